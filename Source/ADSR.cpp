@@ -175,6 +175,115 @@ float ::ADSR::Value(double time, const EventInfo* e) const
    return ofLerp(stageStartValue, mStages[stage].target * e->mMult, lerp);
 }
 
+//the same values as calling Value() for each sample, but the event and the stage are only looked up where they can change,
+//and within a stage, the curve's exponent and the stage length's reciprocal are worked out once instead of per sample
+void ::ADSR::RenderBlock(double startTime, float* out, int numSamples, double sampleIncrementMs) const
+{
+   int pos = 0;
+   while (pos < numSamples)
+   {
+      double time = startTime + pos * sampleIncrementMs;
+      const EventInfo* e = GetEventConst(time);
+
+      //a later event that starts inside the block takes over from its first sample after its start time
+      int eventEnd = numSamples;
+      for (const auto& other : mEvents)
+      {
+         if (&other == e || other.mStartTime < time)
+            continue;
+         int first = MAX(pos + 1, (int)ceil((other.mStartTime - startTime) / sampleIncrementMs));
+         while (first > pos + 1 && startTime + (first - 1) * sampleIncrementMs > other.mStartTime)
+            --first;
+         while (first < eventEnd && startTime + first * sampleIncrementMs <= other.mStartTime)
+            ++first;
+         eventEnd = MIN(eventEnd, first);
+      }
+
+      RenderEvent(e, startTime, sampleIncrementMs, out, pos, eventEnd);
+      pos = eventEnd;
+   }
+}
+
+void ::ADSR::RenderEvent(const EventInfo* e, double startTime, double sampleIncrementMs, float* out, int from, int to) const
+{
+   //the first sample at or after a time, but always at least one past pos, so that each segment makes progress.
+   //everything before a boundary is certainly still in the stage that pos is in
+   auto samplesBefore = [&](int pos, double boundaryTime)
+   {
+      int sample = (int)ceil((boundaryTime - startTime) / sampleIncrementMs);
+      while (sample > pos + 1 && startTime + (sample - 1) * sampleIncrementMs >= boundaryTime)
+         --sample;
+      return ofClamp(sample, pos + 1, to);
+   };
+
+   int pos = from;
+   while (pos < to)
+   {
+      double time = startTime + pos * sampleIncrementMs;
+      double stageStartTime;
+      int stage = GetStage(time, stageStartTime, e);
+
+      int segmentEnd = to;
+      if (mHasSustainStage && e->mStopTime > e->mStartTime && time < e->mStopTime)
+         segmentEnd = samplesBefore(pos, e->mStopTime);
+      if (time < e->mStartTime)
+         segmentEnd = MIN(segmentEnd, samplesBefore(pos, e->mStartTime));
+
+      if (stage == mNumStages) //done
+      {
+         std::fill(out + pos, out + segmentEnd, mStages[stage - 1].target);
+         pos = segmentEnd;
+         continue;
+      }
+
+      float stageStartValue;
+      if (stage == 0)
+         stageStartValue = mZeroValueIsFirstStage ? mStages[0].target : e->mStartBlendFromValue;
+      else if (mHasSustainStage && stage == mSustainStage + 1 && e->mStopBlendFromValue != std::numeric_limits<float>::max())
+         stageStartValue = e->mStopBlendFromValue;
+      else
+         stageStartValue = mStages[stage - 1].target * e->mMult;
+
+      float stageTarget = mStages[stage].target * e->mMult;
+      double stageLength = mStages[stage].time * GetStageTimeScale(stage);
+      double stageEndTime = stageStartTime + stageLength;
+
+      if (mHasSustainStage && stage == mSustainStage && time > stageEndTime)
+      {
+         //holding
+         std::fill(out + pos, out + segmentEnd, mStages[mSustainStage].target * e->mMult);
+         pos = segmentEnd;
+         continue;
+      }
+
+      //the stage (or the ramp part of the sustain stage) moves on once the time is past its end
+      segmentEnd = MIN(segmentEnd, samplesBefore(pos, stageEndTime));
+
+      double invStageLength = 1 / stageLength;
+      float curve = mStages[stage].curve + mCurve;
+      if (curve != 0)
+      {
+         float exponent = expf(-2 * curve * ((stageStartValue < stageTarget) ? 1 : -1)); //MathUtils::Curve()
+         for (int i = pos; i < segmentEnd; ++i)
+         {
+            float lerp = ofClamp((startTime + i * sampleIncrementMs - stageStartTime) * invStageLength, 0, 1);
+            out[i] = ofLerp(stageStartValue, stageTarget, powf(lerp, exponent));
+         }
+      }
+      else
+      {
+         //a straight line, nothing to evaluate but the lerp
+         float delta = stageTarget - stageStartValue;
+         for (int i = pos; i < segmentEnd; ++i)
+         {
+            float lerp = ofClamp((startTime + i * sampleIncrementMs - stageStartTime) * invStageLength, 0, 1);
+            out[i] = stageStartValue + delta * lerp;
+         }
+      }
+      pos = segmentEnd;
+   }
+}
+
 float ::ADSR::GetStageTimeScale(int stage) const
 {
    if (stage >= mNumStages - 1)
@@ -83,6 +83,7 @@ public:
    void Stop(double time, bool warn = true);
    float Value(double time) const;
    float Value(double time, const EventInfo* event) const;
+   void RenderBlock(double startTime, float* out, int numSamples, double sampleIncrementMs) const;
    void Set(float a, float d, float s, float r, float h = -1);
    void Set(const ADSR& other);
    void Clear()
@@ -124,6 +125,7 @@ private:
    EventInfo* GetEvent(double time);
    const EventInfo* GetEventConst(double time) const;
    float GetStageTimeScale(int stage) const;
+   void RenderEvent(const EventInfo* e, double startTime, double sampleIncrementMs, float* out, int from, int to) const;
 
    std::array<EventInfo, 5> mEvents;
    int mNextEventPointer{ 0 };
@@ -43,6 +43,10 @@ enum class AbletonDeviceType
 #include "leathers/unused-variable"
 namespace AbletonDevice
 {
+   //how often the device displays get redrawn, independent of the editor's frame rate.
+   //the bridge's usb thread keeps streaming the last frame it was given in between
+   const double kDisplayRefreshIntervalMs = 1000.0 / 30;
+
    //push 2
    const int kMainEncoderTouchSection = 0;
    const int kMainEncoderSection = 71 + 128;
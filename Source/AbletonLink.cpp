@@ -54,24 +54,20 @@ AbletonLink::AbletonLink()
                                  mNumPeers = p;
                               });
 
-   mLink->setTempoCallback([this](const double bpm)
-                           {
-                              if (mEnabled)
-                                 TheTransport->SetTempo(bpm);
-                              mTempo = bpm;
-                           });
+   //tempo changes from the session are picked up on the audio thread, in GetTargetMeasureTime(), rather than from link's thread
 }
 
 void AbletonLink::Init()
 {
    IDrawableModule::Init();
 
-   TheTransport->AddAudioPoller(this);
+   TheTransport->SetClockSource(this);
 }
 
 AbletonLink::~AbletonLink()
 {
-   TheTransport->RemoveAudioPoller(this);
+   if (TheTransport->GetClockSource() == this)
+      TheTransport->SetClockSource(nullptr);
 }
 
 void AbletonLink::CreateUIControls()
@@ -89,51 +85,47 @@ void AbletonLink::Poll()
 {
 }
 
-void AbletonLink::OnTransportAdvanced(float amount)
+bool AbletonLink::GetTargetMeasureTime(double ms, double& measureTime)
 {
-   if (mEnabled && mLink.get() != nullptr)
+   if (!mEnabled || mLink.get() == nullptr)
+      return false;
+
+   auto& deviceManager = TheSynth->GetAudioDeviceManager();
+   if (deviceManager.getCurrentAudioDevice() == nullptr)
+      return false;
+
+   //one capture per buffer, that everything in the buffer is worked out from
+   auto sessionState = mLink->captureAudioSessionState();
+
+   const double kTempoEpsilon = .001;
+   if (abs(TheTransport->GetTempo() - mTempo) > kTempoEpsilon)
    {
-      if (mTempo != TheTransport->GetTempo())
-      {
-         mTempo = TheTransport->GetTempo();
-         auto sessionState = mLink->captureAudioSessionState();
-         sessionState.setTempo(mTempo, mLink->clock().micros());
-         mLink->commitAudioSessionState(sessionState);
-      }
-
-      auto& deviceManager = TheSynth->GetAudioDeviceManager();
-      if (deviceManager.getCurrentAudioDevice() != nullptr)
-      {
-         auto sampleRate = deviceManager.getCurrentAudioDevice()->getCurrentSampleRate();
-         auto bufferSize = deviceManager.getCurrentAudioDevice()->getCurrentBufferSizeSamples();
-
-         const auto hostTimeUs = sHostTimeFilter.sampleTimeToHostTime(mSampleTime);
-         const auto outputLatencyUs = std::chrono::microseconds{ std::llround(1.0e6 * bufferSize / sampleRate) };
-         auto offsetUs = std::chrono::microseconds{ llround(mOffsetMs * 1000) };
-
-         auto adjustedTimeUs = hostTimeUs + outputLatencyUs + offsetUs;
-
-         auto sessionState = mLink->captureAudioSessionState();
-
-         double quantum = TheTransport->GetTimeSigTop();
-         mLastReceivedBeat = sessionState.beatAtTime(adjustedTimeUs, quantum);
-
-         double measureTime = mLastReceivedBeat / quantum;
-         double localMeasureTime = TheTransport->GetMeasureTime(gTime);
-         double difference = measureTime - localMeasureTime;
-         if (abs(difference) > .01f)
-         {
-            //too far off, correct
-            TheTransport->SetMeasureTime(measureTime);
-            ofLog() << "correcting transport position for ableton link";
-         }
-
-         // Timeline modifications are complete, commit the results
-         //mLink->commitAudioSessionState(sessionState);
-
-         mSampleTime += gBufferSize;
-      }
+      //changed here, tell the session
+      mTempo = TheTransport->GetTempo();
+      sessionState.setTempo(mTempo, mLink->clock().micros());
+      mLink->commitAudioSessionState(sessionState);
    }
+   else if (abs(sessionState.tempo() - mTempo) > kTempoEpsilon)
+   {
+      //changed by a peer
+      mTempo = sessionState.tempo();
+      TheTransport->SetTempo(mTempo);
+   }
+
+   auto sampleRate = deviceManager.getCurrentAudioDevice()->getCurrentSampleRate();
+   auto bufferSize = deviceManager.getCurrentAudioDevice()->getCurrentBufferSizeSamples();
+
+   //the transport is about to move to the start of the buffer that'll be heard an output latency from now
+   const auto hostTimeUs = sHostTimeFilter.sampleTimeToHostTime(mSampleTime);
+   const auto outputLatencyUs = std::chrono::microseconds{ std::llround(1.0e6 * bufferSize / sampleRate) };
+   auto offsetUs = std::chrono::microseconds{ llround(mOffsetMs * 1000) };
+   auto adjustedTimeUs = hostTimeUs + outputLatencyUs + offsetUs;
+   mSampleTime += gBufferSize;
+
+   double quantum = TheTransport->GetTimeSigTop();
+   mLastReceivedBeat = sessionState.beatAtTime(adjustedTimeUs, quantum);
+   measureTime = mLastReceivedBeat / quantum;
+   return true;
 }
 
 void AbletonLink::DrawModule()
@@ -144,7 +136,7 @@ void AbletonLink::DrawModule()
    mOffsetMsSlider->Draw();
    mResetButton->Draw();
 
-   DrawTextNormal("peers: " + ofToString(mNumPeers) + "\ntempo: " + ofToString(mTempo) + "\nbeat: " + ofToString(mLastReceivedBeat), 3, 48);
+   DrawTextNormal("peers: " + ofToString(mNumPeers.load()) + "\ntempo: " + ofToString(mTempo) + "\nbeat: " + ofToString(mLastReceivedBeat), 3, 48);
 }
 
 void AbletonLink::CheckboxUpdated(Checkbox* checkbox, double time)
@@ -24,20 +24,21 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include "IDrawableModule.h"
 #include "Checkbox.h"
-#include "IAudioPoller.h"
 #include "Slider.h"
 #include "ClickButton.h"
+#include "Transport.h"
 
 namespace ableton
 {
    class Link;
 }
 
-class AbletonLink : public IDrawableModule, public IAudioPoller, public IFloatSliderListener, public IButtonListener
+class AbletonLink : public IDrawableModule, public ITransportClockSource, public IFloatSliderListener, public IButtonListener
 {
 public:
    AbletonLink();
@@ -51,7 +52,8 @@ public:
    void CreateUIControls() override;
    void Poll() override;
 
-   void OnTransportAdvanced(float amount) override;
+   //ITransportClockSource
+   bool GetTargetMeasureTime(double ms, double& measureTime) override;
 
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
@@ -69,8 +71,8 @@ private:
    ClickButton* mResetButton{ nullptr };
 
    std::unique_ptr<ableton::Link> mLink;
-   double mTempo{ 120 };
-   std::size_t mNumPeers{ 0 };
+   double mTempo{ 120 }; //the tempo the session and the transport last agreed on
+   std::atomic<std::size_t> mNumPeers{ 0 };
    double mLastReceivedBeat{ 0 };
    double mSampleTime{ 0 };
 };
@@ -290,7 +290,14 @@ void AbletonMoveControl::DrawDisplayModuleRect(ofRectangle rect, float thickness
 void AbletonMoveControl::PostRender()
 {
    if (ThePushBridge.IsInitialized())
-      RenderPush2Display();
+   {
+      double now = juce::Time::getMillisecondCounterHiRes();
+      if (now - mLastDisplayRenderTime >= kDisplayRefreshIntervalMs)
+      {
+         mLastDisplayRenderTime = now;
+         RenderPush2Display();
+      }
+   }
 }
 
 void AbletonMoveControl::KeyPressed(int key, bool isRepeat)
@@ -1103,6 +1110,12 @@ void AbletonMoveControl::RenderPush2Display()
 
    uint8_t* lcdPixels = mLCD.GetPixels();
 
+   //the usb thread streams the raw bitmap continuously, so only repack it when the lcd contents changed
+   int numLCDBytes = mLCD.GetNumDisplayPixels();
+   if (mLastSentLCDPixels.size() == numLCDBytes && memcmp(mLastSentLCDPixels.data(), lcdPixels, numLCDBytes) == 0)
+      return;
+   mLastSentLCDPixels.assign(lcdPixels, lcdPixels + numLCDBytes);
+
    uint16_t* pixels = ThePushBridge.GetDisplay()->GetRawBitmap();
    memset(pixels, 0, sizeof(uint16_t) * mLCD.GetNumDisplayPixels());
    const int kPixelBlockRows = 8;
@@ -137,6 +137,8 @@ private:
    const int kTrackRowScale = -4;
 
    AbletonMoveLCD mLCD;
+   std::vector<uint8_t> mLastSentLCDPixels;
+   double mLastDisplayRenderTime{ 0 };
    double mScreenOverrideTimeout{ 0.0 };
    std::string mTemporaryScreenMessage{};
    double mTemporaryScreenMessageTimeout{ 0.0 };
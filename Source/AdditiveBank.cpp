@@ -0,0 +1,522 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AdditiveBank.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "AdditiveBank.h"
+#include "ComputeOffload.h"
+#include "FFT.h"
+#include "SynthGlobals.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace
+{
+   const int kLanes = 4;
+   const int kChunkSize = 64; //output samples summed per pass over the lanes
+
+   //inverse fft synthesis: blackman-harris windowed frames at 50% overlap. the window's spectrum is compact enough that each
+   //partial only has to be written into the bins within kKernelHalfWidth of its frequency
+   const int kFrameSize = 512;
+   const int kHopSize = kFrameSize / 2;
+   const int kKernelHalfWidth = 4;
+   const int kKernelOversampling = 32;
+
+   struct InverseFFTTables
+   {
+      std::vector<float> mKernel; //the window's transform, sampled kKernelOversampling times per bin from 0 out to kKernelHalfWidth bins
+      std::vector<float> mSynthesisWindow; //undoes the analysis window and applies a triangle instead, so hops sum to unity
+   };
+
+   double BlackmanHarris(int m) //m in [-kFrameSize/2, kFrameSize/2), peak at 0
+   {
+      double x = 2 * M_PI * m / kFrameSize;
+      return .35875 + .48829 * cos(x) + .14128 * cos(2 * x) + .01168 * cos(3 * x);
+   }
+
+   const InverseFFTTables& GetInverseFFTTables()
+   {
+      static const InverseFFTTables sTables = []
+      {
+         InverseFFTTables tables;
+
+         tables.mKernel.resize(kKernelHalfWidth * kKernelOversampling + 2);
+         for (size_t i = 0; i < tables.mKernel.size(); ++i)
+         {
+            double bins = double(i) / kKernelOversampling;
+            double sum = 0;
+            for (int m = -kFrameSize / 2; m < kFrameSize / 2; ++m)
+               sum += BlackmanHarris(m) * cos(2 * M_PI * bins * m / kFrameSize);
+            tables.mKernel[i] = sum;
+         }
+
+         tables.mSynthesisWindow.resize(kFrameSize);
+         for (int n = 0; n < kFrameSize; ++n)
+         {
+            double triangle = 1 - std::abs(n - kFrameSize / 2) / double(kFrameSize / 2);
+            tables.mSynthesisWindow[n] = triangle / (kFrameSize * BlackmanHarris(n - kFrameSize / 2)); //inverse transform is unnormalized
+         }
+
+         return tables;
+      }();
+      return sTables;
+   }
+
+   inline float Kernel(const std::vector<float>& kernel, float bins)
+   {
+      float pos = std::abs(bins) * kKernelOversampling;
+      int index = int(pos);
+      float remainder = pos - index;
+      return (1 - remainder) * kernel[index] + remainder * kernel[index + 1];
+   }
+
+   //rotates kLanes phasors a sample at a time, adding amp * sin(phase) of each into its slot of sums
+   void RunLaneGroup(float* re, float* im, const float* rotRe, const float* rotIm, float* amp, const float* ampInc, float* sums, int length)
+   {
+#if defined(__wasm_simd128__)
+      v128_t r = wasm_v128_load(re);
+      v128_t i4 = wasm_v128_load(im);
+      v128_t rr = wasm_v128_load(rotRe);
+      v128_t ri = wasm_v128_load(rotIm);
+      v128_t a = wasm_v128_load(amp);
+      v128_t da = wasm_v128_load(ampInc);
+      for (int i = 0; i < length; ++i)
+      {
+         v128_t nextRe = wasm_f32x4_sub(wasm_f32x4_mul(r, rr), wasm_f32x4_mul(i4, ri));
+         i4 = wasm_f32x4_add(wasm_f32x4_mul(r, ri), wasm_f32x4_mul(i4, rr));
+         r = nextRe;
+         a = wasm_f32x4_add(a, da);
+         float* sum = sums + i * kLanes;
+         wasm_v128_store(sum, wasm_f32x4_add(wasm_v128_load(sum), wasm_f32x4_mul(a, i4)));
+      }
+      wasm_v128_store(re, r);
+      wasm_v128_store(im, i4);
+      wasm_v128_store(amp, a);
+#else
+      //written lane-wise so the compiler can keep each lane in a vector register
+      float r[kLanes], i4[kLanes], a[kLanes];
+      for (int lane = 0; lane < kLanes; ++lane)
+      {
+         r[lane] = re[lane];
+         i4[lane] = im[lane];
+         a[lane] = amp[lane];
+      }
+      for (int i = 0; i < length; ++i)
+      {
+         float* sum = sums + i * kLanes;
+         for (int lane = 0; lane < kLanes; ++lane)
+         {
+            float nextRe = r[lane] * rotRe[lane] - i4[lane] * rotIm[lane];
+            i4[lane] = r[lane] * rotIm[lane] + i4[lane] * rotRe[lane];
+            r[lane] = nextRe;
+            a[lane] += ampInc[lane];
+            sum[lane] += a[lane] * i4[lane];
+         }
+      }
+      for (int lane = 0; lane < kLanes; ++lane)
+      {
+         re[lane] = r[lane];
+         im[lane] = i4[lane];
+         amp[lane] = a[lane];
+      }
+#endif
+   }
+}
+
+AdditiveBank::AdditiveBank(int maxPartials)
+: mMaxPartials(maxPartials)
+, mNumPartials(maxPartials)
+{
+   int numLanes = (maxPartials + kLanes - 1) / kLanes * kLanes;
+
+   mPhasorRe.resize(maxPartials, 1);
+   mPhasorIm.resize(maxPartials, 0);
+   mRotationRe.resize(maxPartials, 1);
+   mRotationIm.resize(maxPartials, 0);
+   mPhaseInc.resize(maxPartials, 0);
+   mAmp.resize(maxPartials, 0);
+   mTargetAmp.resize(maxPartials, 0);
+
+   mActive.reserve(maxPartials);
+   mLaneRe.resize(numLanes);
+   mLaneIm.resize(numLanes);
+   mLaneRotationRe.resize(numLanes);
+   mLaneRotationIm.resize(numLanes);
+   mLaneAmp.resize(numLanes);
+   mLaneAmpInc.resize(numLanes);
+   mLaneSums.resize(kChunkSize * kLanes);
+
+   mPlan = &FFTPlan::Get(kFrameSize);
+   mSpectrumRe.resize(kFrameSize / 2 + 1);
+   mSpectrumIm.resize(kFrameSize / 2 + 1);
+   mFrame.resize(kFrameSize);
+   mFFTScratch.resize(mPlan->GetScratchSize());
+   mOverlapAdd.resize(kFrameSize);
+   GetInverseFFTTables(); //build the shared tables now instead of on the audio thread
+
+   if (ComputeOffload* offload = ComputeOffload::Get())
+   {
+      //a job is collected in the same slot, and on the same call, that the next one is queued into
+      mComputeLatency = MAX(1, offload->GetLatencyCallbacks());
+      mComputeJobs.resize(mComputeLatency);
+      for (ComputeJob& job : mComputeJobs)
+      {
+         for (auto* lanes : { &job.mRe, &job.mIm, &job.mRotationRe, &job.mRotationIm, &job.mAmp, &job.mAmpInc, &job.mPhase, &job.mPhaseInc })
+            lanes->resize(numLanes);
+      }
+      mComputeOutput.resize(MAX(gBufferSize, 1));
+   }
+}
+
+int AdditiveBank::GetLatencySamples() const
+{
+   return (mMode == Mode::kCompute && !mComputeJobs.empty()) ? mComputeLatency * gBufferSize : 0;
+}
+
+void AdditiveBank::SetNumPartials(int numPartials)
+{
+   numPartials = ofClamp(numPartials, 0, mMaxPartials);
+   for (int i = numPartials; i < mNumPartials; ++i)
+   {
+      mAmp[i] = 0;
+      mTargetAmp[i] = 0;
+   }
+   mNumPartials = numPartials;
+}
+
+void AdditiveBank::SetPartial(int index, float phaseInc, float amp)
+{
+   if (phaseInc != mPhaseInc[index])
+   {
+      mPhaseInc[index] = phaseInc;
+      mRotationRe[index] = cosf(phaseInc);
+      mRotationIm[index] = sinf(phaseInc);
+   }
+   mTargetAmp[index] = amp;
+}
+
+void AdditiveBank::SetPartialPhase(int index, float phase)
+{
+   mPhasorRe[index] = cosf(phase);
+   mPhasorIm[index] = sinf(phase);
+}
+
+void AdditiveBank::ResetPhases()
+{
+   std::fill(mPhasorRe.begin(), mPhasorRe.end(), 1.0f);
+   std::fill(mPhasorIm.begin(), mPhasorIm.end(), 0.0f);
+}
+
+bool AdditiveBank::IsAudible(int index) const
+{
+   if (mPhaseInc[index] <= 0 || mPhaseInc[index] >= FPI) //at or past nyquist
+      return false;
+   return std::abs(mAmp[index]) >= kCullThreshold || std::abs(mTargetAmp[index]) >= kCullThreshold;
+}
+
+void AdditiveBank::Process(float* out, int bufferSize)
+{
+   Mode mode = mMode;
+   if (mode == Mode::kCompute && mComputeJobs.empty())
+      mode = Mode::kOscillators;
+
+   if (mode != mLastProcessedMode)
+   {
+      //whatever was still in flight was for the old mode's timing
+      for (ComputeJob& job : mComputeJobs)
+      {
+         job.mNumLanes = 0;
+         job.mTicket = -1;
+      }
+      mLastProcessedMode = mode;
+   }
+
+   if (mode == Mode::kInverseFFT)
+      ProcessInverseFFT(out, bufferSize);
+   else if (mode == Mode::kCompute)
+      ProcessCompute(out, bufferSize);
+   else
+      ProcessOscillators(out, bufferSize);
+}
+
+int AdditiveBank::GatherLanes(int bufferSize)
+{
+   mActive.clear();
+   for (int i = 0; i < mNumPartials; ++i)
+   {
+      if (IsAudible(i))
+         mActive.push_back(i);
+      else
+         mAmp[i] = mTargetAmp[i];
+   }
+   mNumActivePartials = (int)mActive.size();
+   if (mNumActivePartials == 0)
+      return 0;
+
+   float invBufferSize = 1.0f / bufferSize;
+   int numLanes = (mNumActivePartials + kLanes - 1) / kLanes * kLanes;
+   for (int lane = 0; lane < numLanes; ++lane)
+   {
+      if (lane < mNumActivePartials)
+      {
+         int index = mActive[lane];
+         mLaneRe[lane] = mPhasorRe[index];
+         mLaneIm[lane] = mPhasorIm[index];
+         mLaneRotationRe[lane] = mRotationRe[index];
+         mLaneRotationIm[lane] = mRotationIm[index];
+         mLaneAmp[lane] = mAmp[index];
+         mLaneAmpInc[lane] = (mTargetAmp[index] - mAmp[index]) * invBufferSize;
+      }
+      else
+      {
+         mLaneRe[lane] = 1;
+         mLaneIm[lane] = 0;
+         mLaneRotationRe[lane] = 1;
+         mLaneRotationIm[lane] = 0;
+         mLaneAmp[lane] = 0;
+         mLaneAmpInc[lane] = 0;
+      }
+   }
+   return numLanes;
+}
+
+void AdditiveBank::RunLanes(float* out, int bufferSize, int numLanes)
+{
+   for (int offset = 0; offset < bufferSize; offset += kChunkSize)
+   {
+      int length = MIN(kChunkSize, bufferSize - offset);
+      std::fill(mLaneSums.begin(), mLaneSums.begin() + length * kLanes, 0.0f);
+
+      for (int lane = 0; lane < numLanes; lane += kLanes)
+      {
+         RunLaneGroup(&mLaneRe[lane], &mLaneIm[lane], &mLaneRotationRe[lane], &mLaneRotationIm[lane],
+                      &mLaneAmp[lane], &mLaneAmpInc[lane], mLaneSums.data(), length);
+      }
+
+      for (int i = 0; i < length; ++i)
+      {
+         const float* sum = &mLaneSums[i * kLanes];
+         out[offset + i] += sum[0] + sum[1] + sum[2] + sum[3];
+      }
+   }
+}
+
+void AdditiveBank::ProcessOscillators(float* out, int bufferSize)
+{
+   if (bufferSize <= 0)
+      return;
+
+   int numLanes = GatherLanes(bufferSize);
+   if (numLanes == 0)
+      return;
+
+   RunLanes(out, bufferSize, numLanes);
+
+   for (int lane = 0; lane < mNumActivePartials; ++lane)
+   {
+      int index = mActive[lane];
+      //the recursion slowly drifts off the unit circle, so pull it back in once per block
+      float re = mLaneRe[lane];
+      float im = mLaneIm[lane];
+      float scale = 1.5f - .5f * (re * re + im * im);
+      mPhasorRe[index] = re * scale;
+      mPhasorIm[index] = im * scale;
+      mAmp[index] = mTargetAmp[index];
+   }
+}
+
+void AdditiveBank::ProcessCompute(float* out, int bufferSize)
+{
+   if (bufferSize <= 0)
+      return;
+
+   ComputeOffload* offload = ComputeOffload::Get();
+   ComputeJob& job = mComputeJobs[mComputeJobPos];
+   mComputeJobPos = (mComputeJobPos + 1) % (int)mComputeJobs.size();
+
+   //what's due now was queued mComputeLatency calls ago, into the slot this call's job goes in
+   if (job.mNumLanes > 0)
+   {
+      int length = MIN(job.mNumSamples, bufferSize);
+      if (job.mTicket != -1 && (int)mComputeOutput.size() >= job.mNumSamples && offload->Collect(job.mTicket, mComputeOutput.data(), job.mNumSamples))
+      {
+         Add(out, mComputeOutput.data(), length);
+      }
+      else
+      {
+         //not back in time, so the cpu runs it after all
+         std::copy_n(job.mRe.begin(), job.mNumLanes, mLaneRe.begin());
+         std::copy_n(job.mIm.begin(), job.mNumLanes, mLaneIm.begin());
+         std::copy_n(job.mRotationRe.begin(), job.mNumLanes, mLaneRotationRe.begin());
+         std::copy_n(job.mRotationIm.begin(), job.mNumLanes, mLaneRotationIm.begin());
+         std::copy_n(job.mAmp.begin(), job.mNumLanes, mLaneAmp.begin());
+         std::copy_n(job.mAmpInc.begin(), job.mNumLanes, mLaneAmpInc.begin());
+         RunLanes(out, length, job.mNumLanes);
+      }
+   }
+   job.mNumLanes = 0;
+   job.mTicket = -1;
+
+   int numLanes = GatherLanes(bufferSize);
+   if (numLanes == 0)
+      return;
+
+   if ((int)mComputeOutput.size() < bufferSize)
+      mComputeOutput.resize(bufferSize); //only when the buffer size grows
+
+   std::copy_n(mLaneRe.begin(), numLanes, job.mRe.begin());
+   std::copy_n(mLaneIm.begin(), numLanes, job.mIm.begin());
+   std::copy_n(mLaneRotationRe.begin(), numLanes, job.mRotationRe.begin());
+   std::copy_n(mLaneRotationIm.begin(), numLanes, job.mRotationIm.begin());
+   std::copy_n(mLaneAmp.begin(), numLanes, job.mAmp.begin());
+   std::copy_n(mLaneAmpInc.begin(), numLanes, job.mAmpInc.begin());
+   for (int lane = 0; lane < mNumActivePartials; ++lane)
+   {
+      job.mPhase[lane] = atan2f(mLaneIm[lane], mLaneRe[lane]);
+      job.mPhaseInc[lane] = mPhaseInc[mActive[lane]];
+   }
+   job.mNumLanes = numLanes;
+   job.mNumSamples = bufferSize;
+   job.mTicket = offload->QueueAdditive(job.mPhase.data(), job.mPhaseInc.data(), job.mAmp.data(), job.mAmpInc.data(), mNumActivePartials, bufferSize);
+
+   AdvancePhasors(bufferSize);
+}
+
+//where the oscillators would have left the phasors after bufferSize samples, without running them
+void AdditiveBank::AdvancePhasors(int bufferSize)
+{
+   for (int lane = 0; lane < mNumActivePartials; ++lane)
+   {
+      int index = mActive[lane];
+      float advance = mPhaseInc[index] * bufferSize;
+      float advanceRe = cosf(advance);
+      float advanceIm = sinf(advance);
+      float re = mPhasorRe[index] * advanceRe - mPhasorIm[index] * advanceIm;
+      float im = mPhasorRe[index] * advanceIm + mPhasorIm[index] * advanceRe;
+      float scale = 1.5f - .5f * (re * re + im * im);
+      mPhasorRe[index] = re * scale;
+      mPhasorIm[index] = im * scale;
+      mAmp[index] = mTargetAmp[index];
+   }
+}
+
+void AdditiveBank::ProcessInverseFFT(float* out, int bufferSize)
+{
+   int offset = 0;
+   while (offset < bufferSize)
+   {
+      if (mSamplesUntilFrame == 0)
+      {
+         SynthesizeFrame();
+         mSamplesUntilFrame = kHopSize;
+      }
+
+      int length = MIN(bufferSize - offset, mSamplesUntilFrame);
+      int done = 0;
+      while (done < length)
+      {
+         int run = MIN(length - done, kFrameSize - mOverlapAddPos);
+         Add(out + offset + done, &mOverlapAdd[mOverlapAddPos], run);
+         ::Clear(&mOverlapAdd[mOverlapAddPos], run);
+         mOverlapAddPos = (mOverlapAddPos + run) % kFrameSize;
+         done += run;
+      }
+
+      offset += length;
+      mSamplesUntilFrame -= length;
+   }
+}
+
+void AdditiveBank::SynthesizeFrame()
+{
+   const InverseFFTTables& tables = GetInverseFFTTables();
+   const int kNumBins = kFrameSize / 2 + 1;
+
+   std::fill(mSpectrumRe.begin(), mSpectrumRe.end(), 0.0f);
+   std::fill(mSpectrumIm.begin(), mSpectrumIm.end(), 0.0f);
+
+   mNumActivePartials = 0;
+   for (int i = 0; i < mNumPartials; ++i)
+   {
+      bool audible = std::abs(mTargetAmp[i]) >= kCullThreshold && mPhaseInc[i] > 0 && mPhaseInc[i] < FPI;
+      mAmp[i] = mTargetAmp[i];
+      if (!audible)
+         continue;
+      ++mNumActivePartials;
+
+      //the phasor holds the phase at the center of the frame. amp * sin(phase) splits into
+      //c * exp(i * phase) + conj(c) * exp(-i * phase), with c = -i * amp / 2
+      float halfAmp = mAmp[i] * .5f;
+      float cRe = mPhasorIm[i] * halfAmp;
+      float cIm = -mPhasorRe[i] * halfAmp;
+      float bin = mPhaseInc[i] * kFrameSize / FTWO_PI;
+
+      int first = MAX(0, (int)ceilf(bin - kKernelHalfWidth));
+      int last = MIN(kNumBins - 1, (int)floorf(bin + kKernelHalfWidth));
+      for (int k = first; k <= last; ++k)
+      {
+         float w = Kernel(tables.mKernel, k - bin);
+         if (k & 1)
+            w = -w; //the frame is centered on kFrameSize / 2
+         mSpectrumRe[k] += cRe * w;
+         mSpectrumIm[k] += cIm * w;
+      }
+
+      //the negative frequency image reaches into the lowest bins
+      for (int k = 0; k + bin < kKernelHalfWidth; ++k)
+      {
+         float w = Kernel(tables.mKernel, k + bin);
+         if (k & 1)
+            w = -w;
+         mSpectrumRe[k] += cRe * w;
+         mSpectrumIm[k] -= cIm * w;
+      }
+
+      //on to the center of the next frame
+      float advance = mPhaseInc[i] * kHopSize;
+      float advanceRe = cosf(advance);
+      float advanceIm = sinf(advance);
+      float re = mPhasorRe[i] * advanceRe - mPhasorIm[i] * advanceIm;
+      float im = mPhasorRe[i] * advanceIm + mPhasorIm[i] * advanceRe;
+      float scale = 1.5f - .5f * (re * re + im * im);
+      mPhasorRe[i] = re * scale;
+      mPhasorIm[i] = im * scale;
+   }
+
+   //FFTPlan's imaginary parts are sin-correlations, the negative of the usual convention
+   for (int k = 0; k < kNumBins; ++k)
+      mSpectrumIm[k] = -mSpectrumIm[k];
+
+   mPlan->Inverse(mSpectrumRe.data(), mSpectrumIm.data(), mFrame.data(), mFFTScratch.data());
+   Mult(mFrame.data(), tables.mSynthesisWindow.data(), kFrameSize);
+
+   int firstRun = kFrameSize - mOverlapAddPos;
+   Add(&mOverlapAdd[mOverlapAddPos], mFrame.data(), firstRun);
+   Add(mOverlapAdd.data(), mFrame.data() + firstRun, mOverlapAddPos);
+}
@@ -0,0 +1,139 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AdditiveBank.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+class FFTPlan;
+
+//a bank of sine partials for additive synthesis. oscillator state is kept as structure-of-arrays of complex phasors that get
+//rotated a sample at a time, four partials per simd lane group, and partials too quiet to hear are skipped entirely.
+//for very large partial counts there's also an inverse-fft mode, which places each partial's spectrum into a frame once
+//per hop instead of running it sample by sample. the oscillators can also run on a ComputeOffload, at a few callbacks of latency.
+class AdditiveBank
+{
+public:
+   enum class Mode
+   {
+      kOscillators,
+      kInverseFFT,
+      kCompute //the oscillators on the ComputeOffload, GetLatencySamples() late. the same as kOscillators when there's no offload
+   };
+
+   explicit AdditiveBank(int maxPartials);
+
+   void SetMode(Mode mode) { mMode = mode; }
+   Mode GetMode() const { return mMode; }
+
+   //partials at or past numPartials are silent
+   void SetNumPartials(int numPartials);
+   int GetNumPartials() const { return mNumPartials; }
+
+   //phaseInc is in radians per sample, and partials are only heard between 0 and nyquist (pi).
+   //amplitude changes are ramped across the next Process() call
+   void SetPartial(int index, float phaseInc, float amp);
+   void SetPartialPhase(int index, float phase);
+   void ResetPhases();
+
+   //adds the sum of the partials into out
+   void Process(float* out, int bufferSize);
+
+   //how many partials were loud enough to be computed in the last Process()
+   int GetNumActivePartials() const { return mNumActivePartials; }
+
+   //how much later than it was asked for the output comes out, at gBufferSize samples per Process()
+   int GetLatencySamples() const;
+
+   static constexpr float kCullThreshold = .00001f; //-100dB
+
+private:
+   //offloaded oscillators, the inputs kept so that the cpu can run them instead if the result isn't back in time
+   struct ComputeJob
+   {
+      int mTicket{ -1 };
+      int mNumLanes{ 0 }; //0 for nothing queued
+      int mNumSamples{ 0 };
+      std::vector<float> mRe;
+      std::vector<float> mIm;
+      std::vector<float> mRotationRe;
+      std::vector<float> mRotationIm;
+      std::vector<float> mAmp;
+      std::vector<float> mAmpInc;
+      std::vector<float> mPhase;
+      std::vector<float> mPhaseInc;
+   };
+
+   void ProcessOscillators(float* out, int bufferSize);
+   void ProcessInverseFFT(float* out, int bufferSize);
+   void ProcessCompute(float* out, int bufferSize);
+   int GatherLanes(int bufferSize);
+   void RunLanes(float* out, int bufferSize, int numLanes);
+   void AdvancePhasors(int bufferSize);
+   void SynthesizeFrame();
+   bool IsAudible(int index) const;
+
+   Mode mMode{ Mode::kOscillators };
+   int mMaxPartials{ 0 };
+   int mNumPartials{ 0 };
+   int mNumActivePartials{ 0 };
+
+   //per partial
+   std::vector<float> mPhasorRe;
+   std::vector<float> mPhasorIm;
+   std::vector<float> mRotationRe; //exp(i * phaseInc)
+   std::vector<float> mRotationIm;
+   std::vector<float> mPhaseInc;
+   std::vector<float> mAmp;
+   std::vector<float> mTargetAmp;
+
+   //audible partials, gathered into contiguous lanes for the oscillator loop
+   std::vector<int> mActive;
+   std::vector<float> mLaneRe;
+   std::vector<float> mLaneIm;
+   std::vector<float> mLaneRotationRe;
+   std::vector<float> mLaneRotationIm;
+   std::vector<float> mLaneAmp;
+   std::vector<float> mLaneAmpInc;
+   std::vector<float> mLaneSums; //four interleaved partial sums per output sample
+
+   //inverse fft mode
+   const FFTPlan* mPlan{ nullptr };
+   std::vector<float> mSpectrumRe;
+   std::vector<float> mSpectrumIm;
+   std::vector<float> mFrame;
+   std::vector<float> mFFTScratch;
+   std::vector<float> mOverlapAdd; //the sample at mOverlapAddPos is the next one out
+   int mOverlapAddPos{ 0 };
+   int mSamplesUntilFrame{ 0 };
+
+   //compute mode, a ring of the last GetLatencyCallbacks() + 1 jobs
+   int mComputeLatency{ 0 };
+   std::vector<ComputeJob> mComputeJobs;
+   int mComputeJobPos{ 0 };
+   std::vector<float> mComputeOutput;
+   Mode mLastProcessedMode{ Mode::kOscillators };
+};
@@ -58,23 +58,24 @@ void Amplifier::Process(double time)
 
    mNumChannels = GetBuffer()->NumActiveChannels();
 
+   float* gains = gWorkBuffer;
+   if (mEnabled)
+   {
+      mGainSlider->ComputeBlock(gains, bufferSize);
+   }
+
    ChannelBuffer* out = target->GetBuffer();
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
    {
       auto getBufferChannelCh = GetBuffer()->GetChannel(ch);
       if (mEnabled)
       {
-         for (int i = 0; i < bufferSize; ++i)
-         {
-            ComputeSliders(i);
-            gWorkBuffer[i] = getBufferChannelCh[i] * mGain;
-         }
+         MultAndAdd(getBufferChannelCh, gains, out->GetChannel(ch), bufferSize);
 
          if (mShowLevelMeter)
-            mLevelMeterDisplay.Process(ch, gWorkBuffer, bufferSize);
+            mLevelMeterDisplay.Process(ch, getBufferChannelCh, bufferSize);
 
-         Add(out->GetChannel(ch), gWorkBuffer, GetBuffer()->BufferSize());
-         GetVizBuffer()->WriteChunk(gWorkBuffer, GetBuffer()->BufferSize(), ch);
+         GetVizBuffer()->WriteChunk(getBufferChannelCh, bufferSize, ch);
       }
       else
       {
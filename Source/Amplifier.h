@@ -49,6 +49,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    //IFloatSliderListener
@@ -32,6 +32,7 @@
 
 Arpeggiator::Arpeggiator()
 {
+   mChord.reserve(mInputNotes.size()); //one entry per held pitch at most, so notes never grow it on the audio thread
    TheScale->AddListener(this);
 }
 
@@ -0,0 +1,73 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioCallbackMonitor.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "AudioCallbackMonitor.h"
+#include "SynthGlobals.h"
+
+void AudioCallbackMonitor::Record(uint64_t startNs, uint64_t endNs, double periodMs)
+{
+   uint64_t durationNs = endNs - startNs;
+   mDurations.Add(durationNs);
+   //a gap of over a second is audio having been paused or the device restarting, not jitter
+   if (mLastStartNs != 0 && startNs - mLastStartNs < 1000000000ull)
+      mIntervals.Add(startNs - mLastStartNs);
+   mLastStartNs = startNs;
+   ++mCallbacks;
+
+   if (durationNs > periodMs * 1000000)
+   {
+      ++mMissedDeadlines;
+
+      uint64_t second = endNs / 1000000000ull;
+      int slot = int(second % kHistorySeconds);
+      if (mSecondStamps[slot].load(std::memory_order_relaxed) != second)
+      {
+         mMissesPerSecond[slot].store(0, std::memory_order_relaxed);
+         mSecondStamps[slot].store(second, std::memory_order_release);
+      }
+      mMissesPerSecond[slot].fetch_add(1, std::memory_order_relaxed);
+   }
+}
+
+int AudioCallbackMonitor::GetRecentMissedDeadlines() const
+{
+   uint64_t now = ofGetSystemTimeNanos() / 1000000000ull;
+   int missed = 0;
+   for (int i = 0; i < kHistorySeconds; ++i)
+   {
+      uint64_t stamp = mSecondStamps[i].load(std::memory_order_acquire);
+      if (stamp != 0 && stamp + kHistorySeconds > now)
+         missed += mMissesPerSecond[i].load(std::memory_order_relaxed);
+   }
+   return missed;
+}
+
+void AudioCallbackMonitor::LogSummary() const
+{
+   ofLog() << "audio callbacks: " << mCallbacks.load() << ", missed deadlines: " << mMissedDeadlines.load()
+           << ", duration p50 " << mDurations.GetPercentileUs(.5f) << "us p99 " << mDurations.GetPercentileUs(.99f) << "us max " << mDurations.mMaxNs / 1000 << "us"
+           << ", interval p99 " << mIntervals.GetPercentileUs(.99f) << "us max " << mIntervals.mMaxNs / 1000 << "us";
+}
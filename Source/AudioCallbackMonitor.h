@@ -0,0 +1,62 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioCallbackMonitor.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Log2Histogram.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+//keeps every audio callback's duration, and the time since the one before it, in histograms, and counts the callbacks that
+//took longer than the buffer they produced (a missed deadline, heard as a dropout). unlike the device's cpu usage, which
+//is averaged, a single spike shows up here. recorded on the audio thread, read from the ui thread
+class AudioCallbackMonitor
+{
+public:
+   static const int kRecentMinutes = 5; //the window GetRecentMissedDeadlines() looks at
+
+   void Record(uint64_t startNs, uint64_t endNs, double periodMs);
+   int GetRecentMissedDeadlines() const;
+   void LogSummary() const;
+
+   const Log2Histogram& GetDurations() const { return mDurations; }
+   const Log2Histogram& GetIntervals() const { return mIntervals; }
+
+private:
+   static const int kHistorySeconds = kRecentMinutes * 60;
+
+   Log2Histogram mDurations;
+   Log2Histogram mIntervals;
+   std::atomic<uint64_t> mCallbacks{ 0 };
+   std::atomic<uint64_t> mMissedDeadlines{ 0 };
+   uint64_t mLastStartNs{ 0 };
+
+   //misses per second of wall time, for the last few minutes. each slot is stamped with the second it counts
+   std::array<std::atomic<uint32_t>, kHistorySeconds> mMissesPerSecond{};
+   std::array<std::atomic<uint64_t>, kHistorySeconds> mSecondStamps{};
+};
@@ -0,0 +1,218 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioEngine.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#include "AudioEngine.h"
+#include "AudioExecutionPlan.h"
+#include "ChannelBufferArena.h"
+#include "ControlChangeQueue.h"
+#include "NoteOutputQueue.h"
+#include "Profiler.h"
+#include "SynthGlobals.h"
+#include "Transport.h"
+
+#include <cassert>
+
+AudioEngine::~AudioEngine()
+{
+   StopWorkers();
+
+   delete mExecutionPlan.exchange(nullptr);
+   FreeRetiredExecutionPlans();
+
+   for (float* buffer : mInputBuffers)
+      delete[] buffer;
+   for (float* buffer : mOutputBuffers)
+      delete[] buffer;
+}
+
+void AudioEngine::InitIOBuffers(int inputChannelCount, int outputChannelCount)
+{
+   for (int i = 0; i < inputChannelCount; ++i)
+      mInputBuffers.push_back(new float[gBufferSize]);
+   for (int i = 0; i < outputChannelCount; ++i)
+      mOutputBuffers.push_back(new float[gBufferSize]);
+   mInputOversamplers.resize(mInputBuffers.size());
+   mOutputOversamplers.resize(mOutputBuffers.size());
+}
+
+void AudioEngine::SetOutputRouting(std::vector<OutputRouting::Route> routes)
+{
+   //as many device channels as buses, so the routing only moves and mixes them
+   mOutputRouting.SetUp(std::move(routes), GetNumOutputChannels(), GetNumOutputChannels(), gBufferSize);
+   mDeviceOutputBuffers = &mOutputBuffers;
+}
+
+void AudioEngine::StartWorkers(int numWorkers, std::function<void(int workerIndex)> onWorkerStarted)
+{
+   //everything that processes audio needs its scratch space before it starts, so it never allocates it on the way
+   numWorkers = MIN(numWorkers, kMaxWorkBuffers - kFirstWorkerWorkBuffers);
+   AllocateWorkBuffers(numWorkers);
+   mAudioGraphScheduler.Start(numWorkers, std::move(onWorkerStarted));
+}
+
+void AudioEngine::SetQueues(NoteOutputQueue* noteOutputQueue, ControlChangeQueue* controlChangeQueue)
+{
+   mNoteOutputQueue = noteOutputQueue;
+   mControlChangeQueue = controlChangeQueue;
+}
+
+void AudioEngine::SetSources(const std::vector<IAudioSource*>& sources, bool autoSuspend)
+{
+   AudioExecutionPlan* plan = new AudioExecutionPlan();
+   plan->Build(sources, autoSuspend, mExecutionPlan);
+   PublishExecutionPlan(plan);
+
+   //the audio thread never grows the arena, so top it up while we're off it
+   ChannelBufferArena::Get().Reserve();
+}
+
+void AudioEngine::ClearSources()
+{
+   PublishExecutionPlan(nullptr);
+}
+
+void AudioEngine::PublishExecutionPlan(AudioExecutionPlan* plan)
+{
+   AudioExecutionPlan* oldPlan = mExecutionPlan.exchange(plan);
+   if (oldPlan != nullptr)
+   {
+      std::lock_guard<std::mutex> lock(mRetiredExecutionPlansMutex);
+      mRetiredExecutionPlans.push_back(oldPlan);
+   }
+}
+
+void AudioEngine::FreeRetiredExecutionPlans()
+{
+   std::lock_guard<std::mutex> lock(mRetiredExecutionPlansMutex);
+   for (auto iter = mRetiredExecutionPlans.begin(); iter != mRetiredExecutionPlans.end();)
+   {
+      if (*iter != mExecutionPlanInUse)
+      {
+         delete *iter;
+         iter = mRetiredExecutionPlans.erase(iter);
+      }
+      else
+      {
+         ++iter;
+      }
+   }
+}
+
+bool AudioEngine::HasSources() const
+{
+   const AudioExecutionPlan* plan = mExecutionPlan;
+   return plan != nullptr && !plan->GetSources().empty();
+}
+
+void AudioEngine::GetCircularEdges(std::vector<std::pair<IAudioSource*, IAudioSource*>>& edges) const
+{
+   const AudioExecutionPlan* plan = mExecutionPlan;
+   if (plan != nullptr)
+      edges = plan->GetCircularEdges();
+   else
+      edges.clear();
+}
+
+void AudioEngine::ProcessQueues(double nextBufferTime)
+{
+   ChannelBufferArena::MarkAudioPathThread(); //per thread, a device restart can call us from a new one
+   BindWorkBuffers(kAudioThreadWorkBuffers);
+   if (mNoteOutputQueue != nullptr)
+      mNoteOutputQueue->Process();
+   if (mControlChangeQueue != nullptr)
+      mControlChangeQueue->Process(nextBufferTime);
+}
+
+void AudioEngine::ProcessBuffer()
+{
+   ChannelBufferArena::MarkAudioPathThread();
+   BindWorkBuffers(kAudioThreadWorkBuffers);
+   for (size_t i = 0; i < mOutputBuffers.size(); ++i)
+      Clear(mOutputBuffers[i], gBufferSize);
+
+   double elapsed = gInvSampleRateMs * gBufferSize;
+   gTime += elapsed;
+   UpdateAudioClock();
+   if (TheTransport != nullptr)
+      TheTransport->Advance(elapsed);
+
+   //process all audio
+   AudioExecutionPlan* plan;
+   do
+   {
+      plan = mExecutionPlan;
+      mExecutionPlanInUse = plan;
+   } while (plan != mExecutionPlan); //make sure it didn't get retired before we claimed it
+   if (plan != nullptr)
+   {
+      plan->ClearOrphanedBuffers();
+      if (!mAudioGraphScheduler.Process(*plan, gTime))
+         plan->Process(gTime);
+      if (Profiler::IsModuleTimingEnabled())
+         plan->UpdateCpuLoads();
+   }
+   mExecutionPlanInUse = nullptr;
+
+   mDeviceOutputBuffers = &mOutputRouting.Process(mOutputBuffers, gBufferSize);
+}
+
+void AudioEngine::ReadInput(const float* const* input, int bufferSize, int nChannels, int oversampling)
+{
+   assert(nChannels == (int)mInputBuffers.size());
+
+   for (int i = 0; i < nChannels; ++i)
+   {
+      if (oversampling == 1)
+      {
+         BufferCopy(mInputBuffers[i], input[i], bufferSize);
+      }
+      else
+      {
+         mInputOversamplers[i].SetFactor(oversampling);
+         BufferCopy(mInputBuffers[i], mInputOversamplers[i].Upsample(0, input[i], bufferSize), bufferSize * oversampling);
+      }
+   }
+}
+
+void AudioEngine::DownsampleOutput(int channel, float* output, int bufferSize, int oversampling)
+{
+   assert(channel >= 0 && channel < (int)mDeviceOutputBuffers->size());
+   mOutputOversamplers[channel].SetFactor(oversampling);
+   mOutputOversamplers[channel].Downsample(0, (*mDeviceOutputBuffers)[channel], output, bufferSize);
+}
+
+float* AudioEngine::GetInputBuffer(int channel)
+{
+   assert(channel >= 0 && channel < (int)mInputBuffers.size());
+   return mInputBuffers[channel];
+}
+
+float* AudioEngine::GetOutputBuffer(int channel)
+{
+   assert(channel >= 0 && channel < (int)mOutputBuffers.size());
+   return mOutputBuffers[channel];
+}
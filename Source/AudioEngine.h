@@ -0,0 +1,96 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioEngine.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+#include "AudioGraphScheduler.h"
+#include "OutputRouting.h"
+#include "Oversampler.h"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class AudioExecutionPlan;
+class IAudioSource;
+class NoteOutputQueue;
+class ControlChangeQueue;
+
+//the headless core of the audio path: the source list's execution plan, the io buffers and the per-buffer loop.
+//it has no gui or nanovg dependencies, so ModularSynth and the wasm bridge run audio through the same code.
+class AudioEngine
+{
+public:
+   AudioEngine() = default;
+   ~AudioEngine();
+
+   void InitIOBuffers(int inputChannelCount, int outputChannelCount);
+   void SetOutputRouting(std::vector<OutputRouting::Route> routes); //with the audio stopped, see OutputRouting
+   void SetQueues(NoteOutputQueue* noteOutputQueue, ControlChangeQueue* controlChangeQueue);
+   void StartWorkers(int numWorkers, std::function<void(int workerIndex)> onWorkerStarted = nullptr); //also sets up the work buffers, see AllocateWorkBuffers()
+   void StopWorkers() { mAudioGraphScheduler.Stop(); }
+
+   //main thread. the plan puts the sources in dependency order
+   void SetSources(const std::vector<IAudioSource*>& sources, bool autoSuspend = false); //see AudioExecutionPlan::Build()
+   void ClearSources();
+   void FreeRetiredExecutionPlans();
+   bool HasSources() const;
+   void GetCircularEdges(std::vector<std::pair<IAudioSource*, IAudioSource*>>& edges) const; //of the current plan, see AudioExecutionPlan::GetCircularEdges()
+
+   //audio thread
+   void ProcessQueues(double nextBufferTime);
+   void ProcessBuffer(); //advances the clock and transport by gBufferSize, runs the plan into the output buffers, and routes them to the device channels
+   void ReadInput(const float* const* input, int bufferSize, int nChannels, int oversampling);
+   //filters a device channel down to the device rate, when the whole engine runs oversampled
+   void DownsampleOutput(int channel, float* output, int bufferSize, int oversampling);
+
+   int GetNumInputChannels() const { return (int)mInputBuffers.size(); }
+   int GetNumOutputChannels() const { return (int)mOutputBuffers.size(); }
+   float* GetInputBuffer(int channel);
+   float* GetOutputBuffer(int channel);
+   const std::vector<float*>& GetInputBuffers() const { return mInputBuffers; }
+   const std::vector<float*>& GetOutputBuffers() const { return mOutputBuffers; }
+   const std::vector<float*>& GetDeviceOutputBuffers() const { return *mDeviceOutputBuffers; } //the output buffers after routing
+
+private:
+   void PublishExecutionPlan(AudioExecutionPlan* plan);
+
+   std::vector<float*> mInputBuffers;
+   std::vector<float*> mOutputBuffers;
+   std::vector<Oversampler> mInputOversamplers;
+   std::vector<Oversampler> mOutputOversamplers;
+   OutputRouting mOutputRouting;
+   const std::vector<float*>* mDeviceOutputBuffers{ &mOutputBuffers };
+   std::atomic<AudioExecutionPlan*> mExecutionPlan{ nullptr }; //swapped out whole when the graph changes, never modified once published
+   std::atomic<AudioExecutionPlan*> mExecutionPlanInUse{ nullptr }; //set by the audio thread while it's processing a plan, so it doesn't get freed out from under it
+   std::vector<AudioExecutionPlan*> mRetiredExecutionPlans;
+   std::mutex mRetiredExecutionPlansMutex;
+   AudioGraphScheduler mAudioGraphScheduler;
+   NoteOutputQueue* mNoteOutputQueue{ nullptr };
+   ControlChangeQueue* mControlChangeQueue{ nullptr };
+};
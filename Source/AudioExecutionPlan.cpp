@@ -0,0 +1,576 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioExecutionPlan.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "AudioExecutionPlan.h"
+#include "AudioFaultGuard.h"
+#include "IAudioSource.h"
+#include "IAudioReceiver.h"
+#include "INoteSource.h"
+#include "IPulseReceiver.h"
+#include "IModulator.h"
+#include "ChannelBuffer.h"
+#include "Profiler.h"
+#include "ProfilerTrace.h"
+#include "IClickable.h"
+#include "SidechainBus.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+void AudioExecutionPlan::Build(const std::vector<IAudioSource*>& sources, bool autoSuspend, const AudioExecutionPlan* previous)
+{
+   Clear();
+
+   for (auto* source : sources)
+   {
+      IAudioReceiver* receiver = dynamic_cast<IAudioReceiver*>(source);
+      bool canSleep = autoSuspend && receiver != nullptr && source->CanSleepWhenSilent() && !MustProcessSerially(source);
+      source->SetSleepInput(canSleep ? receiver->GetBuffer() : nullptr);
+      if (!canSleep || source->GetSleepState() == IAudioSource::SleepState::Unreachable)
+         source->SetSleepState(IAudioSource::SleepState::Awake);
+   }
+
+   std::unordered_map<IAudioSource*, int> indices;
+   for (int i = 0; i < (int)sources.size(); ++i)
+      indices[sources[i]] = i;
+
+   std::vector<std::vector<int>> dependents(sources.size());
+   std::vector<int> numDependencies(sources.size(), 0);
+   for (int i = 0; i < (int)sources.size(); ++i)
+   {
+      for (int j = 0; j < sources[i]->GetNumTargets(); ++j)
+      {
+         IAudioReceiver* target = sources[i]->GetTarget(j);
+         if (target == nullptr)
+            continue;
+
+         auto targetIndex = indices.find(dynamic_cast<IAudioSource*>(target));
+         if (targetIndex != indices.end())
+         {
+            dependents[i].push_back(targetIndex->second);
+            ++numDependencies[targetIndex->second];
+         }
+         else if (!VectorContains(target->GetBuffer(), mOrphanedBuffers))
+         {
+            mOrphanedBuffers.push_back(target->GetBuffer());
+         }
+      }
+   }
+
+   //sidechain consumers read their producer's buffer in place, so they have to come after it, the same as if it were patched into them
+   std::vector<std::pair<IAudioSource*, IAudioSource*>> sidechains;
+   SidechainBus::Get().GetDependencies(sidechains);
+   for (const auto& sidechain : sidechains)
+   {
+      auto producerIndex = indices.find(sidechain.first);
+      auto consumerIndex = indices.find(sidechain.second);
+      if (producerIndex == indices.end() || consumerIndex == indices.end())
+         continue;
+      dependents[producerIndex->second].push_back(consumerIndex->second);
+      ++numDependencies[consumerIndex->second];
+      mSideDependencies.push_back(sidechain);
+   }
+
+   //audio rate modulators fill their cv block as they process, so the modules they modulate should come after them.
+   //unlike a cable, that's only a preference: modulating something upstream of yourself is normal, and just reads last buffer's block
+   std::vector<IAudioSource*> consumers;
+   for (int i = 0; i < (int)sources.size(); ++i)
+   {
+      IModulator* modulator = dynamic_cast<IModulator*>(sources[i]);
+      if (modulator == nullptr)
+         continue;
+      consumers.clear();
+      modulator->GetCVConsumers(consumers);
+      for (auto* consumer : consumers)
+      {
+         auto consumerIndex = indices.find(consumer);
+         if (consumerIndex == indices.end() || consumerIndex->second == i || Reaches(dependents, consumerIndex->second, i))
+            continue;
+         dependents[i].push_back(consumerIndex->second);
+         ++numDependencies[consumerIndex->second];
+         mSideDependencies.push_back(std::make_pair(sources[i], consumer));
+      }
+   }
+
+   //topological sort. among sources that are ready at the same time, keep the incoming order, so the plan is stable
+   std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+   for (int i = 0; i < (int)sources.size(); ++i)
+   {
+      if (numDependencies[i] == 0)
+         ready.push(i);
+   }
+
+   std::vector<bool> added(sources.size(), false);
+   while (!ready.empty())
+   {
+      int index = ready.top();
+      ready.pop();
+      mSources.push_back(sources[index]);
+      added[index] = true;
+      for (int dependent : dependents[index])
+      {
+         if (--numDependencies[dependent] == 0)
+            ready.push(dependent);
+      }
+   }
+
+   if (mSources.size() < sources.size()) //circular dependency, don't lose the rest of the sources
+   {
+      mHasCircularDependency = true;
+
+      //the rest are in cycles or downstream of one. put each cycle after what feeds it, and find the edges that close it
+      std::vector<int> components;
+      FindComponents(dependents, components);
+      std::vector<int> rest;
+      for (int i = 0; i < (int)sources.size(); ++i)
+      {
+         if (!added[i])
+            rest.push_back(i);
+      }
+      std::sort(rest.begin(), rest.end(), [&components](int a, int b)
+                {
+                   return components[a] != components[b] ? components[a] > components[b] : a < b;
+                });
+      for (int index : rest)
+      {
+         mSources.push_back(sources[index]);
+         for (int dependent : dependents[index])
+         {
+            if (components[dependent] == components[index])
+               mCircularEdges.push_back(std::make_pair(sources[index], sources[dependent]));
+         }
+      }
+   }
+   else
+   {
+      if (autoSuspend)
+         SuspendUnreachableSources();
+      BuildLevels();
+      BuildDelayCompensation(previous);
+   }
+}
+
+//static
+bool AudioExecutionPlan::Reaches(const std::vector<std::vector<int>>& dependents, int from, int to)
+{
+   std::vector<bool> visited(dependents.size(), false);
+   std::vector<int> stack{ from };
+   visited[from] = true;
+   while (!stack.empty())
+   {
+      int node = stack.back();
+      stack.pop_back();
+      if (node == to)
+         return true;
+      for (int dependent : dependents[node])
+      {
+         if (!visited[dependent])
+         {
+            visited[dependent] = true;
+            stack.push_back(dependent);
+         }
+      }
+   }
+   return false;
+}
+
+//tarjan's strongly connected components, in a single pass over the graph. sources that are in a cycle together share a component.
+//a component is numbered after every component downstream of it, so higher numbers go first in the plan
+//static
+void AudioExecutionPlan::FindComponents(const std::vector<std::vector<int>>& dependents, std::vector<int>& components)
+{
+   int numNodes = (int)dependents.size();
+   components.assign(numNodes, -1);
+   std::vector<int> visitOrder(numNodes, -1);
+   std::vector<int> lowLink(numNodes, 0);
+   std::vector<bool> onStack(numNodes, false);
+   std::vector<int> stack;
+   std::vector<std::pair<int, int>> path; //node, and the next of its dependents to visit. iterative, so long chains can't overflow the stack
+   int numVisited = 0;
+   int numComponents = 0;
+
+   for (int start = 0; start < numNodes; ++start)
+   {
+      if (visitOrder[start] != -1)
+         continue;
+
+      visitOrder[start] = lowLink[start] = numVisited++;
+      stack.push_back(start);
+      onStack[start] = true;
+      path.push_back(std::make_pair(start, 0));
+      while (!path.empty())
+      {
+         int node = path.back().first;
+         int next = path.back().second;
+         if (next < (int)dependents[node].size())
+         {
+            ++path.back().second;
+            int dependent = dependents[node][next];
+            if (visitOrder[dependent] == -1)
+            {
+               visitOrder[dependent] = lowLink[dependent] = numVisited++;
+               stack.push_back(dependent);
+               onStack[dependent] = true;
+               path.push_back(std::make_pair(dependent, 0));
+            }
+            else if (onStack[dependent])
+            {
+               lowLink[node] = MIN(lowLink[node], visitOrder[dependent]);
+            }
+            continue;
+         }
+
+         path.pop_back();
+         if (!path.empty())
+            lowLink[path.back().first] = MIN(lowLink[path.back().first], lowLink[node]);
+
+         if (lowLink[node] == visitOrder[node])
+         {
+            int member;
+            do
+            {
+               member = stack.back();
+               stack.pop_back();
+               onStack[member] = false;
+               components[member] = numComponents;
+            } while (member != node);
+            ++numComponents;
+         }
+      }
+   }
+}
+
+void AudioExecutionPlan::SuspendUnreachableSources()
+{
+   //walk backwards from the end of the chains, so every target has been decided on before the sources feeding it
+   std::unordered_map<IAudioSource*, bool> reachable;
+   for (auto iter = mSources.rbegin(); iter != mSources.rend(); ++iter)
+   {
+      IAudioSource* source = *iter;
+      bool isReachable = source->IsAudioSink() || MustProcessSerially(source);
+      for (int i = 0; i < source->GetNumTargets() && !isReachable; ++i)
+      {
+         IAudioReceiver* target = source->GetTarget(i);
+         if (target == nullptr)
+            continue;
+         auto targetReachable = reachable.find(dynamic_cast<IAudioSource*>(target));
+         //a receiver that isn't a source in the graph does something with the audio we can't see, so it counts
+         isReachable = targetReachable == reachable.end() || targetReachable->second;
+      }
+      for (const auto& dependency : mSideDependencies) //a sidechain producer or a modulator is heard through its consumers
+      {
+         if (dependency.first == source && reachable[dependency.second])
+            isReachable = true;
+      }
+      reachable[source] = isReachable;
+   }
+
+   std::vector<IAudioSource*> kept;
+   for (auto* source : mSources)
+   {
+      if (reachable[source])
+      {
+         kept.push_back(source);
+         continue;
+      }
+
+      mSuspended.push_back(source);
+      source->SetSleepState(IAudioSource::SleepState::Unreachable);
+      //nothing will Process() and reset its input now, so it gets cleared with the orphans, in case something still writes to it
+      IAudioReceiver* receiver = dynamic_cast<IAudioReceiver*>(source);
+      if (receiver != nullptr && !VectorContains(receiver->GetBuffer(), mOrphanedBuffers))
+         mOrphanedBuffers.push_back(receiver->GetBuffer());
+   }
+   mSources = kept;
+}
+
+void AudioExecutionPlan::Clear()
+{
+   mSources.clear();
+   mOrphanedBuffers.clear();
+   mLevels.clear();
+   mSuspended.clear();
+   mSideDependencies.clear();
+   mHasCircularDependency = false;
+   mCircularEdges.clear();
+   mDelayCompensation.clear();
+}
+
+bool AudioExecutionPlan::MustProcessSerially(IAudioSource* source)
+{
+   if (source->RequiresSerialProcessing())
+      return true;
+
+   //these can reach into other modules outside of the audio graph (playing notes, firing pulses, driving sliders) while they process
+   return dynamic_cast<INoteSource*>(source) != nullptr ||
+          dynamic_cast<IPulseSource*>(source) != nullptr ||
+          dynamic_cast<IModulator*>(source) != nullptr;
+}
+
+void AudioExecutionPlan::BuildLevels()
+{
+   std::unordered_map<IAudioReceiver*, int> lastWriterLevel;
+   std::unordered_map<IAudioSource*, int> sourceLevel;
+   int lastSerialLevel = 0;
+   for (auto* source : mSources)
+   {
+      int level = 0;
+
+      //must come after the sidechain producers and modulators we read from
+      for (const auto& dependency : mSideDependencies)
+      {
+         if (dependency.second != source)
+            continue;
+         auto producer = sourceLevel.find(dependency.first);
+         if (producer != sourceLevel.end())
+            level = MAX(level, producer->second + 1);
+      }
+
+      //must come after everything that writes into us
+      auto writer = lastWriterLevel.find(dynamic_cast<IAudioReceiver*>(source));
+      if (writer != lastWriterLevel.end())
+         level = MAX(level, writer->second + 1);
+
+      //must come after anything else that writes into the same target, so the target's buffer is summed in the same order as processing one after another
+      for (int i = 0; i < source->GetNumTargets(); ++i)
+      {
+         IAudioReceiver* target = source->GetTarget(i);
+         if (target == nullptr)
+            continue;
+         auto otherWriter = lastWriterLevel.find(target);
+         if (otherWriter != lastWriterLevel.end())
+            level = MAX(level, otherWriter->second + 1);
+      }
+
+      bool serial = MustProcessSerially(source);
+      if (serial)
+         level = MAX(level, lastSerialLevel);
+
+      if (level >= (int)mLevels.size())
+         mLevels.resize(level + 1);
+
+      if (serial)
+      {
+         mLevels[level].mSerial.push_back(source);
+         lastSerialLevel = level;
+      }
+      else
+      {
+         mLevels[level].mParallel.push_back(source);
+      }
+      sourceLevel[source] = level;
+
+      for (int i = 0; i < source->GetNumTargets(); ++i)
+      {
+         IAudioReceiver* target = source->GetTarget(i);
+         if (target != nullptr)
+            lastWriterLevel[target] = MAX(lastWriterLevel[target], level);
+      }
+   }
+}
+
+void AudioExecutionPlan::BuildDelayCompensation(const AudioExecutionPlan* previous)
+{
+   //mSources is in dependency order, so everything writing into a receiver has been seen by the time we get to it
+   std::unordered_map<IAudioReceiver*, int> inputLatency;
+   std::unordered_map<IAudioSource*, int> outputLatency;
+   int maxLatency = 0;
+   for (auto* source : mSources)
+   {
+      auto input = inputLatency.find(dynamic_cast<IAudioReceiver*>(source));
+      int latency = (input != inputLatency.end() ? input->second : 0) + MAX(0, source->GetLatencySamples());
+      outputLatency[source] = latency;
+      maxLatency = MAX(maxLatency, latency);
+      for (int i = 0; i < source->GetNumTargets(); ++i)
+      {
+         IAudioReceiver* target = source->GetTarget(i);
+         if (target != nullptr)
+            inputLatency[target] = MAX(inputLatency[target], latency);
+      }
+   }
+
+   if (maxLatency == 0)
+      return;
+
+   const int kMaxDelaySamples = (int)gSampleRate * 2; //past that, it's more likely a plugin reporting nonsense than a real latency
+   for (auto* source : mSources)
+   {
+      for (int i = 0; i < source->GetNumTargets(); ++i)
+      {
+         IAudioReceiver* target = source->GetTarget(i);
+         if (target == nullptr)
+            continue;
+         int delay = MIN(inputLatency[target] - outputLatency[source], kMaxDelaySamples);
+         if (delay <= 0)
+            continue;
+
+         ChannelBuffer* buffer = target->GetBuffer();
+         DelayCompensation compensation;
+         compensation.mTarget = target;
+         compensation.mDelaySamples = delay;
+
+         //keep the same lines if this edge hasn't changed, otherwise every repatch would drop what the compensated branches had in flight
+         if (previous != nullptr && previous != this)
+         {
+            auto previousCompensation = previous->mDelayCompensation.find(source);
+            if (previousCompensation != previous->mDelayCompensation.end())
+            {
+               for (const auto& previousDelay : previousCompensation->second)
+               {
+                  if (previousDelay.mTarget == target && previousDelay.mDelaySamples == delay &&
+                      previousDelay.mLines->mLines.size() == (size_t)buffer->NumTotalChannels() &&
+                      !previousDelay.mLines->mEarlierWriters.empty() && previousDelay.mLines->mEarlierWriters[0].size() == (size_t)buffer->BufferSize())
+                  {
+                     compensation.mLines = previousDelay.mLines;
+                     break;
+                  }
+               }
+            }
+         }
+
+         if (compensation.mLines == nullptr)
+         {
+            compensation.mLines = std::make_shared<DelayCompensation::Lines>();
+            compensation.mLines->mLines.assign(buffer->NumTotalChannels(), std::vector<float>(delay, 0));
+            compensation.mLines->mEarlierWriters.assign(buffer->NumTotalChannels(), std::vector<float>(buffer->BufferSize(), 0));
+         }
+         mDelayCompensation[source].push_back(std::move(compensation));
+      }
+   }
+}
+
+void AudioExecutionPlan::DelayCompensation::Begin() const
+{
+   //set aside what's already been summed in, so that the target only holds what this source writes
+   ChannelBuffer* buffer = mTarget->GetBuffer();
+   auto& earlierWriters = mLines->mEarlierWriters;
+   mLines->mNumEarlierWriterChannels = MIN(buffer->NumActiveChannels(), (int)earlierWriters.size());
+   for (int ch = 0; ch < mLines->mNumEarlierWriterChannels; ++ch)
+      BufferCopy(earlierWriters[ch].data(), buffer->GetChannel(ch), (int)earlierWriters[ch].size());
+   buffer->Clear();
+}
+
+void AudioExecutionPlan::DelayCompensation::End() const
+{
+   ChannelBuffer* buffer = mTarget->GetBuffer();
+   auto& lines = *mLines;
+   int bufferSize = MIN(buffer->BufferSize(), (int)lines.mEarlierWriters[0].size());
+   int numChannels = MIN(buffer->NumActiveChannels(), (int)lines.mLines.size());
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      float* data = buffer->GetChannel(ch);
+      float* line = lines.mLines[ch].data();
+      int position = lines.mPosition;
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         float delayed = line[position];
+         line[position] = data[i];
+         data[i] = delayed;
+         if (++position == mDelaySamples)
+            position = 0;
+      }
+   }
+   lines.mPosition = (lines.mPosition + bufferSize) % mDelaySamples;
+
+   buffer->SetNumActiveChannels(MAX(numChannels, lines.mNumEarlierWriterChannels));
+   for (int ch = 0; ch < lines.mNumEarlierWriterChannels; ++ch)
+      Add(buffer->GetChannel(ch), lines.mEarlierWriters[ch].data(), bufferSize);
+}
+
+void AudioExecutionPlan::Process(double time) const
+{
+   for (auto* source : mSources)
+      ProcessSource(source, time);
+}
+
+void AudioExecutionPlan::ProcessSource(IAudioSource* source, double time) const
+{
+   if (!mDelayCompensation.empty())
+   {
+      auto compensation = mDelayCompensation.find(source);
+      if (compensation != mDelayCompensation.end()) //still run the delay lines while it's asleep, so their tails play out
+      {
+         for (auto& delay : compensation->second)
+            delay.Begin();
+         RunSource(source, time);
+         for (auto& delay : compensation->second)
+            delay.End();
+         return;
+      }
+   }
+
+   RunSource(source, time);
+}
+
+//static
+void AudioExecutionPlan::RunSource(IAudioSource* source, double time)
+{
+   if (source->UpdateSleep())
+      return;
+
+   bool guardFaults = AudioFaultGuard::IsEnabled();
+   if (guardFaults && AudioFaultGuard::IsMuted(source, time))
+      return;
+
+   if (ProfilerTrace::IsRecording())
+   {
+      //the cast is only paid for while recording a trace
+      auto* clickable = dynamic_cast<IClickable*>(source);
+      ProfilerTrace::Scope trace(clickable ? clickable->Name() : "<audio source>", kTraceCategory_Process);
+      int64_t start = Profiler::GetTicks();
+      source->Process(time);
+      if (Profiler::IsModuleTimingEnabled())
+         source->AddProcessTicks(Profiler::GetTicks() - start);
+   }
+   else if (Profiler::IsModuleTimingEnabled())
+   {
+      int64_t start = Profiler::GetTicks();
+      source->Process(time);
+      source->AddProcessTicks(Profiler::GetTicks() - start);
+   }
+   else
+   {
+      source->Process(time);
+   }
+
+   if (guardFaults)
+      AudioFaultGuard::CheckOutput(source, time);
+}
+
+void AudioExecutionPlan::UpdateCpuLoads() const
+{
+   double invTicksPerBuffer = 1.0 / Profiler::GetTicksPerBuffer();
+   for (auto* source : mSources)
+      source->UpdateCpuLoad(invTicksPerBuffer);
+}
+
+void AudioExecutionPlan::ClearOrphanedBuffers() const
+{
+   for (auto* buffer : mOrphanedBuffers)
+      buffer->Clear();
+}
@@ -0,0 +1,106 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioExecutionPlan.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class IAudioSource;
+class IAudioReceiver;
+class ChannelBuffer;
+
+//a flattened snapshot of the audio graph, rebuilt whenever modules are added/removed or audio cables are repatched,
+//so the audio thread only has to walk arrays
+class AudioExecutionPlan
+{
+public:
+   struct Level
+   {
+      std::vector<IAudioSource*> mParallel;
+      std::vector<IAudioSource*> mSerial; //processed alone on the audio thread, after mParallel
+   };
+
+   //with autoSuspend, sources that can't be heard are left out, and sources that allow it sleep through silence.
+   //delay lines for edges that are unchanged from previous (same source, target and delay) are carried over, so what's in them keeps playing
+   void Build(const std::vector<IAudioSource*>& sources, bool autoSuspend = false, const AudioExecutionPlan* previous = nullptr);
+   void Clear();
+
+   //audio thread
+   void Process(double time) const;
+   void ClearOrphanedBuffers() const;
+   void UpdateCpuLoads() const;
+
+   //processes one source, timing it if per-module cpu accounting is on, and delaying what it writes where delay compensation needs it
+   void ProcessSource(IAudioSource* source, double time) const;
+
+   const std::vector<IAudioSource*>& GetSources() const { return mSources; }
+   const std::vector<Level>& GetLevels() const { return mLevels; }
+   const std::vector<IAudioSource*>& GetSuspended() const { return mSuspended; }
+   bool HasCircularDependency() const { return mHasCircularDependency; }
+   const std::vector<std::pair<IAudioSource*, IAudioSource*>>& GetCircularEdges() const { return mCircularEdges; } //from, to. every edge that's part of a cycle
+   bool CanProcessInParallel() const { return !mHasCircularDependency && !mLevels.empty(); }
+
+private:
+   //plugin delay compensation. when sources with different latencies (see IAudioSource::GetLatencySamples()) write into the same receiver,
+   //the ones that arrive early have what they write into it held back until the others catch up
+   struct DelayCompensation
+   {
+      struct Lines
+      {
+         int mPosition{ 0 };
+         std::vector<std::vector<float>> mLines; //per channel, mDelaySamples long
+         std::vector<std::vector<float>> mEarlierWriters; //what the sources before us had already summed into the target this buffer
+         int mNumEarlierWriterChannels{ 0 };
+      };
+
+      void Begin() const;
+      void End() const;
+
+      IAudioReceiver* mTarget{ nullptr };
+      int mDelaySamples{ 0 };
+      std::shared_ptr<Lines> mLines; //shared with the plans before and after this one while the edge stays the same. only one plan runs at a time
+   };
+
+   void BuildLevels();
+   void BuildDelayCompensation(const AudioExecutionPlan* previous);
+   void SuspendUnreachableSources();
+   static bool Reaches(const std::vector<std::vector<int>>& dependents, int from, int to);
+   static void FindComponents(const std::vector<std::vector<int>>& dependents, std::vector<int>& components);
+   static bool MustProcessSerially(IAudioSource* source);
+   static void RunSource(IAudioSource* source, double time);
+
+   std::vector<IAudioSource*> mSources; //in dependency order
+   std::vector<ChannelBuffer*> mOrphanedBuffers; //inputs that get written to, but don't belong to any source that would consume and reset them
+   std::vector<Level> mLevels; //groups of sources that don't depend on each other
+   std::vector<IAudioSource*> mSuspended; //left out of mSources, since nothing they output is heard
+   std::vector<std::pair<IAudioSource*, IAudioSource*>> mSideDependencies; //producer, consumer, for sidechains (see SidechainBus) and audio rate modulation (see IModulator::GetCVBlock())
+   bool mHasCircularDependency{ false };
+   std::vector<std::pair<IAudioSource*, IAudioSource*>> mCircularEdges;
+   std::unordered_map<IAudioSource*, std::vector<DelayCompensation>> mDelayCompensation; //the delay lines' state is the only thing that changes once published
+};
@@ -0,0 +1,169 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioFaultGuard.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "AudioFaultGuard.h"
+#include "ChannelBuffer.h"
+#include "IAudioReceiver.h"
+#include "IAudioSource.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace
+{
+   //with the sign bit off: at or above this is an inf or a nan, and anything between 0 and kSmallestNormal is a denormal
+   const uint32_t kInfinityBits = 0x7f800000;
+   const uint32_t kSmallestNormalBits = 0x00800000;
+   const uint32_t kAbsMask = 0x7fffffff;
+}
+
+bool AudioFaultGuard::sEnabled = false;
+
+//static
+AudioFaultGuard::Result AudioFaultGuard::Scan(const float* buffer, int length)
+{
+   bool nonFinite = false;
+   bool denormal = false;
+   int i = 0;
+#if defined(__wasm_simd128__)
+   v128_t nonFinite4 = wasm_i32x4_splat(0);
+   v128_t denormal4 = wasm_i32x4_splat(0);
+   const v128_t absMask = wasm_i32x4_splat(kAbsMask);
+   const v128_t infinity = wasm_i32x4_splat(kInfinityBits);
+   const v128_t smallestNormal = wasm_i32x4_splat(kSmallestNormalBits - 1);
+   const v128_t one = wasm_i32x4_splat(1);
+   for (; i + 4 <= length; i += 4)
+   {
+      v128_t bits = wasm_v128_and(wasm_v128_load(buffer + i), absMask);
+      nonFinite4 = wasm_v128_or(nonFinite4, wasm_u32x4_ge(bits, infinity));
+      denormal4 = wasm_v128_or(denormal4, wasm_u32x4_lt(wasm_i32x4_sub(bits, one), smallestNormal)); //zero wraps around to the top
+   }
+   nonFinite = wasm_v128_any_true(nonFinite4);
+   denormal = wasm_v128_any_true(denormal4);
+#else
+   //four independent lanes, so the compiler is free to vectorize it
+   uint32_t nonFiniteLanes[4]{};
+   uint32_t denormalLanes[4]{};
+   for (; i + 4 <= length; i += 4)
+   {
+      uint32_t bits[4];
+      memcpy(bits, buffer + i, sizeof(bits));
+      for (int lane = 0; lane < 4; ++lane)
+      {
+         uint32_t abs = bits[lane] & kAbsMask;
+         nonFiniteLanes[lane] |= abs >= kInfinityBits;
+         denormalLanes[lane] |= abs - 1 < kSmallestNormalBits - 1;
+      }
+   }
+   nonFinite = (nonFiniteLanes[0] | nonFiniteLanes[1] | nonFiniteLanes[2] | nonFiniteLanes[3]) != 0;
+   denormal = (denormalLanes[0] | denormalLanes[1] | denormalLanes[2] | denormalLanes[3]) != 0;
+#endif
+   for (; i < length; ++i)
+   {
+      uint32_t abs;
+      memcpy(&abs, buffer + i, sizeof(abs));
+      abs &= kAbsMask;
+      nonFinite |= abs >= kInfinityBits;
+      denormal |= abs - 1 < kSmallestNormalBits - 1;
+   }
+
+   if (nonFinite)
+      return Result::NonFinite;
+   if (denormal)
+      return Result::Denormal;
+   return Result::Clean;
+}
+
+//static
+void AudioFaultGuard::FlushDenormals(float* buffer, int length)
+{
+   for (int i = 0; i < length; ++i)
+   {
+      uint32_t bits;
+      memcpy(&bits, buffer + i, sizeof(bits));
+      if ((bits & kAbsMask) < kSmallestNormalBits)
+         buffer[i] = 0;
+   }
+}
+
+//static
+bool AudioFaultGuard::IsMuted(IAudioSource* source, double time)
+{
+   if (time - source->GetAudioFaultTime() >= kMuteMs)
+      return false;
+
+   //it isn't going to clear its input while it's muted, so do that for it, or the upstream modules would keep adding to it
+   if (auto* receiver = dynamic_cast<IAudioReceiver*>(source))
+      receiver->GetBuffer()->Reset();
+   return true;
+}
+
+//static
+void AudioFaultGuard::CheckOutput(IAudioSource* source, double time)
+{
+   bool faulted = false;
+   for (int i = 0; i < source->GetNumTargets(); ++i)
+   {
+      IAudioReceiver* target = source->GetTarget(i);
+      if (target == nullptr)
+         continue;
+      ChannelBuffer* buffer = target->GetBuffer();
+      int length = MIN(buffer->BufferSize(), gBufferSize);
+      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+      {
+         if (buffer->IsSilent(ch))
+            continue;
+         const float* channel = buffer->GetChannelReadOnly(ch);
+         if (channel == nullptr)
+            continue;
+         Result result = Scan(channel, length);
+         if (result == Result::NonFinite)
+            faulted = true;
+         else if (result == Result::Denormal)
+            FlushDenormals(buffer->GetChannel(ch), length);
+      }
+   }
+
+   if (!faulted)
+      return;
+
+   //writers into the same target all come before or after us, never alongside, so the rest of what's in there is from
+   //modules that were already checked. it's only a buffer's worth, and it leaves nothing downstream to add a nan to
+   for (int i = 0; i < source->GetNumTargets(); ++i)
+   {
+      if (IAudioReceiver* target = source->GetTarget(i))
+         target->GetBuffer()->Clear();
+   }
+   if (auto* receiver = dynamic_cast<IAudioReceiver*>(source))
+      receiver->GetBuffer()->Reset();
+   source->GetVizBuffer()->ClearBuffer();
+   source->ResetAudioState();
+   source->OnAudioFault(time);
+}
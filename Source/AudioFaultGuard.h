@@ -0,0 +1,59 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioFaultGuard.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class IAudioSource;
+
+//checks what each module wrote into its targets, right after its Process(), for the guard_audio_faults pref.
+//denormals get flushed to zero where they are. a nan or an inf mutes the module's output for that buffer, resets the module
+//(see IAudioSource::ResetAudioState()) and keeps it muted for kMuteMs, so one blown up filter doesn't take the rest of the
+//patch down with it. the scan only looks at the bits, four samples at a time, and skips silent channels
+class AudioFaultGuard
+{
+public:
+   enum class Result
+   {
+      Clean,
+      Denormal,
+      NonFinite //nan or inf, whether or not there are denormals too
+   };
+
+   static Result Scan(const float* buffer, int length);
+   static void FlushDenormals(float* buffer, int length);
+
+   static void UpdateEnabled(bool enabled) { sEnabled = enabled; } //audio thread, at the start of each buffer
+   static bool IsEnabled() { return sEnabled; }
+
+   //audio thread (or a graph worker), around source->Process()
+   static bool IsMuted(IAudioSource* source, double time); //if so, skip it
+   static void CheckOutput(IAudioSource* source, double time);
+
+   static constexpr double kMuteMs = 1000;
+
+private:
+   static bool sEnabled;
+};
@@ -0,0 +1,227 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioGraphScheduler.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "AudioGraphScheduler.h"
+#include "AudioExecutionPlan.h"
+#include "ChannelBufferArena.h"
+#include "IAudioSource.h"
+#include "SynthGlobals.h"
+
+#include "juce_audio_basics/juce_audio_basics.h"
+
+#if defined(__EMSCRIPTEN_WASM_WORKERS__)
+#include <emscripten/atomic.h>
+#include <emscripten/threading.h>
+#endif
+
+AudioGraphScheduler::~AudioGraphScheduler()
+{
+   Stop();
+}
+
+void AudioGraphScheduler::Start(int numWorkers, std::function<void(int workerIndex)> onWorkerStarted)
+{
+   Stop();
+
+   mQuit = false;
+   mOnWorkerStarted = std::move(onWorkerStarted);
+#if defined(__EMSCRIPTEN_WASM_WORKERS__)
+   //without cross-origin isolation there's no SharedArrayBuffer to share with workers, so stay single-threaded and let Process() refuse the plans
+   if (!emscripten_has_threading_support())
+      return;
+
+   for (int i = 0; i < numWorkers; ++i)
+   {
+      emscripten_wasm_worker_t worker = emscripten_malloc_wasm_worker(kWasmWorkerStackSize);
+      if (worker == 0)
+         break;
+      emscripten_wasm_worker_post_function_vii(worker, &AudioGraphScheduler::WasmWorkerMain, (int)(intptr_t)this, i);
+      mWorkers.push_back(worker);
+   }
+#else
+   for (int i = 0; i < numWorkers; ++i)
+   {
+      mWorkers.emplace_back([this, i]
+                            {
+                               if (mOnWorkerStarted)
+                                  mOnWorkerStarted(i);
+                               BindWorkBuffers(kFirstWorkerWorkBuffers + i);
+                               WorkerThreadLoop();
+                            });
+   }
+#endif
+}
+
+void AudioGraphScheduler::Stop()
+{
+   if (mWorkers.empty())
+      return;
+
+   SetAndWakeWorkers(mQuit);
+#if defined(__EMSCRIPTEN_WASM_WORKERS__)
+   //wasm workers can't be joined. wait for the ones that started to leave their loop, then terminate them all, including any that never got to run
+   while (mRunningWorkers > 0)
+      std::this_thread::yield();
+   for (auto worker : mWorkers)
+      emscripten_terminate_wasm_worker(worker);
+#else
+   for (auto& worker : mWorkers)
+      worker.join();
+#endif
+   mWorkers.clear();
+}
+
+void AudioGraphScheduler::SetAndWakeWorkers(std::atomic<bool>& flag)
+{
+#if defined(__EMSCRIPTEN_WASM_WORKERS__)
+   flag = true;
+   ++mWakeCounter;
+   emscripten_atomic_notify(&mWakeCounter, EMSCRIPTEN_NOTIFY_ALL_WAITERS);
+#else
+   {
+      std::lock_guard<std::mutex> lock(mWakeMutex);
+      flag = true;
+   }
+   mWakeCondition.notify_all();
+#endif
+}
+
+void AudioGraphScheduler::WaitForWorkers()
+{
+   while (mBusyWorkers > 0)
+      std::this_thread::yield();
+}
+
+bool AudioGraphScheduler::Process(const AudioExecutionPlan& plan, double time)
+{
+   if (!IsRunning() || !plan.CanProcessInParallel() || plan.GetLevels().size() >= kNoLevel)
+      return false;
+
+   mPlan = &plan;
+   mJobTime = time;
+   SetAndWakeWorkers(mBufferActive);
+
+   const auto& levels = plan.GetLevels();
+   for (size_t i = 0; i < levels.size(); ++i)
+   {
+      const auto& level = levels[i];
+
+      if (level.mParallel.size() == 1)
+      {
+         plan.ProcessSource(level.mParallel[0], time);
+      }
+      else if (!level.mParallel.empty())
+      {
+         ++mGeneration;
+         mJobsRemaining = (int)level.mParallel.size();
+         mJobWord.store(MakeJobWord(mGeneration, (uint32_t)i, 0));
+
+         RunJobs();
+         while (mJobsRemaining > 0)
+            std::this_thread::yield();
+
+         mJobWord.store(MakeJobWord(mGeneration, kNoLevel, 0));
+      }
+
+      for (auto* source : level.mSerial)
+         plan.ProcessSource(source, time);
+   }
+
+   mBufferActive = false;
+   WaitForWorkers(); //so no worker is still holding on to the plan once we return, and the caller is free to retire it
+
+   return true;
+}
+
+bool AudioGraphScheduler::RunJobs()
+{
+   bool ranAny = false;
+   uint64_t word = mJobWord.load();
+   while (true)
+   {
+      uint32_t level = GetJobLevel(word);
+      if (level == kNoLevel)
+         break;
+      const auto& jobs = mPlan.load()->GetLevels()[level].mParallel;
+      uint32_t index = GetJobIndex(word);
+      if (index >= jobs.size())
+         break;
+
+      if (mJobWord.compare_exchange_weak(word, word + 1))
+      {
+         mPlan.load()->ProcessSource(jobs[index], mJobTime);
+         --mJobsRemaining;
+         ranAny = true;
+         word = mJobWord.load();
+      }
+   }
+   return ranAny;
+}
+
+thread_local bool AudioGraphScheduler::sIsWorkerThread = false;
+
+#if defined(__EMSCRIPTEN_WASM_WORKERS__)
+void AudioGraphScheduler::WasmWorkerMain(int scheduler, int workerIndex)
+{
+   auto* self = reinterpret_cast<AudioGraphScheduler*>((intptr_t)scheduler);
+   ++self->mRunningWorkers;
+   BindWorkBuffers(kFirstWorkerWorkBuffers + workerIndex);
+   self->WorkerThreadLoop();
+   --self->mRunningWorkers;
+}
+#endif
+
+void AudioGraphScheduler::WorkerThreadLoop()
+{
+   juce::FloatVectorOperations::disableDenormalisedNumberSupport();
+   sIsWorkerThread = true;
+   ChannelBufferArena::MarkAudioPathThread();
+
+   while (!mQuit)
+   {
+      if (!mBufferActive)
+      {
+#if defined(__EMSCRIPTEN_WASM_WORKERS__)
+         //if the counter moves after we read it, the wait returns right away, so a wake-up can't be missed
+         uint32_t wakeCounter = mWakeCounter.load();
+         if (!mBufferActive && !mQuit)
+            emscripten_atomic_wait_u32(&mWakeCounter, wakeCounter, ATOMICS_WAIT_DURATION_INFINITE);
+#else
+         std::unique_lock<std::mutex> lock(mWakeMutex);
+         mWakeCondition.wait(lock, [this]
+                             { return mBufferActive || mQuit; });
+#endif
+         continue;
+      }
+
+      ++mBusyWorkers;
+      bool ranAny = RunJobs();
+      --mBusyWorkers;
+
+      if (!ranAny)
+         std::this_thread::yield();
+   }
+}
@@ -0,0 +1,104 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioGraphScheduler.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__EMSCRIPTEN_WASM_WORKERS__)
+#include <emscripten/wasm_worker.h>
+#endif
+
+class AudioExecutionPlan;
+
+//processes an AudioExecutionPlan across a pool of worker threads, one level at a time.
+//nothing in a level depends on anything else in that level, and sources that write into the same receiver
+//are kept in order, so the output matches processing the plan's sources one after another on the audio thread.
+//in the browser the workers are wasm workers, parked with Atomics.wait between buffers, since the audio thread is an AudioWorklet that can't use std::thread.
+class AudioGraphScheduler
+{
+public:
+   AudioGraphScheduler() = default;
+   ~AudioGraphScheduler();
+
+   //onWorkerStarted runs on each worker before it takes any jobs, with the worker's index, to set its priority and affinity.
+   //wasm workers don't call it, the browser doesn't let them change either
+   void Start(int numWorkers, std::function<void(int workerIndex)> onWorkerStarted = nullptr);
+   void Stop();
+   bool IsRunning() const { return !mWorkers.empty(); }
+   static bool IsWorkerThread() { return sIsWorkerThread; }
+
+   //call before modifying a plan that has been processed, to make sure no worker is still looking at it
+   void WaitForWorkers();
+
+   //audio thread. returns false if the plan can't be spread across threads, and the caller should process it itself.
+   //no worker references the plan anymore once this returns
+   bool Process(const AudioExecutionPlan& plan, double time);
+
+private:
+   void WorkerThreadLoop();
+   bool RunJobs();
+   void SetAndWakeWorkers(std::atomic<bool>& flag);
+
+   static uint64_t MakeJobWord(uint32_t generation, uint32_t level, uint32_t index) { return ((uint64_t)generation << 40) | ((uint64_t)level << 20) | index; }
+   static uint32_t GetJobLevel(uint64_t word) { return (word >> 20) & kLevelMask; }
+   static uint32_t GetJobIndex(uint64_t word) { return word & kIndexMask; }
+
+   static constexpr uint32_t kIndexMask = (1 << 20) - 1;
+   static constexpr uint32_t kLevelMask = (1 << 20) - 1;
+   static constexpr uint32_t kNoLevel = kLevelMask;
+
+   static thread_local bool sIsWorkerThread;
+
+   std::atomic<const AudioExecutionPlan*> mPlan{ nullptr };
+   std::function<void(int)> mOnWorkerStarted;
+
+#if defined(__EMSCRIPTEN_WASM_WORKERS__)
+   static void WasmWorkerMain(int scheduler, int workerIndex);
+   static constexpr uint32_t kWasmWorkerStackSize = 256 * 1024;
+
+   std::vector<emscripten_wasm_worker_t> mWorkers;
+   std::atomic<uint32_t> mWakeCounter{ 0 }; //bumped whenever workers should re-check their state, parked workers wait on it
+   std::atomic<int> mRunningWorkers{ 0 };
+#else
+   std::vector<std::thread> mWorkers;
+   std::mutex mWakeMutex;
+   std::condition_variable mWakeCondition;
+#endif
+   std::atomic<bool> mQuit{ false };
+   std::atomic<bool> mBufferActive{ false };
+   std::atomic<int> mBusyWorkers{ 0 };
+   std::atomic<uint64_t> mJobWord{ MakeJobWord(0, kNoLevel, 0) };
+   std::atomic<int> mJobsRemaining{ 0 };
+   uint32_t mGeneration{ 0 };
+   double mJobTime{ 0 };
+};
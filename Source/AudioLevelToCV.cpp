@@ -34,6 +34,7 @@ AudioLevelToCV::AudioLevelToCV()
 : IAudioProcessor(gBufferSize)
 {
    mModulationBuffer = new float[gBufferSize];
+   AllocateCVBlock();
 }
 
 void AudioLevelToCV::CreateUIControls()
@@ -114,6 +115,14 @@ void AudioLevelToCV::Process(double time)
       mModulationBuffer[i] = mVal * mGain;
    }
 
+   //the same mapping as Value(), for the whole block at once
+   float min = GetMin();
+   float range = GetMax() - min;
+   float* cv = GetCVWriteBlock();
+   for (int i = 0; i < gBufferSize; ++i)
+      cv[i] = min + ofClamp(mModulationBuffer[i], 0, 1) * range;
+   CommitCVBlock();
+
    GetBuffer()->Reset();
 }
 
@@ -31,12 +31,14 @@ AudioMeter::AudioMeter()
 : IAudioProcessor(gBufferSize)
 {
    mAnalysisBuffer = new float[gBufferSize];
+   mLevelMeterDisplay.GetAnalyzer().SetMeasureLoudness(true);
 }
 
 void AudioMeter::CreateUIControls()
 {
    IDrawableModule::CreateUIControls();
    mLevelSlider = new FloatSlider(this, "level", 5, 2, 110, 15, &mLevel, 0, mMaxLevel);
+   mResetLoudnessButton = new ClickButton(this, "reset", 3, 54);
 }
 
 AudioMeter::~AudioMeter()
@@ -90,6 +92,26 @@ void AudioMeter::DrawModule()
    mLevelSlider->Draw();
 
    mLevelMeterDisplay.Draw(3, 20, 114, 18, mNumChannels);
+
+   const LevelAnalyzer& analyzer = mLevelMeterDisplay.GetAnalyzer();
+   float truePeak = 0;
+   for (int ch = 0; ch < mNumChannels; ++ch)
+      truePeak = MAX(truePeak, analyzer.GetTruePeak(ch));
+   DrawTextNormal("m " + LoudnessString(analyzer.GetMomentaryLoudness()) + " s " + LoudnessString(analyzer.GetShortTermLoudness()) + " i " + LoudnessString(analyzer.GetIntegratedLoudness()), 4, 50, 10);
+   DrawTextNormal("tp " + (truePeak > 0 ? ofToString(20 * log10f(truePeak), 1) : "-inf") + " dbtp", 45, 66, 10);
+   mResetLoudnessButton->Draw();
+}
+
+//static
+std::string AudioMeter::LoudnessString(float lufs)
+{
+   return lufs > LevelAnalyzer::kSilentLoudness ? ofToString(lufs, 1) : "-inf";
+}
+
+void AudioMeter::ButtonClicked(ClickButton* button, double time)
+{
+   if (button == mResetLoudnessButton)
+      mLevelMeterDisplay.GetAnalyzer().ResetLoudness();
 }
 
 void AudioMeter::LoadLayout(const ofxJSONElement& moduleInfo)
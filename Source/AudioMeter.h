@@ -28,10 +28,11 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Slider.h"
+#include "ClickButton.h"
 #include "PeakTracker.h"
 #include "LevelMeterDisplay.h"
 
-class AudioMeter : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener
+class AudioMeter : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public IButtonListener
 {
 public:
    AudioMeter();
@@ -45,10 +46,13 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //displays its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    //IFloatSliderListener
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
+   //IButtonListener
+   void ButtonClicked(ClickButton* button, double time) override;
 
    void LoadLayout(const ofxJSONElement& moduleInfo) override;
    void SetUpFromSaveData() override;
@@ -58,10 +62,11 @@ public:
 private:
    //IDrawableModule
    void DrawModule() override;
+   static std::string LoudnessString(float lufs);
    void GetModuleDimensions(float& w, float& h) override
    {
       w = 120;
-      h = 40;
+      h = 72;
    }
 
    float mLevel{ 0 };
@@ -71,4 +76,5 @@ private:
    float* mAnalysisBuffer{ nullptr };
    int mNumChannels{ 1 };
    LevelMeterDisplay mLevelMeterDisplay{};
+   ClickButton* mResetLoudnessButton{ nullptr };
 };
@@ -72,22 +72,26 @@ void AudioRouter::Process(double time)
 
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
    {
-      float* outputBuffer = GetBuffer()->GetChannel(ch);
+      const float* input = GetBuffer()->GetChannelReadOnly(ch);
       if (doSwitchAndRamp)
-         mSwitchAndRampIn[ch].Start(time, outputBuffer[0], 0, time + 100);
+         mSwitchAndRampIn[ch].Start(time, input[0], 0, time + 100);
 
-      if (abs(mSwitchAndRampIn[ch].Value(time)) > .01f)
+      bool ramping = abs(mSwitchAndRampIn[ch].Value(time)) > .01f;
+      if (ramping)
       {
-         BufferCopy(gWorkBuffer, outputBuffer, GetBuffer()->BufferSize());
-         outputBuffer = gWorkBuffer;
+         BufferCopy(gWorkBuffer, input, GetBuffer()->BufferSize());
          for (int i = 0; i < GetBuffer()->BufferSize(); ++i)
-            outputBuffer[i] -= mSwitchAndRampIn[ch].Value(time + i * gInvSampleRateMs);
+            gWorkBuffer[i] -= mSwitchAndRampIn[ch].Value(time + i * gInvSampleRateMs);
       }
 
       if (target != nullptr)
       {
-         Add(target->GetBuffer()->GetChannel(ch), outputBuffer, GetBuffer()->BufferSize());
-         GetVizBuffer()->WriteChunk(outputBuffer, GetBuffer()->BufferSize(), ch);
+         //outside of a switch, the target gets our block itself, rather than a copy of it
+         if (ramping)
+            Add(target->GetBuffer()->GetChannel(ch), gWorkBuffer, GetBuffer()->BufferSize());
+         else
+            target->GetBuffer()->AddShared(ch, GetBuffer(), ch);
+         GetVizBuffer()->WriteChunk(ramping ? gWorkBuffer : input, GetBuffer()->BufferSize(), ch);
       }
    }
 
@@ -47,6 +47,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    int GetNumTargets() override { return (int)mDestinationCables.size() + 1; }
 
    //IPatchable
@@ -77,8 +77,8 @@ void AudioSend::Process(double time)
       if (target0)
          for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
          {
-            Add(target0->GetBuffer()->GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
-            GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize(), ch);
+            target0->GetBuffer()->AddShared(ch, GetBuffer(), ch);
+            GetVizBuffer()->WriteChunk(GetBuffer()->GetChannelReadOnly(ch), GetBuffer()->BufferSize(), ch);
          }
 
       GetBuffer()->Reset();
@@ -99,14 +99,24 @@ void AudioSend::Process(double time)
 
    if (target0)
    {
-      gWorkChannelBuffer.CopyFrom(GetBuffer(), GetBuffer()->BufferSize());
-      for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
+      ChannelBuffer* out = target0->GetBuffer();
+      if (mCrossfade)
       {
-         ChannelBuffer* out = target0->GetBuffer();
-         if (mCrossfade)
-            Mult(gWorkChannelBuffer.GetChannel(ch), dryAmountBuffer, GetBuffer()->BufferSize());
-         Add(out->GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize());
-         GetVizBuffer()->WriteChunk(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize(), ch);
+         gWorkChannelBuffer->CopyFrom(GetBuffer(), GetBuffer()->BufferSize());
+         for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
+         {
+            MultAndAdd(gWorkChannelBuffer->GetChannel(ch), dryAmountBuffer, out->GetChannel(ch), GetBuffer()->BufferSize());
+            GetVizBuffer()->WriteChunk(gWorkChannelBuffer->GetChannel(ch), GetBuffer()->BufferSize(), ch);
+         }
+      }
+      else
+      {
+         //the dry side passes our block on as is. if the send below scales it in place, that's when it gets copied
+         for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
+         {
+            out->AddShared(ch, GetBuffer(), ch);
+            GetVizBuffer()->WriteChunk(GetBuffer()->GetChannelReadOnly(ch), GetBuffer()->BufferSize(), ch);
+         }
       }
    }
 
@@ -115,8 +125,7 @@ void AudioSend::Process(double time)
       for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
       {
          ChannelBuffer* out2 = target1->GetBuffer();
-         Mult(GetBuffer()->GetChannel(ch), amountBuffer, GetBuffer()->BufferSize());
-         Add(out2->GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
+         MultAndAdd(GetBuffer()->GetChannel(ch), amountBuffer, out2->GetChannel(ch), GetBuffer()->BufferSize());
          mVizBuffer2.WriteChunk(GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize(), ch);
       }
    }
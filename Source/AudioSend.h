@@ -53,6 +53,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    int GetNumTargets() override { return 2; }
 
@@ -59,16 +59,15 @@ void AudioSplitter::Process(double time)
       {
          ChannelBuffer* out = target->GetBuffer();
          out->SetNumActiveChannels(numchannels);
+         //every target gets the same read-only block, and only copies it if it writes to it
          for (int ch = 0; ch < numchannels; ++ch)
-         {
-            Add(out->GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
-         }
+            out->AddShared(ch, GetBuffer(), ch);
       }
    }
 
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
    {
-      GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize(), ch);
+      GetVizBuffer()->WriteChunk(GetBuffer()->GetChannelReadOnly(ch), GetBuffer()->BufferSize(), ch);
    }
 
    GetBuffer()->Reset();
@@ -48,6 +48,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    void PostRepatch(PatchCableSource* cableSource, bool fromUserClick) override;
    int GetNumTargets() override { return (int)mDestinationCables.size(); }
 
@@ -0,0 +1,224 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioThreadPolicy.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "AudioThreadPolicy.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+#include <thread>
+
+#if BESPOKE_LINUX
+#include <pthread.h>
+#include <sched.h>
+#elif BESPOKE_WINDOWS
+#include <windows.h>
+#elif BESPOKE_MAC
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+#include <mach/thread_policy.h>
+#include <pthread.h>
+#endif
+
+namespace
+{
+   //below the kernel's own irq threads (50) on a PREEMPT_RT box would starve them, above would starve us. the usual pick for audio
+   const int kAudioThreadPriority = 70;
+   const int kWorkerThreadPriority = 69; //audio waits on the workers, so they shouldn't preempt it
+
+   int GetNumCores()
+   {
+      return MAX(1, (int)std::thread::hardware_concurrency());
+   }
+
+   std::vector<int> GetAudioCores()
+   {
+      std::vector<int> cores = AudioThreadPolicy::ParseCoreList(UserPrefs.audio_thread_cores.Get());
+      for (int core : AudioThreadPolicy::ParseCoreList(UserPrefs.audio_worker_cores.Get()))
+      {
+         if (std::find(cores.begin(), cores.end(), core) == cores.end())
+            cores.push_back(core);
+      }
+      return cores;
+   }
+
+#if BESPOKE_WINDOWS
+   typedef HANDLE(WINAPI * AvSetMmThreadCharacteristicsWFn)(LPCWSTR, LPDWORD);
+
+   AvSetMmThreadCharacteristicsWFn GetAvSetMmThreadCharacteristics()
+   {
+      static AvSetMmThreadCharacteristicsWFn sFn = []() -> AvSetMmThreadCharacteristicsWFn
+      {
+         HMODULE avrt = LoadLibraryA("avrt.dll");
+         if (avrt == nullptr)
+            return nullptr;
+         return (AvSetMmThreadCharacteristicsWFn)GetProcAddress(avrt, "AvSetMmThreadCharacteristicsW");
+      }();
+      return sFn;
+   }
+#endif
+}
+
+std::vector<int> AudioThreadPolicy::ParseCoreList(const std::string& list)
+{
+   std::vector<int> cores;
+   int numCores = GetNumCores();
+   for (const auto& token : juce::StringArray::fromTokens(juce::String(list), ",", ""))
+   {
+      juce::String range = token.trim();
+      if (range.isEmpty())
+         continue;
+      int first = range.upToFirstOccurrenceOf("-", false, false).trim().getIntValue();
+      int last = range.contains("-") ? range.fromFirstOccurrenceOf("-", false, false).trim().getIntValue() : first;
+      for (int core = first; core <= last; ++core)
+      {
+         if (core >= 0 && core < numCores && std::find(cores.begin(), cores.end(), core) == cores.end())
+            cores.push_back(core);
+      }
+   }
+   return cores;
+}
+
+void AudioThreadPolicy::ConfigureAudioThread()
+{
+   PinToCores(ParseCoreList(UserPrefs.audio_thread_cores.Get()), "audio thread");
+   if (UserPrefs.realtime_audio_threads.Get())
+      RequestRealtime(kAudioThreadPriority, "audio thread");
+}
+
+void AudioThreadPolicy::ConfigureWorkerThread(int workerIndex)
+{
+   std::vector<int> cores = ParseCoreList(UserPrefs.audio_worker_cores.Get());
+   if (!cores.empty())
+      PinToCores({ cores[workerIndex % cores.size()] }, "audio worker");
+   if (UserPrefs.realtime_audio_threads.Get())
+      RequestRealtime(kWorkerThreadPriority, "audio worker");
+}
+
+void AudioThreadPolicy::KeepOffAudioCores()
+{
+   if (!UserPrefs.keep_other_threads_off_audio_cores.Get())
+      return;
+
+   std::vector<int> audioCores = GetAudioCores();
+   if (audioCores.empty())
+      return;
+
+   std::vector<int> otherCores;
+   for (int core = 0; core < GetNumCores(); ++core)
+   {
+      if (std::find(audioCores.begin(), audioCores.end(), core) == audioCores.end())
+         otherCores.push_back(core);
+   }
+
+   if (otherCores.empty())
+   {
+      ofLog() << "audio_thread_cores and audio_worker_cores cover every core, leaving the other threads where they are";
+      return;
+   }
+
+   PinToCores(otherCores, "main thread");
+}
+
+void AudioThreadPolicy::PinToCores(const std::vector<int>& cores, const char* threadName)
+{
+   if (cores.empty())
+      return;
+
+#if BESPOKE_LINUX
+   cpu_set_t set;
+   CPU_ZERO(&set);
+   for (int core : cores)
+      CPU_SET(core, &set);
+   int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+   if (error != 0)
+      ofLog() << "couldn't pin the " << threadName << " to its cores (error " << error << ")";
+#elif BESPOKE_WINDOWS
+   DWORD_PTR mask = 0;
+   for (int core : cores)
+   {
+      if (core < (int)sizeof(DWORD_PTR) * 8)
+         mask |= (DWORD_PTR)1 << core;
+   }
+   if (mask == 0 || SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+      ofLog() << "couldn't pin the " << threadName << " to its cores (error " << (int)GetLastError() << ")";
+#else
+   (void)threadName;
+#endif
+}
+
+void AudioThreadPolicy::RequestRealtime(int priority, const char* threadName)
+{
+#if BESPOKE_LINUX
+   //the device backend may have made it realtime already, with a priority the user set up for it
+   int policy;
+   sched_param param;
+   if (pthread_getschedparam(pthread_self(), &policy, &param) == 0 && (policy == SCHED_FIFO || policy == SCHED_RR))
+      return;
+
+   param = {};
+   param.sched_priority = CLAMP(priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+   int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+   if (error != 0)
+   {
+      static bool sLogged = false;
+      if (!sLogged)
+         ofLog() << "couldn't make the " << threadName << " realtime (error " << error << "), the user needs an rtprio limit in /etc/security/limits.conf";
+      sLogged = true;
+   }
+#elif BESPOKE_WINDOWS
+   //multimedia class scheduler, the same "Pro Audio" task the asio and wasapi drivers' own threads join
+   (void)priority;
+   DWORD taskIndex = 0;
+   auto avSetMmThreadCharacteristics = GetAvSetMmThreadCharacteristics();
+   if (avSetMmThreadCharacteristics == nullptr || avSetMmThreadCharacteristics(L"Pro Audio", &taskIndex) == nullptr)
+   {
+      if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+         ofLog() << "couldn't raise the priority of the " << threadName;
+   }
+#elif BESPOKE_MAC
+   //time constraint scheduling, with the device callback as the period (not the internal block, which can be a fraction of it). it's the policy core audio's io thread runs with
+   (void)priority;
+   mach_timebase_info_data_t timebase;
+   mach_timebase_info(&timebase);
+   double periodNs = gIOBufferSize * 1e9 / gSampleRate;
+   double nsToTicks = (double)timebase.denom / timebase.numer;
+
+   thread_time_constraint_policy_data_t policy;
+   policy.period = (uint32_t)(periodNs * nsToTicks);
+   policy.computation = (uint32_t)(periodNs * .5 * nsToTicks);
+   policy.constraint = (uint32_t)(periodNs * nsToTicks);
+   policy.preemptible = 1;
+   kern_return_t result = thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_TIME_CONSTRAINT_POLICY, (thread_policy_t)&policy, THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+   if (result != KERN_SUCCESS)
+      ofLog() << "couldn't set time constraint scheduling on the " << threadName << " (error " << result << ")";
+#else
+   (void)priority;
+   (void)threadName;
+#endif
+}
@@ -0,0 +1,46 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AudioThreadPolicy.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//where the audio callback and the graph workers run, and at what priority, from the audio_*_cores and realtime_audio_threads prefs.
+//each call applies to the calling thread. cores can only be chosen on linux and windows, macos has no affinity api
+class AudioThreadPolicy
+{
+public:
+   static void ConfigureAudioThread(); //call from inside the audio callback
+   static void ConfigureWorkerThread(int workerIndex); //workers are pinned one core each, round robin through audio_worker_cores
+   static void KeepOffAudioCores(); //call from the main thread early, threads it starts after this inherit the mask on linux
+
+   static std::vector<int> ParseCoreList(const std::string& list); //"2,4-6" -> 2,4,5,6
+
+private:
+   static void PinToCores(const std::vector<int>& cores, const char* threadName);
+   static void RequestRealtime(int priority, const char* threadName);
+};
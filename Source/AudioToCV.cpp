@@ -34,6 +34,7 @@ AudioToCV::AudioToCV()
 : IAudioProcessor(gBufferSize)
 {
    mModulationBuffer = new float[gBufferSize];
+   AllocateCVBlock();
 }
 
 void AudioToCV::CreateUIControls()
@@ -95,6 +96,14 @@ void AudioToCV::Process(double time)
    BufferCopy(mModulationBuffer, gWorkBuffer, gBufferSize);
    Mult(mModulationBuffer, mGain, gBufferSize);
 
+   //the same mapping as Value(), for the whole block at once
+   float min = GetMin();
+   float range = GetMax() - min;
+   float* cv = GetCVWriteBlock();
+   for (int i = 0; i < gBufferSize; ++i)
+      cv[i] = min + ofClamp(mModulationBuffer[i] * .5f + .5f, 0, 1) * range;
+   CommitCVBlock();
+
    GetBuffer()->Reset();
 }
 
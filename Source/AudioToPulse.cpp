@@ -34,6 +34,7 @@
 
 AudioToPulse::AudioToPulse()
 : IAudioProcessor(gBufferSize)
+, mPulses(gBufferSize)
 {
 }
 
@@ -100,6 +101,7 @@ void AudioToPulse::Process(double time)
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
       Add(gWorkBuffer, GetBuffer()->GetChannel(ch), gBufferSize);
    Mult(gWorkBuffer, 1.0f / GetBuffer()->NumActiveChannels(), gBufferSize);
+   mPulses.Clear(time);
    for (int i = 0; i < gBufferSize; ++i)
    {
       const float decayTime = .01f;
@@ -126,8 +128,10 @@ void AudioToPulse::Process(double time)
          mEnvelope = MAX(0, mEnvelope - gInvSampleRateMs / mRelease);
 
       if (mEnvelope >= 0.01f && oldEnvelope < 0.01f)
-         DispatchPulse(GetPatchCableSource(), time + i * gInvSampleRateMs, 1, 0);
+         mPulses.Add(i, 1, 0);
    }
+   //an audio rate input can fire a lot of them, so they go out together
+   DispatchPulses(GetPatchCableSource(), mPulses);
 
    GetBuffer()->Reset();
 }
@@ -69,4 +69,5 @@ private:
    float mThreshold{ 0.5 };
    float mRelease{ 150 };
    float mReleaseFactor{ 0.99 };
+   PulseBatch mPulses;
 };
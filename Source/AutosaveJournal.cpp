@@ -0,0 +1,196 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AutosaveJournal.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "AutosaveJournal.h"
+#include "ModularSynth.h"
+#include "SaveStateChunks.h"
+#include "SynthGlobals.h"
+
+#include "juce_core/juce_core.h"
+
+namespace
+{
+   const int kFullRecordInterval = 30; //write every module now and then, in case something changed without being marked dirty
+   const int kCompactAfterRecords = 20;
+}
+
+AutosaveJournal& AutosaveJournal::Get()
+{
+   static AutosaveJournal sJournal;
+   return sJournal;
+}
+
+void AutosaveJournal::Autosave()
+{
+   if (mBasePath.empty())
+   {
+      mBasePath = ofToDataPath(ofGetTimestampString("savestate/autosave/autosave_%Y-%m-%d_%H-%M-%S.bskt"));
+      mNumRecords = 0;
+      TheSynth->ClearModuleStateDirty();
+      TheSynth->SaveState(mBasePath, true);
+      return;
+   }
+
+   ++mNumRecords;
+   if (!TheSynth->SaveStateJournalRecord(GetJournalPath(mBasePath), mNumRecords % kFullRecordInterval == 0))
+   {
+      TheSynth->LogEvent("error writing autosave journal, starting a new autosave", kLogEventType_Warning);
+      mBasePath.clear();
+      return;
+   }
+
+   if (mNumRecords % kCompactAfterRecords == 0)
+      StartCompaction();
+}
+
+void AutosaveJournal::Reset()
+{
+   mBasePath.clear();
+   mNumRecords = 0;
+}
+
+void AutosaveJournal::Poll()
+{
+   if (mCompactionThread.joinable() && mCompactionDone)
+      mCompactionThread.join();
+}
+
+void AutosaveJournal::Shutdown()
+{
+   if (mCompactionThread.joinable())
+      mCompactionThread.join();
+}
+
+void AutosaveJournal::StartCompaction()
+{
+   if (mCompactionThread.joinable())
+      return; //still busy with the last one, the journal will just be a bit longer next time
+
+   //set the records aside, so new ones can go on a fresh journal while they get merged. if an earlier compaction
+   //failed its records are still set aside, so merge those first and leave the journal alone
+   juce::File compacting(GetCompactingPath(mBasePath));
+   if (!compacting.existsAsFile() && !juce::File(GetJournalPath(mBasePath)).moveFileTo(compacting))
+      return;
+
+   mCompactionDone = false;
+   mCompactionThread = std::thread([this, basePath = mBasePath]
+                                   {
+                                      Compact(basePath);
+                                      mCompactionDone = true;
+                                   });
+}
+
+void AutosaveJournal::Compact(std::string basePath)
+{
+   SaveStateChunkSet chunks;
+   if (!chunks.Add(std::make_unique<SaveStateChunkReader>(basePath)))
+      return;
+
+   juce::File compacting(GetCompactingPath(basePath));
+   if (!AddRecords(compacting.getFullPathName().toStdString(), chunks))
+      return;
+   chunks.RemoveModulesNotInLayout();
+   if (!chunks.IsValid())
+      return;
+
+   std::string tmpPath = basePath + ".tmp";
+   {
+      SaveStateChunkWriter writer(tmpPath, false);
+      if (!writer.OpenedOk())
+         return;
+
+      writer.CopyChunk(*chunks.mLayout.mReader, chunks.mLayout.mIndex);
+      for (const auto* modules : { &chunks.mModules, &chunks.mUILayerModules })
+      {
+         for (const SaveStateChunkRef& module : *modules)
+         {
+            //the module's sample blocks come along with it, in order, so their numbering within the module still holds
+            const auto& recordChunks = module.mReader->GetChunks();
+            for (int i = 0; i < (int)recordChunks.size(); ++i)
+            {
+               if (recordChunks[i].mType == SaveStateChunk::kSampleBlock && recordChunks[i].mName == recordChunks[module.mIndex].mName)
+                  writer.CopyChunk(*module.mReader, i);
+            }
+            writer.CopyChunk(*module.mReader, module.mIndex);
+         }
+      }
+
+      if (!writer.Finish(chunks.mSaveStateRev))
+         return;
+   }
+
+   chunks.mReaders.clear();
+
+   //replace rather than overwrite, a recovered session might still be mapping samples out of the old base
+   juce::File tmpFile(tmpPath);
+   if (tmpFile.replaceFileIn(juce::File(basePath)))
+      compacting.deleteFile();
+   else
+      tmpFile.deleteFile();
+}
+
+std::string AutosaveJournal::GetJournalPath(const std::string& basePath)
+{
+   return basePath + ".journal";
+}
+
+std::string AutosaveJournal::GetCompactingPath(const std::string& basePath)
+{
+   return basePath + ".journal.compacting";
+}
+
+void AutosaveJournal::DeleteJournals(const std::string& basePath)
+{
+   juce::File(GetCompactingPath(basePath)).deleteFile();
+   juce::File(GetJournalPath(basePath)).deleteFile();
+}
+
+void AutosaveJournal::AddJournalRecords(const std::string& basePath, SaveStateChunkSet& chunks)
+{
+   //records set aside for a compaction that never finished are older than the ones in the journal
+   bool addedCompacting = AddRecords(GetCompactingPath(basePath), chunks);
+   bool addedJournal = AddRecords(GetJournalPath(basePath), chunks);
+   if (addedCompacting || addedJournal)
+      chunks.RemoveModulesNotInLayout();
+}
+
+bool AutosaveJournal::AddRecords(const std::string& journalPath, SaveStateChunkSet& chunks)
+{
+   if (!juce::File(journalPath).existsAsFile())
+      return false;
+
+   bool addedAny = false;
+   for (std::int64_t offset = 0;;)
+   {
+      auto record = std::make_unique<SaveStateChunkReader>(journalPath, offset);
+      if (!record->OpenedOk())
+         break; //the end, or a record that was torn by a crash
+      offset = record->GetEndOffset();
+      chunks.Add(std::move(record));
+      addedAny = true;
+   }
+   return addedAny;
+}
@@ -0,0 +1,64 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    AutosaveJournal.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+struct SaveStateChunkSet;
+
+//incremental autosave. the first autosave of a session writes a full save state (the "base"), after that each autosave
+//appends a record to a journal next to it, with the layout and just the modules that have changed since the last record.
+//every so often the journal is folded back into the base on a background thread, by copying the newest chunk for each module.
+//loading a base with a journal next to it (after a crash, say) replays the journal on top of it
+class AutosaveJournal
+{
+public:
+   static AutosaveJournal& Get();
+
+   void Autosave(); //main thread
+   void Reset(); //start over with a new base on the next autosave, for when a different layout gets loaded
+   void Poll();
+   void Shutdown();
+
+   static std::string GetJournalPath(const std::string& basePath);
+   static void DeleteJournals(const std::string& basePath);
+   static void AddJournalRecords(const std::string& basePath, SaveStateChunkSet& chunks);
+
+private:
+   AutosaveJournal() = default;
+   void StartCompaction();
+   static void Compact(std::string basePath);
+   static bool AddRecords(const std::string& journalPath, SaveStateChunkSet& chunks);
+   static std::string GetCompactingPath(const std::string& basePath);
+
+   std::string mBasePath;
+   int mNumRecords{ 0 };
+   std::thread mCompactionThread;
+   std::atomic<bool> mCompactionDone{ false };
+};
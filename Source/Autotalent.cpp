@@ -25,7 +25,6 @@
 
 #include "Autotalent.h"
 #include "SynthGlobals.h"
-#include "FFT.h"
 #include "Scale.h"
 #include "ModularSynth.h"
 #include "Profiler.h"
@@ -92,51 +91,8 @@ Autotalent::Autotalent()
       mhannwindow[ti] = -0.5 * cos(2 * PI * ti / mcbsize) + 0.5;
    }
 
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mcbwindow = (float*)calloc(mcbsize, sizeof(float));
-   for (int ti = 0; ti < (mcbsize / 2); ti++)
-   {
-      mcbwindow[ti + mcbsize / 4] = -0.5 * cos(4 * PI * ti / (mcbsize - 1)) + 0.5;
-   }
-
    mnoverlap = 4;
 
-   mFFT = new ::FFT((int)mcbsize);
-
-   mffttime = (float*)calloc(mcbsize, sizeof(float));
-   mfftfreqre = (float*)calloc(mcorrsize, sizeof(float));
-   mfftfreqim = (float*)calloc(mcorrsize, sizeof(float));
-
-
-   // ---- Calculate autocorrelation of window ----
-   macwinv = (float*)calloc(mcbsize, sizeof(float));
-   for (int ti = 0; ti < mcbsize; ti++)
-   {
-      mffttime[ti] = mcbwindow[ti];
-   }
-   mFFT->Forward(mcbwindow, mfftfreqre, mfftfreqim);
-   for (int ti = 0; ti < mcorrsize; ti++)
-   {
-      mfftfreqre[ti] = (mfftfreqre[ti]) * (mfftfreqre[ti]) + (mfftfreqim[ti]) * (mfftfreqim[ti]);
-      mfftfreqim[ti] = 0;
-   }
-   mFFT->Inverse(mfftfreqre, mfftfreqim, mffttime);
-   for (long ti = 1; ti < mcbsize; ti++)
-   {
-      macwinv[ti] = mffttime[ti] / mffttime[0];
-      if (macwinv[ti] > 0.000001)
-      {
-         macwinv[ti] = (float)1 / macwinv[ti];
-      }
-      else
-      {
-         macwinv[ti] = 0;
-      }
-   }
-   macwinv[0] = 1;
-   // ---- END Calculate autocorrelation of window ----
-
-
    mlrshift = 0;
    mptarget = 0;
    msptarget = 0;
@@ -233,17 +189,11 @@ void Autotalent::CreateUIControls()
 
 Autotalent::~Autotalent()
 {
-   delete mFFT;
    free(mcbi);
    free(mcbf);
    free(mcbo);
-   free(mcbwindow);
    free(mhannwindow);
-   free(macwinv);
    free(mfrag);
-   free(mffttime);
-   free(mfftfreqre);
-   free(mfftfreqim);
    free(mfk);
    free(mfb);
    free(mfc);
@@ -278,7 +228,6 @@ void Autotalent::Process(double time)
    int iScwarp;
 
    long int N;
-   long int Nf;
    long int fs;
 
    long int ti;
@@ -384,7 +333,6 @@ void Autotalent::Process(double time)
    maref = (float)mTune;
 
    N = mcbsize;
-   Nf = mcorrsize;
    fs = mfs;
 
    pperiod = mpmax;
@@ -392,6 +340,8 @@ void Autotalent::Process(double time)
    float conf = mconf;
    float outpitch = moutpitch;
 
+   mPitchTracker = PitchTrackerPool::Get().Track(mPitchTracker, time, pfInput, bufferSize);
+
 
    /*******************
     *  MAIN DSP LOOP  *
@@ -452,87 +402,16 @@ void Autotalent::Process(double time)
       // Every N/noverlap samples, run pitch estimation / manipulation code
       if ((mcbiwr) % (N / mnoverlap) == 0)
       {
-         // ---- Obtain autocovariance ----
-
-         // Window and fill FFT buffer
-         ti2 = mcbiwr;
-         for (ti = 0; ti < N; ti++)
-         {
-            mffttime[ti] = (float)(mcbi[(ti2 - ti + N) % N] * mcbwindow[ti]);
-         }
-
-         // Calculate FFT
-         mFFT->Forward(mffttime, mfftfreqre, mfftfreqim);
+         // ---- Obtain pitch period and confidence ----
+         // the analysis itself is done by the tracker for the whole block, shared with anything else listening to the same input
 
-         // Remove DC
-         mfftfreqre[0] = 0;
-         mfftfreqim[0] = 0;
-
-         // Take magnitude squared
-         for (ti = 1; ti < Nf; ti++)
-         {
-            mfftfreqre[ti] = (mfftfreqre[ti]) * (mfftfreqre[ti]) + (mfftfreqim[ti]) * (mfftfreqim[ti]);
-            mfftfreqim[ti] = 0;
-         }
-
-         // Calculate IFFT
-         mFFT->Inverse(mfftfreqre, mfftfreqim, mffttime);
-
-         // Normalize
-         tf = (float)1 / mffttime[0];
-         for (ti = 1; ti < N; ti++)
-         {
-            mffttime[ti] = mffttime[ti] * tf;
-         }
-         mffttime[0] = 1;
-
-         //  ---- END Obtain autocovariance ----
-
-
-         //  ---- Calculate pitch and confidence ----
-
-         // Calculate pitch period
-         //   Pitch period is determined by the location of the max (biased)
-         //     peak within a given range
-         //   Confidence is determined by the corresponding unbiased height
-         tf2 = 0;
+         const PitchTracker::Estimate& estimate = mPitchTracker->GetEstimate(lSampleIndex + 1);
          pperiod = mpmin;
-         for (ti = mnmin; ti < mnmax; ti++)
+         conf = 0;
+         if (estimate.mPeriod >= mnmin && estimate.mPeriod <= mnmax)
          {
-            ti2 = ti - 1;
-            ti3 = ti + 1;
-            if (ti2 < 0)
-            {
-               ti2 = 0;
-            }
-            if (ti3 > Nf)
-            {
-               ti3 = Nf;
-            }
-            tf = mffttime[ti];
-
-            if (tf > mffttime[ti2] && tf >= mffttime[ti3] && tf > tf2)
-            {
-               tf2 = tf;
-               ti4 = ti;
-            }
-         }
-         if (tf2 > 0)
-         {
-            conf = tf2 * macwinv[ti4];
-            if (ti4 > 0 && ti4 < Nf)
-            {
-               // Find the center of mass in the vicinity of the detected peak
-               tf = mffttime[ti4 - 1] * (ti4 - 1);
-               tf = tf + mffttime[ti4] * (ti4);
-               tf = tf + mffttime[ti4 + 1] * (ti4 + 1);
-               tf = tf / (mffttime[ti4 - 1] + mffttime[ti4] + mffttime[ti4 + 1]);
-               pperiod = tf / fs;
-            }
-            else
-            {
-               pperiod = (float)ti4 / fs;
-            }
+            pperiod = estimate.mPeriod / fs;
+            conf = estimate.mConfidence;
          }
 
          // Convert to semitones
@@ -32,8 +32,7 @@
 #include "RadioButton.h"
 #include "ClickButton.h"
 #include "INoteReceiver.h"
-
-class FFT;
+#include "PitchTracker.h"
 
 class Autotalent : public IAudioProcessor, public IIntSliderListener, public IFloatSliderListener, public IDrawableModule, public IRadioButtonListener, public IButtonListener, public INoteReceiver
 {
@@ -147,7 +146,7 @@ private:
    float mPitch{ 0 };
    float mConfidence{ 0 };
    float mLatency{ 0 };
-   ::FFT* mFFT;
+   std::shared_ptr<PitchTracker> mPitchTracker;
 
    unsigned long mfs; // Sample rate
 
@@ -159,15 +158,9 @@ private:
    float* mcbf; // circular formant correction buffer
    float* mcbo; // circular output buffer
 
-   float* mcbwindow; // hann of length N/2, zeros for the rest
-   float* macwinv; // inverse of autocorrelation of window
    float* mhannwindow; // length-N hann
    int mnoverlap;
 
-   float* mffttime;
-   float* mfftfreqre;
-   float* mfftfreqim;
-
    // VARIABLES FOR LOW-RATE SECTION
    float maref{ 440 }; // A tuning reference (Hz)
    float minpitch{ 0 }; // Input pitch (semitones)
@@ -34,19 +34,11 @@ BandVocoder::BandVocoder()
    mCarrierInputBuffer = new float[GetBuffer()->BufferSize()];
    Clear(mCarrierInputBuffer, GetBuffer()->BufferSize());
 
-   mWorkBuffer = new float[GetBuffer()->BufferSize()];
-   Clear(mWorkBuffer, GetBuffer()->BufferSize());
-
    mOutBuffer = new float[GetBuffer()->BufferSize()];
    Clear(mOutBuffer, GetBuffer()->BufferSize());
 
-   for (int i = 0; i < VOCODER_MAX_BANDS; ++i)
-   {
-      mPeaks[i].SetDecayTime(mRingTime);
-      mOutputPeaks[i].SetDecayTime(mRingTime);
-      mPeaks[i].SetLimit(mMaxBand);
-      mOutputPeaks[i].SetLimit(mMaxBand);
-   }
+   mFilterBank.SetDecayTime(mRingTime);
+   mFilterBank.SetLimit(mMaxBand);
 
    CalcFilters();
 }
@@ -75,7 +67,7 @@ void BandVocoder::CreateUIControls()
 BandVocoder::~BandVocoder()
 {
    delete[] mCarrierInputBuffer;
-   delete[] mWorkBuffer;
+   delete[] mOutBuffer;
 }
 
 void BandVocoder::SetCarrierBuffer(float* carrier, int bufferSize)
@@ -121,34 +113,8 @@ void BandVocoder::Process(double time)
    Mult(GetBuffer()->GetChannel(0), inputPreampSq * 5, bufferSize);
    Mult(mCarrierInputBuffer, carrierPreampSq * 5, bufferSize);
 
-   for (int i = 0; i < mNumBands; ++i)
-   {
-      //get modulator band
-      BufferCopy(mWorkBuffer, GetBuffer()->GetChannel(0), bufferSize);
-      mBiquadCarrier[i].Filter(mWorkBuffer, bufferSize);
-
-      float oldPeak = mPeaks[i].GetPeak();
-
-      //calculate modulator band level
-      mPeaks[i].Process(mWorkBuffer, bufferSize);
-
-      //get carrier band
-      BufferCopy(mWorkBuffer, mCarrierInputBuffer, bufferSize);
-      mBiquadOut[i].Filter(mWorkBuffer, bufferSize);
-
-      //multiply carrier band by modulator band level
-      //Mult(mWorkBuffer, mPeaks[i].GetPeak(), bufferSize);
-      for (int j = 0; j < bufferSize; ++j)
-         mWorkBuffer[j] *= ofMap(j, 0, bufferSize, oldPeak, mPeaks[i].GetPeak());
-
-      //don't allow a band to go crazy
-      /*mOutputPeaks[i].Process(mWorkBuffer, bufferSize);
-      if (mOutputPeaks[i].GetPeak() > mMaxBand)
-         Mult(mWorkBuffer, 1/mOutputPeaks[i].GetPeak(), bufferSize);*/
-
-      //accumulate output band into total output
-      Add(mOutBuffer, mWorkBuffer, bufferSize);
-   }
+   //filter both signals into every band, and scale each carrier band by the level of the matching modulator band
+   mFilterBank.Process(GetBuffer()->GetChannel(0), mCarrierInputBuffer, mOutBuffer, bufferSize);
 
    Mult(mOutBuffer, mDryWet * volSq, bufferSize);
    Mult(GetBuffer()->GetChannel(0), (1 - mDryWet), bufferSize);
@@ -188,8 +154,8 @@ void BandVocoder::DrawModule()
    ofSetColor(0, 255, 0);
    for (int i = 0; i < mNumBands; ++i)
    {
-      float x = PosForFreq(mBiquadCarrier[i].mF) * w;
-      ofLine(x, h, x, h - mPeaks[i].GetPeak() * 200);
+      float x = PosForFreq(mBandDesigns[i].mF) * w;
+      ofLine(x, h, x, h - mFilterBank.GetPeak(i) * 200);
    }
 
    auto FreqForPos = [](float pos)
@@ -207,7 +173,7 @@ void BandVocoder::DrawModule()
          float freq = FreqForPos(x / w);
          if (freq < gSampleRate / 2)
          {
-            float response = mBiquadCarrier[i].GetMagnitudeResponseAt(freq);
+            float response = mBandDesigns[i].GetMagnitudeResponseAt(freq);
             ofVertex(x, (.5f - .666f * log10(response)) * h);
          }
       }
@@ -225,6 +191,7 @@ void BandVocoder::DrawModule()
 
 void BandVocoder::CalcFilters()
 {
+   mFilterBank.SetNumBands(mNumBands);
    for (int i = 0; i < mNumBands; ++i)
    {
       float a = float(i) / (mNumBands - 1);
@@ -238,10 +205,9 @@ void BandVocoder::CalcFilters()
       else
          f = ofLerp(fExp, fBass, -mSpacingStyle);
 
-      mBiquadCarrier[i].SetFilterType(kFilterType_Bandpass);
-      mBiquadOut[i].SetFilterType(kFilterType_Bandpass);
-      mBiquadCarrier[i].SetFilterParams(f, mQ);
-      mBiquadOut[i].CopyCoeffFrom(mBiquadCarrier[i]);
+      mBandDesigns[i].SetFilterType(kFilterType_Bandpass);
+      mBandDesigns[i].SetFilterParams(f, mQ);
+      mFilterBank.SetBand(i, mBandDesigns[i]);
    }
 }
 
@@ -249,11 +215,7 @@ void BandVocoder::CheckboxUpdated(Checkbox* checkbox, double time)
 {
    if (checkbox == mEnabledCheckbox)
    {
-      for (int i = 0; i < VOCODER_MAX_BANDS; ++i)
-      {
-         mBiquadCarrier[i].Clear();
-         mBiquadOut[i].Clear();
-      }
+      mFilterBank.Clear();
    }
 }
 
@@ -273,19 +235,11 @@ void BandVocoder::FloatSliderUpdated(FloatSlider* slider, float oldVal, double t
    }
    if (slider == mRingTimeSlider)
    {
-      for (int i = 0; i < VOCODER_MAX_BANDS; ++i)
-      {
-         mPeaks[i].SetDecayTime(mRingTime);
-         mOutputPeaks[i].SetDecayTime(mRingTime);
-      }
+      mFilterBank.SetDecayTime(mRingTime);
    }
    if (slider == mMaxBandSlider)
    {
-      for (int i = 0; i < VOCODER_MAX_BANDS; ++i)
-      {
-         mPeaks[i].SetLimit(mMaxBand);
-         mOutputPeaks[i].SetLimit(mMaxBand);
-      }
+      mFilterBank.SetLimit(mMaxBand);
    }
 }
 
@@ -31,9 +31,9 @@
 #include "Slider.h"
 #include "BiquadFilterEffect.h"
 #include "VocoderCarrierInput.h"
-#include "PeakTracker.h"
+#include "VocoderFilterBank.h"
 
-#define VOCODER_MAX_BANDS 64
+#define VOCODER_MAX_BANDS VocoderFilterBank::kMaxBands
 
 class BandVocoder : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public VocoderBase, public IIntSliderListener
 {
@@ -79,7 +79,6 @@ private:
 
    float* mCarrierInputBuffer{ nullptr };
 
-   float* mWorkBuffer{ nullptr };
    float* mOutBuffer{ nullptr };
 
    float mInputPreamp{ 1 };
@@ -105,10 +104,8 @@ private:
    float mSpacingStyle{ 0 };
    FloatSlider* mSpacingStyleSlider{ nullptr };
 
-   BiquadFilter mBiquadCarrier[VOCODER_MAX_BANDS]{};
-   BiquadFilter mBiquadOut[VOCODER_MAX_BANDS]{};
-   PeakTracker mPeaks[VOCODER_MAX_BANDS]{};
-   PeakTracker mOutputPeaks[VOCODER_MAX_BANDS]{};
+   BiquadFilter mBandDesigns[VOCODER_MAX_BANDS]{};
+   VocoderFilterBank mFilterBank;
 
    bool mCarrierDataSet{ false };
 };
@@ -29,6 +29,7 @@
 #include "SynthGlobals.h"
 #include "ModularSynth.h"
 #include "Profiler.h"
+#include "OnsetIndex.h"
 
 #ifdef _WIN32
 #define popen _popen
@@ -96,6 +97,9 @@ void BeatBloks::Poll()
    {
       mHeldBlok = nullptr;
    }
+
+   if (mWantOnsetSegments && !mLoading)
+      SegmentAtOnsets();
 }
 
 void BeatBloks::Process(double time)
@@ -322,9 +326,28 @@ void BeatBloks::FilesDropped(std::vector<std::string> files, int x, int y)
 
    TheTransport->SetTempo(76);
 
+   mWantOnsetSegments = mSegments.empty();
    mLoading = false;
 }
 
+void BeatBloks::SegmentAtOnsets()
+{
+   std::shared_ptr<const OnsetIndex> onsets = mSample->GetOnsets();
+   if (onsets == nullptr || !onsets->IsReady())
+      return;
+
+   const std::vector<int>& positions = onsets->GetOnsets();
+   float length = mSample->LengthInSamples();
+   for (size_t i = 0; i < positions.size(); ++i)
+   {
+      int end = i + 1 < positions.size() ? positions[i + 1] : mSample->LengthInSamples();
+      Blok blok(positions[i] / length, (end - positions[i]) / length, 1);
+      blok.mType = kBlok_Segment;
+      mSegments.push_back(blok);
+   }
+   mWantOnsetSegments = false;
+}
+
 void BeatBloks::ResetRead()
 {
    mReadState = kReadState_Start;
@@ -333,6 +356,7 @@ void BeatBloks::ResetRead()
    mTatums.clear();
    mSections.clear();
    mSegments.clear();
+   mWantOnsetSegments = false;
 }
 
 void BeatBloks::ReadEchonestLine(const char* line)
@@ -124,6 +124,7 @@ private:
    void UpdateZoomExtents();
    void ResetRead();
    void ReadEchonestLine(const char* line);
+   void SegmentAtOnsets();
    float StartTime(const Blok& blok);
    float GetInsertPosition(int& insertIndex);
    void PlaceHeldBlok();
@@ -168,6 +169,7 @@ private:
    std::vector<Blok> mSections;
    std::vector<Blok> mSegments;
    std::vector<Blok> mNothing;
+   bool mWantOnsetSegments{ false }; //no segments came with the analysis, fill them in from the sample's transients
    BlokType mDrawBlokType{ BlokType::kBlok_Bar };
    DropdownList* mDrawBlokTypeDropdown{ nullptr };
    bool mLoading{ false };
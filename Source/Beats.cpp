@@ -315,8 +315,8 @@ void BeatColumn::Process(double time, ChannelBuffer* buffer, int bufferSize)
       beat->SetRate(speed);
 
       int numChannels = 2;
-      gWorkChannelBuffer.SetNumActiveChannels(numChannels);
-      if (beat->ConsumeData(time, &gWorkChannelBuffer, bufferSize, true))
+      gWorkChannelBuffer->SetNumActiveChannels(numChannels);
+      if (beat->ConsumeData(time, gWorkChannelBuffer, bufferSize, true))
       {
          mFilterRamp.Start(time, mFilter, time + 10);
 
@@ -339,7 +339,7 @@ void BeatColumn::Process(double time, ChannelBuffer* buffer, int bufferSize)
                int sampleChannel = ch;
                if (beat->NumChannels() == 1)
                   sampleChannel = 0;
-               float normal = gWorkChannelBuffer.GetChannel(sampleChannel)[i];
+               float normal = gWorkChannelBuffer->GetChannel(sampleChannel)[i];
                float lowPassed = mLowpass[ch].Filter(normal);
                float highPassed = mHighpass[ch].Filter(normal);
                float sample = normal * normalAmount + lowPassed * lowAmount + highPassed * highAmount;
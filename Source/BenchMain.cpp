@@ -0,0 +1,289 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    BenchMain.cpp
+    Created: 14 Oct 2026
+
+    entry point for bespoke-bench, which runs the synth without a window or an audio device,
+    either to time the dsp building blocks one at a time, to load test a whole patch, or to replay a captured session
+
+  ==============================================================================
+*/
+
+#include "DspBenchmark.h"
+#include "LoadTest.h"
+#include "ModularSynth.h"
+#include "ReplayRunner.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+#include "VersionInfo.h"
+#include "ofxJSONElement.h"
+
+#include "juce_audio_devices/juce_audio_devices.h"
+#include "juce_audio_formats/juce_audio_formats.h"
+#include "juce_data_structures/juce_data_structures.h"
+#include "juce_gui_basics/juce_gui_basics.h"
+
+#include <iostream>
+#include <memory>
+
+namespace
+{
+   std::unique_ptr<juce::ApplicationProperties> sAppProperties;
+
+   struct BenchOptions
+   {
+      std::vector<int> mBufferSizes{ 64, 256, 1024 };
+      int mSampleRate{ 48000 };
+      double mMinTimeMs{ 200 };
+      std::string mFilter;
+      std::string mOutputPath;
+
+      std::string mLoadPath;
+      int mLoadBufferSize{ 256 };
+      double mDurationSeconds{ 10 };
+      std::string mPrefabName;
+      int mInstances{ 1 };
+
+      std::string mReplayPath;
+      std::string mTracePath;
+   };
+
+   void PrintUsage()
+   {
+      std::cout << "Benchmarks bespoke's dsp building blocks, load tests a patch, or replays a captured session, and prints the results as json.\n"
+                << "\n"
+                << "Usage: bespoke-bench [OPTIONS]\n"
+                << "       bespoke-bench --load <file.bsk> [OPTIONS]\n"
+                << "       bespoke-bench --replay <file.bsr> [OPTIONS]\n"
+                << "\n"
+                << "Options:\n"
+                << "  --sample-rate <rate>    sample rate (default 48000)\n"
+                << "  --out <file>            write the json here instead of to stdout\n"
+                << "  -h, --help              show this help\n"
+                << "\n"
+                << "Dsp benchmarks:\n"
+                << "  --buffer-sizes <list>   comma separated buffer sizes to run at (default 64,256,1024)\n"
+                << "  --min-time-ms <ms>      how long to time each benchmark for (default 200)\n"
+                << "  --filter <text>         only run the benchmarks whose name contains this\n"
+                << "\n"
+                << "Load test:\n"
+                << "  --load <file.bsk>       save state to load and run\n"
+                << "  --buffer-size <size>    buffer size to run it at (default 256)\n"
+                << "  --duration <seconds>    how much audio to time, at each instance count (default 10)\n"
+                << "  --instances <count>     duplicate a prefab until there are this many, measuring each step (default 1)\n"
+                << "  --prefab <name>         the prefab to duplicate (default: the first one in the patch)\n"
+                << "\n"
+                << "Replay (capture one with the \"replay\" console command):\n"
+                << "  --replay <file.bsr>     capture to run again, at the sample rate and buffer size it was captured at\n"
+                << "  --trace <file.json>     also save the profiler timeline of the run, as chrome trace json\n";
+   }
+
+   bool ParseOptions(int argc, char* argv[], BenchOptions& options)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         juce::String argument = argv[i];
+         bool hasValue = i + 1 < argc;
+         if (argument == "-h" || argument == "--help")
+         {
+            PrintUsage();
+            return false;
+         }
+         else if (argument == "--buffer-sizes" && hasValue)
+         {
+            options.mBufferSizes.clear();
+            for (const auto& size : juce::StringArray::fromTokens(argv[++i], ",", ""))
+            {
+               int bufferSize = size.getIntValue();
+               if (bufferSize <= 0 || !juce::isPowerOfTwo(bufferSize))
+               {
+                  std::cerr << "buffer sizes need to be powers of two, got " << size << "\n";
+                  return false;
+               }
+               options.mBufferSizes.push_back(bufferSize);
+            }
+         }
+         else if (argument == "--sample-rate" && hasValue)
+         {
+            options.mSampleRate = juce::String(argv[++i]).getIntValue();
+         }
+         else if (argument == "--min-time-ms" && hasValue)
+         {
+            options.mMinTimeMs = juce::String(argv[++i]).getDoubleValue();
+         }
+         else if (argument == "--filter" && hasValue)
+         {
+            options.mFilter = argv[++i];
+         }
+         else if (argument == "--out" && hasValue)
+         {
+            options.mOutputPath = argv[++i];
+         }
+         else if (argument == "--load" && hasValue)
+         {
+            options.mLoadPath = argv[++i];
+         }
+         else if (argument == "--buffer-size" && hasValue)
+         {
+            options.mLoadBufferSize = juce::String(argv[++i]).getIntValue();
+         }
+         else if (argument == "--duration" && hasValue)
+         {
+            options.mDurationSeconds = juce::String(argv[++i]).getDoubleValue();
+         }
+         else if (argument == "--instances" && hasValue)
+         {
+            options.mInstances = juce::String(argv[++i]).getIntValue();
+         }
+         else if (argument == "--prefab" && hasValue)
+         {
+            options.mPrefabName = argv[++i];
+         }
+         else if (argument == "--replay" && hasValue)
+         {
+            options.mReplayPath = argv[++i];
+         }
+         else if (argument == "--trace" && hasValue)
+         {
+            options.mTracePath = argv[++i];
+         }
+         else
+         {
+            std::cerr << "unknown or incomplete option " << argument << "\n\n";
+            PrintUsage();
+            return false;
+         }
+      }
+
+      if (options.mBufferSizes.empty() || options.mSampleRate <= 0 || options.mMinTimeMs <= 0 ||
+          options.mLoadBufferSize <= 0 || options.mDurationSeconds <= 0 || options.mInstances <= 0)
+      {
+         PrintUsage();
+         return false;
+      }
+      return true;
+   }
+}
+
+//VSTScanner.cpp uses this, the app defines it in Main.cpp
+juce::ApplicationProperties& getAppProperties()
+{
+   return *sAppProperties;
+}
+
+int main(int argc, char* argv[])
+{
+   BenchOptions options;
+   if (!ParseOptions(argc, argv, options))
+      return 1;
+
+   juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+   juce::PropertiesFile::Options propertiesOptions;
+   propertiesOptions.applicationName = "Bespoke Synth";
+   propertiesOptions.filenameSuffix = "settings";
+   propertiesOptions.osxLibrarySubFolder = "Preferences";
+   sAppProperties = std::make_unique<juce::ApplicationProperties>();
+   sAppProperties->setStorageParameters(propertiesOptions);
+
+   //a replay runs the way it was captured
+   bool isReplay = !options.mReplayPath.empty();
+   ReplayRunner replay(options.mReplayPath);
+   if (isReplay && !replay.ReadCapture())
+      return 1;
+
+   //the dsp benchmarks run everything at or below the global buffer size, a patch runs at exactly it
+   bool isLoadTest = !options.mLoadPath.empty();
+   int bufferSize = options.mLoadBufferSize;
+   if (isReplay)
+   {
+      bufferSize = replay.GetBufferSize();
+   }
+   else if (!isLoadTest)
+   {
+      bufferSize = 0;
+      for (int size : options.mBufferSizes)
+         bufferSize = MAX(bufferSize, size);
+   }
+
+   {
+      //the same bring up as MainContentComponent, minus the window, the gl context and the audio device.
+      //everything but a replay runs at oversampling 1 here, so that the numbers compare across machines with different prefs
+      auto synth = std::make_unique<ModularSynth>();
+      juce::AudioDeviceManager deviceManager;
+      juce::AudioFormatManager formatManager;
+
+      UserPrefs.Init();
+      UserPrefs.oversampling.Get() = isReplay ? replay.GetOversampling() : 1;
+      UserPrefs.internal_block_size.Get() = isReplay ? replay.GetBlockSize() : 0;
+      if (!isReplay)
+         UserPrefs.cpu_governor_budget_percent.Get() = 0; //measure at full quality, rather than what the governor trades it down to
+      SetGlobalSampleRateAndBufferSize(isReplay ? replay.GetSampleRate() : options.mSampleRate, bufferSize);
+      synth->Setup(&deviceManager, &formatManager, nullptr, nullptr);
+      if (isReplay)
+         synth->InitIOBuffers(replay.GetNumInputChannels(), replay.GetNumOutputChannels());
+      else
+         synth->InitIOBuffers(0, 2);
+
+      ofxJSONElement root;
+      root["version"] = Bespoke::VERSION;
+      root["gitHash"] = Bespoke::GIT_HASH;
+      root["buildArch"] = Bespoke::BUILD_ARCH;
+      root["sampleRate"] = gSampleRate;
+
+      if (isReplay)
+      {
+         if (!replay.Run(options.mTracePath))
+            return 1;
+         replay.WriteResults(root);
+      }
+      else if (isLoadTest)
+      {
+         LoadTest loadTest(options.mLoadPath, options.mDurationSeconds, options.mPrefabName, options.mInstances);
+         if (!loadTest.Run())
+            return 1;
+         loadTest.WriteResults(root);
+      }
+      else
+      {
+         DspBenchmark benchmark(options.mBufferSizes, options.mMinTimeMs, options.mFilter);
+         benchmark.RunAll();
+         benchmark.WriteResults(root);
+      }
+
+      if (!options.mOutputPath.empty())
+      {
+         if (!root.save(options.mOutputPath, true))
+         {
+            std::cerr << "couldn't write " << options.mOutputPath << "\n";
+            return 1;
+         }
+         std::cerr << "results written to " << options.mOutputPath << "\n";
+      }
+      else
+      {
+         std::cout << root.getRawString(true) << "\n";
+      }
+   }
+
+   sAppProperties.reset();
+   return 0;
+}
@@ -0,0 +1,213 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    BiquadCascade.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "BiquadCascade.h"
+#include "BiquadFilter.h"
+#include "ChannelBuffer.h"
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+void BiquadCascade::SetNumStages(int numStages)
+{
+   assert(numStages >= 0 && numStages <= kMaxStages);
+   mNumStages = numStages;
+}
+
+void BiquadCascade::SetStageCoefficients(int stage, const BiquadFilter& design, bool interpolate /*= true*/)
+{
+   Coefficients& target = mStages[stage].mTarget;
+   design.GetCoefficients(target.mA0, target.mA1, target.mA2, target.mB1, target.mB2);
+   if (!interpolate)
+      mStages[stage].mCurrent = target;
+   mStages[stage].mRamping = interpolate;
+}
+
+void BiquadCascade::Clear()
+{
+   for (int i = 0; i < kMaxStages; ++i)
+      ClearStage(i);
+}
+
+void BiquadCascade::ClearStage(int stage)
+{
+   mStages[stage].mZ1.fill(0);
+   mStages[stage].mZ2.fill(0);
+}
+
+void BiquadCascade::Process(ChannelBuffer* buffer, int offset /*= 0*/, int length /*= -1*/)
+{
+   if (length == -1)
+      length = buffer->BufferSize() - offset;
+
+   float* channels[kMaxChannels];
+   int numChannels = buffer->NumActiveChannels();
+   assert(numChannels <= kMaxChannels); //only a buffer widened with SetMaxAllowedChannels() could have more
+   numChannels = MIN(numChannels, kMaxChannels);
+   for (int ch = 0; ch < numChannels; ++ch)
+      channels[ch] = buffer->GetChannel(ch) + offset;
+
+   Process(channels, numChannels, length);
+}
+
+void BiquadCascade::Process(float* const* channels, int numChannels, int bufferSize)
+{
+   assert(numChannels <= kMaxChannels);
+   if (bufferSize <= 0)
+      return;
+
+   for (int i = 0; i < mNumStages; ++i)
+   {
+      Stage& stage = mStages[i];
+      if (!stage.mEnabled)
+         continue;
+
+      if (stage.mRamping)
+      {
+         ProcessStage<true>(stage, channels, numChannels, bufferSize);
+         stage.mCurrent = stage.mTarget;
+         stage.mRamping = false;
+      }
+      else
+      {
+         ProcessStage<false>(stage, channels, numChannels, bufferSize);
+      }
+
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         if (std::isnan(stage.mZ1[ch]) || std::isinf(stage.mZ1[ch]) || std::isnan(stage.mZ2[ch]) || std::isinf(stage.mZ2[ch]))
+         {
+            stage.mZ1[ch] = 0;
+            stage.mZ2[ch] = 0;
+         }
+      }
+   }
+}
+
+template <bool kRamping>
+void BiquadCascade::ProcessStage(Stage& stage, float* const* channels, int numChannels, int bufferSize)
+{
+   double da0 = 0, da1 = 0, da2 = 0, db1 = 0, db2 = 0;
+   if (kRamping)
+   {
+      double inv = 1.0 / bufferSize;
+      da0 = (stage.mTarget.mA0 - stage.mCurrent.mA0) * inv;
+      da1 = (stage.mTarget.mA1 - stage.mCurrent.mA1) * inv;
+      da2 = (stage.mTarget.mA2 - stage.mCurrent.mA2) * inv;
+      db1 = (stage.mTarget.mB1 - stage.mCurrent.mB1) * inv;
+      db2 = (stage.mTarget.mB2 - stage.mCurrent.mB2) * inv;
+   }
+
+   //every channel sees the same coefficient ramp, so channels can run one after another (or in pairs) with identical results
+   int ch = 0;
+#if defined(__wasm_simd128__)
+   for (; ch + 1 < numChannels; ch += 2)
+   {
+      //two channels in the f64x2 lanes, so a stereo stage is a single vector pass
+      double a0 = stage.mCurrent.mA0;
+      double a1 = stage.mCurrent.mA1;
+      double a2 = stage.mCurrent.mA2;
+      double b1 = stage.mCurrent.mB1;
+      double b2 = stage.mCurrent.mB2;
+
+      v128_t vA0 = wasm_f64x2_splat(a0);
+      v128_t vA1 = wasm_f64x2_splat(a1);
+      v128_t vA2 = wasm_f64x2_splat(a2);
+      v128_t vB1 = wasm_f64x2_splat(b1);
+      v128_t vB2 = wasm_f64x2_splat(b2);
+
+      float* left = channels[ch];
+      float* right = channels[ch + 1];
+      v128_t z1 = wasm_f64x2_make(stage.mZ1[ch], stage.mZ1[ch + 1]);
+      v128_t z2 = wasm_f64x2_make(stage.mZ2[ch], stage.mZ2[ch + 1]);
+
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         if (kRamping)
+         {
+            a0 += da0;
+            a1 += da1;
+            a2 += da2;
+            b1 += db1;
+            b2 += db2;
+            vA0 = wasm_f64x2_splat(a0);
+            vA1 = wasm_f64x2_splat(a1);
+            vA2 = wasm_f64x2_splat(a2);
+            vB1 = wasm_f64x2_splat(b1);
+            vB2 = wasm_f64x2_splat(b2);
+         }
+
+         v128_t in = wasm_f64x2_make(left[i], right[i]);
+         v128_t out = wasm_f64x2_add(wasm_f64x2_mul(in, vA0), z1);
+         z1 = wasm_f64x2_sub(wasm_f64x2_add(wasm_f64x2_mul(in, vA1), z2), wasm_f64x2_mul(vB1, out));
+         z2 = wasm_f64x2_sub(wasm_f64x2_mul(in, vA2), wasm_f64x2_mul(vB2, out));
+         left[i] = wasm_f64x2_extract_lane(out, 0);
+         right[i] = wasm_f64x2_extract_lane(out, 1);
+      }
+
+      stage.mZ1[ch] = wasm_f64x2_extract_lane(z1, 0);
+      stage.mZ1[ch + 1] = wasm_f64x2_extract_lane(z1, 1);
+      stage.mZ2[ch] = wasm_f64x2_extract_lane(z2, 0);
+      stage.mZ2[ch + 1] = wasm_f64x2_extract_lane(z2, 1);
+   }
+#endif
+
+   for (; ch < numChannels; ++ch)
+   {
+      //keep everything in locals, so the filter state can live in registers for the length of the block
+      double a0 = stage.mCurrent.mA0;
+      double a1 = stage.mCurrent.mA1;
+      double a2 = stage.mCurrent.mA2;
+      double b1 = stage.mCurrent.mB1;
+      double b2 = stage.mCurrent.mB2;
+
+      float* samples = channels[ch];
+      double z1 = stage.mZ1[ch];
+      double z2 = stage.mZ2[ch];
+
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         if (kRamping)
+         {
+            a0 += da0;
+            a1 += da1;
+            a2 += da2;
+            b1 += db1;
+            b2 += db2;
+         }
+
+         double in = samples[i];
+         double out = in * a0 + z1;
+         z1 = in * a1 + z2 - b1 * out;
+         z2 = in * a2 - b2 * out;
+         samples[i] = out;
+      }
+
+      stage.mZ1[ch] = z1;
+      stage.mZ2[ch] = z2;
+   }
+}
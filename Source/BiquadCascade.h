@@ -0,0 +1,79 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChannelBuffer.h"
+
+#include <array>
+
+class BiquadFilter;
+
+//a chain of biquads in series, run a block at a time over several channels at once (transposed direct form II).
+//coefficients are taken from BiquadFilters used as "designs", and changes are ramped across the next processed block,
+//so modulated filters only need to recalculate their coefficients once per block instead of every sample.
+class BiquadCascade
+{
+public:
+   static const int kMaxStages = 8;
+   static const int kMaxChannels = ChannelBuffer::kMaxNumChannels > 4 ? ChannelBuffer::kMaxNumChannels : 4; //state for every channel a ChannelBuffer can carry, so none of them goes through dry
+
+   void SetNumStages(int numStages);
+   int GetNumStages() const { return mNumStages; }
+   void SetStageEnabled(int stage, bool enabled) { mStages[stage].mEnabled = enabled; }
+   void SetStageCoefficients(int stage, const BiquadFilter& design, bool interpolate = true);
+   void Clear();
+   void ClearStage(int stage);
+
+   void Process(float* const* channels, int numChannels, int bufferSize);
+   void Process(ChannelBuffer* buffer, int offset = 0, int length = -1);
+
+private:
+   struct Coefficients
+   {
+      double mA0{ 1 };
+      double mA1{ 0 };
+      double mA2{ 0 };
+      double mB1{ 0 };
+      double mB2{ 0 };
+   };
+
+   struct Stage
+   {
+      bool mEnabled{ true };
+      bool mRamping{ false };
+      Coefficients mCurrent;
+      Coefficients mTarget;
+      std::array<double, kMaxChannels> mZ1{};
+      std::array<double, kMaxChannels> mZ2{};
+   };
+
+   template <bool kRamping>
+   static void ProcessStage(Stage& stage, float* const* channels, int numChannels, int bufferSize);
+
+   std::array<Stage, kMaxStages> mStages;
+   int mNumStages{ 1 };
+};
@@ -62,6 +62,14 @@ public:
    void SetFilterParams(double f, double q);
    void UpdateFilterCoeff();
    void CopyCoeffFrom(BiquadFilter& other);
+   void GetCoefficients(double& a0, double& a1, double& a2, double& b1, double& b2) const
+   {
+      a0 = mA0;
+      a1 = mA1;
+      a2 = mA2;
+      b1 = mB1;
+      b2 = mB2;
+   }
    bool UsesGain() { return mType == kFilterType_Peak || mType == kFilterType_HighShelf || mType == kFilterType_LowShelf; }
    bool UsesQ() { return true; } // return mType == kFilterType_Lowpass || mType == kFilterType_Highpass || mType == kFilterType_Bandpass || mType == kFilterType_Notch || mType == kFilterType_Peak; }
    float GetMagnitudeResponseAt(float f);
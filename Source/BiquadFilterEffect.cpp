@@ -36,10 +36,10 @@ BiquadFilterEffect::BiquadFilterEffect()
 void BiquadFilterEffect::CreateUIControls()
 {
    IDrawableModule::CreateUIControls();
-   mTypeSelector = new RadioButton(this, "type", 4, 52, (int*)(&mBiquad[0].mType), kRadioHorizontal);
-   mFSlider = new FloatSlider(this, "F", 4, 4, 80, 15, &mBiquad[0].mF, 10, 4000);
-   mQSlider = new FloatSlider(this, "Q", 4, 20, 80, 15, &mBiquad[0].mQ, .1f, 18, 3);
-   mGSlider = new FloatSlider(this, "G", 4, 36, 80, 15, &mBiquad[0].mDbGain, -96, 96, 1);
+   mTypeSelector = new RadioButton(this, "type", 4, 52, (int*)(&mBiquad.mType), kRadioHorizontal);
+   mFSlider = new FloatSlider(this, "F", 4, 4, 80, 15, &mBiquad.mF, 10, 4000);
+   mQSlider = new FloatSlider(this, "Q", 4, 20, 80, 15, &mBiquad.mQ, .1f, 18, 3);
+   mGSlider = new FloatSlider(this, "G", 4, 36, 80, 15, &mBiquad.mDbGain, -96, 96, 1);
 
    mTypeSelector->AddLabel("lp", kFilterType_Lowpass);
    mTypeSelector->AddLabel("hp", kFilterType_Highpass);
@@ -50,8 +50,8 @@ void BiquadFilterEffect::CreateUIControls()
    mFSlider->SetMaxValueDisplay("inf");
    mFSlider->SetMode(FloatSlider::kSquare);
    mQSlider->SetMode(FloatSlider::kSquare);
-   mQSlider->SetShowing(mBiquad[0].UsesQ());
-   mGSlider->SetShowing(mBiquad[0].UsesGain());
+   mQSlider->SetShowing(mBiquad.UsesQ());
+   mGSlider->SetShowing(mBiquad.UsesGain());
 }
 
 BiquadFilterEffect::~BiquadFilterEffect()
@@ -77,29 +77,28 @@ void BiquadFilterEffect::ProcessAudio(double time, ChannelBuffer* buffer)
 
    const float fadeOutStart = mFSlider->GetMax() * .75f;
    const float fadeOutEnd = mFSlider->GetMax();
-   bool fadeOut = mBiquad[0].mF > fadeOutStart && mBiquad[0].mType == kFilterType_Lowpass;
+   bool fadeOut = mBiquad.mF > fadeOutStart && mBiquad.mType == kFilterType_Lowpass;
    if (fadeOut)
       mDryBuffer.CopyFrom(buffer);
 
-   for (int i = 0; i < bufferSize; ++i)
+   //recalculate the filter every few samples while it's being modulated, and let the cascade ramp the coefficients in between
+   for (int offset = 0; offset < bufferSize; offset += kModulationBlockSize)
    {
-      ComputeSliders(i);
+      ComputeSliders(offset);
       if (mCoefficientsHaveChanged)
       {
-         mBiquad[0].UpdateFilterCoeff();
-         for (int ch = 1; ch < buffer->NumActiveChannels(); ++ch)
-            mBiquad[ch].CopyCoeffFrom(mBiquad[0]);
+         mBiquad.UpdateFilterCoeff();
+         mCascade.SetStageCoefficients(0, mBiquad);
          mCoefficientsHaveChanged = false;
       }
-      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-         buffer->GetChannel(ch)[i] = mBiquad[ch].Filter(buffer->GetChannel(ch)[i]);
+      mCascade.Process(buffer, offset, MIN(kModulationBlockSize, (int)bufferSize - offset));
    }
 
    if (fadeOut)
    {
       for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
       {
-         float dryness = ofMap(mBiquad[0].mF, fadeOutStart, fadeOutEnd, 0, 1);
+         float dryness = ofMap(mBiquad.mF, fadeOutStart, fadeOutEnd, 0, 1);
          Mult(buffer->GetChannel(ch), 1 - dryness, bufferSize);
          Mult(mDryBuffer.GetChannel(ch), dryness, bufferSize);
          Add(buffer->GetChannel(ch), mDryBuffer.GetChannel(ch), bufferSize);
@@ -131,7 +130,7 @@ void BiquadFilterEffect::DrawModule()
       float freq = FreqForPos(x / w);
       if (freq < gSampleRate / 2)
       {
-         float response = mBiquad[0].GetMagnitudeResponseAt(freq);
+         float response = mBiquad.GetMagnitudeResponseAt(freq);
          ofVertex(x, (.5f - .666f * log10(response)) * h);
       }
    }
@@ -142,14 +141,14 @@ float BiquadFilterEffect::GetEffectAmount()
 {
    if (!mEnabled)
       return 0;
-   if (mBiquad[0].mType == kFilterType_Lowpass)
-      return ofClamp(1 - (mBiquad[0].mF / (mFSlider->GetMax() * .75f)), 0, 1);
-   if (mBiquad[0].mType == kFilterType_Highpass)
-      return ofClamp(mBiquad[0].mF / (mFSlider->GetMax() * .75f), 0, 1);
-   if (mBiquad[0].mType == kFilterType_Bandpass)
-      return ofClamp(.3f + (mBiquad[0].mQ / mQSlider->GetMax()), 0, 1);
-   if (mBiquad[0].mType == kFilterType_Peak)
-      return ofClamp(fabsf(mBiquad[0].mDbGain / 96), 0, 1);
+   if (mBiquad.mType == kFilterType_Lowpass)
+      return ofClamp(1 - (mBiquad.mF / (mFSlider->GetMax() * .75f)), 0, 1);
+   if (mBiquad.mType == kFilterType_Highpass)
+      return ofClamp(mBiquad.mF / (mFSlider->GetMax() * .75f), 0, 1);
+   if (mBiquad.mType == kFilterType_Bandpass)
+      return ofClamp(.3f + (mBiquad.mQ / mQSlider->GetMax()), 0, 1);
+   if (mBiquad.mType == kFilterType_Peak)
+      return ofClamp(fabsf(mBiquad.mDbGain / 96), 0, 1);
    return 0;
 }
 
@@ -161,19 +160,17 @@ void BiquadFilterEffect::GetModuleDimensions(float& width, float& height)
 
 void BiquadFilterEffect::Clear()
 {
-   for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
-      mBiquad[i].Clear();
+   mCascade.Clear();
 }
 
 void BiquadFilterEffect::ResetFilter()
 {
-   if (mBiquad[0].mType == kFilterType_Lowpass)
-      mBiquad[0].SetFilterParams(mFSlider->GetMax(), sqrt(2) / 2);
-   if (mBiquad[0].mType == kFilterType_Highpass)
-      mBiquad[0].SetFilterParams(mFSlider->GetMin(), sqrt(2) / 2);
+   if (mBiquad.mType == kFilterType_Lowpass)
+      mBiquad.SetFilterParams(mFSlider->GetMax(), sqrt(2) / 2);
+   if (mBiquad.mType == kFilterType_Highpass)
+      mBiquad.SetFilterParams(mFSlider->GetMin(), sqrt(2) / 2);
 
-   for (int ch = 1; ch < ChannelBuffer::kMaxNumChannels; ++ch)
-      mBiquad[ch].CopyCoeffFrom(mBiquad[0]);
+   mCascade.SetStageCoefficients(0, mBiquad, false);
 
    Clear();
 }
@@ -186,12 +183,12 @@ void BiquadFilterEffect::RadioButtonUpdated(RadioButton* list, int oldVal, doubl
 {
    if (list == mTypeSelector)
    {
-      if (mBiquad[0].mType == kFilterType_Lowpass)
-         mBiquad[0].SetFilterParams(mFSlider->GetMax(), sqrt(2) / 2);
-      if (mBiquad[0].mType == kFilterType_Highpass)
-         mBiquad[0].SetFilterParams(mFSlider->GetMin(), sqrt(2) / 2);
-      mQSlider->SetShowing(mBiquad[0].UsesQ());
-      mGSlider->SetShowing(mBiquad[0].UsesGain());
+      if (mBiquad.mType == kFilterType_Lowpass)
+         mBiquad.SetFilterParams(mFSlider->GetMax(), sqrt(2) / 2);
+      if (mBiquad.mType == kFilterType_Highpass)
+         mBiquad.SetFilterParams(mFSlider->GetMin(), sqrt(2) / 2);
+      mQSlider->SetShowing(mBiquad.UsesQ());
+      mGSlider->SetShowing(mBiquad.UsesGain());
       mCoefficientsHaveChanged = true;
    }
 }
@@ -216,10 +213,7 @@ bool BiquadFilterEffect::MouseMoved(float x, float y)
 void BiquadFilterEffect::CheckboxUpdated(Checkbox* checkbox, double time)
 {
    if (checkbox == mEnabledCheckbox)
-   {
-      for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
-         mBiquad[i].Clear();
-   }
+      mCascade.Clear();
 }
 
 void BiquadFilterEffect::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
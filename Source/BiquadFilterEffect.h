@@ -29,6 +29,7 @@
 #include "DropdownList.h"
 #include "Slider.h"
 #include "BiquadFilter.h"
+#include "BiquadCascade.h"
 #include "RadioButton.h"
 
 class BiquadFilterEffect : public IAudioEffect, public IDropdownListener, public IFloatSliderListener, public IRadioButtonListener
@@ -44,8 +45,16 @@ public:
 
    void Init() override;
 
-   void SetFilterType(FilterType type) { mBiquad[0].SetFilterType(type); }
-   void SetFilterParams(float f, float q) { mBiquad[0].SetFilterParams(f, q); }
+   void SetFilterType(FilterType type)
+   {
+      mBiquad.SetFilterType(type);
+      mCoefficientsHaveChanged = true;
+   }
+   void SetFilterParams(float f, float q)
+   {
+      mBiquad.SetFilterParams(f, q);
+      mCoefficientsHaveChanged = true;
+   }
    void Clear();
 
    //IAudioEffect
@@ -53,6 +62,7 @@ public:
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    float GetEffectAmount() override;
    std::string GetType() override { return "biquad"; }
+   void ResetAudioState() override { Clear(); }
 
    bool MouseMoved(float x, float y) override;
 
@@ -81,7 +91,10 @@ private:
    FloatSlider* mGSlider{ nullptr };
    bool mMouseControl{ false };
 
-   BiquadFilter mBiquad[ChannelBuffer::kMaxNumChannels];
+   static const int kModulationBlockSize = 16;
+
+   BiquadFilter mBiquad; //holds the parameters, and calculates the coefficients for mCascade
+   BiquadCascade mCascade;
    ChannelBuffer mDryBuffer;
 
    bool mCoefficientsHaveChanged{ true };
@@ -39,7 +39,13 @@ void BitcrushEffect::CreateUIControls()
    UIBLOCK0();
    FLOATSLIDER(mCrushSlider, "crush", &mCrush, 1, 24);
    FLOATSLIDER_DIGITS(mDownsampleSlider, "downsamp", &mDownsample, 1, 40, 0);
+   DROPDOWN(mOversampleDropdown, "oversample", &mOversample, 40);
    ENDUIBLOCK(mWidth, mHeight);
+
+   mOversampleDropdown->AddLabel("1x", 1);
+   mOversampleDropdown->AddLabel("2x", 2);
+   mOversampleDropdown->AddLabel("4x", 4);
+   mOversampleDropdown->AddLabel("8x", 8);
 }
 
 void BitcrushEffect::ProcessAudio(double time, ChannelBuffer* buffer)
@@ -49,31 +55,38 @@ void BitcrushEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
+   int factor = mOversample;
+   mOversampler.SetFactor(factor);
 
    ComputeSliders(0);
 
-   float bitDepth = powf(2, 25 - mCrush);
-   float invBitDepth = 1.f / bitDepth;
+   mKernel.Set(mSampleCounter, mHeldDownsample, (int)mDownsample * factor, powf(2, 25 - mCrush)); //downsamp stays in base rate samples
 
    for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
    {
-      for (int i = 0; i < bufferSize; ++i)
-      {
-         if (mSampleCounter[ch] < (int)mDownsample - 1)
-         {
-            ++mSampleCounter[ch];
-         }
-         else
-         {
-            mHeldDownsample[ch] = buffer->GetChannel(ch)[i];
-            mSampleCounter[ch] = 0;
-         }
-         buffer->GetChannel(ch)[i] = ((int)(mHeldDownsample[ch] * bitDepth)) * invBitDepth;
-      }
+      float* samples = buffer->GetChannel(ch);
+      if (factor > 1)
+         samples = mOversampler.Upsample(ch, samples, bufferSize);
+
+      mKernel.Run(ch, samples, 0, bufferSize * factor);
+
+      if (factor > 1)
+         mOversampler.Downsample(ch, samples, buffer->GetChannel(ch), bufferSize);
    }
 }
 
+SampleKernel* BitcrushEffect::BeginSampleKernel(double time, int bufferSize)
+{
+   if (mOversample > 1)
+      return nullptr; //the oversampler wants the whole buffer
+
+   mOversampler.SetFactor(1);
+   ComputeSliders(0);
+   mKernel.Set(mSampleCounter, mHeldDownsample, (int)mDownsample, powf(2, 25 - mCrush));
+   return &mKernel;
+}
+
 void BitcrushEffect::DrawModule()
 {
    if (!mEnabled)
@@ -81,6 +94,7 @@ void BitcrushEffect::DrawModule()
 
    mDownsampleSlider->Draw();
    mCrushSlider->Draw();
+   mOversampleDropdown->Draw();
 }
 
 float BitcrushEffect::GetEffectAmount()
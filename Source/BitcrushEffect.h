@@ -28,8 +28,11 @@
 #include "IAudioEffect.h"
 #include "Slider.h"
 #include "Checkbox.h"
+#include "DropdownList.h"
+#include "Oversampler.h"
+#include "SampleKernel.h"
 
-class BitcrushEffect : public IAudioEffect, public IIntSliderListener, public IFloatSliderListener
+class BitcrushEffect : public IAudioEffect, public IIntSliderListener, public IFloatSliderListener, public IDropdownListener
 {
 public:
    BitcrushEffect();
@@ -44,10 +47,13 @@ public:
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    float GetEffectAmount() override;
    std::string GetType() override { return "bitcrush"; }
+   int GetTailLengthSamples() override { return (int)mDownsample + mOversampler.GetLatencySamples(); } //the last held sample
+   SampleKernel* BeginSampleKernel(double time, int bufferSize) override;
 
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
    void IntSliderUpdated(IntSlider* slider, int oldVal, double time) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
+   void DropdownUpdated(DropdownList* list, int oldVal, double time) override {}
 
    bool IsEnabled() const override { return mEnabled; }
 
@@ -61,4 +67,8 @@ private:
    float mHeldDownsample[ChannelBuffer::kMaxNumChannels]{};
    FloatSlider* mCrushSlider{ nullptr };
    FloatSlider* mDownsampleSlider{ nullptr };
+   int mOversample{ 1 };
+   DropdownList* mOversampleDropdown{ nullptr };
+   Oversampler mOversampler;
+   BitcrushKernel mKernel;
 };
@@ -56,6 +56,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //records its input
 
    //INoteReceiver
    void PlayNote(NoteMessage note) override;
@@ -30,6 +30,10 @@
 #include "ModularSynth.h"
 #include "PatchCableSource.h"
 #include "Snapshots.h"
+#include "nanovg/nanovg.h"
+
+#include <algorithm>
+#include <cstring>
 
 Canvas::Canvas(IDrawableModule* parent, int x, int y, int w, int h, float length, int rows, int cols, CreateCanvasElementFn elementCreator)
 : mWidth(w)
@@ -80,34 +84,36 @@ void Canvas::Render()
    }
    ofPopStyle();
 
-   for (int i = 0; i < GetNumCols(); ++i)
+   //the grid and the elements are only laid out again when the view or an element changes, so a moving cursor costs a handful of paths
+   mVisibleElements.clear();
+   GetElementsOverlapping(mViewStart / mLength, mViewEnd / mLength, !K(includeWrapped), mVisibleElements);
+   uint64_t signature = CalculateRenderSignature();
+   if (!mHasRenderBatches || signature != mRenderSignature)
    {
-      float pos = ofMap(float(i) / GetNumCols(), mViewStart / mLength, mViewEnd / mLength, 0, 1) * GetWidth();
-      if (pos >= 0 && pos < GetWidth())
-      {
-         ofPushStyle();
-         if (mMajorColumnInterval != -1 && i % mMajorColumnInterval == 0)
-            ofSetColor(255, 255, 255);
-         ofLine(pos, 0, pos, GetHeight());
-         ofPopStyle();
-      }
+      RebuildRenderBatches();
+      mRenderSignature = signature;
+      mHasRenderBatches = true;
    }
 
-   for (int i = 0; i < mElements.size(); ++i)
-   {
-      //ofMap(GetStart() + offset,mCanvas->mStart/mCanvas->GetLength(),mCanvas->mEnd/mCanvas->GetLength(),0,1,clamp)
-      bool visibleOnCanvas = mElements[i]->mRow >= mRowOffset && mElements[i]->mRow < mRowOffset + GetNumVisibleRows() &&
-                             mElements[i]->GetStart() <= mViewEnd / GetLength() && mElements[i]->GetEnd() >= mViewStart / GetLength();
-      if (visibleOnCanvas)
-      {
-         ofVec2f offset(0, 0);
-         if (mClick && mClickedElement != nullptr && mElements[i]->GetHighlighted() && mDragEnd == kHighlightEnd_None)
-            offset = (ofVec2f(TheSynth->GetRawMouseX(), TheSynth->GetRawMouseY()) - mClickedElementStartMousePos) / gDrawScale;
-         mElements[i]->Draw(offset);
-      }
+   DrawColumnLines(mColumnLines);
+   ofPushStyle();
+   ofSetColor(255, 255, 255);
+   DrawColumnLines(mMajorColumnLines);
+   ofPopStyle();
+
+   ofPushStyle();
+   ofSetLineWidth(1);
+   DrawRectBatch(mOffscreenBatch);
+   ofPopStyle();
+   DrawRectBatch(mElementFillBatch);
+   DrawRectBatch(mElementShadeBatch);
 
-      if (!visibleOnCanvas)
-         mElements[i]->DrawOffscreen();
+   for (auto* element : mLiveElements)
+   {
+      ofVec2f offset(0, 0);
+      if (mClick && mClickedElement != nullptr && element->GetHighlighted() && mDragEnd == kHighlightEnd_None)
+         offset = (ofVec2f(TheSynth->GetRawMouseX(), TheSynth->GetRawMouseY()) - mClickedElementStartMousePos) / gDrawScale;
+      element->Draw(offset);
    }
 
    if (mDragSelecting)
@@ -131,9 +137,141 @@ void Canvas::Render()
    ofPopMatrix();
 }
 
+uint64_t Canvas::CalculateRenderSignature() const
+{
+   uint64_t hash = 14695981039346656037ull;
+   auto mix = [&hash](uint64_t value)
+   {
+      hash ^= value;
+      hash *= 1099511628211ull;
+   };
+   auto mixFloat = [&mix](float value)
+   {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      mix(bits);
+   };
+
+   mixFloat(mViewStart);
+   mixFloat(mViewEnd);
+   mixFloat(mLength);
+   mixFloat(mWidth);
+   mixFloat(mHeight);
+   mix(mRowOffset);
+   mix(GetNumVisibleRows());
+   mix(mNumCols);
+   mix(mMajorColumnInterval);
+   mix(mWrap);
+   mix(mElements.size());
+   mix(mElementChangeCount);
+   //selecting, and edits made without InvalidateElementIndex(), only show on the elements in view
+   for (const auto* element : mVisibleElements)
+   {
+      mix(reinterpret_cast<uintptr_t>(element));
+      mix(element->mRow);
+      mix(element->mCol);
+      mixFloat(element->mOffset);
+      mixFloat(element->mLength);
+      mix(element->GetHighlighted());
+   }
+   return hash;
+}
+
+void Canvas::RebuildRenderBatches()
+{
+   mColumnLines.clear();
+   mMajorColumnLines.clear();
+   for (int i = 0; i < GetNumCols(); ++i)
+   {
+      float pos = ofMap(float(i) / GetNumCols(), mViewStart / mLength, mViewEnd / mLength, 0, 1) * GetWidth();
+      if (pos >= 0 && pos < GetWidth())
+      {
+         if (mMajorColumnInterval != -1 && i % mMajorColumnInterval == 0)
+            mMajorColumnLines.push_back(pos);
+         else
+            mColumnLines.push_back(pos);
+      }
+   }
+
+   mOffscreenBatch.mRects.clear();
+   mElementFillBatch.mRects.clear();
+   mElementShadeBatch.mRects.clear();
+   mLiveElements.clear();
+   auto addRects = [this](const ofRectangle& fill, const ofRectangle& shade)
+   {
+      if (fill.width > 0)
+      {
+         mElementFillBatch.mRects.push_back(fill);
+         mElementShadeBatch.mRects.push_back(shade);
+      }
+   };
+
+   //mVisibleElements comes out of the index in the same order as mElements, so one pass sorts out which is which
+   size_t visibleIndex = 0;
+   for (auto* element : mElements)
+   {
+      bool inView = visibleIndex < mVisibleElements.size() && mVisibleElements[visibleIndex] == element;
+      if (inView)
+         ++visibleIndex;
+      if (!inView || !IsRowVisible(element->mRow))
+      {
+         element->GetOffscreenRects(mOffscreenBatch.mRects);
+         continue;
+      }
+
+      ofRectangle fill, shade, wrappedFill, wrappedShade;
+      bool drawWrapped = mWrap && element->GetEnd() > 1;
+      bool batched = !element->GetHighlighted() && element->GetBatchedRects(!K(wrapped), fill, shade) &&
+                     (!drawWrapped || element->GetBatchedRects(K(wrapped), wrappedFill, wrappedShade));
+      if (!batched)
+      {
+         mLiveElements.push_back(element);
+         continue;
+      }
+      addRects(fill, shade);
+      if (drawWrapped)
+         addRects(wrappedFill, wrappedShade);
+   }
+}
+
+//static
+void Canvas::DrawRectBatch(const RectBatch& batch)
+{
+   if (batch.mRects.empty())
+      return;
+
+   if (batch.mFill)
+      ofFill();
+   else
+      ofNoFill();
+   ofSetColor(batch.mColor);
+   nvgBeginPath(gNanoVG);
+   for (const auto& rect : batch.mRects)
+      nvgRoundedRect(gNanoVG, rect.x, rect.y, rect.width, rect.height, batch.mCornerRadius * gCornerRoundness);
+   if (batch.mFill)
+      nvgFill(gNanoVG);
+   else
+      nvgStroke(gNanoVG);
+}
+
+void Canvas::DrawColumnLines(const std::vector<float>& positions) const
+{
+   if (positions.empty())
+      return;
+
+   nvgBeginPath(gNanoVG);
+   for (float pos : positions)
+   {
+      nvgMoveTo(gNanoVG, pos, 0);
+      nvgLineTo(gNanoVG, pos, GetHeight());
+   }
+   nvgStroke(gNanoVG);
+}
+
 void Canvas::AddElement(CanvasElement* element)
 {
    mElements.push_back(element);
+   InvalidateElementIndex();
 }
 
 void Canvas::RemoveElement(CanvasElement* element)
@@ -141,6 +279,7 @@ void Canvas::RemoveElement(CanvasElement* element)
    if (mListener)
       mListener->ElementRemoved(element);
    RemoveFromVector(element, mElements, !K(fail));
+   InvalidateElementIndex();
    //delete element; TODO(Ryan) figure out how to delete without messing up stuff accessing data from other thread
 }
 
@@ -350,6 +489,7 @@ bool Canvas::MouseMoved(float x, float y)
                }
                for (auto newElement : newElements)
                   mElements.push_back(newElement);
+               InvalidateElementIndex();
             }
          }
       }
@@ -561,6 +701,7 @@ void Canvas::KeyPressed(int key, bool isRepeat)
             if (element->GetHighlighted())
                element->mCol += direction;
          }
+         InvalidateElementIndex();
       }
       if (key == OF_KEY_UP || key == OF_KEY_DOWN)
       {
@@ -574,6 +715,7 @@ void Canvas::KeyPressed(int key, bool isRepeat)
             if (element->GetHighlighted())
                element->mRow += direction;
          }
+         InvalidateElementIndex();
       }
    }
 }
@@ -587,6 +729,7 @@ void Canvas::RescaleNumCols(int cols)
       element->mLength *= ratio;
    }
    mNumCols = cols;
+   InvalidateElementIndex();
 }
 
 void Canvas::SetRowColor(int row, ofColor color)
@@ -611,50 +754,132 @@ juce::MouseCursor Canvas::GetMouseCursorType()
    return MouseCursor::NormalCursor;
 }
 
+void Canvas::UpdateElementIndex() const
+{
+   //event elements size themselves to the current zoom, so the cached ends go stale when the view changes
+   float viewSpan = mViewEnd - mViewStart;
+   if (!mElementIndexDirty && viewSpan == mElementIndexViewSpan && mWidth == mElementIndexWidth)
+      return;
+
+   mElementIndexDirty = false;
+   mElementIndexViewSpan = viewSpan;
+   mElementIndexWidth = mWidth;
+
+   mElementIndex.resize(mElements.size());
+   for (int i = 0; i < (int)mElements.size(); ++i)
+   {
+      IndexedElement& indexed = mElementIndex[i];
+      indexed.mElement = mElements[i];
+      indexed.mStart = mElements[i]->GetStart();
+      indexed.mEnd = mElements[i]->GetEnd();
+      indexed.mOrder = i;
+   }
+
+   std::sort(mElementIndex.begin(), mElementIndex.end(), [](const IndexedElement& a, const IndexedElement& b)
+             { return a.mStart < b.mStart; });
+
+   float maxEnd = -FLT_MAX;
+   for (auto& indexed : mElementIndex)
+   {
+      maxEnd = MAX(maxEnd, indexed.mEnd);
+      indexed.mMaxEnd = maxEnd;
+   }
+
+   mElementIndexResults.reserve(mElementIndex.size());
+}
+
+//fills mElementIndexResults with the elements whose [start, end] touches the range, in the order they appear in mElements.
+//call with mElementIndexMutex held
+void Canvas::CollectIndexedElements(float start, float end, bool includeWrapped) const
+{
+   UpdateElementIndex();
+   mElementIndexResults.clear();
+
+   auto collect = [this](float rangeStart, float rangeEnd)
+   {
+      auto firstAfter = std::upper_bound(mElementIndex.begin(), mElementIndex.end(), rangeEnd, [](float pos, const IndexedElement& indexed)
+                                         { return pos < indexed.mStart; });
+      for (int i = int(firstAfter - mElementIndex.begin()) - 1; i >= 0; --i)
+      {
+         if (mElementIndex[i].mMaxEnd < rangeStart)
+            break; //nothing sorted earlier reaches this far
+         if (mElementIndex[i].mEnd >= rangeStart)
+            mElementIndexResults.push_back(&mElementIndex[i]);
+      }
+   };
+
+   collect(start, end);
+   if (includeWrapped)
+      collect(start + mLength, end + mLength);
+
+   std::sort(mElementIndexResults.begin(), mElementIndexResults.end(), [](const IndexedElement* a, const IndexedElement* b)
+             { return a->mOrder < b->mOrder; });
+   if (includeWrapped)
+      mElementIndexResults.erase(std::unique(mElementIndexResults.begin(), mElementIndexResults.end()), mElementIndexResults.end());
+}
+
+void Canvas::GetElementsOverlapping(float start, float end, bool includeWrapped, std::vector<CanvasElement*>& elements) const
+{
+   std::lock_guard<ofMutex> lock(mElementIndexMutex);
+   CollectIndexedElements(start, end, includeWrapped);
+   for (const auto* indexed : mElementIndexResults)
+      elements.push_back(indexed->mElement);
+}
+
 CanvasElement* Canvas::GetElementAt(float pos, int row)
 {
-   for (int i = 0; i < mElements.size(); ++i)
+   std::lock_guard<ofMutex> lock(mElementIndexMutex);
+   CollectIndexedElements(pos, pos, mWrap);
+   for (const auto* indexed : mElementIndexResults)
    {
-      if (mElements[i]->mRow == row && pos >= mElements[i]->GetStart() && pos < mElements[i]->GetEnd())
-         return mElements[i];
-      else if (mWrap && pos >= mElements[i]->GetStart() - mLength && pos < mElements[i]->GetEnd() - mLength)
-         return mElements[i];
+      if (indexed->mElement->mRow == row && pos >= indexed->mStart && pos < indexed->mEnd)
+         return indexed->mElement;
+      else if (mWrap && pos >= indexed->mStart - mLength && pos < indexed->mEnd - mLength)
+         return indexed->mElement;
    }
    return nullptr;
 }
 
 void Canvas::FillElementsAt(float pos, std::vector<CanvasElement*>& elementsAt) const
 {
-   for (int i = 0; i < mElements.size(); ++i)
+   std::lock_guard<ofMutex> lock(mElementIndexMutex);
+   CollectIndexedElements(pos, pos, mWrap);
+   for (const auto* indexed : mElementIndexResults)
    {
-      if (mElements[i]->mRow == -1 || mElements[i]->mCol == -1 || mElements[i]->mRow >= elementsAt.size())
+      CanvasElement* element = indexed->mElement;
+      if (element->mRow == -1 || element->mCol == -1 || element->mRow >= elementsAt.size())
          continue;
 
       bool on = false;
-      if (pos >= mElements[i]->GetStart() && pos < mElements[i]->GetEnd())
+      if (pos >= indexed->mStart && pos < indexed->mEnd)
          on = true;
-      if (mWrap && pos >= mElements[i]->GetStart() - mLength && pos < mElements[i]->GetEnd() - mLength)
+      if (mWrap && pos >= indexed->mStart - mLength && pos < indexed->mEnd - mLength)
          on = true;
       if (on)
-         elementsAt[mElements[i]->mRow] = mElements[i];
+         elementsAt[element->mRow] = element;
    }
 }
 
 void Canvas::EraseElementsAt(float pos)
 {
    std::vector<CanvasElement*> toErase;
-   for (int i = 0; i < mElements.size(); ++i)
    {
-      if (mElements[i]->mRow == -1 || mElements[i]->mCol == -1)
-         continue;
-
-      bool on = false;
-      if (pos >= mElements[i]->GetStart() && pos < mElements[i]->GetEnd())
-         on = true;
-      if (mWrap && pos >= mElements[i]->GetStart() - mLength && pos < mElements[i]->GetEnd() - mLength)
-         on = true;
-      if (on)
-         toErase.push_back(mElements[i]);
+      std::lock_guard<ofMutex> lock(mElementIndexMutex);
+      CollectIndexedElements(pos, pos, mWrap);
+      for (const auto* indexed : mElementIndexResults)
+      {
+         CanvasElement* element = indexed->mElement;
+         if (element->mRow == -1 || element->mCol == -1)
+            continue;
+
+         bool on = false;
+         if (pos >= indexed->mStart && pos < indexed->mEnd)
+            on = true;
+         if (mWrap && pos >= indexed->mStart - mLength && pos < indexed->mEnd - mLength)
+            on = true;
+         if (on)
+            toErase.push_back(element);
+      }
    }
 
    for (auto* elem : toErase)
@@ -675,6 +900,7 @@ CanvasCoord Canvas::GetCoordAt(int x, int y)
 void Canvas::Clear()
 {
    mElements.clear();
+   InvalidateElementIndex();
 }
 
 namespace
@@ -731,4 +957,5 @@ void Canvas::LoadState(FileStreamIn& in, bool shouldSetValue)
       element->LoadState(in);
       mElements.push_back(element);
    }
+   InvalidateElementIndex();
 }
@@ -30,6 +30,8 @@
 
 #include "juce_gui_basics/juce_gui_basics.h"
 
+#include <atomic>
+
 #define MAX_CANVAS_MASK_ELEMENTS 128
 
 class Canvas;
@@ -91,10 +93,18 @@ public:
    }
    float GetWidth() const { return mWidth; }
    float GetHeight() const { return mHeight; }
-   void SetLength(float length) { mLength = length; }
+   void SetLength(float length)
+   {
+      mLength = length;
+      InvalidateElementIndex();
+   }
    float GetLength() const { return mLength; }
    void SetNumRows(int rows) { mNumRows = rows; }
-   void SetNumCols(int cols) { mNumCols = cols; }
+   void SetNumCols(int cols)
+   {
+      mNumCols = cols;
+      InvalidateElementIndex();
+   }
    int GetNumRows() const { return mNumRows; }
    int GetNumCols() const { return mNumCols; }
    void RescaleNumCols(int cols);
@@ -106,6 +116,12 @@ public:
    CanvasControls* GetControls() { return mControls; }
    std::vector<CanvasElement*>& GetElements() { return mElements; }
    void FillElementsAt(float pos, std::vector<CanvasElement*>& elements) const;
+   void GetElementsOverlapping(float start, float end, bool includeWrapped, std::vector<CanvasElement*>& elements) const;
+   void InvalidateElementIndex() //call after moving or resizing elements from outside of the canvas
+   {
+      mElementIndexDirty = true;
+      ++mElementChangeCount;
+   }
    void EraseElementsAt(float pos);
    CanvasElement* GetElementAt(float pos, int row);
    void SetCursorPos(float pos) { mCursorPos = pos; }
@@ -154,6 +170,31 @@ private:
    bool IsOnElement(CanvasElement* element, float x, float y) const;
    float QuantizeToGrid(float input) const;
 
+   struct IndexedElement
+   {
+      float mStart{ 0 };
+      float mEnd{ 0 };
+      float mMaxEnd{ 0 }; //furthest end of this element and every element sorted before it
+      int mOrder{ 0 }; //position in mElements
+      CanvasElement* mElement{ nullptr };
+   };
+
+   void UpdateElementIndex() const;
+   void CollectIndexedElements(float start, float end, bool includeWrapped) const;
+
+   //rects that share a colour and style, drawn as one path
+   struct RectBatch
+   {
+      ofColor mColor;
+      float mCornerRadius{ 0 };
+      bool mFill{ true };
+      std::vector<ofRectangle> mRects;
+   };
+   uint64_t CalculateRenderSignature() const;
+   void RebuildRenderBatches();
+   static void DrawRectBatch(const RectBatch& batch);
+   void DrawColumnLines(const std::vector<float>& positions) const;
+
    bool mClick{ false };
    CanvasElement* mClickedElement{ nullptr };
    ofVec2f mClickedElementStartMousePos;
@@ -162,6 +203,24 @@ private:
    float mLength;
    ICanvasListener* mListener{ nullptr };
    std::vector<CanvasElement*> mElements;
+   //elements sorted by start time, rebuilt lazily after edits, so playback can look up what's under the cursor without scanning every element
+   mutable std::vector<IndexedElement> mElementIndex;
+   mutable std::vector<const IndexedElement*> mElementIndexResults;
+   mutable std::atomic<bool> mElementIndexDirty{ true };
+   mutable float mElementIndexViewSpan{ 0 };
+   mutable float mElementIndexWidth{ 0 };
+   mutable ofMutex mElementIndexMutex;
+   std::atomic<uint32_t> mElementChangeCount{ 0 };
+   //what Render() draws that only changes with the view or an edit, rebuilt when the render signature changes
+   std::vector<CanvasElement*> mVisibleElements; //found with the element index every frame
+   std::vector<float> mColumnLines;
+   std::vector<float> mMajorColumnLines;
+   RectBatch mOffscreenBatch{ ofColor(255, 255, 255), 3, false };
+   RectBatch mElementFillBatch{ ofColor::white, 0, true };
+   RectBatch mElementShadeBatch{ ofColor(232, 232, 232), 0, true };
+   std::vector<CanvasElement*> mLiveElements; //drawn with Draw() every frame: highlighted elements, which can be dragged and outlined, and ones that can't be batched
+   uint64_t mRenderSignature{ 0 };
+   bool mHasRenderBatches{ false };
    CanvasControls* mControls{ nullptr };
    float mCursorPos{ -1 };
    CreateCanvasElementFn mElementCreator;
@@ -144,6 +144,7 @@ void CanvasControls::FloatSliderUpdated(FloatSlider* slider, float oldVal, doubl
       if (element->GetHighlighted())
          element->FloatSliderUpdated(slider->Name(), oldVal, slider->GetValue(), time);
    }
+   mCanvas->InvalidateElementIndex();
 }
 
 void CanvasControls::IntSliderUpdated(IntSlider* slider, int oldVal, double time)
@@ -153,6 +154,7 @@ void CanvasControls::IntSliderUpdated(IntSlider* slider, int oldVal, double time
       if (element->GetHighlighted())
          element->IntSliderUpdated(slider->Name(), oldVal, slider->GetValue(), time);
    }
+   mCanvas->InvalidateElementIndex();
 }
 
 void CanvasControls::TextEntryComplete(TextEntry* entry)
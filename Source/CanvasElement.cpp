@@ -120,11 +120,8 @@ void CanvasElement::DrawElement(bool clamp, bool wrapped, ofVec2f offset)
    }
 }
 
-void CanvasElement::DrawOffscreen()
+void CanvasElement::GetOffscreenRects(std::vector<ofRectangle>& rects) const
 {
-   ofPushStyle();
-   ofSetLineWidth(1);
-   ofSetColor(255, 255, 255);
    {
       ofRectangle rect = GetRect(K(clamp), !K(wrapped));
       if (rect.y < 0)
@@ -138,7 +135,7 @@ void CanvasElement::DrawOffscreen()
          rect.height = 1;
       }
       rect.width = MAX(rect.width, 1);
-      ofRect(rect);
+      rects.push_back(rect);
    }
    if (mCanvas->ShouldWrap() && GetEnd() > 1)
    {
@@ -154,9 +151,8 @@ void CanvasElement::DrawOffscreen()
          rect.height = 1;
       }
       rect.width = MAX(rect.width, 1);
-      ofRect(rect);
+      rects.push_back(rect);
    }
-   ofPopStyle();
 }
 
 float CanvasElement::GetStart(int col, float offset) const
@@ -184,6 +180,7 @@ void CanvasElement::SetStart(float start, bool preserveLength)
    mOffset = start - mCol;
    if (!preserveLength)
       SetEnd(end);
+   mCanvas->InvalidateElementIndex();
 }
 
 float CanvasElement::GetEnd() const
@@ -194,6 +191,7 @@ float CanvasElement::GetEnd() const
 void CanvasElement::SetEnd(float end)
 {
    mLength = end * mCanvas->GetNumCols() - mCol - mOffset;
+   mCanvas->InvalidateElementIndex();
 }
 
 ofRectangle CanvasElement::GetRect(bool clamp, bool wrapped, ofVec2f offset) const
@@ -255,6 +253,7 @@ void CanvasElement::MoveElementByDrag(ofVec2f dragOffset)
    mRow = newRow;
    mCol = newCol;
    mOffset = newOffset;
+   mCanvas->InvalidateElementIndex();
 }
 
 void CanvasElement::AddElementUIControl(IUIControl* control)
@@ -352,20 +351,39 @@ CanvasElement* NoteCanvasElement::CreateDuplicate() const
    return element;
 }
 
+void NoteCanvasElement::GetNoteRects(bool clamp, bool wrapped, ofVec2f offset, ofRectangle& fill, ofRectangle& shade) const
+{
+   fill = GetRect(clamp, wrapped, offset);
+   float fullHeight = fill.height;
+   fill.height *= mVelocity;
+   fill.y += (fullHeight - fill.height) * .5f;
+
+   //the right half is shaded flat rather than with a gradient, which would need a paint per note and stop whole canvases of them being drawn as one path
+   shade = fill;
+   shade.x += fill.width * .5f;
+   shade.width = fill.width * .5f;
+}
+
+bool NoteCanvasElement::GetBatchedRects(bool wrapped, ofRectangle& fill, ofRectangle& shade) const
+{
+   GetNoteRects(K(clamp), wrapped, ofVec2f(0, 0), fill, shade);
+   return fill.width >= 0; //negative lengths get DrawElement()'s red warning rect
+}
+
 void NoteCanvasElement::DrawContents(bool clamp, bool wrapped, ofVec2f offset)
 {
    ofPushStyle();
    ofFill();
    //DrawTextNormal(ofToString(mVelocity), GetRect(true, false).x, GetRect(true, false).y);
 
-   ofRectangle rect = GetRect(clamp, wrapped, offset);
-   float fullHeight = rect.height;
-   rect.height *= mVelocity;
-   rect.y += (fullHeight - rect.height) * .5f;
-   if (rect.width > 0)
+   ofRectangle fill, shade;
+   GetNoteRects(clamp, wrapped, offset, fill, shade);
+   if (fill.width > 0)
    {
-      ofSetColorGradient(ofColor::white, ofColor(210, 210, 210), ofVec2f(ofLerp(rect.getMinX(), rect.getMaxX(), .5f), rect.y), ofVec2f(rect.getMaxX(), rect.y));
-      ofRect(rect, 0);
+      ofSetColor(ofColor::white);
+      ofRect(fill, 0);
+      ofSetColor(232, 232, 232);
+      ofRect(shade, 0);
    }
 
    /*ofSetLineWidth(1.5f * gDrawScale);
@@ -520,6 +538,7 @@ void SampleCanvasElement::ButtonClicked(std::string label, double time)
 
       mSample->Create(firstHalf);
       mLength /= 2;
+      mCanvas->InvalidateElementIndex();
    }
    if (label == "reset speed")
    {
@@ -529,6 +548,7 @@ void SampleCanvasElement::ButtonClicked(std::string label, double time)
          float lengthMs = mSample->LengthInSamples() / mSample->GetSampleRateRatio() / gSampleRateMs;
          float lengthOriginalSpeed = lengthMs / TheTransport->GetDuration(sampleCanvas->GetInterval());
          mLength = lengthOriginalSpeed;
+         mCanvas->InvalidateElementIndex();
       }
    }
 }
@@ -45,7 +45,7 @@ public:
    CanvasElement(Canvas* canvas, int col, int row, float offset, float length);
    virtual ~CanvasElement() {}
    void Draw(ofVec2f offset);
-   void DrawOffscreen();
+   void GetOffscreenRects(std::vector<ofRectangle>& rects) const; //the marks at the edge of the canvas for an element that's out of view
    void SetHighlight(bool highlight) { mHighlighted = highlight; }
    bool GetHighlighted() const { return mHighlighted; }
    ofRectangle GetRect(bool clamp, bool wrapped, ofVec2f offset = ofVec2f(0, 0)) const;
@@ -58,6 +58,9 @@ public:
 
    virtual bool IsResizable() const { return true; }
    virtual CanvasElement* CreateDuplicate() const = 0;
+   //for drawing unhighlighted elements as part of the canvas's cached batches: the rect filled white and the one filled grey over it.
+   //elements that return false are drawn with Draw() every frame
+   virtual bool GetBatchedRects(bool wrapped, ofRectangle& fill, ofRectangle& shade) const { return false; }
 
    virtual void CheckboxUpdated(std::string label, bool value, double time);
    virtual void FloatSliderUpdated(std::string label, float oldVal, float newVal, double time);
@@ -105,12 +108,14 @@ public:
    void WriteModulation(float pos, float pitchBend, float modWheel, float pressure, float pan);
 
    CanvasElement* CreateDuplicate() const override;
+   bool GetBatchedRects(bool wrapped, ofRectangle& fill, ofRectangle& shade) const override;
 
    void SaveState(FileStreamOut& out) override;
    void LoadState(FileStreamIn& in) override;
 
 private:
    void DrawContents(bool clamp, bool wrapped, ofVec2f offset) override;
+   void GetNoteRects(bool clamp, bool wrapped, ofVec2f offset, ofRectangle& fill, ofRectangle& shade) const;
 
    float mVelocity{ .8 };
    FloatSlider* mElementOffsetSlider{ nullptr };
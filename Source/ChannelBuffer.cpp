@@ -27,6 +27,10 @@
 
 #include "ChannelBuffer.h"
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
 ChannelBuffer::ChannelBuffer(int bufferSize)
 {
    mNumChannels = kMaxNumChannels;
@@ -42,75 +46,245 @@ ChannelBuffer::ChannelBuffer(float* data, int bufferSize)
    mNumChannels = 1;
    mOwnsBuffers = false;
 
-   mBuffers = new float*[1];
    mBuffers[0] = data;
    mBufferSize = bufferSize;
 }
 
-ChannelBuffer::~ChannelBuffer()
+ChannelBuffer::ChannelBuffer(ChannelBuffer&& other) noexcept
+: mActiveChannels(other.mActiveChannels)
+, mNumChannels(other.mNumChannels)
+, mBufferSize(other.mBufferSize)
+, mRecentActiveChannels(other.mRecentActiveChannels)
+, mOwnsBuffers(other.mOwnsBuffers)
+, mSilentChannels(other.mSilentChannels)
+, mSharedChannels(other.mSharedChannels)
+, mArenaChannels(other.mArenaChannels)
+, mPeaks(std::move(other.mPeaks))
 {
-   if (mOwnsBuffers)
+   if (other.mBuffers == other.mInlineBuffers)
    {
-      for (int i = 0; i < mNumChannels; ++i)
-         delete[] mBuffers[i];
+      for (int i = 0; i < kMaxNumChannels; ++i)
+         mInlineBuffers[i] = other.mInlineBuffers[i];
    }
-   delete[] mBuffers;
+   else
+   {
+      mBuffers = other.mBuffers;
+   }
+
+   for (int i = 0; i < kMaxNumChannels; ++i)
+      other.mInlineBuffers[i] = nullptr;
+   other.mBuffers = other.mInlineBuffers;
+   other.mNumChannels = 0;
+}
+
+ChannelBuffer::~ChannelBuffer()
+{
+   FreeBuffers();
 }
 
 void ChannelBuffer::Setup(int bufferSize)
 {
-   mBuffers = new float*[mNumChannels];
+   if (mNumChannels > kMaxNumChannels)
+      mBuffers = new float*[mNumChannels];
+   else
+      mBuffers = mInlineBuffers;
    mBufferSize = bufferSize;
 
+   //buffers of the arena's size are allocated up front, so GetChannel() never has to allocate on the audio thread
+   bool allocateNow = UsesArena();
+   mArenaChannels = 0;
    for (int i = 0; i < mNumChannels; ++i)
+   {
       mBuffers[i] = nullptr;
+      if (allocateNow)
+         AllocateChannel(i);
+   }
 
    Clear();
 }
 
+void ChannelBuffer::FreeBuffers()
+{
+   if (mOwnsBuffers)
+   {
+      for (int i = 0; i < mNumChannels; ++i)
+         FreeChannel(i);
+   }
+   if (mBuffers != mInlineBuffers)
+      delete[] mBuffers;
+   mBuffers = mInlineBuffers;
+}
+
+void ChannelBuffer::AllocateChannel(int channel) const
+{
+   assert(mBuffers[channel] == nullptr);
+   //channels past the ones we have bits for can't say where their block came from, so they always get their own
+   float* data = ChannelBit(channel) != 0 ? ChannelBufferArena::Get().Allocate(mBufferSize) : nullptr;
+   if (data != nullptr)
+   {
+      mArenaChannels |= ChannelBit(channel);
+   }
+   else
+   {
+      data = new float[mBufferSize];
+      ::Clear(data, mBufferSize);
+      mArenaChannels &= ~ChannelBit(channel);
+   }
+   mBuffers[channel] = data;
+}
+
+void ChannelBuffer::FreeChannel(int channel)
+{
+   FreeBlock(mBuffers[channel], (mArenaChannels & ChannelBit(channel)) != 0);
+   mBuffers[channel] = nullptr;
+   mSharedChannels &= ~ChannelBit(channel);
+   mArenaChannels &= ~ChannelBit(channel);
+}
+
+//static
+void ChannelBuffer::FreeBlock(float* block, bool fromArena)
+{
+   if (fromArena)
+      ChannelBufferArena::Get().Free(block);
+   else
+      delete[] block;
+}
+
 float* ChannelBuffer::GetChannel(int channel)
+{
+   int index = MIN(channel, mActiveChannels - 1);
+   if (mSharedChannels & ChannelBit(index))
+      UnshareChannel(index, K(keepData)); //the caller might write to it
+   float* ret = LookupChannel(channel);
+   mSilentChannels &= ~ChannelBit(index); //the caller might write to it
+   return ret;
+}
+
+void ChannelBuffer::UnshareChannel(int channel, bool keepData) const
+{
+   //once everyone else has let go of the block, it's ours to write to again
+   float* block = mBuffers[channel];
+   if (ChannelBufferArena::Get().GetRefCount(block) > 1)
+   {
+      mBuffers[channel] = nullptr;
+      AllocateChannel(channel);
+      if (keepData)
+         BufferCopy(mBuffers[channel], block, mBufferSize);
+      ChannelBufferArena::Get().Free(block); //shared blocks are always the arena's
+   }
+   else if (!keepData)
+   {
+      ::Clear(block, mBufferSize);
+   }
+   mSharedChannels &= ~ChannelBit(channel);
+}
+
+void ChannelBuffer::AddShared(int channel, ChannelBuffer* source, int sourceChannel)
+{
+   int index = MIN(channel, mActiveChannels - 1);
+   int sourceIndex = MIN(sourceChannel, source->mActiveChannels - 1);
+   if (source->IsSilent(sourceIndex))
+      return; //adding zeros
+
+   float* block = source->mBuffers[sourceIndex];
+   bool canShare = (source->mArenaChannels & ChannelBit(sourceIndex)) && ChannelBit(index) != 0;
+   if (IsSilent(index) && mOwnsBuffers && source->mBufferSize == mBufferSize && canShare)
+   {
+      ChannelBufferArena::Get().Retain(block);
+      if (mBuffers[index] != nullptr)
+         FreeChannel(index);
+      mBuffers[index] = block;
+      mArenaChannels |= ChannelBit(index);
+      mSharedChannels |= ChannelBit(index);
+      mSilentChannels &= ~ChannelBit(index);
+      source->mSharedChannels |= ChannelBit(sourceIndex);
+      MarkPeaksDirty();
+      return;
+   }
+
+   Add(GetChannel(channel), block, MIN(mBufferSize, source->mBufferSize));
+}
+
+float* ChannelBuffer::LookupChannel(int channel)
 {
    if (channel >= mActiveChannels)
       ofLog() << "error: requesting a higher channel index than we have active";
-   float* ret = mBuffers[MIN(channel, mActiveChannels - 1)];
-   if (ret == nullptr)
+   int index = MIN(channel, mActiveChannels - 1);
+   if (mBuffers[index] == nullptr)
    {
       assert(mOwnsBuffers);
-      ret = new float[BufferSize()];
-      ::Clear(ret, BufferSize());
-      mBuffers[MIN(channel, mActiveChannels - 1)] = ret;
+      AllocateChannel(index);
    }
-   return ret;
+   return mBuffers[index];
 }
 
-void ChannelBuffer::Clear() const
+size_t ChannelBuffer::GetMemoryUsage() const
 {
+   if (!mOwnsBuffers)
+      return 0;
+
+   size_t bytes = 0;
    for (int i = 0; i < mNumChannels; ++i)
    {
       if (mBuffers[i] != nullptr)
+         bytes += mBufferSize * sizeof(float);
+   }
+   return bytes;
+}
+
+void ChannelBuffer::Clear() const
+{
+   for (int i = 0; i < mNumChannels; ++i)
+   {
+      if (mSharedChannels & ChannelBit(i))
+         UnshareChannel(i, !K(keepData)); //the others still need the data, so get a fresh block instead of zeroing theirs
+      else if (mBuffers[i] != nullptr)
          ::Clear(mBuffers[i], BufferSize());
+      mSilentChannels |= ChannelBit(i);
    }
+   MarkPeaksDirty();
 }
 
-void ChannelBuffer::SetMaxAllowedChannels(int channels)
+bool ChannelBuffer::IsSilent() const
 {
-   float** newBuffers = new float*[channels];
-   for (int i = 0; i < channels; ++i)
+   for (int i = 0; i < mActiveChannels; ++i)
    {
-      if (i < mNumChannels)
-         newBuffers[i] = mBuffers[i];
-      else
-         newBuffers[i] = nullptr;
+      if (!IsSilent(i))
+         return false;
    }
+   return true;
+}
 
+void ChannelBuffer::SetMaxAllowedChannels(int channels)
+{
    for (int i = channels; i < mNumChannels; ++i)
-      delete[] mBuffers[i];
-   delete[] mBuffers;
+      FreeChannel(i);
 
+   float** newBuffers = channels > kMaxNumChannels ? new float*[channels] : mInlineBuffers;
+   for (int i = 0; i < channels; ++i)
+      newBuffers[i] = i < mNumChannels ? mBuffers[i] : nullptr;
+   if (mBuffers != mInlineBuffers)
+      delete[] mBuffers;
+
+   int oldNumChannels = mNumChannels;
    mBuffers = newBuffers;
    mNumChannels = channels;
+   for (int i = oldNumChannels; i < channels; ++i)
+   {
+      if (UsesArena())
+         AllocateChannel(i);
+      mSilentChannels |= ChannelBit(i); //new channels start out zeroed
+   }
+
    if (mActiveChannels > channels)
       mActiveChannels = channels;
+
+   if (!mPeaks.empty())
+   {
+      while ((int)mPeaks.size() < mNumChannels)
+         mPeaks.push_back(std::make_unique<WaveformPeaks>());
+      MarkPeaksDirty();
+   }
 }
 
 void ChannelBuffer::CopyFrom(ChannelBuffer* src, int length /*= -1*/, int startOffset /*= 0*/)
@@ -122,46 +296,273 @@ void ChannelBuffer::CopyFrom(ChannelBuffer* src, int length /*= -1*/, int startO
    mActiveChannels = src->mActiveChannels;
    for (int i = 0; i < mActiveChannels; ++i)
    {
+      bool srcSilent = src->mBuffers[i] == nullptr || src->IsSilent(i);
+      if (srcSilent && IsSilent(i))
+         continue; //copying zeros over zeros
+
       if (src->mBuffers[i])
       {
+         if (mSharedChannels & ChannelBit(i))
+            UnshareChannel(i, length < mBufferSize);
          if (mBuffers[i] == nullptr)
          {
             assert(mOwnsBuffers);
-            mBuffers[i] = new float[mBufferSize];
-            ::Clear(mBuffers[i], mBufferSize);
+            AllocateChannel(i);
          }
          BufferCopy(mBuffers[i], src->mBuffers[i] + startOffset, length);
+         if (srcSilent && length == mBufferSize)
+            mSilentChannels |= ChannelBit(i);
+         else
+            mSilentChannels &= ~ChannelBit(i);
+      }
+      else if (UsesArena() && mBuffers[i] != nullptr)
+      {
+         ::Clear(mBuffers[i], mBufferSize); //hold on to it, so we don't have to allocate it again later
+         mSilentChannels |= ChannelBit(i);
       }
       else
       {
-         delete mBuffers[i];
-         mBuffers[i] = nullptr;
+         FreeChannel(i);
+         mSilentChannels |= ChannelBit(i);
       }
    }
+   MarkPeaksDirty(0, length);
 }
 
 void ChannelBuffer::SetChannelPointer(float* data, int channel, bool deleteOldData)
 {
-   if (deleteOldData)
-      delete[] mBuffers[channel];
+   if (deleteOldData || (mSharedChannels & ChannelBit(channel)))
+      FreeChannel(channel); //a shared block isn't ours to hand over, just let go of it
    mBuffers[channel] = data;
+   mArenaChannels &= ~ChannelBit(channel);
+   mSilentChannels &= ~ChannelBit(channel);
+   if (channel < (int)mPeaks.size())
+      mPeaks[channel]->MarkAllDirty();
 }
 
-void ChannelBuffer::Resize(int bufferSize)
+void ChannelBuffer::SetExternalData(float* const* channels, int numChannels, int bufferSize)
 {
-   assert(mOwnsBuffers);
-   for (int i = 0; i < mNumChannels; ++i)
-      delete[] mBuffers[i];
-   delete[] mBuffers;
+   assert(numChannels <= kMaxNumChannels);
+   FreeBuffers();
+
+   mOwnsBuffers = false;
+   mArenaChannels = 0;
+   mNumChannels = numChannels;
+   mActiveChannels = numChannels;
+   mBufferSize = bufferSize;
+   for (int i = 0; i < numChannels; ++i)
+      mBuffers[i] = channels[i];
+   mSilentChannels = 0;
+   MarkPeaksDirty();
+}
+
+void ChannelBuffer::EnablePeaks()
+{
+   while ((int)mPeaks.size() < mNumChannels)
+      mPeaks.push_back(std::make_unique<WaveformPeaks>());
+}
+
+void ChannelBuffer::MarkPeaksDirty(int start /*= 0*/, int length /*= -1*/) const
+{
+   if (length == -1)
+      length = mBufferSize - start;
+   for (auto& peaks : mPeaks)
+      peaks->MarkDirty(start, length);
+}
+
+void ChannelBuffer::Resize(int bufferSize, bool keepData /*= false*/)
+{
+   if (keepData && mOwnsBuffers)
+   {
+      //only the channels that have been allocated need to move, the rest stay lazy
+      int keepLength = MIN(mBufferSize, bufferSize);
+      mBufferSize = bufferSize;
+      for (int i = 0; i < mNumChannels; ++i)
+      {
+         if (mBuffers[i] == nullptr)
+            continue;
+         float* oldData = mBuffers[i];
+         bool oldFromArena = (mArenaChannels & ChannelBit(i)) != 0;
+         mBuffers[i] = nullptr;
+         AllocateChannel(i);
+         BufferCopy(mBuffers[i], oldData, keepLength);
+         ::Clear(mBuffers[i] + keepLength, bufferSize - keepLength);
+         FreeBlock(oldData, oldFromArena); //if it was shared, that drops our reference
+         mSharedChannels &= ~ChannelBit(i);
+      }
+      MarkPeaksDirty();
+      return;
+   }
+
+   FreeBuffers();
+   if (!mOwnsBuffers)
+   {
+      //we were pointing at someone else's data (see SetExternalData()), go back to having our own
+      mOwnsBuffers = true;
+      mNumChannels = kMaxNumChannels;
+   }
 
    Setup(bufferSize);
 }
 
+void ChannelBuffer::ReleaseChannels()
+{
+   if (!mOwnsBuffers)
+      return;
+
+   for (int i = 0; i < mNumChannels; ++i)
+   {
+      if (mBuffers[i] != nullptr)
+         FreeChannel(i);
+      mSilentChannels |= ChannelBit(i);
+   }
+}
+
+void ChannelBuffer::Swap(ChannelBuffer& other)
+{
+   //buffers held inline have to stay pointing at their own object's array
+   float** buffers = mBuffers == mInlineBuffers ? other.mInlineBuffers : mBuffers;
+   float** otherBuffers = other.mBuffers == other.mInlineBuffers ? mInlineBuffers : other.mBuffers;
+   std::swap(mInlineBuffers, other.mInlineBuffers);
+   mBuffers = otherBuffers;
+   other.mBuffers = buffers;
+
+   std::swap(mActiveChannels, other.mActiveChannels);
+   std::swap(mNumChannels, other.mNumChannels);
+   std::swap(mBufferSize, other.mBufferSize);
+   std::swap(mRecentActiveChannels, other.mRecentActiveChannels);
+   std::swap(mOwnsBuffers, other.mOwnsBuffers);
+   std::swap(mSilentChannels, other.mSilentChannels);
+   std::swap(mSharedChannels, other.mSharedChannels);
+   std::swap(mArenaChannels, other.mArenaChannels);
+   std::swap(mPeaks, other.mPeaks);
+}
+
+void ChannelBuffer::AllocateChannels()
+{
+   if (!mOwnsBuffers)
+      return;
+
+   for (int i = 0; i < mNumChannels; ++i)
+   {
+      if (mBuffers[i] == nullptr)
+      {
+         AllocateChannel(i);
+         ::Clear(mBuffers[i], mBufferSize); //recycled arena blocks aren't zeroed
+      }
+   }
+}
+
 namespace
 {
    const int kSaveStateRev = 1;
 }
 
+void ChannelBuffer::SpreadToStereo()
+{
+   assert(mNumChannels >= 2);
+   if (mActiveChannels >= 2)
+      return;
+   mActiveChannels = 2;
+   bool silent = IsSilent(0);
+   float* right = GetChannel(1);
+   if (silent)
+   {
+      ::Clear(right, mBufferSize);
+      mSilentChannels |= ChannelBit(1);
+   }
+   else
+   {
+      BufferCopy(right, GetChannelReadOnly(0), mBufferSize);
+   }
+   MarkPeaksDirty();
+}
+
+void ChannelBuffer::MultLinked(const float* gains, int length)
+{
+   assert(length <= mBufferSize);
+   if (mActiveChannels != 2)
+   {
+      for (int ch = 0; ch < mActiveChannels; ++ch)
+         Mult(GetChannel(ch), gains, length);
+      return;
+   }
+
+   float* left = GetChannel(0);
+   float* right = GetChannel(1);
+   int i = 0;
+#if defined(__wasm_simd128__)
+   for (; i + 4 <= length; i += 4)
+   {
+      v128_t gain = wasm_v128_load(gains + i);
+      wasm_v128_store(left + i, wasm_f32x4_mul(wasm_v128_load(left + i), gain));
+      wasm_v128_store(right + i, wasm_f32x4_mul(wasm_v128_load(right + i), gain));
+   }
+#endif
+   for (; i < length; ++i)
+   {
+      left[i] *= gains[i];
+      right[i] *= gains[i];
+   }
+   MarkPeaksDirty(0, length);
+}
+
+void ChannelBuffer::MixStereo(const StereoMix& mix, int length)
+{
+   assert(length <= mBufferSize);
+   SpreadToStereo();
+   float* left = GetChannel(0);
+   float* right = GetChannel(1);
+   int i = 0;
+#if defined(__wasm_simd128__)
+   v128_t leftToLeft = wasm_f32x4_splat(mix.mLeftToLeft);
+   v128_t rightToLeft = wasm_f32x4_splat(mix.mRightToLeft);
+   v128_t leftToRight = wasm_f32x4_splat(mix.mLeftToRight);
+   v128_t rightToRight = wasm_f32x4_splat(mix.mRightToRight);
+   for (; i + 4 <= length; i += 4)
+   {
+      v128_t l = wasm_v128_load(left + i);
+      v128_t r = wasm_v128_load(right + i);
+      wasm_v128_store(left + i, wasm_f32x4_add(wasm_f32x4_mul(l, leftToLeft), wasm_f32x4_mul(r, rightToLeft)));
+      wasm_v128_store(right + i, wasm_f32x4_add(wasm_f32x4_mul(l, leftToRight), wasm_f32x4_mul(r, rightToRight)));
+   }
+#endif
+   for (; i < length; ++i)
+   {
+      float l = left[i];
+      float r = right[i];
+      left[i] = l * mix.mLeftToLeft + r * mix.mRightToLeft;
+      right[i] = l * mix.mLeftToRight + r * mix.mRightToRight;
+   }
+   MarkPeaksDirty(0, length);
+}
+
+void ChannelBuffer::MixStereo(const float* leftToLeft, const float* rightToLeft, const float* leftToRight, const float* rightToRight, int length)
+{
+   assert(length <= mBufferSize);
+   SpreadToStereo();
+   float* left = GetChannel(0);
+   float* right = GetChannel(1);
+   int i = 0;
+#if defined(__wasm_simd128__)
+   for (; i + 4 <= length; i += 4)
+   {
+      v128_t l = wasm_v128_load(left + i);
+      v128_t r = wasm_v128_load(right + i);
+      wasm_v128_store(left + i, wasm_f32x4_add(wasm_f32x4_mul(l, wasm_v128_load(leftToLeft + i)), wasm_f32x4_mul(r, wasm_v128_load(rightToLeft + i))));
+      wasm_v128_store(right + i, wasm_f32x4_add(wasm_f32x4_mul(l, wasm_v128_load(leftToRight + i)), wasm_f32x4_mul(r, wasm_v128_load(rightToRight + i))));
+   }
+#endif
+   for (; i < length; ++i)
+   {
+      float l = left[i];
+      float r = right[i];
+      left[i] = l * leftToLeft[i] + r * rightToLeft[i];
+      right[i] = l * leftToRight[i] + r * rightToRight[i];
+   }
+   MarkPeaksDirty(0, length);
+}
+
 void ChannelBuffer::Save(FileStreamOut& out, int writeLength)
 {
    out << kSaveStateRev;
@@ -185,7 +586,7 @@ void ChannelBuffer::Load(FileStreamIn& in, int& readLength, LoadMode loadMode)
 
    in >> readLength;
    if (loadMode == LoadMode::kSetBufferSize)
-      Setup(readLength);
+      Resize(readLength);
    else if (loadMode == LoadMode::kRequireExactBufferSize)
       assert(readLength == mBufferSize);
    else
@@ -200,4 +601,5 @@ void ChannelBuffer::Load(FileStreamIn& in, int& readLength, LoadMode loadMode)
       if (hasBuffer)
          in.Read(GetChannel(i), readLength);
    }
+   MarkPeaksDirty();
 }
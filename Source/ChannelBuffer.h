@@ -28,6 +28,11 @@
 #pragma once
 #include "SynthGlobals.h"
 #include "FileStream.h"
+#include "ChannelBufferArena.h"
+#include "WaveformPeaks.h"
+
+#include <memory>
+#include <vector>
 
 class ChannelBuffer
 {
@@ -35,26 +40,63 @@ public:
    ChannelBuffer(int bufferSize);
    ChannelBuffer(float* data, int bufferSize); //intended as a temporary holder for passing raw data to methods that want a ChannelBuffer
    ~ChannelBuffer();
+   ChannelBuffer(ChannelBuffer&& other) noexcept;
+   ChannelBuffer(const ChannelBuffer&) = delete;
+   ChannelBuffer& operator=(const ChannelBuffer&) = delete;
+
+   float* GetChannel(int channel); //copies a shared channel first, if it's still shared (copy on write)
+   const float* GetChannelReadOnly(int channel) { return LookupChannel(channel); } //doesn't give up the channel's silence flag or copy a shared channel, unlike GetChannel()
 
-   float* GetChannel(int channel);
+   //sums a channel of source into one of ours. if ours is silent, the two buffers just share source's block instead of copying it,
+   //until one of them writes to it or is cleared. fanning out to several receivers this way costs no memory traffic at all
+   void AddShared(int channel, ChannelBuffer* source, int sourceChannel);
 
    void Clear() const;
 
+   //a channel is silent if it's known to be all zeros: it has been cleared, and nothing has asked for it with GetChannel() since.
+   //consumers can skip processing or mixing silent channels entirely
+   bool IsSilent(int channel) const { return (mSilentChannels & ChannelBit(channel)) != 0; }
+   bool IsSilent() const;
+
    void SetMaxAllowedChannels(int channels);
    void SetNumActiveChannels(int channels) { mActiveChannels = MIN(mNumChannels, channels); }
    int NumActiveChannels() const { return mActiveChannels; }
    int RecentNumActiveChannels() const { return mRecentActiveChannels; }
    int NumTotalChannels() const { return mNumChannels; }
    int BufferSize() const { return mBufferSize; }
+   size_t GetMemoryUsage() const; //the channels we've allocated, which isn't all of them until they're asked for
    void CopyFrom(ChannelBuffer* src, int length = -1, int startOffset = 0);
    void SetChannelPointer(float* data, int channel, bool deleteOldData);
+   void SetExternalData(float* const* channels, int numChannels, int bufferSize); //points at memory we don't own (and shouldn't write to), until the next Resize()
    void Reset()
    {
       Clear();
       mRecentActiveChannels = mActiveChannels;
       SetNumActiveChannels(1);
    }
-   void Resize(int bufferSize);
+   void Resize(int bufferSize, bool keepData = false); //with keepData, the samples that fit carry over and any new ones are zeroed
+   void ReleaseChannels(); //frees the channels, which come back as silence the next time they're asked for. the size stays the same
+   void AllocateChannels(); //allocates the channels that haven't been asked for yet, as silence, so the audio thread doesn't have to. the ones there already are left alone
+   void Swap(ChannelBuffer& other); //exchanges everything, in constant time, so new storage can be built to one side and changed over under a lock
+
+   //stereo-linked processing, for effects that work out their coefficients once and apply them to both sides together,
+   //four samples of each side at a time. the storage stays planar
+   struct StereoMix
+   {
+      float mLeftToLeft{ 1 };
+      float mRightToLeft{ 0 };
+      float mLeftToRight{ 0 };
+      float mRightToRight{ 1 };
+   };
+   void SpreadToStereo(); //a mono buffer becomes two identical channels, so what follows can assume a pair. needs room for two channels
+   void MultLinked(const float* gains, int length); //every active channel by the same gain a sample
+   void MixStereo(const StereoMix& mix, int length); //one mix for the whole block. spreads a mono buffer first
+   void MixStereo(const float* leftToLeft, const float* rightToLeft, const float* leftToRight, const float* rightToRight, int length); //a mix a sample
+
+   //keep a WaveformPeaks per channel, for buffers that get drawn. anything that writes into the channels directly needs to call MarkPeaksDirty()
+   void EnablePeaks();
+   WaveformPeaks* GetPeaks(int channel) const { return channel < (int)mPeaks.size() ? mPeaks[channel].get() : nullptr; }
+   void MarkPeaksDirty(int start = 0, int length = -1) const;
 
    enum class LoadMode
    {
@@ -70,11 +112,24 @@ public:
 
 private:
    void Setup(int bufferSize);
+   void FreeBuffers();
+   void AllocateChannel(int channel) const; //into an empty channel
+   void FreeChannel(int channel);
+   static void FreeBlock(float* block, bool fromArena);
+   bool UsesArena() const { return mOwnsBuffers && mBufferSize == ChannelBufferArena::Get().GetBlockSize(); }
+   float* LookupChannel(int channel);
+   void UnshareChannel(int channel, bool keepData) const;
+   static uint32_t ChannelBit(int channel) { return channel < 32 ? (1u << channel) : 0; }
 
    int mActiveChannels{ 1 };
    int mNumChannels{ 1 };
    int mBufferSize{ 0 };
-   float** mBuffers;
+   float** mBuffers{ mInlineBuffers };
+   float* mInlineBuffers[kMaxNumChannels]{}; //so that temporary ChannelBuffers don't have to allocate anything
    int mRecentActiveChannels{ 1 };
    bool mOwnsBuffers{ true };
+   mutable uint32_t mSilentChannels{ 0 };
+   mutable uint32_t mSharedChannels{ 0 }; //channels whose block might be referenced by another ChannelBuffer too, see AddShared()
+   mutable uint32_t mArenaChannels{ 0 }; //channels whose block came from ChannelBufferArena, the rest are ours to delete[]
+   std::vector<std::unique_ptr<WaveformPeaks>> mPeaks;
 };
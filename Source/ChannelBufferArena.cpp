@@ -0,0 +1,186 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ChannelBufferArena.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ChannelBufferArena.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+thread_local bool ChannelBufferArena::sOnAudioPath = false;
+
+ChannelBufferArena& ChannelBufferArena::Get()
+{
+   static ChannelBufferArena* sArena = new ChannelBufferArena(); //never destroyed, so buffers that outlive static destruction can still be freed
+   return *sArena;
+}
+
+void ChannelBufferArena::SetBlockSize(int numSamples)
+{
+   std::lock_guard<std::mutex> lock(mGrowMutex);
+
+   if (numSamples == mBlockSize)
+      return;
+
+   assert(mNumAllocatedBlocks == 0); //buffer size can only change before any modules have been created
+   if (mNumAllocatedBlocks > 0)
+      return;
+
+   FreeSlabs();
+
+   const int kFloatsPerAlignment = kAlignment / sizeof(float);
+   mBlockSize = numSamples;
+   mCellStride = kFloatsPerAlignment + (numSamples + kFloatsPerAlignment - 1) / kFloatsPerAlignment * kFloatsPerAlignment;
+
+   if (mBlockSize > 0)
+      AddSlab(); //preallocate, so the first batch of modules doesn't have to
+}
+
+float* ChannelBufferArena::Allocate(int numSamples)
+{
+   if (numSamples != mBlockSize || mBlockSize <= 0)
+      return nullptr;
+
+   BlockHeader* header = PopFreeBlock();
+   if (header == nullptr)
+   {
+      if (sOnAudioPath)
+         return nullptr;
+      Reserve(kBlocksPerSlab);
+      header = PopFreeBlock();
+      if (header == nullptr)
+         return nullptr; //out of slabs
+   }
+
+   header->mRefCount.store(1, std::memory_order_relaxed);
+   ++mNumAllocatedBlocks;
+   float* block = GetBlock(header);
+   memset(block, 0, mBlockSize * sizeof(float));
+   return block;
+}
+
+void ChannelBufferArena::Free(float* block)
+{
+   BlockHeader* header = GetHeader(block);
+   if (header->mRefCount.fetch_sub(1, std::memory_order_acq_rel) > 1)
+      return; //still shared with someone else
+   --mNumAllocatedBlocks;
+   PushFreeBlocks(header, header);
+}
+
+void ChannelBufferArena::Retain(float* block)
+{
+   GetHeader(block)->mRefCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+int ChannelBufferArena::GetRefCount(const float* block) const
+{
+   return GetHeader(block)->mRefCount.load(std::memory_order_acquire);
+}
+
+void ChannelBufferArena::Reserve(int numFreeBlocks)
+{
+   std::lock_guard<std::mutex> lock(mGrowMutex);
+   while (mBlockSize > 0 && mNumFreeBlocks < numFreeBlocks)
+   {
+      if (!AddSlab())
+         break;
+   }
+}
+
+ChannelBufferArena::BlockHeader* ChannelBufferArena::GetHeader(uint32_t index) const
+{
+   float* slab = mSlabs[index / kBlocksPerSlab].load(std::memory_order_acquire);
+   return reinterpret_cast<BlockHeader*>(slab + (index % kBlocksPerSlab) * mCellStride);
+}
+
+ChannelBufferArena::BlockHeader* ChannelBufferArena::PopFreeBlock()
+{
+   uint64_t head = mFreeHead.load(std::memory_order_acquire);
+   while (true)
+   {
+      uint32_t index = (uint32_t)head;
+      if (index == kNoBlock)
+         return nullptr;
+      BlockHeader* header = GetHeader(index);
+      //if someone else takes this block first, the change count makes the exchange fail, so a stale link never gets in
+      uint64_t next = (((head >> 32) + 1) << 32) | header->mNextFree.load(std::memory_order_relaxed);
+      if (mFreeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+      {
+         --mNumFreeBlocks;
+         return header;
+      }
+   }
+}
+
+//first to last have to be linked through mNextFree already
+void ChannelBufferArena::PushFreeBlocks(BlockHeader* first, BlockHeader* last)
+{
+   int numBlocks = last->mIndex - first->mIndex + 1;
+   uint64_t head = mFreeHead.load(std::memory_order_relaxed);
+   uint64_t next;
+   do
+   {
+      last->mNextFree.store((uint32_t)head, std::memory_order_relaxed);
+      next = (((head >> 32) + 1) << 32) | first->mIndex;
+   } while (!mFreeHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+   mNumFreeBlocks += numBlocks;
+}
+
+bool ChannelBufferArena::AddSlab()
+{
+   int slabIndex = mNumSlabs.load(std::memory_order_relaxed);
+   if (slabIndex == kMaxSlabs)
+      return false;
+
+   float* slab = new (std::align_val_t(kAlignment)) float[kBlocksPerSlab * mCellStride];
+   uint32_t firstIndex = slabIndex * kBlocksPerSlab;
+   for (int i = 0; i < kBlocksPerSlab; ++i)
+   {
+      BlockHeader* header = new (slab + i * mCellStride) BlockHeader();
+      header->mIndex = firstIndex + i;
+      header->mNextFree.store(firstIndex + i + 1, std::memory_order_relaxed);
+   }
+   mSlabs[slabIndex].store(slab, std::memory_order_release);
+   mNumSlabs.store(slabIndex + 1, std::memory_order_release);
+
+   //in order, so the blocks come out in the order they sit in the slab
+   PushFreeBlocks(GetHeader(firstIndex), GetHeader(firstIndex + kBlocksPerSlab - 1));
+   return true;
+}
+
+void ChannelBufferArena::FreeSlabs()
+{
+   int numSlabs = mNumSlabs.load(std::memory_order_relaxed);
+   for (int i = 0; i < numSlabs; ++i)
+   {
+      operator delete[](mSlabs[i].load(std::memory_order_relaxed), std::align_val_t(kAlignment));
+      mSlabs[i].store(nullptr, std::memory_order_relaxed);
+   }
+   mNumSlabs = 0;
+   mFreeHead = kNoBlock;
+   mNumFreeBlocks = 0;
+}
@@ -0,0 +1,95 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ChannelBufferArena.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+//hands out cache-aligned, gBufferSize-long blocks for ChannelBuffer channels.
+//blocks are carved out of large slabs in the order they're requested, so modules created together keep their buffers next to each other.
+//blocks are reference counted, so that one can be handed to several ChannelBuffers at once (see ChannelBuffer::AddShared()).
+//each block has a header just in front of it with its reference count and free list link, so nothing here has to look anything up,
+//and allocating and freeing are lock free. the arena only grows off the audio path, see Reserve()
+class ChannelBufferArena
+{
+public:
+   static ChannelBufferArena& Get();
+
+   //called from SetGlobalSampleRateAndBufferSize(), before any buffers are allocated
+   void SetBlockSize(int numSamples);
+   int GetBlockSize() const { return mBlockSize; }
+
+   //with a reference count of 1. returns nullptr if numSamples isn't the arena's block size, or if there are no free blocks left
+   //and this is the audio thread or a graph worker, which never grow the arena. the caller should allocate the memory itself then
+   float* Allocate(int numSamples);
+   //these only take blocks that came from Allocate()
+   void Free(float* block); //drops a reference, the block goes back to the arena when the last one is gone
+   void Retain(float* block); //adds a reference
+   int GetRefCount(const float* block) const;
+
+   //call from the audio thread and the graph workers, they take blocks but never add slabs
+   static void MarkAudioPathThread() { sOnAudioPath = true; }
+
+   //not on the audio path. adds slabs until at least this many blocks are free, so the audio thread has some to take
+   void Reserve(int numFreeBlocks = kMinSpareBlocks);
+
+   static constexpr int kAlignment = 64;
+   static constexpr int kBlocksPerSlab = 256;
+   static constexpr int kMaxSlabs = 1024;
+   static constexpr int kMinSpareBlocks = 128;
+
+private:
+   struct alignas(kAlignment) BlockHeader
+   {
+      std::atomic<int> mRefCount{ 0 };
+      std::atomic<uint32_t> mNextFree{ 0 };
+      uint32_t mIndex{ 0 };
+   };
+   static_assert(sizeof(BlockHeader) == kAlignment, "blocks have to stay aligned after their header");
+
+   static constexpr uint32_t kNoBlock = 0xffffffff;
+   static thread_local bool sOnAudioPath;
+
+   ChannelBufferArena() = default;
+   bool AddSlab(); //call with mGrowMutex held
+   void FreeSlabs(); //call with mGrowMutex held
+   BlockHeader* GetHeader(uint32_t index) const;
+   static BlockHeader* GetHeader(const float* block) { return reinterpret_cast<BlockHeader*>(const_cast<float*>(block)) - 1; }
+   static float* GetBlock(BlockHeader* header) { return reinterpret_cast<float*>(header + 1); }
+   BlockHeader* PopFreeBlock();
+   void PushFreeBlocks(BlockHeader* first, BlockHeader* last);
+
+   int mBlockSize{ 0 };
+   int mCellStride{ 0 }; //header and block in floats, padded out to a multiple of the alignment
+   std::atomic<float*> mSlabs[kMaxSlabs]{};
+   std::atomic<int> mNumSlabs{ 0 };
+   std::atomic<uint64_t> mFreeHead{ kNoBlock }; //index of the first free block in the low half, and a count of changes in the high half so a stale head can't be swapped back in
+   std::atomic<int> mNumFreeBlocks{ 0 };
+   std::atomic<int> mNumAllocatedBlocks{ 0 };
+   std::mutex mGrowMutex; //growing and resizing only, allocating and freeing don't take it
+};
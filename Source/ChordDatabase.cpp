@@ -144,15 +144,19 @@ std::set<std::string> ChordDatabase::GetChordNamesAdvanced(const std::vector<int
       return chordNames;
    }
 
-   // Create a boolean vector with each pitch played, set to be in one octave
-   std::set<int> octavePitches;
+   // Create a mask with a bit for each pitch class played
+   uint16_t octaveMask = 0;
+   int numOctavePitches = 0;
 
    for (auto& pitch : pitches)
    {
-      octavePitches.insert(pitch % 12);
+      uint16_t bit = 1 << (pitch % 12);
+      if ((octaveMask & bit) == 0)
+         ++numOctavePitches;
+      octaveMask |= bit;
    }
 
-   if (octavePitches.size() < 3)
+   if (numOctavePitches < 3)
       return chordNames;
 
    // Considering each played note as a possible root, find the root and chord with the greatest weight
@@ -160,11 +164,17 @@ std::set<std::string> ChordDatabase::GetChordNamesAdvanced(const std::vector<int
    float maxWeight = 0.0f;
    int lowestPitch = pitches[0] % 12;
 
-   std::list<std::tuple<int, ChordShape>> bestChords; // Is this cursed?
+   std::list<std::tuple<int, const ChordShape*>> bestChords;
 
    // For each note played
-   for (auto& rootOctavePitch : octavePitches)
+   for (int rootOctavePitch = 0; rootOctavePitch < 12; ++rootOctavePitch)
    {
+      if ((octaveMask & (1 << rootOctavePitch)) == 0)
+         continue;
+
+      // The played pitch classes relative to this root
+      uint16_t rootMask = RotateMask(octaveMask, rootOctavePitch);
+
       // Try note as the root, multiply with the weights of the notes to be played
       for (auto& shape : mChordShapes)
       {
@@ -174,11 +184,7 @@ std::set<std::string> ChordDatabase::GetChordNamesAdvanced(const std::vector<int
          chordWeight += rootOctavePitch == lowestPitch ? shape.mRootPosBias : 0;
 
          // Add the weights for the pitches in the chord
-         for (auto& octavePitch : octavePitches)
-         {
-            // Looping over the same stuff within the same loop, crazy!
-            chordWeight += 2.0f * shape.mWeights[(12 + octavePitch - rootOctavePitch) % 12];
-         }
+         chordWeight += 2.0f * shape.GetMaskWeight(rootMask);
 
          // Consider the chords with the highest weight as the best fit
          if (chordWeight > maxWeight + FLT_EPSILON)
@@ -187,25 +193,25 @@ std::set<std::string> ChordDatabase::GetChordNamesAdvanced(const std::vector<int
 
             // Better weight than found before, replace list with this chord
             bestChords.clear();
-            bestChords.push_back(std::make_tuple(rootOctavePitch, shape));
+            bestChords.push_back(std::make_tuple(rootOctavePitch, &shape));
          }
          else if (chordWeight >= maxWeight - FLT_EPSILON)
          {
             // Equal weight as current best, add to list
-            bestChords.push_back(std::make_tuple(rootOctavePitch, shape));
+            bestChords.push_back(std::make_tuple(rootOctavePitch, &shape));
          }
       }
    }
 
    for (const auto& chord : bestChords)
    {
-      chordNames.insert(GetChordNameAdvanced(pitches, std::get<0>(chord), std::get<1>(chord), useScaleDegrees));
+      chordNames.insert(GetChordNameAdvanced(pitches, std::get<0>(chord), *std::get<1>(chord), useScaleDegrees));
    }
 
    return chordNames;
 }
 
-std::string ChordDatabase::GetChordNameAdvanced(const std::vector<int>& pitches, const int root, const ChordShape shape, bool useScaleDegrees) const
+std::string ChordDatabase::GetChordNameAdvanced(const std::vector<int>& pitches, const int root, const ChordShape& shape, bool useScaleDegrees) const
 {
    std::string rootName;
    std::string chordName;
@@ -373,6 +379,10 @@ std::string ChordDatabase::GetChordName(std::vector<int> pitches) const
 
    std::list<std::string> names;
 
+   uint16_t octaveMask = 0;
+   for (int pitch : pitches)
+      octaveMask |= 1 << (((pitch % 12) + 12) % 12);
+
    sort(pitches.begin(), pitches.end());
    for (int inversion = 0; inversion < numPitches; ++inversion)
    {
@@ -381,6 +391,11 @@ std::string ChordDatabase::GetChordName(std::vector<int> pitches) const
          if (shape.mElements.size() == numPitches)
          {
             int root = pitches[(numPitches - inversion) % numPitches] - (inversion > 0 ? 12 : 0);
+
+            // Only shapes with the same pitch classes can match, which rules out most of them without walking the elements
+            if (RotateMask(octaveMask, ((root % 12) + 12) % 12) != shape.mMask)
+               continue;
+
             bool match = true;
             for (int i = 0; i < numPitches; ++i)
             {
@@ -429,6 +444,36 @@ std::vector<int> ChordDatabase::GetChord(std::string name, int inversion) const
    return ret;
 }
 
+uint16_t ChordDatabase::RotateMask(uint16_t mask, int semitones)
+{
+   if (semitones == 0)
+      return mask;
+   return ((mask >> semitones) | (mask << (12 - semitones))) & 0xfff;
+}
+
+void ChordDatabase::ChordShape::BuildMasks()
+{
+   mMask = 0;
+   for (int element : mElements)
+      mMask |= 1 << (element % 12);
+
+   for (int bits = 0; bits < 64; ++bits)
+   {
+      float low = 0;
+      float high = 0;
+      for (int i = 0; i < 6; ++i)
+      {
+         if (bits & (1 << i))
+         {
+            low += mWeights[i];
+            high += mWeights[i + 6];
+         }
+      }
+      mLowMaskWeights[bits] = low;
+      mHighMaskWeights[bits] = high;
+   }
+}
+
 std::vector<std::string> ChordDatabase::GetChordNames() const
 {
    std::vector<std::string> ret;
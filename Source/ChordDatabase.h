@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <numeric>
 #include <set>
 #include <string>
@@ -52,6 +54,7 @@ private:
          mWeights = weights;
          mWeightSum = 0;
          mRootPosBias = rootPosBias;
+         BuildMasks();
       }
 
       ChordShape(std::string name, std::vector<int> elements, std::vector<float> weights, float rootPosBias = 0.0f)
@@ -66,16 +69,29 @@ private:
          mWeightSum = std::accumulate(
          mWeights.begin(), mWeights.end(), 0.0f, lambda);
          mRootPosBias = rootPosBias;
+         BuildMasks();
       }
+
+      //the summed weights of a 12 bit pitch class mask relative to the root, looked up six bits at a time
+      float GetMaskWeight(uint16_t mask) const { return mLowMaskWeights[mask & 63] + mHighMaskWeights[(mask >> 6) & 63]; }
+
       std::string mName;
       std::vector<int> mElements;
       std::vector<float> mWeights;
       float mWeightSum;
       float mRootPosBias;
+      uint16_t mMask{ 0 }; //pitch classes of mElements, bit 0 is the root
+      std::array<float, 64> mLowMaskWeights{};
+      std::array<float, 64> mHighMaskWeights{};
+
+   private:
+      void BuildMasks();
    };
    std::vector<ChordShape> mChordShapes;
 
-   std::string GetChordNameAdvanced(const std::vector<int>& pitches, const int root, const ChordShape shape, bool useScaleDegrees) const;
+   static uint16_t RotateMask(uint16_t mask, int semitones);
+
+   std::string GetChordNameAdvanced(const std::vector<int>& pitches, const int root, const ChordShape& shape, bool useScaleDegrees) const;
    std::string NoteNameScaleRelative(int pitch, bool useDegrees) const; // Helper function for GetChordNameAdvanced, may be better off moved to synthglobals?
    std::string ChordNameScaleRelative(int rootPitch) const; // Helper function for GetChordNameAdvanced, may be better off moved to synthglobals?
 };
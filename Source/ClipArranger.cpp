@@ -189,8 +189,9 @@ bool ClipArranger::IsMousePosWithinClip(int x, int y)
 
 void ClipArranger::FilesDropped(std::vector<std::string> files, int x, int y)
 {
+   //the clip goes on the arrangement straight away, and is silent until it's decoded
    Sample* sample = new Sample();
-   sample->Read(files[0].c_str());
+   sample->Read(files[0].c_str(), false, Sample::ReadType::Async);
    AddSample(sample, x, y);
 }
 
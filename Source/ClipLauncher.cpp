@@ -31,6 +31,10 @@
 #include "Profiler.h"
 #include "Looper.h"
 #include "FillSaveDropdown.h"
+#include "FileStream.h"
+#include "SampleLoader.h"
+
+#include "juce_audio_formats/juce_audio_formats.h"
 
 ClipLauncher::ClipLauncher()
 {
@@ -68,19 +72,23 @@ void ClipLauncher::Process(double time)
    float* out = target->GetBuffer()->GetChannel(0);
    assert(bufferSize == gBufferSize);
 
-   int sampleToPlay = -1;
-   for (int i = 0; i < mSamples.size(); ++i)
+   std::lock_guard<ofMutex> lock(mSampleMutex);
+
+   //a streamed clip that's queued gets the disk reading from where it'll launch, on the next bar
+   int queued = GetQueuedClip();
+   if (queued != -1 && IsClipReady(queued))
    {
-      if (mSamples[i].mPlay)
-         sampleToPlay = i;
+      int numBars = mSamples[queued].mNumBars;
+      Sample* queuedSample = mSamples[queued].mSample;
+      queuedSample->PrefetchStream(float((TheTransport->GetMeasure(time) + 1) % numBars) / numBars * queuedSample->LengthInSamples());
    }
 
+   int sampleToPlay = mPlayingIndex;
+
    Sample* sample = nullptr;
    float volSq = 1;
    if (sampleToPlay != -1)
    {
-      mSampleMutex.lock();
-
       sample = mSamples[sampleToPlay].mSample;
       volSq = mVolume * mSamples[sampleToPlay].mVolume;
       volSq *= volSq;
@@ -92,22 +100,123 @@ void ClipLauncher::Process(double time)
 
    if (sample)
    {
-      gWorkChannelBuffer.SetNumActiveChannels(1);
-      sample->ConsumeData(time, &gWorkChannelBuffer, bufferSize, true);
+      gWorkChannelBuffer->SetNumActiveChannels(1);
+      sample->ConsumeData(time, gWorkChannelBuffer, bufferSize, true);
    }
 
    for (int i = 0; i < bufferSize; ++i)
    {
       float samp = 0;
       if (sample)
-         samp = gWorkChannelBuffer.GetChannel(0)[i] * volSq;
+         samp = gWorkChannelBuffer->GetChannel(0)[i] * volSq;
       samp = mJumpBlender.Process(samp, i);
       out[i] += samp;
       GetVizBuffer()->Write(samp, 0);
    }
+}
 
-   if (sampleToPlay != -1)
-      mSampleMutex.unlock();
+int ClipLauncher::GetQueuedClip() const
+{
+   for (int i = 0; i < (int)mSamples.size(); ++i)
+   {
+      if (mSamples[i].mPlay && i != mPlayingIndex)
+         return i;
+   }
+   return -1;
+}
+
+bool ClipLauncher::IsClipReady(int idx) const
+{
+   const SampleData& clip = mSamples[idx];
+   return clip.mResident && clip.mSample->LengthInSamples() > 0 && !clip.mSample->IsSampleLoading();
+}
+
+void ClipLauncher::Poll()
+{
+   for (int i = 0; i < (int)mSamples.size(); ++i)
+      UpdateResidency(i);
+}
+
+//clips from files are read when they're queued, so that there's a bar for them to get ready in, and let go of when they stop
+void ClipLauncher::UpdateResidency(int idx)
+{
+   SampleData& clip = mSamples[idx];
+   if (clip.mPath.empty())
+      return;
+
+   bool wanted = clip.mPlay || idx == mPlayingIndex;
+   if (wanted == clip.mResident)
+      return;
+
+   Sample* sample = clip.CreateSample();
+   if (wanted)
+   {
+      //long files stream from disk with just their head decoded now, shorter ones decode on SampleLoader's threads
+      SampleLoader::Get().BeginBatch();
+      sample->Read(clip.mPath.c_str(), K(mono), Sample::ReadType::Stream);
+      SampleLoader::Get().EndBatch();
+   }
+
+   {
+      std::lock_guard<ofMutex> lock(mSampleMutex);
+      if (!wanted && (clip.mPlay || idx == mPlayingIndex))
+      {
+         //launched since we looked
+         delete sample;
+         return;
+      }
+      std::swap(sample, clip.mSample);
+      clip.mResident = wanted;
+   }
+   delete sample;
+}
+
+void ClipLauncher::SetClipFile(int idx, std::string path, int numBars)
+{
+   SampleData& clip = mSamples[idx];
+   Sample* sample = clip.CreateSample();
+   {
+      std::lock_guard<ofMutex> lock(mSampleMutex);
+      if (idx == mPlayingIndex)
+         mPlayingIndex = -1;
+      std::swap(sample, clip.mSample);
+      clip.mPath = path;
+      clip.mResident = false;
+      clip.mNumBars = MAX(1, numBars);
+      clip.mHasSample = !path.empty();
+   }
+   delete sample;
+}
+
+void ClipLauncher::FilesDropped(std::vector<std::string> files, int x, int y)
+{
+   for (int i = 0; i < (int)mSamples.size(); ++i)
+   {
+      if (y >= GetRowY(i) && y < GetRowY(i + 1))
+      {
+         //only the header gets read now, the audio waits until the clip is queued
+         std::unique_ptr<juce::AudioFormatReader> reader(TheSynth->GetAudioFormatManager().createReaderFor(juce::File(ofToSamplePath(files[0]))));
+         if (reader == nullptr || reader->sampleRate <= 0)
+         {
+            TheSynth->LogEvent("couldn't read " + files[0], kLogEventType_Error);
+            return;
+         }
+         double lengthMs = reader->lengthInSamples / reader->sampleRate * 1000;
+         SetClipFile(i, files[0], (int)round(lengthMs / TheTransport->MsPerBar()));
+         return;
+      }
+   }
+}
+
+size_t ClipLauncher::GetMemoryUsage() const
+{
+   size_t usage = 0;
+   for (const auto& clip : mSamples)
+   {
+      if (clip.mSample != nullptr)
+         usage += clip.mSample->GetMemoryUsage();
+   }
+   return usage;
 }
 
 void ClipLauncher::DropdownClicked(DropdownList* list)
@@ -116,10 +225,32 @@ void ClipLauncher::DropdownClicked(DropdownList* list)
 
 void ClipLauncher::DropdownUpdated(DropdownList* list, int oldVal, double time)
 {
+   for (auto& clip : mSamples)
+   {
+      if (list == clip.mStretchModeSelector)
+         clip.mSample->SetStretchMode(clip.mStretchMode);
+   }
 }
 
 void ClipLauncher::OnTimeEvent(double time)
 {
+   int queued = GetQueuedClip();
+   if (queued == -1)
+      return;
+
+   std::lock_guard<ofMutex> lock(mSampleMutex);
+   if (!IsClipReady(queued))
+      return; //still coming off the disk, launch on the bar after
+
+   float data[JUMP_BLEND_SAMPLES]{};
+   ChannelBuffer temp(data, JUMP_BLEND_SAMPLES);
+   if (mPlayingIndex != -1)
+      mSamples[mPlayingIndex].mSample->ConsumeData(time, &temp, JUMP_BLEND_SAMPLES, true);
+   mJumpBlender.CaptureForJump(0, data, JUMP_BLEND_SAMPLES, gBufferSize);
+
+   mPlayingIndex = queued;
+   for (int i = 0; i < (int)mSamples.size(); ++i)
+      mSamples[i].mPlay = (i == queued);
 }
 
 void ClipLauncher::DrawModule()
@@ -152,32 +283,24 @@ void ClipLauncher::CheckboxUpdated(Checkbox* checkbox, double time)
    {
       if (checkbox == mSamples[i].mPlayCheckbox)
       {
-         int currentlyPlaying = -1;
-         for (int j = 0; j < mSamples.size(); ++j)
+         if (mSamples[i].mPlay)
          {
-            if (j != i && mSamples[j].mPlay)
-               currentlyPlaying = j;
-         }
-         for (int j = 0; j < mSamples.size(); ++j)
-         {
-            if (j != i)
-               mSamples[j].mPlay = false;
-         }
-         int newPlaying = -1;
-         for (int j = 0; j < mSamples.size(); ++j)
-         {
-            if (mSamples[j].mPlay)
-               newPlaying = j;
+            //queue it for the next bar (see OnTimeEvent()), in place of anything else that was queued
+            for (int j = 0; j < mSamples.size(); ++j)
+            {
+               if (j != i && j != mPlayingIndex)
+                  mSamples[j].mPlay = false;
+            }
          }
-         if (currentlyPlaying != newPlaying)
+         else if (i == mPlayingIndex)
          {
-            mSampleMutex.lock();
+            //stopping doesn't wait for the bar
+            std::lock_guard<ofMutex> lock(mSampleMutex);
             float data[JUMP_BLEND_SAMPLES];
             ChannelBuffer temp(data, JUMP_BLEND_SAMPLES);
-            if (currentlyPlaying != -1)
-               mSamples[currentlyPlaying].mSample->ConsumeData(time, &temp, JUMP_BLEND_SAMPLES, true);
+            mSamples[i].mSample->ConsumeData(time, &temp, JUMP_BLEND_SAMPLES, true);
             mJumpBlender.CaptureForJump(0, data, JUMP_BLEND_SAMPLES, gBufferSize);
-            mSampleMutex.unlock();
+            mPlayingIndex = -1;
          }
       }
 
@@ -185,23 +308,34 @@ void ClipLauncher::CheckboxUpdated(Checkbox* checkbox, double time)
       {
          if (mSamples[i].mHasSample)
          {
-            if (mSamples[i].mPlay)
-               mSampleMutex.lock();
+            std::lock_guard<ofMutex> lock(mSampleMutex);
+
+            if (!mSamples[i].mResident)
+            {
+               delete mSamples[i].mSample;
+               mSamples[i].mSample = mSamples[i].CreateSample();
+            }
+            mSamples[i].mPath.clear();
+            mSamples[i].mResident = true;
 
             int bufferSize;
             mSamples[i].mSample->Create(mLooper->GetLoopBuffer(bufferSize));
             mSamples[i].mNumBars = mLooper->GetNumBars();
             mLooper->Clear();
 
-            if (mSamples[i].mPlay)
-               mSampleMutex.unlock();
-
+            //picks up right where the looper left off
+            mPlayingIndex = i;
             for (int j = 0; j < mSamples.size(); ++j)
                mSamples[j].mPlay = (j == i);
          }
          else
          {
+            std::lock_guard<ofMutex> lock(mSampleMutex);
+            if (i == mPlayingIndex)
+               mPlayingIndex = -1;
             mSamples[i].mPlay = false;
+            mSamples[i].mPath.clear();
+            mSamples[i].mResident = true;
             mSamples[i].mSample->Create(1);
          }
       }
@@ -210,7 +344,7 @@ void ClipLauncher::CheckboxUpdated(Checkbox* checkbox, double time)
 
 void ClipLauncher::GetModuleDimensions(float& width, float& height)
 {
-   width = 180;
+   width = 220;
    height = 180;
 }
 
@@ -253,6 +387,7 @@ void ClipLauncher::SetUpFromSaveData()
 {
    SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
    mLooper = dynamic_cast<Looper*>(TheSynth->FindModule(mModuleSaveData.GetString("looper"), false));
+   mPlayingIndex = -1;
    mSamples.resize(mModuleSaveData.GetInt("numclips"));
    for (int i = 0; i < mSamples.size(); ++i)
    {
@@ -260,6 +395,50 @@ void ClipLauncher::SetUpFromSaveData()
    }
 }
 
+void ClipLauncher::SaveState(FileStreamOut& out)
+{
+   out << GetModuleSaveStateRev();
+
+   IDrawableModule::SaveState(out);
+
+   //clips grabbed from the looper only live in memory, clips from files are saved as where to find them
+   out << (int)mSamples.size();
+   for (const auto& clip : mSamples)
+   {
+      out << clip.mPath;
+      out << clip.mNumBars;
+   }
+}
+
+void ClipLauncher::LoadState(FileStreamIn& in, int rev)
+{
+   IDrawableModule::LoadState(in, rev);
+
+   if (rev < 0)
+      return;
+
+   int numClips;
+   in >> numClips;
+   for (int i = 0; i < numClips; ++i)
+   {
+      std::string path;
+      int numBars;
+      in >> path;
+      in >> numBars;
+      if (i < (int)mSamples.size() && !path.empty())
+         SetClipFile(i, path, numBars);
+   }
+}
+
+std::vector<IUIControl*> ClipLauncher::ControlsToNotSetDuringLoadState() const
+{
+   //grabbing is an action on the looper, not something to redo when loading. a clip from a file sets it again itself
+   std::vector<IUIControl*> ignore;
+   for (const auto& clip : mSamples)
+      ignore.push_back(clip.mGrabCheckbox);
+   return ignore;
+}
+
 ClipLauncher::SampleData::~SampleData()
 {
    delete mSample;
@@ -281,22 +460,53 @@ void ClipLauncher::SampleData::Init(ClipLauncher* launcher, int index)
       launcher->RemoveUIControl(mPlayCheckbox);
       mPlayCheckbox->Delete();
    }
+   if (mStretchModeSelector)
+   {
+      launcher->RemoveUIControl(mStretchModeSelector);
+      mStretchModeSelector->Delete();
+   }
 
    std::string indexStr = ofToString(index + 1);
 
-   mSample = new Sample();
-   mSample->SetLooping(true);
+   mSample = CreateSample();
    int y = launcher->GetRowY(index);
    mGrabCheckbox = new Checkbox(launcher, ("grab" + indexStr).c_str(), 110, y, &mHasSample);
    mPlayCheckbox = new Checkbox(launcher, ("play" + indexStr).c_str(), 110, y + 20, &mPlay);
+   mStretchModeSelector = new DropdownList(launcher, ("stretch" + indexStr).c_str(), 165, y, (int*)(&mStretchMode), 50);
+   mStretchModeSelector->AddLabel("resample", (int)StretchMode::Off);
+   mStretchModeSelector->AddLabel("beats", (int)StretchMode::Beats);
+   mStretchModeSelector->AddLabel("tonal", (int)StretchMode::Tonal);
+}
+
+//clips loop, and follow the tempo the way this clip's dropdown says
+Sample* ClipLauncher::SampleData::CreateSample() const
+{
+   Sample* sample = new Sample();
+   sample->SetLooping(true);
+   sample->SetStretchMode(mStretchMode);
+   return sample;
 }
 
 void ClipLauncher::SampleData::Draw()
 {
    ofPushMatrix();
    ofTranslate(5, mClipLauncher->GetRowY(mIndex));
-   DrawAudioBuffer(100, 36, mSample->Data(), 0, mSample->LengthInSamples(), mPlay ? mSample->GetPlayPosition() : -1);
+   bool playing = mIndex == mClipLauncher->mPlayingIndex;
+   if (mResident)
+      DrawAudioBuffer(100, 36, mSample->Data(), 0, mSample->LengthInSamples(), playing ? mSample->GetPlayPosition() : -1);
+   else
+      DrawTextNormal(juce::File(ofToSamplePath(mPath)).getFileName().toStdString(), 2, 20, 10);
+   if (mPlay && !playing)
+   {
+      //queued
+      ofPushStyle();
+      ofNoFill();
+      ofSetColor(255, 255, 0, gModuleDrawAlpha);
+      ofRect(0, 0, 100, 36);
+      ofPopStyle();
+   }
    ofPopMatrix();
    mGrabCheckbox->Draw();
    mPlayCheckbox->Draw();
+   mStretchModeSelector->Draw();
 }
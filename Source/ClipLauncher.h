@@ -35,6 +35,7 @@
 #include "ClickButton.h"
 #include "OpenFrameworksPort.h"
 #include "JumpBlender.h"
+#include "TimeStretcher.h"
 
 class Sample;
 class Looper;
@@ -54,6 +55,9 @@ public:
 
    int GetRowY(int idx);
 
+   void Poll() override;
+   void FilesDropped(std::vector<std::string> files, int x, int y) override;
+
    //IAudioSource
    void Process(double time) override;
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
@@ -70,10 +74,20 @@ public:
    virtual void SaveLayout(ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
 
+   void SaveState(FileStreamOut& out) override;
+   void LoadState(FileStreamIn& in, int rev) override;
+   int GetModuleSaveStateRev() const override { return 0; }
+   std::vector<IUIControl*> ControlsToNotSetDuringLoadState() const override;
+
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override;
 
 private:
    void RecalcPos(double time, int idx);
+   int GetQueuedClip() const;
+   bool IsClipReady(int idx) const;
+   void SetClipFile(int idx, std::string path, int numBars);
+   void UpdateResidency(int idx);
 
    //IDrawableModule
    void DrawModule() override;
@@ -87,12 +101,17 @@ private:
 
       void Init(ClipLauncher* launcher, int index);
       void Draw();
+      Sample* CreateSample() const;
 
       Sample* mSample{ nullptr };
+      std::string mPath; //clips from files only stay decoded while they're playing or queued
+      bool mResident{ true };
       int mNumBars{ 1 };
       float mVolume{ 1 };
       Checkbox* mGrabCheckbox{ nullptr };
       Checkbox* mPlayCheckbox{ nullptr };
+      StretchMode mStretchMode{ StretchMode::Off }; //how the clip follows the tempo
+      DropdownList* mStretchModeSelector{ nullptr };
       ClipLauncher* mClipLauncher{ nullptr };
       int mIndex{ 0 };
       bool mPlay{ false };
@@ -105,6 +124,7 @@ private:
    FloatSlider* mVolumeSlider{ nullptr };
 
    std::vector<SampleData> mSamples;
+   int mPlayingIndex{ -1 }; //clips launch on the next bar, this is the one that's actually playing
    JumpBlender mJumpBlender;
    ofMutex mSampleMutex;
 };
@@ -64,6 +64,8 @@ CodeEntry::CodeEntry(ICodeEntryListener* owner, const char* name, int x, int y,
    assert(module);
    module->AddUIControl(this);
    SetParent(dynamic_cast<IClickable*>(owner));
+   UpdateLines();
+   mPublishedLines = mLines;
 }
 
 CodeEntry::~CodeEntry()
@@ -74,23 +76,7 @@ void CodeEntry::Poll()
 {
    if (mCodeUpdated)
    {
-      if (mDoSyntaxHighlighting && sDoSyntaxHighlighting)
-      {
-         try
-         {
-            py::globals()["syntax_highlight_code"] = GetVisibleCode();
-            py::object ret = py::eval("syntax_highlight_basic()", py::globals());
-            mSyntaxHighlightMapping = ret.cast<std::vector<int> >();
-         }
-         catch (const std::exception& e)
-         {
-            ofLog() << "syntax highlight execution exception: " << e.what();
-         }
-      }
-      else
-      {
-         mSyntaxHighlightMapping.clear();
-      }
+      UpdateSyntaxHighlight();
 
       if (mListener)
          mListener->OnCodeUpdated();
@@ -107,12 +93,13 @@ void CodeEntry::Poll()
          {
             mAutocompleteCaretCoords = GetCaretCoords(mCaretPosition);
 
-            if (!GetVisibleCode().empty())
+            std::string visibleCode = GetVisibleCode();
+            if (!visibleCode.empty())
             {
                try
                {
                   std::string prefix = ScriptModule::GetBootstrapImportString() + "; import me\n";
-                  py::exec("jediScript = jedi.Script('''" + prefix + GetVisibleCode() + "''', project=jediProject)", py::globals());
+                  py::exec("jediScript = jedi.Script('''" + prefix + visibleCode + "''', project=jediProject)", py::globals());
                   //py::exec("jediScript = jedi.Script('''" + prefix + GetVisibleCode() + "''')", py::globals());
                   //py::exec("jediScript = jedi.Interpreter('''" + prefix + GetVisibleCode() + "''', [locals(), globals()])", py::globals());
                   auto coords = GetCaretCoords(mCaretPosition);
@@ -312,34 +299,21 @@ void CodeEntry::Render()
    mCharWidth = gFontFixedWidth.GetStringWidth("x", mFontSize);
    mCharHeight = gFontFixedWidth.GetStringHeight("x", mFontSize);
 
+   //only the lines in view are drawn, however long the script is
    if (hasUnpublishedCode)
    {
+      int firstPublishedLine, lastPublishedLine;
+      GetVisibleLineRange((int)mPublishedLines.size(), firstPublishedLine, lastPublishedLine);
       ofSetColor(color, gModuleDrawAlpha * .05f);
-      gFontFixedWidth.DrawString(mPublishedString, mFontSize, mX + 2 - mScroll.x, mY + mCharHeight - mScroll.y);
+      for (int i = MAX(0, firstPublishedLine); i <= lastPublishedLine; ++i)
+         gFontFixedWidth.DrawString(mPublishedLines[i], mFontSize, mX + 2 - mScroll.x, mY + mCharHeight - mScroll.y + i * mCharHeight);
    }
 
    ofSetColor(color, gModuleDrawAlpha);
 
-   std::string drawString = GetVisibleCode();
-
-   ofPushStyle();
-   const float dim = .7f;
-   DrawSyntaxHighlight(drawString, stringColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 3, -1);
-   DrawSyntaxHighlight(drawString, numberColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 2, -1);
-   DrawSyntaxHighlight(drawString, name1Color * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 1, -1);
-   DrawSyntaxHighlight(drawString, name2Color * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 90, -1);
-   DrawSyntaxHighlight(drawString, name3Color * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 91, -1);
-   DrawSyntaxHighlight(drawString, definedColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 92, -1);
-   DrawSyntaxHighlight(drawString, equalsColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 22, -1);
-   DrawSyntaxHighlight(drawString, parenColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 7, 8);
-   DrawSyntaxHighlight(drawString, braceColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 25, 26);
-   DrawSyntaxHighlight(drawString, bracketColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 9, 10);
-   DrawSyntaxHighlight(drawString, opColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 51, -1);
-   DrawSyntaxHighlight(drawString, commaColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 12, -1);
-   DrawSyntaxHighlight(drawString, commentColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 53, -1);
-   DrawSyntaxHighlight(drawString, unknownColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, 52, 59); //"error" token (like incomplete quotes)
-   DrawSyntaxHighlight(drawString, unknownColor * (isCurrent ? 1 : dim), mSyntaxHighlightMapping, -1, -1);
-   ofPopStyle();
+   int firstLine, lastLine;
+   GetVisibleLineRange((int)mLines.size(), firstLine, lastLine);
+   DrawSyntaxHighlight(isCurrent, firstLine, lastLine);
 
    /*for (int i = 0; i<60; ++i)
    {
@@ -379,7 +353,7 @@ void CodeEntry::Render()
          int endLineNum = (int)round(coordsEnd.y);
          int startCol = (int)round(coordsStart.x);
          int endCol = (int)round(coordsEnd.x);
-         auto lines = GetLines(false);
+         const auto& lines = GetLines(false);
          for (int i = startLineNum; i <= endLineNum; ++i)
          {
             int begin = 0;
@@ -406,8 +380,7 @@ void CodeEntry::Render()
       DrawTextNormal(Name(), mX, mY);
    }*/
 
-   const auto& lines = GetLines(false);
-   float totalHeight = MAX(lines.size() * mCharHeight, mScroll.y + mHeight);
+   float totalHeight = MAX(mLines.size() * mCharHeight, mScroll.y + mHeight);
    if (mScroll.y > 0 || totalHeight > mHeight)
    {
       ofPushStyle();
@@ -416,13 +389,7 @@ void CodeEntry::Render()
       ofRect(mX + mWidth - 6, mY + (mScroll.y / totalHeight) * mHeight, 3, (mHeight / totalHeight) * mHeight);
       ofPopStyle();
    }
-   float totalWidth = mWidth;
-   for (const auto& line : lines)
-   {
-      float lineWidth = line.length() * mCharWidth;
-      if (lineWidth > totalWidth)
-         totalWidth = lineWidth;
-   }
+   float totalWidth = MAX(mWidth, mLongestLine * mCharWidth);
    if (mScroll.x > 0 || totalWidth > mWidth)
    {
       ofPushStyle();
@@ -514,25 +481,27 @@ void CodeEntry::RenderOverlay()
    }
 }
 
+void CodeEntry::GetVisibleLineRange(int numLines, int& firstLine, int& lastLine) const
+{
+   //the lines with (i + 1) * mCharHeight >= mScroll.y and i * mCharHeight <= mScroll.y + mHeight, or -1 for both if there are none
+   firstLine = MAX(0, (int)ceil(mScroll.y / mCharHeight - 1));
+   lastLine = MIN(numLines - 1, (int)floor((mScroll.y + mHeight) / mCharHeight));
+   if (firstLine > lastLine)
+   {
+      firstLine = -1;
+      lastLine = -1;
+   }
+}
+
 std::string CodeEntry::GetVisibleCode()
 {
    std::string visible;
-   std::vector<std::string> lines = GetLines(false);
+   const auto& lines = GetLines(false);
    if (lines.empty())
       return "";
 
-   int firstVisibleLine = -1;
-   int lastVisibleLine = -1;
-
-   for (int i = 0; i < (int)lines.size(); ++i)
-   {
-      if ((i + 1) * mCharHeight >= mScroll.y && i * mCharHeight <= mScroll.y + mHeight)
-      {
-         if (firstVisibleLine == -1)
-            firstVisibleLine = i;
-         lastVisibleLine = i;
-      }
-   }
+   int firstVisibleLine, lastVisibleLine;
+   GetVisibleLineRange((int)lines.size(), firstVisibleLine, lastVisibleLine);
 
    while (firstVisibleLine > 0)
    {
@@ -551,40 +520,154 @@ std::string CodeEntry::GetVisibleCode()
    return visible;
 }
 
-void CodeEntry::DrawSyntaxHighlight(std::string input, ofColor color, std::vector<int> mapping, int filter1, int filter2)
+//static
+int CodeEntry::GetHighlightTypeForToken(int token)
 {
-   std::string filtered = FilterText(input, mapping, filter1, filter2);
-   ofSetColor(color, gModuleDrawAlpha);
+   switch (token)
+   {
+      case 3: return kHighlight_String;
+      case 2: return kHighlight_Number;
+      case 1: return kHighlight_Name1;
+      case 90: return kHighlight_Name2;
+      case 91: return kHighlight_Name3;
+      case 92: return kHighlight_Defined;
+      case 22: return kHighlight_Equals;
+      case 7:
+      case 8: return kHighlight_Paren;
+      case 25:
+      case 26: return kHighlight_Brace;
+      case 9:
+      case 10: return kHighlight_Bracket;
+      case 51: return kHighlight_Op;
+      case 12: return kHighlight_Comma;
+      case 53: return kHighlight_Comment;
+      case 99: return kHighlight_None;
+      default: return kHighlight_Unknown; //including "error" tokens, like incomplete quotes
+   }
+}
 
-   float shake = (1 - ofClamp((gTime - mLastPublishTime) / 150, 0, 1)) * 3.0f;
-   if (TheSynth->IsAudioPaused())
-      shake = 0;
-   float offsetX = ofRandom(-shake, shake);
-   float offsetY = ofRandom(-shake, shake);
+ofColor CodeEntry::GetHighlightColor(int type) const
+{
+   switch (type)
+   {
+      case kHighlight_String: return stringColor;
+      case kHighlight_Number: return numberColor;
+      case kHighlight_Name1: return name1Color;
+      case kHighlight_Name2: return name2Color;
+      case kHighlight_Name3: return name3Color;
+      case kHighlight_Defined: return definedColor;
+      case kHighlight_Equals: return equalsColor;
+      case kHighlight_Paren: return parenColor;
+      case kHighlight_Brace: return braceColor;
+      case kHighlight_Bracket: return bracketColor;
+      case kHighlight_Op: return opColor;
+      case kHighlight_Comma: return commaColor;
+      case kHighlight_Comment: return commentColor;
+      default: return unknownColor;
+   }
+}
 
-   gFontFixedWidth.DrawString(filtered, mFontSize, mX + 2 - mScroll.x + offsetX, mY + mCharHeight - mScroll.y + offsetY);
+void CodeEntry::UpdateLines()
+{
+   mLines = ofSplitString(mString, "\n");
+   mLongestLine = 0;
+   for (const auto& line : mLines)
+      mLongestLine = MAX(mLongestLine, (int)line.length());
+   mLineHighlights.resize(mLines.size());
 }
 
-std::string CodeEntry::FilterText(std::string input, std::vector<int> mapping, int filter1, int filter2)
+void CodeEntry::UpdateSyntaxHighlight()
 {
-   for (size_t i = 0; i < input.size(); ++i)
+   //only the visible lines go to the tokenizer, from the last unindented line so it can make sense of the indentation.
+   //lines keep the runs they got last, so a line scrolled back into view draws in its old colours until this gets to it
+   int firstLine, lastLine;
+   GetVisibleLineRange((int)mLines.size(), firstLine, lastLine);
+   if (firstLine < 0)
+      return;
+   while (firstLine > 0 && mLines[firstLine][0] == ' ')
+      --firstLine;
+
+   std::string code;
+   for (int i = firstLine; i <= lastLine; ++i)
+      code += mLines[i] + "\n";
+   if (firstLine == mHighlightedFirstLine && code == mHighlightedCode)
+      return;
+   mHighlightedFirstLine = firstLine;
+   mHighlightedCode = code;
+
+   std::vector<int> mapping;
+   if (mDoSyntaxHighlighting && sDoSyntaxHighlighting)
    {
-      if (input[i] != '\n')
+      try
       {
-         if (i < mapping.size())
-         {
-            if (mapping[i] != filter1 && mapping[i] != filter2)
-               input[i] = ' ';
-         }
+         py::globals()["syntax_highlight_code"] = code;
+         py::object ret = py::eval("syntax_highlight_basic()", py::globals());
+         mapping = ret.cast<std::vector<int> >();
+      }
+      catch (const std::exception& e)
+      {
+         ofLog() << "syntax highlight execution exception: " << e.what();
+      }
+   }
+
+   //the mapping has an entry per character, newlines included, and anything past the end of it draws as unknown
+   size_t index = 0;
+   for (int i = firstLine; i <= lastLine; ++i)
+   {
+      auto& runs = mLineHighlights[i];
+      runs.clear();
+      int length = (int)mLines[i].length();
+      for (int col = 0; col < length; ++col, ++index)
+      {
+         int type = index < mapping.size() ? GetHighlightTypeForToken(mapping[index]) : kHighlight_Unknown;
+         if (type == kHighlight_None)
+            continue;
+         if (!runs.empty() && runs.back().mType == type && runs.back().mStart + runs.back().mLength == col)
+            ++runs.back().mLength;
          else
-         {
-            bool showLeftovers = (filter1 == -1 && filter2 == -1);
-            if (!showLeftovers)
-               input[i] = ' ';
-         }
+            runs.push_back(HighlightRun{ col, 1, type });
       }
+      ++index;
    }
-   return input;
+}
+
+void CodeEntry::DrawSyntaxHighlight(bool isCurrent, int firstLine, int lastLine)
+{
+   if (firstLine < 0)
+      return;
+
+   const float dim = isCurrent ? 1 : .7f;
+
+   float shake = (1 - ofClamp((gTime - mLastPublishTime) / 150, 0, 1)) * 3.0f;
+   if (TheSynth->IsAudioPaused())
+      shake = 0;
+   ofVec2f offsets[kNumHighlightTypes];
+   for (auto& offset : offsets)
+      offset.set(ofRandom(-shake, shake), ofRandom(-shake, shake));
+
+   ofPushStyle();
+   for (int i = firstLine; i <= lastLine; ++i)
+   {
+      const std::string& line = mLines[i];
+      float x = mX + 2 - mScroll.x;
+      float y = mY + mCharHeight - mScroll.y + i * mCharHeight;
+      int drawnTo = 0;
+      for (const auto& run : mLineHighlights[i])
+      {
+         //the runs can be from before the latest edit, until the next poll
+         if (run.mStart >= (int)line.length())
+            break;
+         ofSetColor(GetHighlightColor(run.mType) * dim, gModuleDrawAlpha);
+         gFontFixedWidth.DrawString(line.substr(run.mStart, run.mLength), mFontSize, x + run.mStart * mCharWidth + offsets[run.mType].x, y + offsets[run.mType].y);
+         drawnTo = run.mStart + run.mLength;
+      }
+      if (drawnTo < (int)line.length())
+      {
+         ofSetColor(unknownColor * dim, gModuleDrawAlpha);
+         gFontFixedWidth.DrawString(line.substr(drawnTo), mFontSize, x + drawnTo * mCharWidth + offsets[kHighlight_Unknown].x, y + offsets[kHighlight_Unknown].y);
+      }
+   }
+   ofPopStyle();
 }
 
 //static
@@ -664,7 +747,7 @@ void CodeEntry::OnPythonInit()
               elif isPython3 and tok_name[token.type] == 'COMMENT':
                  token_type = 53
 
-              if not token_type in [3, 2, 1, 90, 91, 92, 22, 7, 8, 25, 26, 9, 10, 51, 12, 53, 52, 59]: #this list matches the list of matches we use for the DrawSyntaxHighlight() calls
+              if not token_type in [3, 2, 1, 90, 91, 92, 22, 7, 8, 25, 26, 9, 10, 51, 12, 53, 52, 59]: #this list matches the tokens in GetHighlightTypeForToken()
                  token_type = -1
 
               row_start, char_start = token.start[0]-1, token.start[1]
@@ -672,7 +755,7 @@ void CodeEntry::OnPythonInit()
               if lastRowEnd != row_end:
                  lastCharEnd = 0
 
-              output = output + [99]*(char_start - lastCharEnd) + [token_type]*(char_end - char_start)
+              output += [99]*(char_start - lastCharEnd) + [token_type]*(char_end - char_start)
               lastCharEnd = char_end
               lastRowEnd = row_end
 
@@ -921,7 +1004,7 @@ void CodeEntry::OnKeyPressed(int key, bool isRepeat)
 
          ofVec2f coords = GetCaretCoords(mCaretPosition);
          int lineNum = (int)round(coords.y);
-         auto lines = GetLines(false);
+         const auto& lines = GetLines(false);
          int numSpaces = 0;
          if (mCaretPosition > 0 && mString[mCaretPosition - 1] == ':') //auto-indent
             numSpaces += kTabSize;
@@ -1028,6 +1111,8 @@ void CodeEntry::AcceptAutocompletion()
 void CodeEntry::Publish()
 {
    mPublishedString = mString;
+   mPublishedLines = mLines;
+   mHighlightedFirstLine = -1; //names the script defines change colour once it runs
    mLastPublishTime = gTime;
    mLastPublishedLineStart = 0;
    mLastPublishedLineEnd = (int)GetLines(true).size();
@@ -1046,6 +1131,7 @@ void CodeEntry::Undo()
       mString = mUndoBuffer[mUndoBufferPos].mString;
       mCaretPosition = mUndoBuffer[mUndoBufferPos].mCaretPos;
       mCaretPosition2 = mUndoBuffer[mUndoBufferPos].mCaretPos;
+      UpdateLines();
 
       OnCodeUpdated();
    }
@@ -1063,6 +1149,7 @@ void CodeEntry::Redo()
       mString = mUndoBuffer[mUndoBufferPos].mString;
       mCaretPosition = mUndoBuffer[mUndoBufferPos].mCaretPos;
       mCaretPosition2 = mUndoBuffer[mUndoBufferPos].mCaretPos;
+      UpdateLines();
 
       OnCodeUpdated();
    }
@@ -1073,6 +1160,7 @@ void CodeEntry::UpdateString(std::string newString)
    mUndoBuffer[mUndoBufferPos].mCaretPos = mCaretPosition;
 
    mString = newString;
+   UpdateLines();
 
    int size = (int)mUndoBuffer.size();
    mRedosLeft = 0;
@@ -1204,7 +1292,7 @@ void CodeEntry::MoveCaret(int pos, bool allowSelection /*=true*/)
 void CodeEntry::MoveCaretToStart()
 {
    ofVec2f coords = GetCaretCoords(mCaretPosition);
-   auto lines = GetLines(false);
+   const auto& lines = GetLines(false);
    int x = 0;
    if (coords.y < lines.size())
    {
@@ -1270,7 +1358,7 @@ void CodeEntry::SetDimensions(float width, float height)
 
 int CodeEntry::GetCaretPosition(int col, int row)
 {
-   auto lines = GetLines(false);
+   const auto& lines = GetLines(false);
    int caretPos = 0;
    for (size_t i = 0; i < row && i < lines.size(); ++i)
       caretPos += lines[i].length() + 1;
@@ -1312,8 +1400,7 @@ ofVec2f CodeEntry::GetLinePos(int lineNum, bool end, bool published /*= true*/)
 
    if (end)
    {
-      std::string str = published ? mPublishedString : mString;
-      auto lines = ofSplitString(str, "\n");
+      const auto& lines = GetLines(published);
       if (lineNum < (int)lines.size())
          x += lines[lineNum].length() * mCharWidth;
    }
@@ -1325,7 +1412,7 @@ ofVec2f CodeEntry::GetCaretCoords(int caret)
 {
    ofVec2f coords;
    int caretRemaining = caret;
-   auto lines = GetLines(false);
+   const auto& lines = GetLines(false);
    for (size_t i = 0; i < lines.size(); ++i)
    {
       if (caretRemaining >= lines[i].length() + 1)
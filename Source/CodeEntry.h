@@ -55,12 +55,17 @@ public:
    {
       mString = "";
       mCaretPosition = 0;
+      UpdateLines();
    }
    const std::string GetText(bool published) const { return published ? mPublishedString : mString; }
-   const std::vector<std::string> GetLines(bool published) const { return ofSplitString(published ? mPublishedString : mString, "\n"); }
+   const std::vector<std::string>& GetLines(bool published) const { return published ? mPublishedLines : mLines; }
    void SetText(std::string text) { UpdateString(text); }
    void SetError(bool error, int errorLine = -1);
-   void SetDoSyntaxHighlighting(bool highlight) { mDoSyntaxHighlighting = highlight; }
+   void SetDoSyntaxHighlighting(bool highlight)
+   {
+      mDoSyntaxHighlighting = highlight;
+      mHighlightedFirstLine = -1;
+   }
    static bool HasJediNotInstalledWarning() { return sWarnJediNotInstalled; }
 
    static void OnPythonInit();
@@ -109,9 +114,13 @@ private:
    void Undo();
    void Redo();
    void UpdateString(std::string newString);
-   void DrawSyntaxHighlight(std::string input, ofColor color, std::vector<int> mapping, int filter1, int filter2);
-   std::string FilterText(std::string input, std::vector<int> mapping, int filter1, int filter2);
+   void UpdateLines();
+   void UpdateSyntaxHighlight();
+   void DrawSyntaxHighlight(bool isCurrent, int firstLine, int lastLine);
+   ofColor GetHighlightColor(int type) const;
+   static int GetHighlightTypeForToken(int token);
    void OnCodeUpdated();
+   void GetVisibleLineRange(int numLines, int& firstLine, int& lastLine) const;
    std::string GetVisibleCode();
    bool IsAutocompleteShowing();
    void AcceptAutocompletion();
@@ -143,6 +152,34 @@ private:
       std::string autocompleteRest;
    };
 
+   enum HighlightType
+   {
+      kHighlight_String,
+      kHighlight_Number,
+      kHighlight_Name1,
+      kHighlight_Name2,
+      kHighlight_Name3,
+      kHighlight_Defined,
+      kHighlight_Equals,
+      kHighlight_Paren,
+      kHighlight_Brace,
+      kHighlight_Bracket,
+      kHighlight_Op,
+      kHighlight_Comma,
+      kHighlight_Comment,
+      kHighlight_Unknown,
+      kNumHighlightTypes,
+      kHighlight_None //whitespace between tokens
+   };
+
+   //a stretch of one line drawn in one colour
+   struct HighlightRun
+   {
+      int mStart{ 0 };
+      int mLength{ 0 };
+      int mType{ kHighlight_Unknown };
+   };
+
    ICodeEntryListener* mListener;
    float mWidth{ 200 };
    float mHeight{ 20 };
@@ -150,6 +187,9 @@ private:
    float mCharHeight{ 15 };
    std::string mString;
    std::string mPublishedString;
+   std::vector<std::string> mLines;
+   std::vector<std::string> mPublishedLines;
+   int mLongestLine{ 0 };
    std::array<UndoBufferEntry, 50> mUndoBuffer;
    int mUndoBufferPos{ 0 };
    int mUndosLeft{ 0 };
@@ -165,7 +205,9 @@ private:
    bool mHasError{ false };
    int mErrorLine{ -1 };
    ofVec2f mScroll;
-   std::vector<int> mSyntaxHighlightMapping;
+   std::vector<std::vector<HighlightRun> > mLineHighlights; //per line, kept for lines scrolled out of view
+   std::string mHighlightedCode; //what was last sent to the highlighter, so scrolling within the same lines doesn't resend it
+   int mHighlightedFirstLine{ -1 };
    /*
     * For syntax highlighting we have both a static (system wide) and mDo (per insdtance)
     * control and then we use and
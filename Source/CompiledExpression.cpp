@@ -0,0 +1,820 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    CompiledExpression.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#include "CompiledExpression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+enum class CompiledExpression::Op : int
+{
+   Constant,
+   Variable,
+   //one argument
+   Negate,
+   Not,
+   Abs,
+   Sqrt,
+   Exp,
+   Expm1,
+   Log,
+   Log1p,
+   Log2,
+   Log10,
+   Sin,
+   Cos,
+   Tan,
+   Asin,
+   Acos,
+   Atan,
+   Sinh,
+   Cosh,
+   Tanh,
+   Floor,
+   Ceil,
+   Round,
+   Trunc,
+   Frac,
+   Sgn,
+   Deg2Rad,
+   Rad2Deg,
+   //two arguments
+   Add,
+   Subtract,
+   Multiply,
+   Divide,
+   Modulus,
+   Pow,
+   Min,
+   Max,
+   Atan2,
+   Hypot,
+   Logn,
+   Root,
+   Roundn,
+   Less,
+   LessEqual,
+   Greater,
+   GreaterEqual,
+   Equal,
+   NotEqual,
+   And,
+   Or,
+   Xor,
+   //three arguments
+   Select,
+   Clamp,
+   InRange
+};
+
+namespace
+{
+   using Op = CompiledExpression::Op;
+
+   int GetNumArgs(Op op)
+   {
+      if (op <= Op::Variable)
+         return 0;
+      if (op <= Op::Rad2Deg)
+         return 1;
+      if (op <= Op::Xor)
+         return 2;
+      return 3;
+   }
+
+   template <typename F>
+   void Apply1(float* out, const float* a, int n, F f)
+   {
+      for (int i = 0; i < n; ++i)
+         out[i] = f(a[i]);
+   }
+
+   template <typename F>
+   void Apply2(float* out, const float* a, const float* b, int n, F f)
+   {
+      for (int i = 0; i < n; ++i)
+         out[i] = f(a[i], b[i]);
+   }
+
+   template <typename F>
+   void Apply3(float* out, const float* a, const float* b, const float* c, int n, F f)
+   {
+      for (int i = 0; i < n; ++i)
+         out[i] = f(a[i], b[i], c[i]);
+   }
+
+   //the same loops are used for folding constants and for single-valued registers, with n = 1, so the results always agree
+   void Apply(Op op, float* out, const float* a, const float* b, const float* c, int n)
+   {
+      switch (op)
+      {
+         case Op::Negate: Apply1(out, a, n, [](float x) { return -x; }); break;
+         case Op::Not: Apply1(out, a, n, [](float x) { return x == 0 ? 1.0f : 0.0f; }); break;
+         case Op::Abs: Apply1(out, a, n, [](float x) { return fabsf(x); }); break;
+         case Op::Sqrt: Apply1(out, a, n, [](float x) { return sqrtf(x); }); break;
+         case Op::Exp: Apply1(out, a, n, [](float x) { return expf(x); }); break;
+         case Op::Expm1: Apply1(out, a, n, [](float x) { return expm1f(x); }); break;
+         case Op::Log: Apply1(out, a, n, [](float x) { return logf(x); }); break;
+         case Op::Log1p: Apply1(out, a, n, [](float x) { return log1pf(x); }); break;
+         case Op::Log2: Apply1(out, a, n, [](float x) { return log2f(x); }); break;
+         case Op::Log10: Apply1(out, a, n, [](float x) { return log10f(x); }); break;
+         case Op::Sin: Apply1(out, a, n, [](float x) { return sinf(x); }); break;
+         case Op::Cos: Apply1(out, a, n, [](float x) { return cosf(x); }); break;
+         case Op::Tan: Apply1(out, a, n, [](float x) { return tanf(x); }); break;
+         case Op::Asin: Apply1(out, a, n, [](float x) { return asinf(x); }); break;
+         case Op::Acos: Apply1(out, a, n, [](float x) { return acosf(x); }); break;
+         case Op::Atan: Apply1(out, a, n, [](float x) { return atanf(x); }); break;
+         case Op::Sinh: Apply1(out, a, n, [](float x) { return sinhf(x); }); break;
+         case Op::Cosh: Apply1(out, a, n, [](float x) { return coshf(x); }); break;
+         case Op::Tanh: Apply1(out, a, n, [](float x) { return tanhf(x); }); break;
+         case Op::Floor: Apply1(out, a, n, [](float x) { return floorf(x); }); break;
+         case Op::Ceil: Apply1(out, a, n, [](float x) { return ceilf(x); }); break;
+         case Op::Round: Apply1(out, a, n, [](float x) { return roundf(x); }); break;
+         case Op::Trunc: Apply1(out, a, n, [](float x) { return truncf(x); }); break;
+         case Op::Frac: Apply1(out, a, n, [](float x) { return x - truncf(x); }); break;
+         case Op::Sgn: Apply1(out, a, n, [](float x) { return x > 0 ? 1.0f : (x < 0 ? -1.0f : 0.0f); }); break;
+         case Op::Deg2Rad: Apply1(out, a, n, [](float x) { return x * float(M_PI / 180); }); break;
+         case Op::Rad2Deg: Apply1(out, a, n, [](float x) { return x * float(180 / M_PI); }); break;
+
+         case Op::Add: Apply2(out, a, b, n, [](float x, float y) { return x + y; }); break;
+         case Op::Subtract: Apply2(out, a, b, n, [](float x, float y) { return x - y; }); break;
+         case Op::Multiply: Apply2(out, a, b, n, [](float x, float y) { return x * y; }); break;
+         case Op::Divide: Apply2(out, a, b, n, [](float x, float y) { return x / y; }); break;
+         case Op::Modulus: Apply2(out, a, b, n, [](float x, float y) { return fmodf(x, y); }); break;
+         case Op::Pow: Apply2(out, a, b, n, [](float x, float y) { return powf(x, y); }); break;
+         case Op::Min: Apply2(out, a, b, n, [](float x, float y) { return x < y ? x : y; }); break;
+         case Op::Max: Apply2(out, a, b, n, [](float x, float y) { return x > y ? x : y; }); break;
+         case Op::Atan2: Apply2(out, a, b, n, [](float x, float y) { return atan2f(x, y); }); break;
+         case Op::Hypot: Apply2(out, a, b, n, [](float x, float y) { return hypotf(x, y); }); break;
+         case Op::Logn: Apply2(out, a, b, n, [](float x, float y) { return logf(x) / logf(y); }); break;
+         case Op::Root: Apply2(out, a, b, n, [](float x, float y) { return powf(x, 1 / y); }); break;
+         case Op::Roundn: Apply2(out, a, b, n, [](float x, float y)
+                                 {
+                                    float scale = powf(10, truncf(y));
+                                    return roundf(x * scale) / scale;
+                                 });
+            break;
+         case Op::Less: Apply2(out, a, b, n, [](float x, float y) { return x < y ? 1.0f : 0.0f; }); break;
+         case Op::LessEqual: Apply2(out, a, b, n, [](float x, float y) { return x <= y ? 1.0f : 0.0f; }); break;
+         case Op::Greater: Apply2(out, a, b, n, [](float x, float y) { return x > y ? 1.0f : 0.0f; }); break;
+         case Op::GreaterEqual: Apply2(out, a, b, n, [](float x, float y) { return x >= y ? 1.0f : 0.0f; }); break;
+         case Op::Equal: Apply2(out, a, b, n, [](float x, float y) { return x == y ? 1.0f : 0.0f; }); break;
+         case Op::NotEqual: Apply2(out, a, b, n, [](float x, float y) { return x != y ? 1.0f : 0.0f; }); break;
+         case Op::And: Apply2(out, a, b, n, [](float x, float y) { return (x != 0 && y != 0) ? 1.0f : 0.0f; }); break;
+         case Op::Or: Apply2(out, a, b, n, [](float x, float y) { return (x != 0 || y != 0) ? 1.0f : 0.0f; }); break;
+         case Op::Xor: Apply2(out, a, b, n, [](float x, float y) { return ((x != 0) != (y != 0)) ? 1.0f : 0.0f; }); break;
+
+         case Op::Select: Apply3(out, a, b, c, n, [](float cond, float x, float y) { return cond != 0 ? x : y; }); break;
+         case Op::Clamp: Apply3(out, a, b, c, n, [](float lo, float x, float hi) { return x < lo ? lo : (x > hi ? hi : x); }); break;
+         case Op::InRange: Apply3(out, a, b, c, n, [](float lo, float x, float hi) { return (x >= lo && x <= hi) ? 1.0f : 0.0f; }); break;
+
+         case Op::Constant:
+         case Op::Variable:
+            break;
+      }
+   }
+
+   struct Node
+   {
+      Op mOp{ Op::Constant };
+      int mArgs[3]{};
+      float mValue{ 0 };
+   };
+
+   struct Function
+   {
+      const char* mName;
+      Op mOp;
+      int mNumArgs; //-1 for functions that take any number of arguments, folded together with mOp
+   };
+
+   const Function kFunctions[] = {
+      { "abs", Op::Abs, 1 },
+      { "sqrt", Op::Sqrt, 1 },
+      { "exp", Op::Exp, 1 },
+      { "expm1", Op::Expm1, 1 },
+      { "log", Op::Log, 1 },
+      { "log1p", Op::Log1p, 1 },
+      { "log2", Op::Log2, 1 },
+      { "log10", Op::Log10, 1 },
+      { "sin", Op::Sin, 1 },
+      { "cos", Op::Cos, 1 },
+      { "tan", Op::Tan, 1 },
+      { "asin", Op::Asin, 1 },
+      { "acos", Op::Acos, 1 },
+      { "atan", Op::Atan, 1 },
+      { "sinh", Op::Sinh, 1 },
+      { "cosh", Op::Cosh, 1 },
+      { "tanh", Op::Tanh, 1 },
+      { "floor", Op::Floor, 1 },
+      { "ceil", Op::Ceil, 1 },
+      { "round", Op::Round, 1 },
+      { "trunc", Op::Trunc, 1 },
+      { "frac", Op::Frac, 1 },
+      { "sgn", Op::Sgn, 1 },
+      { "deg2rad", Op::Deg2Rad, 1 },
+      { "rad2deg", Op::Rad2Deg, 1 },
+      { "not", Op::Not, 1 },
+      { "atan2", Op::Atan2, 2 },
+      { "hypot", Op::Hypot, 2 },
+      { "logn", Op::Logn, 2 },
+      { "root", Op::Root, 2 },
+      { "roundn", Op::Roundn, 2 },
+      { "pow", Op::Pow, 2 },
+      { "min", Op::Min, -1 },
+      { "max", Op::Max, -1 },
+      { "sum", Op::Add, -1 },
+      { "mul", Op::Multiply, -1 },
+      { "avg", Op::Add, -1 },
+      { "if", Op::Select, 3 },
+      { "clamp", Op::Clamp, 3 },
+      { "inrange", Op::InRange, 3 }
+   };
+
+   //recursive descent over exprtk's precedence levels, from loosest to tightest:
+   //ternary, or, and, comparison, additive, multiplicative, power, unary
+   class Parser
+   {
+   public:
+      Parser(const std::string& text, const std::vector<std::string>& variableNames)
+      : mText(text)
+      , mVariableNames(variableNames)
+      {
+      }
+
+      int Parse()
+      {
+         int root = ParseTernary();
+         SkipSpace();
+         while (mPos < mText.size() && mText[mPos] == ';') //allow a trailing statement terminator
+         {
+            ++mPos;
+            SkipSpace();
+         }
+         if (mPos != mText.size())
+            mFailed = true;
+         return mFailed ? -1 : root;
+      }
+
+      std::vector<Node> mNodes;
+
+   private:
+      int ParseTernary()
+      {
+         int condition = ParseOr();
+         if (Match("?"))
+         {
+            int whenTrue = ParseTernary();
+            if (!Match(":"))
+               return Fail();
+            int whenFalse = ParseTernary();
+            return MakeNode(Op::Select, condition, whenTrue, whenFalse);
+         }
+         return condition;
+      }
+
+      int ParseOr()
+      {
+         int left = ParseAnd();
+         while (!mFailed)
+         {
+            if (MatchWord("or") || Match("||") || Match("|"))
+               left = MakeNode(Op::Or, left, ParseAnd());
+            else if (MatchWord("xor"))
+               left = MakeNode(Op::Xor, left, ParseAnd());
+            else
+               break;
+         }
+         return left;
+      }
+
+      int ParseAnd()
+      {
+         int left = ParseComparison();
+         while (!mFailed && (MatchWord("and") || Match("&&") || Match("&")))
+            left = MakeNode(Op::And, left, ParseComparison());
+         return left;
+      }
+
+      int ParseComparison()
+      {
+         int left = ParseAdditive();
+         while (!mFailed)
+         {
+            Op op;
+            if (Match("<=")) op = Op::LessEqual;
+            else if (Match(">=")) op = Op::GreaterEqual;
+            else if (Match("==")) op = Op::Equal;
+            else if (Match("!=") || Match("<>")) op = Op::NotEqual;
+            else if (Match("<")) op = Op::Less;
+            else if (Match(">")) op = Op::Greater;
+            else if (PeekAssignment()) return Fail(); //":=" and friends are statements
+            else if (Match("=")) op = Op::Equal;
+            else break;
+            left = MakeNode(op, left, ParseAdditive());
+         }
+         return left;
+      }
+
+      int ParseAdditive()
+      {
+         int left = ParseMultiplicative();
+         while (!mFailed)
+         {
+            if (PeekAssignment())
+               return Fail();
+            if (Match("+"))
+               left = MakeNode(Op::Add, left, ParseMultiplicative());
+            else if (Match("-"))
+               left = MakeNode(Op::Subtract, left, ParseMultiplicative());
+            else
+               break;
+         }
+         return left;
+      }
+
+      int ParseMultiplicative()
+      {
+         int left = ParseUnary();
+         while (!mFailed)
+         {
+            if (PeekAssignment())
+               return Fail();
+            if (Match("*"))
+               left = MakeNode(Op::Multiply, left, ParseUnary());
+            else if (Match("/"))
+               left = MakeNode(Op::Divide, left, ParseUnary());
+            else if (Match("%"))
+               left = MakeNode(Op::Modulus, left, ParseUnary());
+            else
+               break;
+         }
+         return left;
+      }
+
+      int ParseUnary()
+      {
+         if (Match("-"))
+            return MakeNode(Op::Negate, ParseUnary());
+         if (Match("+"))
+            return ParseUnary();
+         if (Match("!"))
+            return MakeNode(Op::Not, ParseUnary());
+         return ParsePower();
+      }
+
+      int ParsePower()
+      {
+         int left = ParsePrimary();
+         while (!mFailed && Match("^"))
+            left = MakeNode(Op::Pow, left, ParsePrimaryWithSign());
+         return left;
+      }
+
+      int ParsePrimaryWithSign()
+      {
+         if (Match("-"))
+            return MakeNode(Op::Negate, ParsePrimaryWithSign());
+         if (Match("+"))
+            return ParsePrimaryWithSign();
+         return ParsePrimary();
+      }
+
+      int ParsePrimary()
+      {
+         SkipSpace();
+         if (mFailed || mPos >= mText.size())
+            return Fail();
+
+         char c = mText[mPos];
+         if (Match("("))
+         {
+            int inner = ParseTernary();
+            if (!Match(")"))
+               return Fail();
+            return ImplicitMultiply(inner);
+         }
+
+         if (isdigit((unsigned char)c) || (c == '.' && mPos + 1 < mText.size() && isdigit((unsigned char)mText[mPos + 1])))
+         {
+            const char* start = mText.c_str() + mPos;
+            char* end = nullptr;
+            float value = strtof(start, &end);
+            mPos += end - start;
+            return ImplicitMultiply(MakeConstant(value));
+         }
+
+         if (isalpha((unsigned char)c) || c == '_')
+         {
+            std::string name = ReadWord();
+
+            for (const Function& function : kFunctions)
+            {
+               if (name == function.mName)
+                  return ParseFunction(function);
+            }
+
+            if (name == "pi")
+               return MakeConstant(float(M_PI));
+            if (name == "epsilon")
+               return MakeConstant(std::numeric_limits<float>::epsilon());
+            if (name == "inf")
+               return MakeConstant(std::numeric_limits<float>::infinity());
+            if (name == "true")
+               return MakeConstant(1);
+            if (name == "false")
+               return MakeConstant(0);
+
+            for (int i = 0; i < (int)mVariableNames.size(); ++i)
+            {
+               if (name == mVariableNames[i])
+               {
+                  Node node;
+                  node.mOp = Op::Variable;
+                  node.mArgs[0] = i;
+                  mNodes.push_back(node);
+                  return (int)mNodes.size() - 1;
+               }
+            }
+         }
+
+         return Fail();
+      }
+
+      int ParseFunction(const Function& function)
+      {
+         if (!Match("("))
+            return Fail();
+
+         std::vector<int> args;
+         if (!Match(")"))
+         {
+            do
+            {
+               args.push_back(ParseTernary());
+            } while (!mFailed && Match(","));
+            if (!Match(")"))
+               return Fail();
+         }
+
+         if (function.mNumArgs == -1)
+         {
+            if (args.empty())
+               return Fail();
+            int result = args[0];
+            for (size_t i = 1; i < args.size(); ++i)
+               result = MakeNode(function.mOp, result, args[i]);
+            if (strcmp(function.mName, "avg") == 0 && args.size() > 1)
+               result = MakeNode(Op::Multiply, result, MakeConstant(1.0f / args.size()));
+            return ImplicitMultiply(result);
+         }
+
+         if ((int)args.size() != function.mNumArgs)
+            return Fail();
+         return ImplicitMultiply(MakeNode(function.mOp, args[0], args.size() > 1 ? args[1] : -1, args.size() > 2 ? args[2] : -1));
+      }
+
+      //exprtk reads "2x" and "2(x+1)" and "(x+1)(x-1)" as multiplications
+      int ImplicitMultiply(int left)
+      {
+         SkipSpace();
+         if (mFailed || mPos >= mText.size())
+            return left;
+         char c = mText[mPos];
+         if (c == '(' || isalpha((unsigned char)c) || c == '_')
+         {
+            size_t wordEnd = mPos;
+            while (wordEnd < mText.size() && (isalnum((unsigned char)mText[wordEnd]) || mText[wordEnd] == '_'))
+               ++wordEnd;
+            std::string word = ToLower(mText.substr(mPos, wordEnd - mPos));
+            if (word == "and" || word == "or" || word == "xor")
+               return left;
+            return MakeNode(Op::Multiply, left, ParsePower());
+         }
+         return left;
+      }
+
+      int MakeConstant(float value)
+      {
+         Node node;
+         node.mOp = Op::Constant;
+         node.mValue = value;
+         mNodes.push_back(node);
+         return (int)mNodes.size() - 1;
+      }
+
+      int MakeNode(Op op, int a, int b = -1, int c = -1)
+      {
+         if (mFailed)
+            return -1;
+
+         const int numArgs = GetNumArgs(op);
+         const int args[3] = { a, b, c };
+         bool allConstant = true;
+         float values[3] = { 0, 0, 0 };
+         for (int i = 0; i < numArgs; ++i)
+         {
+            if (args[i] < 0)
+               return Fail();
+            if (mNodes[args[i]].mOp == Op::Constant)
+               values[i] = mNodes[args[i]].mValue;
+            else
+               allConstant = false;
+         }
+
+         if (allConstant)
+         {
+            float folded;
+            Apply(op, &folded, &values[0], &values[1], &values[2], 1);
+            return MakeConstant(folded);
+         }
+
+         Node node;
+         node.mOp = op;
+         for (int i = 0; i < 3; ++i)
+            node.mArgs[i] = args[i];
+         mNodes.push_back(node);
+         return (int)mNodes.size() - 1;
+      }
+
+      int Fail()
+      {
+         mFailed = true;
+         return -1;
+      }
+
+      void SkipSpace()
+      {
+         while (mPos < mText.size() && isspace((unsigned char)mText[mPos]))
+            ++mPos;
+      }
+
+      bool Match(const char* token)
+      {
+         SkipSpace();
+         size_t length = strlen(token);
+         if (mText.compare(mPos, length, token) != 0)
+            return false;
+         mPos += length;
+         return true;
+      }
+
+      bool MatchWord(const char* word)
+      {
+         SkipSpace();
+         size_t length = strlen(word);
+         if (mPos + length > mText.size() || ToLower(mText.substr(mPos, length)) != word)
+            return false;
+         if (mPos + length < mText.size() && (isalnum((unsigned char)mText[mPos + length]) || mText[mPos + length] == '_'))
+            return false;
+         mPos += length;
+         return true;
+      }
+
+      bool PeekAssignment()
+      {
+         SkipSpace();
+         if (mPos + 1 >= mText.size() || mText[mPos + 1] != '=')
+            return false;
+         char c = mText[mPos];
+         return c == ':' || c == '+' || c == '-' || c == '*' || c == '/' || c == '%';
+      }
+
+      std::string ReadWord()
+      {
+         size_t start = mPos;
+         while (mPos < mText.size() && (isalnum((unsigned char)mText[mPos]) || mText[mPos] == '_'))
+            ++mPos;
+         return ToLower(mText.substr(start, mPos - start));
+      }
+
+      static std::string ToLower(std::string str)
+      {
+         std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return (char)tolower(c); });
+         return str;
+      }
+
+      const std::string& mText;
+      const std::vector<std::string>& mVariableNames;
+      size_t mPos{ 0 };
+      bool mFailed{ false };
+   };
+}
+
+int CompiledExpression::AddVariable(const std::string& name)
+{
+   std::string lower = name;
+   std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)tolower(c); });
+   mVariableNames.push_back(lower);
+   mBindings.push_back(Binding());
+   mUsesVariable.push_back(false);
+   return (int)mVariableNames.size() - 1;
+}
+
+bool CompiledExpression::Compile(const std::string& expression)
+{
+   mValid = false;
+   mProgram.clear();
+   std::fill(mUsesVariable.begin(), mUsesVariable.end(), false);
+
+   Parser parser(expression, mVariableNames);
+   int root = parser.Parse();
+   if (root < 0)
+      return false;
+
+   //emit the tree in postorder, with each node's result going in the register at its depth,
+   //so arguments always occupy the registers directly after their parent's
+   int numRegisters = 1;
+   struct Pending
+   {
+      int mNode;
+      int mRegister;
+      bool mArgsEmitted;
+   };
+   std::vector<Pending> stack;
+   stack.push_back({ root, 0, false });
+   while (!stack.empty())
+   {
+      Pending pending = stack.back();
+      stack.pop_back();
+      const Node& node = parser.mNodes[pending.mNode];
+      const int numArgs = GetNumArgs(node.mOp);
+
+      if (!pending.mArgsEmitted && numArgs > 0)
+      {
+         stack.push_back({ pending.mNode, pending.mRegister, true });
+         for (int i = numArgs - 1; i >= 0; --i)
+            stack.push_back({ node.mArgs[i], pending.mRegister + i, false });
+         numRegisters = std::max(numRegisters, pending.mRegister + numArgs);
+         continue;
+      }
+
+      Instruction instruction;
+      instruction.mOp = node.mOp;
+      instruction.mDest = pending.mRegister;
+      if (node.mOp == Op::Constant)
+      {
+         instruction.mValue = node.mValue;
+      }
+      else if (node.mOp == Op::Variable)
+      {
+         instruction.mArgs[0] = node.mArgs[0];
+         mUsesVariable[node.mArgs[0]] = true;
+      }
+      else
+      {
+         for (int i = 0; i < numArgs; ++i)
+            instruction.mArgs[i] = pending.mRegister + i;
+      }
+      mProgram.push_back(instruction);
+   }
+
+   mRegisterStorage.assign(numRegisters * kChunkSize, 0);
+   mRegisters.resize(numRegisters);
+   for (int i = 0; i < numRegisters; ++i)
+   {
+      mRegisters[i].mStorage = mRegisterStorage.data() + i * kChunkSize;
+      mRegisters[i].mData = mRegisters[i].mStorage;
+   }
+
+   mValid = true;
+   return true;
+}
+
+void CompiledExpression::SetValue(int variable, float value)
+{
+   mBindings[variable].mValues = nullptr;
+   mBindings[variable].mValue = value;
+}
+
+void CompiledExpression::SetValues(int variable, const float* values)
+{
+   mBindings[variable].mValues = values;
+}
+
+float CompiledExpression::Evaluate()
+{
+   float out;
+   EvaluateBlock(&out, 1);
+   return out;
+}
+
+void CompiledExpression::EvaluateBlock(float* out, int numSamples)
+{
+   if (!mValid)
+   {
+      std::fill(out, out + numSamples, 0.0f);
+      return;
+   }
+
+   bool allUniform = true;
+   for (size_t i = 0; i < mBindings.size(); ++i)
+   {
+      if (mUsesVariable[i] && mBindings[i].mValues != nullptr)
+         allUniform = false;
+   }
+
+   if (allUniform)
+   {
+      RunChunk(0, 1);
+      std::fill(out, out + numSamples, mRegisters[0].mData[0]);
+      return;
+   }
+
+   for (int offset = 0; offset < numSamples; offset += kChunkSize)
+   {
+      int chunkSize = std::min(kChunkSize, numSamples - offset);
+      RunChunk(offset, chunkSize);
+      const Register& result = mRegisters[0];
+      if (result.mUniform)
+         std::fill(out + offset, out + offset + chunkSize, result.mData[0]);
+      else
+         memcpy(out + offset, result.mData, chunkSize * sizeof(float));
+   }
+}
+
+void CompiledExpression::RunChunk(int offset, int numSamples)
+{
+   for (const Instruction& instruction : mProgram)
+   {
+      Register& dest = mRegisters[instruction.mDest];
+
+      if (instruction.mOp == Op::Constant)
+      {
+         dest.mStorage[0] = instruction.mValue;
+         dest.mData = dest.mStorage;
+         dest.mUniform = true;
+         continue;
+      }
+
+      if (instruction.mOp == Op::Variable)
+      {
+         const Binding& binding = mBindings[instruction.mArgs[0]];
+         if (binding.mValues != nullptr)
+         {
+            dest.mData = binding.mValues + offset;
+            dest.mUniform = false;
+         }
+         else
+         {
+            dest.mStorage[0] = binding.mValue;
+            dest.mData = dest.mStorage;
+            dest.mUniform = true;
+         }
+         continue;
+      }
+
+      const int numArgs = GetNumArgs(instruction.mOp);
+      bool uniform = true;
+      for (int i = 0; i < numArgs; ++i)
+         uniform = uniform && mRegisters[instruction.mArgs[i]].mUniform;
+
+      //an operation on single values only has to happen once, otherwise spread the single values out to meet the arrays
+      if (!uniform)
+      {
+         for (int i = 0; i < numArgs; ++i)
+         {
+            Register& arg = mRegisters[instruction.mArgs[i]];
+            if (arg.mUniform)
+            {
+               std::fill(arg.mStorage + 1, arg.mStorage + numSamples, arg.mStorage[0]);
+               arg.mUniform = false;
+            }
+         }
+      }
+
+      const float* a = mRegisters[instruction.mArgs[0]].mData;
+      const float* b = numArgs > 1 ? mRegisters[instruction.mArgs[1]].mData : nullptr;
+      const float* c = numArgs > 2 ? mRegisters[instruction.mArgs[2]].mData : nullptr;
+      Apply(instruction.mOp, dest.mStorage, a, b, c, uniform ? 1 : numSamples);
+      dest.mData = dest.mStorage;
+      dest.mUniform = uniform;
+   }
+}
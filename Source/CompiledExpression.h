@@ -0,0 +1,89 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    CompiledExpression.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//compiles the arithmetic subset of exprtk's syntax into a flat program that runs over whole blocks of samples at a time.
+//every variable is bound for the block to either a single value or an array of per-sample values. subexpressions of constants
+//are folded away when compiling, and ones that only depend on single-valued variables are only run once rather than per sample.
+//anything outside of the subset (statements, assignments, strings, loops) fails to compile, so callers can fall back to exprtk.
+class CompiledExpression
+{
+public:
+   //variables have to be added before compiling. names are case insensitive, like they are in exprtk
+   int AddVariable(const std::string& name);
+   bool Compile(const std::string& expression);
+   bool IsValid() const { return mValid; }
+   bool UsesVariable(int variable) const { return mValid && mUsesVariable[variable]; }
+
+   //bindings are kept until they're changed. arrays need to be at least as long as the blocks that are evaluated
+   void SetValue(int variable, float value);
+   void SetValues(int variable, const float* values);
+
+   //for array-bound variables, this uses the first sample
+   float Evaluate();
+   void EvaluateBlock(float* out, int numSamples);
+
+   enum class Op : int;
+
+private:
+   struct Instruction
+   {
+      Op mOp;
+      int mDest{ 0 };
+      int mArgs[3]{};
+      float mValue{ 0 };
+   };
+
+   struct Binding
+   {
+      const float* mValues{ nullptr };
+      float mValue{ 0 };
+   };
+
+   struct Register
+   {
+      float* mStorage{ nullptr };
+      const float* mData{ nullptr };
+      bool mUniform{ true };
+   };
+
+   void RunChunk(int offset, int numSamples);
+
+   std::vector<std::string> mVariableNames;
+   std::vector<Binding> mBindings;
+   std::vector<bool> mUsesVariable;
+   std::vector<Instruction> mProgram;
+   std::vector<float> mRegisterStorage;
+   std::vector<Register> mRegisters;
+   bool mValid{ false };
+
+   static constexpr int kChunkSize = 64;
+};
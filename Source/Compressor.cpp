@@ -28,27 +28,19 @@
 #include "SynthGlobals.h"
 #include "Profiler.h"
 #include "UIControlMacros.h"
+#include "ModularSynth.h"
 
 namespace
 {
-   static double lin2dB(double lin)
-   {
-      static const double LOG_2_DB = 8.6858896380650365530225783783321; // 20 / ln( 10 )
-      return log(lin) * LOG_2_DB;
-   }
-
-   static double dB2lin(double dB)
-   {
-      static const double DB_2_LOG = 0.11512925464970228420089957273422; // ln( 10 ) / 20
-      return exp(dB * DB_2_LOG);
-   }
-
    const float kMaxLookaheadMs = 50;
+   const float kRmsWindowMs = 5;
 }
 
 Compressor::Compressor()
-: mDelayBuffer(kMaxLookaheadMs * gSampleRateMs)
+: mLookaheadDelay(kMaxLookaheadMs * gSampleRateMs + 1)
+, mGain(gBufferSize)
 {
+   mDetector.SetRmsWindow(kRmsWindowMs);
 }
 
 void Compressor::CreateUIControls()
@@ -59,6 +51,8 @@ void Compressor::CreateUIControls()
    FLOATSLIDER(mDriveSlider, "drive", &mDrive, .01f, 2);
    FLOATSLIDER(mThresholdSlider, "threshold", &mThreshold, -70, 0);
    FLOATSLIDER(mRatioSlider, "ratio", &mRatio, 1, 40);
+   CHECKBOX(mRmsCheckbox, "rms", &mRms);
+   TEXTENTRY(mSidechainEntry, "sidechain", 7, &mSidechainName);
    UIBLOCK_NEWCOLUMN();
    FLOATSLIDER(mAttackSlider, "attack", &mAttack, .1f, kMaxLookaheadMs);
    FLOATSLIDER(mReleaseSlider, "release", &mRelease, .1f, 500);
@@ -72,8 +66,8 @@ void Compressor::CreateUIControls()
    mLookaheadSlider->SetMode(FloatSlider::kSquare);
    mOutputAdjustSlider->SetMode(FloatSlider::kSquare);
 
-   mEnv.setAttack(mAttack);
-   mEnv.setRelease(mRelease);
+   mOverThresholdEnvelope.SetAttack(mAttack);
+   mOverThresholdEnvelope.SetRelease(mRelease);
 }
 
 void Compressor::ProcessAudio(double time, ChannelBuffer* buffer)
@@ -83,60 +77,64 @@ void Compressor::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   int bufferSize = buffer->BufferSize();
-   mDelayBuffer.SetNumChannels(buffer->NumActiveChannels());
-
-   for (int i = 0; i < bufferSize; ++i)
-   {
-      ComputeSliders(i);
-
-      // create sidechain
-
-      float input = 0;
-      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-         input = MAX(input, fabsf(buffer->GetChannel(ch)[i]));
-      input *= mDrive;
-
-      /* if desired, one could use another EnvelopeDetector to smooth
-       * the rectified signal.
-       */
+   ComputeSliders(0);
 
-      // convert key to dB
-      input += DC_OFFSET; // add DC offset to avoid log( 0 )
-      mCurrentInputDb = lin2dB(input); // convert linear -> dB
-
-      // threshold
-      double overdB = mCurrentInputDb - mThreshold; // delta over threshold
-      if (overdB < 0.0)
-         overdB = 0.0;
-
-      // attack/release
-
-      overdB += DC_OFFSET; // add DC offset to avoid denormal
-      mEnv.run(overdB, envdB_); // run attack/release envelope
-      overdB = envdB_ - DC_OFFSET; // subtract DC offset
-
-      /* REGARDING THE DC OFFSET: In this case, since the offset is added before
-       * the attack/release processes, the envelope will never fall below the offset,
-       * thereby avoiding denormals. However, to prevent the offset from causing
-       * constant gain reduction, we must subtract it from the envelope, yielding
-       * a minimum value of 0dB.
-       */
-
-      double invRatio = 1 / mRatio;
+   int bufferSize = buffer->BufferSize();
+   int numChannels = MIN(buffer->NumActiveChannels(), LookaheadDelay::kMaxChannels);
+   if ((int)mGain.size() < bufferSize)
+      mGain.resize(bufferSize);
+   float* gain = mGain.data();
 
-      // transfer function
-      double reduction = overdB * (invRatio - 1.0); // gain reduction (dB)
-      double makeup = (-mThreshold * .5) * (1.0 - invRatio);
-      mOutputGain = ofLerp(1, dB2lin(reduction + makeup) * mDrive * mOutputAdjust, mMix);
+   float* channels[LookaheadDelay::kMaxChannels];
+   for (int ch = 0; ch < numChannels; ++ch)
+      channels[ch] = buffer->GetChannel(ch);
 
-      // output gain
-      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+   // sidechain level in dB, and how far it's over the threshold. a sidechain bus channel is read where its producer left it
+   if (mSidechainChannel == nullptr)
+   {
+      mDetector.Process(channels, numChannels, bufferSize, gain);
+   }
+   else
+   {
+      SidechainBus::View sidechain = SidechainBus::Read(mSidechainChannel, time);
+      if (sidechain.mBuffer != nullptr && sidechain.mBuffer->BufferSize() >= bufferSize)
+      {
+         const float* sidechainChannels[ChannelBuffer::kMaxNumChannels];
+         int numSidechainChannels = MIN(sidechain.mBuffer->NumActiveChannels(), ChannelBuffer::kMaxNumChannels);
+         for (int ch = 0; ch < numSidechainChannels; ++ch)
+            sidechainChannels[ch] = sidechain.mBuffer->GetChannelReadOnly(ch);
+         mDetector.Process(sidechainChannels, numSidechainChannels, bufferSize, gain);
+      }
+      else
       {
-         mDelayBuffer.Write(buffer->GetChannel(ch)[i], ch);
-         buffer->GetChannel(ch)[i] = mDelayBuffer.GetSample(ofClamp(int(mLookahead * gSampleRateMs) + 1, 1, mDelayBuffer.Size() - 1), ch) * mOutputGain; // apply gain reduction to input
+         Clear(gain, bufferSize);
       }
    }
+   const float drive = mDrive;
+   const float threshold = mThreshold;
+   for (int i = 0; i < bufferSize; ++i)
+      gain[i] = MAX(0, FastGainToDb(gain[i] * drive + 1e-25f) - threshold); // offset avoids log(0)
+   mCurrentInputDb = threshold + (bufferSize > 0 ? gain[bufferSize - 1] : 0);
+
+   // attack/release, in dB
+   mOverThresholdEnvelope.Process(gain, gain, bufferSize);
+
+   // transfer function
+   const float invRatio = 1 / mRatio;
+   const float reductionPerDb = invRatio - 1;
+   const float makeup = (-threshold * .5f) * (1 - invRatio);
+   const float outputScale = drive * mOutputAdjust;
+   const float mix = mMix;
+   for (int i = 0; i < bufferSize; ++i)
+      gain[i] = ofLerp(1.0f, FastDbToGain(gain[i] * reductionPerDb + makeup) * outputScale, mix);
+   if (bufferSize > 0)
+      mOutputGain = gain[bufferSize - 1];
+
+   // apply to the delayed input, so the gain reduction starts ahead of what triggered it
+   mLookaheadDelay.SetDelay(int(mLookahead * gSampleRateMs));
+   mLookaheadDelay.Process(channels, numChannels, bufferSize);
+   for (int ch = 0; ch < numChannels; ++ch)
+      Mult(channels[ch], gain, bufferSize);
 }
 
 void Compressor::DrawModule()
@@ -145,6 +143,8 @@ void Compressor::DrawModule()
    mDriveSlider->Draw();
    mThresholdSlider->Draw();
    mRatioSlider->Draw();
+   mRmsCheckbox->Draw();
+   mSidechainEntry->Draw();
    mAttackSlider->Draw();
    mReleaseSlider->Draw();
    mLookaheadSlider->Draw();
@@ -171,58 +171,28 @@ void Compressor::DrawModule()
 void Compressor::CheckboxUpdated(Checkbox* checkbox, double time)
 {
    if (checkbox == mEnabledCheckbox)
-      envdB_ = DC_OFFSET; //reset state
-}
-
-void Compressor::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
-{
-   if (slider == mAttackSlider)
-      mEnv.setAttack(MAX(.1f, mAttack));
-   if (slider == mReleaseSlider)
-      mEnv.setRelease(MAX(.1f, mRelease));
-}
-
-//-------------------------------------------------------------
-// envelope detector
-//-------------------------------------------------------------
-EnvelopeDetector::EnvelopeDetector(double ms)
-{
-   assert(ms > 0.0);
-   ms_ = ms;
-   setCoef();
-}
-
-//-------------------------------------------------------------
-void EnvelopeDetector::setTc(double ms)
-{
-   assert(ms > 0.0);
-   ms_ = ms;
-   setCoef();
-}
-
-//-------------------------------------------------------------
-void EnvelopeDetector::setCoef()
-{
-   coef_ = exp(-1000.0 / (ms_ * gSampleRate));
-}
-
-//-------------------------------------------------------------
-// attack/release envelope
-//-------------------------------------------------------------
-AttRelEnvelope::AttRelEnvelope(double att_ms, double rel_ms)
-: att_(att_ms)
-, rel_(rel_ms)
-{
+   {
+      mOverThresholdEnvelope.Reset();
+      mDetector.Reset();
+      mLookaheadDelay.Reset();
+   }
+   if (checkbox == mRmsCheckbox)
+      mDetector.SetMode(mRms ? LevelDetector::Mode::Rms : LevelDetector::Mode::Peak);
 }
 
-//-------------------------------------------------------------
-void AttRelEnvelope::setAttack(double ms)
+void Compressor::TextEntryComplete(TextEntry* entry)
 {
-   att_.setTc(ms);
+   if (entry == mSidechainEntry)
+   {
+      mSidechainChannel = SidechainBus::Get().Subscribe(this, mSidechainName);
+      TheSynth->ArrangeAudioSourceDependencies();
+   }
 }
 
-//-------------------------------------------------------------
-void AttRelEnvelope::setRelease(double ms)
+void Compressor::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
 {
-   rel_.setTc(ms);
+   if (slider == mAttackSlider)
+      mOverThresholdEnvelope.SetAttack(MAX(.1f, mAttack));
+   if (slider == mReleaseSlider)
+      mOverThresholdEnvelope.SetRelease(MAX(.1f, mRelease));
 }
@@ -28,83 +28,11 @@
 #include "IAudioEffect.h"
 #include "Slider.h"
 #include "Checkbox.h"
-#include "RollingBuffer.h"
+#include "DynamicsCore.h"
+#include "TextEntry.h"
+#include "SidechainBus.h"
 
-//-------------------------------------------------------------
-// DC offset (to prevent denormal)
-//-------------------------------------------------------------
-
-// USE:
-// 1. init envelope state to DC_OFFSET before processing
-// 2. add to input before envelope runtime function
-static const double DC_OFFSET = 1.0E-25;
-
-//-------------------------------------------------------------
-// envelope detector
-//-------------------------------------------------------------
-class EnvelopeDetector
-{
-public:
-   EnvelopeDetector(double ms = 1.0);
-   virtual ~EnvelopeDetector() {}
-
-   // time constant
-   virtual void setTc(double ms);
-   virtual double getTc(void) const { return ms_; }
-
-   // runtime function
-   void run(double in, double& state)
-   {
-      state = in + coef_ * (state - in);
-   }
-
-protected:
-   double ms_{ 1 }; // time constant in ms
-   double coef_{ 0 }; // runtime coefficient
-   virtual void setCoef(void); // coef calculation
-
-}; // end SimpleComp class
-
-//-------------------------------------------------------------
-// attack/release envelope
-//-------------------------------------------------------------
-class AttRelEnvelope
-{
-public:
-   AttRelEnvelope(double att_ms = 10.0, double rel_ms = 100.0);
-   virtual ~AttRelEnvelope() {}
-
-   // attack time constant
-   virtual void setAttack(double ms);
-   virtual double getAttack(void) const { return att_.getTc(); }
-
-   // release time constant
-   virtual void setRelease(double ms);
-   virtual double getRelease(void) const { return rel_.getTc(); }
-
-   // runtime function
-   void run(double in, double& state)
-   {
-
-      /* assumes that:
-          * positive delta = attack
-          * negative delta = release
-          * good for linear & log values
-          */
-
-      if (in > state)
-         att_.run(in, state); // attack
-      else
-         rel_.run(in, state); // release
-   }
-
-private:
-   EnvelopeDetector att_;
-   EnvelopeDetector rel_;
-
-}; // end AttRelEnvelope class
-
-class Compressor : public IAudioEffect, public IFloatSliderListener
+class Compressor : public IAudioEffect, public IFloatSliderListener, public ITextEntryListener
 {
 public:
    Compressor();
@@ -121,6 +49,7 @@ public:
 
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
+   void TextEntryComplete(TextEntry* entry) override;
 
    bool IsEnabled() const override { return mEnabled; }
 
@@ -145,13 +74,17 @@ private:
    FloatSlider* mLookaheadSlider{ nullptr };
    FloatSlider* mOutputAdjustSlider{ nullptr };
 
-   double mCurrentInputDb{ 0 };
-   double mOutputGain{ 1 };
-
-   // runtime variables
-   double envdB_{ DC_OFFSET }; // over-threshold envelope (dB)
+   bool mRms{ false };
+   Checkbox* mRmsCheckbox{ nullptr };
+   std::string mSidechainName; //detect the level of a sidechain bus channel rather than of our own input
+   TextEntry* mSidechainEntry{ nullptr };
+   SidechainBus::Channel* mSidechainChannel{ nullptr };
 
-   AttRelEnvelope mEnv;
+   float mCurrentInputDb{ 0 };
+   float mOutputGain{ 1 };
 
-   RollingBuffer mDelayBuffer;
+   LevelDetector mDetector;
+   EnvelopeFollower mOverThresholdEnvelope; //dB over the threshold
+   LookaheadDelay mLookaheadDelay;
+   std::vector<float> mGain;
 };
@@ -0,0 +1,63 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ComputeOffload.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//somewhere other than the audio thread's cpu to run the heaviest dsp kernels on, like the compute shaders of the wasm build
+//(see wasm/include/BespokeWasm/GPUCompute.h). work queued during an audio callback goes out as one batch at the end of it, and
+//its results can be collected GetLatencyCallbacks() callbacks later. nothing ever waits on a result: whoever finds theirs
+//missing does the work on the cpu instead, so there's no offload at all in builds that never call Set().
+//everything here is called from the audio thread, apart from Set() and creating and destroying spectral banks
+class ComputeOffload
+{
+public:
+   static ComputeOffload* Get() { return sInstance; }
+   static void Set(ComputeOffload* offload) { sInstance = offload; }
+
+   virtual ~ComputeOffload() = default;
+
+   virtual int GetLatencyCallbacks() const = 0;
+
+   //partitioned convolution's spectral multiply-accumulate (see ConvolutionEngine). spectra is numPartitions spectra of numBins
+   //real parts then numBins imaginary parts each, and stays on the device along with a history of historyLength input spectra.
+   //returns -1 if there's no room for it
+   virtual int CreateSpectralBank(const float* spectra, int numPartitions, int numBins, int historyLength) = 0;
+   virtual void ClearSpectralBank(int bank) = 0;
+   virtual void DestroySpectralBank(int bank) = 0;
+   //writes spectrum into history[historyPos], then queues out = sum over i of history[(historyPos + i + firstPartition) % historyLength] * spectra[i].
+   //returns a ticket for the result, numBins * 2 floats, or -1 if this callback's batch is full
+   virtual int QueueSpectralMultiply(int bank, const float* spectrum, int historyPos, int firstPartition) = 0;
+
+   //a bank of sine partials (see AdditiveBank). queues out[n] = sum over i of (amp[i] + (n + 1) * ampInc[i]) * sin(phase[i] + (n + 1) * phaseInc[i]),
+   //for n in [0, numSamples). returns a ticket for the result, or -1 if this callback's batch is full
+   virtual int QueueAdditive(const float* phase, const float* phaseInc, const float* amp, const float* ampInc, int numPartials, int numSamples) = 0;
+
+   //copies a ticket's result into out, false if it isn't back yet or was dropped
+   virtual bool Collect(int ticket, float* out, int size) = 0;
+
+private:
+   static ComputeOffload* sInstance;
+};
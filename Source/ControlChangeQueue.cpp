@@ -0,0 +1,69 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ControlChangeQueue.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#include "ControlChangeQueue.h"
+#include "IDrawableModule.h"
+#include "Slider.h"
+#include "SynthGlobals.h"
+
+#include "juce_core/juce_core.h"
+
+namespace
+{
+   const double kAudioStalledMs = 250;
+}
+
+bool ControlChangeQueue::QueueSliderValue(FloatSlider* slider, float* target, float value)
+{
+   if (IsAudioThread() || juce::Time::getMillisecondCounterHiRes() - mLastProcessTime > kAudioStalledMs)
+      return false;
+
+   return mQueue.enqueue({ slider, target, value });
+}
+
+void ControlChangeQueue::Process(double time)
+{
+   assert(IsAudioThread());
+
+   mLastProcessTime = juce::Time::getMillisecondCounterHiRes();
+
+   PendingSliderValue change;
+   while (mQueue.try_dequeue(change))
+   {
+      if (change.mSlider->GetModuleParent() != nullptr && change.mSlider->GetModuleParent()->IsDeleted())
+         continue;
+      change.mSlider->ApplyQueuedValue(change.mTarget, change.mValue, time);
+   }
+}
+
+void ControlChangeQueue::Clear()
+{
+   PendingSliderValue change;
+   while (mQueue.try_dequeue(change))
+   {
+   }
+}
@@ -0,0 +1,57 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ControlChangeQueue.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+#include "readerwriterqueue.h"
+
+#include <atomic>
+
+class FloatSlider;
+
+//slider changes made from the ui thread, applied on the audio thread at the start of the next buffer.
+//this way the audio thread never sees a value change partway through processing a buffer, and the ui never needs a lock to set one.
+//any smoothing the slider has set up still ramps to the new value
+class ControlChangeQueue
+{
+public:
+   //returns false if nothing is draining the queue (audio isn't running), in which case the caller should apply the change itself
+   bool QueueSliderValue(FloatSlider* slider, float* target, float value);
+   void Process(double time);
+   void Clear(); //drops what's queued without applying it, before the sliders it points at are freed. hold the audio mutex, so nothing else is dequeuing
+
+private:
+   struct PendingSliderValue
+   {
+      FloatSlider* mSlider{ nullptr };
+      float* mTarget{ nullptr };
+      float mValue{ 0 };
+   };
+
+   moodycamel::ReaderWriterQueue<PendingSliderValue> mQueue{ 256 };
+   std::atomic<double> mLastProcessTime{ -1 };
+};
@@ -154,6 +154,8 @@ void ControlRecorder::Clear()
    mSpeed = 1;
    mCurve.Clear();
    mHasRecorded = false;
+   mHasRecordAnchor = false;
+   mHasProvisionalPoint = false;
 }
 
 void ControlRecorder::RecordPoint()
@@ -162,13 +164,62 @@ void ControlRecorder::RecordPoint()
    if (target)
    {
       float time = TheTransport->GetMeasureTime(gTime) - mRecordStartOffset;
-      mCurve.AddPointAtEnd(CurvePoint(time, target->GetMidiValue()));
+      AddRecordedPoint(CurvePoint(time, target->GetMidiValue()));
       mCurve.SetExtents(0, time);
       mHasRecorded = true;
       mLength = time;
    }
 }
 
+void ControlRecorder::AddRecordedPoint(CurvePoint point)
+{
+   const float kTolerance = .002f; //well under one midi cc step
+
+   if (!mHasRecordAnchor)
+   {
+      mCurve.AddPointAtEnd(point);
+      mRecordAnchor = point;
+      mHasRecordAnchor = true;
+      mHasProvisionalPoint = false;
+      return;
+   }
+
+   float dt = point.mTime - mRecordAnchor.mTime;
+   if (dt <= 0)
+   {
+      if (mHasProvisionalPoint)
+         mCurve.ReplaceLastPoint(point);
+      return;
+   }
+
+   float slope = (point.mValue - mRecordAnchor.mValue) / dt;
+   if (mHasProvisionalPoint && slope >= mRecordSlopeMin && slope <= mRecordSlopeMax)
+   {
+      //the line to this point passes close enough to everything since the anchor, so the previous point isn't needed
+      mCurve.ReplaceLastPoint(point);
+      mRecordSlopeMin = MAX(mRecordSlopeMin, (point.mValue - kTolerance - mRecordAnchor.mValue) / dt);
+      mRecordSlopeMax = MIN(mRecordSlopeMax, (point.mValue + kTolerance - mRecordAnchor.mValue) / dt);
+      return;
+   }
+
+   if (mHasProvisionalPoint)
+   {
+      //keep the previous point as a breakpoint, and measure from there
+      mRecordAnchor = *mCurve.GetPoint(mCurve.GetNumPoints() - 1);
+      dt = point.mTime - mRecordAnchor.mTime;
+      if (dt <= 0)
+      {
+         mHasProvisionalPoint = false;
+         return;
+      }
+   }
+
+   mCurve.AddPointAtEnd(point);
+   mRecordSlopeMin = (point.mValue - kTolerance - mRecordAnchor.mValue) / dt;
+   mRecordSlopeMax = (point.mValue + kTolerance - mRecordAnchor.mValue) / dt;
+   mHasProvisionalPoint = true;
+}
+
 void ControlRecorder::SetRecording(bool record)
 {
    mRecord = record;
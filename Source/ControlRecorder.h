@@ -86,6 +86,7 @@ public:
 private:
    float GetPlaybackTime(double time);
    void RecordPoint();
+   void AddRecordedPoint(CurvePoint point);
    void Clear();
 
    //IDrawableModule
@@ -106,4 +107,12 @@ private:
    Checkbox* mRecordCheckbox{ nullptr };
    bool mRecord{ false };
    IUIControl* mConnectedControl{ nullptr };
+
+   //while recording, only breakpoints are kept: the last point is provisional, and gets replaced by the next one
+   //as long as a straight line from the anchor stays within tolerance of every point that's been dropped along the way
+   CurvePoint mRecordAnchor;
+   bool mHasRecordAnchor{ false };
+   bool mHasProvisionalPoint{ false };
+   float mRecordSlopeMin{ 0 };
+   float mRecordSlopeMax{ 0 };
 };
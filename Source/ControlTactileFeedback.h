@@ -44,6 +44,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //drives a controller directly
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
 
@@ -178,12 +178,12 @@ void ControllingSong::Process(double time)
          TheTransport->SetMeasureTime(measure + measurePos);
       }
 
-      gWorkChannelBuffer.SetNumActiveChannels(1);
-      if (mSample.ConsumeData(time, &gWorkChannelBuffer, bufferSize, true))
+      gWorkChannelBuffer->SetNumActiveChannels(1);
+      if (mSample.ConsumeData(time, gWorkChannelBuffer, bufferSize, true))
       {
          for (int i = 0; i < bufferSize; ++i)
          {
-            float sample = gWorkChannelBuffer.GetChannel(0)[i] * volSq;
+            float sample = gWorkChannelBuffer->GetChannel(0)[i] * volSq;
             if (mMute)
                sample = 0;
             out[i] += sample;
@@ -0,0 +1,373 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ConvolutionEffect.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ConvolutionEffect.h"
+#include "OpenFrameworksPort.h"
+#include "SynthGlobals.h"
+#include "ModularSynth.h"
+#include "Profiler.h"
+#include "Resampler.h"
+#include "FileStream.h"
+
+#include "juce_gui_basics/juce_gui_basics.h"
+#include "juce_audio_formats/juce_audio_formats.h"
+
+namespace
+{
+   const float kMaxImpulseSeconds = 20;
+   const int kMinBlockSize = 32;
+   const int kMaxBlockSize = 1024;
+   const int kResamplePadding = 128; //zeros around the file, so the resampler's kernel doesn't wrap the tail into the head
+
+   juce::ThreadPool& GetLoadPool()
+   {
+      static juce::ThreadPool* sPool = new juce::ThreadPool(1); //never destroyed, effects can outlive static destruction
+      return *sPool;
+   }
+
+   int ChooseBlockSize()
+   {
+      //the largest power of two that buffers divide into, so whole buffers go through the engine without added latency
+      int blockSize = 1;
+      while (gBufferSize % (blockSize * 2) == 0 && blockSize * 2 <= kMaxBlockSize)
+         blockSize *= 2;
+      if (blockSize < kMinBlockSize)
+         blockSize = 128; //odd buffer sizes pay a block of latency instead
+      return blockSize;
+   }
+}
+
+class ImpulseResponseLoadJob : public juce::ThreadPoolJob
+{
+public:
+   ImpulseResponseLoadJob(ConvolutionEffect* owner, std::string path)
+   : juce::ThreadPoolJob("impulse response load")
+   , mOwner(owner)
+   , mPath(path)
+   {
+   }
+
+   JobStatus runJob() override
+   {
+      ConvolutionEffect::Kernel* kernel = Load();
+      if (shouldExit())
+         delete kernel;
+      else
+         mOwner->OnLoadFinished(kernel);
+      return jobHasFinished;
+   }
+
+private:
+   ConvolutionEffect::Kernel* Load()
+   {
+      std::unique_ptr<juce::AudioFormatReader> reader(TheSynth->GetAudioFormatManager().createReaderFor(juce::File(ofToSamplePath(mPath))));
+      if (reader == nullptr || reader->numChannels == 0 || reader->lengthInSamples == 0)
+         return nullptr;
+
+      int numChannels = MIN((int)reader->numChannels, ChannelBuffer::kMaxNumChannels);
+      int fileLength = (int)MIN(reader->lengthInSamples, (juce::int64)(kMaxImpulseSeconds * reader->sampleRate));
+      juce::AudioSampleBuffer fileBuffer((int)reader->numChannels, fileLength + kResamplePadding * 2);
+      fileBuffer.clear();
+      reader->read(&fileBuffer, kResamplePadding, fileLength, 0, true, true);
+      if (shouldExit())
+         return nullptr;
+
+      double rate = reader->sampleRate / gSampleRate;
+      int length = MAX(1, int(fileLength / rate));
+      std::vector<float> impulses[ChannelBuffer::kMaxNumChannels];
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         impulses[ch].resize(length);
+         Resample(fileBuffer.getReadPointer(ch), fileBuffer.getNumSamples(), kResamplePadding, rate, impulses[ch].data(), length, ResampleQuality::Sinc);
+      }
+
+      //trim the tail once it's 80db down, it would only cost cpu
+      float peak = 0;
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         for (float sample : impulses[ch])
+            peak = MAX(peak, fabsf(sample));
+      }
+      if (peak <= 0)
+         return nullptr;
+      int trimmedLength = 1;
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         for (int i = length - 1; i >= trimmedLength; --i)
+         {
+            if (fabsf(impulses[ch][i]) > peak * .0001f)
+            {
+               trimmedLength = i + 1;
+               break;
+            }
+         }
+      }
+      length = trimmedLength;
+
+      //normalize to unit energy, so the wet signal sits around the level of the input whatever the file's level
+      double energy = 0;
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         double channelEnergy = 0;
+         for (int i = 0; i < length; ++i)
+            channelEnergy += impulses[ch][i] * impulses[ch][i];
+         energy = MAX(energy, channelEnergy);
+      }
+      float normalize = float(1 / sqrt(energy));
+
+      auto kernel = std::make_unique<ConvolutionEffect::Kernel>();
+      kernel->mLength = length;
+      std::shared_ptr<const ConvolutionEngine::Response> responses[ChannelBuffer::kMaxNumChannels];
+      int blockSize = ChooseBlockSize();
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         Mult(impulses[ch].data(), normalize, length);
+         responses[ch] = ConvolutionEngine::PrepareResponse(impulses[ch].data(), length, blockSize);
+         if (shouldExit())
+            return nullptr;
+      }
+      //a mono response is shared by both channels
+      for (int ch = 0; ch < ChannelBuffer::kMaxNumChannels; ++ch)
+         kernel->mEngines[ch] = std::make_unique<ConvolutionEngine>(responses[MIN(ch, numChannels - 1)]);
+
+      return kernel.release();
+   }
+
+   ConvolutionEffect* mOwner;
+   std::string mPath;
+};
+
+ConvolutionEffect::ConvolutionEffect()
+{
+   mWetBuffer.resize(gBufferSize);
+   mFadeBuffer.resize(gBufferSize);
+}
+
+ConvolutionEffect::~ConvolutionEffect()
+{
+   CancelLoad();
+   delete mKernel;
+   delete mPendingKernel.exchange(nullptr);
+   delete mRetiredKernel.exchange(nullptr);
+}
+
+void ConvolutionEffect::CreateUIControls()
+{
+   IDrawableModule::CreateUIControls();
+   mDrySlider = new FloatSlider(this, "dry", 5, 4, 110, 15, &mDry, 0, 1);
+   mWetSlider = new FloatSlider(this, "wet", 5, 20, 110, 15, &mWet, 0, 1);
+   mLoadButton = new ClickButton(this, "load", 5, 38);
+}
+
+void ConvolutionEffect::Poll()
+{
+   delete mRetiredKernel.exchange(nullptr);
+
+   if (mLoadFailed.exchange(false))
+      TheSynth->LogEvent("couldn't load impulse response " + mImpulsePath, kLogEventType_Error);
+}
+
+void ConvolutionEffect::LoadImpulseResponse(std::string path)
+{
+   CancelLoad();
+
+   mImpulsePath = path;
+   mLoading = true;
+   mLoadJob = new ImpulseResponseLoadJob(this, path);
+   GetLoadPool().addJob(mLoadJob, true);
+}
+
+void ConvolutionEffect::CancelLoad()
+{
+   if (mLoadJob == nullptr)
+      return;
+
+   //the job might have finished and been deleted by now, removeJob() only looks for the pointer
+   GetLoadPool().removeJob(mLoadJob, true, -1);
+   mLoadJob = nullptr;
+   mLoading = false;
+}
+
+void ConvolutionEffect::OnLoadFinished(Kernel* kernel)
+{
+   if (kernel != nullptr)
+      delete mPendingKernel.exchange(kernel); //replaces one that never got swapped in
+   else
+      mLoadFailed = true;
+   mLoading = false;
+}
+
+void ConvolutionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
+{
+   PROFILER(ConvolutionEffect);
+
+   if (!mEnabled)
+      return;
+
+   int bufferSize = buffer->BufferSize();
+   if ((int)mWetBuffer.size() < bufferSize)
+   {
+      mWetBuffer.resize(bufferSize);
+      mFadeBuffer.resize(bufferSize);
+   }
+
+   ComputeSliders(0);
+
+   //swap in a newly loaded response, once the last one swapped out has been cleaned up
+   Kernel* fadingOut = nullptr;
+   if (mRetiredKernel.load() == nullptr)
+   {
+      Kernel* pending = mPendingKernel.exchange(nullptr);
+      if (pending != nullptr)
+      {
+         fadingOut = mKernel;
+         mKernel = pending;
+         mTailLength = mKernel->mLength + mKernel->mEngines[0]->GetBlockSize();
+      }
+   }
+
+   for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+   {
+      float* data = buffer->GetChannel(ch);
+      if (mKernel == nullptr)
+      {
+         Mult(data, mDry, bufferSize);
+         continue;
+      }
+
+      float* wet = mWetBuffer.data();
+      mKernel->mEngines[ch]->Process(data, wet, bufferSize);
+      if (fadingOut != nullptr)
+      {
+         fadingOut->mEngines[ch]->Process(data, mFadeBuffer.data(), bufferSize);
+         for (int i = 0; i < bufferSize; ++i)
+         {
+            float fade = float(i + 1) / bufferSize;
+            wet[i] = wet[i] * fade + mFadeBuffer[i] * (1 - fade);
+         }
+      }
+
+      for (int i = 0; i < bufferSize; ++i)
+         data[i] = data[i] * mDry + wet[i] * mWet;
+   }
+
+   if (fadingOut != nullptr)
+      mRetiredKernel = fadingOut;
+}
+
+void ConvolutionEffect::DrawModule()
+{
+   if (!mEnabled)
+      return;
+
+   mDrySlider->Draw();
+   mWetSlider->Draw();
+   mLoadButton->Draw();
+
+   std::string status;
+   if (mLoading)
+      status = "loading...";
+   else if (mImpulsePath.empty())
+      status = "drop an impulse response";
+   else
+      status = juce::File(mImpulsePath).getFileNameWithoutExtension().toStdString();
+   DrawTextNormal(status, 40, 50, 11);
+}
+
+void ConvolutionEffect::GetModuleDimensions(float& width, float& height)
+{
+   if (mEnabled)
+   {
+      width = 120;
+      height = 56;
+   }
+   else
+   {
+      width = 120;
+      height = 0;
+   }
+}
+
+float ConvolutionEffect::GetEffectAmount()
+{
+   if (!mEnabled)
+      return 0;
+   return mWet;
+}
+
+int ConvolutionEffect::GetTailLengthSamples()
+{
+   return mTailLength;
+}
+
+void ConvolutionEffect::FilesDropped(std::vector<std::string> files, int x, int y)
+{
+   if (!files.empty())
+      LoadImpulseResponse(files[0]);
+}
+
+void ConvolutionEffect::ButtonClicked(ClickButton* button, double time)
+{
+   if (button == mLoadButton)
+   {
+      auto filePattern = TheSynth->GetAudioFormatManager().getWildcardForAllFormats();
+      if (juce::File::areFileNamesCaseSensitive())
+         filePattern += ";" + filePattern.toUpperCase();
+      juce::FileChooser chooser("Load impulse response", juce::File(ofToSamplePath("")), filePattern, true, false, TheSynth->GetFileChooserParent());
+      if (chooser.browseForFileToOpen())
+         LoadImpulseResponse(chooser.getResult().getFullPathName().toStdString());
+   }
+}
+
+std::vector<IUIControl*> ConvolutionEffect::ControlsToIgnoreInSaveState() const
+{
+   std::vector<IUIControl*> ignore;
+   ignore.push_back(mLoadButton);
+   return ignore;
+}
+
+void ConvolutionEffect::SaveState(FileStreamOut& out)
+{
+   out << GetModuleSaveStateRev();
+
+   IDrawableModule::SaveState(out);
+
+   out << mImpulsePath;
+}
+
+void ConvolutionEffect::LoadState(FileStreamIn& in, int rev)
+{
+   IDrawableModule::LoadState(in, rev);
+   if (rev < 0)
+      return;
+
+   LoadStateValidate(rev <= GetModuleSaveStateRev());
+
+   std::string path;
+   in >> path;
+   if (!path.empty())
+      LoadImpulseResponse(path);
+}
@@ -0,0 +1,109 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ConvolutionEffect.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "IAudioEffect.h"
+#include "Slider.h"
+#include "ClickButton.h"
+#include "ConvolutionEngine.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class ImpulseResponseLoadJob;
+
+//reverb (or any other filter) from a recorded impulse response. the response is loaded and prepared on a background thread,
+//and swapped in with a crossfade once it's ready
+class ConvolutionEffect : public IAudioEffect, public IFloatSliderListener, public IButtonListener
+{
+public:
+   ConvolutionEffect();
+   ~ConvolutionEffect();
+
+   static IAudioEffect* Create() { return new ConvolutionEffect(); }
+
+
+   void CreateUIControls() override;
+   void Poll() override;
+
+   void LoadImpulseResponse(std::string path);
+
+   //IAudioEffect
+   void ProcessAudio(double time, ChannelBuffer* buffer) override;
+   void SetEnabled(bool enabled) override { mEnabled = enabled; }
+   float GetEffectAmount() override;
+   int GetTailLengthSamples() override;
+   std::string GetType() override { return "convolution"; }
+
+   void FilesDropped(std::vector<std::string> files, int x, int y) override;
+   void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
+   void ButtonClicked(ClickButton* button, double time) override;
+
+   bool IsEnabled() const override { return mEnabled; }
+
+   void SaveState(FileStreamOut& out) override;
+   void LoadState(FileStreamIn& in, int rev) override;
+   int GetModuleSaveStateRev() const override { return 0; }
+   std::vector<IUIControl*> ControlsToIgnoreInSaveState() const override;
+
+private:
+   friend class ImpulseResponseLoadJob;
+
+   //one engine per channel, built off the audio thread
+   struct Kernel
+   {
+      std::unique_ptr<ConvolutionEngine> mEngines[ChannelBuffer::kMaxNumChannels];
+      int mLength{ 0 };
+   };
+
+   //IDrawableModule
+   void DrawModule() override;
+   void GetModuleDimensions(float& width, float& height) override;
+
+   void CancelLoad();
+   void OnLoadFinished(Kernel* kernel); //background thread, kernel is null if the file couldn't be read
+
+   float mDry{ 1 };
+   float mWet{ .5f };
+   FloatSlider* mDrySlider{ nullptr };
+   FloatSlider* mWetSlider{ nullptr };
+   ClickButton* mLoadButton{ nullptr };
+
+   std::string mImpulsePath;
+   ImpulseResponseLoadJob* mLoadJob{ nullptr };
+   std::atomic<bool> mLoading{ false };
+   std::atomic<bool> mLoadFailed{ false };
+
+   Kernel* mKernel{ nullptr }; //audio thread
+   std::atomic<Kernel*> mPendingKernel{ nullptr }; //ready to be swapped in
+   std::atomic<Kernel*> mRetiredKernel{ nullptr }; //swapped out, for Poll() to delete
+   std::atomic<int> mTailLength{ 0 };
+
+   std::vector<float> mWetBuffer;
+   std::vector<float> mFadeBuffer;
+};
@@ -0,0 +1,319 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ConvolutionEngine.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ConvolutionEngine.h"
+#include "ComputeOffload.h"
+#include "FFT.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+   const int kStageGrowth = 8;
+   const int kMaxMissedResults = 4; //an offloaded stage goes back to the cpu after this many late results in a row
+
+   int GetSpectrumStride(int partitionSize)
+   {
+      return (partitionSize + 1) * 2;
+   }
+}
+
+std::shared_ptr<const ConvolutionEngine::Response> ConvolutionEngine::PrepareResponse(const float* impulse, int length, int blockSize)
+{
+   assert(blockSize > 0 && (blockSize & (blockSize - 1)) == 0);
+
+   auto response = std::make_shared<Response>();
+   response->mBlockSize = blockSize;
+   response->mLength = length;
+
+   //the head is convolved in sync with the blocks. every later stage needs two of its partitions of lead time (one to collect input, one
+   //to spread the work across), so it starts two of its partitions in, and runs until the next stage can take over
+   int start = 0;
+   for (int partitionSize = blockSize; start < length; partitionSize *= kStageGrowth)
+   {
+      bool isLastStage = partitionSize * kStageGrowth > kMaxPartitionSize;
+      int end = isLastStage ? length : MIN(length, partitionSize * kStageGrowth * 2);
+      int latency = (partitionSize == blockSize) ? 0 : partitionSize * 2;
+
+      Response::Stage stage;
+      stage.mPartitionSize = partitionSize;
+      stage.mNumPartitions = (end - start + partitionSize - 1) / partitionSize;
+      stage.mFirstPartition = (start - latency) / partitionSize;
+
+      const FFTPlan& plan = FFTPlan::Get(partitionSize * 2);
+      const int stride = GetSpectrumStride(partitionSize);
+      //fold the inverse transform's normalization in here, so the output doesn't have to be scaled every block
+      const float normalize = 1.0f / plan.GetSize();
+      std::vector<float> frame(plan.GetSize());
+      std::vector<float> scratch(plan.GetScratchSize());
+      stage.mSpectra.resize(stage.mNumPartitions * stride);
+      for (int i = 0; i < stage.mNumPartitions; ++i)
+      {
+         int partitionStart = start + i * partitionSize;
+         int partitionLength = MIN(partitionSize, length - partitionStart);
+         std::fill(frame.begin(), frame.end(), 0);
+         for (int j = 0; j < partitionLength; ++j)
+            frame[j] = impulse[partitionStart + j] * normalize;
+         float* spectrum = &stage.mSpectra[i * stride];
+         plan.Forward(frame.data(), spectrum, spectrum + partitionSize + 1, scratch.data());
+      }
+
+      response->mStages.push_back(std::move(stage));
+      start = end;
+   }
+
+   return response;
+}
+
+ConvolutionEngine::ConvolutionEngine(std::shared_ptr<const Response> response)
+: mResponse(response)
+{
+   int scratchSize = 0;
+   for (const Response::Stage& stage : mResponse->mStages)
+   {
+      StageState state;
+      state.mStage = &stage;
+      state.mPlan = &FFTPlan::Get(stage.mPartitionSize * 2);
+      state.mBlocksPerPartition = stage.mPartitionSize / mResponse->mBlockSize;
+      state.mInput.resize(stage.mPartitionSize * 2);
+      state.mFrame.resize(stage.mPartitionSize * 2);
+      state.mHistoryLength = stage.mNumPartitions + stage.mFirstPartition;
+      state.mHistory.resize(state.mHistoryLength * GetSpectrumStride(stage.mPartitionSize));
+      state.mAccumulator.resize(GetSpectrumStride(stage.mPartitionSize));
+      state.mOutput.resize(stage.mPartitionSize);
+      scratchSize = MAX(scratchSize, state.mPlan->GetScratchSize());
+
+      //a stage's result is due a partition after its input is complete. that has to cover the offload's latency, whichever
+      //block of the callback the input completes in
+      ComputeOffload* offload = ComputeOffload::Get();
+      if (offload != nullptr && state.mBlocksPerPartition > 1 && stage.mPartitionSize >= offload->GetLatencyCallbacks() * gBufferSize)
+         state.mSpectralBank = offload->CreateSpectralBank(stage.mSpectra.data(), stage.mNumPartitions, stage.mPartitionSize + 1, state.mHistoryLength);
+
+      mStages.push_back(std::move(state));
+   }
+
+   mScratch.resize(scratchSize);
+   mFifoIn.resize(mResponse->mBlockSize);
+   mFifoOut.resize(mResponse->mBlockSize);
+}
+
+ConvolutionEngine::~ConvolutionEngine()
+{
+   for (StageState& state : mStages)
+      ReleaseOffload(state);
+}
+
+int ConvolutionEngine::GetNumOffloadedStages() const
+{
+   int numOffloaded = 0;
+   for (const StageState& state : mStages)
+   {
+      if (state.mSpectralBank != -1)
+         ++numOffloaded;
+   }
+   return numOffloaded;
+}
+
+void ConvolutionEngine::ReleaseOffload(StageState& state)
+{
+   if (state.mSpectralBank != -1)
+      ComputeOffload::Get()->DestroySpectralBank(state.mSpectralBank);
+   state.mSpectralBank = -1;
+   state.mTicket = -1;
+}
+
+void ConvolutionEngine::Reset()
+{
+   for (StageState& state : mStages)
+   {
+      std::fill(state.mInput.begin(), state.mInput.end(), 0);
+      std::fill(state.mHistory.begin(), state.mHistory.end(), 0);
+      std::fill(state.mAccumulator.begin(), state.mAccumulator.end(), 0);
+      std::fill(state.mOutput.begin(), state.mOutput.end(), 0);
+      state.mHistoryPos = 0;
+      state.mBlockInPartition = 0;
+      state.mComputing = false;
+      state.mInputTransformed = false;
+      state.mTicket = -1;
+      if (state.mSpectralBank != -1)
+         ComputeOffload::Get()->ClearSpectralBank(state.mSpectralBank);
+   }
+   std::fill(mFifoIn.begin(), mFifoIn.end(), 0);
+   std::fill(mFifoOut.begin(), mFifoOut.end(), 0);
+   mFifoPos = 0;
+}
+
+void ConvolutionEngine::Process(const float* input, float* output, int numSamples)
+{
+   const int blockSize = mResponse->mBlockSize;
+
+   if (mFifoPos == 0 && numSamples % blockSize == 0)
+   {
+      for (int i = 0; i < numSamples; i += blockSize)
+         ProcessBlock(input + i, output + i);
+      return;
+   }
+
+   for (int i = 0; i < numSamples; ++i)
+   {
+      float in = input[i];
+      output[i] = mFifoOut[mFifoPos];
+      mFifoIn[mFifoPos] = in;
+      if (++mFifoPos == blockSize)
+      {
+         ProcessBlock(mFifoIn.data(), mFifoOut.data());
+         mFifoPos = 0;
+      }
+   }
+}
+
+void ConvolutionEngine::ProcessBlock(const float* input, float* output)
+{
+   const int blockSize = mResponse->mBlockSize;
+
+   for (StageState& state : mStages)
+      memcpy(&state.mInput[state.mStage->mPartitionSize + state.mBlockInPartition * blockSize], input, blockSize * sizeof(float));
+
+   //input might be the same buffer as output, it's been copied out now
+   memset(output, 0, blockSize * sizeof(float));
+
+   for (StageState& state : mStages)
+   {
+      const int partitionSize = state.mStage->mPartitionSize;
+
+      if (state.mBlocksPerPartition == 1)
+      {
+         //the head, convolved right away
+         TransformInput(state, state.mInput.data());
+         MultiplyAccumulate(state, 0, state.mStage->mNumPartitions);
+         TransformOutput(state);
+         for (int i = 0; i < blockSize; ++i)
+            output[i] += state.mOutput[i];
+         memcpy(state.mInput.data(), &state.mInput[partitionSize], partitionSize * sizeof(float));
+         continue;
+      }
+
+      const int block = state.mBlockInPartition;
+      const float* stageOutput = &state.mOutput[block * blockSize];
+      for (int i = 0; i < blockSize; ++i)
+         output[i] += stageOutput[i];
+
+      if (state.mComputing)
+      {
+         if (block == 0 && !state.mInputTransformed)
+            TransformInput(state, state.mFrame.data());
+         const int numPartitions = state.mStage->mNumPartitions;
+         if (state.mTicket == -1)
+            MultiplyAccumulate(state, block * numPartitions / state.mBlocksPerPartition, (block + 1) * numPartitions / state.mBlocksPerPartition);
+         if (block == state.mBlocksPerPartition - 1)
+         {
+            if (state.mTicket != -1)
+            {
+               if (ComputeOffload::Get()->Collect(state.mTicket, state.mAccumulator.data(), (int)state.mAccumulator.size()))
+               {
+                  state.mMissedResults = 0;
+               }
+               else
+               {
+                  //late, so it all has to happen now
+                  MultiplyAccumulate(state, 0, numPartitions);
+                  if (++state.mMissedResults >= kMaxMissedResults)
+                     ReleaseOffload(state);
+               }
+               state.mTicket = -1;
+            }
+            TransformOutput(state); //the last of the previous output was just played
+            state.mComputing = false;
+         }
+      }
+
+      if (block == state.mBlocksPerPartition - 1)
+      {
+         //a partition of input is complete, set it aside for the next partition's worth of blocks to work on
+         state.mFrame = state.mInput;
+         memcpy(state.mInput.data(), &state.mInput[partitionSize], partitionSize * sizeof(float));
+         state.mComputing = true;
+         state.mInputTransformed = false;
+         if (state.mSpectralBank != -1)
+            QueueOffload(state);
+      }
+
+      state.mBlockInPartition = (block + 1) % state.mBlocksPerPartition;
+   }
+}
+
+void ConvolutionEngine::TransformInput(StageState& state, const float* frame)
+{
+   const int partitionSize = state.mStage->mPartitionSize;
+   state.mHistoryPos = (state.mHistoryPos + state.mHistoryLength - 1) % state.mHistoryLength;
+   float* spectrum = &state.mHistory[state.mHistoryPos * GetSpectrumStride(partitionSize)];
+   state.mPlan->Forward(frame, spectrum, spectrum + partitionSize + 1, mScratch.data());
+}
+
+void ConvolutionEngine::QueueOffload(StageState& state)
+{
+   //the device keeps its own copy of the input history, so every input spectrum has to go out, whether or not this one's result comes back in time
+   TransformInput(state, state.mFrame.data());
+   state.mInputTransformed = true;
+   const float* spectrum = &state.mHistory[state.mHistoryPos * GetSpectrumStride(state.mStage->mPartitionSize)];
+   state.mTicket = ComputeOffload::Get()->QueueSpectralMultiply(state.mSpectralBank, spectrum, state.mHistoryPos, state.mStage->mFirstPartition);
+   if (state.mTicket == -1)
+      ReleaseOffload(state); //its history has a hole in it now, so the stage is back on the cpu for good
+}
+
+void ConvolutionEngine::MultiplyAccumulate(StageState& state, int firstPartition, int endPartition)
+{
+   const int numBins = state.mStage->mPartitionSize + 1;
+   const int stride = GetSpectrumStride(state.mStage->mPartitionSize);
+   float* __restrict accRe = state.mAccumulator.data();
+   float* __restrict accIm = accRe + numBins;
+
+   for (int i = firstPartition; i < endPartition; ++i)
+   {
+      int historyIndex = (state.mHistoryPos + i + state.mStage->mFirstPartition) % state.mHistoryLength;
+      const float* __restrict xRe = &state.mHistory[historyIndex * stride];
+      const float* __restrict xIm = xRe + numBins;
+      const float* __restrict hRe = &state.mStage->mSpectra[i * stride];
+      const float* __restrict hIm = hRe + numBins;
+      for (int k = 0; k < numBins; ++k)
+      {
+         accRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+         accIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+      }
+   }
+}
+
+void ConvolutionEngine::TransformOutput(StageState& state)
+{
+   const int partitionSize = state.mStage->mPartitionSize;
+   float* re = state.mAccumulator.data();
+   state.mPlan->Inverse(re, re + partitionSize + 1, state.mFrame.data(), mScratch.data());
+   //overlap-save: the first half wrapped around, the second half is this partition's output
+   memcpy(state.mOutput.data(), &state.mFrame[partitionSize], partitionSize * sizeof(float));
+   std::fill(state.mAccumulator.begin(), state.mAccumulator.end(), 0);
+}
@@ -0,0 +1,110 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ConvolutionEngine.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+class FFTPlan;
+
+//convolves a signal with a long impulse response, using non-uniformly partitioned overlap-save.
+//the head of the response is split into block-sized partitions and convolved every block with no latency. further out,
+//the response is split into partitions eight times larger per stage, whose transforms and spectral products are spread across
+//the blocks before their output is due, so a long response costs about the same on every block.
+//when there's a ComputeOffload, stages with enough lead time to cover its latency send their multiply-accumulate there instead
+class ConvolutionEngine
+{
+public:
+   //the impulse response split into partitions and transformed. immutable, so it can be prepared on any thread and shared between engines
+   struct Response
+   {
+      struct Stage
+      {
+         int mPartitionSize{ 0 };
+         int mNumPartitions{ 0 };
+         int mFirstPartition{ 0 }; //delay before the stage's first partition, in partitions after the stage's own latency
+         std::vector<float> mSpectra; //each partition's real bins followed by its imaginary bins
+      };
+
+      int mBlockSize{ 0 };
+      int mLength{ 0 };
+      std::vector<Stage> mStages;
+   };
+
+   static const int kMaxPartitionSize = 8192;
+
+   //blockSize has to be a power of two
+   static std::shared_ptr<const Response> PrepareResponse(const float* impulse, int length, int blockSize);
+
+   //allocates everything the engine needs, so it's best created off the audio thread too
+   explicit ConvolutionEngine(std::shared_ptr<const Response> response);
+   ~ConvolutionEngine();
+
+   int GetBlockSize() const { return mResponse->mBlockSize; }
+   int GetLength() const { return mResponse->mLength; }
+   int GetNumOffloadedStages() const;
+
+   //output can be the same buffer as input. while calls come in whole blocks there's no latency,
+   //otherwise the output is delayed by one block
+   void Process(const float* input, float* output, int numSamples);
+   void Reset();
+
+private:
+   struct StageState
+   {
+      const Response::Stage* mStage{ nullptr };
+      const FFTPlan* mPlan{ nullptr };
+      int mBlocksPerPartition{ 0 };
+      std::vector<float> mInput; //the previous partition of input followed by the one being collected
+      std::vector<float> mFrame; //a completed input window, waiting to be transformed
+      std::vector<float> mHistory; //input spectra, newest at mHistoryPos
+      int mHistoryLength{ 0 };
+      int mHistoryPos{ 0 };
+      std::vector<float> mAccumulator;
+      std::vector<float> mOutput; //the stage's current partition of output
+      int mBlockInPartition{ 0 }; //how far through collecting input, computing and playing output we are
+      bool mComputing{ false };
+      bool mInputTransformed{ false }; //offloaded stages transform their input as soon as it's complete, to send it off
+      int mSpectralBank{ -1 }; //on the ComputeOffload, -1 if the stage runs on the cpu
+      int mTicket{ -1 }; //the multiply-accumulate in flight for the partition being computed
+      int mMissedResults{ 0 }; //in a row
+   };
+
+   void ProcessBlock(const float* input, float* output);
+   void TransformInput(StageState& state, const float* frame);
+   void MultiplyAccumulate(StageState& state, int firstPartition, int endPartition);
+   void TransformOutput(StageState& state);
+   void QueueOffload(StageState& state);
+   void ReleaseOffload(StageState& state);
+
+   std::shared_ptr<const Response> mResponse;
+   std::vector<StageState> mStages;
+   std::vector<float> mScratch;
+   std::vector<float> mFifoIn;
+   std::vector<float> mFifoOut;
+   int mFifoPos{ 0 };
+};
@@ -0,0 +1,74 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    CpuGovernor.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "CpuGovernor.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+
+void CpuGovernor::Record(uint64_t startNs, uint64_t endNs, double periodMs)
+{
+   int budgetPercent = UserPrefs.cpu_governor_budget_percent.Get();
+   if (budgetPercent <= 0 || periodMs <= 0)
+   {
+      mLevel.store(kLevel_None, std::memory_order_relaxed);
+      return;
+   }
+
+   //quick to notice a rise, slow to trust a drop
+   float used = float((endNs - startNs) / (periodMs * 1000000));
+   float load = mLoad.load(std::memory_order_relaxed);
+   load += (used - load) * (used > load ? .5f : .05f);
+   mLoad.store(load, std::memory_order_relaxed);
+
+   float budget = budgetPercent / 100.0f;
+   int level = GetLevel();
+   if (load > budget)
+   {
+      mHeadroomMs = 0;
+      if (++mCallbacksOver >= kCallbacksToRaise && level < kNumLevels - 1)
+      {
+         ++level;
+         mCallbacksOver = 0;
+      }
+   }
+   else
+   {
+      mCallbacksOver = 0;
+      if (load < budget * kRecoverFraction)
+         mHeadroomMs += periodMs;
+      if (mHeadroomMs >= kRecoverMs && level > kLevel_None)
+      {
+         --level;
+         mHeadroomMs = 0;
+      }
+   }
+   mLevel.store(level, std::memory_order_relaxed);
+}
+
+int CpuGovernor::GetLevel(int priority) const
+{
+   return MAX(kLevel_None, GetLevel() - priority);
+}
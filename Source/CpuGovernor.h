@@ -0,0 +1,64 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    CpuGovernor.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+//raises a degradation level as the audio callbacks get close to their deadline, so that voices trade quality for time
+//before the callback runs over and drops out. it steps up a level at a time while over budget, and back down once there's
+//been headroom for a while. each instrument subtracts its priority from the level, so a protected lead degrades last.
+//recorded on the audio thread, read from anywhere
+class CpuGovernor
+{
+public:
+   enum Level
+   {
+      kLevel_None,
+      kLevel_StealReleased, //released voices are faded out early once they've gotten quiet
+      kLevel_ReduceQuality, //fewer unison copies, cheaper resampling
+      kLevel_ReduceControlRate, //modulation is followed once a buffer instead of every sample
+      kLevel_ReduceVoices, //new notes only get half the voices
+      kNumLevels
+   };
+
+   void Record(uint64_t startNs, uint64_t endNs, double periodMs);
+
+   int GetLevel() const { return mLevel.load(std::memory_order_relaxed); }
+   int GetLevel(int priority) const; //the level an instrument with this priority should run at
+   float GetLoad() const { return mLoad.load(std::memory_order_relaxed); } //smoothed fraction of the callback period used
+
+private:
+   static const int kCallbacksToRaise = 4; //over budget this many callbacks in a row before the next level
+   static constexpr float kRecoverFraction = .7f; //under this much of the budget counts as headroom
+   static constexpr double kRecoverMs = 1000; //of headroom before the next level down
+
+   std::atomic<int> mLevel{ kLevel_None };
+   std::atomic<float> mLoad{ 0 };
+   int mCallbacksOver{ 0 };
+   double mHeadroomMs{ 0 };
+};
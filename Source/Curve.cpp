@@ -32,36 +32,79 @@ Curve::Curve(float defaultValue)
 {
 }
 
-void Curve::AddPoint(CurvePoint point)
+Curve::~Curve()
+{
+   CurvePoint** chunks = mChunks.load();
+   for (int i = 0; i < mNumChunks; ++i)
+      delete[] chunks[i];
+   delete[] chunks;
+   for (auto* table : mRetiredChunkTables)
+      delete[] table;
+}
+
+//storage grows a chunk at a time, and a chunk never moves once it's allocated, so a curve can keep growing while it's being read.
+//when the table of chunks outgrows itself, the old table is kept around (it's tiny) in case anything is still reading through it
+void Curve::EnsureCapacity(int numPoints)
 {
-   if (IsAtCapacity())
+   int numChunksNeeded = (numPoints + kChunkSize - 1) / kChunkSize;
+   if (numChunksNeeded <= mNumChunks)
       return;
 
-   bool inserted = false;
+   CurvePoint** chunks = mChunks.load(std::memory_order_relaxed);
+   if (numChunksNeeded > mChunkTableSize)
+   {
+      int newTableSize = MAX(mChunkTableSize * 2, 4);
+      while (newTableSize < numChunksNeeded)
+         newTableSize *= 2;
+      CurvePoint** newChunks = new CurvePoint*[newTableSize];
+      for (int i = 0; i < mNumChunks; ++i)
+         newChunks[i] = chunks[i];
+      mChunks.store(newChunks, std::memory_order_release);
+      if (chunks != nullptr)
+         mRetiredChunkTables.push_back(chunks);
+      chunks = newChunks;
+      mChunkTableSize = newTableSize;
+   }
+
+   while (mNumChunks < numChunksNeeded)
+   {
+      chunks[mNumChunks] = new CurvePoint[kChunkSize];
+      ++mNumChunks;
+   }
+}
+
+void Curve::AddPoint(CurvePoint point)
+{
    for (int i = 0; i < mNumCurvePoints; ++i)
    {
-      if (mPoints[i].mTime > point.mTime)
+      if (PointAt(i).mTime > point.mTime)
       {
-         for (int j = i; j < mNumCurvePoints; ++j)
-            mPoints[j + 1] = mPoints[j];
-         mPoints[i] = point;
-         inserted = true;
+         EnsureCapacity(mNumCurvePoints + 1);
+         for (int j = mNumCurvePoints; j > i; --j)
+            PointAt(j) = PointAt(j - 1);
+         PointAt(i) = point;
          ++mNumCurvePoints;
-         break;
+         return;
       }
    }
-   if (!inserted)
-      AddPointAtEnd(point);
+   AddPointAtEnd(point);
 }
 
 void Curve::AddPointAtEnd(CurvePoint point)
 {
-   if (IsAtCapacity())
-      return;
-   mPoints[mNumCurvePoints] = point;
+   EnsureCapacity(mNumCurvePoints + 1);
+   PointAt(mNumCurvePoints) = point;
    ++mNumCurvePoints;
 }
 
+void Curve::ReplaceLastPoint(CurvePoint point)
+{
+   if (mNumCurvePoints == 0)
+      AddPointAtEnd(point);
+   else
+      PointAt(mNumCurvePoints - 1) = point;
+}
+
 int Curve::FindIndexForTime(float time)
 {
    int max = mNumCurvePoints - 1;
@@ -71,9 +114,9 @@ int Curve::FindIndexForTime(float time)
    {
       int mid = left + (right - left) / 2;
 
-      if (mPoints[mid].mTime < time && (mid == max || mPoints[mid + 1].mTime >= time)) // Check if x is present at mid
+      if (PointAt(mid).mTime < time && (mid == max || PointAt(mid + 1).mTime >= time)) // Check if x is present at mid
          return mid;
-      if (mPoints[mid].mTime < time) // If time greater, ignore left half
+      if (PointAt(mid).mTime < time) // If time greater, ignore left half
          left = mid + 1;
       else // If time is smaller, ignore right half
          right = mid - 1;
@@ -89,19 +132,19 @@ float Curve::Evaluate(float time, bool holdEndForLoop)
 
    if (mNumCurvePoints > 0)
    {
-      if (time <= mPoints[0].mTime)
+      if (time <= PointAt(0).mTime)
       {
          if (holdEndForLoop)
-            return mPoints[mNumCurvePoints - 1].mValue;
+            return PointAt(mNumCurvePoints - 1).mValue;
          else
-            return mPoints[0].mValue;
+            return PointAt(0).mValue;
       }
 
       int beforeIndex = 0;
       int quickCheckIndex = mLastEvalIndex;
       if (quickCheckIndex < mNumCurvePoints &&
-          mPoints[quickCheckIndex].mTime < time &&
-          (quickCheckIndex == mNumCurvePoints - 1 || mPoints[quickCheckIndex + 1].mTime >= time))
+          PointAt(quickCheckIndex).mTime < time &&
+          (quickCheckIndex == mNumCurvePoints - 1 || PointAt(quickCheckIndex + 1).mTime >= time))
       {
          beforeIndex = quickCheckIndex;
       }
@@ -109,7 +152,7 @@ float Curve::Evaluate(float time, bool holdEndForLoop)
       {
          /*for (int i=1; i<mNumCurvePoints; ++i)
          {
-            if (mPoints[i].mTime >= time)
+            if (PointAt(i).mTime >= time)
             {
                beforeIndex = i-1;
                break;
@@ -122,7 +165,7 @@ float Curve::Evaluate(float time, bool holdEndForLoop)
       mLastEvalIndex = beforeIndex;
       int afterIndex = MIN(beforeIndex + 1, mNumCurvePoints - 1);
 
-      retVal = ofMap(time, mPoints[beforeIndex].mTime, mPoints[afterIndex].mTime, mPoints[beforeIndex].mValue, mPoints[afterIndex].mValue, K(clamp));
+      retVal = ofMap(time, PointAt(beforeIndex).mTime, PointAt(afterIndex).mTime, PointAt(beforeIndex).mValue, PointAt(afterIndex).mValue, K(clamp));
    }
 
    return retVal;
@@ -155,7 +198,7 @@ void Curve::Clear()
 CurvePoint* Curve::GetPoint(int index)
 {
    assert(index < mNumCurvePoints);
-   return &mPoints[index];
+   return &PointAt(index);
 }
 
 void Curve::OnClicked(float x, float y, bool right)
@@ -186,7 +229,7 @@ void Curve::SaveState(FileStreamOut& out)
 
    out << mNumCurvePoints;
    for (int i = 0; i < mNumCurvePoints; ++i)
-      out << mPoints[i].mTime << mPoints[i].mValue;
+      out << PointAt(i).mTime << PointAt(i).mValue;
 }
 
 void Curve::LoadState(FileStreamIn& in)
@@ -195,7 +238,11 @@ void Curve::LoadState(FileStreamIn& in)
    in >> rev;
    LoadStateValidate(rev <= kSaveStateRev);
 
-   in >> mNumCurvePoints;
-   for (int i = 0; i < mNumCurvePoints; ++i)
-      in >> mPoints[i].mTime >> mPoints[i].mValue;
+   int numPoints;
+   in >> numPoints;
+   mNumCurvePoints = 0;
+   EnsureCapacity(numPoints);
+   for (int i = 0; i < numPoints; ++i)
+      in >> PointAt(i).mTime >> PointAt(i).mValue;
+   mNumCurvePoints = numPoints;
 }
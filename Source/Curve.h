@@ -28,6 +28,8 @@
 #include "OpenFrameworksPort.h"
 #include "IClickable.h"
 
+#include <atomic>
+
 class FileStreamOut;
 class FileStreamIn;
 
@@ -47,8 +49,12 @@ class Curve : public IClickable
 {
 public:
    Curve(float defaultValue);
+   ~Curve();
+   Curve(const Curve&) = delete;
+   Curve& operator=(const Curve&) = delete;
    void AddPoint(CurvePoint point);
    void AddPointAtEnd(CurvePoint point); //only use this if you are sure that there are no points already added at an earlier time
+   void ReplaceLastPoint(CurvePoint point);
    float Evaluate(float time, bool holdEndForLoop = false);
    void Render() override;
    void SetExtents(float start, float end)
@@ -80,9 +86,15 @@ protected:
    bool MouseScrolled(float x, float y, float scrollX, float scrollY, bool isSmoothScroll, bool isInvertedScroll) override;
 
 private:
-   bool IsAtCapacity() { return mNumCurvePoints >= (int)mPoints.size(); }
    int FindIndexForTime(float time);
-   std::array<CurvePoint, 5000> mPoints;
+   void EnsureCapacity(int numPoints);
+   CurvePoint& PointAt(int index) const { return mChunks.load(std::memory_order_acquire)[index / kChunkSize][index % kChunkSize]; }
+
+   static constexpr int kChunkSize = 256;
+   std::atomic<CurvePoint**> mChunks{ nullptr };
+   int mNumChunks{ 0 };
+   int mChunkTableSize{ 0 };
+   std::vector<CurvePoint**> mRetiredChunkTables;
    int mNumCurvePoints{ 0 };
    float mWidth{ 200 };
    float mHeight{ 20 };
@@ -53,6 +53,12 @@ void DCRemoverEffect::ProcessAudio(double time, ChannelBuffer* buffer)
       mBiquad[ch].Filter(buffer->GetChannel(ch), bufferSize);
 }
 
+SampleKernel* DCRemoverEffect::BeginSampleKernel(double time, int bufferSize)
+{
+   mKernel.SetFilters(mBiquad);
+   return &mKernel;
+}
+
 void DCRemoverEffect::DrawModule()
 {
 }
@@ -27,6 +27,7 @@
 
 #include "IAudioEffect.h"
 #include "BiquadFilter.h"
+#include "SampleKernel.h"
 
 class DCRemoverEffect : public IAudioEffect
 {
@@ -42,6 +43,7 @@ public:
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    float GetEffectAmount() override;
    std::string GetType() override { return "dcremover"; }
+   SampleKernel* BeginSampleKernel(double time, int bufferSize) override;
 
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
 
@@ -53,4 +55,5 @@ private:
    void DrawModule() override;
 
    BiquadFilter mBiquad[ChannelBuffer::kMaxNumChannels]{};
+   BiquadKernel mKernel;
 };
@@ -32,8 +32,11 @@
 
 #include "juce_core/juce_core.h"
 
+#include <limits>
+
 DelayEffect::DelayEffect()
-: mDelayBuffer(DELAY_BUFFER_SIZE)
+: mDelayLine(DELAY_BUFFER_SIZE - 2)
+, mDelayed(gBufferSize)
 {
 }
 
@@ -75,8 +78,8 @@ void DelayEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   float bufferSize = buffer->BufferSize();
-   mDelayBuffer.SetNumChannels(buffer->NumActiveChannels());
+   int bufferSize = buffer->BufferSize();
+   mDelayLine.GetBuffer().SetNumChannels(buffer->NumActiveChannels());
 
    if (mInterval != kInterval_None)
    {
@@ -85,37 +88,109 @@ void DelayEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    }
 
    mAmountRamp.Start(time, mFeedback, time + 3);
+
+   //a delay longer than the buffer only reads what was written before this buffer, so the whole buffer's worth of delayed
+   //samples can be read in one go, with the delay ramped across it. modulation is picked up once a buffer when it does
+   ComputeSliders(bufferSize - 1);
+   float delaySamples = GetDelaySamples(time + (bufferSize - 1) * gInvSampleRateMs);
+   float lastDelaySamples = mLastDelaySamples >= 0 ? mLastDelaySamples : delaySamples;
+   if (MIN(delaySamples, lastDelaySamples) > bufferSize && bufferSize <= (int)mDelayed.size())
+      ProcessBlock(time, buffer, delaySamples);
+   else
+      ProcessSamples(time, buffer);
+}
+
+float DelayEffect::GetDelaySamples(double time)
+{
+   float delay;
+   if (mDelaySlider->GetModulator() != nullptr)
+      delay = MAX(mDelay, GetMinDelayMs());
+   else
+      delay = MAX(mDelayRamp.Value(time), GetMinDelayMs());
+
+   float delaySamps = delay / gInvSampleRateMs;
+   if (mFeedbackModuleMode)
+      delaySamps -= gBufferSize;
+   return ofClamp(delaySamps, DelayLine::kMinDelaySamples, mDelayLine.GetMaxDelaySamples());
+}
+
+void DelayEffect::ProcessBlock(double time, ChannelBuffer* buffer, float delaySamples)
+{
+   int bufferSize = buffer->BufferSize();
+   RollingBuffer& delayBuffer = mDelayLine.GetBuffer();
+
+   DelayLine::Tap tap;
+   tap.mDelayFrom = mLastDelaySamples >= 0 ? mLastDelaySamples : delaySamples;
+   tap.mDelayTo = delaySamples;
+   if (mFeedbackSlider->GetModulator() != nullptr)
+   {
+      tap.mGainFrom = mFeedback;
+      tap.mGainTo = mFeedback;
+   }
+   else
+   {
+      tap.mGainFrom = mAmountRamp.Value(time);
+      tap.mGainTo = mAmountRamp.Value(time + bufferSize * gInvSampleRateMs);
+      mFeedback = mAmountRamp.Value(time + (bufferSize - 1) * gInvSampleRateMs);
+   }
+   if (mInvert)
+   {
+      tap.mGainFrom *= -1;
+      tap.mGainTo *= -1;
+   }
+   mLastDelaySamples = delaySamples;
+
+   float* delayed = mDelayed.data();
+   for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+   {
+      float* samples = buffer->GetChannel(ch);
+      std::fill(delayed, delayed + bufferSize, 0.0f);
+      mDelayLine.ReadTaps(&tap, 1, delayed, nullptr, bufferSize, ch);
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         JUCE_UNDENORMALISE(delayed[i]);
+         if (std::isnan(delayed[i]))
+            delayed[i] = 0;
+      }
+
+      if (!mEcho && mAcceptInput) //single delay, no continuous feedback so do it pre
+         delayBuffer.WriteChunk(samples, bufferSize, ch);
+
+      Add(samples, delayed, bufferSize);
+
+      if (mEcho && mAcceptInput) //continuous feedback so do it post
+         delayBuffer.WriteChunk(samples, bufferSize, ch);
+
+      if (!mAcceptInput)
+         delayBuffer.WriteChunk(delayed, bufferSize, ch);
+
+      if (!mDry)
+         BufferCopy(samples, delayed, bufferSize);
+   }
+}
+
+void DelayEffect::ProcessSamples(double time, ChannelBuffer* buffer)
+{
+   int bufferSize = buffer->BufferSize();
+   RollingBuffer& delayBuffer = mDelayLine.GetBuffer();
+
    for (int i = 0; i < bufferSize; ++i)
    {
       mFeedback = mAmountRamp.Value(time);
 
       ComputeSliders(i);
 
-      float delay;
-      if (mDelaySlider->GetModulator() != nullptr)
-         delay = MAX(mDelay, GetMinDelayMs());
-      else
-         delay = MAX(mDelayRamp.Value(time), GetMinDelayMs());
-
-      float delaySamps = delay / gInvSampleRateMs;
-      if (mFeedbackModuleMode)
-         delaySamps -= gBufferSize;
-      delaySamps = ofClamp(delaySamps, 0.1f, DELAY_BUFFER_SIZE - 2);
-
-      int sampsAgoA = int(delaySamps);
-      int sampsAgoB = sampsAgoA + 1;
+      float delaySamps = GetDelaySamples(time);
+      mLastDelaySamples = delaySamps;
 
       for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
       {
-         float sample = mDelayBuffer.GetSample(sampsAgoA, ch);
-         float nextSample = mDelayBuffer.GetSample(sampsAgoB, ch);
-         float a = delaySamps - sampsAgoA;
-         float delayedSample = (1 - a) * sample + a * nextSample; //interpolate
+         float delayedSample = mDelayLine.Read(delaySamps, ch);
 
          float in = buffer->GetChannel(ch)[i];
 
          if (!mEcho && mAcceptInput) //single delay, no continuous feedback so do it pre
-            mDelayBuffer.Write(buffer->GetChannel(ch)[i], ch);
+            delayBuffer.Write(buffer->GetChannel(ch)[i], ch);
 
          float delayInput = delayedSample * mFeedback * (mInvert ? -1 : 1);
          JUCE_UNDENORMALISE(delayInput);
@@ -123,10 +198,10 @@ void DelayEffect::ProcessAudio(double time, ChannelBuffer* buffer)
             buffer->GetChannel(ch)[i] += delayInput;
 
          if (mEcho && mAcceptInput) //continuous feedback so do it post
-            mDelayBuffer.Write(buffer->GetChannel(ch)[i], ch);
+            delayBuffer.Write(buffer->GetChannel(ch)[i], ch);
 
          if (!mAcceptInput)
-            mDelayBuffer.Write(delayInput, ch);
+            delayBuffer.Write(delayInput, ch);
 
          if (!mDry)
             buffer->GetChannel(ch)[i] -= in;
@@ -158,6 +233,21 @@ float DelayEffect::GetEffectAmount()
    return mFeedback;
 }
 
+int DelayEffect::GetTailLengthSamples()
+{
+   if (!mAcceptInput || mFeedbackModuleMode || fabsf(mFeedback) >= 1)
+      return kTailUnknown; //keeps recirculating
+
+   //echoes until it's 80dB down, and at least long enough for the whole delay line to have been overwritten with silence,
+   //so nothing stale comes back out if the delay time changes while we're not being processed
+   float delaySamples = MAX(mDelay, GetMinDelayMs()) / gInvSampleRateMs;
+   int repeats = 1;
+   if (mEcho && fabsf(mFeedback) > .0001f)
+      repeats = (int)ceilf(logf(.0001f) / logf(fabsf(mFeedback)));
+   double echoSamples = (double)delaySamples * (repeats + 1);
+   return (int)MIN(MAX(echoSamples, (double)DELAY_BUFFER_SIZE), (double)(std::numeric_limits<int>::max() / 4));
+}
+
 void DelayEffect::SetDelay(float delay)
 {
    mDelay = delay;
@@ -199,7 +289,27 @@ void DelayEffect::SetEnabled(bool enabled)
 {
    mEnabled = enabled;
    if (!enabled)
-      mDelayBuffer.ClearBuffer();
+      mDelayLine.GetBuffer().ClearBuffer();
+}
+
+void DelayEffect::Hibernate()
+{
+   ScopedMutex mutex(TheSynth->GetAudioMutex(), "DelayEffect::Hibernate()");
+   mDelayLine.GetBuffer().GetRawBuffer()->ReleaseChannels();
+}
+
+void DelayEffect::Wake()
+{
+   //allocate the line here rather than on the audio thread, the first time it's written to
+   ScopedMutex mutex(TheSynth->GetAudioMutex(), "DelayEffect::Wake()");
+   mDelayLine.GetBuffer().GetRawBuffer()->AllocateChannels();
+}
+
+void DelayEffect::Prewarm()
+{
+   //same as waking up, for a delay that has never run. it might be running already, so whatever is in the line stays
+   ScopedMutex mutex(TheSynth->GetAudioMutex(), "DelayEffect::Prewarm()");
+   mDelayLine.GetBuffer().GetRawBuffer()->AllocateChannels();
 }
 
 void DelayEffect::CheckboxUpdated(Checkbox* checkbox, double time)
@@ -209,7 +319,7 @@ void DelayEffect::CheckboxUpdated(Checkbox* checkbox, double time)
    if (checkbox == mEnabledCheckbox)
    {
       if (!mEnabled)
-         mDelayBuffer.ClearBuffer();
+         mDelayLine.GetBuffer().ClearBuffer();
    }
 }
 
@@ -232,7 +342,7 @@ void DelayEffect::SaveState(FileStreamOut& out)
 
    IDrawableModule::SaveState(out);
 
-   mDelayBuffer.SaveState(out);
+   mDelayLine.GetBuffer().SaveState(out);
 }
 
 void DelayEffect::LoadState(FileStreamIn& in, int rev)
@@ -243,5 +353,5 @@ void DelayEffect::LoadState(FileStreamIn& in, int rev)
       in >> rev;
    LoadStateValidate(rev <= GetModuleSaveStateRev());
 
-   mDelayBuffer.LoadState(in);
+   mDelayLine.GetBuffer().LoadState(in);
 }
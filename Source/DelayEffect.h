@@ -26,7 +26,7 @@
 #pragma once
 
 #include "IAudioEffect.h"
-#include "RollingBuffer.h"
+#include "DelayLine.h"
 #include "Slider.h"
 #include "Checkbox.h"
 #include "DropdownList.h"
@@ -45,11 +45,13 @@ public:
 
    void CreateUIControls() override;
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override { return mDelayLine.GetBuffer().GetMemoryUsage(); }
+   bool CanHibernate() const override { return GetMemoryUsage() > 0; }
 
    void SetDelay(float delay);
    void SetShortMode(bool on);
    void SetFeedback(float feedback) { mFeedback = feedback; }
-   void Clear() { mDelayBuffer.ClearBuffer(); }
+   void Clear() { mDelayLine.GetBuffer().ClearBuffer(); }
    void SetDry(bool dry) { mDry = dry; }
    void SetFeedbackModuleMode();
 
@@ -58,6 +60,8 @@ public:
    void SetEnabled(bool enabled) override;
    float GetEffectAmount() override;
    std::string GetType() override { return "delay"; }
+   int GetTailLengthSamples() override;
+   void ResetAudioState() override { Clear(); }
 
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
@@ -69,14 +73,22 @@ public:
 
 private:
    //IDrawableModule
+   void Hibernate() override; //the line is cleared when the delay is disabled, so there's nothing to keep
+   void Wake() override;
+   void Prewarm() override;
    void DrawModule() override;
 
    float GetMinDelayMs() const;
+   float GetDelaySamples(double time);
+   void ProcessBlock(double time, ChannelBuffer* buffer, float delaySamples);
+   void ProcessSamples(double time, ChannelBuffer* buffer);
 
    float mDelay{ 500 };
    float mFeedback{ 0 };
    bool mEcho{ true };
-   RollingBuffer mDelayBuffer;
+   DelayLine mDelayLine;
+   float mLastDelaySamples{ -1 }; //where the last buffer's delay ended up, to ramp on from
+   std::vector<float> mDelayed;
    FloatSlider* mFeedbackSlider{ nullptr };
    FloatSlider* mDelaySlider{ nullptr };
    Checkbox* mEchoCheckbox{ nullptr };
@@ -0,0 +1,151 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    DelayLine.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "DelayLine.h"
+#include "Profiler.h"
+#include "SynthGlobals.h"
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+DelayLine::DelayLine(int maxDelaySamples)
+: mBuffer(maxDelaySamples + 2, K(roundUpToPowerOfTwo))
+{
+}
+
+float DelayLine::Read(float delaySamples, int channel)
+{
+   delaySamples = ofClamp(delaySamples, kMinDelaySamples, GetMaxDelaySamples());
+   int samplesAgo = int(delaySamples);
+   float a = delaySamples - samplesAgo;
+   float sample = mBuffer.GetSample(samplesAgo, channel);
+   float nextSample = mBuffer.GetSample(samplesAgo + 1, channel);
+   return (1 - a) * sample + a * nextSample;
+}
+
+void DelayLine::ReadTaps(const Tap* taps, int numTaps, float* out, float* send, int bufferSize, int channel)
+{
+   PROFILER(DelayLine);
+
+   if (bufferSize <= 0)
+      return;
+
+   for (int t = 0; t < numTaps; ++t)
+   {
+      const Tap& tap = taps[t];
+      bool sends = send != nullptr && (tap.mSendFrom != 0 || tap.mSendTo != 0);
+      if (tap.mGainFrom == 0 && tap.mGainTo == 0 && !sends)
+         continue;
+
+      if (tap.mDelayFrom != tap.mDelayTo || !ReadContiguous(tap, out, sends ? send : nullptr, bufferSize, channel))
+         ReadRamped(tap, out, sends ? send : nullptr, bufferSize, channel);
+   }
+}
+
+void DelayLine::ReadRamped(const Tap& tap, float* out, float* send, int bufferSize, int channel)
+{
+   const float* data = mBuffer.GetRawBuffer()->GetChannelReadOnly(channel);
+   const int now = mBuffer.GetRawBufferOffset(channel);
+   const float maxDelay = GetMaxDelaySamples();
+   const float invBufferSize = 1.0f / bufferSize;
+   const float delayInc = (tap.mDelayTo - tap.mDelayFrom) * invBufferSize;
+   const float gainInc = (tap.mGainTo - tap.mGainFrom) * invBufferSize;
+   const float sendInc = (tap.mSendTo - tap.mSendFrom) * invBufferSize;
+
+   float delay = tap.mDelayFrom;
+   float gain = tap.mGainFrom;
+   float sendGain = tap.mSendFrom;
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      float samplesAgo = ofClamp(delay - i, kMinDelaySamples, maxDelay);
+      int whole = int(samplesAgo);
+      float a = samplesAgo - whole;
+      float sample = data[mBuffer.WrapIndex(now - whole)];
+      float older = data[mBuffer.WrapIndex(now - whole - 1)];
+      float delayed = sample + (older - sample) * a;
+
+      out[i] += delayed * gain;
+      if (send)
+         send[i] += delayed * sendGain;
+
+      delay += delayInc;
+      gain += gainInc;
+      sendGain += sendInc;
+   }
+}
+
+//a fixed delay reads a run of consecutive samples, all with the same interpolation weight. returns false if that run isn't
+//one piece of the buffer, or would need clamping
+bool DelayLine::ReadContiguous(const Tap& tap, float* out, float* send, int bufferSize, int channel)
+{
+   float delay = tap.mDelayFrom;
+   if (delay - (bufferSize - 1) < 1 || delay > GetMaxDelaySamples())
+      return false;
+
+   int whole = int(delay);
+   float a = delay - whole;
+   int start = mBuffer.GetRawBufferOffset(channel) - whole - 1; //the older sample of the first pair
+   if (start < 0)
+      start += mBuffer.Size();
+   if (start < 0 || start + bufferSize + 1 > mBuffer.Size())
+      return false;
+
+   const float* older = mBuffer.GetRawBuffer()->GetChannelReadOnly(channel) + start;
+   const float* samples = older + 1;
+   const float invBufferSize = 1.0f / bufferSize;
+   const float gainInc = (tap.mGainTo - tap.mGainFrom) * invBufferSize;
+   const float sendInc = (tap.mSendTo - tap.mSendFrom) * invBufferSize;
+
+   int i = 0;
+#if defined(__wasm_simd128__)
+   v128_t vA = wasm_f32x4_splat(a);
+   v128_t gain = wasm_f32x4_make(tap.mGainFrom, tap.mGainFrom + gainInc, tap.mGainFrom + gainInc * 2, tap.mGainFrom + gainInc * 3);
+   v128_t gainStep = wasm_f32x4_splat(gainInc * 4);
+   v128_t sendGain = wasm_f32x4_make(tap.mSendFrom, tap.mSendFrom + sendInc, tap.mSendFrom + sendInc * 2, tap.mSendFrom + sendInc * 3);
+   v128_t sendStep = wasm_f32x4_splat(sendInc * 4);
+   for (; i + 4 <= bufferSize; i += 4)
+   {
+      v128_t sample = wasm_v128_load(samples + i);
+      v128_t delayed = wasm_f32x4_add(sample, wasm_f32x4_mul(wasm_f32x4_sub(wasm_v128_load(older + i), sample), vA));
+      wasm_v128_store(out + i, wasm_f32x4_add(wasm_v128_load(out + i), wasm_f32x4_mul(delayed, gain)));
+      if (send)
+         wasm_v128_store(send + i, wasm_f32x4_add(wasm_v128_load(send + i), wasm_f32x4_mul(delayed, sendGain)));
+      gain = wasm_f32x4_add(gain, gainStep);
+      sendGain = wasm_f32x4_add(sendGain, sendStep);
+   }
+#endif
+
+   for (; i < bufferSize; ++i)
+   {
+      float delayed = samples[i] + (older[i] - samples[i]) * a;
+      out[i] += delayed * (tap.mGainFrom + gainInc * i);
+      if (send)
+         send[i] += delayed * (tap.mSendFrom + sendInc * i);
+   }
+
+   return true;
+}
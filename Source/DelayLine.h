@@ -0,0 +1,68 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    DelayLine.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "RollingBuffer.h"
+
+//a delay buffer that any number of taps read from a block at a time. each tap's delay is ramped linearly across the block
+//from where it was to where it's headed, so modulated delay times only need working out once per block, and a tap that
+//holds still over a stretch of buffer that doesn't wrap is a straight vector interpolation instead of a lookup per sample
+class DelayLine
+{
+public:
+   struct Tap
+   {
+      float mDelayFrom{ 1 }; //in samples, at the first sample of the block
+      float mDelayTo{ 1 }; //where the ramp is headed, reached at the first sample of the next block
+      float mGainFrom{ 1 };
+      float mGainTo{ 1 };
+      float mSendFrom{ 0 }; //a second gain, for taps that feed back or go somewhere else too
+      float mSendTo{ 0 };
+   };
+
+   explicit DelayLine(int maxDelaySamples);
+
+   //the buffer underneath, for writing, drawing, clearing and saving
+   RollingBuffer& GetBuffer() { return mBuffer; }
+   const RollingBuffer& GetBuffer() const { return mBuffer; }
+   int GetMaxDelaySamples() const { return mBuffer.Size() - 2; }
+
+   //interpolated, delaySamples behind the buffer's write position
+   float Read(float delaySamples, int channel);
+
+   //adds each tap into out (and with its send gain, into send if there is one). output sample i is read as if it sits i
+   //samples after the write position, so a tap delayed by d reads d - i samples back from there
+   void ReadTaps(const Tap* taps, int numTaps, float* out, float* send, int bufferSize, int channel);
+
+   static constexpr float kMinDelaySamples = .1f;
+
+private:
+   void ReadRamped(const Tap& tap, float* out, float* send, int bufferSize, int channel);
+   bool ReadContiguous(const Tap& tap, float* out, float* send, int bufferSize, int channel);
+
+   RollingBuffer mBuffer;
+};
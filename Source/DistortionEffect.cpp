@@ -52,6 +52,7 @@ void DistortionEffect::CreateUIControls()
    FLOATSLIDER(mPreampSlider, "preamp", &mPreamp, 1, 10);
    FLOATSLIDER(mFuzzAmountSlider, "fuzz", &mFuzzAmount, -1, 1);
    CHECKBOX(mRemoveInputDCCheckbox, "center input", &mRemoveInputDC);
+   DROPDOWN(mOversampleDropdown, "oversample", &mOversample, 40);
    ENDUIBLOCK(mWidth, mHeight);
 
    mTypeDropdown->AddLabel("clean", kClean);
@@ -61,6 +62,11 @@ void DistortionEffect::CreateUIControls()
    mTypeDropdown->AddLabel("asym", kAsymmetric);
    mTypeDropdown->AddLabel("fold", kFold);
    mTypeDropdown->AddLabel("grungy", kGrungy);
+
+   mOversampleDropdown->AddLabel("1x", 1);
+   mOversampleDropdown->AddLabel("2x", 2);
+   mOversampleDropdown->AddLabel("4x", 4);
+   mOversampleDropdown->AddLabel("8x", 8);
 }
 
 void DistortionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
@@ -70,7 +76,9 @@ void DistortionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
+   int factor = mOversample;
+   mOversampler.SetFactor(factor);
 
    for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
    {
@@ -79,60 +87,66 @@ void DistortionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
 
       mPeakTracker[ch].Process(buffer->GetChannel(ch), bufferSize);
 
+      //only the shaping runs oversampled, that's the part that aliases
+      float* samples = buffer->GetChannel(ch);
+      if (factor > 1)
+         samples = mOversampler.Upsample(ch, samples, bufferSize);
+      int numSamples = bufferSize * factor;
+
       if (mType == kDirty)
       {
-         for (int i = 0; i < bufferSize; ++i)
+         for (int i = 0; i < numSamples; ++i)
          {
-            ComputeSliders(i);
-            buffer->GetChannel(ch)[i] = (ofClamp((buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -1, 1)) / mGain;
+            ComputeSliders(i / factor);
+            samples[i] = (ofClamp((samples[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -1, 1)) / mGain;
          }
       }
       else if (mType == kClean)
       {
-         for (int i = 0; i < bufferSize; ++i)
+         for (int i = 0; i < numSamples; ++i)
          {
-            ComputeSliders(i);
-            buffer->GetChannel(ch)[i] = tanh((buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain) / mGain;
+            ComputeSliders(i / factor);
+            samples[i] = tanh((samples[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain) / mGain;
          }
       }
       else if (mType == kWarm)
       {
-         for (int i = 0; i < bufferSize; ++i)
+         for (int i = 0; i < numSamples; ++i)
          {
-            ComputeSliders(i);
-            buffer->GetChannel(ch)[i] = sin((buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain) / mGain;
+            ComputeSliders(i / factor);
+            samples[i] = sin((samples[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain) / mGain;
          }
       }
       else if (mType == kGrungy)
       {
-         for (int i = 0; i < bufferSize; ++i)
+         for (int i = 0; i < numSamples; ++i)
          {
-            ComputeSliders(i);
-            buffer->GetChannel(ch)[i] = asin(ofClamp((buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -1, 1)) / mGain;
+            ComputeSliders(i / factor);
+            samples[i] = asin(ofClamp((samples[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -1, 1)) / mGain;
          }
       }
       //soft and asymmetric from http://www.music.mcgill.ca/~gary/courses/projects/618_2009/NickDonaldson/#Distortion
       else if (mType == kSoft)
       {
-         for (int i = 0; i < bufferSize; ++i)
+         for (int i = 0; i < numSamples; ++i)
          {
-            ComputeSliders(i);
-            float sample = (buffer->GetChannel(ch)[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain;
+            ComputeSliders(i / factor);
+            float sample = (samples[i] + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain;
             if (sample > 1)
                sample = .66666f;
             else if (sample < -1)
                sample = -.66666f;
             else
                sample = sample - (sample * sample * sample) / 3.0f;
-            buffer->GetChannel(ch)[i] = sample / mGain;
+            samples[i] = sample / mGain;
          }
       }
       else if (mType == kAsymmetric)
       {
-         for (int i = 0; i < bufferSize; ++i)
+         for (int i = 0; i < numSamples; ++i)
          {
-            ComputeSliders(i);
-            float sample = (buffer->GetChannel(ch)[i] * .5f + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain;
+            ComputeSliders(i / factor);
+            float sample = (samples[i] * .5f + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain;
             if (sample >= .320018f)
                sample = .630035f;
             else if (sample >= -.08905f)
@@ -141,15 +155,15 @@ void DistortionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
                sample = -.75f * (1 - powf(1 - (fabsf(sample) - .032847f), 12) + .333f * (fabsf(sample) - .032847f)) + .01f;
             else
                sample = -.9818f;
-            buffer->GetChannel(ch)[i] = sample / mGain;
+            samples[i] = sample / mGain;
          }
       }
       else if (mType == kFold)
       {
-         for (int i = 0; i < bufferSize; ++i)
+         for (int i = 0; i < numSamples; ++i)
          {
-            ComputeSliders(i);
-            float sample = ofClamp((buffer->GetChannel(ch)[i] * .5f + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -100, 100);
+            ComputeSliders(i / factor);
+            float sample = ofClamp((samples[i] * .5f + mFuzzAmount * mPeakTracker[ch].GetPeak()) * mPreamp * mGain, -100, 100);
             while (sample > 1 || sample < -1)
             {
                if (sample > 1)
@@ -157,9 +171,12 @@ void DistortionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
                if (sample < -1)
                   sample = -2 - sample;
             }
-            buffer->GetChannel(ch)[i] = sample / mGain;
+            samples[i] = sample / mGain;
          }
       }
+
+      if (factor > 1)
+         mOversampler.Downsample(ch, samples, buffer->GetChannel(ch), bufferSize);
    }
 }
 
@@ -179,6 +196,7 @@ void DistortionEffect::DrawModule()
    mPreampSlider->Draw();
    mRemoveInputDCCheckbox->Draw();
    mFuzzAmountSlider->Draw();
+   mOversampleDropdown->Draw();
 }
 
 float DistortionEffect::GetEffectAmount()
@@ -194,6 +212,7 @@ void DistortionEffect::CheckboxUpdated(Checkbox* checkbox, double time)
    {
       for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
          mDCRemover[i].Clear();
+      mOversampler.Reset();
    }
 }
 
@@ -31,6 +31,7 @@
 #include "DropdownList.h"
 #include "BiquadFilter.h"
 #include "PeakTracker.h"
+#include "Oversampler.h"
 
 class DistortionEffect : public IAudioEffect, public IFloatSliderListener, public IDropdownListener
 {
@@ -77,12 +78,15 @@ private:
    float mPreamp{ 1 };
    float mFuzzAmount{ 0 };
    bool mRemoveInputDC{ false };
+   int mOversample{ 1 };
 
    DropdownList* mTypeDropdown{ nullptr };
    FloatSlider* mClipSlider{ nullptr };
    FloatSlider* mPreampSlider{ nullptr };
    Checkbox* mRemoveInputDCCheckbox{ nullptr };
    FloatSlider* mFuzzAmountSlider{ nullptr };
+   DropdownList* mOversampleDropdown{ nullptr };
    BiquadFilter mDCRemover[ChannelBuffer::kMaxNumChannels]{};
    PeakTracker mPeakTracker[ChannelBuffer::kMaxNumChannels]{};
+   Oversampler mOversampler;
 };
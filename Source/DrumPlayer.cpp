@@ -50,6 +50,8 @@ void DrumPlayer::Init()
    IDrawableModule::Init();
 
    TheTransport->AddListener(this, mQuantizeInterval, OffsetInfo(0, true), false);
+
+   PreloadKits();
 }
 
 DrumPlayer::~DrumPlayer()
@@ -240,7 +242,11 @@ void DrumPlayer::LoadKit(int kit)
       LoadSampleLock();
       for (int i = 0; i < NUM_DRUM_HITS; ++i)
       {
-         mDrumHits[i].mSample.Read(mKits[kit].mSampleFiles[i].c_str());
+         Sample* preloaded = kit < mPreloadedKits.size() ? &(*mPreloadedKits[kit])[i] : nullptr;
+         if (preloaded != nullptr && preloaded->LengthInSamples() > 0 && !preloaded->IsSampleLoading())
+            mDrumHits[i].mSample.CopyFrom(preloaded); //shares the decoded data, nothing to read
+         else
+            mDrumHits[i].mSample.Read(mKits[kit].mSampleFiles[i].c_str());
          mDrumHits[i].mLinkId = mKits[kit].mLinkIds[i];
          mDrumHits[i].mVol = mKits[kit].mVols[i];
          mDrumHits[i].mSpeed = mKits[kit].mSpeeds[i];
@@ -295,8 +301,8 @@ void DrumPlayer::Process(double time)
       for (int i = 0; i < NUM_DRUM_HITS; ++i)
       {
          int individualOutputIndex = GetIndividualOutputIndex(i);
-         gWorkChannelBuffer.SetNumActiveChannels(numChannels);
-         if (mDrumHits[i].Process(time, mSpeed, volSq, &gWorkChannelBuffer, bufferSize))
+         gWorkChannelBuffer->SetNumActiveChannels(numChannels);
+         if (mDrumHits[i].Process(time, mSpeed, volSq, gWorkChannelBuffer, bufferSize))
          {
             for (int ch = 0; ch < numChannels; ++ch)
             {
@@ -305,12 +311,12 @@ void DrumPlayer::Process(double time)
                   int targetIndex = individualOutputIndex + 1;
                   IAudioReceiver* targetOut = GetTarget(targetIndex);
                   if (targetOut)
-                     Add(targetOut->GetBuffer()->GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), bufferSize);
-                  mIndividualOutputs[individualOutputIndex]->mVizBuffer->WriteChunk(gWorkChannelBuffer.GetChannel(ch), bufferSize, ch);
+                     Add(targetOut->GetBuffer()->GetChannel(ch), gWorkChannelBuffer->GetChannel(ch), bufferSize);
+                  mIndividualOutputs[individualOutputIndex]->mVizBuffer->WriteChunk(gWorkChannelBuffer->GetChannel(ch), bufferSize, ch);
                }
                else
                {
-                  Add(mOutputBuffer.GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), bufferSize);
+                  Add(mOutputBuffer.GetChannel(ch), gWorkChannelBuffer->GetChannel(ch), bufferSize);
                }
             }
          }
@@ -339,8 +345,32 @@ void DrumPlayer::Process(double time)
 
 void DrumPlayer::DrumHit::StartPlayhead(double time, float startOffsetPercent, float velocity)
 {
-   mCurrentPlayheadIndex = (mCurrentPlayheadIndex + 1) % mPlayheads.size();
-   for (size_t i = 0; i < mPlayheads.size(); ++i)
+   //a free playhead if there is one, otherwise the one that's been releasing the longest, otherwise the oldest
+   int index = -1;
+   for (int i = 0; i < (int)mPlayheads.size(); ++i)
+   {
+      if (mPlayheads[i].mStartTime == -1 || mPlayheads[i].mOffset >= mSample.LengthInSamples())
+      {
+         index = i;
+         break;
+      }
+   }
+   if (index == -1)
+   {
+      index = 0;
+      for (int i = 1; i < (int)mPlayheads.size(); ++i)
+      {
+         const Playhead& check = mPlayheads[i];
+         const Playhead& best = mPlayheads[index];
+         if (check.mCutOffTime != -1 && (best.mCutOffTime == -1 || check.mCutOffTime < best.mCutOffTime))
+            index = i;
+         else if (check.mCutOffTime == -1 && best.mCutOffTime == -1 && check.mStartTime < best.mStartTime)
+            index = i;
+      }
+   }
+
+   mCurrentPlayheadIndex = index;
+   for (int i = 0; i < (int)mPlayheads.size(); ++i)
    {
       if (i == mCurrentPlayheadIndex)
       {
@@ -350,8 +380,9 @@ void DrumPlayer::DrumHit::StartPlayhead(double time, float startOffsetPercent, f
          mPlayheads[i].mEnvelopeTime = 0;
          mPlayheads[i].mEnvelopeScale = ofLerp(.2f, 1, velocity);
          mPlayheads[i].mSpeedTweak = ofRandom(1 - mOwner->mSpeedRandomization, 1 + mOwner->mSpeedRandomization);
+         mPlayheads[i].mVelocity = mVelocity;
       }
-      else
+      else if (mPlayheads[i].mCutOffTime == -1)
       {
          mPlayheads[i].mCutOffTime = time;
       }
@@ -403,23 +434,22 @@ bool DrumPlayer::DrumHit::Process(double time, float speed, float vol, ChannelBu
       {
          if (mPlayheads[playhead].mStartTime != -1 && time > mPlayheads[playhead].mStartTime && mPlayheads[playhead].mOffset < mSample.LengthInSamples())
          {
+            float gain = mPlayheads[playhead].mVelocity * vol * mVol * mVol;
+            if (mUseEnvelope)
+               gain *= mEnvelope.Value(mPlayheads[playhead].mEnvelopeTime);
+
+            if (mPlayheads[playhead].mCutOffTime != -1 && time > mPlayheads[playhead].mCutOffTime)
+            {
+               float fade = ofMap(time - mPlayheads[playhead].mCutOffTime, 0, kReleaseMs, 1, 0, K(clamp));
+               gain *= fade * fade;
+               if (fade == 0)
+                  mPlayheads[playhead].mStartTime = -1;
+            }
+
             for (int ch = 0; ch < out->NumActiveChannels(); ++ch)
             {
                int dataChannel = MIN(ch, sampleData->NumActiveChannels() - 1);
-               float sample = GetInterpolatedSample(mPlayheads[playhead].mOffset, sampleData->GetChannel(dataChannel), mSample.LengthInSamples());
-               sample *= mVelocity * vol * mVol * mVol;
-               if (mUseEnvelope)
-                  sample *= mEnvelope.Value(mPlayheads[playhead].mEnvelopeTime);
-
-               if (mPlayheads[playhead].mCutOffTime != -1 && time > mPlayheads[playhead].mCutOffTime)
-               {
-                  float fade = ofMap(time - mPlayheads[playhead].mCutOffTime, 0, .25f, 1, 0, K(clamp));
-                  sample *= fade;
-                  if (fade == 0)
-                     mPlayheads[playhead].mStartTime = -1;
-               }
-
-               gWorkBuffer[ch] += sample;
+               gWorkBuffer[ch] += GetInterpolatedSample(mPlayheads[playhead].mOffset, sampleData->GetChannel(dataChannel), mSample.LengthInSamples()) * gain;
             }
 
             mPlayheads[playhead].mOffset += sampleSpeed * mPlayheads[playhead].mSpeedTweak * mSample.GetSampleRateRatio();
@@ -1027,6 +1057,22 @@ void DrumPlayer::ReadKits()
    }
 }
 
+//decodes every hit of every kit on SampleLoader's threads. the data goes through SampleCache, so other drumplayers share it
+void DrumPlayer::PreloadKits()
+{
+   mPreloadedKits.clear();
+   for (const auto& kit : mKits)
+   {
+      auto samples = std::make_unique<std::array<Sample, NUM_DRUM_HITS>>();
+      for (int i = 0; i < NUM_DRUM_HITS; ++i)
+      {
+         if (!kit.mSampleFiles[i].empty() && File(ofToSamplePath(kit.mSampleFiles[i])).existsAsFile())
+            (*samples)[i].Read(kit.mSampleFiles[i].c_str(), false, Sample::ReadType::Async);
+      }
+      mPreloadedKits.push_back(std::move(samples));
+   }
+}
+
 void DrumPlayer::CreateKit()
 {
    StoredDrumKit kit;
@@ -1039,6 +1085,10 @@ void DrumPlayer::CreateKit()
    }
 
    mKits.push_back(kit);
+   auto samples = std::make_unique<std::array<Sample, NUM_DRUM_HITS>>();
+   for (int i = 0; i < NUM_DRUM_HITS; ++i)
+      (*samples)[i].CopyFrom(&mDrumHits[i].mSample);
+   mPreloadedKits.push_back(std::move(samples));
    mLoadedKit = (int)mKits.size() - 1;
    mKitSelector->AddLabel(kit.mName.c_str(), mLoadedKit);
 }
@@ -1090,8 +1140,8 @@ void DrumPlayer::FloatSliderUpdated(FloatSlider* slider, float oldVal, double ti
             LoadSampleLock();
             mDrumHits[mSelectedHitIdx].mSample.Read(file.c_str());
             LoadSampleUnlock();
-            mDrumHits[mSelectedHitIdx].StartPlayhead(time, 0, 1);
             mDrumHits[mSelectedHitIdx].mVelocity = .5f;
+            mDrumHits[mSelectedHitIdx].StartPlayhead(time, 0, 1);
             mDrumHits[mSelectedHitIdx].mEnvelopeLength = mDrumHits[mSelectedHitIdx].mSample.LengthInSamples() * gInvSampleRateMs;
          }
       }
@@ -123,6 +123,7 @@ private:
    void LoadKit(int kit);
    int GetAssociatedSampleIndex(int x, int y);
    void ReadKits();
+   void PreloadKits();
    void SaveKits();
    void CreateKit();
    void ShuffleKit();
@@ -150,6 +151,7 @@ private:
    bool mEditMode{ false };
    Checkbox* mEditCheckbox{ nullptr };
    std::vector<StoredDrumKit> mKits;
+   std::vector<std::unique_ptr<std::array<Sample, NUM_DRUM_HITS>>> mPreloadedKits; //decoded in the background, so switching kits only has to share their data
    ClickButton* mSaveButton{ nullptr };
    ClickButton* mNewKitButton{ nullptr };
    int mAuditionSampleIdx{ 0 };
@@ -217,13 +219,16 @@ private:
       struct Playhead
       {
          double mStartTime{ -1 };
-         double mCutOffTime{ -1 };
+         double mCutOffTime{ -1 }; //when it starts releasing
          double mOffset{ 0 };
          double mEnvelopeTime{ 0 };
          double mEnvelopeScale{ 1 };
          float mSpeedTweak{ 1 };
+         float mVelocity{ 1 };
       };
 
+      static constexpr float kReleaseMs = 10; //how quickly a retriggered or choked hit fades out
+
       DrumHit()
       {
          mEnvelope.GetHasSustainStage() = false;
@@ -283,7 +288,7 @@ private:
       RollingBuffer mWidenerBuffer{ 2048 };
       int mSamplesRemainingToProcess{ 0 };
 
-      std::array<Playhead, 2> mPlayheads;
+      std::array<Playhead, 4> mPlayheads; //enough for the releases of a fast roll to overlap
       int mCurrentPlayheadIndex{ 0 };
    };
 
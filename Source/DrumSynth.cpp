@@ -109,14 +109,9 @@ void DrumSynth::Process(double time)
 
             mHits[i]->Process(time, gWorkBuffer, hitBufferSize, oversampling, sampleRate, sampleIncrementMs);
 
-            //assume power-of-two
-            while (hitOversampling > 1)
-            {
-               for (int j = 0; j < hitBufferSize; ++j)
-                  gWorkBuffer[j] = (gWorkBuffer[j * 2] + gWorkBuffer[j * 2 + 1]) / 2;
-               hitOversampling /= 2;
-               hitBufferSize /= 2;
-            }
+            hitBufferSize /= hitOversampling;
+            mHits[i]->mOversampler.SetFactor(hitOversampling);
+            mHits[i]->mOversampler.Downsample(0, gWorkBuffer, gWorkBuffer, hitBufferSize);
 
             Mult(gWorkBuffer, volSq, hitBufferSize);
             auto* targetBuffer = GetTarget(i + 1)->GetBuffer();
@@ -136,14 +131,9 @@ void DrumSynth::Process(double time)
       for (size_t i = 0; i < mHits.size(); ++i)
          mHits[i]->Process(time, gWorkBuffer, bufferSize, oversampling, sampleRate, sampleIncrementMs);
 
-      //assume power-of-two
-      while (oversampling > 1)
-      {
-         for (int i = 0; i < bufferSize; ++i)
-            gWorkBuffer[i] = (gWorkBuffer[i * 2] + gWorkBuffer[i * 2 + 1]) / 2;
-         oversampling /= 2;
-         bufferSize /= 2;
-      }
+      bufferSize /= oversampling;
+      mOversampler.SetFactor(oversampling);
+      mOversampler.Downsample(0, gWorkBuffer, gWorkBuffer, bufferSize);
 
       Mult(gWorkBuffer, volSq, bufferSize);
 
@@ -39,6 +39,7 @@
 #include "BiquadFilter.h"
 #include "TextEntry.h"
 #include "PatchCableSource.h"
+#include "Oversampler.h"
 
 class MidiController;
 class ADSRDisplay;
@@ -135,6 +136,7 @@ private:
       int mX{ 0 };
       int mY{ 0 };
       BiquadFilter mFilter;
+      Oversampler mOversampler; //for its individual output
 
       IndividualOutput* mIndividualOutput{ nullptr };
    };
@@ -177,4 +179,5 @@ private:
    bool mUseIndividualOuts{ false };
    bool mMonoOutput{ false };
    int mOversampling{ 1 };
+   Oversampler mOversampler; //for the mixed output
 };
@@ -0,0 +1,481 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    DspBenchmark.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "DspBenchmark.h"
+#include "ADSR.h"
+#include "BiquadFilter.h"
+#include "ChannelBuffer.h"
+#include "DelayLine.h"
+#include "EffectFactory.h"
+#include "FFT.h"
+#include "FMVoice.h"
+#include "IAudioEffect.h"
+#include "KarplusStrongVoice.h"
+#include "ModularSynth.h"
+#include "OnsetIndex.h"
+#include "Sample.h"
+#include "SampleVoice.h"
+#include "SingleOscillatorVoice.h"
+#include "SynthGlobals.h"
+#include "Transport.h"
+#include "VocoderFilterBank.h"
+#include "ofxJSONElement.h"
+
+#include <memory>
+
+namespace
+{
+   const int kWarmupCalls = 16;
+
+   class CountingListener : public ITimeListener
+   {
+   public:
+      void OnTimeEvent(double time) override { ++mCount; }
+      int mCount{ 0 };
+   };
+
+   void FillInput(ChannelBuffer& buffer, const std::vector<float>& input, int bufferSize)
+   {
+      for (int ch = 0; ch < buffer.NumActiveChannels(); ++ch)
+         BufferCopy(buffer.GetChannel(ch), input.data() + ch, bufferSize);
+   }
+}
+
+DspBenchmark::DspBenchmark(std::vector<int> bufferSizes, double minTimeMs, std::string filter)
+: mBufferSizes(std::move(bufferSizes))
+, mMinTimeMs(minTimeMs)
+, mFilter(std::move(filter))
+{
+   int maxBufferSize = 0;
+   for (int bufferSize : mBufferSizes)
+      maxBufferSize = MAX(maxBufferSize, bufferSize);
+
+   //-12dB white noise, with one extra sample so the right channel can read it offset by one
+   mNoise.resize(maxBufferSize + 1);
+   for (auto& sample : mNoise)
+      sample = ofRandom(-.25f, .25f);
+}
+
+bool DspBenchmark::ShouldRun(const std::string& name) const
+{
+   return mFilter.empty() || name.find(mFilter) != std::string::npos;
+}
+
+void DspBenchmark::Time(std::string name, int bufferSize, std::function<void(int)> process)
+{
+   if (!ShouldRun(name))
+      return;
+
+   //moves time forward like the audio thread does, so envelopes and the transport behave like they do live
+   auto call = [&]()
+   {
+      process(bufferSize);
+      gTime += bufferSize * gInvSampleRateMs;
+   };
+
+   for (int i = 0; i < kWarmupCalls; ++i)
+      call();
+
+   const long minTimeNs = long(mMinTimeMs * 1000000);
+   long calls = 0;
+   long start = ofGetSystemTimeNanos();
+   long elapsed = 0;
+   do
+   {
+      //check the clock every few calls, so that reading it doesn't weigh on the tiny kernels
+      for (int i = 0; i < 8; ++i)
+         call();
+      calls += 8;
+      elapsed = ofGetSystemTimeNanos() - start;
+   } while (elapsed < minTimeNs);
+
+   Result result;
+   result.mName = name;
+   result.mBufferSize = bufferSize;
+   result.mNsPerCall = double(elapsed) / calls;
+   result.mNsPerSample = result.mNsPerCall / bufferSize;
+   mResults.push_back(result);
+
+   //progress goes to stderr, so stdout only has the json
+   fprintf(stderr, "%-32s %5d  %10.1f ns/call  %8.3f ns/sample\n", name.c_str(), bufferSize, result.mNsPerCall, result.mNsPerSample);
+}
+
+void DspBenchmark::RunAll()
+{
+   for (int bufferSize : mBufferSizes)
+   {
+      RunBufferOps(bufferSize);
+      RunBiquad(bufferSize);
+      RunFFT(bufferSize);
+      RunInterpolatedSample(bufferSize);
+      RunAdsr(bufferSize);
+      RunTransportListeners(bufferSize);
+      RunVoices(bufferSize);
+      RunEffects(bufferSize);
+   }
+}
+
+void DspBenchmark::WriteResults(ofxJSONElement& root) const
+{
+   root["kernels"].resize(0);
+   for (int i = 0; i < (int)mResults.size(); ++i)
+   {
+      root["kernels"][i]["name"] = mResults[i].mName;
+      root["kernels"][i]["bufferSize"] = mResults[i].mBufferSize;
+      root["kernels"][i]["nsPerCall"] = mResults[i].mNsPerCall;
+      root["kernels"][i]["nsPerSample"] = mResults[i].mNsPerSample;
+   }
+}
+
+void DspBenchmark::RunBufferOps(int bufferSize)
+{
+   //the input copy that the effect benchmarks pay for on every call, to compare the cheap effects against
+   ChannelBuffer buffer(bufferSize);
+   buffer.SetNumActiveChannels(2);
+   Time("buffer_copy", bufferSize, [&](int size)
+        {
+           FillInput(buffer, mNoise, size);
+        });
+
+   std::vector<float> output(bufferSize);
+   Time("buffer_mult_add", bufferSize, [&](int size)
+        {
+           Mult(output.data(), .99f, size);
+           Add(output.data(), mNoise.data(), size);
+        });
+
+   //an effect chain's dry/wet blend, with the mix moving
+   Time("buffer_mix_ramp", bufferSize, [&](int size)
+        {
+           MixRamp(output.data(), mNoise.data(), .3f, .7f, size);
+        });
+
+   //a splitter feeding eight receivers that only read what they get. at the global buffer size they share the splitter's block,
+   //at the smaller sizes (which don't come from the arena) each one falls back to summing in a copy
+   std::vector<ChannelBuffer> receivers;
+   for (int i = 0; i < 8; ++i)
+      receivers.emplace_back(bufferSize);
+   FillInput(buffer, mNoise, bufferSize);
+   Time("buffer_fan_out_8", bufferSize, [&](int size)
+        {
+           for (auto& receiver : receivers)
+           {
+              receiver.SetNumActiveChannels(2);
+              for (int ch = 0; ch < 2; ++ch)
+                 receiver.AddShared(ch, &buffer, ch);
+           }
+           for (auto& receiver : receivers)
+              receiver.Reset();
+        });
+}
+
+void DspBenchmark::RunBiquad(int bufferSize)
+{
+   BiquadFilter filter;
+   filter.SetSampleRate(gSampleRate);
+   filter.SetFilterType(kFilterType_Lowpass);
+   filter.SetFilterParams(1000, sqrt(2) / 2);
+
+   std::vector<float> buffer(bufferSize);
+   Time("biquad_lowpass", bufferSize, [&](int size)
+        {
+           BufferCopy(buffer.data(), mNoise.data(), size);
+           filter.Filter(buffer.data(), size);
+        });
+
+   //a vocoder's worth of band-pass filters, run over the modulator and the carrier
+   for (int numBands : { 16, 64 })
+   {
+      VocoderFilterBank bank;
+      bank.SetNumBands(numBands);
+      for (int i = 0; i < numBands; ++i)
+      {
+         filter.SetFilterType(kFilterType_Bandpass);
+         filter.SetFilterParams(200 * powf(30, float(i) / (numBands - 1)), 40);
+         bank.SetBand(i, filter);
+      }
+
+      Time("vocoder_filter_bank_" + ofToString(numBands), bufferSize, [&](int size)
+           {
+              Clear(buffer.data(), size);
+              bank.Process(mNoise.data(), mNoise.data(), buffer.data(), size);
+           });
+   }
+}
+
+void DspBenchmark::RunFFT(int bufferSize)
+{
+   FFT fft(bufferSize);
+   std::vector<float> re(bufferSize / 2 + 1);
+   std::vector<float> im(bufferSize / 2 + 1);
+   std::vector<float> timeDomain(bufferSize);
+
+   Time("fft_forward", bufferSize, [&](int size)
+        {
+           BufferCopy(timeDomain.data(), mNoise.data(), size);
+           fft.Forward(timeDomain.data(), re.data(), im.data());
+        });
+
+   Time("fft_inverse", bufferSize, [&](int size)
+        {
+           fft.Inverse(re.data(), im.data(), timeDomain.data());
+        });
+
+   //the background transient analysis, per buffer's worth of audio
+   OnsetIndex::Detector detector(gSampleRate);
+   Time("onset_detector", bufferSize, [&](int size)
+        {
+           detector.Process(mNoise.data(), size);
+        });
+}
+
+void DspBenchmark::RunInterpolatedSample(int bufferSize)
+{
+   //read through a second of audio at a speed that lands between samples, like a pitched sample would
+   int tableSize = (int)gSampleRate;
+   std::vector<float> table(tableSize);
+   for (int i = 0; i < tableSize; ++i)
+      table[i] = mNoise[i % bufferSize];
+
+   std::vector<float> output(bufferSize);
+   double offset = 0;
+   Time("interpolated_sample", bufferSize, [&](int size)
+        {
+           for (int i = 0; i < size; ++i)
+           {
+              output[i] = GetInterpolatedSample(offset, table.data(), tableSize);
+              offset += 1.37;
+              if (offset >= tableSize)
+                 offset -= tableSize;
+           }
+        });
+
+   //four delay taps into a second of buffer, the way multitapdelay reads them: fixed, and with the delay swept
+   DelayLine delayLine(tableSize);
+   delayLine.GetBuffer().SetNumChannels(1);
+   DelayLine::Tap taps[4];
+   for (int t = 0; t < 4; ++t)
+   {
+      taps[t].mDelayFrom = taps[t].mDelayTo = (t + 1) * tableSize * .2f + .5f;
+      taps[t].mGainFrom = taps[t].mGainTo = .5f;
+   }
+   Time("delay_line_taps_fixed", bufferSize, [&](int size)
+        {
+           delayLine.GetBuffer().WriteChunk(mNoise.data(), size, 0);
+           Clear(output.data(), size);
+           delayLine.ReadTaps(taps, 4, output.data(), nullptr, size, 0);
+        });
+
+   for (int t = 0; t < 4; ++t)
+      taps[t].mDelayTo = taps[t].mDelayFrom + 10;
+   Time("delay_line_taps_swept", bufferSize, [&](int size)
+        {
+           delayLine.GetBuffer().WriteChunk(mNoise.data(), size, 0);
+           Clear(output.data(), size);
+           delayLine.ReadTaps(taps, 4, output.data(), nullptr, size, 0);
+        });
+}
+
+void DspBenchmark::RunAdsr(int bufferSize)
+{
+   //a note every 300ms, released after 150, so the envelope spends time in every stage
+   ::ADSR adsr(10, 100, .5f, 100);
+   std::vector<float> output(bufferSize);
+   double noteStart = -1000;
+   auto retrigger = [&]()
+   {
+      if (gTime - noteStart > 300)
+      {
+         noteStart = gTime;
+         adsr.Start(gTime, 1);
+         adsr.Stop(gTime + 150);
+      }
+   };
+
+   Time("adsr_value", bufferSize, [&](int size)
+        {
+           retrigger();
+           for (int i = 0; i < size; ++i)
+              output[i] = adsr.Value(gTime + i * gInvSampleRateMs);
+        });
+
+   Time("adsr_render_block", bufferSize, [&](int size)
+        {
+           retrigger();
+           adsr.RenderBlock(gTime, output.data(), size, gInvSampleRateMs);
+        });
+}
+
+void DspBenchmark::RunTransportListeners(int bufferSize)
+{
+   const NoteInterval kIntervals[] = { kInterval_4n, kInterval_8n, kInterval_16n, kInterval_32n, kInterval_8nt, kInterval_16nt };
+   const int kNumIntervals = sizeof(kIntervals) / sizeof(kIntervals[0]);
+
+   for (int numListeners : { 16, 128, 1024 })
+   {
+      std::vector<CountingListener> listeners(numListeners);
+      for (int i = 0; i < numListeners; ++i)
+         TheTransport->AddListener(&listeners[i], kIntervals[i % kNumIntervals], OffsetInfo((i / kNumIntervals) % 4 * 5, true), i % 2 == 0);
+
+      Time("transport_listeners_" + ofToString(numListeners), bufferSize, [&](int size)
+           {
+              TheTransport->Advance(size * gInvSampleRateMs);
+           });
+
+      for (auto& listener : listeners)
+         TheTransport->RemoveListener(&listener);
+   }
+}
+
+void DspBenchmark::RunVoices(int bufferSize)
+{
+   ChannelBuffer out(bufferSize);
+   out.SetNumActiveChannels(2);
+
+   //one voice each, held, so the numbers are the cost of a single sounding note
+   auto runVoice = [&](std::string name, IMidiVoice* voice, IVoiceParams* params)
+   {
+      voice->SetVoiceParams(params);
+      voice->ClearVoice();
+      voice->SetPitch(48);
+      voice->Start(gTime, 1);
+      Time(name, bufferSize, [&](int size)
+           {
+              if (voice->IsDone(gTime))
+              {
+                 voice->ClearVoice();
+                 voice->Start(gTime, 1);
+              }
+              out.Clear();
+              voice->Process(gTime, &out, 1);
+           });
+   };
+
+   {
+      OscillatorVoiceParams params;
+      params.mOscType = kOsc_Saw;
+      params.mFilterCutoffMax = 4000;
+      SingleOscillatorVoice voice;
+      runVoice("voice/singleoscillator", &voice, &params);
+   }
+
+   {
+      OscillatorVoiceParams params;
+      params.mOscType = kOsc_Saw;
+      params.mFilterCutoffMax = 4000;
+      params.mUnison = SingleOscillatorVoice::kMaxUnison;
+      params.mDetune = .2f;
+      params.mUnisonWidth = 1;
+      SingleOscillatorVoice voice;
+      runVoice("voice/singleoscillator_supersaw", &voice, &params);
+   }
+
+   {
+      FMVoiceParams params;
+      params.mOscADSRParams = ::ADSR(10, 0, 1, 10);
+      params.mModIdxADSRParams = ::ADSR(10, 0, 1, 10);
+      params.mHarmRatioADSRParams = ::ADSR(10, 0, 1, 10);
+      params.mModIdxADSRParams2 = ::ADSR(10, 0, 1, 10);
+      params.mHarmRatioADSRParams2 = ::ADSR(10, 0, 1, 10);
+      params.mModIdx = .5f;
+      params.mHarmRatio = 2;
+      params.mModIdx2 = .25f;
+      params.mHarmRatio2 = 3;
+      FMVoice voice;
+      runVoice("voice/fm", &voice, &params);
+   }
+
+   {
+      FMVoiceParams params;
+      params.mMode = kFMMode_Operators;
+      params.mAlgorithm = 0;
+      params.mFeedback = .3f;
+      for (int op = 0; op < kNumFMOperators; ++op)
+      {
+         params.mOperators[op].mADSR = ::ADSR(10, 0, 1, 10);
+         params.mOperators[op].mRatio = op + 1;
+         params.mOperators[op].mLevel = .5f;
+      }
+      FMVoice voice;
+      runVoice("voice/fm_operators", &voice, &params);
+   }
+
+   {
+      KarplusStrongVoiceParams params;
+      KarplusStrongVoice voice;
+      runVoice("voice/karplusstrong", &voice, &params);
+   }
+
+   {
+      //a two second saw, sustain looped so the voice never runs off the end
+      int length = (int)gSampleRate * 2;
+      Sample sample;
+      sample.Create(length);
+      float* data = sample.Data()->GetChannel(0);
+      for (int i = 0; i < length; ++i)
+         data[i] = (i % 200) / 100.0f - 1;
+
+      SampleVoiceParams params;
+      params.mSample = &sample;
+      params.mSustainLoopStart = 0;
+      params.mSustainLoopEnd = length - 1;
+      SampleVoice voice;
+      runVoice("voice/sample", &voice, &params);
+   }
+}
+
+void DspBenchmark::RunEffects(int bufferSize)
+{
+   ChannelBuffer buffer(bufferSize);
+   buffer.SetNumActiveChannels(2);
+
+   EffectFactory* factory = TheSynth->GetEffectFactory();
+   for (const auto& type : factory->GetSpawnableEffects())
+   {
+      std::string name = "effect/" + type;
+      if (!ShouldRun(name))
+         continue;
+
+      //set up the way EffectChain::AddEffect() does it, with default settings
+      std::unique_ptr<IAudioEffect> effect(factory->MakeEffect(type));
+      if (effect == nullptr)
+         continue;
+      effect->SetName(type.c_str());
+      effect->SetTypeName(type, kModuleCategory_Processor);
+      effect->CreateUIControls();
+      ofxJSONElement empty;
+      effect->LoadLayoutBase(empty);
+      effect->SetUpFromSaveDataBase();
+      effect->Init();
+      effect->SetEnabled(true);
+
+      Time(name, bufferSize, [&](int size)
+           {
+              FillInput(buffer, mNoise, size);
+              effect->ProcessAudio(gTime, &buffer);
+           });
+   }
+}
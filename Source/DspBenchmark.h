@@ -0,0 +1,73 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    DspBenchmark.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class ofxJSONElement;
+
+//times the dsp building blocks one at a time, outside of any patch, for bespoke-bench.
+//needs a ModularSynth that has been set up (so TheTransport and TheScale exist), but no window or audio device
+class DspBenchmark
+{
+public:
+   struct Result
+   {
+      std::string mName;
+      int mBufferSize{ 0 };
+      double mNsPerCall{ 0 };
+      double mNsPerSample{ 0 };
+   };
+
+   DspBenchmark(std::vector<int> bufferSizes, double minTimeMs, std::string filter);
+
+   void RunAll();
+   const std::vector<Result>& GetResults() const { return mResults; }
+   void WriteResults(ofxJSONElement& root) const;
+
+private:
+   bool ShouldRun(const std::string& name) const;
+   //calls process(bufferSize) until at least mMinTimeMs has gone by, after a few warmup calls
+   void Time(std::string name, int bufferSize, std::function<void(int)> process);
+
+   void RunBufferOps(int bufferSize);
+   void RunBiquad(int bufferSize);
+   void RunFFT(int bufferSize);
+   void RunInterpolatedSample(int bufferSize);
+   void RunAdsr(int bufferSize);
+   void RunTransportListeners(int bufferSize);
+   void RunVoices(int bufferSize);
+   void RunEffects(int bufferSize);
+
+   std::vector<int> mBufferSizes;
+   double mMinTimeMs{ 200 };
+   std::string mFilter;
+   std::vector<float> mNoise; //input signal, fed to everything that processes audio
+   std::vector<Result> mResults;
+};
@@ -0,0 +1,279 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    DynamicsCore.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "DynamicsCore.h"
+#include "SynthGlobals.h"
+
+#include <cassert>
+#include <cmath>
+
+float EnvelopeFollower::TimeToCoefficient(float ms)
+{
+   if (ms <= 0)
+      return 0;
+   return expf(-1000.0f / (ms * gSampleRate));
+}
+
+void EnvelopeFollower::Process(const float* input, float* output, int numSamples)
+{
+   float value = mValue;
+   const float attackCoef = mAttackCoef;
+   const float releaseCoef = mReleaseCoef;
+   for (int i = 0; i < numSamples; ++i)
+   {
+      float in = input[i];
+      float coef = in > value ? attackCoef : releaseCoef;
+      value = in + coef * (value - in);
+      output[i] = value;
+   }
+
+   if (fabsf(value) < 1e-15f) //keep long releases out of denormals
+      value = 0;
+   mValue = value;
+}
+
+void LevelDetector::SetRmsWindow(float ms)
+{
+   mRmsAverage.SetAttack(ms);
+   mRmsAverage.SetRelease(ms);
+}
+
+void LevelDetector::Process(const float* const* channels, int numChannels, int numSamples, float* level)
+{
+   if (numChannels <= 0)
+   {
+      memset(level, 0, numSamples * sizeof(float));
+      return;
+   }
+
+   if (mMode == Mode::Peak)
+   {
+      for (int i = 0; i < numSamples; ++i)
+         level[i] = fabsf(channels[0][i]);
+      for (int ch = 1; ch < numChannels; ++ch)
+      {
+         for (int i = 0; i < numSamples; ++i)
+            level[i] = MAX(level[i], fabsf(channels[ch][i]));
+      }
+   }
+   else
+   {
+      for (int i = 0; i < numSamples; ++i)
+         level[i] = channels[0][i] * channels[0][i];
+      for (int ch = 1; ch < numChannels; ++ch)
+      {
+         for (int i = 0; i < numSamples; ++i)
+            level[i] = MAX(level[i], channels[ch][i] * channels[ch][i]);
+      }
+
+      mRmsAverage.Process(level, level, numSamples);
+      for (int i = 0; i < numSamples; ++i)
+         level[i] = sqrtf(level[i]);
+   }
+}
+
+LookaheadDelay::LookaheadDelay(int maxDelaySamples)
+: mMaxDelay(MAX(0, maxDelaySamples))
+{
+   int size = 1;
+   while (size <= mMaxDelay)
+      size <<= 1;
+   mMask = size - 1;
+   for (auto& buffer : mBuffer)
+      buffer.assign(size, 0);
+}
+
+void LookaheadDelay::SetDelay(int samples)
+{
+   mDelay = ofClamp(samples, 0, mMaxDelay);
+}
+
+void LookaheadDelay::Reset()
+{
+   for (auto& buffer : mBuffer)
+      std::fill(buffer.begin(), buffer.end(), 0);
+}
+
+void LookaheadDelay::Process(float* const* channels, int numChannels, int numSamples)
+{
+   assert(numChannels <= kMaxChannels);
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      float* ring = mBuffer[ch].data();
+      float* audio = channels[ch];
+      int writePos = mWritePos;
+      for (int i = 0; i < numSamples; ++i)
+      {
+         ring[writePos] = audio[i];
+         audio[i] = ring[(writePos - mDelay) & mMask];
+         writePos = (writePos + 1) & mMask;
+      }
+   }
+   mWritePos = (mWritePos + numSamples) & mMask;
+}
+
+CrossoverBank::CrossoverBank()
+{
+   for (auto& buffer : mBandBuffers)
+      buffer.assign(gBufferSize, 0);
+}
+
+void CrossoverBank::Design(Crossover& crossover, float frequency)
+{
+   //a linkwitz-riley lowpass/highpass is a butterworth lowpass/highpass squared, and the two sum to a 2nd order allpass with the butterworth poles.
+   //same bilinear prewarping as CLinkwitzRiley_4thOrder, but as biquads so moving the frequency while running stays stable
+   frequency = ofClamp(frequency, 10, gSampleRate * .49f);
+   double k = tan(M_PI * frequency / gSampleRate);
+   double k2 = k * k;
+   double norm = 1 / (1 + sqrt(2.0) * k + k2);
+
+   Biquad poles;
+   poles.mB1 = 2 * (k2 - 1) * norm;
+   poles.mB2 = (1 - sqrt(2.0) * k + k2) * norm;
+
+   crossover.mLowPass = poles;
+   crossover.mLowPass.mA0 = k2 * norm;
+   crossover.mLowPass.mA1 = 2 * k2 * norm;
+   crossover.mLowPass.mA2 = k2 * norm;
+
+   crossover.mHighPass = poles;
+   crossover.mHighPass.mA0 = norm;
+   crossover.mHighPass.mA1 = -2 * norm;
+   crossover.mHighPass.mA2 = norm;
+
+   crossover.mAllPass = poles;
+   crossover.mAllPass.mA0 = poles.mB2;
+   crossover.mAllPass.mA1 = poles.mB1;
+   crossover.mAllPass.mA2 = 1;
+}
+
+void CrossoverBank::SetCrossoverFrequencies(const float* frequencies, int numCrossovers)
+{
+   numCrossovers = ofClamp(numCrossovers, 0, kMaxCrossovers);
+   if (numCrossovers != mNumCrossovers)
+   {
+      mNumCrossovers = numCrossovers;
+      Reset(); //the bands have all moved
+   }
+
+   for (int i = 0; i < mNumCrossovers; ++i)
+      Design(mCrossovers[i], frequencies[i]);
+}
+
+void CrossoverBank::Reset()
+{
+   for (auto& crossover : mCrossovers)
+   {
+      crossover.mLowState = {};
+      crossover.mHighState = {};
+      crossover.mAllPassState = {};
+   }
+}
+
+void CrossoverBank::Process(const float* const* channels, int numChannels, int numSamples)
+{
+   assert(numChannels <= kMaxChannels);
+   if ((int)mBandBuffers[0].size() < numSamples)
+   {
+      for (auto& buffer : mBandBuffers)
+         buffer.resize(numSamples);
+   }
+
+   //split from the bottom up, the top band holds what's left over above each crossover
+   for (int ch = 0; ch < numChannels; ++ch)
+      memcpy(GetBand(mNumCrossovers, ch), channels[ch], numSamples * sizeof(float));
+
+   for (int i = 0; i < mNumCrossovers; ++i)
+   {
+      Split(mCrossovers[i], i, numChannels, numSamples);
+      if (mPhaseCompensation && i > 0)
+         Compensate(mCrossovers[i], i, numChannels, numSamples);
+   }
+}
+
+void CrossoverBank::Split(Crossover& crossover, int lowBand, int numChannels, int numSamples)
+{
+   float* low[kMaxChannels];
+   float* high[kMaxChannels];
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      low[ch] = GetBand(lowBand, ch);
+      high[ch] = GetBand(mNumCrossovers, ch);
+   }
+
+   //keep everything in locals so the channel lanes can live in registers for the length of the block
+   const Biquad lowPass = crossover.mLowPass;
+   const Biquad highPass = crossover.mHighPass;
+   auto lowState = crossover.mLowState;
+   auto highState = crossover.mHighState;
+
+   for (int i = 0; i < numSamples; ++i)
+   {
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         double in = high[ch][i];
+         double lowOut = Tick(lowPass, lowState[1][ch], Tick(lowPass, lowState[0][ch], in));
+         double highOut = Tick(highPass, highState[1][ch], Tick(highPass, highState[0][ch], in));
+         low[ch][i] = lowOut;
+         high[ch][i] = highOut;
+      }
+   }
+
+   crossover.mLowState = lowState;
+   crossover.mHighState = highState;
+}
+
+void CrossoverBank::Compensate(Crossover& crossover, int numBandsBelow, int numChannels, int numSamples)
+{
+   //every band below this crossover gets the same allpass, so run them all side by side as lanes
+   const int kMaxLanes = kMaxCrossovers * kMaxChannels;
+   float* lanes[kMaxLanes];
+   BiquadState state[kMaxLanes];
+   int numLanes = 0;
+   for (int band = 0; band < numBandsBelow; ++band)
+   {
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         lanes[numLanes] = GetBand(band, ch);
+         state[numLanes] = crossover.mAllPassState[band][ch];
+         ++numLanes;
+      }
+   }
+
+   const Biquad allPass = crossover.mAllPass;
+   for (int i = 0; i < numSamples; ++i)
+   {
+      for (int lane = 0; lane < numLanes; ++lane)
+         lanes[lane][i] = Tick(allPass, state[lane], lanes[lane][i]);
+   }
+
+   numLanes = 0;
+   for (int band = 0; band < numBandsBelow; ++band)
+   {
+      for (int ch = 0; ch < numChannels; ++ch)
+         crossover.mAllPassState[band][ch] = state[numLanes++];
+   }
+}
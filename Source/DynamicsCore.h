@@ -0,0 +1,201 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    DynamicsCore.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//building blocks shared by the dynamics processors (compressor, gate, multiband compressor, band trackers):
+//level detection, attack/release envelopes, lookahead delay and a crossover bank, all processed a block at a time
+
+//fast approximations of log2/exp2 for converting levels to and from dB. good to about 1e-4 (well under .001dB),
+//which is plenty for gain computation, and they vectorize, unlike logf()/expf()
+inline float FastLog2(float x)
+{
+   uint32_t bits;
+   memcpy(&bits, &x, sizeof(bits));
+   uint32_t mantissaBits = (bits & 0x007FFFFF) | 0x3f000000;
+   float mantissa;
+   memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+   return bits * 1.1920928955078125e-7f - 124.22551499f - 1.498030302f * mantissa - 1.72587999f / (0.3520887068f + mantissa);
+}
+
+inline float FastExp2(float x)
+{
+   float clipped = x < -126 ? -126.0f : x;
+   float fraction = clipped - (int)clipped + (clipped < 0 ? 1.0f : 0.0f);
+   uint32_t bits = (uint32_t)((1 << 23) * (clipped + 121.2740575f + 27.7280233f / (4.84252568f - fraction) - 1.49012907f * fraction));
+   float result;
+   memcpy(&result, &bits, sizeof(result));
+   return result;
+}
+
+inline float FastGainToDb(float gain)
+{
+   return FastLog2(gain) * 6.02059991f; //20 * log10(2)
+}
+
+inline float FastDbToGain(float db)
+{
+   return FastExp2(db * .166096405f); //log2(10) / 20
+}
+
+//one-pole attack/release smoother. rising input uses the attack time, falling input the release time.
+//works on linear levels or dB alike. a time of 0 follows instantly
+class EnvelopeFollower
+{
+public:
+   void SetAttack(float ms) { mAttackCoef = TimeToCoefficient(ms); }
+   void SetRelease(float ms) { mReleaseCoef = TimeToCoefficient(ms); }
+   void Reset(float value = 0) { mValue = value; }
+   float GetValue() const { return mValue; }
+
+   //input and output may be the same buffer
+   void Process(const float* input, float* output, int numSamples);
+
+   static float TimeToCoefficient(float ms);
+
+private:
+   float mAttackCoef{ 0 };
+   float mReleaseCoef{ 0 };
+   float mValue{ 0 };
+};
+
+//rectifies a block, linking the channels so that the loudest one drives the level
+class LevelDetector
+{
+public:
+   enum class Mode
+   {
+      Peak,
+      Rms
+   };
+
+   void SetMode(Mode mode) { mMode = mode; }
+   Mode GetMode() const { return mMode; }
+   void SetRmsWindow(float ms);
+   void Reset() { mRmsAverage.Reset(); }
+
+   void Process(const float* const* channels, int numChannels, int numSamples, float* level);
+
+private:
+   Mode mMode{ Mode::Peak };
+   EnvelopeFollower mRmsAverage;
+};
+
+//delays a block of audio by a fixed number of samples, so gain computed from the undelayed signal lands ahead of the transients it reacts to.
+//anything mixed back in alongside the processed audio (dry signal, other bands) has to go through the same delay to stay aligned
+class LookaheadDelay
+{
+public:
+   static const int kMaxChannels = 2;
+
+   explicit LookaheadDelay(int maxDelaySamples);
+
+   void SetDelay(int samples);
+   int GetLatency() const { return mDelay; }
+   void Reset();
+
+   //in place
+   void Process(float* const* channels, int numChannels, int numSamples);
+
+private:
+   std::vector<float> mBuffer[kMaxChannels];
+   int mMask{ 0 };
+   int mWritePos{ 0 };
+   int mDelay{ 0 };
+   int mMaxDelay{ 0 };
+};
+
+//splits audio into bands with a cascade of 4th-order linkwitz-riley crossovers.
+//each crossover is run as two butterworth biquad pairs over all channels at once, and every band below a crossover is passed through that crossover's allpass,
+//so the bands are phase aligned and sum back to a flat (allpassed) signal
+class CrossoverBank
+{
+public:
+   static const int kMaxCrossovers = 15;
+   static const int kMaxBands = kMaxCrossovers + 1;
+   static const int kMaxChannels = 2;
+
+   CrossoverBank();
+
+   //ascending
+   void SetCrossoverFrequencies(const float* frequencies, int numCrossovers);
+   int GetNumBands() const { return mNumCrossovers + 1; }
+   //the allpass compensation can be skipped when only the level of each band matters
+   void SetPhaseCompensation(bool compensate) { mPhaseCompensation = compensate; }
+   void Reset();
+
+   //band 0 is the lowest, the last band is everything above the highest crossover
+   void Process(const float* const* channels, int numChannels, int numSamples);
+   float* GetBand(int band, int channel) { return mBandBuffers[band * kMaxChannels + channel].data(); }
+
+private:
+   struct Biquad
+   {
+      double mA0{ 1 };
+      double mA1{ 0 };
+      double mA2{ 0 };
+      double mB1{ 0 };
+      double mB2{ 0 };
+   };
+
+   struct BiquadState
+   {
+      double mZ1{ 0 };
+      double mZ2{ 0 };
+   };
+
+   struct Crossover
+   {
+      Biquad mLowPass;
+      Biquad mHighPass;
+      Biquad mAllPass;
+      std::array<std::array<BiquadState, kMaxChannels>, 2> mLowState{};
+      std::array<std::array<BiquadState, kMaxChannels>, 2> mHighState{};
+      std::array<std::array<BiquadState, kMaxChannels>, kMaxCrossovers> mAllPassState{}; //one per band below this crossover
+   };
+
+   static double Tick(const Biquad& filter, BiquadState& state, double input)
+   {
+      double output = input * filter.mA0 + state.mZ1;
+      state.mZ1 = input * filter.mA1 + state.mZ2 - filter.mB1 * output;
+      state.mZ2 = input * filter.mA2 - filter.mB2 * output;
+      return output;
+   }
+
+   static void Design(Crossover& crossover, float frequency);
+   void Split(Crossover& crossover, int lowBand, int numChannels, int numSamples);
+   void Compensate(Crossover& crossover, int numBandsBelow, int numChannels, int numSamples);
+
+   std::array<Crossover, kMaxCrossovers> mCrossovers;
+   int mNumCrossovers{ 0 };
+   bool mPhaseCompensation{ true };
+   std::array<std::vector<float>, kMaxBands * kMaxChannels> mBandBuffers;
+};
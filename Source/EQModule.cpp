@@ -40,10 +40,7 @@ EQModule::EQModule()
 , mFFTData(kNumFFTBins, kNumFFTBins / 2 + 1)
 , mRollingInputBuffer(kNumFFTBins)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[kNumFFTBins];
-   for (int i = 0; i < kNumFFTBins; ++i)
-      mWindower[i] = -.5f * cos(FTWO_PI * i / kNumFFTBins) + .5f;
+   mWindower = mFFT.GetHannWindow();
    mSmoother = new float[kNumFFTBins / 2 + 1 - kBinIgnore];
    for (int i = 0; i < kNumFFTBins / 2 + 1 - kBinIgnore; ++i)
       mSmoother[i] = 0;
@@ -55,13 +52,11 @@ EQModule::EQModule()
    {
       auto& filter = mFilters[i];
       filter.mEnabled = i < 4;
-      for (auto& biquad : filter.mFilter)
-      {
-         biquad.SetFilterParams(cutoffs[i], sqrtf(2) / 2);
-         biquad.SetFilterType(types[i]);
-      }
+      filter.mFilter.SetFilterParams(cutoffs[i], sqrtf(2) / 2);
+      filter.mFilter.SetFilterType(types[i]);
       filter.mNeedToCalculateCoefficients = true;
    }
+   mCascade.SetNumStages((int)mFilters.size());
 }
 
 void EQModule::CreateUIControls()
@@ -74,10 +69,10 @@ void EQModule::CreateUIControls()
       auto& filter = mFilters[i];
 
       CHECKBOX(filter.mEnabledCheckbox, ("enabled" + ofToString(i)).c_str(), &filter.mEnabled);
-      DROPDOWN(filter.mTypeSelector, ("type" + ofToString(i)).c_str(), (int*)(&filter.mFilter[0].mType), 45);
-      FLOATSLIDER(filter.mFSlider, ("f" + ofToString(i)).c_str(), &filter.mFilter[0].mF, 20, 20000);
-      FLOATSLIDER(filter.mGSlider, ("g" + ofToString(i)).c_str(), &filter.mFilter[0].mDbGain, -15, 15);
-      FLOATSLIDER_DIGITS(filter.mQSlider, ("q" + ofToString(i)).c_str(), &filter.mFilter[0].mQ, .1f, 18, 3);
+      DROPDOWN(filter.mTypeSelector, ("type" + ofToString(i)).c_str(), (int*)(&filter.mFilter.mType), 45);
+      FLOATSLIDER(filter.mFSlider, ("f" + ofToString(i)).c_str(), &filter.mFilter.mF, 20, 20000);
+      FLOATSLIDER(filter.mGSlider, ("g" + ofToString(i)).c_str(), &filter.mFilter.mDbGain, -15, 15);
+      FLOATSLIDER_DIGITS(filter.mQSlider, ("q" + ofToString(i)).c_str(), &filter.mFilter.mQ, .1f, 18, 3);
       UIBLOCK_NEWCOLUMN();
 
       filter.mTypeSelector->AddLabel("lp", kFilterType_Lowpass);
@@ -90,15 +85,14 @@ void EQModule::CreateUIControls()
 
       filter.mFSlider->SetMode(FloatSlider::kSquare);
       filter.mQSlider->SetMode(FloatSlider::kSquare);
-      filter.mGSlider->SetShowing(filter.mFilter[0].UsesGain());
-      filter.mQSlider->SetShowing(filter.mFilter[0].UsesQ());
+      filter.mGSlider->SetShowing(filter.mFilter.UsesGain());
+      filter.mQSlider->SetShowing(filter.mFilter.UsesQ());
    }
    ENDUIBLOCK0();
 }
 
 EQModule::~EQModule()
 {
-   delete[] mWindower;
    delete[] mSmoother;
 }
 
@@ -109,16 +103,7 @@ void EQModule::Process(double time)
    if (mLiteCpuModulation)
    {
       ComputeSliders(0);
-
-      for (auto& filter : mFilters)
-      {
-         if (filter.mEnabled)
-         {
-            bool updated = filter.UpdateCoefficientsIfNecessary();
-            if (updated)
-               mNeedToUpdateFrequencyResponseGraph = true;
-         }
-      }
+      UpdateCascade();
    }
 
    IAudioReceiver* target = GetTarget();
@@ -133,57 +118,37 @@ void EQModule::Process(double time)
       Clear(gWorkBuffer, GetBuffer()->BufferSize());
 
       ChannelBuffer* out = target->GetBuffer();
-      gWorkChannelBuffer.SetNumActiveChannels(out->NumActiveChannels());
-
-      if (!mLiteCpuModulation) //should we try to recalculate filters every sample?
-      {
-         for (int i = 0; i < GetBuffer()->BufferSize(); ++i)
-         {
-            ComputeSliders(i);
+      gWorkChannelBuffer->SetNumActiveChannels(out->NumActiveChannels());
 
-            for (auto& filter : mFilters)
-            {
-               if (filter.mEnabled)
-               {
-                  bool updated = filter.UpdateCoefficientsIfNecessary();
-                  if (updated)
-                     mNeedToUpdateFrequencyResponseGraph = true;
-               }
-            }
+      int numChannels = MIN(GetBuffer()->NumActiveChannels(), BiquadCascade::kMaxChannels);
+      for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
+         BufferCopy(gWorkChannelBuffer->GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
 
-            for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
-            {
-               float sample = GetBuffer()->GetChannel(ch)[i];
-               for (auto& filter : mFilters)
-               {
-                  if (filter.mEnabled)
-                     sample = filter.mFilter[ch].Filter(sample);
-               }
-               gWorkChannelBuffer.GetChannel(ch)[i] = sample;
-            }
-         }
-      }
-      else
+      //when modulating at full rate, recalculate the filters every few samples, and let the cascade ramp the coefficients in between
+      int blockSize = mLiteCpuModulation ? GetBuffer()->BufferSize() : kModulationBlockSize;
+      for (int offset = 0; offset < GetBuffer()->BufferSize(); offset += blockSize)
       {
-         for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
+         int length = MIN(blockSize, GetBuffer()->BufferSize() - offset);
+         if (!mLiteCpuModulation)
          {
-            BufferCopy(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
-            for (auto& filter : mFilters)
-            {
-               if (filter.mEnabled)
-                  filter.mFilter[ch].Filter(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize());
-            }
+            ComputeSliders(offset);
+            UpdateCascade();
          }
+
+         float* channels[BiquadCascade::kMaxChannels];
+         for (int ch = 0; ch < numChannels; ++ch)
+            channels[ch] = gWorkChannelBuffer->GetChannel(ch) + offset;
+         mCascade.Process(channels, numChannels, length);
       }
 
       for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
       {
-         Add(out->GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize());
-         GetVizBuffer()->WriteChunk(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize(), ch);
+         Add(out->GetChannel(ch), gWorkChannelBuffer->GetChannel(ch), GetBuffer()->BufferSize());
+         GetVizBuffer()->WriteChunk(gWorkChannelBuffer->GetChannel(ch), GetBuffer()->BufferSize(), ch);
       }
 
       for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
-         Add(gWorkBuffer, gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize());
+         Add(gWorkBuffer, gWorkChannelBuffer->GetChannel(ch), GetBuffer()->BufferSize());
 
       mRollingInputBuffer.WriteChunk(gWorkBuffer, GetBuffer()->BufferSize(), 0);
 
@@ -217,8 +182,8 @@ void EQModule::DrawModule()
    {
       filter.mTypeSelector->SetShowing(filter.mEnabled);
       filter.mFSlider->SetShowing(filter.mEnabled);
-      filter.mGSlider->SetShowing(filter.mEnabled && filter.mFilter[0].UsesGain());
-      filter.mQSlider->SetShowing(filter.mEnabled && filter.mFilter[0].UsesQ());
+      filter.mGSlider->SetShowing(filter.mEnabled && filter.mFilter.UsesGain());
+      filter.mQSlider->SetShowing(filter.mEnabled && filter.mFilter.UsesQ());
 
       filter.mEnabledCheckbox->Draw();
       filter.mTypeSelector->Draw();
@@ -292,7 +257,7 @@ void EQModule::DrawModule()
             for (auto& filter : mFilters)
             {
                if (filter.mEnabled)
-                  response *= filter.mFilter[0].GetMagnitudeResponseAt(freq);
+                  response *= filter.mFilter.GetMagnitudeResponseAt(freq);
             }
             if (responseGraphIndex < mFrequencyResponse.size())
                mFrequencyResponse[responseGraphIndex] = response;
@@ -312,8 +277,8 @@ void EQModule::DrawModule()
       auto& filter = mFilters[i];
       if (filter.mEnabled)
       {
-         float x = PosForFreq(filter.mFilter[0].mF) * w;
-         float y = PosForGain(filter.mFilter[0].mDbGain) * h + kDrawYOffset;
+         float x = PosForFreq(filter.mFilter.mF) * w;
+         float y = PosForGain(filter.mFilter.mDbGain) * h + kDrawYOffset;
          ofFill();
          ofSetColor(255, 210, 0);
          ofCircle(x, y, 8);
@@ -332,13 +297,25 @@ void EQModule::DrawModule()
    ofPopStyle();
 }
 
+void EQModule::UpdateCascade()
+{
+   for (size_t i = 0; i < mFilters.size(); ++i)
+   {
+      auto& filter = mFilters[i];
+      mCascade.SetStageEnabled((int)i, filter.mEnabled);
+      if (filter.mEnabled && filter.UpdateCoefficientsIfNecessary())
+      {
+         mCascade.SetStageCoefficients((int)i, filter.mFilter);
+         mNeedToUpdateFrequencyResponseGraph = true;
+      }
+   }
+}
+
 bool EQModule::Filter::UpdateCoefficientsIfNecessary()
 {
    if (mNeedToCalculateCoefficients)
    {
-      mFilter[0].UpdateFilterCoeff();
-      for (size_t ch = 1; ch < mFilter.size(); ++ch)
-         mFilter[ch].CopyCoeffFrom(mFilter[0]);
+      mFilter.UpdateFilterCoeff();
       mNeedToCalculateCoefficients = false;
       return true;
    }
@@ -385,8 +362,8 @@ bool EQModule::MouseMoved(float x, float y)
       for (int i = 0; i < mFilters.size(); ++i)
       {
          if (mFilters[i].mEnabled &&
-             abs(x - PosForFreq(mFilters[i].mFilter[0].mF) * w) < 5 &&
-             abs((y - kDrawYOffset) - PosForGain(mFilters[i].mFilter[0].mDbGain) * h) < 5)
+             abs(x - PosForFreq(mFilters[i].mFilter.mF) * w) < 5 &&
+             abs((y - kDrawYOffset) - PosForGain(mFilters[i].mFilter.mDbGain) * h) < 5)
          {
             mHoveredFilterHandleIndex = i;
             break;
@@ -461,7 +438,7 @@ void EQModule::DropdownUpdated(DropdownList* list, int oldVal, double time)
    {
       if (list == filter.mTypeSelector)
       {
-         filter.mFilter[0].SetFilterType(filter.mFilter[0].mType);
+         filter.mFilter.SetFilterType(filter.mFilter.mType);
          filter.mNeedToCalculateCoefficients = true;
       }
    }
@@ -469,12 +446,11 @@ void EQModule::DropdownUpdated(DropdownList* list, int oldVal, double time)
 
 void EQModule::CheckboxUpdated(Checkbox* checkbox, double time)
 {
-   for (auto& filter : mFilters)
+   for (size_t i = 0; i < mFilters.size(); ++i)
    {
-      if (checkbox == filter.mEnabledCheckbox)
+      if (checkbox == mFilters[i].mEnabledCheckbox)
       {
-         filter.mFilter[0].Clear();
-         filter.mFilter[1].Clear();
+         mCascade.ClearStage((int)i);
          mNeedToUpdateFrequencyResponseGraph = true;
       }
    }
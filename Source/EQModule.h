@@ -33,6 +33,7 @@
 #include "FFT.h"
 #include "RollingBuffer.h"
 #include "BiquadFilter.h"
+#include "BiquadCascade.h"
 #include "DropdownList.h"
 
 class EQModule : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public IDropdownListener
@@ -49,6 +50,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    bool IsResizable() const override { return true; }
@@ -84,7 +86,7 @@ private:
    float PosForGain(float gain) { return .5f - gain / 30.0f; };
    float GainForPos(float pos) { return (.5f - pos) * 30; }
 
-   float* mWindower{ nullptr };
+   const float* mWindower{ nullptr }; //shared with other FFTs of this size
    float* mSmoother{ nullptr };
 
    ::FFT mFFT;
@@ -94,7 +96,7 @@ private:
    struct Filter
    {
       bool mEnabled{ false };
-      std::array<BiquadFilter, 2> mFilter;
+      BiquadFilter mFilter; //holds the parameters, and calculates the coefficients for the matching mCascade stage
       Checkbox* mEnabledCheckbox{ nullptr };
       DropdownList* mTypeSelector{ nullptr };
       FloatSlider* mFSlider{ nullptr };
@@ -105,7 +107,12 @@ private:
       bool UpdateCoefficientsIfNecessary();
    };
 
+   void UpdateCascade();
+
+   static const int kModulationBlockSize = 16;
+
    std::array<Filter, 8> mFilters;
+   BiquadCascade mCascade;
    int mHoveredFilterHandleIndex{ -1 };
    int mDragging{ false };
    std::array<float, 1024> mFrequencyResponse{};
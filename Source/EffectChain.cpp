@@ -28,9 +28,60 @@
 #include "SynthGlobals.h"
 #include "ModularSynth.h"
 #include "Profiler.h"
+#include "SampleKernel.h"
+
+#include <limits>
 
 const double gSwapLength = 150.0;
 
+namespace
+{
+   //two kernels in one loop, with both of them inlined
+   template <class A, class B>
+   void RunFusedPair(A& a, B& b, ChannelBuffer* buffer, int bufferSize)
+   {
+      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+      {
+         float* samples = buffer->GetChannel(ch);
+         for (int i = 0; i < bufferSize; ++i)
+            samples[i] = b.Tick(ch, i, a.Tick(ch, i, samples[i]));
+      }
+   }
+
+   template <class A>
+   void RunFusedPairWith(A& a, SampleKernel* b, ChannelBuffer* buffer, int bufferSize)
+   {
+      switch (b->GetKernelType())
+      {
+         case SampleKernel::Type::kGain:
+            RunFusedPair(a, static_cast<GainKernel&>(*b), buffer, bufferSize);
+            break;
+         case SampleKernel::Type::kBiquad:
+            RunFusedPair(a, static_cast<BiquadKernel&>(*b), buffer, bufferSize);
+            break;
+         case SampleKernel::Type::kBitcrush:
+            RunFusedPair(a, static_cast<BitcrushKernel&>(*b), buffer, bufferSize);
+            break;
+      }
+   }
+
+   void RunFusedPair(SampleKernel* a, SampleKernel* b, ChannelBuffer* buffer, int bufferSize)
+   {
+      switch (a->GetKernelType())
+      {
+         case SampleKernel::Type::kGain:
+            RunFusedPairWith(static_cast<GainKernel&>(*a), b, buffer, bufferSize);
+            break;
+         case SampleKernel::Type::kBiquad:
+            RunFusedPairWith(static_cast<BiquadKernel&>(*a), b, buffer, bufferSize);
+            break;
+         case SampleKernel::Type::kBitcrush:
+            RunFusedPairWith(static_cast<BitcrushKernel&>(*a), b, buffer, bufferSize);
+            break;
+      }
+   }
+}
+
 EffectChain::EffectChain()
 : IAudioProcessor(gBufferSize)
 , mDryBuffer(gBufferSize)
@@ -41,6 +92,8 @@ EffectChain::~EffectChain()
 {
    for (int i = 0; i < mEffects.size(); ++i)
       delete mEffects[i];
+   for (auto& removed : mRemovedEffects)
+      delete removed.mEffect;
 }
 
 void EffectChain::CreateUIControls()
@@ -93,15 +146,16 @@ void EffectChain::AddEffect(std::string type, std::string desiredName, bool onTh
    if (mInitialized) //if we've already been initialized, call init on this
       effect->Init();
 
-   mEffectMutex.lock();
-   mEffects.push_back(effect);
-   mEffectMutex.unlock();
-   AddChild(effect);
-
-   float* dryWet = &(mDryWetLevels[mEffects.size() - 1]);
+   //everything about the effect is set up before the audio thread can see it
+   EffectControls controls;
+   controls.mDryWetSlot = GetFreeDryWetSlot();
+   float* dryWet = &(mDryWetLevels[controls.mDryWetSlot]);
    *dryWet = 1;
+   mLastDryWetLevels[controls.mDryWetSlot] = 1;
+
+   AddChild(effect);
+   mEffects.push_back(effect);
 
-   EffectControls controls;
    controls.mMoveLeftButton = new ClickButton(this, "<", 0, 0);
    controls.mMoveLeftButton->SetCableTargetable(false);
    controls.mMoveRightButton = new ClickButton(this, ">", 0, 0);
@@ -113,6 +167,30 @@ void EffectChain::AddEffect(std::string type, std::string desiredName, bool onTh
    controls.mPush2DisplayEffectButton->SetShowing(false);
    controls.mPush2DisplayEffectButton->SetCableTargetable(false);
    mEffectControls.push_back(controls);
+
+   PublishEffectList();
+}
+
+int EffectChain::GetFreeDryWetSlot() const
+{
+   for (int slot = 0; slot < MAX_EFFECTS_IN_CHAIN; ++slot)
+   {
+      bool used = false;
+      for (const auto& controls : mEffectControls)
+         used |= controls.mDryWetSlot == slot;
+      if (!used)
+         return slot;
+   }
+   assert(false); //AddEffect() stops at MAX_EFFECTS_IN_CHAIN
+   return 0;
+}
+
+void EffectChain::ResetAudioState()
+{
+   const EffectList& effects = mEffectLists[mProcessingEffectList];
+   for (int i = 0; i < effects.mNumEffects; ++i)
+      effects.mEffects[i]->ResetAudioState();
+   mDryBuffer.Clear();
 }
 
 void EffectChain::Process(double time)
@@ -130,36 +208,68 @@ void EffectChain::Process(double time)
 
    if (mEnabled)
    {
-      mEffectMutex.lock();
+      if (mSharedEffectList & kEffectListDirty)
+      {
+         mProcessingEffectList = mSharedEffectList.exchange(mProcessingEffectList) & ~kEffectListDirty;
+         mProcessingGeneration = mEffectLists[mProcessingEffectList].mGeneration;
+      }
+      const EffectList& effects = mEffectLists[mProcessingEffectList];
 
-      for (int i = 0; i < mEffects.size(); ++i)
+      //once the input has been silent for longer than the effects ring out, there's nothing left for them to do
+      bool inputSilent = GetBuffer()->IsSilent();
+      int tailLength = GetTailLengthSamples(effects);
+      bool skipEffects = inputSilent && tailLength != IAudioEffect::kTailUnknown && mSilentInputSamples >= tailLength;
+      mSilentInputSamples = inputSilent ? MIN(mSilentInputSamples + bufferSize, std::numeric_limits<int>::max() / 2) : 0;
+
+      for (int i = 0; i < effects.mNumEffects && !skipEffects; ++i)
       {
-         mDryBuffer.CopyFrom(GetBuffer());
+         IAudioEffect* effect = effects.mEffects[i];
+         if (!effect->IsEnabled() && !effect->ProcessesWhileDisabled())
+            continue; //bypassed, it would hand the audio straight back
 
-         mEffects[i]->ProcessAudio(time, GetBuffer());
+         //the mix ramps from where it was last buffer, so a modulated mix doesn't step
+         int slot = effects.mDryWetSlots[i];
+         float startMix = mLastDryWetLevels[slot];
+         float endMix = mDryWetLevels[slot];
+         mLastDryWetLevels[slot] = endMix;
 
-         float* dryWetBuffer = gWorkBuffer;
-         float* invDryWetBuffer = gWorkBuffer + bufferSize;
-         for (int j = 0; j < bufferSize; ++j)
+         if (startMix == 1 && endMix == 1)
          {
-            ComputeSliders(j);
-            dryWetBuffer[j] = mDryWetLevels[i];
-            invDryWetBuffer[j] = 1.0f - mDryWetLevels[i];
+            //fully wet, there's no dry signal to keep. simple effects in a row wait, to all run in one loop
+            SampleKernel* kernel = effect->IsEnabled() ? effect->BeginSampleKernel(time, bufferSize) : nullptr;
+            if (kernel != nullptr)
+            {
+               mPendingKernels[mNumPendingKernels++] = kernel;
+               continue;
+            }
+            RunPendingKernels(bufferSize);
+            effect->ProcessAudio(time, GetBuffer());
+            continue;
          }
 
+         RunPendingKernels(bufferSize);
+         mDryBuffer.CopyFrom(GetBuffer());
+
+         effect->ProcessAudio(time, GetBuffer());
+
          for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
          {
-            Mult(mDryBuffer.GetChannel(ch), invDryWetBuffer, bufferSize);
-            Mult(GetBuffer()->GetChannel(ch), dryWetBuffer, bufferSize);
-            Add(GetBuffer()->GetChannel(ch), mDryBuffer.GetChannel(ch), bufferSize);
+            if (GetBuffer()->IsSilent(ch) && mDryBuffer.IsSilent(ch))
+               continue;
+            MixRamp(GetBuffer()->GetChannel(ch), mDryBuffer.GetChannelReadOnly(ch), startMix, endMix, bufferSize);
          }
       }
-
-      mEffectMutex.unlock();
+      RunPendingKernels(bufferSize);
    }
 
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
    {
+      if (GetBuffer()->IsSilent(ch))
+      {
+         GetVizBuffer()->WriteChunk(GetBuffer()->GetChannelReadOnly(ch), bufferSize, ch);
+         continue; //leave the target's silence intact
+      }
+
       float* buffer = GetBuffer()->GetChannel(ch);
       if (mEnabled)
       {
@@ -174,6 +284,65 @@ void EffectChain::Process(double time)
    GetBuffer()->Reset();
 }
 
+int EffectChain::GetTailLengthSamples(const EffectList& effects) const
+{
+   int tailLength = 0;
+   for (int i = 0; i < effects.mNumEffects; ++i)
+   {
+      IAudioEffect* effect = effects.mEffects[i];
+      if (!effect->IsEnabled())
+         continue;
+      int effectTail = effect->GetTailLengthSamples();
+      if (effectTail == IAudioEffect::kTailUnknown)
+         return IAudioEffect::kTailUnknown;
+      tailLength = MAX(tailLength, effectTail);
+   }
+   return tailLength;
+}
+
+void EffectChain::RunPendingKernels(int bufferSize)
+{
+   if (mNumPendingKernels == 0)
+      return;
+
+   PROFILER(EffectChainKernels);
+
+   ChannelBuffer* buffer = GetBuffer();
+   if (mNumPendingKernels == 2)
+   {
+      RunFusedPair(mPendingKernels[0], mPendingKernels[1], buffer, bufferSize);
+   }
+   else
+   {
+      //a chunk at a time through every kernel, so the samples stay in cache between them
+      const int kChunkSize = 64;
+      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+      {
+         float* samples = buffer->GetChannel(ch);
+         for (int start = 0; start < bufferSize; start += kChunkSize)
+         {
+            int length = MIN(kChunkSize, bufferSize - start);
+            for (int i = 0; i < mNumPendingKernels; ++i)
+               mPendingKernels[i]->Run(ch, samples, start, length);
+         }
+      }
+   }
+   mNumPendingKernels = 0;
+}
+
+void EffectChain::PublishEffectList()
+{
+   EffectList& list = mEffectLists[mWritingEffectList];
+   list.mNumEffects = (int)mEffects.size();
+   for (int i = 0; i < list.mNumEffects; ++i)
+   {
+      list.mEffects[i] = mEffects[i];
+      list.mDryWetSlots[i] = mEffectControls[i].mDryWetSlot;
+   }
+   list.mGeneration = ++mPublishedGeneration;
+   mWritingEffectList = mSharedEffectList.exchange(mWritingEffectList | kEffectListDirty) & ~kEffectListDirty;
+}
+
 void EffectChain::Poll()
 {
    if (mWantToDeleteEffectAtIndex != -1)
@@ -181,6 +350,30 @@ void EffectChain::Poll()
       DeleteEffect(mWantToDeleteEffectAtIndex);
       mWantToDeleteEffectAtIndex = -1;
    }
+
+   RetireRemovedEffects();
+}
+
+//shuts a removed effect down the way deleting a module does, once processing can't reach it any more.
+//like other deleted modules it's kept around rather than freed, in case anything still points at its controls
+void EffectChain::RetireRemovedEffects()
+{
+   for (auto iter = mRemovedEffects.begin(); iter != mRemovedEffects.end();)
+   {
+      if (mProcessingGeneration < iter->mGeneration)
+      {
+         ++iter;
+         continue;
+      }
+
+      IAudioEffect* effect = iter->mEffect;
+      IUIControl::DestroyCablesTargetingControls(effect->GetUIControls());
+      effect->MarkAsDeleted();
+      effect->SetEnabled(false);
+      effect->Exit();
+      TheSynth->OnModuleDeleted(effect);
+      iter = mRemovedEffects.erase(iter);
+   }
 }
 
 void EffectChain::DrawModule()
@@ -242,7 +435,7 @@ void EffectChain::DrawModule()
       mEffects[i]->GetDimensions(w, h);
       w = MAX(w, MIN_EFFECT_WIDTH);
 
-      if (mDryWetLevels[i] == 0)
+      if (mDryWetLevels[mEffectControls[i].mDryWetSlot] == 0)
       {
          ofPushStyle();
          ofFill();
@@ -399,7 +592,6 @@ void EffectChain::DeleteEffect(int index)
       mEffectControls[index].mDryWetSlider->Delete();
       mEffectControls[index].mPush2DisplayEffectButton->Delete();
       //remove the element from mEffectControls
-      int i = 0;
       for (auto iter = mEffectControls.begin(); iter != mEffectControls.end(); ++iter)
       {
          if (iter->mDeleteButton == mEffectControls[index].mDeleteButton) //delete buttons match, we found the right one
@@ -407,22 +599,17 @@ void EffectChain::DeleteEffect(int index)
             mEffectControls.erase(iter);
             break;
          }
-         ++i;
       }
 
-      for (; i < mEffectControls.size() + 1; ++i)
-         mDryWetLevels[i] = mDryWetLevels[i + 1];
-
       UpdateReshuffledDryWetSliders();
    }
 
    {
-      mEffectMutex.lock();
       IAudioEffect* toRemove = mEffects[index];
       RemoveFromVector(toRemove, mEffects);
+      PublishEffectList();
       RemoveChild(toRemove);
-      //delete toRemove;   TODO(Ryan) can't do this in case stuff is referring to its UI controls
-      mEffectMutex.unlock();
+      mRemovedEffects.push_back({ toRemove, mPublishedGeneration });
    }
 }
 
@@ -438,20 +625,18 @@ void EffectChain::MoveEffect(int fromIndex, int direction)
       mEffects[mSwapToIdx]->GetPosition(mSwapToPos.x, mSwapToPos.y, true);
       mSwapTime = gTime + gSwapLength;
 
-      mEffectMutex.lock();
       IAudioEffect* swap = mEffects[newIndex];
       mEffects[newIndex] = mEffects[fromIndex];
       mEffects[fromIndex] = swap;
-      mEffectMutex.unlock();
-
-      float level = mDryWetLevels[newIndex];
-      mDryWetLevels[newIndex] = mDryWetLevels[fromIndex];
-      mDryWetLevels[fromIndex] = level;
 
       FloatSlider* dryWetSlider = mEffectControls[newIndex].mDryWetSlider;
       mEffectControls[newIndex].mDryWetSlider = mEffectControls[fromIndex].mDryWetSlider;
       mEffectControls[fromIndex].mDryWetSlider = dryWetSlider;
 
+      std::swap(mEffectControls[newIndex].mDryWetSlot, mEffectControls[fromIndex].mDryWetSlot);
+
+      PublishEffectList();
+
       ClickButton* displayButton = mEffectControls[newIndex].mPush2DisplayEffectButton;
       mEffectControls[newIndex].mPush2DisplayEffectButton = mEffectControls[fromIndex].mPush2DisplayEffectButton;
       mEffectControls[fromIndex].mPush2DisplayEffectButton = displayButton;
@@ -465,7 +650,7 @@ void EffectChain::UpdateReshuffledDryWetSliders()
    for (size_t i = 0; i < mEffectControls.size(); ++i)
    {
       mEffectControls[i].mDryWetSlider->SetName(("mix" + ofToString(i)).c_str());
-      mEffectControls[i].mDryWetSlider->SetVar(&mDryWetLevels[i]);
+      mEffectControls[i].mDryWetSlider->SetVar(&mDryWetLevels[mEffectControls[i].mDryWetSlot]);
    }
 }
 
@@ -32,10 +32,13 @@
 #include "Checkbox.h"
 #include "DropdownList.h"
 
+#include <atomic>
+
 #define MAX_EFFECTS_IN_CHAIN 100
 #define MIN_EFFECT_WIDTH 80
 
 class IAudioEffect;
+class SampleKernel;
 
 class EffectChain : public IDrawableModule, public IAudioProcessor, public IButtonListener, public IFloatSliderListener, public IDropdownListener
 {
@@ -57,6 +60,8 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
+   void ResetAudioState() override;
 
    void KeyPressed(int key, bool isRepeat) override;
    void KeyReleased(int key) override;
@@ -88,6 +93,12 @@ private:
    void DeleteEffect(int index);
    void MoveEffect(int index, int direction);
    void UpdateReshuffledDryWetSliders();
+   struct EffectList;
+   int GetTailLengthSamples(const EffectList& effects) const;
+   void RunPendingKernels(int bufferSize);
+   void PublishEffectList();
+   void RetireRemovedEffects();
+   int GetFreeDryWetSlot() const;
    ofVec2f GetEffectPos(int index) const;
 
    struct EffectControls
@@ -97,12 +108,41 @@ private:
       ClickButton* mDeleteButton{ nullptr };
       FloatSlider* mDryWetSlider{ nullptr };
       ClickButton* mPush2DisplayEffectButton{ nullptr };
+      int mDryWetSlot{ 0 }; //where in mDryWetLevels this effect's mix lives. it stays put when effects move or get deleted
    };
 
    std::vector<IAudioEffect*> mEffects{};
+
+   //the audio thread's copy of mEffects. it's handed over through a triple buffer, so changing the chain never blocks processing
+   struct EffectList
+   {
+      std::array<IAudioEffect*, MAX_EFFECTS_IN_CHAIN> mEffects{};
+      std::array<int, MAX_EFFECTS_IN_CHAIN> mDryWetSlots{};
+      int mNumEffects{ 0 };
+      int mGeneration{ 0 };
+   };
+   static constexpr int kEffectListDirty = 4;
+   std::array<EffectList, 3> mEffectLists{};
+   int mWritingEffectList{ 0 };
+   int mProcessingEffectList{ 1 };
+   std::atomic<int> mSharedEffectList{ 2 };
+   int mPublishedGeneration{ 0 };
+   std::atomic<int> mProcessingGeneration{ 0 }; //the generation of the list the audio thread has moved on to
+
+   //effects taken out of the chain, waiting for the audio thread to pick up a list without them before they're shut down
+   struct RemovedEffect
+   {
+      IAudioEffect* mEffect{ nullptr };
+      int mGeneration{ 0 };
+   };
+   std::vector<RemovedEffect> mRemovedEffects;
    ChannelBuffer mDryBuffer;
    std::vector<EffectControls> mEffectControls;
    std::array<float, MAX_EFFECTS_IN_CHAIN> mDryWetLevels{};
+   std::array<float, MAX_EFFECTS_IN_CHAIN> mLastDryWetLevels{}; //audio thread, where each slot's mix ramps on from
+   int mSilentInputSamples{ 0 };
+   std::array<SampleKernel*, MAX_EFFECTS_IN_CHAIN> mPendingKernels{}; //audio thread, a row of fully wet effects waiting to run as one loop
+   int mNumPendingKernels{ 0 };
 
    double mSwapTime{ -1 };
    int mSwapFromIdx{ -1 };
@@ -122,6 +162,4 @@ private:
    DropdownList* mEffectSpawnList{ nullptr };
    ClickButton* mSpawnEffectButton{ nullptr };
    ClickButton* mPush2ExitEffectButton{ nullptr };
-
-   ofMutex mEffectMutex;
 };
@@ -45,6 +45,7 @@
 #include "PitchShiftEffect.h"
 #include "ButterworthFilterEffect.h"
 #include "GainStageEffect.h"
+#include "ConvolutionEffect.h"
 
 EffectFactory::EffectFactory()
 {
@@ -69,6 +70,7 @@ EffectFactory::EffectFactory()
    //Register("formant", &(FormantFilterEffect::Create));
    Register("butterworth", &(ButterworthFilterEffect::Create));
    Register("gainstage", &(GainStageEffect::Create));
+   Register("convolution", &(ConvolutionEffect::Create));
 }
 
 void EffectFactory::Register(std::string type, CreateEffectFn creator)
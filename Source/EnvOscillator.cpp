@@ -25,7 +25,7 @@
 
 #include "EnvOscillator.h"
 
-float EnvOscillator::Audio(double time, float phase)
+float EnvOscillator::Audio(double time, float phase, float phaseInc /*= 0*/)
 {
-   return mOsc.Value(phase) * mAdsr.Value(time);
+   return mOsc.Value(phase, phaseInc) * mAdsr.Value(time);
 }
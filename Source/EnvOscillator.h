@@ -46,7 +46,7 @@ public:
       mAdsr.Start(time, target);
    }
    void Stop(double time) { mAdsr.Stop(time); }
-   float Audio(double time, float phase);
+   float Audio(double time, float phase, float phaseInc = 0);
    ::ADSR* GetADSR() { return &mAdsr; }
    void SetPulseWidth(float width) { mOsc.SetPulseWidth(width); }
    Oscillator mOsc{ OscillatorType::kOsc_Sin };
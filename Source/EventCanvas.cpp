@@ -126,7 +126,10 @@ void EventCanvas::OnTransportAdvanced(float amount)
    if (!mEnabled)
       return;
 
-   for (auto* canvasElement : mCanvas->GetElements())
+   //only elements that overlap what the cursor moved across can have a start or end in it. ends past the canvas length wrap around
+   mElementsInRange.clear();
+   mCanvas->GetElementsOverlapping(mPreviousPosition, lookaheadPos, K(includeWrapped), mElementsInRange);
+   for (auto* canvasElement : mElementsInRange)
    {
       float elementStart = canvasElement->GetStart();
       bool startPassed = (lookaheadPos >= elementStart && mPreviousPosition < elementStart);
@@ -355,6 +358,7 @@ void EventCanvas::ButtonClicked(ClickButton* button, double time)
             element->mOffset = 0;
          }
       }
+      mCanvas->InvalidateElementIndex();
    }
 }
 
@@ -104,6 +104,7 @@ private:
    bool mRecord{ false };
    Checkbox* mRecordCheckbox{ nullptr };
    double mPreviousPosition{ 0 };
+   std::vector<CanvasElement*> mElementsInRange;
 
    struct ControlConnection
    {
@@ -24,528 +24,309 @@
 //
 
 #include "FFT.h"
-#include <cstring>
 
-// Constructor for FFT routine
-FFT::FFT(int nfft)
-{
-   mNfft = nfft;
-   mNumfreqs = nfft / 2 + 1;
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
 
-   mFft_data = (float*)calloc(nfft, sizeof(float));
-}
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
 
-// Destructor for FFT routine
-FFT::~FFT()
+namespace
 {
-   free(mFft_data);
-}
-
-// Perform forward FFT of real data
-// Accepts:
-//   input - pointer to an array of (real) input values, size nfft
-//   output_re - pointer to an array of the real part of the output,
-//     size nfft/2 + 1
-//   output_im - pointer to an array of the imaginary part of the output,
-//     size nfft/2 + 1
-void FFT::Forward(float* input, float* output_re, float* output_im)
-{
-   int hnfft = mNfft / 2;
+#if defined(__wasm_simd128__)
+   struct Complex4
+   {
+      v128_t re;
+      v128_t im;
+   };
 
-   for (int ti = 0; ti < mNfft; ti++)
+   inline Complex4 Load4(const float* re, const float* im) { return { wasm_v128_load(re), wasm_v128_load(im) }; }
+   inline void Store4(float* re, float* im, Complex4 v)
    {
-      mFft_data[ti] = input[ti];
+      wasm_v128_store(re, v.re);
+      wasm_v128_store(im, v.im);
    }
-
-   mayer_realfft(mNfft, mFft_data);
-
-   output_im[0] = 0;
-   for (int ti = 0; ti < hnfft; ti++)
+   inline Complex4 Add4(Complex4 a, Complex4 b) { return { wasm_f32x4_add(a.re, b.re), wasm_f32x4_add(a.im, b.im) }; }
+   inline Complex4 Sub4(Complex4 a, Complex4 b) { return { wasm_f32x4_sub(a.re, b.re), wasm_f32x4_sub(a.im, b.im) }; }
+   inline Complex4 MulI4(Complex4 a) { return { wasm_f32x4_neg(a.im), a.re }; }
+   inline Complex4 MulW4(Complex4 a, v128_t wr, v128_t wi)
    {
-      output_re[ti] = mFft_data[ti];
-      output_im[ti] = mFft_data[mNfft - 1 - ti];
+      return { wasm_f32x4_sub(wasm_f32x4_mul(a.re, wr), wasm_f32x4_mul(a.im, wi)),
+               wasm_f32x4_add(wasm_f32x4_mul(a.re, wi), wasm_f32x4_mul(a.im, wr)) };
    }
-   output_re[hnfft] = mFft_data[hnfft];
-   output_im[hnfft] = 0;
+#endif
 }
 
-// Perform inverse FFT, returning real data
-// Accepts:
-//   input_re - pointer to an array of the real part of the output,
-//     size nfft/2 + 1
-//   input_im - pointer to an array of the imaginary part of the output,
-//     size nfft/2 + 1
-//   output - pointer to an array of (real) input values, size nfft
-void FFT::Inverse(float* input_re, float* input_im, float* output)
+const FFTPlan& FFTPlan::Get(int size)
 {
-   int hnfft;
+   static std::mutex sMutex;
+   static auto* sPlans = new std::map<int, std::unique_ptr<FFTPlan>>(); //never destroyed, so FFTs that outlive static destruction are still safe
+
+   std::lock_guard<std::mutex> lock(sMutex);
+   auto& plan = (*sPlans)[size];
+   if (plan == nullptr)
+      plan.reset(new FFTPlan(size));
+   return *plan;
+}
 
-   hnfft = mNfft / 2;
+FFTPlan::FFTPlan(int size)
+: mSize(size)
+, mHalfSize(size / 2)
+{
+   assert(size >= 4 && (size & (size - 1)) == 0); //power of two
 
-   for (int ti = 0; ti < hnfft; ti++)
+   mTwiddleRe.resize(mHalfSize);
+   mTwiddleIm.resize(mHalfSize);
+   for (int j = 0; j < mHalfSize; ++j)
    {
-      mFft_data[ti] = input_re[ti];
-      mFft_data[mNfft - 1 - ti] = input_im[ti];
+      double theta = 2 * M_PI * j / mHalfSize;
+      mTwiddleRe[j] = (float)cos(theta);
+      mTwiddleIm[j] = (float)-sin(theta);
    }
-   mFft_data[hnfft] = input_re[hnfft];
 
-   mayer_realifft(mNfft, mFft_data);
-
-   for (int ti = 0; ti < mNfft; ti++)
+   mRealTwiddleRe.resize(mHalfSize + 1);
+   mRealTwiddleIm.resize(mHalfSize + 1);
+   for (int k = 0; k <= mHalfSize; ++k)
    {
-      output[ti] = mFft_data[ti];
-   }
-}
-
-
-/* This is the FFT routine taken from PureData, a great piece of
- software by Miller S. Puckette.
- http://crca.ucsd.edu/~msp/software.html */
-
-/*
- ** FFT and FHT routines
- **  Copyright 1988, 1993; Ron Mayer
- **
- **  mayer_fht(fz,n);
- **      Does a hartley transform of "n" points in the array "fz".
- **  mayer_fft(n,real,imag)
- **      Does a fourier transform of "n" points of the "real" and
- **      "imag" arrays.
- **  mayer_ifft(n,real,imag)
- **      Does an inverse fourier transform of "n" points of the "real"
- **      and "imag" arrays.
- **  mayer_realfft(n,real)
- **      Does a real-valued fourier transform of "n" points of the
- **      "real" array.  The real part of the transform ends
- **      up in the first half of the array and the imaginary part of the
- **      transform ends up in the second half of the array.
- **  mayer_realifft(n,real)
- **      The inverse of the realfft() routine above.
- **
- **
- ** NOTE: This routine uses at least 2 patented algorithms, and may be
- **       under the restrictions of a bunch of different organizations.
- **       Although I wrote it completely myself, it is kind of a derivative
- **       of a routine I once authored and released under the GPL, so it
- **       may fall under the free software foundation's restrictions;
- **       it was worked on as a Stanford Univ project, so they claim
- **       some rights to it; it was further optimized at work here, so
- **       I think this company claims parts of it.  The patents are
- **       held by R. Bracewell (the FHT algorithm) and O. Buneman (the
- **       trig generator), both at Stanford Univ.
- **       If it were up to me, I'd say go do whatever you want with it;
- **       but it would be polite to give credit to the following people
- **       if you use this anywhere:
- **           Euler     - probable inventor of the fourier transform.
- **           Gauss     - probable inventor of the FFT.
- **           Hartley   - probable inventor of the hartley transform.
- **           Buneman   - for a really cool trig generator
- **           Mayer(me) - for authoring this particular version and
- **                       including all the optimizations in one package.
- **       Thanks,
- **       Ron Mayer; mayer@acuson.com
- **
- */
-
-/* This is a slightly modified version of Mayer's contribution; write
- * msp@ucsd.edu for the original code.  Kudos to Mayer for a fine piece
- * of work.  -msp
- */
-
-#define REAL float
-#define GOOD_TRIG
-
-#ifdef GOOD_TRIG
-#else
-#define FAST_TRIG
-#endif
-
-#if defined(GOOD_TRIG)
-#define FHT_SWAP(a, b, t) \
-   {                      \
-      (t) = (a);          \
-      (a) = (b);          \
-      (b) = (t);          \
-   }
-#define TRIG_VARS \
-   int t_lam = 0;
-#define TRIG_INIT(k, c, s)      \
-   {                            \
-      int i;                    \
-      for (i = 2; i <= k; i++)  \
-      {                         \
-         coswrk[i] = costab[i]; \
-         sinwrk[i] = sintab[i]; \
-      }                         \
-      t_lam = 0;                \
-      c = 1;                    \
-      s = 0;                    \
-   }
-#define TRIG_NEXT(k, c, s)                                    \
-   {                                                          \
-      int i, j;                                               \
-      (t_lam)++;                                              \
-      for (i = 0; !((1 << i) & t_lam); i++)                   \
-         ;                                                    \
-      i = k - i;                                              \
-      s = sinwrk[i];                                          \
-      c = coswrk[i];                                          \
-      if (i > 1)                                              \
-      {                                                       \
-         for (j = k - i + 2; (1 << j) & t_lam; j++)           \
-            ;                                                 \
-         j = k - j;                                           \
-         sinwrk[i] = halsec[i] * (sinwrk[i - 1] + sinwrk[j]); \
-         coswrk[i] = halsec[i] * (coswrk[i - 1] + coswrk[j]); \
-      }                                                       \
+      double theta = 2 * M_PI * k / mSize;
+      mRealTwiddleRe[k] = (float)cos(theta);
+      mRealTwiddleIm[k] = (float)-sin(theta);
    }
-#define TRIG_RESET(k, c, s)
-#endif
 
-#if defined(FAST_TRIG)
-#define TRIG_VARS \
-   REAL t_c, t_s;
-#define TRIG_INIT(k, c, s) \
-   {                       \
-      t_c = costab[k];     \
-      t_s = sintab[k];     \
-      c = 1;               \
-      s = 0;               \
-   }
-#define TRIG_NEXT(k, c, s)   \
-   {                         \
-      REAL t = c;            \
-      c = t * t_c - s * t_s; \
-      s = t * t_s + s * t_c; \
-   }
-#define TRIG_RESET(k, c, s)
-#endif
+   mHannWindow.resize(mSize);
+   for (int i = 0; i < mSize; ++i)
+      mHannWindow[i] = (float)(-.5 * cos(2 * M_PI * i / mSize) + .5);
+}
 
-static REAL halsec[20] = {
-   0,
-   0,
-   .54119610014619698439972320536638942006107206337801,
-   .50979557910415916894193980398784391368261849190893,
-   .50241928618815570551167011928012092247859337193963,
-   .50060299823519630134550410676638239611758632599591,
-   .50015063602065098821477101271097658495974913010340,
-   .50003765191554772296778139077905492847503165398345,
-   .50000941253588775676512870469186533538523133757983,
-   .50000235310628608051401267171204408939326297376426,
-   .50000058827484117879868526730916804925780637276181,
-   .50000014706860214875463798283871198206179118093251,
-   .50000003676714377807315864400643020315103490883972,
-   .50000000919178552207366560348853455333939112569380,
-   .50000000229794635411562887767906868558991922348920,
-   .50000000057448658687873302235147272458812263401372
-};
-static REAL costab[20] = {
-   .00000000000000000000000000000000000000000000000000,
-   .70710678118654752440084436210484903928483593768847,
-   .92387953251128675612818318939678828682241662586364,
-   .98078528040323044912618223613423903697393373089333,
-   .99518472667219688624483695310947992157547486872985,
-   .99879545620517239271477160475910069444320361470461,
-   .99969881869620422011576564966617219685006108125772,
-   .99992470183914454092164649119638322435060646880221,
-   .99998117528260114265699043772856771617391725094433,
-   .99999529380957617151158012570011989955298763362218,
-   .99999882345170190992902571017152601904826792288976,
-   .99999970586288221916022821773876567711626389934930,
-   .99999992646571785114473148070738785694820115568892,
-   .99999998161642929380834691540290971450507605124278,
-   .99999999540410731289097193313960614895889430318945,
-   .99999999885102682756267330779455410840053741619428
-};
-static REAL sintab[20] = {
-   1.0000000000000000000000000000000000000000000000000,
-   .70710678118654752440084436210484903928483593768846,
-   .38268343236508977172845998403039886676134456248561,
-   .19509032201612826784828486847702224092769161775195,
-   .09801714032956060199419556388864184586113667316749,
-   .04906767432741801425495497694268265831474536302574,
-   .02454122852291228803173452945928292506546611923944,
-   .01227153828571992607940826195100321214037231959176,
-   .00613588464915447535964023459037258091705788631738,
-   .00306795676296597627014536549091984251894461021344,
-   .00153398018628476561230369715026407907995486457522,
-   .00076699031874270452693856835794857664314091945205,
-   .00038349518757139558907246168118138126339502603495,
-   .00019174759731070330743990956198900093346887403385,
-   .00009587379909597734587051721097647635118706561284,
-   .00004793689960306688454900399049465887274686668768
-};
-static REAL coswrk[20] = {
-   .00000000000000000000000000000000000000000000000000,
-   .70710678118654752440084436210484903928483593768847,
-   .92387953251128675612818318939678828682241662586364,
-   .98078528040323044912618223613423903697393373089333,
-   .99518472667219688624483695310947992157547486872985,
-   .99879545620517239271477160475910069444320361470461,
-   .99969881869620422011576564966617219685006108125772,
-   .99992470183914454092164649119638322435060646880221,
-   .99998117528260114265699043772856771617391725094433,
-   .99999529380957617151158012570011989955298763362218,
-   .99999882345170190992902571017152601904826792288976,
-   .99999970586288221916022821773876567711626389934930,
-   .99999992646571785114473148070738785694820115568892,
-   .99999998161642929380834691540290971450507605124278,
-   .99999999540410731289097193313960614895889430318945,
-   .99999999885102682756267330779455410840053741619428
-};
-static REAL sinwrk[20] = {
-   1.0000000000000000000000000000000000000000000000000,
-   .70710678118654752440084436210484903928483593768846,
-   .38268343236508977172845998403039886676134456248561,
-   .19509032201612826784828486847702224092769161775195,
-   .09801714032956060199419556388864184586113667316749,
-   .04906767432741801425495497694268265831474536302574,
-   .02454122852291228803173452945928292506546611923944,
-   .01227153828571992607940826195100321214037231959176,
-   .00613588464915447535964023459037258091705788631738,
-   .00306795676296597627014536549091984251894461021344,
-   .00153398018628476561230369715026407907995486457522,
-   .00076699031874270452693856835794857664314091945205,
-   .00038349518757139558907246168118138126339502603495,
-   .00019174759731070330743990956198900093346887403385,
-   .00009587379909597734587051721097647635118706561284,
-   .00004793689960306688454900399049465887274686668768
-};
-
-
-#define SQRT2_2 0.70710678118654752440084436210484
-#define SQRT2 2 * 0.70710678118654752440084436210484
-
-void mayer_fht(REAL* fz, int n)
+//radix-4 stockham autosort, with a radix-2 pass at the end for odd powers of two.
+//there's no bit-reversal pass, and each stage works on contiguous runs of stride values, which get longer as the stages go.
+//on return re/im point at whichever pair of buffers holds the result
+void FFTPlan::ComplexForward(float*& re, float*& im, float*& workRe, float*& workIm) const
 {
-   /*  REAL a,b;
-    REAL c1,s1,s2,c2,s3,c3,s4,c4;
-    REAL f0,g0,f1,g1,f2,g2,f3,g3; */
-   int k, k1, k2, k3, k4, kx;
-   REAL *fi, *fn, *gi;
-   TRIG_VARS;
-
-   for (k1 = 1, k2 = 0; k1 < n; k1++)
+   int stride = 1;
+   int n = mHalfSize;
+   for (; n >= 4; n /= 4)
    {
-      REAL aa;
-      for (k = n >> 1; (!((k2 ^= k) & k)); k >>= 1)
-         ;
-      if (k1 > k2)
+      int quarter = n / 4;
+      for (int p = 0; p < quarter; ++p)
       {
-         aa = fz[k1];
-         fz[k1] = fz[k2];
-         fz[k2] = aa;
+         const float w1r = mTwiddleRe[p * stride];
+         const float w1i = mTwiddleIm[p * stride];
+         const float w2r = mTwiddleRe[2 * p * stride];
+         const float w2i = mTwiddleIm[2 * p * stride];
+         const float w3r = mTwiddleRe[3 * p * stride];
+         const float w3i = mTwiddleIm[3 * p * stride];
+
+         const int a = stride * p;
+         const int b = stride * (p + quarter);
+         const int c = stride * (p + quarter * 2);
+         const int d = stride * (p + quarter * 3);
+         const int y0 = stride * (4 * p);
+         const int y1 = stride * (4 * p + 1);
+         const int y2 = stride * (4 * p + 2);
+         const int y3 = stride * (4 * p + 3);
+
+         int q = 0;
+#if defined(__wasm_simd128__)
+         if (stride >= 4)
+         {
+            v128_t w1r4 = wasm_f32x4_splat(w1r), w1i4 = wasm_f32x4_splat(w1i);
+            v128_t w2r4 = wasm_f32x4_splat(w2r), w2i4 = wasm_f32x4_splat(w2i);
+            v128_t w3r4 = wasm_f32x4_splat(w3r), w3i4 = wasm_f32x4_splat(w3i);
+            for (; q < stride; q += 4)
+            {
+               Complex4 va = Load4(re + a + q, im + a + q);
+               Complex4 vb = Load4(re + b + q, im + b + q);
+               Complex4 vc = Load4(re + c + q, im + c + q);
+               Complex4 vd = Load4(re + d + q, im + d + q);
+               Complex4 apc = Add4(va, vc);
+               Complex4 amc = Sub4(va, vc);
+               Complex4 bpd = Add4(vb, vd);
+               Complex4 jbmd = MulI4(Sub4(vb, vd));
+               Store4(workRe + y0 + q, workIm + y0 + q, Add4(apc, bpd));
+               Store4(workRe + y1 + q, workIm + y1 + q, MulW4(Sub4(amc, jbmd), w1r4, w1i4));
+               Store4(workRe + y2 + q, workIm + y2 + q, MulW4(Sub4(apc, bpd), w2r4, w2i4));
+               Store4(workRe + y3 + q, workIm + y3 + q, MulW4(Add4(amc, jbmd), w3r4, w3i4));
+            }
+         }
+#endif
+         for (; q < stride; ++q)
+         {
+            float apcRe = re[a + q] + re[c + q];
+            float apcIm = im[a + q] + im[c + q];
+            float amcRe = re[a + q] - re[c + q];
+            float amcIm = im[a + q] - im[c + q];
+            float bpdRe = re[b + q] + re[d + q];
+            float bpdIm = im[b + q] + im[d + q];
+            float jbmdRe = im[d + q] - im[b + q];
+            float jbmdIm = re[b + q] - re[d + q];
+
+            workRe[y0 + q] = apcRe + bpdRe;
+            workIm[y0 + q] = apcIm + bpdIm;
+
+            float tRe = amcRe - jbmdRe;
+            float tIm = amcIm - jbmdIm;
+            workRe[y1 + q] = tRe * w1r - tIm * w1i;
+            workIm[y1 + q] = tRe * w1i + tIm * w1r;
+
+            tRe = apcRe - bpdRe;
+            tIm = apcIm - bpdIm;
+            workRe[y2 + q] = tRe * w2r - tIm * w2i;
+            workIm[y2 + q] = tRe * w2i + tIm * w2r;
+
+            tRe = amcRe + jbmdRe;
+            tIm = amcIm + jbmdIm;
+            workRe[y3 + q] = tRe * w3r - tIm * w3i;
+            workIm[y3 + q] = tRe * w3i + tIm * w3r;
+         }
       }
+      std::swap(re, workRe);
+      std::swap(im, workIm);
+      stride *= 4;
    }
-   for (k = 0; (1 << k) < n; k++)
-      ;
-   k &= 1;
-   if (k == 0)
+
+   if (n == 2)
    {
-      for (fi = fz, fn = fz + n; fi < fn; fi += 4)
+      for (int q = 0; q < stride; ++q)
       {
-         REAL f0, f1, f2, f3;
-         f1 = fi[0] - fi[1];
-         f0 = fi[0] + fi[1];
-         f3 = fi[2] - fi[3];
-         f2 = fi[2] + fi[3];
-         fi[2] = (f0 - f2);
-         fi[0] = (f0 + f2);
-         fi[3] = (f1 - f3);
-         fi[1] = (f1 + f3);
+         float aRe = re[q];
+         float aIm = im[q];
+         float bRe = re[q + stride];
+         float bIm = im[q + stride];
+         workRe[q] = aRe + bRe;
+         workIm[q] = aIm + bIm;
+         workRe[q + stride] = aRe - bRe;
+         workIm[q + stride] = aIm - bIm;
       }
+      std::swap(re, workRe);
+      std::swap(im, workIm);
    }
-   else
+}
+
+void FFTPlan::Forward(const float* input, float* re, float* im, float* scratch) const
+{
+   const int m = mHalfSize;
+   float* zRe = scratch;
+   float* zIm = scratch + m;
+   float* workRe = scratch + m * 2;
+   float* workIm = scratch + m * 3;
+
+   //pack even samples into the real part and odd samples into the imaginary part
+   for (int i = 0; i < m; ++i)
    {
-      for (fi = fz, fn = fz + n, gi = fi + 1; fi < fn; fi += 8, gi += 8)
-      {
-         REAL bs1, bc1, bs2, bc2, bs3, bc3, bs4, bc4,
-         bg0, bf0, bf1, bg1, bf2, bg2, bf3, bg3;
-         bc1 = fi[0] - gi[0];
-         bs1 = fi[0] + gi[0];
-         bc2 = fi[2] - gi[2];
-         bs2 = fi[2] + gi[2];
-         bc3 = fi[4] - gi[4];
-         bs3 = fi[4] + gi[4];
-         bc4 = fi[6] - gi[6];
-         bs4 = fi[6] + gi[6];
-         bf1 = (bs1 - bs2);
-         bf0 = (bs1 + bs2);
-         bg1 = (bc1 - bc2);
-         bg0 = (bc1 + bc2);
-         bf3 = (bs3 - bs4);
-         bf2 = (bs3 + bs4);
-         bg3 = SQRT2 * bc4;
-         bg2 = SQRT2 * bc3;
-         fi[4] = bf0 - bf2;
-         fi[0] = bf0 + bf2;
-         fi[6] = bf1 - bf3;
-         fi[2] = bf1 + bf3;
-         gi[4] = bg0 - bg2;
-         gi[0] = bg0 + bg2;
-         gi[6] = bg1 - bg3;
-         gi[2] = bg1 + bg3;
-      }
+      zRe[i] = input[i * 2];
+      zIm[i] = input[i * 2 + 1];
    }
-   if (n < 16)
-      return;
 
-   do
+   ComplexForward(zRe, zIm, workRe, workIm);
+
+   //untangle the even and odd spectra, and combine them into the spectrum of the real signal
+   for (int k = 0; k <= m; ++k)
    {
-      REAL s1, c1;
-      int ii;
-      k += 2;
-      k1 = 1 << k;
-      k2 = k1 << 1;
-      k4 = k2 << 1;
-      k3 = k2 + k1;
-      kx = k1 >> 1;
-      fi = fz;
-      gi = fi + kx;
-      fn = fz + n;
-      do
-      {
-         REAL g0, f0, f1, g1, f2, g2, f3, g3;
-         f1 = fi[0] - fi[k1];
-         f0 = fi[0] + fi[k1];
-         f3 = fi[k2] - fi[k3];
-         f2 = fi[k2] + fi[k3];
-         fi[k2] = f0 - f2;
-         fi[0] = f0 + f2;
-         fi[k3] = f1 - f3;
-         fi[k1] = f1 + f3;
-         g1 = gi[0] - gi[k1];
-         g0 = gi[0] + gi[k1];
-         g3 = SQRT2 * gi[k3];
-         g2 = SQRT2 * gi[k2];
-         gi[k2] = g0 - g2;
-         gi[0] = g0 + g2;
-         gi[k3] = g1 - g3;
-         gi[k1] = g1 + g3;
-         gi += k4;
-         fi += k4;
-      } while (fi < fn);
-      TRIG_INIT(k, c1, s1);
-      for (ii = 1; ii < kx; ii++)
-      {
-         REAL c2, s2;
-         TRIG_NEXT(k, c1, s1);
-         c2 = c1 * c1 - s1 * s1;
-         s2 = 2 * (c1 * s1);
-         fn = fz + n;
-         fi = fz + ii;
-         gi = fz + k1 - ii;
-         do
-         {
-            REAL a, b, g0, f0, f1, g1, f2, g2, f3, g3;
-            b = s2 * fi[k1] - c2 * gi[k1];
-            a = c2 * fi[k1] + s2 * gi[k1];
-            f1 = fi[0] - a;
-            f0 = fi[0] + a;
-            g1 = gi[0] - b;
-            g0 = gi[0] + b;
-            b = s2 * fi[k3] - c2 * gi[k3];
-            a = c2 * fi[k3] + s2 * gi[k3];
-            f3 = fi[k2] - a;
-            f2 = fi[k2] + a;
-            g3 = gi[k2] - b;
-            g2 = gi[k2] + b;
-            b = s1 * f2 - c1 * g3;
-            a = c1 * f2 + s1 * g3;
-            fi[k2] = f0 - a;
-            fi[0] = f0 + a;
-            gi[k3] = g1 - b;
-            gi[k1] = g1 + b;
-            b = c1 * g2 - s1 * f3;
-            a = s1 * g2 + c1 * f3;
-            gi[k2] = g0 - a;
-            gi[0] = g0 + a;
-            fi[k3] = f1 - b;
-            fi[k1] = f1 + b;
-            gi += k4;
-            fi += k4;
-         } while (fi < fn);
-      }
-      TRIG_RESET(k, c1, s1);
-   } while (k4 < n);
+      int a = k < m ? k : 0;
+      int b = k > 0 ? m - k : 0;
+      float evenRe = (zRe[a] + zRe[b]) * .5f;
+      float evenIm = (zIm[a] - zIm[b]) * .5f;
+      float oddRe = (zIm[a] + zIm[b]) * .5f;
+      float oddIm = (zRe[b] - zRe[a]) * .5f;
+      float wr = mRealTwiddleRe[k];
+      float wi = mRealTwiddleIm[k];
+      re[k] = evenRe + oddRe * wr - oddIm * wi;
+      im[k] = -(evenIm + oddRe * wi + oddIm * wr);
+   }
 }
 
-void mayer_fft(int n, REAL* real, REAL* imag)
+void FFTPlan::Inverse(const float* re, const float* im, float* output, float* scratch) const
 {
-   REAL a, b, c, d;
-   REAL q, r, s, t;
-   int i, j, k;
-   for (i = 1, j = n - 1, k = n / 2; i < k; i++, j--)
+   const int m = mHalfSize;
+   float* zRe = scratch;
+   float* zIm = scratch + m;
+   float* workRe = scratch + m * 2;
+   float* workIm = scratch + m * 3;
+
+   //rebuild the packed even/odd spectrum (doubled, to match the unnormalized forward transform), conjugated so a forward pass inverts it
+   for (int k = 0; k < m; ++k)
    {
-      a = real[i];
-      b = real[j];
-      q = a + b;
-      r = a - b;
-      c = imag[i];
-      d = imag[j];
-      s = c + d;
-      t = c - d;
-      real[i] = (q + t) * .5;
-      real[j] = (q - t) * .5;
-      imag[i] = (s - r) * .5;
-      imag[j] = (s + r) * .5;
+      float xRe = re[k];
+      float xIm = -im[k];
+      float cRe = re[m - k];
+      float cIm = im[m - k];
+      float evenRe = xRe + cRe;
+      float evenIm = xIm + cIm;
+      float dRe = xRe - cRe;
+      float dIm = xIm - cIm;
+      float wr = mRealTwiddleRe[k];
+      float wi = -mRealTwiddleIm[k];
+      float oddRe = dRe * wr - dIm * wi;
+      float oddIm = dRe * wi + dIm * wr;
+      zRe[k] = evenRe - oddIm;
+      zIm[k] = -(evenIm + oddRe);
    }
-   mayer_fht(real, n);
-   mayer_fht(imag, n);
-}
 
-void mayer_ifft(int n, REAL* real, REAL* imag)
-{
-   REAL a, b, c, d;
-   REAL q, r, s, t;
-   int i, j, k;
-   mayer_fht(real, n);
-   mayer_fht(imag, n);
-   for (i = 1, j = n - 1, k = n / 2; i < k; i++, j--)
+   ComplexForward(zRe, zIm, workRe, workIm);
+
+   for (int i = 0; i < m; ++i)
    {
-      a = real[i];
-      b = real[j];
-      q = a + b;
-      r = a - b;
-      c = imag[i];
-      d = imag[j];
-      s = c + d;
-      t = c - d;
-      imag[i] = (s + r) * 0.5;
-      imag[j] = (s - r) * 0.5;
-      real[i] = (q - t) * 0.5;
-      real[j] = (q + t) * 0.5;
+      output[i * 2] = zRe[i];
+      output[i * 2 + 1] = -zIm[i];
    }
 }
 
-void mayer_realfft(int n, REAL* real)
+FFT::FFT(int nfft)
+: mPlan(FFTPlan::Get(nfft))
+, mNfft(nfft)
 {
-   REAL a, b;
-   int i, j, k;
+   mScratch.resize(mPlan.GetScratchSize() + nfft / 2 + 1);
+}
 
-   mayer_fht(real, n);
-   for (i = 1, j = n - 1, k = n / 2; i < k; i++, j--)
-   {
-      a = real[i];
-      b = real[j];
-      real[j] = (a - b) * 0.5;
-      real[i] = (a + b) * 0.5;
-   }
+FFT::~FFT()
+{
 }
 
-void mayer_realifft(int n, REAL* real)
+// Perform forward FFT of real data
+// Accepts:
+//   input - pointer to an array of (real) input values, size nfft
+//   output_re - pointer to an array of the real part of the output,
+//     size nfft/2 + 1
+//   output_im - pointer to an array of the imaginary part of the output,
+//     size nfft/2 + 1
+//   the imaginary part keeps the layout of the hartley-based transform this used to be built on: output_im[k] holds bin k+1,
+//   and output_im[nfft/2 - 1] repeats the nyquist bin's real part
+void FFT::Forward(float* input, float* output_re, float* output_im)
 {
-   REAL a, b;
-   int i, j, k;
+   int hnfft = mNfft / 2;
 
-   for (i = 1, j = n - 1, k = n / 2; i < k; i++, j--)
-   {
-      a = real[i];
-      b = real[j];
-      real[j] = (a - b);
-      real[i] = (a + b);
-   }
-   mayer_fht(real, n);
+   mPlan.Forward(input, output_re, output_im, mScratch.data());
+
+   for (int ti = 0; ti < hnfft - 1; ti++)
+      output_im[ti] = output_im[ti + 1];
+   output_im[hnfft - 1] = output_re[hnfft];
+   output_im[hnfft] = 0;
+}
+
+// Perform inverse FFT, returning real data
+// Accepts:
+//   input_re - pointer to an array of the real part of the output,
+//     size nfft/2 + 1
+//   input_im - pointer to an array of the imaginary part of the output,
+//     size nfft/2 + 1, in the layout Forward() produces
+//   output - pointer to an array of (real) input values, size nfft
+void FFT::Inverse(float* input_re, float* input_im, float* output)
+{
+   int hnfft = mNfft / 2;
+
+   float* im = mScratch.data() + mPlan.GetScratchSize();
+   im[0] = 0;
+   for (int ti = 1; ti < hnfft; ti++)
+      im[ti] = input_im[ti - 1];
+   im[hnfft] = 0;
+
+   mPlan.Inverse(input_re, im, output, mScratch.data());
 }
 
 void FFTData::Clear()
@@ -25,9 +25,40 @@
 
 #pragma once
 
+
 #include "SynthGlobals.h"
 
-// Variables for FFT routine
+#include <vector>
+
+//twiddle tables (and a hann window) for one power-of-two transform size.
+//plans are built the first time a size is asked for, and shared by every FFT of that size
+class FFTPlan
+{
+public:
+   static const FFTPlan& Get(int size);
+
+   int GetSize() const { return mSize; }
+   const float* GetHannWindow() const { return mHannWindow.data(); }
+   int GetScratchSize() const { return mSize * 2; }
+
+   //real-to-complex. for k in [0, size/2], re[k] = sum(x[n] * cos(2*pi*k*n/size)) and im[k] = sum(x[n] * sin(2*pi*k*n/size))
+   void Forward(const float* input, float* re, float* im, float* scratch) const;
+   //the inverse of Forward(), unnormalized, so output comes back size times larger than the original
+   void Inverse(const float* re, const float* im, float* output, float* scratch) const;
+
+private:
+   explicit FFTPlan(int size);
+   void ComplexForward(float*& re, float*& im, float*& workRe, float*& workIm) const;
+
+   int mSize{ 0 };
+   int mHalfSize{ 0 }; //the real transform runs as a complex transform of half the size
+   std::vector<float> mTwiddleRe; //exp(-2*pi*i*j/mHalfSize), for the complex stages
+   std::vector<float> mTwiddleIm;
+   std::vector<float> mRealTwiddleRe; //exp(-2*pi*i*k/mSize), for splitting the complex result into the real spectrum
+   std::vector<float> mRealTwiddleIm;
+   std::vector<float> mHannWindow;
+};
+
 class FFT
 {
 public:
@@ -35,11 +66,12 @@ public:
    ~FFT();
    void Forward(float* input, float* output_re, float* output_im);
    void Inverse(float* input_re, float* input_im, float* output);
+   const float* GetHannWindow() const { return mPlan.GetHannWindow(); }
 
 private:
+   const FFTPlan& mPlan;
    int mNfft{ 0 }; // size of FFT
-   int mNumfreqs{ 0 }; // number of frequencies represented (nfft/2 + 1)
-   float* mFft_data{ nullptr }; // array for writing/reading to/from FFT function
+   std::vector<float> mScratch; //per instance, so FFTs of the same size can run on different threads
 };
 
 struct FFTData
@@ -69,14 +101,3 @@ struct FFTData
    float* mImaginaryValues{ nullptr };
    float* mTimeDomain{ nullptr };
 };
-
-
-#ifndef MAYER_H
-#define MAYER_H
-
-#define REAL float
-
-void mayer_realfft(int n, REAL* real);
-void mayer_realifft(int n, REAL* real);
-
-#endif
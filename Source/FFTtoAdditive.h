@@ -27,8 +27,8 @@
 
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "STFT.h"
+#include "AdditiveBank.h"
 #include "Slider.h"
 #include "BiquadFilterEffect.h"
 
@@ -66,7 +66,6 @@ public:
 
 private:
    void DrawViz();
-   float SinSample(float phase);
 
    //IDrawableModule
    void DrawModule() override;
@@ -76,13 +75,9 @@ private:
       h = 170;
    }
 
-   FFTData mFFTData;
-
-   float* mWindower{ nullptr };
-
-   ::FFT mFFT;
-   RollingBuffer mRollingInputBuffer;
-   RollingBuffer mRollingOutputBuffer;
+   STFT mSTFT;
+   FFTData mFFTData; //amplitude and phase of each partial, from the latest frame
+   AdditiveBank mBank;
 
    float mInputPreamp{ 1 };
    float mValue1{ 1 };
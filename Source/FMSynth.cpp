@@ -63,6 +63,7 @@ FMSynth::FMSynth()
    mVoiceParams.mModIdx2 = 0;
    mVoiceParams.mPhaseOffset2 = 0;
    mVoiceParams.mVol = 1.f;
+   mVoiceParams.mOperators[0].mLevel = 1;
 
    mPolyMgr.Init(kVoiceType_FM, &mVoiceParams);
 }
@@ -112,6 +113,54 @@ void FMSynth::CreateUIControls()
 
    mModSlider->SetMode(FloatSlider::kSquare);
    mModSlider2->SetMode(FloatSlider::kSquare);
+
+   mModeSelector = new DropdownList(this, "mode", 4, 204, (int*)(&mVoiceParams.mMode), 80);
+   mModeSelector->AddLabel("classic", kFMMode_Classic);
+   mModeSelector->AddLabel("operators", kFMMode_Operators);
+
+   mAlgorithmSelector = new DropdownList(this, "algorithm", 4, 4, &mVoiceParams.mAlgorithm, 80);
+   for (int i = 0; i < kNumFMAlgorithms; ++i)
+      mAlgorithmSelector->AddLabel(FMVoice::GetAlgorithmName(i).c_str(), i);
+   mFeedbackSlider = new FloatSlider(this, "feedback", mVolSlider, kAnchor_Below, 80, 15, &mVoiceParams.mFeedback, 0, 1);
+   for (int op = 0; op < kNumFMOperators; ++op)
+   {
+      std::string number = ofToString(op + 1);
+      OperatorControls& controls = mOperatorControls[op];
+      controls.mEnvelopeDisplay = new ADSRDisplay(this, ("op" + number + "env").c_str(), 4, 50 + op * 38, 80, 34, &mVoiceParams.mOperators[op].mADSR);
+      controls.mRatioSlider = new FloatSlider(this, ("ratio" + number).c_str(), 94, 50 + op * 38, 80, 15, &mVoiceParams.mOperators[op].mRatio, .125f, 16, 3);
+      controls.mLevelSlider = new FloatSlider(this, ("level" + number).c_str(), controls.mRatioSlider, kAnchor_Below, 80, 15, &mVoiceParams.mOperators[op].mLevel, 0, 1);
+      controls.mRatioSlider->SetMode(FloatSlider::kSquare);
+   }
+
+   UpdateVisibleControls();
+}
+
+void FMSynth::UpdateVisibleControls()
+{
+   bool classic = mVoiceParams.mMode == kFMMode_Classic;
+   mAdsrDisplayVol->SetShowing(classic);
+   mPhaseOffsetSlider0->SetShowing(classic);
+   mAdsrDisplayHarm->SetShowing(classic);
+   mAdsrDisplayMod->SetShowing(classic);
+   mHarmRatioBaseDropdown->SetShowing(classic);
+   mHarmSlider->SetShowing(classic);
+   mModSlider->SetShowing(classic);
+   mPhaseOffsetSlider1->SetShowing(classic);
+   mAdsrDisplayHarm2->SetShowing(classic);
+   mAdsrDisplayMod2->SetShowing(classic);
+   mHarmRatioBaseDropdown2->SetShowing(classic);
+   mHarmSlider2->SetShowing(classic);
+   mModSlider2->SetShowing(classic);
+   mPhaseOffsetSlider2->SetShowing(classic);
+
+   mAlgorithmSelector->SetShowing(!classic);
+   mFeedbackSlider->SetShowing(!classic);
+   for (auto& controls : mOperatorControls)
+   {
+      controls.mEnvelopeDisplay->SetShowing(!classic);
+      controls.mRatioSlider->SetShowing(!classic);
+      controls.mLevelSlider->SetShowing(!classic);
+   }
 }
 
 FMSynth::~FMSynth()
@@ -140,8 +189,9 @@ void FMSynth::Process(double time)
    SyncOutputBuffer(mWriteBuffer.NumActiveChannels());
    for (int ch = 0; ch < mWriteBuffer.NumActiveChannels(); ++ch)
    {
-      GetVizBuffer()->WriteChunk(mWriteBuffer.GetChannel(ch), mWriteBuffer.BufferSize(), ch);
-      Add(target->GetBuffer()->GetChannel(ch), mWriteBuffer.GetChannel(ch), gBufferSize);
+      GetVizBuffer()->WriteChunk(mWriteBuffer.GetChannelReadOnly(ch), mWriteBuffer.BufferSize(), ch);
+      if (!mWriteBuffer.IsSilent(ch)) //no voices playing
+         Add(target->GetBuffer()->GetChannel(ch), mWriteBuffer.GetChannelReadOnly(ch), gBufferSize);
    }
 }
 
@@ -160,11 +210,15 @@ void FMSynth::PlayNote(NoteMessage note)
    {
       mPolyMgr.Start(note.time, note.pitch, note.velocity / 127.0f, note.voiceIdx, note.modulation);
       mVoiceParams.mOscADSRParams.Start(note.time, 1); //for visualization
+      for (auto& op : mVoiceParams.mOperators)
+         op.mADSR.Start(note.time, 1);
    }
    else
    {
       mPolyMgr.Stop(note.time, note.pitch, note.voiceIdx);
       mVoiceParams.mOscADSRParams.Stop(note.time); //for visualization
+      for (auto& op : mVoiceParams.mOperators)
+         op.mADSR.Stop(note.time);
    }
 
    if (mDrawDebug)
@@ -181,12 +235,29 @@ void FMSynth::DrawModule()
    if (Minimized() || IsVisible() == false)
       return;
 
+   UpdateVisibleControls(); //the mode can change from a loaded state too
+   mModeSelector->Draw();
+   mVolSlider->Draw();
+
+   if (mVoiceParams.mMode == kFMMode_Operators)
+   {
+      mAlgorithmSelector->Draw();
+      mFeedbackSlider->Draw();
+      for (int op = 0; op < kNumFMOperators; ++op)
+      {
+         mOperatorControls[op].mEnvelopeDisplay->Draw();
+         mOperatorControls[op].mRatioSlider->Draw();
+         mOperatorControls[op].mLevelSlider->Draw();
+         DrawTextNormal("op" + ofToString(op + 1), mOperatorControls[op].mEnvelopeDisplay->GetPosition(true).x, mOperatorControls[op].mEnvelopeDisplay->GetPosition(true).y + 10);
+      }
+      return;
+   }
+
    mAdsrDisplayVol->Draw();
    mAdsrDisplayHarm->Draw();
    mAdsrDisplayMod->Draw();
    mHarmSlider->Draw();
    mModSlider->Draw();
-   mVolSlider->Draw();
    mPhaseOffsetSlider0->Draw();
    mHarmRatioBaseDropdown->Draw();
    mPhaseOffsetSlider1->Draw();
@@ -234,6 +305,11 @@ void FMSynth::DropdownUpdated(DropdownList* list, int oldVal, double time)
 {
    if (list == mHarmRatioBaseDropdown || list == mHarmRatioBaseDropdown2)
       UpdateHarmonicRatio();
+   if (list == mModeSelector)
+   {
+      mPolyMgr.KillAll();
+      UpdateVisibleControls();
+   }
 }
 
 void FMSynth::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
@@ -251,7 +327,8 @@ void FMSynth::CheckboxUpdated(Checkbox* checkbox, double time)
 void FMSynth::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
-   mModuleSaveData.LoadInt("voicelimit", moduleInfo, -1, -1, kNumVoices);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, -1, -1, kMaxPolyphony);
+   mModuleSaveData.LoadInt("cpu_priority", moduleInfo, 0, 0, CpuGovernor::kNumLevels - 1);
    EnumMap oversamplingMap;
    oversamplingMap["1"] = 1;
    oversamplingMap["2"] = 2;
@@ -272,6 +349,7 @@ void FMSynth::SetUpFromSaveData()
       mPolyMgr.SetVoiceLimit(voiceLimit);
    else
       mPolyMgr.SetVoiceLimit(kNumVoices);
+   mPolyMgr.SetPriority(mModuleSaveData.GetInt("cpu_priority"));
 
    bool mono = mModuleSaveData.GetBool("mono");
    mWriteBuffer.SetNumActiveChannels(mono ? 1 : 2);
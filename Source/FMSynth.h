@@ -34,6 +34,8 @@
 #include "DropdownList.h"
 #include "ADSRDisplay.h"
 
+#include <array>
+
 class FMSynth : public IAudioSource, public INoteReceiver, public IDrawableModule, public IDropdownListener, public IFloatSliderListener
 {
 public:
@@ -43,6 +45,7 @@ public:
    static bool AcceptsAudio() { return false; }
    static bool AcceptsNotes() { return true; }
    static bool AcceptsPulses() { return false; }
+   static bool CanConstructOffThread() { return true; }
 
    void CreateUIControls() override;
 
@@ -67,6 +70,7 @@ public:
 
 private:
    void UpdateHarmonicRatio();
+   void UpdateVisibleControls();
 
    //IDrawableModule
    void DrawModule() override;
@@ -74,7 +78,7 @@ private:
    void GetModuleDimensions(float& width, float& height) override
    {
       width = 180;
-      height = 203;
+      height = 222;
    }
 
    PolyphonyMgr mPolyMgr;
@@ -102,5 +106,16 @@ private:
    DropdownList* mHarmRatioBaseDropdown2{ nullptr };
    FloatSlider* mPhaseOffsetSlider2{ nullptr };
 
+   DropdownList* mModeSelector{ nullptr };
+   DropdownList* mAlgorithmSelector{ nullptr };
+   FloatSlider* mFeedbackSlider{ nullptr };
+   struct OperatorControls
+   {
+      ADSRDisplay* mEnvelopeDisplay{ nullptr };
+      FloatSlider* mRatioSlider{ nullptr };
+      FloatSlider* mLevelSlider{ nullptr };
+   };
+   std::array<OperatorControls, kNumFMOperators> mOperatorControls;
+
    ChannelBuffer mWriteBuffer;
 };
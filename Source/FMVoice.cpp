@@ -31,6 +31,36 @@
 #include "ChannelBuffer.h"
 #include "PolyphonyMgr.h"
 
+namespace
+{
+   //operators are numbered from 1 in the names and from 0 in the bits. higher operators only ever modulate lower ones,
+   //so rendering from the last operator down has every modulator ready before the operators it feeds
+   struct FMAlgorithm
+   {
+      const char* mName;
+      unsigned char mModulators[kNumFMOperators]; //which operators modulate each operator
+      unsigned char mCarriers; //which operators are heard
+   };
+
+   const FMAlgorithm kAlgorithms[kNumFMAlgorithms] = {
+      { "4>3>2>1", { 1 << 1, 1 << 2, 1 << 3, 0 }, 1 << 0 },
+      { "(3+4)>2>1", { 1 << 1, (1 << 2) | (1 << 3), 0, 0 }, 1 << 0 },
+      { "(3>2 + 4)>1", { (1 << 1) | (1 << 3), 1 << 2, 0, 0 }, 1 << 0 },
+      { "(2 + 4>3)>1", { (1 << 1) | (1 << 2), 0, 1 << 3, 0 }, 1 << 0 },
+      { "2>1 + 4>3", { 1 << 1, 0, 1 << 3, 0 }, (1 << 0) | (1 << 2) },
+      { "4>(1+2+3)", { 1 << 3, 1 << 3, 1 << 3, 0 }, (1 << 0) | (1 << 1) | (1 << 2) },
+      { "4>3 + 2 + 1", { 0, 0, 1 << 3, 0 }, (1 << 0) | (1 << 1) | (1 << 2) },
+      { "1+2+3+4", { 0, 0, 0, 0 }, (1 << 0) | (1 << 1) | (1 << 2) | (1 << 3) }
+   };
+
+   const float kModulatorDepth = FTWO_PI * 2; //how far a modulator at full level pushes the phase of what it modulates
+
+   const FMAlgorithm& GetAlgorithm(int algorithm)
+   {
+      return kAlgorithms[MIN(MAX(algorithm, 0), kNumFMAlgorithms - 1)];
+   }
+}
+
 FMVoice::FMVoice(IDrawableModule* owner)
 : mOwner(owner)
 {
@@ -40,11 +70,43 @@ FMVoice::~FMVoice()
 {
 }
 
+//static
+std::string FMVoice::GetAlgorithmName(int algorithm)
+{
+   return ofToString(algorithm + 1) + ": " + GetAlgorithm(algorithm).mName;
+}
+
 bool FMVoice::IsDone(double time)
 {
+   if (mVoiceParams->mMode == kFMMode_Operators)
+   {
+      const FMAlgorithm& algorithm = GetAlgorithm(mVoiceParams->mAlgorithm);
+      for (int op = 0; op < kNumFMOperators; ++op)
+      {
+         if ((algorithm.mCarriers & (1 << op)) && !mOperatorEnvelopes[op].IsDone(time))
+            return false;
+      }
+      return true;
+   }
    return mOsc.GetADSR()->IsDone(time);
 }
 
+float FMVoice::GetLevel(double time)
+{
+   if (mVoiceParams->mMode == kFMMode_Operators)
+   {
+      const FMAlgorithm& algorithm = GetAlgorithm(mVoiceParams->mAlgorithm);
+      float level = 0;
+      for (int op = 0; op < kNumFMOperators; ++op)
+      {
+         if (algorithm.mCarriers & (1 << op))
+            level = MAX(level, mOperatorEnvelopes[op].Value(time) * mVoiceParams->mOperators[op].mLevel);
+      }
+      return level;
+   }
+   return mOsc.GetADSR()->Value(time);
+}
+
 bool FMVoice::Process(double time, ChannelBuffer* out, int oversampling)
 {
    PROFILER(FMVoice);
@@ -57,6 +119,7 @@ bool FMVoice::Process(double time, ChannelBuffer* out, int oversampling)
    double sampleIncrementMs = gInvSampleRateMs;
    ChannelBuffer* destBuffer = out;
 
+   mOversampler.SetFactor(oversampling);
    if (oversampling != 1)
    {
       gMidiVoiceWorkChannelBuffer.SetNumActiveChannels(channels);
@@ -66,14 +129,59 @@ bool FMVoice::Process(double time, ChannelBuffer* out, int oversampling)
       sampleIncrementMs /= oversampling;
    }
 
+   if ((int)mScratch.size() < bufferSize * (kNumFMOperators + 3))
+      mScratch.resize(bufferSize * (kNumFMOperators + 3));
+   float* block = mScratch.data();
+
+   if (mVoiceParams->mMode == kFMMode_Operators)
+      RenderOperators(time, block, bufferSize, oversampling, sampleIncrementMs);
+   else
+      RenderClassic(time, block, bufferSize, oversampling, sampleIncrementMs);
+
+   if (channels == 1)
+   {
+      Add(destBuffer->GetChannel(0), block, bufferSize);
+   }
+   else
+   {
+      AddWithGain(destBuffer->GetChannel(0), block, GetLeftPanGain(GetPan()), bufferSize);
+      AddWithGain(destBuffer->GetChannel(1), block, GetRightPanGain(GetPan()), bufferSize);
+   }
+
+   if (oversampling != 1)
+   {
+      bufferSize /= oversampling;
+      for (int ch = 0; ch < channels; ++ch)
+      {
+         mOversampler.Downsample(ch, destBuffer->GetChannel(ch), destBuffer->GetChannel(ch), bufferSize);
+         Add(out->GetChannel(ch), destBuffer->GetChannel(ch), bufferSize);
+      }
+   }
+
+   return true;
+}
+
+void FMVoice::RenderClassic(double time, float* out, int bufferSize, int oversampling, double sampleIncrementMs)
+{
+   float* oscEnv = out + bufferSize;
+   float* harmEnv = oscEnv + bufferSize;
+   float* modIdxEnv = harmEnv + bufferSize;
+   float* harmEnv2 = modIdxEnv + bufferSize;
+   float* modIdxEnv2 = harmEnv2 + bufferSize;
+   mOsc.GetADSR()->RenderBlock(time, oscEnv, bufferSize, sampleIncrementMs);
+   mHarm.GetADSR()->RenderBlock(time, harmEnv, bufferSize, sampleIncrementMs);
+   mModIdx.RenderBlock(time, modIdxEnv, bufferSize, sampleIncrementMs);
+   mHarm2.GetADSR()->RenderBlock(time, harmEnv2, bufferSize, sampleIncrementMs);
+   mModIdx2.RenderBlock(time, modIdxEnv2, bufferSize, sampleIncrementMs);
+
    for (int pos = 0; pos < bufferSize; ++pos)
    {
       if (mOwner)
          mOwner->ComputeSliders(pos / oversampling);
 
       float oscFreq = TheScale->PitchToFreq(GetPitch(pos / oversampling));
-      float harmFreq = oscFreq * mHarm.GetADSR()->Value(time) * mVoiceParams->mHarmRatio;
-      float harmFreq2 = harmFreq * mHarm2.GetADSR()->Value(time) * mVoiceParams->mHarmRatio2;
+      float harmFreq = oscFreq * harmEnv[pos] * mVoiceParams->mHarmRatio;
+      float harmFreq2 = harmFreq * harmEnv2[pos] * mVoiceParams->mHarmRatio2;
 
       float harmPhaseInc2 = GetPhaseInc(harmFreq2) / oversampling;
 
@@ -83,7 +191,7 @@ bool FMVoice::Process(double time, ChannelBuffer* out, int oversampling)
          mHarmPhase2 -= FTWO_PI;
       }
 
-      float modHarmFreq = harmFreq + mHarm2.Audio(time, mHarmPhase2 + mVoiceParams->mPhaseOffset2) * harmFreq2 * mModIdx2.Value(time) * mVoiceParams->mModIdx2;
+      float modHarmFreq = harmFreq + Oscillator::Sin(mHarmPhase2 + mVoiceParams->mPhaseOffset2) * harmEnv2[pos] * harmFreq2 * modIdxEnv2[pos] * mVoiceParams->mModIdx2;
 
       float harmPhaseInc = GetPhaseInc(modHarmFreq) / oversampling;
 
@@ -93,7 +201,7 @@ bool FMVoice::Process(double time, ChannelBuffer* out, int oversampling)
          mHarmPhase -= FTWO_PI;
       }
 
-      float modOscFreq = oscFreq + mHarm.Audio(time, mHarmPhase + mVoiceParams->mPhaseOffset1) * harmFreq * mModIdx.Value(time) * mVoiceParams->mModIdx;
+      float modOscFreq = oscFreq + Oscillator::Sin(mHarmPhase + mVoiceParams->mPhaseOffset1) * harmEnv[pos] * harmFreq * modIdxEnv[pos] * mVoiceParams->mModIdx;
       float oscPhaseInc = GetPhaseInc(modOscFreq) / oversampling;
 
       mOscPhase += oscPhaseInc;
@@ -102,39 +210,71 @@ bool FMVoice::Process(double time, ChannelBuffer* out, int oversampling)
          mOscPhase -= FTWO_PI;
       }
 
-      float sample = mOsc.Audio(time, mOscPhase + mVoiceParams->mPhaseOffset0) * mVoiceParams->mVol / 20.0f;
-      if (channels == 1)
-      {
-         destBuffer->GetChannel(0)[pos] += sample;
-      }
-      else
-      {
-         destBuffer->GetChannel(0)[pos] += sample * GetLeftPanGain(GetPan());
-         destBuffer->GetChannel(1)[pos] += sample * GetRightPanGain(GetPan());
-      }
-
-      time += sampleIncrementMs;
+      out[pos] = Oscillator::Sin(mOscPhase + mVoiceParams->mPhaseOffset0) * oscEnv[pos] * mVoiceParams->mVol / 20.0f;
    }
+}
 
-   if (oversampling != 1)
+//pitch and operator settings are read once a buffer, so every operator can be rendered as a whole block
+void FMVoice::RenderOperators(double time, float* out, int bufferSize, int oversampling, double sampleIncrementMs)
+{
+   if (mOwner)
+      mOwner->ComputeSliders(0);
+
+   const FMAlgorithm& algorithm = GetAlgorithm(mVoiceParams->mAlgorithm);
+   float freq = TheScale->PitchToFreq(GetPitch(0));
+   float* envelope = out + bufferSize;
+   float* phases = envelope + bufferSize;
+   float* operatorOut[kNumFMOperators];
+   for (int op = 0; op < kNumFMOperators; ++op)
+      operatorOut[op] = phases + bufferSize * (op + 1);
+
+   Clear(out, bufferSize);
+   int numCarriers = 0;
+   for (int op = kNumFMOperators - 1; op >= 0; --op)
    {
-      //assume power-of-two
-      while (oversampling > 1)
+      const FMOperatorParams& params = mVoiceParams->mOperators[op];
+      bool isCarrier = algorithm.mCarriers & (1 << op);
+      float phaseInc = GetPhaseInc(freq * params.mRatio) / oversampling;
+      float* opOut = operatorOut[op];
+
+      for (int i = 0; i < bufferSize; ++i)
+         phases[i] = mOperatorPhases[op] + phaseInc * i;
+      for (int source = op + 1; source < kNumFMOperators; ++source)
       {
+         if (algorithm.mModulators[op] & (1 << source))
+            Add(phases, operatorOut[source], bufferSize);
+      }
+
+      if (op == kNumFMOperators - 1 && mVoiceParams->mFeedback > 0)
+      {
+         //feeding back needs the sample before, so this one goes a sample at a time
+         float feedback = mVoiceParams->mFeedback * FPI;
          for (int i = 0; i < bufferSize; ++i)
          {
-            for (int ch = 0; ch < channels; ++ch)
-               destBuffer->GetChannel(ch)[i] = (destBuffer->GetChannel(ch)[i * 2] + destBuffer->GetChannel(ch)[i * 2 + 1]) / 2;
+            opOut[i] = Oscillator::Sin(phases[i] + (mFeedbackHistory[0] + mFeedbackHistory[1]) * .5f * feedback);
+            mFeedbackHistory[1] = mFeedbackHistory[0];
+            mFeedbackHistory[0] = opOut[i];
          }
-         oversampling /= 2;
-         bufferSize /= 2;
+      }
+      else
+      {
+         Oscillator::RenderSinPhases(phases, opOut, bufferSize);
       }
 
-      for (int ch = 0; ch < channels; ++ch)
-         Add(out->GetChannel(ch), destBuffer->GetChannel(ch), bufferSize);
+      mOperatorEnvelopes[op].RenderBlock(time, envelope, bufferSize, sampleIncrementMs);
+      Mult(opOut, envelope, bufferSize);
+      Mult(opOut, isCarrier ? params.mLevel : params.mLevel * kModulatorDepth, bufferSize);
+      if (isCarrier)
+      {
+         Add(out, opOut, bufferSize);
+         ++numCarriers;
+      }
+
+      mOperatorPhases[op] += phaseInc * bufferSize;
+      mOperatorPhases[op] -= FTWO_PI * floorf(mOperatorPhases[op] / FTWO_PI);
    }
 
-   return true;
+   Mult(out, mVoiceParams->mVol / 20.0f / MAX(1, numCarriers), bufferSize);
 }
 
 void FMVoice::Start(double time, float target)
@@ -158,6 +298,13 @@ void FMVoice::Start(double time, float target)
                 mVoiceParams->mHarmRatioADSRParams2);
    mModIdx2.Start(time, 1,
                   mVoiceParams->mModIdxADSRParams2);
+
+   const FMAlgorithm& algorithm = GetAlgorithm(mVoiceParams->mAlgorithm);
+   for (int op = 0; op < kNumFMOperators; ++op)
+   {
+      mOperatorEnvelopes[op].Set(mVoiceParams->mOperators[op].mADSR);
+      mOperatorEnvelopes[op].Start(time, (algorithm.mCarriers & (1 << op)) ? target : 1);
+   }
 }
 
 void FMVoice::Stop(double time)
@@ -171,6 +318,8 @@ void FMVoice::Stop(double time)
       mHarm2.Stop(time);
    if (mModIdx2.GetR() > 1)
       mModIdx2.Stop(time);
+   for (int op = 0; op < kNumFMOperators; ++op)
+      mOperatorEnvelopes[op].Stop(time);
 }
 
 void FMVoice::ClearVoice()
@@ -183,6 +332,13 @@ void FMVoice::ClearVoice()
    mOscPhase = 0;
    mHarmPhase = 0;
    mHarmPhase2 = 0;
+   for (int op = 0; op < kNumFMOperators; ++op)
+   {
+      mOperatorEnvelopes[op].Clear();
+      mOperatorPhases[op] = 0;
+   }
+   mFeedbackHistory[0] = 0;
+   mFeedbackHistory[1] = 0;
 }
 
 void FMVoice::SetVoiceParams(IVoiceParams* params)
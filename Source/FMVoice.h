@@ -29,12 +29,32 @@
 #include "IVoiceParams.h"
 #include "ADSR.h"
 #include "EnvOscillator.h"
+#include "Oversampler.h"
+
+#include <vector>
 
 class IDrawableModule;
 
+enum FMMode
+{
+   kFMMode_Classic, //a carrier, a modulator and a modulator of the modulator, each with a ratio envelope
+   kFMMode_Operators //four sine operators wired up by one of kNumFMAlgorithms, like a dx or tx
+};
+
+const int kNumFMOperators = 4;
+const int kNumFMAlgorithms = 8;
+
+struct FMOperatorParams
+{
+   ::ADSR mADSR{ 1, 0, 1, 10 };
+   float mRatio{ 1 };
+   float mLevel{ 0 };
+};
+
 class FMVoiceParams : public IVoiceParams
 {
 public:
+   FMMode mMode{ kFMMode_Classic };
    ::ADSR mOscADSRParams;
    ::ADSR mModIdxADSRParams;
    ::ADSR mHarmRatioADSRParams;
@@ -48,6 +68,11 @@ public:
    float mPhaseOffset0{ 0 };
    float mPhaseOffset1{ 0 };
    float mPhaseOffset2{ 0 };
+
+   //kFMMode_Operators
+   int mAlgorithm{ 0 };
+   float mFeedback{ 0 }; //of the last operator into itself
+   FMOperatorParams mOperators[kNumFMOperators];
 };
 
 class FMVoice : public IMidiVoice
@@ -63,8 +88,14 @@ public:
    bool Process(double time, ChannelBuffer* out, int oversampling) override;
    void SetVoiceParams(IVoiceParams* params) override;
    bool IsDone(double time) override;
+   float GetLevel(double time) override;
+
+   static std::string GetAlgorithmName(int algorithm);
 
 private:
+   void RenderClassic(double time, float* out, int bufferSize, int oversampling, double sampleIncrementMs);
+   void RenderOperators(double time, float* out, int bufferSize, int oversampling, double sampleIncrementMs);
+
    float mOscPhase{ 0 };
    EnvOscillator mOsc{ kOsc_Sin };
    float mHarmPhase{ 0 };
@@ -73,6 +104,13 @@ private:
    float mHarmPhase2{ 0 };
    EnvOscillator mHarm2{ kOsc_Sin };
    ::ADSR mModIdx2;
+
+   ::ADSR mOperatorEnvelopes[kNumFMOperators];
+   float mOperatorPhases[kNumFMOperators]{};
+   float mFeedbackHistory[2]{};
+
+   std::vector<float> mScratch; //envelopes and operator outputs for a block, and the block itself
    FMVoiceParams* mVoiceParams{ nullptr };
+   Oversampler mOversampler;
    IDrawableModule* mOwner;
 };
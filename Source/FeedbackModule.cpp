@@ -63,6 +63,15 @@ FeedbackModule::~FeedbackModule()
 {
 }
 
+void FeedbackModule::ResetAudioState()
+{
+   mDelay.ResetAudioState();
+   for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
+      mGainScale[i] = 1;
+   if (mFeedbackTarget)
+      mFeedbackTarget->GetBuffer()->Clear(); //the feedback send isn't a target, so AudioFaultGuard doesn't clear it
+}
+
 void FeedbackModule::Process(double time)
 {
    PROFILER(FeedbackModule);
@@ -48,6 +48,8 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //its feedback send isn't one of its targets
+   void ResetAudioState() override;
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    //IFloatSliderListener
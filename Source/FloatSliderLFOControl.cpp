@@ -338,9 +338,27 @@ namespace
    }
 }
 
+void FloatSliderLFOControl::ValueBlock(float* out, int numSamples)
+{
+   if (HasSlidersNeedingCompute())
+   {
+      IModulator::ValueBlock(out, numSamples); //settings are moving too, have to go sample by sample
+      return;
+   }
+
+   ComputeSliders(0);
+   mLFO.ValueBlock(out, numSamples);
+   for (int i = 0; i < numSamples; ++i)
+      out[i] = ShapeLFOValue(out[i]);
+}
+
 float FloatSliderLFOControl::GetLFOValue(int samplesIn /*= 0*/, float forcePhase /*= -1*/)
 {
-   float val = mLFO.Value(samplesIn, forcePhase);
+   return ShapeLFOValue(mLFO.Value(samplesIn, forcePhase));
+}
+
+float FloatSliderLFOControl::ShapeLFOValue(float val)
+{
    if (mUseOldSpreadStyle)
       val = val * (1 - mLFOSettings.mSpread) + (-cosf(val * FPI) + 1) * .5f * mLFOSettings.mSpread;
    else
@@ -92,6 +92,7 @@ public:
 
    //IModulator
    float Value(int samplesIn = 0) override;
+   void ValueBlock(float* out, int numSamples) override;
    bool Active() const override { return mEnabled; }
    bool InitializeWithZeroRange() const override { return true; }
 
@@ -127,6 +128,7 @@ protected:
 private:
    void UpdateVisibleControls();
    float GetLFOValue(int samplesIn = 0, float forcePhase = -1);
+   float ShapeLFOValue(float val);
    float GetTargetMin() const;
    float GetTargetMax() const;
 
@@ -83,12 +83,12 @@ void FollowingSong::Process(double time)
    {
       mLoadSongMutex.lock();
 
-      gWorkChannelBuffer.SetNumActiveChannels(1);
-      if (mSample.ConsumeData(time, &gWorkChannelBuffer, bufferSize, true))
+      gWorkChannelBuffer->SetNumActiveChannels(1);
+      if (mSample.ConsumeData(time, gWorkChannelBuffer, bufferSize, true))
       {
          for (int i = 0; i < bufferSize; ++i)
          {
-            float sample = gWorkChannelBuffer.GetChannel(0)[i] * volSq;
+            float sample = gWorkChannelBuffer->GetChannel(0)[i] * volSq;
             if (mMute)
                sample = 0;
             out[i] += sample;
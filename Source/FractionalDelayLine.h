@@ -0,0 +1,120 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    FractionalDelayLine.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+//a single channel delay line for feedback loops that read one tap per sample, like a plucked string.
+//the length is a power of two so wrapping is a mask, and the fractional part of the delay goes through a
+//first order allpass (thiran) interpolator, which doesn't lowpass the loop the way linear interpolation does
+class FractionalDelayLine
+{
+public:
+   explicit FractionalDelayLine(int maxDelaySamples) { Resize(maxDelaySamples); }
+
+   void Resize(int maxDelaySamples)
+   {
+      int size = 1;
+      while (size < maxDelaySamples + 2)
+         size *= 2;
+      mBuffer.assign(size, 0);
+      mMask = size - 1;
+      mWritePos = 0;
+      mAllpassOut = 0;
+   }
+
+   void Clear()
+   {
+      std::fill(mBuffer.begin(), mBuffer.end(), 0.0f);
+      mAllpassOut = 0;
+   }
+
+   //delay is counted from the sample that's about to be written, so it has to be at least one and a half to interpolate.
+   //returns 0 for delays longer than the line
+   float Read(float delaySamples)
+   {
+      if (delaySamples < 1.5f)
+         delaySamples = 1.5f;
+      if (delaySamples > MaxDelay())
+         return 0;
+
+      //keep the fractional part in [.5, 1.5), where the allpass is well behaved
+      int whole = int(delaySamples - .5f);
+      float fraction = delaySamples - whole;
+      float coefficient = (1 - fraction) / (1 + fraction);
+
+      float newer = mBuffer[(mWritePos - whole) & mMask];
+      float older = mBuffer[(mWritePos - whole - 1) & mMask];
+      mAllpassOut = coefficient * (newer - mAllpassOut) + older;
+      return mAllpassOut;
+   }
+
+   void Write(float sample)
+   {
+      mBuffer[mWritePos] = sample;
+      mWritePos = (mWritePos + 1) & mMask;
+   }
+
+   float MaxDelay() const { return float(mMask - 1); }
+
+   //the allpass only delays by exactly the fractional part at dc, and by a little more or less towards nyquist.
+   //this adjusts a delay so that Read() delays a frequency (in radians per sample) by as close to the amount asked for as it can.
+   //the whole part is kept, since the phase delay jumps where Read() moves from one whole sample to the next
+   static float CompensateForFrequency(float delaySamples, float w)
+   {
+      if (delaySamples < 1.5f)
+         return delaySamples;
+      float lowest = int(delaySamples - .5f) + .5f;
+      float highest = lowest + .999f;
+      float adjusted = delaySamples;
+      for (int i = 0; i < 4; ++i)
+      {
+         adjusted += delaySamples - GetPhaseDelay(adjusted, w);
+         adjusted = adjusted < lowest ? lowest : (adjusted > highest ? highest : adjusted);
+      }
+      return adjusted;
+   }
+
+   static float GetPhaseDelay(float delaySamples, float w)
+   {
+      if (delaySamples < 1.5f)
+         delaySamples = 1.5f;
+      int whole = int(delaySamples - .5f);
+      float fraction = delaySamples - whole;
+      float coefficient = (1 - fraction) / (1 + fraction);
+      //phase of (a + e^-jw) / (1 + a e^-jw)
+      float phase = atan2f(-sinf(w), coefficient + cosf(w)) - atan2f(-coefficient * sinf(w), 1 + coefficient * cosf(w));
+      return whole - phase / w;
+   }
+
+private:
+   std::vector<float> mBuffer;
+   int mMask{ 0 };
+   int mWritePos{ 0 };
+   float mAllpassOut{ 0 };
+};
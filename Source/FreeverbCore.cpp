@@ -0,0 +1,373 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    FreeverbCore.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "FreeverbCore.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace
+{
+   const int kCombTuning[numcombs] = { combtuningL1, combtuningL2, combtuningL3, combtuningL4, combtuningL5, combtuningL6, combtuningL7, combtuningL8 };
+   const int kAllpassTuning[numallpasses] = { allpasstuningL1, allpasstuningL2, allpasstuningL3, allpasstuningL4 };
+   const float kAllpassFeedback = .5f;
+
+   //what freeverb's undenormalise() does, without the branch
+   inline float Undenormalize(float sample)
+   {
+      return fabsf(sample) < FLT_MIN ? 0 : sample;
+   }
+
+#if defined(__wasm_simd128__)
+   const int kGroupSize = 4;
+
+   inline v128_t Undenormalize(v128_t samples)
+   {
+      return wasm_v128_andnot(samples, wasm_f32x4_lt(wasm_f32x4_abs(samples), wasm_f32x4_splat(FLT_MIN)));
+   }
+
+   //four lanes of four samples each into four samples of four lanes each, and back
+   inline void Transpose(v128_t& a, v128_t& b, v128_t& c, v128_t& d)
+   {
+      v128_t t0 = wasm_i32x4_shuffle(a, b, 0, 4, 1, 5);
+      v128_t t1 = wasm_i32x4_shuffle(a, b, 2, 6, 3, 7);
+      v128_t t2 = wasm_i32x4_shuffle(c, d, 0, 4, 1, 5);
+      v128_t t3 = wasm_i32x4_shuffle(c, d, 2, 6, 3, 7);
+      a = wasm_i32x4_shuffle(t0, t2, 0, 1, 4, 5);
+      b = wasm_i32x4_shuffle(t0, t2, 2, 3, 6, 7);
+      c = wasm_i32x4_shuffle(t1, t3, 0, 1, 4, 5);
+      d = wasm_i32x4_shuffle(t1, t3, 2, 3, 6, 7);
+   }
+#endif
+}
+
+FreeverbCore::FreeverbCore()
+{
+   for (int i = 0; i < numcombs; ++i)
+   {
+      mCombs[i].mBuffer.resize(kCombTuning[i]);
+      mCombs[i + numcombs].mBuffer.resize(kCombTuning[i] + stereospread);
+   }
+   for (int i = 0; i < numallpasses; ++i)
+   {
+      mAllpasses[0][i].mBuffer.resize(kAllpassTuning[i]);
+      mAllpasses[1][i].mBuffer.resize(kAllpassTuning[i] + stereospread);
+   }
+   Update();
+}
+
+void FreeverbCore::Update()
+{
+   mWet1 = mWet * (mWidth / 2 + .5f);
+   mWet2 = mWet * ((1 - mWidth) / 2);
+
+   if (mFreeze)
+   {
+      mFeedback = 1;
+      mDamp1 = 0;
+      mGain = muted;
+   }
+   else
+   {
+      mFeedback = mRoomSize;
+      mDamp1 = mDamp;
+      mGain = fixedgain;
+   }
+   mDamp2 = 1 - mDamp1;
+}
+
+void FreeverbCore::Mute()
+{
+   if (mFreeze)
+      return;
+
+   for (DelayLine& comb : mCombs)
+      std::fill(comb.mBuffer.begin(), comb.mBuffer.end(), 0);
+   for (auto& channel : mAllpasses)
+   {
+      for (DelayLine& allpass : channel)
+         std::fill(allpass.mBuffer.begin(), allpass.mBuffer.end(), 0);
+   }
+}
+
+void FreeverbCore::Reset()
+{
+   bool freeze = mFreeze;
+   mFreeze = false;
+   Mute();
+   mFreeze = freeze;
+   std::fill(std::begin(mFilterStore), std::end(mFilterStore), 0);
+}
+
+void FreeverbCore::Process(const float* inputL, const float* inputR, float* outputL, float* outputR, int numSamples)
+{
+   for (int i = 0; i < numSamples; i += kChunkSize)
+   {
+      int chunk = std::min(kChunkSize, numSamples - i);
+      ProcessChunk(inputL + i, inputR + i, outputL + i, outputR + i, chunk);
+   }
+}
+
+void FreeverbCore::ProcessChunk(const float* inputL, const float* inputR, float* outputL, float* outputR, int numSamples)
+{
+   for (int i = 0; i < numSamples; ++i)
+      mInput[i] = (inputL[i] + inputR[i]) * mGain;
+
+   //the delay lines are all longer than the chunk, so none of the chunk's reads see its writes
+   GatherCombs(numSamples);
+   RunCombFilters(numSamples);
+   ScatterCombs(numSamples);
+
+   for (int i = 0; i < numallpasses; ++i)
+   {
+      ProcessAllpass(mAllpasses[0][i], mWetL, numSamples);
+      ProcessAllpass(mAllpasses[1][i], mWetR, numSamples);
+   }
+
+   //one sample at a time, because with a mono buffer the right output reads the left output back as its dry input, as it does in revmodel
+   for (int i = 0; i < numSamples; ++i)
+   {
+      outputL[i] = mWetL[i] * mWet1 + mWetR[i] * mWet2 + inputL[i] * mDry;
+      outputR[i] = mWetR[i] * mWet1 + mWetL[i] * mWet2 + inputR[i] * mDry;
+   }
+}
+
+//reads the chunk's worth of output from every comb into lanes, and sums the combs of each side in the same order revmodel does,
+//so the output is identical
+void FreeverbCore::GatherCombs(int numSamples)
+{
+   std::fill(mWetL, mWetL + numSamples, 0);
+   std::fill(mWetR, mWetR + numSamples, 0);
+
+#if defined(__wasm_simd128__)
+   for (int firstLane = 0; firstLane < kNumLanes; firstLane += kGroupSize)
+   {
+      float* wet = firstLane < numcombs ? mWetL : mWetR;
+      for (int i = 0; i < numSamples;)
+      {
+         int run = numSamples - i;
+         for (int lane = firstLane; lane < firstLane + kGroupSize; ++lane)
+            run = std::min(run, (int)mCombs[lane].mBuffer.size() - mCombs[lane].mPos);
+
+         const float* delayed[kGroupSize];
+         for (int j = 0; j < kGroupSize; ++j)
+            delayed[j] = mCombs[firstLane + j].mBuffer.data() + mCombs[firstLane + j].mPos;
+
+         int j = 0;
+         for (; j + kGroupSize <= run; j += kGroupSize)
+         {
+            v128_t a = Undenormalize(wasm_v128_load(delayed[0] + j));
+            v128_t b = Undenormalize(wasm_v128_load(delayed[1] + j));
+            v128_t c = Undenormalize(wasm_v128_load(delayed[2] + j));
+            v128_t d = Undenormalize(wasm_v128_load(delayed[3] + j));
+            float* sum = wet + i + j;
+            wasm_v128_store(sum, wasm_f32x4_add(wasm_f32x4_add(wasm_f32x4_add(wasm_f32x4_add(wasm_v128_load(sum), a), b), c), d));
+            Transpose(a, b, c, d);
+            float* read = mCombRead + (i + j) * kNumLanes + firstLane;
+            wasm_v128_store(read, a);
+            wasm_v128_store(read + kNumLanes, b);
+            wasm_v128_store(read + kNumLanes * 2, c);
+            wasm_v128_store(read + kNumLanes * 3, d);
+         }
+         for (; j < run; ++j)
+         {
+            for (int k = 0; k < kGroupSize; ++k)
+            {
+               float output = Undenormalize(delayed[k][j]);
+               mCombRead[(i + j) * kNumLanes + firstLane + k] = output;
+               wet[i + j] += output;
+            }
+         }
+
+         i += run;
+         for (int lane = firstLane; lane < firstLane + kGroupSize; ++lane)
+            mCombs[lane].mPos = (mCombs[lane].mPos + run) % (int)mCombs[lane].mBuffer.size();
+      }
+   }
+#else
+   for (int lane = 0; lane < kNumLanes; ++lane)
+   {
+      DelayLine& comb = mCombs[lane];
+      float* wet = lane < numcombs ? mWetL : mWetR;
+      int pos = comb.mPos;
+      int size = (int)comb.mBuffer.size();
+      for (int i = 0; i < numSamples;)
+      {
+         int run = std::min(numSamples - i, size - pos);
+         const float* delayed = comb.mBuffer.data() + pos;
+         float* read = mCombRead + i * kNumLanes + lane;
+         for (int j = 0; j < run; ++j)
+         {
+            float output = Undenormalize(delayed[j]);
+            read[j * kNumLanes] = output;
+            wet[i + j] += output;
+         }
+         i += run;
+         pos = (pos + run) % size;
+      }
+      comb.mPos = pos;
+   }
+#endif
+}
+
+//runs the damping filters of all sixteen combs side by side, working out what each comb writes back
+void FreeverbCore::RunCombFilters(int numSamples)
+{
+#if defined(__wasm_simd128__)
+   const int kGroups = kNumLanes / kGroupSize;
+   v128_t store[kGroups];
+   for (int group = 0; group < kGroups; ++group)
+      store[group] = wasm_v128_load(mFilterStore + group * kGroupSize);
+   const v128_t damp1 = wasm_f32x4_splat(mDamp1);
+   const v128_t damp2 = wasm_f32x4_splat(mDamp2);
+   const v128_t feedback = wasm_f32x4_splat(mFeedback);
+   for (int i = 0; i < numSamples; ++i)
+   {
+      const v128_t input = wasm_f32x4_splat(mInput[i]);
+      for (int group = 0; group < kGroups; ++group)
+      {
+         v128_t output = wasm_v128_load(mCombRead + i * kNumLanes + group * kGroupSize);
+         store[group] = Undenormalize(wasm_f32x4_add(wasm_f32x4_mul(output, damp2), wasm_f32x4_mul(store[group], damp1)));
+         wasm_v128_store(mCombWrite + i * kNumLanes + group * kGroupSize, wasm_f32x4_add(input, wasm_f32x4_mul(store[group], feedback)));
+      }
+   }
+   for (int group = 0; group < kGroups; ++group)
+      wasm_v128_store(mFilterStore + group * kGroupSize, store[group]);
+#else
+   //written lane-wise so the compiler can keep the lanes in vector registers
+   float store[kNumLanes];
+   for (int lane = 0; lane < kNumLanes; ++lane)
+      store[lane] = mFilterStore[lane];
+   for (int i = 0; i < numSamples; ++i)
+   {
+      const float* read = mCombRead + i * kNumLanes;
+      float* write = mCombWrite + i * kNumLanes;
+      for (int lane = 0; lane < kNumLanes; ++lane)
+      {
+         store[lane] = Undenormalize(read[lane] * mDamp2 + store[lane] * mDamp1);
+         write[lane] = mInput[i] + store[lane] * mFeedback;
+      }
+   }
+   for (int lane = 0; lane < kNumLanes; ++lane)
+      mFilterStore[lane] = store[lane];
+#endif
+}
+
+//writes the lanes back into the combs. GatherCombs() has already moved the positions along, so this works back from them
+void FreeverbCore::ScatterCombs(int numSamples)
+{
+#if defined(__wasm_simd128__)
+   for (int firstLane = 0; firstLane < kNumLanes; firstLane += kGroupSize)
+   {
+      int pos[kGroupSize];
+      for (int k = 0; k < kGroupSize; ++k)
+      {
+         const DelayLine& comb = mCombs[firstLane + k];
+         int size = (int)comb.mBuffer.size();
+         pos[k] = (comb.mPos - numSamples + size) % size;
+      }
+
+      for (int i = 0; i < numSamples;)
+      {
+         int run = numSamples - i;
+         for (int k = 0; k < kGroupSize; ++k)
+            run = std::min(run, (int)mCombs[firstLane + k].mBuffer.size() - pos[k]);
+
+         float* delayed[kGroupSize];
+         for (int k = 0; k < kGroupSize; ++k)
+            delayed[k] = mCombs[firstLane + k].mBuffer.data() + pos[k];
+
+         int j = 0;
+         for (; j + kGroupSize <= run; j += kGroupSize)
+         {
+            const float* write = mCombWrite + (i + j) * kNumLanes + firstLane;
+            v128_t a = wasm_v128_load(write);
+            v128_t b = wasm_v128_load(write + kNumLanes);
+            v128_t c = wasm_v128_load(write + kNumLanes * 2);
+            v128_t d = wasm_v128_load(write + kNumLanes * 3);
+            Transpose(a, b, c, d);
+            wasm_v128_store(delayed[0] + j, a);
+            wasm_v128_store(delayed[1] + j, b);
+            wasm_v128_store(delayed[2] + j, c);
+            wasm_v128_store(delayed[3] + j, d);
+         }
+         for (; j < run; ++j)
+         {
+            for (int k = 0; k < kGroupSize; ++k)
+               delayed[k][j] = mCombWrite[(i + j) * kNumLanes + firstLane + k];
+         }
+
+         i += run;
+         for (int k = 0; k < kGroupSize; ++k)
+            pos[k] = (pos[k] + run) % (int)mCombs[firstLane + k].mBuffer.size();
+      }
+   }
+#else
+   for (int lane = 0; lane < kNumLanes; ++lane)
+   {
+      DelayLine& comb = mCombs[lane];
+      int size = (int)comb.mBuffer.size();
+      int pos = (comb.mPos - numSamples + size) % size;
+      for (int i = 0; i < numSamples;)
+      {
+         int run = std::min(numSamples - i, size - pos);
+         float* delayed = comb.mBuffer.data() + pos;
+         const float* write = mCombWrite + i * kNumLanes + lane;
+         for (int j = 0; j < run; ++j)
+            delayed[j] = write[j * kNumLanes];
+         i += run;
+         pos = (pos + run) % size;
+      }
+   }
+#endif
+}
+
+void FreeverbCore::ProcessAllpass(DelayLine& allpass, float* signal, int numSamples)
+{
+   float* buffer = allpass.mBuffer.data();
+   int size = (int)allpass.mBuffer.size();
+   for (int i = 0; i < numSamples;)
+   {
+      //contiguous runs up to the end of the delay line
+      int run = std::min(numSamples - i, size - allpass.mPos);
+      float* delayed = buffer + allpass.mPos;
+      float* x = signal + i;
+      for (int j = 0; j < run; ++j)
+      {
+         float bufout = Undenormalize(delayed[j]);
+         float input = x[j];
+         x[j] = -input + bufout;
+         delayed[j] = input + bufout * kAllpassFeedback;
+      }
+      i += run;
+      allpass.mPos = (allpass.mPos + run) % size;
+   }
+}
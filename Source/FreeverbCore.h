@@ -0,0 +1,95 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    FreeverbCore.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "freeverb/tuning.h"
+
+#include <vector>
+
+//the freeverb algorithm (same tuning, same output as libs/freeverb's revmodel), restructured so it vectorizes.
+//the left and right comb banks run together as sixteen lanes of one filter state, a chunk of samples at a time, and since every
+//delay is longer than a chunk, each allpass can process its whole chunk at once
+class FreeverbCore
+{
+public:
+   FreeverbCore();
+
+   //same ranges as revmodel: room size 0-1, damp and width 0-100, wet and dry as gains
+   void SetRoomSize(float roomSize) { mRoomSize = roomSize; }
+   void SetDamp(float damp) { mDamp = damp * .01f * scaledamp; }
+   void SetWet(float wet) { mWet = wet; }
+   void SetDry(float dry) { mDry = dry; }
+   void SetWidth(float width) { mWidth = width * .01f; }
+   void SetFreeze(bool freeze) { mFreeze = freeze; }
+   void Update(); //applies the settings above
+   void Mute();
+   void Reset(); //Mute(), even when frozen, and the damping filters too
+
+   //input and output buffers may be the same, and left and right may point at the same channel
+   void Process(const float* inputL, const float* inputR, float* outputL, float* outputR, int numSamples);
+
+   static const int kNumLanes = numcombs * 2; //left combs, then right combs
+   static const int kChunkSize = 128; //has to be shorter than the shortest delay line
+
+private:
+   struct DelayLine
+   {
+      std::vector<float> mBuffer;
+      int mPos{ 0 };
+   };
+
+   void ProcessChunk(const float* inputL, const float* inputR, float* outputL, float* outputR, int numSamples);
+   void GatherCombs(int numSamples);
+   void RunCombFilters(int numSamples);
+   void ScatterCombs(int numSamples);
+   void ProcessAllpass(DelayLine& allpass, float* signal, int numSamples);
+
+   float mRoomSize{ initialroom };
+   float mDamp{ initialdamp * .01f * scaledamp };
+   float mWet{ initialwet };
+   float mDry{ initialdry };
+   float mWidth{ initialwidth * .01f };
+   bool mFreeze{ false };
+
+   float mGain{ fixedgain };
+   float mFeedback{ 0 };
+   float mDamp1{ 0 };
+   float mDamp2{ 1 };
+   float mWet1{ 0 };
+   float mWet2{ 0 };
+
+   DelayLine mCombs[kNumLanes];
+   DelayLine mAllpasses[2][numallpasses];
+   alignas(16) float mFilterStore[kNumLanes]{};
+
+   //chunk scratch, lane-interleaved for the combs
+   alignas(16) float mCombRead[kChunkSize * kNumLanes];
+   alignas(16) float mCombWrite[kChunkSize * kNumLanes];
+   float mInput[kChunkSize];
+   float mWetL[kChunkSize];
+   float mWetR[kChunkSize];
+};
@@ -30,13 +30,13 @@
 
 FreeverbEffect::FreeverbEffect()
 {
-   //mFreeverb.setmode(GetParameter(KMode));
-   mFreeverb.setroomsize(mRoomSize);
-   mFreeverb.setdamp(mDamp);
-   mFreeverb.setwet(mWet);
-   mFreeverb.setdry(mDry);
-   mFreeverb.setwidth(mVerbWidth);
-   mFreeverb.update();
+   //mFreeverb.SetFreeze(mFreeze);
+   mFreeverb.SetRoomSize(mRoomSize);
+   mFreeverb.SetDamp(mDamp);
+   mFreeverb.SetWet(mWet);
+   mFreeverb.SetDry(mDry);
+   mFreeverb.SetWidth(mVerbWidth);
+   mFreeverb.Update();
 }
 
 FreeverbEffect::~FreeverbEffect()
@@ -67,7 +67,7 @@ void FreeverbEffect::ProcessAudio(double time, ChannelBuffer* buffer)
 
    if (mNeedUpdate)
    {
-      mFreeverb.update();
+      mFreeverb.Update();
       mNeedUpdate = false;
    }
 
@@ -75,7 +75,7 @@ void FreeverbEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (buffer->NumActiveChannels() <= 1)
       secondChannel = 0;
 
-   mFreeverb.processreplace(buffer->GetChannel(0), buffer->GetChannel(secondChannel), buffer->GetChannel(0), buffer->GetChannel(secondChannel), bufferSize, 1);
+   mFreeverb.Process(buffer->GetChannel(0), buffer->GetChannel(secondChannel), buffer->GetChannel(0), buffer->GetChannel(secondChannel), bufferSize);
 }
 
 void FreeverbEffect::DrawModule()
@@ -119,27 +119,27 @@ void FreeverbEffect::FloatSliderUpdated(FloatSlider* slider, float oldVal, doubl
 {
    if (slider == mRoomSizeSlider)
    {
-      mFreeverb.setroomsize(mRoomSize);
+      mFreeverb.SetRoomSize(mRoomSize);
       mNeedUpdate = true;
    }
    if (slider == mDampSlider)
    {
-      mFreeverb.setdamp(mDamp);
+      mFreeverb.SetDamp(mDamp);
       mNeedUpdate = true;
    }
    if (slider == mWetSlider)
    {
-      mFreeverb.setwet(mWet);
+      mFreeverb.SetWet(mWet);
       mNeedUpdate = true;
    }
    if (slider == mDrySlider)
    {
-      mFreeverb.setdry(mDry);
+      mFreeverb.SetDry(mDry);
       mNeedUpdate = true;
    }
    if (slider == mWidthSlider)
    {
-      mFreeverb.setwidth(mVerbWidth);
+      mFreeverb.SetWidth(mVerbWidth);
       mNeedUpdate = true;
    }
 }
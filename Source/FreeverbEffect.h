@@ -28,7 +28,7 @@
 #include "IAudioEffect.h"
 #include "Slider.h"
 #include "Checkbox.h"
-#include "freeverb/revmodel.hpp"
+#include "FreeverbCore.h"
 
 class FreeverbEffect : public IAudioEffect, public IFloatSliderListener
 {
@@ -46,6 +46,7 @@ public:
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    float GetEffectAmount() override;
    std::string GetType() override { return "freeverb"; }
+   void ResetAudioState() override { mFreeverb.Reset(); }
 
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
@@ -57,7 +58,7 @@ private:
    void DrawModule() override;
    void GetModuleDimensions(float& width, float& height) override;
 
-   revmodel mFreeverb;
+   FreeverbCore mFreeverb;
    bool mNeedUpdate{ false };
    bool mFreeze{ false };
    float mRoomSize{ .5 };
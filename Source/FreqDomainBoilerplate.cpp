@@ -29,20 +29,14 @@
 namespace
 {
    const int fftWindowSize = 1024;
-   const int fftFreqDomainSize = fftWindowSize / 2 + 1;
+   const int fftHopSize = fftWindowSize / 4;
 }
 
 FreqDomainBoilerplate::FreqDomainBoilerplate()
 : IAudioProcessor(gBufferSize)
-, mFFT(fftWindowSize)
-, mRollingInputBuffer(fftWindowSize)
-, mRollingOutputBuffer(fftWindowSize)
-, mFFTData(fftWindowSize, fftFreqDomainSize)
+, mSTFT(fftWindowSize, fftHopSize)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[fftWindowSize];
-   for (int i = 0; i < fftWindowSize; ++i)
-      mWindower[i] = -.5 * cos(FTWO_PI * i / fftWindowSize) + .5;
+   mSTFT.SetSynthesisScale(.0001f); //the level this has always had
 }
 
 void FreqDomainBoilerplate::CreateUIControls()
@@ -59,7 +53,6 @@ void FreqDomainBoilerplate::CreateUIControls()
 
 FreqDomainBoilerplate::~FreqDomainBoilerplate()
 {
-   delete[] mWindower;
 }
 
 void FreqDomainBoilerplate::Process(double time)
@@ -79,51 +72,35 @@ void FreqDomainBoilerplate::Process(double time)
 
    int bufferSize = GetBuffer()->BufferSize();
 
-   mRollingInputBuffer.WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
+   float* wet = gWorkBuffer;
+   const float* inputs[] = { GetBuffer()->GetChannel(0) };
+   mSTFT.Process(inputs, wet, bufferSize, [this, inputPreampSq](int)
+                 {
+                    FFTData& frame = mSTFT.GetFrame();
+                    for (int i = 0; i < mSTFT.GetNumBins(); ++i)
+                    {
+                       float real = frame.mRealValues[i];
+                       float imag = frame.mImaginaryValues[i];
 
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, fftWindowSize, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, fftWindowSize);
-   Mult(mFFTData.mTimeDomain, inputPreampSq, fftWindowSize);
+                       //cartesian to polar
+                       float amp = 2. * sqrtf(real * real + imag * imag) * inputPreampSq;
+                       float phase = atan2(imag, real);
 
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
+                       phase = FloatWrap(phase + mPhaseOffset, FTWO_PI);
 
-   for (int i = 0; i < fftFreqDomainSize; ++i)
-   {
-      float real = mFFTData.mRealValues[i];
-      float imag = mFFTData.mImaginaryValues[i];
+                       //polar to cartesian
+                       real = amp * cos(phase);
+                       imag = amp * sin(phase);
 
-      //cartesian to polar
-      float amp = 2. * sqrtf(real * real + imag * imag);
-      float phase = atan2(imag, real);
-
-      phase = FloatWrap(phase + mPhaseOffset, FTWO_PI);
-
-      //polar to cartesian
-      real = amp * cos(phase);
-      imag = amp * sin(phase);
-
-      mFFTData.mRealValues[i] = real;
-      mFFTData.mImaginaryValues[i] = imag;
-   }
-
-   mFFT.Inverse(mFFTData.mRealValues,
-                mFFTData.mImaginaryValues,
-                mFFTData.mTimeDomain);
-
-   for (int i = 0; i < bufferSize; ++i)
-      mRollingOutputBuffer.Write(0, 0);
-
-   //copy rolling input buffer into working buffer and window it
-   for (int i = 0; i < fftWindowSize; ++i)
-      mRollingOutputBuffer.Accum(fftWindowSize - i - 1, mFFTData.mTimeDomain[i] * mWindower[i] * .0001f, 0);
+                       frame.mRealValues[i] = real;
+                       frame.mImaginaryValues[i] = imag;
+                    }
+                 });
 
    Mult(GetBuffer()->GetChannel(0), (1 - mDryWet) * inputPreampSq, GetBuffer()->BufferSize());
 
    for (int i = 0; i < bufferSize; ++i)
-      GetBuffer()->GetChannel(0)[i] += mRollingOutputBuffer.GetSample(fftWindowSize - i - 1, 0) * volSq * mDryWet;
+      GetBuffer()->GetChannel(0)[i] += wet[i] * volSq * mDryWet;
 
    Add(target->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
 
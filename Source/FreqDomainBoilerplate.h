@@ -27,8 +27,7 @@
 
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "STFT.h"
 #include "Slider.h"
 #include "BiquadFilterEffect.h"
 
@@ -68,13 +67,7 @@ private:
       h = 170;
    }
 
-   FFTData mFFTData;
-
-   float* mWindower{ nullptr };
-
-   ::FFT mFFT;
-   RollingBuffer mRollingInputBuffer;
-   RollingBuffer mRollingOutputBuffer;
+   STFT mSTFT;
 
    float mInputPreamp{ 1 };
    float mValue1{ 1 };
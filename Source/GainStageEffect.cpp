@@ -46,14 +46,20 @@ void GainStageEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   float bufferSize = buffer->BufferSize();
-
-   for (int i = 0; i < bufferSize; ++i)
-   {
-      ComputeSliders(i);
-      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-         buffer->GetChannel(ch)[i] *= mGain;
-   }
+   int bufferSize = buffer->BufferSize();
+   BeginSampleKernel(time, bufferSize);
+   for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+      Mult(buffer->GetChannel(ch), mGains.data(), bufferSize);
+}
+
+SampleKernel* GainStageEffect::BeginSampleKernel(double time, int bufferSize)
+{
+   if ((int)mGains.size() < bufferSize)
+      mGains.resize(bufferSize);
+
+   mGainSlider->ComputeBlock(mGains.data(), bufferSize);
+   mKernel.SetGains(mGains.data());
+   return &mKernel;
 }
 
 void GainStageEffect::DrawModule()
@@ -29,6 +29,7 @@
 #include "IAudioEffect.h"
 #include "Slider.h"
 #include "Checkbox.h"
+#include "SampleKernel.h"
 
 class GainStageEffect : public IAudioEffect, public IFloatSliderListener
 {
@@ -43,6 +44,8 @@ public:
    void ProcessAudio(double time, ChannelBuffer* buffer) override;
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    std::string GetType() override { return "gainstage"; }
+   int GetTailLengthSamples() override { return 0; }
+   SampleKernel* BeginSampleKernel(double time, int bufferSize) override;
 
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
@@ -60,4 +63,6 @@ private:
 
    float mGain{ 1 };
    FloatSlider* mGainSlider{ nullptr };
+   std::vector<float> mGains;
+   GainKernel mKernel;
 };
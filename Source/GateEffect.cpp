@@ -26,9 +26,13 @@
 #include "GateEffect.h"
 #include "SynthGlobals.h"
 #include "Profiler.h"
+#include "ModularSynth.h"
 
 GateEffect::GateEffect()
+: mLevel(gBufferSize)
 {
+   const float kPeakHalfLifeMs = 10;
+   mPeakFollower.SetRelease(kPeakHalfLifeMs / M_LN2);
 }
 
 void GateEffect::CreateUIControls()
@@ -37,6 +41,7 @@ void GateEffect::CreateUIControls()
    mThresholdSlider = new FloatSlider(this, "threshold", 5, 2, 110, 15, &mThreshold, 0, 1);
    mAttackSlider = new FloatSlider(this, "attack", 5, 18, 110, 15, &mAttackTime, .1f, 500);
    mReleaseSlider = new FloatSlider(this, "release", 5, 34, 110, 15, &mReleaseTime, .1f, 500);
+   mSidechainEntry = new TextEntry(this, "sidechain", 5, 50, 9, &mSidechainName);
 
    mThresholdSlider->SetMode(FloatSlider::kSquare);
 }
@@ -48,41 +53,56 @@ void GateEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
+   int numChannels = MIN(buffer->NumActiveChannels(), ChannelBuffer::kMaxNumChannels);
 
    ComputeSliders(0);
 
+   if ((int)mLevel.size() < bufferSize)
+      mLevel.resize(bufferSize);
+   float* level = mLevel.data();
+
+   //key off of a sidechain bus channel in place if we're subscribed to one, otherwise off of our own input
+   ChannelBuffer* key = buffer;
+   if (mSidechainChannel != nullptr)
+   {
+      key = SidechainBus::Read(mSidechainChannel, time).mBuffer;
+      if (key != nullptr && key->BufferSize() < bufferSize)
+         key = nullptr;
+   }
+
+   //ride peaks up instantly, decay exponentially when the signal drops
+   if (key != nullptr)
+   {
+      const float* channels[ChannelBuffer::kMaxNumChannels];
+      int numKeyChannels = MIN(key->NumActiveChannels(), ChannelBuffer::kMaxNumChannels);
+      for (int ch = 0; ch < numKeyChannels; ++ch)
+         channels[ch] = key->GetChannelReadOnly(ch);
+      mDetector.Process(channels, numKeyChannels, bufferSize, level);
+   }
+   else
+   {
+      Clear(level, bufferSize);
+   }
+   mPeakFollower.Process(level, level, bufferSize);
+   mPeak = mPeakFollower.GetValue();
+
+   //level becomes the gate's gain
+   const float attackStep = gInvSampleRateMs / mAttackTime;
+   const float releaseStep = gInvSampleRateMs / mReleaseTime;
+   float envelope = mEnvelope;
    for (int i = 0; i < bufferSize; ++i)
    {
-      const float decayTime = .01f;
-      float scalar = powf(0.5f, 1.0f / (decayTime * gSampleRate));
-      float input = 0;
-      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-         input = MAX(input, fabsf(buffer->GetChannel(ch)[i]));
-
-      if (input >= mPeak)
-      {
-         /* When we hit a peak, ride the peak to the top. */
-         mPeak = input;
-      }
+      if (level[i] >= mThreshold)
+         envelope = MIN(1, envelope + attackStep);
       else
-      {
-         /* Exponential decay of output when signal is low. */
-         mPeak = mPeak * scalar;
-         if (mPeak < FLT_EPSILON)
-            mPeak = 0.0;
-      }
-
-      if (mPeak >= mThreshold && mEnvelope < 1)
-         mEnvelope = MIN(1, mEnvelope + gInvSampleRateMs / mAttackTime);
-      if (mPeak < mThreshold && mEnvelope > 0)
-         mEnvelope = MAX(0, mEnvelope - gInvSampleRateMs / mReleaseTime);
-
-      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-         buffer->GetChannel(ch)[i] *= mEnvelope;
-
-      time += gInvSampleRateMs;
+         envelope = MAX(0, envelope - releaseStep);
+      level[i] = envelope;
    }
+   mEnvelope = envelope;
+
+   for (int ch = 0; ch < numChannels; ++ch)
+      Mult(buffer->GetChannel(ch), level, bufferSize);
 }
 
 void GateEffect::DrawModule()
@@ -90,6 +110,7 @@ void GateEffect::DrawModule()
    mThresholdSlider->Draw();
    mAttackSlider->Draw();
    mReleaseSlider->Draw();
+   mSidechainEntry->Draw();
 
    ofPushStyle();
    ofFill();
@@ -111,3 +132,12 @@ void GateEffect::IntSliderUpdated(IntSlider* slider, int oldVal, double time)
 void GateEffect::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
 {
 }
+
+void GateEffect::TextEntryComplete(TextEntry* entry)
+{
+   if (entry == mSidechainEntry)
+   {
+      mSidechainChannel = SidechainBus::Get().Subscribe(this, mSidechainName);
+      TheSynth->ArrangeAudioSourceDependencies();
+   }
+}
@@ -28,8 +28,11 @@
 #include "IAudioEffect.h"
 #include "Slider.h"
 #include "Checkbox.h"
+#include "DynamicsCore.h"
+#include "TextEntry.h"
+#include "SidechainBus.h"
 
-class GateEffect : public IAudioEffect, public IIntSliderListener, public IFloatSliderListener
+class GateEffect : public IAudioEffect, public IIntSliderListener, public IFloatSliderListener, public ITextEntryListener
 {
 public:
    GateEffect();
@@ -50,6 +53,7 @@ public:
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
    void IntSliderUpdated(IntSlider* slider, int oldVal, double time) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
+   void TextEntryComplete(TextEntry* entry) override;
 
    bool IsEnabled() const override { return mEnabled; }
 
@@ -59,7 +63,7 @@ private:
    void GetModuleDimensions(float& width, float& height) override
    {
       width = 120;
-      height = 50;
+      height = 68;
    }
 
    float mThreshold{ .1 };
@@ -68,6 +72,12 @@ private:
    FloatSlider* mThresholdSlider{ nullptr };
    FloatSlider* mAttackSlider{ nullptr };
    FloatSlider* mReleaseSlider{ nullptr };
+   std::string mSidechainName; //open for a sidechain bus channel rather than for our own input
+   TextEntry* mSidechainEntry{ nullptr };
+   SidechainBus::Channel* mSidechainChannel{ nullptr };
    float mEnvelope{ 0 };
    float mPeak{ 0 };
+   LevelDetector mDetector;
+   EnvelopeFollower mPeakFollower;
+   std::vector<float> mLevel;
 };
@@ -29,8 +29,40 @@
 #include "ChannelBuffer.h"
 #include "juce_dsp/maths/juce_FastMathApproximations.h"
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace
+{
+   //out += a * gainA + b * gainB
+   void MixGrain(float* out, const float* a, float gainA, const float* b, float gainB, int length)
+   {
+#if defined(__wasm_simd128__)
+      v128_t gainA4 = wasm_f32x4_splat(gainA);
+      v128_t gainB4 = wasm_f32x4_splat(gainB);
+      int i = 0;
+      for (; i + 4 <= length; i += 4)
+      {
+         v128_t mix = wasm_f32x4_add(wasm_f32x4_mul(wasm_v128_load(a + i), gainA4), wasm_f32x4_mul(wasm_v128_load(b + i), gainB4));
+         wasm_v128_store(out + i, wasm_f32x4_add(wasm_v128_load(out + i), mix));
+      }
+      for (; i < length; ++i)
+         out[i] += a[i] * gainA + b[i] * gainB;
+#else
+      for (int i = 0; i < length; ++i)
+         out[i] += a[i] * gainA + b[i] * gainB;
+#endif
+   }
+}
+
 Granulator::Granulator()
 {
+   mActiveGrains.reserve(kMaxGrains);
+   mFreeGrains.reserve(kMaxGrains);
+   for (int i = kMaxGrains - 1; i >= 0; --i)
+      mFreeGrains.push_back(i);
+
    Reset();
 }
 
@@ -54,7 +86,56 @@ void Granulator::Reset()
    }
 }
 
+void Granulator::Process(double time, ChannelBuffer* buffer, int bufferLength, double offset, double offsetIncrement, float speed, float* const* output, int numSamples)
+{
+   //spawn everything that's due in this block up front. grains only start sounding at their own start time,
+   //and slots are only reused once a grain has finished, so this can't cut into anything still playing
+   double blockEndTime = time + numSamples * gInvSampleRateMs;
+   bool spawnsDue = mPendingQueuedGrainSpawnTime != -1 || mQueuedGrainSpawnTimes.size_approx() > 0 || (mSpawnGrains && mNextGrainSpawnMs <= blockEndTime);
+   if (spawnsDue)
+   {
+      for (int i = 0; i < numSamples; ++i)
+         SpawnDueGrains(time + i * gInvSampleRateMs, buffer, offset + i * offsetIncrement, speed);
+   }
+
+   UpdateWindowTable();
+
+   for (size_t i = 0; i < mActiveGrains.size();)
+   {
+      Grain& grain = mGrains[mActiveGrains[i]];
+      RenderGrain(grain, time, buffer, bufferLength, output, numSamples);
+
+      if (grain.mEndTime < blockEndTime || grain.mVol == 0)
+      {
+         grain.mActive = false;
+         mFreeGrains.push_back(mActiveGrains[i]);
+         mActiveGrains[i] = mActiveGrains.back();
+         mActiveGrains.pop_back();
+      }
+      else
+      {
+         ++i;
+      }
+   }
+
+   float densityGain = GetDensityGain();
+   for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+   {
+      if (densityGain != 1)
+         Mult(output[ch], densityGain, numSamples);
+      mBiquad[ch].Filter(output[ch], numSamples);
+   }
+}
+
 void Granulator::ProcessFrame(double time, ChannelBuffer* buffer, int bufferLength, double offset, float speed, float* output)
+{
+   float* channels[ChannelBuffer::kMaxNumChannels];
+   for (int ch = 0; ch < ChannelBuffer::kMaxNumChannels; ++ch)
+      channels[ch] = output + ch;
+   Process(time, buffer, bufferLength, offset, 0, speed, channels, 1);
+}
+
+void Granulator::SpawnDueGrains(double time, ChannelBuffer* buffer, double offset, float speed)
 {
    while (true)
    {
@@ -81,15 +162,102 @@ void Granulator::ProcessFrame(double time, ChannelBuffer* buffer, int bufferLeng
 
    if (mSpawnGrains)
       SpawnGrainIfReady(time, mNextGrainSpawnMs, buffer, offset, speed);
+}
 
-   for (int i = 0; i < MAX_GRAINS; ++i)
-      mGrains[i].Process(time, buffer, bufferLength, output, this);
+float Granulator::GetDensityGain() const
+{
+   //lower volume on dense granulation, starting at 4 overlap
+   if (mGrainOverlap <= 4)
+      return 1;
+   if (mGrainOverlap <= kReferenceOverlap)
+      return ofMap(mGrainOverlap, kReferenceOverlap, 4, .5f, 1);
+   return .5f * sqrtf(kReferenceOverlap / mGrainOverlap); //past that, overlapping grains add up roughly like uncorrelated noise
+}
 
-   for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+void Granulator::UpdateWindowTable()
+{
+   bool lengthMatters = mWindowType == GrainWindowType::Envelope || mWindowType == GrainWindowType::Hybrid;
+   if (mWindowType == mWindowTableType && mWindowShape == mWindowTableShape && (!lengthMatters || mGrainLengthMs == mWindowTableLengthMs))
+      return;
+
+   for (int i = 0; i <= kWindowTableSize; ++i)
+      mWindowTable[i] = GetWindow(mWindowType, mWindowShape, mGrainLengthMs, double(i) / kWindowTableSize);
+   mWindowTable[kWindowTableSize + 1] = mWindowTable[kWindowTableSize]; //guard for interpolating at the very end
+
+   mWindowTableType = mWindowType;
+   mWindowTableShape = mWindowShape;
+   mWindowTableLengthMs = mGrainLengthMs;
+}
+
+void Granulator::RenderGrain(Grain& grain, double time, ChannelBuffer* buffer, int bufferLength, float* const* output, int numSamples)
+{
+   if (grain.mVol == 0 || bufferLength <= 0)
+      return;
+
+   //the samples of this block that fall within the grain
+   const double kEpsilon = .0001;
+   int first = MAX(0, (int)ceil((grain.mStartTime - time) * gSampleRateMs - kEpsilon));
+   int last = MIN(numSamples - 1, (int)floor((grain.mEndTime - time) * gSampleRateMs + kEpsilon));
+   if (first > last)
+      return;
+
+   int numChannels = buffer->NumActiveChannels();
+   const float* source[ChannelBuffer::kMaxNumChannels];
+   for (int ch = 0; ch < numChannels; ++ch)
+      source[ch] = buffer->GetChannelReadOnly(ch);
+
+   //how much of each source channel goes to each output channel, same as blending between channels with GetInterpolatedSample()
+   float gain[ChannelBuffer::kMaxNumChannels][ChannelBuffer::kMaxNumChannels]{};
+   for (int ch = 0; ch < numChannels; ++ch)
    {
-      if (mGrainOverlap > 4)
-         output[ch] *= ofMap(mGrainOverlap, MAX_GRAINS, 4, .5f, 1); //lower volume on dense granulation, starting at 4 overlap
-      output[ch] = mBiquad[ch].Filter(output[ch]);
+      float pan = grain.mVol * (1 + (ch == 0 ? grain.mStereoPosition : -grain.mStereoPosition));
+      if (numChannels == 1)
+      {
+         gain[ch][0] = pan;
+         continue;
+      }
+      float blend = std::clamp(ch + grain.mStereoPosition, 0.f, 1.f);
+      int channelA = MIN((int)floor(blend), numChannels - 2);
+      gain[ch][channelA] += (1 - (blend - channelA)) * pan;
+      gain[ch][channelA + 1] += (blend - channelA) * pan;
+   }
+
+   double rate = grain.mSpeedMult * mSpeed;
+   double phaseInc = gInvSampleRateMs * grain.mStartToEndInv;
+   for (int chunkStart = first; chunkStart <= last; chunkStart += kChunkSize)
+   {
+      int length = MIN(kChunkSize, last + 1 - chunkStart);
+      double phase = (time + chunkStart * gInvSampleRateMs - grain.mStartTime) * grain.mStartToEndInv;
+      double pos = DoubleWrap(grain.mPos, bufferLength);
+
+      for (int i = 0; i < length; ++i)
+      {
+         pos += rate;
+         if (pos >= bufferLength)
+            pos -= bufferLength;
+         else if (pos < 0)
+            pos += bufferLength;
+         int index = MIN(int(pos), bufferLength - 1);
+         int next = index + 1 < bufferLength ? index + 1 : 0;
+         float a = pos - index;
+
+         float windowPos = ofClamp(phase + i * phaseInc, 0, 1) * kWindowTableSize;
+         int windowIndex = int(windowPos);
+         float windowRemainder = windowPos - windowIndex;
+         float window = mWindowTable[windowIndex] + (mWindowTable[windowIndex + 1] - mWindowTable[windowIndex]) * windowRemainder;
+
+         for (int ch = 0; ch < numChannels; ++ch)
+            mWindowedSamples[ch][i] = (source[ch][index] + (source[ch][next] - source[ch][index]) * a) * window;
+      }
+      grain.mPos += rate * length;
+
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         if (numChannels == 1)
+            MixGrain(output[ch] + chunkStart, mWindowedSamples[0], gain[ch][0], mWindowedSamples[0], 0, length);
+         else
+            MixGrain(output[ch] + chunkStart, mWindowedSamples[0], gain[ch][0], mWindowedSamples[1], gain[ch][1], length);
+      }
    }
 }
 
@@ -132,9 +300,14 @@ void Granulator::SpawnGrain(double time, double offset, float width, float speed
       }
    }
    offset += ofRandom(-mPosRandomizeMs, mPosRandomizeMs) / gInvSampleRateMs;
-   mGrains[mNextGrainIdx].Spawn(time, offset, speedMult, mGrainLengthMs, vol, width);
+   if (!mFreeGrains.empty()) //if the pool is used up, skip this one and catch up at the next spawn
+   {
+      int index = mFreeGrains.back();
+      mFreeGrains.pop_back();
+      mActiveGrains.push_back(index);
+      mGrains[index].Spawn(time, offset, speedMult, mGrainLengthMs, vol, width);
+   }
 
-   mNextGrainIdx = (mNextGrainIdx + 1) % MAX_GRAINS;
    mNextGrainSpawnMs = time + mGrainLengthMs * 1 / mGrainOverlap * ofRandom(1 - mSpacingRandomize / 2, 1 + mSpacingRandomize / 2);
 }
 
@@ -145,8 +318,11 @@ void Granulator::QueueGrainSpawn(double spawnTime)
 
 void Granulator::Draw(float x, float y, float w, float h, int bufferStart, int viewLength, int bufferLength, float gain)
 {
-   for (int i = 0; i < MAX_GRAINS; ++i)
-      mGrains[i].DrawGrain(i, x, y, w, h, bufferStart, viewLength, bufferLength, gain, this);
+   for (int i = 0; i < kMaxGrains; ++i)
+   {
+      if (mGrains[i].IsActive())
+         mGrains[i].DrawGrain(i, x, y, w, h, bufferStart, viewLength, bufferLength, gain, this);
+   }
 }
 
 void Granulator::DrawWindow(float x, float y, float w, float h)
@@ -174,8 +350,12 @@ void Granulator::DrawWindow(float x, float y, float w, float h)
 
 void Granulator::ClearGrains()
 {
-   for (int i = 0; i < MAX_GRAINS; ++i)
-      mGrains[i].Clear();
+   for (int index : mActiveGrains)
+   {
+      mGrains[index].mActive = false;
+      mFreeGrains.push_back(index);
+   }
+   mActiveGrains.clear();
 }
 
 namespace
@@ -247,25 +427,11 @@ void Grain::Spawn(double time, double pos, float speedMult, float lengthInMs, fl
    mStartToEnd = mEndTime - mStartTime;
    mStartToEndInv = 1.0 / mStartToEnd;
    mVol = vol;
+   mActive = true;
    mStereoPosition = ofRandom(-width, width);
    mDrawPos = ofRandom(1);
 }
 
-void Grain::Process(double time, ChannelBuffer* buffer, int bufferLength, float* output, const Granulator* granulator)
-{
-   if (time >= mStartTime && time <= mEndTime && mVol != 0)
-   {
-      mPos += mSpeedMult * granulator->mSpeed;
-      double phase = (time - mStartTime) * mStartToEndInv;
-      double window = Granulator::GetWindow(granulator->mWindowType, granulator->mWindowShape, granulator->mGrainLengthMs, phase);
-      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-      {
-         float sample = GetInterpolatedSample(mPos, buffer, bufferLength, std::clamp(ch + mStereoPosition, 0.f, 1.f));
-         output[ch] += sample * window * mVol * (1 + (ch == 0 ? mStereoPosition : -mStereoPosition));
-      }
-   }
-}
-
 void Grain::DrawGrain(int idx, float x, float y, float w, float h, int bufferStart, int viewLength, int bufferLength, float gain, const Granulator* granulator)
 {
    float a = fmod((mPos - bufferStart), bufferLength) / viewLength;
@@ -29,7 +29,9 @@
 #include "ChannelBuffer.h"
 #include "readerwriterqueue.h"
 
-#define MAX_GRAINS 32
+#include <vector>
+
+#define MAX_GRAINS 256 //the most overlap the grain controls go up to
 
 class Granulator;
 
@@ -46,11 +48,13 @@ class Grain
 {
 public:
    void Spawn(double time, double pos, float speedMult, float lengthInMs, float vol, float width);
-   void Process(double time, ChannelBuffer* buffer, int bufferLength, float* output, const Granulator* granulator);
    void DrawGrain(int idx, float x, float y, float w, float h, int bufferStart, int viewLength, int bufferLength, float gain, const Granulator* granulator);
-   void Clear() { mVol = 0; }
+   bool IsActive() const { return mActive; }
 
 private:
+   friend class Granulator;
+
+   bool mActive{ false };
    double mPos{ 0 };
    float mSpeedMult{ 1 };
    double mStartTime{ 0 };
@@ -61,10 +65,18 @@ private:
    float mDrawPos{ .5 };
 };
 
+//grains come out of a fixed pool, and are rendered a block at a time: read positions and windows (from a table) are worked out
+//for each grain's whole span of the block, and the grains are then mixed into the output with simd adds
 class Granulator
 {
 public:
+   static const int kMaxGrains = 512;
+   static constexpr float kReferenceOverlap = 32; //density that the gain compensation was tuned around
+
    Granulator();
+   //adds numSamples of grains into output (one pointer per channel of buffer). offset is where grains spawn from at the
+   //first sample, moving by offsetIncrement per sample after that
+   void Process(double time, ChannelBuffer* buffer, int bufferLength, double offset, double offsetIncrement, float speed, float* const* output, int numSamples);
    void ProcessFrame(double time, ChannelBuffer* buffer, int bufferLength, double offset, float speed, float* output);
    void Draw(float x, float y, float w, float h, int bufferStart, int viewLength, int bufferLength, float gain);
    void DrawWindow(float x, float y, float w, float h);
@@ -72,6 +84,7 @@ public:
    void ClearGrains();
    void SetLiveMode(bool live) { mLiveMode = live; }
    void QueueGrainSpawn(double spawnTime);
+   int GetNumActiveGrains() const { return (int)mActiveGrains.size(); }
    static inline double GetWindow(GrainWindowType type, double shape, double grainLengthMs, double phase);
 
    bool mSpawnGrains{ true };
@@ -87,12 +100,28 @@ public:
    float mWindowShape{ 0.5f };
 
 private:
+   static const int kWindowTableSize = 512;
+   static const int kChunkSize = 128;
+
+   void SpawnDueGrains(double time, ChannelBuffer* buffer, double offset, float speed);
    bool SpawnGrainIfReady(double currentTime, double spawnTime, ChannelBuffer* buffer, double offset, float speed);
    void SpawnGrain(double time, double offset, float width, float speed);
+   void RenderGrain(Grain& grain, double time, ChannelBuffer* buffer, int bufferLength, float* const* output, int numSamples);
+   void UpdateWindowTable();
+   float GetDensityGain() const;
 
    double mNextGrainSpawnMs{ 0 };
-   int mNextGrainIdx{ 0 };
-   Grain mGrains[MAX_GRAINS]{};
+   Grain mGrains[kMaxGrains]{};
+   std::vector<int> mActiveGrains;
+   std::vector<int> mFreeGrains;
+
+   float mWindowTable[kWindowTableSize + 2]{};
+   GrainWindowType mWindowTableType{ GrainWindowType::Round };
+   float mWindowTableShape{ -1 };
+   float mWindowTableLengthMs{ -1 };
+
+   float mWindowedSamples[ChannelBuffer::kMaxNumChannels][kChunkSize]{};
+
    bool mLiveMode{ false };
    BiquadFilter mBiquad[ChannelBuffer::kMaxNumChannels]{};
    moodycamel::ReaderWriterQueue<double> mQueuedGrainSpawnTimes;
@@ -100,17 +100,16 @@ GridControllerMidi::GridControllerMidi()
 {
 }
 
+GridControllerMidi::~GridControllerMidi()
+{
+   mLights.SetSender(nullptr);
+}
+
 void GridControllerMidi::OnControllerPageSelected()
 {
    mOwner->OnControllerPageSelected();
 
-   for (int i = 0; i < mCols; ++i)
-   {
-      for (int j = 0; j < mRows; ++j)
-      {
-         SetLightDirect(i, j, mLights[i][j], K(force));
-      }
-   }
+   mLights.Invalidate();
 }
 
 void GridControllerMidi::OnInput(int control, float velocity)
@@ -185,17 +184,33 @@ void GridControllerMidi::SetLight(int x, int y, GridColor color, bool force)
 
 void GridControllerMidi::SetLightDirect(int x, int y, int color, bool force)
 {
-   if (mLights[x][y] != color || force)
+   if (x >= mCols || y >= mRows)
+      return;
+
+   mLights.Set(x + y * mCols, color, force);
+}
+
+//led output thread
+void GridControllerMidi::SendLights(const std::vector<LedFramebuffer::Change>& changes)
+{
+   juce::MidiBuffer messages;
+   int channel = mMidiController->GetOutChannel();
+   for (const auto& change : changes)
    {
-      if (mMidiController)
+      int control = mControls[change.mIndex % mCols][change.mIndex / mCols];
+      if (mMessageType == kMidiMessage_Note)
+      {
+         if (change.mValue > 0)
+            messages.addEvent(juce::MidiMessage::noteOn(channel, control, (juce::uint8)change.mValue), 0);
+         else
+            messages.addEvent(juce::MidiMessage::noteOff(channel, control), 0);
+      }
+      else if (mMessageType == kMidiMessage_Control)
       {
-         if (mMessageType == kMidiMessage_Note)
-            mMidiController->SendNote(mControllerPage, mControls[x][y], color);
-         else if (mMessageType == kMidiMessage_Control)
-            mMidiController->SendCC(mControllerPage, mControls[x][y], color);
+         messages.addEvent(juce::MidiMessage::controllerEvent(channel, control, change.mValue), 0);
       }
-      mLights[x][y] = color;
    }
+   mMidiController->SendMessages(mControllerPage, messages);
 }
 
 void GridControllerMidi::ResetLights()
@@ -229,10 +244,18 @@ void GridControllerMidi::SetUp(GridLayout* layout, int page, MidiController* con
    mMidiController = controller;
    mControllerPage = page;
 
+   if (mLights.GetNumLeds() != (int)(mCols * mRows))
+      mLights.Resize(mCols * mRows);
+   mLights.SetSender([this](const std::vector<LedFramebuffer::Change>& changes, const LedFramebuffer& leds)
+                     {
+                        SendLights(changes);
+                     });
+
    OnControllerPageSelected();
 }
 
 void GridControllerMidi::UnhookController()
 {
+   mLights.SetSender(nullptr);
    mMidiController = nullptr;
 }
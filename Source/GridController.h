@@ -26,6 +26,7 @@
 #pragma once
 
 #include "IUIControl.h"
+#include "LedFramebuffer.h"
 #include "MidiController.h"
 
 #define MAX_GRIDCONTROLLER_ROWS 512
@@ -110,7 +111,7 @@ class GridControllerMidi : public IGridController
 {
 public:
    GridControllerMidi();
-   virtual ~GridControllerMidi() {}
+   virtual ~GridControllerMidi();
 
    void SetUp(GridLayout* layout, int page, MidiController* controller);
    void UnhookController();
@@ -130,14 +131,16 @@ public:
    void OnInput(int control, float velocity);
 
 private:
+   void SendLights(const std::vector<LedFramebuffer::Change>& changes);
+
    unsigned int mRows{ 8 };
    unsigned int mCols{ 8 };
    int mControls[MAX_GRIDCONTROLLER_COLS][MAX_GRIDCONTROLLER_ROWS]{};
    float mInput[MAX_GRIDCONTROLLER_COLS][MAX_GRIDCONTROLLER_ROWS]{};
-   int mLights[MAX_GRIDCONTROLLER_COLS][MAX_GRIDCONTROLLER_ROWS]{};
    std::vector<int> mColors;
    MidiMessageType mMessageType{ MidiMessageType::kMidiMessage_Note };
    MidiController* mMidiController{ nullptr };
    int mControllerPage{ 0 };
    IGridControllerListener* mOwner{ nullptr };
+   LedFramebuffer mLights{ 0 }; //mCols x mRows
 };
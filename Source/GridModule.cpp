@@ -94,10 +94,10 @@ void GridModule::OnGridButton(int x, int y, float velocity, IGridController* gri
    if (y < GetRows() && x < GetCols())
    {
       for (auto listener : mScriptListeners)
-         // use callAsync as RunCode should only be called from main thread
+         // use callAsync as script callbacks should only be run from main thread
          juce::MessageManager::callAsync([listener, time = gTime, x, y, velocity]()
                                          {
-                                            listener->RunCode(time, "on_grid_button(" + ofToString(x) + ", " + ofToString(y) + ", " + ofToString(velocity) + ")");
+                                            listener->RunGridButtonCallback(time, x, y, velocity);
                                          });
       if (mGridControllerOwner)
          mGridControllerOwner->OnGridButton(x, y, velocity, this);
@@ -42,8 +42,6 @@ std::list<HelpDisplay::ModuleTooltipInfo> HelpDisplay::sTooltips;
 HelpDisplay::HelpDisplay()
 : IDrawableModule(700, 700)
 {
-   LoadHelp();
-
    sShowTooltips = UserPrefs.show_tooltips_on_load.Get();
    LoadTooltips();
 }
@@ -76,6 +74,7 @@ void HelpDisplay::LoadHelp()
       std::string help = file.loadFileAsString().toStdString();
       ofStringReplace(help, "\r", "");
       mHelpText = ofSplitString(help, "\n");
+      mHelpLoaded = true;
    }
 
    mMaxScrollAmount = (int)mHelpText.size() * 14;
@@ -89,6 +88,10 @@ void HelpDisplay::DrawModule()
    ofRect(0, 0, mWidth, mHeight);
    ofPopStyle();
 
+   //loaded when the help is first shown rather than at startup, the wasm build fetches resources on demand and the file may not be there yet
+   if (!mHelpLoaded)
+      LoadHelp();
+
    DrawTextRightJustify(GetBuildInfoString(), mWidth - 5, 12);
 
    mShowTooltipsCheckbox->Draw();
@@ -88,6 +88,7 @@ private:
    UIControlTooltipInfo* FindControlInfo(IUIControl* control);
 
    std::vector<std::string> mHelpText;
+   bool mHelpLoaded{ false };
    Checkbox* mShowTooltipsCheckbox{ nullptr };
    ClickButton* mCopyBuildInfoButton{ nullptr };
    ClickButton* mDumpModuleInfoButton{ nullptr };
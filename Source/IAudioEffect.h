@@ -28,6 +28,8 @@
 #include "IDrawableModule.h"
 #include "ChannelBuffer.h"
 
+class SampleKernel;
+
 class IAudioEffect : public IDrawableModule
 {
 public:
@@ -35,6 +37,15 @@ public:
    virtual void ProcessAudio(double time, ChannelBuffer* buffer) = 0;
    void SetEnabled(bool enabled) override = 0;
    virtual float GetEffectAmount() { return 0; }
+   //how many samples of output this effect keeps producing once its input goes silent, so EffectChain knows when it can stop processing it
+   virtual int GetTailLengthSamples() { return kTailUnknown; }
+   static const int kTailUnknown = -1; //can't tell, or might never go quiet
+   //EffectChain skips effects that aren't enabled. override for effects that keep listening to their input while bypassed
+   virtual bool ProcessesWhileDisabled() const { return false; }
+   virtual void ResetAudioState() {} //audio thread, see IAudioSource::ResetAudioState()
+   //audio thread, in place of ProcessAudio(), for effects whose work is a simple function of each sample: do what ProcessAudio() would
+   //before its loop, and return the loop as a kernel for EffectChain to fuse with its neighbours. nullptr to have ProcessAudio() called
+   virtual SampleKernel* BeginSampleKernel(double time, int bufferSize) { return nullptr; }
    virtual std::string GetType() = 0;
    bool CanMinimize() override { return false; }
    bool IsSaveable() override { return false; }
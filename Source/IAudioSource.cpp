@@ -26,11 +26,54 @@
 #include "IAudioSource.h"
 #include "IAudioReceiver.h"
 #include "PatchCableSource.h"
+#include "ChannelBuffer.h"
 
 IAudioReceiver* IAudioSource::GetTarget(int index)
 {
    assert(index < GetNumTargets());
-   return GetPatchCableSource(index)->GetAudioReceiver();
+   PatchCableSource* cableSource = GetPatchCableSource(index);
+   if (cableSource == nullptr) //not set up yet
+      return nullptr;
+   return cableSource->GetAudioReceiver();
+}
+
+void IAudioSource::UpdateCpuLoad(double invTicksPerBuffer)
+{
+   float load = float(mProcessTicks * invTicksPerBuffer);
+   mProcessTicks = 0;
+   mCpuLoad = ofLerp(mCpuLoad, load, .05f);
+   mCpuLoadPeak = MAX(load, mCpuLoadPeak * .999f);
+}
+
+bool IAudioSource::UpdateSleep()
+{
+   ChannelBuffer* input = mSleepInput;
+   if (input == nullptr)
+      return false;
+
+   //silence flags are conservative, anything that even looked at a channel clears them, so this wakes up early rather than late
+   if (!input->IsSilent())
+   {
+      mSilentSamples = 0;
+      mSleepState = SleepState::Awake;
+      return false;
+   }
+
+   if (mSleepState == SleepState::Silent)
+      return true;
+
+   //our output (as written to the viz buffer) going quiet too means any tail has finished
+   if (GetVizBuffer()->IsSilent())
+      mSilentSamples = MIN(mSilentSamples + gBufferSize, (int)gSampleRate);
+   else
+      mSilentSamples = 0;
+
+   if (mSilentSamples >= gSampleRate)
+   {
+      mSleepState = SleepState::Silent;
+      return true;
+   }
+   return false;
 }
 
 void IAudioSource::SyncOutputBuffer(int numChannels)
@@ -29,7 +29,10 @@
 #include "SynthGlobals.h"
 #include "IPatchable.h"
 
+#include <atomic>
+
 class IAudioReceiver;
+class ChannelBuffer;
 
 #define VIZ_BUFFER_SECONDS .1f
 
@@ -43,11 +46,51 @@ public:
    virtual void Process(double time) = 0;
    IAudioReceiver* GetTarget(int index = 0);
    virtual int GetNumTargets() { return 1; }
+   virtual bool RequiresSerialProcessing() const { return false; } //true if Process() touches shared state outside of our targets' buffers
+   virtual int GetLatencySamples() const { return 0; } //how late our output is relative to our input, for delay compensation (see AudioExecutionPlan::BuildDelayCompensation())
+
+   //for the auto_suspend_modules pref, see AudioExecutionPlan::Build()
+   enum class SleepState : uint8_t
+   {
+      Awake,
+      Unreachable, //nothing it outputs gets to anything that's heard, recorded or displayed
+      Silent //its input and output have both been silent for a while
+   };
+   virtual bool IsAudioSink() const { return false; } //true if processing matters even with nothing plugged into our outputs (outputs, recorders, meters)
+   virtual bool CanSleepWhenSilent() const { return false; } //true if silent input always means silent output, once the tail has rung out
+   SleepState GetSleepState() const { return mSleepState; }
+   void SetSleepState(SleepState state) { mSleepState = state; }
+   void SetSleepInput(ChannelBuffer* input) { mSleepInput = input; }
+   bool UpdateSleep(); //audio thread, true if Process() can be skipped this buffer
    RollingBuffer* GetVizBuffer() { return &mVizBuffer; }
 
+   //for the guard_audio_faults pref, see AudioFaultGuard
+   virtual void ResetAudioState() {} //audio thread. clear filter, delay and feedback state, after Process() wrote a nan or an inf
+   void OnAudioFault(double time)
+   {
+      mAudioFaultTime = time;
+      ++mAudioFaultCount;
+   }
+   double GetAudioFaultTime() const { return mAudioFaultTime.load(std::memory_order_relaxed); }
+   int GetAudioFaultCount() const { return mAudioFaultCount.load(std::memory_order_relaxed); }
+
+   //cpu accounting, see Profiler::IsModuleTimingEnabled(). loads are fractions of the time available for one buffer
+   void AddProcessTicks(int64_t ticks) { mProcessTicks += ticks; }
+   void UpdateCpuLoad(double invTicksPerBuffer);
+   float GetCpuLoad() const { return mCpuLoad; }
+   float GetCpuLoadPeak() const { return mCpuLoadPeak; }
+
 protected:
    void SyncOutputBuffer(int numChannels);
 
 private:
    RollingBuffer mVizBuffer;
+   int64_t mProcessTicks{ 0 };
+   float mCpuLoad{ 0 };
+   float mCpuLoadPeak{ 0 };
+   std::atomic<SleepState> mSleepState{ SleepState::Awake };
+   std::atomic<ChannelBuffer*> mSleepInput{ nullptr }; //set while we're allowed to sleep through silence
+   int mSilentSamples{ 0 };
+   std::atomic<double> mAudioFaultTime{ -1e9 };
+   std::atomic<int> mAudioFaultCount{ 0 };
 };
@@ -27,6 +27,7 @@
 #include "SynthGlobals.h"
 #include "IDrawableModule.h"
 #include "Prefab.h"
+#include "UIControlIndex.h"
 
 #include <cstring>
 
@@ -37,6 +38,15 @@ IClickable::IClickable()
 {
 }
 
+void IClickable::SetName(const char* name)
+{
+   if (mName != name)
+   {
+      StringCopy(mName, name, MAX_TEXTENTRY_LENGTH);
+      UIControlIndex::NoteLayoutChanged(); //paths through this have changed
+   }
+}
+
 void IClickable::Draw()
 {
    if (!mShowing)
@@ -63,11 +63,7 @@ public:
    }
    ofVec2f GetDimensions();
    ofRectangle GetRect(bool local = false);
-   void SetName(const char* name)
-   {
-      if (mName != name)
-         StringCopy(mName, name, MAX_TEXTENTRY_LENGTH);
-   }
+   void SetName(const char* name);
    const char* Name() const { return mName; }
    char* NameMutable() { return mName; }
    std::string Path(bool ignoreContext = false, bool useDisplayName = false, IClickable* relativeTo = nullptr);
@@ -26,6 +26,7 @@
 #include "IDrawableModule.h"
 #include "RollingBuffer.h"
 #include "IAudioSource.h"
+#include "AudioFaultGuard.h"
 #include "INoteSource.h"
 #include "INoteReceiver.h"
 #include "IAudioReceiver.h"
@@ -47,6 +48,8 @@
 #include "UserPrefs.h"
 #include "Prefab.h"
 #include "Snapshots.h"
+#include "ModuleRenderCache.h"
+#include "UIControlIndex.h"
 
 float IDrawableModule::sHueNote = 27;
 float IDrawableModule::sHueAudio = 135;
@@ -71,6 +74,7 @@ IDrawableModule::~IDrawableModule()
       mUIControls[i]->Delete();
    for (auto source : mPatchCableSources)
       delete source;
+   delete mRenderCache.load();
 }
 
 void IDrawableModule::CreateUIControls()
@@ -198,12 +202,19 @@ void IDrawableModule::DrawFrame(float w, float h, bool drawModule, float& titleB
 
    ofColor color = GetColor(mModuleCategory);
 
+   //zoomed out far enough that the contents wouldn't be legible, so just draw a box with the title
+   const float kMinTitlePixels = 5;
+   float simplifyBelowSize = UserPrefs.simplify_modules_below_size.Get();
+   float onScreenScale = GetOnScreenScale();
+   bool simplified = simplifyBelowSize > 0 && drawModule && !Push2Control::sDrawingPush2Display && gHoveredModule != this &&
+                     MAX(w, h + titleBarHeight) * onScreenScale < simplifyBelowSize;
+
    highlight = 0;
 
    if (IsEnabled())
    {
       IAudioSource* audioSource = dynamic_cast<IAudioSource*>(this);
-      if (audioSource)
+      if (audioSource && !audioSource->GetVizBuffer()->IsSilent())
       {
          RollingBuffer* vizBuff = audioSource->GetVizBuffer();
          int numSamples = std::min(500, vizBuff->Size());
@@ -273,7 +284,7 @@ void IDrawableModule::DrawFrame(float w, float h, bool drawModule, float& titleB
       gModuleDrawAlpha *= .2f;
 
    float enableToggleOffset = 0;
-   if (HasTitleBar())
+   if (HasTitleBar() && !simplified)
    {
       ofPushStyle();
       ofSetColor(color, 50);
@@ -333,7 +344,7 @@ void IDrawableModule::DrawFrame(float w, float h, bool drawModule, float& titleB
    }
 
    const bool kDrawInnerFade = true;
-   if (kDrawInnerFade && !Push2Control::sDrawingPush2Display)
+   if (kDrawInnerFade && !Push2Control::sDrawingPush2Display && !simplified)
    {
       float fadeRoundness = 100;
       float fadeLength = w / 3;
@@ -345,7 +356,7 @@ void IDrawableModule::DrawFrame(float w, float h, bool drawModule, float& titleB
       nvgFill(gNanoVG);
    }
 
-   if (drawModule)
+   if (drawModule && !simplified)
    {
       ofSetColor(color, gModuleDrawAlpha);
       ofPushMatrix();
@@ -353,16 +364,66 @@ void IDrawableModule::DrawFrame(float w, float h, bool drawModule, float& titleB
          ofClipWindow(0, 0, w, h, true);
       else
          ofResetClipWindow();
-      DrawModule();
+
+      bool drawnFromCache = false;
+      if (CanCacheRendering() && (GetOwningContainer() == TheSynth->GetRootContainer() || GetOwningContainer() == TheSynth->GetUIContainer()))
+      {
+         if (mRenderCache == nullptr)
+            mRenderCache = new ModuleRenderCache(this);
+         drawnFromCache = mRenderCache.load()->Draw(w, h);
+      }
+      if (!drawnFromCache)
+         DrawModule();
       ofPopMatrix();
    }
 
-   if (HasTitleBar())
+   if (HasTitleBar() && (!simplified || 14 * onScreenScale >= kMinTitlePixels))
    {
       ofSetColor(color * (1 - GetBeaconAmount()) + ofColor::yellow * GetBeaconAmount(), gModuleDrawAlpha);
       DrawTextBold(GetTitleLabel(), 5 + enableToggleOffset, 10 - titleBarHeight, 14);
    }
 
+   if (UserPrefs.auto_suspend_modules.Get())
+   {
+      IAudioSource* audioSource = dynamic_cast<IAudioSource*>(this);
+      if (audioSource != nullptr && audioSource->GetSleepState() != IAudioSource::SleepState::Awake)
+      {
+         ofPushStyle();
+         ofSetColor(color, gModuleDrawAlpha * .6f);
+         DrawTextNormal(audioSource->GetSleepState() == IAudioSource::SleepState::Unreachable ? "zz (not connected to anything heard)" : "zz (silent)", 0, -titleBarHeight - 3, 10);
+         ofPopStyle();
+      }
+   }
+
+   if (UserPrefs.guard_audio_faults.Get())
+   {
+      IAudioSource* audioSource = dynamic_cast<IAudioSource*>(this);
+      if (audioSource != nullptr && gTime - audioSource->GetAudioFaultTime() < AudioFaultGuard::kMuteMs * 3)
+      {
+         ofPushStyle();
+         ofSetColor(255, 60, 60, gModuleDrawAlpha);
+         DrawTextNormal("output went nan/inf, muted and reset (" + ofToString(audioSource->GetAudioFaultCount()) + "x)", 0, -titleBarHeight - 3, 10);
+         ofPopStyle();
+      }
+   }
+
+   if (UserPrefs.show_module_cpu_usage.Get())
+   {
+      IAudioSource* audioSource = dynamic_cast<IAudioSource*>(this);
+      if (audioSource != nullptr)
+      {
+         //percent of the buffer's time budget, red once it's past what's safe for the whole patch to use
+         float load = audioSource->GetCpuLoad();
+         ofPushStyle();
+         if (load > .7f)
+            ofSetColor(255, 0, 0, gModuleDrawAlpha);
+         else
+            ofSetColor(color, gModuleDrawAlpha);
+         DrawTextNormal(ofToString(load * 100, 1) + "% (" + ofToString(audioSource->GetCpuLoadPeak() * 100, 1) + "% peak)", 0, h + 11, 10);
+         ofPopStyle();
+      }
+   }
+
    bool groupSelected = !TheSynth->GetGroupSelectedModules().empty() && VectorContains(this, TheSynth->GetGroupSelectedModules());
    if ((IsEnabled() || groupSelected || TheSynth->GetMoveModule() == this) && mShouldDrawOutline)
    {
@@ -846,12 +907,14 @@ void IDrawableModule::AddChild(IDrawableModule* child)
    }
 
    mChildren.push_back(child);
+   ModuleContainer::NoteModuleListChanged();
 }
 
 void IDrawableModule::RemoveChild(IDrawableModule* child)
 {
    child->SetParent(nullptr);
    RemoveFromVector(child, mChildren);
+   ModuleContainer::NoteModuleListChanged();
 }
 
 std::vector<IUIControl*> IDrawableModule::GetUIControls() const
@@ -966,6 +1029,7 @@ void IDrawableModule::AddUIControl(IUIControl* control)
       mFloatSliders.push_back(slider);
       mSliderMutex.unlock();
    }
+   UIControlIndex::NoteLayoutChanged();
 }
 
 void IDrawableModule::RemoveUIControl(IUIControl* control, bool cleanUpReferences /* = true */)
@@ -981,11 +1045,13 @@ void IDrawableModule::RemoveUIControl(IUIControl* control, bool cleanUpReference
       RemoveFromVector(slider, mFloatSliders, K(fail));
       mSliderMutex.unlock();
    }
+   UIControlIndex::NoteLayoutChanged();
 }
 
 void IDrawableModule::AddUIGrid(UIGrid* grid)
 {
    mUIGrids.push_back(grid);
+   UIControlIndex::NoteLayoutChanged();
 }
 
 void IDrawableModule::ComputeSliders(int samplesIn)
@@ -996,6 +1062,16 @@ void IDrawableModule::ComputeSliders(int samplesIn)
    //mSliderMutex.unlock();
 }
 
+bool IDrawableModule::HasSlidersNeedingCompute() const
+{
+   for (const auto* slider : mFloatSliders)
+   {
+      if (slider->NeedsCompute())
+         return true;
+   }
+   return false;
+}
+
 PatchCableOld IDrawableModule::GetPatchCableOld(IClickable* target)
 {
    float wThis, hThis, xThis, yThis, wThat, hThat, xThat, yThat;
@@ -1254,6 +1330,40 @@ namespace
    const char kControlSeparator[kControlSeparatorLength + 1] = "controlseparator";
 }
 
+void IDrawableModule::HibernateModule()
+{
+   if (mHibernating || !CanHibernate())
+      return;
+   mHibernating = true; //first, so the audio thread stops using what's about to go
+   Hibernate();
+}
+
+void IDrawableModule::WakeModule()
+{
+   if (!mHibernating)
+      return;
+   Wake();
+   mHibernating = false;
+}
+
+void IDrawableModule::MarkStateDirty()
+{
+   mStateDirty = true;
+   mUndoDirty = true;
+
+   //modules inside a prefab are saved as part of it
+   IDrawableModule* parent = dynamic_cast<IDrawableModule*>(GetParent());
+   if (parent != nullptr)
+      parent->MarkStateDirty();
+}
+
+void IDrawableModule::MarkRenderDirty()
+{
+   ModuleRenderCache* cache = mRenderCache;
+   if (cache != nullptr)
+      cache->MarkDirty();
+}
+
 void IDrawableModule::SaveState(FileStreamOut& out)
 {
    if (!CanModuleTypeSaveState())
@@ -30,6 +30,8 @@
 #include "ModuleSaveData.h"
 #include "IPatchable.h"
 
+#include <atomic>
+
 class Checkbox;
 class IUIControl;
 class FileStreamIn;
@@ -41,6 +43,7 @@ class Sample;
 class PatchCable;
 class PatchCableSource;
 class ModuleContainer;
+class ModuleRenderCache;
 class UIGrid;
 
 enum ModuleCategory
@@ -73,6 +76,7 @@ public:
    static bool AcceptsAudio() { return false; }
    static bool AcceptsNotes() { return false; }
    static bool AcceptsPulses() { return false; }
+   static bool CanConstructOffThread() { return false; } //true if the constructor and CreateUIControls() only touch the module itself, so layouts can build several at once
 
    void Render() override;
    void PreRenderUnclipped();
@@ -157,6 +161,7 @@ public:
    virtual bool HasSpecialDelete() const { return false; }
    virtual void DoSpecialDelete() {}
    void ComputeSliders(int samplesIn);
+   bool HasSlidersNeedingCompute() const;
    void SetOwningContainer(ModuleContainer* container) { mOwningContainer = container; }
    ModuleContainer* GetOwningContainer() const { return mOwningContainer; }
    virtual ModuleContainer* GetContainer() { return nullptr; }
@@ -167,6 +172,10 @@ public:
    void MarkAsDeleted() { mDeleted = true; }
    bool IsDeleted() const { return mDeleted; }
    virtual bool ShouldClipContents() { return true; }
+   //opt in for modules whose DrawModule() only shows their controls, or that call MarkRenderDirty() when anything else it shows changes.
+   //an unchanged module is then composited from a cached image instead of being redrawn
+   virtual bool CanCacheRendering() const { return false; }
+   void MarkRenderDirty();
    bool CanReceiveAudio() { return mCanReceiveAudio; }
    bool CanReceiveNotes() { return mCanReceiveNotes; }
    bool CanReceivePulses() { return mCanReceivePulses; }
@@ -180,6 +189,11 @@ public:
    void SaveLayoutBase(ofxJSONElement& moduleInfo);
    void SetUpFromSaveDataBase();
    virtual bool IsSaveable() { return true; }
+   void MarkStateDirty(); //something changed what SaveState() writes, so the next incremental autosave and the next undo step should include this module
+   bool IsStateDirty() const { return mStateDirty; }
+   bool TakeStateDirty() { return mStateDirty.exchange(false); }
+   bool IsUndoDirty() const { return mUndoDirty; }
+   bool TakeUndoDirty() { return mUndoDirty.exchange(false); } //see UndoHistory
    ModuleSaveData& GetSaveData() { return mModuleSaveData; }
    virtual void SaveState(FileStreamOut& out);
    virtual void LoadState(FileStreamIn& in, int rev);
@@ -196,6 +210,20 @@ public:
    virtual bool CanModuleTypeSaveState() const { return true; }
    bool IsSpawningOnTheFly(const ofxJSONElement& moduleInfo);
    virtual bool HasDebugDraw() const { return false; }
+   //bytes held in buffers, samples and tables, for the memoryusage panel. modules with anything big override this
+   virtual size_t GetMemoryUsage() const { return 0; }
+   //modules with buffers sized for the worst case can offer to cut them down to what they use right now
+   virtual bool CanShrinkMemory() const { return false; }
+   virtual void ShrinkMemory() {}
+   //modules that can let go of big buffers while they're disabled, and get them back when they're enabled again. see ModuleHibernation
+   virtual bool CanHibernate() const { return false; }
+   bool IsHibernating() const { return mHibernating; } //any thread. whatever the module let go of isn't there until it wakes, so it plays silence
+   void HibernateModule(); //main thread
+   void WakeModule(); //main thread, does nothing if the module isn't hibernating
+   //main thread, a few bars before a SongBuilder scene turns the module on or sets its controls. anything the first buffer after that
+   //would otherwise allocate or load can be done here instead. it isn't paired with anything, so it has to be safe to call again
+   virtual void Prewarm() {}
+   size_t& GetTrackedAllocationBytes() { return mTrackedAllocationBytes; } //newed while being set up, only counted with BESPOKE_DEBUG_ALLOCATIONS
    virtual bool HasPush2OverrideControls() const { return false; }
    virtual void GetPush2OverrideControls(std::vector<IUIControl*>& controls) const {}
    virtual bool DrawToPush2Screen() { return false; }
@@ -238,6 +266,8 @@ protected:
    float mHeight{ 20 };
 
 private:
+   virtual void Hibernate() {}
+   virtual void Wake() {}
    virtual void PreDrawModuleUnclipped() {}
    virtual void PreDrawModule() {}
    virtual void DrawModule() = 0;
@@ -275,8 +305,15 @@ private:
    bool mCanReceiveNotes{ false };
    bool mCanReceivePulses{ false };
    IKeyboardFocusListener* mKeyboardFocusListener{ nullptr };
+   std::atomic<bool> mStateDirty{ true };
+   std::atomic<bool> mUndoDirty{ true };
+   std::atomic<bool> mHibernating{ false };
+   std::atomic<ModuleRenderCache*> mRenderCache{ nullptr };
+   size_t mTrackedAllocationBytes{ 0 };
 
    ofMutex mSliderMutex;
 
    std::vector<PatchCableSource*> mPatchCableSources;
+
+   friend class ModuleRenderCache;
 };
@@ -42,7 +42,10 @@ public:
    virtual void Stop(double time) = 0;
    virtual bool Process(double time, ChannelBuffer* out, int oversampling) = 0;
    virtual bool IsDone(double time) = 0;
+   virtual float GetLevel(double time) { return 1; } //how loud the envelope is, for choosing a voice to steal
    virtual void SetVoiceParams(IVoiceParams* params) = 0;
+   void SetDegradeLevel(int level) { mDegradeLevel = level; } //a CpuGovernor::Level, for the voices that can save time when asked
+   int GetDegradeLevel() const { return mDegradeLevel; }
    void SetPan(float pan)
    {
       assert(pan >= -1 && pan <= 1);
@@ -54,12 +57,14 @@ public:
       return mPan;
    }
 
-   float GetPitch(int samplesIn) { return mPitch + (mModulators.pitchBend ? mModulators.pitchBend->GetValue(samplesIn) : ModulationParameters::kDefaultPitchBend); }
-   float GetModWheel(int samplesIn) { return mModulators.modWheel ? mModulators.modWheel->GetValue(samplesIn) : ModulationParameters::kDefaultModWheel; }
-   float GetPressure(int samplesIn) { return mModulators.pressure ? mModulators.pressure->GetValue(samplesIn) : ModulationParameters::kDefaultPressure; }
+   float GetNotePitch() const { return mPitch; } //without pitch bend
+   float GetPitch(int samplesIn) { return mPitch + (mModulators.pitchBend ? mModulators.pitchBend->GetBlockValue(samplesIn) : ModulationParameters::kDefaultPitchBend); }
+   float GetModWheel(int samplesIn) { return mModulators.modWheel ? mModulators.modWheel->GetBlockValue(samplesIn) : ModulationParameters::kDefaultModWheel; }
+   float GetPressure(int samplesIn) { return mModulators.pressure ? mModulators.pressure->GetBlockValue(samplesIn) : ModulationParameters::kDefaultPressure; }
 
 private:
    float mPitch{ 0 };
    float mPan{ 0 };
+   int mDegradeLevel{ 0 };
    ModulationParameters mModulators;
 };
@@ -26,6 +26,7 @@
 */
 
 #include "IModulator.h"
+#include "IAudioSource.h"
 #include "Slider.h"
 #include "PatchCableSource.h"
 #include "ModularSynth.h"
@@ -106,6 +107,10 @@ void IModulator::OnModulatorRepatch()
    TheSynth->RemoveExtraPoller(this);
    //if (RequiresManualPolling())
    TheSynth->AddExtraPoller(this);
+
+   //what we modulate decides where we go in the execution plan
+   if (dynamic_cast<IAudioSource*>(this) != nullptr)
+      TheSynth->ArrangeAudioSourceDependencies();
 }
 
 void IModulator::Poll()
@@ -129,6 +134,46 @@ void IModulator::Poll()
    }
 }
 
+void IModulator::ValueBlock(float* out, int numSamples)
+{
+   for (int i = 0; i < numSamples; ++i)
+      out[i] = Value(i);
+}
+
+const float* IModulator::GetCVBlock() const
+{
+   return mCVBlockTime == gTime ? mCVBlock.data() : nullptr;
+}
+
+void IModulator::AllocateCVBlock()
+{
+   mCVBlock.resize(gBufferSize);
+}
+
+float* IModulator::GetCVWriteBlock()
+{
+   assert((int)mCVBlock.size() >= gBufferSize);
+   mCVBlockTime = -1; //not readable until it's committed
+   return mCVBlock.data();
+}
+
+void IModulator::CommitCVBlock()
+{
+   mCVBlockTime = gTime;
+}
+
+void IModulator::GetCVConsumers(std::vector<IAudioSource*>& consumers) const
+{
+   for (const auto& target : mTargets)
+   {
+      if (target.mUIControlTarget == nullptr)
+         continue;
+      IAudioSource* consumer = dynamic_cast<IAudioSource*>(target.mUIControlTarget->GetModuleParent());
+      if (consumer != nullptr && !VectorContains(consumer, consumers))
+         consumers.push_back(consumer);
+   }
+}
+
 float IModulator::GetRecentChange() const
 {
    return mLastPollValue - mSmoothedValue;
@@ -30,6 +30,9 @@
 #include "Slider.h"
 #include "IPollable.h"
 
+#include <vector>
+
+class IAudioSource;
 class PatchCableSource;
 
 class IModulator : public IPollable
@@ -38,6 +41,8 @@ public:
    IModulator();
    virtual ~IModulator();
    virtual float Value(int samplesIn = 0) = 0;
+   //out[i] = Value(i) for the whole block. override where the modulator can do that cheaper than sample by sample
+   virtual void ValueBlock(float* out, int numSamples);
    virtual bool Active() const = 0;
    virtual bool CanAdjustRange() const { return true; }
    virtual bool InitializeWithZeroRange() const { return false; }
@@ -49,8 +54,17 @@ public:
    void OnRemovedFrom(IUIControl* control);
    int GetNumTargets() const;
 
+   //audio rate modulators fill a block of output values once per Process(), so the sliders they drive copy it instead of calling Value()
+   //sample by sample, and the execution plan puts them ahead of the modules they modulate (see AudioExecutionPlan::Build()).
+   //nullptr if there isn't one for this buffer (yet)
+   const float* GetCVBlock() const;
+   void GetCVConsumers(std::vector<IAudioSource*>& consumers) const; //the modules in the audio graph whose sliders we drive
+
 protected:
    void InitializeRange(float currentValue, float min, float max, FloatSlider::Mode sliderMode);
+   void AllocateCVBlock(); //main thread, before the audio thread starts writing blocks
+   float* GetCVWriteBlock(); //gBufferSize values in the target's range, published for this buffer by CommitCVBlock()
+   void CommitCVBlock();
 
    FloatSlider* GetSliderTarget() const { return mTargets[0].mSliderTarget; }
 
@@ -71,4 +85,8 @@ protected:
    std::array<Target, 10> mTargets;
    float mLastPollValue{ 0 };
    float mSmoothedValue{ 0 };
+
+private:
+   std::vector<float> mCVBlock;
+   double mCVBlockTime{ -1 };
 };
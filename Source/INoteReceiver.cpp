@@ -27,58 +27,44 @@
 
 #include "INoteReceiver.h"
 #include "Profiler.h"
+#include "NoteEventLane.h"
+#include "SynthGlobals.h"
 
 NoteInputBuffer::NoteInputBuffer(INoteReceiver* receiver)
 : mReceiver(receiver)
+, mLane(std::make_unique<NoteEventLane>(kBufferSize))
+{
+}
+
+NoteInputBuffer::~NoteInputBuffer()
 {
-   for (int i = 0; i < kBufferSize; ++i)
-      mBuffer[i].time = -1;
 }
 
 void NoteInputBuffer::Process(double time)
 {
    PROFILER(NoteInputBuffer);
 
-   //process note offs first
-   for (int i = 0; i < kBufferSize; ++i)
+   if (mLane->IsEmpty())
+      return;
+
+   NoteEventLane::Span events = mLane->TakeEventsForBuffer(gTime, gBufferSize);
+
+   //process note offs first, then note ons, each in the order they land
+   for (const NoteEvent& event : events)
    {
-      if (mBuffer[i].time != -1 && mBuffer[i].velocity == 0 &&
-          IsTimeWithinFrame(mBuffer[i].time))
-      {
-         NoteMessage& element = mBuffer[i];
-         mReceiver->PlayNote(element);
-         mBuffer[i].time = -1;
-      }
+      if (event.mNote.velocity == 0)
+         mReceiver->PlayNote(event.mNote);
    }
-
-   //now process note ons
-   for (int i = 0; i < kBufferSize; ++i)
+   for (const NoteEvent& event : events)
    {
-      if (mBuffer[i].time != -1 && mBuffer[i].velocity != 0 &&
-          IsTimeWithinFrame(mBuffer[i].time))
-      {
-         NoteMessage& element = mBuffer[i];
-         mReceiver->PlayNote(element);
-         mBuffer[i].time = -1;
-      }
+      if (event.mNote.velocity != 0)
+         mReceiver->PlayNote(event.mNote);
    }
 }
 
 void NoteInputBuffer::QueueNote(NoteMessage note)
 {
-   for (int i = 0; i < kBufferSize; ++i)
-   {
-      if (mBuffer[i].time == -1)
-      {
-         mBuffer[i].time = note.time;
-         NoteMessage& element = mBuffer[i];
-         element.pitch = note.pitch;
-         element.velocity = note.velocity;
-         element.voiceIdx = note.voiceIdx;
-         element.modulation = note.modulation;
-         break;
-      }
-   }
+   mLane->PushNote(note);
 }
 
 //static
@@ -27,11 +27,15 @@
 
 #include "ModulationChain.h"
 
+#include <memory>
+
 namespace juce
 {
    class MidiMessage;
 }
 
+class NoteEventLane;
+
 struct NoteMessage
 {
    NoteMessage()
@@ -86,12 +90,13 @@ class NoteInputBuffer
 {
 public:
    NoteInputBuffer(INoteReceiver* receiver);
+   ~NoteInputBuffer();
    void Process(double time);
    void QueueNote(NoteMessage note);
    static bool IsTimeWithinFrame(double time);
 
 private:
-   static const int kBufferSize = 50;
-   NoteMessage mBuffer[kBufferSize];
+   static const int kBufferSize = 128;
    INoteReceiver* mReceiver{ nullptr };
+   std::unique_ptr<NoteEventLane> mLane;
 };
@@ -30,6 +30,7 @@
 #include "PatchCableSource.h"
 #include "Profiler.h"
 #include "NoteOutputQueue.h"
+#include "AudioGraphScheduler.h"
 
 void NoteOutput::PlayNote(NoteMessage note)
 {
@@ -43,6 +44,8 @@ void NoteOutput::PlayNoteInternal(NoteMessage note, bool isFromMainThreadAndSche
    {
       if (!isFromMainThreadAndScheduled) //if we specifically scheduled this ahead of time, there's no need to make adjustments. otherwise, account for immediately requesting a note from the non-audio thread
       {
+         if (note.time <= NextBufferTime(false) && !AudioGraphScheduler::IsWorkerThread()) //meant to happen right away, so place it relative to when it actually came in
+            note.time = GetTimeForImmediateEvent();
          note.time += TheTransport->GetEventLookaheadMs();
          if (note.velocity == 0)
             note.time += gBufferSizeMs; //1 buffer later, to make sure notes get cleared
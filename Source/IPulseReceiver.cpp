@@ -27,6 +27,45 @@
 
 #include "IPulseReceiver.h"
 #include "PatchCableSource.h"
+#include "SynthGlobals.h"
+
+PulseBatch::PulseBatch(int capacity)
+: mCapacity(capacity)
+{
+   mOffsets.reserve(capacity);
+   mVelocities.reserve(capacity);
+   mFlags.reserve(capacity);
+}
+
+void PulseBatch::Clear(double bufferStartTime)
+{
+   mBufferStartTime = bufferStartTime;
+   mOffsets.clear();
+   mVelocities.clear();
+   mFlags.clear();
+}
+
+bool PulseBatch::Add(int offset, float velocity, int flags)
+{
+   if (IsFull())
+      return false;
+   assert(mOffsets.empty() || offset >= mOffsets.back());
+   mOffsets.push_back(offset);
+   mVelocities.push_back(velocity);
+   mFlags.push_back(flags);
+   return true;
+}
+
+double PulseBatch::GetTime(int index) const
+{
+   return mBufferStartTime + mOffsets[index] * gInvSampleRateMs;
+}
+
+void IPulseReceiver::OnPulses(const PulseBatch& batch)
+{
+   for (int i = 0; i < batch.GetNumPulses(); ++i)
+      OnPulse(batch.GetTime(i), batch.GetVelocity(i), batch.GetFlags(i));
+}
 
 void IPulseSource::DispatchPulse(PatchCableSource* destination, double time, float velocity, int flags)
 {
@@ -39,3 +78,21 @@ void IPulseSource::DispatchPulse(PatchCableSource* destination, double time, flo
    for (auto* receiver : receivers)
       receiver->OnPulse(time, velocity, flags);
 }
+
+void IPulseSource::DispatchPulses(PatchCableSource* destination, const PulseBatch& batch)
+{
+   int numPulses = batch.GetNumPulses();
+   if (numPulses == 0 || batch.GetTime(0) == destination->GetLastOnEventTime()) //avoid stack overflow, like DispatchPulse()
+      return;
+
+   //the cable only draws the most recent ones anyway
+   for (int i = MAX(0, numPulses - NoteHistory::kHistorySize / 2); i < numPulses; ++i)
+   {
+      double time = batch.GetTime(i);
+      destination->AddHistoryEvent(time, true, batch.GetFlags(i));
+      destination->AddHistoryEvent(time + 15, false);
+   }
+   const std::vector<IPulseReceiver*>& receivers = destination->GetPulseReceivers();
+   for (auto* receiver : receivers)
+      receiver->OnPulses(batch);
+}
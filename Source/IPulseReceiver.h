@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include <vector>
+
 class PatchCableSource;
 
 enum PulseFlags
@@ -40,11 +42,39 @@ enum PulseFlags
    kPulseFlag_Repeat = 0x20
 };
 
+//a buffer's worth of pulses as sample offsets from the start of the buffer, in order, for sources that can fire many in one buffer
+//(like audiotopulse on an audio rate clock). they go down the cable in one call instead of one virtual call per pulse
+class PulseBatch
+{
+public:
+   explicit PulseBatch(int capacity);
+
+   void Clear(double bufferStartTime);
+   bool Add(int offset, float velocity, int flags); //false if it's full. offsets have to be added in order
+   bool IsFull() const { return (int)mOffsets.size() == mCapacity; }
+
+   int GetNumPulses() const { return (int)mOffsets.size(); }
+   double GetBufferStartTime() const { return mBufferStartTime; }
+   double GetTime(int index) const;
+   int GetOffset(int index) const { return mOffsets[index]; }
+   float GetVelocity(int index) const { return mVelocities[index]; }
+   int GetFlags(int index) const { return mFlags[index]; }
+
+private:
+   int mCapacity{ 0 };
+   double mBufferStartTime{ 0 };
+   std::vector<int> mOffsets;
+   std::vector<float> mVelocities;
+   std::vector<int> mFlags;
+};
+
 class IPulseReceiver
 {
 public:
    virtual ~IPulseReceiver() {}
    virtual void OnPulse(double time, float velocity, int flags) = 0;
+   //override to handle a batch as arrays, otherwise it's handed to OnPulse() a pulse at a time
+   virtual void OnPulses(const PulseBatch& batch);
 };
 
 class IPulseSource
@@ -53,4 +83,5 @@ public:
    IPulseSource() {}
    virtual ~IPulseSource() {}
    void DispatchPulse(PatchCableSource* destination, double time, float velocity, int flags);
+   void DispatchPulses(PatchCableSource* destination, const PulseBatch& batch);
 };
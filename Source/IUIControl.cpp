@@ -29,14 +29,22 @@
 #include "ModularSynth.h"
 #include "PatchCable.h"
 #include "Push2Control.h"
+#include "UIControlIndex.h"
 
 //static
 IUIControl* IUIControl::sLastHoveredUIControl = nullptr;
 //static
 bool IUIControl::sLastUIHoverWasSetManually = false;
 
+void IUIControl::Delete()
+{
+   mIsDeleted = true;
+   UIControlIndex::Get().OnControlDeleted(this);
+}
+
 IUIControl::~IUIControl()
 {
+   UIControlIndex::Get().OnControlDeleted(this);
    if (gHoveredUIControl == this)
       gHoveredUIControl = nullptr;
    if (gBindToUIControl == this)
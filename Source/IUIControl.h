@@ -47,7 +47,7 @@ class IUIControl : public IClickable
 public:
    IUIControl()
    {}
-   virtual void Delete() { mIsDeleted = true; }
+   virtual void Delete();
    void AddRemoteController() { ++mRemoteControlCount; }
    void RemoveRemoteController() { --mRemoteControlCount; }
    virtual void SetFromMidiCC(float slider, double time, bool setViaModulator) = 0;
@@ -45,12 +45,11 @@ KarplusStrong::KarplusStrong()
    mBiquad.SetFilterParams(3000, sqrt(2) / 2);
    mBiquad.SetName("biquad");
 
-   for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
-   {
-      mDCRemover[i].SetFilterParams(10, sqrt(2) / 2);
-      mDCRemover[i].SetFilterType(kFilterType_Highpass);
-      mDCRemover[i].UpdateFilterCoeff();
-   }
+   BiquadFilter dcRemover;
+   dcRemover.SetFilterParams(10, sqrt(2) / 2);
+   dcRemover.SetFilterType(kFilterType_Highpass);
+   dcRemover.UpdateFilterCoeff();
+   mDCRemover.SetStageCoefficients(0, dcRemover, false);
 }
 
 void KarplusStrong::CreateUIControls()
@@ -111,11 +110,9 @@ void KarplusStrong::Process(double time)
    mPolyMgr.Process(time, &mWriteBuffer, bufferSize);
 
    for (int ch = 0; ch < mWriteBuffer.NumActiveChannels(); ++ch)
-   {
       Mult(mWriteBuffer.GetChannel(ch), mVolume, bufferSize);
-      if (!mVoiceParams.mInvert) //unnecessary if inversion is eliminating dc offset
-         mDCRemover[ch].Filter(mWriteBuffer.GetChannel(ch), bufferSize);
-   }
+   if (!mVoiceParams.mInvert) //unnecessary if inversion is eliminating dc offset
+      mDCRemover.Process(&mWriteBuffer);
 
    mBiquad.ProcessAudio(time, &mWriteBuffer);
 
@@ -198,8 +195,7 @@ void KarplusStrong::CheckboxUpdated(Checkbox* checkbox, double time)
    if (checkbox == mEnabledCheckbox)
    {
       mPolyMgr.KillAll();
-      for (int ch = 0; ch < ChannelBuffer::kMaxNumChannels; ++ch)
-         mDCRemover[ch].Clear();
+      mDCRemover.Clear();
       mBiquad.Clear();
    }
 }
@@ -207,7 +203,8 @@ void KarplusStrong::CheckboxUpdated(Checkbox* checkbox, double time)
 void KarplusStrong::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
-   mModuleSaveData.LoadInt("voicelimit", moduleInfo, -1, -1, kNumVoices);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, -1, -1, kMaxPolyphony);
+   mModuleSaveData.LoadInt("cpu_priority", moduleInfo, 0, 0, CpuGovernor::kNumLevels - 1);
    EnumMap oversamplingMap;
    oversamplingMap["1"] = 1;
    oversamplingMap["2"] = 2;
@@ -228,6 +225,7 @@ void KarplusStrong::SetUpFromSaveData()
       mPolyMgr.SetVoiceLimit(voiceLimit);
    else
       mPolyMgr.SetVoiceLimit(kNumVoices);
+   mPolyMgr.SetPriority(mModuleSaveData.GetInt("cpu_priority"));
 
    bool mono = mModuleSaveData.GetBool("mono");
    mWriteBuffer.SetNumActiveChannels(mono ? 1 : 2);
@@ -34,6 +34,7 @@
 #include "DropdownList.h"
 #include "Checkbox.h"
 #include "BiquadFilterEffect.h"
+#include "BiquadCascade.h"
 #include "ChannelBuffer.h"
 
 class KarplusStrong : public IAudioProcessor, public INoteReceiver, public IDrawableModule, public IDropdownListener, public IFloatSliderListener
@@ -87,7 +88,7 @@ private:
    DropdownList* mSourceDropdown{ nullptr };
    Checkbox* mInvertCheckbox{ nullptr };
    BiquadFilterEffect mBiquad;
-   BiquadFilter mDCRemover[ChannelBuffer::kMaxNumChannels];
+   BiquadCascade mDCRemover;
 
    Checkbox* mStretchCheckbox{ nullptr };
    FloatSlider* mExciterFreqSlider{ nullptr };
@@ -36,7 +36,7 @@
 #include "juce_core/juce_core.h"
 
 KarplusStrongVoice::KarplusStrongVoice(IDrawableModule* owner)
-: mBuffer(gSampleRate)
+: mDelayLine(gSampleRate)
 , mOwner(owner)
 {
    mOsc.Start(0, 1);
@@ -70,9 +70,9 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out, int oversampli
    int bufferSize = out->BufferSize();
    int channels = out->NumActiveChannels();
    double sampleIncrementMs = gInvSampleRateMs;
-   double sampleRate = gSampleRate;
    ChannelBuffer* destBuffer = out;
 
+   mOversampler.SetFactor(oversampling);
    if (oversampling != 1)
    {
       gMidiVoiceWorkChannelBuffer.SetNumActiveChannels(channels);
@@ -80,31 +80,46 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out, int oversampli
       gMidiVoiceWorkChannelBuffer.Clear();
       bufferSize *= oversampling;
       sampleIncrementMs /= oversampling;
-      sampleRate *= oversampling;
    }
 
-   float freq;
-   float filterRate;
+   float delaySamples;
    float filterLerp;
    float pitch;
    float oscPhaseInc;
 
    if (mVoiceParams->mLiteCPUMode)
-      DoParameterUpdate(0, oversampling, pitch, freq, filterRate, filterLerp, oscPhaseInc);
+      DoParameterUpdate(0, oversampling, pitch, delaySamples, filterLerp, oscPhaseInc);
+
+   if (mVoiceParams->mSourceType == kSourceTypeSaw)
+      mOsc.SetType(kOsc_Saw);
+   else
+      mOsc.SetType(kOsc_Sin);
+
+   bool useEnvelope = mVoiceParams->mSourceType != kSourceTypeInputNoEnvelope;
+   if (useEnvelope)
+   {
+      if ((int)mEnvValues.size() < bufferSize)
+         mEnvValues.resize(bufferSize);
+      mEnv.RenderBlock(time, mEnvValues.data(), bufferSize, sampleIncrementMs);
+   }
+
+   bool useNoise = mVoiceParams->mSourceType == kSourceTypeNoise || mVoiceParams->mSourceType == kSourceTypeMix;
+   if (useNoise)
+   {
+      if ((int)mNoiseValues.size() < bufferSize)
+         mNoiseValues.resize(bufferSize);
+      mNoise.FillBipolar(mNoiseValues.data(), bufferSize);
+   }
 
    for (int pos = 0; pos < bufferSize; ++pos)
    {
       if (!mVoiceParams->mLiteCPUMode)
-         DoParameterUpdate(pos / oversampling, oversampling, pitch, freq, filterRate, filterLerp, oscPhaseInc);
+         DoParameterUpdate(pos / oversampling, oversampling, pitch, delaySamples, filterLerp, oscPhaseInc);
 
-      if (mVoiceParams->mSourceType == kSourceTypeSaw)
-         mOsc.SetType(kOsc_Saw);
-      else
-         mOsc.SetType(kOsc_Sin);
       mOscPhase += oscPhaseInc;
       float sample = 0;
       float oscSample = mOsc.Audio(time, mOscPhase);
-      float noiseSample = RandomSample();
+      float noiseSample = useNoise ? mNoiseValues[pos] : 0;
       float pitchBlend = ofClamp((pitch - 40) / 60.0f, 0, 1);
       pitchBlend *= pitchBlend;
       if (mVoiceParams->mSourceType == kSourceTypeSin || mVoiceParams->mSourceType == kSourceTypeSaw)
@@ -116,26 +131,10 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out, int oversampli
       else if (mVoiceParams->mSourceType == kSourceTypeInput || mVoiceParams->mSourceType == kSourceTypeInputNoEnvelope)
          sample = mKarplusStrongModule->GetBuffer()->GetChannel(0)[pos / oversampling];
 
-      if (mVoiceParams->mSourceType != kSourceTypeInputNoEnvelope)
-         sample *= mEnv.Value(time) + mVoiceParams->mExcitation;
+      if (useEnvelope)
+         sample *= mEnvValues[pos] + mVoiceParams->mExcitation;
 
-      float samplesAgo = sampleRate / freq;
-      AssertIfDenormal(samplesAgo);
-      float feedbackSample = 0;
-      if (samplesAgo < mBuffer.Size())
-      {
-         //interpolated delay
-         int delay_pos = int(samplesAgo);
-         int posNext = int(samplesAgo) + 1;
-         if (delay_pos < mBuffer.Size())
-         {
-            float delay_sample = delay_pos < 0 ? 0 : mBuffer.GetSample(delay_pos, 0);
-            float nextSample = posNext >= mBuffer.Size() ? 0 : mBuffer.GetSample(posNext, 0);
-            float a = samplesAgo - delay_pos;
-            feedbackSample = (1 - a) * delay_sample + a * nextSample; //interpolate
-            JUCE_UNDENORMALISE(feedbackSample);
-         }
-      }
+      float feedbackSample = mDelayLine.Read(delaySamples);
       mFilteredSample = ofLerp(feedbackSample, mFilteredSample, filterLerp);
       JUCE_UNDENORMALISE(mFilteredSample);
       //sample += mFeedbackRamp.Value(time) * mFilterSample;
@@ -151,7 +150,7 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out, int oversampli
          outputSample = sampleForFeedbackBuffer;
       JUCE_UNDENORMALISE(sample);
 
-      mBuffer.Write(sampleForFeedbackBuffer, 0);
+      mDelayLine.Write(sampleForFeedbackBuffer);
 
       if (channels == 1)
       {
@@ -168,20 +167,12 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out, int oversampli
 
    if (oversampling != 1)
    {
-      //assume power-of-two
-      while (oversampling > 1)
-      {
-         for (int i = 0; i < bufferSize; ++i)
-         {
-            for (int ch = 0; ch < channels; ++ch)
-               destBuffer->GetChannel(ch)[i] = (destBuffer->GetChannel(ch)[i * 2] + destBuffer->GetChannel(ch)[i * 2 + 1]) / 2;
-         }
-         oversampling /= 2;
-         bufferSize /= 2;
-      }
-
+      bufferSize /= oversampling;
       for (int ch = 0; ch < channels; ++ch)
+      {
+         mOversampler.Downsample(ch, destBuffer->GetChannel(ch), destBuffer->GetChannel(ch), bufferSize);
          Add(out->GetChannel(ch), destBuffer->GetChannel(ch), bufferSize);
+      }
    }
 
    return true;
@@ -190,8 +181,7 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out, int oversampli
 void KarplusStrongVoice::DoParameterUpdate(int samplesIn,
                                            int oversampling,
                                            float& pitch,
-                                           float& freq,
-                                           float& filterRate,
+                                           float& delaySamples,
                                            float& filterLerp,
                                            float& oscPhaseInc)
 {
@@ -202,9 +192,28 @@ void KarplusStrongVoice::DoParameterUpdate(int samplesIn,
    if (mVoiceParams->mInvert)
       pitch += 12; //inverting the pitch gives an octave down sound by halving the resonating frequency, so correct for that
 
-   freq = TheScale->PitchToFreq(pitch);
-   filterRate = mVoiceParams->mFilter * pow(freq / 300, exp2(mVoiceParams->mPitchTone)) * (1 + GetModWheel(samplesIn));
-   filterLerp = ofClamp(exp2(-filterRate / oversampling), 0, 1);
+   float freq = TheScale->PitchToFreq(pitch);
+   float filterRate = mVoiceParams->mFilter * (1 + GetModWheel(samplesIn));
+   float sampleRate = gSampleRate * oversampling;
+   if (freq != mCachedFreq || filterRate != mCachedFilterRate || mVoiceParams->mPitchTone != mCachedPitchTone || sampleRate != mCachedSampleRate)
+   {
+      mCachedFreq = freq;
+      mCachedFilterRate = filterRate;
+      mCachedPitchTone = mVoiceParams->mPitchTone;
+      mCachedSampleRate = sampleRate;
+
+      float damping = filterRate * pow(freq / 300, exp2(mVoiceParams->mPitchTone));
+      mCachedFilterLerp = ofClamp(exp2(-damping / oversampling), 0, 1);
+
+      //the damping filter delays the loop too, by more of the period the higher the note is.
+      //take its phase delay at the fundamental out of the delay line, so the string stays in tune
+      float fundamental = mVoiceParams->mInvert ? freq / 2 : freq;
+      float w = FTWO_PI * MIN(fundamental, sampleRate * .49f) / sampleRate;
+      float filterDelay = atan2f(mCachedFilterLerp * sinf(w), 1 - mCachedFilterLerp * cosf(w)) / w;
+      mCachedDelaySamples = FractionalDelayLine::CompensateForFrequency(sampleRate / freq - filterDelay, w);
+   }
+   delaySamples = mCachedDelaySamples;
+   filterLerp = mCachedFilterLerp;
 
    oscPhaseInc = GetPhaseInc(mVoiceParams->mExciterFreq) / oversampling;
 }
@@ -231,7 +240,7 @@ void KarplusStrongVoice::Stop(double time)
 
 void KarplusStrongVoice::ClearVoice()
 {
-   mBuffer.ClearBuffer();
+   mDelayLine.Clear();
    mFilteredSample = 0;
    mActive = false;
 }
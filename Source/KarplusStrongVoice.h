@@ -29,8 +29,12 @@
 #include "IVoiceParams.h"
 #include "ADSR.h"
 #include "EnvOscillator.h"
-#include "RollingBuffer.h"
+#include "FractionalDelayLine.h"
 #include "Ramp.h"
+#include "Oversampler.h"
+#include "RandomBlock.h"
+
+#include <vector>
 
 class IDrawableModule;
 class KarplusStrong;
@@ -83,8 +87,7 @@ private:
    void DoParameterUpdate(int samplesIn,
                           int oversampling,
                           float& pitch,
-                          float& freq,
-                          float& filterRate,
+                          float& delaySamples,
                           float& filterLerp,
                           float& oscPhaseInc);
 
@@ -92,11 +95,23 @@ private:
    EnvOscillator mOsc{ OscillatorType::kOsc_Sin };
    ::ADSR mEnv;
    KarplusStrongVoiceParams* mVoiceParams{ nullptr };
-   RollingBuffer mBuffer;
+   FractionalDelayLine mDelayLine;
    float mFilteredSample{ 0 };
+   std::vector<float> mEnvValues;
+   RandomBlock mNoise;
+   std::vector<float> mNoiseValues;
+
+   //the loop length and damping only need working out again when something they depend on changes
+   float mCachedFreq{ -1 };
+   float mCachedFilterRate{ -1 };
+   float mCachedPitchTone{ 0 };
+   float mCachedSampleRate{ -1 };
+   float mCachedDelaySamples{ 0 };
+   float mCachedFilterLerp{ 0 };
    Ramp mMuteRamp;
    float mLastBufferSample{ 0 };
    bool mActive{ false };
+   Oversampler mOversampler;
    IDrawableModule* mOwner{ nullptr };
    KarplusStrong* mKarplusStrongModule{ nullptr };
 };
@@ -131,6 +131,61 @@ float LFO::Value(int samplesIn /*= 0*/, float forcePhase /*= -1*/) const
    return sample;
 }
 
+void LFO::ValueBlock(float* out, int numSamples) const
+{
+   OscillatorType type = mOsc.GetType();
+   bool linearPhase = mPeriod != kInterval_None && type != kOsc_Random && type != kOsc_Drunk && type != kOsc_Perlin;
+   if (linearPhase && mPeriod != kInterval_Free)
+      linearPhase = TheTransport->IsPastQueuedMeasureJump(gTime) == TheTransport->IsPastQueuedMeasureJump(gTime + numSamples * gInvSampleRateMs);
+
+   if (type == kOsc_Perlin && mPeriod != kInterval_None)
+   {
+      //the same walk through the noise as Value(), a block at a time
+      double perlinPhase = ((gTime - mPhaseResetTime) + mPhaseOffset * 1000) * mFreeRate / 1000.0f;
+      double perlinStep = gInvSampleRateMs * mFreeRate / 1000.0f;
+      sPerlinNoise.noiseBlock(out, numSamples, perlinPhase, perlinStep, mRandomSeed, -perlinPhase, -perlinStep);
+      for (int i = 0; i < numSamples; ++i)
+      {
+         if (mOsc.GetPulseWidth() != .5f)
+            out[i] = Bias(out[i], mOsc.GetPulseWidth());
+         if (mMode == kLFOMode_Oscillator) //rescale to -1 1
+            out[i] = (out[i] - .5f * 2);
+      }
+      return;
+   }
+
+   if (!linearPhase)
+   {
+      for (int i = 0; i < numSamples; ++i)
+         out[i] = Value(i);
+      return;
+   }
+
+   //the phase moves at a constant rate across a block, so step it rather than asking the transport every sample
+   float startPhase = CalculatePhase(0, false);
+   float phaseIncrement;
+   if (mPeriod == kInterval_Free)
+   {
+      phaseIncrement = mFreeRate / gSampleRate;
+   }
+   else
+   {
+      float period = TheTransport->GetDuration(mPeriod) / TheTransport->GetDuration(kInterval_1n);
+      phaseIncrement = gInvSampleRateMs / TheTransport->MsPerBar() / period;
+   }
+
+   for (int i = 0; i < numSamples; ++i)
+   {
+      float phase = startPhase + i * phaseIncrement;
+      if (mPeriod != kInterval_Free)
+         phase -= int(phase) / 2 * 2;
+      float sample = mOsc.Value(TransformPhase(phase) * FTWO_PI);
+      if (mMode == kLFOMode_Envelope) //rescale to 0 1
+         sample = sample * .5f + .5f;
+      out[i] = sample;
+   }
+}
+
 void LFO::SetPeriod(NoteInterval interval)
 {
    if (interval == kInterval_Free)
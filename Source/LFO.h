@@ -43,6 +43,7 @@ public:
    LFO();
    ~LFO();
    float Value(int samplesIn = 0, float forcePhase = -1) const;
+   void ValueBlock(float* out, int numSamples) const;
    void SetOffset(float offset)
    {
       mPhaseOffset = offset;
@@ -139,6 +139,8 @@ void LatencyCalculatorSender::SetUpFromSaveData()
    mReceiver = dynamic_cast<LatencyCalculatorReceiver*>(receiver);
 }
 
+std::atomic<float> LatencyCalculatorReceiver::sMeasuredLatencyMs{ -1 };
+
 LatencyCalculatorReceiver::LatencyCalculatorReceiver()
 : IAudioProcessor(gBufferSize)
 {
@@ -171,6 +173,7 @@ void LatencyCalculatorReceiver::Process(double time)
          {
             mState = State::DisplayResult;
             mTestEndTime = time;
+            sMeasuredLatencyMs = mTestSamplesElapsed * gInvSampleRateMs;
          }
       }
 
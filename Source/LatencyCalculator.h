@@ -31,6 +31,8 @@
 #include "IDrawableModule.h"
 #include "ClickButton.h"
 
+#include <atomic>
+
 class LatencyCalculatorReceiver;
 
 class LatencyCalculatorSender : public IAudioSource, public IDrawableModule, public IButtonListener
@@ -46,6 +48,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //part of a measurement
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
@@ -88,8 +91,13 @@ public:
    void OnTestRequested();
    void OnTestStarted(double time, int samplesIn);
 
+   //the round trip from the most recent test that got a result, in ms, or -1 if there hasn't been one.
+   //other modules (e.g. looperrecorder) can use this to compensate for the input latency
+   static float GetMeasuredLatencyMs() { return sMeasuredLatencyMs; }
+
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //part of a measurement
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
@@ -117,6 +125,7 @@ private:
 
    State mState{ State::Init };
    int mTestSamplesElapsed{ 0 };
+   static std::atomic<float> sMeasuredLatencyMs;
    double mTestStartTime{ 0.0 };
    double mTestEndTime{ 0.0 };
 };
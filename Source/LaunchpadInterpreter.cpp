@@ -31,10 +31,23 @@ LaunchpadInterpreter::LaunchpadInterpreter(ILaunchpadListener* listener)
 {
 }
 
+LaunchpadInterpreter::~LaunchpadInterpreter()
+{
+   mLights.SetSender(nullptr);
+}
+
 void LaunchpadInterpreter::SetController(MidiController* controller, int page)
 {
+   mLights.SetSender(nullptr);
    mController = controller;
    mControllerPage = page;
+   if (mController != nullptr)
+   {
+      mLights.SetSender([this](const std::vector<LedFramebuffer::Change>& changes, const LedFramebuffer& lights)
+                        {
+                           SendLights(changes, lights);
+                        });
+   }
 }
 
 void LaunchpadInterpreter::OnMidiNote(MidiNote& note)
@@ -96,25 +109,64 @@ void LaunchpadInterpreter::UpdateLights(std::vector<LightUpdate> lightUpdates, b
       else
          val = color;
 
-      if (mLights[lookup] != val || force)
+      mLights.Set(lookup, val, force);
+   }
+}
+
+//led output thread
+void LaunchpadInterpreter::SendLights(const std::vector<LedFramebuffer::Change>& changes, const LedFramebuffer& lights)
+{
+   const int kRapidUpdateThreshold = 16;
+
+   juce::MidiBuffer messages;
+   int channel = mController->GetOutChannel();
+   auto addNote = [&](int pitch, int val)
+   {
+      if (val > 0)
+         messages.addEvent(juce::MidiMessage::noteOn(channel, pitch, (juce::uint8)val), 0);
+      else
+         messages.addEvent(juce::MidiMessage::noteOff(channel, pitch), 0);
+   };
+
+   if (!IsMonome() && (int)changes.size() >= kRapidUpdateThreshold)
+   {
+      //a big change goes out as a rapid update: after a layout message, each note on channel 3 sets the next two lights,
+      //through the grid from the top left, then the side column from the top, then the top row. half the messages of setting them one by one
+      auto rapidUpdateLookup = [](int position)
       {
+         if (position < 64)
+            return position % 8 + (7 - position / 8) * 8;
+         if (position < 72)
+            return 64 + (7 - (position - 64));
+         return position;
+      };
+      messages.addEvent(juce::MidiMessage(0xB0, 0x01, 0x00), 0);
+      for (int position = 0; position < lights.GetNumLeds(); position += 2)
+         messages.addEvent(juce::MidiMessage(0x92, lights.GetSent(rapidUpdateLookup(position)), lights.GetSent(rapidUpdateLookup(position + 1))), 0);
+   }
+   else
+   {
+      for (const auto& change : changes)
+      {
+         int lookup = change.mIndex;
          if (IsMonome())
          {
-            if (x >= 0 && y >= 0)
-               mController->SendNote(mControllerPage, x + (7 - y) * 8, val);
+            if (lookup < 64)
+               addNote(lookup % 8 + (7 - lookup / 8) * 8, change.mValue);
          }
          else
          {
-            if (x == -1)
-               mController->SendNote(mControllerPage, 8 + (7 - y) * 16, val);
-            else if (y == -1)
-               mController->SendData(mControllerPage, 176, x + 104, val);
+            if (lookup < 64)
+               addNote(lookup % 8 + (7 - lookup / 8) * 16, change.mValue);
+            else if (lookup < 72)
+               addNote(8 + (7 - (lookup - 64)) * 16, change.mValue);
             else
-               mController->SendNote(mControllerPage, x + (7 - y) * 16, val);
+               messages.addEvent(juce::MidiMessage(176, lookup - 72 + 104, change.mValue), 0);
          }
-         mLights[lookup] = val;
       }
    }
+
+   mController->SendMessages(mControllerPage, messages);
 }
 
 void LaunchpadInterpreter::Draw(ofVec2f vPos)
@@ -131,6 +183,9 @@ void LaunchpadInterpreter::ResetLaunchpad()
       for (int i = 0; i < 64; ++i)
          mController->SendNote(mControllerPage, i, 0);
    }
+
+   //the device is dark now, whatever it was showing
+   mLights.Invalidate();
 }
 
 int LaunchpadInterpreter::LaunchpadColor(int r, int g)
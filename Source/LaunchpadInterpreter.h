@@ -26,6 +26,7 @@
 #pragma once
 
 #include "OpenFrameworksPort.h"
+#include "LedFramebuffer.h"
 
 class MidiController;
 struct MidiNote;
@@ -58,6 +59,7 @@ class LaunchpadInterpreter
 {
 public:
    LaunchpadInterpreter(ILaunchpadListener* listener);
+   ~LaunchpadInterpreter();
    void SetController(MidiController* controller, int controllerPage);
    void OnMidiNote(MidiNote& note);
    void OnMidiControl(MidiControl& control);
@@ -70,9 +72,10 @@ public:
 
 private:
    bool IsMonome() const;
+   void SendLights(const std::vector<LedFramebuffer::Change>& changes, const LedFramebuffer& lights);
 
    ILaunchpadListener* mListener{ nullptr };
-   int mLights[64 + 8 + 8]{}; //grid + side + top
    MidiController* mController{ nullptr };
    int mControllerPage{ 0 };
+   LedFramebuffer mLights{ 64 + 8 + 8 }; //grid + side + top
 };
@@ -0,0 +1,168 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    LedFramebuffer.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "LedFramebuffer.h"
+
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+
+namespace
+{
+   const int kFlushIntervalMs = 10;
+
+   class LedOutputThread : public juce::Thread
+   {
+   public:
+      LedOutputThread()
+      : juce::Thread("led output")
+      {
+      }
+
+      ~LedOutputThread() override
+      {
+         stopThread(1000);
+      }
+
+      void Add(LedFramebuffer* leds)
+      {
+         {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFramebuffers.push_back(leds);
+         }
+         if (!isThreadRunning())
+            startThread(5);
+      }
+
+      void Remove(LedFramebuffer* leds)
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         mFramebuffers.erase(std::remove(mFramebuffers.begin(), mFramebuffers.end(), leds), mFramebuffers.end());
+      }
+
+      void run() override
+      {
+         while (!threadShouldExit())
+         {
+            {
+               std::lock_guard<std::mutex> lock(mMutex);
+               for (auto* leds : mFramebuffers)
+                  leds->Flush();
+            }
+            wait(kFlushIntervalMs);
+         }
+      }
+
+   private:
+      std::mutex mMutex;
+      std::vector<LedFramebuffer*> mFramebuffers;
+   };
+
+   LedOutputThread& GetOutputThread()
+   {
+      static LedOutputThread sThread;
+      return sThread;
+   }
+}
+
+LedFramebuffer::LedFramebuffer(int numLeds)
+{
+   Resize(numLeds);
+   GetOutputThread().Add(this);
+}
+
+LedFramebuffer::~LedFramebuffer()
+{
+   GetOutputThread().Remove(this);
+}
+
+void LedFramebuffer::SetSender(Sender sender)
+{
+   std::lock_guard<std::mutex> lock(mSenderMutex);
+   mSender = sender;
+   Invalidate();
+}
+
+void LedFramebuffer::Resize(int numLeds)
+{
+   std::lock_guard<std::mutex> senderLock(mSenderMutex);
+   std::lock_guard<std::mutex> lock(mValuesMutex);
+   mValues.assign(numLeds, 0);
+   mForced.assign(numLeds, false);
+   mSent.assign(numLeds, 0);
+   mDirty = true;
+   mInvalidated = true;
+}
+
+void LedFramebuffer::Set(int index, int value, bool force)
+{
+   std::lock_guard<std::mutex> lock(mValuesMutex);
+   if (index < 0 || index >= (int)mValues.size())
+      return;
+   if (mValues[index] != value || force)
+   {
+      mValues[index] = value;
+      if (force)
+         mForced[index] = true;
+      mDirty = true;
+   }
+}
+
+void LedFramebuffer::Invalidate()
+{
+   std::lock_guard<std::mutex> lock(mValuesMutex);
+   mDirty = true;
+   mInvalidated = true;
+}
+
+void LedFramebuffer::Flush()
+{
+   std::lock_guard<std::mutex> senderLock(mSenderMutex);
+   if (mSender == nullptr)
+      return;
+
+   //only hold the values lock long enough to diff, so that setting a light never waits on a send
+   mChanges.clear();
+   {
+      std::lock_guard<std::mutex> lock(mValuesMutex);
+      if (!mDirty)
+         return;
+      for (int i = 0; i < (int)mValues.size(); ++i)
+      {
+         if (mInvalidated || mForced[i] || mValues[i] != mSent[i])
+         {
+            mChanges.push_back({ i, mValues[i] });
+            mSent[i] = mValues[i];
+            mForced[i] = false;
+         }
+      }
+      mDirty = false;
+      mInvalidated = false;
+   }
+
+   if (!mChanges.empty())
+      mSender(mChanges, *this);
+}
@@ -0,0 +1,71 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    LedFramebuffer.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+//the lights of one controller, as an array of raw values. setting a light, from any thread, only writes here. a shared led output
+//thread compares it against what was last sent a few times a second, and hands just the changes to the device's sender all at once,
+//so it can batch them however that device likes (one midi block, a rapid update stream, an 8x8 quad message)
+class LedFramebuffer
+{
+public:
+   struct Change
+   {
+      int mIndex{ 0 };
+      int mValue{ 0 };
+   };
+   using Sender = std::function<void(const std::vector<Change>& changes, const LedFramebuffer& leds)>;
+
+   explicit LedFramebuffer(int numLeds);
+   ~LedFramebuffer();
+
+   void SetSender(Sender sender); //nullptr to stop sending, waits for a send in progress to finish
+   void Resize(int numLeds);
+   void Set(int index, int value, bool force = false);
+   void Invalidate(); //resend everything, for when the device may have lost what it was showing
+
+   //for senders, during a send
+   int GetSent(int index) const { return mSent[index]; }
+   int GetNumLeds() const { return (int)mSent.size(); }
+
+   void Flush(); //led output thread
+
+private:
+   std::mutex mValuesMutex;
+   std::vector<int> mValues;
+   std::vector<bool> mForced;
+   bool mDirty{ false };
+   bool mInvalidated{ true };
+
+   std::mutex mSenderMutex;
+   Sender mSender;
+   std::vector<int> mSent;
+   std::vector<Change> mChanges;
+};
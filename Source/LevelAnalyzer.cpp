@@ -0,0 +1,377 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    LevelAnalyzer.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "LevelAnalyzer.h"
+#include "Profiler.h"
+#include "SynthGlobals.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace
+{
+   const float kPeakDecaySeconds = .01f; //the time to fall by half, as PeakTracker counts it
+   const float kSlowPeakDecaySeconds = 3;
+   const float kRmsSeconds = .3f;
+
+   constexpr int kTruePeakPhases = LevelAnalyzer::kTruePeakOversampling;
+   constexpr int kTruePeakTaps = LevelAnalyzer::kTruePeakTaps;
+
+   void AbsMaxAndSumOfSquares(const float* buffer, int length, float& absMax, float& sumOfSquares)
+   {
+      int i = 0;
+#if defined(__wasm_simd128__)
+      v128_t max4 = wasm_f32x4_splat(0);
+      v128_t sum4 = wasm_f32x4_splat(0);
+      for (; i + 4 <= length; i += 4)
+      {
+         v128_t x = wasm_v128_load(buffer + i);
+         max4 = wasm_f32x4_pmax(max4, wasm_f32x4_abs(x));
+         sum4 = wasm_f32x4_add(sum4, wasm_f32x4_mul(x, x));
+      }
+      absMax = MAX(MAX(wasm_f32x4_extract_lane(max4, 0), wasm_f32x4_extract_lane(max4, 1)), MAX(wasm_f32x4_extract_lane(max4, 2), wasm_f32x4_extract_lane(max4, 3)));
+      sumOfSquares = wasm_f32x4_extract_lane(sum4, 0) + wasm_f32x4_extract_lane(sum4, 1) + wasm_f32x4_extract_lane(sum4, 2) + wasm_f32x4_extract_lane(sum4, 3);
+#else
+      //four independent accumulators, so the compiler is free to vectorize the reductions
+      float max[4]{};
+      float sum[4]{};
+      for (; i + 4 <= length; i += 4)
+      {
+         for (int lane = 0; lane < 4; ++lane)
+         {
+            max[lane] = MAX(max[lane], fabsf(buffer[i + lane]));
+            sum[lane] += buffer[i + lane] * buffer[i + lane];
+         }
+      }
+      absMax = MAX(MAX(max[0], max[1]), MAX(max[2], max[3]));
+      sumOfSquares = sum[0] + sum[1] + sum[2] + sum[3];
+#endif
+      for (; i < length; ++i)
+      {
+         absMax = MAX(absMax, fabsf(buffer[i]));
+         sumOfSquares += buffer[i] * buffer[i];
+      }
+   }
+
+   //bs.1770, for a mean square of k-weighted samples. unbounded below, for the gates
+   double Loudness(double meanSquare)
+   {
+      return meanSquare > 0 ? -.691 + 10 * log10(meanSquare) : -1000;
+   }
+
+   float DisplayLoudness(double meanSquare)
+   {
+      return (float)MAX(LevelAnalyzer::kSilentLoudness, Loudness(meanSquare));
+   }
+}
+
+//static
+const float* LevelAnalyzer::GetTruePeakCoefficients()
+{
+   static const std::array<float, kTruePeakTaps * kTruePeakPhases> sCoefficients = []
+   {
+      std::array<float, kTruePeakTaps * kTruePeakPhases> coefficients{};
+      const int length = kTruePeakTaps * kTruePeakPhases;
+      const double center = (length - 1) * .5;
+      for (int phase = 0; phase < kTruePeakPhases; ++phase)
+      {
+         double sum = 0;
+         for (int tap = 0; tap < kTruePeakTaps; ++tap)
+         {
+            int m = tap * kTruePeakPhases + phase;
+            double x = (m - center) / kTruePeakPhases;
+            double sinc = x == 0 ? 1 : sin(M_PI * x) / (M_PI * x);
+            double window = .42 - .5 * cos(2 * M_PI * m / (length - 1)) + .08 * cos(4 * M_PI * m / (length - 1));
+            coefficients[tap * kTruePeakPhases + phase] = (float)(sinc * window);
+            sum += sinc * window;
+         }
+         for (int tap = 0; tap < kTruePeakTaps; ++tap)
+            coefficients[tap * kTruePeakPhases + phase] /= (float)sum; //each phase passes dc at unity gain
+      }
+      return coefficients;
+   }();
+   return sCoefficients.data();
+}
+
+void LevelAnalyzer::UpdateCoefficients()
+{
+   mSampleRate = gSampleRate;
+   mPeakDecay = powf(.5f, kSubBlock / (kPeakDecaySeconds * mSampleRate));
+   mSlowPeakDecay = powf(.5f, kSubBlock / (kSlowPeakDecaySeconds * mSampleRate));
+   mRmsSmoothing = expf(-kSubBlock / (kRmsSeconds * mSampleRate));
+
+   //the k-weighting filter of bs.1770, worked out for any sample rate the way libebur128 does it: a high shelf for the head, then a high pass
+   {
+      const double f0 = 1681.974450955533;
+      const double gain = 3.999843853973347;
+      const double q = .7071752369554196;
+      double k = tan(M_PI * f0 / mSampleRate);
+      double vh = pow(10, gain / 20);
+      double vb = pow(vh, .4996667741545416);
+      double a0 = 1 + k / q + k * k;
+      mShelf.mB0 = (float)((vh + vb * k / q + k * k) / a0);
+      mShelf.mB1 = (float)(2 * (k * k - vh) / a0);
+      mShelf.mB2 = (float)((vh - vb * k / q + k * k) / a0);
+      mShelf.mA1 = (float)(2 * (k * k - 1) / a0);
+      mShelf.mA2 = (float)((1 - k / q + k * k) / a0);
+   }
+   {
+      const double f0 = 38.13547087602444;
+      const double q = .5003270373238773;
+      double k = tan(M_PI * f0 / mSampleRate);
+      double a0 = 1 + k / q + k * k;
+      mHighPass.mB0 = 1;
+      mHighPass.mB1 = -2;
+      mHighPass.mB2 = 1;
+      mHighPass.mA1 = (float)(2 * (k * k - 1) / a0);
+      mHighPass.mA2 = (float)((1 - k / q + k * k) / a0);
+   }
+
+   mLoudnessBlockLength = MAX(1, (int)(mSampleRate / 10));
+   ResetLoudnessState();
+}
+
+void LevelAnalyzer::Process(int channel, const float* buffer, int bufferSize, double time)
+{
+   PROFILER(LevelAnalyzer);
+
+   if (channel < 0 || channel >= (int)mChannels.size() || bufferSize <= 0)
+      return;
+
+   if (mSampleRate != gSampleRate)
+      UpdateCoefficients();
+
+   Channel& state = mChannels[channel];
+   const float epsilon = std::numeric_limits<float>::epsilon();
+   const bool useLimit = mSlowPeakLimit > epsilon;
+   float peak = state.mPeakState;
+   float slowPeak = state.mSlowPeakState;
+   float meanSquare = state.mMeanSquare;
+   float blockMax = 0;
+   for (int start = 0; start < bufferSize; start += kSubBlock)
+   {
+      int length = MIN(kSubBlock, bufferSize - start);
+      float absMax, sumOfSquares;
+      AbsMaxAndSumOfSquares(buffer + start, length, absMax, sumOfSquares);
+      blockMax = MAX(blockMax, absMax);
+
+      float peakDecay = mPeakDecay;
+      float slowPeakDecay = mSlowPeakDecay;
+      float rmsSmoothing = mRmsSmoothing;
+      if (length < kSubBlock)
+      {
+         float fraction = length / (float)kSubBlock;
+         peakDecay = powf(peakDecay, fraction);
+         slowPeakDecay = powf(slowPeakDecay, fraction);
+         rmsSmoothing = powf(rmsSmoothing, fraction);
+      }
+
+      peak = MAX(absMax, peak * peakDecay);
+      if (peak < epsilon)
+         peak = 0;
+
+      slowPeak = MAX(absMax, slowPeak * slowPeakDecay);
+      if (useLimit && slowPeak >= mSlowPeakLimit)
+      {
+         slowPeak = mSlowPeakLimit;
+         state.mHitLimitTime.store(time + start * gInvSampleRateMs, std::memory_order_relaxed);
+      }
+      if (slowPeak < epsilon)
+         slowPeak = 0;
+
+      float subBlockMeanSquare = sumOfSquares / length;
+      meanSquare = subBlockMeanSquare + (meanSquare - subBlockMeanSquare) * rmsSmoothing;
+   }
+   state.mPeakState = peak;
+   state.mSlowPeakState = slowPeak;
+   state.mMeanSquare = meanSquare;
+   state.mPeak.store(peak, std::memory_order_relaxed);
+   state.mSlowPeak.store(slowPeak, std::memory_order_relaxed);
+   state.mRms.store(sqrtf(meanSquare), std::memory_order_relaxed);
+
+   if (mMeasureLoudness)
+   {
+      if (channel == 0)
+      {
+         if (mWantResetLoudness.exchange(false))
+            ResetLoudnessState();
+         if (mLoudnessBlockSamples >= mLoudnessBlockLength)
+            EndLoudnessBlock();
+         mLoudnessBlockSamples += bufferSize;
+      }
+
+      MeasureTruePeak(state, buffer, bufferSize);
+      state.mTruePeakState = MAX(state.mTruePeakState, blockMax); //the interpolated points fall between the samples, never on them
+      state.mTruePeak.store(state.mTruePeakState, std::memory_order_relaxed);
+
+      mLoudnessBlockEnergy += KWeightedSumOfSquares(state, buffer, bufferSize);
+   }
+}
+
+void LevelAnalyzer::MeasureTruePeak(Channel& state, const float* buffer, int bufferSize)
+{
+   const int history = kTruePeakTaps - 1;
+   if ((int)state.mTruePeakInput.size() < history + bufferSize)
+      state.mTruePeakInput.resize(history + bufferSize); //only when the buffer size goes up
+   float* input = state.mTruePeakInput.data();
+   BufferCopy(input + history, buffer, bufferSize);
+
+   const float* coefficients = GetTruePeakCoefficients();
+   float truePeak = 0;
+#if defined(__wasm_simd128__)
+   v128_t max4 = wasm_f32x4_splat(0);
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      const float* x = input + history + i;
+      v128_t sum4 = wasm_f32x4_splat(0);
+      for (int tap = 0; tap < kTruePeakTaps; ++tap)
+         sum4 = wasm_f32x4_add(sum4, wasm_f32x4_mul(wasm_f32x4_splat(x[-tap]), wasm_v128_load(coefficients + tap * kTruePeakPhases)));
+      max4 = wasm_f32x4_pmax(max4, wasm_f32x4_abs(sum4));
+   }
+   truePeak = MAX(MAX(wasm_f32x4_extract_lane(max4, 0), wasm_f32x4_extract_lane(max4, 1)), MAX(wasm_f32x4_extract_lane(max4, 2), wasm_f32x4_extract_lane(max4, 3)));
+#else
+   float max[kTruePeakPhases]{};
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      const float* x = input + history + i;
+      float sum[kTruePeakPhases]{};
+      for (int tap = 0; tap < kTruePeakTaps; ++tap)
+      {
+         for (int phase = 0; phase < kTruePeakPhases; ++phase)
+            sum[phase] += x[-tap] * coefficients[tap * kTruePeakPhases + phase];
+      }
+      for (int phase = 0; phase < kTruePeakPhases; ++phase)
+         max[phase] = MAX(max[phase], fabsf(sum[phase]));
+   }
+   for (int phase = 0; phase < kTruePeakPhases; ++phase)
+      truePeak = MAX(truePeak, max[phase]);
+#endif
+   state.mTruePeakState = MAX(state.mTruePeakState, truePeak);
+
+   memmove(input, input + bufferSize, history * sizeof(float));
+}
+
+float LevelAnalyzer::KWeightedSumOfSquares(Channel& state, const float* buffer, int bufferSize)
+{
+   //each sample depends on the last, so this stays scalar. everything lives in locals for the length of the block
+   const Biquad shelf = mShelf;
+   const Biquad highPass = mHighPass;
+   float shelfZ1 = state.mShelfZ1;
+   float shelfZ2 = state.mShelfZ2;
+   float highPassZ1 = state.mHighPassZ1;
+   float highPassZ2 = state.mHighPassZ2;
+   float sum = 0;
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      float x = buffer[i];
+      float shelved = shelf.mB0 * x + shelfZ1;
+      shelfZ1 = shelf.mB1 * x - shelf.mA1 * shelved + shelfZ2;
+      shelfZ2 = shelf.mB2 * x - shelf.mA2 * shelved;
+      float weighted = highPass.mB0 * shelved + highPassZ1;
+      highPassZ1 = highPass.mB1 * shelved - highPass.mA1 * weighted + highPassZ2;
+      highPassZ2 = highPass.mB2 * shelved - highPass.mA2 * weighted;
+      sum += weighted * weighted;
+   }
+   state.mShelfZ1 = shelfZ1;
+   state.mShelfZ2 = shelfZ2;
+   state.mHighPassZ1 = highPassZ1;
+   state.mHighPassZ2 = highPassZ2;
+   return sum;
+}
+
+void LevelAnalyzer::EndLoudnessBlock()
+{
+   double blockMeanSquare = mLoudnessBlockEnergy / mLoudnessBlockSamples;
+   mBlockMeanSquares[mNumBlocks % kShortTermBlocks] = blockMeanSquare;
+   ++mNumBlocks;
+   mLoudnessBlockEnergy = 0;
+   mLoudnessBlockSamples = 0;
+
+   auto average = [this](int numBlocks)
+   {
+      numBlocks = MIN(numBlocks, mNumBlocks);
+      double sum = 0;
+      for (int i = 0; i < numBlocks; ++i)
+         sum += mBlockMeanSquares[(mNumBlocks - 1 - i) % kShortTermBlocks];
+      return sum / numBlocks;
+   };
+   double momentary = average(kMomentaryBlocks);
+   mMomentaryLoudness.store(DisplayLoudness(momentary), std::memory_order_relaxed);
+   mShortTermLoudness.store(DisplayLoudness(average(kShortTermBlocks)), std::memory_order_relaxed);
+
+   //every block ends another 400ms gating block, overlapping the last by 75%
+   if (mNumBlocks < kMomentaryBlocks)
+      return;
+
+   double loudness = Loudness(momentary);
+   if (loudness <= kSilentLoudness)
+      return;
+   int bin = MIN(kGatingBins - 1, (int)((loudness - kSilentLoudness) * 10));
+   ++mGatingCounts[bin];
+   mGatingEnergy[bin] += momentary;
+
+   //then the relative gate, 10 lu under what made it through the absolute one. to the nearest bin
+   double energy = 0;
+   int count = 0;
+   for (int i = 0; i < kGatingBins; ++i)
+   {
+      energy += mGatingEnergy[i];
+      count += mGatingCounts[i];
+   }
+   double relativeGate = Loudness(energy / count) - 10;
+   int firstBin = (int)ceil((relativeGate - kSilentLoudness) * 10);
+   firstBin = CLAMP(firstBin, 0, kGatingBins - 1);
+   energy = 0;
+   count = 0;
+   for (int i = firstBin; i < kGatingBins; ++i)
+   {
+      energy += mGatingEnergy[i];
+      count += mGatingCounts[i];
+   }
+   mIntegratedLoudness.store(count > 0 ? DisplayLoudness(energy / count) : kSilentLoudness, std::memory_order_relaxed);
+}
+
+void LevelAnalyzer::ResetLoudnessState()
+{
+   mLoudnessBlockSamples = 0;
+   mLoudnessBlockEnergy = 0;
+   mNumBlocks = 0;
+   mGatingCounts.fill(0);
+   mGatingEnergy.fill(0);
+   mMomentaryLoudness.store(kSilentLoudness, std::memory_order_relaxed);
+   mShortTermLoudness.store(kSilentLoudness, std::memory_order_relaxed);
+   mIntegratedLoudness.store(kSilentLoudness, std::memory_order_relaxed);
+   for (auto& channel : mChannels)
+   {
+      channel.mTruePeakState = 0;
+      channel.mTruePeak.store(0, std::memory_order_relaxed);
+   }
+}
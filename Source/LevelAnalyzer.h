@@ -0,0 +1,131 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    LevelAnalyzer.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChannelBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+//the levels behind the meters, for up to ChannelBuffer::kMaxNumChannels channels: a fast peak, a slow peak that holds near the top
+//of the meter, rms, and if asked for, the true (inter-sample) peak and ebu r128 loudness.
+//every channel of a block is read once on the audio thread, with simd for everything that doesn't depend on the previous sample.
+//the readings are relaxed atomics, so draw code can read them whenever it likes without locking anything
+class LevelAnalyzer
+{
+public:
+   //audio thread. loudness is summed over the channels, so channel 0 of a block has to come first
+   void Process(int channel, const float* buffer, int bufferSize, double time);
+
+   void SetSlowPeakLimit(float limit) { mSlowPeakLimit = limit; } //the slow peak is clamped here, and the clip time noted when it hits it
+   float GetSlowPeakLimit() const { return mSlowPeakLimit; }
+   void SetMeasureLoudness(bool measure) { mMeasureLoudness = measure; } //true peak and loudness. these cost a lot more than the rest
+   void ResetLoudness() { mWantResetLoudness = true; } //any thread. starts the integrated loudness and the true peak max over
+
+   //any thread
+   float GetPeak(int channel) const { return mChannels[channel].mPeak.load(std::memory_order_relaxed); }
+   float GetSlowPeak(int channel) const { return mChannels[channel].mSlowPeak.load(std::memory_order_relaxed); }
+   float GetRms(int channel) const { return mChannels[channel].mRms.load(std::memory_order_relaxed); }
+   float GetTruePeak(int channel) const { return mChannels[channel].mTruePeak.load(std::memory_order_relaxed); } //the highest since ResetLoudness()
+   double GetLastHitLimitTime(int channel) const { return mChannels[channel].mHitLimitTime.load(std::memory_order_relaxed); }
+   float GetMomentaryLoudness() const { return mMomentaryLoudness.load(std::memory_order_relaxed); } //lufs, over the last 400ms
+   float GetShortTermLoudness() const { return mShortTermLoudness.load(std::memory_order_relaxed); } //lufs, over the last 3s
+   float GetIntegratedLoudness() const { return mIntegratedLoudness.load(std::memory_order_relaxed); } //lufs, gated, since ResetLoudness()
+
+   static constexpr float kSilentLoudness = -70; //the absolute gate, and what the loudness readings say about silence
+   static constexpr int kTruePeakOversampling = 4;
+   static constexpr int kTruePeakTaps = 12; //per phase of the interpolator
+   static constexpr int kTruePeakDelay = 6; //samples, about half the taps. how late the interpolated points come out
+   //a blackman windowed sinc that interpolates kTruePeakOversampling points between each pair of samples, laid out with the phases
+   //of a tap next to each other so one simd lane works out each phase. tap 0 goes with the newest sample
+   static const float* GetTruePeakCoefficients();
+
+private:
+   struct Biquad
+   {
+      float mB0{ 1 };
+      float mB1{ 0 };
+      float mB2{ 0 };
+      float mA1{ 0 };
+      float mA2{ 0 };
+   };
+
+   struct Channel
+   {
+      float mPeakState{ 0 };
+      float mSlowPeakState{ 0 };
+      float mMeanSquare{ 0 };
+      float mTruePeakState{ 0 };
+      std::vector<float> mTruePeakInput; //the last kTruePeakTaps - 1 samples, then the block
+      float mShelfZ1{ 0 };
+      float mShelfZ2{ 0 };
+      float mHighPassZ1{ 0 };
+      float mHighPassZ2{ 0 };
+
+      std::atomic<float> mPeak{ 0 };
+      std::atomic<float> mSlowPeak{ 0 };
+      std::atomic<float> mRms{ 0 };
+      std::atomic<float> mTruePeak{ 0 };
+      std::atomic<double> mHitLimitTime{ -9999 };
+   };
+
+   void UpdateCoefficients();
+   void MeasureTruePeak(Channel& channel, const float* buffer, int bufferSize);
+   float KWeightedSumOfSquares(Channel& channel, const float* buffer, int bufferSize);
+   void EndLoudnessBlock();
+   void ResetLoudnessState();
+
+   std::array<Channel, ChannelBuffer::kMaxNumChannels> mChannels;
+   float mSlowPeakLimit{ -1 };
+   bool mMeasureLoudness{ false };
+   std::atomic<bool> mWantResetLoudness{ false };
+
+   //the peaks and rms move once per kSubBlock samples, from the loudest sample and the energy of each
+   static constexpr int kSubBlock = 16;
+   float mSampleRate{ 0 };
+   float mPeakDecay{ 0 };
+   float mSlowPeakDecay{ 0 };
+   float mRmsSmoothing{ 0 };
+   Biquad mShelf; //the two stages of the k-weighting filter
+   Biquad mHighPass;
+
+   //loudness is built from 100ms blocks of k-weighted energy, summed over the channels
+   static constexpr int kShortTermBlocks = 30;
+   static constexpr int kMomentaryBlocks = 4;
+   static constexpr int kGatingBins = 800; //0.1 lu each, from the absolute gate up
+   int mLoudnessBlockLength{ 0 };
+   int mLoudnessBlockSamples{ 0 };
+   double mLoudnessBlockEnergy{ 0 };
+   std::array<double, kShortTermBlocks> mBlockMeanSquares{};
+   int mNumBlocks{ 0 };
+   std::array<int, kGatingBins> mGatingCounts{};
+   std::array<double, kGatingBins> mGatingEnergy{};
+   std::atomic<float> mMomentaryLoudness{ kSilentLoudness };
+   std::atomic<float> mShortTermLoudness{ kSilentLoudness };
+   std::atomic<float> mIntegratedLoudness{ kSilentLoudness };
+};
@@ -28,11 +28,7 @@
 
 LevelMeterDisplay::LevelMeterDisplay()
 {
-   for (size_t i = 0; i < mLevelMeters.size(); ++i)
-   {
-      mLevelMeters[i].mPeakTrackerSlow.SetDecayTime(3);
-      mLevelMeters[i].mPeakTrackerSlow.SetLimit(1);
-   }
+   mAnalyzer.SetSlowPeakLimit(1);
 }
 
 LevelMeterDisplay::~LevelMeterDisplay()
@@ -41,16 +37,15 @@ LevelMeterDisplay::~LevelMeterDisplay()
 
 void LevelMeterDisplay::Process(int channel, float* buffer, int bufferSize)
 {
-   mLevelMeters[channel].mPeakTracker.Process(buffer, bufferSize);
-   mLevelMeters[channel].mPeakTrackerSlow.Process(buffer, bufferSize);
+   mAnalyzer.Process(channel, buffer, bufferSize, gTime);
 }
 
 void LevelMeterDisplay::GetLevel(int channel, float& level, float& watermarkLevel) const
 {
-   if (channel >= 0 && channel < (int)mLevelMeters.size())
+   if (channel >= 0 && channel < ChannelBuffer::kMaxNumChannels)
    {
-      level = mLevelMeters[channel].mPeakTracker.GetPeak();
-      watermarkLevel = mLevelMeters[channel].mPeakTrackerSlow.GetPeak();
+      level = mAnalyzer.GetPeak(channel);
+      watermarkLevel = mAnalyzer.GetSlowPeak(channel);
    }
    else
    {
@@ -63,7 +58,7 @@ void LevelMeterDisplay::Draw(float x, float y, float width, float height, int nu
 {
    for (int i = 0; i < numChannels; ++i)
    {
-      float limit = mLevelMeters[i].mPeakTrackerSlow.GetLimit();
+      float limit = mAnalyzer.GetSlowPeakLimit();
 
       const int kNumSegments = 20;
       const int kPaddingBetween = 1;
@@ -94,7 +89,7 @@ void LevelMeterDisplay::Draw(float x, float y, float width, float height, int nu
          ofPopStyle();
       }
 
-      if (mLevelMeters[i].mPeakTrackerSlow.GetLastHitLimitTime() > gTime - 1000)
+      if (mAnalyzer.GetLastHitLimitTime(i) > gTime - 1000)
       {
          ofPushStyle();
          ofSetColor(ofColor::red);
@@ -106,6 +101,5 @@ void LevelMeterDisplay::Draw(float x, float y, float width, float height, int nu
 
 void LevelMeterDisplay::SetLimit(float limit)
 {
-   for (size_t i = 0; i < mLevelMeters.size(); ++i)
-      mLevelMeters[i].mPeakTrackerSlow.SetLimit(limit);
+   mAnalyzer.SetSlowPeakLimit(limit);
 }
@@ -25,8 +25,7 @@
 
 #pragma once
 
-#include "ChannelBuffer.h"
-#include "PeakTracker.h"
+#include "LevelAnalyzer.h"
 
 class LevelMeterDisplay
 {
@@ -38,13 +37,8 @@ public:
    void Draw(float x, float y, float width, float height, int numChannels);
    void SetLimit(float limit);
    void GetLevel(int channel, float& levelFast, float& levelSlow) const;
+   LevelAnalyzer& GetAnalyzer() { return mAnalyzer; }
 
 private:
-   struct LevelMeter
-   {
-      PeakTracker mPeakTracker;
-      PeakTracker mPeakTrackerSlow;
-   };
-
-   std::array<LevelMeter, ChannelBuffer::kMaxNumChannels> mLevelMeters;
+   LevelAnalyzer mAnalyzer; //the fast level is its peak, the watermark its slow peak
 };
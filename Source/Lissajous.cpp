@@ -73,11 +73,32 @@ void Lissajous::Process(double time)
 
       mOffset += bufferSize;
       mOffset %= NUM_LISSAJOUS_POINTS;
+
+      FillTap();
    }
 
    GetBuffer()->Reset();
 }
 
+void Lissajous::FillTap()
+{
+   VisualizationTap::Frame* frame = mTap.BeginFrame();
+   if (frame == nullptr)
+      return;
+
+   const int autocorrelationDelay = 90;
+   float minDistance = 1.0f / mTap.GetResolution();
+   for (int i = mOffset; i < NUM_LISSAJOUS_POINTS + mOffset - autocorrelationDelay; ++i)
+   {
+      ofVec2f point = mLissajousPoints[i % NUM_LISSAJOUS_POINTS];
+      if (mAutocorrelationMode || mOnlyHasOneChannel)
+         point.y = mLissajousPoints[(i + autocorrelationDelay) % NUM_LISSAJOUS_POINTS].x;
+      frame->AddPoint(point, minDistance);
+   }
+
+   mTap.PublishFrame();
+}
+
 void Lissajous::DrawModule()
 {
    if (Minimized() || IsVisible() == false)
@@ -96,20 +117,16 @@ void Lissajous::DrawModule()
    float w, h;
    GetDimensions(w, h);
 
-   ofBeginShape();
+   mTap.SetResolution(MAX(w, h) * mScale * gDrawScale);
+   const VisualizationTap::Frame& frame = mTap.GetLatestFrame();
 
-   const int autocorrelationDelay = 90;
+   ofBeginShape();
 
    ofSetColor(0, 255, 0, 30);
-   for (int i = mOffset; i < NUM_LISSAJOUS_POINTS + mOffset - autocorrelationDelay; ++i)
+   for (int i = 0; i < frame.mNumPoints; ++i)
    {
-      float x = w / 2 + mLissajousPoints[i % NUM_LISSAJOUS_POINTS].x * w * mScale;
-      float y;
-      if (mAutocorrelationMode || mOnlyHasOneChannel)
-         y = h / 2 + mLissajousPoints[(i + autocorrelationDelay) % NUM_LISSAJOUS_POINTS].x * h * mScale;
-      else
-         y = h / 2 + mLissajousPoints[i % NUM_LISSAJOUS_POINTS].y * h * mScale;
-      //float alpha = (i-mOffset)/float(NUM_LISSAJOUS_POINTS-autocorrelationDelay);
+      float x = w / 2 + frame.mPoints[i].x * w * mScale;
+      float y = h / 2 + frame.mPoints[i].y * h * mScale;
       ofVertex(x, y);
    }
 
@@ -28,6 +28,7 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Slider.h"
+#include "VisualizationTap.h"
 
 #define NUM_LISSAJOUS_POINTS 3000
 
@@ -48,6 +49,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //displays its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
@@ -65,8 +67,11 @@ private:
    float mScale{ 1 };
    FloatSlider* mScaleSlider{ nullptr };
 
-   ofVec2f mLissajousPoints[NUM_LISSAJOUS_POINTS];
+   void FillTap();
+
+   ofVec2f mLissajousPoints[NUM_LISSAJOUS_POINTS]; //audio thread only
    int mOffset{ 0 };
+   VisualizationTap mTap;
    bool mAutocorrelationMode{ true };
    bool mOnlyHasOneChannel{ true };
 };
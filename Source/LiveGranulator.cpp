@@ -71,6 +71,8 @@ void LiveGranulator::CreateUIControls()
    FLOATSLIDER(mWidthSlider, "width", &mGranulator.mWidth, 0, 1);
    ENDUIBLOCK(mWidth, mHeight);
 
+   mGranOverlap->SetMode(FloatSlider::kLogarithmic);
+
    mBufferX = mWidth + 3;
    mWidth += kBufferWidth + 3 * 2;
 
@@ -112,11 +114,12 @@ void LiveGranulator::ProcessAudio(double time, ChannelBuffer* buffer)
    float bufferSize = buffer->BufferSize();
    mBuffer.SetNumChannels(buffer->NumActiveChannels());
 
+   ComputeSliders(0);
+   mGranulator.SetLiveMode(!mFreeze);
+
+   double grainOffset = 0; //where grains spawn from, at the first sample
    for (int i = 0; i < bufferSize; ++i)
    {
-      ComputeSliders(i);
-
-      mGranulator.SetLiveMode(!mFreeze);
       if (!mFreeze)
       {
          for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
@@ -129,18 +132,31 @@ void LiveGranulator::ProcessAudio(double time, ChannelBuffer* buffer)
             mBuffer.Write(buffer->GetChannel(ch)[i], ch);
       }
 
-      if (mEnabled)
+      if (i == 0)
+         grainOffset = mBuffer.GetRawBufferOffset(0) - mFreezeExtraSamples - 1 - gBufferSize + mPos;
+   }
+
+   if (mEnabled)
+   {
+      //the write head moves along with the grains unless we're frozen (the extra frozen samples move both together)
+      double grainOffsetIncrement = mFreeze ? 0 : 1;
+
+      mGrainOutput.SetNumActiveChannels(buffer->NumActiveChannels());
+      mGrainOutput.Clear();
+      float* grainOutput[ChannelBuffer::kMaxNumChannels]{};
+      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+         grainOutput[ch] = mGrainOutput.GetChannel(ch);
+      mGranulator.Process(time, mBuffer.GetRawBuffer(), mBufferLength, grainOffset, grainOffsetIncrement, 1.0f, grainOutput, bufferSize);
+
+      float grainProportion = std::clamp((mGranulator.mGrainOverlap - 1) / (Granulator::kReferenceOverlap - 1), 0.0f, 1.0f);
+      float gainScale = ofLerp(.333f, 1.0f, (1 - grainProportion) * (1 - grainProportion) * (1 - grainProportion));
+      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
       {
-         float sample[ChannelBuffer::kMaxNumChannels];
-         Clear(sample, ChannelBuffer::kMaxNumChannels);
-         mGranulator.ProcessFrame(time, mBuffer.GetRawBuffer(), mBufferLength, mBuffer.GetRawBufferOffset(0) - mFreezeExtraSamples - 1 - gBufferSize + mPos, 1.0f, sample);
-         float grainProportion = std::clamp((mGranulator.mGrainOverlap - 1) / (MAX_GRAINS - 1), 0.0f, 1.0f);
-         float gainScale = ofLerp(.333f, 1.0f, (1 - grainProportion) * (1 - grainProportion) * (1 - grainProportion));
-         for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-            buffer->GetChannel(ch)[i] = mDry * buffer->GetChannel(ch)[i] + sample[ch] * gainScale;
+         float* channel = buffer->GetChannel(ch);
+         Mult(channel, mDry, bufferSize);
+         Mult(grainOutput[ch], gainScale, bufferSize);
+         Add(channel, grainOutput[ch], bufferSize);
       }
-
-      time += gInvSampleRateMs;
    }
 }
 
@@ -61,6 +61,8 @@ public:
    void DropdownUpdated(DropdownList* list, int oldVal, double time) override;
 
    bool IsEnabled() const override { return mEnabled; }
+   bool ProcessesWhileDisabled() const override { return true; } //keeps recording, so there's something to granulate when it's turned on
+   size_t GetMemoryUsage() const override { return mBuffer.GetMemoryUsage() + mGrainOutput.GetMemoryUsage(); }
 
 private:
    void Freeze();
@@ -71,6 +73,7 @@ private:
    float mBufferLength;
    RollingBuffer mBuffer;
    Granulator mGranulator;
+   ChannelBuffer mGrainOutput{ gBufferSize };
    FloatSlider* mGranOverlap{ nullptr };
    FloatSlider* mGranSpeed{ nullptr };
    FloatSlider* mGranLengthMs{ nullptr };
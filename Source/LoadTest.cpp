@@ -0,0 +1,165 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    LoadTest.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "LoadTest.h"
+#include "ModularSynth.h"
+#include "Prefab.h"
+#include "SampleLoader.h"
+#include "SynthGlobals.h"
+#include "ofxJSONElement.h"
+
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+
+LoadTest::LoadTest(std::string patchPath, double durationSeconds, std::string prefabName, int maxInstances)
+: mPatchPath(std::move(patchPath))
+, mDurationSeconds(durationSeconds)
+, mPrefabName(std::move(prefabName))
+, mMaxInstances(maxInstances)
+{
+}
+
+double LoadTest::GetBudgetMs() const
+{
+   return gBufferSize * gInvSampleRateMs;
+}
+
+Prefab* LoadTest::FindPrefab() const
+{
+   if (!mPrefabName.empty())
+      return dynamic_cast<Prefab*>(TheSynth->FindModule(mPrefabName));
+
+   for (auto* module : TheSynth->GetRootContainer()->GetModules())
+   {
+      if (auto* prefab = dynamic_cast<Prefab*>(module))
+         return prefab;
+   }
+   return nullptr;
+}
+
+bool LoadTest::Run()
+{
+   juce::File patchFile(ofToDataPath(mPatchPath));
+   if (!patchFile.existsAsFile())
+   {
+      fprintf(stderr, "couldn't find %s\n", patchFile.getFullPathName().toRawUTF8());
+      return false;
+   }
+
+   TheSynth->LoadState(patchFile.getFullPathName().toStdString());
+
+   //samples decode in the background. wait for them, so the first measurement isn't of silence
+   while (SampleLoader::Get().IsBusy())
+      juce::Thread::sleep(10);
+
+   Prefab* prefab = nullptr;
+   if (mMaxInstances > 1 || !mPrefabName.empty())
+   {
+      prefab = FindPrefab();
+      if (prefab == nullptr)
+      {
+         fprintf(stderr, "couldn't find %s in %s to duplicate\n", mPrefabName.empty() ? "a prefab" : mPrefabName.c_str(), mPatchPath.c_str());
+         return false;
+      }
+   }
+
+   for (int instances = 1; instances <= mMaxInstances; ++instances)
+   {
+      //the same duplication as alt-dragging the prefab, cables out of it included
+      if (instances > 1)
+         TheSynth->DuplicateModule(prefab);
+      mSteps.push_back(Measure(instances));
+   }
+
+   return true;
+}
+
+LoadTest::Step LoadTest::Measure(int instances)
+{
+   int numChannels = TheSynth->GetNumOutputChannels();
+   std::vector<std::vector<float>> output(numChannels, std::vector<float>(gBufferSize));
+   std::vector<float*> outputPointers;
+   for (auto& channel : output)
+      outputPointers.push_back(channel.data());
+
+   //a second of audio first, to get past envelopes starting and caches filling
+   int numWarmupCallbacks = (int)ceil(gSampleRate / gBufferSize);
+   for (int i = 0; i < numWarmupCallbacks; ++i)
+      TheSynth->AudioOut(outputPointers.data(), gBufferSize, numChannels);
+
+   int numCallbacks = MAX(1, (int)ceil(mDurationSeconds * gSampleRate / gBufferSize));
+   std::vector<double> callbackMs(numCallbacks);
+   for (int i = 0; i < numCallbacks; ++i)
+   {
+      long start = ofGetSystemTimeNanos();
+      TheSynth->AudioOut(outputPointers.data(), gBufferSize, numChannels);
+      callbackMs[i] = (ofGetSystemTimeNanos() - start) / 1000000.0;
+   }
+
+   Step step;
+   step.mInstances = instances;
+   step.mCallbacks = numCallbacks;
+   double total = 0;
+   for (double ms : callbackMs)
+   {
+      total += ms;
+      if (ms > GetBudgetMs())
+         ++step.mOverruns;
+   }
+   step.mMeanMs = total / numCallbacks;
+   std::sort(callbackMs.begin(), callbackMs.end());
+   step.mP99Ms = callbackMs[MIN(numCallbacks - 1, (int)(numCallbacks * .99))];
+   step.mMaxMs = callbackMs.back();
+
+   //progress goes to stderr, so stdout only has the json
+   fprintf(stderr, "%3d instance%s  mean %7.3f ms  p99 %7.3f ms  max %7.3f ms  (%.1f%% of %.3f ms)  %d overruns\n", instances, instances == 1 ? " " : "s", step.mMeanMs, step.mP99Ms, step.mMaxMs, step.mMeanMs / GetBudgetMs() * 100, GetBudgetMs(), step.mOverruns);
+   return step;
+}
+
+void LoadTest::WriteResults(ofxJSONElement& root) const
+{
+   root["patch"] = mPatchPath;
+   root["bufferSize"] = gBufferSize;
+   root["durationSeconds"] = mDurationSeconds;
+   root["budgetMs"] = GetBudgetMs();
+
+   //the first instance count where the worst callbacks don't fit in the buffer any more
+   root["scalingBreaksAt"] = Json::Value(Json::nullValue);
+   root["steps"].resize(0);
+   for (int i = 0; i < (int)mSteps.size(); ++i)
+   {
+      const Step& step = mSteps[i];
+      root["steps"][i]["instances"] = step.mInstances;
+      root["steps"][i]["callbacks"] = step.mCallbacks;
+      root["steps"][i]["meanMs"] = step.mMeanMs;
+      root["steps"][i]["p99Ms"] = step.mP99Ms;
+      root["steps"][i]["maxMs"] = step.mMaxMs;
+      root["steps"][i]["overruns"] = step.mOverruns;
+      if (root["scalingBreaksAt"].isNull() && step.mP99Ms > GetBudgetMs())
+         root["scalingBreaksAt"] = step.mInstances;
+   }
+}
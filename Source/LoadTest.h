@@ -0,0 +1,65 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    LoadTest.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class ofxJSONElement;
+class Prefab;
+
+//loads a save state and runs ModularSynth::AudioOut() back to back as fast as it can, timing every callback, for bespoke-bench.
+//with a prefab and an instance count, it measures again after each copy of the prefab is added, to find how many fit
+class LoadTest
+{
+public:
+   struct Step
+   {
+      int mInstances{ 1 };
+      int mCallbacks{ 0 };
+      double mMeanMs{ 0 };
+      double mP99Ms{ 0 };
+      double mMaxMs{ 0 };
+      int mOverruns{ 0 }; //callbacks that took longer than the buffer they produced
+   };
+
+   LoadTest(std::string patchPath, double durationSeconds, std::string prefabName, int maxInstances);
+
+   bool Run(); //false if the patch or the prefab couldn't be found
+   void WriteResults(ofxJSONElement& root) const;
+
+private:
+   Prefab* FindPrefab() const;
+   Step Measure(int instances);
+   double GetBudgetMs() const;
+
+   std::string mPatchPath;
+   double mDurationSeconds{ 10 };
+   std::string mPrefabName;
+   int mMaxInstances{ 1 };
+   std::vector<Step> mSteps;
+};
@@ -0,0 +1,71 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Log2Histogram.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "Log2Histogram.h"
+
+#include <cmath>
+
+void Log2Histogram::Add(uint64_t ns)
+{
+   uint64_t us = ns / 1000;
+   int bucket = 0;
+   while (bucket < kNumBuckets - 1 && us >= (1ull << bucket))
+      ++bucket;
+   mCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+
+   uint64_t max = mMaxNs.load(std::memory_order_relaxed);
+   while (ns > max && !mMaxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+   {
+   }
+}
+
+uint32_t Log2Histogram::GetCount() const
+{
+   uint32_t count = 0;
+   for (const auto& bucket : mCounts)
+      count += bucket.load(std::memory_order_relaxed);
+   return count;
+}
+
+uint64_t Log2Histogram::GetPercentileUs(float percentile) const
+{
+   uint32_t target = uint32_t(ceil(GetCount() * percentile));
+   uint32_t seen = 0;
+   for (int i = 0; i < kNumBuckets; ++i)
+   {
+      seen += mCounts[i].load(std::memory_order_relaxed);
+      if (seen >= target && seen > 0)
+         return (i == kNumBuckets - 1) ? mMaxNs.load(std::memory_order_relaxed) / 1000 : (1ull << i);
+   }
+   return 0;
+}
+
+void Log2Histogram::Clear()
+{
+   for (auto& bucket : mCounts)
+      bucket.store(0, std::memory_order_relaxed);
+   mMaxNs.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,46 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Log2Histogram.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+//counts durations into power of two microsecond buckets. every counter is atomic, so the audio thread can
+//record into it while the ui thread reads it, without a lock
+struct Log2Histogram
+{
+   static const int kNumBuckets = 16; //bucket i counts times under 2^i microseconds, the last one also everything longer
+
+   void Add(uint64_t ns);
+   uint32_t GetCount() const;
+   uint64_t GetPercentileUs(float percentile) const; //the upper edge of the bucket the percentile lands in
+   void Clear();
+
+   std::array<std::atomic<uint32_t>, kNumBuckets> mCounts{};
+   std::atomic<uint64_t> mMaxNs{ 0 };
+};
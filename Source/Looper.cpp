@@ -34,6 +34,9 @@
 #include "Profiler.h"
 #include "Rewriter.h"
 #include "LooperGranulator.h"
+#include "ModuleHibernation.h"
+
+#include <limits>
 
 float Looper::mBeatwheelPosRight = 0;
 float Looper::mBeatwheelDepthRight = 0;
@@ -44,24 +47,31 @@ bool Looper::mBeatwheelSingleMeasure = 0;
 namespace
 {
    const int kMaxNumBars = 16;
+   const int kLoopChunkSize = 1 << 16; //loop storage grows and shrinks in steps of this many samples
+   const int kCommitSamplesPerBuffer = 8192; //how much of a commit to write per buffer, so a long take lands within a few buffers without spiking one
+
+   //rounded up to whole chunks, so that nudging the tempo doesn't reallocate the loop every time
+   int GetCapacityForLength(int length)
+   {
+      return MAX(1, (length + kLoopChunkSize - 1) / kLoopChunkSize) * kLoopChunkSize;
+   }
 }
 
 Looper::Looper()
 : IAudioProcessor(gBufferSize)
 , mWorkBuffer(gBufferSize)
 {
-   //TODO(Ryan) buffer sizes
-   mBuffer = new ChannelBuffer(MAX_BUFFER_SIZE);
-   mUndoBuffer = new ChannelBuffer(MAX_BUFFER_SIZE);
+   //channels are only allocated once they're written to, and SetLoopLength() below sizes them to the loop
+   mBuffer = new ChannelBuffer(kLoopChunkSize);
+   mUndoBuffer = new ChannelBuffer(kLoopChunkSize);
+   mBuffer->EnablePeaks();
+   mUndoBuffer->EnablePeaks();
    Clear();
 
    mMuteRamp.SetValue(1);
 
    for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
-   {
-      mPitchShifter[i] = new PitchShifter(1024);
       mLastInputSample[i] = 0;
-   }
 
    SetLoopLength(4 * 60.0f / TheTransport->GetTempo() * gSampleRate);
 }
@@ -101,6 +111,8 @@ void Looper::CreateUIControls()
    mBeatwheelDepthLeftSlider = new FloatSlider(this, "beatwheel depth left", HIDDEN_UICONTROL, HIDDEN_UICONTROL, 1, 1, &mBeatwheelDepthLeft, 0, 1);
    mBeatwheelSingleMeasureCheckbox = new Checkbox(this, "beatwheel single measure", HIDDEN_UICONTROL, HIDDEN_UICONTROL, &mBeatwheelSingleMeasure);
    mKeepPitchCheckbox = new Checkbox(this, "auto", -1, -1, &mKeepPitch);
+   mResampleQualitySelector = new DropdownList(this, "quality", -1, -1, (int*)(&mResampleQuality));
+   mStretchModeSelector = new DropdownList(this, "stretch", -1, -1, (int*)(&mStretchMode));
    mResampleButton = new ClickButton(this, "resample for tempo", 15, 40);
 
    mNumBarsSelector->AddLabel(" 1 ", 1);
@@ -119,6 +131,15 @@ void Looper::CreateUIControls()
    mFourTetSlicesDropdown->AddLabel(" 8", 8);
    mFourTetSlicesDropdown->AddLabel("16", 16);
 
+   mResampleQualitySelector->AddLabel("linear", (int)ResampleQuality::Linear);
+   mResampleQualitySelector->AddLabel("cubic", (int)ResampleQuality::Cubic);
+   mResampleQualitySelector->AddLabel("sinc", (int)ResampleQuality::Sinc);
+
+   mStretchModeSelector->AddLabel("pitchshift", (int)StretchMode::Off);
+   mStretchModeSelector->AddLabel("beats", (int)StretchMode::Beats);
+   mStretchModeSelector->AddLabel("tonal", (int)StretchMode::Tonal);
+   mStretchModeSelector->DrawLabel(true);
+
    mBeatwheelPosLeftSlider->SetClamped(false);
    mBeatwheelPosRightSlider->SetClamped(false);
 
@@ -139,14 +160,14 @@ void Looper::CreateUIControls()
    mScratchSpeedSlider->PositionTo(mLoopPosOffsetSlider, kAnchor_Below);
    mAllowScratchCheckbox->PositionTo(mScratchSpeedSlider, kAnchor_Right);
    mPassthroughCheckbox->PositionTo(mScratchSpeedSlider, kAnchor_Below);
+   mResampleQualitySelector->PositionTo(mPassthroughCheckbox, kAnchor_Right);
+   mStretchModeSelector->PositionTo(mPassthroughCheckbox, kAnchor_Below);
 }
 
 Looper::~Looper()
 {
    delete mBuffer;
    delete mUndoBuffer;
-   for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
-      delete mPitchShifter[i];
 }
 
 void Looper::Exit()
@@ -204,7 +225,12 @@ void Looper::Process(double time)
    if (target == nullptr)
       return;
 
-   if (!mEnabled)
+   //the main thread resizes the loop's storage under this
+   std::unique_lock<ofMutex> lock(mBufferMutex, std::defer_lock);
+   if (mEnabled)
+      lock.lock();
+
+   if (!mEnabled || IsHibernating()) //hibernating: just enabled, and the main thread hasn't brought the loop back yet
    {
       SyncBuffers();
 
@@ -286,31 +312,68 @@ void Looper::Process(double time)
       mQueuedNewBuffer = nullptr;
    }
 
+   //"auto" either stretches the loop to the tempo, or plays it resampled and shifts the pitch back afterwards
+   bool stretch = mKeepPitch && mStretcher != nullptr && !doGranular;
    if (mKeepPitch)
-      mPitchShift = 1 / speed;
+      mPitchShift = stretch ? 1 : 1 / speed;
    int latencyOffset = 0;
    if (mPitchShift != 1)
-      latencyOffset = mPitchShifter[0]->GetLatency();
+      latencyOffset = mPitchShifter.GetLatency(); //read ahead, so the shifted output stays lined up with the loop
 
+   //work out where the playhead reads from first, so the whole block can be resampled at once
+   if ((int)mReadPositions.size() < bufferSize)
+      mReadPositions.resize(bufferSize);
    double processStartTime = time;
+   int fourTetSwitchIndex = -1;
    for (int i = 0; i < bufferSize; ++i)
    {
-      float smooth = .001f;
-      mSmoothedVol = mSmoothedVol * (1 - smooth) + mVol * smooth;
-      float volSq = mSmoothedVol * mSmoothedVol;
-
       mLoopPosOffsetSlider->Compute(i);
 
       if (mAllowScratch)
          ProcessScratch();
 
-      if (mFourTet > 0)
-         ProcessFourTet(processStartTime, i);
+      if (mFourTet > 0 && ProcessFourTet(processStartTime, i))
+         fourTetSwitchIndex = i;
 
       if (mBeatwheel)
          ProcessBeatwheel(processStartTime, i);
 
       float offset = mLoopPos + i * speed + mLoopPosOffset + latencyOffset;
+      mReadPositions[i] = offset;
+   }
+
+   if (stretch)
+   {
+      //the stretcher follows the playhead from where the block starts, a scratch or a jump within the block lands on the next one
+      TimeStretcher::Source source;
+      float* channels[ChannelBuffer::kMaxNumChannels];
+      for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
+      {
+         source.mChannels[ch] = mBuffer->GetChannel(ch);
+         channels[ch] = mWorkBuffer.GetChannel(ch);
+      }
+      source.mLength = mLoopLength;
+      source.mLooping = true;
+      mStretcher->Process(source, mReadPositions[0], speed, 1, channels, mBuffer->NumActiveChannels(), bufferSize);
+   }
+   else if (!doGranular)
+   {
+      for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
+         Resample(mBuffer->GetChannel(ch), mLoopLength, mReadPositions.data(), mWorkBuffer.GetChannel(ch), bufferSize, mResampleQuality, speed);
+   }
+
+   float writtenFrom = std::numeric_limits<float>::max();
+   float writtenTo = std::numeric_limits<float>::lowest();
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      float smooth = .001f;
+      mSmoothedVol = mSmoothedVol * (1 - smooth) + mVol * smooth;
+      float volSq = mSmoothedVol * mSmoothedVol;
+
+      if (i == fourTetSwitchIndex)
+         mSwitchAndRamp.StartSwitch(); //smooth discontinuity
+
+      float offset = mReadPositions[i];
       float output[ChannelBuffer::kMaxNumChannels];
       ::Clear(output, ChannelBuffer::kMaxNumChannels);
 
@@ -320,16 +383,13 @@ void Looper::Process(double time)
       for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
       {
          if (!doGranular)
-         {
-            output[ch] = GetInterpolatedSample(offset, mBuffer->GetChannel(ch), mLoopLength);
-            output[ch] = mJumpBlender[ch].Process(output[ch], i);
-         }
+            output[ch] = mJumpBlender[ch].Process(mWorkBuffer.GetChannel(ch)[i], i);
 
          if (mFourTet > 0 && mFourTet < 1) //fourtet wet/dry
          {
             output[ch] *= mFourTet;
             float normalOffset = mLoopPos + i * speed;
-            output[ch] += GetInterpolatedSample(normalOffset, mBuffer->GetChannel(ch), mLoopLength) * (1 - mFourTet);
+            output[ch] += GetResampledSample(normalOffset, mBuffer->GetChannel(ch), mLoopLength, mResampleQuality, speed) * (1 - mFourTet);
          }
 
          float writeAmount = mWriteInputRamp.Value(time);
@@ -338,6 +398,8 @@ void Looper::Process(double time)
             //write at least one sample the past so we don't end up feeding into the next output
             int writeOffsetSamples = MAX(int(mWriteMsOffset * gSampleRateMs), 1);
             WriteInterpolatedSample(offset - writeOffsetSamples, mBuffer->GetChannel(ch), mLoopLength, mLastInputSample[ch] * writeAmount);
+            writtenFrom = std::min(writtenFrom, offset - writeOffsetSamples);
+            writtenTo = std::max(writtenTo, offset - writeOffsetSamples);
          }
          mLastInputSample[ch] = GetBuffer()->GetChannel(ch)[i];
 
@@ -354,13 +416,16 @@ void Looper::Process(double time)
       time += gInvSampleRateMs;
    }
 
+   if (writtenFrom <= writtenTo)
+      MarkBufferWritten(writtenFrom, writtenTo);
+
    if (mPitchShift != 1)
    {
+      float* channels[ChannelBuffer::kMaxNumChannels];
       for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
-      {
-         mPitchShifter[ch]->SetRatio(mPitchShift);
-         mPitchShifter[ch]->Process(mWorkBuffer.GetChannel(ch), bufferSize);
-      }
+         channels[ch] = mWorkBuffer.GetChannel(ch);
+      mPitchShifter.SetRatio(mPitchShift);
+      mPitchShifter.Process(channels, mBuffer->NumActiveChannels(), bufferSize);
    }
 
    for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
@@ -391,7 +456,7 @@ void Looper::Process(double time)
    }
 
    if (mCommitSamplesProgress >= 0)
-      ProcessCommit(std::max(1000, gBufferSize));
+      ProcessCommit(std::max(kCommitSamplesPerBuffer, gBufferSize));
 }
 
 void Looper::DoCommit(double time)
@@ -425,31 +490,61 @@ void Looper::ProcessCommit(int numSamplesToProcess)
       done = true;
    }
 
+   //the undo buffer was sized and allocated on the main thread, see ReserveForCommit(). if the loop has grown since, only what fits is kept
    int undoSamplesToCopy = numSamplesToProcess;
-   if (mCommitSamplesProgress + undoSamplesToCopy > mLoopLength)
-      undoSamplesToCopy = mLoopLength - mCommitSamplesProgress;
+   if (mCommitSamplesProgress + undoSamplesToCopy > MIN(mLoopLength, mUndoBuffer->BufferSize()))
+      undoSamplesToCopy = MIN(mLoopLength, mUndoBuffer->BufferSize()) - mCommitSamplesProgress;
    if (undoSamplesToCopy > 0)
-      mUndoBuffer->CopyFrom(mBuffer, numSamplesToProcess, mCommitSamplesProgress);
+   {
+      for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
+         BufferCopy(mUndoBuffer->GetChannel(ch) + mCommitSamplesProgress, mBuffer->GetChannel(ch) + mCommitSamplesProgress, undoSamplesToCopy);
+   }
 
-   for (int i = 0; i < numSamplesToProcess; ++i)
+   //write the take in runs that don't wrap around either buffer or cross a fade boundary, so that the body of the take is a straight copy (or add)
+   //rather than a modulo and a channel lookup per sample
+   ChannelBuffer* source = mCommitBuffer->GetRawBuffer();
+   int sourceSize = mCommitBuffer->Size();
+   bool replace = mMute || mReplaceOnCommit;
+   int end = mCommitSamplesProgress + numSamplesToProcess;
+   while (mCommitSamplesProgress < end)
    {
-      float fade = 1;
-      if (mCommitSamplesProgress < LOOPER_COMMIT_FADE_SAMPLES)
-         fade = float(mCommitSamplesProgress) / LOOPER_COMMIT_FADE_SAMPLES;
-      if (mCommitSamplesProgress >= mLoopLength)
-         fade = 1 - (float(mCommitSamplesProgress - mLoopLength) / LOOPER_COMMIT_FADE_SAMPLES);
+      int progress = mCommitSamplesProgress;
+      int sourceIndex = (mCommitBufferStartSample + progress) % sourceSize;
+      int targetIndex = ((progress + mCommitTargetBufferOffset) % mLoopLength + mLoopLength) % mLoopLength;
+      bool fading = progress < LOOPER_COMMIT_FADE_SAMPLES || progress >= mLoopLength;
+      int runEnd = progress < LOOPER_COMMIT_FADE_SAMPLES ? LOOPER_COMMIT_FADE_SAMPLES : (progress < mLoopLength ? mLoopLength : mCommitLength);
+      int run = MIN(MIN(end, runEnd) - progress, MIN(sourceSize - sourceIndex, mLoopLength - targetIndex));
+
       for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
       {
-         float writeSample = mCommitBuffer->GetRawBuffer()->GetChannel(ch)[(mCommitBufferStartSample + mCommitSamplesProgress) % mCommitBuffer->Size()] * fade;
-         int writeToIndex = (mCommitSamplesProgress + mCommitTargetBufferOffset) % mLoopLength;
-         if (mMute || mReplaceOnCommit)
-            mBuffer->GetChannel(ch)[writeToIndex] = writeSample;
-         else
-            mBuffer->GetChannel(ch)[writeToIndex] += writeSample;
+         const float* in = source->GetChannelReadOnly(ch) + sourceIndex;
+         float* out = mBuffer->GetChannel(ch) + targetIndex;
+         if (!fading)
+         {
+            if (replace)
+               BufferCopy(out, in, run);
+            else
+               Add(out, in, run);
+            continue;
+         }
+
+         for (int i = 0; i < run; ++i)
+         {
+            float fade = 1;
+            if (progress + i < LOOPER_COMMIT_FADE_SAMPLES)
+               fade = float(progress + i) / LOOPER_COMMIT_FADE_SAMPLES;
+            if (progress + i >= mLoopLength)
+               fade = 1 - (float(progress + i - mLoopLength) / LOOPER_COMMIT_FADE_SAMPLES);
+            if (replace)
+               out[i] = in[i] * fade;
+            else
+               out[i] += in[i] * fade;
+         }
       }
 
-      ++mCommitSamplesProgress;
+      mCommitSamplesProgress += run;
    }
+   mBuffer->MarkPeaksDirty(0, mLoopLength);
 
    if (done)
    {
@@ -458,17 +553,94 @@ void Looper::ProcessCommit(int numSamplesToProcess)
    }
 }
 
+//WriteInterpolatedSample() wraps around the loop, so anything that isn't a plain span within it dirties the whole loop
+void Looper::MarkBufferWritten(float fromOffset, float toOffset)
+{
+   int start = (int)floorf(fromOffset);
+   int end = (int)floorf(toOffset) + 2; //interpolated writes touch the next sample too
+   if (start < 0 || end > mLoopLength)
+      mBuffer->MarkPeaksDirty(0, mLoopLength);
+   else
+      mBuffer->MarkPeaksDirty(start, end - start);
+}
+
 void Looper::Fill(ChannelBuffer* buffer, int length)
 {
-   mBuffer->CopyFrom(buffer, length);
+   ChannelBuffer built = BuildBuffer(buffer, length, MAX(GetCapacityForLength(length), mBuffer->BufferSize()), 0);
+   ChangeOver(mBuffer, built, mLoopLength);
 }
 
 void Looper::DoUndo()
 {
-   ChannelBuffer* swap = mUndoBuffer;
-   mUndoBuffer = mBuffer;
-   mBuffer = swap;
    mWantUndo = false;
+   if (mUndoBuffer->BufferSize() < mLoopLength)
+      return; //the loop grew after the undo was asked for, and there's no room for it here without allocating
+   std::swap(mBuffer, mUndoBuffer);
+}
+
+//main thread. the undo buffer only takes memory once there's something to undo, and then at least as much as the loop it's a snapshot of,
+//with its channels allocated so that the audio thread can copy into it straight away
+void Looper::PrepareUndo(int numChannels)
+{
+   int capacity = MAX(mBuffer->BufferSize(), mUndoBuffer->BufferSize());
+   if (mUndoBuffer->BufferSize() >= capacity && mUndoBuffer->GetMemoryUsage() >= size_t(numChannels) * capacity * sizeof(float))
+      return;
+   ChannelBuffer built = BuildBuffer(mUndoBuffer, mUndoBuffer->BufferSize(), capacity, numChannels);
+   ChangeOver(mUndoBuffer, built, mLoopLength);
+}
+
+void Looper::ReserveForCommit(int numBars, int numChannels)
+{
+   //the loop's length doesn't change until the commit, it just gets the room for it, so the audio thread doesn't have to make any
+   numChannels = MIN(MAX(numChannels, mBuffer->NumActiveChannels()), ChannelBuffer::kMaxNumChannels);
+   int capacity = MAX(GetCapacityForLength(GetLoopLengthForBars(numBars)), mBuffer->BufferSize());
+   if (mBuffer->BufferSize() < capacity || mBuffer->GetMemoryUsage() < size_t(numChannels) * capacity * sizeof(float))
+   {
+      ChannelBuffer built = BuildBuffer(mBuffer, mBuffer->BufferSize(), capacity, numChannels);
+      ChangeOver(mBuffer, built, mLoopLength);
+   }
+   PrepareUndo(numChannels);
+}
+
+int Looper::GetLoopLengthForBars(int numBars) const
+{
+   int sampsPerBar = abs(int(TheTransport->MsPerBar() / 1000 * gSampleRate));
+   return MIN(sampsPerBar * numBars, MAX_BUFFER_SIZE - 1);
+}
+
+//new storage for the loop, built without the lock: source's first copyLength samples and then silence. channels below
+//numChannelsToAllocate are allocated even if there's nothing in them yet, the rest stay unallocated until something writes to them
+ChannelBuffer Looper::BuildBuffer(ChannelBuffer* source, int copyLength, int capacity, int numChannelsToAllocate) const
+{
+   ChannelBuffer built(capacity);
+   built.EnablePeaks();
+   int numChannels = MIN(MAX(source->NumActiveChannels(), numChannelsToAllocate), built.NumTotalChannels());
+   built.SetNumActiveChannels(numChannels);
+   copyLength = MIN(MIN(copyLength, capacity), source->BufferSize());
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      bool hasData = ch < source->NumActiveChannels() && !source->IsSilent(ch);
+      if (!hasData && ch >= numChannelsToAllocate)
+         continue;
+      float* data = built.GetChannel(ch);
+      int copied = 0;
+      if (hasData)
+      {
+         BufferCopy(data, source->GetChannelReadOnly(ch), copyLength);
+         copied = copyLength;
+      }
+      ::Clear(data + copied, capacity - copied);
+   }
+   built.MarkPeaksDirty();
+   return built;
+}
+
+//the audio thread only ever waits for the storage to change hands, built holds the old storage afterwards so that it's freed off the lock too
+void Looper::ChangeOver(ChannelBuffer* buffer, ChannelBuffer& built, int loopLength)
+{
+   std::lock_guard<ofMutex> lock(mBufferMutex);
+   buffer->Swap(built);
+   mLoopLength = loopLength;
 }
 
 int Looper::GetRecorderNumBars() const
@@ -488,7 +660,7 @@ void Looper::ProcessScratch()
    mLoopPosOffset = FloatWrap(mLoopPosOffset - GetPlaybackSpeed() + mScratchSpeed, mLoopLength);
 }
 
-void Looper::ProcessFourTet(double time, int sampleIdx)
+bool Looper::ProcessFourTet(double time, int sampleIdx)
 {
    float measurePos = TheTransport->GetMeasurePos(time) + sampleIdx / (TheTransport->MsPerBar() / gInvSampleRateMs);
    measurePos += TheTransport->GetMeasure(time) % mNumBars;
@@ -506,9 +678,8 @@ void Looper::ProcessFourTet(double time, int sampleIdx)
    //offset regular movement
    mLoopPosOffset = FloatWrap(mLoopPosOffset - (mLoopPos + sampleIdx * GetPlaybackSpeed()), mLoopLength);
 
-   //smooth discontinuity
-   if (oldOffset >= mLoopLength * .5f && mLoopPosOffset < mLoopLength * .5f)
-      mSwitchAndRamp.StartSwitch();
+   //returns whether we jumped, so the discontinuity can be smoothed
+   return oldOffset >= mLoopLength * .5f && mLoopPosOffset < mLoopLength * .5f;
 }
 
 void Looper::ProcessBeatwheel(double time, int sampleIdx)
@@ -606,22 +777,30 @@ int Looper::GetMeasureSliceIndex(double time, int sampleIdx, int slicesPerBar)
 void Looper::ResampleForSpeed(float speed)
 {
    int oldLoopLength = mLoopLength;
-   SetLoopLength(MIN(int(abs(mLoopLength / speed)), MAX_BUFFER_SIZE - 1));
-   mLoopPos /= speed;
-   while (mLoopPos < 0)
-      mLoopPos += mLoopLength;
+   int newLoopLength = MIN(int(abs(mLoopLength / speed)), MAX_BUFFER_SIZE - 1);
+
+   //resample into storage of the new length, then copy it over in one go, so the old loop stays readable until then
+   ChannelBuffer resampled(GetCapacityForLength(newLoopLength));
+   resampled.EnablePeaks();
+   resampled.SetNumActiveChannels(mBuffer->NumActiveChannels());
    for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
    {
-      float* oldBuffer = new float[oldLoopLength];
-      BufferCopy(oldBuffer, mBuffer->GetChannel(ch), oldLoopLength);
-      for (int i = 0; i < mLoopLength; ++i)
+      const float* oldBuffer = mBuffer->GetChannel(ch);
+      float* newBuffer = resampled.GetChannel(ch);
+      for (int i = 0; i < newLoopLength; ++i)
       {
          float offset = i * speed;
-         mBuffer->GetChannel(ch)[i] = GetInterpolatedSample(offset, oldBuffer, oldLoopLength);
+         newBuffer[i] = GetInterpolatedSample(offset, oldBuffer, oldLoopLength);
       }
-      delete[] oldBuffer;
    }
 
+   resampled.MarkPeaksDirty();
+   ChangeOver(mBuffer, resampled, newLoopLength);
+   SetLoopLength(newLoopLength);
+   mLoopPos /= speed;
+   while (mLoopPos < 0)
+      mLoopPos += mLoopLength;
+
    if (mKeepPitch)
    {
       mKeepPitch = false;
@@ -653,7 +832,10 @@ void Looper::DrawModule()
 
    float displayPos = GetActualLoopPos(0);
    mBufferMutex.lock();
-   DrawAudioBuffer(kBufferWidth, kBufferHeight, mBuffer, 0, mLoopLength, displayPos, mVol);
+   if (IsHibernating()) //drawing the buffer would bring its channels back
+      DrawTextNormal("hibernating", 4, kBufferHeight / 2);
+   else
+      DrawAudioBuffer(kBufferWidth, kBufferHeight, mBuffer, 0, mLoopLength, displayPos, mVol);
    mBufferMutex.unlock();
    ofSetColor(255, 255, 0, gModuleDrawAlpha);
    for (int i = 1; i < mNumBars; ++i)
@@ -731,6 +913,8 @@ void Looper::DrawModule()
    mSaveButton->Draw();
    mMuteCheckbox->Draw();
    mPassthroughCheckbox->Draw();
+   mResampleQualitySelector->Draw();
+   mStretchModeSelector->Draw();
    mCommitButton->Draw();
 
    if (mGranulator)
@@ -870,7 +1054,8 @@ bool Looper::DrawToPush2Screen()
    ofTranslate(60, 3);
    float displayPos = GetActualLoopPos(0);
    mBufferMutex.lock();
-   DrawAudioBuffer(180, 74, mBuffer, 0, mLoopLength, displayPos, mVol);
+   if (!IsHibernating())
+      DrawAudioBuffer(180, 74, mBuffer, 0, mLoopLength, displayPos, mVol);
    mBufferMutex.unlock();
 
    ofPopMatrix();
@@ -880,7 +1065,11 @@ bool Looper::DrawToPush2Screen()
 
 void Looper::Clear()
 {
-   mBuffer->Clear();
+   {
+      //give the memory back, the channels get allocated again when something is next written
+      std::lock_guard<ofMutex> lock(mBufferMutex);
+      mBuffer->Resize(GetCapacityForLength(mLoopLength));
+   }
    mLastCommitTime = gTime;
    mVol = 1;
    mFourTet = 0;
@@ -898,9 +1087,11 @@ void Looper::SetNumBars(int numBars)
 
 void Looper::BakeVolume()
 {
-   mUndoBuffer->CopyFrom(mBuffer, mLoopLength);
+   //PrepareUndo() has already been done on the main thread. if the loop has grown since, only what fits is kept
+   mUndoBuffer->CopyFrom(mBuffer, MIN(mLoopLength, mUndoBuffer->BufferSize()));
    for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
       Mult(mBuffer->GetChannel(ch), mVol * mVol, mLoopLength);
+   mBuffer->MarkPeaksDirty(0, mLoopLength);
    mVol = 1;
    mSmoothedVol = 1;
    mWantBakeVolume = false;
@@ -909,8 +1100,9 @@ void Looper::BakeVolume()
 void Looper::UpdateNumBars(int oldNumBars)
 {
    assert(mNumBars > 0);
+   SetLoopLength(GetLoopLengthForBars(mNumBars));
+   std::lock_guard<ofMutex> lock(mBufferMutex);
    int sampsPerBar = abs(int(TheTransport->MsPerBar() / 1000 * gSampleRate));
-   SetLoopLength(MIN(sampsPerBar * mNumBars, MAX_BUFFER_SIZE - 1));
    while (mLoopPos > sampsPerBar)
       mLoopPos -= sampsPerBar;
    mLoopPos += sampsPerBar * (TheTransport->GetMeasure(gTime) % mNumBars);
@@ -922,17 +1114,30 @@ void Looper::UpdateNumBars(int oldNumBars)
       {
          for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
          {
-            if (oldLoopLength * i + oldLoopLength < MAX_BUFFER_SIZE)
+            if (oldLoopLength * i + oldLoopLength <= mBuffer->BufferSize())
                BufferCopy(mBuffer->GetChannel(ch) + oldLoopLength * i, mBuffer->GetChannel(ch), oldLoopLength);
          }
       }
+      mBuffer->MarkPeaksDirty();
    }
 }
 
 void Looper::SetLoopLength(int length)
 {
    assert(length > 0);
-   mLoopLength = length;
+   //the storage changes over together with the length, so the audio thread never reads past the end. it's only ever made on the audio thread
+   //when the loop outgrows what ReserveForCommit() set aside, and it's never shrunk there, the room is just kept until the main thread next resizes
+   int capacity = GetCapacityForLength(length);
+   if (capacity > mBuffer->BufferSize() || (capacity < mBuffer->BufferSize() && !IsAudioThread()))
+   {
+      ChannelBuffer built = BuildBuffer(mBuffer, MIN(mLoopLength, mBuffer->BufferSize()), capacity, 0);
+      ChangeOver(mBuffer, built, length);
+   }
+   else
+   {
+      std::lock_guard<ofMutex> lock(mBufferMutex);
+      mLoopLength = length;
+   }
    if (mLoopPosOffsetSlider != nullptr)
       mLoopPosOffsetSlider->SetExtents(0, length);
    mBufferTempo = TheTransport->GetTempo();
@@ -940,23 +1145,30 @@ void Looper::SetLoopLength(int length)
 
 void Looper::MergeIn(Looper* otherLooper)
 {
+   WakeModule();
+   otherLooper->WakeModule();
    int newNumBars = MAX(mNumBars, otherLooper->mNumBars);
 
    SetNumBars(newNumBars);
 
    otherLooper->SetNumBars(newNumBars);
 
+   std::lock_guard<ofMutex> lock(mBufferMutex);
+   std::lock_guard<ofMutex> otherLock(otherLooper->mBufferMutex);
+   int length = MIN(mLoopLength, otherLooper->mLoopLength); //the same unless the tempo moved between the two being recorded
    if (mVol > 0.01f)
    {
       for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
       {
-         Mult(otherLooper->mBuffer->GetChannel(ch), (otherLooper->mVol * otherLooper->mVol) / (mVol * mVol), mLoopLength); //keep other looper at same apparent volume
-         Add(mBuffer->GetChannel(ch), otherLooper->mBuffer->GetChannel(ch), mLoopLength);
+         Mult(otherLooper->mBuffer->GetChannel(ch), (otherLooper->mVol * otherLooper->mVol) / (mVol * mVol), length); //keep other looper at same apparent volume
+         Add(mBuffer->GetChannel(ch), otherLooper->mBuffer->GetChannel(ch), length);
       }
+      mBuffer->MarkPeaksDirty(0, length);
+      otherLooper->mBuffer->MarkPeaksDirty(0, length);
    }
    else //ours was silent, just replace it
    {
-      mBuffer->CopyFrom(otherLooper->mBuffer, mLoopLength);
+      mBuffer->CopyFrom(otherLooper->mBuffer, length);
       mVol = 1;
    }
 
@@ -969,6 +1181,8 @@ void Looper::MergeIn(Looper* otherLooper)
 void Looper::SwapBuffers(Looper* otherLooper)
 {
    assert(otherLooper);
+   WakeModule();
+   otherLooper->WakeModule();
    ChannelBuffer* temp = otherLooper->mBuffer;
    int length = otherLooper->mLoopLength;
    int numBars = otherLooper->mNumBars;
@@ -986,8 +1200,12 @@ void Looper::SwapBuffers(Looper* otherLooper)
 void Looper::CopyBuffer(Looper* sourceLooper)
 {
    assert(sourceLooper);
-   mBuffer->CopyFrom(sourceLooper->mBuffer, mLoopLength);
-   SetLoopLength(sourceLooper->mLoopLength);
+   WakeModule();
+   sourceLooper->WakeModule();
+   int length = sourceLooper->mLoopLength;
+   ChannelBuffer built = BuildBuffer(sourceLooper->mBuffer, length, GetCapacityForLength(length), 0);
+   ChangeOver(mBuffer, built, length);
+   SetLoopLength(length);
    mNumBars = sourceLooper->mNumBars;
 }
 
@@ -1042,6 +1260,7 @@ void Looper::SampleDropped(int x, int y, Sample* sample)
    if (sample->GetNumBars() > 0)
       SetNumBars(sample->GetNumBars());
 
+   std::lock_guard<ofMutex> lock(mBufferMutex);
    float lengthRatio = float(numSamples) / mLoopLength;
    mBuffer->SetNumActiveChannels(sample->NumChannels());
    for (int i = 0; i < mLoopLength; ++i)
@@ -1050,12 +1269,13 @@ void Looper::SampleDropped(int x, int y, Sample* sample)
       for (int ch = 0; ch < sample->NumChannels(); ++ch)
          mBuffer->GetChannel(ch)[i] = GetInterpolatedSample(offset, sample->Data()->GetChannel(ch), numSamples);
    }
+   mBuffer->MarkPeaksDirty(0, mLoopLength);
 }
 
 void Looper::GetModuleDimensions(float& width, float& height)
 {
    width = kBufferX * 2 + kBufferWidth;
-   height = 182;
+   height = 200;
 }
 
 void Looper::OnClicked(float x, float y, bool right)
@@ -1079,7 +1299,9 @@ void Looper::ButtonClicked(ClickButton* button, double time)
 {
    if (button == mClearButton)
    {
-      mUndoBuffer->CopyFrom(mBuffer, mLoopLength);
+      //the loop being cleared becomes the undo state as it is, rather than being copied there
+      std::lock_guard<ofMutex> lock(mBufferMutex);
+      std::swap(mBuffer, mUndoBuffer);
       Clear();
    }
    if (button == mMergeButton && mRecorder)
@@ -1089,7 +1311,10 @@ void Looper::ButtonClicked(ClickButton* button, double time)
    if (button == mCopyButton && mRecorder)
       mRecorder->RequestCopy(this);
    if (button == mVolumeBakeButton)
+   {
+      PrepareUndo(mBuffer->NumActiveChannels());
       mWantBakeVolume = true;
+   }
    if (button == mSaveButton)
    {
       Sample::WriteDataToFile(ofGetTimestampString("loops/loop_%Y-%m-%d_%H-%M-%S.wav").c_str(), mBuffer, mLoopLength);
@@ -1121,7 +1346,10 @@ void Looper::ButtonClicked(ClickButton* button, double time)
          SetNumBars(newLength);
    }
    if (button == mUndoButton)
+   {
+      PrepareUndo(mBuffer->NumActiveChannels()); //so that the swap finds it at least the loop's size
       mWantUndo = true;
+   }
    if (button == mWriteOffsetButton)
       mWantShiftOffset = true;
    if (button == mQueueCaptureButton)
@@ -1162,6 +1390,17 @@ void Looper::DropdownUpdated(DropdownList* list, int oldVal, double time)
 {
    if (list == mNumBarsSelector)
       UpdateNumBars(oldVal);
+   if (list == mStretchModeSelector)
+   {
+      std::unique_ptr<TimeStretcher> stretcher;
+      if (mStretchMode != StretchMode::Off)
+      {
+         stretcher = std::make_unique<TimeStretcher>();
+         stretcher->SetMode(mStretchMode);
+      }
+      std::lock_guard<ofMutex> lock(mBufferMutex);
+      std::swap(mStretcher, stretcher);
+   }
 }
 
 void Looper::CheckboxUpdated(Checkbox* checkbox, double time)
@@ -1250,69 +1489,52 @@ void Looper::HalveNumBars()
 void Looper::DoShiftMeasure()
 {
    int measureSize = int(TheTransport->MsPerBar() * gSampleRate / 1000);
-   for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
-   {
-      float* newBuffer = new float[MAX_BUFFER_SIZE];
-      BufferCopy(newBuffer, mBuffer->GetChannel(ch) + measureSize, mLoopLength - measureSize);
-      BufferCopy(newBuffer + mLoopLength - measureSize, mBuffer->GetChannel(ch), measureSize);
-      mBufferMutex.lock();
-      mBuffer->SetChannelPointer(newBuffer, ch, true);
-      mBufferMutex.unlock();
-   }
+   RotateLoop(measureSize);
    mWantShiftMeasure = false;
 }
 
 void Looper::DoHalfShift()
 {
    int halfMeasureSize = int(TheTransport->MsPerBar() * gSampleRate / 1000 / 2);
-   for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
-   {
-      float* newBuffer = new float[MAX_BUFFER_SIZE];
-      BufferCopy(newBuffer, mBuffer->GetChannel(ch) + halfMeasureSize, mLoopLength - halfMeasureSize);
-      BufferCopy(newBuffer + mLoopLength - halfMeasureSize, mBuffer->GetChannel(ch), halfMeasureSize);
-      mBufferMutex.lock();
-      mBuffer->SetChannelPointer(newBuffer, ch, true);
-      mBufferMutex.unlock();
-   }
+   RotateLoop(halfMeasureSize);
    mWantHalfShift = false;
 }
 
 void Looper::DoShiftDownbeat()
 {
-   int shift = int(mLoopPos);
-   for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
-   {
-      float* newBuffer = new float[MAX_BUFFER_SIZE];
-      BufferCopy(newBuffer, mBuffer->GetChannel(ch) + shift, mLoopLength - shift);
-      BufferCopy(newBuffer + mLoopLength - shift, mBuffer->GetChannel(ch), shift);
-      mBufferMutex.lock();
-      mBuffer->SetChannelPointer(newBuffer, ch, true);
-      mBufferMutex.unlock();
-   }
+   RotateLoop(int(mLoopPos));
    mWantShiftDownbeat = false;
 }
 
 void Looper::DoShiftOffset()
 {
-   int shift = int(mLoopPosOffset);
-   if (shift != 0)
-   {
-      for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
-      {
-         float* newBuffer = new float[MAX_BUFFER_SIZE];
-         BufferCopy(newBuffer, mBuffer->GetChannel(ch) + shift, mLoopLength - shift);
-         BufferCopy(newBuffer + mLoopLength - shift, mBuffer->GetChannel(ch), shift);
-         mBufferMutex.lock();
-         mBuffer->SetChannelPointer(newBuffer, ch, true);
-         mBufferMutex.unlock();
-      }
-   }
+   RotateLoop(int(mLoopPosOffset));
    mWantShiftOffset = false;
    mLoopPosOffset = 0;
 }
 
+//moves the loop's contents earlier by shift samples, wrapping around
+void Looper::RotateLoop(int shift)
+{
+   shift = ((shift % mLoopLength) + mLoopLength) % mLoopLength;
+   if (shift == 0)
+      return;
+
+   std::lock_guard<ofMutex> lock(mBufferMutex);
+   int capacity = mBuffer->BufferSize();
+   for (int ch = 0; ch < mBuffer->NumActiveChannels(); ++ch)
+   {
+      float* newBuffer = new float[capacity];
+      BufferCopy(newBuffer, mBuffer->GetChannel(ch) + shift, mLoopLength - shift);
+      BufferCopy(newBuffer + mLoopLength - shift, mBuffer->GetChannel(ch), shift);
+      ::Clear(newBuffer + mLoopLength, capacity - mLoopLength);
+      mBuffer->SetChannelPointer(newBuffer, ch, true);
+   }
+}
+
 void Looper::Rewrite()
 {
+   ReserveForCommit(GetRecorderNumBars(), mBuffer->NumActiveChannels());
    mWantRewrite = true;
 }
 
@@ -1352,11 +1574,64 @@ void Looper::SaveState(FileStreamOut& out)
 
    out << mLoopLength;
    out << mBufferTempo;
-   mBuffer->Save(out, mLoopLength);
+   if (IsHibernating())
+   {
+      juce::MemoryBlock loop;
+      ModuleHibernation::Decompress(mHibernatedLoop, loop);
+      out.WriteGeneric(loop.getData(), (int)loop.getSize());
+   }
+   else
+   {
+      mBuffer->Save(out, mLoopLength);
+   }
+}
+
+void Looper::Hibernate()
+{
+   juce::MemoryBlock loop;
+   juce::MemoryBlock undo;
+   {
+      std::lock_guard<ofMutex> lock(mBufferMutex);
+      {
+         FileStreamOut out(loop);
+         mBuffer->Save(out, mLoopLength);
+      }
+      {
+         //all of it, since the loop length it was a snapshot of may have changed since. channels it never used aren't written
+         FileStreamOut out(undo);
+         mUndoBuffer->Save(out, mUndoBuffer->BufferSize());
+      }
+      mBuffer->ReleaseChannels();
+      mUndoBuffer->ReleaseChannels();
+   }
+   ModuleHibernation::Compress(loop, mHibernatedLoop);
+   ModuleHibernation::Compress(undo, mHibernatedUndo);
+}
+
+void Looper::Wake()
+{
+   juce::MemoryBlock loop;
+   ModuleHibernation::Decompress(mHibernatedLoop, loop);
+   mHibernatedLoop.reset();
+   juce::MemoryBlock undo;
+   ModuleHibernation::Decompress(mHibernatedUndo, undo);
+   mHibernatedUndo.reset();
+
+   int readLength;
+   std::lock_guard<ofMutex> lock(mBufferMutex);
+   {
+      FileStreamIn in(loop);
+      mBuffer->Load(in, readLength, ChannelBuffer::LoadMode::kAnyBufferSize);
+   }
+   {
+      FileStreamIn in(undo);
+      mUndoBuffer->Load(in, readLength, ChannelBuffer::LoadMode::kSetBufferSize);
+   }
 }
 
 void Looper::LoadState(FileStreamIn& in, int rev)
 {
+   WakeModule(); //so that what's loaded isn't replaced by what it was hibernating with
    IDrawableModule::LoadState(in, rev);
 
    if (ModularSynth::sLoadingFileSaveStateRev < 423)
@@ -1366,6 +1641,7 @@ void Looper::LoadState(FileStreamIn& in, int rev)
    in >> mLoopLength;
    if (rev >= 1)
       in >> mBufferTempo;
+   mBuffer->Resize(GetCapacityForLength(mLoopLength));
    int readLength;
    mBuffer->Load(in, readLength, ChannelBuffer::LoadMode::kAnyBufferSize);
    assert(mLoopLength == readLength);
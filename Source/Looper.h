@@ -36,10 +36,16 @@
 #include "Ramp.h"
 #include "JumpBlender.h"
 #include "PitchShifter.h"
+#include "Resampler.h"
+#include "TimeStretcher.h"
 #include "INoteReceiver.h"
 #include "SwitchAndRamp.h"
 #include "IInputRecordable.h"
 
+#include "juce_core/juce_core.h"
+
+#include <memory>
+
 class LooperRecorder;
 class Rewriter;
 class Sample;
@@ -56,12 +62,14 @@ public:
    static bool AcceptsAudio() { return true; }
    static bool AcceptsNotes() { return true; }
    static bool AcceptsPulses() { return false; }
+   static bool CanConstructOffThread() { return true; }
 
    void CreateUIControls() override;
 
    void SetRecorder(LooperRecorder* recorder);
    LooperRecorder* GetRecorder() const { return mRecorder; }
    void Clear();
+   void ReserveForCommit(int numBars, int numChannels); //main thread, ahead of a Commit() from the audio thread
    void Commit(RollingBuffer* commitBuffer, bool replaceOnCommit, float offsetMs);
    void Fill(ChannelBuffer* buffer, int length);
    void ResampleForSpeed(float speed);
@@ -90,6 +98,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //records its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    //INoteReceiver
@@ -136,18 +145,30 @@ public:
    int GetModuleSaveStateRev() const override { return 1; }
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override { return mBuffer->GetMemoryUsage() + mUndoBuffer->GetMemoryUsage() + mWorkBuffer.GetMemoryUsage() + mHibernatedLoop.getSize() + mHibernatedUndo.getSize(); }
+   bool CanHibernate() const override { return mBuffer->GetMemoryUsage() + mUndoBuffer->GetMemoryUsage() > 0; }
 
 private:
+   //IDrawableModule
+   void Hibernate() override; //keeps the loop and the undo state compressed
+   void Wake() override;
+
    void DoShiftMeasure();
    void DoHalfShift();
    void DoShiftDownbeat();
    void DoShiftOffset();
+   void RotateLoop(int shift);
+   int GetLoopLengthForBars(int numBars) const;
+   ChannelBuffer BuildBuffer(ChannelBuffer* source, int copyLength, int capacity, int numChannelsToAllocate) const;
+   void ChangeOver(ChannelBuffer* buffer, ChannelBuffer& built, int loopLength);
+   void PrepareUndo(int numChannels);
    void DoCommit(double time);
    void ProcessCommit(int numSamplesToProcess);
+   void MarkBufferWritten(float fromOffset, float toOffset);
    void UpdateNumBars(int oldNumBars);
    void BakeVolume();
    void DoUndo();
-   void ProcessFourTet(double time, int sampleIdx);
+   bool ProcessFourTet(double time, int sampleIdx);
    void ProcessScratch();
    void ProcessBeatwheel(double time, int sampleIdx);
    int GetMeasureSliceIndex(double time, int sampleIdx, int slicesPerBar);
@@ -160,7 +181,7 @@ private:
    void GetModuleDimensions(float& width, float& height) override;
    void OnClicked(float x, float y, bool right) override;
 
-   ChannelBuffer* mBuffer{ nullptr };
+   ChannelBuffer* mBuffer{ nullptr }; //at least the loop's size, in whole chunks, see SetLoopLength()
    ChannelBuffer mWorkBuffer;
    int mLoopLength{ -1 };
    float mLoopPos{ 0 };
@@ -215,6 +236,8 @@ private:
    int mFourTetSlices{ 4 };
    DropdownList* mFourTetSlicesDropdown{ nullptr };
    ofMutex mBufferMutex;
+   juce::MemoryBlock mHibernatedLoop; //mBuffer->Save() of the loop, compressed, while hibernating
+   juce::MemoryBlock mHibernatedUndo; //the same for mUndoBuffer, so an undo after waking still has something to go back to
    Ramp mMuteRamp;
    JumpBlender mJumpBlender[ChannelBuffer::kMaxNumChannels];
    bool mClearCommitBuffer{ false };
@@ -250,11 +273,17 @@ private:
    float mWriteMsOffset{ 0.0f }; //offset to use when writing with direct input
 
    //pitch shifter
-   PitchShifter* mPitchShifter[ChannelBuffer::kMaxNumChannels];
+   PitchShifter mPitchShifter{ 1024, ChannelBuffer::kMaxNumChannels };
    float mPitchShift{ 1 };
    FloatSlider* mPitchShiftSlider{ nullptr };
    bool mKeepPitch{ false };
    Checkbox* mKeepPitchCheckbox{ nullptr };
+   ResampleQuality mResampleQuality{ ResampleQuality::Linear };
+   DropdownList* mResampleQualitySelector{ nullptr };
+   StretchMode mStretchMode{ StretchMode::Off }; //what "auto" keeps the pitch with. off is the pitch shifter
+   DropdownList* mStretchModeSelector{ nullptr };
+   std::unique_ptr<TimeStretcher> mStretcher;
+   std::vector<double> mReadPositions;
 
    LooperGranulator* mGranulator{ nullptr };
 
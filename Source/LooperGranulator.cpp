@@ -64,6 +64,7 @@ void LooperGranulator::CreateUIControls()
    mLooperCable->AddTypeFilter("looper");
    AddPatchCableSource(mLooperCable);
 
+   mGranOverlap->SetMode(FloatSlider::kLogarithmic);
    mGranPosRandomize->SetMode(FloatSlider::kSquare);
    mGranLengthMs->SetMode(FloatSlider::kSquare);
 }
@@ -34,6 +34,8 @@
 #include "Profiler.h"
 #include "PatchCableSource.h"
 #include "UIControlMacros.h"
+#include "UserPrefs.h"
+#include "LatencyCalculator.h"
 
 LooperRecorder::LooperRecorder()
 : IAudioProcessor(gBufferSize)
@@ -75,8 +77,11 @@ void LooperRecorder::CreateUIControls()
    BUTTON(mClearOverdubButton, "clear");
    CHECKBOX(mFreeRecordingCheckbox, "free rec", &mFreeRecording);
    BUTTON(mCancelFreeRecordButton, "cancel free rec");
+   CHECKBOX(mRecordToDiskCheckbox, "to disk", &mRecordToDisk);
    ENDUIBLOCK(width, height);
 
+   mRecordToDiskCheckbox->SetShouldSaveState(false); //don't start writing a file just from loading a layout
+
    mWidth = MAX(mWidth, width);
    mHeight = MAX(mHeight, height);
 
@@ -95,6 +100,8 @@ void LooperRecorder::CreateUIControls()
    BUTTON(mResampAndSetButton, "resample & set key");
    UIBLOCK_PUSHSLIDERWIDTH(120);
    FLOATSLIDER(mLatencyFixMsSlider, "latency fix ms", &mLatencyFixMs, 0, 200);
+   UIBLOCK_SHIFTRIGHT();
+   CHECKBOX(mUseMeasuredLatencyCheckbox, "measured", &mUseMeasuredLatency);
    ENDUIBLOCK(width, height);
 
    mWidth = MAX(mWidth, width);
@@ -243,6 +250,9 @@ void LooperRecorder::Process(double time)
       }
    }
 
+   if (mDiskRecorder.IsRecording())
+      mDiskRecorder.Write(&mWriteBuffer, bufferSize);
+
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
    {
       mRecordBuffer.WriteChunk(mWriteBuffer.GetChannel(ch), bufferSize, ch);
@@ -345,6 +355,7 @@ void LooperRecorder::DrawModule()
    mSnapPitchButton->Draw();
    mFreeRecordingCheckbox->Draw();
    mCancelFreeRecordButton->Draw();
+   mRecordToDiskCheckbox->Draw();
    mLatencyFixMsSlider->Draw();
    mNextCommitTargetSlider->Draw();
    mAutoAdvanceThroughLoopersCheckbox->Draw();
@@ -492,6 +503,7 @@ void LooperRecorder::SyncLoopLengths()
 
 void LooperRecorder::Commit(Looper* looper)
 {
+   looper->ReserveForCommit(mNumBars, mRecordBuffer.NumChannels());
    mCommitToLooper = looper;
 }
 
@@ -882,6 +894,24 @@ void LooperRecorder::CheckboxUpdated(Checkbox* checkbox, double time)
          EndFreeRecord(time);
    }
 
+   if (checkbox == mRecordToDiskCheckbox)
+   {
+      if (mRecordToDisk)
+      {
+         std::string path = ofGetTimestampString(UserPrefs.recordings_path.Get() + "looperrecorder_%Y-%m-%d_%H-%M-%S.wav");
+         if (!mDiskRecorder.Start(path, MAX(1, mRecordBuffer.NumChannels())))
+         {
+            TheSynth->LogEvent("couldn't record to " + path, kLogEventType_Error);
+            mRecordToDisk = false;
+         }
+      }
+      else if (mDiskRecorder.IsRecording())
+      {
+         mDiskRecorder.Stop();
+         TheSynth->LogEvent("wrote " + mDiskRecorder.GetPath(), kLogEventType_Verbose);
+      }
+   }
+
    for (int i = 0; i < (int)mWriteForLooperCheckbox.size(); ++i)
    {
       if (checkbox == mWriteForLooperCheckbox[i])
@@ -949,6 +979,12 @@ void LooperRecorder::IntSliderUpdated(IntSlider* slider, int oldVal, double time
 
 void LooperRecorder::Poll()
 {
+   if (mUseMeasuredLatency)
+   {
+      float measured = LatencyCalculatorReceiver::GetMeasuredLatencyMs();
+      if (measured >= 0)
+         mLatencyFixMs = ofClamp(measured, mLatencyFixMsSlider->GetMin(), mLatencyFixMsSlider->GetMax());
+   }
 }
 
 void LooperRecorder::LoadLayout(const ofxJSONElement& moduleInfo)
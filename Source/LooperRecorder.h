@@ -37,6 +37,7 @@
 #include "DropdownList.h"
 #include "Push2Control.h"
 #include "IInputRecordable.h"
+#include "StreamingRecorder.h"
 
 class Stutter;
 class PatchCableSource;
@@ -50,6 +51,7 @@ public:
    static bool AcceptsAudio() { return true; }
    static bool AcceptsNotes() { return false; }
    static bool AcceptsPulses() { return false; }
+   static bool CanConstructOffThread() { return true; }
 
    void CreateUIControls() override;
 
@@ -75,6 +77,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //records its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    //IDrawableModule
@@ -114,6 +117,7 @@ public:
    int GetModuleSaveStateRev() const override { return 0; }
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override { return mRecordBuffer.GetMemoryUsage() + mWriteBuffer.GetMemoryUsage(); }
 
 private:
    void SyncLoopLengths();
@@ -170,12 +174,18 @@ private:
    std::array<double, kMaxLoopers> mStartRecordMeasureTime{ 0 };
    float mLatencyFixMs{ 0 };
    FloatSlider* mLatencyFixMsSlider{ nullptr };
+   bool mUseMeasuredLatency{ false };
+   Checkbox* mUseMeasuredLatencyCheckbox{ nullptr };
 
    bool mFreeRecording{ false };
    Checkbox* mFreeRecordingCheckbox{ nullptr };
    double mStartFreeRecordTime{ 0 };
    ClickButton* mCancelFreeRecordButton{ nullptr };
 
+   bool mRecordToDisk{ false };
+   Checkbox* mRecordToDiskCheckbox{ nullptr };
+   StreamingRecorder mDiskRecorder; //everything that goes into the record buffer, for as long as "to disk" is on
+
    enum RecorderMode
    {
       kRecorderMode_Record,
@@ -11,6 +11,8 @@
 #include "juce_gui_basics/juce_gui_basics.h"
 #include <memory>
 #include "VSTScanner.h"
+#include "PluginSandbox.h"
+#include "StartupTimer.h"
 #include "SynthGlobals.h"
 
 #include "VersionInfo.h"
@@ -45,6 +47,8 @@ public:
    //==============================================================================
    void initialise(const String& commandLine) override
    {
+      StartupTimer::Get().Start();
+
       // Parse command line arguments that should cause us to exit
       auto cliArgv = JUCEApplication::getCommandLineParameterArray();
       for (int i = 0; i < cliArgv.size(); ++i)
@@ -63,6 +67,8 @@ public:
                       << "\n"
                       << "Options:\n"
                       << "  -o, --option <option> <value>   Temporarily override settings in preferences file\n"
+                      << "  --bounce <bars> <path>.wav      Render the project offline for <bars> bars to <path>.wav, then exit\n"
+                      << "  --tempo <bpm>                   Tempo to use for --bounce\n"
                       << "  -h, --help                      Print help\n"
                       << "  -v, --version                   Print version\n"
                       << std::flush;
@@ -73,7 +79,7 @@ public:
             std::cout << "bespoke synth " << GetBuildInfoString() << std::endl;
             should_exit = true;
          }
-         else if (argument == "-o" || argument == "--option")
+         else if (argument == "-o" || argument == "--option" || argument == "--bounce")
          {
             if ((cliArgv[i + 1].isEmpty()) || (cliArgv[i + 2].isEmpty()))
             {
@@ -81,6 +87,14 @@ public:
                should_exit = true;
             }
          }
+         else if (argument == "--tempo")
+         {
+            if (cliArgv[i + 1].isEmpty())
+            {
+               CliErrorExpectedOpt(argument);
+               should_exit = true;
+            }
+         }
 
          if (should_exit == true)
          {
@@ -97,6 +111,13 @@ public:
          return;
       }
 
+      //launched to host a single plugin for a sandboxed VSTPlugin
+      if (auto sandboxWorker = PluginSandbox::CreateWorker(commandLine))
+      {
+         storedSandboxWorker = std::move(sandboxWorker);
+         return;
+      }
+
       mainWindow = std::make_unique<MainWindow>("bespoke synth");
 
       juce::PropertiesFile::Options options;
@@ -193,6 +214,7 @@ public:
 private:
    std::unique_ptr<MainWindow> mainWindow;
    std::unique_ptr<PluginScannerSubprocess> storedScannerSubprocess;
+   std::unique_ptr<juce::ChildProcessWorker> storedSandboxWorker;
 };
 
 //==============================================================================
@@ -9,11 +9,15 @@ using namespace juce;
 #include "nanovg/nanovg.h"
 #define NANOVG_GLES2_IMPLEMENTATION
 #include "nanovg/nanovg_gl.h"
+#include "AudioThreadPolicy.h"
 #include "ModularSynth.h"
 #include "SynthGlobals.h"
 #include "Push2Control.h" //TODO(Ryan) remove
 #include "SpaceMouseControl.h"
+#include "ModuleRenderCache.h"
+#include "StartupTimer.h"
 #include "UserPrefs.h"
+#include "VSTScanner.h"
 
 #ifdef JUCE_WINDOWS
 #include <windows.h>
@@ -54,6 +58,9 @@ public:
 #endif
       ofLog() << "   git hash        : " << Bespoke::GIT_HASH;
       ofLog() << "   git branch      : " << Bespoke::GIT_BRANCH;
+
+      //the fonts can be read off disk while the window and the gl context are being set up
+      PreloadGlobalResources();
       ofLog() << "   build time      : " << Bespoke::BUILD_DATE << " at " << Bespoke::BUILD_TIME;
       ofLog() << "   command line    : " << JUCEApplication::getCommandLineParameters();
 
@@ -68,6 +75,7 @@ public:
 #endif
 
       UserPrefs.Init();
+      AudioThreadPolicy::KeepOffAudioCores(); //before the threads that should stay off the audio cores exist
 
       int screenWidth, screenHeight;
       {
@@ -103,10 +111,12 @@ public:
       setWantsKeyboardFocus(true);
       Desktop::setScreenSaverEnabled(false);
       mGlobalManagers.mDeviceManager.getAvailableDeviceTypes(); //scans for device types ("Windows Audio", "DirectSound", etc)
+      StartupTimer::Get().Stage("window");
    }
 
    ~MainContentComponent()
    {
+      mBackgroundPluginScan.reset();
       shutdownOpenGL();
       shutdownAudio();
    }
@@ -124,12 +134,18 @@ public:
          sHasGrabbedFocus = true;
       }
 
-      mSynth.Poll();
+      //opening the audio device can take a while, so that waits until there's something on screen.
+      //the synth isn't polled until then, so the layout still gets loaded with the device open
+      if (mWantFinishStartup && mHasRenderedFirstFrame)
+         FinishStartup();
+
+      if (!mWantFinishStartup)
+         mSynth.Poll();
 
 #if DEBUG
-      if (sRenderFrame % 2 == 0)
+      if (sRenderFrame % 2 == 0 && ShouldRenderFrame())
 #else
-      if (true)
+      if (ShouldRenderFrame())
 #endif
       {
          openGLContext.triggerRepaint();
@@ -186,6 +202,21 @@ public:
                                          const AudioIODeviceCallbackContext& context) override
    {
       ignoreUnused(context);
+      if (mSynth.IsRenderingOffline())
+      {
+         for (int ch = 0; ch < numOutputChannels; ++ch)
+            FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+         return;
+      }
+
+      //once per callback thread, a device restart can bring up a new one
+      static thread_local bool sConfiguredThread = false;
+      if (!sConfiguredThread)
+      {
+         AudioThreadPolicy::ConfigureAudioThread();
+         sConfiguredThread = true;
+      }
+
       mSynth.AudioIn(inputChannelData, numSamples, numInputChannels);
       mSynth.AudioOut(outputChannelData, numSamples, numOutputChannels);
    }
@@ -217,8 +248,10 @@ public:
          printf("Could not init font bounds nanovg.\n");
 
       Push2Control::CreateStaticFramebuffer();
+      StartupTimer::Get().Stage("gl context");
 
       mSynth.LoadResources(mVG, mFontBoundsVG);
+      StartupTimer::Get().Stage("fonts");
 
       /*for (auto deviceType : mGlobalManagers.mDeviceManager.getAvailableDeviceTypes())
       {
@@ -236,11 +269,53 @@ public:
       SetGlobalSampleRateAndBufferSize(UserPrefs.samplerate.Get(), UserPrefs.buffersize.Get());
 
       mSynth.Setup(&mGlobalManagers.mDeviceManager, &mGlobalManagers.mAudioFormatManager, this, &openGLContext);
+      StartupTimer::Get().Stage("synth setup");
 
 #ifdef JUCE_WINDOWS
       CoInitializeEx(0, COINIT_MULTITHREADED);
 #endif
 
+      ParseBounceArguments();
+      if (mSynth.HasStartupBounce())
+      {
+         //rendering offline from the command line, so there's no need for an audio device
+         mSynth.InitIOBuffers(0, 2);
+      }
+      else
+      {
+         mWantFinishStartup = true; //see timerCallback()
+      }
+
+      for (int i = 0; i < JUCEApplication::getCommandLineParameterArray().size(); ++i)
+      {
+         juce::String argument = JUCEApplication::getCommandLineParameterArray()[i];
+         if (argument.endsWith(".bsk") || argument.endsWith(".bskt"))
+         {
+            mSynth.SetStartupSaveStateFile(argument.toStdString());
+            TitleBar::sShowInitialHelpOverlay = false; //don't show initial help popup, a user who uses the command line arguments likely doesn't need it
+            break;
+         }
+      }
+
+      UserPrefs.LastTargetFramerate = UserPrefs.target_framerate.Get();
+      startTimerHz(UserPrefs.target_framerate.Get());
+   }
+
+   //the parts of startup that don't need to happen before the first frame is drawn
+   void FinishStartup()
+   {
+      mWantFinishStartup = false;
+
+      OpenAudioDevice();
+      StartupTimer::Get().Stage("audio device");
+
+      //plugin discovery happens off the message thread, so startup doesn't wait on it
+      if (UserPrefs.rescan_plugins_on_startup.Get())
+         mBackgroundPluginScan = std::make_unique<BackgroundPluginScan>(mSynth.GetAudioPluginFormatManager(), mSynth.GetKnownPluginList());
+   }
+
+   void OpenAudioDevice()
+   {
       std::string inputDevice = GetInputDeviceName();
       std::string outputDevice = GetOutputDeviceName();
       String audioError = InitializeAudioDevice();
@@ -260,9 +335,9 @@ public:
             mSynth.SetFatalError("error setting input device to '" + inputDevice + "', fix this in userprefs.json (use \"auto\" for default device, or \"none\" for no device)" +
                                  "\n\n\nvalid devices:\n" + GetAudioDevices());
          }
-         else if (loadedSetup.bufferSize != gBufferSize / UserPrefs.oversampling.Get())
+         else if (loadedSetup.bufferSize != gIOBufferSize / UserPrefs.oversampling.Get())
          {
-            mSynth.SetFatalError("error setting buffer size to " + ofToString(gBufferSize / UserPrefs.oversampling.Get()) + " on device '" + loadedSetup.outputDeviceName.toStdString() + "', fix this in userprefs.json" +
+            mSynth.SetFatalError("error setting buffer size to " + ofToString(gIOBufferSize / UserPrefs.oversampling.Get()) + " on device '" + loadedSetup.outputDeviceName.toStdString() + "', fix this in userprefs.json" +
                                  "\n\n(a valid buffer size might be: " + ofToString(loadedSetup.bufferSize) + ")");
          }
          else if (loadedSetup.sampleRate != gSampleRate / UserPrefs.oversampling.Get())
@@ -306,20 +381,30 @@ public:
          mSynth.SetFatalError("error initializing audio device: " + audioError.toStdString() +
                               "\n\n\nvalid devices:\n" + GetAudioDevices());
       }
+   }
 
-      for (int i = 0; i < JUCEApplication::getCommandLineParameterArray().size(); ++i)
+   void ParseBounceArguments()
+   {
+      //--bounce <bars> <file.wav> [--tempo <bpm>]
+      auto cliArgv = JUCEApplication::getCommandLineParameterArray();
+      int numBars = 0;
+      float tempo = -1;
+      std::string outputPath;
+      for (int i = 0; i < cliArgv.size(); ++i)
       {
-         juce::String argument = JUCEApplication::getCommandLineParameterArray()[i];
-         if (argument.endsWith(".bsk") || argument.endsWith(".bskt"))
+         if (cliArgv[i] == "--bounce" && i + 2 < cliArgv.size())
          {
-            mSynth.SetStartupSaveStateFile(argument.toStdString());
-            TitleBar::sShowInitialHelpOverlay = false; //don't show initial help popup, a user who uses the command line arguments likely doesn't need it
-            break;
+            numBars = cliArgv[i + 1].getIntValue();
+            outputPath = cliArgv[i + 2].toStdString();
+         }
+         else if (cliArgv[i] == "--tempo" && i + 1 < cliArgv.size())
+         {
+            tempo = cliArgv[i + 1].getFloatValue();
          }
       }
 
-      UserPrefs.LastTargetFramerate = UserPrefs.target_framerate.Get();
-      startTimerHz(UserPrefs.target_framerate.Get());
+      if (numBars > 0 && !outputPath.empty())
+         mSynth.SetStartupBounce(outputPath, numBars, tempo);
    }
 
    std::string GetInputDeviceName() const
@@ -341,7 +426,7 @@ public:
       std::string outputDevice = GetOutputDeviceName();
       AudioDeviceManager::AudioDeviceSetup preferredSetupOptions;
       preferredSetupOptions.sampleRate = gSampleRate / UserPrefs.oversampling.Get();
-      preferredSetupOptions.bufferSize = gBufferSize / UserPrefs.oversampling.Get();
+      preferredSetupOptions.bufferSize = gIOBufferSize / UserPrefs.oversampling.Get();
       if (outputDevice != kAutoDevice && outputDevice != kNoneDevice)
          preferredSetupOptions.outputDeviceName = outputDevice;
       if (inputDevice != kAutoDevice && inputDevice != kNoneDevice)
@@ -426,6 +511,9 @@ public:
       float width = getWidth();
       float height = getHeight();
 
+      //has to happen before the main frame begins, since each cache is its own nanovg frame
+      ModuleRenderCache::RenderPending(mVG, mPixelRatio);
+
       static float kMotionTrails = .4f;
 
       ofVec3f bgColor(ModularSynth::sBackgroundR, ModularSynth::sBackgroundG, ModularSynth::sBackgroundB);
@@ -457,6 +545,12 @@ public:
 
       mSynth.LockRender(false);
 
+      if (!mHasRenderedFirstFrame)
+      {
+         StartupTimer::Get().Stage("first frame");
+         mHasRenderedFirstFrame = true;
+      }
+
       ++mFrameCountAccum;
       int64 time = Time::currentTimeMillis();
 
@@ -494,16 +588,19 @@ private:
 
    void mouseDown(const MouseEvent& e) override
    {
+      NoteUserActivity();
       mSynth.MousePressed(e.getMouseDownX(), e.getMouseDownY(), GetMouseButton(e), e.source);
    }
 
    void mouseUp(const MouseEvent& e) override
    {
+      NoteUserActivity();
       mSynth.MouseReleased(e.getPosition().x, e.getPosition().y, GetMouseButton(e), e.source);
    }
 
    void mouseDrag(const MouseEvent& e) override
    {
+      NoteUserActivity();
       mSynth.MouseDragged(e.getPosition().x, e.getPosition().y, GetMouseButton(e), e.source);
    }
 
@@ -515,6 +612,7 @@ private:
 
    void mouseWheelMove(const MouseEvent& e, const MouseWheelDetails& wheel) override
    {
+      NoteUserActivity();
       float invert = 1;
       if (wheel.isReversed)
          invert = -1;
@@ -529,6 +627,7 @@ private:
 
    void mouseMagnify(const MouseEvent& e, float scaleFactor) override
    {
+      NoteUserActivity();
       mSynth.MouseMagnify(e.getPosition().x, e.getPosition().y, scaleFactor, e.source);
    }
 
@@ -559,6 +658,8 @@ private:
       }
 #endif
 
+      NoteUserActivity();
+
       int keyCode = key.getTextCharacter();
       if (keyCode < 32 || key.getModifiers().isAltDown())
          keyCode = key.getKeyCode();
@@ -643,7 +744,49 @@ private:
       juce::AudioFormatManager mAudioFormatManager;
    } mGlobalManagers;
 
+   void NoteUserActivity() { mLastUserActivityTime = Time::getMillisecondCounterHiRes(); }
+
+   //with adaptive_framerate on, frames are drawn at the full target rate while the user is doing something or audio is playing,
+   //slow to a trickle once the patch has been sitting still for a bit, and back off when the audio callback is using most of its time
+   bool ShouldRenderFrame()
+   {
+      if (!UserPrefs.adaptive_framerate.Get())
+         return true;
+
+      const double kIdleAfterMs = 2000;
+      const float kIdleFramerate = 10;
+      const float kThrottleAboveAudioLoad = .7f;
+      const float kMinThrottledFramerate = 15;
+
+      double now = Time::getMillisecondCounterHiRes();
+      juce::Point<int> mouse = Desktop::getMousePosition();
+      if (mouse != mLastMousePosition)
+      {
+         mLastMousePosition = mouse;
+         NoteUserActivity();
+      }
+
+      RollingBuffer* recordBuffer = mSynth.GetGlobalRecordBuffer();
+      bool playingAudio = !mSynth.IsAudioPaused() && recordBuffer != nullptr && recordBuffer->GetSamplesSinceSignal() < gSampleRate / 2;
+
+      float targetFramerate = UserPrefs.target_framerate.Get();
+      float framerate = targetFramerate;
+      if (!playingAudio && mPressedKeys.empty() && now - mLastUserActivityTime > kIdleAfterMs)
+         framerate = kIdleFramerate;
+
+      float audioLoad = mGlobalManagers.mDeviceManager.getCpuUsage();
+      if (audioLoad > kThrottleAboveAudioLoad)
+         framerate = MIN(framerate, ofMap(audioLoad, kThrottleAboveAudioLoad, 1, targetFramerate, kMinThrottledFramerate, K(clamp)));
+
+      //the timer ticks at the target rate, so allow half a tick of slack to avoid skipping frames that are only just early
+      if (now - mLastRenderTime < 1000 / framerate - 500 / targetFramerate)
+         return false;
+      mLastRenderTime = now;
+      return true;
+   }
+
    ModularSynth mSynth;
+   std::unique_ptr<BackgroundPluginScan> mBackgroundPluginScan;
 
    NVGcontext* mVG;
    NVGcontext* mFontBoundsVG;
@@ -652,6 +795,9 @@ private:
    std::list<int> mPressedKeys;
    double mPixelRatio;
    juce::Point<int> mScreenPosition;
+   juce::Point<int> mLastMousePosition;
+   double mLastUserActivityTime{ 0 };
+   double mLastRenderTime{ 0 };
    juce::Point<int> mDesiredInitialPosition;
    SpaceMouseMessageWindow mSpaceMouseReader;
 
@@ -663,6 +809,8 @@ private:
       Disconnected
    };
    AudioDeviceConnectionState mAudioDeviceConnectionState{ AudioDeviceConnectionState::None };
+   std::atomic<bool> mWantFinishStartup{ false };
+   std::atomic<bool> mHasRenderedFirstFrame{ false };
 
    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainContentComponent)
 };
@@ -0,0 +1,250 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    MasterLimiter.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "MasterLimiter.h"
+#include "LevelAnalyzer.h"
+#include "SynthGlobals.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace
+{
+   constexpr int kTruePeakPhases = LevelAnalyzer::kTruePeakOversampling;
+   constexpr int kTruePeakTaps = LevelAnalyzer::kTruePeakTaps;
+   constexpr int kTruePeakHistory = kTruePeakTaps - 1;
+}
+
+void MasterLimiter::Prepare(int numChannels, int bufferSize)
+{
+   //only when something changes, so not on a normal buffer
+   bool sampleRateChanged = mSampleRate != gSampleRate;
+   if (sampleRateChanged)
+   {
+      mSampleRate = gSampleRate;
+      mAttackSamples = MAX(1, (int)(kLookaheadMs * gSampleRateMs));
+      //a true peak comes out of the interpolator up to kTruePeakDelay samples after the sample it's next to,
+      //so the hold reaches that much further and the output is delayed that much more
+      mHoldSamples = mAttackSamples + LevelAnalyzer::kTruePeakDelay + 1;
+      mDelaySamples = mHoldSamples - 1;
+      mHoldGains.assign(mHoldSamples, 1);
+      mHoldIndices.assign(mHoldSamples, 0);
+      mAttackRamp.assign(mAttackSamples, 1);
+   }
+
+   if ((int)mChannels.size() < numChannels)
+      mChannels.resize(numChannels);
+   for (auto& channel : mChannels)
+   {
+      if ((int)channel.mDetectorInput.size() < kTruePeakHistory + bufferSize)
+         channel.mDetectorInput.resize(kTruePeakHistory + bufferSize);
+      if ((int)channel.mDelay.size() != mDelaySamples)
+         channel.mDelay.assign(mDelaySamples, 0);
+   }
+   if ((int)mGain.size() < bufferSize)
+   {
+      mGain.resize(bufferSize);
+      mScratch.resize(bufferSize);
+   }
+
+   if (sampleRateChanged)
+      Reset();
+}
+
+void MasterLimiter::Reset()
+{
+   for (auto& channel : mChannels)
+   {
+      std::fill(channel.mDetectorInput.begin(), channel.mDetectorInput.end(), 0);
+      std::fill(channel.mDelay.begin(), channel.mDelay.end(), 0);
+   }
+   mHoldFront = 0;
+   mHoldCount = 0;
+   mEnvelope = 1;
+   std::fill(mAttackRamp.begin(), mAttackRamp.end(), 1);
+   mAttackSum = mAttackSamples;
+   mAttackPos = 0;
+   mGainReduction.store(1, std::memory_order_relaxed);
+}
+
+void MasterLimiter::Analyze(const std::vector<float*>& buffers, int numChannels, int bufferSize, float ceilingDb, float releaseMs)
+{
+   Prepare(numChannels, bufferSize);
+
+   float ceiling = powf(10, ceilingDb / 20);
+   for (int i = 0; i < bufferSize; ++i)
+      mGain[i] = 1;
+   for (int ch = 0; ch < numChannels; ++ch)
+      FindRequiredGain(mChannels[ch], buffers[ch], bufferSize, ceiling);
+
+   //the part that depends on the previous sample: the hold, the release and the attack ramp
+   float releaseCoef = expf(-1 / (MAX(releaseMs, 1.0f) * gSampleRateMs));
+   float lowest = 1;
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      float required = mGain[i];
+      int64_t index = mSampleIndex++;
+
+      //the front of the ring is the lowest gain in the window
+      if (mHoldCount > 0 && mHoldIndices[mHoldFront] <= index - mHoldSamples)
+      {
+         mHoldFront = (mHoldFront + 1) % mHoldSamples;
+         --mHoldCount;
+      }
+      while (mHoldCount > 0 && mHoldGains[(mHoldFront + mHoldCount - 1) % mHoldSamples] >= required)
+         --mHoldCount;
+      int back = (mHoldFront + mHoldCount) % mHoldSamples;
+      mHoldGains[back] = required;
+      mHoldIndices[back] = index;
+      ++mHoldCount;
+      float held = mHoldGains[mHoldFront];
+
+      //down right away, and the ramp below does the smoothing. never above what's held, so the ramp can't overshoot
+      mEnvelope = held < mEnvelope ? held : held + (mEnvelope - held) * releaseCoef;
+
+      mAttackSum += mEnvelope - mAttackRamp[mAttackPos];
+      mAttackRamp[mAttackPos] = mEnvelope;
+      mAttackPos = (mAttackPos + 1) % mAttackSamples;
+
+      mGain[i] = (float)(mAttackSum / mAttackSamples);
+      lowest = MIN(lowest, mGain[i]);
+   }
+
+   //the running sum drifts a little in double, start it over from the ramp every so often
+   if ((mSampleIndex & 0xffff) < bufferSize)
+   {
+      mAttackSum = 0;
+      for (float gain : mAttackRamp)
+         mAttackSum += gain;
+   }
+
+   mGainReduction.store(lowest, std::memory_order_relaxed);
+}
+
+void MasterLimiter::FindRequiredGain(Channel& channel, const float* buffer, int bufferSize, float ceiling)
+{
+   float* input = channel.mDetectorInput.data();
+   BufferCopy(input + kTruePeakHistory, buffer, bufferSize);
+   const float* coefficients = LevelAnalyzer::GetTruePeakCoefficients();
+
+   //the gain each sample needs, ceiling / max(peak, ceiling), where the peak is the sample or the interpolated points before it
+#if defined(__wasm_simd128__)
+   v128_t ceiling4 = wasm_f32x4_splat(ceiling);
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      const float* x = input + kTruePeakHistory + i;
+      v128_t sum4 = wasm_f32x4_splat(0);
+      for (int tap = 0; tap < kTruePeakTaps; ++tap)
+         sum4 = wasm_f32x4_add(sum4, wasm_f32x4_mul(wasm_f32x4_splat(x[-tap]), wasm_v128_load(coefficients + tap * kTruePeakPhases)));
+      v128_t peak4 = wasm_f32x4_pmax(wasm_f32x4_abs(sum4), wasm_f32x4_splat(fabsf(x[0])));
+      v128_t gain4 = wasm_f32x4_div(ceiling4, wasm_f32x4_pmax(peak4, ceiling4));
+      float gain = MIN(MIN(wasm_f32x4_extract_lane(gain4, 0), wasm_f32x4_extract_lane(gain4, 1)), MIN(wasm_f32x4_extract_lane(gain4, 2), wasm_f32x4_extract_lane(gain4, 3)));
+      mGain[i] = MIN(mGain[i], gain);
+   }
+#else
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      const float* x = input + kTruePeakHistory + i;
+      float sum[kTruePeakPhases]{};
+      for (int tap = 0; tap < kTruePeakTaps; ++tap)
+      {
+         for (int phase = 0; phase < kTruePeakPhases; ++phase)
+            sum[phase] += x[-tap] * coefficients[tap * kTruePeakPhases + phase];
+      }
+      float peak = fabsf(x[0]);
+      for (int phase = 0; phase < kTruePeakPhases; ++phase)
+         peak = MAX(peak, fabsf(sum[phase]));
+      mGain[i] = MIN(mGain[i], ceiling / MAX(peak, ceiling));
+   }
+#endif
+
+   memmove(input, input + bufferSize, kTruePeakHistory * sizeof(float));
+}
+
+void MasterLimiter::Apply(int channel, const float* input, float* speakers, float* record, int start, int count) const
+{
+   //the first mDelaySamples of the output come from the last buffer
+   const float* delayed = mChannels[channel].mDelay.data();
+   const float* gain = mGain.data();
+   int end = start + count;
+   int fromDelay = MIN(end, mDelaySamples);
+   for (int i = start; i < fromDelay; ++i)
+   {
+      float sample = delayed[i] * gain[i];
+      if (speakers != nullptr)
+         speakers[i] = sample;
+      if (record != nullptr)
+         record[i - start] = sample;
+   }
+
+   int from = MAX(start, mDelaySamples);
+   if (from >= end)
+      return;
+   if (speakers != nullptr && record != nullptr)
+   {
+      for (int i = from; i < end; ++i)
+      {
+         float sample = input[i - mDelaySamples] * gain[i];
+         speakers[i] = sample;
+         record[i - start] = sample;
+      }
+   }
+   else if (speakers != nullptr)
+   {
+      for (int i = from; i < end; ++i)
+         speakers[i] = input[i - mDelaySamples] * gain[i];
+   }
+   else
+   {
+      for (int i = from; i < end; ++i)
+         record[i - start] = input[i - mDelaySamples] * gain[i];
+   }
+}
+
+void MasterLimiter::EndChannel(int channel, const float* input, int bufferSize)
+{
+   float* delayed = mChannels[channel].mDelay.data();
+   if (bufferSize >= mDelaySamples)
+   {
+      BufferCopy(delayed, input + bufferSize - mDelaySamples, mDelaySamples);
+   }
+   else
+   {
+      memmove(delayed, delayed + bufferSize, (mDelaySamples - bufferSize) * sizeof(float));
+      BufferCopy(delayed + mDelaySamples - bufferSize, input, bufferSize);
+   }
+}
+
+void MasterLimiter::ApplyInPlace(int channel, float* buffer, int bufferSize)
+{
+   BufferCopy(mScratch.data(), buffer, bufferSize);
+   Apply(channel, mScratch.data(), buffer, nullptr, 0, bufferSize);
+   EndChannel(channel, mScratch.data(), bufferSize);
+}
@@ -0,0 +1,84 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    MasterLimiter.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+//the optional brickwall limiter at the very end of ModularSynth::AudioOut(), behind the master_limiter prefs.
+//Analyze() reads every output channel once, finds the sample and true peaks and works out one gain curve for all of them,
+//then Apply() is the output copy itself: it writes the delayed, limited samples straight to the speakers and the record buffer.
+//the curve holds the lowest gain any peak in the lookahead needs and ramps into it over the lookahead, so nothing on the
+//sample grid goes over the ceiling and the inter-sample peaks the interpolator sees don't either
+class MasterLimiter
+{
+public:
+   //audio thread, in this order each buffer: Analyze(), then Apply() across each channel's buffer, then EndChannel() for it
+   void Analyze(const std::vector<float*>& buffers, int numChannels, int bufferSize, float ceilingDb, float releaseMs);
+   void Apply(int channel, const float* input, float* speakers, float* record, int start, int count) const; //speakers or record can be null, neither can be input
+   void EndChannel(int channel, const float* input, int bufferSize);
+   void ApplyInPlace(int channel, float* buffer, int bufferSize); //all three, for when the output goes to the decimator first
+   void Reset();
+
+   int GetLatencySamples() const { return mDelaySamples; }
+   float GetGainReduction() const { return mGainReduction.load(std::memory_order_relaxed); } //any thread. the lowest gain of the last buffer
+
+   static constexpr float kLookaheadMs = 1.5f;
+
+private:
+   struct Channel
+   {
+      std::vector<float> mDetectorInput; //the interpolator's history, then the block
+      std::vector<float> mDelay; //the last mDelaySamples of input, oldest first
+   };
+
+   void Prepare(int numChannels, int bufferSize);
+   void FindRequiredGain(Channel& channel, const float* buffer, int bufferSize, float ceiling); //takes mGain down to what this channel needs
+
+   std::vector<Channel> mChannels;
+   std::vector<float> mGain; //for each sample of the output buffer
+   std::vector<float> mScratch;
+   float mSampleRate{ 0 };
+   int mAttackSamples{ 1 };
+   int mHoldSamples{ 1 };
+   int mDelaySamples{ 0 };
+
+   //the lowest gain over the last mHoldSamples, as a ring of increasing gains with the sample each one came from
+   std::vector<float> mHoldGains;
+   std::vector<int64_t> mHoldIndices;
+   int mHoldFront{ 0 };
+   int mHoldCount{ 0 };
+   int64_t mSampleIndex{ 0 };
+
+   float mEnvelope{ 1 };
+   std::vector<float> mAttackRamp; //the last mAttackSamples of the envelope, averaged
+   double mAttackSum{ 0 };
+   int mAttackPos{ 0 };
+
+   std::atomic<float> mGainReduction{ 1 };
+};
@@ -37,6 +37,8 @@ MidiClockIn::MidiClockIn()
 
 MidiClockIn::~MidiClockIn()
 {
+   if (TheTransport->GetClockSource() == this)
+      TheTransport->SetClockSource(nullptr);
 }
 
 void MidiClockIn::CreateUIControls()
@@ -48,8 +50,14 @@ void MidiClockIn::CreateUIControls()
    DROPDOWN(mTempoRoundModeList, "rounding", ((int*)&mTempoRoundMode), 50);
    FLOATSLIDER(mStartOffsetMsSlider, "start offset ms", &mStartOffsetMs, -300, 300);
    INTSLIDER(mSmoothAmountSlider, "smoothing", &mSmoothAmount, 1, (int)mTempoHistory.size());
+   DROPDOWN(mTrackingModeList, "mode", ((int*)&mTrackingMode), 60);
+   FLOATSLIDER(mBandwidthSlider, "bandwidth", &mBandwidth, .05f, 5);
    ENDUIBLOCK(mWidth, mHeight);
 
+   mTrackingModeList->DrawLabel(true);
+   mTrackingModeList->AddLabel("average", (int)TrackingMode::kAverage);
+   mTrackingModeList->AddLabel("pll", (int)TrackingMode::kPll);
+
    mTempoRoundModeList->DrawLabel(true);
    mTempoRoundModeList->AddLabel("none", (int)TempoRoundMode::kNone);
    mTempoRoundModeList->AddLabel("1", (int)TempoRoundMode::kWhole);
@@ -65,6 +73,8 @@ void MidiClockIn::Init()
    IDrawableModule::Init();
 
    InitDevice();
+
+   TheTransport->SetClockSource(this);
 }
 
 void MidiClockIn::InitDevice()
@@ -88,21 +98,26 @@ float MidiClockIn::GetRoundedTempo()
       avgTempo += mTempoHistory[(mTempoIdx - 1 - i + (int)mTempoHistory.size()) % (int)mTempoHistory.size()];
    avgTempo /= temposToCount;
 
+   return RoundTempo(avgTempo);
+}
+
+float MidiClockIn::RoundTempo(float tempo) const
+{
    switch (mTempoRoundMode)
    {
       case TempoRoundMode::kNone:
-         return avgTempo;
+         return tempo;
       case TempoRoundMode::kWhole:
-         return round(avgTempo);
+         return round(tempo);
       case TempoRoundMode::kHalf:
-         return round(avgTempo * 2) / 2;
+         return round(tempo * 2) / 2;
       case TempoRoundMode::kQuarter:
-         return round(avgTempo * 4) / 4;
+         return round(tempo * 4) / 4;
       case TempoRoundMode::kTenth:
-         return round(avgTempo * 10) / 10;
+         return round(tempo * 10) / 10;
    }
 
-   return avgTempo;
+   return tempo;
 }
 
 void MidiClockIn::DrawModule()
@@ -114,8 +129,16 @@ void MidiClockIn::DrawModule()
    mTempoRoundModeList->Draw();
    mStartOffsetMsSlider->Draw();
    mSmoothAmountSlider->Draw();
+   mTrackingModeList->Draw();
+   mBandwidthSlider->Draw();
+
+   mSmoothAmountSlider->SetShowing(mTrackingMode == TrackingMode::kAverage);
+   mBandwidthSlider->SetShowing(mTrackingMode == TrackingMode::kPll);
 
-   DrawTextNormal("tempo: " + ofToString(GetRoundedTempo()), 4, mHeight - 5);
+   if (mTrackingMode == TrackingMode::kPll)
+      DrawTextNormal("tempo: " + (mPllLocked ? ofToString(mPllTempo, 2) : "-"), 4, mHeight - 5);
+   else
+      DrawTextNormal("tempo: " + ofToString(GetRoundedTempo()), 4, mHeight - 5);
 }
 
 void MidiClockIn::DrawModuleUnclipped()
@@ -143,6 +166,9 @@ void MidiClockIn::OnMidi(const juce::MidiMessage& message)
       if (mDrawDebug)
          AddDebugLine("midi clock " + ofToString(time, 3), kDebugMaxLineCount);
 
+      if (message.isMidiClock())
+         OnPllPulse(time);
+
       if (mReceivedPulseCount == 0)
       {
          double currentTempoDeltaSeconds = 1.0 / (TheTransport->GetTempo() / 60 * 24);
@@ -169,7 +195,7 @@ void MidiClockIn::OnMidi(const juce::MidiMessage& message)
                mTempoHistory[mTempoIdx] = instantTempo;
             mTempoIdx = (mTempoIdx + 1) % mTempoHistory.size();
 
-            if (mEnabled)
+            if (mEnabled && mTrackingMode == TrackingMode::kAverage)
                TheTransport->SetTempo(GetRoundedTempo());
          }
 
@@ -193,6 +219,11 @@ void MidiClockIn::OnMidi(const juce::MidiMessage& message)
             TheSynth->SetAudioPaused(false);
             TheTransport->Reset();
          }
+
+         //the first clock after a start is the downbeat that the transport was just reset to
+         mPllPulseCount = -1;
+         mPllOriginMeasure = ceil(TheTransport->GetMeasureTime(gTime));
+         mPllHasOrigin = true;
       }
    }
    if (message.isMidiStop())
@@ -221,6 +252,11 @@ void MidiClockIn::OnMidi(const juce::MidiMessage& message)
 
       if (mEnabled)
          TheTransport->SetMeasureTime(message.getSongPositionPointerMidiBeat() / TheTransport->GetTimeSigTop() + mStartOffsetMs / TheTransport->MsPerBar());
+
+      //song position is in sixteenths, and the next clock is the one at that position
+      mPllPulseCount = message.getSongPositionPointerMidiBeat() * 6 - 1;
+      mPllOriginMeasure = 0;
+      mPllHasOrigin = true;
    }
    if (message.isQuarterFrame())
    {
@@ -229,6 +265,117 @@ void MidiClockIn::OnMidi(const juce::MidiMessage& message)
    }
 }
 
+//midi thread
+void MidiClockIn::OnPllPulse(double time)
+{
+   const int kMinRequiredPulseCount = 24;
+
+   mRecoveryLoop.SetBandwidth(mBandwidth);
+
+   bool restart = mReceivedPulseCount == 0;
+   int pulses = 1;
+   if (restart)
+   {
+      //starting over, from the current tempo
+      mRecoveryLoop.Reset(time, 60.0 / (TheTransport->GetTempo() * 24));
+      mPllLocked = false;
+   }
+   else
+   {
+      pulses = mRecoveryLoop.Update(time);
+      if (pulses == 0 && mDrawDebug)
+         AddDebugLine("   ignoring pulse at " + ofToString(time, 4), 40);
+   }
+
+   //a start or a song position says exactly which pulse this is. otherwise the phase is picked up from the transport on a restart
+   bool newOrigin = restart || mPllHasOrigin;
+   if (mPllHasOrigin)
+      mPllPulseCount += 1;
+   else if (restart)
+      mPllPulseCount = 0;
+   else
+      mPllPulseCount += pulses;
+
+   if (mReceivedPulseCount >= kMinRequiredPulseCount)
+      mPllLocked = true;
+   PublishPll(newOrigin);
+   mPllHasOrigin = false;
+}
+
+//midi thread
+void MidiClockIn::PublishPll(bool newOrigin)
+{
+   if (newOrigin)
+      ++mPllOriginGeneration;
+
+   uint32_t sequence = mPllSequence.load(std::memory_order_relaxed);
+   mPllSequence.store(sequence + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+   mSharedPulseTime.store(mRecoveryLoop.GetPulseTime(), std::memory_order_relaxed);
+   mSharedPeriod.store(mRecoveryLoop.GetPeriod(), std::memory_order_relaxed);
+   mSharedPulseCount.store(mPllPulseCount, std::memory_order_relaxed);
+   mSharedOriginGeneration.store(mPllOriginGeneration, std::memory_order_relaxed);
+   mSharedOriginMeasure.store(mPllOriginMeasure, std::memory_order_relaxed);
+   mSharedHasOrigin.store(mPllHasOrigin, std::memory_order_relaxed);
+   mPllSequence.store(sequence + 2, std::memory_order_release);
+}
+
+//audio thread
+bool MidiClockIn::GetTargetMeasureTime(double ms, double& measureTime)
+{
+   if (!mEnabled || mTrackingMode != TrackingMode::kPll || !mPllLocked)
+      return false;
+
+   double pulseTime = 0;
+   double period = 0;
+   int pulseCount = 0;
+   int originGeneration = 0;
+   double originMeasure = 0;
+   bool hasOrigin = false;
+   bool read = false;
+   for (int attempt = 0; attempt < 10 && !read; ++attempt)
+   {
+      uint32_t sequence = mPllSequence.load(std::memory_order_acquire);
+      if (sequence & 1)
+         continue;
+      pulseTime = mSharedPulseTime.load(std::memory_order_relaxed);
+      period = mSharedPeriod.load(std::memory_order_relaxed);
+      pulseCount = mSharedPulseCount.load(std::memory_order_relaxed);
+      originGeneration = mSharedOriginGeneration.load(std::memory_order_relaxed);
+      originMeasure = mSharedOriginMeasure.load(std::memory_order_relaxed);
+      hasOrigin = mSharedHasOrigin.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      read = mPllSequence.load(std::memory_order_relaxed) == sequence;
+   }
+   if (!read || period <= 0)
+      return false;
+
+   //where the clock is at the time this buffer will be heard. if the pulses stop, let the transport run on by itself
+   double now = (juce::Time::getMillisecondCounterHiRes() + gBufferSizeMs + mStartOffsetMs) * .001;
+   double sincePulse = now - pulseTime;
+   if (sincePulse > period * 4)
+      return false;
+
+   float tempo = 60 / (period * 24);
+   if (tempo < 20 || tempo > 999)
+      return false;
+   mPllTempo = RoundTempo(tempo);
+   if (abs(TheTransport->GetTempo() - mPllTempo) > .001f)
+      TheTransport->SetTempo(mPllTempo);
+
+   double beats = (pulseCount + sincePulse / period) / 24;
+   double timeSigTop = TheTransport->GetTimeSigTop();
+   if (originGeneration != mAudioOriginGeneration)
+   {
+      //without a start or song position to line up to, pick up from wherever the transport already is
+      mAudioOriginGeneration = originGeneration;
+      mAudioOriginMeasure = hasOrigin ? originMeasure : TheTransport->GetMeasureTime(gTime) + ms / TheTransport->MsPerBar() - beats / timeSigTop;
+   }
+
+   measureTime = mAudioOriginMeasure + beats / timeSigTop;
+   return true;
+}
+
 void MidiClockIn::DropdownUpdated(DropdownList* list, int oldVal, double time)
 {
    if (list == mDeviceList)
@@ -29,6 +29,9 @@
 #include "IDrawableModule.h"
 #include "DropdownList.h"
 #include "Slider.h"
+#include "Transport.h"
+
+#include <atomic>
 
 class IAudioSource;
 
@@ -82,7 +85,73 @@ private:
    }
 };
 
-class MidiClockIn : public IDrawableModule, public IDropdownListener, public MidiDeviceListener, public IFloatSliderListener, public IIntSliderListener
+//recovers a steady pulse train from jittery clock pulses: a second order phase locked loop on the pulse times, with a bandwidth in hz.
+//pulses far from where the loop expects them are ignored (or counted as dropped pulses, if they land a whole number of pulses late),
+//and only a run of them in a row makes it let go and lock again
+class ClockRecoveryLoop
+{
+public:
+   void Reset(double time, double period)
+   {
+      mPulseTime = time;
+      mRawPulseTime = time;
+      mPeriod = period;
+      mOutliersInARow = 0;
+   }
+
+   //how many pulses the loop moved forward by, 0 if this pulse was rejected
+   int Update(double time)
+   {
+      const double kOutlierThreshold = .35; //of a period
+      const int kMaxMissedPulses = 3;
+      const int kMaxOutliersInARow = 6;
+
+      double predicted = mPulseTime + mPeriod;
+      double error = time - predicted;
+      int missedPulses = (int)round(error / mPeriod);
+      if (missedPulses >= 1 && missedPulses <= kMaxMissedPulses && abs(error - missedPulses * mPeriod) < mPeriod * kOutlierThreshold)
+      {
+         predicted += missedPulses * mPeriod;
+         error -= missedPulses * mPeriod;
+      }
+      else
+      {
+         missedPulses = 0;
+      }
+
+      if (abs(error) > mPeriod * kOutlierThreshold)
+      {
+         if (++mOutliersInARow >= kMaxOutliersInARow)
+         {
+            //not an outlier any more, the clock really did move. start again from the spacing of the raw pulses
+            Reset(time, ofClamp(time - mRawPulseTime, mPeriod * .5, mPeriod * 2));
+            return 1;
+         }
+         mRawPulseTime = time;
+         return 0;
+      }
+
+      mOutliersInARow = 0;
+      mRawPulseTime = time;
+      double omega = MIN(2 * juce::MathConstants<double>::pi * mBandwidth * mPeriod, 1);
+      mPulseTime = predicted + juce::MathConstants<double>::sqrt2 * omega * error;
+      mPeriod += omega * omega * error;
+      return 1 + missedPulses;
+   }
+
+   void SetBandwidth(double hz) { mBandwidth = hz; }
+   double GetPulseTime() const { return mPulseTime; } //filtered time of the latest pulse
+   double GetPeriod() const { return mPeriod; }
+
+private:
+   double mBandwidth{ 1 };
+   double mPulseTime{ 0 };
+   double mRawPulseTime{ 0 };
+   double mPeriod{ 1 / 48.0 };
+   int mOutliersInARow{ 0 };
+};
+
+class MidiClockIn : public IDrawableModule, public IDropdownListener, public MidiDeviceListener, public IFloatSliderListener, public IIntSliderListener, public ITransportClockSource
 {
 public:
    MidiClockIn();
@@ -106,6 +175,9 @@ public:
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
    void IntSliderUpdated(IntSlider* slider, int oldVal, double time) override {}
 
+   //ITransportClockSource
+   bool GetTargetMeasureTime(double ms, double& measureTime) override;
+
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
 
@@ -115,11 +187,20 @@ private:
    void InitDevice();
    void BuildDeviceList();
    float GetRoundedTempo();
+   float RoundTempo(float tempo) const;
+   void OnPllPulse(double time);
+   void PublishPll(bool newOrigin);
 
    //IDrawableModule
    void DrawModule() override;
    void DrawModuleUnclipped() override;
 
+   enum class TrackingMode
+   {
+      kAverage,
+      kPll
+   };
+
    enum class TempoRoundMode
    {
       kNone,
@@ -139,6 +220,10 @@ private:
    FloatSlider* mStartOffsetMsSlider{ nullptr };
    int mSmoothAmount{ kMaxHistory / 2 };
    IntSlider* mSmoothAmountSlider{ nullptr };
+   TrackingMode mTrackingMode{ TrackingMode::kAverage };
+   DropdownList* mTrackingModeList{ nullptr };
+   float mBandwidth{ 1 };
+   FloatSlider* mBandwidthSlider{ nullptr };
    bool mObeyClockStartStop{ true };
 
    MidiDevice mDevice;
@@ -148,4 +233,22 @@ private:
    double mLastTimestamp{ -1 };
    int mReceivedPulseCount{ 0 };
    DelayLockedLoop mDelayLockedLoop;
+
+   //pll mode. the loop runs on the midi thread, and hands its state to the audio thread through a sequence number (odd while writing)
+   ClockRecoveryLoop mRecoveryLoop;
+   int mPllPulseCount{ 0 };
+   int mPllOriginGeneration{ 0 };
+   double mPllOriginMeasure{ 0 };
+   bool mPllHasOrigin{ false };
+   std::atomic<uint32_t> mPllSequence{ 0 };
+   std::atomic<double> mSharedPulseTime{ 0 };
+   std::atomic<double> mSharedPeriod{ 0 };
+   std::atomic<int> mSharedPulseCount{ 0 };
+   std::atomic<int> mSharedOriginGeneration{ 0 };
+   std::atomic<double> mSharedOriginMeasure{ 0 };
+   std::atomic<bool> mSharedHasOrigin{ false };
+   std::atomic<bool> mPllLocked{ false };
+   int mAudioOriginGeneration{ -1 };
+   double mAudioOriginMeasure{ 0 };
+   float mPllTempo{ 0 };
 };
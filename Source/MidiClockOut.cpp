@@ -93,8 +93,27 @@ void MidiClockOut::BuildDeviceList()
       mDeviceList->AddLabel(devices[i].c_str(), i);
 }
 
+//the wall clock time that gTime will be heard at, following the sample timeline rather than when each callback happened to run.
+//callbacks come in bursts, so this advances by exactly the audio that was rendered, and only leans gently toward the measured time
+double MidiClockOut::UpdateTimelineWallMs()
+{
+   const double kMaxDriftMs = 50;
+   const double kCorrection = .01;
+
+   double measuredWallMs = juce::Time::getMillisecondCounterHiRes() + gBufferSizeMs;
+   double predictedWallMs = mTimelineWallMs + (gTime - mTimelineTime);
+   if (mTimelineWallMs < 0 || abs(measuredWallMs - predictedWallMs) > kMaxDriftMs)
+      mTimelineWallMs = measuredWallMs; //started, or audio stalled or was paused
+   else
+      mTimelineWallMs = predictedWallMs + (measuredWallMs - predictedWallMs) * kCorrection;
+   mTimelineTime = gTime;
+   return mTimelineWallMs;
+}
+
 void MidiClockOut::OnTransportAdvanced(float amount)
 {
+   double timelineWallMs = UpdateTimelineWallMs();
+
    if (mEnabled)
    {
       int pulsesPerBeat = 24;
@@ -115,14 +134,15 @@ void MidiClockOut::OnTransportAdvanced(float amount)
       double pulseMs = TheTransport->GetDuration(kInterval_4n) / pulsesPerBeat;
       for (int i = 0; i < pulses; ++i)
       {
+         double pulseWallMs = timelineWallMs + (distToFirstPulse + i) * pulseMs;
          if (mClockStartQueued && (int(oldPulse) + i) % pulsesPerMeasure == 0)
          {
-            mDevice.SendMessage(gTime + (distToFirstPulse + i) * pulseMs, juce::MidiMessage::midiStart());
+            mDevice.SendMessageAtWallTime(pulseWallMs, juce::MidiMessage::midiStart());
             mClockStartQueued = false;
          }
          else
          {
-            mDevice.SendMessage(gTime + (distToFirstPulse + i) * pulseMs, juce::MidiMessage::midiClock());
+            mDevice.SendMessageAtWallTime(pulseWallMs, juce::MidiMessage::midiClock());
          }
       }
    }
@@ -64,6 +64,7 @@ public:
 private:
    void InitDevice();
    void BuildDeviceList();
+   double UpdateTimelineWallMs();
 
    //IDrawableModule
    void DrawModule() override;
@@ -85,4 +86,7 @@ private:
    DropdownList* mMultiplierSelector{ nullptr };
 
    MidiDevice mDevice{ nullptr };
+
+   double mTimelineWallMs{ -1 };
+   double mTimelineTime{ 0 };
 };
@@ -39,6 +39,7 @@
 #include "ScriptModule.h"
 #include "Push2Control.h"
 #include "QwertyController.h"
+#include "UserPrefs.h"
 
 using namespace juce;
 
@@ -113,6 +114,7 @@ void MidiController::Init()
    for (auto i = mConnections.begin(); i != mConnections.end(); ++i)
       delete *i;
    mConnections.clear();
+   ConnectionsChanged();
 
    mHasCreatedConnectionUIControls = false;
 
@@ -167,6 +169,7 @@ UIControlConnection* MidiController::AddControlConnection(MidiMessageType messag
 
    connection->CreateUIControls((int)mConnections.size());
    mConnections.push_back(connection);
+   ConnectionsChanged();
    if (uicontrol != nullptr)
       uicontrol->AddRemoteController();
 
@@ -279,6 +282,7 @@ void MidiController::AddControlConnection(const ofxJSONElement& connection)
 
       //controlConnection->CreateUIControls(this, mConnections.size()); //do this on the first draw instead, to avoid a long init time when setting up a bunch of minimized controllers
       mConnections.push_back(controlConnection);
+      ConnectionsChanged();
 
       if (!connection["pages"].isNull())
       {
@@ -293,6 +297,7 @@ void MidiController::AddControlConnection(const ofxJSONElement& connection)
                nextPageConnection->mEditorControls.clear(); //TODO(Ryan) temp fix
                nextPageConnection->CreateUIControls((int)mConnections.size());
                mConnections.push_back(nextPageConnection);
+               ConnectionsChanged();
                uicontrolNextPage->AddRemoteController();
             }
          }
@@ -308,71 +313,74 @@ void MidiController::OnTransportAdvanced(float amount)
 {
    PROFILER(MidiController);
 
-   mQueuedMessageMutex.lock();
-
    double firstNoteTimestampMs = -1;
    double lastPlayTime = -1;
-   for (auto note = mQueuedNotes.begin(); note != mQueuedNotes.end(); ++note)
+   QueuedNote queued;
+   while (mQueuedNotes.try_dequeue(queued))
    {
+      MidiNote& note = queued.mNote;
       int voiceIdx = -1;
 
       if (mUseChannelAsVoice)
-         voiceIdx = note->mChannel - 1;
+         voiceIdx = note.mChannel - 1;
 
       //TODO(Ryan) how can I use note->mTimestamp to get more accurate timing for midi input?
       //this here is not accurate, but prevents notes played within the same buffer from having the exact same time
       double playTime;
-      if (firstNoteTimestampMs == -1) //this is the first note
+      if (queued.mTime != -1) //placed by when it came in, in OnMidiNote()
+      {
+         playTime = MAX(queued.mTime, gTime);
+         if (playTime <= lastPlayTime)
+            playTime = lastPlayTime + .01; //keep note on/off pairs at the same timestamp in order
+      }
+      else if (firstNoteTimestampMs == -1) //this is the first note
       {
-         firstNoteTimestampMs = note->mTimestampMs;
+         firstNoteTimestampMs = note.mTimestampMs;
          playTime = gTime;
       }
       else
       {
-         playTime = gTime + (note->mTimestampMs - firstNoteTimestampMs);
+         playTime = gTime + (note.mTimestampMs - firstNoteTimestampMs);
          if (playTime <= lastPlayTime)
             playTime += .01; //hack to handle note on/off in the same frame
       }
       lastPlayTime = playTime;
-      PlayNoteOutput(NoteMessage(playTime, note->mPitch + mNoteOffset, MIN(127, note->mVelocity * mVelocityMult), voiceIdx, ModulationParameters(mModulation.GetPitchBend(voiceIdx), mModulation.GetModWheel(voiceIdx), mModulation.GetPressure(voiceIdx), 0)));
+      PlayNoteOutput(NoteMessage(playTime, note.mPitch + mNoteOffset, MIN(127, note.mVelocity * mVelocityMult), voiceIdx, ModulationParameters(mModulation.GetPitchBend(voiceIdx), mModulation.GetModWheel(voiceIdx), mModulation.GetPressure(voiceIdx), 0)));
 
       for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiNote(*note);
+         (*i)->OnMidiNote(note);
    }
-   mQueuedNotes.clear();
 
-   for (auto ctrl = mQueuedControls.begin(); ctrl != mQueuedControls.end(); ++ctrl)
+   MidiControl control;
+   while (mQueuedControls.try_dequeue(control))
    {
       if (mSendCCOutput)
       {
          int voiceIdx = -1;
 
          if (mUseChannelAsVoice)
-            voiceIdx = ctrl->mChannel - 1;
+            voiceIdx = control.mChannel - 1;
 
-         SendCCOutput(ctrl->mControl, ctrl->mValue, voiceIdx);
+         SendCCOutput(control.mControl, control.mValue, voiceIdx);
       }
 
       for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiControl(*ctrl);
+         (*i)->OnMidiControl(control);
    }
-   mQueuedControls.clear();
 
-   for (auto note = mQueuedProgramChanges.begin(); note != mQueuedProgramChanges.end(); ++note)
+   MidiProgramChange programChange;
+   while (mQueuedProgramChanges.try_dequeue(programChange))
    {
       for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiProgramChange(*note);
+         (*i)->OnMidiProgramChange(programChange);
    }
-   mQueuedProgramChanges.clear();
 
-   for (auto note = mQueuedPitchBends.begin(); note != mQueuedPitchBends.end(); ++note)
+   MidiPitchBend pitchBend;
+   while (mQueuedPitchBends.try_dequeue(pitchBend))
    {
       for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiPitchBend(*note);
+         (*i)->OnMidiPitchBend(pitchBend);
    }
-   mQueuedPitchBends.clear();
-
-   mQueuedMessageMutex.unlock();
 }
 
 void MidiController::OnMidiNote(MidiNote& note)
@@ -388,8 +396,17 @@ void MidiController::OnMidiNote(MidiNote& note)
 
    MidiReceived(kMidiMessage_Note, note.mPitch, note.mVelocity / 127.0f, note.mVelocity, note.mChannel);
 
+   QueuedNote queued;
+   queued.mNote = note;
+   if (UserPrefs.timestamped_midi_input.Get())
+   {
+      //keep the device's timing within the buffer, rather than everything since the last buffer landing at its start.
+      //notes without a timestamp (qwerty, osc, monome) are placed by when they got here instead
+      queued.mTime = note.mTimestampMs > 0 ? GetTimeForEventAt(note.mTimestampMs) : GetTimeForImmediateEvent();
+   }
+
    mQueuedMessageMutex.lock();
-   mQueuedNotes.push_back(note);
+   mQueuedNotes.enqueue(queued);
    mQueuedMessageMutex.unlock();
 
    if (mPrintInput)
@@ -417,7 +434,7 @@ void MidiController::OnMidiControl(MidiControl& control)
    MidiReceived(kMidiMessage_Control, control.mControl, control.mValue / 127.0f, control.mValue, control.mChannel);
 
    mQueuedMessageMutex.lock();
-   mQueuedControls.push_back(control);
+   mQueuedControls.enqueue(control);
    mQueuedMessageMutex.unlock();
 
    if (mPrintInput)
@@ -447,7 +464,7 @@ void MidiController::OnMidiProgramChange(MidiProgramChange& program)
    MidiReceived(kMidiMessage_Program, program.mProgram, 1, 1, program.mChannel);
 
    mQueuedMessageMutex.lock();
-   mQueuedProgramChanges.push_back(program);
+   mQueuedProgramChanges.enqueue(program);
    mQueuedMessageMutex.unlock();
 
    if (mPrintInput)
@@ -473,7 +490,7 @@ void MidiController::OnMidiPitchBend(MidiPitchBend& pitchBend)
    MidiReceived(kMidiMessage_PitchBend, MIDI_PITCH_BEND_CONTROL_NUM, pitchBend.mValue / 16383.0f, pitchBend.mValue, pitchBend.mChannel); //16383 = max pitch bend
 
    mQueuedMessageMutex.lock();
-   mQueuedPitchBends.push_back(pitchBend);
+   mQueuedPitchBends.enqueue(pitchBend);
    mQueuedMessageMutex.unlock();
 
    if (mPrintInput)
@@ -565,120 +582,18 @@ void MidiController::MidiReceived(MidiMessageType messageType, int control, floa
       }
    }
 
-   for (auto i = mConnections.begin(); i != mConnections.end(); ++i)
-   {
-      UIControlConnection* connection = *i;
-      if (connection->mMessageType == messageType &&
-          (connection->mControl == control || messageType == kMidiMessage_PitchBend) &&
-          (connection->mPageless || connection->mPage == mControllerPage) &&
-          (connection->mChannel == -1 || connection->mChannel == channel))
-      {
-         float controlValueRange = 127.0f;
-         if (connection->m14BitMode &&
-             messageType == kMidiMessage_Control &&
-             control - 32 >= 0) //in 14-bit mode, the most sigificant bit comes from the control 32 higher, so this control must be at least 32
-         {
-            controlValueRange = 16383.0f;
-
-            float mostSignificantBitValue = GetLayoutControl(control - 32, kMidiMessage_Control).mLastValue;
-            int MSB = mostSignificantBitValue * 127.0f;
-            int LSB = value * 127.0f;
-            int combined = (MSB << 7) + LSB;
-            value = combined / controlValueRange;
-         }
+   if (mConnectionIndexDirty.exchange(false))
+      RebuildConnectionIndex();
 
-         mLastActivityBound = true;
-         //if (value > 0)
-         connection->mLastActivityTime = gTime;
-
-         IUIControl* uicontrol = connection->GetUIControl();
-         if (uicontrol == nullptr)
-            continue;
-
-         if (mShowActivityUIOverlay)
-         {
-            sLastActivityUIControl = uicontrol;
-            sLastConnectedActivityTime = gTime;
-         }
-
-         if (connection->mType == kControlType_Slider)
-         {
-            if (connection->mIncrementAmount != 0)
-            {
-               float curValue = uicontrol->GetMidiValue();
-               float increment = connection->mIncrementAmount / 100;
-               if (GetKeyModifiers() & kModifier_Shift)
-                  increment /= 50;
-               const float midpoint = ceil(controlValueRange / 2) / controlValueRange;
-               if (value != midpoint)
-               {
-                  float change = (value - midpoint);
-                  //float sign = change > 0 ? 1 : -1;
-                  //change = sign * sqrtf(fabsf(change)); //make response fall off for bigger changes
-                  curValue += (increment * 127.0f) * change;
-                  uicontrol->SetFromMidiCC(curValue, NextBufferTime(false), false);
-               }
-            }
-            else
-            {
-               if (connection->mMessageType == kMidiMessage_Note)
-                  value = value > 0 ? 1 : 0;
-               if (connection->mScaleOutput && (connection->mMidiOffValue != 0 || connection->mMidiOnValue != controlValueRange))
-                  value = ofLerp(connection->mMidiOffValue / controlValueRange, connection->mMidiOnValue / controlValueRange, value);
-               uicontrol->SetFromMidiCC(value, NextBufferTime(false), false);
-            }
-            uicontrol->StartBeacon();
-         }
-         else if (connection->mType == kControlType_Toggle)
-         {
-            if (value > 0)
-            {
-               float val = uicontrol->GetMidiValue();
-               uicontrol->SetValue(val == 0, NextBufferTime(false));
-               uicontrol->StartBeacon();
-            }
-         }
-         else if (connection->mType == kControlType_SetValue)
-         {
-            if (value > 0 || mUseNegativeEdge)
-            {
-               if (connection->mIncrementAmount != 0)
-               {
-                  const float midpoint = ceil(controlValueRange / 2) / controlValueRange;
-                  if (value > midpoint)
-                     uicontrol->Increment(connection->mIncrementAmount);
-                  else
-                     uicontrol->Increment(-connection->mIncrementAmount);
-               }
-               else
-               {
-                  uicontrol->SetValue(connection->mValue, NextBufferTime(false), K(forceUpdate));
-               }
-               uicontrol->StartBeacon();
-            }
-         }
-         else if (connection->mType == kControlType_SetValueOnRelease)
-         {
-            if (value == 0)
-            {
-               if (connection->mIncrementAmount != 0)
-                  uicontrol->Increment(connection->mIncrementAmount);
-               else
-                  uicontrol->SetValue(connection->mValue, NextBufferTime(false), K(forceUpdate));
-               uicontrol->StartBeacon();
-            }
-         }
-         else if (connection->mType == kControlType_Direct)
-         {
-            uicontrol->SetValue(rawValue, NextBufferTime(false), K(forceUpdate));
-            uicontrol->StartBeacon();
-         }
-
-         if (!mSendTwoWayOnChange)
-            connection->mLastControlValue = int(uicontrol->GetMidiValue() * controlValueRange); //set expected value here, so we don't send the value. otherwise, this will send the input value right back as output. (although, this behavior is desirable for some controllers, hence mSendTwoWayOnChange)
-
-         if (mResendFeedbackOnRelease && value == 0)
-            connection->mLastControlValue = -999; //force feedback update on release
+   auto connections = mConnectionIndex.find(GetConnectionKey(messageType, control));
+   if (connections != mConnectionIndex.end())
+   {
+      for (auto* connection : connections->second)
+      {
+         //pages and channels have wildcards, so they're checked here instead of being part of the key
+         if ((connection->mPageless || connection->mPage == mControllerPage) &&
+             (connection->mChannel == -1 || connection->mChannel == channel))
+            ApplyConnection(connection, messageType, control, value, rawValue);
       }
    }
 
@@ -710,6 +625,135 @@ void MidiController::MidiReceived(MidiMessageType messageType, int control, floa
       script->MidiReceived(messageType, control, value, channel);
 }
 
+//static
+uint64_t MidiController::GetConnectionKey(MidiMessageType messageType, int control)
+{
+   if (messageType == kMidiMessage_PitchBend)
+      control = 0; //there's only one pitch bend, whatever control number it was saved with
+   return ((uint64_t)messageType << 32) | (uint32_t)control;
+}
+
+void MidiController::RebuildConnectionIndex()
+{
+   for (auto& bucket : mConnectionIndex)
+      bucket.second.clear();
+   for (auto* connection : mConnections)
+      mConnectionIndex[GetConnectionKey(connection->mMessageType, connection->mControl)].push_back(connection);
+}
+
+void MidiController::ApplyConnection(UIControlConnection* connection, MidiMessageType messageType, int control, float& value, int rawValue)
+{
+   float controlValueRange = 127.0f;
+   if (connection->m14BitMode &&
+       messageType == kMidiMessage_Control &&
+       control - 32 >= 0) //in 14-bit mode, the most sigificant bit comes from the control 32 higher, so this control must be at least 32
+   {
+      controlValueRange = 16383.0f;
+
+      float mostSignificantBitValue = GetLayoutControl(control - 32, kMidiMessage_Control).mLastValue;
+      int MSB = mostSignificantBitValue * 127.0f;
+      int LSB = value * 127.0f;
+      int combined = (MSB << 7) + LSB;
+      value = combined / controlValueRange;
+   }
+
+   mLastActivityBound = true;
+   //if (value > 0)
+   connection->mLastActivityTime = gTime;
+
+   IUIControl* uicontrol = connection->GetUIControl();
+   if (uicontrol == nullptr)
+      return;
+
+   if (uicontrol->GetModuleParent() != nullptr)
+      uicontrol->GetModuleParent()->MarkStateDirty();
+
+   if (mShowActivityUIOverlay)
+   {
+      sLastActivityUIControl = uicontrol;
+      sLastConnectedActivityTime = gTime;
+   }
+
+   if (connection->mType == kControlType_Slider)
+   {
+      if (connection->mIncrementAmount != 0)
+      {
+         float curValue = uicontrol->GetMidiValue();
+         float increment = connection->mIncrementAmount / 100;
+         if (GetKeyModifiers() & kModifier_Shift)
+            increment /= 50;
+         const float midpoint = ceil(controlValueRange / 2) / controlValueRange;
+         if (value != midpoint)
+         {
+            float change = (value - midpoint);
+            //float sign = change > 0 ? 1 : -1;
+            //change = sign * sqrtf(fabsf(change)); //make response fall off for bigger changes
+            curValue += (increment * 127.0f) * change;
+            uicontrol->SetFromMidiCC(curValue, NextBufferTime(false), false);
+         }
+      }
+      else
+      {
+         if (connection->mMessageType == kMidiMessage_Note)
+            value = value > 0 ? 1 : 0;
+         if (connection->mScaleOutput && (connection->mMidiOffValue != 0 || connection->mMidiOnValue != controlValueRange))
+            value = ofLerp(connection->mMidiOffValue / controlValueRange, connection->mMidiOnValue / controlValueRange, value);
+         uicontrol->SetFromMidiCC(value, NextBufferTime(false), false);
+      }
+      uicontrol->StartBeacon();
+   }
+   else if (connection->mType == kControlType_Toggle)
+   {
+      if (value > 0)
+      {
+         float val = uicontrol->GetMidiValue();
+         uicontrol->SetValue(val == 0, NextBufferTime(false));
+         uicontrol->StartBeacon();
+      }
+   }
+   else if (connection->mType == kControlType_SetValue)
+   {
+      if (value > 0 || mUseNegativeEdge)
+      {
+         if (connection->mIncrementAmount != 0)
+         {
+            const float midpoint = ceil(controlValueRange / 2) / controlValueRange;
+            if (value > midpoint)
+               uicontrol->Increment(connection->mIncrementAmount);
+            else
+               uicontrol->Increment(-connection->mIncrementAmount);
+         }
+         else
+         {
+            uicontrol->SetValue(connection->mValue, NextBufferTime(false), K(forceUpdate));
+         }
+         uicontrol->StartBeacon();
+      }
+   }
+   else if (connection->mType == kControlType_SetValueOnRelease)
+   {
+      if (value == 0)
+      {
+         if (connection->mIncrementAmount != 0)
+            uicontrol->Increment(connection->mIncrementAmount);
+         else
+            uicontrol->SetValue(connection->mValue, NextBufferTime(false), K(forceUpdate));
+         uicontrol->StartBeacon();
+      }
+   }
+   else if (connection->mType == kControlType_Direct)
+   {
+      uicontrol->SetValue(rawValue, NextBufferTime(false), K(forceUpdate));
+      uicontrol->StartBeacon();
+   }
+
+   if (!mSendTwoWayOnChange)
+      connection->mLastControlValue = int(uicontrol->GetMidiValue() * controlValueRange); //set expected value here, so we don't send the value. otherwise, this will send the input value right back as output. (although, this behavior is desirable for some controllers, hence mSendTwoWayOnChange)
+
+   if (mResendFeedbackOnRelease && value == 0)
+      connection->mLastControlValue = -999; //force feedback update on release
+}
+
 void MidiController::OnKeyPressed(int key, bool isRepeat)
 {
    if (mEnabled && !isRepeat)
@@ -758,6 +802,7 @@ void MidiController::RemoveConnection(int control, MidiMessageType messageType,
          removed = (*i)->mUIControl;
          delete *i;
          i = mConnections.erase(i);
+         ConnectionsChanged();
          break;
       }
    }
@@ -1650,6 +1695,27 @@ void MidiController::SendSysEx(int page, std::string data)
    }
 }
 
+//a batch of notes and ccs, like a frame of lights. a nonstandard controller gets them one at a time
+void MidiController::SendMessages(int page, const juce::MidiBuffer& messages)
+{
+   if (page == mControllerPage)
+   {
+      mDevice.SendMessagesNow(messages);
+
+      if (mNonstandardController)
+      {
+         for (const auto metadata : messages)
+         {
+            juce::MidiMessage message = metadata.getMessage();
+            if (message.isNoteOnOrOff())
+               mNonstandardController->SendValue(page, message.getNoteNumber(), message.getVelocity() / 127.0f, false, message.getChannel());
+            else if (message.isController())
+               mNonstandardController->SendValue(page, message.getControllerNumber(), message.getControllerValue() / 127.0f, false, message.getChannel());
+         }
+      }
+   }
+}
+
 UIControlConnection* MidiController::GetConnectionForControl(MidiMessageType messageType, int control)
 {
    for (auto i = mConnections.begin(); i != mConnections.end(); ++i)
@@ -1994,6 +2060,7 @@ void MidiController::ButtonClicked(ClickButton* button, double time)
       if (button == connection->mRemoveButton)
       {
          mConnections.remove(connection);
+         ConnectionsChanged();
          delete connection;
          break;
       }
@@ -2002,6 +2069,7 @@ void MidiController::ButtonClicked(ClickButton* button, double time)
          UIControlConnection* copy = connection->MakeCopy();
          copy->CreateUIControls((int)mConnections.size());
          mConnections.push_back(copy); //make a copy of this one
+         ConnectionsChanged();
          break;
       }
    }
@@ -2009,6 +2077,7 @@ void MidiController::ButtonClicked(ClickButton* button, double time)
 
 void MidiController::DropdownUpdated(DropdownList* list, int oldVal, double time)
 {
+   ConnectionsChanged(); //a connection's message type might have been edited
    if (list == mPageSelector)
    {
       SetEntirePageToZero(oldVal);
@@ -2077,6 +2146,7 @@ void MidiController::TextEntryActivated(TextEntry* entry)
 
 void MidiController::TextEntryComplete(TextEntry* entry)
 {
+   ConnectionsChanged(); //a connection's control number might have been edited
    for (auto iter = mConnections.begin(); iter != mConnections.end(); ++iter)
    {
       UIControlConnection* connection = *iter;
@@ -2184,6 +2254,7 @@ void MidiController::PostRepatch(PatchCableSource* cableSource, bool fromUserCli
            uiConnection->mUIControlPathInput[0] != 0))
       {
          mConnections.remove(uiConnection);
+         ConnectionsChanged();
          delete uiConnection;
       }
    }
@@ -37,6 +37,11 @@
 #include "ModulationChain.h"
 #include "INoteSource.h"
 
+#include "readerwriterqueue.h"
+
+#include <atomic>
+#include <unordered_map>
+
 #define MIDI_PITCH_BEND_CONTROL_NUM 999
 #define MIDI_PAGE_WIDTH 1000
 #define MAX_MIDI_PAGES 32
@@ -301,6 +306,8 @@ public:
    void SendPitchBend(int page, int bend, int channel = -1);
    void SendData(int page, unsigned char a, unsigned char b, unsigned char c);
    void SendSysEx(int page, std::string data);
+   void SendMessages(int page, const juce::MidiBuffer& messages);
+   int GetOutChannel() const { return mOutChannel; }
 
    INonstandardController* GetNonstandardController() { return mNonstandardController; }
 
@@ -376,8 +383,18 @@ private:
    bool MouseMoved(float x, float y) override;
 
    void ConnectDevice();
+   struct QueuedNote
+   {
+      MidiNote mNote;
+      double mTime{ -1 }; //when to play it, or -1 to play it at the start of the buffer it's taken in
+   };
+
    void MidiReceived(MidiMessageType messageType, int control, float scaledValue, int rawValue, int channel);
    void RemoveConnection(int control, MidiMessageType messageType, int channel, int page);
+   void ApplyConnection(UIControlConnection* connection, MidiMessageType messageType, int control, float& value, int rawValue);
+   void ConnectionsChanged() { mConnectionIndexDirty = true; }
+   void RebuildConnectionIndex();
+   static uint64_t GetConnectionKey(MidiMessageType messageType, int control);
    int GetNumConnectionsOnPage(int page);
    void SetEntirePageToZero(int page);
    void BuildControllerList();
@@ -410,6 +427,8 @@ private:
    double mInitialConnectionTime{ 0 };
    ofxJSONElement mConnectionsJson;
    std::list<UIControlConnection*> mConnections;
+   std::unordered_map<uint64_t, std::vector<UIControlConnection*> > mConnectionIndex; //by type and control, in mConnections order. only touched from MidiReceived()
+   std::atomic<bool> mConnectionIndexDirty{ true };
    bool mSendCCOutput{ false };
    bool mUseNegativeEdge{ false }; // for midi toggle, accept on or off as a button press
    bool mSlidersDefaultToIncremental{ false };
@@ -419,10 +438,10 @@ private:
    bool mSendTwoWayOnChange{ true };
    bool mResendFeedbackOnRelease{ false };
    ClickButton* mAddConnectionButton{ nullptr };
-   std::list<MidiNote> mQueuedNotes;
-   std::list<MidiControl> mQueuedControls;
-   std::list<MidiProgramChange> mQueuedProgramChanges;
-   std::list<MidiPitchBend> mQueuedPitchBends;
+   moodycamel::ReaderWriterQueue<QueuedNote> mQueuedNotes{ 256 };
+   moodycamel::ReaderWriterQueue<MidiControl> mQueuedControls{ 1024 };
+   moodycamel::ReaderWriterQueue<MidiProgramChange> mQueuedProgramChanges{ 32 };
+   moodycamel::ReaderWriterQueue<MidiPitchBend> mQueuedPitchBends{ 256 };
    DropdownList* mControllerList{ nullptr };
    Checkbox* mDrawCablesCheckbox{ nullptr };
    MappingDisplayMode mMappingDisplayMode{ MappingDisplayMode::kHide };
@@ -463,5 +482,5 @@ private:
    int mLayoutHeight{ 0 };
    std::vector<GridLayout*> mGrids;
 
-   ofMutex mQueuedMessageMutex;
+   ofMutex mQueuedMessageMutex; //only between the threads pushing into the queues above, OnTransportAdvanced() reads them without it
 };
@@ -26,6 +26,8 @@
 #include "MidiDevice.h"
 #include "SynthGlobals.h"
 #include "ModularSynth.h"
+#include "ReplayCapture.h"
+#include "IDrawableModule.h"
 
 using namespace juce;
 
@@ -281,6 +283,27 @@ void MidiDevice::SendMessage(double time, juce::MidiMessage message)
    }
 }
 
+//for a message whose Time::getMillisecondCounterHiRes() time is already known, rather than worked out from when this was called
+void MidiDevice::SendMessageAtWallTime(double wallMs, juce::MidiMessage message)
+{
+   if (mMidiOut)
+   {
+      juce::MidiBuffer midiBuffer;
+      midiBuffer.addEvent(message, 0);
+
+      mMidiOut->sendBlockOfMessages(midiBuffer, wallMs, gSampleRate);
+   }
+}
+
+//a batch, like a frame of led changes, written out back to back
+void MidiDevice::SendMessagesNow(const juce::MidiBuffer& messages)
+{
+   if (mMidiOut)
+   {
+      mMidiOut->sendBlockOfMessagesNow(messages);
+   }
+}
+
 void MidiDevice::handleIncomingMidiMessage(MidiInput* source, const MidiMessage& message)
 {
    if (TheSynth->IsReady() == false)
@@ -288,6 +311,12 @@ void MidiDevice::handleIncomingMidiMessage(MidiInput* source, const MidiMessage&
 
    if (mListener)
    {
+      if (ReplayCapture::IsCapturing())
+      {
+         if (auto* module = dynamic_cast<IDrawableModule*>(mListener))
+            ReplayCapture::RecordMidi(module->Path(), mDeviceInInfo.name.toRawUTF8(), message);
+      }
+
       MidiDevice::SendMidiMessage(mListener, mDeviceInInfo.name.toRawUTF8(), message);
 
       if (gPrintMidiInput)
@@ -108,6 +108,9 @@ public:
    void SendSysEx(std::string data);
    void SendData(unsigned char a, unsigned char b, unsigned char c);
    void SendMessage(double time, juce::MidiMessage message);
+   void SendMessageAtWallTime(double wallMs, juce::MidiMessage message);
+   void SendMessagesNow(const juce::MidiBuffer& messages);
+   int GetOutputChannel() const { return mOutputChannel; }
 
    static void SendMidiMessage(MidiDeviceListener* listener, const char* deviceName, const juce::MidiMessage& message);
 
@@ -59,26 +59,105 @@ void Minimap::GetDimensionsMinimap(float& width, float& height)
    }
 }
 
-void Minimap::ComputeBoundingBox(ofRectangle& rect)
+namespace
 {
-   std::vector<IDrawableModule*> modules;
-   TheSynth->GetRootContainer()->GetAllModules(modules);
+   bool RectsMatch(const ofRectangle& a, const ofRectangle& b)
+   {
+      return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+   }
+}
 
-   if (modules.empty())
+//returns true if the model changed
+bool Minimap::UpdateModel()
+{
+   float width, height;
+   GetDimensionsMinimap(width, height);
+   bool needsRebuild = ModuleContainer::GetModuleListGeneration() != mModuleListGeneration || width != mModelWidth || height != mModelHeight;
+
+   for (int i = 0; i < (int)mTrackedModules.size() && !needsRebuild; ++i)
+   {
+      const TrackedModule& tracked = mTrackedModules[i];
+      if (tracked.mShowing != tracked.mModule->IsShowing() ||
+          tracked.mMinimized != tracked.mModule->Minimized() ||
+          !RectsMatch(tracked.mRect, tracked.mModule->GetRect()))
+         needsRebuild = true;
+   }
+
+   if (needsRebuild)
+      RebuildModel();
+   return needsRebuild;
+}
+
+void Minimap::RebuildModel()
+{
+   mModuleListGeneration = ModuleContainer::GetModuleListGeneration();
+   GetDimensionsMinimap(mModelWidth, mModelHeight);
+
+   mAllModules.clear();
+   TheSynth->GetRootContainer()->GetAllModules(mAllModules);
+
+   mTrackedModules.clear();
+   for (auto* module : mAllModules)
+      mTrackedModules.push_back({ module, module->GetRect(), module->IsShowing(), module->Minimized() });
+
+   //effect chain children aren't in a container, but still need to be watched for moving when their chain changes
+   for (auto* module : mAllModules)
+   {
+      if (dynamic_cast<EffectChain*>(module) != nullptr)
+      {
+         for (auto* effect : module->GetChildren())
+            mTrackedModules.push_back({ effect, effect->GetRect(), effect->IsShowing(), effect->Minimized() });
+      }
+   }
+
+   ComputeBoundingBox(mBoundingBox);
+
+   std::vector<IDrawableModule*> secondPassModules;
+   mEntries.clear();
+   for (auto* module : mAllModules)
+   {
+      if (!module->IsShowing() ||
+          (dynamic_cast<IDrawableModule*>(module->GetParent()) && dynamic_cast<IDrawableModule*>(module->GetParent())->Minimized()))
+      {
+         continue;
+      }
+      if (dynamic_cast<Prefab*>(module->GetParent()) != nullptr || dynamic_cast<EffectChain*>(module->GetParent()) != nullptr)
+      {
+         secondPassModules.push_back(module);
+         continue;
+      }
+      if (dynamic_cast<EffectChain*>(module) != nullptr && !module->GetChildren().empty() && !module->Minimized())
+         for (auto& effect : module->GetChildren())
+            secondPassModules.push_back(effect);
+      mEntries.push_back({ module->GetRect(), module->GetColor(module->GetModuleCategory()) });
+      if (!module->GetChildren().empty())
+         mEntries.back().mColor.a = 127;
+   }
+   for (auto* module : secondPassModules)
+   {
+      mEntries.push_back({ module->GetRect(), module->GetColor(module->GetModuleCategory()) });
+      if (!module->GetChildren().empty())
+         mEntries.back().mColor.a = 127;
+   }
+}
+
+void Minimap::ComputeBoundingBox(ofRectangle& rect)
+{
+   if (mAllModules.empty())
    {
       rect = TheSynth->GetDrawRect();
       return;
    }
 
-   rect = modules[0]->GetRect();
+   rect = mAllModules[0]->GetRect();
 
-   for (int i = 1; i < modules.size(); ++i)
+   for (int i = 1; i < mAllModules.size(); ++i)
    {
-      if (!modules[i]->IsShowing())
+      if (!mAllModules[i]->IsShowing())
       {
          continue;
       }
-      ofRectangle moduleRect = modules[i]->GetRect();
+      ofRectangle moduleRect = mAllModules[i]->GetRect();
       RectUnion(rect, moduleRect);
    }
 
@@ -121,44 +200,16 @@ ofVec2f Minimap::CoordsToViewport(ofRectangle& boundingBox, float x, float y)
 
 void Minimap::DrawModulesOnMinimap(ofRectangle& boundingBox)
 {
-   std::vector<IDrawableModule*> modules;
-   std::vector<IDrawableModule*> second_pass_modules;
-   TheSynth->GetRootContainer()->GetAllModules(modules);
-
    ofPushStyle();
-   for (auto& module : modules)
+   ofFill();
+   for (auto& entry : mEntries)
    {
-      if (!module->IsShowing() ||
-          (dynamic_cast<IDrawableModule*>(module->GetParent()) && dynamic_cast<IDrawableModule*>(module->GetParent())->Minimized()))
-      {
-         continue;
-      }
-      if (dynamic_cast<Prefab*>(module->GetParent()) != nullptr || dynamic_cast<EffectChain*>(module->GetParent()) != nullptr)
-      {
-         second_pass_modules.push_back(module);
-         continue;
-      }
-      if (dynamic_cast<EffectChain*>(module) != nullptr && !module->GetChildren().empty() && !module->Minimized())
-         for (auto& effect : module->GetChildren())
-            second_pass_modules.push_back(effect);
-      DrawModuleOnMinimap(boundingBox, module);
+      ofSetColor(entry.mColor);
+      ofRect(CoordsToMinimap(boundingBox, entry.mRect));
    }
-   for (auto& module : second_pass_modules)
-      DrawModuleOnMinimap(boundingBox, module);
    ofPopStyle();
 }
 
-void Minimap::DrawModuleOnMinimap(ofRectangle& boundingBox, IDrawableModule* module)
-{
-   ofRectangle moduleRect = module->GetRect();
-   ofColor moduleColor(IDrawableModule::GetColor(module->GetModuleCategory()));
-   if (!module->GetChildren().empty())
-      moduleColor.a = 127;
-   ofSetColor(moduleColor);
-   ofFill();
-   ofRect(CoordsToMinimap(boundingBox, moduleRect));
-}
-
 void Minimap::RectUnion(ofRectangle& target, ofRectangle& unionRect)
 {
    float x2 = target.getMaxX();
@@ -189,18 +240,35 @@ void Minimap::RectUnion(ofRectangle& target, ofRectangle& unionRect)
    target.height = fabs(y2) - target.y;
 }
 
-void Minimap::DrawModule()
+void Minimap::PreDrawModule()
+{
+   //runs every frame, even when DrawModule() is being skipped in favor of the cached image
+   ForcePosition();
+   UpdateBookmarkGrid();
+
+   int bookmarkMask = 0;
+   for (int i = 0; i < kNumBookmarks; ++i)
+   {
+      if (TheSynth->GetLocationZoomer()->HasLocation(i + '1'))
+         bookmarkMask |= 1 << i;
+   }
+
+   bool modelChanged = UpdateModel();
+   ofRectangle viewport = TheSynth->GetDrawRect();
+   if (modelChanged || !RectsMatch(viewport, mLastViewport) || bookmarkMask != mLastBookmarkMask)
+   {
+      mLastViewport = viewport;
+      mLastBookmarkMask = bookmarkMask;
+      MarkRenderDirty();
+   }
+}
+
+void Minimap::UpdateBookmarkGrid()
 {
    float width;
    float height;
-   ofRectangle boundingBox;
-   ofRectangle viewport = TheSynth->GetDrawRect();
-   ForcePosition();
-   ComputeBoundingBox(boundingBox);
    GetDimensions(width, height);
 
-   DrawModulesOnMinimap(boundingBox);
-
    for (int i = 0; i < mGrid->GetCols() * mGrid->GetRows(); ++i)
    {
       float val = 0.0f;
@@ -221,6 +289,13 @@ void Minimap::DrawModule()
       mGrid->SetPosition(0, height - kBookmarkSize);
       mGrid->SetGrid(kNumBookmarks, 1);
    }
+}
+
+void Minimap::DrawModule()
+{
+   ofRectangle viewport = TheSynth->GetDrawRect();
+
+   DrawModulesOnMinimap(mBoundingBox);
 
    ofPushMatrix();
    float widthMM;
@@ -229,10 +304,10 @@ void Minimap::DrawModule()
    ofClipWindow(0, 0, widthMM, heightMM, true);
    ofPushStyle();
    ofSetColor(255, 255, 255, 80);
-   ofRect(CoordsToMinimap(boundingBox, viewport));
+   ofRect(CoordsToMinimap(mBoundingBox, viewport));
    ofSetColor(255, 255, 255, 10);
    ofFill();
-   ofRect(CoordsToMinimap(boundingBox, viewport));
+   ofRect(CoordsToMinimap(mBoundingBox, viewport));
    ofPopStyle();
    ofPopMatrix();
 
@@ -277,10 +352,9 @@ void Minimap::OnClicked(float x, float y, bool right)
    }
    else
    {
-      ofRectangle boundingBox;
       ofRectangle viewport = TheSynth->GetDrawRect();
-      ComputeBoundingBox(boundingBox);
-      ofVec2f viewportCoords = CoordsToViewport(boundingBox, x, y);
+      UpdateModel();
+      ofVec2f viewportCoords = CoordsToViewport(mBoundingBox, x, y);
       TheSynth->SetDrawOffset(ofVec2f(-viewportCoords.x + viewport.width / 2, -viewportCoords.y + viewport.height / 2));
       mClick = true;
    }
@@ -295,10 +369,9 @@ bool Minimap::MouseMoved(float x, float y)
 {
    if (mClick)
    {
-      ofRectangle boundingBox;
       ofRectangle viewport = TheSynth->GetDrawRect();
-      ComputeBoundingBox(boundingBox);
-      ofVec2f viewportCoords = CoordsToViewport(boundingBox, x, y);
+      UpdateModel();
+      ofVec2f viewportCoords = CoordsToViewport(mBoundingBox, x, y);
       TheSynth->SetDrawOffset(ofVec2f(-viewportCoords.x + viewport.width / 2, -viewportCoords.y + viewport.height / 2));
    }
    mGrid->NotifyMouseMoved(x, y);
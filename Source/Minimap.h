@@ -45,6 +45,7 @@ public:
 
    void CreateUIControls() override;
    void DrawModule() override;
+   bool CanCacheRendering() const override { return true; }
 
    bool AlwaysOnTop() override { return true; };
    void GetDimensions(float& width, float& height) override;
@@ -54,10 +55,13 @@ private:
    bool IsSingleton() const override { return true; };
    bool HasTitleBar() const override { return false; };
    bool IsSaveable() override { return false; }
+   void PreDrawModule() override;
+   bool UpdateModel();
+   void RebuildModel();
    void ComputeBoundingBox(ofRectangle& rect);
    ofRectangle CoordsToMinimap(ofRectangle& boundingBox, ofRectangle& source);
    void DrawModulesOnMinimap(ofRectangle& boundingBox);
-   void DrawModuleOnMinimap(ofRectangle& boundingBox, IDrawableModule* module);
+   void UpdateBookmarkGrid();
    void RectUnion(ofRectangle& target, ofRectangle& unionRect);
    void OnClicked(float x, float y, bool right) override;
    void MouseReleased() override;
@@ -68,4 +72,27 @@ private:
    bool mClick{ false };
    UIGrid* mGrid{ nullptr };
    GridCell mHoveredBookmarkPos{ -1, -1 };
+
+   //what the minimap was last built from. it's only rebuilt when modules are added, removed, moved, resized, shown or hidden
+   struct TrackedModule
+   {
+      IDrawableModule* mModule{ nullptr };
+      ofRectangle mRect;
+      bool mShowing{ false };
+      bool mMinimized{ false };
+   };
+   struct MinimapEntry
+   {
+      ofRectangle mRect;
+      ofColor mColor;
+   };
+   std::vector<TrackedModule> mTrackedModules;
+   std::vector<MinimapEntry> mEntries;
+   std::vector<IDrawableModule*> mAllModules;
+   ofRectangle mBoundingBox;
+   int mModuleListGeneration{ -1 };
+   float mModelWidth{ 0 };
+   float mModelHeight{ 0 };
+   ofRectangle mLastViewport;
+   int mLastBookmarkMask{ -1 };
 };
@@ -1,4 +1,6 @@
 #include "ModularSynth.h"
+#include "AudioFaultGuard.h"
+#include "AudioThreadPolicy.h"
 #include "IAudioSource.h"
 #include "OpenFrameworksPort.h"
 #include "SynthGlobals.h"
@@ -14,10 +16,18 @@
 #include "ModuleSaveDataPanel.h"
 #include "Profiler.h"
 #include "Sample.h"
+#include "SampleLibrary.h"
+#include "PresetLibrary.h"
+#include "SampleLoader.h"
+#include "AutosaveJournal.h"
+#include "UndoHistory.h"
+#include "ModuleHibernation.h"
+#include "SaveStateChunks.h"
 #include "FloatSliderLFOControl.h"
 //#include <CoreServices/CoreServices.h>
 #include "fenv.h"
 #include <stdlib.h>
+#include <set>
 #include "GridController.h"
 #include "FileStream.h"
 #include "PatchCable.h"
@@ -36,6 +46,15 @@
 #include "ClickButton.h"
 #include "UserPrefs.h"
 #include "NoteOutputQueue.h"
+#include "ControlChangeQueue.h"
+#include "RealtimeSanitizer.h"
+#include "ProfilerTrace.h"
+#include "ReplayCapture.h"
+#include "RetroCapture.h"
+#include "SidechainBus.h"
+#include "SpawnIndex.h"
+#include "StartupTimer.h"
+#include "UIControlIndex.h"
 
 #include "juce_audio_processors/juce_audio_processors.h"
 #include "juce_audio_formats/juce_audio_formats.h"
@@ -50,6 +69,36 @@ ModularSynth* TheSynth = nullptr;
 namespace
 {
    juce::String TheClipboard;
+
+   //samples [start, start + count) of the graph output, to the speakers (unless they're fed by the engine's decimator when oversampling)
+   //and to record, if there is one, in a single pass. through the limiter, if there is one
+   void CopyToOutput(const MasterLimiter* limiter, int channel, const float* src, float* speakers, float* record, int start, int count)
+   {
+      if (limiter != nullptr)
+      {
+         limiter->Apply(channel, src, speakers, record, start, count);
+         return;
+      }
+
+      if (speakers == nullptr)
+      {
+         if (record != nullptr)
+            BufferCopy(record, src + start, count);
+      }
+      else if (record != nullptr)
+      {
+         for (int i = 0; i < count; ++i)
+         {
+            float sample = src[start + i];
+            speakers[start + i] = sample;
+            record[i] = sample;
+         }
+      }
+      else
+      {
+         BufferCopy(speakers + start, src + start, count);
+      }
+   }
 }
 
 //static
@@ -65,6 +114,7 @@ int ModularSynth::sLoadingFileSaveStateRev = ModularSynth::kSaveStateRev;
 int ModularSynth::sLastLoadedFileSaveStateRev = ModularSynth::kSaveStateRev;
 std::thread::id ModularSynth::sMainThreadId;
 std::thread::id ModularSynth::sAudioThreadId;
+thread_local bool ModularSynth::sIsOfflineRenderThread = false;
 
 #if BESPOKE_WINDOWS
 LONG WINAPI TopLevelExceptionHandler(PEXCEPTION_POINTERS pExceptionInfo);
@@ -96,7 +146,17 @@ ModularSynth::~ModularSynth()
 {
    DeleteAllModules();
 
+   mEngine.ClearSources();
+   FreeRetiredExecutionPlans();
+
+   SampleLoader::Get().Shutdown();
+   SampleLibrary::Get().Shutdown();
+   PresetLibrary::Get().Shutdown();
+   AutosaveJournal::Get().Shutdown();
+
+   mRetroCapture.reset();
    delete mGlobalRecordBuffer;
+   mModuleFactory.GetSpawnIndex()->Shutdown();
    mAudioPluginFormatManager.reset();
    mKnownPluginList.reset();
 
@@ -232,9 +292,12 @@ void ModularSynth::Setup(juce::AudioDeviceManager* globalAudioDeviceManager, juc
 
    sShouldAutosave = UserPrefs.autosave.Get();
 
-   mIOBufferSize = gBufferSize;
+   mIOBufferSize = gIOBufferSize;
 
-   mGlobalRecordBuffer = new RollingBuffer(UserPrefs.record_buffer_length_minutes.Get() * 60 * gSampleRate);
+   float recordSeconds = UserPrefs.record_buffer_length_minutes.Get() * 60;
+   if (UserPrefs.record_buffer_compressed.Get())
+      recordSeconds = MIN(recordSeconds, RetroCapture::kRawSeconds);
+   mGlobalRecordBuffer = new RollingBuffer(recordSeconds * gSampleRate);
    mGlobalRecordBuffer->SetNumChannels(2);
 
    juce::File(ofToDataPath("savestate")).createDirectory();
@@ -275,6 +338,9 @@ void ModularSynth::Setup(juce::AudioDeviceManager* globalAudioDeviceManager, juc
 
    ResetLayout();
 
+   mEngine.StartWorkers(UserPrefs.audio_worker_threads.Get(), AudioThreadPolicy::ConfigureWorkerThread);
+   Transport::sEventEarlyMs = UserPrefs.event_lookahead_ms.Get();
+
    mConsoleListener = new ConsoleListener();
    mConsoleEntry = new TextEntry(mConsoleListener, "console", 0, 20, 50, mConsoleText);
    mConsoleEntry->SetRequireEnter(true);
@@ -292,10 +358,42 @@ void ModularSynth::LoadResources(void* nanoVG, void* fontBoundsNanoVG)
 
 void ModularSynth::InitIOBuffers(int inputChannelCount, int outputChannelCount)
 {
-   for (int i = 0; i < inputChannelCount; ++i)
-      mInputBuffers.push_back(new float[gBufferSize]);
-   for (int i = 0; i < outputChannelCount; ++i)
-      mOutputBuffers.push_back(new float[gBufferSize]);
+   mEngine.InitIOBuffers(inputChannelCount, outputChannelCount);
+
+   mStagedInput.clear();
+   mStagedInputPointers.clear();
+   if (gBufferSize != mIOBufferSize)
+   {
+      mStagedInput.assign(inputChannelCount, std::vector<float>(mIOBufferSize / UserPrefs.oversampling.Get()));
+      mStagedInputPointers.resize(inputChannelCount);
+   }
+
+   std::vector<OutputRouting::Route> routes;
+   std::string error;
+   if (OutputRouting::Parse(UserPrefs.output_routing.Get(), routes, error))
+      mEngine.SetOutputRouting(routes);
+   else
+      ofLog() << error;
+
+   //the stereo record buffer is the one the lissajous and the rest read, the outputs past it get their own
+   mExtraRecordBuffers.clear();
+   if (UserPrefs.record_all_outputs.Get())
+   {
+      for (int ch = 2; ch < outputChannelCount; ++ch)
+      {
+         mExtraRecordBuffers.push_back(std::make_unique<RollingBuffer>(mGlobalRecordBuffer->Size()));
+         mExtraRecordBuffers.back()->SetNumChannels(1);
+      }
+   }
+
+   mRetroCapture.reset();
+   if (UserPrefs.record_buffer_compressed.Get())
+   {
+      std::vector<RollingBuffer*> sources{ mGlobalRecordBuffer };
+      for (auto& buffer : mExtraRecordBuffers)
+         sources.push_back(buffer.get());
+      mRetroCapture = std::make_unique<RetroCapture>(sources, (std::int64_t)(UserPrefs.record_buffer_length_minutes.Get() * 60 * gSampleRate));
+   }
 }
 
 
@@ -321,6 +419,7 @@ static int sFrameCount = 0;
 void ModularSynth::Poll()
 {
    sMainThreadId = std::this_thread::get_id();
+   ProfilerTrace::Scope trace("Poll", kTraceCategory_Poll);
 
    if (mFatalError == "")
    {
@@ -333,6 +432,16 @@ void ModularSynth::Poll()
          else
             LoadLayoutFromFile(ofToDataPath(UserPrefs.layout.Get()));
          mInitialized = true;
+         StartupTimer::Get().Stage("initial layout");
+         StartupTimer::Get().Finish();
+
+         if (HasStartupBounce())
+         {
+            bool success = Bounce(mStartupBouncePath, mStartupBounceBars, mStartupBounceTempo);
+            mStartupBounceBars = 0;
+            JUCEApplicationBase::getInstance()->setApplicationReturnValue(success ? 0 : 1);
+            JUCEApplicationBase::quit();
+         }
       }
 
       if (mWantReloadInitialLayout)
@@ -340,8 +449,21 @@ void ModularSynth::Poll()
          LoadLayoutFromFile(ofToDataPath(UserPrefs.layout.Get()));
          mWantReloadInitialLayout = false;
       }
+
+      //journal records are cheap, so also write them on a timer rather than only when modules get added
+      const double kJournalAutosaveIntervalMs = 60 * 1000;
+      if (sShouldAutosave && UserPrefs.autosave_journal.Get() && mInitialized && !mIsLoadingState && gTime - mLastAutosaveTime > kJournalAutosaveIntervalMs)
+         DoAutosave();
    }
 
+   AutosaveJournal::Get().Poll();
+   //record a step once a drag is done, rather than part of the way through it
+   bool isMouseHeld = std::any_of(mIsMouseButtonHeld.begin(), mIsMouseButtonHeld.end(), [](bool held) { return held; });
+   UndoHistory::Get().Poll(mInitialized && !mIsLoadingState && mMoveModule == nullptr && !isMouseHeld);
+   if (mInitialized && !mIsLoadingState)
+      ModuleHibernation::Get().Poll();
+   ReplayCapture::Poll();
+
    mZoomer.Update();
 
    if (!mIsLoadingState)
@@ -402,7 +524,7 @@ void ModularSynth::Poll()
          desiredCursor = MouseCursor::NormalCursor;
       }
 
-      if (desiredCursor != sCurrentCursor)
+      if (desiredCursor != sCurrentCursor && mMainComponent != nullptr)
       {
          sCurrentCursor = desiredCursor;
          mMainComponent->setMouseCursor(desiredCursor);
@@ -427,12 +549,14 @@ void ModularSynth::Poll()
    }
    mIsShiftPressed = shiftPressed;
 
-   if (mArrangeDependenciesWhenLoadCompletes && !mIsLoadingState)
+   if (mArrangeDependenciesWhenLoadCompletes && !mIsLoadingState && !mHoldExecutionPlan)
    {
       ArrangeAudioSourceDependencies();
       mArrangeDependenciesWhenLoadCompletes = false;
    }
 
+   FreeRetiredExecutionPlans();
+
    if (gHoveredUIControl != nullptr && gHoveredUIControl->IsShowing() == false)
       gHoveredUIControl = nullptr;
 
@@ -443,6 +567,12 @@ void ModularSynth::DeleteAllModules()
 {
    mModuleContainer.Clear();
 
+   if (mControlChangeQueue != nullptr)
+   {
+      ScopedMutex mutex(&mAudioThreadMutex, "DeleteAllModules()");
+      mControlChangeQueue->Clear(); //it can still be holding sliders of the modules freed below
+   }
+
    for (int i = 0; i < mDeletedModules.size(); ++i)
       delete mDeletedModules[i];
    mDeletedModules.clear();
@@ -503,6 +633,7 @@ void ModularSynth::PanTo(float x, float y)
 
 void ModularSynth::Draw(void* vg)
 {
+   ProfilerTrace::Scope trace("Draw", kTraceCategory_Draw);
    gNanoVG = (NVGcontext*)vg;
 
    ofNoFill();
@@ -533,7 +664,7 @@ void ModularSynth::Draw(void* vg)
    }
 
    if (UserPrefs.draw_background_lissajous.Get())
-      DrawLissajous(mGlobalRecordBuffer, 0, 0, ofGetWidth(), ofGetHeight(), sBackgroundLissajousR, sBackgroundLissajousG, sBackgroundLissajousB, UserPrefs.background_lissajous_autocorrelate.Get());
+      DrawLissajous(mBackgroundLissajousTap, 0, 0, ofGetWidth(), ofGetHeight(), sBackgroundLissajousR, sBackgroundLissajousG, sBackgroundLissajousB);
 
    if (gTime == 1 && mFatalError == "")
    {
@@ -546,6 +677,7 @@ void ModularSynth::Draw(void* vg)
    {
       std::string loading("Bespoke is loading...");
       DrawTextNormal(loading, ofGetWidth() / 2 - GetStringWidth(loading, 28) / 2, ofGetHeight() / 2 - 6, 28);
+      DrawSampleLoadProgress(ofGetWidth() / 2, ofGetHeight() / 2 + 20);
       return;
    }
 
@@ -863,9 +995,29 @@ void ModularSynth::Draw(void* vg)
    }
    ofPopStyle();
 
+   DrawSampleLoadProgress(ofGetWidth() / 2, ofGetHeight() - 30);
+
    ++mFrameCount;
 }
 
+void ModularSynth::DrawSampleLoadProgress(float centerX, float y)
+{
+   if (!SampleLoader::Get().IsBusy())
+      return;
+
+   const float kWidth = 200;
+   ofPushStyle();
+   ofFill();
+   ofSetColor(50, 50, 50, 180);
+   ofRect(centerX - kWidth / 2, y, kWidth, 16);
+   ofSetColor(0, 150, 255, 180);
+   ofRect(centerX - kWidth / 2, y, kWidth * SampleLoader::Get().GetProgress(), 16);
+   ofSetColor(255, 255, 255);
+   std::string progress = "loading samples " + ofToString(SampleLoader::Get().GetNumLoaded()) + "/" + ofToString(SampleLoader::Get().GetNumQueued());
+   DrawTextNormal(progress, centerX - GetStringWidth(progress) / 2, y + 12);
+   ofPopStyle();
+}
+
 void ModularSynth::PostRender()
 {
    mModuleContainer.PostRender();
@@ -967,6 +1119,9 @@ void ModularSynth::Exit()
    mAudioThreadMutex.Lock("exiting");
    mAudioPaused = true;
    mAudioThreadMutex.Unlock();
+   ReplayCapture::Stop();
+   mCallbackMonitor.LogSummary();
+   mEngine.StopWorkers();
    mModuleContainer.Exit();
    DeleteAllModules();
    ofExit();
@@ -984,11 +1139,18 @@ IDrawableModule* ModularSynth::GetLastClickedModule() const
 
 void ModularSynth::KeyPressed(int key, bool isRepeat)
 {
+   ReplayCapture::ScopedControlWatch replayWatch;
    mLastShiftPressTime = -9999; //reset timer for detecing double-shift press, so it doens't happen while typing
 
    if (!isRepeat)
       mHideTooltipsUntilMouseMove = true;
 
+   IUIControl* focusedControl = dynamic_cast<IUIControl*>(IKeyboardFocusListener::GetActiveKeyboardFocus());
+   if (focusedControl != nullptr && focusedControl->GetModuleParent() != nullptr)
+      focusedControl->GetModuleParent()->MarkStateDirty();
+   else if (gHoveredModule != nullptr)
+      gHoveredModule->MarkStateDirty();
+
    if (gHoveredUIControl &&
        IKeyboardFocusListener::GetActiveKeyboardFocus() == nullptr &&
        !isRepeat)
@@ -1154,6 +1316,15 @@ void ModularSynth::KeyPressed(int key, bool isRepeat)
    if (key == 's' && GetKeyModifiers() == kModifier_Command && !isRepeat)
       SaveCurrentState();
 
+   if (key == 'z' && (GetKeyModifiers() & ~kModifier_Shift) == kModifier_Command && mMoveModule == nullptr)
+   {
+      mGroupSelectedModules.clear();
+      if (GetKeyModifiers() & kModifier_Shift)
+         UndoHistory::Get().Redo();
+      else
+         UndoHistory::Get().Undo();
+   }
+
    if (key == 's' && GetKeyModifiers() == (kModifier_Command | kModifier_Shift) && !isRepeat)
       SaveStatePopup();
 
@@ -1389,6 +1560,7 @@ void ModularSynth::MouseMoved(int intX, int intY)
 
 void ModularSynth::MouseDragged(int intX, int intY, int button, const juce::MouseInputSource& source)
 {
+   ReplayCapture::ScopedControlWatch replayWatch;
    float x = GetMouseX(&mModuleContainer);
    float y = GetMouseY(&mModuleContainer);
 
@@ -1645,6 +1817,7 @@ void ModularSynth::MouseDragged(int intX, int intY, int button, const juce::Mous
 
 void ModularSynth::MousePressed(int intX, int intY, int button, const juce::MouseInputSource& source)
 {
+   ReplayCapture::ScopedControlWatch replayWatch;
    bool rightButton = button == 2;
 
    mZoomer.ExitVanityPanningMode();
@@ -1850,6 +2023,7 @@ void ModularSynth::ToggleQuickSpawn()
 
 void ModularSynth::MouseScrolled(float xScroll, float yScroll, bool isSmoothScroll, bool isInvertedScroll, bool canZoomCanvas)
 {
+   ReplayCapture::ScopedControlWatch replayWatch;
    xScroll *= UserPrefs.scroll_multiplier_horizontal.Get();
    yScroll *= UserPrefs.scroll_multiplier_vertical.Get();
 
@@ -1860,6 +2034,8 @@ void ModularSynth::MouseScrolled(float xScroll, float yScroll, bool isSmoothScro
    }
    else if (gHoveredUIControl)
    {
+      if (gHoveredUIControl->GetModuleParent() != nullptr)
+         gHoveredUIControl->GetModuleParent()->MarkStateDirty();
 #if JUCE_WINDOWS
       yScroll += xScroll / 4; //taking advantage of logitech horizontal scroll wheel
 #endif
@@ -2060,6 +2236,8 @@ void ModularSynth::CheckClick(IDrawableModule* clickedModule, float x, float y,
       clickedModule->GetParent()->GetPosition(parentX, parentY);
 
    //do the regular click
+   ModuleHibernation::Get().Touch(clickedModule);
+   clickedModule->MarkStateDirty();
    clickedModule->TestClick(x - parentX, y - parentY, rightButton);
 }
 
@@ -2076,8 +2254,6 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
 
    mDeletedModules.push_back(module);
 
-   mAudioThreadMutex.Lock("delete");
-
    std::list<PatchCable*> cablesToRemove;
    for (auto* cable : mPatchCables)
    {
@@ -2088,8 +2264,12 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
       RemoveFromVector(cable, mPatchCables);
 
    RemoveFromVector(dynamic_cast<IAudioSource*>(module), mSources);
+   RebuildExecutionPlan();
    RemoveFromVector(module, mLissajousDrawers);
+
+   mAudioThreadMutex.Lock("delete");
    TheTransport->RemoveAudioPoller(dynamic_cast<IAudioPoller*>(module));
+   SidechainBus::Get().RemoveModule(module);
    //delete module; TODO(Ryan) deleting is hard... need to clear out everything with a reference to this, or switch to smart pointers
 
    if (module == TheChaosEngine)
@@ -2102,6 +2282,7 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
 
 void ModularSynth::MouseReleased(int intX, int intY, int button, const juce::MouseInputSource& source)
 {
+   ReplayCapture::ScopedControlWatch replayWatch;
    mMousePos.x = intX;
    mMousePos.y = intY;
    mMouseMovedSignificantlySincePressed = source.hasMovedSignificantlySincePressed();
@@ -2147,6 +2328,9 @@ void ModularSynth::MouseReleased(int intX, int intY, int button, const juce::Mou
       }
    }
 
+   if (mLastClickedModule != nullptr)
+      mLastClickedModule->MarkStateDirty(); //for whatever was dragged since the click
+
    mUILayerModuleContainer.MouseReleased();
    mModuleContainer.MouseReleased();
 
@@ -2158,6 +2342,7 @@ void ModularSynth::MouseReleased(int intX, int intY, int button, const juce::Mou
          float moduleX, moduleY;
          module->GetPosition(moduleX, moduleY);
          module->SampleDropped(x - moduleX, y - moduleY, GetHeldSample());
+         module->MarkStateDirty();
       }
       ClearHeldSample();
    }
@@ -2178,13 +2363,16 @@ void ModularSynth::AudioOut(float* const* output, int bufferSize, int nChannels)
 {
    PROFILER(audioOut_total);
 
-   sAudioThreadId = std::this_thread::get_id();
+   if (!sIsOfflineRenderThread) //a bounce renders from the main thread, which mustn't become the audio thread for anything checking after it's done
+      sAudioThreadId = std::this_thread::get_id();
+   uint64_t callbackStartNs = ofGetSystemTimeNanos();
 
-   static bool sFirst = true;
-   if (sFirst)
+   //per thread, a device restart can call us from a new one. the graph workers do the same for themselves
+   static thread_local bool sDenormalsDisabled = false;
+   if (!sDenormalsDisabled)
    {
       FloatVectorOperations::disableDenormalisedNumberSupport();
-      sFirst = false;
+      sDenormalsDisabled = true;
    }
 
    if (mAudioPaused)
@@ -2199,72 +2387,114 @@ void ModularSynth::AudioOut(float* const* output, int bufferSize, int nChannels)
 
    ScopedMutex mutex(&mAudioThreadMutex, "audioOut()");
 
+   if (mRenderingOffline && !sIsOfflineRenderThread)
+   {
+      //a device callback that got this far before a Bounce() started, it waited for the mutex and mustn't interleave with the render
+      for (int ch = 0; ch < nChannels; ++ch)
+         Clear(output[ch], bufferSize);
+      return;
+   }
+
    /////////// AUDIO PROCESSING STARTS HERE /////////////
-   mNoteOutputQueue->Process();
+   ReplayCapture::OnBufferStarted();
+   mEngine.ProcessQueues(NextBufferTime(false));
 
    int oversampling = UserPrefs.oversampling.Get();
 
    assert(bufferSize * oversampling == mIOBufferSize);
-   assert(nChannels == (int)mOutputBuffers.size());
-   assert(mIOBufferSize == gBufferSize); //need to be the same for now
-   //if we want these different, need to fix outBuffer here, and also fix audioIn()
-   //by now, many assumptions will have to be fixed to support mIOBufferSize and gBufferSize diverging
+   assert(nChannels == mEngine.GetNumOutputChannels());
+   assert(mIOBufferSize % gBufferSize == 0);
+   int deviceBlockSize = gBufferSize / oversampling;
    for (int ioOffset = 0; ioOffset < mIOBufferSize; ioOffset += gBufferSize)
    {
-      for (size_t i = 0; i < mOutputBuffers.size(); ++i)
-         Clear(mOutputBuffers[i], mIOBufferSize);
-
-      double elapsed = gInvSampleRateMs * mIOBufferSize;
-      gTime += elapsed;
-      TheTransport->Advance(elapsed);
+      int deviceOffset = ioOffset / oversampling;
+      if (!mStagedInput.empty())
+      {
+         for (size_t ch = 0; ch < mStagedInput.size(); ++ch)
+            mStagedInputPointers[ch] = mStagedInput[ch].data() + deviceOffset;
+         mEngine.ReadInput(mStagedInputPointers.data(), deviceBlockSize, (int)mStagedInputPointers.size(), oversampling);
+      }
 
       //process all audio
-      for (int i = 0; i < mSources.size(); ++i)
-         mSources[i]->Process(gTime);
+      Profiler::UpdateModuleTimingEnabled(UserPrefs.show_module_cpu_usage.Get());
+      AudioFaultGuard::UpdateEnabled(UserPrefs.guard_audio_faults.Get());
+      mEngine.ProcessBuffer();
+      const std::vector<float*>& outputBuffers = mEngine.GetDeviceOutputBuffers();
+
+      //after the routing, so it sees what the device gets
+      bool limit = UserPrefs.master_limiter.Get() && nChannels > 0;
+      if (limit && !mMasterLimiterOn)
+         mMasterLimiter.Reset();
+      mMasterLimiterOn = limit;
+      if (limit)
+         mMasterLimiter.Analyze(outputBuffers, nChannels, gBufferSize, UserPrefs.master_limiter_ceiling_db.Get(), UserPrefs.master_limiter_release_ms.Get());
+      const MasterLimiter* fusedLimiter = (limit && oversampling == 1) ? &mMasterLimiter : nullptr;
 
       if (gTime - mLastClapboardTime < 100)
       {
          for (int ch = 0; ch < nChannels; ++ch)
          {
-            for (int i = 0; i < bufferSize; ++i)
+            for (int i = 0; i < deviceBlockSize; ++i)
             {
                float sample = sin(GetPhaseInc(440) * i) * (1 - ((gTime - mLastClapboardTime) / 100));
-               output[ch][i] = sample;
+               output[ch][deviceOffset + i] = sample;
             }
          }
       }
 
-      //put it into speakers
+      //put it into speakers, and the global record buffer at the full internal rate
       for (int ch = 0; ch < nChannels; ++ch)
       {
-         if (oversampling == 1)
+         float* speakers = (oversampling == 1) ? output[ch] + deviceOffset : nullptr;
+         if (limit && oversampling > 1)
+            mMasterLimiter.ApplyInPlace(ch, outputBuffers[ch], gBufferSize); //the decimator reads the engine's buffer
+         RollingBuffer* record = nullptr;
+         int recordChannel = 0;
+         if (ch < 2)
          {
-            BufferCopy(output[ch], mOutputBuffers[ch], gBufferSize);
-            if (ch < 2)
-               mGlobalRecordBuffer->WriteChunk(output[ch], bufferSize, ch);
+            record = mGlobalRecordBuffer;
+            recordChannel = ch;
+         }
+         else if (ch - 2 < (int)mExtraRecordBuffers.size())
+         {
+            record = mExtraRecordBuffers[ch - 2].get();
+         }
+
+         if (record != nullptr)
+         {
+            RollingBuffer::WriteSpan span = record->GetWriteSpan(gBufferSize, recordChannel);
+            CopyToOutput(fusedLimiter, ch, outputBuffers[ch], speakers, span.mFirst, 0, span.mFirstSize);
+            if (span.mSecondSize > 0)
+               CopyToOutput(fusedLimiter, ch, outputBuffers[ch], speakers, span.mSecond, span.mFirstSize, span.mSecondSize);
+            record->CommitWrite(gBufferSize, recordChannel);
          }
          else
          {
-            for (int sampleIndex = 0; sampleIndex < gBufferSize / oversampling; ++sampleIndex)
-            {
-               output[ch][sampleIndex] = 0;
-               for (int subsampleIndex = 0; subsampleIndex < oversampling; ++subsampleIndex)
-               {
-                  float sample = mOutputBuffers[ch][sampleIndex * oversampling + subsampleIndex];
-                  output[ch][sampleIndex] += sample / oversampling;
-                  if (ch < 2)
-                     mGlobalRecordBuffer->Write(sample, ch);
-               }
-            }
+            CopyToOutput(fusedLimiter, ch, outputBuffers[ch], speakers, nullptr, 0, gBufferSize);
          }
+         if (fusedLimiter != nullptr)
+            mMasterLimiter.EndChannel(ch, outputBuffers[ch], gBufferSize);
+
+         if (oversampling > 1)
+            mEngine.DownsampleOutput(ch, output[ch] + deviceOffset, deviceBlockSize, oversampling);
       }
+
+      if (mRetroCapture != nullptr)
+         mRetroCapture->Write(gBufferSize);
    }
 
    /////////// AUDIO PROCESSING ENDS HERE /////////////
    mRecordingLength += bufferSize * oversampling;
    mRecordingLength = MIN(mRecordingLength, mGlobalRecordBuffer->Size());
 
+   if (UserPrefs.draw_background_lissajous.Get())
+      FillLissajousTap(mBackgroundLissajousTap, mGlobalRecordBuffer, UserPrefs.background_lissajous_autocorrelate.Get());
+
    Profiler::PrintCounters();
+
+   uint64_t callbackEndNs = ofGetSystemTimeNanos();
+   mCallbackMonitor.Record(callbackStartNs, callbackEndNs, mIOBufferSize * gInvSampleRateMs);
+   mCpuGovernor.Record(callbackStartNs, callbackEndNs, mIOBufferSize * gInvSampleRateMs);
 }
 
 void ModularSynth::AudioIn(const float* const* input, int bufferSize, int nChannels)
@@ -2274,37 +2504,23 @@ void ModularSynth::AudioIn(const float* const* input, int bufferSize, int nChann
 
    ScopedMutex mutex(&mAudioThreadMutex, "audioIn()");
 
+   if (mRenderingOffline)
+      return; //the bounce renders without any input
+
    int oversampling = UserPrefs.oversampling.Get();
 
    assert(bufferSize * oversampling == mIOBufferSize);
-   assert(nChannels == (int)mInputBuffers.size());
-
-   for (int i = 0; i < nChannels; ++i)
+   ReplayCapture::RecordAudioInput(input, bufferSize, nChannels);
+   if (mStagedInput.empty())
    {
-      if (oversampling == 1)
-      {
-         BufferCopy(mInputBuffers[i], input[i], bufferSize);
-      }
-      else
-      {
-         for (int sampleIndex = 0; sampleIndex < bufferSize * oversampling; ++sampleIndex)
-         {
-            mInputBuffers[i][sampleIndex] = input[i][sampleIndex / oversampling];
-         }
-      }
+      mEngine.ReadInput(input, bufferSize, nChannels, oversampling);
+   }
+   else
+   {
+      //AudioOut() reads it a block at a time
+      for (int ch = 0; ch < MIN(nChannels, (int)mStagedInput.size()); ++ch)
+         BufferCopy(mStagedInput[ch].data(), input[ch], bufferSize);
    }
-}
-
-float* ModularSynth::GetInputBuffer(int channel)
-{
-   assert(channel >= 0 && channel < mInputBuffers.size());
-   return mInputBuffers[channel];
-}
-
-float* ModularSynth::GetOutputBuffer(int channel)
-{
-   assert(channel >= 0 && channel < mOutputBuffers.size());
-   return mOutputBuffers[channel];
 }
 
 void ModularSynth::TriggerClapboard()
@@ -2333,195 +2549,101 @@ void ModularSynth::FilesDropped(std::vector<std::string> files, int intX, int in
          x -= moduleX;
          y -= moduleY;
          target->FilesDropped(files, x, y);
+         target->MarkStateDirty();
       }
    }
 }
 
-struct SourceDepInfo
-{
-   SourceDepInfo(IAudioSource* me)
-   : mMe(me)
-   {}
-   IAudioSource* mMe;
-   std::vector<IAudioSource*> mDeps;
-};
-
 void ModularSynth::ArrangeAudioSourceDependencies()
 {
-   if (mIsLoadingState)
+   if (mIsLoadingState || mHoldExecutionPlan)
    {
       mArrangeDependenciesWhenLoadCompletes = true;
       return;
    }
 
-   //ofLog() << "Calculating audio source dependencies:";
-
-   std::vector<SourceDepInfo> deps;
-   for (int i = 0; i < mSources.size(); ++i)
-      deps.push_back(SourceDepInfo(mSources[i]));
-
-   for (int i = 0; i < mSources.size(); ++i)
-   {
-      for (int j = 0; j < mSources.size(); ++j)
-      {
-         for (int k = 0; k < mSources[i]->GetNumTargets(); ++k)
-         {
-            if (mSources[i]->GetTarget(k) != nullptr &&
-                mSources[i]->GetTarget(k) == dynamic_cast<IAudioReceiver*>(mSources[j]))
-            {
-               deps[j].mDeps.push_back(mSources[i]);
-            }
-         }
-      }
-   }
-
-   /*for (int i=0; i<deps.size(); ++i)
-   {
-      string depStr;
-      for (int j=0;j<deps[i].mDeps.size();++j)
-      {
-         depStr += dynamic_cast<IDrawableModule*>(deps[i].mDeps[j])->Name();
-         if (j<deps[i].mDeps.size()-1)
-            depStr += ", ";
-      }
-      ofLog() << dynamic_cast<IDrawableModule*>(deps[i].mMe)->Name() << "depends on:" << depStr;
-   }*/
-
-   //TODO(Ryan) detect circular dependencies
-   const int kMaxLoopCount = 1000; //how many times we loop over the graph before deciding that it must contain a circular dependency
-   mSources.clear();
-   int loopCount = 0;
-   while (deps.size() > 0 && loopCount < kMaxLoopCount) //stupid circular dependency detection, make better
-   {
-      for (int i = 0; i < deps.size(); ++i)
-      {
-         bool hasDeps = false;
-         for (int j = 0; j < deps[i].mDeps.size(); ++j)
-         {
-            bool found = false;
-            for (int k = 0; k < mSources.size(); ++k)
-            {
-               if (deps[i].mDeps[j] == mSources[k])
-                  found = true;
-            }
-            if (!found) //has a dep that hasn't been added yet
-               hasDeps = true;
-         }
-         if (!hasDeps)
-         {
-            mSources.push_back(deps[i].mMe);
-            deps.erase(deps.begin() + i);
-            i -= 1;
-         }
-      }
-      ++loopCount;
-   }
+   //the plan sorts the sources and finds any cycles, see AudioExecutionPlan::Build()
+   RebuildExecutionPlan();
 
-   if (loopCount == kMaxLoopCount) //circular dependency, don't lose the rest of the sources
-   {
-      mHasCircularDependency = true;
+   std::vector<std::pair<IAudioSource*, IAudioSource*>> circularEdges;
+   mEngine.GetCircularEdges(circularEdges);
+   if (!circularEdges.empty() && !mHasCircularDependency)
       ofLog() << "circular dependency detected";
-      for (int i = 0; i < deps.size(); ++i)
-         mSources.push_back(deps[i].mMe);
-      FindCircularDependencies();
-   }
-   else
-   {
-      if (mHasCircularDependency) //we used to have a circular dependency, now we don't
-         ClearCircularDependencyMarkers();
-      mHasCircularDependency = false;
-   }
+   mHasCircularDependency = !circularEdges.empty();
+   UpdateCircularDependencyMarkers(circularEdges);
+}
 
-   /*ofLog() << "new ordering:";
-   for (int i=0; i<mSources.size(); ++i)
-      ofLog() << dynamic_cast<IDrawableModule*>(mSources[i])->Name();*/
+void ModularSynth::RebuildExecutionPlan()
+{
+   mEngine.SetSources(mSources, UserPrefs.auto_suspend_modules.Get());
 }
 
-void ModularSynth::FindCircularDependencies()
+void ModularSynth::FreeRetiredExecutionPlans()
 {
-   ClearCircularDependencyMarkers();
-   for (int i = 0; i < mSources.size(); ++i)
-   {
-      std::list<IAudioSource*> chain;
-      if (FindCircularDependencySearch(chain, mSources[i]))
-         break;
-   }
+   mEngine.FreeRetiredExecutionPlans();
 }
 
-bool ModularSynth::FindCircularDependencySearch(std::list<IAudioSource*> chain, IAudioSource* searchFrom)
+void ModularSynth::UpdateCircularDependencyMarkers(const std::vector<std::pair<IAudioSource*, IAudioSource*>>& circularEdges)
 {
-   /*std::string debugString = "FindCircularDependencySearch(): ";
-   for (auto& element : chain)
-      debugString += dynamic_cast<IDrawableModule*>(element)->GetDisplayName() + "->";
-   debugString += dynamic_cast<IDrawableModule*>(searchFrom)->GetDisplayName();
-   ofLog() << debugString;*/
+   //only modules with a cable that's in a cycle now, or was last time, can have a marker that needs to change
+   std::set<std::pair<IAudioSource*, IAudioSource*>> edges(circularEdges.begin(), circularEdges.end());
+   std::set<IAudioSource*> affected;
+   for (const auto& edge : mCircularEdges)
+      affected.insert(edge.first);
+   for (const auto& edge : circularEdges)
+      affected.insert(edge.first);
 
-   chain.push_back(searchFrom);
-   IAudioSource* end = chain.back();
-   for (int i = 0; i < end->GetNumTargets(); ++i)
+   for (auto* source : affected)
    {
-      IAudioReceiver* receiver = end->GetTarget(i);
-      IAudioSource* targetAsSource = dynamic_cast<IAudioSource*>(receiver);
-      if (targetAsSource != nullptr)
+      IDrawableModule* module = dynamic_cast<IDrawableModule*>(source);
+      if (module == nullptr)
+         continue;
+      for (auto* cableSource : module->GetPatchCableSources())
       {
-         if (ListContains(targetAsSource, chain)) //found a circular dependency
-         {
-            std::string debugString = "FindCircularDependencySearch(): found! ";
-            for (auto& element : chain)
-               debugString += dynamic_cast<IDrawableModule*>(element)->GetDisplayName() + "->";
-            debugString += dynamic_cast<IDrawableModule*>(targetAsSource)->GetDisplayName();
-            ofLog() << debugString;
-
-            chain.push_back(targetAsSource);
-            std::vector<IAudioSource*> chainVec;
-            for (auto& element : chain)
-               chainVec.push_back(element);
-            for (int j = 0; j < (int)chainVec.size() - 1; ++j)
-            {
-               IDrawableModule* module = dynamic_cast<IDrawableModule*>(chainVec[j]);
-               for (int k = 0; k < (int)module->GetPatchCableSources().size(); ++k)
-               {
-                  if (dynamic_cast<IAudioSource*>(module->GetPatchCableSource(k)->GetTarget()) == chainVec[j + 1])
-                     module->GetPatchCableSource(k)->SetIsPartOfCircularDependency(true);
-               }
-            }
-
-            return true;
-         }
-         else
-         {
-            if (FindCircularDependencySearch(chain, targetAsSource))
-               return true;
-         }
+         IAudioSource* target = dynamic_cast<IAudioSource*>(cableSource->GetTarget());
+         cableSource->SetIsPartOfCircularDependency(target != nullptr && edges.count(std::make_pair(source, target)) > 0);
       }
    }
 
-   return false;
+   mCircularEdges = circularEdges;
 }
 
-void ModularSynth::ClearCircularDependencyMarkers()
+void ModularSynth::SetWindowTitle(std::string title)
 {
-   for (int i = 0; i < mSources.size(); ++i)
-   {
-      IDrawableModule* module = dynamic_cast<IDrawableModule*>(mSources[i]);
-      for (int j = 0; j < (int)module->GetPatchCableSources().size(); ++j)
-         module->GetPatchCableSource(j)->SetIsPartOfCircularDependency(false);
-   }
+   //there's no window when running headless, like in bespoke-bench
+   if (mMainComponent != nullptr)
+      mMainComponent->getTopLevelComponent()->setName(title);
 }
 
 void ModularSynth::ResetLayout()
 {
-   mMainComponent->getTopLevelComponent()->setName("bespoke synth");
+   SetWindowTitle("bespoke synth");
    mCurrentSaveStatePath = "";
+   AutosaveJournal::Get().Reset();
+   UndoHistory::Get().Reset();
+   ModuleHibernation::Get().Reset();
+
+   //make sure nothing is processing the old modules before they get deleted
+   mSources.clear();
+   RebuildExecutionPlan();
+   FreeRetiredExecutionPlans();
 
    mModuleContainer.Clear();
    mUILayerModuleContainer.Clear();
 
+   if (mControlChangeQueue != nullptr)
+   {
+      ScopedMutex mutex(&mAudioThreadMutex, "ResetLayout()");
+      mControlChangeQueue->Clear(); //it can still be holding sliders of the modules freed below
+   }
+
    for (int i = 0; i < mDeletedModules.size(); ++i)
       delete mDeletedModules[i];
 
    mDeletedModules.clear();
    mSources.clear();
+   mCircularEdges.clear();
+   mHasCircularDependency = false;
    mLissajousDrawers.clear();
    mMoveModule = nullptr;
    TheTransport->ClearListenersAndPollers();
@@ -2552,6 +2674,7 @@ void ModularSynth::ResetLayout()
    delete mQuickSpawn;
    delete mUserPrefsEditor;
    delete mNoteOutputQueue;
+   delete mControlChangeQueue;
 
    TitleBar* titleBar = new TitleBar();
    titleBar->SetPosition(0, 0);
@@ -2608,6 +2731,8 @@ void ModularSynth::ResetLayout()
    SetUIScale(UserPrefs.ui_scale.Get());
 
    mNoteOutputQueue = new NoteOutputQueue();
+   mControlChangeQueue = new ControlChangeQueue();
+   mEngine.SetQueues(mNoteOutputQueue, mControlChangeQueue);
 }
 
 bool ModularSynth::LoadLayoutFromFile(std::string jsonFile, bool makeDefaultLayout /*= true*/)
@@ -2694,8 +2819,10 @@ void ModularSynth::LoadLayout(ofxJSONElement json)
 
    ResetLayout();
 
+   SampleLoader::Get().BeginBatch();
    mModuleContainer.LoadModules(json["modules"]);
    mUILayerModuleContainer.LoadModules(json["ui_modules"]);
+   SampleLoader::Get().EndBatch();
 
    //timer.PrintCosts();
 
@@ -2721,7 +2848,36 @@ void ModularSynth::RemoveExtraPoller(IPollable* poller)
       mExtraPollers.remove(poller);
 }
 
-IDrawableModule* ModularSynth::CreateModule(const ofxJSONElement& moduleInfo)
+IDrawableModule* ModularSynth::ConstructModule(const ofxJSONElement& moduleInfo)
+{
+   IDrawableModule* module = nullptr;
+   try
+   {
+      if (moduleInfo["comment_out"].asBool())
+         return nullptr;
+
+      std::string type = ModuleFactory::FixUpTypeName(moduleInfo["type"].asString());
+      if (!mModuleFactory.CanConstructOffThread(type))
+         return nullptr;
+
+      size_t setupBytes = 0;
+      ScopedAllocationCounter countAllocations(&setupBytes);
+      module = mModuleFactory.MakeModule(type);
+      if (module == nullptr)
+         return nullptr;
+      module->CreateUIControls();
+      module->GetTrackedAllocationBytes() += setupBytes;
+   }
+   catch (...)
+   {
+      //leave it to CreateModule() to try again, and to report what went wrong
+      delete module;
+      module = nullptr;
+   }
+   return module;
+}
+
+IDrawableModule* ModularSynth::CreateModule(const ofxJSONElement& moduleInfo, IDrawableModule* constructed /*= nullptr*/)
 {
    IDrawableModule* module = nullptr;
 
@@ -2735,7 +2891,12 @@ IDrawableModule* ModularSynth::CreateModule(const ofxJSONElement& moduleInfo)
 
       try
       {
-         if (type == "transport")
+         size_t setupBytes = 0;
+         ScopedAllocationCounter countAllocations(&setupBytes);
+
+         if (constructed != nullptr)
+            module = constructed;
+         else if (type == "transport")
             module = TheTransport;
          else if (type == "scale")
             module = TheScale;
@@ -2748,10 +2909,11 @@ IDrawableModule* ModularSynth::CreateModule(const ofxJSONElement& moduleInfo)
             return nullptr;
          }
 
-         if (module->IsSingleton() == false)
+         if (module->IsSingleton() == false && constructed == nullptr)
             module->CreateUIControls();
          module->LoadBasics(moduleInfo, type);
          assert(strlen(module->Name()) > 0);
+         module->GetTrackedAllocationBytes() += setupBytes;
       }
       catch (UnknownModuleException& e)
       {
@@ -2769,6 +2931,7 @@ IDrawableModule* ModularSynth::CreateModule(const ofxJSONElement& moduleInfo)
 void ModularSynth::SetUpModule(IDrawableModule* module, const ofxJSONElement& moduleInfo)
 {
    assert(module != nullptr);
+   ScopedAllocationCounter countAllocations(&module->GetTrackedAllocationBytes());
 
    try
    {
@@ -2786,7 +2949,24 @@ void ModularSynth::OnModuleAdded(IDrawableModule* module)
 {
    IAudioSource* source = dynamic_cast<IAudioSource*>(module);
    if (source)
+   {
       mSources.push_back(source);
+      if (mIsLoadingState || mHoldExecutionPlan)
+         mArrangeDependenciesWhenLoadCompletes = true;
+      else
+         RebuildExecutionPlan();
+   }
+}
+
+void ModularSynth::SetHoldExecutionPlan(bool hold)
+{
+   //counted, so that one load finishing doesn't release the plan while another is still building
+   mHoldExecutionPlan = MAX(0, mHoldExecutionPlan + (hold ? 1 : -1));
+   if (mHoldExecutionPlan == 0 && mArrangeDependenciesWhenLoadCompletes && !mIsLoadingState)
+   {
+      ArrangeAudioSourceDependencies();
+      mArrangeDependenciesWhenLoadCompletes = false;
+   }
 }
 
 void ModularSynth::AddDynamicModule(IDrawableModule* module)
@@ -2847,9 +3027,9 @@ IUIControl* ModularSynth::FindUIControl(std::string path)
    {
       if (Prefab::sLoadingPrefab)
          return nullptr;
-      return mModuleContainer.FindUIControl(path.substr(1, path.length() - 1));
+      return UIControlIndex::Get().Find(path.substr(1, path.length() - 1));
    }
-   return mModuleContainer.FindUIControl(IClickable::sPathLoadContext + path);
+   return UIControlIndex::Get().Find(IClickable::sPathLoadContext + path);
 }
 
 void ModularSynth::GrabSample(ChannelBuffer* data, std::string name, bool window, int numBars)
@@ -2876,6 +3056,7 @@ void ModularSynth::GrabSample(ChannelBuffer* data, std::string name, bool window
                mHeldSample->Data()->GetChannel(ch)[length - 1 - i] *= fade;
             }
          }
+         mHeldSample->Data()->MarkPeaksDirty();
       }
    }
 }
@@ -2947,6 +3128,25 @@ IDrawableModule* ModularSynth::DuplicateModule(IDrawableModule* module)
    return newModule;
 }
 
+void ModularSynth::LoadModuleState(IDrawableModule* module, const juce::MemoryBlock& state)
+{
+   //the state was saved by this build, whatever rev the file that's open was saved with
+   int loadingRev = sLoadingFileSaveStateRev;
+   sLoadingFileSaveStateRev = kSaveStateRev;
+   mIsLoadingModule = true;
+   try
+   {
+      FileStreamIn in(state);
+      module->LoadState(in, module->LoadModuleSaveStateRev(in));
+   }
+   catch (LoadStateException& e)
+   {
+      LogEvent("Couldn't load the state of \"" + std::string(module->Name()) + "\"", kLogEventType_Error);
+   }
+   mIsLoadingModule = false;
+   sLoadingFileSaveStateRev = loadingRev;
+}
+
 ofxJSONElement ModularSynth::GetLayout()
 {
    ofxJSONElement root;
@@ -3034,7 +3234,7 @@ void ModularSynth::SaveState(std::string file, bool autosave)
    {
       mCurrentSaveStatePath = file;
       std::string filename = File(mCurrentSaveStatePath).getFileName().toStdString();
-      mMainComponent->getTopLevelComponent()->setName("bespoke synth - " + filename);
+      SetWindowTitle("bespoke synth - " + filename);
       TheTitleBar->DisplayTemporaryMessage("saved " + filename);
    }
 
@@ -3044,21 +3244,62 @@ void ModularSynth::SaveState(std::string file, bool autosave)
    std::string tmpFilePath = ofToDataPath("tmp");
 
    {
-      FileStreamOut out(tmpFilePath);
-
-      mZoomer.WriteCurrentLocation(-1);
-      out << GetLayout().getRawString(true);
-      mModuleContainer.SaveState(out);
-      mUILayerModuleContainer.SaveState(out);
+      SaveStateChunkWriter writer(tmpFilePath, UserPrefs.compress_savestates.Get());
+      if (!WriteStateChunks(writer, false))
+         LogEvent("error writing save state " + file, kLogEventType_Error);
    }
 
+   //replace rather than overwrite, samples loaded from the old file might still be mapping it
    juce::File writtenFile(tmpFilePath);
    juce::File targetFile(file);
-   writtenFile.copyFileTo(targetFile);
+   if (!writtenFile.replaceFileIn(targetFile) && !writtenFile.copyFileTo(targetFile))
+   {
+      //the old file is still locked (on windows, samples map it). keep what was written under its own name, the next save would overwrite "tmp"
+      juce::File keptFile = targetFile.getSiblingFile(targetFile.getFileNameWithoutExtension() + "_unsaved" + targetFile.getFileExtension()).getNonexistentSibling();
+      if (!writtenFile.moveFileTo(keptFile))
+         keptFile = writtenFile;
+      LogEvent("couldn't write " + file + ", the save was kept as " + keptFile.getFullPathName().toStdString(), kLogEventType_Error);
+   }
 
    mAudioThreadMutex.Unlock();
 }
 
+bool ModularSynth::SaveStateJournalRecord(std::string journalFile, bool allModules)
+{
+   if (!allModules && !mModuleContainer.HasDirtyModules() && !mUILayerModuleContainer.HasDirtyModules())
+      return true;
+
+   if (allModules)
+      ClearModuleStateDirty();
+
+   mAudioThreadMutex.Lock("SaveStateJournalRecord()");
+   bool success;
+   {
+      SaveStateChunkWriter writer(journalFile, UserPrefs.compress_savestates.Get(), true);
+      success = writer.OpenedOk() && WriteStateChunks(writer, !allModules);
+   }
+   mAudioThreadMutex.Unlock();
+   return success;
+}
+
+bool ModularSynth::WriteStateChunks(SaveStateChunkWriter& writer, bool onlyDirtyModules)
+{
+   mZoomer.WriteCurrentLocation(-1);
+   std::string layout = GetLayout().getRawString(true);
+   writer.AddChunk(SaveStateChunk::kLayout, "layout", juce::MemoryBlock(layout.data(), layout.size()));
+   SaveStateChunkWriter::SetActive(&writer);
+   mModuleContainer.SaveState(writer, SaveStateChunk::kModule, onlyDirtyModules);
+   mUILayerModuleContainer.SaveState(writer, SaveStateChunk::kUILayerModule, onlyDirtyModules);
+   SaveStateChunkWriter::SetActive(nullptr);
+   return writer.Finish(kSaveStateRev);
+}
+
+void ModularSynth::ClearModuleStateDirty()
+{
+   mModuleContainer.ClearStateDirty();
+   mUILayerModuleContainer.ClearStateDirty();
+}
+
 void ModularSynth::SetStartupSaveStateFile(std::string bskPath)
 {
    mStartupSaveStateFile = std::move(bskPath);
@@ -3077,6 +3318,19 @@ void ModularSynth::LoadState(std::string file)
    if (mInitialized)
       TitleBar::sShowInitialHelpOverlay = false; //don't show initial help popup
 
+   std::unique_ptr<SaveStateChunkSet> chunks;
+   if (SaveStateChunk::IsChunkedSaveState(ofToDataPath(file)))
+   {
+      chunks = std::make_unique<SaveStateChunkSet>();
+      chunks->Add(std::make_unique<SaveStateChunkReader>(ofToDataPath(file)));
+      AutosaveJournal::AddJournalRecords(ofToDataPath(file), *chunks); //an autosave that has changes on top of it
+      if (!chunks->IsValid())
+      {
+         LogEvent("Couldn't read save state: " + file, kLogEventType_Error);
+         return;
+      }
+   }
+
    FileStreamIn in(ofToDataPath(file));
 
    if (in.Eof())
@@ -3092,6 +3346,48 @@ void ModularSynth::LoadState(std::string file)
    LockRender(false);
    mAudioThreadMutex.Unlock();
 
+   //samples decode in the background, audio can start before they've all arrived
+   SampleLoader::Get().BeginBatch();
+
+   if (chunks != nullptr)
+      LoadChunkedState(*chunks);
+   else
+      LoadLegacyState(in);
+
+   mCurrentSaveStatePath = file;
+   File savePath(mCurrentSaveStatePath);
+   std::string filename = savePath.getFileName().toStdString();
+   SetWindowTitle("bespoke synth - " + filename);
+
+   SampleLoader::Get().EndBatch();
+
+   mAudioThreadMutex.Lock("LoadState()");
+   LockRender(true);
+   mAudioPaused = false;
+   mIsLoadingState = false;
+   LockRender(false);
+   mAudioThreadMutex.Unlock();
+}
+
+void ModularSynth::LoadChunkedState(SaveStateChunkSet& chunks)
+{
+   SaveStateChunkReader* layoutReader = chunks.mLayout.mReader;
+   bool layoutLoaded = LoadLayoutFromString(layoutReader->GetChunkData(chunks.mLayout.mIndex).toString().toStdString());
+   layoutReader->ReleaseChunkData(chunks.mLayout.mIndex);
+
+   if (layoutLoaded)
+   {
+      mIsLoadingModule = true;
+      mModuleContainer.LoadState(chunks.mModules, chunks.mSaveStateRev);
+      mUILayerModuleContainer.LoadState(chunks.mUILayerModules, chunks.mSaveStateRev);
+      mIsLoadingModule = false;
+
+      TheTransport->Reset();
+   }
+}
+
+void ModularSynth::LoadLegacyState(FileStreamIn& in)
+{
    //TODO(Ryan) here's a little hack to allow older BSK files that were saved in 32-bit to load.
    //I guess this could bite me if someone ever has a very massive json. the number corresponds to a long-standing sanity check in FileStreamIn::operator>>(std::string &var), so this shouldn't break any current behavior.
    //this should definitely be removed if anything about the structure of the BSK format changes.
@@ -3116,18 +3412,6 @@ void ModularSynth::LoadState(std::string file)
    }
 
    FileStreamIn::s32BitMode = false;
-
-   mCurrentSaveStatePath = file;
-   File savePath(mCurrentSaveStatePath);
-   std::string filename = savePath.getFileName().toStdString();
-   mMainComponent->getTopLevelComponent()->setName("bespoke synth - " + filename);
-
-   mAudioThreadMutex.Lock("LoadState()");
-   LockRender(true);
-   mAudioPaused = false;
-   mIsLoadingState = false;
-   LockRender(false);
-   mAudioThreadMutex.Unlock();
 }
 
 bool ModularSynth::IsCurrentSaveStateATemplate() const
@@ -3225,6 +3509,21 @@ void ModularSynth::OnConsoleInput(std::string command /* = "" */)
       {
          SaveOutput();
       }
+      else if (tokens[0] == "grab")
+      {
+         //grab [seconds]
+         GrabRecentOutput(tokens.size() > 1 ? ofToFloat(tokens[1]) : 10);
+      }
+      else if (tokens[0] == "bounce")
+      {
+         //bounce <bars> [file] [tempo]
+         if (tokens.size() > 1)
+         {
+            std::string filename = tokens.size() > 2 ? tokens[2] : ofGetTimestampString(UserPrefs.recordings_path.Get() + "bounce_%Y-%m-%d_%H-%M.wav");
+            float tempo = tokens.size() > 3 ? ofToFloat(tokens[3]) : -1;
+            Bounce(filename, ofToInt(tokens[1]), tempo);
+         }
+      }
       else if (tokens[0] == "reconnect")
       {
          ReconnectMidiDevices();
@@ -3233,6 +3532,27 @@ void ModularSynth::OnConsoleInput(std::string command /* = "" */)
       {
          Profiler::ToggleProfiler();
       }
+      else if (tokens[0] == "trace")
+      {
+         if (!ProfilerTrace::IsRecording())
+         {
+            ProfilerTrace::Start();
+            ofLog() << "recording trace, \"trace\" again to stop and save it";
+         }
+         else
+         {
+            std::string path = ofToDataPath(ofGetTimestampString("trace_%Y-%m-%d_%H-%M-%S.json"));
+            if (!ProfilerTrace::StopAndSave(path))
+               ofLog() << "couldn't write " << path;
+         }
+      }
+      else if (tokens[0] == "replay")
+      {
+         if (!ReplayCapture::IsCapturing())
+            ReplayCapture::Start(ofGetTimestampString(UserPrefs.recordings_path.Get() + "replay_%Y-%m-%d_%H-%M-%S.bsr"));
+         else
+            ReplayCapture::Stop();
+      }
       else if (tokens[0] == "clear")
       {
          mErrors.clear();
@@ -3280,6 +3600,12 @@ void ModularSynth::OnConsoleInput(std::string command /* = "" */)
       {
          DumpUnfreedMemory();
       }
+      else if (tokens[0] == "rtsanitizer")
+      {
+         if (tokens.size() >= 2)
+            RealtimeSanitizer::SetEnabled(tokens[1] == "on");
+         RealtimeSanitizer::PrintSummary();
+      }
       else if (tokens[0] == "savestate")
       {
          if (tokens.size() >= 2)
@@ -3362,13 +3688,20 @@ void ModularSynth::DoAutosave()
       FileTimeComparator cmp;
       autosaveFiles.sort(cmp, false);
       for (int i = kMaxAutosaveSlots; i < autosaveFiles.size(); ++i) //delete oldest files beyond slot limit
+      {
          autosaveFiles[i].deleteFile();
+         AutosaveJournal::DeleteJournals(autosaveFiles[i].getFullPathName().toStdString());
+      }
    }
 
-   SaveState(ofToDataPath(ofGetTimestampString("savestate/autosave/autosave_%Y-%m-%d_%H-%M-%S.bskt")), true);
+   mLastAutosaveTime = gTime;
+   if (UserPrefs.autosave_journal.Get())
+      AutosaveJournal::Get().Autosave();
+   else
+      SaveState(ofToDataPath(ofGetTimestampString("savestate/autosave/autosave_%Y-%m-%d_%H-%M-%S.bskt")), true);
 }
 
-IDrawableModule* ModularSynth::SpawnModuleOnTheFly(ModuleFactory::Spawnable spawnable, float x, float y, bool addToContainer, std::string name)
+IDrawableModule* ModularSynth::SpawnModuleOnTheFly(ModuleFactory::Spawnable spawnable, float x, float y, bool addToContainer, std::string name, std::function<void(IDrawableModule*)> onSpawned)
 {
    if (mInitialized)
       TitleBar::sShowInitialHelpOverlay = false; //don't show initial help popup
@@ -3449,7 +3782,18 @@ IDrawableModule* ModularSynth::SpawnModuleOnTheFly(ModuleFactory::Spawnable spaw
       {
          Prefab* prefab = dynamic_cast<Prefab*>(module);
          if (prefab != nullptr)
-            prefab->LoadPrefab("prefabs" + GetPathSeparator() + spawnable.mLabel);
+         {
+            //the modules only exist once the load finishes, so that's when the spawn is done
+            prefab->LoadPrefab("prefabs" + GetPathSeparator() + spawnable.mLabel, [this, spawnable, onSpawned](Prefab* loaded, bool succeeded)
+                               {
+                                  if (!succeeded)
+                                     return;
+                                  mModuleFactory.GetSpawnIndex()->NoteSpawned(spawnable);
+                                  if (onSpawned)
+                                     onSpawned(loaded);
+                               });
+            return module;
+         }
       }
       break;
 
@@ -3476,7 +3820,7 @@ IDrawableModule* ModularSynth::SpawnModuleOnTheFly(ModuleFactory::Spawnable spaw
       {
          std::string presetFilePath = ofToDataPath("presets/" + spawnable.mPresetModuleType + "/" + spawnable.mLabel);
          ModuleSaveDataPanel::LoadPreset(module, presetFilePath);
-         module->SetName(GetUniqueName(juce::String(spawnable.mLabel).replace(".preset", "").toStdString(), modules).c_str());
+         module->SetName(GetUniqueName(juce::String(spawnable.mLabel).fromLastOccurrenceOf("/", false, false).replace(".preset", "").toStdString(), modules).c_str());
       }
       break;
 
@@ -3486,6 +3830,13 @@ IDrawableModule* ModularSynth::SpawnModuleOnTheFly(ModuleFactory::Spawnable spaw
       break;
    }
 
+   if (module != nullptr)
+   {
+      mModuleFactory.GetSpawnIndex()->NoteSpawned(spawnable);
+      if (onSpawned)
+         onSpawned(module);
+   }
+
    return module;
 }
 
@@ -3526,7 +3877,7 @@ void ModularSynth::SaveOutput()
 
    assert(mRecordingLength <= mGlobalRecordBuffer->Size());
 
-   int channels = 2;
+   int channels = 2 + (int)mExtraRecordBuffers.size();
    auto wavFormat = std::make_unique<juce::WavAudioFormat>();
    juce::File outputFile(ofToDataPath(filename));
    outputFile.create();
@@ -3535,29 +3886,157 @@ void ModularSynth::SaveOutput()
    bool b1{ false };
    auto writer = std::unique_ptr<juce::AudioFormatWriter>(wavFormat->createWriterFor(outputTo.release(), gSampleRate, channels, 16, b1, 0));
 
-   int samplesRemaining = mRecordingLength;
-   const int chunkSize = 256;
-   float leftChannel[chunkSize];
-   float rightChannel[chunkSize];
-   float* chunk[2]{ leftChannel, rightChannel };
-   while (samplesRemaining > 0)
+   if (mRetroCapture != nullptr)
    {
-      int numSamples = MIN(chunkSize, samplesRemaining);
-      for (int i = 0; i < numSamples; ++i)
-      {
-         chunk[0][i] = mGlobalRecordBuffer->GetSample(samplesRemaining - 1, 0);
-         chunk[1][i] = mGlobalRecordBuffer->GetSample(samplesRemaining - 1, 1);
-         --samplesRemaining;
+      assert(mRetroCapture->GetNumChannels() == channels);
+      mRetroCapture->Read(mRetroCapture->GetNumSamples(), [&writer, channels](const float* const* data, int numSamples)
+                          {
+                             writer->writeFromFloatArrays(data, channels, numSamples);
+                          });
+      mRetroCapture->Clear();
+   }
+   else
+   {
+      int samplesRemaining = mRecordingLength;
+      const int chunkSize = 256;
+      std::vector<float> chunkData(chunkSize * channels);
+      std::vector<float*> chunk(channels);
+      for (int ch = 0; ch < channels; ++ch)
+         chunk[ch] = chunkData.data() + ch * chunkSize;
+      while (samplesRemaining > 0)
+      {
+         int numSamples = MIN(chunkSize, samplesRemaining);
+         samplesRemaining -= numSamples;
+         for (int ch = 0; ch < channels; ++ch)
+         {
+            if (ch < 2)
+               mGlobalRecordBuffer->ReadChunk(chunk[ch], numSamples, samplesRemaining, ch);
+            else
+               mExtraRecordBuffers[ch - 2]->ReadChunk(chunk[ch], numSamples, samplesRemaining, 0);
+         }
+         writer->writeFromFloatArrays(chunk.data(), channels, numSamples);
       }
-      writer->writeFromFloatArrays(chunk, channels, numSamples);
    }
 
    mGlobalRecordBuffer->ClearBuffer();
+   for (auto& buffer : mExtraRecordBuffers)
+      buffer->ClearBuffer();
    mRecordingLength = 0;
 
    TheTitleBar->DisplayTemporaryMessage("wrote " + filename);
 }
 
+void ModularSynth::GrabRecentOutput(float seconds)
+{
+   int numSamples = (int)(seconds * gSampleRate);
+   if (mRetroCapture != nullptr)
+      numSamples = (int)MIN((std::int64_t)numSamples, mRetroCapture->GetNumSamples());
+   else
+      numSamples = MIN(numSamples, mRecordingLength);
+   if (numSamples <= 0)
+      return;
+
+   ChannelBuffer data(numSamples);
+   data.SetNumActiveChannels(2);
+   if (mRetroCapture != nullptr)
+   {
+      int written = 0;
+      mRetroCapture->Read(numSamples, [&data, &written](const float* const* channels, int pieceSize)
+                          {
+                             for (int ch = 0; ch < 2; ++ch)
+                                BufferCopy(data.GetChannel(ch) + written, channels[ch], pieceSize);
+                             written += pieceSize;
+                          });
+   }
+   else
+   {
+      ScopedMutex mutex(&mAudioThreadMutex, "GrabRecentOutput()");
+      for (int ch = 0; ch < 2; ++ch)
+         mGlobalRecordBuffer->ReadChunk(data.GetChannel(ch), numSamples, 0, ch);
+   }
+
+   GrabSample(&data, "output", K(window));
+}
+
+//renders the patch from the top of the transport, as fast as it can be processed rather than in realtime, and writes the master output to a wav.
+//while this runs, the audio device (if there is one) is fed silence and none of its input
+bool ModularSynth::Bounce(std::string outputPath, int numBars, float tempo /*= -1*/)
+{
+   if (numBars <= 0 || outputPath.empty() || mEngine.GetNumOutputChannels() == 0)
+      return false;
+
+   //samples from the patch that was just loaded are still decoding in the background, and would render as silence
+   while (SampleLoader::Get().IsBusy())
+      juce::Thread::sleep(10);
+
+   juce::File outputFile(ofToDataPath(outputPath));
+   outputFile.deleteFile();
+   outputFile.create();
+   auto outputTo = outputFile.createOutputStream();
+   if (outputTo == nullptr)
+   {
+      LogEvent("couldn't open " + outputFile.getFullPathName().toStdString() + " for bounce", kLogEventType_Error);
+      return false;
+   }
+
+   int oversampling = UserPrefs.oversampling.Get();
+   int sampleRate = gSampleRate / oversampling;
+   int bufferSize = mIOBufferSize / oversampling;
+   int numOutputChannels = mEngine.GetNumOutputChannels();
+   int channels = MIN(numOutputChannels, 2);
+
+   auto wavFormat = std::make_unique<juce::WavAudioFormat>();
+   auto writer = std::unique_ptr<juce::AudioFormatWriter>(wavFormat->createWriterFor(outputTo.release(), sampleRate, channels, 24, StringPairArray(), 0));
+   if (writer == nullptr)
+      return false;
+
+   {
+      //set under the mutex, so that a device callback already past its check has finished, and any later one sees it
+      ScopedMutex mutex(&mAudioThreadMutex, "Bounce()");
+      mRenderingOffline = true;
+      for (auto* input : mEngine.GetInputBuffers())
+         Clear(input, gBufferSize);
+      for (auto& input : mStagedInput)
+         std::fill(input.begin(), input.end(), 0.0f);
+
+      if (tempo > 0)
+         TheTransport->SetTempo(tempo);
+      TheTransport->Reset();
+   }
+
+   std::vector<std::vector<float>> output(numOutputChannels, std::vector<float>(bufferSize));
+   std::vector<float*> outputPointers;
+   for (auto& channel : output)
+      outputPointers.push_back(channel.data());
+
+   //same path as the audio device callback, so the transport and everything listening to it advance just like they do live
+   int64_t samplesRemaining = int64_t(TheTransport->MsPerBar() * numBars / 1000 * sampleRate);
+   sIsOfflineRenderThread = true;
+   while (samplesRemaining > 0)
+   {
+      AudioOut(outputPointers.data(), bufferSize, numOutputChannels);
+      int numSamples = (int)MIN(samplesRemaining, (int64_t)bufferSize);
+      writer->writeFromFloatArrays(outputPointers.data(), channels, numSamples);
+      samplesRemaining -= numSamples;
+   }
+   sIsOfflineRenderThread = false;
+
+   writer.reset();
+   mRenderingOffline = false;
+
+   ofLog() << "bounced " << numBars << " bars to " << outputFile.getFullPathName().toStdString();
+   if (TheTitleBar != nullptr)
+      TheTitleBar->DisplayTemporaryMessage("bounced " + outputFile.getFileName().toStdString());
+   return true;
+}
+
+void ModularSynth::SetStartupBounce(std::string outputPath, int numBars, float tempo)
+{
+   mStartupBouncePath = std::move(outputPath);
+   mStartupBounceBars = numBars;
+   mStartupBounceTempo = tempo;
+}
+
 const String& ModularSynth::GetTextFromClipboard() const
 {
    return TheClipboard;
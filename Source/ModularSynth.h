@@ -14,7 +14,15 @@
 #include "EffectFactory.h"
 #include "ModuleContainer.h"
 #include "Minimap.h"
+#include "AudioEngine.h"
+#include "AudioCallbackMonitor.h"
+#include "CpuGovernor.h"
+#include "MasterLimiter.h"
+#include "VisualizationTap.h"
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
 
 #ifdef BESPOKE_LINUX
 #include <climits>
@@ -46,6 +54,10 @@ class UserPrefsEditor;
 class Minimap;
 class ScriptWarningPopup;
 class NoteOutputQueue;
+class ControlChangeQueue;
+struct SaveStateChunkSet;
+class SaveStateChunkWriter;
+class RetroCapture;
 
 enum LogEventType
 {
@@ -113,14 +125,15 @@ public:
 
    void AddMidiDevice(MidiDevice* device);
    void ArrangeAudioSourceDependencies();
-   IDrawableModule* SpawnModuleOnTheFly(ModuleFactory::Spawnable spawnable, float x, float y, bool addToContainer = true, std::string name = "");
+   //onSpawned is called once the module is completely set up: before this returns for most, but prefabs finish loading in a later Poll()
+   IDrawableModule* SpawnModuleOnTheFly(ModuleFactory::Spawnable spawnable, float x, float y, bool addToContainer = true, std::string name = "", std::function<void(IDrawableModule*)> onSpawned = nullptr);
 
    void SetMoveModule(IDrawableModule* module, float offsetX, float offsetY, bool canStickToCursor);
 
-   int GetNumInputChannels() const { return (int)mInputBuffers.size(); }
-   int GetNumOutputChannels() const { return (int)mOutputBuffers.size(); }
-   float* GetInputBuffer(int channel);
-   float* GetOutputBuffer(int channel);
+   int GetNumInputChannels() const { return mEngine.GetNumInputChannels(); }
+   int GetNumOutputChannels() const { return mEngine.GetNumOutputChannels(); }
+   float* GetInputBuffer(int channel) { return mEngine.GetInputBuffer(channel); }
+   float* GetOutputBuffer(int channel) { return mEngine.GetOutputBuffer(channel); }
 
    IDrawableModule* FindModule(std::string name, bool fail = false);
    IAudioReceiver* FindAudioReceiver(std::string name, bool fail = false);
@@ -237,12 +250,20 @@ public:
    float GetFrameRate() const { return mFrameRate; }
    std::recursive_mutex& GetRenderLock() { return mRenderLock; }
    NamedMutex* GetAudioMutex() { return &mAudioThreadMutex; }
+   const AudioCallbackMonitor& GetCallbackMonitor() const { return mCallbackMonitor; }
+   const CpuGovernor& GetCpuGovernor() const { return mCpuGovernor; }
+   void RebuildExecutionPlan();
    static std::thread::id GetMainThreadID() { return sMainThreadId; }
    static std::thread::id GetAudioThreadID() { return sAudioThreadId; }
+   static bool IsOfflineRenderThread() { return sIsOfflineRenderThread; } //doing the audio thread's work for a Bounce()
    NoteOutputQueue* GetNoteOutputQueue() { return mNoteOutputQueue; }
+   ControlChangeQueue* GetControlChangeQueue() { return mControlChangeQueue; }
 
-   IDrawableModule* CreateModule(const ofxJSONElement& moduleInfo);
+   IDrawableModule* CreateModule(const ofxJSONElement& moduleInfo, IDrawableModule* constructed = nullptr); //constructed: from ConstructModule(), to finish here
+   IDrawableModule* ConstructModule(const ofxJSONElement& moduleInfo); //the part of CreateModule() that can run on any thread, nullptr if this type can't
    void SetUpModule(IDrawableModule* module, const ofxJSONElement& moduleInfo);
+   IDrawableModule* DuplicateModule(IDrawableModule* module);
+   void LoadModuleState(IDrawableModule* module, const juce::MemoryBlock& state); //state from module->SaveState() this session
    void OnModuleAdded(IDrawableModule* module);
    void OnModuleDeleted(IDrawableModule* module);
    void AddDynamicModule(IDrawableModule* module);
@@ -253,6 +274,7 @@ public:
    bool IsLoadingModule() const { return mIsLoadingModule; }
    bool IsDuplicatingModule() const { return mIsDuplicatingModule; }
    void SetIsLoadingState(bool loading) { mIsLoadingState = loading; }
+   void SetHoldExecutionPlan(bool hold); //while held, added modules stay out of the audio thread's plan until it's released. holds nest
 
    static std::string GetUserPrefsPath();
    static void CrashHandler(void*);
@@ -262,7 +284,14 @@ public:
    ofxJSONElement GetLayout();
    void SaveLayoutAsPopup();
    void SaveOutput();
+   void GrabRecentOutput(float seconds); //picks up the last few seconds of output as a sample, to drop on a module
+   bool Bounce(std::string outputPath, int numBars, float tempo = -1);
+   void SetStartupBounce(std::string outputPath, int numBars, float tempo);
+   bool HasStartupBounce() const { return mStartupBounceBars > 0; }
+   bool IsRenderingOffline() const { return mRenderingOffline; }
    void SaveState(std::string file, bool autosave);
+   bool SaveStateJournalRecord(std::string journalFile, bool allModules); //see AutosaveJournal
+   void ClearModuleStateDirty();
    void LoadState(std::string file);
    void SetStartupSaveStateFile(std::string bskPath);
    void SaveCurrentState();
@@ -296,28 +325,39 @@ public:
 
 private:
    void ResetLayout();
+   void SetWindowTitle(std::string title);
    void ReconnectMidiDevices();
    void DrawConsole();
+   void DrawSampleLoadProgress(float centerX, float y);
+   bool WriteStateChunks(SaveStateChunkWriter& writer, bool onlyDirtyModules);
+   void LoadChunkedState(SaveStateChunkSet& chunks);
+   void LoadLegacyState(FileStreamIn& in);
    void CheckClick(IDrawableModule* clickedModule, float x, float y, bool rightButton);
    void UpdateUserPrefsLayout();
    void LoadStatePopupImp();
-   IDrawableModule* DuplicateModule(IDrawableModule* module);
    void DeleteAllModules();
    void TriggerClapboard();
    void DoAutosave();
-   void FindCircularDependencies();
-   bool FindCircularDependencySearch(std::list<IAudioSource*> chain, IAudioSource* searchFrom);
-   void ClearCircularDependencyMarkers();
+   void FreeRetiredExecutionPlans();
+   void UpdateCircularDependencyMarkers(const std::vector<std::pair<IAudioSource*, IAudioSource*>>& circularEdges);
    bool IsCurrentSaveStateATemplate() const;
 
    void ReadClipboardTextFromSystem();
 
    int mIOBufferSize{ 0 };
+   std::vector<std::vector<float>> mStagedInput; //a callback's input, when it's processed in more than one block
+   std::vector<const float*> mStagedInputPointers;
 
    std::vector<IAudioSource*> mSources;
+   AudioEngine mEngine;
+   AudioCallbackMonitor mCallbackMonitor;
+   CpuGovernor mCpuGovernor;
+   MasterLimiter mMasterLimiter;
+   bool mMasterLimiterOn{ false };
    std::vector<IDrawableModule*> mLissajousDrawers;
    std::vector<IDrawableModule*> mDeletedModules;
    bool mHasCircularDependency{ false };
+   std::vector<std::pair<IAudioSource*, IAudioSource*>> mCircularEdges; //whose cables are marked, see UpdateCircularDependencyMarkers()
 
    std::vector<IDrawableModule*> mModalFocusItemStack;
 
@@ -353,6 +393,9 @@ private:
    UserPrefsEditor* mUserPrefsEditor{ nullptr };
 
    RollingBuffer* mGlobalRecordBuffer{ nullptr };
+   std::vector<std::unique_ptr<RollingBuffer>> mExtraRecordBuffers; //for the outputs past the first two, with record_all_outputs on
+   std::unique_ptr<RetroCapture> mRetroCapture; //with record_buffer_compressed on, holds the capture, and the record buffers only the last few seconds of it
+   VisualizationTap mBackgroundLissajousTap;
    int mRecordingLength{ 0 };
 
    struct LogEventItem
@@ -369,14 +412,17 @@ private:
    std::list<LogEventItem> mEvents;
    std::list<std::string> mErrors;
 
-   NamedMutex mAudioThreadMutex;
+   NamedMutex mAudioThreadMutex{ "audio thread" };
    static std::thread::id sMainThreadId;
    static std::thread::id sAudioThreadId;
+   static thread_local bool sIsOfflineRenderThread;
    NoteOutputQueue* mNoteOutputQueue{ nullptr };
+   ControlChangeQueue* mControlChangeQueue{ nullptr };
 
    bool mAudioPaused{ false };
    bool mIsLoadingState{ false };
    bool mArrangeDependenciesWhenLoadCompletes{ false };
+   int mHoldExecutionPlan{ 0 };
 
    ModuleFactory mModuleFactory;
    EffectFactory mEffectFactory;
@@ -393,6 +439,10 @@ private:
    bool mWantReloadInitialLayout{ false };
    std::string mCurrentSaveStatePath;
    std::string mStartupSaveStateFile;
+   std::string mStartupBouncePath;
+   int mStartupBounceBars{ 0 };
+   float mStartupBounceTempo{ -1 };
+   std::atomic<bool> mRenderingOffline{ false };
 
    Sample* mHeldSample{ nullptr };
 
@@ -435,6 +485,7 @@ private:
 
    bool mIsLoadingModule{ false };
    bool mIsDuplicatingModule{ false };
+   double mLastAutosaveTime{ 0 };
 
    std::list<IPollable*> mExtraPollers;
 
@@ -444,8 +495,6 @@ private:
 
    double mPixelRatio{ 1 };
 
-   std::vector<float*> mInputBuffers;
-   std::vector<float*> mOutputBuffers;
 
    std::unique_ptr<juce::AudioPluginFormatManager> mAudioPluginFormatManager;
    std::unique_ptr<juce::KnownPluginList> mKnownPluginList;
@@ -24,6 +24,7 @@
 //
 
 #include "ModulationChain.h"
+#include "ChannelBufferArena.h"
 
 ModulationChain::ModulationChain(float initialValue)
 {
@@ -60,35 +61,135 @@ float ModulationChain::GetIndividualValue(int samplesIn) const
    return value;
 }
 
+float ModulationChain::GetBlockValue(int samplesIn) const
+{
+   if (samplesIn >= 0 && samplesIn < gBufferSize)
+   {
+      const float* block = GetBlock();
+      if (block != nullptr)
+         return block[samplesIn];
+   }
+   return GetValue(samplesIn);
+}
+
+//GetValue() for the whole buffer. the chain this is appended to, and the sidechain and multiply-in chains,
+//come out of their own cached blocks, so each link is a single loop over the buffer
+const float* ModulationChain::GetBlock() const
+{
+   uint64_t changeCount = GetChainChangeCount();
+   const float* cached = mBlock.Find(gTime, changeCount);
+   if (cached != nullptr)
+      return cached;
+
+   float* block = mBlock.BeginFill();
+   if (block == nullptr)
+      return nullptr;
+
+   const float* individual = GetIndividualBlock();
+   const float* multiplyIn = mMultiplyIn ? mMultiplyIn->GetIndividualBlock() : nullptr;
+   const float* sidechain = mSidechain ? mSidechain->GetIndividualBlock() : nullptr;
+   const float* prev = mPrev ? mPrev->GetBlock() : nullptr;
+   for (int i = 0; i < gBufferSize; ++i)
+   {
+      float value = individual ? individual[i] : GetIndividualValue(i);
+      if (mMultiplyIn)
+         value *= multiplyIn ? multiplyIn[i] : mMultiplyIn->GetIndividualValue(i);
+      if (mSidechain)
+         value += sidechain ? sidechain[i] : mSidechain->GetIndividualValue(i);
+      if (mPrev)
+         value += prev ? prev[i] : mPrev->GetValue(i);
+      if (std::isnan(value))
+         value = 0;
+      block[i] = value;
+   }
+
+   mBlock.EndFill(gTime, changeCount);
+   return block;
+}
+
+const float* ModulationChain::GetIndividualBlock() const
+{
+   const float* cached = mIndividualBlock.Find(gTime, mChangeCount);
+   if (cached != nullptr)
+      return cached;
+
+   float* block = mIndividualBlock.BeginFill();
+   if (block == nullptr)
+      return nullptr;
+
+   if (mLFOAmount != 0)
+   {
+      mLFO.ValueBlock(block, gBufferSize);
+      for (int i = 0; i < gBufferSize; ++i)
+         block[i] *= mLFOAmount;
+   }
+   else
+   {
+      Clear(block, gBufferSize);
+   }
+
+   for (int i = 0; i < gBufferSize; ++i)
+   {
+      double time = gTime + gInvSampleRateMs * i;
+      if (mRamp.HasValue(time))
+         block[i] += mRamp.Value(time);
+   }
+
+   if (mBuffer != nullptr)
+      Add(block, mBuffer, gBufferSize);
+
+   mIndividualBlock.EndFill(gTime, mChangeCount);
+   return block;
+}
+
+//changes whenever anything GetValue() depends on (besides time) changes
+uint64_t ModulationChain::GetChainChangeCount() const
+{
+   uint64_t changeCount = mChangeCount;
+   if (mMultiplyIn)
+      changeCount += mMultiplyIn->mChangeCount;
+   if (mSidechain)
+      changeCount += mSidechain->mChangeCount;
+   if (mPrev)
+      changeCount += mPrev->GetChainChangeCount();
+   return changeCount;
+}
+
 void ModulationChain::SetValue(float value)
 {
    mRamp.Start(gTime, value, gTime + gInvSampleRateMs * gBufferSize);
+   Changed();
 }
 
 void ModulationChain::RampValue(double time, float from, float to, double length)
 {
    mRamp.Start(time, from, to, time + length);
+   Changed();
 }
 
 void ModulationChain::SetLFO(NoteInterval interval, float amount)
 {
    mLFO.SetPeriod(interval);
    mLFOAmount = amount;
+   Changed();
 }
 
 void ModulationChain::AppendTo(ModulationChain* chain)
 {
    mPrev = chain;
+   Changed();
 }
 
 void ModulationChain::SetSidechain(ModulationChain* chain)
 {
    mSidechain = chain;
+   Changed();
 }
 
 void ModulationChain::MultiplyIn(ModulationChain* chain)
 {
    mMultiplyIn = chain;
+   Changed();
 }
 
 void ModulationChain::CreateBuffer()
@@ -96,12 +197,16 @@ void ModulationChain::CreateBuffer()
    if (mBuffer == nullptr)
       mBuffer = new float[gBufferSize];
    Clear(mBuffer, gBufferSize);
+   Changed();
 }
 
 void ModulationChain::FillBuffer(float* buffer)
 {
    if (mBuffer != nullptr)
+   {
       BufferCopy(mBuffer, buffer, gBufferSize);
+      Changed();
+   }
 }
 
 float ModulationChain::GetBufferValue(int sampleIdx)
@@ -111,6 +216,46 @@ float ModulationChain::GetBufferValue(int sampleIdx)
    return 0;
 }
 
+ModulationChain::BlockCache::~BlockCache()
+{
+   if (mValues == nullptr)
+      return;
+   if (mValuesFromArena)
+      ChannelBufferArena::Get().Free(mValues);
+   else
+      delete[] mValues;
+}
+
+const float* ModulationChain::BlockCache::Find(double time, uint64_t changeCount) const
+{
+   if (mTime.load(std::memory_order_acquire) == time && mChangeCount.load(std::memory_order_relaxed) == changeCount)
+      return mValues;
+   return nullptr;
+}
+
+float* ModulationChain::BlockCache::BeginFill()
+{
+   if (mFilling.exchange(true, std::memory_order_acquire))
+      return nullptr;
+
+   if (mValues == nullptr)
+   {
+      mValues = ChannelBufferArena::Get().Allocate(gBufferSize);
+      mValuesFromArena = mValues != nullptr;
+      if (mValues == nullptr)
+         mValues = new float[gBufferSize];
+   }
+   mTime.store(-1, std::memory_order_relaxed);
+   return mValues;
+}
+
+void ModulationChain::BlockCache::EndFill(double time, uint64_t changeCount)
+{
+   mChangeCount.store(changeCount, std::memory_order_relaxed);
+   mTime.store(time, std::memory_order_release);
+   mFilling.store(false, std::memory_order_release);
+}
+
 Modulations::Modulations(bool isGlobalEffect)
 {
    mVoiceModulations.resize(kNumVoices);
@@ -28,12 +28,17 @@
 #include "Ramp.h"
 #include "LFO.h"
 
+#include <atomic>
+#include <cstdint>
+
 class ModulationChain
 {
 public:
    ModulationChain(float initialValue);
    float GetValue(int samplesIn) const;
    float GetIndividualValue(int samplesIn) const;
+   //audio thread. same as GetValue(), but read out of a block evaluated once per buffer, so voices that share a chain (or the chain it's appended to) don't each recompute it
+   float GetBlockValue(int samplesIn) const;
    void SetValue(float value);
    void RampValue(double time, float from, float to, double length);
    void SetLFO(NoteInterval interval, float amount);
@@ -45,6 +50,30 @@ public:
    float GetBufferValue(int sampleIdx);
 
 private:
+   //a gBufferSize block of chain values, remembered for the buffer time and chain state it was evaluated for
+   struct BlockCache
+   {
+      BlockCache() = default;
+      BlockCache(const BlockCache&) {} //copies of a chain evaluate into their own block
+      BlockCache& operator=(const BlockCache&) { return *this; }
+      ~BlockCache();
+
+      const float* Find(double time, uint64_t changeCount) const;
+      float* BeginFill(); //returns nullptr if another thread is already filling the block
+      void EndFill(double time, uint64_t changeCount);
+
+      float* mValues{ nullptr };
+      bool mValuesFromArena{ false };
+      std::atomic<double> mTime{ -1 };
+      std::atomic<uint64_t> mChangeCount{ 0 };
+      std::atomic<bool> mFilling{ false };
+   };
+
+   const float* GetBlock() const;
+   const float* GetIndividualBlock() const;
+   uint64_t GetChainChangeCount() const;
+   void Changed() { ++mChangeCount; }
+
    Ramp mRamp;
    LFO mLFO;
    float mLFOAmount{ 0 };
@@ -52,6 +81,9 @@ private:
    ModulationChain* mPrev{ nullptr };
    ModulationChain* mSidechain{ nullptr };
    ModulationChain* mMultiplyIn{ nullptr };
+   uint64_t mChangeCount{ 0 };
+   mutable BlockCache mBlock;
+   mutable BlockCache mIndividualBlock;
 };
 
 struct ModulationParameters
@@ -92,6 +92,21 @@ float ModulatorCurve::Value(int samplesIn)
    return ofLerp(GetMin(), GetMax(), val);
 }
 
+void ModulatorCurve::ValueBlock(float* out, int numSamples)
+{
+   mInputSlider->ComputeBlock(out, numSamples); //the input is the only slider
+   const float min = GetMin();
+   const float max = GetMax();
+   for (int i = 0; i < numSamples; ++i)
+   {
+      ADSR::EventInfo adsrEvent(0, kAdsrTime);
+      float val = ofClamp(mAdsr.Value(out[i] * kAdsrTime, &adsrEvent), 0, 1);
+      if (std::isnan(val))
+         val = 0;
+      out[i] = ofLerp(min, max, val);
+   }
+}
+
 void ModulatorCurve::OnClicked(float x, float y, bool right)
 {
    IDrawableModule::OnClicked(x, y, right);
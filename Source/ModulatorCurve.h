@@ -51,6 +51,7 @@ public:
 
    //IModulator
    float Value(int samplesIn = 0) override;
+   void ValueBlock(float* out, int numSamples) override;
    bool Active() const override { return mEnabled; }
 
    FloatSlider* GetTarget() { return GetSliderTarget(); }
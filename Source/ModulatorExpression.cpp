@@ -40,6 +40,13 @@ namespace
 
 ModulatorExpression::ModulatorExpression()
 {
+   for (CompiledExpression* expression : { &mCompiledExpression, &mCompiledExpressionDraw })
+   {
+      for (const char* name : { "x", "t", "a", "b", "c", "d", "e" })
+         expression->AddVariable(name);
+   }
+   for (auto& block : mVariableBlocks)
+      block.resize(gBufferSize);
 }
 
 void ModulatorExpression::CreateUIControls()
@@ -92,6 +99,11 @@ float ModulatorExpression::Value(int samplesIn)
    if (mExpressionValid)
    {
       mT = (gTime + samplesIn * gInvSampleRateMs) * .001;
+      if (mUseCompiledExpression)
+      {
+         BindCompiledVariables(mCompiledExpression, mExpressionInput);
+         return mCompiledExpression.Evaluate();
+      }
       return mExpression.value();
    }
 
@@ -100,6 +112,65 @@ float ModulatorExpression::Value(int samplesIn)
    return 0;
 }
 
+void ModulatorExpression::ValueBlock(float* out, int numSamples)
+{
+   if (!mExpressionValid || !mUseCompiledExpression || numSamples > (int)mVariableBlocks[0].size())
+   {
+      IModulator::ValueBlock(out, numSamples);
+      return;
+   }
+
+   //sliders that aren't moving are bound as single values, so anything that only depends on them gets run once for the whole block
+   FloatSlider* sliders[kNumVariables] = { mExpressionInputSlider, nullptr, mASlider, mBSlider, mCSlider, mDSlider, mESlider };
+   for (int i = 0; i < kNumVariables; ++i)
+   {
+      if (sliders[i] == nullptr || !mCompiledExpression.UsesVariable(i))
+         continue;
+
+      if (sliders[i]->NeedsCompute())
+      {
+         sliders[i]->ComputeBlock(mVariableBlocks[i].data(), numSamples);
+         mCompiledExpression.SetValues(i, mVariableBlocks[i].data());
+      }
+      else
+      {
+         mCompiledExpression.SetValue(i, *sliders[i]->GetVar());
+      }
+   }
+
+   if (mCompiledExpression.UsesVariable(kVariable_T))
+   {
+      float* t = mVariableBlocks[kVariable_T].data();
+      for (int i = 0; i < numSamples; ++i)
+         t[i] = (gTime + i * gInvSampleRateMs) * .001;
+      mCompiledExpression.SetValues(kVariable_T, t);
+   }
+
+   mCompiledExpression.EvaluateBlock(out, numSamples);
+}
+
+void ModulatorExpression::BindCompiledVariables(CompiledExpression& expression, float input) const
+{
+   expression.SetValue(kVariable_X, input);
+   expression.SetValue(kVariable_T, mT);
+   expression.SetValue(kVariable_A, mA);
+   expression.SetValue(kVariable_B, mB);
+   expression.SetValue(kVariable_C, mC);
+   expression.SetValue(kVariable_D, mD);
+   expression.SetValue(kVariable_E, mE);
+}
+
+float ModulatorExpression::EvaluateForDraw(float input)
+{
+   if (mUseCompiledExpression)
+   {
+      BindCompiledVariables(mCompiledExpressionDraw, input);
+      return mCompiledExpressionDraw.Evaluate();
+   }
+   mExpressionInputDraw = input;
+   return mExpressionDraw.value();
+}
+
 void ModulatorExpression::PostRepatch(PatchCableSource* cableSource, bool fromUserClick)
 {
    OnModulatorRepatch();
@@ -114,6 +185,17 @@ void ModulatorExpression::PostRepatch(PatchCableSource* cableSource, bool fromUs
 void ModulatorExpression::TextEntryComplete(TextEntry* entry)
 {
    mExpressionValid = false;
+   mUseCompiledExpression = false;
+
+   //most expressions are plain math that can be run a block at a time. only fall back to exprtk for the rest
+   if (mCompiledExpressionDraw.Compile(mEntryString))
+   {
+      mCompiledExpression.Compile(mEntryString);
+      mUseCompiledExpression = true;
+      mExpressionValid = true;
+      return;
+   }
+
    exprtk::parser<float> parser;
    mExpressionValid = parser.compile(mEntryString, mExpression);
    if (mExpressionValid)
@@ -151,8 +233,7 @@ void ModulatorExpression::DrawModule()
       float drawMaxOutput = mLastDrawMaxOutput;
       for (int i = 0; i <= kGraphWidth; ++i)
       {
-         mExpressionInputDraw = ofMap(i, 0, kGraphWidth, mExpressionInputSlider->GetMin(), mExpressionInputSlider->GetMax());
-         float output = mExpressionDraw.value();
+         float output = EvaluateForDraw(ofMap(i, 0, kGraphWidth, mExpressionInputSlider->GetMin(), mExpressionInputSlider->GetMax()));
          ofVertex(i + kGraphX, ofMap(output, drawMinOutput, drawMaxOutput, kGraphHeight, 0) + kGraphY);
 
          if (i == 0)
@@ -171,8 +252,8 @@ void ModulatorExpression::DrawModule()
       ofEndShape();
 
       ofSetColor(245, 58, 135);
-      mExpressionInputDraw = mExpressionInput;
-      ofCircle(kGraphX + ofMap(mExpressionInputDraw, mExpressionInputSlider->GetMin(), mExpressionInputSlider->GetMax(), 0, kGraphWidth), ofMap(mExpressionDraw.value(), mLastDrawMinOutput, mLastDrawMaxOutput, kGraphHeight, 0) + kGraphY, 3);
+      float input = mExpressionInput;
+      ofCircle(kGraphX + ofMap(input, mExpressionInputSlider->GetMin(), mExpressionInputSlider->GetMax(), 0, kGraphWidth), ofMap(EvaluateForDraw(input), mLastDrawMinOutput, mLastDrawMaxOutput, kGraphHeight, 0) + kGraphY, 3);
       ofPopStyle();
 
       DrawTextNormal(ofToString(drawMinOutput, 2), kGraphX + kGraphWidth * .35f, kGraphY + kGraphHeight - 1);
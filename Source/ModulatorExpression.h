@@ -33,6 +33,9 @@
 #include "ClickButton.h"
 #include "TextEntry.h"
 #include "exprtk.hpp"
+#include "CompiledExpression.h"
+
+#include <array>
 
 class ModulatorExpression : public IDrawableModule, public IFloatSliderListener, public ITextEntryListener, public IModulator
 {
@@ -48,6 +51,7 @@ public:
 
    //IModulator
    float Value(int samplesIn = 0) override;
+   void ValueBlock(float* out, int numSamples) override;
    bool Active() const override { return mEnabled; }
    bool CanAdjustRange() const override { return false; }
 
@@ -69,6 +73,21 @@ private:
    void DrawModule() override;
    void GetModuleDimensions(float& w, float& h) override;
 
+   void BindCompiledVariables(CompiledExpression& expression, float input) const;
+   float EvaluateForDraw(float input);
+
+   enum Variable
+   {
+      kVariable_X,
+      kVariable_T,
+      kVariable_A,
+      kVariable_B,
+      kVariable_C,
+      kVariable_D,
+      kVariable_E,
+      kNumVariables
+   };
+
    float mExpressionInput{ 0 };
    FloatSlider* mExpressionInputSlider{ nullptr };
    float mA{ 0 };
@@ -88,6 +107,10 @@ private:
    exprtk::expression<float> mExpression;
    exprtk::symbol_table<float> mSymbolTableDraw;
    exprtk::expression<float> mExpressionDraw;
+   CompiledExpression mCompiledExpression;
+   CompiledExpression mCompiledExpressionDraw;
+   bool mUseCompiledExpression{ false };
+   std::array<std::vector<float>, kNumVariables> mVariableBlocks;
 
    float mExpressionInputDraw{ 0 };
    float mT{ 0 };
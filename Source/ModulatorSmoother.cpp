@@ -91,6 +91,17 @@ float ModulatorSmoother::Value(int samplesIn)
    return ofClamp(mRamp.Value(gTime + samplesIn * gInvSampleRateMs), GetMin(), GetMax());
 }
 
+void ModulatorSmoother::ValueBlock(float* out, int numSamples)
+{
+   //the ramp only picks up the input when the transport advances, so there's no need to follow it through the block
+   ComputeSliders(0);
+   mRamp.ValueBlock(gTime, gInvSampleRateMs, out, numSamples);
+   const float min = GetMin();
+   const float max = GetMax();
+   for (int i = 0; i < numSamples; ++i)
+      out[i] = ofClamp(out[i], min, max);
+}
+
 void ModulatorSmoother::SaveLayout(ofxJSONElement& moduleInfo)
 {
 }
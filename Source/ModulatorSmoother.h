@@ -53,6 +53,7 @@ public:
 
    //IModulator
    float Value(int samplesIn = 0) override;
+   void ValueBlock(float* out, int numSamples) override;
    bool Active() const override { return mEnabled; }
    bool CanAdjustRange() const override { return false; }
 
@@ -33,9 +33,32 @@
 #include "SynthGlobals.h"
 #include "QuickSpawnMenu.h"
 #include "Prefab.h"
+#include "SaveStateChunks.h"
 
 #include "juce_core/juce_core.h"
 
+int ModuleContainer::sModuleListGeneration = 0;
+
+namespace
+{
+   //holds the mutex for one step of a load, if there is one
+   struct ModuleStepLock
+   {
+      ModuleStepLock(NamedMutex* mutex, const char* locker)
+      : mMutex(mutex)
+      {
+         if (mMutex)
+            mMutex->Lock(locker);
+      }
+      ~ModuleStepLock()
+      {
+         if (mMutex)
+            mMutex->Unlock();
+      }
+      NamedMutex* mMutex;
+   };
+}
+
 ModuleContainer::ModuleContainer()
 {
 }
@@ -74,10 +97,25 @@ void ModuleContainer::PreDrawUnclipped()
 
 void ModuleContainer::DrawModules()
 {
+   //only the main canvas lines up with the draw rect, the ui layer and prefab contents don't
+   bool cull = (this == TheSynth->GetRootContainer());
+   ofRectangle cullRect = TheSynth->GetDrawRect();
+   cullRect.grow(kDrawCullMargin);
+
    for (int i = (int)mModules.size() - 1; i >= 0; --i)
    {
       if (!mModules[i]->AlwaysOnTop())
+      {
+         //skip modules nowhere near the screen. pinned modules place themselves while they draw, so they always draw
+         //their cable sources still need placing though, since cables into visible modules are drawn from them
+         if (cull && !mModules[i]->Pinned() && !mModules[i]->IsWithinRect(cullRect))
+         {
+            for (auto* source : mModules[i]->GetPatchCableSources())
+               source->UpdatePosition(false);
+            continue;
+         }
          mModules[i]->Draw();
+      }
    }
 
    for (int i = (int)mModules.size() - 1; i >= 0; --i)
@@ -148,6 +186,7 @@ void ModuleContainer::Clear()
       }
    }
    mModules.clear();
+   NoteModuleListChanged();
 }
 
 void ModuleContainer::Exit()
@@ -308,6 +347,7 @@ void ModuleContainer::AddModule(IDrawableModule* module)
 {
    mModules.push_back(module);
    MoveToFront(module);
+   NoteModuleListChanged();
    TheSynth->OnModuleAdded(module);
    module->SetOwningContainer(this);
    if (mOwner)
@@ -321,6 +361,7 @@ void ModuleContainer::TakeModule(IDrawableModule* module)
    if (module->GetOwningContainer()->mOwner)
       module->GetOwningContainer()->mOwner->RemoveChild(module);
    RemoveFromVector(module, module->GetOwningContainer()->mModules);
+   NoteModuleListChanged();
 
    std::string newName = GetUniqueName(module->Name(), mModules);
 
@@ -342,6 +383,8 @@ void ModuleContainer::DeleteModule(IDrawableModule* module, bool fail /*= true*/
    if (!module->CanBeDeleted())
       return;
 
+   NoteModuleListChanged();
+
    if (module->HasSpecialDelete())
    {
       module->DoSpecialDelete();
@@ -505,7 +548,7 @@ bool ModuleContainer::IsHigherThan(IDrawableModule* checkFor, IDrawableModule* c
    return false;
 }
 
-void ModuleContainer::LoadModules(const ofxJSONElement& modules)
+void ModuleContainer::LoadModules(const ofxJSONElement& modules, NamedMutex* lockPerModule /*= nullptr*/)
 {
    PerformanceTimer timer;
    {
@@ -515,6 +558,24 @@ void ModuleContainer::LoadModules(const ofxJSONElement& modules)
 
       if (mOwner)
          IClickable::SetLoadContext(mOwner);
+      //modules that can be constructed off the main thread are all built at once first. they don't touch anything
+      //outside themselves until CreateModule() finishes them below, in order, so nothing needs the lock yet
+      std::vector<IDrawableModule*> constructed(modules.size(), nullptr);
+      std::vector<int> offThread;
+      for (int i = 0; i < modules.size(); ++i)
+      {
+         if (modules[i].isObject() && modules[i]["type"].isString() && TheSynth->GetModuleFactory()->CanConstructOffThread(ModuleFactory::FixUpTypeName(modules[i]["type"].asString())))
+            offThread.push_back(i);
+      }
+      if (offThread.size() > 1)
+      {
+         TimerInstance t("construct", timer);
+         RunInParallel((int)offThread.size(), [&modules, &constructed, &offThread](int i)
+                       {
+                          constructed[offThread[i]] = TheSynth->ConstructModule(modules[offThread[i]]);
+                       });
+      }
+
       {
          TimerInstance t("create", timer);
          for (int i = 0; i < modules.size(); ++i)
@@ -522,7 +583,8 @@ void ModuleContainer::LoadModules(const ofxJSONElement& modules)
             try
             {
                TimerInstance t("create " + modules[i]["name"].asString(), timer);
-               IDrawableModule* module = TheSynth->CreateModule(modules[i]);
+               ModuleStepLock lock(lockPerModule, "LoadModules() create");
+               IDrawableModule* module = TheSynth->CreateModule(modules[i], constructed[i]);
                if (module != nullptr)
                {
                   //ofLog() << "create " << module->Name();
@@ -543,6 +605,7 @@ void ModuleContainer::LoadModules(const ofxJSONElement& modules)
             try
             {
                TimerInstance t("setup " + modules[i]["name"].asString(), timer);
+               ModuleStepLock lock(lockPerModule, "LoadModules() setup");
                IDrawableModule* module = FindModule(modules[i]["name"].asString(), true);
                if (module != nullptr)
                {
@@ -566,6 +629,7 @@ void ModuleContainer::LoadModules(const ofxJSONElement& modules)
          for (int i = 0; i < mModules.size(); ++i)
          {
             TimerInstance t(std::string("init ") + mModules[i]->Name(), timer);
+            ModuleStepLock lock(lockPerModule, "LoadModules() init");
             if (mModules[i]->IsSingleton() == false)
                mModules[i]->Init();
          }
@@ -644,33 +708,138 @@ void ModuleContainer::SaveState(FileStreamOut& out)
    IClickable::ClearSaveContext();
 }
 
-void ModuleContainer::LoadState(FileStreamIn& in)
+void ModuleContainer::SaveState(SaveStateChunkWriter& writer, std::uint32_t chunkType, bool onlyDirty /*= false*/)
+{
+   if (mOwner)
+      IClickable::SetSaveContext(mOwner);
+
+   for (auto* module : mModules)
+   {
+      if (module->IsSaveable())
+      {
+         if (onlyDirty && !module->TakeStateDirty())
+            continue;
+
+         writer.SetCurrentModule(module->Name());
+         juce::MemoryBlock block;
+         {
+            FileStreamOut out(block);
+            module->SaveState(out);
+         }
+         writer.AddChunk(chunkType, module->Name(), std::move(block));
+      }
+   }
+
+   IClickable::ClearSaveContext();
+}
+
+void ModuleContainer::ClearStateDirty()
+{
+   for (auto* module : mModules)
+      module->TakeStateDirty();
+}
+
+bool ModuleContainer::HasDirtyModules() const
+{
+   for (auto* module : mModules)
+   {
+      if (module->IsSaveable() && module->IsStateDirty())
+         return true;
+   }
+   return false;
+}
+
+namespace
+{
+   int sModuleContainerLoadStack = 0;
+}
+
+bool ModuleContainer::BeginLoadState(int saveStateRev)
 {
    Prefab::sLastLoadWasPrefab = Prefab::sLoadingPrefab;
 
    bool wasLoadingState = TheSynth->IsLoadingState();
    TheSynth->SetIsLoadingState(true);
 
-   static int sModuleContainerLoadStack = 0;
    ++sModuleContainerLoadStack;
 
+   assert(saveStateRev <= ModularSynth::kSaveStateRev);
+   ModularSynth::sLoadingFileSaveStateRev = saveStateRev;
+   ModularSynth::sLastLoadedFileSaveStateRev = saveStateRev;
+
+   if (mOwner)
+      IClickable::SetLoadContext(mOwner);
+
+   return wasLoadingState;
+}
+
+void ModuleContainer::EndLoadState(bool wasLoadingState)
+{
+   for (auto module : mModules)
+      module->PostLoadState();
+
+   IClickable::ClearLoadContext();
+   TheSynth->SetIsLoadingState(wasLoadingState);
+
+   --sModuleContainerLoadStack;
+
+   if (sModuleContainerLoadStack <= 0)
+      ModularSynth::sLoadingFileSaveStateRev = ModularSynth::kSaveStateRev; //reset to current
+}
+
+void ModuleContainer::LoadState(const std::vector<SaveStateChunkRef>& chunks, int saveStateRev)
+{
+   bool wasLoadingState = BeginLoadState(saveStateRev);
+
+   std::map<SaveStateChunkReader*, std::vector<int>> prefetch;
+   for (const auto& chunk : chunks)
+      prefetch[chunk.mReader].push_back(chunk.mIndex);
+   for (auto& readerChunks : prefetch)
+      readerChunks.first->Prefetch(readerChunks.second);
+
+   for (const auto& chunk : chunks)
+   {
+      const std::string& moduleName = chunk.mReader->GetChunks()[chunk.mIndex].mName;
+      IDrawableModule* module = FindModule(moduleName, false);
+      try
+      {
+         if (module == nullptr)
+            throw LoadStateException();
+
+         //samples in the module find their data through the active reader
+         SaveStateChunkReader::SetActive(chunk.mReader);
+         chunk.mReader->SetCurrentModule(chunk.mIndex);
+         FileStreamIn in(chunk.mReader->GetChunkData(chunk.mIndex));
+         module->LoadState(in, module->LoadModuleSaveStateRev(in));
+      }
+      catch (LoadStateException& e)
+      {
+         //every module has its own chunk, so there's nothing to skip past
+         TheSynth->LogEvent("Error loading state for module \"" + moduleName + "\"", kLogEventType_Error);
+      }
+      chunk.mReader->SetCurrentModule(-1);
+      chunk.mReader->ReleaseChunkData(chunk.mIndex);
+   }
+   SaveStateChunkReader::SetActive(nullptr);
+
+   EndLoadState(wasLoadingState);
+}
+
+void ModuleContainer::LoadState(FileStreamIn& in, NamedMutex* lockPerModule /*= nullptr*/)
+{
    int header;
    in >> header;
-   assert(header <= ModularSynth::kSaveStateRev);
-   ModularSynth::sLoadingFileSaveStateRev = header;
-   ModularSynth::sLastLoadedFileSaveStateRev = header;
+   bool wasLoadingState = BeginLoadState(header);
 
    int savedModules;
    in >> savedModules;
 
-   if (mOwner)
-      IClickable::SetLoadContext(mOwner);
-
    for (int i = 0; i < savedModules; ++i)
    {
       std::string moduleName;
       in >> moduleName;
       //ofLog() << "Loading " << moduleName;
+      ModuleStepLock lock(lockPerModule, "LoadState() module");
       IDrawableModule* module = FindModule(moduleName, false);
       try
       {
@@ -723,16 +892,8 @@ void ModuleContainer::LoadState(FileStreamIn& in)
       }
    }
 
-   for (auto module : mModules)
-      module->PostLoadState();
-
-   IClickable::ClearLoadContext();
-   TheSynth->SetIsLoadingState(wasLoadingState);
-
-   --sModuleContainerLoadStack;
-
-   if (sModuleContainerLoadStack <= 0)
-      ModularSynth::sLoadingFileSaveStateRev = ModularSynth::kSaveStateRev; //reset to current
+   ModuleStepLock lock(lockPerModule, "LoadState() post");
+   EndLoadState(wasLoadingState);
 }
 
 //static
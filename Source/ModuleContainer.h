@@ -31,6 +31,11 @@
 #include "IDrawableModule.h"
 #include "ofxJSONElement.h"
 
+class NamedMutex;
+class SaveStateChunkWriter;
+class SaveStateChunkReader;
+struct SaveStateChunkRef;
+
 class ModuleContainer
 {
 public:
@@ -84,19 +89,33 @@ public:
       return ret;
    }
 
-   void LoadModules(const ofxJSONElement& modules);
+   void LoadModules(const ofxJSONElement& modules, NamedMutex* lockPerModule = nullptr); //with a mutex, it's only held for one module at a time
    ofxJSONElement WriteModules();
    void SaveState(FileStreamOut& out);
-   void LoadState(FileStreamIn& in);
+   void LoadState(FileStreamIn& in, NamedMutex* lockPerModule = nullptr);
+   void SaveState(SaveStateChunkWriter& writer, std::uint32_t chunkType, bool onlyDirty = false); //one chunk per module
+   void LoadState(const std::vector<SaveStateChunkRef>& chunks, int saveStateRev); //chunks can come from several readers, see AutosaveJournal
+   void ClearStateDirty();
+   bool HasDirtyModules() const;
 
+   static constexpr float kDrawCullMargin = 60; //room for beacons and shadows that spill outside of a module's rect
    static constexpr int GetModuleSeparatorLength() { return 13; }
    static const char* GetModuleSeparator() { return "ryanchallinor"; }
    static bool DoesModuleHaveMoreSaveData(FileStreamIn& in);
 
+   //bumped whenever a module is added to or removed from a container or a parent module, so anything mirroring the layout knows to refresh
+   static int GetModuleListGeneration() { return sModuleListGeneration; }
+   static void NoteModuleListChanged() { ++sModuleListGeneration; }
+
 private:
+   bool BeginLoadState(int saveStateRev);
+   void EndLoadState(bool wasLoadingState);
+
    std::vector<IDrawableModule*> mModules;
    IDrawableModule* mOwner{ nullptr };
 
    ofVec2f mDrawOffset;
    float mDrawScale{ 1 };
+
+   static int sModuleListGeneration;
 };
@@ -29,6 +29,7 @@
 #endif
 
 #include "ModuleFactory.h"
+#include "SpawnIndex.h"
 
 #include "LaunchpadKeyboard.h"
 #include "DrumPlayer.h"
@@ -51,6 +52,8 @@
 #include "WhiteKeys.h"
 #include "RingModulator.h"
 #include "Neighborhooder.h"
+#include "NetAudioReceive.h"
+#include "NetAudioSend.h"
 #include "Polyrhythms.h"
 #include "Looper.h"
 #include "Rewriter.h"
@@ -92,10 +95,13 @@
 #include "MultitrackRecorder.h"
 //#include "MidiPlayer.h"
 #include "SamplerGrid.h"
+#include "MultiSampler.h"
 #include "SignalGenerator.h"
 #include "Lissajous.h"
 #include "DebugAudioSource.h"
 #include "TimerDisplay.h"
+#include "ModuleProfilerPanel.h"
+#include "ModuleMemoryPanel.h"
 #include "DrumSynth.h"
 //#include "EigenChorder.h"
 #include "PitchBender.h"
@@ -279,14 +285,16 @@
 #include "ModulatorBinaryValue.h"
 #include "VelocityToDuration.h"
 #include "TapTempo.h"
+#include "SidechainSend.h"
+#include "PresetLibrary.h"
 
 #include <juce_core/juce_core.h>
 
 #include "PulseRouter.h"
 
-#define REGISTER(class, name, type) Register(#name, &(class ::Create), &(class ::CanCreate), type, false, false, class ::AcceptsAudio(), class ::AcceptsNotes(), class ::AcceptsPulses());
-#define REGISTER_HIDDEN(class, name, type) Register(#name, &(class ::Create), &(class ::CanCreate), type, true, false, class ::AcceptsAudio(), class ::AcceptsNotes(), class ::AcceptsPulses());
-#define REGISTER_EXPERIMENTAL(class, name, type) Register(#name, &(class ::Create), &(class ::CanCreate), type, false, true, class ::AcceptsAudio(), class ::AcceptsNotes(), class ::AcceptsPulses());
+#define REGISTER(class, name, type) Register(#name, &(class ::Create), &(class ::CanCreate), type, false, false, class ::AcceptsAudio(), class ::AcceptsNotes(), class ::AcceptsPulses(), class ::CanConstructOffThread());
+#define REGISTER_HIDDEN(class, name, type) Register(#name, &(class ::Create), &(class ::CanCreate), type, true, false, class ::AcceptsAudio(), class ::AcceptsNotes(), class ::AcceptsPulses(), class ::CanConstructOffThread());
+#define REGISTER_EXPERIMENTAL(class, name, type) Register(#name, &(class ::Create), &(class ::CanCreate), type, false, true, class ::AcceptsAudio(), class ::AcceptsNotes(), class ::AcceptsPulses(), class ::CanConstructOffThread());
 
 ModuleFactory::ModuleFactory()
 {
@@ -332,6 +340,7 @@ ModuleFactory::ModuleFactory()
    //REGISTER(Eigenharp, eigenharp, kModuleCategory_Synth);
    REGISTER(Beats, beats, kModuleCategory_Synth);
    REGISTER(Sampler, sampler, kModuleCategory_Synth);
+   REGISTER(MultiSampler, multisampler, kModuleCategory_Synth);
    //REGISTER(NoteTransformer, notetransformer, kModuleCategory_Note);
    REGISTER(SliderSequencer, slidersequencer, kModuleCategory_Instrument);
    REGISTER(VelocityStepSequencer, velocitystepsequencer, kModuleCategory_Note);
@@ -340,6 +349,8 @@ ModuleFactory::ModuleFactory()
    REGISTER(SignalGenerator, signalgenerator, kModuleCategory_Synth);
    REGISTER(Lissajous, lissajous, kModuleCategory_Audio);
    REGISTER(TimerDisplay, timerdisplay, kModuleCategory_Other);
+   REGISTER(ModuleProfilerPanel, moduleprofiler, kModuleCategory_Other);
+   REGISTER(ModuleMemoryPanel, modulememory, kModuleCategory_Other);
    REGISTER(DrumSynth, drumsynth, kModuleCategory_Synth);
    //REGISTER(EigenChorder, eigenchorder, kModuleCategory_Note);
    REGISTER(PitchBender, pitchbender, kModuleCategory_Note);
@@ -513,6 +524,9 @@ ModuleFactory::ModuleFactory()
    REGISTER(ModulatorBinaryValue, binaryvalue, kModuleCategory_Modulator);
    REGISTER(VelocityToDuration, velocitytoduration, kModuleCategory_Note);
    REGISTER(TapTempo, taptempo, kModuleCategory_Other);
+   REGISTER(SidechainSend, sidechainsend, kModuleCategory_Audio);
+   REGISTER(NetAudioSend, netsend, kModuleCategory_Audio);
+   REGISTER(NetAudioReceive, netreceive, kModuleCategory_Audio);
 
    //REGISTER_EXPERIMENTAL(MidiPlayer, midiplayer, kModuleCategory_Instrument);
    REGISTER_HIDDEN(Autotalent, autotalent, kModuleCategory_Audio);
@@ -547,9 +561,15 @@ ModuleFactory::ModuleFactory()
    REGISTER_HIDDEN(ScriptReferenceDisplay, scriptingreference, kModuleCategory_Other);
    REGISTER_HIDDEN(ScriptWarningPopup, scriptwarning, kModuleCategory_Other);
    REGISTER_HIDDEN(MultitrackRecorderTrack, multitrackrecordertrack, kModuleCategory_Audio);
+
+   mSpawnIndex = std::make_unique<SpawnIndex>(mFactoryMap);
+}
+
+ModuleFactory::~ModuleFactory()
+{
 }
 
-void ModuleFactory::Register(std::string type, CreateModuleFn creator, CanCreateModuleFn canCreate, ModuleCategory moduleCategory, bool hidden, bool experimental, bool canReceiveAudio, bool canReceiveNotes, bool canReceivePulses)
+void ModuleFactory::Register(std::string type, CreateModuleFn creator, CanCreateModuleFn canCreate, ModuleCategory moduleCategory, bool hidden, bool experimental, bool canReceiveAudio, bool canReceiveNotes, bool canReceivePulses, bool canConstructOffThread)
 {
    ModuleInfo moduleInfo;
    moduleInfo.mCreatorFn = creator;
@@ -560,6 +580,7 @@ void ModuleFactory::Register(std::string type, CreateModuleFn creator, CanCreate
    moduleInfo.mCanReceiveAudio = canReceiveAudio;
    moduleInfo.mCanReceiveNotes = canReceiveNotes;
    moduleInfo.mCanReceivePulses = canReceivePulses;
+   moduleInfo.mCanConstructOffThread = canConstructOffThread;
    mFactoryMap[type] = moduleInfo;
 }
 
@@ -606,125 +627,9 @@ std::vector<ModuleFactory::Spawnable> ModuleFactory::GetSpawnableModules(ModuleC
    return modules;
 }
 
-namespace
-{
-   bool CheckHeldKeysMatch(juce::String name, std::string heldKeys, bool continuous)
-   {
-      name = name.toLowerCase();
-
-      if (name.isEmpty() || heldKeys.empty())
-         return false;
-
-      if (continuous)
-         return name.contains(heldKeys);
-
-      if (name[0] != heldKeys[0])
-         return false;
-
-      int stringPos = 0;
-      int end = name.indexOfChar('.');
-      if (end == -1)
-         end = name.indexOfChar(' ');
-      if (end == -1)
-         end = name.length() - 1;
-      for (size_t j = 1; j < heldKeys.length(); ++j)
-      {
-         stringPos = name.substring(stringPos + 1, end + 1).indexOfChar(heldKeys[j]);
-         if (stringPos == -1) //couldn't find key in remaining string
-            return false;
-      }
-
-      return true;
-   }
-}
-
 std::vector<ModuleFactory::Spawnable> ModuleFactory::GetSpawnableModules(std::string keys, bool continuousString)
 {
-   std::vector<ModuleFactory::Spawnable> modules{};
-   for (auto iter = mFactoryMap.begin(); iter != mFactoryMap.end(); ++iter)
-   {
-      if ((!iter->second.mIsHidden || gShowDevModules) &&
-          CheckHeldKeysMatch(iter->first, keys, continuousString))
-      {
-         ModuleFactory::Spawnable spawnable{};
-         spawnable.mLabel = iter->first;
-         modules.push_back(spawnable);
-      }
-   }
-
-   std::vector<juce::PluginDescription> vsts;
-   VSTLookup::GetAvailableVSTs(vsts);
-   std::vector<juce::PluginDescription> matchingVsts;
-   for (auto& pluginDesc : vsts)
-   {
-      std::string pluginName = pluginDesc.name.toStdString();
-      if (CheckHeldKeysMatch(pluginName, keys, continuousString))
-         matchingVsts.push_back(pluginDesc);
-   }
-   const int kMaxQuickspawnVstCount = 10;
-   if ((int)matchingVsts.size() > kMaxQuickspawnVstCount)
-      VSTLookup::SortByLastUsed(matchingVsts);
-
-   for (int i = 0; i < (int)matchingVsts.size() && i < kMaxQuickspawnVstCount; ++i)
-   {
-      ModuleFactory::Spawnable spawnable{};
-      auto& pluginDesc = matchingVsts[i];
-      spawnable.mLabel = pluginDesc.name.toStdString();
-      spawnable.mDecorator = "[" + ModuleFactory::Spawnable::GetPluginLabel(pluginDesc) + "]";
-      spawnable.mPluginDesc = pluginDesc;
-      spawnable.mSpawnMethod = SpawnMethod::Plugin;
-      modules.push_back(spawnable);
-   }
-
-   std::vector<Spawnable> prefabs;
-   ModuleFactory::GetPrefabs(prefabs);
-   for (const auto& prefab : prefabs)
-   {
-      if (CheckHeldKeysMatch(prefab.mLabel, keys, continuousString) || keys[0] == ';')
-         modules.push_back(prefab);
-   }
-
-   std::vector<std::string> midicontrollers = MidiController::GetAvailableInputDevices();
-   for (const auto& midicontroller : midicontrollers)
-   {
-      if (CheckHeldKeysMatch(midicontroller, keys, continuousString))
-      {
-         ModuleFactory::Spawnable spawnable{};
-         spawnable.mLabel = midicontroller;
-         spawnable.mDecorator = kMidiControllerSuffix;
-         spawnable.mSpawnMethod = SpawnMethod::MidiController;
-         modules.push_back(spawnable);
-      }
-   }
-
-   std::vector<std::string> effects = TheSynth->GetEffectFactory()->GetSpawnableEffects();
-   for (const auto& effect : effects)
-   {
-      if (CheckHeldKeysMatch(effect, keys, continuousString))
-      {
-         ModuleFactory::Spawnable spawnable{};
-         spawnable.mLabel = effect;
-         spawnable.mDecorator = kEffectChainSuffix;
-         spawnable.mSpawnMethod = SpawnMethod::EffectChain;
-         modules.push_back(spawnable);
-      }
-   }
-
-   std::vector<Spawnable> presets;
-   ModuleFactory::GetPresets(presets);
-   for (const auto& preset : presets)
-   {
-      if (CheckHeldKeysMatch(preset.mLabel, keys, continuousString) || keys[0] == ';')
-         modules.push_back(preset);
-   }
-
-   sort(modules.begin(), modules.end(), Spawnable::CompareAlphabetical);
-
-   std::vector<ModuleFactory::Spawnable> ret;
-   for (size_t i = 0; i < modules.size(); ++i)
-      ret.push_back(modules[i]);
-
-   return ret;
+   return mSpawnIndex->Search(keys, continuousString);
 }
 
 ModuleCategory ModuleFactory::GetModuleCategory(std::string typeName)
@@ -786,50 +691,41 @@ bool ModuleFactory::IsExperimental(std::string typeName)
    return false;
 }
 
+bool ModuleFactory::CanConstructOffThread(const std::string& typeName) const
+{
+   auto moduleInfo = mFactoryMap.find(typeName);
+   return moduleInfo != mFactoryMap.end() && moduleInfo->second.mCanConstructOffThread;
+}
+
 //static
 void ModuleFactory::GetPrefabs(std::vector<ModuleFactory::Spawnable>& prefabs)
 {
-   using namespace juce;
-   File dir(ofToDataPath("prefabs"));
-   Array<File> files;
-   dir.findChildFiles(files, File::findFiles, false);
-   for (auto& file : files)
+   std::vector<PresetLibrary::Entry> entries;
+   PresetLibrary::Get().GetEntries(PresetLibrary::kPrefabType, entries);
+   for (const auto& entry : entries)
    {
-      if (file.getFileExtension() == ".pfb")
-      {
-         ModuleFactory::Spawnable spawnable;
-         spawnable.mLabel = file.getFileName().toStdString();
-         spawnable.mDecorator = kPrefabSuffix;
-         spawnable.mSpawnMethod = SpawnMethod::Prefab;
-         prefabs.push_back(spawnable);
-      }
+      ModuleFactory::Spawnable spawnable;
+      spawnable.mLabel = entry.mName;
+      spawnable.mDecorator = kPrefabSuffix;
+      spawnable.mSpawnMethod = SpawnMethod::Prefab;
+      prefabs.push_back(spawnable);
    }
 }
 
 //static
 void ModuleFactory::GetPresets(std::vector<ModuleFactory::Spawnable>& presets)
 {
-   using namespace juce;
-   File dir(ofToDataPath("presets"));
-   Array<File> directories;
-   dir.findChildFiles(directories, File::findDirectories, false);
-   for (auto& moduleDir : directories)
+   //the label is the path under the module type's folder, so presets tagged with a subfolder can be searched for by it
+   std::vector<PresetLibrary::Entry> entries;
+   PresetLibrary::Get().GetEntries("", entries);
+   for (const auto& entry : entries)
    {
-      std::string moduleTypeName = moduleDir.getFileName().toStdString();
-      Array<File> files;
-      moduleDir.findChildFiles(files, File::findFiles, false);
-      for (auto file : files)
-      {
-         if (file.getFileExtension() == ".preset")
-         {
-            ModuleFactory::Spawnable spawnable;
-            spawnable.mLabel = file.getFileName().toStdString();
-            spawnable.mDecorator = "[" + moduleTypeName + "]";
-            spawnable.mPresetModuleType = moduleTypeName;
-            spawnable.mSpawnMethod = SpawnMethod::Preset;
-            presets.push_back(spawnable);
-         }
-      }
+      ModuleFactory::Spawnable spawnable;
+      spawnable.mLabel = entry.mName;
+      spawnable.mDecorator = "[" + entry.mModuleType + "]";
+      spawnable.mPresetModuleType = entry.mModuleType;
+      spawnable.mSpawnMethod = SpawnMethod::Preset;
+      presets.push_back(spawnable);
    }
 }
 
@@ -30,6 +30,8 @@
 #include "juce_core/juce_core.h"
 #include "juce_audio_processors/juce_audio_processors.h"
 
+class SpawnIndex;
+
 typedef IDrawableModule* (*CreateModuleFn)(void);
 typedef bool (*CanCreateModuleFn)(void);
 
@@ -37,6 +39,7 @@ class ModuleFactory
 {
 public:
    ModuleFactory();
+   ~ModuleFactory();
 
    enum class SpawnMethod
    {
@@ -84,18 +87,21 @@ public:
       bool mCanReceiveAudio{ false };
       bool mCanReceiveNotes{ false };
       bool mCanReceivePulses{ false };
+      bool mCanConstructOffThread{ false };
    };
 
    IDrawableModule* MakeModule(std::string type);
    std::vector<Spawnable> GetSpawnableModules(ModuleCategory moduleCategory);
-   std::vector<Spawnable> GetSpawnableModules(std::string keys, bool continuousString);
+   std::vector<Spawnable> GetSpawnableModules(std::string keys, bool continuousString); //see SpawnIndex
    ModuleCategory GetModuleCategory(std::string typeName);
    ModuleCategory GetModuleCategory(Spawnable spawnable);
    ModuleInfo GetModuleInfo(std::string typeName);
    bool IsExperimental(std::string typeName);
+   bool CanConstructOffThread(const std::string& typeName) const; //safe to call from any thread, the factory doesn't change after startup
    static void GetPrefabs(std::vector<Spawnable>& prefabs);
    static void GetPresets(std::vector<Spawnable>& presets);
    static std::string FixUpTypeName(std::string typeName);
+   SpawnIndex* GetSpawnIndex() { return mSpawnIndex.get(); }
 
    static constexpr const char* kPluginSuffix = "[plugin]";
    static constexpr const char* kPrefabSuffix = "[prefab]";
@@ -103,7 +109,8 @@ public:
    static constexpr const char* kEffectChainSuffix = "[effectchain]";
 
 private:
-   void Register(std::string type, CreateModuleFn creator, CanCreateModuleFn canCreate, ModuleCategory moduleCategory, bool hidden, bool experimental, bool canReceiveAudio, bool canReceiveNotes, bool canReceivePulses);
+   void Register(std::string type, CreateModuleFn creator, CanCreateModuleFn canCreate, ModuleCategory moduleCategory, bool hidden, bool experimental, bool canReceiveAudio, bool canReceiveNotes, bool canReceivePulses, bool canConstructOffThread);
 
    std::map<std::string, ModuleInfo> mFactoryMap;
+   std::unique_ptr<SpawnIndex> mSpawnIndex;
 };
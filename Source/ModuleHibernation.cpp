@@ -0,0 +1,163 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ModuleHibernation.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ModuleHibernation.h"
+#include "IDrawableModule.h"
+#include "ModularSynth.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+
+namespace
+{
+   const double kScanIntervalMs = 1000;
+
+   void AddWithChildren(IDrawableModule* module, std::vector<IDrawableModule*>& out)
+   {
+      out.push_back(module);
+      for (auto* child : module->GetChildren())
+         AddWithChildren(child, out);
+   }
+}
+
+ModuleHibernation& ModuleHibernation::Get()
+{
+   static ModuleHibernation sHibernation;
+   return sHibernation;
+}
+
+void ModuleHibernation::Reset()
+{
+   mIdleSinceMs.clear();
+   mHibernating.clear();
+}
+
+void ModuleHibernation::Poll()
+{
+   double now = juce::Time::getMillisecondCounterHiRes();
+
+   //waking up is checked every frame, the audio thread plays silence in the meantime
+   for (auto it = mHibernating.begin(); it != mHibernating.end();)
+   {
+      IDrawableModule* module = *it;
+      if (module->IsDeleted() || module->IsEnabled() || !module->IsHibernating())
+      {
+         if (!module->IsDeleted())
+            module->WakeModule();
+         mIdleSinceMs.erase(module);
+         it = mHibernating.erase(it);
+      }
+      else
+      {
+         ++it;
+      }
+   }
+
+   if (now - mLastScanMs < kScanIntervalMs)
+      return;
+   mLastScanMs = now;
+
+   int timeoutSeconds = UserPrefs.hibernate_disabled_modules_after_seconds.Get();
+   if (timeoutSeconds <= 0)
+   {
+      for (auto* module : mHibernating)
+         module->WakeModule();
+      Reset();
+      return;
+   }
+
+   std::vector<IDrawableModule*> topLevel;
+   TheSynth->GetAllModules(topLevel);
+   std::vector<IDrawableModule*> modules;
+   for (auto* module : topLevel)
+      AddWithChildren(module, modules);
+
+   std::map<IDrawableModule*, double> idleSinceMs;
+   for (auto* module : modules)
+   {
+      if (module->IsDeleted() || module->IsEnabled() || module->IsHibernating() || !module->CanHibernate())
+         continue;
+
+      auto it = mIdleSinceMs.find(module);
+      double idleSince = it != mIdleSinceMs.end() ? it->second : now;
+      if (now - idleSince >= timeoutSeconds * 1000.0)
+      {
+         module->HibernateModule();
+         mHibernating.push_back(module);
+         continue;
+      }
+      idleSinceMs[module] = idleSince;
+   }
+   mIdleSinceMs = std::move(idleSinceMs); //which drops the ones that have been enabled or deleted since
+}
+
+void ModuleHibernation::Prefetch(IDrawableModule* module)
+{
+   if (module == nullptr)
+      return;
+
+   if (module->IsHibernating())
+   {
+      module->WakeModule();
+      mHibernating.erase(std::remove(mHibernating.begin(), mHibernating.end(), module), mHibernating.end());
+   }
+   mIdleSinceMs[module] = juce::Time::getMillisecondCounterHiRes();
+}
+
+void ModuleHibernation::Touch(IDrawableModule* module)
+{
+   std::vector<IDrawableModule*> modules;
+   AddWithChildren(module, modules);
+   for (auto* touched : modules)
+   {
+      if (touched->IsHibernating() || mIdleSinceMs.count(touched) > 0)
+         Prefetch(touched);
+   }
+}
+
+//static
+void ModuleHibernation::Compress(const juce::MemoryBlock& data, juce::MemoryBlock& compressed)
+{
+   compressed.reset();
+   juce::MemoryOutputStream out(compressed, false);
+   {
+      //fast rather than small, it runs on the main thread. silence, which is what most idle buffers are full of, shrinks to nothing either way
+      juce::GZIPCompressorOutputStream zip(out, 1);
+      zip.write(data.getData(), data.getSize());
+   }
+}
+
+//static
+void ModuleHibernation::Decompress(const juce::MemoryBlock& compressed, juce::MemoryBlock& data)
+{
+   data.reset();
+   juce::MemoryInputStream in(compressed, false);
+   juce::GZIPDecompressorInputStream zip(in);
+   zip.readIntoMemoryBlock(data);
+}
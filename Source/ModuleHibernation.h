@@ -0,0 +1,62 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ModuleHibernation.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+class IDrawableModule;
+
+namespace juce
+{
+   class MemoryBlock;
+}
+
+//lets modules that have been disabled for "hibernate_disabled_modules_after_seconds" let go of their big buffers
+//(see IDrawableModule::CanHibernate()), so a template set can hold a lot more instruments than are playing at once.
+//they're woken as soon as they're enabled again, or a little ahead of that when SongBuilder has a scene queued that enables them
+class ModuleHibernation
+{
+public:
+   static ModuleHibernation& Get();
+
+   void Poll(); //main thread
+   void Prefetch(IDrawableModule* module); //wakes it now, and keeps it awake for a while even if it stays disabled
+   void Touch(IDrawableModule* module); //somebody's working with it, like clicking on it. its children too
+   void Reset(); //for when the layout is cleared
+
+   //for a module's Hibernate() and Wake(), to keep what it lets go of small
+   static void Compress(const juce::MemoryBlock& data, juce::MemoryBlock& compressed);
+   static void Decompress(const juce::MemoryBlock& compressed, juce::MemoryBlock& data);
+
+private:
+   ModuleHibernation() = default;
+
+   std::map<IDrawableModule*, double> mIdleSinceMs; //disabled modules that could hibernate, and when they were last used
+   std::vector<IDrawableModule*> mHibernating;
+   double mLastScanMs{ 0 };
+};
@@ -0,0 +1,145 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ModuleMemoryPanel.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ModuleMemoryPanel.h"
+#include "ModularSynth.h"
+#include "SynthGlobals.h"
+#include "IAudioSource.h"
+
+#include <algorithm>
+
+namespace
+{
+   std::string FormatBytes(size_t bytes)
+   {
+      if (bytes >= 1024 * 1024)
+         return ofToString(bytes / (1024.0f * 1024.0f), 1) + " MB";
+      return ofToString(bytes / 1024.0f, 1) + " KB";
+   }
+}
+
+ModuleMemoryPanel::ModuleMemoryPanel()
+{
+}
+
+void ModuleMemoryPanel::CreateUIControls()
+{
+   IDrawableModule::CreateUIControls();
+   mSortModeSelector = new DropdownList(this, "sort", 3, 3, (int*)(&mSortMode));
+   mShrinkButton = new ClickButton(this, "shrink", mSortModeSelector, kAnchor_Right);
+
+   mSortModeSelector->AddLabel("size", kSort_Size);
+   mSortModeSelector->AddLabel("name", kSort_Name);
+}
+
+void ModuleMemoryPanel::ButtonClicked(ClickButton* button, double time)
+{
+   if (button == mShrinkButton)
+   {
+      std::vector<IDrawableModule*> modules;
+      TheSynth->GetAllModules(modules);
+      for (auto* module : modules)
+      {
+         if (module->CanShrinkMemory())
+            module->ShrinkMemory();
+      }
+   }
+}
+
+void ModuleMemoryPanel::DrawModule()
+{
+   if (Minimized() || IsVisible() == false)
+      return;
+
+   mSortModeSelector->Draw();
+   mShrinkButton->Draw();
+
+   std::vector<IDrawableModule*> modules;
+   TheSynth->GetAllModules(modules);
+
+   struct Entry
+   {
+      std::string mName;
+      size_t mBytes;
+      size_t mTrackedBytes;
+      bool mCanShrink;
+   };
+   std::vector<Entry> entries;
+   size_t totalBytes = 0;
+   for (auto* module : modules)
+   {
+      //every audio module keeps a little history for its cables to draw
+      size_t bytes = module->GetMemoryUsage();
+      if (auto* source = dynamic_cast<IAudioSource*>(module))
+         bytes += source->GetVizBuffer()->GetMemoryUsage();
+      entries.push_back({ module->Path(), bytes, module->GetTrackedAllocationBytes(), module->CanShrinkMemory() });
+      totalBytes += bytes;
+   }
+
+   switch (mSortMode)
+   {
+      case kSort_Size:
+         std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+                   { return a.mBytes > b.mBytes; });
+         break;
+      case kSort_Name:
+         std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+                   { return a.mName < b.mName; });
+         break;
+   }
+
+   float w, h;
+   GetDimensions(w, h);
+
+   ofPushStyle();
+   ofSetColor(255, 255, 255, gModuleDrawAlpha);
+   DrawTextRightJustify("total: " + FormatBytes(totalBytes), w - 3, 14, 11);
+
+   const float kBarX = 160;
+   const float kBarWidth = w - kBarX - 3;
+   size_t largest = entries.empty() ? 0 : std::max_element(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+                                                           { return a.mBytes < b.mBytes; })
+                                               ->mBytes;
+   for (int i = 0; i < kNumRows && i < (int)entries.size(); ++i)
+   {
+      const Entry& entry = entries[i];
+      float y = 24 + i * kRowHeight;
+
+      if (largest > 0)
+      {
+         ofFill();
+         ofSetColor(entry.mCanShrink ? ofColor(255, 160, 0) : ofColor(0, 160, 255), gModuleDrawAlpha * .5f);
+         ofRect(kBarX, y + 2, float(entry.mBytes) / largest * kBarWidth, kRowHeight - 4, 0);
+      }
+
+      ofSetColor(255, 255, 255, gModuleDrawAlpha);
+      DrawTextNormal(entry.mName, 3, y + 11, 11);
+      DrawTextRightJustify(FormatBytes(entry.mBytes), kBarX - 4, y + 11, 11);
+      if (entry.mTrackedBytes > 0)
+         DrawTextNormal("+" + FormatBytes(entry.mTrackedBytes) + " new", kBarX + 2, y + 11, 9);
+   }
+   ofPopStyle();
+}
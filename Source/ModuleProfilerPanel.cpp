@@ -0,0 +1,123 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ModuleProfilerPanel.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ModuleProfilerPanel.h"
+#include "ModularSynth.h"
+#include "SynthGlobals.h"
+#include "IAudioSource.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+ModuleProfilerPanel::ModuleProfilerPanel()
+{
+   Profiler::RequestModuleTiming(true);
+}
+
+ModuleProfilerPanel::~ModuleProfilerPanel()
+{
+   Profiler::RequestModuleTiming(false);
+}
+
+void ModuleProfilerPanel::CreateUIControls()
+{
+   IDrawableModule::CreateUIControls();
+   mSortModeSelector = new DropdownList(this, "sort", 3, 3, (int*)(&mSortMode));
+
+   mSortModeSelector->AddLabel("cpu", kSort_Load);
+   mSortModeSelector->AddLabel("peak", kSort_Peak);
+   mSortModeSelector->AddLabel("name", kSort_Name);
+}
+
+void ModuleProfilerPanel::DrawModule()
+{
+   if (Minimized() || IsVisible() == false)
+      return;
+
+   mSortModeSelector->Draw();
+
+   std::vector<IDrawableModule*> modules;
+   TheSynth->GetAllModules(modules);
+
+   struct Entry
+   {
+      std::string mName;
+      float mLoad;
+      float mPeak;
+   };
+   std::vector<Entry> entries;
+   float totalLoad = 0;
+   for (auto* module : modules)
+   {
+      IAudioSource* source = dynamic_cast<IAudioSource*>(module);
+      if (source == nullptr)
+         continue;
+      entries.push_back({ module->Path(), source->GetCpuLoad(), source->GetCpuLoadPeak() });
+      totalLoad += source->GetCpuLoad();
+   }
+
+   switch (mSortMode)
+   {
+      case kSort_Load:
+         std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+                   { return a.mLoad > b.mLoad; });
+         break;
+      case kSort_Peak:
+         std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+                   { return a.mPeak > b.mPeak; });
+         break;
+      case kSort_Name:
+         std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+                   { return a.mName < b.mName; });
+         break;
+   }
+
+   float w, h;
+   GetDimensions(w, h);
+
+   ofPushStyle();
+   ofSetColor(255, 255, 255, gModuleDrawAlpha);
+   DrawTextRightJustify("total: " + ofToString(totalLoad * 100, 1) + "%", w - 3, 14, 11);
+
+   const float kBarX = 160;
+   const float kBarWidth = w - kBarX - 3;
+   for (int i = 0; i < kNumRows && i < (int)entries.size(); ++i)
+   {
+      const Entry& entry = entries[i];
+      float y = 24 + i * kRowHeight;
+
+      ofFill();
+      ofSetColor(entry.mPeak > .7f ? ofColor(255, 0, 0) : ofColor(0, 160, 0), gModuleDrawAlpha * .5f);
+      ofRect(kBarX, y + 2, MIN(entry.mPeak, 1) * kBarWidth, kRowHeight - 4, 0);
+      ofSetColor(entry.mLoad > .7f ? ofColor(255, 0, 0) : ofColor(0, 255, 0), gModuleDrawAlpha);
+      ofRect(kBarX, y + 2, MIN(entry.mLoad, 1) * kBarWidth, kRowHeight - 4, 0);
+
+      ofSetColor(255, 255, 255, gModuleDrawAlpha);
+      DrawTextNormal(entry.mName, 3, y + 11, 11);
+      DrawTextRightJustify(ofToString(entry.mLoad * 100, 1) + "%", kBarX - 4, y + 11, 11);
+   }
+   ofPopStyle();
+}
@@ -0,0 +1,70 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ModuleProfilerPanel.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "IDrawableModule.h"
+#include "DropdownList.h"
+
+//lists the audio modules by how much of the buffer's time budget each one uses. per-module timing stays on while one of these exists
+class ModuleProfilerPanel : public IDrawableModule, public IDropdownListener
+{
+public:
+   ModuleProfilerPanel();
+   ~ModuleProfilerPanel();
+   static IDrawableModule* Create() { return new ModuleProfilerPanel(); }
+   static bool AcceptsAudio() { return false; }
+   static bool AcceptsNotes() { return false; }
+   static bool AcceptsPulses() { return false; }
+
+   void CreateUIControls() override;
+
+   void DropdownUpdated(DropdownList* list, int oldVal, double time) override {}
+
+   bool IsEnabled() const override { return true; }
+
+private:
+   enum SortMode
+   {
+      kSort_Load,
+      kSort_Peak,
+      kSort_Name
+   };
+
+   //IDrawableModule
+   void DrawModule() override;
+   void GetModuleDimensions(float& width, float& height) override
+   {
+      width = 280;
+      height = 24 + kNumRows * kRowHeight;
+   }
+
+   static const int kNumRows = 16;
+   static const int kRowHeight = 14;
+
+   SortMode mSortMode{ kSort_Load };
+   DropdownList* mSortModeSelector{ nullptr };
+};
@@ -0,0 +1,266 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ModuleRenderCache.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "juce_opengl/juce_opengl.h"
+using namespace juce::gl;
+
+#include "ModuleRenderCache.h"
+#include "IDrawableModule.h"
+#include "IUIControl.h"
+#include "ModularSynth.h"
+#include "PatchCable.h"
+#include "Push2Control.h"
+#include "SynthGlobals.h"
+#include "OpenFrameworksPort.h"
+#include "nanovg/nanovg.h"
+#define NANOVG_GLES2_IMPLEMENTATION
+#include "nanovg/nanovg_gl.h"
+#include "nanovg/nanovg_gl_utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+   const int kStableFramesBeforeCaching = 3;
+   const int kMaxFramebufferSize = 2048;
+}
+
+std::vector<ModuleRenderCache*> ModuleRenderCache::sPending;
+std::vector<NVGLUframebuffer*> ModuleRenderCache::sRetiredFramebuffers;
+std::vector<int> ModuleRenderCache::sRetiredImages;
+std::mutex ModuleRenderCache::sMutex;
+
+ModuleRenderCache::ModuleRenderCache(IDrawableModule* owner)
+: mOwner(owner)
+{
+}
+
+ModuleRenderCache::~ModuleRenderCache()
+{
+   std::lock_guard<std::mutex> lock(sMutex);
+   sPending.erase(std::remove(sPending.begin(), sPending.end(), this), sPending.end());
+   RetireFramebuffer();
+}
+
+bool ModuleRenderCache::CanUseCache() const
+{
+   //anything the user is interacting with, or that's showing some kind of mode-dependent overlay, draws live
+   if (Push2Control::sDrawingPush2Display)
+      return false;
+   if (gHoveredModule == mOwner || (gHoveredUIControl != nullptr && gHoveredUIControl->GetModuleParent() == mOwner))
+      return false;
+   if (IKeyboardFocusListener::GetActiveKeyboardFocus() != nullptr || gBindToUIControl != nullptr || PatchCable::sActivePatchCable != nullptr)
+      return false;
+   if (TheSynth->InMidiMapMode() || !TheSynth->GetGroupSelectedModules().empty())
+      return false;
+   if (!mOwner->ShouldClipContents() || !mOwner->mChildren.empty())
+      return false;
+   return true;
+}
+
+uint64_t ModuleRenderCache::CalculateSignature(float w, float h) const
+{
+   uint64_t hash = 14695981039346656037ull;
+   auto mix = [&hash](uint64_t value)
+   {
+      hash ^= value;
+      hash *= 1099511628211ull;
+   };
+   auto mixFloat = [&mix](float value)
+   {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      mix(bits);
+   };
+
+   mixFloat(w);
+   mixFloat(h);
+   mixFloat(mOwner->GetOwningContainer()->GetDrawScale());
+   mixFloat(TheSynth->GetPixelRatio());
+   mixFloat(gModuleDrawAlpha);
+   mix(mDirtyCount);
+   mix(mOwner->Minimized());
+   mix(mOwner->IsEnabled());
+
+   for (auto* control : mOwner->mUIControls)
+   {
+      mix(control->IsShowing());
+      if (!control->IsShowing())
+         continue;
+      float x, y, controlW, controlH;
+      control->GetPosition(x, y, K(local));
+      control->GetDimensions(controlW, controlH);
+      mixFloat(x);
+      mixFloat(y);
+      mixFloat(controlW);
+      mixFloat(controlH);
+      mixFloat(control->GetValue());
+   }
+
+   return hash;
+}
+
+bool ModuleRenderCache::Draw(float w, float h)
+{
+   if (!CanUseCache())
+   {
+      mStableFrames = 0;
+      return false;
+   }
+
+   uint64_t signature = CalculateSignature(w, h);
+   if (mHasCachedImage && signature == mCachedSignature)
+   {
+      NVGpaint paint = nvgImagePattern(gNanoVG, 0, 0, mWidth, mHeight, 0, mFramebuffer->image, 1);
+      nvgBeginPath(gNanoVG);
+      nvgRect(gNanoVG, 0, 0, mWidth, mHeight);
+      nvgFillPaint(gNanoVG, paint);
+      nvgFill(gNanoVG);
+      return true;
+   }
+
+   if (signature == mLastSignature)
+   {
+      ++mStableFrames;
+   }
+   else
+   {
+      mLastSignature = signature;
+      mStableFrames = 0;
+   }
+
+   float pixelRatio = TheSynth->GetPixelRatio();
+   float drawScale = mOwner->GetOwningContainer()->GetDrawScale();
+   bool fitsInFramebuffer = w > 0 && h > 0 && w * drawScale * pixelRatio <= kMaxFramebufferSize && h * drawScale * pixelRatio <= kMaxFramebufferSize;
+   if (mStableFrames >= kStableFramesBeforeCaching && !mQueued && fitsInFramebuffer)
+   {
+      //whatever gets rendered next frame is what this frame drew, since nothing can change on the ui thread in between.
+      //if the audio thread moves a control in that window, the signature won't match next frame and this gets redrawn
+      mWidth = w;
+      mHeight = h;
+      mDrawScale = drawScale;
+      mModuleDrawAlpha = gModuleDrawAlpha;
+      mCachedSignature = signature;
+      mHasCachedImage = false;
+      mQueued = true;
+
+      std::lock_guard<std::mutex> lock(sMutex);
+      sPending.push_back(this);
+   }
+
+   return false;
+}
+
+//static
+void ModuleRenderCache::RenderPending(NVGcontext* vg, float pixelRatio)
+{
+   std::lock_guard<std::mutex> lock(sMutex);
+
+   for (auto* framebuffer : sRetiredFramebuffers)
+      nvgluDeleteFramebuffer(framebuffer);
+   sRetiredFramebuffers.clear();
+   for (int image : sRetiredImages)
+      nvgDeleteImage(vg, image);
+   sRetiredImages.clear();
+
+   if (sPending.empty())
+      return;
+
+   GLint defaultFramebuffer;
+   glGetIntegerv(GL_FRAMEBUFFER_BINDING, &defaultFramebuffer);
+
+   NVGcontext* mainVG = gNanoVG;
+   gNanoVG = vg;
+   for (auto* cache : sPending)
+   {
+      cache->mQueued = false;
+      cache->RenderToFramebuffer(vg, pixelRatio);
+   }
+   sPending.clear();
+   gNanoVG = mainVG;
+
+   glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer);
+}
+
+//static
+void ModuleRenderCache::RetireImage(int image)
+{
+   std::lock_guard<std::mutex> lock(sMutex);
+   sRetiredImages.push_back(image);
+}
+
+void ModuleRenderCache::RenderToFramebuffer(NVGcontext* vg, float pixelRatio)
+{
+   //the mouse may have moved onto the module since it was queued, and hover highlights aren't part of the signature
+   if (!CanUseCache())
+      return;
+
+   int width = (int)ceilf(mWidth * mDrawScale * pixelRatio);
+   int height = (int)ceilf(mHeight * mDrawScale * pixelRatio);
+   if (mFramebuffer == nullptr || width != mFramebufferWidth || height != mFramebufferHeight)
+   {
+      if (mFramebuffer != nullptr)
+         nvgluDeleteFramebuffer(mFramebuffer);
+      mFramebuffer = nvgluCreateFramebuffer(vg, width, height, 0);
+      mFramebufferWidth = width;
+      mFramebufferHeight = height;
+      if (mFramebuffer == nullptr)
+         return;
+   }
+
+   glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer->fbo);
+   glViewport(0, 0, width, height);
+   glClearColor(0, 0, 0, 0);
+   glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+   nvgBeginFrame(vg, width / pixelRatio, height / pixelRatio, pixelRatio);
+
+   //match the state the main frame is drawn with
+   nvgLineCap(vg, NVG_ROUND);
+   nvgLineJoin(vg, NVG_ROUND);
+   nvgTextLetterSpacing(vg, -.3f);
+   nvgScale(vg, mDrawScale, mDrawScale);
+
+   float mainModuleDrawAlpha = gModuleDrawAlpha;
+   gModuleDrawAlpha = mModuleDrawAlpha;
+   ofPushStyle();
+   ofSetColor(IDrawableModule::GetColor(mOwner->GetModuleCategory()), mModuleDrawAlpha);
+   mOwner->DrawModule();
+   ofPopStyle();
+   gModuleDrawAlpha = mainModuleDrawAlpha;
+
+   nvgEndFrame(vg);
+
+   mHasCachedImage = true;
+}
+
+void ModuleRenderCache::RetireFramebuffer()
+{
+   if (mFramebuffer != nullptr)
+      sRetiredFramebuffers.push_back(mFramebuffer);
+   mFramebuffer = nullptr;
+   mHasCachedImage = false;
+}
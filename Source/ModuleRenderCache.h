@@ -0,0 +1,84 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ModuleRenderCache.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class IDrawableModule;
+struct NVGcontext;
+struct NVGLUframebuffer;
+
+//keeps what a module's DrawModule() drew in an offscreen framebuffer, so a module that hasn't changed can be composited
+//as one textured rect instead of reissuing all of its paths every frame.
+//the cache is only used once a module's contents have held still for a few frames. anything that changes every frame just draws live.
+class ModuleRenderCache
+{
+public:
+   explicit ModuleRenderCache(IDrawableModule* owner);
+   ~ModuleRenderCache();
+
+   //main pass, with the module's transform and clip already applied. returns false if the caller should draw the contents itself
+   bool Draw(float w, float h);
+
+   //something DrawModule() shows changed in a way the module's controls don't reflect. safe to call from any thread
+   void MarkDirty() { ++mDirtyCount; }
+
+   //render thread, before the main nanovg frame begins. redraws every cache that was queued during the previous frame
+   static void RenderPending(NVGcontext* vg, float pixelRatio);
+
+   //for nanovg images that modules make themselves, and that need deleting from a destructor that isn't on the render thread
+   static void RetireImage(int image);
+
+private:
+   bool CanUseCache() const;
+   uint64_t CalculateSignature(float w, float h) const;
+   void RenderToFramebuffer(NVGcontext* vg, float pixelRatio);
+   void RetireFramebuffer();
+
+   IDrawableModule* mOwner{ nullptr };
+   NVGLUframebuffer* mFramebuffer{ nullptr };
+   int mFramebufferWidth{ 0 };
+   int mFramebufferHeight{ 0 };
+   float mWidth{ 0 };
+   float mHeight{ 0 };
+   float mDrawScale{ 1 };
+   float mModuleDrawAlpha{ 255 };
+   uint64_t mCachedSignature{ 0 };
+   bool mHasCachedImage{ false };
+   uint64_t mLastSignature{ 0 };
+   int mStableFrames{ 0 };
+   bool mQueued{ false };
+   std::atomic<uint32_t> mDirtyCount{ 0 };
+
+   static std::vector<ModuleRenderCache*> sPending;
+   static std::vector<NVGLUframebuffer*> sRetiredFramebuffers; //deleted on the render thread, where the gl context is current
+   static std::vector<int> sRetiredImages;
+   static std::mutex sMutex;
+};
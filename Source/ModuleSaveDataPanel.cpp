@@ -32,6 +32,7 @@
 #include "IDrivableSequencer.h"
 #include "ModularSynth.h"
 #include "PatchCableSource.h"
+#include "PresetLibrary.h"
 
 #include <cstring>
 
@@ -230,7 +231,15 @@ void ModuleSaveDataPanel::Poll()
 //static
 void ModuleSaveDataPanel::LoadPreset(IDrawableModule* module, std::string presetFilePath)
 {
-   FileStreamIn presetFile(presetFilePath);
+   //out of the preset archive, so switching presets while playing doesn't wait on the disk
+   juce::MemoryBlock data;
+   if (!PresetLibrary::Get().ReadData(presetFilePath, data))
+   {
+      TheSynth->LogEvent("Couldn't open " + presetFilePath, kLogEventType_Error);
+      return;
+   }
+
+   FileStreamIn presetFile(data);
    presetFile >> ModularSynth::sLoadingFileSaveStateRev;
    TheSynth->SetIsLoadingState(true);
    PatchCableSource::sIsLoadingModulePreset = true;
@@ -336,13 +345,16 @@ void ModuleSaveDataPanel::ButtonClicked(ClickButton* button, double time)
       if (chooser.browseForFileToSave(true))
       {
          std::string path = chooser.getResult().getFullPathName().toStdString();
-         FileStreamOut output(path);
-
-         output << ModularSynth::kSaveStateRev;
-         mSaveModule->SaveState(output);
+         {
+            FileStreamOut output(path);
+            output << ModularSynth::kSaveStateRev;
+            mSaveModule->SaveState(output);
+         }
+         PresetLibrary::Get().NoteChanged();
 
          RefreshPresetFiles();
 
+         mPresetFileIndex = -1;
          for (size_t i = 0; i < mPresetFilePaths.size(); ++i)
          {
             if (mPresetFilePaths[i] == path)
@@ -351,6 +363,12 @@ void ModuleSaveDataPanel::ButtonClicked(ClickButton* button, double time)
                break;
             }
          }
+         if (mPresetFileIndex == -1) //new, and not in the library until it's rescanned
+         {
+            mPresetFileIndex = (int)mPresetFilePaths.size();
+            mPresetFileSelector->AddLabel(juce::File(path).getFileName().toStdString(), mPresetFileIndex);
+            mPresetFilePaths.push_back(path);
+         }
       }
    }
 }
@@ -415,19 +433,14 @@ void ModuleSaveDataPanel::RefreshPresetFiles()
    if (mSaveModule == nullptr)
       return;
 
-   juce::File(ofToDataPath("presets/" + mSaveModule->GetTypeName())).createDirectory();
    mPresetFilePaths.clear();
    mPresetFileSelector->Clear();
-   juce::Array<juce::File> fileList;
-   for (const auto& entry : juce::RangedDirectoryIterator{ juce::File{ ofToDataPath("presets/" + mSaveModule->GetTypeName()) }, false, "*.preset" })
-   {
-      fileList.add(entry.getFile());
-   }
-   fileList.sort();
-   for (const auto& file : fileList)
+   std::vector<PresetLibrary::Entry> entries;
+   PresetLibrary::Get().GetEntries(mSaveModule->GetTypeName(), entries);
+   for (const auto& entry : entries)
    {
-      mPresetFileSelector->AddLabel(file.getFileName().toStdString(), (int)mPresetFilePaths.size());
-      mPresetFilePaths.push_back(file.getFullPathName().toStdString());
+      mPresetFileSelector->AddLabel(entry.mName, (int)mPresetFilePaths.size());
+      mPresetFilePaths.push_back(entry.mPath);
    }
 }
 
@@ -32,10 +32,15 @@ int Monome::sNextMonomeReceivePort = 13338;
 Monome::Monome(MidiDeviceListener* listener)
 : mListener(listener)
 {
+   mLights.SetSender([this](const std::vector<LedFramebuffer::Change>& changes, const LedFramebuffer& lights)
+                     {
+                        SendLights(changes, lights);
+                     });
 }
 
 Monome::~Monome()
 {
+   mLights.SetSender(nullptr);
    OSCReceiver::disconnect();
 }
 
@@ -97,8 +102,7 @@ void Monome::SetLightInternal(int x, int y, float value)
 
    Vec2i pos = Rotate(x, y, mGridRotation);
    int index = pos.x + pos.y * mMaxColumns;
-   mLights[index].mValue = value;
-   mLights[index].mLastUpdatedTime = NextBufferTime(false);
+   mLights.Set(index, ofClamp(int(value * 16), 0, 15));
 }
 
 void Monome::SetLight(int x, int y, float value)
@@ -106,30 +110,58 @@ void Monome::SetLight(int x, int y, float value)
    SetLightInternal(x, y, value);
 }
 
-void Monome::Poll()
+//led output thread
+void Monome::SendLights(const std::vector<LedFramebuffer::Change>& changes, const LedFramebuffer& lights)
 {
-   int updatedLightCount = 0;
-   for (int i = 0; i < (int)mLights.size(); ++i)
-   {
-      int index = (i * 13 + TheSynth->GetFrameCount() * 7) % (int)mLights.size();
+   if (!mHasMonome || mMaxColumns <= 0)
+      return;
 
-      if (mLights[index].mLastUpdatedTime > mLights[index].mLastSentTime)
+   //serialosc can set a whole 8x8 quad in one message, so a busy quad goes out that way, and a quiet one light by light
+   const int kQuadSize = 8;
+   const int kMinChangesForQuad = 6;
+   int columns = mMaxColumns;
+   int rows = lights.GetNumLeds() / columns;
+   int quadsAcross = (columns + kQuadSize - 1) / kQuadSize;
+   int quadsDown = (rows + kQuadSize - 1) / kQuadSize;
+   std::vector<int> changesPerQuad(quadsAcross * quadsDown, 0);
+   for (const auto& change : changes)
+      ++changesPerQuad[(change.mIndex % columns) / kQuadSize + (change.mIndex / columns) / kQuadSize * quadsAcross];
+
+   juce::OSCBundle bundle;
+   for (int quad = 0; quad < (int)changesPerQuad.size(); ++quad)
+   {
+      if (changesPerQuad[quad] < kMinChangesForQuad)
+         continue;
+
+      int offsetX = quad % quadsAcross * kQuadSize;
+      int offsetY = quad / quadsAcross * kQuadSize;
+      juce::OSCMessage mapMsg("/" + mPrefix + "/grid/led/level/map");
+      mapMsg.addInt32(offsetX);
+      mapMsg.addInt32(offsetY);
+      for (int y = offsetY; y < offsetY + kQuadSize; ++y)
       {
-         juce::OSCMessage lightMsg("/" + mPrefix + "/grid/led/level/set");
-         lightMsg.addInt32(index % mMaxColumns);
-         lightMsg.addInt32(index / mMaxColumns);
-         lightMsg.addInt32(mLights[index].mValue * 16);
-         bool written = mToMonome.send(lightMsg);
-         assert(written);
-
-         mLights[index].mLastSentTime = gTime;
-         ++updatedLightCount;
+         for (int x = offsetX; x < offsetX + kQuadSize; ++x)
+            mapMsg.addInt32(x < columns && y < rows ? lights.GetSent(x + y * columns) : 0);
       }
+      bundle.addElement(mapMsg);
+   }
 
-      static float kRateLimit = 8;
-      if (updatedLightCount > kRateLimit)
-         break;
+   for (const auto& change : changes)
+   {
+      int x = change.mIndex % columns;
+      int y = change.mIndex / columns;
+      if (changesPerQuad[x / kQuadSize + y / kQuadSize * quadsAcross] >= kMinChangesForQuad)
+         continue;
+
+      juce::OSCMessage lightMsg("/" + mPrefix + "/grid/led/level/set");
+      lightMsg.addInt32(x);
+      lightMsg.addInt32(y);
+      lightMsg.addInt32(change.mValue);
+      bundle.addElement(lightMsg);
    }
+
+   bool written = mToMonome.send(bundle);
+   assert(written);
 }
 
 void Monome::SetLightFlicker(int x, int y, float intensity)
@@ -226,8 +258,7 @@ void Monome::ConnectToDevice(std::string deviceDesc)
    setTiltMsg.addInt32(1);
    mToMonome.send(setTiltMsg);*/
 
-   for (auto& light : mLights)
-      light.mLastSentTime = 0;
+   mLights.Invalidate();
 }
 
 bool Monome::Reconnect()
@@ -301,7 +332,7 @@ void Monome::oscMessageReceived(const juce::OSCMessage& msg)
       else
          mMaxColumns = msg[1].getInt32();
 
-      mLights.resize(msg[0].getInt32() * msg[1].getInt32());
+      mLights.Resize(msg[0].getInt32() * msg[1].getInt32());
       mLightsInitialized = true;
    }
    else if (label == "/" + mPrefix + "/grid/key")
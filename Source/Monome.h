@@ -27,6 +27,7 @@
 
 #include "MidiDevice.h"
 #include "INonstandardController.h"
+#include "LedFramebuffer.h"
 
 #include "juce_osc/juce_osc.h"
 
@@ -45,7 +46,6 @@ public:
    Monome(MidiDeviceListener* listener);
    ~Monome();
 
-   void Poll() override;
    bool SetUpOsc();
    void ListMonomes();
    void SetLight(int x, int y, float value);
@@ -67,6 +67,7 @@ public:
 
 private:
    void SetLightInternal(int x, int y, float value);
+   void SendLights(const std::vector<LedFramebuffer::Change>& changes, const LedFramebuffer& lights);
    Vec2i Rotate(int x, int y, int rotations);
 
    static int sNextMonomeReceivePort;
@@ -103,12 +104,5 @@ private:
    DropdownList* mListForMidiController{ nullptr };
    MonomeDevice mLastConnectedDeviceInfo;
 
-   struct LightInfo
-   {
-      float mValue{ 0 };
-      double mLastUpdatedTime{ 0 };
-      double mLastSentTime{ 0 };
-   };
-
-   std::vector<LightInfo> mLights;
+   LedFramebuffer mLights{ 0 }; //levels, 0-15
 };
@@ -28,33 +28,38 @@
 #include "Profiler.h"
 
 MultiBandTracker::MultiBandTracker()
+: mWorkBuffer(gBufferSize)
 {
+   mCrossovers.SetPhaseCompensation(false); //only the levels are used
    SetNumBands(8);
-
-   mWorkBuffer = new float[gBufferSize];
 }
 
 MultiBandTracker::~MultiBandTracker()
 {
-   delete[] mWorkBuffer;
 }
 
 void MultiBandTracker::SetRange(float minFreq, float maxFreq)
 {
+   mMinFreq = minFreq;
+   mMaxFreq = maxFreq;
+
+   float frequencies[CrossoverBank::kMaxCrossovers];
    for (int i = 0; i < mNumBands; ++i)
    {
       float a = float(i) / mNumBands;
-      float f = mMinFreq * powf(mMaxFreq / mMinFreq, a);
-      mBands[i].SetCrossoverFreq(f);
+      frequencies[i] = mMinFreq * powf(mMaxFreq / mMinFreq, a);
    }
+   mCrossovers.SetCrossoverFrequencies(frequencies, mNumBands);
 }
 
 void MultiBandTracker::SetNumBands(int numBands)
 {
    mMutex.lock();
-   mNumBands = numBands;
-   mBands.resize(numBands);
-   mPeaks.resize(numBands);
+   mNumBands = ofClamp(numBands, 0, CrossoverBank::kMaxCrossovers);
+   const float kPeakHalfLifeMs = 10;
+   mPeaks.resize(mNumBands);
+   for (auto& peak : mPeaks)
+      peak.SetRelease(kPeakHalfLifeMs / M_LN2);
    SetRange(mMinFreq, mMaxFreq);
    mMutex.unlock();
 }
@@ -65,15 +70,17 @@ void MultiBandTracker::Process(float* buffer, int bufferSize)
 
    mMutex.lock();
 
-   for (int i = 0; i < bufferSize; ++i)
+   if ((int)mWorkBuffer.size() < bufferSize)
+      mWorkBuffer.resize(bufferSize);
+
+   const float* input = buffer;
+   mCrossovers.Process(&input, 1, bufferSize);
+   for (int j = 0; j < mNumBands; ++j)
    {
-      float lower;
-      float highLeftover = buffer[i];
-      for (int j = 0; j < mNumBands; ++j)
-      {
-         mBands[j].ProcessSample(highLeftover, lower, highLeftover);
-         mPeaks[j].Process(&lower, 1);
-      }
+      const float* band = mCrossovers.GetBand(j, 0);
+      for (int i = 0; i < bufferSize; ++i)
+         mWorkBuffer[i] = fabsf(band[i]);
+      mPeaks[j].Process(mWorkBuffer.data(), mWorkBuffer.data(), bufferSize);
    }
 
    mMutex.unlock();
@@ -81,5 +88,5 @@ void MultiBandTracker::Process(float* buffer, int bufferSize)
 
 float MultiBandTracker::GetBand(int idx)
 {
-   return mPeaks[idx].GetPeak();
+   return mPeaks[idx].GetValue();
 }
@@ -26,8 +26,7 @@
 #pragma once
 
 #include "OpenFrameworksPort.h"
-#include "LinkwitzRileyFilter.h"
-#include "PeakTracker.h"
+#include "DynamicsCore.h"
 
 class MultiBandTracker
 {
@@ -42,11 +41,11 @@ public:
    int NumBands() { return mNumBands; }
 
 private:
-   std::vector<CLinkwitzRiley_4thOrder> mBands;
-   std::vector<PeakTracker> mPeaks;
+   CrossoverBank mCrossovers;
+   std::vector<EnvelopeFollower> mPeaks;
    int mNumBands{ 8 };
    float mMinFreq{ 150 };
    float mMaxFreq{ 15000 };
-   float* mWorkBuffer{ nullptr };
+   std::vector<float> mWorkBuffer;
    ofMutex mMutex;
 };
@@ -0,0 +1,437 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    MultiSampleMap.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "MultiSampleMap.h"
+#include "ModularSynth.h"
+#include "Sample.h"
+#include "SynthGlobals.h"
+#include "ofxJSONElement.h"
+
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+   constexpr int kNumKeys = 128;
+   constexpr int kNumVelocities = 128;
+
+   //drops // and /* */ comments, and puts headers on their own lines so they split off from the opcodes around them
+   std::string PrepareSfzText(const std::string& text)
+   {
+      std::string out;
+      out.reserve(text.size());
+      for (size_t i = 0; i < text.size(); ++i)
+      {
+         if (text.compare(i, 2, "/*") == 0)
+         {
+            size_t end = text.find("*/", i + 2);
+            i = (end == std::string::npos) ? text.size() : end + 1;
+         }
+         else if (text.compare(i, 2, "//") == 0)
+         {
+            size_t end = text.find('\n', i);
+            i = (end == std::string::npos) ? text.size() : end - 1;
+         }
+         else if (text[i] == '<')
+         {
+            out += "\n<";
+         }
+         else if (text[i] == '>')
+         {
+            out += ">\n";
+         }
+         else
+         {
+            out += text[i] == '\r' ? '\n' : text[i];
+         }
+      }
+      return out;
+   }
+
+   //sfz keys are midi numbers or note names, with c4 as 60
+   int ParseKey(const std::string& value)
+   {
+      if (value.empty())
+         return -1;
+      char letter = (char)tolower(value[0]);
+      if (letter < 'a' || letter > 'g')
+         return atoi(value.c_str());
+
+      static const int kSemitones[] = { 9, 11, 0, 2, 4, 5, 7 };
+      int pitch = kSemitones[letter - 'a'];
+      size_t pos = 1;
+      if (pos < value.size() && value[pos] == '#')
+      {
+         ++pitch;
+         ++pos;
+      }
+      else if (pos < value.size() && value[pos] == 'b')
+      {
+         --pitch;
+         ++pos;
+      }
+      return pitch + (atoi(value.c_str() + pos) + 1) * 12;
+   }
+
+   template <typename Opcodes>
+   std::string GetString(const Opcodes& opcodes, const char* name, const std::string& defaultValue)
+   {
+      auto it = opcodes.find(name);
+      return it != opcodes.end() ? it->second : defaultValue;
+   }
+
+   template <typename Opcodes>
+   float GetFloat(const Opcodes& opcodes, const char* name, float defaultValue)
+   {
+      auto it = opcodes.find(name);
+      return it != opcodes.end() ? (float)atof(it->second.c_str()) : defaultValue;
+   }
+
+   template <typename Opcodes>
+   int GetInt(const Opcodes& opcodes, const char* name, int defaultValue)
+   {
+      auto it = opcodes.find(name);
+      return it != opcodes.end() ? atoi(it->second.c_str()) : defaultValue;
+   }
+
+   template <typename Opcodes>
+   int GetKey(const Opcodes& opcodes, const char* name, int defaultValue)
+   {
+      auto it = opcodes.find(name);
+      return it != opcodes.end() ? ParseKey(it->second) : defaultValue;
+   }
+}
+
+MultiSampleMap::MultiSampleMap()
+{
+}
+
+MultiSampleMap::~MultiSampleMap()
+{
+}
+
+bool MultiSampleMap::Load(const std::string& path)
+{
+   juce::File file(path);
+   if (!file.existsAsFile())
+   {
+      TheSynth->LogEvent("couldn't find " + path, kLogEventType_Error);
+      return false;
+   }
+
+   bool parsed = file.hasFileExtension("json") ? ParseJson(file) : ParseSfz(file);
+   if (!parsed || mZones.empty())
+   {
+      TheSynth->LogEvent("couldn't find any zones in " + path, kLogEventType_Error);
+      return false;
+   }
+
+   BuildTable();
+   return true;
+}
+
+//supports <control>, <global>, <master>, <group> and <region>, with each level's opcodes applying to the regions under it.
+//#define and #include aren't supported, and the opcodes under other headers are ignored
+bool MultiSampleMap::ParseSfz(const juce::File& file)
+{
+   Opcodes control, global, master, group, region;
+   Opcodes* current = &global;
+   bool inRegion = false;
+
+   auto finishRegion = [&]()
+   {
+      if (!inRegion)
+         return;
+      Opcodes merged = control;
+      for (const Opcodes* level : { &global, &master, &group, &region })
+      {
+         for (const auto& opcode : *level)
+            merged[opcode.first] = opcode.second;
+      }
+      AddZone(merged, file.getParentDirectory());
+      inRegion = false;
+   };
+
+   std::istringstream lines(PrepareSfzText(file.loadFileAsString().toStdString()));
+   std::string line;
+   while (std::getline(lines, line))
+   {
+      std::istringstream words(line);
+      std::string word;
+      std::string* value = nullptr; //values can have spaces in them, the rest of the line up to the next opcode is part of it
+      while (words >> word)
+      {
+         if (value == nullptr && word[0] == '#')
+            break;
+
+         size_t equals = word.find('=');
+         if (word.front() == '<' && word.back() == '>')
+         {
+            finishRegion();
+            std::string header = word.substr(1, word.size() - 2);
+            if (header == "control")
+            {
+               current = &control;
+            }
+            else if (header == "global")
+            {
+               global.clear();
+               master.clear();
+               group.clear();
+               current = &global;
+            }
+            else if (header == "master")
+            {
+               master.clear();
+               group.clear();
+               current = &master;
+            }
+            else if (header == "group")
+            {
+               group.clear();
+               current = &group;
+            }
+            else if (header == "region")
+            {
+               region.clear();
+               current = &region;
+               inRegion = true;
+            }
+            else
+            {
+               current = nullptr;
+            }
+            value = nullptr;
+         }
+         else if (equals != std::string::npos && equals > 0)
+         {
+            value = nullptr;
+            if (current != nullptr)
+            {
+               value = &(*current)[word.substr(0, equals)];
+               *value = word.substr(equals + 1);
+            }
+         }
+         else if (value != nullptr)
+         {
+            *value += " " + word;
+         }
+      }
+   }
+   finishRegion();
+
+   return true;
+}
+
+//a json map takes the same opcodes as an sfz region, as strings or numbers:
+//{ "default_path": "samples/", "zones": [ { "sample": "piano_c4.wav", "lokey": 58, "hikey": 62, "pitch_keycenter": 60 }, ... ] }
+//the top level's opcodes apply to every zone
+bool MultiSampleMap::ParseJson(const juce::File& file)
+{
+   ofxJSONElement root;
+   if (!root.parse(file.loadFileAsString().toStdString()) || !root["zones"].isArray())
+      return false;
+
+   auto readOpcodes = [](const Json::Value& object, Opcodes& opcodes)
+   {
+      for (const auto& name : object.getMemberNames())
+      {
+         const Json::Value& value = object[name];
+         if (value.isString())
+            opcodes[name] = value.asString();
+         else if (value.isNumeric())
+            opcodes[name] = ofToString(value.asDouble());
+      }
+   };
+
+   Opcodes defaults;
+   readOpcodes(root, defaults);
+   for (int i = 0; i < (int)root["zones"].size(); ++i)
+   {
+      Opcodes opcodes = defaults;
+      readOpcodes(root["zones"][i], opcodes);
+      AddZone(opcodes, file.getParentDirectory());
+   }
+
+   return true;
+}
+
+void MultiSampleMap::AddZone(const Opcodes& opcodes, const juce::File& directory)
+{
+   std::string samplePath = GetString(opcodes, "sample", "");
+   if (samplePath.empty() || samplePath[0] == '*') //the built in generators like *sine aren't supported
+      return;
+   samplePath = GetString(opcodes, "default_path", "") + samplePath;
+   std::replace(samplePath.begin(), samplePath.end(), '\\', '/');
+
+   MultiSampleZone zone;
+   zone.mSample = GetSample(directory.getChildFile(samplePath).getFullPathName().toStdString());
+   if (zone.mSample == nullptr)
+      return;
+
+   int key = GetKey(opcodes, "key", -1);
+   if (key >= 0)
+   {
+      zone.mLoKey = key;
+      zone.mHiKey = key;
+      zone.mRootKey = key;
+   }
+   zone.mLoKey = MAX(0, GetKey(opcodes, "lokey", zone.mLoKey));
+   zone.mHiKey = MIN(kNumKeys - 1, GetKey(opcodes, "hikey", zone.mHiKey));
+   zone.mLoVel = MAX(1, GetInt(opcodes, "lovel", zone.mLoVel));
+   zone.mHiVel = MIN(kNumVelocities - 1, GetInt(opcodes, "hivel", zone.mHiVel));
+   if (zone.mLoKey > zone.mHiKey || zone.mLoVel > zone.mHiVel)
+      return;
+
+   zone.mRootKey = GetKey(opcodes, "pitch_keycenter", zone.mRootKey);
+   zone.mKeyTrack = GetFloat(opcodes, "pitch_keytrack", 100) / 100;
+   zone.mTune = GetFloat(opcodes, "transpose", 0) + GetFloat(opcodes, "tune", 0) / 100;
+   zone.mGain = powf(10, GetFloat(opcodes, "volume", 0) / 20);
+   zone.mPan = ofClamp(GetFloat(opcodes, "pan", 0) / 100, -1, 1);
+
+   zone.mStart = MAX(0, GetInt(opcodes, "offset", 0));
+   int end = GetInt(opcodes, "end", -1);
+   if (end >= 0)
+      zone.mEnd = end + 1; //sfz's end is the last sample that plays
+
+   zone.mLoopStart = GetInt(opcodes, "loop_start", GetInt(opcodes, "loopstart", -1));
+   int loopEnd = GetInt(opcodes, "loop_end", GetInt(opcodes, "loopend", -1));
+   if (loopEnd >= 0)
+      zone.mLoopEnd = loopEnd + 1;
+
+   std::string loopMode = GetString(opcodes, "loop_mode", GetString(opcodes, "loopmode", ""));
+   if (loopMode == "one_shot")
+      zone.mLoopMode = MultiSampleLoopMode::OneShot;
+   else if (loopMode == "loop_continuous")
+      zone.mLoopMode = MultiSampleLoopMode::Continuous;
+   else if (loopMode == "loop_sustain")
+      zone.mLoopMode = MultiSampleLoopMode::Sustain;
+   else if (loopMode.empty() && zone.mLoopStart >= 0 && zone.mLoopEnd > zone.mLoopStart)
+      zone.mLoopMode = MultiSampleLoopMode::Continuous;
+
+   zone.mSequenceLength = MAX(1, GetInt(opcodes, "seq_length", 1));
+   zone.mSequencePosition = MIN(MAX(1, GetInt(opcodes, "seq_position", 1)), zone.mSequenceLength);
+   zone.mLoRand = GetFloat(opcodes, "lorand", 0);
+   zone.mHiRand = GetFloat(opcodes, "hirand", 1);
+
+   mZones.push_back(zone);
+}
+
+Sample* MultiSampleMap::GetSample(const std::string& path)
+{
+   auto existing = mSamplesByPath.find(path);
+   if (existing != mSamplesByPath.end())
+      return existing->second;
+
+   //zones often share a sample, each file is only read once
+   Sample* sample = nullptr;
+   auto read = std::make_unique<Sample>();
+   if (juce::File(path).existsAsFile() && read->Read(path.c_str()))
+   {
+      sample = read.get();
+      mSamples.push_back(std::move(read));
+   }
+   else
+   {
+      TheSynth->LogEvent("couldn't read " + path, kLogEventType_Error);
+   }
+   mSamplesByPath[path] = sample;
+   return sample;
+}
+
+void MultiSampleMap::BuildTable()
+{
+   std::vector<std::vector<int>> cellZones(kNumKeys * kNumVelocities);
+   for (int i = 0; i < (int)mZones.size(); ++i)
+   {
+      const MultiSampleZone& zone = mZones[i];
+      for (int key = zone.mLoKey; key <= zone.mHiKey; ++key)
+      {
+         for (int velocity = zone.mLoVel; velocity <= zone.mHiVel; ++velocity)
+            cellZones[key * kNumVelocities + velocity].push_back(i);
+      }
+   }
+
+   mCells.assign(cellZones.size(), Cell());
+   mCellZones.clear();
+   for (size_t i = 0; i < cellZones.size(); ++i)
+   {
+      mCells[i].mFirst = (int)mCellZones.size();
+      mCells[i].mCount = (int)cellZones[i].size();
+      mCellZones.insert(mCellZones.end(), cellZones[i].begin(), cellZones[i].end());
+   }
+}
+
+//audio thread
+int MultiSampleMap::ChooseZones(int pitch, int velocity, std::array<const MultiSampleZone*, kMaxLayers>& zones)
+{
+   if (mCells.empty())
+      return 0;
+
+   pitch = MIN(MAX(pitch, 0), kNumKeys - 1);
+   velocity = MIN(MAX(velocity, 1), kNumVelocities - 1);
+   const Cell& cell = mCells[pitch * kNumVelocities + velocity];
+   int sequence = mRoundRobin[pitch];
+   mRoundRobin[pitch] = (sequence + 1) % (1 << 24);
+   float random = gRandom01(gRandom);
+
+   int numZones = 0;
+   for (int i = 0; i < cell.mCount && numZones < kMaxLayers; ++i)
+   {
+      const MultiSampleZone& zone = mZones[mCellZones[cell.mFirst + i]];
+      if (sequence % zone.mSequenceLength + 1 != zone.mSequencePosition)
+         continue;
+      if (random < zone.mLoRand || random >= zone.mHiRand)
+         continue;
+      zones[numZones++] = &zone;
+   }
+   return numZones;
+}
+
+int MultiSampleMap::GetNumSamplesLoading() const
+{
+   int loading = 0;
+   for (const auto& sample : mSamples)
+   {
+      if (sample->IsSampleLoading())
+         ++loading;
+   }
+   return loading;
+}
+
+bool MultiSampleMap::HasZonesForKey(int pitch) const
+{
+   if (mCells.empty())
+      return false;
+   for (int velocity = 1; velocity < kNumVelocities; ++velocity)
+   {
+      if (mCells[pitch * kNumVelocities + velocity].mCount > 0)
+         return true;
+   }
+   return false;
+}
@@ -0,0 +1,117 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    MultiSampleMap.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Sample;
+
+namespace juce
+{
+   class File;
+}
+
+enum class MultiSampleLoopMode
+{
+   NoLoop,
+   OneShot, //plays to the end, ignoring note offs
+   Continuous,
+   Sustain //loops until the note is released, then plays out
+};
+
+//one region of a multisample, and the keys and velocities that play it
+struct MultiSampleZone
+{
+   Sample* mSample{ nullptr };
+   int mLoKey{ 0 };
+   int mHiKey{ 127 };
+   int mLoVel{ 1 };
+   int mHiVel{ 127 };
+   float mRootKey{ 60 };
+   float mKeyTrack{ 1 }; //semitones per key
+   float mTune{ 0 }; //semitones, tune and transpose together
+   float mGain{ 1 };
+   float mPan{ 0 };
+   int mStart{ 0 };
+   int mEnd{ -1 }; //exclusive, -1 for the end of the sample
+   MultiSampleLoopMode mLoopMode{ MultiSampleLoopMode::NoLoop };
+   int mLoopStart{ -1 };
+   int mLoopEnd{ -1 }; //exclusive
+   int mSequenceLength{ 1 }; //round robin: plays every mSequenceLength notes on a key, on the mSequencePosition'th
+   int mSequencePosition{ 1 };
+   float mLoRand{ 0 }; //random round robin: plays when a note's random number is in [mLoRand, mHiRand)
+   float mHiRand{ 1 };
+};
+
+//the zones of an sfz file or a json map, and the samples they play. every key and velocity has its list of candidate zones
+//worked out at load, so starting a note is a table lookup however many zones there are.
+//samples are read in a SampleLoader batch, so they decode in the background into the memory-mapped SampleCache
+class MultiSampleMap
+{
+public:
+   MultiSampleMap();
+   ~MultiSampleMap();
+
+   static constexpr int kMaxLayers = 8; //zones that can sound for one note
+
+   bool Load(const std::string& path); //logs why and returns false if the file can't be read or has no zones
+
+   //audio thread. the zones a note plays, with the key's round robin advanced. returns how many of zones it filled
+   int ChooseZones(int pitch, int velocity, std::array<const MultiSampleZone*, kMaxLayers>& zones);
+
+   int GetNumZones() const { return (int)mZones.size(); }
+   const MultiSampleZone& GetZone(int index) const { return mZones[index]; }
+   int GetNumSamples() const { return (int)mSamples.size(); }
+   int GetNumSamplesLoading() const;
+   bool HasZonesForKey(int pitch) const;
+
+private:
+   using Opcodes = std::map<std::string, std::string>;
+
+   bool ParseSfz(const juce::File& file);
+   bool ParseJson(const juce::File& file);
+   void AddZone(const Opcodes& opcodes, const juce::File& directory);
+   Sample* GetSample(const std::string& path);
+   void BuildTable();
+
+   struct Cell
+   {
+      int mFirst{ 0 }; //into mCellZones
+      int mCount{ 0 };
+   };
+
+   std::vector<MultiSampleZone> mZones;
+   std::vector<std::unique_ptr<Sample>> mSamples;
+   std::map<std::string, Sample*> mSamplesByPath;
+   std::vector<Cell> mCells; //128 keys by 128 velocities
+   std::vector<int> mCellZones;
+   std::array<int, 128> mRoundRobin{};
+};
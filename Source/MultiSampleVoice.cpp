@@ -0,0 +1,183 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    MultiSampleVoice.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "MultiSampleVoice.h"
+#include "SynthGlobals.h"
+#include "Scale.h"
+#include "Profiler.h"
+#include "ChannelBuffer.h"
+#include "Sample.h"
+#include "CpuGovernor.h"
+
+MultiSampleVoice::MultiSampleVoice(IDrawableModule* owner)
+: mOwner(owner)
+{
+}
+
+MultiSampleVoice::~MultiSampleVoice()
+{
+}
+
+bool MultiSampleVoice::IsDone(double time)
+{
+   return mNumLayers == 0 || mAdsr.IsDone(time);
+}
+
+bool MultiSampleVoice::Process(double time, ChannelBuffer* out, int oversampling)
+{
+   PROFILER(MultiSampleVoice);
+
+   if (IsDone(time))
+      return false;
+
+   int bufferSize = out->BufferSize();
+   if ((int)mGain.size() < bufferSize)
+   {
+      mGain.resize(bufferSize);
+      mResampled.resize(bufferSize);
+   }
+
+   if (mOwner)
+      mOwner->ComputeSliders(0);
+
+   mAdsr.RenderBlock(time, mGain.data(), bufferSize, gInvSampleRateMs);
+   float volSq = mVoiceParams->mVol * mVoiceParams->mVol;
+   float pitch = GetPitch(0);
+   ResampleQuality quality = mVoiceParams->mResampleQuality;
+   if (GetDegradeLevel() >= CpuGovernor::kLevel_ReduceQuality)
+      quality = GetCheaperQuality(quality);
+
+   //the pitch is only worked out once a block, so each layer can be resampled at a constant rate
+   int numPlaying = 0;
+   for (int i = 0; i < mNumLayers; ++i)
+   {
+      Layer& layer = mLayers[i];
+      const MultiSampleZone* zone = layer.mZone;
+      ChannelBuffer* data = zone->mSample->Data();
+      float zonePitch = zone->mRootKey + (pitch - zone->mRootKey) * zone->mKeyTrack + zone->mTune;
+      double rate = TheScale->PitchToFreq(zonePitch) / TheScale->PitchToFreq(zone->mRootKey) * zone->mSample->GetSampleRateRatio();
+      bool loop = layer.mLoopEnd > layer.mLoopStart &&
+                  (zone->mLoopMode == MultiSampleLoopMode::Continuous || (zone->mLoopMode == MultiSampleLoopMode::Sustain && !mReleased));
+      float pan = ofClamp(GetPan() + zone->mPan, -1, 1);
+
+      double pos = layer.mPos;
+      for (int ch = 0; ch < 2; ++ch)
+      {
+         int dataChannel = MIN(ch, data->NumActiveChannels() - 1);
+         if (ch == 0 || dataChannel != 0) //mono samples only need to be resampled once
+            pos = RenderLayer(layer, data->GetChannel(dataChannel), rate, loop, quality, mResampled.data(), bufferSize);
+         float gain = volSq * zone->mGain * (ch == 0 ? GetLeftPanGain(pan) : GetRightPanGain(pan));
+         float* dest = out->GetChannel(ch);
+         for (int s = 0; s < bufferSize; ++s)
+            dest[s] += mResampled[s] * mGain[s] * gain;
+      }
+
+      layer.mPos = pos;
+      if (pos >= 0)
+         mLayers[numPlaying++] = layer;
+   }
+   mNumLayers = numPlaying;
+
+   return true;
+}
+
+//resamples one channel of a layer, in runs split where it loops. returns the position it got to, or -1 if it ran past the end
+double MultiSampleVoice::RenderLayer(const Layer& layer, const float* src, double rate, bool loop, ResampleQuality quality, float* dst, int numSamples) const
+{
+   double pos = layer.mPos;
+   int rendered = 0;
+   while (rendered < numSamples)
+   {
+      int boundary = loop ? layer.mLoopEnd : layer.mEnd;
+      int count = MIN(numSamples - rendered, (int)ceil((boundary - pos) / rate));
+      if (count > 0)
+      {
+         pos = Resample(src, layer.mLength, pos, rate, dst + rendered, count, quality);
+         rendered += count;
+      }
+
+      if (pos >= boundary)
+      {
+         if (!loop)
+         {
+            std::fill(dst + rendered, dst + numSamples, 0.0f);
+            return -1;
+         }
+         pos -= layer.mLoopEnd - layer.mLoopStart;
+      }
+   }
+   return pos;
+}
+
+void MultiSampleVoice::Start(double time, float target)
+{
+   mNumLayers = 0;
+   mReleased = false;
+   mOneShot = true;
+
+   std::array<const MultiSampleZone*, MultiSampleMap::kMaxLayers> zones;
+   int numZones = 0;
+   if (mVoiceParams->mMap != nullptr)
+      numZones = mVoiceParams->mMap->ChooseZones((int)GetNotePitch(), (int)round(target * 127), zones);
+
+   for (int i = 0; i < numZones; ++i)
+   {
+      const MultiSampleZone* zone = zones[i];
+      Sample* sample = zone->mSample;
+      if (sample->IsSampleLoading() || sample->LengthInSamples() == 0)
+         continue; //still decoding in the background
+
+      Layer& layer = mLayers[mNumLayers++];
+      layer.mZone = zone;
+      layer.mLength = MIN(sample->LengthInSamples(), sample->Data()->BufferSize()); //a streamed sample only has its head in memory
+      layer.mEnd = zone->mEnd < 0 ? layer.mLength : MIN(zone->mEnd, layer.mLength);
+      layer.mPos = MIN(zone->mStart, layer.mEnd);
+      layer.mLoopStart = MAX(zone->mLoopStart, 0);
+      layer.mLoopEnd = MIN(zone->mLoopEnd, layer.mEnd);
+      if (zone->mLoopMode != MultiSampleLoopMode::OneShot)
+         mOneShot = false;
+   }
+
+   mAdsr.Start(time, target, mVoiceParams->mAdsr);
+}
+
+void MultiSampleVoice::Stop(double time)
+{
+   mReleased = true;
+   if (!mOneShot)
+      mAdsr.Stop(time);
+}
+
+void MultiSampleVoice::ClearVoice()
+{
+   mAdsr.Clear();
+   mNumLayers = 0;
+}
+
+void MultiSampleVoice::SetVoiceParams(IVoiceParams* params)
+{
+   mVoiceParams = dynamic_cast<MultiSampleVoiceParams*>(params);
+}
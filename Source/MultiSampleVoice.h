@@ -0,0 +1,88 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    MultiSampleVoice.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "IMidiVoice.h"
+#include "IVoiceParams.h"
+#include "ADSR.h"
+#include "MultiSampleMap.h"
+#include "Resampler.h"
+
+#include <array>
+#include <vector>
+
+class IDrawableModule;
+
+class MultiSampleVoiceParams : public IVoiceParams
+{
+public:
+   ::ADSR mAdsr{ 1, 0, 1, 100 };
+   float mVol{ .5f };
+   ResampleQuality mResampleQuality{ ResampleQuality::Cubic };
+   MultiSampleMap* mMap{ nullptr };
+};
+
+//plays the zones a MultiSampleMap picks for the note, each resampled a block at a time at the rate its pitch gives
+class MultiSampleVoice : public IMidiVoice
+{
+public:
+   MultiSampleVoice(IDrawableModule* owner = nullptr);
+   ~MultiSampleVoice();
+
+   // IMidiVoice
+   void Start(double time, float amount) override;
+   void Stop(double time) override;
+   void ClearVoice() override;
+   bool Process(double time, ChannelBuffer* out, int oversampling) override;
+   void SetVoiceParams(IVoiceParams* params) override;
+   bool IsDone(double time) override;
+   float GetLevel(double time) override { return mAdsr.Value(time); }
+
+private:
+   struct Layer
+   {
+      const MultiSampleZone* mZone{ nullptr };
+      double mPos{ 0 };
+      int mLength{ 0 };
+      int mEnd{ 0 };
+      int mLoopStart{ -1 };
+      int mLoopEnd{ -1 };
+   };
+
+   double RenderLayer(const Layer& layer, const float* src, double rate, bool loop, ResampleQuality quality, float* dst, int numSamples) const;
+
+   ::ADSR mAdsr;
+   MultiSampleVoiceParams* mVoiceParams{};
+   std::array<Layer, MultiSampleMap::kMaxLayers> mLayers;
+   int mNumLayers{ 0 };
+   bool mOneShot{ false };
+   bool mReleased{ false };
+   IDrawableModule* mOwner{ nullptr };
+
+   std::vector<float> mGain;
+   std::vector<float> mResampled;
+};
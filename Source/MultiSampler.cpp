@@ -0,0 +1,259 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    MultiSampler.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "MultiSampler.h"
+#include "OpenFrameworksPort.h"
+#include "SynthGlobals.h"
+#include "IAudioReceiver.h"
+#include "ofxJSONElement.h"
+#include "ModularSynth.h"
+#include "Profiler.h"
+#include "SampleLoader.h"
+#include "UIControlMacros.h"
+
+#include "juce_gui_basics/juce_gui_basics.h"
+
+MultiSampler::MultiSampler()
+: mPolyMgr(this)
+, mNoteInputBuffer(this)
+, mWriteBuffer(gBufferSize)
+{
+   mPolyMgr.Init(kVoiceType_MultiSample, &mVoiceParams);
+}
+
+MultiSampler::~MultiSampler()
+{
+}
+
+void MultiSampler::CreateUIControls()
+{
+   IDrawableModule::CreateUIControls();
+
+   mADSRDisplay = new ADSRDisplay(this, "env", 3, 3, 100, 50, &mVoiceParams.mAdsr);
+
+   UIBLOCK(3, 56, 100);
+   FLOATSLIDER(mVolSlider, "vol", &mVoiceParams.mVol, 0, 1);
+   DROPDOWN(mResampleQualitySelector, "quality", (int*)(&mVoiceParams.mResampleQuality), 50);
+   BUTTON(mLoadButton, "load");
+   ENDUIBLOCK(mWidth, mHeight);
+   mWidth = 240;
+
+   mResampleQualitySelector->AddLabel("linear", (int)ResampleQuality::Linear);
+   mResampleQualitySelector->AddLabel("cubic", (int)ResampleQuality::Cubic);
+   mResampleQualitySelector->AddLabel("sinc", (int)ResampleQuality::Sinc);
+}
+
+//main thread. the map is parsed here, and its samples are handed to SampleLoader to decode in the background
+void MultiSampler::LoadMap(std::string path)
+{
+   auto map = std::make_unique<MultiSampleMap>();
+   SampleLoader::Get().BeginBatch();
+   bool loaded = map->Load(path);
+   SampleLoader::Get().EndBatch();
+   if (!loaded)
+      return;
+
+   mMapPath = path;
+   mMapMutex.lock();
+   mPolyMgr.KillAll();
+   mMap.swap(map);
+   mVoiceParams.mMap = mMap.get();
+   mMapMutex.unlock();
+}
+
+void MultiSampler::Process(double time)
+{
+   PROFILER(MultiSampler);
+
+   IAudioReceiver* target = GetTarget();
+
+   if (!mEnabled || target == nullptr)
+      return;
+
+   mNoteInputBuffer.Process(time);
+
+   ComputeSliders(0);
+
+   int bufferSize = target->GetBuffer()->BufferSize();
+   assert(bufferSize == gBufferSize);
+
+   mWriteBuffer.Clear();
+   mMapMutex.lock();
+   mPolyMgr.Process(time, &mWriteBuffer, bufferSize);
+   mMapMutex.unlock();
+
+   SyncOutputBuffer(mWriteBuffer.NumActiveChannels());
+   for (int ch = 0; ch < mWriteBuffer.NumActiveChannels(); ++ch)
+   {
+      GetVizBuffer()->WriteChunk(mWriteBuffer.GetChannelReadOnly(ch), mWriteBuffer.BufferSize(), ch);
+      if (!mWriteBuffer.IsSilent(ch)) //no voices playing
+         Add(target->GetBuffer()->GetChannel(ch), mWriteBuffer.GetChannelReadOnly(ch), gBufferSize);
+   }
+}
+
+void MultiSampler::PlayNote(NoteMessage note)
+{
+   if (!mEnabled)
+      return;
+
+   if (!NoteInputBuffer::IsTimeWithinFrame(note.time) && GetTarget())
+   {
+      mNoteInputBuffer.QueueNote(note);
+      return;
+   }
+
+   mMapMutex.lock();
+   if (note.velocity > 0)
+   {
+      mPolyMgr.Start(note.time, note.pitch, note.velocity / 127.0f, note.voiceIdx, note.modulation);
+      mVoiceParams.mAdsr.Start(note.time, 1); //for visualization
+   }
+   else
+   {
+      mPolyMgr.Stop(note.time, note.pitch, note.voiceIdx);
+      mVoiceParams.mAdsr.Stop(note.time); //for visualization
+   }
+   mMapMutex.unlock();
+}
+
+void MultiSampler::DrawModule()
+{
+   if (Minimized() || IsVisible() == false)
+      return;
+
+   mADSRDisplay->Draw();
+   mVolSlider->Draw();
+   mResampleQualitySelector->Draw();
+   mLoadButton->Draw();
+
+   ofPushMatrix();
+   ofTranslate(108, 3);
+   ofPushStyle();
+   ofSetColor(100, 100, 100, 100);
+   ofRect(0, 0, 128, 16);
+   if (mMap != nullptr)
+   {
+      //which keys have something to play
+      ofSetColor(IDrawableModule::GetColor(kModuleCategory_Synth));
+      for (int pitch = 0; pitch < 128; ++pitch)
+      {
+         if (mMap->HasZonesForKey(pitch))
+            ofRect(pitch, 0, 1, 16, 0);
+      }
+   }
+   ofPopStyle();
+
+   std::string status = "drop an sfz or json map";
+   if (mMap != nullptr)
+   {
+      status = juce::File(mMapPath).getFileNameWithoutExtension().toStdString();
+      DrawTextNormal(ofToString(mMap->GetNumZones()) + " zones, " + ofToString(mMap->GetNumSamples()) + " samples", 0, 42, 11);
+      int loading = mMap->GetNumSamplesLoading();
+      if (loading > 0)
+         DrawTextNormal("loading " + ofToString(mMap->GetNumSamples() - loading) + "/" + ofToString(mMap->GetNumSamples()), 0, 56, 11);
+   }
+   DrawTextNormal(status, 0, 28, 11);
+   ofPopMatrix();
+}
+
+void MultiSampler::DrawModuleUnclipped()
+{
+   if (mDrawDebug)
+      mPolyMgr.DrawDebug(mWidth + 3, 0);
+}
+
+void MultiSampler::FilesDropped(std::vector<std::string> files, int x, int y)
+{
+   if (!files.empty())
+      LoadMap(files[0]);
+}
+
+void MultiSampler::CheckboxUpdated(Checkbox* checkbox, double time)
+{
+   if (checkbox == mEnabledCheckbox)
+      mPolyMgr.KillAll();
+}
+
+void MultiSampler::ButtonClicked(ClickButton* button, double time)
+{
+   if (button == mLoadButton)
+   {
+      juce::FileChooser chooser("Load multisample", juce::File(ofToSamplePath("")), "*.sfz;*.json", true, false, TheSynth->GetFileChooserParent());
+      if (chooser.browseForFileToOpen())
+         LoadMap(chooser.getResult().getFullPathName().toStdString());
+   }
+}
+
+std::vector<IUIControl*> MultiSampler::ControlsToIgnoreInSaveState() const
+{
+   std::vector<IUIControl*> ignore;
+   ignore.push_back(mLoadButton);
+   return ignore;
+}
+
+void MultiSampler::LoadLayout(const ofxJSONElement& moduleInfo)
+{
+   mModuleSaveData.LoadString("target", moduleInfo);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, -1, -1, kMaxPolyphony);
+   mModuleSaveData.LoadInt("cpu_priority", moduleInfo, 0, 0, CpuGovernor::kNumLevels - 1);
+
+   SetUpFromSaveData();
+}
+
+void MultiSampler::SetUpFromSaveData()
+{
+   SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
+
+   int voiceLimit = mModuleSaveData.GetInt("voicelimit");
+   if (voiceLimit > 0)
+      mPolyMgr.SetVoiceLimit(voiceLimit);
+   else
+      mPolyMgr.SetVoiceLimit(kNumVoices);
+   mPolyMgr.SetPriority(mModuleSaveData.GetInt("cpu_priority"));
+}
+
+void MultiSampler::SaveState(FileStreamOut& out)
+{
+   out << GetModuleSaveStateRev();
+
+   IDrawableModule::SaveState(out);
+
+   out << mMapPath;
+}
+
+void MultiSampler::LoadState(FileStreamIn& in, int rev)
+{
+   IDrawableModule::LoadState(in, rev);
+   if (rev < 0)
+      return;
+
+   LoadStateValidate(rev <= GetModuleSaveStateRev());
+
+   std::string path;
+   in >> path;
+   if (!path.empty())
+      LoadMap(path);
+}
@@ -0,0 +1,102 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    MultiSampler.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "IAudioSource.h"
+#include "PolyphonyMgr.h"
+#include "MultiSampleVoice.h"
+#include "INoteReceiver.h"
+#include "IDrawableModule.h"
+#include "Slider.h"
+#include "DropdownList.h"
+#include "ADSRDisplay.h"
+#include "ClickButton.h"
+
+#include <memory>
+
+class ofxJSONElement;
+
+//plays a multisampled instrument from an sfz file or a json map, see MultiSampleMap for what's supported
+class MultiSampler : public IAudioSource, public INoteReceiver, public IDrawableModule, public IDropdownListener, public IFloatSliderListener, public IButtonListener
+{
+public:
+   MultiSampler();
+   ~MultiSampler();
+   static IDrawableModule* Create() { return new MultiSampler(); }
+   static bool AcceptsAudio() { return false; }
+   static bool AcceptsNotes() { return true; }
+   static bool AcceptsPulses() { return false; }
+
+   void CreateUIControls() override;
+
+   void LoadMap(std::string path);
+
+   //IAudioSource
+   void Process(double time) override;
+   void SetEnabled(bool enabled) override { mEnabled = enabled; }
+
+   //INoteReceiver
+   void PlayNote(NoteMessage note) override;
+   void SendCC(int control, int value, int voiceIdx = -1) override {}
+
+   void FilesDropped(std::vector<std::string> files, int x, int y) override;
+
+   void DropdownUpdated(DropdownList* list, int oldVal, double time) override {}
+   void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
+   void CheckboxUpdated(Checkbox* checkbox, double time) override;
+   void ButtonClicked(ClickButton* button, double time) override;
+
+   void LoadLayout(const ofxJSONElement& moduleInfo) override;
+   void SetUpFromSaveData() override;
+   void SaveState(FileStreamOut& out) override;
+   void LoadState(FileStreamIn& in, int rev) override;
+   int GetModuleSaveStateRev() const override { return 0; }
+   std::vector<IUIControl*> ControlsToIgnoreInSaveState() const override;
+
+   bool HasDebugDraw() const override { return true; }
+
+   bool IsEnabled() const override { return mEnabled; }
+
+private:
+   //IDrawableModule
+   void DrawModule() override;
+   void DrawModuleUnclipped() override;
+
+   PolyphonyMgr mPolyMgr;
+   NoteInputBuffer mNoteInputBuffer;
+   MultiSampleVoiceParams mVoiceParams;
+   ADSRDisplay* mADSRDisplay{ nullptr };
+   FloatSlider* mVolSlider{ nullptr };
+   DropdownList* mResampleQualitySelector{ nullptr };
+   ClickButton* mLoadButton{ nullptr };
+
+   std::string mMapPath;
+   std::unique_ptr<MultiSampleMap> mMap; //only replaced on the main thread, with mMapMutex held
+   ofMutex mMapMutex;
+
+   ChannelBuffer mWriteBuffer;
+};
@@ -29,13 +29,10 @@
 
 MultibandCompressor::MultibandCompressor()
 : IAudioProcessor(gBufferSize)
+, mLevel(gBufferSize)
 {
-   mWorkBuffer = new float[GetBuffer()->BufferSize()];
-   Clear(mWorkBuffer, GetBuffer()->BufferSize());
-
-   mOutBuffer = new float[GetBuffer()->BufferSize()];
-   Clear(mOutBuffer, GetBuffer()->BufferSize());
-
+   for (int i = 0; i < COMPRESSOR_MAX_BANDS; ++i)
+      mPeaks[i].SetRelease(mRingTime * 1000 / M_LN2);
    CalcFilters();
 }
 
@@ -52,8 +49,6 @@ void MultibandCompressor::CreateUIControls()
 
 MultibandCompressor::~MultibandCompressor()
 {
-   delete[] mOutBuffer;
-   delete[] mWorkBuffer;
 }
 
 void MultibandCompressor::Process(double time)
@@ -70,48 +65,28 @@ void MultibandCompressor::Process(double time)
    IAudioReceiver* target = GetTarget();
    if (target)
    {
-      Clear(mOutBuffer, bufferSize);
+      if ((int)mLevel.size() < bufferSize)
+         mLevel.resize(bufferSize);
+      float* gain = mLevel.data();
 
-      for (int i = 0; i < bufferSize; ++i)
-      {
-         float lower;
-         float highLeftover = GetBuffer()->GetChannel(0)[i];
-         for (int j = 0; j < mNumBands; ++j)
-         {
-            mFilters[j].ProcessSample(highLeftover, lower, highLeftover);
-            mPeaks[j].Process(&lower, 1);
-            float compress = ofClamp(1 / mPeaks[i].GetPeak(), 0, 10);
-            mOutBuffer[i] += lower * compress;
-         }
-         mOutBuffer[i] += highLeftover;
-      }
+      const float* input = GetBuffer()->GetChannel(0);
+      mCrossovers.Process(&input, 1, bufferSize);
 
-      /*for (int i=0; i<mNumBands; ++i)
+      //the bands sum back to an allpassed copy of the input, so mixing the ungained bands in for the dry signal keeps it phase aligned with the wet one
+      float* out = target->GetBuffer()->GetChannel(0);
+      for (int j = 0; j < mNumBands; ++j)
       {
-         //get carrier band
-         BufferCopy(mWorkBuffer, mInputBuffer, bufferSize);
-         
-         mFilters[i].ProcessSample(const double &sample, double &lowOut, double &highOut)(mWorkBuffer, bufferSize);
-         
-         //calculate modulator band level
-         mPeaks[i].Process(mWorkBuffer, bufferSize);
-         
-         //multiply carrier band by modulator band level
-         if (mPeaks[i].GetPeak() > 0)
+         float* band = mCrossovers.GetBand(j, 0);
+         for (int i = 0; i < bufferSize; ++i)
+            gain[i] = MIN(fabsf(band[i]), mMaxBand);
+         mPeaks[j].Process(gain, gain, bufferSize);
+         for (int i = 0; i < bufferSize; ++i)
          {
-            float compress = ofClamp(1/mPeaks[i].GetPeak(), 0, 10);
-            Mult(mWorkBuffer, compress, bufferSize);
+            float compress = MIN(1 / MAX(gain[i], .1f), 10);
+            out[i] += band[i] * ofLerp(1.0f, compress, mDryWet);
          }
-         
-         //accumulate output band into total output
-         Add(mOutBuffer, mWorkBuffer, bufferSize);
-      }*/
-
-      Mult(GetBuffer()->GetChannel(0), (1 - mDryWet), bufferSize);
-      Mult(mOutBuffer, mDryWet, bufferSize);
-
-      Add(target->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
-      Add(target->GetBuffer()->GetChannel(0), mOutBuffer, bufferSize);
+      }
+      Add(out, mCrossovers.GetBand(mNumBands, 0), bufferSize);
    }
 
    GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
@@ -137,20 +112,20 @@ void MultibandCompressor::DrawModule()
    const float width = 25;
    for (int i = 0; i < mNumBands; ++i)
    {
-      ofRect(i * (width + 3), -mPeaks[i].GetPeak() * 200, width, mPeaks[i].GetPeak() * 200);
+      ofRect(i * (width + 3), -mPeaks[i].GetValue() * 200, width, mPeaks[i].GetValue() * 200);
    }
    ofPopStyle();
 }
 
 void MultibandCompressor::CalcFilters()
 {
+   float frequencies[COMPRESSOR_MAX_BANDS];
    for (int i = 0; i < mNumBands; ++i)
    {
       float a = float(i) / mNumBands;
-      float f = mFreqMin * powf(mFreqMax / mFreqMin, a);
-
-      mFilters[i].SetCrossoverFreq(f);
+      frequencies[i] = mFreqMin * powf(mFreqMax / mFreqMin, a);
    }
+   mCrossovers.SetCrossoverFrequencies(frequencies, mNumBands);
 }
 
 void MultibandCompressor::IntSliderUpdated(IntSlider* slider, int oldVal, double time)
@@ -170,12 +145,7 @@ void MultibandCompressor::FloatSliderUpdated(FloatSlider* slider, float oldVal,
    if (slider == mRingTimeSlider)
    {
       for (int i = 0; i < COMPRESSOR_MAX_BANDS; ++i)
-         mPeaks[i].SetDecayTime(mRingTime);
-   }
-   if (slider == mMaxBandSlider)
-   {
-      for (int i = 0; i < COMPRESSOR_MAX_BANDS; ++i)
-         mPeaks[i].SetLimit(mMaxBand);
+         mPeaks[i].SetRelease(mRingTime * 1000 / M_LN2); //ring is the half-life of each band's level
    }
 }
 
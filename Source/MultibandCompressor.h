@@ -28,9 +28,7 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Slider.h"
-#include "RollingBuffer.h"
-#include "LinkwitzRileyFilter.h"
-#include "PeakTracker.h"
+#include "DynamicsCore.h"
 
 #define COMPRESSOR_MAX_BANDS 10
 
@@ -51,6 +49,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
@@ -72,8 +71,6 @@ private:
 
    void CalcFilters();
 
-   float* mWorkBuffer{ nullptr };
-   float* mOutBuffer{ nullptr };
 
    float mDryWet{ 1 };
    FloatSlider* mDryWetSlider{ nullptr };
@@ -88,6 +85,7 @@ private:
    float mMaxBand{ .3 };
    FloatSlider* mMaxBandSlider{ nullptr };
 
-   CLinkwitzRiley_4thOrder mFilters[COMPRESSOR_MAX_BANDS];
-   PeakTracker mPeaks[COMPRESSOR_MAX_BANDS];
+   CrossoverBank mCrossovers;
+   EnvelopeFollower mPeaks[COMPRESSOR_MAX_BANDS];
+   std::vector<float> mLevel;
 };
@@ -32,17 +32,22 @@
 #include "Profiler.h"
 #include "ModulationChain.h"
 
+#include <limits>
+
 const float mBufferX = 5;
 const float mBufferY = 50;
 const float mBufferW = 800;
 const float mBufferH = 200;
+const float kMaxDelaySeconds = 5; //the buffer rounds up past this, but the controls stop here
 
 MultitapDelay::MultitapDelay()
 : IAudioProcessor(gBufferSize)
 , mWriteBuffer(gBufferSize)
-, mDelayBuffer(5 * gSampleRate)
+, mDelayLine(kMaxDelaySeconds * gSampleRate - 2)
+, mSendBuffer(gBufferSize)
 {
    mTaps.resize(mNumTaps);
+   mLineTaps.resize(mNumTaps);
    for (int i = 0; i < mNumTaps; ++i)
       mTaps[i].mOwner = this;
 
@@ -57,7 +62,7 @@ void MultitapDelay::CreateUIControls()
    int tapBoxW = (mBufferW - 30) / 4;
 
    mDryAmountSlider = new FloatSlider(this, "dry", 5, 10, tapBoxW, 15, &mDryAmount, 0, 1);
-   mDisplayLengthSlider = new FloatSlider(this, "display length", mDryAmountSlider, kAnchor_Below, tapBoxW, 15, &mDisplayLength, .1f, mDelayBuffer.Size() / gSampleRate);
+   mDisplayLengthSlider = new FloatSlider(this, "display length", mDryAmountSlider, kAnchor_Below, tapBoxW, 15, &mDisplayLength, .1f, kMaxDelaySeconds);
    mDisplayLength = mDisplayLengthSlider->GetMax();
 
    for (int i = 0; i < mNumTaps; ++i)
@@ -65,7 +70,7 @@ void MultitapDelay::CreateUIControls()
       int row = i / 4;
       int column = i % 4;
 
-      mTaps[i].mDelayMsSlider = new FloatSlider(this, ("delay " + ofToString(i + 1)).c_str(), 5 + column * (tapBoxW + 10), mBufferY + mBufferH + 10 + row * 80, tapBoxW, 15, &mTaps[i].mDelayMs, gBufferSize / gSampleRateMs, mDelayBuffer.Size() / gSampleRateMs);
+      mTaps[i].mDelayMsSlider = new FloatSlider(this, ("delay " + ofToString(i + 1)).c_str(), 5 + column * (tapBoxW + 10), mBufferY + mBufferH + 10 + row * 80, tapBoxW, 15, &mTaps[i].mDelayMs, gBufferSize / gSampleRateMs, kMaxDelaySeconds * 1000);
       mTaps[i].mGainSlider = new FloatSlider(this, ("gain " + ofToString(i + 1)).c_str(), mTaps[i].mDelayMsSlider, kAnchor_Below, tapBoxW, 15, &mTaps[i].mGain, 0, 1);
       mTaps[i].mFeedbackSlider = new FloatSlider(this, ("feedback " + ofToString(i + 1)).c_str(), mTaps[i].mGainSlider, kAnchor_Below, tapBoxW, 15, &mTaps[i].mFeedback, 0, 1);
       mTaps[i].mPanSlider = new FloatSlider(this, ("pan " + ofToString(i + 1)).c_str(), mTaps[i].mFeedbackSlider, kAnchor_Below, tapBoxW, 15, &mTaps[i].mPan, -1, 1);
@@ -100,7 +105,7 @@ void MultitapDelay::Process(double time)
    }
 
    mWriteBuffer.SetNumActiveChannels(GetBuffer()->NumActiveChannels());
-   mDelayBuffer.SetNumChannels(GetBuffer()->NumActiveChannels());
+   mDelayLine.GetBuffer().SetNumChannels(GetBuffer()->NumActiveChannels());
    for (int t = 0; t < mNumTaps; ++t)
       mTaps[t].mTapBuffer.SetNumActiveChannels(mWriteBuffer.NumActiveChannels());
 
@@ -113,22 +118,36 @@ void MultitapDelay::Process(double time)
    {
       BufferCopy(mWriteBuffer.GetChannel(ch), GetBuffer()->GetChannel(ch), bufferSize);
       Mult(mWriteBuffer.GetChannel(ch), mDryAmount, bufferSize);
-      mDelayBuffer.WriteChunk(GetBuffer()->GetChannel(ch), bufferSize, ch);
+      mDelayLine.GetBuffer().WriteChunk(GetBuffer()->GetChannel(ch), bufferSize, ch);
    }
 
-   for (int i = 0; i < bufferSize; ++i)
+   ComputeSliders(bufferSize - 1);
+   if (CanProcessBlock(bufferSize))
    {
-      ComputeSliders(i);
-
-      for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
+      ProcessBlock(bufferSize);
+   }
+   else
+   {
+      for (int i = 0; i < bufferSize; ++i)
       {
-         for (int t = 0; t < mNumTaps; ++t)
-            mTaps[t].Process(&mWriteBuffer.GetChannel(ch)[i], i, ch);
-         for (int t = 0; t < kNumMPETaps; ++t)
-            mMPETaps[t].Process(&mWriteBuffer.GetChannel(ch)[i], i, ch);
+         ComputeSliders(i);
+
+         for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
+         {
+            for (int t = 0; t < mNumTaps; ++t)
+               mTaps[t].Process(&mWriteBuffer.GetChannel(ch)[i], i, ch);
+            for (int t = 0; t < kNumMPETaps; ++t)
+               mMPETaps[t].Process(&mWriteBuffer.GetChannel(ch)[i], i, ch);
+         }
       }
    }
 
+   for (int t = 0; t < mNumTaps; ++t)
+   {
+      mTaps[t].mLastDelaySamples = mTaps[t].GetDelaySamples();
+      mTaps[t].mLastGain = mTaps[t].mGain;
+   }
+
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
    {
       Add(target->GetBuffer()->GetChannel(ch), mWriteBuffer.GetChannel(ch), bufferSize);
@@ -139,6 +158,65 @@ void MultitapDelay::Process(double time)
    GetBuffer()->Reset();
 }
 
+//when every tap reads from further back than this buffer, plus another buffer for feedback to land in, nothing a tap
+//reads gets written to during the buffer, so all of the taps can be read at once with their delays and gains ramped
+bool MultitapDelay::CanProcessBlock(int bufferSize) const
+{
+   if (bufferSize > (int)mSendBuffer.size())
+      return false;
+
+   bool feedsBack = false;
+   float minDelaySamples = std::numeric_limits<float>::max();
+   for (int t = 0; t < mNumTaps; ++t)
+   {
+      const DelayTap& tap = mTaps[t];
+      if (tap.mGain <= 0 && tap.mLastGain <= 0)
+         continue;
+      minDelaySamples = MIN(minDelaySamples, tap.GetDelaySamples());
+      if (tap.mLastDelaySamples >= 0)
+         minDelaySamples = MIN(minDelaySamples, tap.mLastDelaySamples);
+      if (tap.mFeedback != 0)
+         feedsBack = true;
+   }
+   return minDelaySamples >= (feedsBack ? 2 : 1) * bufferSize;
+}
+
+void MultitapDelay::ProcessBlock(int bufferSize)
+{
+   RollingBuffer& delayBuffer = mDelayLine.GetBuffer();
+   float* send = mSendBuffer.data();
+
+   for (int ch = 0; ch < mWriteBuffer.NumActiveChannels(); ++ch)
+   {
+      bool feedsBack = false;
+      for (int t = 0; t < mNumTaps; ++t)
+      {
+         const DelayTap& tap = mTaps[t];
+         DelayLine::Tap& lineTap = mLineTaps[t];
+         lineTap.mDelayTo = tap.GetDelaySamples();
+         lineTap.mDelayFrom = tap.mLastDelaySamples >= 0 ? tap.mLastDelaySamples : lineTap.mDelayTo;
+         lineTap.mGainFrom = MAX(tap.mLastGain, 0);
+         lineTap.mGainTo = MAX(tap.mGain, 0);
+         float sendGain = tap.mFeedback * (ch == 0 ? GetLeftPanGain(tap.mPan) : GetRightPanGain(tap.mPan));
+         lineTap.mSendFrom = lineTap.mGainFrom * sendGain;
+         lineTap.mSendTo = lineTap.mGainTo * sendGain;
+         if (sendGain != 0)
+            feedsBack = true;
+      }
+
+      if (feedsBack)
+         std::fill(send, send + bufferSize, 0.0f);
+      mDelayLine.ReadTaps(mLineTaps.data(), mNumTaps, mWriteBuffer.GetChannel(ch), feedsBack ? send : nullptr, bufferSize, ch);
+
+      //back into the samples just written, as the per-sample path does
+      if (feedsBack)
+      {
+         for (int i = 0; i < bufferSize; ++i)
+            delayBuffer.Accum(bufferSize - i, send[i], ch);
+      }
+   }
+}
+
 void MultitapDelay::DrawModule()
 {
    if (Minimized() || IsVisible() == false)
@@ -155,8 +233,9 @@ void MultitapDelay::DrawModule()
       mTaps[i].mPanSlider->Draw();
    }
 
-   for (int ch = 0; ch < mDelayBuffer.NumChannels(); ++ch)
-      mDelayBuffer.Draw(mBufferX, mBufferY + mBufferH / mDelayBuffer.NumChannels() * ch, mBufferW, mBufferH / mDelayBuffer.NumChannels(), mDisplayLength * gSampleRate, ch);
+   RollingBuffer& delayBuffer = mDelayLine.GetBuffer();
+   for (int ch = 0; ch < delayBuffer.NumChannels(); ++ch)
+      delayBuffer.Draw(mBufferX, mBufferY + mBufferH / delayBuffer.NumChannels() * ch, mBufferW, mBufferH / delayBuffer.NumChannels(), mDisplayLength * gSampleRate, ch);
 
    ofPushMatrix();
    ofTranslate(mBufferX, mBufferY);
@@ -246,7 +325,7 @@ void MultitapDelay::SaveState(FileStreamOut& out)
 
    IDrawableModule::SaveState(out);
 
-   mDelayBuffer.SaveState(out);
+   mDelayLine.GetBuffer().SaveState(out);
 }
 
 void MultitapDelay::LoadState(FileStreamIn& in, int rev)
@@ -257,7 +336,7 @@ void MultitapDelay::LoadState(FileStreamIn& in, int rev)
       in >> rev;
    LoadStateValidate(rev <= GetModuleSaveStateRev());
 
-   mDelayBuffer.LoadState(in);
+   mDelayLine.GetBuffer().LoadState(in);
 }
 
 
@@ -335,26 +414,22 @@ void MultitapDelay::DelayTap::Process(float* sampleOut, int offset, int ch)
 {
    if (mGain > 0)
    {
-      float delaySamps = mDelayMs / gInvSampleRateMs;
-      delaySamps = ofClamp(delaySamps - offset, 0.1f, mOwner->mDelayBuffer.Size() - 2);
-
-      int sampsAgoA = int(delaySamps);
-      int sampsAgoB = sampsAgoA + 1;
-
-      float sample = mOwner->mDelayBuffer.GetSample(sampsAgoA, ch);
-      float nextSample = mOwner->mDelayBuffer.GetSample(sampsAgoB, ch);
-      float a = delaySamps - sampsAgoA;
-      float delayedSample = (1 - a) * sample + a * nextSample; //interpolate
+      float delayedSample = mOwner->mDelayLine.Read(mDelayMs / gInvSampleRateMs - offset, ch);
 
       float outputSample = delayedSample * mGain;
       mTapBuffer.GetChannel(ch)[offset] = outputSample;
 
       *sampleOut += outputSample;
       float panGain = ch == 0 ? GetLeftPanGain(mPan) : GetRightPanGain(mPan);
-      mOwner->mDelayBuffer.Accum(gBufferSize - offset, outputSample * mFeedback * panGain, ch);
+      mOwner->mDelayLine.GetBuffer().Accum(gBufferSize - offset, outputSample * mFeedback * panGain, ch);
    }
 }
 
+float MultitapDelay::DelayTap::GetDelaySamples() const
+{
+   return ofClamp(mDelayMs / gInvSampleRateMs, DelayLine::kMinDelaySamples, mOwner->mDelayLine.GetMaxDelaySamples());
+}
+
 void MultitapDelay::DelayTap::Draw(float w, float h)
 {
    ofPushStyle();
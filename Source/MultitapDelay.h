@@ -36,6 +36,7 @@
 #include "INoteReceiver.h"
 #include "Granulator.h"
 #include "ADSR.h"
+#include "DelayLine.h"
 
 class Sample;
 
@@ -57,6 +58,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    //IClickable
@@ -82,6 +84,7 @@ public:
    int GetModuleSaveStateRev() const override { return 0; }
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override { return mDelayLine.GetBuffer().GetMemoryUsage() + mWriteBuffer.GetMemoryUsage(); }
 
 private:
    //IDrawableModule
@@ -89,11 +92,15 @@ private:
    void GetModuleDimensions(float& width, float& height) override;
    void OnClicked(float x, float y, bool right) override;
 
+   bool CanProcessBlock(int bufferSize) const;
+   void ProcessBlock(int bufferSize);
+
    struct DelayTap
    {
       DelayTap();
       void Process(float* sampleOut, int offset, int ch);
       void Draw(float w, float h);
+      float GetDelaySamples() const;
 
       float mDelayMs{ 100 };
       float mGain{ 0 };
@@ -108,6 +115,9 @@ private:
       FloatSlider* mPanSlider{ nullptr };
 
       ChannelBuffer mTapBuffer;
+
+      float mLastDelaySamples{ -1 }; //where the last buffer left the delay and gain, for the next one to ramp on from
+      float mLastGain{ 0 };
    };
 
    struct DelayMPETap
@@ -135,5 +145,7 @@ private:
    float mDryAmount{ 1 };
    FloatSlider* mDisplayLengthSlider{ nullptr };
    float mDisplayLength{ 10 };
-   RollingBuffer mDelayBuffer;
+   DelayLine mDelayLine;
+   std::vector<DelayLine::Tap> mLineTaps;
+   std::vector<float> mSendBuffer;
 };
@@ -47,6 +47,8 @@ void MultitrackRecorder::CreateUIControls()
    CHECKBOX(mRecordCheckbox, "record", &mRecord);
    UIBLOCK_SHIFTRIGHT();
    BUTTON(mClearButton, "clear");
+   UIBLOCK_SHIFTRIGHT();
+   CHECKBOX(mRecordToDiskCheckbox, "to disk", &mRecordToDisk);
    UIBLOCK_NEWLINE();
    BUTTON(mAddTrackButton, "add track");
    UIBLOCK_SHIFTRIGHT();
@@ -65,9 +67,11 @@ void MultitrackRecorder::DrawModule()
 
    mAddTrackButton->SetShowing(!mRecord);
    mBounceButton->SetShowing(!mRecord);
+   mRecordToDiskCheckbox->SetShowing(!mRecord);
 
    mRecordCheckbox->Draw();
    mClearButton->Draw();
+   mRecordToDiskCheckbox->Draw();
    mAddTrackButton->Draw();
    mBounceButton->Draw();
 
@@ -122,6 +126,23 @@ int MultitrackRecorder::GetRecordingLength()
    return recordingLength;
 }
 
+std::string MultitrackRecorder::GetFilenamePrefix() const
+{
+   std::string save_prefix = "multitrack_";
+   if (!TheSynth->GetLastSavePath().empty())
+   {
+      // This assumes that mCurrentSaveStatePath always has a valid filename at the end
+      std::string filename = juce::File(TheSynth->GetLastSavePath()).getFileNameWithoutExtension().toStdString();
+      save_prefix = filename + "_";
+   }
+   // Crude way of checking if the filename does not have a date/time in it.
+   if (std::count(save_prefix.begin(), save_prefix.end(), '-') < 3)
+   {
+      save_prefix += "%Y-%m-%d_%H-%M_";
+   }
+   return ofGetTimestampString(UserPrefs.recordings_path.Get() + save_prefix);
+}
+
 void MultitrackRecorder::ButtonClicked(ClickButton* button, double time)
 {
    if (button == mAddTrackButton)
@@ -131,19 +152,7 @@ void MultitrackRecorder::ButtonClicked(ClickButton* button, double time)
 
    if (button == mBounceButton)
    {
-      std::string save_prefix = "multitrack_";
-      if (!TheSynth->GetLastSavePath().empty())
-      {
-         // This assumes that mCurrentSaveStatePath always has a valid filename at the end
-         std::string filename = juce::File(TheSynth->GetLastSavePath()).getFileNameWithoutExtension().toStdString();
-         save_prefix = filename + "_";
-      }
-      // Crude way of checking if the filename does not have a date/time in it.
-      if (std::count(save_prefix.begin(), save_prefix.end(), '-') < 3)
-      {
-         save_prefix += "%Y-%m-%d_%H-%M_";
-      }
-      std::string filenamePrefix = ofGetTimestampString(UserPrefs.recordings_path.Get() + save_prefix);
+      std::string filenamePrefix = GetFilenamePrefix();
 
       int numFiles = 0;
       for (int i = 0; i < (int)mTracks.size(); ++i)
@@ -176,8 +185,29 @@ void MultitrackRecorder::CheckboxUpdated(Checkbox* checkbox, double time)
 {
    if (checkbox == mRecordCheckbox)
    {
-      for (auto* track : mTracks)
-         track->SetRecording(mRecord);
+      if (mRecord && mRecordToDisk)
+         mDiskFilenamePrefix = GetFilenamePrefix();
+
+      int numDiskFiles = 0;
+      for (int i = 0; i < (int)mTracks.size(); ++i)
+      {
+         if (mRecord && mRecordToDisk)
+         {
+            mTracks[i]->SetRecording(true, mDiskFilenamePrefix + ofToString(i + 1) + ".wav");
+         }
+         else
+         {
+            mTracks[i]->SetRecording(mRecord);
+            if (mTracks[i]->StoppedRecordingToDisk())
+               ++numDiskFiles;
+         }
+      }
+
+      if (numDiskFiles > 0)
+      {
+         mStatusString = "wrote " + ofToString(numDiskFiles) + " files to " + mDiskFilenamePrefix + "*.wav";
+         mStatusStringTime = gTime;
+      }
    }
 }
 
@@ -305,7 +335,11 @@ void MultitrackRecorderTrack::Process(double time)
    ComputeSliders(0);
    SyncBuffers(numChannels);
 
-   if (mDoRecording)
+   if (mDoRecording && mDiskRecorder.IsRecording())
+   {
+      mDiskRecorder.Write(GetBuffer(), GetBuffer()->BufferSize());
+   }
+   else if (mDoRecording)
    {
       for (size_t i = 0; i < mRecordChunks.size(); ++i)
          mRecordChunks[i]->SetNumActiveChannels(numChannels);
@@ -337,6 +371,9 @@ void MultitrackRecorderTrack::Poll()
 {
    IDrawableModule::Poll();
 
+   if (!mDiskRecordingPath.empty())
+      return; //nothing kept in memory
+
    int chunkIndex = mRecordingLength / kRecordingChunkSize;
    if (chunkIndex >= (int)mRecordChunks.size() - 1)
    {
@@ -367,6 +404,21 @@ void MultitrackRecorderTrack::DrawModule()
       ofRect(0, 0, sampleWidth, height - 6);
    }
 
+   if (!mDiskRecordingPath.empty())
+   {
+      int seconds = (int)(mDiskRecorder.IsRecording() ? mDiskRecorder.GetNumSamplesWritten() / gSampleRate : 0);
+      std::string status = mDiskRecorder.IsRecording() ? ("recording to disk: " + ofToString(seconds / 60) + ":" + (seconds % 60 < 10 ? "0" : "") + ofToString(seconds % 60)) : "recorded to disk";
+      ofSetColor(255, 255, 255);
+      DrawTextNormal(status + "\n" + juce::File(mDiskRecordingPath).getFileName().toStdString(), 5, 20);
+      if (mDiskRecorder.GetNumDroppedBlocks() > 0)
+      {
+         ofSetColor(255, 0, 0);
+         DrawTextNormal("disk too slow! dropped " + ofToString(mDiskRecorder.GetNumDroppedBlocks()) + " buffers", 5, 50);
+      }
+      ofPopMatrix();
+      return;
+   }
+
    ofPushMatrix();
    int numChunks = mRecordingLength / kRecordingChunkSize + 1;
    float chunkWidth = sampleWidth / numChunks;
@@ -387,10 +439,29 @@ void MultitrackRecorderTrack::Setup(MultitrackRecorder* recorder, int minLength)
    mRecordingLength = minLength;
 }
 
-void MultitrackRecorderTrack::SetRecording(bool record)
+void MultitrackRecorderTrack::SetRecording(bool record, const std::string& diskPath /*= ""*/)
 {
-   if (record)
+   if (record && !diskPath.empty())
+   {
+      Clear();
+      if (mDiskRecorder.Start(diskPath, MAX(1, GetBuffer()->NumActiveChannels())))
+      {
+         mDiskRecordingPath = diskPath;
+         for (auto* recordChunk : mRecordChunks)
+            delete recordChunk;
+         mRecordChunks.clear();
+         mDoRecording = true;
+      }
+      else
+      {
+         TheSynth->LogEvent("couldn't record to " + diskPath, kLogEventType_Error);
+      }
+   }
+   else if (record)
    {
+      if (!mDiskRecordingPath.empty())
+         Clear(); //back to recording in memory
+
       if (mRecordingLength == 0)
       {
          mRecordingLength = 0;
@@ -410,6 +481,7 @@ void MultitrackRecorderTrack::SetRecording(bool record)
    else
    {
       mDoRecording = false;
+      mDiskRecorder.Stop();
    }
 }
 
@@ -443,6 +515,8 @@ Sample* MultitrackRecorderTrack::BounceRecording()
 
 void MultitrackRecorderTrack::Clear()
 {
+   mDiskRecorder.Stop();
+   mDiskRecordingPath.clear();
    for (auto* recordChunk : mRecordChunks)
       delete recordChunk;
    mRecordChunks.clear();
@@ -31,6 +31,7 @@
 #include "Checkbox.h"
 #include "IAudioProcessor.h"
 #include "ModuleContainer.h"
+#include "StreamingRecorder.h"
 
 class MultitrackRecorderTrack;
 
@@ -67,12 +68,16 @@ private:
 
    void AddTrack();
    int GetRecordingLength();
+   std::string GetFilenamePrefix() const;
 
    ModuleContainer mModuleContainer;
 
    ClickButton* mAddTrackButton{ nullptr };
    Checkbox* mRecordCheckbox{ nullptr };
    bool mRecord{ false };
+   Checkbox* mRecordToDiskCheckbox{ nullptr };
+   bool mRecordToDisk{ false };
+   std::string mDiskFilenamePrefix;
    ClickButton* mBounceButton{ nullptr };
    ClickButton* mClearButton{ nullptr };
 
@@ -98,7 +103,8 @@ public:
    void Process(double time) override;
 
    void Setup(MultitrackRecorder* recorder, int minLength);
-   void SetRecording(bool record);
+   void SetRecording(bool record, const std::string& diskPath = ""); //with a path, stream the take to it instead of keeping it in memory
+   bool StoppedRecordingToDisk() const { return !mDiskRecorder.IsRecording() && !mDiskRecordingPath.empty(); }
    Sample* BounceRecording();
    void Clear();
    int GetRecordingLength() const { return mRecordingLength; }
@@ -118,6 +124,8 @@ private:
    MultitrackRecorder* mRecorder{ nullptr };
 
    std::vector<ChannelBuffer*> mRecordChunks;
+   StreamingRecorder mDiskRecorder;
+   std::string mDiskRecordingPath;
    bool mDoRecording{ false };
    int mRecordingLength{ 0 };
    ClickButton* mDeleteButton{ nullptr };
@@ -50,6 +50,12 @@ void Muter::ProcessAudio(double time, ChannelBuffer* buffer)
 
    float bufferSize = buffer->BufferSize();
 
+   if (mRamp.Value(time) == 0 && mRamp.Value(time + bufferSize * gInvSampleRateMs) == 0)
+   {
+      buffer->Clear(); //fully muted, so let everything downstream know it's silent
+      return;
+   }
+
    for (int i = 0; i < bufferSize; ++i)
    {
       for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
@@ -45,6 +45,7 @@ public:
    void ProcessAudio(double time, ChannelBuffer* buffer) override;
    void SetEnabled(bool enabled) override {}
    std::string GetType() override { return "muter"; }
+   int GetTailLengthSamples() override { return 0; }
 
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
@@ -24,6 +24,94 @@
 //
 
 #include "NamedMutex.h"
+#include "SynthGlobals.h"
+#include "RealtimeSanitizer.h"
+#include "ProfilerTrace.h"
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> NamedMutex::sTrackContention{ false };
+
+namespace
+{
+   std::mutex sTrackedMutexesLock;
+   std::vector<std::pair<std::string, NamedMutex*>> sTrackedMutexes;
+
+   void UpdateMax(std::atomic<uint64_t>& max, uint64_t value)
+   {
+      uint64_t current = max.load(std::memory_order_relaxed);
+      while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+      {
+      }
+   }
+}
+
+int MutexContentionStats::FindLocker(const std::string& locker)
+{
+   uint32_t hash = JenkinsHash(locker.c_str());
+   if (hash == 0)
+      hash = 1;
+
+   for (int i = 0; i < kMaxLockers; ++i)
+   {
+      uint32_t slotHash = mLockers[i].mHash.load(std::memory_order_acquire);
+      if (slotHash == hash)
+         return i;
+      if (slotHash == 0)
+      {
+         uint32_t expected = 0;
+         if (mLockers[i].mHash.compare_exchange_strong(expected, hash))
+         {
+            strncpy(mLockers[i].mName, locker.c_str(), kMaxLockerNameLength - 1);
+            mLockers[i].mNameReady.store(true, std::memory_order_release);
+            return i;
+         }
+         if (expected == hash) //another thread claimed it for the same locker first
+            return i;
+      }
+   }
+   return -1;
+}
+
+void MutexContentionStats::Clear()
+{
+   mAudioThreadWait.Clear();
+   mOtherThreadWait.Clear();
+   mHold.Clear();
+   //the slots themselves stay claimed, so lockers that are holding the mutex right now keep pointing at the right one
+   for (auto& locker : mLockers)
+   {
+      locker.mAudioThreadBlocks.store(0, std::memory_order_relaxed);
+      locker.mAudioThreadBlockedNs.store(0, std::memory_order_relaxed);
+      locker.mMaxHoldNs.store(0, std::memory_order_relaxed);
+   }
+}
+
+NamedMutex::NamedMutex(std::string name)
+: mName(std::move(name))
+, mStats(std::make_unique<MutexContentionStats>())
+{
+   std::lock_guard<std::mutex> lock(sTrackedMutexesLock);
+   sTrackedMutexes.push_back(std::make_pair(mName, this));
+}
+
+NamedMutex::~NamedMutex()
+{
+   if (mStats == nullptr)
+      return;
+
+   std::lock_guard<std::mutex> lock(sTrackedMutexesLock);
+   for (auto iter = sTrackedMutexes.begin(); iter != sTrackedMutexes.end(); ++iter)
+   {
+      if (iter->second == this)
+      {
+         sTrackedMutexes.erase(iter);
+         break;
+      }
+   }
+}
 
 void NamedMutex::Lock(std::string locker)
 {
@@ -32,14 +120,70 @@ void NamedMutex::Lock(std::string locker)
       ++mExtraLockCount;
       return;
    }
-   mMutex.lock();
+
+   REALTIME_SANITIZER_CHECK("NamedMutex::Lock()", locker.c_str());
+#if BESPOKE_REALTIME_SANITIZER
+   RealtimeSanitizer::ScopedSuppress alreadyReported;
+#endif
+
+   if (mStats == nullptr || !sTrackContention.load(std::memory_order_relaxed))
+   {
+      if (!ProfilerTrace::IsRecording())
+      {
+         mMutex.lock();
+      }
+      else if (!mMutex.try_lock())
+      {
+         ProfilerTrace::Scope wait(locker.c_str(), kTraceCategory_LockWait);
+         mMutex.lock();
+      }
+      mLocker = locker;
+      ++mTrackedDepth;
+      return;
+   }
+
+   int slot = mStats->FindLocker(locker);
+   bool isAudioThread = IsAudioThread();
+   uint64_t waitNs = 0;
+   if (!mMutex.try_lock())
+   {
+      //whoever has it now is who we're waiting on. it could let go before we read this, then there's no one to blame
+      int holder = mHolder.load(std::memory_order_acquire);
+      uint64_t waitStart = ofGetSystemTimeNanos();
+      mMutex.lock();
+      uint64_t waitEnd = ofGetSystemTimeNanos();
+      waitNs = waitEnd - waitStart;
+      ProfilerTrace::Record(locker.c_str(), kTraceCategory_LockWait, waitStart, waitEnd);
+
+      if (isAudioThread && holder != -1)
+      {
+         mStats->mLockers[holder].mAudioThreadBlocks.fetch_add(1, std::memory_order_relaxed);
+         mStats->mLockers[holder].mAudioThreadBlockedNs.fetch_add(waitNs, std::memory_order_relaxed);
+      }
+   }
+   (isAudioThread ? mStats->mAudioThreadWait : mStats->mOtherThreadWait).Add(waitNs);
+
    mLocker = locker;
+   if (mTrackedDepth++ == 0)
+   {
+      mHoldStartNs = ofGetSystemTimeNanos();
+      mHolder.store(slot, std::memory_order_release);
+   }
 }
 
 void NamedMutex::Unlock()
 {
    if (mExtraLockCount == 0)
    {
+      if (--mTrackedDepth == 0 && mHoldStartNs != 0)
+      {
+         uint64_t holdNs = ofGetSystemTimeNanos() - mHoldStartNs;
+         mStats->mHold.Add(holdNs);
+         int holder = mHolder.exchange(-1, std::memory_order_acq_rel);
+         if (holder != -1)
+            UpdateMax(mStats->mLockers[holder].mMaxHoldNs, holdNs);
+         mHoldStartNs = 0;
+      }
       mLocker = "<none>";
       mMutex.unlock();
    }
@@ -49,6 +193,26 @@ void NamedMutex::Unlock()
    }
 }
 
+//static
+void NamedMutex::SetContentionTrackingEnabled(bool enabled)
+{
+   if (enabled && !sTrackContention)
+   {
+      std::lock_guard<std::mutex> lock(sTrackedMutexesLock);
+      for (auto& tracked : sTrackedMutexes)
+         tracked.second->mStats->Clear();
+   }
+   sTrackContention = enabled;
+}
+
+//static
+void NamedMutex::ForEachTracked(std::function<void(const std::string& name, const MutexContentionStats& stats)> visit)
+{
+   std::lock_guard<std::mutex> lock(sTrackedMutexesLock);
+   for (auto& tracked : sTrackedMutexes)
+      visit(tracked.first, *tracked.second->mStats);
+}
+
 ScopedMutex::ScopedMutex(NamedMutex* mutex, std::string locker)
 : mMutex(mutex)
 {
@@ -26,17 +26,68 @@
 #pragma once
 
 #include "OpenFrameworksPort.h"
+#include "Log2Histogram.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+//how long a named mutex gets waited on and held, and by whom. every counter is atomic,
+//so the audio thread can record into it without taking another lock
+struct MutexContentionStats
+{
+   static const int kMaxLockers = 32;
+   static const int kMaxLockerNameLength = 48;
+
+   using Histogram = Log2Histogram;
+
+   struct Locker
+   {
+      std::atomic<uint32_t> mHash{ 0 }; //0 for a free slot
+      std::atomic<bool> mNameReady{ false };
+      char mName[kMaxLockerNameLength]{};
+      std::atomic<uint32_t> mAudioThreadBlocks{ 0 }; //times the audio thread had to wait while this locker held the mutex
+      std::atomic<uint64_t> mAudioThreadBlockedNs{ 0 };
+      std::atomic<uint64_t> mMaxHoldNs{ 0 };
+   };
+
+   int FindLocker(const std::string& locker); //claims a slot the first time a locker shows up, -1 once they're all taken
+   void Clear();
+
+   Histogram mAudioThreadWait;
+   Histogram mOtherThreadWait;
+   Histogram mHold;
+   std::array<Locker, kMaxLockers> mLockers;
+};
 
 class NamedMutex
 {
 public:
+   NamedMutex() = default;
+   explicit NamedMutex(std::string name); //only named mutexes keep contention stats
+   ~NamedMutex();
+
    void Lock(std::string locker);
    void Unlock();
 
+   //off by default, the profiler overlay turns it on
+   static void SetContentionTrackingEnabled(bool enabled);
+   static bool IsContentionTrackingEnabled() { return sTrackContention; }
+   static void ForEachTracked(std::function<void(const std::string& name, const MutexContentionStats& stats)> visit);
+
 private:
    ofMutex mMutex;
    std::string mLocker{ "<none>" };
    int mExtraLockCount{ 0 };
+
+   std::string mName;
+   std::unique_ptr<MutexContentionStats> mStats;
+   std::atomic<int> mHolder{ -1 }; //locker slot of whoever has it, for the audio thread to blame when it blocks
+   uint64_t mHoldStartNs{ 0 };
+   int mTrackedDepth{ 0 };
+
+   static std::atomic<bool> sTrackContention;
 };
 
 class ScopedMutex
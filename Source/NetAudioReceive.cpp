@@ -0,0 +1,302 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    NetAudioReceive.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "NetAudioReceive.h"
+#include "IAudioReceiver.h"
+#include "ModularSynth.h"
+#include "PatchCableSource.h"
+#include "Profiler.h"
+#include "UIControlMacros.h"
+
+NetAudioReceive::NetAudioReceive()
+: mSlots(kNumSlots)
+, mSlotSequences(kNumSlots, kNoSequence)
+{
+}
+
+void NetAudioReceive::Init()
+{
+   IDrawableModule::Init();
+
+   Listen();
+}
+
+void NetAudioReceive::CreateUIControls()
+{
+   IDrawableModule::CreateUIControls();
+   UIBLOCK0();
+   TEXTENTRY_NUM(mPortEntry, "port", 5, &mPort, 1, 65535);
+   UIBLOCK_SHIFTRIGHT();
+   CHECKBOX(mAllowRemoteCheckbox, "lan", &mAllowRemote);
+   UIBLOCK_NEWLINE();
+   FLOATSLIDER(mLatencySlider, "latency", &mLatencyMs, 5, 250);
+   ENDUIBLOCK(mWidth, mHeight);
+   mHeight += 10; //room for the status
+
+   mLatencySlider->SetMode(FloatSlider::kSquare);
+
+   mNoteOutput.SetPatchCableSource(new PatchCableSource(this, kConnectionType_Note));
+   mNoteOutput.GetPatchCableSource()->SetManualPosition(mWidth - 30, mHeight + 5);
+   mNoteOutput.GetPatchCableSource()->SetOverrideCableDir(ofVec2f(0, 1), PatchCableSource::Side::kBottom);
+   AddPatchCableSource(mNoteOutput.GetPatchCableSource());
+
+   mPulseCable = new PatchCableSource(this, kConnectionType_Pulse);
+   mPulseCable->SetManualPosition(mWidth - 15, mHeight + 5);
+   mPulseCable->SetOverrideCableDir(ofVec2f(0, 1), PatchCableSource::Side::kBottom);
+   AddPatchCableSource(mPulseCable);
+}
+
+NetAudioReceive::~NetAudioReceive()
+{
+   mReceiver.Disconnect();
+}
+
+void NetAudioReceive::Listen()
+{
+   mListening = mReceiver.Listen(mPort, mAllowRemote);
+}
+
+int NetAudioReceive::GetLatencyFrames() const
+{
+   //a packet's worth is taken up waiting for the sender to fill it
+   int frames = (int)round(mLatencyMs / gInvSampleRateMs) + NetAudioPacket::kFrames;
+   return MIN(frames, (kNumSlots - 2) * NetAudioPacket::kFrames);
+}
+
+void NetAudioReceive::Process(double time)
+{
+   PROFILER(NetAudioReceive);
+
+   ReceivePackets();
+
+   IAudioReceiver* target = GetTarget();
+   if (!mEnabled || !mSynced)
+      return;
+
+   //play out the latency behind the newest packet. falling far behind means packets came in a burst, so jump to catch up.
+   //otherwise, follow it slowly, a sample at a time, so the jitter in when packets arrive doesn't come through.
+   //running ahead just plays silence, until the sender comes back (see ReceivePackets())
+   int latency = GetLatencyFrames();
+   int64_t newestEnd = (int64_t)(mNewestSequence + 1) * NetAudioPacket::kFrames;
+   float error = (float)(newestEnd - latency - mPlayFrame);
+   if (mLatencyChanged.exchange(false) || error > latency)
+   {
+      Resync();
+   }
+   else
+   {
+      mDrift += (error - mDrift) * .01f;
+      if (mDrift > NetAudioPacket::kFrames / 2)
+      {
+         ++mPlayFrame;
+         mDrift -= 1;
+      }
+      else if (mDrift < -NetAudioPacket::kFrames / 2)
+      {
+         --mPlayFrame;
+         mDrift += 1;
+      }
+   }
+
+   SyncOutputBuffer(mNumChannels);
+
+   int bufferSize = gBufferSize;
+   for (int i = 0; i < bufferSize;)
+   {
+      int64_t frame = mPlayFrame + i;
+      int offset = (int)(((frame % NetAudioPacket::kFrames) + NetAudioPacket::kFrames) % NetAudioPacket::kFrames);
+      int frames = MIN(bufferSize - i, NetAudioPacket::kFrames - offset);
+
+      const NetAudioPacket* packet = GetPacket(frame);
+      for (int ch = 0; ch < mNumChannels; ++ch)
+      {
+         if (packet != nullptr && ch < packet->mNumChannels)
+         {
+            if (target != nullptr)
+               Add(target->GetBuffer()->GetChannel(ch) + i, packet->mSamples[ch] + offset, frames);
+            GetVizBuffer()->WriteChunk(packet->mSamples[ch] + offset, frames, ch);
+         }
+         else
+         {
+            for (int j = 0; j < frames; ++j)
+               GetVizBuffer()->Write(0, ch);
+         }
+      }
+
+      if (packet != nullptr)
+      {
+         PlayEvents(*packet, offset, frames, time + i * gInvSampleRateMs);
+      }
+      else if (frame >= 0)
+      {
+         uint64_t sequence = (uint64_t)(frame / NetAudioPacket::kFrames);
+         if (sequence <= mNewestSequence && sequence != mLastLostSequence)
+         {
+            mLastLostSequence = sequence;
+            ++mNumLost;
+         }
+      }
+
+      i += frames;
+   }
+
+   mEventsPlayedThrough = MAX(mEventsPlayedThrough, mPlayFrame + bufferSize - 1);
+   mPlayFrame += bufferSize;
+}
+
+void NetAudioReceive::ReceivePackets()
+{
+   int latency = GetLatencyFrames();
+   while (mReceiver.Receive(mIncoming))
+   {
+      //a new stream, from a sender that reconnected or a different one, or the same one coming back from a stall
+      int64_t packetStart = (int64_t)mIncoming.mSequence * NetAudioPacket::kFrames;
+      if (!mSynced || mIncoming.mStreamId != mStreamId || packetStart + latency * 2 < mPlayFrame)
+      {
+         mSynced = true;
+         mStreamId = mIncoming.mStreamId;
+         std::fill(mSlotSequences.begin(), mSlotSequences.end(), kNoSequence);
+         mNewestSequence = mIncoming.mSequence;
+         Resync();
+      }
+
+      if (packetStart + NetAudioPacket::kFrames <= mPlayFrame)
+      {
+         ++mNumLate;
+         continue;
+      }
+
+      int slot = (int)(mIncoming.mSequence % kNumSlots);
+      mSlots[slot] = mIncoming;
+      mSlotSequences[slot] = mIncoming.mSequence;
+      mNewestSequence = MAX(mNewestSequence, mIncoming.mSequence);
+      mNumChannels = mIncoming.mNumChannels;
+      mSenderSampleRate = mIncoming.mSampleRate;
+   }
+}
+
+void NetAudioReceive::Resync()
+{
+   mPlayFrame = (int64_t)(mNewestSequence + 1) * NetAudioPacket::kFrames - GetLatencyFrames();
+   mEventsPlayedThrough = mPlayFrame - 1;
+   mDrift = 0;
+}
+
+const NetAudioPacket* NetAudioReceive::GetPacket(int64_t frame) const
+{
+   if (frame < 0)
+      return nullptr;
+   uint64_t sequence = (uint64_t)(frame / NetAudioPacket::kFrames);
+   int slot = (int)(sequence % kNumSlots);
+   if (mSlotSequences[slot] != sequence)
+      return nullptr;
+   return &mSlots[slot];
+}
+
+void NetAudioReceive::PlayEvents(const NetAudioPacket& packet, int offset, int frames, double time)
+{
+   int64_t packetStart = (int64_t)packet.mSequence * NetAudioPacket::kFrames;
+   for (int i = 0; i < packet.mNumEvents; ++i)
+   {
+      const NetAudioPacket::Event& event = packet.mEvents[i];
+      if (event.mOffset < offset || event.mOffset >= offset + frames || packetStart + event.mOffset <= mEventsPlayedThrough)
+         continue;
+
+      double eventTime = time + (event.mOffset - offset) * gInvSampleRateMs;
+      if (event.mType == NetAudioPacket::EventType::Note)
+      {
+         NoteMessage note(eventTime, event.mPitch, 0, event.mVoiceIdx);
+         note.velocity = event.mVelocity;
+         mNoteOutput.PlayNoteOutput(note);
+      }
+      else
+      {
+         DispatchPulse(mPulseCable, eventTime, event.mVelocity, event.mPitch);
+      }
+   }
+}
+
+void NetAudioReceive::DrawModule()
+{
+   if (Minimized() || IsVisible() == false)
+      return;
+
+   mPortEntry->Draw();
+   mAllowRemoteCheckbox->Draw();
+   mLatencySlider->Draw();
+
+   ofPushStyle();
+   int senderSampleRate = mSenderSampleRate;
+   if (!mListening)
+   {
+      ofSetColor(255, 0, 0);
+      DrawTextNormal("port in use", 5, mHeight - 4);
+   }
+   else if (senderSampleRate != 0 && senderSampleRate != gSampleRate)
+   {
+      ofSetColor(255, 0, 0);
+      DrawTextNormal("sender is at " + ofToString(senderSampleRate) + "hz", 5, mHeight - 4);
+   }
+   else
+   {
+      ofSetColor(255, 255, 255, gModuleDrawAlpha);
+      DrawTextNormal(ofToString(mReceiver.GetNumReceived()) + " in, " + ofToString(mNumLost + mNumLate) + " lost", 5, mHeight - 4);
+   }
+   ofPopStyle();
+}
+
+void NetAudioReceive::TextEntryComplete(TextEntry* entry)
+{
+   if (entry == mPortEntry)
+      Listen();
+}
+
+void NetAudioReceive::CheckboxUpdated(Checkbox* checkbox, double time)
+{
+   if (checkbox == mAllowRemoteCheckbox)
+      Listen();
+}
+
+void NetAudioReceive::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
+{
+   if (slider == mLatencySlider)
+   {
+      mLatencyChanged = true;
+      TheSynth->ArrangeAudioSourceDependencies();
+   }
+}
+
+void NetAudioReceive::LoadLayout(const ofxJSONElement& moduleInfo)
+{
+   mModuleSaveData.LoadString("target", moduleInfo);
+
+   SetUpFromSaveData();
+}
+
+void NetAudioReceive::SetUpFromSaveData()
+{
+   SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
+}
@@ -0,0 +1,123 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    NetAudioReceive.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "IAudioSource.h"
+#include "IDrawableModule.h"
+#include "INoteSource.h"
+#include "Checkbox.h"
+#include "IPulseReceiver.h"
+#include "NetAudioStream.h"
+#include "Slider.h"
+#include "TextEntry.h"
+
+#include <atomic>
+#include <vector>
+
+class PatchCableSource;
+
+//plays the stream from a netsend, with its notes and pulses on their own cables.
+//packets are held in a jitter buffer and played out a fixed latency behind the newest one, which is reported for delay compensation.
+//a packet that hasn't arrived by the time it's due plays as silence, and clock drift between the machines is taken up a sample at a time
+class NetAudioReceive : public IAudioSource, public IPulseSource, public IDrawableModule, public ITextEntryListener, public IFloatSliderListener
+{
+public:
+   NetAudioReceive();
+   virtual ~NetAudioReceive();
+   static IDrawableModule* Create() { return new NetAudioReceive(); }
+   static bool AcceptsAudio() { return false; }
+   static bool AcceptsNotes() { return false; }
+   static bool AcceptsPulses() { return false; }
+
+   void Init() override;
+   void CreateUIControls() override;
+
+   //IAudioSource
+   void Process(double time) override;
+   void SetEnabled(bool enabled) override { mEnabled = enabled; }
+   int GetLatencySamples() const override { return GetLatencyFrames(); }
+
+   void TextEntryComplete(TextEntry* entry) override;
+   void CheckboxUpdated(Checkbox* checkbox, double time) override;
+   void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
+
+   virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
+   virtual void SetUpFromSaveData() override;
+
+   bool IsEnabled() const override { return mEnabled; }
+
+private:
+   static constexpr int kNumSlots = 256; //packets, enough for the longest latency at 192k
+   static constexpr uint64_t kNoSequence = ~0ull;
+
+   //IDrawableModule
+   void DrawModule() override;
+   void GetModuleDimensions(float& w, float& h) override
+   {
+      w = mWidth;
+      h = mHeight;
+   }
+
+   void Listen();
+   int GetLatencyFrames() const;
+   void ReceivePackets();
+   void Resync();
+   const NetAudioPacket* GetPacket(int64_t frame) const; //nullptr if it was lost, or hasn't arrived yet
+   void PlayEvents(const NetAudioPacket& packet, int offset, int frames, double time);
+
+   int mPort{ NetAudioPacket::kDefaultPort };
+   TextEntry* mPortEntry{ nullptr };
+   bool mAllowRemote{ false }; //off so a patch doesn't take notes from anyone on the network until asked to
+   Checkbox* mAllowRemoteCheckbox{ nullptr };
+   float mLatencyMs{ 30 };
+   FloatSlider* mLatencySlider{ nullptr };
+   float mWidth{ 120 };
+   float mHeight{ 40 };
+
+   NetAudioReceiver mReceiver;
+   bool mListening{ false };
+   AdditionalNoteCable mNoteOutput;
+   PatchCableSource* mPulseCable{ nullptr };
+
+   //audio thread
+   std::vector<NetAudioPacket> mSlots;
+   std::vector<uint64_t> mSlotSequences;
+   NetAudioPacket mIncoming;
+   bool mSynced{ false };
+   uint32_t mStreamId{ 0 };
+   uint64_t mNewestSequence{ 0 };
+   int64_t mPlayFrame{ 0 }; //where in the stream the next buffer starts
+   int64_t mEventsPlayedThrough{ -1 }; //so repeating a frame for drift doesn't play its notes twice
+   float mDrift{ 0 };
+   uint64_t mLastLostSequence{ kNoSequence };
+   int mNumChannels{ 1 };
+
+   std::atomic<bool> mLatencyChanged{ false };
+   std::atomic<int> mSenderSampleRate{ 0 };
+   std::atomic<int> mNumLost{ 0 };
+   std::atomic<int> mNumLate{ 0 };
+};
@@ -0,0 +1,241 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    NetAudioSend.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "NetAudioSend.h"
+#include "ModularSynth.h"
+#include "Profiler.h"
+#include "UIControlMacros.h"
+
+namespace
+{
+   const int kMaxPendingEvents = 256;
+}
+
+NetAudioSend::NetAudioSend()
+: IAudioProcessor(gBufferSize)
+{
+   mEvents.reserve(kMaxPendingEvents);
+}
+
+void NetAudioSend::Init()
+{
+   IDrawableModule::Init();
+
+   Connect();
+}
+
+void NetAudioSend::CreateUIControls()
+{
+   IDrawableModule::CreateUIControls();
+   UIBLOCK0();
+   TEXTENTRY(mHostEntry, "host", 13, &mHost);
+   TEXTENTRY_NUM(mPortEntry, "port", 5, &mPort, 1, 65535);
+   ENDUIBLOCK(mWidth, mHeight);
+   mHeight += 10; //room for the status
+}
+
+NetAudioSend::~NetAudioSend()
+{
+   mSender.Disconnect();
+}
+
+void NetAudioSend::Connect()
+{
+   mConnected = false;
+   mSender.Connect(mHost, mPort);
+   mStreamId = juce::Random::getSystemRandom().nextInt();
+   mConnected = mSender.IsConnected();
+}
+
+void NetAudioSend::Process(double time)
+{
+   PROFILER(NetAudioSend);
+
+   SyncBuffers();
+
+   ChannelBuffer* buffer = GetBuffer();
+   int bufferSize = buffer->BufferSize();
+   int numChannels = MIN(buffer->NumActiveChannels(), ChannelBuffer::kMaxNumChannels);
+
+   //a new connection is a new stream, so the receiver starts over instead of waiting for the old one to catch up
+   uint32_t streamId = mStreamId;
+   if (streamId != mPacket.mStreamId)
+   {
+      mPacket.mStreamId = streamId;
+      mPacket.mNumChannels = 0;
+      mPacket.mNumEvents = 0;
+      mPacketFrames = 0;
+      mSequence = 0;
+      mStreamFrames = 0;
+      mEvents.clear();
+   }
+
+   mBufferStartFrame = mStreamFrames;
+   mBufferStartTime = time;
+
+   if (mEnabled && mConnected)
+   {
+      for (int i = 0; i < bufferSize;)
+      {
+         int frames = MIN(bufferSize - i, NetAudioPacket::kFrames - mPacketFrames);
+         for (int ch = mPacket.mNumChannels; ch < numChannels; ++ch)
+            std::fill(mPacket.mSamples[ch], mPacket.mSamples[ch] + mPacketFrames, 0.0f);
+         mPacket.mNumChannels = MAX(mPacket.mNumChannels, numChannels);
+         for (int ch = 0; ch < mPacket.mNumChannels; ++ch)
+         {
+            if (ch < numChannels)
+               BufferCopy(mPacket.mSamples[ch] + mPacketFrames, buffer->GetChannelReadOnly(ch) + i, frames);
+            else
+               std::fill(mPacket.mSamples[ch] + mPacketFrames, mPacket.mSamples[ch] + mPacketFrames + frames, 0.0f);
+         }
+
+         mPacketFrames += frames;
+         mStreamFrames += frames;
+         i += frames;
+         if (mPacketFrames == NetAudioPacket::kFrames)
+            FinishPacket();
+      }
+   }
+
+   IAudioReceiver* target = GetTarget();
+   if (target != nullptr)
+   {
+      SyncOutputBuffer(numChannels);
+      for (int ch = 0; ch < numChannels; ++ch)
+         Add(target->GetBuffer()->GetChannel(ch), buffer->GetChannelReadOnly(ch), bufferSize);
+   }
+   for (int ch = 0; ch < numChannels; ++ch)
+      GetVizBuffer()->WriteChunk(buffer->GetChannelReadOnly(ch), bufferSize, ch);
+
+   buffer->Reset();
+}
+
+void NetAudioSend::FinishPacket()
+{
+   int64_t packetEnd = mStreamFrames;
+   int64_t packetStart = packetEnd - NetAudioPacket::kFrames;
+
+   //events that don't fit go out at the start of the next packet, a little late rather than lost
+   int numKept = 0;
+   for (const auto& pending : mEvents)
+   {
+      if (pending.mFrame < packetEnd && mPacket.mNumEvents < NetAudioPacket::kMaxEvents)
+      {
+         NetAudioPacket::Event& event = mPacket.mEvents[mPacket.mNumEvents++];
+         event = pending.mEvent;
+         event.mOffset = (int)ofClamp(pending.mFrame - packetStart, 0, NetAudioPacket::kFrames - 1);
+      }
+      else
+      {
+         mEvents[numKept++] = pending;
+      }
+   }
+   mEvents.resize(numKept);
+
+   mPacket.mSequence = mSequence++;
+   mPacket.mSampleRate = gSampleRate;
+   if (!mSender.Send(mPacket))
+      ++mNumDropped;
+
+   mPacket.mNumChannels = 0;
+   mPacket.mNumEvents = 0;
+   mPacketFrames = 0;
+}
+
+void NetAudioSend::AddEvent(double time, const NetAudioPacket::Event& event)
+{
+   if (!mEnabled || !mConnected || (int)mEvents.size() >= kMaxPendingEvents)
+      return;
+
+   //relative to the start of the last buffer processed, which works out the same whether or not this buffer has been processed yet
+   PendingEvent pending;
+   pending.mFrame = mBufferStartFrame + (int64_t)round((time - mBufferStartTime) / gInvSampleRateMs);
+   pending.mEvent = event;
+   mEvents.push_back(pending);
+}
+
+void NetAudioSend::PlayNote(NoteMessage note)
+{
+   NetAudioPacket::Event event;
+   event.mType = NetAudioPacket::EventType::Note;
+   event.mPitch = note.pitch;
+   event.mVelocity = note.velocity;
+   event.mVoiceIdx = note.voiceIdx;
+   AddEvent(note.time, event);
+}
+
+void NetAudioSend::OnPulse(double time, float velocity, int flags)
+{
+   NetAudioPacket::Event event;
+   event.mType = NetAudioPacket::EventType::Pulse;
+   event.mPitch = flags;
+   event.mVelocity = velocity;
+   AddEvent(time, event);
+}
+
+void NetAudioSend::DrawModule()
+{
+   if (Minimized() || IsVisible() == false)
+      return;
+
+   mHostEntry->Draw();
+   mPortEntry->Draw();
+
+   ofPushStyle();
+   if (!mConnected)
+   {
+      ofSetColor(255, 0, 0);
+      DrawTextNormal("not connected", 5, mHeight - 4);
+   }
+   else
+   {
+      ofSetColor(255, 255, 255, gModuleDrawAlpha);
+      std::string status = ofToString(mSender.GetNumSent()) + " sent";
+      int failed = mSender.GetNumFailed() + mNumDropped;
+      if (failed > 0)
+         status += ", " + ofToString(failed) + " failed";
+      DrawTextNormal(status, 5, mHeight - 4);
+   }
+   ofPopStyle();
+}
+
+void NetAudioSend::TextEntryComplete(TextEntry* entry)
+{
+   if (entry == mHostEntry || entry == mPortEntry)
+      Connect();
+}
+
+void NetAudioSend::LoadLayout(const ofxJSONElement& moduleInfo)
+{
+   mModuleSaveData.LoadString("target", moduleInfo);
+
+   SetUpFromSaveData();
+}
+
+void NetAudioSend::SetUpFromSaveData()
+{
+   SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
+}
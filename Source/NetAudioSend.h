@@ -0,0 +1,111 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    NetAudioSend.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "IAudioProcessor.h"
+#include "IDrawableModule.h"
+#include "INoteReceiver.h"
+#include "IPulseReceiver.h"
+#include "NetAudioStream.h"
+#include "TextEntry.h"
+
+#include <atomic>
+#include <vector>
+
+//passes audio through untouched, and streams it over udp to a netreceive on another machine (or another instance on this one),
+//along with the notes and pulses sent into it, each at the sample they arrived at
+class NetAudioSend : public IAudioProcessor, public IDrawableModule, public INoteReceiver, public IPulseReceiver, public ITextEntryListener
+{
+public:
+   NetAudioSend();
+   virtual ~NetAudioSend();
+   static IDrawableModule* Create() { return new NetAudioSend(); }
+   static bool AcceptsAudio() { return true; }
+   static bool AcceptsNotes() { return true; }
+   static bool AcceptsPulses() { return true; }
+
+   void Init() override;
+   void CreateUIControls() override;
+
+   //IAudioSource
+   void Process(double time) override;
+   void SetEnabled(bool enabled) override { mEnabled = enabled; }
+
+   //INoteReceiver
+   void PlayNote(NoteMessage note) override;
+   void SendCC(int control, int value, int voiceIdx = -1) override {}
+
+   //IPulseReceiver
+   void OnPulse(double time, float velocity, int flags) override;
+
+   void TextEntryComplete(TextEntry* entry) override;
+
+   virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
+   virtual void SetUpFromSaveData() override;
+
+   bool IsEnabled() const override { return mEnabled; }
+
+private:
+   struct PendingEvent
+   {
+      int64_t mFrame{ 0 }; //in the stream
+      NetAudioPacket::Event mEvent;
+   };
+
+   //IDrawableModule
+   void DrawModule() override;
+   void GetModuleDimensions(float& w, float& h) override
+   {
+      w = mWidth;
+      h = mHeight;
+   }
+
+   void Connect();
+   void AddEvent(double time, const NetAudioPacket::Event& event);
+   void FinishPacket();
+
+   std::string mHost{ "127.0.0.1" };
+   TextEntry* mHostEntry{ nullptr };
+   int mPort{ NetAudioPacket::kDefaultPort };
+   TextEntry* mPortEntry{ nullptr };
+   float mWidth{ 120 };
+   float mHeight{ 40 };
+
+   NetAudioSender mSender;
+   std::atomic<bool> mConnected{ false };
+   std::atomic<uint32_t> mStreamId{ 0 }; //a new one on every connect, picked up by the audio thread
+
+   //audio thread
+   NetAudioPacket mPacket;
+   int mPacketFrames{ 0 };
+   uint64_t mSequence{ 0 };
+   int64_t mStreamFrames{ 0 };
+   int64_t mBufferStartFrame{ 0 };
+   double mBufferStartTime{ 0 };
+   std::vector<PendingEvent> mEvents;
+   std::atomic<int> mNumDropped{ 0 };
+};
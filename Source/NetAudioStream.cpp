@@ -0,0 +1,276 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    NetAudioStream.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "NetAudioStream.h"
+#include "SynthGlobals.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+   const std::uint32_t kMagic = 0x31414e42; //"BNA1"
+
+   //everything goes over the wire little endian, whatever the machines are
+   class PacketWriter
+   {
+   public:
+      explicit PacketWriter(char* data)
+      : mData(data)
+      {
+      }
+
+      template <typename T>
+      void Write(T value)
+      {
+         static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "");
+         std::uint64_t bits = 0;
+         memcpy(&bits, &value, sizeof(T));
+         for (size_t i = 0; i < sizeof(T); ++i)
+            mData[mPosition++] = (char)((bits >> (i * 8)) & 0xff);
+      }
+      int GetPosition() const { return mPosition; }
+
+   private:
+      char* mData{ nullptr };
+      int mPosition{ 0 };
+   };
+
+   class PacketReader
+   {
+   public:
+      PacketReader(const char* data, int size)
+      : mData(data)
+      , mSize(size)
+      {
+      }
+
+      template <typename T>
+      bool Read(T& value)
+      {
+         if (mPosition + (int)sizeof(T) > mSize)
+            return false;
+         std::uint64_t bits = 0;
+         for (size_t i = 0; i < sizeof(T); ++i)
+            bits |= (std::uint64_t)(std::uint8_t)mData[mPosition++] << (i * 8);
+         memcpy(&value, &bits, sizeof(T));
+         return true;
+      }
+
+   private:
+      const char* mData{ nullptr };
+      int mSize{ 0 };
+      int mPosition{ 0 };
+   };
+}
+
+int NetAudioPacket::Write(char* data) const
+{
+   PacketWriter writer(data);
+   writer.Write(kMagic);
+   writer.Write(mStreamId);
+   writer.Write(mSequence);
+   writer.Write((std::int32_t)mSampleRate);
+   writer.Write((std::uint16_t)mNumChannels);
+   writer.Write((std::uint16_t)mNumEvents);
+   for (int ch = 0; ch < mNumChannels; ++ch)
+   {
+      for (int i = 0; i < kFrames; ++i)
+         writer.Write(mSamples[ch][i]);
+   }
+   for (int i = 0; i < mNumEvents; ++i)
+   {
+      writer.Write((std::uint8_t)mEvents[i].mType);
+      writer.Write((std::uint16_t)mEvents[i].mOffset);
+      writer.Write((std::int32_t)mEvents[i].mPitch);
+      writer.Write(mEvents[i].mVelocity);
+      writer.Write((std::int32_t)mEvents[i].mVoiceIdx);
+   }
+   return writer.GetPosition();
+}
+
+bool NetAudioPacket::Read(const char* data, int size)
+{
+   PacketReader reader(data, size);
+   std::uint32_t magic = 0;
+   std::int32_t sampleRate = 0;
+   std::uint16_t numChannels = 0;
+   std::uint16_t numEvents = 0;
+   if (!reader.Read(magic) || magic != kMagic || !reader.Read(mStreamId) || !reader.Read(mSequence) ||
+       !reader.Read(sampleRate) || !reader.Read(numChannels) || !reader.Read(numEvents))
+      return false;
+   if (numChannels < 1 || numChannels > ChannelBuffer::kMaxNumChannels || numEvents > kMaxEvents)
+      return false;
+
+   mSampleRate = sampleRate;
+   mNumChannels = numChannels;
+   mNumEvents = numEvents;
+   for (int ch = 0; ch < mNumChannels; ++ch)
+   {
+      for (int i = 0; i < kFrames; ++i)
+      {
+         if (!reader.Read(mSamples[ch][i]))
+            return false;
+      }
+   }
+   for (int i = 0; i < mNumEvents; ++i)
+   {
+      std::uint8_t type = 0;
+      std::uint16_t offset = 0;
+      std::int32_t pitch = 0;
+      std::int32_t voiceIdx = 0;
+      if (!reader.Read(type) || !reader.Read(offset) || !reader.Read(pitch) || !reader.Read(mEvents[i].mVelocity) || !reader.Read(voiceIdx))
+         return false;
+      if (type > (std::uint8_t)EventType::Pulse || offset >= kFrames || !std::isfinite(mEvents[i].mVelocity))
+         return false;
+      //these come straight off the network, and end up indexing per-pitch and per-voice arrays downstream
+      if ((EventType)type == EventType::Note && (pitch < 0 || pitch > 127 || voiceIdx < -1 || voiceIdx >= kNumVoices))
+         return false;
+      mEvents[i].mType = (EventType)type;
+      mEvents[i].mOffset = offset;
+      mEvents[i].mPitch = pitch;
+      mEvents[i].mVoiceIdx = voiceIdx;
+   }
+   return true;
+}
+
+NetAudioSender::NetAudioSender()
+: juce::Thread("net audio send")
+{
+   mBytes.resize(NetAudioPacket::kMaxBytes);
+}
+
+NetAudioSender::~NetAudioSender()
+{
+   Disconnect();
+}
+
+void NetAudioSender::Connect(std::string host, int port)
+{
+   Disconnect();
+
+   if (host.empty() || port <= 0)
+      return;
+
+   //nothing to bind, the system picks the port we send from
+   mHost = host;
+   mPort = port;
+   mSocket = std::make_unique<juce::DatagramSocket>(false);
+   startThread(8); //audio is waiting on the other end
+}
+
+void NetAudioSender::Disconnect()
+{
+   signalThreadShouldExit();
+   stopThread(1000);
+   mSocket.reset();
+
+   NetAudioPacket packet;
+   while (mQueue.try_dequeue(packet))
+   {
+   }
+}
+
+bool NetAudioSender::Send(const NetAudioPacket& packet)
+{
+   return mQueue.try_enqueue(packet);
+}
+
+void NetAudioSender::run()
+{
+   NetAudioPacket packet;
+   while (!threadShouldExit())
+   {
+      //wake up now and then to check whether we should be stopping
+      if (!mQueue.wait_dequeue_timed(packet, 100000))
+         continue;
+
+      int bytes = packet.Write(mBytes.data());
+      if (mSocket->write(mHost, mPort, mBytes.data(), bytes) == bytes)
+         ++mNumSent;
+      else
+         ++mNumFailed;
+   }
+}
+
+NetAudioReceiver::NetAudioReceiver()
+: juce::Thread("net audio receive")
+{
+   mBytes.resize(NetAudioPacket::kMaxBytes);
+}
+
+NetAudioReceiver::~NetAudioReceiver()
+{
+   Disconnect();
+}
+
+bool NetAudioReceiver::Listen(int port, bool allowRemote)
+{
+   Disconnect();
+
+   auto socket = std::make_unique<juce::DatagramSocket>(false);
+   if (port <= 0 || !socket->bindToPort(port, allowRemote ? juce::String() : juce::String("127.0.0.1")))
+      return false;
+
+   mSocket = std::move(socket);
+   startThread(8);
+   return true;
+}
+
+void NetAudioReceiver::Disconnect()
+{
+   signalThreadShouldExit();
+   if (mSocket != nullptr)
+      mSocket->shutdown();
+   stopThread(1000);
+   mSocket.reset();
+   //anything still queued is sorted out by the audio thread, which is the only one allowed to dequeue
+}
+
+bool NetAudioReceiver::Receive(NetAudioPacket& packet)
+{
+   return mQueue.try_dequeue(packet);
+}
+
+void NetAudioReceiver::run()
+{
+   while (!threadShouldExit())
+   {
+      int ready = mSocket->waitUntilReady(true, 100);
+      if (ready < 0)
+         break;
+      if (ready == 0)
+         continue;
+
+      int bytes = mSocket->read(mBytes.data(), (int)mBytes.size(), false);
+      if (bytes > 0 && mPacket.Read(mBytes.data(), bytes))
+      {
+         //if the audio thread has fallen this far behind, the packet would be too late anyway
+         if (mQueue.try_enqueue(mPacket))
+            ++mNumReceived;
+      }
+   }
+}
@@ -0,0 +1,128 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    NetAudioStream.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChannelBuffer.h"
+
+#include "juce_core/juce_core.h"
+#include "readerwriterqueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//netsend and netreceive stream audio, notes and pulses between bespoke instances over udp, so a heavy part of a patch can run on another machine.
+//the stream is cut into packets of a fixed number of frames, numbered in order, so the receiver can put them back in order,
+//notice the ones that got lost, and play them out a fixed latency behind the newest one
+struct NetAudioPacket
+{
+   static constexpr int kFrames = 128;
+   static constexpr int kMaxEvents = 16; //the rest carry over into the next packet, to keep each one under a typical mtu
+   static constexpr int kDefaultPort = 9300;
+   static constexpr int kMaxBytes = 24 + ChannelBuffer::kMaxNumChannels * kFrames * 4 + kMaxEvents * 15;
+
+   enum class EventType : std::uint8_t
+   {
+      Note,
+      Pulse
+   };
+
+   struct Event
+   {
+      EventType mType{ EventType::Note };
+      int mOffset{ 0 }; //frames into the packet
+      int mPitch{ 0 }; //pulse flags, for a pulse
+      float mVelocity{ 0 };
+      int mVoiceIdx{ -1 };
+   };
+
+   int Write(char* data) const; //returns how many bytes were written, at most kMaxBytes
+   bool Read(const char* data, int size); //false if it isn't one of ours
+
+   std::uint32_t mStreamId{ 0 }; //picked again whenever the sender starts over, so the receiver knows to resync
+   std::uint64_t mSequence{ 0 };
+   int mSampleRate{ 0 };
+   int mNumChannels{ 0 };
+   int mNumEvents{ 0 };
+   float mSamples[ChannelBuffer::kMaxNumChannels][kFrames]{};
+   Event mEvents[kMaxEvents];
+};
+
+//sends packets handed over from the audio thread on its own thread, so the audio thread never touches the socket
+class NetAudioSender : private juce::Thread
+{
+public:
+   NetAudioSender();
+   ~NetAudioSender();
+
+   void Connect(std::string host, int port); //main thread
+   void Disconnect();
+   bool IsConnected() const { return mSocket != nullptr; }
+   bool Send(const NetAudioPacket& packet); //audio thread, false if the queue is full
+
+   int GetNumSent() const { return mNumSent; }
+   int GetNumFailed() const { return mNumFailed; }
+
+private:
+   //juce::Thread
+   void run() override;
+
+   std::string mHost;
+   int mPort{ 0 };
+   std::unique_ptr<juce::DatagramSocket> mSocket;
+   moodycamel::BlockingReaderWriterQueue<NetAudioPacket> mQueue{ 64 };
+   std::vector<char> mBytes;
+   std::atomic<int> mNumSent{ 0 };
+   std::atomic<int> mNumFailed{ 0 };
+};
+
+//receives packets on its own thread, and hands them over to the audio thread to be ordered and played out
+class NetAudioReceiver : private juce::Thread
+{
+public:
+   NetAudioReceiver();
+   ~NetAudioReceiver();
+
+   bool Listen(int port, bool allowRemote); //main thread, false if the port couldn't be bound. only bound to localhost unless allowRemote
+   void Disconnect();
+   bool IsListening() const { return mSocket != nullptr; }
+   bool Receive(NetAudioPacket& packet); //audio thread
+
+   int GetNumReceived() const { return mNumReceived; }
+
+private:
+   //juce::Thread
+   void run() override;
+
+   std::unique_ptr<juce::DatagramSocket> mSocket;
+   moodycamel::ReaderWriterQueue<NetAudioPacket> mQueue{ 64 };
+   std::vector<char> mBytes;
+   NetAudioPacket mPacket;
+   std::atomic<int> mNumReceived{ 0 };
+};
@@ -45,10 +45,20 @@ void NoiseEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
+   BeginSampleKernel(time, bufferSize);
+   buffer->MultLinked(mRandoms.data(), bufferSize);
+}
 
+SampleKernel* NoiseEffect::BeginSampleKernel(double time, int bufferSize)
+{
    ComputeSliders(0);
 
+   //a fresh value for every sample it could be needed at, drawn a block at a time
+   if ((int)mRandoms.size() < bufferSize)
+      mRandoms.resize(bufferSize);
+   mRandomBlock.FillUniform(mRandoms.data(), bufferSize, 1 - mAmount, 1);
+
    for (int i = 0; i < bufferSize; ++i)
    {
       if (mSampleCounter < mWidth - 1)
@@ -57,13 +67,14 @@ void NoiseEffect::ProcessAudio(double time, ChannelBuffer* buffer)
       }
       else
       {
-         mRandom = ofRandom(mAmount) + (1 - mAmount);
+         mRandom = mRandoms[i];
          mSampleCounter = 0;
       }
-
-      for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-         buffer->GetChannel(ch)[i] *= mRandom;
+      mRandoms[i] = mRandom;
    }
+
+   mKernel.SetGains(mRandoms.data());
+   return &mKernel;
 }
 
 void NoiseEffect::DrawModule()
@@ -28,6 +28,10 @@
 #include "IAudioEffect.h"
 #include "Slider.h"
 #include "Checkbox.h"
+#include "RandomBlock.h"
+#include "SampleKernel.h"
+
+#include <vector>
 
 class NoiseEffect : public IAudioEffect, public IIntSliderListener, public IFloatSliderListener
 {
@@ -44,6 +48,7 @@ public:
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    float GetEffectAmount() override;
    std::string GetType() override { return "noisify"; }
+   SampleKernel* BeginSampleKernel(double time, int bufferSize) override;
 
 
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
@@ -67,6 +72,9 @@ private:
    int mWidth{ 10 };
    int mSampleCounter{ 0 };
    float mRandom{ 0 };
+   RandomBlock mRandomBlock;
+   std::vector<float> mRandoms; //drawn, and then held for mWidth samples at a time
+   GainKernel mKernel;
    FloatSlider* mAmountSlider{ nullptr };
    IntSlider* mWidthSlider{ nullptr };
 };
@@ -396,6 +396,7 @@ bool NoteCanvas::OnAbletonGridControl(IAbletonGridDevice* abletonGrid, int contr
                      length = 0.5f;
                }
                element->mLength = length;
+               mCanvas->InvalidateElementIndex();
             }
 
             if (midiValue > 0)
@@ -433,6 +434,7 @@ bool NoteCanvas::OnAbletonGridControl(IAbletonGridDevice* abletonGrid, int contr
                   pos = std::clamp(pos, 0.0f, float(mCanvas->GetNumCols() - 1));
                   element->mCol = int(pos);
                   element->mOffset = pos - int(pos);
+                  mCanvas->InvalidateElementIndex();
                }
             }
          }
@@ -1246,6 +1248,7 @@ void NoteCanvas::QuantizeNotes()
          element->mOffset = 0;
       }
    }
+   mCanvas->InvalidateElementIndex();
 }
 
 void NoteCanvas::LoadMidi()
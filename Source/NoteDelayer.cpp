@@ -87,8 +87,7 @@ void NoteDelayer::CheckboxUpdated(Checkbox* checkbox, double time)
    if (checkbox == mEnabledCheckbox)
    {
       mNoteOutput.Flush(time);
-      mAppendIndex = 0;
-      mConsumeIndex = 0;
+      mDelayedNotes.Clear();
    }
 }
 
@@ -98,18 +97,8 @@ void NoteDelayer::OnTransportAdvanced(float amount)
 
    ComputeSliders(0);
 
-   int end = mAppendIndex;
-   if (mAppendIndex < mConsumeIndex)
-      end += kQueueSize;
-   for (int i = mConsumeIndex; i < end; ++i)
-   {
-      const NoteMessage note = mInputNotes[i % kQueueSize];
-      if (NextBufferTime(true) >= note.time)
-      {
-         PlayNoteOutput(note);
-         mConsumeIndex = (mConsumeIndex + 1) % kQueueSize;
-      }
-   }
+   for (const NoteEvent& delayed : mDelayedNotes.TakeEventsDueBefore(NextBufferTime(true)))
+      PlayNoteOutput(delayed.mNote);
 }
 
 void NoteDelayer::PlayNote(NoteMessage note)
@@ -123,17 +112,13 @@ void NoteDelayer::PlayNote(NoteMessage note)
    if (note.velocity > 0)
       mLastNoteOnTime = note.time;
 
-   if ((mAppendIndex + 1) % kQueueSize != mConsumeIndex)
-   {
-      mInputNotes[mAppendIndex] = note;
-      float delayMs;
-      if (mDelayInMs)
-         delayMs = mDelayMs;
-      else
-         delayMs = mDelay / (float(TheTransport->GetTimeSigTop()) / TheTransport->GetTimeSigBottom()) * TheTransport->MsPerBar();
-      mInputNotes[mAppendIndex].time += delayMs;
-      mAppendIndex = (mAppendIndex + 1) % kQueueSize;
-   }
+   float delayMs;
+   if (mDelayInMs)
+      delayMs = mDelayMs;
+   else
+      delayMs = mDelay / (float(TheTransport->GetTimeSigTop()) / TheTransport->GetTimeSigBottom()) * TheTransport->MsPerBar();
+   note.time += delayMs;
+   mDelayedNotes.PushNote(note); //dropped if the queue is full
 }
 
 void NoteDelayer::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
@@ -26,6 +26,7 @@
 #pragma once
 
 #include "NoteEffectBase.h"
+#include "NoteEventLane.h"
 #include "IDrawableModule.h"
 #include "INoteSource.h"
 #include "Slider.h"
@@ -77,7 +78,5 @@ private:
    float mLastNoteOnTime{ 0 };
 
    static const int kQueueSize = 500;
-   NoteMessage mInputNotes[kQueueSize]{};
-   int mConsumeIndex{ 0 };
-   int mAppendIndex{ 0 };
+   NoteEventLane mDelayedNotes{ kQueueSize }; //time sorted, so notes come out in order when the delay changes while they're queued
 };
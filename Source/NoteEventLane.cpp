@@ -0,0 +1,125 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    NoteEventLane.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#include "NoteEventLane.h"
+#include "SynthGlobals.h"
+
+#include <algorithm>
+
+NoteEventLane::NoteEventLane(int capacity /*= kDefaultCapacity*/)
+: mCapacity(capacity)
+{
+   mPending.reserve(capacity);
+   mTaken.reserve(capacity);
+}
+
+bool NoteEventLane::PushNote(const NoteMessage& note)
+{
+   NoteEvent event;
+   event.mType = NoteEvent::Type::Note;
+   event.mTime = note.time;
+   event.mNote = note;
+   return Push(event);
+}
+
+bool NoteEventLane::PushCC(double time, int control, int value, int voiceIdx /*= -1*/)
+{
+   NoteEvent event;
+   event.mType = NoteEvent::Type::CC;
+   event.mTime = time;
+   event.mControl = control;
+   event.mValue = value;
+   event.mNote.voiceIdx = voiceIdx;
+   return Push(event);
+}
+
+bool NoteEventLane::PushPulse(double time, float velocity, int flags)
+{
+   NoteEvent event;
+   event.mType = NoteEvent::Type::Pulse;
+   event.mTime = time;
+   event.mPulseVelocity = velocity;
+   event.mPulseFlags = flags;
+   return Push(event);
+}
+
+bool NoteEventLane::Push(const NoteEvent& event)
+{
+   if ((int)mPending.size() >= mCapacity)
+      return false;
+
+   //events mostly arrive in order, so search from the back. events at the same time stay in the order they were pushed
+   auto it = mPending.end();
+   while (it != mPending.begin() && (it - 1)->mTime > event.mTime)
+      --it;
+   mPending.insert(it, event);
+   return true;
+}
+
+NoteEventLane::Span NoteEventLane::TakeEventsForBuffer(double bufferStartTime, int bufferSize)
+{
+   return TakeEventsDueBefore(bufferStartTime + bufferSize * gInvSampleRateMs, bufferStartTime, bufferSize);
+}
+
+NoteEventLane::Span NoteEventLane::TakeEventsDueBefore(double time)
+{
+   return TakeEventsDueBefore(time, 0, 0);
+}
+
+NoteEventLane::Span NoteEventLane::TakeEventsDueBefore(double time, double bufferStartTime, int bufferSize)
+{
+   mTaken.clear();
+   auto due = mPending.begin();
+   while (due != mPending.end() && due->mTime < time)
+   {
+      mTaken.push_back(*due);
+      if (bufferSize > 0)
+         mTaken.back().mSampleOffset = std::min(GetSampleOffset(due->mTime, bufferStartTime), bufferSize - 1);
+      ++due;
+   }
+   mPending.erase(mPending.begin(), due);
+
+   Span span;
+   span.mBegin = mTaken.data();
+   span.mEnd = mTaken.data() + mTaken.size();
+   return span;
+}
+
+void NoteEventLane::RemoveNotes(int pitch)
+{
+   mPending.erase(std::remove_if(mPending.begin(), mPending.end(), [pitch](const NoteEvent& event)
+                                 {
+                                    return event.mType == NoteEvent::Type::Note && event.mNote.pitch == pitch;
+                                 }),
+                  mPending.end());
+}
+
+//static
+int NoteEventLane::GetSampleOffset(double time, double bufferStartTime)
+{
+   return std::max(0, (int)((time - bufferStartTime) * gSampleRateMs));
+}
@@ -0,0 +1,100 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    NoteEventLane.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+#include "INoteReceiver.h"
+
+#include <vector>
+
+struct NoteEvent
+{
+   enum class Type
+   {
+      Note,
+      CC,
+      Pulse
+   };
+
+   Type mType{ Type::Note };
+   double mTime{ 0 };
+   int mSampleOffset{ 0 }; //into the buffer the event was taken for, filled in by NoteEventLane::TakeEventsForBuffer()
+   NoteMessage mNote; //for notes. CCs and pulses only use mNote.voiceIdx
+   int mControl{ 0 };
+   int mValue{ 0 };
+   float mPulseVelocity{ 0 };
+   int mPulseFlags{ 0 };
+};
+
+//a preallocated, time-sorted lane of events waiting for the buffer they land in.
+//each buffer, the events that are due are handed over as one sorted span with integer sample offsets,
+//so a receiver can walk through them alongside its audio instead of working out the offsets itself.
+class NoteEventLane
+{
+public:
+   explicit NoteEventLane(int capacity = kDefaultCapacity);
+
+   //return false if the lane is full, in which case the event is dropped
+   bool PushNote(const NoteMessage& note);
+   bool PushCC(double time, int control, int value, int voiceIdx = -1);
+   bool PushPulse(double time, float velocity, int flags);
+
+   struct Span
+   {
+      const NoteEvent* begin() const { return mBegin; }
+      const NoteEvent* end() const { return mEnd; }
+      int size() const { return int(mEnd - mBegin); }
+      bool empty() const { return mBegin == mEnd; }
+
+      const NoteEvent* mBegin{ nullptr };
+      const NoteEvent* mEnd{ nullptr };
+   };
+
+   //removes every event due before the end of the buffer that starts at bufferStartTime. late events get an offset of 0.
+   //the span stays valid until the next call
+   Span TakeEventsForBuffer(double bufferStartTime, int bufferSize);
+   //the same, for modules that just replay the events through a note output: everything due before time, with offsets of 0
+   Span TakeEventsDueBefore(double time);
+
+   void RemoveNotes(int pitch); //drops the pending notes of this pitch, to reschedule one
+
+   bool IsEmpty() const { return mPending.empty(); }
+   int GetNumPending() const { return (int)mPending.size(); }
+   void Clear() { mPending.clear(); }
+
+   static int GetSampleOffset(double time, double bufferStartTime);
+
+   static const int kDefaultCapacity = 256;
+
+private:
+   bool Push(const NoteEvent& event);
+   Span TakeEventsDueBefore(double time, double bufferStartTime, int bufferSize);
+
+   std::vector<NoteEvent> mPending;
+   std::vector<NoteEvent> mTaken;
+   int mCapacity{ kDefaultCapacity };
+};
@@ -49,6 +49,7 @@ public:
    void SetUpFromSaveData() override;
 
    bool IsEnabled() const override { return true; }
+   bool CanCacheRendering() const override { return true; }
 
 private:
    //IDrawableModule
@@ -55,6 +55,7 @@ public:
    virtual void SetUpFromSaveData() override;
 
    bool IsEnabled() const override { return mEnabled; }
+   bool CanCacheRendering() const override { return true; }
 
 private:
    struct NoteInfo
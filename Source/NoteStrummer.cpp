@@ -59,40 +59,48 @@ void NoteStrummer::DrawModule()
 
    mStrumSlider->Draw();
 
-   int numNotes = (int)mNotes.size();
-   int i = 0;
-   for (auto& pitch : mNotes)
+   int numNotes = mNumNotes;
+   for (int i = 0; i < numNotes; ++i)
    {
       float pos = float(i + .5f) / numNotes;
-      DrawTextNormal(NoteName(pitch), mStrumSlider->GetPosition(true).x + pos * mStrumSlider->IClickable::GetDimensions().x, mStrumSlider->GetPosition(true).y + mStrumSlider->IClickable::GetDimensions().y + 12);
-      ++i;
+      DrawTextNormal(NoteName(mNotes[i]), mStrumSlider->GetPosition(true).x + pos * mStrumSlider->IClickable::GetDimensions().x, mStrumSlider->GetPosition(true).y + mStrumSlider->IClickable::GetDimensions().y + 12);
    }
 }
 
 void NoteStrummer::PlayNote(NoteMessage note)
 {
+   if (note.pitch < 0 || note.pitch >= 128)
+      return;
+
    if (note.velocity > 0)
    {
-      mNotes.push_back(note.pitch);
+      if (mNumNotes < (int)mNotes.size())
+         mNotes[mNumNotes++] = note.pitch;
    }
    else
    {
       PlayNoteOutput(note.MakeNoteOff());
-      mNotes.remove(note.pitch);
+      int kept = 0;
+      for (int i = 0; i < mNumNotes; ++i)
+      {
+         if (mNotes[i] != note.pitch)
+            mNotes[kept++] = mNotes[i];
+      }
+      mNumNotes = kept;
    }
 }
 
 void NoteStrummer::OnTransportAdvanced(float amount)
 {
-   int numNotes = (int)mNotes.size();
+   int numNotes = mNumNotes;
 
    for (int i = 0; i < gBufferSize; ++i)
    {
       ComputeSliders(i);
 
-      int index = 0;
-      for (auto& pitch : mNotes)
+      for (int index = 0; index < numNotes; ++index)
       {
+         int pitch = mNotes[index];
          float pos = float(index + .5f) / numNotes;
          float change = mStrum - mLastStrumPos;
          float offset = pos - mLastStrumPos;
@@ -101,7 +109,6 @@ void NoteStrummer::OnTransportAdvanced(float amount)
              fabsf(offset) <= fabsf(change) &&
              !wraparound)
             PlayNoteOutput(NoteMessage(gTime + i * gInvSampleRateMs, pitch, 127));
-         ++index;
       }
       mLastStrumPos = mStrum;
    }
@@ -70,5 +70,6 @@ private:
    float mStrum{ 0 };
    float mLastStrumPos{ 0 };
    FloatSlider* mStrumSlider{ nullptr };
-   std::list<int> mNotes;
+   std::array<int, 128> mNotes{}; //held pitches, in the order they were played
+   int mNumNotes{ 0 };
 };
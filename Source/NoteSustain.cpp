@@ -59,18 +59,8 @@ void NoteSustain::DrawModule()
 
 void NoteSustain::OnTransportAdvanced(float amount)
 {
-   for (auto iter = mNoteOffs.begin(); iter != mNoteOffs.end();)
-   {
-      if (iter->time < NextBufferTime(false))
-      {
-         PlayNoteOutput(*iter);
-         iter = mNoteOffs.erase(iter);
-      }
-      else
-      {
-         ++iter;
-      }
-   }
+   for (const NoteEvent& noteOff : mNoteOffs.TakeEventsDueBefore(NextBufferTime(false)))
+      PlayNoteOutput(noteOff.mNote);
 }
 
 void NoteSustain::PlayNote(NoteMessage note)
@@ -89,24 +79,11 @@ void NoteSustain::PlayNote(NoteMessage note)
 
       float durationMs = mSustain / (float(TheTransport->GetTimeSigTop()) / TheTransport->GetTimeSigBottom()) * TheTransport->MsPerBar();
 
-      bool found = false;
-      for (auto& queued : mNoteOffs)
-      {
-         if (queued.pitch == note.pitch)
-         {
-            queued.time = note.time + durationMs;
-            queued.voiceIdx = note.voiceIdx;
-            found = true;
-            break;
-         }
-      }
-
-      if (!found)
-      {
-         NoteMessage noteOff = note.MakeNoteOff();
-         noteOff.time = note.time + durationMs;
-         mNoteOffs.push_back(noteOff);
-      }
+      //a retrigger pushes the pending note off back
+      mNoteOffs.RemoveNotes(note.pitch);
+      NoteMessage noteOff = note.MakeNoteOff();
+      noteOff.time = note.time + durationMs;
+      mNoteOffs.PushNote(noteOff);
    }
 }
 
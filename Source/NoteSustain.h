@@ -27,6 +27,7 @@
 
 #include "IDrawableModule.h"
 #include "NoteEffectBase.h"
+#include "NoteEventLane.h"
 #include "Slider.h"
 #include "Transport.h"
 
@@ -72,5 +73,5 @@ private:
 
    float mSustain{ .25 };
    FloatSlider* mSustainSlider{ nullptr };
-   std::list<NoteMessage> mNoteOffs;
+   NoteEventLane mNoteOffs{ 128 }; //at most one per pitch
 };
@@ -29,8 +29,10 @@
 #include "SynthGlobals.h"
 #include "ModularSynth.h"
 #include "UIControlMacros.h"
+#include "UserPrefs.h"
 
 OSCOutput::OSCOutput()
+: mOscOut(1000.0 / MAX(1, UserPrefs.target_framerate.Get())) //values coalesce down to one per address per frame
 {
    for (int i = 0; i < OSC_OUTPUT_MAX_PARAMS; ++i)
    {
@@ -47,7 +49,7 @@ void OSCOutput::Init()
 {
    IDrawableModule::Init();
 
-   mOscOut.connect(mOscOutAddress, mOscOutPort);
+   mOscOut.Connect(mOscOutAddress, mOscOutPort);
 }
 
 void OSCOutput::CreateUIControls()
@@ -112,7 +114,7 @@ void OSCOutput::PlayNote(NoteMessage note)
          pitchOut += note.modulation.pitchBend->GetValue(0);
       msg.addFloat32(pitchOut);
       msg.addFloat32(note.velocity);
-      mOscOut.send(msg);
+      mOscOut.Send(msg, !K(coalesce));
    }
 }
 
@@ -120,21 +122,21 @@ void OSCOutput::SendFloat(std::string address, float val)
 {
    juce::OSCMessage msg(address.c_str());
    msg.addFloat32(val);
-   mOscOut.send(msg);
+   mOscOut.Send(msg, K(coalesce));
 }
 
 void OSCOutput::SendInt(std::string address, int val)
 {
    juce::OSCMessage msg(address.c_str());
    msg.addInt32(val);
-   mOscOut.send(msg);
+   mOscOut.Send(msg, K(coalesce));
 }
 
 void OSCOutput::SendString(std::string address, std::string val)
 {
    juce::OSCMessage msg(address.c_str());
    msg.addString(val);
-   mOscOut.send(msg);
+   mOscOut.Send(msg, K(coalesce));
 }
 
 void OSCOutput::Resize(float width, float height)
@@ -159,7 +161,7 @@ void OSCOutput::FloatSliderUpdated(FloatSlider* slider, float oldVal, double tim
    address += slider->Name();
    juce::OSCMessage msg(address);
    msg.addFloat32(slider->GetValue());
-   mOscOut.send(msg);
+   mOscOut.Send(msg, K(coalesce));
 }
 
 void OSCOutput::TextEntryComplete(TextEntry* entry)
@@ -178,14 +180,15 @@ void OSCOutput::TextEntryComplete(TextEntry* entry)
 
    if (entry == mOscOutAddressEntry || entry == mOscOutPortEntry)
    {
-      mOscOut.disconnect();
-      mOscOut.connect(mOscOutAddress, mOscOutPort);
+      mOscOut.Connect(mOscOutAddress, mOscOutPort);
    }
 }
 
 void OSCOutput::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("address_prefix", moduleInfo, mAddressPrefix);
+   mModuleSaveData.LoadFloat("rate_limit_ms", moduleInfo, 0, 0, 1000, K(isTextField));
+   mModuleSaveData.LoadBool("send_bundles", moduleInfo, true);
 
    SetUpFromSaveData();
 }
@@ -193,6 +196,8 @@ void OSCOutput::LoadLayout(const ofxJSONElement& moduleInfo)
 void OSCOutput::SetUpFromSaveData()
 {
    mAddressPrefix = mModuleSaveData.GetString("address_prefix");
+   mOscOut.SetRateLimitMs(mModuleSaveData.GetFloat("rate_limit_ms"));
+   mOscOut.SetUseBundles(mModuleSaveData.GetBool("send_bundles"));
 }
 
 void OSCOutput::SaveLayout(ofxJSONElement& moduleInfo)
@@ -32,8 +32,7 @@
 #include "TextEntry.h"
 #include "Slider.h"
 #include "INoteReceiver.h"
-
-#include "juce_osc/juce_osc.h"
+#include "OSCSendQueue.h"
 
 #define OSC_OUTPUT_MAX_PARAMS 50
 
@@ -88,7 +87,7 @@ private:
    std::string mNoteOutLabel{ "note" };
    TextEntry* mNoteOutLabelEntry{ nullptr };
 
-   juce::OSCSender mOscOut;
+   OSCSendQueue mOscOut;
 
    std::string mAddressPrefix{ "/bespoke" };
 };
@@ -0,0 +1,141 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    OSCSendQueue.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "OSCSendQueue.h"
+#include "SynthGlobals.h"
+
+namespace
+{
+   //keeps a bundle well inside a single udp packet
+   const int kMaxMessagesPerBundle = 32;
+}
+
+OSCSendQueue::OSCSendQueue(double sendIntervalMs)
+: juce::Thread("osc send")
+, mSendIntervalMs(sendIntervalMs)
+{
+   mOutgoing.reserve(kMaxMessagesPerBundle);
+   startThread();
+}
+
+OSCSendQueue::~OSCSendQueue()
+{
+   stopThread(1000);
+}
+
+void OSCSendQueue::Connect(const std::string& host, int port)
+{
+   std::lock_guard<std::mutex> lock(mSenderMutex);
+   mSender.disconnect();
+   mConnected = mSender.connect(host, port);
+}
+
+void OSCSendQueue::Send(juce::OSCMessage message, bool coalesce)
+{
+   PendingMessage pending;
+   pending.mMessage = std::move(message);
+   pending.mCoalesce = coalesce;
+
+   if (IsAudioThread())
+   {
+      mAudioThreadQueue.try_enqueue(std::move(pending)); //dropped rather than allocating if the sender has fallen that far behind
+   }
+   else
+   {
+      std::lock_guard<std::mutex> lock(mProducerMutex);
+      mQueue.enqueue(std::move(pending));
+   }
+}
+
+void OSCSendQueue::run()
+{
+   while (!threadShouldExit())
+   {
+      SendTick();
+      wait((int)mSendIntervalMs);
+   }
+}
+
+void OSCSendQueue::Drain(moodycamel::ReaderWriterQueue<PendingMessage>& queue)
+{
+   PendingMessage pending;
+   while (queue.try_dequeue(pending))
+   {
+      if (pending.mCoalesce)
+      {
+         auto& state = mAddresses[pending.mMessage.getAddressPattern().toString()];
+         state.mLatest = std::move(pending.mMessage);
+         state.mPending = true;
+      }
+      else
+      {
+         mOutgoing.push_back(std::move(pending.mMessage));
+      }
+   }
+}
+
+void OSCSendQueue::SendTick()
+{
+   Drain(mAudioThreadQueue);
+   Drain(mQueue);
+
+   double now = juce::Time::getMillisecondCounterHiRes();
+   double rateLimitMs = mRateLimitMs;
+   for (auto& pair : mAddresses)
+   {
+      auto& state = pair.second;
+      if (state.mPending && now - state.mLastSentMs >= rateLimitMs)
+      {
+         mOutgoing.push_back(state.mLatest);
+         state.mPending = false;
+         state.mLastSentMs = now;
+      }
+   }
+
+   if (mOutgoing.empty())
+      return;
+
+   std::lock_guard<std::mutex> lock(mSenderMutex);
+   if (mConnected)
+   {
+      if (mUseBundles && mOutgoing.size() > 1)
+      {
+         for (size_t start = 0; start < mOutgoing.size(); start += kMaxMessagesPerBundle)
+         {
+            juce::OSCBundle bundle;
+            for (size_t i = start; i < mOutgoing.size() && i < start + kMaxMessagesPerBundle; ++i)
+               bundle.addElement(mOutgoing[i]);
+            mSender.send(bundle);
+         }
+      }
+      else
+      {
+         for (const auto& message : mOutgoing)
+            mSender.send(message);
+      }
+   }
+   mOutgoing.clear();
+}
@@ -0,0 +1,89 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    OSCSendQueue.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "readerwriterqueue.h"
+
+#include "juce_osc/juce_osc.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+//sends osc from a background thread instead of from whichever thread produced the message. values are coalesced,
+//so only the latest one to each address goes out per tick, and everything due in a tick goes out as one bundle
+class OSCSendQueue : private juce::Thread
+{
+public:
+   explicit OSCSendQueue(double sendIntervalMs);
+   ~OSCSendQueue() override;
+
+   void Connect(const std::string& host, int port);
+
+   //from any thread. a message that coalesces replaces any earlier one to the same address that hasn't gone out yet,
+   //one that doesn't (like a note) always goes out, in order
+   void Send(juce::OSCMessage message, bool coalesce);
+
+   //at most one message per this many ms to each coalesced address, 0 for no limit. the latest value always goes out eventually
+   void SetRateLimitMs(double ms) { mRateLimitMs = ms; }
+   void SetUseBundles(bool use) { mUseBundles = use; }
+
+private:
+   struct PendingMessage
+   {
+      juce::OSCMessage mMessage{ "/" };
+      bool mCoalesce{ false };
+   };
+
+   struct AddressState
+   {
+      juce::OSCMessage mLatest{ "/" };
+      bool mPending{ false };
+      double mLastSentMs{ -1e9 };
+   };
+
+   void run() override;
+   void Drain(moodycamel::ReaderWriterQueue<PendingMessage>& queue);
+   void SendTick();
+
+   moodycamel::ReaderWriterQueue<PendingMessage> mAudioThreadQueue{ 1024 };
+   moodycamel::ReaderWriterQueue<PendingMessage> mQueue{ 1024 };
+   std::mutex mProducerMutex; //between the threads other than the audio thread that feed mQueue
+
+   std::mutex mSenderMutex;
+   juce::OSCSender mSender;
+   bool mConnected{ false };
+
+   double mSendIntervalMs;
+   std::atomic<double> mRateLimitMs{ 0 };
+   std::atomic<bool> mUseBundles{ true };
+
+   //sender thread only
+   std::vector<juce::OSCMessage> mOutgoing;
+   std::map<juce::String, AddressState> mAddresses;
+};
@@ -0,0 +1,250 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    OnsetIndex.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "OnsetIndex.h"
+#include "FFT.h"
+#include "SampleLoader.h"
+#include "SynthGlobals.h"
+
+#include "juce_audio_formats/juce_audio_formats.h"
+
+#include <algorithm>
+
+namespace
+{
+   const int kFrameSize = 1024;
+   const int kHopSize = 256;
+   const int kChunkSize = 1 << 16; //how much of the source the job mixes down at a time
+   const float kThresholdRatio = 1.5f; //how far above the surrounding flux a peak needs to be
+   const float kFloorRatio = .3f; //and above the average flux, so noise in quiet passages doesn't count
+   const float kPeakWindowSeconds = .02f;
+   const float kMeanWindowSeconds = .05f;
+   const float kMinGapSeconds = .04f;
+}
+
+class OnsetAnalysisJob : public juce::ThreadPoolJob
+{
+public:
+   OnsetAnalysisJob(std::weak_ptr<OnsetIndex> index, int numSamples, int sampleRate)
+   : juce::ThreadPoolJob("onset analysis")
+   , mIndex(std::move(index))
+   , mNumSamples(numSamples)
+   , mSampleRate(sampleRate)
+   {
+   }
+
+   std::shared_ptr<const SampleCache::Data> mData;
+   std::vector<float> mMono;
+   std::unique_ptr<juce::AudioFormatReader> mReader;
+
+   JobStatus runJob() override
+   {
+      OnsetIndex::Detector detector(mSampleRate);
+      std::vector<float> mixed;
+      juce::AudioSampleBuffer readBuffer;
+      for (int pos = 0; pos < mNumSamples; pos += kChunkSize)
+      {
+         if (shouldExit() || mIndex.expired())
+            return jobHasFinished;
+
+         int length = MIN(kChunkSize, mNumSamples - pos);
+         if (!mMono.empty())
+         {
+            detector.Process(mMono.data() + pos, length);
+            continue;
+         }
+
+         mixed.resize(length);
+         if (mData != nullptr)
+         {
+            BufferCopy(mixed.data(), mData->GetChannel(0) + pos, length);
+            for (int ch = 1; ch < mData->NumChannels(); ++ch)
+               Add(mixed.data(), mData->GetChannel(ch) + pos, length);
+            Mult(mixed.data(), 1.0f / mData->NumChannels(), length);
+         }
+         else
+         {
+            readBuffer.setSize(mReader->numChannels, length, false, false, true);
+            mReader->read(&readBuffer, 0, length, pos, true, true);
+            BufferCopy(mixed.data(), readBuffer.getReadPointer(0), length);
+            for (int ch = 1; ch < readBuffer.getNumChannels(); ++ch)
+               Add(mixed.data(), readBuffer.getReadPointer(ch), length);
+            Mult(mixed.data(), 1.0f / readBuffer.getNumChannels(), length);
+         }
+         detector.Process(mixed.data(), length);
+      }
+
+      std::shared_ptr<OnsetIndex> index = mIndex.lock();
+      if (index != nullptr)
+      {
+         index->mOnsets = detector.Finish();
+         index->mReady = true;
+      }
+      return jobHasFinished;
+   }
+
+private:
+   std::weak_ptr<OnsetIndex> mIndex;
+   int mNumSamples;
+   int mSampleRate;
+};
+
+int OnsetIndex::GetSliceStart(int position) const
+{
+   if (!mReady)
+      return 0;
+   auto it = std::upper_bound(mOnsets.begin(), mOnsets.end(), position);
+   return it == mOnsets.begin() ? 0 : *(it - 1);
+}
+
+int OnsetIndex::GetNextOnset(int position) const
+{
+   if (!mReady)
+      return -1;
+   auto it = std::upper_bound(mOnsets.begin(), mOnsets.end(), position);
+   return it == mOnsets.end() ? -1 : *it;
+}
+
+std::shared_ptr<OnsetIndex> OnsetIndex::Analyze(std::shared_ptr<const SampleCache::Data> data)
+{
+   auto index = std::make_shared<OnsetIndex>();
+   auto* job = new OnsetAnalysisJob(index, data->NumSamples(), data->SampleRate());
+   job->mData = std::move(data);
+   SampleLoader::Get().AddJob(job);
+   return index;
+}
+
+std::shared_ptr<OnsetIndex> OnsetIndex::Analyze(std::vector<float> mono, int sampleRate)
+{
+   auto index = std::make_shared<OnsetIndex>();
+   auto* job = new OnsetAnalysisJob(index, (int)mono.size(), sampleRate);
+   job->mMono = std::move(mono);
+   SampleLoader::Get().AddJob(job);
+   return index;
+}
+
+std::shared_ptr<OnsetIndex> OnsetIndex::Analyze(std::unique_ptr<juce::AudioFormatReader> reader)
+{
+   auto index = std::make_shared<OnsetIndex>();
+   auto* job = new OnsetAnalysisJob(index, (int)reader->lengthInSamples, (int)reader->sampleRate);
+   job->mReader = std::move(reader);
+   SampleLoader::Get().AddJob(job);
+   return index;
+}
+
+OnsetIndex::Detector::Detector(int sampleRate)
+: mSampleRate(sampleRate)
+, mFrame(kFrameSize)
+, mWindowed(kFrameSize)
+, mRe(kFrameSize / 2 + 1)
+, mIm(kFrameSize / 2 + 1)
+, mScratch(FFTPlan::Get(kFrameSize).GetScratchSize())
+, mLastMagnitudes(kFrameSize / 2 + 1)
+{
+   //start half a frame early, so the first frame is centered on the first sample and a hit right at the start is found
+   mFramePos = kFrameSize / 2;
+}
+
+void OnsetIndex::Detector::Process(const float* mono, int numSamples)
+{
+   while (numSamples > 0)
+   {
+      int length = MIN(numSamples, kFrameSize - mFramePos);
+      BufferCopy(mFrame.data() + mFramePos, mono, length);
+      mFramePos += length;
+      mono += length;
+      numSamples -= length;
+
+      if (mFramePos == kFrameSize)
+      {
+         ProcessFrame();
+         std::copy(mFrame.begin() + kHopSize, mFrame.end(), mFrame.begin());
+         mFramePos -= kHopSize;
+      }
+   }
+}
+
+void OnsetIndex::Detector::ProcessFrame()
+{
+   const FFTPlan& plan = FFTPlan::Get(kFrameSize);
+   const float* window = plan.GetHannWindow();
+   for (int i = 0; i < kFrameSize; ++i)
+      mWindowed[i] = mFrame[i] * window[i];
+   plan.Forward(mWindowed.data(), mRe.data(), mIm.data(), mScratch.data());
+
+   //log compressed magnitudes, so that the flux follows how loud a change sounds rather than being dominated by the bass
+   float flux = 0;
+   for (int k = 1; k <= kFrameSize / 2; ++k)
+   {
+      float magnitude = log1pf(100 * sqrtf(mRe[k] * mRe[k] + mIm[k] * mIm[k]) / kFrameSize);
+      flux += MAX(0, magnitude - mLastMagnitudes[k]);
+      mLastMagnitudes[k] = magnitude;
+   }
+   mFlux.push_back(flux);
+}
+
+std::vector<int> OnsetIndex::Detector::Finish()
+{
+   //flush the tail, so the last frame is centered on the last sample
+   std::vector<float> silence(kFrameSize / 2);
+   Process(silence.data(), (int)silence.size());
+
+   std::vector<int> onsets;
+   int numFrames = (int)mFlux.size();
+   if (numFrames == 0)
+      return onsets;
+
+   std::vector<double> sums(numFrames + 1);
+   for (int i = 0; i < numFrames; ++i)
+      sums[i + 1] = sums[i] + mFlux[i];
+   float mean = float(sums[numFrames] / numFrames);
+
+   int peakFrames = MAX(1, int(kPeakWindowSeconds * mSampleRate / kHopSize));
+   int meanFrames = MAX(1, int(kMeanWindowSeconds * mSampleRate / kHopSize));
+   int minGap = int(kMinGapSeconds * mSampleRate);
+   for (int i = 0; i < numFrames; ++i)
+   {
+      //a local maximum, taking the first frame of a plateau
+      bool isPeak = true;
+      for (int j = MAX(0, i - peakFrames); j <= MIN(numFrames - 1, i + peakFrames) && isPeak; ++j)
+         isPeak = j < i ? mFlux[j] < mFlux[i] : mFlux[j] <= mFlux[i];
+      if (!isPeak)
+         continue;
+
+      int start = MAX(0, i - meanFrames);
+      int end = MIN(numFrames, i + meanFrames + 1);
+      float localMean = float((sums[end] - sums[start]) / (end - start));
+      if (mFlux[i] <= localMean * kThresholdRatio || mFlux[i] <= mean * kFloorRatio)
+         continue;
+
+      //frame i is centered on i * kHopSize. the change arrived within the hop before that
+      int position = MAX(0, i * kHopSize - kHopSize / 2);
+      if (!onsets.empty() && position - onsets.back() < minGap)
+         continue;
+      onsets.push_back(position);
+   }
+   return onsets;
+}
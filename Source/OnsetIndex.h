@@ -0,0 +1,84 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    OnsetIndex.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SampleCache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace juce
+{
+   class AudioFormatReader;
+}
+
+//where the transients in a sample are, found from the spectral flux of its mono mix on SampleLoader's threads.
+//the index for decoded file data lives with that data in SampleCache, so every Sample reading the same file shares one analysis,
+//and slicing modules can jump to or chop at transients immediately without reanalyzing. see Sample::GetOnsets()
+class OnsetIndex
+{
+public:
+   bool IsReady() const { return mReady; }
+   const std::vector<int>& GetOnsets() const { return mOnsets; } //ascending sample positions, at the sample's own rate. empty until IsReady()
+   int GetSliceStart(int position) const; //the last onset at or before position, or 0
+   int GetNextOnset(int position) const; //the first onset after position, or -1
+
+   //start analyzing in the background, the returned index fills in when it's done.
+   //the job stops early if nothing holds on to the index any more
+   static std::shared_ptr<OnsetIndex> Analyze(std::shared_ptr<const SampleCache::Data> data);
+   static std::shared_ptr<OnsetIndex> Analyze(std::vector<float> mono, int sampleRate);
+   static std::shared_ptr<OnsetIndex> Analyze(std::unique_ptr<juce::AudioFormatReader> reader); //for streamed files, read from disk in chunks
+
+   //spectral flux onset detection, fed the mono mix a block at a time
+   class Detector
+   {
+   public:
+      explicit Detector(int sampleRate);
+      void Process(const float* mono, int numSamples);
+      std::vector<int> Finish();
+
+   private:
+      void ProcessFrame();
+
+      int mSampleRate;
+      std::vector<float> mFrame;
+      int mFramePos{ 0 };
+      std::vector<float> mWindowed;
+      std::vector<float> mRe;
+      std::vector<float> mIm;
+      std::vector<float> mScratch;
+      std::vector<float> mLastMagnitudes;
+      std::vector<float> mFlux; //one per hop
+   };
+
+private:
+   friend class OnsetAnalysisJob;
+   std::vector<int> mOnsets;
+   std::atomic<bool> mReady{ false };
+};
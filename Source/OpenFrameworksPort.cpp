@@ -40,6 +40,7 @@ using namespace juce;
 #define NANOVG_GLES2_IMPLEMENTATION
 #include "nanovg/nanovg_gl.h"
 #include "ModularSynth.h"
+#include "TextLayoutCache.h"
 #include "Push2Control.h"
 #include "UserData.h"
 
@@ -59,6 +60,7 @@ ofColor ofColor::clear(0, 0, 0, 0);
 
 NVGcontext* gNanoVG = nullptr;
 NVGcontext* gFontBoundsNanoVG = nullptr;
+static std::mutex sFontBoundsMutex; //gFontBoundsNanoVG's font state, for measuring text off the gl thread
 
 std::string ofToSamplePath(const std::string& path)
 {
@@ -782,19 +784,29 @@ ofColor ofColor::operator+(const ofColor& other)
    return ofColor(r + other.r, g + other.g, b + other.b, a + other.a);
 }
 
+void RetinaTrueTypeFont::ReadFontFile(std::string path)
+{
+   mFontDataPath = ofToDataPath(path);
+   mFontData.clear();
+   MemoryBlock data;
+   if (File(mFontDataPath.c_str()).loadFileAsData(data))
+      mFontData.assign((const unsigned char*)data.getData(), (const unsigned char*)data.getData() + data.getSize());
+}
+
 void RetinaTrueTypeFont::LoadFont(std::string path)
 {
    mFontPath = ofToDataPath(path);
-   File file(mFontPath.c_str());
-   if (file.existsAsFile())
-   {
-      mFontHandle = nvgCreateFont(gNanoVG, path.c_str(), path.c_str());
-      mFontBoundsHandle = nvgCreateFont(gFontBoundsNanoVG, path.c_str(), path.c_str());
-      mLoaded = true;
-   }
-   else
+   if (mFontDataPath != mFontPath || mFontData.empty())
+      ReadFontFile(path);
+
+   mLoaded = false;
+   if (!mFontData.empty())
    {
-      mLoaded = false;
+      //the file is only read once, nanovg doesn't take ownership of the data
+      mFontHandle = nvgCreateFontMem(gNanoVG, mFontPath.c_str(), mFontData.data(), (int)mFontData.size(), 0);
+      mFontBoundsHandle = nvgCreateFontMem(gFontBoundsNanoVG, mFontPath.c_str(), mFontData.data(), (int)mFontData.size(), 0);
+      mLoaded = mFontHandle != -1 && mFontBoundsHandle != -1;
+      TextLayoutCache::Get().Clear();
    }
 }
 
@@ -814,9 +826,8 @@ void RetinaTrueTypeFont::DrawString(std::string str, float size, float x, float
    else
    {
       std::vector<std::string> lines = ofSplitString(str, "\n");
-      float bounds[4];
-      nvgTextBounds(gNanoVG, 0, 0, str.c_str(), nullptr, bounds);
-      float lineHeight = bounds[3] - bounds[1];
+      float width, lineHeight;
+      TextLayoutCache::Get().Measure(gNanoVG, mFontHandle, size, str, width, lineHeight);
       for (int i = 0; i < lines.size(); ++i)
       {
          nvgText(gNanoVG, x, y, lines[i].c_str(), nullptr);
@@ -848,6 +859,7 @@ float RetinaTrueTypeFont::GetStringWidth(std::string str, float size)
 
    NVGcontext* vg;
    int handle;
+   std::unique_lock<std::mutex> lock(sFontBoundsMutex, std::defer_lock);
    if (TheSynth->GetOpenGLContext()->getCurrentContext() != nullptr)
    {
       vg = gNanoVG;
@@ -857,12 +869,13 @@ float RetinaTrueTypeFont::GetStringWidth(std::string str, float size)
    {
       vg = gFontBoundsNanoVG;
       handle = mFontBoundsHandle;
+      lock.lock(); //modules being built in parallel measure their labels at the same time
    }
 
    nvgFontFaceId(vg, handle);
    nvgFontSize(vg, size);
-   float bounds[4];
-   float width = nvgTextBounds(vg, 0, 0, str.c_str(), nullptr, bounds);
+   float width, height;
+   TextLayoutCache::Get().Measure(vg, handle, size, str, width, height);
 
    return width;
 }
@@ -874,6 +887,7 @@ float RetinaTrueTypeFont::GetStringHeight(std::string str, float size)
 
    NVGcontext* vg;
    int handle;
+   std::unique_lock<std::mutex> lock(sFontBoundsMutex, std::defer_lock);
    if (TheSynth->GetOpenGLContext()->getCurrentContext() != nullptr)
    {
       vg = gNanoVG;
@@ -883,13 +897,13 @@ float RetinaTrueTypeFont::GetStringHeight(std::string str, float size)
    {
       vg = gFontBoundsNanoVG;
       handle = mFontBoundsHandle;
+      lock.lock(); //modules being built in parallel measure their labels at the same time
    }
 
    nvgFontFaceId(vg, handle);
    nvgFontSize(vg, size);
-   float bounds[4];
-   nvgTextBounds(vg, 0, 0, str.c_str(), nullptr, bounds);
+   float width, lineHeight;
+   TextLayoutCache::Get().Measure(vg, handle, size, str, width, lineHeight);
 
-   float lineHeight = bounds[3] - bounds[1];
    return lineHeight;
 }
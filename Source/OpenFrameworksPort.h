@@ -221,6 +221,7 @@ class RetinaTrueTypeFont
 {
 public:
    RetinaTrueTypeFont() {}
+   void ReadFontFile(std::string path); //safe to call from any thread, so the file can be read ahead of LoadFont()
    void LoadFont(std::string path);
    void DrawString(std::string str, float size, float x, float y);
    ofRectangle DrawStringWrap(std::string str, float size, float x, float y, float width);
@@ -235,6 +236,8 @@ private:
    int mFontBoundsHandle{};
    bool mLoaded{ false };
    std::string mFontPath;
+   std::vector<unsigned char> mFontData; //both nanovg contexts use this, so it's kept for as long as the font is
+   std::string mFontDataPath;
 };
 
 typedef ofVec2f ofPoint;
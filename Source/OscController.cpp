@@ -28,53 +28,374 @@
 #include "IPulseReceiver.h"
 #include "TitleBar.h"
 
+namespace
+{
+   const int kMaxPacketSize = 65536;
+   const int kMaxBundleDepth = 8;
+
+   int32_t ReadInt32(const char* data)
+   {
+      return juce::ByteOrder::bigEndianInt(data);
+   }
+
+   int64_t ReadInt64(const char* data)
+   {
+      return juce::ByteOrder::bigEndianInt64(data);
+   }
+
+   //osc strings are null terminated and padded out to four bytes. returns the size with the padding, or -1 if it runs off the end
+   int ReadString(const char* data, int size, std::string_view& string)
+   {
+      const char* end = (const char*)memchr(data, 0, size);
+      if (end == nullptr)
+         return -1;
+      string = std::string_view(data, end - data);
+      int padded = ((int)string.size() + 4) & ~3;
+      return padded <= size ? padded : -1;
+   }
+
+   bool ParseMessage(const char* data, int size, OscParsedMessage& message)
+   {
+      int addressSize = ReadString(data, size, message.mAddress);
+      if (addressSize < 0 || message.mAddress.empty() || message.mAddress[0] != '/')
+         return false;
+      data += addressSize;
+      size -= addressSize;
+
+      message.mNumArguments = 0;
+      if (size == 0)
+         return true; //no type tags, no arguments
+
+      std::string_view types;
+      int typesSize = ReadString(data, size, types);
+      if (typesSize < 0 || types.empty() || types[0] != ',')
+         return false;
+      data += typesSize;
+      size -= typesSize;
+
+      for (size_t i = 1; i < types.size() && message.mNumArguments < OscParsedMessage::kMaxArguments; ++i)
+      {
+         auto& argument = message.mArguments[message.mNumArguments];
+         argument.mType = 0;
+         int argumentSize = 0;
+         switch (types[i])
+         {
+            case 'i':
+               argumentSize = 4;
+               if (size >= 4)
+               {
+                  argument.mType = 'i';
+                  argument.mInt = ReadInt32(data);
+               }
+               break;
+            case 'f':
+               argumentSize = 4;
+               if (size >= 4)
+               {
+                  argument.mType = 'f';
+                  int32_t bits = ReadInt32(data);
+                  memcpy(&argument.mFloat, &bits, sizeof(float));
+               }
+               break;
+            case 'd':
+               argumentSize = 8;
+               if (size >= 8)
+               {
+                  argument.mType = 'f';
+                  int64_t bits = ReadInt64(data);
+                  double value;
+                  memcpy(&value, &bits, sizeof(double));
+                  argument.mFloat = (float)value;
+               }
+               break;
+            case 'h':
+               argumentSize = 8;
+               if (size >= 8)
+               {
+                  argument.mType = 'i';
+                  argument.mInt = (int)ReadInt64(data);
+               }
+               break;
+            case 'T':
+            case 'F':
+               argument.mType = 'i';
+               argument.mInt = types[i] == 'T' ? 1 : 0;
+               break;
+            case 's':
+            case 'S':
+               argumentSize = ReadString(data, size, argument.mString);
+               if (argumentSize < 0)
+                  return false;
+               argument.mType = 's';
+               break;
+            case 'b':
+               if (size < 4)
+                  return false;
+               argumentSize = 4 + ((ReadInt32(data) + 3) & ~3);
+               break;
+            case 't':
+               argumentSize = 8;
+               break;
+            case 'c':
+            case 'r':
+            case 'm':
+               argumentSize = 4;
+               break;
+            default: //N, I, arrays
+               break;
+         }
+
+         if (argumentSize > size || argumentSize < 0)
+            return false;
+         data += argumentSize;
+         size -= argumentSize;
+         ++message.mNumArguments;
+      }
+
+      return true;
+   }
+
+   bool StartsWith(std::string_view string, std::string_view prefix)
+   {
+      return string.substr(0, prefix.size()) == prefix;
+   }
+}
+
 OscController::OscController(MidiDeviceListener* listener, std::string outAddress, int outPort, int inPort)
-: mListener(listener)
+: juce::Thread("osc input")
+, mListener(listener)
 , mOutAddress(outAddress)
 , mOutPort(outPort)
 , mInPort(inPort)
 {
+   mPacket.resize(kMaxPacketSize);
+   mDispatchTable.reserve(128);
    Connect();
 }
 
 OscController::~OscController()
 {
-   OSCReceiver::disconnect();
+   DisconnectInput();
+   cancelPendingUpdate();
 }
 
 void OscController::Connect()
 {
-   try
+   DisconnectInput();
+
+   auto socket = std::make_unique<juce::DatagramSocket>(false);
+   if (socket->bindToPort(mInPort))
    {
-      bool connected = OSCReceiver::connect(mInPort);
-      assert(connected);
+      mSocket = std::move(socket);
+      startThread(7); //above normal, controllers want their values promptly
+      mConnected = true;
+   }
 
-      OSCReceiver::addListener(this);
+   ConnectOutput();
+}
 
-      ConnectOutput();
+void OscController::DisconnectInput()
+{
+   signalThreadShouldExit();
+   if (mSocket != nullptr)
+      mSocket->shutdown();
+   stopThread(1000);
+   mSocket.reset();
+   mConnected = false;
+}
 
-      mConnected = true;
+void OscController::ConnectOutput()
+{
+   if (mOutAddress != "" && mOutPort > 0)
+   {
+      mOutputConnected = mOscOut.connect(mOutAddress, mOutPort);
    }
-   catch (std::exception e)
+}
+
+void OscController::run()
+{
+   while (!threadShouldExit())
    {
+      //wake up now and then to check whether we should be stopping
+      int ready = mSocket->waitUntilReady(true, 100);
+      if (ready < 0)
+         break;
+      if (ready == 0)
+         continue;
+
+      int bytes = mSocket->read(mPacket.data(), (int)mPacket.size(), false);
+      if (bytes > 0 && bytes % 4 == 0)
+         HandlePacket(mPacket.data(), bytes, 0);
    }
 }
 
-void OscController::ConnectOutput()
+void OscController::HandlePacket(const char* data, int size, int depth)
 {
-   if (mOutAddress != "" && mOutPort > 0)
+   static const char kBundleTag[] = "#bundle"; //with its null terminator, eight bytes
+
+   if (size >= 16 && memcmp(data, kBundleTag, sizeof(kBundleTag)) == 0)
    {
-      mOutputConnected = mOscOut.connect(mOutAddress, mOutPort);
+      if (depth >= kMaxBundleDepth)
+         return;
+      //the time tag is ignored, everything is handled as it arrives
+      for (int position = 16; position + 4 <= size;)
+      {
+         int elementSize = ReadInt32(data + position);
+         position += 4;
+         if (elementSize <= 0 || elementSize % 4 != 0 || position + elementSize > size)
+            return;
+         HandlePacket(data + position, elementSize, depth + 1);
+         position += elementSize;
+      }
+      return;
+   }
+
+   if (ParseMessage(data, size, mParsedMessage))
+      HandleMessage(mParsedMessage);
+}
+
+void OscController::HandleMessage(const OscParsedMessage& message)
+{
+   //the mapped controls and notes are the messages that come in fast, so they're the ones handled here.
+   ///bespoke/ commands touch the patch, so those go over to the main thread along with anything not mapped yet
+   if (message.mNumArguments > 0 && message.mArguments[0].IsNumber() && !StartsWith(message.mAddress, "/bespoke/") && !StartsWith(message.mAddress, "/jockey/"))
+   {
+      if (HandleNote(message) || DispatchMappedControls(message))
+         return;
+   }
+   else if (StartsWith(message.mAddress, "/bespoke/note") && HandleNote(message))
+   {
+      return;
+   }
+
+   QueueForMainThread(message);
+}
+
+bool OscController::HandleNote(const OscParsedMessage& message)
+{
+   // Handle note data and output these as notes instead of CC's.
+   if (!StartsWith(message.mAddress, "/note") && !StartsWith(message.mAddress, "/bespoke/note"))
+      return false;
+
+   const auto* args = message.mArguments;
+   int offset = 0;
+   if (message.mNumArguments >= 3 && args[0].mType == 'i' && args[1].mType == 'f' && args[2].mType == 'f')
+      offset = 1;
+   else if (!(message.mNumArguments >= 2 && args[0].mType == 'f' && args[1].mType == 'f'))
+      return false;
+
+   MidiNote note;
+   note.mDeviceName = "osccontroller";
+   note.mChannel = offset == 1 ? args[0].mInt : 1;
+   note.mPitch = args[0 + offset].mFloat;
+   if (args[1 + offset].mFloat < 1 / 127)
+      note.mVelocity = 0;
+   else
+      note.mVelocity = args[1 + offset].mFloat * 127;
+   if (mListener != nullptr)
+      mListener->OnMidiNote(note);
+   return true;
+}
+
+bool OscController::DispatchMappedControls(const OscParsedMessage& message)
+{
+   if (message.mAddress.size() > kMaxAddressLength)
+      return false;
+
+   //each argument after the first is its own control, at the address with "_<n>" on the end
+   char address[kMaxAddressLength + 16];
+   memcpy(address, message.mAddress.data(), message.mAddress.size());
+
+   MidiControl controls[OscParsedMessage::kMaxArguments];
+   int numControls = 0;
+   {
+      std::lock_guard<std::mutex> lock(mDispatchMutex);
+
+      int mapIndices[OscParsedMessage::kMaxArguments];
+      for (int i = 0; i < message.mNumArguments; ++i)
+      {
+         int length = (int)message.mAddress.size();
+         if (i > 0)
+            length += snprintf(address + length, 16, "_%d", i + 1);
+         mapIndices[i] = -1;
+         if (message.mArguments[i].IsNumber())
+         {
+            mapIndices[i] = FindControl(std::string_view(address, length));
+            if (mapIndices[i] == -1)
+               return false; //new, so it needs setting up on the main thread
+         }
+      }
+
+      for (int i = 0; i < message.mNumArguments; ++i)
+      {
+         if (mapIndices[i] == -1)
+            continue;
+
+         OscMap& map = mOscMap[mapIndices[i]];
+         MidiControl& control = controls[numControls++];
+         control.mControl = map.mControl;
+         control.mDeviceName = "osccontroller";
+         control.mChannel = 1;
+         map.mLastChangedTime = gTime;
+         if (map.mIsFloat)
+         {
+            map.mFloatValue = message.mArguments[i].GetNumber();
+            control.mValue = map.mFloatValue * 127;
+         }
+         else
+         {
+            map.mIntValue = (int)message.mArguments[i].GetNumber();
+            control.mValue = map.mIntValue;
+         }
+      }
+   }
+
+   if (mListener != nullptr)
+   {
+      for (int i = 0; i < numControls; ++i)
+         mListener->OnMidiControl(controls[i]);
+   }
+   return true;
+}
+
+void OscController::QueueForMainThread(const OscParsedMessage& message)
+{
+   try
+   {
+      juce::OSCMessage msg(juce::String(message.mAddress.data(), message.mAddress.size()));
+      for (int i = 0; i < message.mNumArguments; ++i)
+      {
+         const auto& argument = message.mArguments[i];
+         if (argument.mType == 'i')
+            msg.addInt32(argument.mInt);
+         else if (argument.mType == 'f')
+            msg.addFloat32(argument.mFloat);
+         else if (argument.mType == 's')
+            msg.addString(juce::String(argument.mString.data(), argument.mString.size()));
+      }
+      if (mMainThreadQueue.try_enqueue(std::move(msg)))
+         triggerAsyncUpdate();
+   }
+   catch (juce::OSCFormatError&)
+   {
+      //not an address juce can represent
    }
 }
 
+void OscController::handleAsyncUpdate()
+{
+   juce::OSCMessage msg("/");
+   while (mMainThreadQueue.try_dequeue(msg))
+      HandleMessageOnMainThread(msg);
+}
+
 bool OscController::SetInPort(int port)
 {
    if (mInPort != port)
    {
       mInPort = port;
-      OSCReceiver::disconnect();
-      return OSCReceiver::connect(mInPort);
+      Connect();
+      return mConnected;
    }
 
    return false;
@@ -115,7 +436,7 @@ void OscController::SendValue(int page, int control, float value, bool forceNote
    }
 }
 
-void OscController::oscMessageReceived(const juce::OSCMessage& msg)
+void OscController::HandleMessageOnMainThread(const juce::OSCMessage& msg)
 {
    std::string address = msg.getAddressPattern().toString().toStdString();
 
@@ -311,41 +632,49 @@ void OscController::oscMessageReceived(const juce::OSCMessage& msg)
 
    for (int i = 0; i < msg.size(); ++i)
    {
-      auto calculated_address = (i > 0) ? address + "_" + std::to_string(i + 1) : address;
-      int mapIndex = FindControl(calculated_address);
+      if (!msg[i].isFloat32() && !msg[i].isInt32())
+         continue;
 
-      bool isNew = false;
-      if (mapIndex == -1) //create a new map entry
-      {
-         isNew = true;
-         mapIndex = AddControl(calculated_address, msg[i].isFloat32());
-      }
+      auto calculated_address = (i > 0) ? address + "_" + std::to_string(i + 1) : address;
+      float value = msg[i].isFloat32() ? msg[i].getFloat32() : msg[i].getInt32();
 
       MidiControl control;
-      control.mControl = mOscMap[mapIndex].mControl;
       control.mDeviceName = "osccontroller";
       control.mChannel = 1;
-      mOscMap[mapIndex].mLastChangedTime = gTime;
-      if (mOscMap[mapIndex].mIsFloat)
-      {
-         assert(msg[i].isFloat32());
-         mOscMap[mapIndex].mFloatValue = msg[i].getFloat32();
-         control.mValue = mOscMap[mapIndex].mFloatValue * 127;
-      }
-      else
+      bool isNew = false;
       {
-         assert(msg[i].isInt32());
-         mOscMap[mapIndex].mIntValue = msg[i].getInt32();
-         control.mValue = mOscMap[mapIndex].mIntValue;
+         std::lock_guard<std::mutex> lock(mDispatchMutex);
+         int mapIndex = FindControl(calculated_address);
+         if (mapIndex == -1) //create a new map entry
+         {
+            isNew = true;
+            mapIndex = AddControlLocked(calculated_address, msg[i].isFloat32());
+         }
+
+         OscMap& map = mOscMap[mapIndex];
+         control.mControl = map.mControl;
+         map.mLastChangedTime = gTime;
+         if (map.mIsFloat)
+         {
+            map.mFloatValue = value;
+            control.mValue = map.mFloatValue * 127;
+         }
+         else
+         {
+            map.mIntValue = (int)value;
+            control.mValue = map.mIntValue;
+         }
       }
 
+      bool isFloat = msg[i].isFloat32();
+
       if (isNew)
       {
          MidiController* midiController = dynamic_cast<MidiController*>(mListener);
          if (midiController)
          {
             auto& layoutControl = midiController->GetLayoutControl(control.mControl, kMidiMessage_Control);
-            layoutControl.mConnectionType = mOscMap[mapIndex].mIsFloat ? kControlType_Slider : kControlType_Direct;
+            layoutControl.mConnectionType = isFloat ? kControlType_Slider : kControlType_Direct;
          }
       }
 
@@ -354,18 +683,19 @@ void OscController::oscMessageReceived(const juce::OSCMessage& msg)
    }
 }
 
-int OscController::FindControl(std::string address)
+int OscController::FindControl(std::string_view address) const
 {
-   for (int i = 0; i < mOscMap.size(); ++i)
-   {
-      if (address == mOscMap[i].mAddress)
-         return i;
-   }
-
-   return -1;
+   auto it = mDispatchTable.find(address);
+   return it != mDispatchTable.end() ? it->second : -1;
 }
 
 int OscController::AddControl(std::string address, bool isFloat)
+{
+   std::lock_guard<std::mutex> lock(mDispatchMutex);
+   return AddControlLocked(address, isFloat);
+}
+
+int OscController::AddControlLocked(std::string address, bool isFloat)
 {
    int existing = FindControl(address);
    if (existing != -1)
@@ -377,10 +707,19 @@ int OscController::AddControl(std::string address, bool isFloat)
    entry.mAddress = address;
    entry.mIsFloat = isFloat;
    mOscMap.push_back(entry);
+   RebuildDispatchTable();
 
    return mapIndex;
 }
 
+void OscController::RebuildDispatchTable()
+{
+   //the keys view mOscMap's strings, which move when it grows, so this rebuilds it all rather than adding to it
+   mDispatchTable.clear();
+   for (int i = 0; i < (int)mOscMap.size(); ++i)
+      mDispatchTable.emplace(mOscMap[i].mAddress, i);
+}
+
 namespace
 {
    const int kSaveStateRev = 1;
@@ -408,6 +747,8 @@ void OscController::LoadState(FileStreamIn& in)
    in >> rev;
    LoadStateValidate(rev <= kSaveStateRev);
 
+   std::lock_guard<std::mutex> lock(mDispatchMutex);
+
    int mapSize;
    in >> mapSize;
    mOscMap.resize(mapSize);
@@ -420,4 +761,5 @@ void OscController::LoadState(FileStreamIn& in)
       in >> mOscMap[i].mIntValue;
       in >> mOscMap[i].mLastChangedTime;
    }
+   RebuildDispatchTable();
 }
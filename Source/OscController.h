@@ -28,8 +28,14 @@
 #include "MidiDevice.h"
 #include "INonstandardController.h"
 
+#include "readerwriterqueue.h"
+
 #include "juce_osc/juce_osc.h"
 
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
 struct OscMap
 {
    int mControl{ 0 };
@@ -40,16 +46,38 @@ struct OscMap
    double mLastChangedTime{ -9999 }; //@TODO(Noxy): Unused but is in savestates.
 };
 
+//an incoming osc message, parsed in place. the address and any string arguments point into the packet it came in
+struct OscParsedMessage
+{
+   static constexpr int kMaxArguments = 16;
+
+   struct Argument
+   {
+      char mType{ 0 }; //'i', 'f' or 's' (doubles, int64s and bools come in as those), 0 for anything else
+      int mInt{ 0 };
+      float mFloat{ 0 };
+      std::string_view mString;
+
+      bool IsNumber() const { return mType == 'i' || mType == 'f'; }
+      float GetNumber() const { return mType == 'f' ? mFloat : mInt; }
+   };
+
+   std::string_view mAddress;
+   int mNumArguments{ 0 };
+   Argument mArguments[kMaxArguments];
+};
+
+//receives osc on its own thread. messages to mapped addresses go straight to the listener without allocating,
+//through a table that's rebuilt when the mappings change. everything else (new addresses, /bespoke/ commands) is handled on the main thread
 class OscController : public INonstandardController,
-                      private juce::OSCReceiver,
-                      private juce::OSCReceiver::Listener<juce::OSCReceiver::MessageLoopCallback>
+                      private juce::Thread,
+                      private juce::AsyncUpdater
 {
 public:
    OscController(MidiDeviceListener* listener, std::string outAddress, int outPort, int inPort);
    ~OscController();
 
    void Connect();
-   void oscMessageReceived(const juce::OSCMessage& msg) override;
    void SendValue(int page, int control, float value, bool forceNoteOn = false, int channel = -1) override;
    int AddControl(std::string address, bool isFloat);
 
@@ -66,9 +94,28 @@ public:
    void LoadState(FileStreamIn& in) override;
 
 private:
+   static constexpr int kMaxAddressLength = 256;
+
+   //juce::Thread
+   void run() override;
+   //juce::AsyncUpdater
+   void handleAsyncUpdate() override;
+
+   void DisconnectInput();
+   void HandlePacket(const char* data, int size, int depth);
+   void HandleMessage(const OscParsedMessage& message);
+   bool HandleNote(const OscParsedMessage& message);
+   bool DispatchMappedControls(const OscParsedMessage& message);
+   void QueueForMainThread(const OscParsedMessage& message);
+   void HandleMessageOnMainThread(const juce::OSCMessage& msg);
+
+   //these need mDispatchMutex held
+   int FindControl(std::string_view address) const;
+   int AddControlLocked(std::string address, bool isFloat);
+   void RebuildDispatchTable();
+
    MidiDeviceListener* mListener{ nullptr };
 
-   int FindControl(std::string address);
    void ConnectOutput();
 
    std::string mOutAddress;
@@ -79,4 +126,13 @@ private:
    bool mOutputConnected{ false };
 
    std::vector<OscMap> mOscMap;
+
+   std::unique_ptr<juce::DatagramSocket> mSocket;
+   std::vector<char> mPacket;
+   OscParsedMessage mParsedMessage;
+
+   std::mutex mDispatchMutex; //between the receive thread dispatching and the main thread changing the mappings
+   std::unordered_map<std::string_view, int> mDispatchTable; //address to index in mOscMap, viewing mOscMap's strings
+
+   moodycamel::ReaderWriterQueue<juce::OSCMessage> mMainThreadQueue{ 256 };
 };
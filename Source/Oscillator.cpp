@@ -25,14 +25,105 @@
 
 #include "Oscillator.h"
 
-float Oscillator::Value(float phase) const
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace
+{
+   const int kSinTableSize = 4096;
+   float sSinTable[kSinTableSize + 1];
+   bool sSinTableInitialized = []
+   {
+      for (int i = 0; i <= kSinTableSize; ++i)
+         sSinTable[i] = sin(i * FTWO_PI / kSinTableSize);
+      return true;
+   }();
+
+   float WrapPhase(float phase, float period)
+   {
+      if (phase >= 0 && phase < period)
+         return phase;
+      return phase - period * floorf(phase / period);
+   }
+
+#if defined(__wasm_simd128__)
+   v128_t WrapPhase4(v128_t phase, v128_t period)
+   {
+      return wasm_f32x4_sub(phase, wasm_f32x4_mul(period, wasm_f32x4_floor(wasm_f32x4_div(phase, period))));
+   }
+
+   v128_t SinSample4(v128_t phase)
+   {
+      v128_t pos = wasm_f32x4_mul(phase, wasm_f32x4_splat(kSinTableSize / FTWO_PI));
+      v128_t index = wasm_i32x4_min(wasm_i32x4_trunc_sat_f32x4(pos), wasm_i32x4_splat(kSinTableSize - 1));
+      v128_t frac = wasm_f32x4_sub(pos, wasm_f32x4_convert_i32x4(index));
+
+      //no gathers in simd128, so the table lookups stay scalar
+      int i0 = wasm_i32x4_extract_lane(index, 0);
+      int i1 = wasm_i32x4_extract_lane(index, 1);
+      int i2 = wasm_i32x4_extract_lane(index, 2);
+      int i3 = wasm_i32x4_extract_lane(index, 3);
+      v128_t a = wasm_f32x4_make(sSinTable[i0], sSinTable[i1], sSinTable[i2], sSinTable[i3]);
+      v128_t b = wasm_f32x4_make(sSinTable[i0 + 1], sSinTable[i1 + 1], sSinTable[i2 + 1], sSinTable[i3 + 1]);
+      return wasm_f32x4_add(a, wasm_f32x4_mul(wasm_f32x4_sub(b, a), frac));
+   }
+
+   v128_t PolyBlep4(v128_t t, v128_t dt)
+   {
+      v128_t one = wasm_f32x4_splat(1);
+      v128_t a = wasm_f32x4_div(t, dt);
+      v128_t rising = wasm_f32x4_sub(wasm_f32x4_sub(wasm_f32x4_add(a, a), wasm_f32x4_mul(a, a)), one);
+      v128_t b = wasm_f32x4_div(wasm_f32x4_sub(t, one), dt);
+      v128_t falling = wasm_f32x4_add(wasm_f32x4_add(wasm_f32x4_add(wasm_f32x4_mul(b, b), b), b), one);
+      v128_t result = wasm_v128_and(falling, wasm_f32x4_gt(t, wasm_f32x4_sub(one, dt)));
+      return wasm_v128_bitselect(rising, result, wasm_f32x4_lt(t, dt));
+   }
+
+   //four samples of one of the plain waveforms, at unwrapped phases. dt is the phase increment over two pi,
+   //and bandLimit masks the lanes that get polyblep
+   v128_t PlainSample4(OscillatorType type, float pulseWidth, v128_t phase, v128_t dt, v128_t bandLimit)
+   {
+      v128_t twoPi = wasm_f32x4_splat(FTWO_PI);
+      v128_t one = wasm_f32x4_splat(1);
+      if (type == kOsc_Tri)
+         phase = wasm_f32x4_add(phase, wasm_f32x4_splat(.5f * FPI));
+      v128_t p = WrapPhase4(phase, twoPi);
+      v128_t t = wasm_f32x4_div(p, twoPi);
+      switch (type)
+      {
+         case kOsc_Sin:
+            return SinSample4(p);
+         case kOsc_Saw:
+         case kOsc_NegSaw:
+         {
+            v128_t sample = wasm_f32x4_sub(wasm_f32x4_add(t, t), one);
+            sample = wasm_f32x4_sub(sample, wasm_v128_and(PolyBlep4(t, dt), bandLimit));
+            return type == kOsc_NegSaw ? wasm_f32x4_neg(sample) : sample;
+         }
+         case kOsc_Square:
+         {
+            v128_t high = wasm_f32x4_gt(p, wasm_f32x4_splat(FTWO_PI * pulseWidth));
+            v128_t sample = wasm_v128_bitselect(wasm_f32x4_splat(-1), one, high);
+            v128_t pulseT = wasm_f32x4_sub(t, wasm_f32x4_splat(pulseWidth));
+            pulseT = wasm_f32x4_sub(pulseT, wasm_f32x4_floor(pulseT));
+            return wasm_f32x4_add(sample, wasm_v128_and(wasm_f32x4_sub(PolyBlep4(t, dt), PolyBlep4(pulseT, dt)), bandLimit));
+         }
+         default: //kOsc_Tri
+            return wasm_f32x4_sub(wasm_f32x4_mul(wasm_f32x4_abs(wasm_f32x4_sub(t, wasm_f32x4_splat(.5f))), wasm_f32x4_splat(4)), one);
+      }
+   }
+#endif
+}
+
+float Oscillator::Value(float phase, float phaseInc /*= 0*/) const
 {
    if (mType == kOsc_Tri)
       phase += .5f * FPI; //shift phase to make triangle start at zero instead of 1, to eliminate click on start
 
    if (mShuffle > 0)
    {
-      phase = fmod(phase, FTWO_PI * 2);
+      phase = WrapPhase(phase, FTWO_PI * 2);
 
       float shufflePoint = FTWO_PI * (1 + mShuffle);
 
@@ -42,24 +133,35 @@ float Oscillator::Value(float phase) const
          phase = (phase - shufflePoint) / (1 - mShuffle);
    }
 
-   phase = fmod(phase, FTWO_PI);
+   phase = WrapPhase(phase, FTWO_PI);
+
+   //polyblep only knows about the jumps at the ends of the cycle, so leave it out when shuffle/soften/pulse width move them
+   bool bandLimit = phaseInc > 0 && mShuffle == 0 && mSoften == 0;
+   float t = phase / FTWO_PI;
+   float dt = phaseInc / FTWO_PI;
 
    float sample = 0;
    switch (mType)
    {
       case kOsc_Sin:
-         sample = sin(phase);
+         sample = SinSample(phase);
          break;
       case kOsc_Saw:
          sample = SawSample(phase);
+         if (bandLimit && mPulseWidth == .5f)
+            sample -= PolyBlep(t, dt);
          break;
       case kOsc_NegSaw:
          sample = -SawSample(phase);
+         if (bandLimit && mPulseWidth == .5f)
+            sample += PolyBlep(t, dt);
          break;
       case kOsc_Square:
          if (mSoften == 0)
          {
             sample = phase > (FTWO_PI * mPulseWidth) ? -1 : 1;
+            if (bandLimit)
+               sample += PolyBlep(t, dt) - PolyBlep(WrapPhase(t - mPulseWidth, 1), dt);
          }
          else
          {
@@ -87,6 +189,114 @@ float Oscillator::Value(float phase) const
    return sample;
 }
 
+float Oscillator::RenderBlock(float phase, float phaseInc, float* out, int bufferSize) const
+{
+   const float kPeriod = FTWO_PI * 2; //two cycles, so shuffle lines up
+   int i = 0;
+
+#if defined(__wasm_simd128__)
+   //four samples at a time for the plain waveforms
+   if (IsPlainShape())
+   {
+      v128_t bandLimit = wasm_i32x4_splat(phaseInc > 0 && phaseInc < FTWO_PI ? -1 : 0);
+      v128_t dt = wasm_f32x4_splat(phaseInc / FTWO_PI);
+      v128_t laneOffsets = wasm_f32x4_make(0, phaseInc, phaseInc * 2, phaseInc * 3);
+
+      for (; i + 4 <= bufferSize; i += 4)
+      {
+         wasm_v128_store(out + i, PlainSample4(mType, mPulseWidth, wasm_f32x4_add(wasm_f32x4_splat(phase), laneOffsets), dt, bandLimit));
+         phase += phaseInc * 4;
+         if (phase >= kPeriod)
+            phase -= kPeriod;
+      }
+   }
+#endif
+
+   for (; i < bufferSize; ++i)
+   {
+      out[i] = Value(phase, phaseInc);
+      phase += phaseInc;
+      if (phase >= kPeriod)
+         phase -= kPeriod;
+   }
+   return phase;
+}
+
+void Oscillator::RenderLanes(const float* phases, const float* phaseIncs, float* out, int numLanes) const
+{
+   int i = 0;
+
+#if defined(__wasm_simd128__)
+   if (IsPlainShape())
+   {
+      v128_t zero = wasm_f32x4_splat(0);
+      v128_t twoPi = wasm_f32x4_splat(FTWO_PI);
+      for (; i + 4 <= numLanes; i += 4)
+      {
+         v128_t phaseInc = wasm_v128_load(phaseIncs + i);
+         v128_t bandLimit = wasm_v128_and(wasm_f32x4_gt(phaseInc, zero), wasm_f32x4_lt(phaseInc, twoPi));
+         wasm_v128_store(out + i, PlainSample4(mType, mPulseWidth, wasm_v128_load(phases + i), wasm_f32x4_div(phaseInc, twoPi), bandLimit));
+      }
+   }
+#endif
+
+   for (; i < numLanes; ++i)
+      out[i] = Value(phases[i], phaseIncs[i]);
+}
+
+//shuffle, soften and pulse width on non-squares bend the phase, so those stay on Value()
+bool Oscillator::IsPlainShape() const
+{
+   bool plainType = mType == kOsc_Sin || mType == kOsc_Saw || mType == kOsc_NegSaw || mType == kOsc_Square || mType == kOsc_Tri;
+   return plainType && mShuffle == 0 && mSoften == 0 && (mPulseWidth == .5f || mType == kOsc_Square);
+}
+
+//static
+float Oscillator::Sin(float phase)
+{
+   return SinSample(WrapPhase(phase, FTWO_PI));
+}
+
+//static
+void Oscillator::RenderSinPhases(const float* phases, float* out, int bufferSize)
+{
+   int i = 0;
+#if defined(__wasm_simd128__)
+   v128_t twoPi = wasm_f32x4_splat(FTWO_PI);
+   for (; i + 4 <= bufferSize; i += 4)
+      wasm_v128_store(out + i, SinSample4(WrapPhase4(wasm_v128_load(phases + i), twoPi)));
+#endif
+   for (; i < bufferSize; ++i)
+      out[i] = SinSample(WrapPhase(phases[i], FTWO_PI));
+}
+
+float Oscillator::SinSample(float phase)
+{
+   //phase is already wrapped to [0, 2pi)
+   float pos = phase * (kSinTableSize / FTWO_PI);
+   int index = MIN(int(pos), kSinTableSize - 1);
+   float frac = pos - index;
+   return sSinTable[index] + (sSinTable[index + 1] - sSinTable[index]) * frac;
+}
+
+float Oscillator::PolyBlep(float t, float dt)
+{
+   //two-sample polynomial correction around a jump of -2 at t == 0 (as in a rising saw)
+   if (dt <= 0 || dt >= 1)
+      return 0;
+   if (t < dt)
+   {
+      t /= dt;
+      return t + t - t * t - 1;
+   }
+   if (t > 1 - dt)
+   {
+      t = (t - 1) / dt;
+      return t * t + t + t + 1;
+   }
+   return 0;
+}
+
 float Oscillator::SawSample(float phase) const
 {
    phase /= FTWO_PI;
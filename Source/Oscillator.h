@@ -44,7 +44,11 @@ public:
 
    OscillatorType GetType() const { return mType; }
    void SetType(OscillatorType type) { mType = type; }
-   float Value(float phase) const;
+   float Value(float phase, float phaseInc = 0) const; //pass the phase increment to band-limit the saw and square edges
+   float RenderBlock(float phase, float phaseInc, float* out, int bufferSize) const; //returns the phase to continue from
+   void RenderLanes(const float* phases, const float* phaseIncs, float* out, int numLanes) const; //one sample from each of several copies, for unison
+   static float Sin(float phase); //table sine of any phase
+   static void RenderSinPhases(const float* phases, float* out, int bufferSize); //the same over a block of phases, for phase modulation. out can be phases
    float GetPulseWidth() const { return mPulseWidth; }
    void SetPulseWidth(float width) { mPulseWidth = width; }
    float GetShuffle() const { return mShuffle; }
@@ -54,7 +58,10 @@ public:
    OscillatorType mType{ OscillatorType::kOsc_Sin };
 
 private:
+   bool IsPlainShape() const;
    float SawSample(float phase) const;
+   static float SinSample(float phase);
+   static float PolyBlep(float t, float dt);
 
    float mPulseWidth{ .5 };
    float mShuffle{ 0 };
@@ -64,7 +64,7 @@ void OutputChannel::Process(double time)
    if (numChannels == 1)
    {
       int channel = channelSelectionIndex;
-      auto getBufferGetChannel0 = GetBuffer()->GetChannel(0);
+      auto getBufferGetChannel0 = GetBuffer()->GetChannelReadOnly(0);
       if (channel >= 0 && channel < TheSynth->GetNumOutputChannels())
       {
          if (mLimit > std::numeric_limits<float>::epsilon())
@@ -87,7 +87,7 @@ void OutputChannel::Process(double time)
       int channel1 = channelSelectionIndex - mStereoSelectionOffset;
       if (channel1 >= 0 && channel1 < TheSynth->GetNumOutputChannels())
       {
-         auto getBufferGetChannel0 = GetBuffer()->GetChannel(0);
+         auto getBufferGetChannel0 = GetBuffer()->GetChannelReadOnly(0);
          if (mLimit > std::numeric_limits<float>::epsilon())
          {
             for (int i = 0; i < gBufferSize; ++i)
@@ -104,7 +104,7 @@ void OutputChannel::Process(double time)
       int inputChannel2 = (GetBuffer()->NumActiveChannels() >= 2) ? 1 : 0;
       if (channel2 >= 0 && channel2 < TheSynth->GetNumOutputChannels())
       {
-         auto getBufferGetChannel2 = GetBuffer()->GetChannel(inputChannel2);
+         auto getBufferGetChannel2 = GetBuffer()->GetChannelReadOnly(inputChannel2);
          if (mLimit > std::numeric_limits<float>::epsilon())
          {
             for (int i = 0; i < gBufferSize; ++i)
@@ -48,6 +48,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool RequiresSerialProcessing() const override { return true; } //sums into the shared device output buffers
 
    void DropdownUpdated(DropdownList* list, int oldVal, double time) override {}
 
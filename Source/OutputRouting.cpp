@@ -0,0 +1,110 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    OutputRouting.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "OutputRouting.h"
+#include "SynthGlobals.h"
+
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+
+bool OutputRouting::Parse(const std::string& table, std::vector<Route>& routes, std::string& error)
+{
+   routes.clear();
+   for (const auto& token : juce::StringArray::fromTokens(juce::String(table), ", ", ""))
+   {
+      if (token.isEmpty())
+         continue;
+
+      juce::String bus = token.upToFirstOccurrenceOf(">", false, false);
+      juce::String rest = token.fromFirstOccurrenceOf(">", false, false);
+      juce::String channel = rest.upToFirstOccurrenceOf("*", false, false);
+      juce::String gain = rest.fromFirstOccurrenceOf("*", false, false);
+      if (!token.contains(">") || !bus.containsOnly("0123456789") || !channel.containsOnly("0123456789") ||
+          bus.isEmpty() || channel.isEmpty() || (rest.contains("*") && !gain.containsOnly("0123456789.-")))
+      {
+         error = "couldn't read output route \"" + token.toStdString() + "\", expected bus>channel or bus>channel*gain";
+         return false;
+      }
+
+      Route route;
+      route.mBus = bus.getIntValue() - 1;
+      route.mChannel = channel.getIntValue() - 1;
+      route.mGain = rest.contains("*") ? gain.getFloatValue() : 1;
+      if (route.mBus < 0 || route.mChannel < 0)
+      {
+         error = "output routes count from 1, got \"" + token.toStdString() + "\"";
+         return false;
+      }
+      routes.push_back(route);
+   }
+   return true;
+}
+
+void OutputRouting::SetUp(std::vector<Route> routes, int numBuses, int numChannels, int bufferSize)
+{
+   routes.erase(std::remove_if(routes.begin(), routes.end(), [numBuses, numChannels](const Route& route)
+                               {
+                                  return route.mBus >= numBuses || route.mChannel >= numChannels || route.mGain == 0;
+                               }),
+                routes.end());
+   std::stable_sort(routes.begin(), routes.end(), [](const Route& a, const Route& b)
+                    {
+                       return a.mChannel < b.mChannel;
+                    });
+
+   mRoutes = std::move(routes);
+   mActive = !mRoutes.empty();
+   mChannelData.assign(mActive ? (size_t)numChannels * bufferSize : 0, 0.0f);
+   mChannels.resize(mActive ? numChannels : 0);
+   for (size_t ch = 0; ch < mChannels.size(); ++ch)
+      mChannels[ch] = mChannelData.data() + ch * bufferSize;
+}
+
+const std::vector<float*>& OutputRouting::Process(const std::vector<float*>& buses, int bufferSize)
+{
+   if (!mActive)
+      return buses;
+
+   //each channel is written by its first route and summed into by the rest, a vectorized pass per route
+   size_t route = 0;
+   for (int ch = 0; ch < (int)mChannels.size(); ++ch)
+   {
+      float* channel = mChannels[ch];
+      if (route == mRoutes.size() || mRoutes[route].mChannel != ch)
+      {
+         Clear(channel, bufferSize);
+         continue;
+      }
+
+      BufferCopy(channel, buses[mRoutes[route].mBus], bufferSize);
+      if (mRoutes[route].mGain != 1)
+         Mult(channel, mRoutes[route].mGain, bufferSize);
+      for (++route; route < mRoutes.size() && mRoutes[route].mChannel == ch; ++route)
+         AddWithGain(channel, buses[mRoutes[route].mBus], mRoutes[route].mGain, bufferSize);
+   }
+   return mChannels;
+}
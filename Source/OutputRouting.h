@@ -0,0 +1,60 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    OutputRouting.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//sums the output buses (what output and outputchannel modules write to) into the device channels through a sparse gain table,
+//so a few buses can feed a large speaker array without a module per speaker each doing its own full buffer add.
+//with no table, each bus goes to the channel with the same number untouched, and nothing is copied
+class OutputRouting
+{
+public:
+   struct Route
+   {
+      int mBus{ 0 };
+      int mChannel{ 0 };
+      float mGain{ 1 };
+   };
+
+   //"bus>channel" or "bus>channel*gain" entries, one based, separated by commas or spaces, like "1>1 2>2 1>3*.5 2>3*.5"
+   static bool Parse(const std::string& table, std::vector<Route>& routes, std::string& error);
+
+   //main thread, with the audio stopped. routes to buses or channels that don't exist are dropped
+   void SetUp(std::vector<Route> routes, int numBuses, int numChannels, int bufferSize);
+   bool IsActive() const { return mActive; }
+
+   //audio thread. the device channels, summed from the buses
+   const std::vector<float*>& Process(const std::vector<float*>& buses, int bufferSize);
+
+private:
+   std::vector<Route> mRoutes; //grouped by channel
+   std::vector<float> mChannelData;
+   std::vector<float*> mChannels;
+   bool mActive{ false };
+};
@@ -0,0 +1,242 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Oversampler.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "Oversampler.h"
+#include "SynthGlobals.h"
+
+#include <cmath>
+
+namespace
+{
+   //zeroth order modified bessel function of the first kind, for the kaiser window
+   double BesselI0(double x)
+   {
+      double sum = 1;
+      double term = 1;
+      for (int k = 1; k < 32; ++k)
+      {
+         term *= (x / (2 * k)) * (x / (2 * k));
+         sum += term;
+      }
+      return sum;
+   }
+
+   //the taps of a kaiser windowed halfband lowpass at odd offsets from the center, the only nonzero ones besides the center tap of 0.5.
+   //taps[i] is the tap at offset 2 * i - (2 * numTaps - 1), the other half mirrors it
+   std::vector<float> DesignHalfband(int numTaps, double beta)
+   {
+      int halfLength = numTaps * 2 - 1;
+      std::vector<double> taps(numTaps);
+      double sum = 0;
+      for (int i = 0; i < numTaps; ++i)
+      {
+         double offset = 2 * i - halfLength;
+         double sinc = sin(PI * offset / 2) / (PI * offset);
+         double position = offset / (halfLength + 1);
+         double window = BesselI0(beta * sqrt(1 - position * position)) / BesselI0(beta);
+         taps[i] = sinc * window;
+         sum += taps[i] * 2;
+      }
+
+      //normalize so the odd taps sum to 0.5, which with the center tap gives unity gain at dc
+      std::vector<float> normalized(numTaps);
+      for (int i = 0; i < numTaps; ++i)
+         normalized[i] = taps[i] * 0.5 / sum;
+      return normalized;
+   }
+}
+
+//static
+const float* Oversampler::GetTaps(int stage, int& numTaps)
+{
+   static const std::vector<float> sSteep = DesignHalfband(kSteepTaps, 8);
+   static const std::vector<float> sRelaxed = DesignHalfband(kRelaxedTaps, 7);
+
+   numTaps = (stage == 0) ? kSteepTaps : kRelaxedTaps;
+   return (stage == 0) ? sSteep.data() : sRelaxed.data();
+}
+
+void Oversampler::SetFactor(int factor)
+{
+   assert(factor == 1 || factor == 2 || factor == 4 || factor == 8);
+   if (factor == mFactor)
+      return;
+
+   mFactor = factor;
+   mNumStages = 0;
+   while ((1 << mNumStages) < factor)
+      ++mNumStages;
+   Reset();
+}
+
+int Oversampler::GetLatencySamples() const
+{
+   //each octave delays by about its half length at its own rate, once on the way up and once on the way down
+   float latency = 0;
+   for (int stage = 0; stage < mNumStages; ++stage)
+   {
+      int numTaps;
+      GetTaps(stage, numTaps);
+      int halfLength = numTaps * 2 - 1;
+      latency += (halfLength * 2 - 1) / float(2 << stage);
+   }
+   return (int)(latency + .5f);
+}
+
+void Oversampler::Reset()
+{
+   for (auto& channel : mStates)
+   {
+      for (auto& state : channel)
+         state = StageState();
+   }
+}
+
+void Oversampler::EnsureCapacity(int bufferSize)
+{
+   int size = bufferSize * mFactor;
+   if (size <= mCapacity)
+      return;
+
+   //only happens when a larger block than before comes through, after that processing doesn't allocate
+   mCapacity = size;
+   for (auto& buffer : mOversampled)
+      buffer.resize(size);
+   for (auto& buffer : mStageBuffers)
+      buffer.resize(size / 2);
+   mEven.resize(size / 2 + kSteepTaps * 2);
+   mOdd.resize(size / 2 + kSteepTaps * 2);
+}
+
+float* Oversampler::Upsample(int ch, const float* input, int bufferSize)
+{
+   assert(ch >= 0 && ch < kMaxChannels);
+   EnsureCapacity(bufferSize);
+
+   if (mFactor == 1)
+   {
+      BufferCopy(mOversampled[ch].data(), input, bufferSize);
+      return mOversampled[ch].data();
+   }
+
+   const float* src = input;
+   int size = bufferSize;
+   for (int stage = 0; stage < mNumStages; ++stage)
+   {
+      float* dst = (stage == mNumStages - 1) ? mOversampled[ch].data() : mStageBuffers[stage & 1].data();
+      UpsampleStage(stage, mStates[ch][stage], src, dst, size);
+      src = dst;
+      size *= 2;
+   }
+   return mOversampled[ch].data();
+}
+
+void Oversampler::Downsample(int ch, const float* input, float* output, int bufferSize)
+{
+   assert(ch >= 0 && ch < kMaxChannels);
+
+   if (mFactor == 1)
+   {
+      if (output != input)
+         BufferCopy(output, input, bufferSize);
+      return;
+   }
+
+   EnsureCapacity(bufferSize);
+
+   const float* src = input;
+   int size = bufferSize * mFactor / 2;
+   for (int stage = mNumStages - 1, step = 0; stage >= 0; --stage, ++step)
+   {
+      float* dst = (stage == 0) ? output : mStageBuffers[step & 1].data();
+      DownsampleStage(stage, mStates[ch][stage], src, dst, size);
+      src = dst;
+      size /= 2;
+   }
+}
+
+//with the halfband's odd taps h, and its center tap of 0.5 (the rest are zero), zero stuffing and filtering comes down to
+//out[2n] = 2 * sum(h[i] * in[n - i]) and out[2n + 1] = in[n - (numTaps - 1)].
+//the sum runs a tap at a time across the whole block rather than a sample at a time across the taps, so each pass is a
+//contiguous multiply-add that AddWithGain() does with simd
+void Oversampler::UpsampleStage(int stage, StageState& state, const float* input, float* output, int inputSize)
+{
+   int numTaps;
+   const float* taps = GetTaps(stage, numTaps);
+   int historySize = numTaps * 2 - 1;
+
+   float* extended = mEven.data();
+   BufferCopy(extended, state.mUpHistory.data(), historySize);
+   BufferCopy(extended + historySize, input, inputSize);
+
+   float* sum = mOdd.data();
+   Clear(sum, inputSize);
+   for (int i = 0; i < numTaps; ++i)
+   {
+      AddWithGain(sum, extended + historySize - i, taps[i] * 2, inputSize);
+      AddWithGain(sum, extended + i, taps[i] * 2, inputSize);
+   }
+
+   const float* center = extended + historySize - (numTaps - 1);
+   for (int n = 0; n < inputSize; ++n)
+   {
+      output[n * 2] = sum[n];
+      output[n * 2 + 1] = center[n];
+   }
+
+   BufferCopy(state.mUpHistory.data(), extended + inputSize, historySize);
+}
+
+//the same split the other way: out[n] = 0.5 * even[n - (numTaps - 1)] + sum(h[i] * odd[n - i])
+void Oversampler::DownsampleStage(int stage, StageState& state, const float* input, float* output, int outputSize)
+{
+   int numTaps;
+   const float* taps = GetTaps(stage, numTaps);
+   int evenHistorySize = numTaps - 1;
+   int oddHistorySize = numTaps * 2 - 1;
+
+   float* even = mEven.data();
+   float* odd = mOdd.data();
+   BufferCopy(even, state.mDownEvenHistory.data(), evenHistorySize);
+   BufferCopy(odd, state.mDownOddHistory.data(), oddHistorySize);
+   for (int n = 0; n < outputSize; ++n)
+   {
+      even[evenHistorySize + n] = input[n * 2];
+      odd[oddHistorySize + n] = input[n * 2 + 1];
+   }
+
+   //input has been split into even and odd by now, so output can be written to even if it's the same buffer
+   Clear(output, outputSize);
+   AddWithGain(output, even, .5f, outputSize);
+   for (int i = 0; i < numTaps; ++i)
+   {
+      AddWithGain(output, odd + oddHistorySize - i, taps[i], outputSize);
+      AddWithGain(output, odd + i, taps[i], outputSize);
+   }
+
+   BufferCopy(state.mDownEvenHistory.data(), even + outputSize, evenHistorySize);
+   BufferCopy(state.mDownOddHistory.data(), odd + outputSize, oddHistorySize);
+}
@@ -0,0 +1,79 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Oversampler.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChannelBuffer.h"
+
+#include <array>
+#include <vector>
+
+//runs part of a module at 2x, 4x or 8x the engine rate, so nonlinear stages don't alias, while the rest of the graph stays at the base rate.
+//each octave is a linear phase halfband FIR split into its two polyphase branches, so only the nonzero taps are computed, at the lower of the two rates.
+//the stage next to the base rate has the steep filter, the ones above it only have to reject images far outside the audio band, so they're shorter.
+class Oversampler
+{
+public:
+   static const int kMaxFactor = 8;
+   static const int kMaxChannels = ChannelBuffer::kMaxNumChannels;
+
+   //1, 2, 4 or 8. clears the filter state when the factor changes
+   void SetFactor(int factor);
+   int GetFactor() const { return mFactor; }
+   //round trip delay of Upsample() followed by Downsample(), in base rate samples
+   int GetLatencySamples() const;
+   void Reset();
+
+   //returns bufferSize * factor samples of the input at the oversampled rate, to be processed in place and handed back to Downsample()
+   float* Upsample(int ch, const float* input, int bufferSize);
+   //filters bufferSize * factor samples at the oversampled rate down to bufferSize samples. output may be the same buffer as input
+   void Downsample(int ch, const float* input, float* output, int bufferSize);
+
+private:
+   static const int kSteepTaps = 12; //nonzero taps per side for the first octave, 47 taps in total
+   static const int kRelaxedTaps = 6; //and for the octaves above it, 23 taps
+
+   struct StageState
+   {
+      std::array<float, kSteepTaps * 2 - 1> mUpHistory{};
+      std::array<float, kSteepTaps - 1> mDownEvenHistory{};
+      std::array<float, kSteepTaps * 2 - 1> mDownOddHistory{};
+   };
+
+   static const float* GetTaps(int stage, int& numTaps);
+   void UpsampleStage(int stage, StageState& state, const float* input, float* output, int inputSize);
+   void DownsampleStage(int stage, StageState& state, const float* input, float* output, int outputSize);
+   void EnsureCapacity(int bufferSize);
+
+   int mFactor{ 1 };
+   int mNumStages{ 0 };
+   int mCapacity{ 0 };
+   std::array<std::array<StageState, 3>, kMaxChannels> mStates;
+   std::array<std::vector<float>, kMaxChannels> mOversampled;
+   std::array<std::vector<float>, 2> mStageBuffers;
+   std::vector<float> mEven;
+   std::vector<float> mOdd;
+};
@@ -72,49 +72,50 @@ void Panner::Process(double time)
    SyncBuffers(2);
    mWidenerBuffer.SetNumChannels(2);
 
-   float* secondChannel;
-   if (GetBuffer()->NumActiveChannels() == 1) //panning mono input
-   {
-      BufferCopy(gWorkBuffer, GetBuffer()->GetChannel(0), GetBuffer()->BufferSize());
-      secondChannel = gWorkBuffer;
-   }
-   else
-   {
-      secondChannel = GetBuffer()->GetChannel(1);
-   }
+   ChannelBuffer* in = GetBuffer();
+   int bufferSize = in->BufferSize();
+   in->SpreadToStereo(); //panning mono input
 
    ChannelBuffer* out = target->GetBuffer();
 
    if (abs(mWiden) > 0)
    {
-      for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
-         mWidenerBuffer.WriteChunk(GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize(), ch);
+      for (int ch = 0; ch < 2; ++ch)
+         mWidenerBuffer.WriteChunk(in->GetChannel(ch), bufferSize, ch);
       if (mWiden < 0)
-         mWidenerBuffer.ReadChunk(secondChannel, GetBuffer()->BufferSize(), abs(mWiden), (GetBuffer()->NumActiveChannels() == 1) ? 0 : 1);
+         mWidenerBuffer.ReadChunk(in->GetChannel(1), bufferSize, abs(mWiden), 1);
       else
-         mWidenerBuffer.ReadChunk(GetBuffer()->GetChannel(0), GetBuffer()->BufferSize(), abs(mWiden), 0);
+         mWidenerBuffer.ReadChunk(in->GetChannel(0), bufferSize, abs(mWiden), 0);
    }
 
+   //the pan is worked out once a sample, then both sides are mixed with it together
+   if ((int)mPanMix.size() < bufferSize * 4)
+      mPanMix.resize(bufferSize * 4);
+   float* leftToLeft = mPanMix.data();
+   float* rightToLeft = leftToLeft + bufferSize;
+   float* leftToRight = rightToLeft + bufferSize;
+   float* rightToRight = leftToRight + bufferSize;
    mPanRamp.Start(time, mPan, time + 2);
-   for (int i = 0; i < GetBuffer()->BufferSize(); ++i)
+   for (int i = 0; i < bufferSize; ++i)
    {
       mPan = mPanRamp.Value(time);
 
       ComputeSliders(i);
 
-      float left = GetBuffer()->GetChannel(0)[i];
-      float right = secondChannel[i];
-      GetBuffer()->GetChannel(0)[i] = left * ofMap(mPan, 0, 1, 1, 0, true) + right * ofMap(mPan, -1, 0, 1, 0, true);
-      secondChannel[i] = right * ofMap(mPan, -1, 0, 0, 1, true) + left * ofMap(mPan, 0, 1, 0, 1, true);
-
-      out->GetChannel(0)[i] += GetBuffer()->GetChannel(0)[i];
-      out->GetChannel(1)[i] += secondChannel[i];
+      leftToLeft[i] = ofMap(mPan, 0, 1, 1, 0, true);
+      rightToLeft[i] = ofMap(mPan, -1, 0, 1, 0, true);
+      leftToRight[i] = ofMap(mPan, 0, 1, 0, 1, true);
+      rightToRight[i] = ofMap(mPan, -1, 0, 0, 1, true);
 
       time += gInvSampleRateMs;
    }
+   in->MixStereo(leftToLeft, rightToLeft, leftToRight, rightToRight, bufferSize);
 
-   GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(0), GetBuffer()->BufferSize(), 0);
-   GetVizBuffer()->WriteChunk(secondChannel, GetBuffer()->BufferSize(), 1);
+   for (int ch = 0; ch < 2; ++ch)
+   {
+      Add(out->GetChannel(ch), in->GetChannel(ch), bufferSize);
+      GetVizBuffer()->WriteChunk(in->GetChannel(ch), bufferSize, ch);
+   }
 
    GetBuffer()->Reset();
 }
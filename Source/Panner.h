@@ -34,6 +34,8 @@
 #include "RollingBuffer.h"
 #include "Ramp.h"
 
+#include <vector>
+
 class Panner : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public IButtonListener, public IIntSliderListener
 {
 public:
@@ -50,6 +52,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
@@ -61,6 +64,7 @@ public:
    virtual void SetUpFromSaveData() override;
 
    bool IsEnabled() const override { return mEnabled; }
+   bool CanCacheRendering() const override { return true; }
 
 private:
    //IDrawableModule
@@ -77,4 +81,5 @@ private:
    float mWiden{ 0 };
    FloatSlider* mWidenSlider{ nullptr };
    RollingBuffer mWidenerBuffer{ 2048 };
+   std::vector<float> mPanMix; //each sample's stereo mix, a buffer of each coefficient after the other
 };
@@ -39,6 +39,7 @@
 #include "IModulator.h"
 #include "UserPrefs.h"
 #include "QuickSpawnMenu.h"
+#include "nanovg/nanovg.h"
 
 PatchCable* PatchCable::sActivePatchCable = nullptr;
 
@@ -62,6 +63,46 @@ void PatchCable::SetCableTarget(IClickable* target)
    mAudioReceiverTarget = dynamic_cast<IAudioReceiver*>(target);
 }
 
+//the bezier stays within its control points, which are at most .15 of the wire length out from the ends
+bool PatchCable::IsOffscreen(PatchCablePos cable) const
+{
+   if (mDragging || GetOwningModule() == nullptr || GetOwningModule()->GetOwningContainer() != TheSynth->GetRootContainer())
+      return false;
+
+   float minX = MIN(MIN(cable.start.x, cable.end.x), cable.plug.x);
+   float maxX = MAX(MAX(cable.start.x, cable.end.x), cable.plug.x);
+   float minY = MIN(MIN(cable.start.y, cable.end.y), cable.plug.y);
+   float maxY = MAX(MAX(cable.start.y, cable.end.y), cable.plug.y);
+   ofRectangle bounds(minX, minY, maxX - minX, maxY - minY);
+   bounds.grow(sqrtf((cable.plug - cable.start).lengthSquared()) * .15f + 10);
+   return !bounds.intersects(TheSynth->GetDrawRect());
+}
+
+//nanovg flattens the curve itself, only as finely as it shows up on screen, so there's no need to step along it here
+void PatchCable::DrawCurve(PatchCablePos cable, ofVec2f bezierControl1, ofVec2f bezierControl2, ofColor color, float wireLength)
+{
+   ofVec2f cableFadeOut = cable.start * .47 + cable.end * .53f;
+   ofVec2f cableFadeIn = cable.start * .53f + cable.end * .47f;
+
+   for (int half = 0; half < 2; ++half)
+   {
+      if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
+         ofSetColor(color);
+      else if (half == 0)
+         ofSetColorGradient(color, ofColor::clear, cable.start, cableFadeOut);
+      else
+         ofSetColorGradient(ofColor::clear, color, cableFadeIn, cable.end);
+
+      nvgBeginPath(gNanoVG);
+      nvgMoveTo(gNanoVG, cable.start.x, cable.start.y);
+      nvgBezierTo(gNanoVG, bezierControl1.x, bezierControl1.y, bezierControl2.x, bezierControl2.y, cable.plug.x, cable.plug.y);
+      nvgStroke(gNanoVG);
+
+      if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
+         break;
+   }
+}
+
 void PatchCable::Render()
 {
    PatchCablePos cable = GetPatchCablePos();
@@ -108,18 +149,7 @@ void PatchCable::Render()
             if (vizBuff == nullptr)
                vizBuff = audioSource->GetVizBuffer();
             assert(vizBuff);
-            int numSamples = vizBuff->Size();
-            bool allZero = true;
-            for (int ch = 0; ch < vizBuff->NumChannels(); ++ch)
-            {
-               for (int i = 0; i < numSamples && allZero; ++i)
-               {
-                  if (vizBuff->GetSample(i, ch) != 0)
-                     allZero = false;
-               }
-            }
-
-            if (allZero)
+            if (vizBuff->IsSilent())
                return;
          }
          else
@@ -136,6 +166,9 @@ void PatchCable::Render()
    }
 
 
+   if (IsOffscreen(cable))
+      return;
+
    if (fatCable)
    {
       lineWidth = 1;
@@ -180,30 +213,7 @@ void PatchCable::Render()
           type == kConnectionType_UIControl)
       {
          ofSetLineWidth(lineWidth);
-         float cableStepSize = ofClamp(wireLength / (60 * cableQuality), 1, 1000);
-
-         for (int half = 0; half < 2; ++half)
-         {
-            if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
-               ofSetColor(lineColorAlphaed);
-            else if (half == 0)
-               ofSetColorGradient(lineColorAlphaed, ofColor::clear, cable.start, cableFadeOut);
-            else
-               ofSetColorGradient(ofColor::clear, lineColorAlphaed, cableFadeIn, cable.end);
-
-            ofBeginShape();
-            ofVertex(cable.start.x, cable.start.y);
-            for (float i = 1; i < wireLength - 1; i += cableStepSize)
-            {
-               ofVec2f pos = MathUtils::Bezier(i / wireLength, cable.start, bezierControl1, bezierControl2, cable.plug);
-               ofVertex(pos.x, pos.y);
-            }
-            ofVertex(cable.plug.x, cable.plug.y);
-            ofEndShape();
-
-            if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
-               break;
-         }
+         DrawCurve(cable, bezierControl1, bezierControl2, lineColorAlphaed, wireLength);
 
          IModulator* modulator = mOwner->GetModulatorOwner();
          if (modulator != nullptr)
@@ -214,31 +224,8 @@ void PatchCable::Render()
                float delta = ofClamp(modulator->GetRecentChange() / range, -1, 1);
                ofColor color = ofColor::lerp(ofColor::blue, ofColor::red, delta * .5f + .5f);
                color.a = abs(1 - ((1 - delta) * (1 - delta))) * 150 * UserPrefs.cable_alpha.Get();
-               ofSetColor(color);
                ofSetLineWidth(3);
-
-               for (int half = 0; half < 2; ++half)
-               {
-                  if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
-                     ofSetColor(color);
-                  else if (half == 0)
-                     ofSetColorGradient(color, ofColor::clear, cable.start, cableFadeOut);
-                  else
-                     ofSetColorGradient(ofColor::clear, color, cableFadeIn, cable.end);
-
-                  ofBeginShape();
-                  ofVertex(cable.start.x, cable.start.y);
-                  for (float i = 1; i < wireLength - 1; i += cableStepSize)
-                  {
-                     ofVec2f pos = MathUtils::Bezier(i / wireLength, cable.start, bezierControl1, bezierControl2, cable.plug);
-                     ofVertex(pos.x, pos.y);
-                  }
-                  ofVertex(cable.plug.x, cable.plug.y);
-                  ofEndShape();
-
-                  if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
-                     break;
-               }
+               DrawCurve(cable, bezierControl1, bezierControl2, color, wireLength);
 
                //change plug color
                if (delta > 0)
@@ -324,6 +311,7 @@ void PatchCable::Render()
          float dx = (cable.plug.x - cable.start.x) / wireLength;
          float dy = (cable.plug.y - cable.start.y) / wireLength;
          float cableStepSize = ofClamp(wireLength / (100 * cableQuality), 1, 7);
+         bool silent = vizBuff->IsSilent();
 
          for (int ch = 0; ch < vizBuff->NumChannels(); ++ch)
          {
@@ -334,6 +322,15 @@ void PatchCable::Render()
                drawColor.set(lineColorAlphaed.g, lineColorAlphaed.r, lineColorAlphaed.b, lineColorAlphaed.a);
             ofVec2f offset((ch - (vizBuff->NumChannels() - 1) * .5f) * 2 * dy, (ch - (vizBuff->NumChannels() - 1) * .5f) * 2 * -dx);
 
+            if (silent) //no waveform to show, so skip sampling it along the cable
+            {
+               ofPushMatrix();
+               ofTranslate(offset.x, offset.y);
+               DrawCurve(cable, bezierControl1, bezierControl2, drawColor, wireLength);
+               ofPopMatrix();
+               continue;
+            }
+
             for (int half = 0; half < 2; ++half)
             {
                if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
@@ -406,30 +403,7 @@ void PatchCable::Render()
       else
       {
          ofSetLineWidth(lineWidth);
-         float cableStepSize = ofClamp(wireLength / (60 * cableQuality), 1, 1000);
-
-         for (int half = 0; half < 2; ++half)
-         {
-            if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
-               ofSetColor(lineColorAlphaed);
-            else if (half == 0)
-               ofSetColorGradient(lineColorAlphaed, ofColor::clear, cable.start, cableFadeOut);
-            else
-               ofSetColorGradient(ofColor::clear, lineColorAlphaed, cableFadeIn, cable.end);
-
-            ofBeginShape();
-            ofVertex(cable.start.x, cable.start.y);
-            for (float i = 1; i < wireLength - 1; i += cableStepSize)
-            {
-               ofVec2f pos = MathUtils::Bezier(i / wireLength, cable.start, bezierControl1, bezierControl2, cable.plug);
-               ofVertex(pos.x, pos.y);
-            }
-            ofVertex(cable.plug.x, cable.plug.y);
-            ofEndShape();
-
-            if (!UserPrefs.fade_cable_middle.Get() || wireLength < 100)
-               break;
-         }
+         DrawCurve(cable, bezierControl1, bezierControl2, lineColorAlphaed, wireLength);
 
          ofSetLineWidth(plugWidth);
          ofSetColor(lineColor);
@@ -103,6 +103,8 @@ protected:
 private:
    void SetCableTarget(IClickable* target);
    PatchCablePos GetPatchCablePos();
+   bool IsOffscreen(PatchCablePos cable) const;
+   void DrawCurve(PatchCablePos cable, ofVec2f bezierControl1, ofVec2f bezierControl2, ofColor color, float wireLength);
    ofVec2f FindClosestSide(float x, float y, float w, float h, ofVec2f start, ofVec2f startDirection, ofVec2f& endDirection);
 
    PatchCableSource* mOwner{ nullptr };
@@ -81,6 +81,72 @@ double PerlinNoise::noise(double x, double y, double z)
    return (res + 1.0) / 2.0;
 }
 
+void PerlinNoise::noiseBlock(float* out, int length, double x, double xStep, double y, double z, double zStep, int octaves)
+{
+   std::fill(out, out + length, 0.0f);
+
+   double frequency = 1;
+   double amplitude = 1;
+   double totalAmplitude = 0;
+   for (int octave = 0; octave < std::max(1, octaves); ++octave)
+   {
+      // y stays put for the whole block, further octaves read other rows of the permutation
+      double octaveY = y + octave * 64;
+      int Y = (int)floor(octaveY) & 255;
+      double yFrac = octaveY - floor(octaveY);
+      double v = fade(yFrac);
+
+      int lastX = -1;
+      int lastZ = -1;
+      int hashes[8]{};
+      for (int i = 0; i < length; ++i)
+      {
+         double px = (x + i * xStep) * frequency;
+         double pz = (z + i * zStep) * frequency;
+         double floorX = floor(px);
+         double floorZ = floor(pz);
+         int X = (int)floorX & 255;
+         int Z = (int)floorZ & 255;
+         if (X != lastX || Z != lastZ)
+         {
+            int A = p[X] + Y;
+            int AA = p[A] + Z;
+            int AB = p[A + 1] + Z;
+            int B = p[X + 1] + Y;
+            int BA = p[B] + Z;
+            int BB = p[B + 1] + Z;
+            hashes[0] = p[AA];
+            hashes[1] = p[BA];
+            hashes[2] = p[AB];
+            hashes[3] = p[BB];
+            hashes[4] = p[AA + 1];
+            hashes[5] = p[BA + 1];
+            hashes[6] = p[AB + 1];
+            hashes[7] = p[BB + 1];
+            lastX = X;
+            lastZ = Z;
+         }
+
+         px -= floorX;
+         pz -= floorZ;
+         double u = fade(px);
+         double w = fade(pz);
+         double res = lerp(w, lerp(v, lerp(u, grad(hashes[0], px, yFrac, pz), grad(hashes[1], px - 1, yFrac, pz)), lerp(u, grad(hashes[2], px, yFrac - 1, pz), grad(hashes[3], px - 1, yFrac - 1, pz))), lerp(v, lerp(u, grad(hashes[4], px, yFrac, pz - 1), grad(hashes[5], px - 1, yFrac, pz - 1)), lerp(u, grad(hashes[6], px, yFrac - 1, pz - 1), grad(hashes[7], px - 1, yFrac - 1, pz - 1))));
+         out[i] += (float)((res + 1.0) / 2.0 * amplitude);
+      }
+
+      totalAmplitude += amplitude;
+      amplitude *= .5;
+      frequency *= 2;
+   }
+
+   if (totalAmplitude != 1)
+   {
+      for (int i = 0; i < length; ++i)
+         out[i] /= (float)totalAmplitude;
+   }
+}
+
 double PerlinNoise::fade(double t)
 {
    return t * t * t * (t * (t * 6 - 15) + 10);
@@ -20,6 +20,9 @@ public:
    PerlinNoise(unsigned int seed);
    // Get a noise value, for 2D images z can have any value
    double noise(double x, double y, double z);
+   // Fill out with noise(x + i * xStep, y, z + i * zStep), summing octaves of twice the frequency and half the amplitude of the
+   // last, scaled back to 0-1. The cube corner hashes are only looked up again when the walk crosses into a new cube
+   void noiseBlock(float* out, int length, double x, double xStep, double y, double z, double zStep, int octaves = 1);
 
 private:
    double fade(double t);
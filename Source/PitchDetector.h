@@ -25,51 +25,20 @@
 
 #pragma once
 
-class FFT;
+#include "PitchTracker.h"
 
 class PitchDetector
 {
 public:
    PitchDetector();
-   ~PitchDetector();
 
+   //returns the pitch (as a midi note) of the last voiced stretch of the buffer
    float DetectPitch(float* buffer, int bufferSize);
 
 private:
-   ////////////////////////////////////////
-   //ported
+   PitchTracker mTracker;
    float mTune{ 440 };
    float mPitch{ 0 };
    float mConfidence{ 0 };
-   float mLatency{ 0 };
-   ::FFT* mFFT;
-
-   unsigned long mfs; // Sample rate
-
-   unsigned long mcbsize; // size of circular buffer
-   unsigned long mcorrsize; // cbsize/2 + 1
-   unsigned long mcbiwr;
-   float* mcbi; // circular input buffer
-
-   float* mcbwindow; // hann of length N/2, zeros for the rest
-   float* macwinv; // inverse of autocorrelation of window
-   int mnoverlap;
-
-   float* mffttime;
-   float* mfftfreqre;
-   float* mfftfreqim;
-
-   // VARIABLES FOR LOW-RATE SECTION
-   float maref{ 440 }; // A tuning reference (Hz)
-   float mconf{ 0 }; // Confidence of pitch period estimate (between 0 and 1)
-   float mvthresh; // Voiced speech threshold
-
-   float mpmax; // Maximum allowable pitch period (seconds)
-   float mpmin; // Minimum allowable pitch period (seconds)
-   unsigned long mnmax; // Maximum period index for pitch prd est
-   unsigned long mnmin; // Minimum period index for pitch prd est
-
-   float mlrshift; // Shift prescribed by low-rate section
-   int mptarget; // Pitch target, between 0 and 11
-   float msptarget; // Smoothed pitch target
+   float mVoicedThreshold{ .7f };
 };
@@ -30,14 +30,10 @@
 
 PitchShiftEffect::PitchShiftEffect()
 {
-   for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
-      mPitchShifter[i] = new PitchShifter(1024);
 }
 
 PitchShiftEffect::~PitchShiftEffect()
 {
-   for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
-      delete mPitchShifter[i];
 }
 
 void PitchShiftEffect::CreateUIControls()
@@ -45,6 +41,7 @@ void PitchShiftEffect::CreateUIControls()
    IDrawableModule::CreateUIControls();
    mRatioSlider = new FloatSlider(this, "ratio", 5, 4, 85, 15, &mRatio, .5f, 2.0f);
    mRatioSelector = new RadioButton(this, "ratioselector", 5, 20, &mRatioSelection, kRadioHorizontal);
+   mLowLatencyCheckbox = new Checkbox(this, "low latency", 5, 38, &mLowLatency);
 
    mRatioSelector->AddLabel(".5", 5);
    mRatioSelector->AddLabel("1", 10);
@@ -63,11 +60,12 @@ void PitchShiftEffect::ProcessAudio(double time, ChannelBuffer* buffer)
 
    ComputeSliders(0);
 
+   float* channels[ChannelBuffer::kMaxNumChannels];
    for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-   {
-      mPitchShifter[ch]->SetRatio(mRatio);
-      mPitchShifter[ch]->Process(buffer->GetChannel(ch), bufferSize);
-   }
+      channels[ch] = buffer->GetChannel(ch);
+   mPitchShifter.SetRatio(mRatio);
+   mPitchShifter.SetLowLatency(mLowLatency);
+   mPitchShifter.Process(channels, buffer->NumActiveChannels(), bufferSize);
 }
 
 void PitchShiftEffect::DrawModule()
@@ -77,6 +75,7 @@ void PitchShiftEffect::DrawModule()
 
    mRatioSlider->Draw();
    mRatioSelector->Draw();
+   mLowLatencyCheckbox->Draw();
 }
 
 void PitchShiftEffect::GetModuleDimensions(float& width, float& height)
@@ -84,7 +83,7 @@ void PitchShiftEffect::GetModuleDimensions(float& width, float& height)
    if (mEnabled)
    {
       width = 105;
-      height = 39;
+      height = 56;
    }
    else
    {
@@ -29,6 +29,7 @@
 #include "Slider.h"
 #include "PitchShifter.h"
 #include "RadioButton.h"
+#include "Checkbox.h"
 
 class PitchShiftEffect : public IAudioEffect, public IIntSliderListener, public IFloatSliderListener, public IRadioButtonListener
 {
@@ -62,5 +63,7 @@ private:
    FloatSlider* mRatioSlider{ nullptr };
    int mRatioSelection{ 10 };
    RadioButton* mRatioSelector{ nullptr };
-   PitchShifter* mPitchShifter[ChannelBuffer::kMaxNumChannels];
+   bool mLowLatency{ false };
+   Checkbox* mLowLatencyCheckbox{ nullptr };
+   PitchShifter mPitchShifter{ 1024, ChannelBuffer::kMaxNumChannels };
 };
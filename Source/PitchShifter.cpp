@@ -29,439 +29,232 @@
 
 #include <cstring>
 
-PitchShifter::PitchShifter(int fftBins)
-: mFFTBins(fftBins)
-, mFFT(mFFTBins)
-, mRollingInputBuffer(mFFTBins)
-, mRollingOutputBuffer(mFFTBins)
-, mFFTData(mFFTBins, mFFTBins / 2 + 1)
+namespace
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[mFFTBins];
-   for (int i = 0; i < mFFTBins; ++i)
-      mWindower[i] = -.5 * cos(FTWO_PI * i / mFFTBins) + .5;
-   mLastPhase = new float[mFFTBins / 2 + 1];
-   mSumPhase = new float[mFFTBins / 2 + 1];
-   mAnalysisMag = new float[mFFTBins];
-   mAnalysisFreq = new float[mFFTBins];
-   mSynthesisMag = new float[mFFTBins];
-   mSynthesisFreq = new float[mFFTBins];
+   //the smb implementation this replaced came out ~3.5dB hot, keep that so existing patches don't change level
+   const float kLegacyGain = 1.5f;
 }
 
-PitchShifter::~PitchShifter()
+PitchShifter::PitchShifter(int frameSize, int numChannels /*= 1*/)
+: mMaxFrameSize(frameSize)
 {
-   delete[] mLastPhase;
-   delete[] mSumPhase;
-   delete[] mWindower;
-   delete[] mAnalysisMag;
-   delete[] mAnalysisFreq;
-   delete[] mSynthesisMag;
-   delete[] mSynthesisFreq;
-}
-
-#define MY_PITCHSHIFTER 0
-
-#if MY_PITCHSHIFTER
-
-void PitchShifter::Process(float* buffer, int bufferSize)
-{
-   PROFILER(PitchShifter);
-
-   const int osamp = mOversampling;
-   const int stepSize = mFFTBins / osamp;
-   const double expct = 2. * M_PI * (double)stepSize / (double)mFFTBins;
-   const double freqPerBin = gSampleRate / (double)mFFTBins;
-
-   mLatency = mFFTBins - stepSize;
-
-   mRollingInputBuffer.WriteChunk(buffer, bufferSize, 0);
-
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, mFFTBins, latency);
-   Mult(mFFTData.mTimeDomain, mWindower, mFFTBins);
-
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
+   assert(numChannels >= 1 && numChannels <= kMaxChannels);
 
-   const int fftFrameSize2 = mFFTBins / 2;
+   mFullPlan = &FFTPlan::Get(frameSize);
+   mLowLatencyPlan = &FFTPlan::Get(MAX(frameSize / 4, 64));
 
-   // this is the analysis step
-   for (int k = 0; k <= fftFrameSize2; k++)
+   int numBins = frameSize / 2 + 1;
+   mChannels.resize(numChannels);
+   for (auto& channel : mChannels)
    {
-      // de-interlace FFT buffer
-      float real = mFFTData.mRealValues[k];
-      float imag = mFFTData.mImaginaryValues[k];
-
-      // compute magnitude and phase
-      double mag = 2. * sqrt(real * real + imag * imag);
-      double phase = atan2(imag, real);
-
-      // compute phase difference
-      double diff = phase - mLastPhase[k];
-      mLastPhase[k] = phase;
-
-      // subtract expected phase difference
-      diff -= (double)k * expct;
-
-      // map delta phase into +/- Pi interval
-      long qpd = diff / M_PI;
-      if (qpd >= 0)
-         qpd += qpd & 1;
-      else
-         qpd -= qpd & 1;
-      diff -= M_PI * (double)qpd;
-
-      // get deviation from bin frequency from the +/- Pi interval
-      double deviation = osamp * diff / (2. * M_PI);
-
-      // compute the k-th partials' true frequency
-      double freq = (double)k * freqPerBin + deviation * freqPerBin;
-
-      // store magnitude and true frequency in analysis arrays
-      mAnalysisMag[k] = mag;
-      mAnalysisFreq[k] = freq;
+      channel.mInFIFO.resize(frameSize);
+      channel.mOutFIFO.resize(frameSize);
+      channel.mOutputAccum.resize(frameSize * 2);
+      channel.mRe.resize(numBins);
+      channel.mIm.resize(numBins);
+      channel.mSynthesisRe.resize(numBins);
+      channel.mSynthesisIm.resize(numBins);
+      channel.mLastPhase.resize(numBins);
+      channel.mSumPhase.resize(numBins);
    }
+   mAnalysisPhase.resize(numBins);
+   mAnalysisFreq.resize(numBins);
+   mSynthesisFreq.resize(numBins);
+   mTimeDomain.resize(frameSize);
+   mScratch.resize(mFullPlan->GetScratchSize());
 
-   // this does the actual pitch shifting
-   memset(mSynthesisMag, 0, mFFTBins * sizeof(float));
-   memset(mSynthesisFreq, 0, mFFTBins * sizeof(float));
-   for (int k = 0; k <= fftFrameSize2; k++)
-   {
-      int index = k * mRatio;
-      if (index <= fftFrameSize2)
-      {
-         mSynthesisMag[index] += mAnalysisMag[k];
-         mSynthesisFreq[index] = mAnalysisFreq[k] * mRatio;
-      }
-   }
-
-   // this is the synthesis step
-   for (int k = 0; k <= fftFrameSize2; k++)
-   {
-      // get magnitude and true frequency from synthesis arrays
-      double mag = mSynthesisMag[k];
-      double tmp = mSynthesisFreq[k];
-
-      // subtract bin mid frequency
-      tmp -= (double)k * freqPerBin;
-
-      // get bin deviation from freq deviation
-      tmp /= freqPerBin;
+   UpdateFrameSize(frameSize);
+}
 
-      // take osamp into account
-      tmp = 2. * M_PI * tmp / osamp;
+void PitchShifter::SetOversampling(int oversampling)
+{
+   if (oversampling == mOversampling)
+      return;
+   mOversampling = oversampling;
+   UpdateFrameSize(mFrameSize);
+}
 
-      // add the overlap phase advance back in
-      tmp += (double)k * expct;
+void PitchShifter::SetLowLatency(bool lowLatency)
+{
+   const FFTPlan* plan = lowLatency ? mLowLatencyPlan : mFullPlan;
+   if (plan != mPlan)
+      UpdateFrameSize(plan->GetSize());
+}
 
-      // accumulate delta phase to get bin phase
-      mSumPhase[k] += tmp;
-      double phase = mSumPhase[k];
+void PitchShifter::UpdateFrameSize(int frameSize)
+{
+   mFrameSize = frameSize;
+   mPlan = frameSize == mMaxFrameSize ? mFullPlan : mLowLatencyPlan;
+   mHopSize = MAX(frameSize / mOversampling, 1);
+
+   //each output sample is the sum of frameSize / hopSize frames, windowed twice, and the inverse transform is unnormalized
+   const float* window = mPlan->GetHannWindow();
+   float windowPowerSum = 0;
+   for (int i = 0; i < frameSize; ++i)
+      windowPowerSum += window[i] * window[i];
+   mSynthesisScale = kLegacyGain / (frameSize * windowPowerSum / mHopSize);
+
+   Clear();
+}
 
-      // get real and imag part and re-interleave
-      mFFTData.mRealValues[k + 1] = mag * cos(phase);
-      mFFTData.mImaginaryValues[k + 1] = mag * sin(phase);
+void PitchShifter::Clear()
+{
+   for (auto& channel : mChannels)
+   {
+      std::fill(channel.mInFIFO.begin(), channel.mInFIFO.end(), 0.0f);
+      std::fill(channel.mOutFIFO.begin(), channel.mOutFIFO.end(), 0.0f);
+      std::fill(channel.mOutputAccum.begin(), channel.mOutputAccum.end(), 0.0f);
+      std::fill(channel.mLastPhase.begin(), channel.mLastPhase.end(), 0.0f);
+      std::fill(channel.mSumPhase.begin(), channel.mSumPhase.end(), 0.0f);
    }
-
-   mFFT.Inverse(mFFTData.mRealValues,
-                mFFTData.mImaginaryValues,
-                mFFTData.mTimeDomain);
-
-   for (int i = 0; i < bufferSize; ++i)
-      mRollingOutputBuffer.Write(0);
-
-   //copy rolling input buffer into working buffer and window it
-   for (int i = 0; i < mFFTBins; ++i)
-      mRollingOutputBuffer.Accum(mFFTBins - i, mFFTData.mTimeDomain[i] * mWindower[i] * .0001f);
-
-   for (int i = 0; i < bufferSize; ++i)
-      buffer[i] = mRollingOutputBuffer.GetSample(latency - i);
+   mRover = GetLatency();
 }
 
-#else
-
-void smbFft(float* fftBuffer, long fftFrameSize, long sign)
-/*
-	FFT routine, (C)1996 S.M.Bernsee. Sign = -1 is FFT, 1 is iFFT (inverse)
-	Fills fftBuffer[0...2*fftFrameSize-1] with the Fourier transform of the
-	time domain data in fftBuffer[0...2*fftFrameSize-1]. The FFT array takes
-	and returns the cosine and sine parts in an interleaved manner, ie.
-	fftBuffer[0] = cosPart[0], fftBuffer[1] = sinPart[0], asf. fftFrameSize
-	must be a power of 2. It expects a complex input signal (see footnote 2),
-	ie. when working with 'common' audio signals our input signal has to be
-	passed as {in[0],0.,in[1],0.,in[2],0.,...} asf. In that case, the transform
-	of the frequencies of interest is in fftBuffer[0...fftFrameSize].
- */
+void PitchShifter::Process(float* const* channels, int numChannels, int bufferSize)
 {
-   float wr, wi, arg, *p1, *p2, temp;
-   float tr, ti, ur, ui, *p1r, *p1i, *p2r, *p2i;
-   long i, bitm, j, le, le2, k;
+   PROFILER(PitchShifter);
+
+   numChannels = MIN(numChannels, (int)mChannels.size());
+   const int latency = GetLatency();
 
-   for (i = 2; i < 2 * fftFrameSize - 2; i += 2)
+   //fill the input fifo and drain the output fifo until a frame is ready, a run at a time
+   int i = 0;
+   while (i < bufferSize)
    {
-      for (bitm = 2, j = 0; bitm < 2 * fftFrameSize; bitm <<= 1)
-      {
-         if (i & bitm)
-            j++;
-         j <<= 1;
-      }
-      if (i < j)
+      int run = MIN(bufferSize - i, mFrameSize - mRover);
+      for (int ch = 0; ch < numChannels; ++ch)
       {
-         p1 = fftBuffer + i;
-         p2 = fftBuffer + j;
-         temp = *p1;
-         *(p1++) = *p2;
-         *(p2++) = temp;
-         temp = *p1;
-         *p1 = *p2;
-         *p2 = temp;
+         Channel& channel = mChannels[ch];
+         BufferCopy(channel.mInFIFO.data() + mRover, channels[ch] + i, run);
+         BufferCopy(channels[ch] + i, channel.mOutFIFO.data() + mRover - latency, run);
       }
-   }
-   for (k = 0, le = 2; k < (long)(log(fftFrameSize) / log(2.) + .5); k++)
-   {
-      le <<= 1;
-      le2 = le >> 1;
-      ur = 1.0;
-      ui = 0.0;
-      arg = M_PI / (le2 >> 1);
-      wr = cos(arg);
-      wi = sign * sin(arg);
-      for (j = 0; j < le2; j += 2)
+      mRover += run;
+      i += run;
+
+      if (mRover >= mFrameSize)
       {
-         p1r = fftBuffer + j;
-         p1i = p1r + 1;
-         p2r = p1r + le2;
-         p2i = p2r + 1;
-         for (i = j; i < 2 * fftFrameSize; i += le)
-         {
-            tr = *p2r * ur - *p2i * ui;
-            ti = *p2r * ui + *p2i * ur;
-            *p2r = *p1r - tr;
-            *p2i = *p1i - ti;
-            *p1r += tr;
-            *p1i += ti;
-            p1r += le;
-            p1i += le;
-            p2r += le;
-            p2i += le;
-         }
-         tr = ur * wr - ui * wi;
-         ui = ur * wi + ui * wr;
-         ur = tr;
+         mRover = latency;
+         ProcessFrame(numChannels);
       }
    }
 }
 
-/****************************************************************************
- *
- * NAME: smbPitchShift.cpp
- * VERSION: 1.2
- * HOME URL: http://blogs.zynaptiq.com/bernsee
- * KNOWN BUGS: none
- *
- * SYNOPSIS: Routine for doing pitch shifting while maintaining
- * duration using the Short Time Fourier Transform.
- *
- * DESCRIPTION: The routine takes a pitchShift factor value which is between 0.5
- * (one octave down) and 2. (one octave up). A value of exactly 1 does not change
- * the pitch. numSampsToProcess tells the routine how many samples in indata[0...
- * numSampsToProcess-1] should be pitch shifted and moved to outdata[0 ...
- * numSampsToProcess-1]. The two buffers can be identical (ie. it can process the
- * data in-place). fftFrameSize defines the FFT frame size used for the
- * processing. Typical values are 1024, 2048 and 4096. It may be any value <=
- * MAX_FRAME_LENGTH but it MUST be a power of 2. osamp is the STFT
- * oversampling factor which also determines the overlap between adjacent STFT
- * frames. It should at least be 4 for moderate scaling ratios. A value of 32 is
- * recommended for best quality. sampleRate takes the sample rate for the signal
- * in unit Hz, ie. 44100 for 44.1 kHz audio. The data passed to the routine in
- * indata[] should be in the range [-1.0, 1.0), which is also the output range
- * for the data, make sure you scale the data accordingly (for 16bit signed integers
- * you would have to divide (and multiply) by 32768).
- *
- * COPYRIGHT 1999-2015 Stephan M. Bernsee <s.bernsee [AT] zynaptiq [DOT] com>
- *
- * 						The Wide Open License (WOL)
- *
- * Permission to use, copy, modify, distribute and sell this software and its
- * documentation for any purpose is hereby granted without fee, provided that
- * the above copyright notice and this license appear in all source copies.
- * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY OF
- * ANY KIND. See http://www.dspguru.com/wol.htm for more information.
- *
- *****************************************************************************/
-
-void PitchShifter::Process(float* buffer, int bufferSize)
+void PitchShifter::ProcessFrame(int numChannels)
 {
-   PROFILER(PitchShifter);
+   const float* window = mPlan->GetHannWindow();
 
-   const int fftFrameSize = mFFTBins;
-   const int sampleRate = gSampleRate;
-   const int osamp = mOversampling;
-   const int numSampsToProcess = bufferSize;
-   float* indata = buffer;
-   float* outdata = buffer;
-   const float pitchShift = mRatio;
-
-   double magn, phase, tmp, window, real, imag;
-   double freqPerBin, expct;
-   long i, k, qpd, index, inFifoLatency, stepSize, fftFrameSize2;
-
-   /* set up some handy variables */
-   fftFrameSize2 = fftFrameSize / 2;
-   stepSize = fftFrameSize / osamp;
-   freqPerBin = sampleRate / (double)fftFrameSize;
-   expct = 2. * M_PI * (double)stepSize / (double)fftFrameSize;
-   inFifoLatency = fftFrameSize - stepSize;
-   if (gRover == false)
-      gRover = inFifoLatency;
-
-   mLatency = inFifoLatency;
-
-   /* initialize our static arrays */
-   if (gInit == false)
+   for (int ch = 0; ch < numChannels; ++ch)
    {
-      memset(gInFIFO, 0, MAX_FRAME_LENGTH * sizeof(float));
-      memset(gOutFIFO, 0, MAX_FRAME_LENGTH * sizeof(float));
-      memset(gFFTworksp, 0, 2 * MAX_FRAME_LENGTH * sizeof(float));
-      memset(gLastPhase, 0, (MAX_FRAME_LENGTH / 2 + 1) * sizeof(float));
-      memset(gSumPhase, 0, (MAX_FRAME_LENGTH / 2 + 1) * sizeof(float));
-      memset(gOutputAccum, 0, 2 * MAX_FRAME_LENGTH * sizeof(float));
-      memset(gAnaFreq, 0, MAX_FRAME_LENGTH * sizeof(float));
-      memset(gAnaMagn, 0, MAX_FRAME_LENGTH * sizeof(float));
-      gInit = true;
+      Channel& channel = mChannels[ch];
+      BufferCopy(mTimeDomain.data(), channel.mInFIFO.data(), mFrameSize);
+      Mult(mTimeDomain.data(), window, mFrameSize);
+      mPlan->Forward(mTimeDomain.data(), channel.mRe.data(), channel.mIm.data(), mScratch.data());
    }
 
-   /* main processing loop */
-   for (i = 0; i < numSampsToProcess; i++)
+   if (mLinked)
    {
-      /* As long as we have not yet collected enough data just read in */
-      gInFIFO[gRover] = indata[i];
-      outdata[i] = gOutFIFO[gRover - inFifoLatency];
-      gRover++;
-
-      /* now we have enough data for processing */
-      if (gRover >= fftFrameSize)
-      {
-         gRover = inFifoLatency;
-
-         /* do windowing and re,im interleave */
-         for (k = 0; k < fftFrameSize; k++)
-         {
-            window = -.5 * cos(2. * M_PI * (double)k / (double)fftFrameSize) + .5;
-            gFFTworksp[2 * k] = gInFIFO[k] * window;
-            gFFTworksp[2 * k + 1] = 0.;
-         }
-
+      ShiftGroup(0, numChannels);
+   }
+   else
+   {
+      for (int ch = 0; ch < numChannels; ++ch)
+         ShiftGroup(ch, 1);
+   }
 
-         /* ***************** ANALYSIS ******************* */
-         /* do transform */
-         smbFft(gFFTworksp, fftFrameSize, -1);
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      Channel& channel = mChannels[ch];
+      mPlan->Inverse(channel.mSynthesisRe.data(), channel.mSynthesisIm.data(), mTimeDomain.data(), mScratch.data());
+      Mult(mTimeDomain.data(), window, mFrameSize);
+      AddWithGain(channel.mOutputAccum.data(), mTimeDomain.data(), mSynthesisScale, mFrameSize);
+
+      BufferCopy(channel.mOutFIFO.data(), channel.mOutputAccum.data(), mHopSize);
+      memmove(channel.mOutputAccum.data(), channel.mOutputAccum.data() + mHopSize, mFrameSize * sizeof(float));
+      memmove(channel.mInFIFO.data(), channel.mInFIFO.data() + mHopSize, (mFrameSize - mHopSize) * sizeof(float));
+   }
+}
 
-         /* this is the analysis step */
-         for (k = 0; k <= fftFrameSize2; k++)
-         {
-            /* de-interlace FFT buffer */
-            real = gFFTworksp[2 * k];
-            imag = gFFTworksp[2 * k + 1];
-
-            /* compute magnitude and phase */
-            magn = 2. * sqrt(real * real + imag * imag);
-            phase = atan2(imag, real);
-
-            /* compute phase difference */
-            tmp = phase - gLastPhase[k];
-            gLastPhase[k] = phase;
-
-            /* subtract expected phase difference */
-            tmp -= (double)k * expct;
-
-            /* map delta phase into +/- Pi interval */
-            qpd = tmp / M_PI;
-            if (qpd >= 0)
-               qpd += qpd & 1;
-            else
-               qpd -= qpd & 1;
-            tmp -= M_PI * (double)qpd;
-
-            /* get deviation from bin frequency from the +/- Pi interval */
-            tmp = osamp * tmp / (2. * M_PI);
-
-            /* compute the k-th partials' true frequency */
-            tmp = (double)k * freqPerBin + tmp * freqPerBin;
-
-            /* store magnitude and true frequency in analysis arrays */
-            gAnaMagn[k] = magn;
-            gAnaFreq[k] = tmp;
-         }
+void PitchShifter::ShiftGroup(int firstChannel, int numChannels)
+{
+   const int half = mFrameSize / 2;
+   const float expected = FTWO_PI / mOversampling; //phase advance of bin 1 over one hop
+   Channel& lead = mChannels[firstChannel];
 
-         /* ***************** PROCESSING ******************* */
-         /* this does the actual pitch shifting */
-         memset(gSynMagn, 0, fftFrameSize * sizeof(float));
-         memset(gSynFreq, 0, fftFrameSize * sizeof(float));
-         for (k = 0; k <= fftFrameSize2; k++)
+   //analysis. FFTPlan's imaginary parts are the sine correlation, so the phase is atan2(-im, re).
+   //linked channels are tracked through their sum, unless they mostly cancel out
+   for (int k = 0; k <= half; ++k)
+   {
+      float re = lead.mRe[k];
+      float im = lead.mIm[k];
+      if (numChannels > 1)
+      {
+         float sumRe = 0;
+         float sumIm = 0;
+         float power = 0;
+         for (int ch = firstChannel; ch < firstChannel + numChannels; ++ch)
          {
-            index = k * pitchShift;
-            if (index <= fftFrameSize2)
-            {
-               gSynMagn[index] += gAnaMagn[k];
-               gSynFreq[index] = gAnaFreq[k] * pitchShift;
-            }
+            sumRe += mChannels[ch].mRe[k];
+            sumIm += mChannels[ch].mIm[k];
+            power += mChannels[ch].mRe[k] * mChannels[ch].mRe[k] + mChannels[ch].mIm[k] * mChannels[ch].mIm[k];
          }
-
-         /* ***************** SYNTHESIS ******************* */
-         /* this is the synthesis step */
-         for (k = 0; k <= fftFrameSize2; k++)
+         if (sumRe * sumRe + sumIm * sumIm > .1f * power)
          {
-            /* get magnitude and true frequency from synthesis arrays */
-            magn = gSynMagn[k];
-            tmp = gSynFreq[k];
-
-            /* subtract bin mid frequency */
-            tmp -= (double)k * freqPerBin;
-
-            /* get bin deviation from freq deviation */
-            tmp /= freqPerBin;
-
-            /* take osamp into account */
-            tmp = 2. * M_PI * tmp / osamp;
-
-            /* add the overlap phase advance back in */
-            tmp += (double)k * expct;
-
-            /* accumulate delta phase to get bin phase */
-            gSumPhase[k] += tmp;
-            phase = gSumPhase[k];
-
-            /* get real and imag part and re-interleave */
-            gFFTworksp[2 * k] = magn * cos(phase);
-            gFFTworksp[2 * k + 1] = magn * sin(phase);
+            re = sumRe;
+            im = sumIm;
          }
+      }
 
-         /* zero negative frequencies */
-         for (k = fftFrameSize + 2; k < 2 * fftFrameSize; k++)
-            gFFTworksp[k] = 0.;
-
-         /* do inverse transform */
-         smbFft(gFFTworksp, fftFrameSize, 1);
+      float phase = atan2f(-im, re);
+      float diff = phase - lead.mLastPhase[k] - k * expected;
+      lead.mLastPhase[k] = phase;
+      diff -= FTWO_PI * floorf(diff / FTWO_PI + .5f); //into +/- pi
 
-         /* do windowing and add to output accumulator */
-         for (k = 0; k < fftFrameSize; k++)
-         {
-            window = -.5 * cos(2. * M_PI * (double)k / (double)fftFrameSize) + .5;
-            gOutputAccum[k] += 2. * window * gFFTworksp[2 * k] / (fftFrameSize2 * osamp);
-         }
-         for (k = 0; k < stepSize; k++)
-            gOutFIFO[k] = gOutputAccum[k];
+      mAnalysisPhase[k] = phase;
+      mAnalysisFreq[k] = k + diff * mOversampling / FTWO_PI;
+   }
 
-         /* shift accumulator */
-         memmove(gOutputAccum, gOutputAccum + stepSize, fftFrameSize * sizeof(float));
+   //move each bin's partial to its new frequency, and advance the synthesis phases
+   std::fill(mSynthesisFreq.begin(), mSynthesisFreq.begin() + half + 1, 0.0f);
+   for (int k = 0; k <= half; ++k)
+   {
+      int index = int(k * mRatio);
+      if (index <= half)
+         mSynthesisFreq[index] = mAnalysisFreq[k] * mRatio;
+   }
+   for (int k = 0; k <= half; ++k)
+   {
+      float sumPhase = lead.mSumPhase[k] + mSynthesisFreq[k] * expected;
+      lead.mSumPhase[k] = sumPhase - FTWO_PI * floorf(sumPhase / FTWO_PI);
+   }
 
-         /* move input FIFO */
-         for (k = 0; k < inFifoLatency; k++)
-            gInFIFO[k] = gInFIFO[k + stepSize];
+   //synthesis. every channel's bin is rotated by the same amount, from the tracked phase to the synthesis phase,
+   //which keeps each channel's own magnitude and its phase relative to the others
+   for (int ch = firstChannel; ch < firstChannel + numChannels; ++ch)
+   {
+      std::fill(mChannels[ch].mSynthesisRe.begin(), mChannels[ch].mSynthesisRe.begin() + half + 1, 0.0f);
+      std::fill(mChannels[ch].mSynthesisIm.begin(), mChannels[ch].mSynthesisIm.begin() + half + 1, 0.0f);
+   }
+   for (int k = 0; k <= half; ++k)
+   {
+      int index = int(k * mRatio);
+      if (index > half)
+         break;
+
+      float rotation = lead.mSumPhase[index] - mAnalysisPhase[k];
+      float rotRe = cosf(rotation);
+      float rotIm = -sinf(rotation); //in FFTPlan's convention
+      for (int ch = firstChannel; ch < firstChannel + numChannels; ++ch)
+      {
+         Channel& channel = mChannels[ch];
+         float re = channel.mRe[k];
+         float im = channel.mIm[k];
+         channel.mSynthesisRe[index] += re * rotRe - im * rotIm;
+         channel.mSynthesisIm[index] += re * rotIm + im * rotRe;
       }
    }
+   for (int ch = firstChannel; ch < firstChannel + numChannels; ++ch)
+   {
+      mChannels[ch].mSynthesisIm[0] = 0;
+      mChannels[ch].mSynthesisIm[half] = 0;
+   }
 }
-
-#endif
@@ -23,55 +23,67 @@
 //
 //
 
+#pragma once
 #pragma once
 
 #include "FFT.h"
-#include "RollingBuffer.h"
 
-#define MAX_FRAME_LENGTH 8192
+#include <vector>
 
+//phase vocoder pitch shifter.
+//channels processed in the same call share one phase analysis when linked, so stereo keeps its image and
+//only pays for the extra forward/inverse transforms. low latency mode runs on frames a quarter of the size
 class PitchShifter
 {
 public:
-   PitchShifter(int fftBins);
-   virtual ~PitchShifter();
+   static const int kMaxChannels = 2;
+
+   PitchShifter(int frameSize, int numChannels = 1);
 
-   void Process(float* buffer, int bufferSize);
+   void Process(float* buffer, int bufferSize) { Process(&buffer, 1, bufferSize); }
+   void Process(float* const* channels, int numChannels, int bufferSize);
    void SetRatio(float ratio) { mRatio = ratio; }
-   void SetOversampling(int oversampling) { mOversampling = oversampling; }
-   int GetLatency() const { return mLatency; }
+   void SetOversampling(int oversampling);
+   void SetLowLatency(bool lowLatency);
+   bool IsLowLatency() const { return mFrameSize != mMaxFrameSize; }
+   void SetLinked(bool linked) { mLinked = linked; }
+   int GetLatency() const { return mFrameSize - mHopSize; } //in samples
+   void Clear();
 
 private:
-   int mFFTBins;
-
-   FFTData mFFTData;
+   struct Channel
+   {
+      std::vector<float> mInFIFO;
+      std::vector<float> mOutFIFO;
+      std::vector<float> mOutputAccum;
+      std::vector<float> mRe;
+      std::vector<float> mIm;
+      std::vector<float> mSynthesisRe;
+      std::vector<float> mSynthesisIm;
+      std::vector<float> mLastPhase; //analysis and synthesis phase, only used on the first channel of a linked group
+      std::vector<float> mSumPhase;
+   };
 
-   float* mLastPhase{ nullptr };
-   float* mSumPhase{ nullptr };
-   float* mWindower{ nullptr };
-   float* mAnalysisMag{ nullptr };
-   float* mAnalysisFreq{ nullptr };
-   float* mSynthesisMag{ nullptr };
-   float* mSynthesisFreq{ nullptr };
+   void UpdateFrameSize(int frameSize);
+   void ProcessFrame(int numChannels);
+   void ShiftGroup(int firstChannel, int numChannels);
 
-   ::FFT mFFT;
-   RollingBuffer mRollingInputBuffer;
-   RollingBuffer mRollingOutputBuffer;
-
-   float mRatio{ 1 };
+   int mMaxFrameSize{ 0 };
+   int mFrameSize{ 0 };
+   int mHopSize{ 0 };
    int mOversampling{ 4 };
-   float mLatency{ 0 };
+   int mRover{ 0 };
+   float mRatio{ 1 };
+   bool mLinked{ true };
+   float mSynthesisScale{ 1 };
+   const FFTPlan* mPlan{ nullptr };
+   const FFTPlan* mFullPlan{ nullptr };
+   const FFTPlan* mLowLatencyPlan{ nullptr };
 
-   float gInFIFO[MAX_FRAME_LENGTH]{};
-   float gOutFIFO[MAX_FRAME_LENGTH]{};
-   float gFFTworksp[2 * MAX_FRAME_LENGTH]{};
-   float gLastPhase[MAX_FRAME_LENGTH / 2 + 1]{};
-   float gSumPhase[MAX_FRAME_LENGTH / 2 + 1]{};
-   float gOutputAccum[2 * MAX_FRAME_LENGTH]{};
-   float gAnaFreq[MAX_FRAME_LENGTH]{};
-   float gAnaMagn[MAX_FRAME_LENGTH]{};
-   float gSynFreq[MAX_FRAME_LENGTH]{};
-   float gSynMagn[MAX_FRAME_LENGTH]{};
-   long gRover{ false };
-   long gInit{ false };
+   std::vector<Channel> mChannels;
+   std::vector<float> mAnalysisPhase;
+   std::vector<float> mAnalysisFreq; //in bins
+   std::vector<float> mSynthesisFreq;
+   std::vector<float> mTimeDomain;
+   std::vector<float> mScratch;
 };
@@ -0,0 +1,268 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    PitchTracker.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "PitchTracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+   const float kSilenceMeanSquare = 1e-10f; //-100dB
+   const float kPeakThreshold = .9f; //how close to the highest peak the chosen one has to be
+   const int kMaxEstimatesPerBlock = 64;
+}
+
+PitchTracker::PitchTracker(int windowSize /*= 1024*/, int hopSize /*= 256*/)
+: mWindowSize(windowSize)
+, mHopSize(hopSize)
+, mMaxPeriod(windowSize / 2)
+, mPlan(FFTPlan::Get(windowSize * 2))
+{
+   mRing.resize(windowSize);
+   mFrame.resize(windowSize * 2);
+   mRe.resize(windowSize + 1);
+   mIm.resize(windowSize + 1);
+   mNsdf.resize(windowSize);
+   mScratch.resize(mPlan.GetScratchSize());
+   mBlockEstimates.reserve(kMaxEstimatesPerBlock);
+
+   Clear();
+}
+
+void PitchTracker::SetPeriodRange(float minPeriod, float maxPeriod)
+{
+   mMinPeriod = MAX(minPeriod, 2);
+   mMaxPeriod = MIN(maxPeriod, mWindowSize - 2);
+}
+
+void PitchTracker::Clear()
+{
+   std::fill(mRing.begin(), mRing.end(), 0.0f);
+   mPos = 0;
+   mSamplesUntilHop = mHopSize;
+   mEnergy = 0;
+   mPreviousEstimate = Estimate();
+   mBlockEstimates.clear();
+}
+
+const PitchTracker::Estimate& PitchTracker::GetEstimate(int offset /*= INT_MAX*/) const
+{
+   const Estimate* estimate = &mPreviousEstimate;
+   for (const auto& blockEstimate : mBlockEstimates)
+   {
+      if (blockEstimate.mOffset > offset)
+         break;
+      estimate = &blockEstimate.mEstimate;
+   }
+   return *estimate;
+}
+
+void PitchTracker::Process(const float* input, int bufferSize)
+{
+   if (!mBlockEstimates.empty())
+      mPreviousEstimate = mBlockEstimates.back().mEstimate;
+   mBlockEstimates.clear();
+
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      float oldest = mRing[mPos];
+      mEnergy += input[i] * input[i] - oldest * oldest;
+      mRing[mPos] = input[i];
+      mPos = (mPos + 1) % mWindowSize;
+
+      if (--mSamplesUntilHop == 0)
+      {
+         mSamplesUntilHop = mHopSize;
+         if ((int)mBlockEstimates.size() == kMaxEstimatesPerBlock)
+            mBlockEstimates.pop_back();
+         mBlockEstimates.push_back({ i + 1, Analyze() });
+      }
+   }
+}
+
+PitchTracker::Estimate PitchTracker::Analyze()
+{
+   Estimate estimate;
+
+   if (mEnergy < kSilenceMeanSquare * mWindowSize)
+      return estimate;
+
+   //unroll the ring oldest-first, zero padded to the transform size
+   int firstRun = mWindowSize - mPos;
+   BufferCopy(mFrame.data(), mRing.data() + mPos, firstRun);
+   BufferCopy(mFrame.data() + firstRun, mRing.data(), mPos);
+   ::Clear(mFrame.data() + mWindowSize, mWindowSize);
+
+   //recompute the energy exactly every so often, so the running sum doesn't drift
+   double energy = 0;
+   for (int i = 0; i < mWindowSize; ++i)
+      energy += mFrame[i] * mFrame[i];
+   mEnergy = energy;
+
+   //autocorrelation is the inverse transform of the power spectrum
+   mPlan.Forward(mFrame.data(), mRe.data(), mIm.data(), mScratch.data());
+   for (int k = 0; k <= mWindowSize; ++k)
+   {
+      mRe[k] = mRe[k] * mRe[k] + mIm[k] * mIm[k];
+      mIm[k] = 0;
+   }
+   std::vector<float>& acf = mFrame;
+   mPlan.Inverse(mRe.data(), mIm.data(), acf.data(), mScratch.data());
+
+   //normalized square difference, nsdf(tau) = 2 * r(tau) / sum(x[j]^2 + x[j+tau]^2).
+   //the denominator is built up incrementally from the autocorrelation at lag 0. mRing hasn't changed, read it again for the squares
+   int maxTau = MIN((int)mMaxPeriod + 1, mWindowSize - 1);
+   float acfScale = 1.0f / (mWindowSize * 2); //the inverse transform is unnormalized
+   double m = 2 * energy;
+   for (int tau = 0; tau <= maxTau; ++tau)
+   {
+      if (tau > 0)
+      {
+         float a = mRing[(mPos + tau - 1) % mWindowSize];
+         float b = mRing[(mPos + mWindowSize - tau) % mWindowSize];
+         m -= a * a + b * b;
+      }
+      mNsdf[tau] = m > 0 ? float(2 * acf[tau] * acfScale / m) : 0;
+   }
+
+   //key maxima: the highest point of each positive lobe after the first negative crossing
+   int bestTau = -1;
+   float highest = 0;
+   int keyMaxima[64];
+   int numKeyMaxima = 0;
+   int tau = 1;
+   while (tau <= maxTau && mNsdf[tau] > 0)
+      ++tau;
+   while (tau <= maxTau)
+   {
+      while (tau <= maxTau && mNsdf[tau] <= 0)
+         ++tau;
+      int lobeMax = -1;
+      while (tau <= maxTau && mNsdf[tau] > 0)
+      {
+         if (tau >= mMinPeriod && (lobeMax == -1 || mNsdf[tau] > mNsdf[lobeMax]))
+            lobeMax = tau;
+         ++tau;
+      }
+      if (lobeMax > 0 && lobeMax < maxTau && lobeMax <= mMaxPeriod && numKeyMaxima < 64)
+      {
+         keyMaxima[numKeyMaxima++] = lobeMax;
+         highest = MAX(highest, mNsdf[lobeMax]);
+      }
+   }
+   for (int i = 0; i < numKeyMaxima; ++i)
+   {
+      if (mNsdf[keyMaxima[i]] >= highest * kPeakThreshold)
+      {
+         bestTau = keyMaxima[i];
+         break;
+      }
+   }
+   if (bestTau == -1)
+      return estimate;
+
+   //parabolic interpolation around the peak
+   float left = mNsdf[bestTau - 1];
+   float center = mNsdf[bestTau];
+   float right = mNsdf[bestTau + 1];
+   float denominator = left - 2 * center + right;
+   float shift = denominator < 0 ? .5f * (left - right) / denominator : 0;
+   estimate.mPeriod = bestTau + shift;
+   estimate.mConfidence = MIN(center - .25f * (left - right) * shift, 1);
+   return estimate;
+}
+
+PitchTrackerPool& PitchTrackerPool::Get()
+{
+   static PitchTrackerPool sPool;
+   return sPool;
+}
+
+std::shared_ptr<PitchTracker> PitchTrackerPool::Track(std::shared_ptr<PitchTracker> tracker, double time, const float* input, int bufferSize)
+{
+   //fnv-1a over the raw samples
+   uint64_t hash = 14695981039346656037ull;
+   bool silent = true;
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      uint32_t bits;
+      memcpy(&bits, &input[i], sizeof(bits));
+      hash = (hash ^ bits) * 1099511628211ull;
+      silent = silent && input[i] == 0;
+   }
+   hash = (hash ^ (uint64_t)bufferSize) * 1099511628211ull;
+
+   std::unique_lock<std::mutex> lock(mMutex);
+
+   mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(), [time](const Entry& entry)
+                                 { return entry.mTime != time; }),
+                  mEntries.end());
+
+   if (tracker != nullptr && tracker->mLastTime == time)
+   {
+      if (tracker->mLastHash == hash)
+      {
+         //a partner already fed this tracker the same audio. wait for it to finish
+         lock.unlock();
+         std::lock_guard<std::mutex> trackerLock(tracker->mMutex);
+         return tracker;
+      }
+      tracker = nullptr; //our input no longer matches our partners'
+   }
+
+   //silence is identical everywhere, so it's no sign that two consumers are listening to the same thing
+   if (!silent)
+   {
+      for (const auto& entry : mEntries)
+      {
+         if (entry.mHash == hash)
+         {
+            std::shared_ptr<PitchTracker> shared = entry.mTracker;
+            lock.unlock();
+            std::lock_guard<std::mutex> trackerLock(shared->mMutex);
+            return shared;
+         }
+      }
+   }
+
+   if (tracker == nullptr)
+   {
+      tracker = std::make_shared<PitchTracker>(); //only when consumers are added or split apart
+      tracker->SetPeriodRange(gSampleRate / kMaxFrequency, gSampleRate / kMinFrequency);
+   }
+
+   //hold the tracker while it processes, so partners that find it wait for the result
+   std::lock_guard<std::mutex> trackerLock(tracker->mMutex);
+   tracker->mLastTime = time;
+   tracker->mLastHash = hash;
+   if (!silent)
+      mEntries.push_back({ time, hash, tracker });
+   lock.unlock();
+
+   tracker->Process(input, bufferSize);
+   return tracker;
+}
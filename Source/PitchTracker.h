@@ -0,0 +1,124 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    PitchTracker.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FFT.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//monophonic pitch tracking with the mcleod pitch method: the normalized square difference of a sliding window is computed from an
+//fft autocorrelation every hop, and the first peak close to the highest one is taken as the period.
+//the window's energy is kept up to date sample by sample, so silent input skips the analysis
+class PitchTracker
+{
+public:
+   struct Estimate
+   {
+      float mPeriod{ 0 }; //in samples, 0 if nothing periodic was found
+      float mConfidence{ 0 }; //normalized correlation at the period, 1 for a perfectly periodic signal
+   };
+
+   PitchTracker(int windowSize = 1024, int hopSize = 256);
+
+   void SetPeriodRange(float minPeriod, float maxPeriod); //in samples
+   int GetWindowSize() const { return mWindowSize; }
+   int GetHopSize() const { return mHopSize; }
+
+   void Process(const float* input, int bufferSize);
+   void Clear();
+
+   //the latest estimate made at or before offset into the last processed block
+   const Estimate& GetEstimate(int offset = std::numeric_limits<int>::max()) const;
+
+private:
+   friend class PitchTrackerPool;
+
+   Estimate Analyze();
+
+   int mWindowSize{ 0 };
+   int mHopSize{ 0 };
+   float mMinPeriod{ 2 };
+   float mMaxPeriod{ 0 };
+   const FFTPlan& mPlan; //twice the window size, so the autocorrelation doesn't wrap
+
+   std::vector<float> mRing; //the last windowSize samples, oldest at mPos
+   int mPos{ 0 };
+   int mSamplesUntilHop{ 0 };
+   double mEnergy{ 0 };
+
+   std::vector<float> mFrame;
+   std::vector<float> mRe;
+   std::vector<float> mIm;
+   std::vector<float> mNsdf;
+   std::vector<float> mScratch;
+
+   struct BlockEstimate
+   {
+      int mOffset;
+      Estimate mEstimate;
+   };
+   Estimate mPreviousEstimate; //from before the last block
+   std::vector<BlockEstimate> mBlockEstimates;
+
+   //for PitchTrackerPool
+   std::mutex mMutex;
+   double mLastTime{ -1 };
+   uint64_t mLastHash{ 0 };
+};
+
+//lets consumers that are fed the same audio share one PitchTracker.
+//consumers hand back the tracker they got last time, and get one that has processed this block. if another consumer was already handed
+//a tracker for identical audio this buffer, that one is reused, and a consumer whose input stops matching its partners' splits off
+//onto a new tracker
+class PitchTrackerPool
+{
+public:
+   static PitchTrackerPool& Get();
+
+   std::shared_ptr<PitchTracker> Track(std::shared_ptr<PitchTracker> tracker, double time, const float* input, int bufferSize);
+
+   //the range every pooled tracker listens for, consumers narrow it down themselves
+   static constexpr float kMinFrequency = 60;
+   static constexpr float kMaxFrequency = 2000;
+
+private:
+   PitchTrackerPool() = default;
+
+   struct Entry
+   {
+      double mTime;
+      uint64_t mHash;
+      std::shared_ptr<PitchTracker> mTracker;
+   };
+
+   std::mutex mMutex;
+   std::vector<Entry> mEntries; //trackers handed out for the current buffer
+};
@@ -0,0 +1,864 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    PluginSandbox.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "PluginSandbox.h"
+#include "ModularSynth.h"
+#include "SynthGlobals.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+
+#if BESPOKE_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <semaphore.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+   const int kLoadTimeoutMs = 30000; //some plugins take a long time to scan their content on first load
+   const int kRequestTimeoutMs = 5000;
+
+   //what lives in the shared memory. the host writes a buffer's input, bumps mSubmitted and wakes the helper,
+   //the helper processes it in place and sets mCompleted to match
+   struct SharedBlock
+   {
+      static constexpr uint32_t kMagic = 0x42534258; //"BSBX"
+      static constexpr int kMaxChannels = 64;
+      static constexpr int kMaxBlockSize = 4096;
+      static constexpr int kMaxMidiBytes = 32 * 1024;
+      static constexpr int kMaxParameters = 4096;
+      static constexpr int kMaxParameterChanges = 512;
+
+      struct ParameterChange
+      {
+         int32_t mIndex;
+         float mValue;
+      };
+
+      uint32_t mMagic;
+      std::atomic<uint32_t> mSubmitted;
+      std::atomic<uint32_t> mCompleted;
+      std::atomic<int32_t> mLatencySamples;
+      int32_t mNumChannels;
+      int32_t mNumSamples;
+
+      //transport, for the helper's playhead
+      double mBpm;
+      double mPpqPosition;
+      double mPpqPositionOfLastBarStart;
+      int64_t mTimeInSamples;
+      int32_t mTimeSigNumerator;
+      int32_t mTimeSigDenominator;
+      int32_t mIsPlaying;
+
+      int32_t mNumParameterChanges;
+      ParameterChange mParameterChanges[kMaxParameterChanges];
+      float mParameterValues[kMaxParameters]; //the helper's view of every parameter, after its last block
+
+      int32_t mMidiInBytes;
+      int32_t mMidiOutBytes;
+      uint8_t mMidiIn[kMaxMidiBytes];
+      uint8_t mMidiOut[kMaxMidiBytes];
+
+      float mAudio[kMaxChannels * kMaxBlockSize]; //channel after channel, input on the way in and output on the way out
+
+      float* GetChannel(int channel) { return mAudio + channel * kMaxBlockSize; }
+   };
+
+   static_assert(std::atomic<uint32_t>::is_always_lock_free, "the shared block needs address-free atomics");
+
+   //midi events are packed as [sample position][size][bytes]
+   int WriteMidi(const juce::MidiBuffer& midi, uint8_t* dest, int capacity)
+   {
+      int bytes = 0;
+      for (const auto metadata : midi)
+      {
+         int32_t header[2] = { metadata.samplePosition, metadata.numBytes };
+         if (bytes + (int)sizeof(header) + metadata.numBytes > capacity)
+            break;
+         memcpy(dest + bytes, header, sizeof(header));
+         memcpy(dest + bytes + sizeof(header), metadata.data, metadata.numBytes);
+         bytes += sizeof(header) + metadata.numBytes;
+      }
+      return bytes;
+   }
+
+   void ReadMidi(const uint8_t* source, int bytes, juce::MidiBuffer& midi)
+   {
+      int position = 0;
+      while (position + 2 * (int)sizeof(int32_t) <= bytes)
+      {
+         int32_t header[2];
+         memcpy(header, source + position, sizeof(header));
+         position += sizeof(header);
+         if (header[1] <= 0 || position + header[1] > bytes)
+            break;
+         midi.addEvent(source + position, header[1], header[0]);
+         position += header[1];
+      }
+   }
+
+   //wakes the helper's audio thread. only the helper ever waits on it
+   class SharedSemaphore
+   {
+   public:
+      ~SharedSemaphore()
+      {
+#if BESPOKE_WINDOWS
+         if (mHandle != nullptr)
+            CloseHandle(mHandle);
+#else
+         if (mSemaphore != SEM_FAILED)
+            sem_close(mSemaphore);
+         if (mOwner)
+            sem_unlink(mName.toRawUTF8());
+#endif
+      }
+
+      bool Create(const juce::String& name)
+      {
+#if BESPOKE_WINDOWS
+         mHandle = CreateSemaphoreW(nullptr, 0, 1 << 30, name.toWideCharPointer());
+         return mHandle != nullptr;
+#else
+         mName = name;
+         mSemaphore = sem_open(name.toRawUTF8(), O_CREAT | O_EXCL, 0600, 0);
+         mOwner = mSemaphore != SEM_FAILED;
+         return mOwner;
+#endif
+      }
+
+      bool Open(const juce::String& name)
+      {
+#if BESPOKE_WINDOWS
+         mHandle = OpenSemaphoreW(SEMAPHORE_ALL_ACCESS, FALSE, name.toWideCharPointer());
+         return mHandle != nullptr;
+#else
+         mName = name;
+         mSemaphore = sem_open(name.toRawUTF8(), 0);
+         return mSemaphore != SEM_FAILED;
+#endif
+      }
+
+      void Post()
+      {
+#if BESPOKE_WINDOWS
+         ReleaseSemaphore(mHandle, 1, nullptr);
+#else
+         sem_post(mSemaphore);
+#endif
+      }
+
+      void Wait()
+      {
+#if BESPOKE_WINDOWS
+         WaitForSingleObject(mHandle, INFINITE);
+#else
+         while (sem_wait(mSemaphore) != 0 && errno == EINTR)
+         {
+         }
+#endif
+      }
+
+   private:
+#if BESPOKE_WINDOWS
+      HANDLE mHandle{ nullptr };
+#else
+      sem_t* mSemaphore{ SEM_FAILED };
+      juce::String mName;
+      bool mOwner{ false };
+#endif
+   };
+
+   juce::MemoryBlock ToMessage(const juce::var& message)
+   {
+      juce::String json = juce::JSON::toString(message, true);
+      return { json.toRawUTF8(), json.getNumBytesAsUTF8() };
+   }
+
+   juce::var MakeMessage(const juce::String& type)
+   {
+      juce::var message(new juce::DynamicObject());
+      message.getDynamicObject()->setProperty("type", type);
+      return message;
+   }
+
+   juce::File GetSharedMemoryDirectory()
+   {
+      //ram backed where there's one
+      juce::File shm("/dev/shm");
+      if (shm.isDirectory())
+         return shm;
+      return juce::File::getSpecialLocation(juce::File::tempDirectory);
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+   //host side
+
+   class SandboxCoordinator : public juce::ChildProcessCoordinator
+   {
+   public:
+      //one request at a time, from the main thread. returns a void var if the helper didn't answer in time or went away
+      juce::var Request(juce::var message, int timeoutMs)
+      {
+         std::lock_guard<std::mutex> requestLock(mRequestMutex);
+         std::unique_lock<std::mutex> lock(mReplyMutex);
+         int id = ++mLastRequestId;
+         message.getDynamicObject()->setProperty("id", id);
+         mReply = juce::var();
+         if (mConnectionLost || !sendMessageToWorker(ToMessage(message)))
+            return juce::var();
+         mReplyCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&]
+                                  { return mConnectionLost || (int)mReply.getProperty("id", 0) == id; });
+         return (int)mReply.getProperty("id", 0) == id ? mReply : juce::var();
+      }
+
+      void Send(const juce::var& message)
+      {
+         if (!mConnectionLost)
+            sendMessageToWorker(ToMessage(message));
+      }
+
+      bool IsConnectionLost() const { return mConnectionLost; }
+
+   private:
+      void handleMessageFromWorker(const juce::MemoryBlock& mb) override
+      {
+         std::lock_guard<std::mutex> lock(mReplyMutex);
+         mReply = juce::JSON::parse(mb.toString());
+         mReplyCondition.notify_all();
+      }
+
+      void handleConnectionLost() override
+      {
+         std::lock_guard<std::mutex> lock(mReplyMutex);
+         mConnectionLost = true;
+         mReplyCondition.notify_all();
+      }
+
+      std::mutex mRequestMutex;
+      std::mutex mReplyMutex;
+      std::condition_variable mReplyCondition;
+      juce::var mReply;
+      int mLastRequestId{ 0 };
+      std::atomic<bool> mConnectionLost{ false };
+   };
+
+   class SandboxedParameter : public juce::HostedAudioProcessorParameter
+   {
+   public:
+      explicit SandboxedParameter(const juce::var& info)
+      : mName(info["name"].toString())
+      , mID(info["id"].toString())
+      , mLabel(info["label"].toString())
+      , mDefaultValue((float)info["default"])
+      , mNumSteps((int)info["steps"])
+      , mValue((float)info["value"])
+      , mLastReported((float)info["value"])
+      {
+      }
+
+      float getValue() const override { return mValue; }
+      void setValue(float newValue) override
+      {
+         mValue = newValue;
+         mPendingValue = newValue;
+         mHasPendingValue = true;
+      }
+      float getDefaultValue() const override { return mDefaultValue; }
+      juce::String getName(int maximumStringLength) const override { return mName.substring(0, maximumStringLength); }
+      juce::String getLabel() const override { return mLabel; }
+      int getNumSteps() const override { return mNumSteps; }
+      float getValueForText(const juce::String& text) const override { return text.getFloatValue(); }
+      juce::String getParameterID() const override { return mID; }
+
+      //audio thread
+      bool TakePendingValue(float& value)
+      {
+         if (!mHasPendingValue.exchange(false))
+            return false;
+         value = mPendingValue;
+         return true;
+      }
+
+      //audio thread. only takes the helper's value when it changed there, so it doesn't fight values we've just set
+      void UpdateFromHelper(float reported)
+      {
+         if (reported != mLastReported)
+         {
+            mLastReported = reported;
+            if (!mHasPendingValue)
+               mValue = reported;
+         }
+      }
+
+   private:
+      juce::String mName;
+      juce::String mID;
+      juce::String mLabel;
+      float mDefaultValue{ 0 };
+      int mNumSteps{ 0x7fffffff };
+      std::atomic<float> mValue{ 0 };
+      std::atomic<float> mPendingValue{ 0 };
+      std::atomic<bool> mHasPendingValue{ false };
+      float mLastReported{ 0 };
+   };
+
+   class SandboxedPluginInstance : public juce::AudioPluginInstance, private juce::Timer
+   {
+   public:
+      SandboxedPluginInstance(std::unique_ptr<SandboxCoordinator> coordinator, std::unique_ptr<juce::MemoryMappedFile> sharedMemory, juce::File sharedFile,
+                              std::unique_ptr<SharedSemaphore> semaphore, const juce::PluginDescription& desc, const juce::var& info, int bufferSize)
+      : juce::AudioPluginInstance(MakeBuses(info["numInputs"], info["numOutputs"]))
+      , mCoordinator(std::move(coordinator))
+      , mSharedMemory(std::move(sharedMemory))
+      , mSharedFile(sharedFile)
+      , mSemaphore(std::move(semaphore))
+      , mShared(static_cast<SharedBlock*>(mSharedMemory->getData()))
+      , mDesc(desc)
+      , mName(info["name"].toString())
+      , mHasEditor(info["hasEditor"])
+      , mBufferSize(bufferSize)
+      {
+         if (auto* parameters = info["parameters"].getArray())
+         {
+            for (int i = 0; i < parameters->size() && i < SharedBlock::kMaxParameters; ++i)
+            {
+               auto parameter = std::make_unique<SandboxedParameter>((*parameters)[i]);
+               mParameters.push_back(parameter.get());
+               addHostedParameter(std::move(parameter));
+            }
+         }
+         mMidiOut.ensureSize(SharedBlock::kMaxMidiBytes);
+         UpdateLatency();
+         startTimer(250);
+      }
+
+      ~SandboxedPluginInstance() override
+      {
+         stopTimer();
+         mCoordinator.reset(); //kills the helper
+         mSharedMemory.reset();
+         mSharedFile.deleteFile();
+      }
+
+      bool HasCrashed() const { return mCoordinator->IsConnectionLost(); }
+      bool HasEditorInHelper() const { return mHasEditor; }
+      void ShowEditor() { mCoordinator->Send(MakeMessage("showEditor")); }
+
+      //juce::AudioProcessor
+      const juce::String getName() const override { return mName; }
+      void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override
+      {
+         mBufferSize = MIN(maximumExpectedSamplesPerBlock, SharedBlock::kMaxBlockSize);
+         juce::var message = MakeMessage("prepare");
+         message.getDynamicObject()->setProperty("sampleRate", sampleRate);
+         message.getDynamicObject()->setProperty("bufferSize", mBufferSize);
+         mCoordinator->Request(message, kRequestTimeoutMs);
+         UpdateLatency();
+      }
+      void releaseResources() override {}
+      double getTailLengthSeconds() const override { return 0; }
+      bool acceptsMidi() const override { return true; }
+      bool producesMidi() const override { return true; }
+      juce::AudioProcessorEditor* createEditor() override { return nullptr; } //see ShowEditor()
+      bool hasEditor() const override { return false; }
+      int getNumPrograms() override { return 1; }
+      int getCurrentProgram() override { return 0; }
+      void setCurrentProgram(int index) override {}
+      const juce::String getProgramName(int index) override { return {}; }
+      void changeProgramName(int index, const juce::String& newName) override {}
+
+      void getStateInformation(juce::MemoryBlock& destData) override
+      {
+         juce::var reply = mCoordinator->Request(MakeMessage("getState"), kRequestTimeoutMs);
+         destData.reset();
+         destData.fromBase64Encoding(reply["state"].toString());
+      }
+
+      void setStateInformation(const void* data, int sizeInBytes) override
+      {
+         juce::var message = MakeMessage("setState");
+         message.getDynamicObject()->setProperty("state", juce::MemoryBlock(data, sizeInBytes).toBase64Encoding());
+         mCoordinator->Request(message, kRequestTimeoutMs);
+      }
+
+      void fillInPluginDescription(juce::PluginDescription& description) const override { description = mDesc; }
+
+      void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi) override
+      {
+         int numSamples = MIN(buffer.getNumSamples(), SharedBlock::kMaxBlockSize);
+         int numChannels = MIN(buffer.getNumChannels(), SharedBlock::kMaxChannels);
+
+         //the helper is still on the last buffer (or gone). drop this one rather than wait
+         if (HasCrashed() || mShared->mCompleted.load(std::memory_order_acquire) != mSubmitted)
+         {
+            buffer.clear();
+            midi.clear();
+            return;
+         }
+
+         //what the helper made of the previous buffer comes out, this buffer goes in
+         for (int ch = 0; ch < numChannels; ++ch)
+            std::swap_ranges(buffer.getWritePointer(ch), buffer.getWritePointer(ch) + numSamples, mShared->GetChannel(ch));
+         for (int ch = numChannels; ch < buffer.getNumChannels(); ++ch)
+            buffer.clear(ch, 0, buffer.getNumSamples());
+
+         mMidiOut.clear();
+         ReadMidi(mShared->mMidiOut, mShared->mMidiOutBytes, mMidiOut);
+         mShared->mMidiInBytes = WriteMidi(midi, mShared->mMidiIn, SharedBlock::kMaxMidiBytes);
+         midi.swapWith(mMidiOut);
+
+         for (int i = 0; i < (int)mParameters.size(); ++i)
+            mParameters[i]->UpdateFromHelper(mShared->mParameterValues[i]);
+         int numChanges = 0;
+         for (int i = 0; i < (int)mParameters.size() && numChanges < SharedBlock::kMaxParameterChanges; ++i)
+         {
+            float value;
+            if (mParameters[i]->TakePendingValue(value))
+               mShared->mParameterChanges[numChanges++] = { i, value };
+         }
+         mShared->mNumParameterChanges = numChanges;
+
+         juce::AudioPlayHead::CurrentPositionInfo position;
+         if (getPlayHead() != nullptr && getPlayHead()->getCurrentPosition(position))
+         {
+            mShared->mBpm = position.bpm;
+            mShared->mPpqPosition = position.ppqPosition;
+            mShared->mPpqPositionOfLastBarStart = position.ppqPositionOfLastBarStart;
+            mShared->mTimeInSamples = position.timeInSamples;
+            mShared->mTimeSigNumerator = position.timeSigNumerator;
+            mShared->mTimeSigDenominator = position.timeSigDenominator;
+            mShared->mIsPlaying = position.isPlaying;
+         }
+
+         mShared->mNumChannels = numChannels;
+         mShared->mNumSamples = numSamples;
+         mShared->mSubmitted.store(++mSubmitted, std::memory_order_release);
+         mSemaphore->Post();
+      }
+
+   private:
+      static BusesProperties MakeBuses(int numInputs, int numOutputs)
+      {
+         BusesProperties buses;
+         if (numInputs > 0)
+            buses = buses.withInput("input", juce::AudioChannelSet::canonicalChannelSet(numInputs), true);
+         if (numOutputs > 0)
+            buses = buses.withOutput("output", juce::AudioChannelSet::canonicalChannelSet(numOutputs), true);
+         return buses;
+      }
+
+      void timerCallback() override
+      {
+         UpdateLatency();
+
+         if (HasCrashed() && !mReportedCrash)
+         {
+            mReportedCrash = true;
+            TheSynth->LogEvent("the helper process for " + mName.toStdString() + " stopped responding, it's been bypassed. reload the plugin to start it again", kLogEventType_Error);
+         }
+      }
+
+      //running a buffer behind is latency like any other, so delay compensation can line everything else up with it
+      void UpdateLatency()
+      {
+         int latency = mShared->mLatencySamples.load() + mBufferSize;
+         if (latency != getLatencySamples())
+            setLatencySamples(latency);
+      }
+
+      std::unique_ptr<SandboxCoordinator> mCoordinator;
+      std::unique_ptr<juce::MemoryMappedFile> mSharedMemory;
+      juce::File mSharedFile;
+      std::unique_ptr<SharedSemaphore> mSemaphore;
+      SharedBlock* mShared{ nullptr };
+      juce::PluginDescription mDesc;
+      juce::String mName;
+      bool mHasEditor{ false };
+      int mBufferSize{ 0 };
+      std::vector<SandboxedParameter*> mParameters;
+      juce::MidiBuffer mMidiOut;
+      uint32_t mSubmitted{ 0 };
+      bool mReportedCrash{ false };
+   };
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+   //helper side
+
+   class SandboxPlayHead : public juce::AudioPlayHead
+   {
+   public:
+      bool getCurrentPosition(CurrentPositionInfo& result) override
+      {
+         result.resetToDefault();
+         result.bpm = mShared->mBpm;
+         result.ppqPosition = mShared->mPpqPosition;
+         result.ppqPositionOfLastBarStart = mShared->mPpqPositionOfLastBarStart;
+         result.timeInSamples = mShared->mTimeInSamples;
+         result.timeSigNumerator = mShared->mTimeSigNumerator;
+         result.timeSigDenominator = mShared->mTimeSigDenominator;
+         result.isPlaying = mShared->mIsPlaying != 0;
+         return true;
+      }
+
+      SharedBlock* mShared{ nullptr };
+   };
+
+   class EditorWindow : public juce::DocumentWindow
+   {
+   public:
+      EditorWindow(juce::AudioProcessorEditor* editor, const juce::String& name)
+      : juce::DocumentWindow(name, juce::Colours::black, juce::DocumentWindow::closeButton)
+      {
+         setUsingNativeTitleBar(true);
+         setContentNonOwned(editor, true);
+         setAlwaysOnTop(true);
+      }
+      void closeButtonPressed() override { setVisible(false); }
+   };
+
+   class SandboxWorker : public juce::ChildProcessWorker, private juce::AsyncUpdater, private juce::Thread
+   {
+   public:
+      SandboxWorker()
+      : juce::Thread("sandbox audio")
+      {
+         mFormatManager.addDefaultFormats();
+      }
+
+      ~SandboxWorker() override
+      {
+         StopAudioThread();
+         mEditorWindow.reset();
+         if (mPlugin != nullptr)
+            mPlugin->releaseResources();
+      }
+
+   private:
+      void handleMessageFromCoordinator(const juce::MemoryBlock& mb) override
+      {
+         {
+            std::lock_guard<std::mutex> lock(mPendingMutex);
+            mPending.push(juce::JSON::parse(mb.toString()));
+         }
+         triggerAsyncUpdate();
+      }
+
+      void handleConnectionLost() override
+      {
+         StopAudioThread();
+         juce::JUCEApplicationBase::quit();
+      }
+
+      //plugins expect to be created and talked to on the message thread
+      void handleAsyncUpdate() override
+      {
+         while (true)
+         {
+            juce::var message;
+            {
+               std::lock_guard<std::mutex> lock(mPendingMutex);
+               if (mPending.empty())
+                  return;
+               message = mPending.front();
+               mPending.pop();
+            }
+
+            juce::var reply = MakeMessage("reply");
+            reply.getDynamicObject()->setProperty("id", message["id"]);
+            juce::String type = message["type"].toString();
+            if (type == "load")
+               Load(message, reply);
+            else if (type == "prepare")
+               Prepare(message["sampleRate"], message["bufferSize"]);
+            else if (type == "getState")
+               GetState(reply);
+            else if (type == "setState")
+               SetState(message["state"].toString());
+            else if (type == "showEditor")
+               ShowEditor();
+            sendMessageToCoordinator(ToMessage(reply));
+         }
+      }
+
+      void Load(const juce::var& message, juce::var& reply)
+      {
+         auto fail = [&](const juce::String& error)
+         {
+            reply.getDynamicObject()->setProperty("error", error);
+         };
+
+         mSharedMemory = std::make_unique<juce::MemoryMappedFile>(juce::File(message["sharedMemory"].toString()), juce::MemoryMappedFile::readWrite, false);
+         mShared = static_cast<SharedBlock*>(mSharedMemory->getData());
+         if (mShared == nullptr || mSharedMemory->getSize() < sizeof(SharedBlock) || mShared->mMagic != SharedBlock::kMagic)
+            return fail("couldn't map the shared memory");
+         if (!mSemaphore.Open(message["semaphore"].toString()))
+            return fail("couldn't open the semaphore");
+
+         juce::PluginDescription desc;
+         auto xml = juce::parseXML(message["description"].toString());
+         if (xml == nullptr || !desc.loadFromXml(*xml))
+            return fail("couldn't read the plugin description");
+
+         juce::String error;
+         mPlugin = mFormatManager.createPluginInstance(desc, message["sampleRate"], message["bufferSize"], error);
+         if (mPlugin == nullptr)
+            return fail(error);
+
+         mPlugin->enableAllBuses();
+         mPlayHead.mShared = mShared;
+         mPlugin->setPlayHead(&mPlayHead);
+         Prepare(message["sampleRate"], message["bufferSize"]);
+
+         auto* info = reply.getDynamicObject();
+         info->setProperty("name", mPlugin->getName());
+         info->setProperty("numInputs", mPlugin->getTotalNumInputChannels());
+         info->setProperty("numOutputs", mPlugin->getTotalNumOutputChannels());
+         info->setProperty("hasEditor", mPlugin->hasEditor());
+         juce::Array<juce::var> parameters;
+         const auto& pluginParameters = mPlugin->getParameters();
+         for (int i = 0; i < pluginParameters.size() && i < SharedBlock::kMaxParameters; ++i)
+         {
+            auto* parameter = pluginParameters[i];
+            juce::var entry(new juce::DynamicObject());
+            auto* hosted = dynamic_cast<juce::HostedAudioProcessorParameter*>(parameter);
+            entry.getDynamicObject()->setProperty("id", hosted != nullptr ? hosted->getParameterID() : juce::String(i));
+            entry.getDynamicObject()->setProperty("name", parameter->getName(64));
+            entry.getDynamicObject()->setProperty("label", parameter->getLabel());
+            entry.getDynamicObject()->setProperty("default", parameter->getDefaultValue());
+            entry.getDynamicObject()->setProperty("steps", parameter->getNumSteps());
+            entry.getDynamicObject()->setProperty("value", parameter->getValue());
+            mShared->mParameterValues[i] = parameter->getValue();
+            parameters.add(entry);
+         }
+         info->setProperty("parameters", parameters);
+
+         startThread(juce::Thread::realtimeAudioPriority);
+      }
+
+      void Prepare(double sampleRate, int bufferSize)
+      {
+         if (mPlugin == nullptr)
+            return;
+         std::lock_guard<std::mutex> lock(mProcessMutex);
+         mPlugin->prepareToPlay(sampleRate, MIN(bufferSize, SharedBlock::kMaxBlockSize));
+         mShared->mLatencySamples = mPlugin->getLatencySamples();
+      }
+
+      void GetState(juce::var& reply)
+      {
+         if (mPlugin == nullptr)
+            return;
+         juce::MemoryBlock state;
+         {
+            std::lock_guard<std::mutex> lock(mProcessMutex);
+            mPlugin->getStateInformation(state);
+         }
+         reply.getDynamicObject()->setProperty("state", state.toBase64Encoding());
+      }
+
+      void SetState(const juce::String& base64)
+      {
+         if (mPlugin == nullptr)
+            return;
+         juce::MemoryBlock state;
+         state.fromBase64Encoding(base64);
+         std::lock_guard<std::mutex> lock(mProcessMutex);
+         mPlugin->setStateInformation(state.getData(), (int)state.getSize());
+      }
+
+      void ShowEditor()
+      {
+         if (mPlugin == nullptr || !mPlugin->hasEditor())
+            return;
+         if (mEditorWindow == nullptr)
+         {
+            if (auto* editor = mPlugin->createEditorIfNeeded())
+               mEditorWindow = std::make_unique<EditorWindow>(editor, mPlugin->getName());
+         }
+         if (mEditorWindow != nullptr)
+         {
+            mEditorWindow->setVisible(true);
+            mEditorWindow->toFront(true);
+         }
+      }
+
+      void StopAudioThread()
+      {
+         signalThreadShouldExit();
+         if (mShared != nullptr)
+            mSemaphore.Post();
+         stopThread(1000);
+      }
+
+      void run() override
+      {
+         juce::AudioBuffer<float> buffer;
+         juce::MidiBuffer midi;
+         midi.ensureSize(SharedBlock::kMaxMidiBytes);
+         float* channels[SharedBlock::kMaxChannels];
+
+         while (!threadShouldExit())
+         {
+            mSemaphore.Wait();
+            if (threadShouldExit())
+               break;
+
+            uint32_t submitted = mShared->mSubmitted.load(std::memory_order_acquire);
+            if (submitted == mShared->mCompleted.load(std::memory_order_relaxed))
+               continue;
+
+            {
+               std::lock_guard<std::mutex> lock(mProcessMutex);
+
+               const auto& parameters = mPlugin->getParameters();
+               for (int i = 0; i < mShared->mNumParameterChanges; ++i)
+               {
+                  const auto& change = mShared->mParameterChanges[i];
+                  if (change.mIndex >= 0 && change.mIndex < parameters.size())
+                     parameters[change.mIndex]->setValue(change.mValue);
+               }
+
+               int numChannels = juce::jlimit(0, SharedBlock::kMaxChannels, (int)mShared->mNumChannels);
+               int numSamples = juce::jlimit(0, SharedBlock::kMaxBlockSize, (int)mShared->mNumSamples);
+               for (int ch = 0; ch < numChannels; ++ch)
+                  channels[ch] = mShared->GetChannel(ch);
+               buffer.setDataToReferTo(channels, numChannels, numSamples);
+
+               midi.clear();
+               ReadMidi(mShared->mMidiIn, mShared->mMidiInBytes, midi);
+               mPlugin->processBlock(buffer, midi);
+               mShared->mMidiOutBytes = WriteMidi(midi, mShared->mMidiOut, SharedBlock::kMaxMidiBytes);
+
+               for (int i = 0; i < parameters.size() && i < SharedBlock::kMaxParameters; ++i)
+                  mShared->mParameterValues[i] = parameters[i]->getValue();
+               mShared->mLatencySamples = mPlugin->getLatencySamples();
+            }
+
+            mShared->mCompleted.store(submitted, std::memory_order_release);
+         }
+      }
+
+      juce::AudioPluginFormatManager mFormatManager;
+      std::unique_ptr<juce::AudioPluginInstance> mPlugin;
+      std::unique_ptr<juce::MemoryMappedFile> mSharedMemory;
+      SharedBlock* mShared{ nullptr };
+      SharedSemaphore mSemaphore;
+      SandboxPlayHead mPlayHead;
+      std::unique_ptr<EditorWindow> mEditorWindow;
+      std::mutex mProcessMutex; //between the audio thread and the plugin calls the message thread makes
+      std::mutex mPendingMutex;
+      std::queue<juce::var> mPending;
+   };
+}
+
+std::unique_ptr<juce::AudioPluginInstance> PluginSandbox::CreateInstance(const juce::PluginDescription& desc, double sampleRate, int bufferSize, juce::String& errorMessage)
+{
+   static std::atomic<int> sCounter{ 0 };
+   juce::String uniqueName = "bespoke_" + juce::String(juce::Time::currentTimeMillis() % 1000000) + "_" + juce::String(++sCounter);
+
+   juce::File sharedFile = GetSharedMemoryDirectory().getChildFile(uniqueName + ".shm");
+   {
+      juce::MemoryBlock zeros(sizeof(SharedBlock), true);
+      if (!sharedFile.replaceWithData(zeros.getData(), zeros.getSize()))
+      {
+         errorMessage = "couldn't create " + sharedFile.getFullPathName();
+         return nullptr;
+      }
+   }
+   auto sharedMemory = std::make_unique<juce::MemoryMappedFile>(sharedFile, juce::MemoryMappedFile::readWrite, false);
+   auto* shared = static_cast<SharedBlock*>(sharedMemory->getData());
+   if (shared == nullptr)
+   {
+      errorMessage = "couldn't map " + sharedFile.getFullPathName();
+      sharedFile.deleteFile();
+      return nullptr;
+   }
+   shared->mMagic = SharedBlock::kMagic;
+
+   juce::String semaphoreName = "/" + uniqueName;
+   auto semaphore = std::make_unique<SharedSemaphore>();
+   auto coordinator = std::make_unique<SandboxCoordinator>();
+   juce::var reply;
+   if (!semaphore->Create(semaphoreName))
+      errorMessage = "couldn't create a semaphore for the helper process";
+   else if (!coordinator->launchWorkerProcess(juce::File::getSpecialLocation(juce::File::currentExecutableFile), kSandboxProcessUID, 0, 0))
+      errorMessage = "couldn't start the helper process";
+   else
+   {
+      juce::var message = MakeMessage("load");
+      message.getDynamicObject()->setProperty("description", desc.createXml()->toString());
+      message.getDynamicObject()->setProperty("sampleRate", sampleRate);
+      message.getDynamicObject()->setProperty("bufferSize", bufferSize);
+      message.getDynamicObject()->setProperty("sharedMemory", sharedFile.getFullPathName());
+      message.getDynamicObject()->setProperty("semaphore", semaphoreName);
+      reply = coordinator->Request(message, kLoadTimeoutMs);
+      if (reply.isVoid())
+         errorMessage = "the helper process didn't load the plugin in time";
+      else if (reply.hasProperty("error"))
+         errorMessage = reply["error"].toString();
+   }
+
+   if (errorMessage.isNotEmpty())
+   {
+      coordinator.reset();
+      sharedMemory.reset();
+      sharedFile.deleteFile();
+      return nullptr;
+   }
+
+   return std::make_unique<SandboxedPluginInstance>(std::move(coordinator), std::move(sharedMemory), sharedFile, std::move(semaphore), desc, reply, bufferSize);
+}
+
+bool PluginSandbox::IsSandboxed(juce::AudioProcessor* processor)
+{
+   return dynamic_cast<SandboxedPluginInstance*>(processor) != nullptr;
+}
+
+bool PluginSandbox::HasCrashed(juce::AudioProcessor* processor)
+{
+   auto* sandboxed = dynamic_cast<SandboxedPluginInstance*>(processor);
+   return sandboxed != nullptr && sandboxed->HasCrashed();
+}
+
+void PluginSandbox::ShowEditor(juce::AudioProcessor* processor)
+{
+   if (auto* sandboxed = dynamic_cast<SandboxedPluginInstance*>(processor))
+      sandboxed->ShowEditor();
+}
+
+std::unique_ptr<juce::ChildProcessWorker> PluginSandbox::CreateWorker(const juce::String& commandLine)
+{
+   auto worker = std::make_unique<SandboxWorker>();
+   if (!worker->initialiseFromCommandLine(commandLine, kSandboxProcessUID))
+      return nullptr;
+   return worker;
+}
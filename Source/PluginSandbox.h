@@ -0,0 +1,49 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    PluginSandbox.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce_audio_processors/juce_audio_processors.h"
+
+#include <memory>
+
+constexpr const char* kSandboxProcessUID = "bespokesandbox";
+
+//hosting plugins in a helper process (this same executable, started as a ChildProcessWorker, see Main.cpp),
+//so that a plugin that crashes or hangs takes its helper down rather than the synth.
+//audio, midi and parameter changes cross over through shared memory, running one buffer behind: each processBlock() hands the helper
+//this buffer's input and picks up what it made of the previous one, so the helper gets a whole buffer to do its work in.
+//if it isn't done in time, that buffer comes out silent instead of holding up the audio thread
+namespace PluginSandbox
+{
+   std::unique_ptr<juce::AudioPluginInstance> CreateInstance(const juce::PluginDescription& desc, double sampleRate, int bufferSize, juce::String& errorMessage);
+   bool IsSandboxed(juce::AudioProcessor* processor);
+   bool HasCrashed(juce::AudioProcessor* processor);
+   void ShowEditor(juce::AudioProcessor* processor); //the plugin's own window, opened by the helper
+
+   //in the helper process. returns nullptr if the command line isn't one that launches a helper
+   std::unique_ptr<juce::ChildProcessWorker> CreateWorker(const juce::String& commandLine);
+}
@@ -29,8 +29,11 @@
 #include "KarplusStrongVoice.h"
 #include "SingleOscillatorVoice.h"
 #include "SampleVoice.h"
+#include "MultiSampleVoice.h"
 #include "SynthGlobals.h"
 #include "Profiler.h"
+#include "ModularSynth.h"
+#include "CpuGovernor.h"
 
 ChannelBuffer gMidiVoiceWorkChannelBuffer(kWorkBufferSize);
 
@@ -41,62 +44,96 @@ PolyphonyMgr::PolyphonyMgr(IDrawableModule* owner)
 
 PolyphonyMgr::~PolyphonyMgr()
 {
-   for (int i = 0; i < kNumVoices; ++i)
+   for (int i = 0; i < mNumVoices; ++i)
       delete mVoices[i].mVoice;
 }
 
 void PolyphonyMgr::Init(VoiceType type, IVoiceParams* params)
 {
-   if (type == kVoiceType_FM)
+   mVoiceType = type;
+   mVoiceParams = params;
+   if (type == kVoiceType_SingleOscillator && mOscillatorLanes == nullptr)
+      mOscillatorLanes = std::make_unique<OscillatorLanes>();
+   SetVoiceLimit(mVoiceLimit.load(std::memory_order_relaxed));
+}
+
+IMidiVoice* PolyphonyMgr::CreateVoice() const
+{
+   IMidiVoice* voice = nullptr;
+   if (mVoiceType == kVoiceType_FM)
+      voice = new FMVoice(mOwner);
+   else if (mVoiceType == kVoiceType_Karplus)
+      voice = new KarplusStrongVoice(mOwner);
+   else if (mVoiceType == kVoiceType_SingleOscillator)
+      voice = new SingleOscillatorVoice(mOwner);
+   else if (mVoiceType == kVoiceType_Sampler)
+      voice = new SampleVoice(mOwner);
+   else if (mVoiceType == kVoiceType_MultiSample)
+      voice = new MultiSampleVoice(mOwner);
+   else
+      assert(false); //unsupported voice type
+
+   voice->SetVoiceParams(mVoiceParams);
+   return voice;
+}
+
+//main thread. the new voices exist before the audio thread can be told to use them: the release stores publish them to its acquire loads
+void PolyphonyMgr::SetVoiceLimit(int limit)
+{
+   limit = ofClamp(limit, 1, kMaxPolyphony);
+   if (mVoiceParams != nullptr)
    {
-      for (int i = 0; i < kNumVoices; ++i)
-      {
-         mVoices[i].mVoice = new FMVoice(mOwner);
-         mVoices[i].mVoice->SetVoiceParams(params);
-      }
+      int numVoices = mNumVoices.load(std::memory_order_relaxed);
+      for (int i = numVoices; i < MAX(limit, kNumVoices); ++i)
+         mVoices[i].mVoice = CreateVoice();
+      mNumVoices.store(MAX(numVoices, MAX(limit, kNumVoices)), std::memory_order_release);
    }
-   else if (type == kVoiceType_Karplus)
-   {
-      for (int i = 0; i < kNumVoices; ++i)
-      {
-         mVoices[i].mVoice = new KarplusStrongVoice(mOwner);
-         mVoices[i].mVoice->SetVoiceParams(params);
-      }
-   }
-   else if (type == kVoiceType_SingleOscillator)
+   mVoiceLimit.store(limit, std::memory_order_release);
+}
+
+//a released voice first, the quietest of them, then the note that's been held the longest
+int PolyphonyMgr::ChooseVoiceToSteal(double time, int voiceLimit) const
+{
+   voiceLimit = MIN(voiceLimit, mNumVoices.load(std::memory_order_acquire));
+   int released = -1;
+   float releasedLevel = 0;
+   int held = 0;
+   for (int i = 0; i < voiceLimit; ++i)
    {
-      for (int i = 0; i < kNumVoices; ++i)
+      if (!mVoices[i].mNoteOn)
       {
-         mVoices[i].mVoice = new SingleOscillatorVoice(mOwner);
-         mVoices[i].mVoice->SetVoiceParams(params);
+         float level = mVoices[i].mVoice->GetLevel(time);
+         if (released == -1 || level < releasedLevel || (level == releasedLevel && mVoices[i].mTime < mVoices[released].mTime))
+         {
+            released = i;
+            releasedLevel = level;
+         }
       }
-   }
-   else if (type == kVoiceType_Sampler)
-   {
-      for (int i = 0; i < kNumVoices; ++i)
+      else if (mVoices[i].mTime < mVoices[held].mTime)
       {
-         mVoices[i].mVoice = new SampleVoice(mOwner);
-         mVoices[i].mVoice->SetVoiceParams(params);
+         held = i;
       }
    }
-   else
-   {
-      assert(false); //unsupported voice type
-   }
+   return released != -1 ? released : held;
 }
 
 int PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, ModulationParameters modulation)
 {
-   assert(voiceIdx < kNumVoices);
+   assert(voiceIdx < mNumVoices.load(std::memory_order_acquire));
 
    bool preserveVoice = voiceIdx != -1 && //we specified a voice
                         mVoices[voiceIdx].mPitch != -1; //there is a note playing from that voice
 
+   //when the cpu governor is at its last level, new notes only get half the voices, and steal sooner
+   int voiceLimit = mVoiceLimit.load(std::memory_order_acquire);
+   if (TheSynth->GetCpuGovernor().GetLevel(mPriority) >= CpuGovernor::kLevel_ReduceVoices)
+      voiceLimit = MAX(1, voiceLimit / 2);
+
    if (voiceIdx == -1) //need a new voice
    {
-      for (int i = 0; i < mVoiceLimit; ++i)
+      for (int i = 0; i < voiceLimit; ++i)
       {
-         int check = (i + mLastVoice + 1) % mVoiceLimit; //try to keep incrementing through list to allow old voices to finish
+         int check = (i + mLastVoice + 1) % voiceLimit; //try to keep incrementing through list to allow old voices to finish
          if (mVoices[check].mPitch == -1)
          {
             voiceIdx = check;
@@ -108,39 +145,15 @@ int PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, Modu
    if (voiceIdx == -1) //all used
    {
       if (mAllowStealing)
-      {
-         double oldest = mVoices[0].mTime;
-         int oldestIndex = 0;
-         for (int i = 1; i < mVoiceLimit; ++i)
-         {
-            if (mVoices[i].mTime < oldest)
-            {
-               oldest = mVoices[i].mTime;
-               oldestIndex = i;
-            }
-         }
-         voiceIdx = oldestIndex;
-      }
+         voiceIdx = ChooseVoiceToSteal(time, voiceLimit);
       else
-      {
          return voiceIdx;
-      }
    }
 
    IMidiVoice* voice = mVoices[voiceIdx].mVoice;
    assert(voice);
    if (!voice->IsDone(time) && (!preserveVoice || modulation.pan != voice->GetPan()))
-   {
-      //ofLog() << "fading stolen voice " << voiceIdx << " at " << time;
-      mFadeOutWorkBuffer.Clear();
-      voice->Process(time, &mFadeOutWorkBuffer, mOversampling);
-      for (int i = 0; i < kVoiceFadeSamples; ++i)
-      {
-         float fade = 1 - (float(i) / kVoiceFadeSamples);
-         for (int ch = 0; ch < mFadeOutBuffer.NumActiveChannels(); ++ch)
-            mFadeOutBuffer.GetChannel(ch)[(i + mFadeOutBufferPos) % kVoiceFadeSamples] += mFadeOutWorkBuffer.GetChannel(ch)[i] * fade;
-      }
-   }
+      FadeOutVoice(time, voiceIdx);
    if (!preserveVoice)
       voice->ClearVoice();
    voice->SetPitch(pitch);
@@ -149,6 +162,8 @@ int PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, Modu
    voice->SetPan(modulation.pan);
    mLastVoice = voiceIdx;
 
+   if (mVoices[voiceIdx].mPitch == -1)
+      mActiveVoices[mNumActiveVoices++] = voiceIdx;
    mVoices[voiceIdx].mPitch = pitch;
    mVoices[voiceIdx].mTime = time;
    mVoices[voiceIdx].mNoteOn = true;
@@ -156,13 +171,29 @@ int PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, Modu
    return voiceIdx;
 }
 
+//renders the start of a voice that's about to be cut off into the fade out ring, fading it from full to silent
+void PolyphonyMgr::FadeOutVoice(double time, int voiceIdx)
+{
+   //ofLog() << "fading stolen voice " << voiceIdx << " at " << time;
+   mFadeOutWorkBuffer.Clear();
+   mVoices[voiceIdx].mVoice->Process(time, &mFadeOutWorkBuffer, mOversampling);
+   for (int i = 0; i < kVoiceFadeSamples; ++i)
+   {
+      float fade = 1 - (float(i) / kVoiceFadeSamples);
+      for (int ch = 0; ch < mFadeOutBuffer.NumActiveChannels(); ++ch)
+         mFadeOutBuffer.GetChannel(ch)[(i + mFadeOutBufferPos) % kVoiceFadeSamples] += mFadeOutWorkBuffer.GetChannel(ch)[i] * fade;
+   }
+   mFadeOutSamplesLeft = kVoiceFadeSamples;
+}
+
 void PolyphonyMgr::Stop(double time, int pitch, int voiceIdx)
 {
    if (voiceIdx == -1)
    {
       double oldest = std::numeric_limits<double>::max();
-      for (int i = 0; i < mVoiceLimit; ++i)
+      for (int active = 0; active < mNumActiveVoices; ++active)
       {
+         int i = mActiveVoices[active];
          if (mVoices[i].mPitch == pitch && mVoices[i].mNoteOn && mVoices[i].mTime < oldest)
          {
             oldest = mVoices[i].mTime;
@@ -179,7 +210,8 @@ void PolyphonyMgr::Stop(double time, int pitch, int voiceIdx)
 
 void PolyphonyMgr::KillAll()
 {
-   for (int i = 0; i < kNumVoices; ++i)
+   int numVoices = mNumVoices.load(std::memory_order_acquire);
+   for (int i = 0; i < numVoices; ++i)
    {
       mVoices[i].mVoice->ClearVoice();
       mVoices[i].mNoteOn = false;
@@ -193,34 +225,69 @@ void PolyphonyMgr::Process(double time, ChannelBuffer* out, int bufferSize)
    mFadeOutBuffer.SetNumActiveChannels(out->NumActiveChannels());
    mFadeOutWorkBuffer.SetNumActiveChannels(out->NumActiveChannels());
 
+   int degradeLevel = TheSynth->GetCpuGovernor().GetLevel(mPriority);
+
+   //single oscillator voices all play from mVoiceParams, so the sounding ones are rendered together below, with their oscillators side by side
+   //in simd lanes. mActivity only follows the voices that are rendered one at a time
+   bool renderLanes = mOscillatorLanes != nullptr && mVoiceType == kVoiceType_SingleOscillator && mOversampling == 1;
+   int numLaneVoices = 0;
+
    float debugRef = 0;
-   for (int i = 0; i < mVoiceLimit; ++i)
+   for (int active = 0; active < mNumActiveVoices;)
    {
-      if (mVoices[i].mPitch != -1)
+      int i = mActiveVoices[active];
+      IMidiVoice* voice = mVoices[i].mVoice;
+      if (degradeLevel >= CpuGovernor::kLevel_StealReleased && !mVoices[i].mNoteOn && voice->GetLevel(time) < kEarlyStealLevel)
       {
-         mVoices[i].mVoice->Process(time, out, mOversampling);
-
-         float testSample = out->GetChannel(0)[0];
-         mVoices[i].mActivity = testSample - debugRef;
+         //over budget, a quiet release tail isn't worth finishing
+         FadeOutVoice(time, i);
+         voice->ClearVoice();
+      }
+      else
+      {
+         voice->SetDegradeLevel(degradeLevel);
+         if (renderLanes)
+            mLaneVoices[numLaneVoices++] = static_cast<SingleOscillatorVoice*>(voice);
+         else
+            voice->Process(time, out, mOversampling);
+      }
 
-         if (!mVoices[i].mNoteOn && mVoices[i].mVoice->IsDone(time))
-            mVoices[i].mPitch = -1;
+      float testSample = out->GetChannel(0)[0];
+      mVoices[i].mActivity = testSample - debugRef;
+      debugRef = testSample;
 
-         debugRef = testSample;
+      if (!mVoices[i].mNoteOn && mVoices[i].mVoice->IsDone(time))
+      {
+         mVoices[i].mPitch = -1;
+         mActiveVoices[active] = mActiveVoices[--mNumActiveVoices];
+      }
+      else
+      {
+         ++active;
       }
    }
 
-   for (int ch = 0; ch < out->NumActiveChannels(); ++ch)
+   if (numLaneVoices > 0)
+      SingleOscillatorVoice::ProcessLanes(mLaneVoices.data(), numLaneVoices, time, out, *mOscillatorLanes);
+
+   //mix in the tails of stolen voices, in contiguous runs of the ring buffer rather than wrapping every sample
+   int fadeOutSamples = MIN(bufferSize, kVoiceFadeSamples);
+   for (int ch = 0; ch < out->NumActiveChannels() && mFadeOutSamplesLeft > 0; ++ch)
    {
-      for (int i = 0; i < bufferSize; ++i)
+      float* outChannel = out->GetChannel(ch);
+      float* fadeOut = mFadeOutBuffer.GetChannel(ch);
+      for (int i = 0; i < fadeOutSamples;)
       {
          int fadeOutIdx = (i + mFadeOutBufferPos) % kVoiceFadeSamples;
-         out->GetChannel(ch)[i] += mFadeOutBuffer.GetChannel(ch)[fadeOutIdx];
-         mFadeOutBuffer.GetChannel(ch)[fadeOutIdx] = 0;
+         int length = MIN(fadeOutSamples - i, kVoiceFadeSamples - fadeOutIdx);
+         Add(outChannel + i, fadeOut + fadeOutIdx, length);
+         Clear(fadeOut + fadeOutIdx, length);
+         i += length;
       }
    }
 
-   mFadeOutBufferPos += bufferSize;
+   mFadeOutBufferPos = (mFadeOutBufferPos + bufferSize) % kVoiceFadeSamples;
+   mFadeOutSamplesLeft = MAX(0, mFadeOutSamplesLeft - bufferSize);
 }
 
 void PolyphonyMgr::DrawDebug(float x, float y)
@@ -228,7 +295,8 @@ void PolyphonyMgr::DrawDebug(float x, float y)
    ofPushMatrix();
    ofPushStyle();
    ofTranslate(x, y);
-   for (int i = 0; i < kNumVoices; ++i)
+   int voiceLimit = mVoiceLimit.load(std::memory_order_acquire);
+   for (int i = 0; i < voiceLimit; ++i)
    {
       if (mVoices[i].mPitch == -1)
          ofSetColor(100, 100, 100);
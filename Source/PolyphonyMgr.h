@@ -28,12 +28,19 @@
 #include "SynthGlobals.h"
 #include "ChannelBuffer.h"
 
+#include <array>
+#include <atomic>
+#include <memory>
+
 const int kVoiceFadeSamples = 50;
+const float kEarlyStealLevel = .1f; //how quiet a released voice has to be for the cpu governor to cut it short
 
 extern ChannelBuffer gMidiVoiceWorkChannelBuffer;
 
 class IMidiVoice;
 class IVoiceParams;
+class SingleOscillatorVoice;
+struct OscillatorLanes;
 class IDrawableModule;
 struct ModulationParameters;
 
@@ -42,7 +49,8 @@ enum VoiceType
    kVoiceType_Karplus,
    kVoiceType_FM,
    kVoiceType_SingleOscillator,
-   kVoiceType_Sampler
+   kVoiceType_Sampler,
+   kVoiceType_MultiSample
 };
 
 struct VoiceInfo
@@ -67,20 +75,37 @@ public:
    void Stop(double time, int pitch, int voiceIdx);
    void Process(double time, ChannelBuffer* out, int bufferSize);
    void DrawDebug(float x, float y);
-   void SetVoiceLimit(int limit) { mVoiceLimit = limit; }
+   void SetVoiceLimit(int limit);
+   int GetVoiceLimit() const { return mVoiceLimit.load(std::memory_order_acquire); }
    void KillAll();
    void SetOversampling(int oversampling) { mOversampling = oversampling; }
+   void SetPriority(int priority) { mPriority = priority; } //subtracted from the CpuGovernor level, so a lead can keep its quality
    const VoiceInfo& GetVoiceInfo(int voiceIdx) const { return mVoices[voiceIdx]; }
 
 private:
-   VoiceInfo mVoices[kNumVoices];
+   IMidiVoice* CreateVoice() const;
+   int ChooseVoiceToSteal(double time, int voiceLimit) const;
+   void FadeOutVoice(double time, int voiceIdx);
+
+   //voices are only made as the limit needs them, and only the sounding ones are processed, so a high limit costs nothing until it's used.
+   //there are always at least kNumVoices, so that every voice index a note can ask for exists
+   std::array<VoiceInfo, kMaxPolyphony> mVoices;
+   std::atomic<int> mNumVoices{ 0 }; //only grows, and only once the voices it covers have been made, see SetVoiceLimit()
+   std::array<int, kMaxPolyphony> mActiveVoices{};
+   int mNumActiveVoices{ 0 };
+   VoiceType mVoiceType{ kVoiceType_SingleOscillator };
+   IVoiceParams* mVoiceParams{ nullptr };
    bool mAllowStealing{ true };
    int mLastVoice{ -1 };
    ChannelBuffer mFadeOutBuffer{ kVoiceFadeSamples };
    ChannelBuffer mFadeOutWorkBuffer{ kVoiceFadeSamples };
    float mWorkBuffer[2048]{};
    int mFadeOutBufferPos{ 0 };
+   int mFadeOutSamplesLeft{ 0 }; //so we don't touch the output when no stolen voices are fading out
    IDrawableModule* mOwner;
-   int mVoiceLimit{ kNumVoices };
+   std::atomic<int> mVoiceLimit{ kNumVoices };
    int mOversampling{ 1 };
+   int mPriority{ 0 };
+   std::unique_ptr<OscillatorLanes> mOscillatorLanes; //single oscillator voices render together through these, see Process()
+   std::array<SingleOscillatorVoice*, kMaxPolyphony> mLaneVoices{};
 };
@@ -30,9 +30,14 @@
 #include "Checkbox.h"
 #include "ModularSynth.h"
 #include "PatchCableSource.h"
+#include "PresetLibrary.h"
+#include "SampleLoader.h"
+#include "Transport.h"
 
 #include "juce_gui_basics/juce_gui_basics.h"
 
+#include <atomic>
+
 //static
 bool Prefab::sLoadingPrefab = false;
 bool Prefab::sLastLoadWasPrefab = false;
@@ -44,6 +49,49 @@ namespace
    const float paddingY = 10;
 }
 
+//a prefab file, read and parsed off the main thread
+struct PendingPrefabLoad
+{
+   std::string mPath;
+   std::unique_ptr<FileStreamIn> mIn; //left just past the json, where the module state starts
+   ofxJSONElement mRoot;
+   bool mOpened{ false };
+   bool mParsed{ false };
+   std::atomic<bool> mDone{ false };
+   std::function<void(Prefab*, bool)> mOnFinished; //main thread only
+};
+
+namespace
+{
+   class PrefabParseJob : public juce::ThreadPoolJob
+   {
+   public:
+      explicit PrefabParseJob(std::shared_ptr<PendingPrefabLoad> load)
+      : juce::ThreadPoolJob("prefab parse")
+      , mLoad(std::move(load))
+      {
+      }
+
+      JobStatus runJob() override
+      {
+         juce::MemoryBlock data;
+         mLoad->mOpened = PresetLibrary::Get().ReadData(ofToDataPath(mLoad->mPath), data);
+         mLoad->mIn = std::make_unique<FileStreamIn>(data);
+         if (mLoad->mOpened)
+         {
+            std::string jsonString;
+            *mLoad->mIn >> jsonString;
+            mLoad->mParsed = mLoad->mRoot.parse(jsonString);
+         }
+         mLoad->mDone = true;
+         return jobHasFinished;
+      }
+
+   private:
+      std::shared_ptr<PendingPrefabLoad> mLoad;
+   };
+}
+
 Prefab::Prefab()
 {
    mModuleContainer.SetOwner(this);
@@ -75,6 +123,9 @@ std::string Prefab::GetTitleLabel() const
 
 void Prefab::Poll()
 {
+   if (mPendingLoad != nullptr && mPendingLoad->mDone)
+      FinishLoadingPrefab();
+
    float xMin, yMin;
    GetPosition(xMin, yMin);
    for (auto* module : mModuleContainer.GetModules())
@@ -175,6 +226,8 @@ void Prefab::DrawModule()
    mLoadButton->Draw();
    mDisbandButton->Draw();
    DrawTextNormal("remove", 18, 14);
+   if (mPendingLoad != nullptr)
+      DrawTextNormal("loading...", 18, 30);
 
    mModuleContainer.DrawModules();
 }
@@ -288,44 +341,73 @@ void Prefab::SavePrefab(std::string savePath)
 
    UpdatePrefabName(savePath);
 
-   FileStreamOut out(ofToDataPath(savePath));
-
-   out << lines;
-   mModuleContainer.SaveState(out);
+   {
+      FileStreamOut out(ofToDataPath(savePath));
+      out << lines;
+      mModuleContainer.SaveState(out);
+   }
+   PresetLibrary::Get().NoteChanged();
 }
 
-void Prefab::LoadPrefab(std::string loadPath)
+void Prefab::LoadPrefab(std::string loadPath, std::function<void(Prefab* prefab, bool succeeded)> onFinished)
 {
-   sLoadingPrefab = true;
+   //a load that's still parsing is dropped, its job finishes on its own
+   mPendingLoad = std::make_shared<PendingPrefabLoad>();
+   mPendingLoad->mPath = loadPath;
+   mPendingLoad->mOnFinished = std::move(onFinished);
+   SampleLoader::Get().AddJob(new PrefabParseJob(mPendingLoad));
+}
 
-   ScopedMutex mutex(TheSynth->GetAudioMutex(), "LoadPrefab()");
-   std::lock_guard<std::recursive_mutex> renderLock(TheSynth->GetRenderLock());
+void Prefab::FinishLoadingPrefab()
+{
+   std::shared_ptr<PendingPrefabLoad> load = std::move(mPendingLoad);
 
-   mModuleContainer.Clear();
+   if (!load->mOpened)
+   {
+      TheSynth->LogEvent("Couldn't open " + load->mPath, kLogEventType_Error);
+      if (load->mOnFinished)
+         load->mOnFinished(this, false);
+      return;
+   }
 
-   FileStreamIn in(ofToDataPath(loadPath));
+   if (!load->mParsed)
+   {
+      TheSynth->LogEvent("Couldn't load, error parsing " + load->mPath, kLogEventType_Error);
+      TheSynth->LogEvent("Try loading it up in a json validator", kLogEventType_Error);
+      if (load->mOnFinished)
+         load->mOnFinished(this, false);
+      return;
+   }
 
-   assert(in.OpenedOk());
+   sLoadingPrefab = true;
 
-   std::string jsonString;
-   in >> jsonString;
-   ofxJSONElement root;
-   bool loaded = root.parse(jsonString);
+   std::lock_guard<std::recursive_mutex> renderLock(TheSynth->GetRenderLock());
 
-   if (!loaded)
    {
-      TheSynth->LogEvent("Couldn't load, error parsing " + loadPath, kLogEventType_Error);
-      TheSynth->LogEvent("Try loading it up in a json validator", kLogEventType_Error);
-      return;
+      ScopedMutex mutex(TheSynth->GetAudioMutex(), "LoadPrefab() clear");
+      mModuleContainer.Clear();
    }
 
-   UpdatePrefabName(loadPath);
+   UpdatePrefabName(load->mPath);
 
-   mModuleContainer.LoadModules(root["modules"]);
+   //build the modules while the audio keeps running: the audio mutex is only held for one module at a time, and until
+   //the splice below, the new modules aren't in the execution plan and the transport doesn't call them
+   int stagingToken = TheTransport->BeginStaging();
+   TheSynth->SetHoldExecutionPlan(true);
 
-   mModuleContainer.LoadState(in);
+   mModuleContainer.LoadModules(load->mRoot["modules"], TheSynth->GetAudioMutex());
+   mModuleContainer.LoadState(*load->mIn, TheSynth->GetAudioMutex());
+
+   {
+      ScopedMutex mutex(TheSynth->GetAudioMutex(), "LoadPrefab() splice");
+      TheTransport->CommitStaged(stagingToken);
+      TheSynth->SetHoldExecutionPlan(false);
+   }
 
    sLoadingPrefab = false;
+
+   if (load->mOnFinished)
+      load->mOnFinished(this, true);
 }
 
 void Prefab::UpdatePrefabName(std::string path)
@@ -31,7 +31,11 @@
 #include "ClickButton.h"
 #include "ModuleContainer.h"
 
+#include <functional>
+#include <memory>
+
 class PatchCableSource;
+struct PendingPrefabLoad;
 
 class Prefab : public IDrawableModule, public IButtonListener
 {
@@ -65,7 +69,8 @@ public:
    //IPatchable
    void PostRepatch(PatchCableSource* cableSource, bool fromUserClick) override;
 
-   void LoadPrefab(std::string loadPath);
+   //reads and parses in the background, the modules show up in a later Poll(). onFinished is called from there, unless another load replaces this one first
+   void LoadPrefab(std::string loadPath, std::function<void(Prefab* prefab, bool succeeded)> onFinished = nullptr);
 
    static bool sLoadingPrefab;
    static bool sLastLoadWasPrefab;
@@ -87,6 +92,7 @@ private:
 
    void SavePrefab(std::string savePath);
    void UpdatePrefabName(std::string path);
+   void FinishLoadingPrefab();
 
    PatchCableSource* mRemoveModuleCable{ nullptr };
    ClickButton* mSaveButton{ nullptr };
@@ -94,4 +100,5 @@ private:
    ClickButton* mDisbandButton{ nullptr };
    ModuleContainer mModuleContainer;
    std::string mPrefabName{ "" };
+   std::shared_ptr<PendingPrefabLoad> mPendingLoad;
 };
@@ -0,0 +1,320 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    PresetLibrary.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "PresetLibrary.h"
+#include "FileStream.h"
+#include "SynthGlobals.h"
+
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+
+namespace
+{
+   const int kArchiveRev = 1;
+   const int kRescanIntervalMs = 10 * 1000; //for files changed outside of bespoke
+
+   bool SameFile(const PresetLibrary::Entry& a, const PresetLibrary::Entry& b)
+   {
+      return a.mPath == b.mPath && a.mModificationTime == b.mModificationTime && a.mFileSize == b.mFileSize;
+   }
+}
+
+PresetLibrary& PresetLibrary::Get()
+{
+   static PresetLibrary sLibrary;
+   return sLibrary;
+}
+
+PresetLibrary::~PresetLibrary()
+{
+}
+
+std::string PresetLibrary::GetArchivePath()
+{
+   return ofToDataPath("internal/preset_library");
+}
+
+void PresetLibrary::StartIfNeeded()
+{
+   if (mScanThread.joinable() || mQuit)
+      return;
+
+   {
+      //whatever was packed last session is there right away, the scan catches up on anything that changed since
+      std::lock_guard<std::mutex> lock(mMutex);
+      Map();
+   }
+   mScanThread = std::thread(&PresetLibrary::ScanThreadLoop, this);
+}
+
+void PresetLibrary::Shutdown()
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mQuit = true;
+   }
+   mWakeCondition.notify_all();
+   if (mScanThread.joinable())
+      mScanThread.join();
+}
+
+void PresetLibrary::GetEntries(const std::string& moduleType, std::vector<Entry>& entries)
+{
+   StartIfNeeded();
+
+   entries.clear();
+   std::lock_guard<std::mutex> lock(mMutex);
+   for (const auto& entry : mEntries)
+   {
+      if (moduleType.empty() ? entry.mModuleType != kPrefabType : entry.mModuleType == moduleType)
+         entries.push_back(entry);
+   }
+}
+
+bool PresetLibrary::ReadData(const std::string& path, juce::MemoryBlock& data)
+{
+   StartIfNeeded();
+
+   std::string fullPath = juce::File(path).getFullPathName().toStdString();
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto it = mEntryByPath.find(fullPath);
+      if (it != mEntryByPath.end() && mMapping != nullptr)
+      {
+         const Entry& entry = mEntries[it->second];
+         data.replaceAll((const char*)mMapping->getData() + mDataStart + (size_t)entry.mOffset, (size_t)entry.mSize);
+         return true;
+      }
+   }
+
+   return juce::File(fullPath).loadFileAsData(data);
+}
+
+void PresetLibrary::NoteChanged()
+{
+   StartIfNeeded();
+
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mWantRescan = true;
+   }
+   mWakeCondition.notify_all();
+}
+
+void PresetLibrary::ScanThreadLoop()
+{
+   for (;;)
+   {
+      {
+         std::unique_lock<std::mutex> lock(mMutex);
+         mWakeCondition.wait_for(lock, std::chrono::milliseconds(kRescanIntervalMs), [this]
+                                 {
+                                    return mQuit || mWantRescan;
+                                 });
+         if (mQuit)
+            return;
+         mWantRescan = false;
+      }
+
+      Rescan();
+   }
+}
+
+void PresetLibrary::ScanFolder(const std::string& moduleType, const std::string& dirPath, bool recursive, std::vector<Entry>& found) const
+{
+   juce::File dir(dirPath);
+   if (!dir.isDirectory())
+      return;
+
+   juce::String wildcard = moduleType == kPrefabType ? "*.pfb" : "*.preset";
+   for (const auto& entry : juce::RangedDirectoryIterator(dir, recursive, wildcard, juce::File::findFiles | juce::File::ignoreHiddenFiles))
+   {
+      if (mQuit)
+         return;
+
+      const juce::File& file = entry.getFile();
+      Entry info;
+      info.mPath = file.getFullPathName().toStdString();
+      info.mModuleType = moduleType;
+      info.mName = file.getRelativePathFrom(dir).replaceCharacter('\\', '/').toStdString();
+      info.mTags = ofSplitString(juce::String(info.mName).upToLastOccurrenceOf("/", false, false).toStdString(), "/", true, true);
+      info.mModificationTime = (double)entry.getModificationTime().toMilliseconds();
+      info.mFileSize = (double)entry.getFileSize();
+      found.push_back(info);
+   }
+}
+
+void PresetLibrary::Rescan()
+{
+   std::vector<Entry> found;
+   ScanFolder(kPrefabType, ofToDataPath("prefabs"), false, found);
+   juce::File presetsDir(ofToDataPath("presets"));
+   if (presetsDir.isDirectory())
+   {
+      for (const auto& moduleDir : presetsDir.findChildFiles(juce::File::findDirectories, false))
+         ScanFolder(moduleDir.getFileName().toStdString(), moduleDir.getFullPathName().toStdString(), true, found);
+   }
+   if (mQuit)
+      return;
+
+   std::sort(found.begin(), found.end(), [](const Entry& a, const Entry& b)
+             {
+                return a.mModuleType != b.mModuleType ? a.mModuleType < b.mModuleType : a.mName < b.mName;
+             });
+
+   //only this thread changes mEntries, so it can read them without the lock
+   bool changed = found.size() != mEntries.size();
+   for (size_t i = 0; i < found.size() && !changed; ++i)
+      changed = !SameFile(found[i], mEntries[i]);
+   if (!changed)
+      return;
+
+   if (!Pack(found))
+      ofLog() << "couldn't write " << GetArchivePath();
+}
+
+bool PresetLibrary::Pack(std::vector<Entry>& entries)
+{
+   //the data of each entry, from the current archive if the file hasn't changed since it was packed
+   std::vector<juce::MemoryBlock> data(entries.size());
+   for (size_t i = 0; i < entries.size(); ++i)
+   {
+      auto it = mEntryByPath.find(entries[i].mPath);
+      if (it != mEntryByPath.end() && SameFile(entries[i], mEntries[it->second]))
+      {
+         if (ReadData(entries[i].mPath, data[i]))
+            continue;
+      }
+      if (!juce::File(entries[i].mPath).loadFileAsData(data[i]))
+         data[i].reset(); //unreadable for now, it'll be tried again once it changes
+   }
+
+   double offset = 0;
+   for (size_t i = 0; i < entries.size(); ++i)
+   {
+      entries[i].mOffset = offset;
+      entries[i].mSize = (double)data[i].getSize();
+      offset += entries[i].mSize;
+   }
+
+   //write to a temp file first, so a crash mid-save doesn't leave a broken archive
+   std::string tmpPath = GetArchivePath() + ".tmp";
+   juce::File(GetArchivePath()).getParentDirectory().createDirectory();
+   {
+      FileStreamOut out(tmpPath);
+      out << kArchiveRev;
+      out << (int)entries.size();
+      for (const auto& entry : entries)
+      {
+         out << entry.mPath;
+         out << entry.mModuleType;
+         out << entry.mName;
+         out << (int)entry.mTags.size();
+         for (const auto& tag : entry.mTags)
+            out << tag;
+         out << entry.mModificationTime;
+         out << entry.mFileSize;
+         out << entry.mOffset;
+         out << entry.mSize;
+      }
+      for (const auto& block : data)
+         out.WriteGeneric(block.getData(), (int)block.getSize());
+   }
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   mMapping.reset(); //a mapped file can't be replaced on windows
+   bool moved = juce::File(tmpPath).moveFileTo(juce::File(GetArchivePath()));
+   Map();
+   return moved;
+}
+
+void PresetLibrary::Map()
+{
+   mMapping.reset();
+   mEntries.clear();
+   mEntryByPath.clear();
+   mDataStart = 0;
+   ++mRevision;
+
+   juce::File archive(GetArchivePath());
+   if (!archive.existsAsFile())
+      return;
+
+   mMapping = std::make_unique<juce::MemoryMappedFile>(archive, juce::MemoryMappedFile::readOnly);
+   if (mMapping->getData() == nullptr)
+   {
+      mMapping.reset();
+      return;
+   }
+
+   FileStreamIn in(std::make_unique<juce::MemoryInputStream>(mMapping->getData(), mMapping->getSize(), false));
+   int rev;
+   in >> rev;
+   if (rev != kArchiveRev)
+   {
+      mMapping.reset(); //the next scan repacks it
+      return;
+   }
+
+   int numEntries;
+   in >> numEntries;
+   std::vector<Entry> entries(MAX(0, numEntries));
+   for (auto& entry : entries)
+   {
+      if (in.Eof())
+      {
+         mMapping.reset();
+         return;
+      }
+      int numTags;
+      in >> entry.mPath;
+      in >> entry.mModuleType;
+      in >> entry.mName;
+      in >> numTags;
+      entry.mTags.resize(MAX(0, numTags));
+      for (auto& tag : entry.mTags)
+         in >> tag;
+      in >> entry.mModificationTime;
+      in >> entry.mFileSize;
+      in >> entry.mOffset;
+      in >> entry.mSize;
+   }
+   mDataStart = (size_t)in.GetFilePosition();
+
+   for (const auto& entry : entries)
+   {
+      if (mDataStart + entry.mOffset + entry.mSize > mMapping->getSize())
+      {
+         mMapping.reset(); //truncated
+         return;
+      }
+   }
+
+   mEntries = std::move(entries);
+   for (size_t i = 0; i < mEntries.size(); ++i)
+      mEntryByPath[mEntries[i].mPath] = i;
+}
@@ -0,0 +1,94 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    PresetLibrary.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace juce
+{
+   class MemoryBlock;
+   class MemoryMappedFile;
+}
+
+//every module preset (presets/<module type>/) and prefab (prefabs/), packed into one archive in data/internal/ along with
+//an index of them, and memory mapped. listing presets reads the index, and loading one copies it out of the mapping,
+//so neither touches the filesystem. a background thread looks for added, removed and modified files and repacks the archive.
+//files in subfolders of a module type's folder get the subfolders' names as tags
+class PresetLibrary
+{
+public:
+   static constexpr const char* kPrefabType = "prefab";
+
+   struct Entry
+   {
+      std::string mPath; //the file the entry was packed from
+      std::string mModuleType; //kPrefabType for prefabs
+      std::string mName; //relative to the module type's folder, like "pads/warm.preset"
+      std::vector<std::string> mTags;
+      double mModificationTime{ 0 }; //ms since epoch
+      double mFileSize{ 0 };
+      double mOffset{ 0 }; //into the archive's data
+      double mSize{ 0 };
+   };
+
+   static PresetLibrary& Get();
+
+   void GetEntries(const std::string& moduleType, std::vector<Entry>& entries); //"" for every preset, prefabs not included. sorted by name
+   bool ReadData(const std::string& path, juce::MemoryBlock& data); //falls back to reading the file if it isn't packed yet
+   void NoteChanged(); //something was saved into presets/ or prefabs/, look for it now rather than on the next rescan
+   int GetRevision() const { return mRevision; } //changes whenever the entries do
+   void Shutdown();
+
+private:
+   PresetLibrary() = default;
+   ~PresetLibrary();
+   void StartIfNeeded();
+   void ScanThreadLoop();
+   void Rescan();
+   void ScanFolder(const std::string& moduleType, const std::string& dirPath, bool recursive, std::vector<Entry>& found) const;
+   bool Pack(std::vector<Entry>& entries); //writes the archive, copying unchanged entries out of the current one
+   void Map(); //with mMutex held
+   static std::string GetArchivePath();
+
+   std::vector<Entry> mEntries; //sorted by type then name
+   std::map<std::string, size_t> mEntryByPath;
+   std::unique_ptr<juce::MemoryMappedFile> mMapping;
+   size_t mDataStart{ 0 }; //where the data after the index starts in the mapping
+   std::thread mScanThread;
+   bool mWantRescan{ true };
+   std::atomic<bool> mQuit{ false };
+   std::atomic<int> mRevision{ 0 };
+   mutable std::mutex mMutex;
+   std::condition_variable mWakeCondition;
+};
@@ -26,6 +26,8 @@
 #include "Profiler.h"
 #include "SynthGlobals.h"
 #include "ModularSynth.h"
+#include "NamedMutex.h"
+#include "ProfilerTrace.h"
 #if BESPOKE_WINDOWS
 #include <intrin.h>
 #else
@@ -36,6 +38,8 @@
 
 Profiler::Cost Profiler::sCosts[];
 bool Profiler::sEnableProfiler = false;
+bool Profiler::sEnableModuleTiming = false;
+std::atomic<int> Profiler::sModuleTimingRequests{ 0 };
 std::array<float, 50> Profiler::sCpuUsageHistory{};
 int Profiler::sCpuUsageHistoryIndex = 0;
 
@@ -59,21 +63,31 @@ namespace
 }
 
 Profiler::Profiler(const char* name, uint32_t hash)
+: mName(name)
 {
+   if (ProfilerTrace::IsRecording())
+      mTraceStartNs = ofGetSystemTimeNanos();
+
    if (sEnableProfiler)
    {
+      if (hash == 0)
+         hash = 1;
       for (int i = 0; i < PROFILER_MAX_TRACK; ++i)
       {
-         if (sCosts[i].mHash == hash)
+         uint32_t slotHash = sCosts[i].mHash.load(std::memory_order_acquire);
+         if (slotHash == 0)
          {
-            mIndex = i;
-            break;
+            if (sCosts[i].mHash.compare_exchange_strong(slotHash, hash))
+            {
+               sCosts[i].mName.store(name, std::memory_order_release);
+               mIndex = i;
+               break;
+            }
+            //otherwise another thread got this slot first, and slotHash is now whatever it claimed it for
          }
-         if (sCosts[i].mName[0] == 0)
+         if (slotHash == hash)
          {
             mIndex = i;
-            sCosts[i].mName = name;
-            sCosts[i].mHash = hash;
             break;
          }
       }
@@ -89,10 +103,13 @@ Profiler::Profiler(const char* name, uint32_t hash)
 
 Profiler::~Profiler()
 {
-   if (sEnableProfiler)
+   if (mTraceStartNs != 0)
+      ProfilerTrace::Record(mName, kTraceCategory_Profiler, mTraceStartNs, ofGetSystemTimeNanos());
+
+   if (sEnableProfiler && mIndex != -1)
    {
       uint32_t aux;
-      sCosts[mIndex].mFrameCost += rdtscp(aux) - mTimerStart;
+      sCosts[mIndex].mFrameCost.fetch_add(rdtscp(aux) - mTimerStart, std::memory_order_relaxed);
 
       //struct timespec t;
       //clock_gettime(CLOCK_MONOTONIC, &t);
@@ -108,7 +125,7 @@ void Profiler::PrintCounters()
    //bool printedBreak = false;
    for (int i = 0; i < PROFILER_MAX_TRACK; ++i)
    {
-      if (sCosts[i].mName[0] == 0)
+      if (sCosts[i].mHash == 0)
          break;
       /*if (sCosts[i].mFrameCost > 500)
       {
@@ -153,13 +170,16 @@ void Profiler::Draw()
    long entireFrameUs = GetSafeFrameLengthNanoseconds();
    for (int i = 0; i < PROFILER_MAX_TRACK; ++i)
    {
-      if (sCosts[i].mName[0] == 0)
+      if (sCosts[i].mHash == 0)
          break;
       const Cost& cost = sCosts[i];
+      const char* name = cost.mName.load(std::memory_order_acquire);
+      if (name == nullptr) //claimed, but not named yet
+         continue;
       long maxCost = cost.MaxCost();
 
       ofSetColor(255, 255, 255);
-      gFont.DrawString(std::string(sCosts[i].mName) + ": " + ofToString(maxCost / 1000), 13, 0, 0);
+      gFont.DrawString(std::string(name) + ": " + ofToString(maxCost / 1000), 13, 0, 0);
 
       if (maxCost > entireFrameUs)
          ofSetColor(255, 0, 0);
@@ -169,10 +189,53 @@ void Profiler::Draw()
 
       ofTranslate(0, 15);
    }
+
+   DrawLockContention();
+
    ofPopStyle();
    ofPopMatrix();
 }
 
+//static
+void Profiler::DrawLockContention()
+{
+   ofTranslate(0, 15);
+   NamedMutex::ForEachTracked([](const std::string& name, const MutexContentionStats& stats)
+                              {
+                                 const auto& audioWait = stats.mAudioThreadWait;
+                                 ofSetColor(255, 255, 255);
+                                 gFont.DrawString("lock '" + name + "': audio waits " + ofToString(audioWait.GetCount()) +
+                                                  "  p99 " + ofToString(audioWait.GetPercentileUs(.99f)) + "us" +
+                                                  "  max " + ofToString(audioWait.mMaxNs / 1000) + "us" +
+                                                  "  | other waits p99 " + ofToString(stats.mOtherThreadWait.GetPercentileUs(.99f)) + "us" +
+                                                  "  | hold p99 " + ofToString(stats.mHold.GetPercentileUs(.99f)) + "us" +
+                                                  "  max " + ofToString(stats.mHold.mMaxNs / 1000) + "us",
+                                                  13, 0, 0);
+                                 ofTranslate(0, 15);
+
+                                 //who the audio thread was stuck behind, worst first
+                                 std::vector<const MutexContentionStats::Locker*> blockers;
+                                 for (const auto& locker : stats.mLockers)
+                                 {
+                                    if (locker.mNameReady && locker.mAudioThreadBlocks > 0)
+                                       blockers.push_back(&locker);
+                                 }
+                                 std::sort(blockers.begin(), blockers.end(), [](const MutexContentionStats::Locker* a, const MutexContentionStats::Locker* b)
+                                           {
+                                              return a->mAudioThreadBlockedNs > b->mAudioThreadBlockedNs;
+                                           });
+                                 for (const auto* locker : blockers)
+                                 {
+                                    ofSetColor(255, 120, 0);
+                                    gFont.DrawString("   blocked by " + std::string(locker->mName) + ": " + ofToString(locker->mAudioThreadBlocks) +
+                                                     "x, " + ofToString(locker->mAudioThreadBlockedNs / 1000) + "us total, longest hold " +
+                                                     ofToString(locker->mMaxHoldNs / 1000) + "us",
+                                                     13, 0, 0);
+                                    ofTranslate(0, 15);
+                                 }
+                              });
+}
+
 //static
 long Profiler::GetSafeFrameLengthNanoseconds()
 {
@@ -185,15 +248,31 @@ long Profiler::GetSafeFrameLengthNanoseconds()
 void Profiler::ToggleProfiler()
 {
    sEnableProfiler = !sEnableProfiler;
+   NamedMutex::SetContentionTrackingEnabled(sEnableProfiler);
 
    for (int i = 0; i < PROFILER_MAX_TRACK; ++i)
-      sCosts[i].mName[0] = 0;
+   {
+      sCosts[i].mName = nullptr;
+      sCosts[i].mHash = 0;
+      sCosts[i].mFrameCost = 0;
+   }
+}
+
+//static
+int64_t Profiler::GetTicks()
+{
+   return juce::Time::getHighResolutionTicks();
+}
+
+//static
+double Profiler::GetTicksPerBuffer()
+{
+   return juce::Time::getHighResolutionTicksPerSecond() * (double)gBufferSize / gSampleRate;
 }
 
 void Profiler::Cost::EndFrame()
 {
-   mHistory[mHistoryIdx] = mFrameCost;
-   mFrameCost = 0;
+   mHistory[mHistoryIdx] = mFrameCost.exchange(0, std::memory_order_relaxed);
    ++mHistoryIdx;
    if (mHistoryIdx >= PROFILER_HISTORY_LENGTH)
       mHistoryIdx = 0;
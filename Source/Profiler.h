@@ -27,6 +27,8 @@
 
 #include "OpenFrameworksPort.h"
 
+#include <atomic>
+
 #define PROFILER_HISTORY_LENGTH 500
 #define PROFILER_MAX_TRACK 100
 
@@ -45,26 +47,40 @@ public:
 
    static void ToggleProfiler();
 
+   //per-module cpu accounting, done around each audio source's Process() by AudioExecutionPlan::ProcessSource().
+   //cheap enough to leave on, it's enabled while the overlay pref is on or something (like a ModuleProfilerPanel) requests it
+   static void UpdateModuleTimingEnabled(bool overlayEnabled) { sEnableModuleTiming = overlayEnabled || sModuleTimingRequests > 0; }
+   static bool IsModuleTimingEnabled() { return sEnableModuleTiming; }
+   static void RequestModuleTiming(bool request) { sModuleTimingRequests += request ? 1 : -1; }
+   static int64_t GetTicks();
+   static double GetTicksPerBuffer();
+
 private:
    static long GetSafeFrameLengthNanoseconds();
+   static void DrawLockContention();
 
+   //slots are claimed and added to from any thread that processes audio, so the audio graph workers can profile at the same time
    struct Cost
    {
       void EndFrame();
       unsigned long long MaxCost() const;
 
-      std::string mName;
-      uint32_t mHash{ 0 };
-      unsigned long long mFrameCost{ 0 };
+      std::atomic<uint32_t> mHash{ 0 }; //0 for a free slot
+      std::atomic<const char*> mName{ nullptr }; //set once the hash is claimed
+      std::atomic<unsigned long long> mFrameCost{ 0 };
       unsigned long long mHistory[PROFILER_HISTORY_LENGTH]{};
       int mHistoryIdx{ 0 };
    };
 
    unsigned long long mTimerStart{ 0 };
    int mIndex{ -1 };
+   const char* mName{ nullptr };
+   uint64_t mTraceStartNs{ 0 }; //set when ProfilerTrace is recording
 
    static Cost sCosts[PROFILER_MAX_TRACK];
    static bool sEnableProfiler;
+   static bool sEnableModuleTiming;
+   static std::atomic<int> sModuleTimingRequests;
 
    static std::array<float, 50> sCpuUsageHistory;
    static int sCpuUsageHistoryIndex;
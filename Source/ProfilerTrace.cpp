@@ -0,0 +1,165 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ProfilerTrace.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ProfilerTrace.h"
+#include "SynthGlobals.h"
+
+#include "juce_core/juce_core.h"
+
+#include <cstdio>
+
+std::atomic<bool> ProfilerTrace::sRecording{ false };
+std::atomic<uint64_t> ProfilerTrace::sWriteIndex{ 0 };
+uint64_t ProfilerTrace::sStartNs = 0;
+std::vector<ProfilerTrace::Event> ProfilerTrace::sEvents;
+
+namespace
+{
+   const int kMaxThreads = 64;
+   const int kMaxThreadNameLength = 23;
+   const char* kCategoryNames[kNumTraceCategories] = { "profiler", "process", "draw", "poll", "lock" };
+
+   std::atomic<int> sNumThreads{ 0 };
+   char sThreadNames[kMaxThreads][kMaxThreadNameLength + 1]{};
+   thread_local int tThreadIndex = -1;
+
+   void WriteEscaped(FILE* file, const char* text)
+   {
+      for (const char* c = text; *c != 0; ++c)
+      {
+         if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+         if ((unsigned char)*c >= ' ')
+            fputc(*c, file);
+      }
+   }
+}
+
+ProfilerTrace::Scope::Scope(const char* name, TraceCategory category)
+: mName(name)
+, mCategory(category)
+{
+   if (IsRecording())
+      mStartNs = ofGetSystemTimeNanos();
+}
+
+ProfilerTrace::Scope::~Scope()
+{
+   if (mStartNs != 0)
+      Record(mName, mCategory, mStartNs, ofGetSystemTimeNanos());
+}
+
+//static
+void ProfilerTrace::Start()
+{
+   if (IsRecording())
+      return;
+
+   //allocated once, the first time, and kept: writers on other threads can still be finishing an event after a stop
+   if (sEvents.empty())
+      sEvents.resize(kCapacity);
+   sWriteIndex = 0;
+   sStartNs = ofGetSystemTimeNanos();
+   sRecording = true;
+}
+
+//static
+int ProfilerTrace::GetThreadIndex()
+{
+   if (tThreadIndex == -1)
+   {
+      int index = sNumThreads.fetch_add(1);
+      if (index >= kMaxThreads)
+         index = kMaxThreads - 1; //everything past the limit shares the last track
+      else if (IsAudioThread())
+         snprintf(sThreadNames[index], sizeof(sThreadNames[index]), "audio");
+      else if (IsMainThread())
+         snprintf(sThreadNames[index], sizeof(sThreadNames[index]), "main");
+      else
+         snprintf(sThreadNames[index], sizeof(sThreadNames[index]), "thread %d", index);
+      tThreadIndex = index;
+   }
+   return tThreadIndex;
+}
+
+//static
+void ProfilerTrace::Record(const char* name, TraceCategory category, uint64_t startNs, uint64_t endNs)
+{
+   if (!IsRecording())
+      return;
+
+   uint64_t index = sWriteIndex.fetch_add(1, std::memory_order_relaxed);
+   Event& event = sEvents[index & (kCapacity - 1)];
+   event.mStartNs = startNs;
+   event.mDurationNs = endNs - startNs;
+   event.mThread = (uint16_t)GetThreadIndex();
+   event.mCategory = (uint8_t)category;
+   strncpy(event.mName, name, kMaxNameLength);
+   event.mName[kMaxNameLength] = 0;
+}
+
+//static
+bool ProfilerTrace::StopAndSave(std::string path)
+{
+   if (!IsRecording())
+      return false;
+   sRecording = false;
+
+   //let anything that was mid-Record() finish writing its event
+   juce::Thread::sleep(20);
+
+   FILE* file = fopen(path.c_str(), "w");
+   if (file == nullptr)
+      return false;
+
+   uint64_t written = sWriteIndex.load();
+   uint64_t first = written > (uint64_t)kCapacity ? written - kCapacity : 0;
+
+   fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+   int numThreads = MIN(sNumThreads.load(), kMaxThreads);
+   for (int i = 0; i < numThreads; ++i)
+      fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", i, sThreadNames[i]);
+
+   for (uint64_t i = first; i < written; ++i)
+   {
+      const Event& event = sEvents[i & (kCapacity - 1)];
+      if (event.mStartNs < sStartNs || event.mCategory >= kNumTraceCategories)
+         continue; //left over from an earlier recording, or torn by a late writer
+
+      fprintf(file, "{\"name\":\"%s", event.mCategory == kTraceCategory_LockWait ? "lock wait: " : "");
+      WriteEscaped(file, event.mName);
+      //chrome's timestamps are in microseconds, fractions keep the ns resolution
+      fprintf(file, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n",
+              kCategoryNames[event.mCategory], event.mThread, (event.mStartNs - sStartNs) / 1000.0, event.mDurationNs / 1000.0);
+   }
+
+   //the trailing comma above is fine for chrome and perfetto, but close it off with a real event so it's valid json too
+   fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Bespoke Synth\"}}\n]}\n");
+   fclose(file);
+
+   ofLog() << "wrote " << (written - first) << " trace events to " << path;
+   return true;
+}
@@ -0,0 +1,88 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ProfilerTrace.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum TraceCategory
+{
+   kTraceCategory_Profiler, //PROFILER() scopes
+   kTraceCategory_Process, //each audio source's Process()
+   kTraceCategory_Draw,
+   kTraceCategory_Poll,
+   kTraceCategory_LockWait,
+   kNumTraceCategories
+};
+
+//timeline recording for the profiler: while recording, timed scopes from every thread go into a preallocated ring
+//(nothing is allocated or locked to record one), and StopAndSave() writes them as chrome trace event json,
+//which chrome://tracing and ui.perfetto.dev both open. the ring keeps the most recent kCapacity events, so stopping
+//right after a glitch shows what every thread was doing around the callback that overran.
+//started and stopped with the "trace" console command
+class ProfilerTrace
+{
+public:
+   static const int kCapacity = 1 << 18;
+   static const int kMaxNameLength = 44;
+
+   class Scope
+   {
+   public:
+      Scope(const char* name, TraceCategory category);
+      ~Scope();
+
+   private:
+      const char* mName;
+      TraceCategory mCategory;
+      uint64_t mStartNs{ 0 };
+   };
+
+   static void Start();
+   static bool StopAndSave(std::string path);
+   static bool IsRecording() { return sRecording.load(std::memory_order_relaxed); }
+   static void Record(const char* name, TraceCategory category, uint64_t startNs, uint64_t endNs);
+
+private:
+   struct Event
+   {
+      uint64_t mStartNs;
+      uint64_t mDurationNs;
+      uint16_t mThread;
+      uint8_t mCategory;
+      char mName[kMaxNameLength + 1];
+   };
+
+   static int GetThreadIndex();
+
+   static std::atomic<bool> sRecording;
+   static std::atomic<uint64_t> sWriteIndex;
+   static uint64_t sStartNs;
+   static std::vector<Event> sEvents;
+};
@@ -31,6 +31,7 @@
 #include "Transport.h"
 
 PulseChance::PulseChance()
+: mAccepted(gBufferSize)
 {
    Reseed();
 }
@@ -108,6 +109,37 @@ void PulseChance::OnPulse(double time, float velocity, int flags)
       return;
    }
 
+   if (Roll(flags))
+      DispatchPulse(GetPatchCableSource(), time, velocity, flags);
+}
+
+void PulseChance::OnPulses(const PulseBatch& batch)
+{
+   ComputeSliders(0);
+
+   if (!mEnabled)
+   {
+      DispatchPulses(GetPatchCableSource(), batch);
+      return;
+   }
+
+   mAccepted.Clear(batch.GetBufferStartTime());
+   for (int i = 0; i < batch.GetNumPulses(); ++i)
+   {
+      if (!Roll(batch.GetFlags(i)))
+         continue;
+      if (mAccepted.IsFull())
+      {
+         DispatchPulses(GetPatchCableSource(), mAccepted);
+         mAccepted.Clear(batch.GetBufferStartTime());
+      }
+      mAccepted.Add(batch.GetOffset(i), batch.GetVelocity(i), batch.GetFlags(i));
+   }
+   DispatchPulses(GetPatchCableSource(), mAccepted);
+}
+
+bool PulseChance::Roll(int flags)
+{
    if (flags & kPulseFlag_Reset)
       mRandomIndex = 0;
 
@@ -123,13 +155,11 @@ void PulseChance::OnPulse(double time, float velocity, int flags)
    }
 
    bool accept = random <= mChance;
-   if (accept)
-      DispatchPulse(GetPatchCableSource(), time, velocity, flags);
-
    if (accept)
       mLastAcceptTime = gTime;
    else
       mLastRejectTime = gTime;
+   return accept;
 }
 
 void PulseChance::Reseed()
@@ -48,6 +48,7 @@ public:
 
    //IPulseReceiver
    void OnPulse(double time, float velocity, int flags) override;
+   void OnPulses(const PulseBatch& batch) override;
 
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
    void TextEntryComplete(TextEntry* entry) override {}
@@ -64,6 +65,9 @@ private:
    void GetModuleDimensions(float& width, float& height) override;
 
    void Reseed();
+   bool Roll(int flags); //whether a pulse gets through
+
+   PulseBatch mAccepted;
 
    float mChance{ 1 };
    FloatSlider* mChanceSlider{ nullptr };
@@ -111,11 +111,39 @@ void PulseDelayer::OnPulse(double time, float velocity, int flags)
    if (velocity > 0)
       mLastPulseTime = time;
 
+   QueuePulse(time + GetDelayMs(), velocity, flags);
+}
+
+void PulseDelayer::OnPulses(const PulseBatch& batch)
+{
+   if (!mEnabled)
+   {
+      DispatchPulses(GetPatchCableSource(), batch);
+      return;
+   }
+
+   double delayMs = GetDelayMs();
+   for (int i = 0; i < batch.GetNumPulses(); ++i)
+   {
+      double time = batch.GetTime(i);
+      if (batch.GetVelocity(i) > 0)
+         mLastPulseTime = time;
+      QueuePulse(time + delayMs, batch.GetVelocity(i), batch.GetFlags(i));
+   }
+}
+
+double PulseDelayer::GetDelayMs() const
+{
+   return mDelay / (float(TheTransport->GetTimeSigTop()) / TheTransport->GetTimeSigBottom()) * TheTransport->MsPerBar();
+}
+
+void PulseDelayer::QueuePulse(double triggerTime, float velocity, int flags)
+{
    if ((mAppendIndex + 1) % kQueueSize != mConsumeIndex)
    {
       PulseInfo info;
       info.mVelocity = velocity;
-      info.mTriggerTime = time + mDelay / (float(TheTransport->GetTimeSigTop()) / TheTransport->GetTimeSigBottom()) * TheTransport->MsPerBar();
+      info.mTriggerTime = triggerTime;
       info.mFlags = flags;
       mInputPulses[mAppendIndex] = info;
       mAppendIndex = (mAppendIndex + 1) % kQueueSize;
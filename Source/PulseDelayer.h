@@ -50,6 +50,7 @@ public:
 
    //IPulseReceiver
    void OnPulse(double time, float velocity, int flags) override;
+   void OnPulses(const PulseBatch& batch) override;
 
    void OnTransportAdvanced(float amount) override;
 
@@ -77,6 +78,9 @@ private:
       height = 22;
    }
 
+   void QueuePulse(double triggerTime, float velocity, int flags);
+   double GetDelayMs() const;
+
    float mDelay{ .25 };
    FloatSlider* mDelaySlider{ nullptr };
 
@@ -78,6 +78,17 @@ void PulseDisplayer::OnPulse(double time, float velocity, int flags)
    DispatchPulse(GetPatchCableSource(), time, velocity, flags);
 }
 
+void PulseDisplayer::OnPulses(const PulseBatch& batch)
+{
+   if (batch.GetNumPulses() > 0)
+   {
+      mLastReceivedFlags = batch.GetFlags(batch.GetNumPulses() - 1);
+      mLastReceivedFlagTime = gTime;
+   }
+
+   DispatchPulses(GetPatchCableSource(), batch);
+}
+
 void PulseDisplayer::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
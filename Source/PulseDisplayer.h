@@ -45,6 +45,7 @@ public:
 
    //IPulseReceiver
    void OnPulse(double time, float velocity, int flags) override;
+   void OnPulses(const PulseBatch& batch) override;
 
    void LoadLayout(const ofxJSONElement& moduleInfo) override;
    void SetUpFromSaveData() override;
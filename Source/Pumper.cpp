@@ -58,6 +58,7 @@ void Pumper::CreateUIControls()
    FLOATSLIDER(mAttackSlider, "attack", &mAttack, 0, 1);
    DROPDOWN(mIntervalSelector, "interval", (int*)(&mInterval), 40);
    UIBLOCK_SHIFTRIGHT();
+   TEXTENTRY(mSidechainEntry, "sidechain", 7, &mSidechainName);
    ENDUIBLOCK(mWidth, mHeight);
 
    mIntervalSelector->AddLabel("1n", kInterval_1n);
@@ -83,6 +84,21 @@ void Pumper::ProcessAudio(double time, ChannelBuffer* buffer)
 
    ComputeSliders(0);
 
+   if (mSidechainChannel != nullptr)
+   {
+      //the producer's envelope is read in place. with nothing published on the channel, there's nothing to duck for
+      const float* envelope = SidechainBus::Read(mSidechainChannel, time).mEnvelope;
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         float target = envelope != nullptr ? 1 - mAmount * MIN(envelope[i], 1) : 1;
+         float value = mLastValue * .99f + target * .01f;
+         for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
+            buffer->GetChannel(ch)[i] *= value;
+         mLastValue = value;
+      }
+      return;
+   }
+
    double intervalPos = GetIntervalPos(time);
 
    ADSR::EventInfo adsrEvent(0, kAdsrTime);
@@ -117,6 +133,7 @@ void Pumper::DrawModule()
    mCurveSlider->Draw();
    mAttackSlider->Draw();
    mIntervalSelector->Draw();
+   mSidechainEntry->Draw();
 
    ofPushStyle();
    ofSetColor(0, 200, 0, 50);
@@ -173,6 +190,15 @@ void Pumper::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
    }
 }
 
+void Pumper::TextEntryComplete(TextEntry* entry)
+{
+   if (entry == mSidechainEntry)
+   {
+      mSidechainChannel = SidechainBus::Get().Subscribe(this, mSidechainName);
+      TheSynth->ArrangeAudioSourceDependencies();
+   }
+}
+
 void Pumper::SyncToAdsr()
 {
    mAmount = 1 - mAdsr.GetStageData(0).target;
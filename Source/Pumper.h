@@ -30,8 +30,10 @@
 #include "Slider.h"
 #include "DropdownList.h"
 #include "LFO.h"
+#include "TextEntry.h"
+#include "SidechainBus.h"
 
-class Pumper : public IAudioEffect, public IDropdownListener, public IFloatSliderListener
+class Pumper : public IAudioEffect, public IDropdownListener, public IFloatSliderListener, public ITextEntryListener
 {
 public:
    Pumper();
@@ -51,6 +53,7 @@ public:
    void DropdownUpdated(DropdownList* list, int oldVal, double time) override;
    void CheckboxUpdated(Checkbox* checkbox, double time) override {}
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
+   void TextEntryComplete(TextEntry* entry) override;
 
    void SaveState(FileStreamOut& out) override;
    void LoadState(FileStreamIn& in, int rev) override;
@@ -73,6 +76,9 @@ private:
    ::ADSR mAdsr;
    NoteInterval mInterval{ NoteInterval::kInterval_4n };
    DropdownList* mIntervalSelector{ nullptr };
+   std::string mSidechainName; //duck by a sidechain bus channel's envelope, rather than on the interval
+   TextEntry* mSidechainEntry{ nullptr };
+   SidechainBus::Channel* mSidechainChannel{ nullptr };
    float mLastValue{ 0 };
    float mAmount{ 0 };
    float mLength{ 0 };
@@ -68,8 +68,10 @@ Push2Control::Push2Control()
 , mDevice(this)
 {
    Initialize();
-   for (int i = 0; i < 128 * 2; ++i)
-      mLedState[i] = -1;
+   mLedState.SetSender([this](const std::vector<LedFramebuffer::Change>& changes, const LedFramebuffer& leds)
+                       {
+                          SendLeds(changes);
+                       });
    for (int i = 0; i < (int)mModuleGrid.size(); ++i)
       mModuleGrid[i] = nullptr;
    for (int i = 0; i < kNumQuantizeButtons; ++i)
@@ -78,20 +80,22 @@ Push2Control::Push2Control()
 
 Push2Control::~Push2Control()
 {
+   mLedState.SetSender(nullptr);
 }
 
 void Push2Control::Exit()
 {
    for (int i = 0; i < 128; ++i)
-   {
-      SetLed(i, 0);
       SetLed(i, 0);
-   }
+   //out now, rather than on the led thread, since the device is about to go
+   mLedState.Invalidate();
+   mLedState.Flush();
 
    if (mPixels != nullptr)
    {
       memset(mPixels, 0, sizeof(unsigned char) * GetNumDisplayPixels());
       ThePushBridge.Flip(mPixels);
+      mLastFlippedPixels.clear();
    }
 
    mDevice.DisconnectInput();
@@ -198,7 +202,14 @@ void Push2Control::DrawDisplayModuleRect(ofRectangle rect, float thickness)
 void Push2Control::PostRender()
 {
    if (ThePushBridge.IsInitialized())
-      RenderPush2Display();
+   {
+      double now = juce::Time::getMillisecondCounterHiRes();
+      if (now - mLastDisplayRenderTime >= kDisplayRefreshIntervalMs)
+      {
+         mLastDisplayRenderTime = now;
+         RenderPush2Display();
+      }
+   }
 }
 
 void Push2Control::KeyPressed(int key, bool isRepeat)
@@ -359,6 +370,7 @@ bool Push2Control::Initialize()
       {
          mDevice.ConnectOutput(i);
          mDevice.ConnectInput(devices[i].c_str());
+         mLedState.Invalidate();
 
          std::string touchStripConfig = { 0x00, 0x21, 0x1D, 0x01, 0x01, 0x17, 0x03 };
          mDevice.SendSysEx(touchStripConfig);
@@ -643,7 +655,6 @@ void Push2Control::DrawToFramebuffer(NVGcontext* vg, NVGLUframebuffer* fb, float
 
    nvgEndFrame(vg);
 
-   glFinish();
    glReadBuffer(juce::gl::GL_COLOR_ATTACHMENT0);
    glReadPixels(0, 0, winWidth, winHeight, juce::gl::GL_RGB, GL_UNSIGNED_BYTE, mPixels);
 
@@ -1066,6 +1077,11 @@ void Push2Control::RenderPush2Display()
    sDrawingPush2Display = false;
    gNanoVG = mainVG;
 
+   //the bridge converts the whole frame every flip, so skip it when nothing on the display changed
+   if (mLastFlippedPixels.size() == GetNumDisplayPixels() && memcmp(mLastFlippedPixels.data(), mPixels, GetNumDisplayPixels()) == 0)
+      return;
+   mLastFlippedPixels.assign(mPixels, mPixels + GetNumDisplayPixels());
+
    // Tells the bridge we're done with drawing and the frame can be sent to the display
    ThePushBridge.Flip(mPixels);
 }
@@ -1277,24 +1293,44 @@ void Push2Control::SetLed(int index, int color, int flashColor /*=-1*/)
    int channel = 1;
    if (flashColor != -1)
       channel = 10;
-   int stateValue = color | channel << 8;
-   if (mLedState[index] != stateValue)
-   {
+   mLedState.Set(index, color | channel << 8 | (flashColor + 1) << 16);
+}
+
+//led output thread
+void Push2Control::SendLeds(const std::vector<LedFramebuffer::Change>& changes)
+{
+   //the push has no batched led message, but one block of them is still far fewer trips than one message each
+   juce::MidiBuffer messages;
+   int defaultChannel = mDevice.GetOutputChannel();
+   for (const auto& change : changes)
+   {
+      int index = change.mIndex;
+      int color = change.mValue & 0xff;
+      int channel = (change.mValue >> 8) & 0xff;
+      int flashColor = (change.mValue >> 16) - 1;
+      if (channel == 0)
+         channel = 1; //never set since the last reset
+
       //bool isPulse = (channel >= 7 && channel <= 11);
-      mLedState[index] = stateValue;
       if (index < 128)
       {
-         if (flashColor != -1)
-            mDevice.SendNote(gTime, index, flashColor, false, -1);
-         mDevice.SendNote(gTime, index, color, false, channel);
+         if (flashColor > 0)
+            messages.addEvent(juce::MidiMessage::noteOn(defaultChannel, index, (juce::uint8)flashColor), 0);
+         else if (flashColor == 0)
+            messages.addEvent(juce::MidiMessage::noteOff(defaultChannel, index), 0);
+         if (color > 0)
+            messages.addEvent(juce::MidiMessage::noteOn(channel, index, (juce::uint8)color), 0);
+         else
+            messages.addEvent(juce::MidiMessage::noteOff(channel, index), 0);
       }
       else
       {
          if (flashColor != -1)
-            mDevice.SendCC(index - 128, flashColor);
-         mDevice.SendCC(index - 128, color, channel);
+            messages.addEvent(juce::MidiMessage::controllerEvent(defaultChannel, index - 128, flashColor), 0);
+         messages.addEvent(juce::MidiMessage::controllerEvent(channel, index - 128, color), 0);
       }
    }
+   mDevice.SendMessagesNow(messages);
 }
 
 bool Push2Control::GetButtonState(int index) const
@@ -30,6 +30,7 @@
 #include "IDrawableModule.h"
 #include "MidiDevice.h"
 #include "MidiController.h"
+#include "LedFramebuffer.h"
 #include "TitleBar.h"
 #include "DropdownList.h"
 #include "AbletonDeviceShared.h"
@@ -110,6 +111,7 @@ private:
    void RenderPush2Display();
 
    void SetModuleGridLights();
+   void SendLeds(const std::vector<LedFramebuffer::Change>& changes);
    void DrawDisplayModuleControls();
    void DrawLowerModuleSelector();
    void DrawRoutingDisplay();
@@ -138,6 +140,8 @@ private:
    void SetGridControlInterface(IAbletonGridController* controller, IDrawableModule* module);
 
    unsigned char* mPixels{ nullptr };
+   std::vector<unsigned char> mLastFlippedPixels;
+   double mLastDisplayRenderTime{ 0 };
    const int kPixelRatio = 1;
 
    const float kColumnSpacing = 121;
@@ -221,10 +225,10 @@ private:
    IDrawableModule* mGridControlModule{ nullptr };
    bool mDisplayModuleCanControlGrid{ false };
 
-   int mLedState[128 * 2]{}; //bottom 128 are notes, top 128 are CCs
    bool mButtonState[128 * 2]{}; //bottom 128 are notes, top 128 are CCs
 
    MidiDevice mDevice;
+   LedFramebuffer mLedState{ 128 * 2 }; //bottom 128 are notes, top 128 are CCs. color | channel << 8 | (flash color + 1) << 16
 
    SpawnListManager mSpawnLists;
    int mPendingSpawnPitch{ -1 };
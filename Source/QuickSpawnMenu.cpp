@@ -28,6 +28,7 @@
 #include "QuickSpawnMenu.h"
 #include "ModularSynth.h"
 #include "ModuleFactory.h"
+#include "SpawnIndex.h"
 #include "TitleBar.h"
 #include "PatchCable.h"
 #include "PatchCableSource.h"
@@ -207,6 +208,10 @@ void QuickSpawnMenu::UpdateDisplay()
    }
    else
    {
+      //new plugins, prefabs and midi devices get picked up as the menu opens, not on every key press
+      if (!IsShowing())
+         TheSynth->GetModuleFactory()->GetSpawnIndex()->Refresh();
+
       if (mMenuMode == MenuMode::ModuleCategories)
       {
          mElements.clear();
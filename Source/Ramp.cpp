@@ -74,6 +74,46 @@ float Ramp::Value(double time) const
    return retVal;
 }
 
+void Ramp::ValueBlock(double startTime, double timeStep, float* out, int numSamples) const
+{
+   int i = 0;
+   while (i < numSamples)
+   {
+      //stick with the current ramp until a later one starts
+      double time = startTime + i * timeStep;
+      const RampData* rampData = GetCurrentRampData(time);
+      double nextStartTime = DBL_MAX;
+      for (const auto& data : mRampDatas)
+      {
+         if (data.mStartTime >= time && data.mStartTime < nextStartTime)
+            nextStartTime = data.mStartTime;
+      }
+
+      double length = rampData->mEndTime - rampData->mStartTime;
+      do
+      {
+         time = startTime + i * timeStep;
+         float value;
+         if (rampData->mStartTime == -1 || time <= rampData->mStartTime)
+         {
+            value = rampData->mStartValue;
+         }
+         else if (time >= rampData->mEndTime)
+         {
+            value = rampData->mEndValue;
+         }
+         else
+         {
+            value = rampData->mStartValue + (time - rampData->mStartTime) / length * (rampData->mEndValue - rampData->mStartValue);
+            if (fabsf(value) < FLT_EPSILON)
+               value = 0;
+         }
+         out[i] = value;
+         ++i;
+      } while (i < numSamples && startTime + i * timeStep <= nextStartTime);
+   }
+}
+
 const Ramp::RampData* Ramp::GetCurrentRampData(double time) const
 {
    int ret = 0;
@@ -35,6 +35,8 @@ public:
    void SetValue(float val);
    bool HasValue(double time) const;
    float Value(double time) const;
+   //out[i] = Value(startTime + i * timeStep)
+   void ValueBlock(double startTime, double timeStep, float* out, int numSamples) const;
    float Target(double time) const { return GetCurrentRampData(time)->mEndValue; }
 
 private:
@@ -0,0 +1,154 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    RandomBlock.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "RandomBlock.h"
+#include "SynthGlobals.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+   const uint64_t kGoldenGamma = 0x9e3779b97f4a7c15uLL;
+   const float kInv24Bit = 1.0f / 16777216.0f;
+   const float kInv16Bit = 1.0f / 65536.0f;
+   const float kPinkGain = .125f;
+}
+
+RandomBlock::RandomBlock()
+: RandomBlock(gRandom())
+{
+}
+
+RandomBlock::RandomBlock(uint64_t seed)
+{
+   Seed(seed);
+}
+
+void RandomBlock::Seed(uint64_t seed)
+{
+   //every word of every lane from its own point along one splitmix64 sequence, so no two lanes start out related
+   uint64_t* words[4] = { mS0, mS1, mS2, mS3 };
+   int n = 0;
+   for (int word = 0; word < 4; ++word)
+   {
+      for (int lane = 0; lane < kLanes; ++lane)
+         words[word][lane] = bespoke::core::detail::splitmix64(seed + kGoldenGamma * n++);
+   }
+   for (float& pink : mPink)
+      pink = 0;
+}
+
+void RandomBlock::FillBits()
+{
+   uint64_t s0[kLanes], s1[kLanes], s2[kLanes], s3[kLanes];
+   std::copy(mS0, mS0 + kLanes, s0);
+   std::copy(mS1, mS1 + kLanes, s1);
+   std::copy(mS2, mS2 + kLanes, s2);
+   std::copy(mS3, mS3 + kLanes, s3);
+
+   for (int step = 0; step < kStepsPerChunk; ++step)
+   {
+      uint64_t* out = mBits + step * kLanes;
+      for (int lane = 0; lane < kLanes; ++lane)
+      {
+         //rotl(s1 * 5, 7) * 9, with the multiplies spelled as shifts and adds, which vectorize without 64 bit multiplies
+         uint64_t times5 = (s1[lane] << 2) + s1[lane];
+         uint64_t rotated = (times5 << 7) | (times5 >> 57);
+         out[lane] = (rotated << 3) + rotated;
+
+         uint64_t t = s1[lane] << 17;
+         s2[lane] ^= s0[lane];
+         s3[lane] ^= s1[lane];
+         s1[lane] ^= s2[lane];
+         s0[lane] ^= s3[lane];
+         s2[lane] ^= t;
+         s3[lane] = (s3[lane] << 45) | (s3[lane] >> 19);
+      }
+   }
+
+   std::copy(s0, s0 + kLanes, mS0);
+   std::copy(s1, s1 + kLanes, mS1);
+   std::copy(s2, s2 + kLanes, mS2);
+   std::copy(s3, s3 + kLanes, mS3);
+}
+
+void RandomBlock::FillUniform(float* out, int length, float min, float max)
+{
+   //two 24 bit floats out of each word
+   float scale = (max - min) * kInv24Bit;
+   for (int i = 0; i < length; i += kChunkSize * 2)
+   {
+      FillBits();
+      float chunk[kChunkSize * 2];
+      for (int j = 0; j < kChunkSize; ++j)
+      {
+         chunk[j * 2] = (mBits[j] >> 40) * scale + min;
+         chunk[j * 2 + 1] = ((mBits[j] >> 8) & 0xffffff) * scale + min;
+      }
+      int count = std::min(kChunkSize * 2, length - i);
+      std::copy(chunk, chunk + count, out + i);
+   }
+}
+
+void RandomBlock::FillGaussian(float* out, int length, float mean, float stdDev)
+{
+   //four 16 bit uniforms per word. their sum has a variance of 1/3, hence the sqrt(3)
+   float scale = stdDev * sqrtf(3.0f);
+   for (int i = 0; i < length; i += kChunkSize)
+   {
+      FillBits();
+      float chunk[kChunkSize];
+      for (int j = 0; j < kChunkSize; ++j)
+      {
+         uint64_t bits = mBits[j];
+         uint32_t sum = (uint32_t)(bits & 0xffff) + (uint32_t)((bits >> 16) & 0xffff) + (uint32_t)((bits >> 32) & 0xffff) + (uint32_t)(bits >> 48);
+         chunk[j] = (sum * kInv16Bit - 2.0f) * scale + mean;
+      }
+      int count = std::min(kChunkSize, length - i);
+      std::copy(chunk, chunk + count, out + i);
+   }
+}
+
+void RandomBlock::FillPink(float* out, int length)
+{
+   //paul kellet's economy pink filter over white noise
+   FillUniform(out, length, -1, 1);
+   float b0 = mPink[0];
+   float b1 = mPink[1];
+   float b2 = mPink[2];
+   for (int i = 0; i < length; ++i)
+   {
+      float white = out[i];
+      b0 = .99765f * b0 + white * .0990460f;
+      b1 = .96300f * b1 + white * .2965164f;
+      b2 = .57000f * b2 + white * 1.0526913f;
+      out[i] = (b0 + b1 + b2 + white * .1848f) * kPinkGain;
+   }
+   mPink[0] = b0;
+   mPink[1] = b1;
+   mPink[2] = b2;
+}
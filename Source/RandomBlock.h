@@ -0,0 +1,59 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    RandomBlock.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+//several xoshiro256** streams stepped side by side, for filling whole blocks with noise instead of asking gRandom and a
+//distribution for every sample. the state is one array per word with a lane per stream, so a step is shifts, xors and adds
+//across the lanes that the compiler can keep in vector registers
+class RandomBlock
+{
+public:
+   RandomBlock(); //seeded from gRandom, so a seeded session gets the same noise back
+   explicit RandomBlock(uint64_t seed);
+   void Seed(uint64_t seed);
+
+   void FillUniform(float* out, int length, float min, float max);
+   void FillBipolar(float* out, int length) { FillUniform(out, length, -1, 1); }
+   void FillGaussian(float* out, int length, float mean, float stdDev); //a sum of four uniforms, which is plenty for noise and jitter
+   void FillPink(float* out, int length); //peaks around -1 to 1. the filter's state carries over from the previous block
+
+private:
+   static constexpr int kLanes = 4;
+   static constexpr int kStepsPerChunk = 16;
+   static constexpr int kChunkSize = kLanes * kStepsPerChunk;
+
+   void FillBits(); //kChunkSize fresh words into mBits
+
+   uint64_t mS0[kLanes]{};
+   uint64_t mS1[kLanes]{};
+   uint64_t mS2[kLanes]{};
+   uint64_t mS3[kLanes]{};
+   uint64_t mBits[kChunkSize]{};
+   float mPink[3]{};
+};
@@ -33,19 +33,16 @@
 
 #include <cstring>
 
-namespace
-{
-   double sineBuffer[514] = { 0, 0.012268, 0.024536, 0.036804, 0.049042, 0.06131, 0.073547, 0.085785, 0.097992, 0.1102, 0.12241, 0.13455, 0.1467, 0.15884, 0.17093, 0.18301, 0.19507, 0.20709, 0.21909, 0.23105, 0.24295, 0.25485, 0.26669, 0.2785, 0.29025, 0.30197, 0.31366, 0.32529, 0.33685, 0.34839, 0.35986, 0.37128, 0.38266, 0.39395, 0.40521, 0.41641, 0.42752, 0.4386, 0.44958, 0.46051, 0.47137, 0.48215, 0.49286, 0.50351, 0.51407, 0.52457, 0.53497, 0.54529, 0.55554, 0.5657, 0.57578, 0.58575, 0.59567, 0.60547, 0.6152, 0.62482, 0.63437, 0.6438, 0.65314, 0.66238, 0.67151, 0.68057, 0.68951, 0.69833, 0.70706, 0.7157, 0.72421, 0.7326, 0.74091, 0.74908, 0.75717, 0.76514, 0.77298, 0.7807, 0.7883, 0.79581, 0.80316, 0.81042, 0.81754, 0.82455, 0.83142, 0.8382, 0.84482, 0.85132, 0.8577, 0.86392, 0.87006, 0.87604, 0.88187, 0.8876, 0.89319, 0.89862, 0.90396, 0.90912, 0.91415, 0.91907, 0.92383, 0.92847, 0.93295, 0.93729, 0.9415, 0.94556, 0.94949, 0.95325, 0.95691, 0.96039, 0.96375, 0.96692, 0.97, 0.9729, 0.97565, 0.97827, 0.98074, 0.98306, 0.98523, 0.98724, 0.98914, 0.99084, 0.99243, 0.99387, 0.99515, 0.99628, 0.99725, 0.99808, 0.99875, 0.99927, 0.99966, 0.99988, 0.99997, 0.99988, 0.99966, 0.99927, 0.99875, 0.99808, 0.99725, 0.99628, 0.99515, 0.99387, 0.99243, 0.99084, 0.98914, 0.98724, 0.98523, 0.98306, 0.98074, 0.97827, 0.97565, 0.9729, 0.97, 0.96692, 0.96375, 0.96039, 0.95691, 0.95325, 0.94949, 0.94556, 0.9415, 0.93729, 0.93295, 0.92847, 0.92383, 0.91907, 0.91415, 0.90912, 0.90396, 0.89862, 0.89319, 0.8876, 0.88187, 0.87604, 0.87006, 0.86392, 0.8577, 0.85132, 0.84482, 0.8382, 0.83142, 0.82455, 0.81754, 0.81042, 0.80316, 0.79581, 0.7883, 0.7807, 0.77298, 0.76514, 0.75717, 0.74908, 0.74091, 0.7326, 0.72421, 0.7157, 0.70706, 0.69833, 0.68951, 0.68057, 0.67151, 0.66238, 0.65314, 0.6438, 0.63437, 0.62482, 0.6152, 0.60547, 0.59567, 0.58575, 0.57578, 0.5657, 0.55554, 0.54529, 0.53497, 0.52457, 0.51407, 0.50351, 0.49286, 0.48215, 0.47137, 0.46051, 0.44958, 0.4386, 0.42752, 0.41641, 0.40521, 0.39395, 0.38266, 0.37128, 0.35986, 0.34839, 0.33685, 0.32529, 0.31366, 0.30197, 0.29025, 0.2785, 0.26669, 0.25485, 0.24295, 0.23105, 0.21909, 0.20709, 0.19507, 0.18301, 0.17093, 0.15884, 0.1467, 0.13455, 0.12241, 0.1102, 0.097992, 0.085785, 0.073547, 0.06131, 0.049042, 0.036804, 0.024536, 0.012268, 0, -0.012268, -0.024536, -0.036804, -0.049042, -0.06131, -0.073547, -0.085785, -0.097992, -0.1102, -0.12241, -0.13455, -0.1467, -0.15884, -0.17093, -0.18301, -0.19507, -0.20709, -0.21909, -0.23105, -0.24295, -0.25485, -0.26669, -0.2785, -0.29025, -0.30197, -0.31366, -0.32529, -0.33685, -0.34839, -0.35986, -0.37128, -0.38266, -0.39395, -0.40521, -0.41641, -0.42752, -0.4386, -0.44958, -0.46051, -0.47137, -0.48215, -0.49286, -0.50351, -0.51407, -0.52457, -0.53497, -0.54529, -0.55554, -0.5657, -0.57578, -0.58575, -0.59567, -0.60547, -0.6152, -0.62482, -0.63437, -0.6438, -0.65314, -0.66238, -0.67151, -0.68057, -0.68951, -0.69833, -0.70706, -0.7157, -0.72421, -0.7326, -0.74091, -0.74908, -0.75717, -0.76514, -0.77298, -0.7807, -0.7883, -0.79581, -0.80316, -0.81042, -0.81754, -0.82455, -0.83142, -0.8382, -0.84482, -0.85132, -0.8577, -0.86392, -0.87006, -0.87604, -0.88187, -0.8876, -0.89319, -0.89862, -0.90396, -0.90912, -0.91415, -0.91907, -0.92383, -0.92847, -0.93295, -0.93729, -0.9415, -0.94556, -0.94949, -0.95325, -0.95691, -0.96039, -0.96375, -0.96692, -0.97, -0.9729, -0.97565, -0.97827, -0.98074, -0.98306, -0.98523, -0.98724, -0.98914, -0.99084, -0.99243, -0.99387, -0.99515, -0.99628, -0.99725, -0.99808, -0.99875, -0.99927, -0.99966, -0.99988, -0.99997, -0.99988, -0.99966, -0.99927, -0.99875, -0.99808, -0.99725, -0.99628, -0.99515, -0.99387, -0.99243, -0.99084, -0.98914, -0.98724, -0.98523, -0.98306, -0.98074, -0.97827, -0.97565, -0.9729, -0.97, -0.96692, -0.96375, -0.96039, -0.95691, -0.95325, -0.94949, -0.94556, -0.9415, -0.93729, -0.93295, -0.92847, -0.92383, -0.91907, -0.91415, -0.90912, -0.90396, -0.89862, -0.89319, -0.8876, -0.88187, -0.87604, -0.87006, -0.86392, -0.8577, -0.85132, -0.84482, -0.8382, -0.83142, -0.82455, -0.81754, -0.81042, -0.80316, -0.79581, -0.7883, -0.7807, -0.77298, -0.76514, -0.75717, -0.74908, -0.74091, -0.7326, -0.72421, -0.7157, -0.70706, -0.69833, -0.68951, -0.68057, -0.67151, -0.66238, -0.65314, -0.6438, -0.63437, -0.62482, -0.6152, -0.60547, -0.59567, -0.58575, -0.57578, -0.5657, -0.55554, -0.54529, -0.53497, -0.52457, -0.51407, -0.50351, -0.49286, -0.48215, -0.47137, -0.46051, -0.44958, -0.4386, -0.42752, -0.41641, -0.40521, -0.39395, -0.38266, -0.37128, -0.35986, -0.34839, -0.33685, -0.32529, -0.31366, -0.30197, -0.29025, -0.2785, -0.26669, -0.25485, -0.24295, -0.23105, -0.21909, -0.20709, -0.19507, -0.18301, -0.17093, -0.15884, -0.1467, -0.13455, -0.12241, -0.1102, -0.097992, -0.085785, -0.073547, -0.06131, -0.049042, -0.036804, -0.024536, -0.012268, 0, 0.012268 };
-}
-
 Razor::Razor()
+: mBank(NUM_PARTIALS)
 {
    std::memset(mAmp, 0, sizeof(float) * NUM_PARTIALS);
    std::memset(mPeakHistory, 0, sizeof(float) * (VIZ_WIDTH + 1) * RAZOR_HISTORY);
-   std::memset(mPhases, 0, sizeof(float) * NUM_PARTIALS);
 
    for (int i = 0; i < NUM_PARTIALS; ++i)
       mDetune[i] = 1;
+
+   mBank.SetMode(GetBankMode()); //so the latency is right from the first plan we're in, not just from the first Process()
 }
 
 void Razor::CreateUIControls()
@@ -70,6 +67,7 @@ void Razor::CreateUIControls()
    mNegHarmonicsSlider = new IntSlider(this, "neg harmonics", 335, 120, 160, 15, &mNegHarmonics, 1, 10);
    mHarshnessCutSlider = new FloatSlider(this, "harshness cut", 500, 120, 160, 15, &mHarshnessCut, 0, 20000);
    mManualControlCheckbox = new Checkbox(this, "manual control", 4, 145, &mManualControl);
+   mInverseFFTCheckbox = new Checkbox(this, "fft synthesis", 330, 145, &mInverseFFT);
 
    for (int i = 0; i < NUM_AMP_SLIDERS; ++i)
    {
@@ -106,33 +104,29 @@ void Razor::Process(double time)
    if (!mManualControl)
       CalcAmp();
 
-   for (int i = 0; i < bufferSize; ++i)
-   {
-      float freq = TheScale->PitchToFreq(mPitch + (mPitchBend ? mPitchBend->GetValue(i) : 0));
-
-      int oscNyquistLimitIdx = int(gNyquistLimit / freq);
-
-      float write = 0;
-      for (int j = 0; j < mUseNumPartials && j < oscNyquistLimitIdx; ++j)
-      {
-         float phaseInc = 512. / (gSampleRate / (freq)) * (j + 1) * mDetune[j];
-         mPhases[j] += phaseInc;
-         while (mPhases[j] >= 512)
-         {
-            mPhases[j] -= 512;
-         }
-
-         float sample = SinSample(mPhases[j]) * mAdsr[j].Value(time) * mAmp[j] * mVol;
+   //every partial shares the same envelope, so it's applied to the sum instead of to each partial
+   float freq = TheScale->PitchToFreq(mPitch + (mPitchBend ? mPitchBend->GetValue(0) : 0));
+   float phaseInc = GetPhaseInc(freq);
+   mBank.SetMode(GetBankMode());
+   mBank.SetNumPartials(mUseNumPartials);
+   for (int j = 0; j < mUseNumPartials; ++j)
+      mBank.SetPartial(j, phaseInc * (j + 1) * mDetune[j], mAmp[j]);
 
-         write += sample;
-      }
+   float* write = gWorkBuffer;
+   ::Clear(write, bufferSize);
+   mBank.Process(write, bufferSize);
 
-      GetVizBuffer()->Write(write, 0);
+   //the partials come out of the bank late when it runs on the compute offload, the envelope has to be just as late
+   double envelopeTime = time - mBank.GetLatencySamples() * gInvSampleRateMs;
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      write[i] *= mAdsr.Value(envelopeTime) * mVol;
+      envelopeTime += gInvSampleRateMs;
+   }
 
-      out[i] += write;
+   GetVizBuffer()->WriteChunk(write, bufferSize, 0);
 
-      time += gInvSampleRateMs;
-   }
+   Add(out, write, bufferSize);
 }
 
 void Razor::PlayNote(NoteMessage note)
@@ -145,14 +139,11 @@ void Razor::PlayNote(NoteMessage note)
       float amount = note.velocity / 127.0f;
 
       mPitch = note.pitch;
-      for (int i = 1; i <= NUM_PARTIALS; ++i)
-      {
-         mAdsr[i - 1].Start(note.time, amount,
-                            mA,
-                            mD,
-                            mS,
-                            mR);
-      }
+      mAdsr.Start(note.time, amount,
+                  mA,
+                  mD,
+                  mS,
+                  mR);
 
       mPitchBend = note.modulation.pitchBend;
       mModWheel = note.modulation.modWheel;
@@ -160,8 +151,7 @@ void Razor::PlayNote(NoteMessage note)
    }
    else if (mPitch == note.pitch)
    {
-      for (int i = 0; i < NUM_PARTIALS; ++i)
-         mAdsr[i].Stop(note.time);
+      mAdsr.Stop(note.time);
    }
 }
 
@@ -193,6 +183,7 @@ void Razor::DrawModule()
       mRSlider->Draw();
 
       mManualControlCheckbox->Draw();
+      mInverseFFTCheckbox->Draw();
       for (int i = 0; i < NUM_AMP_SLIDERS; ++i)
       {
          mAmpSliders[i]->Draw();
@@ -238,7 +229,7 @@ void Razor::DrawViz()
    std::memset(mPeakHistory[mHistoryPtr], 0, sizeof(float) * VIZ_WIDTH);
    for (int i = 1; i <= mUseNumPartials && i <= oscNyquistLimitIdx; ++i)
    {
-      float height = mAdsr[i - 1].Value(gTime) * mAmp[i - 1];
+      float height = mAdsr.Value(gTime) * mAmp[i - 1];
       int intHeight = int(height * 100.0f);
       if (intHeight == 0)
       {
@@ -267,13 +258,6 @@ void Razor::DrawViz()
    ofPopStyle();
 }
 
-float Razor::SinSample(float phase)
-{
-   int intPhase = int(phase) % 512;
-   float remainder = phase - int(phase);
-   return ((1 - remainder) * sineBuffer[intPhase] + remainder * sineBuffer[1 + intPhase]);
-}
-
 bool IsPrime(int n)
 {
    if (n == 1)
@@ -349,10 +333,28 @@ void Razor::SetEnabled(bool enabled)
    mEnabled = enabled;
 }
 
+AdditiveBank::Mode Razor::GetBankMode() const
+{
+   return mInverseFFT ? AdditiveBank::Mode::kInverseFFT : AdditiveBank::Mode::kCompute;
+}
+
+int Razor::GetLatencySamples() const
+{
+   return mBank.GetLatencySamples();
+}
+
 void Razor::CheckboxUpdated(Checkbox* checkbox, double time)
 {
    if (checkbox == mEnabledCheckbox)
       SetEnabled(mEnabled);
+   if (checkbox == mInverseFFTCheckbox)
+   {
+      //switching to or from the compute offload changes our latency
+      int latency = mBank.GetLatencySamples();
+      mBank.SetMode(GetBankMode());
+      if (mBank.GetLatencySamples() != latency)
+         TheSynth->RebuildExecutionPlan();
+   }
    if (checkbox == mManualControlCheckbox)
    {
       if (mManualControl)
@@ -368,7 +370,7 @@ void Razor::IntSliderUpdated(IntSlider* slider, int oldVal, double time)
 {
    if (slider == mNumPartialsSlider)
    {
-      std::memset(mPhases, 0, sizeof(float) * NUM_PARTIALS);
+      mBank.ResetPhases();
    }
 }
 
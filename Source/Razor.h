@@ -28,6 +28,7 @@
 #include "IAudioSource.h"
 #include "INoteReceiver.h"
 #include "ADSR.h"
+#include "AdditiveBank.h"
 #include "IDrawableModule.h"
 #include "Checkbox.h"
 #include "Slider.h"
@@ -61,6 +62,7 @@ public:
    //IAudioSource
    void Process(double time) override;
    void SetEnabled(bool enabled) override;
+   int GetLatencySamples() const override;
 
    //INoteReceiver
    void PlayNote(NoteMessage note) override;
@@ -75,11 +77,12 @@ public:
    virtual void SetUpFromSaveData() override;
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override { return sizeof(mAmp) + sizeof(mDetune) + sizeof(mPeakHistory); }
 
 private:
-   float SinSample(float phase); //phase 0-512
    void CalcAmp();
    void DrawViz();
+   AdditiveBank::Mode GetBankMode() const;
 
    //IDrawableModule
    void DrawModule() override;
@@ -91,9 +94,9 @@ private:
 
    float mVol{ .05 };
    float mPhase{ 0 };
-   ::ADSR mAdsr[NUM_PARTIALS]{};
+   ::ADSR mAdsr;
+   AdditiveBank mBank;
    float mAmp[NUM_PARTIALS]{};
-   float mPhases[NUM_PARTIALS]{};
    float mDetune[NUM_PARTIALS]{};
 
    int mPitch{ -1 };
@@ -125,6 +128,8 @@ private:
 
    bool mManualControl{ false };
    Checkbox* mManualControlCheckbox{ nullptr };
+   bool mInverseFFT{ false };
+   Checkbox* mInverseFFTCheckbox{ nullptr };
    FloatSlider* mAmpSliders[NUM_AMP_SLIDERS]{ nullptr };
    FloatSlider* mDetuneSliders[NUM_AMP_SLIDERS]{ nullptr };
    ClickButton* mResetDetuneButton{ nullptr };
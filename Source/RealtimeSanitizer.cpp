@@ -0,0 +1,339 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    RealtimeSanitizer.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "RealtimeSanitizer.h"
+#include "SynthGlobals.h"
+
+#include "juce_core/juce_core.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if !BESPOKE_WINDOWS
+#include <execinfo.h>
+#include <pthread.h>
+#endif
+
+#if BESPOKE_REALTIME_SANITIZER
+
+#ifdef BESPOKE_DEBUG_ALLOCATIONS
+#error BESPOKE_DEBUG_ALLOCATIONS and BESPOKE_REALTIME_SANITIZER both replace operator new, pick one
+#endif
+
+namespace
+{
+   const int kMaxStacks = 512;
+   const int kMaxFrames = 48;
+
+   struct Violation
+   {
+      std::atomic<uint64_t> mHash{ 0 }; //0 for a free slot
+      std::atomic<uint32_t> mCount{ 0 };
+      const char* mViolation{ nullptr };
+   };
+
+   std::atomic<bool> sEnabled{ true };
+   std::array<Violation, kMaxStacks> sViolations;
+   std::atomic<uint32_t> sTotalViolations{ 0 };
+   std::atomic<uint32_t> sDroppedStacks{ 0 };
+
+   //set while reporting, so the reporting itself (which allocates and writes to stderr) doesn't report
+   thread_local int tSuppressDepth = 0;
+
+   uint64_t HashStack(void* const* frames, int numFrames, const char* violation)
+   {
+      //fnv-1a over the return addresses and what happened there
+      uint64_t hash = 14695981039346656037ull;
+      auto mix = [&hash](uint64_t value)
+      {
+         hash ^= value;
+         hash *= 1099511628211ull;
+      };
+      for (int i = 0; i < numFrames; ++i)
+         mix((uint64_t)(uintptr_t)frames[i]);
+      mix((uint64_t)(uintptr_t)violation);
+      return hash == 0 ? 1 : hash;
+   }
+}
+
+//static
+void RealtimeSanitizer::Check(const char* violation, const char* detail)
+{
+   if (tSuppressDepth > 0 || !sEnabled.load(std::memory_order_relaxed) || !IsAudioThread())
+      return;
+
+   ScopedSuppress suppress;
+   sTotalViolations.fetch_add(1, std::memory_order_relaxed);
+
+#if BESPOKE_WINDOWS
+   juce::String stack = juce::SystemStats::getStackBacktrace();
+   uint64_t hash = (uint64_t)stack.hashCode64() ^ (uint64_t)(uintptr_t)violation;
+   if (hash == 0)
+      hash = 1;
+#else
+   void* frames[kMaxFrames];
+   int numFrames = backtrace(frames, kMaxFrames);
+   uint64_t hash = HashStack(frames, numFrames, violation);
+#endif
+
+   for (auto& slot : sViolations)
+   {
+      uint64_t slotHash = slot.mHash.load(std::memory_order_acquire);
+      if (slotHash == hash)
+      {
+         slot.mCount.fetch_add(1, std::memory_order_relaxed);
+         return;
+      }
+      if (slotHash == 0)
+      {
+         uint64_t expected = 0;
+         if (!slot.mHash.compare_exchange_strong(expected, hash))
+         {
+            if (expected == hash)
+            {
+               slot.mCount.fetch_add(1, std::memory_order_relaxed);
+               return;
+            }
+            continue;
+         }
+
+         slot.mViolation = violation;
+         slot.mCount.store(1, std::memory_order_relaxed);
+
+         //only the first time for each call stack, after that it's just counted
+         fprintf(stderr, "[realtime sanitizer] %s on the audio thread%s%s\n", violation, detail ? ": " : "", detail ? detail : "");
+#if BESPOKE_WINDOWS
+         fprintf(stderr, "%s\n", stack.toRawUTF8());
+#else
+         //frame 0 is this function
+         backtrace_symbols_fd(frames + 1, numFrames - 1, fileno(stderr));
+         fprintf(stderr, "\n");
+#endif
+         return;
+      }
+   }
+
+   sDroppedStacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+//static
+void RealtimeSanitizer::SetEnabled(bool enabled)
+{
+   sEnabled = enabled;
+}
+
+//static
+bool RealtimeSanitizer::IsEnabled()
+{
+   return sEnabled;
+}
+
+//static
+void RealtimeSanitizer::PrintSummary()
+{
+   ScopedSuppress suppress;
+   int numStacks = 0;
+   for (const auto& slot : sViolations)
+   {
+      if (slot.mHash == 0 || slot.mViolation == nullptr)
+         continue;
+      ++numStacks;
+      ofLog() << "realtime sanitizer: " << slot.mViolation << " x" << slot.mCount.load() << " (stack " << juce::String::toHexString((juce::int64)slot.mHash.load()) << ")";
+   }
+   ofLog() << "realtime sanitizer: " << sTotalViolations.load() << " violations from " << numStacks << " call stacks (" << sDroppedStacks.load() << " more past the first " << kMaxStacks << ")";
+}
+
+RealtimeSanitizer::ScopedSuppress::ScopedSuppress()
+{
+   ++tSuppressDepth;
+}
+
+RealtimeSanitizer::ScopedSuppress::~ScopedSuppress()
+{
+   --tSuppressDepth;
+}
+
+#undef new
+
+#if BESPOKE_REALTIME_SANITIZER_WRAP_LIBC
+//malloc and free get checked by their wrappers below
+#define CHECK_HEAP(violation)
+#else
+#define CHECK_HEAP(violation) RealtimeSanitizer::Check(violation)
+#endif
+
+void* operator new(std::size_t size)
+{
+   CHECK_HEAP("operator new");
+   void* ptr = malloc(size);
+   if (ptr == nullptr)
+      throw std::bad_alloc();
+   return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+   CHECK_HEAP("operator new[]");
+   void* ptr = malloc(size);
+   if (ptr == nullptr)
+      throw std::bad_alloc();
+   return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+   CHECK_HEAP("operator new");
+   return malloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+   CHECK_HEAP("operator new[]");
+   return malloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+   if (p != nullptr)
+      CHECK_HEAP("operator delete");
+   free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+   if (p != nullptr)
+      CHECK_HEAP("operator delete[]");
+   free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+   operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+   operator delete[](p);
+}
+
+#if BESPOKE_REALTIME_SANITIZER_WRAP_LIBC
+//linked with -Wl,--wrap=<name>, so every call to <name> from our own code (juce included, it's built into the app) lands here
+extern "C"
+{
+   void* __real_malloc(size_t size);
+   void* __real_calloc(size_t count, size_t size);
+   void* __real_realloc(void* ptr, size_t size);
+   void __real_free(void* ptr);
+   int __real_pthread_mutex_lock(pthread_mutex_t* mutex);
+   FILE* __real_fopen(const char* path, const char* mode);
+   size_t __real_fread(void* ptr, size_t size, size_t count, FILE* file);
+   size_t __real_fwrite(const void* ptr, size_t size, size_t count, FILE* file);
+   int __real_fclose(FILE* file);
+
+   void* __wrap_malloc(size_t size)
+   {
+      RealtimeSanitizer::Check("malloc");
+      return __real_malloc(size);
+   }
+
+   void* __wrap_calloc(size_t count, size_t size)
+   {
+      RealtimeSanitizer::Check("calloc");
+      return __real_calloc(count, size);
+   }
+
+   void* __wrap_realloc(void* ptr, size_t size)
+   {
+      RealtimeSanitizer::Check("realloc");
+      return __real_realloc(ptr, size);
+   }
+
+   void __wrap_free(void* ptr)
+   {
+      if (ptr != nullptr)
+         RealtimeSanitizer::Check("free");
+      __real_free(ptr);
+   }
+
+   int __wrap_pthread_mutex_lock(pthread_mutex_t* mutex)
+   {
+      RealtimeSanitizer::Check("mutex lock");
+      return __real_pthread_mutex_lock(mutex);
+   }
+
+   FILE* __wrap_fopen(const char* path, const char* mode)
+   {
+      RealtimeSanitizer::Check("fopen", path);
+      return __real_fopen(path, mode);
+   }
+
+   size_t __wrap_fread(void* ptr, size_t size, size_t count, FILE* file)
+   {
+      RealtimeSanitizer::Check("fread");
+      return __real_fread(ptr, size, count, file);
+   }
+
+   size_t __wrap_fwrite(const void* ptr, size_t size, size_t count, FILE* file)
+   {
+      RealtimeSanitizer::Check("fwrite");
+      return __real_fwrite(ptr, size, count, file);
+   }
+
+   int __wrap_fclose(FILE* file)
+   {
+      RealtimeSanitizer::Check("fclose");
+      return __real_fclose(file);
+   }
+}
+#endif
+
+#else
+
+void RealtimeSanitizer::Check(const char* violation, const char* detail)
+{
+}
+void RealtimeSanitizer::SetEnabled(bool enabled)
+{
+}
+bool RealtimeSanitizer::IsEnabled()
+{
+   return false;
+}
+void RealtimeSanitizer::PrintSummary()
+{
+   ofLog() << "This only works with BESPOKE_REALTIME_SANITIZER defined";
+}
+RealtimeSanitizer::ScopedSuppress::ScopedSuppress()
+{
+}
+RealtimeSanitizer::ScopedSuppress::~ScopedSuppress()
+{
+}
+
+#endif
@@ -0,0 +1,57 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    RealtimeSanitizer.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//debug mode that reports anything on the audio thread that can block: heap allocations, mutex locks and file i/o.
+//build with -DBESPOKE_REALTIME_SANITIZER=ON. every distinct call stack is printed to stderr the first time it's hit,
+//and counted after that, so the hot path can be checked for being allocation and lock free by running a patch and
+//reading what comes out. the "rtsanitizer" console command prints the counts.
+//
+//operator new/delete are replaced everywhere. on linux malloc/free, pthread_mutex_lock and the libc file calls
+//are wrapped at link time too (BESPOKE_REALTIME_SANITIZER_WRAP_LIBC), elsewhere locks are only seen through NamedMutex
+class RealtimeSanitizer
+{
+public:
+   static void Check(const char* violation, const char* detail = nullptr);
+   static void SetEnabled(bool enabled);
+   static bool IsEnabled();
+   static void PrintSummary();
+
+   //for code that's already been reported by the caller, like the lock under NamedMutex::Lock()
+   class ScopedSuppress
+   {
+   public:
+      ScopedSuppress();
+      ~ScopedSuppress();
+   };
+};
+
+#if BESPOKE_REALTIME_SANITIZER
+#define REALTIME_SANITIZER_CHECK(violation, detail) RealtimeSanitizer::Check(violation, detail)
+#else
+#define REALTIME_SANITIZER_CHECK(violation, detail)
+#endif
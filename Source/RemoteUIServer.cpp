@@ -0,0 +1,806 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    RemoteUIServer.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "RemoteUIServer.h"
+#include "IDrawableModule.h"
+#include "IUIControl.h"
+#include "ModularSynth.h"
+#include "PatchCable.h"
+#include "PatchCableSource.h"
+#include "SynthGlobals.h"
+
+#include "juce_gui_basics/juce_gui_basics.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+//the protocol is text frames of tab separated lines, one per thing the client draws.
+//the first field of a line is its kind and the second its key, so a later line with the same two replaces it:
+//
+//   v  view  <draw offset x>  <draw offset y>  <draw scale>
+//   m  <module path>  <type>  <x>  <y>  <width>  <height>  <minimized>  <enabled>
+//   p  <module path>  <cable target path>...                  all of the module's cables, in one line
+//   c  <control path>  <x>  <y>  <width>  <height>  <value 0-1>  <display value>         position relative to its module
+//   -  <kind>  <key>                                             the line with this kind and key is gone
+//   reset                                                        a full state follows, drop everything
+//
+//clients send lines too, with the modifiers held as a bitmask (1 shift, 2 alt, 4 control, 8 command).
+//the first has to be the token the server printed when it started, or the connection is closed:
+//
+//   auth  <token>
+//   resize  <width>  <height>
+//   move  <x>  <y>  <modifiers>
+//   down  <x>  <y>  <button>  <modifiers>                        button 1 left, 2 right, 3 middle
+//   up  <x>  <y>  <button>  <modifiers>
+//   wheel  <dx>  <dy>  <modifiers>
+//   keydown  <key>  <repeat>  <modifiers>                        key is a character code, or left/right/up/down/delete/backspace/return/escape/tab
+//   keyup  <key>  <modifiers>
+//   set  <control path>  <value 0-1>
+
+namespace
+{
+   const double kSendIntervalMs = 33;
+   const size_t kMaxPendingBytes = 8 << 20; //past this a client isn't keeping up, it gets a fresh state once it catches up instead
+   const size_t kMaxMessageBytes = 1 << 20;
+   const int kHandshakeTimeoutMs = 5000;
+
+   //only the websocket handshake needs this, juce doesn't have it
+   std::string Sha1(const std::string& text)
+   {
+      uint32_t h[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+      auto rotate = [](uint32_t value, int bits)
+      { return (value << bits) | (value >> (32 - bits)); };
+
+      std::string message = text;
+      uint64_t bitLength = (uint64_t)text.size() * 8;
+      message += (char)0x80;
+      while (message.size() % 64 != 56)
+         message += (char)0;
+      for (int i = 7; i >= 0; --i)
+         message += (char)((bitLength >> (i * 8)) & 0xff);
+
+      for (size_t chunk = 0; chunk < message.size(); chunk += 64)
+      {
+         uint32_t w[80];
+         for (int i = 0; i < 16; ++i)
+         {
+            const unsigned char* bytes = (const unsigned char*)message.data() + chunk + i * 4;
+            w[i] = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+         }
+         for (int i = 16; i < 80; ++i)
+            w[i] = rotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+         uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+         for (int i = 0; i < 80; ++i)
+         {
+            uint32_t f, k;
+            if (i < 20)
+            {
+               f = (b & c) | (~b & d);
+               k = 0x5a827999;
+            }
+            else if (i < 40)
+            {
+               f = b ^ c ^ d;
+               k = 0x6ed9eba1;
+            }
+            else if (i < 60)
+            {
+               f = (b & c) | (b & d) | (c & d);
+               k = 0x8f1bbcdc;
+            }
+            else
+            {
+               f = b ^ c ^ d;
+               k = 0xca62c1d6;
+            }
+            uint32_t temp = rotate(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotate(b, 30);
+            b = a;
+            a = temp;
+         }
+         h[0] += a;
+         h[1] += b;
+         h[2] += c;
+         h[3] += d;
+         h[4] += e;
+      }
+
+      std::string digest;
+      for (uint32_t word : h)
+      {
+         for (int i = 3; i >= 0; --i)
+            digest += (char)((word >> (i * 8)) & 0xff);
+      }
+      return digest;
+   }
+
+   std::string MakeFrame(int opcode, const char* data, size_t size)
+   {
+      std::string frame;
+      frame += (char)(0x80 | opcode); //always a final frame, the server never fragments
+      if (size < 126)
+      {
+         frame += (char)size;
+      }
+      else if (size <= 0xffff)
+      {
+         frame += (char)126;
+         frame += (char)((size >> 8) & 0xff);
+         frame += (char)(size & 0xff);
+      }
+      else
+      {
+         frame += (char)127;
+         for (int i = 7; i >= 0; --i)
+            frame += (char)(((uint64_t)size >> (i * 8)) & 0xff);
+      }
+      frame.append(data, size);
+      return frame;
+   }
+
+   std::vector<std::string> SplitFields(const std::string& line)
+   {
+      std::vector<std::string> fields;
+      size_t start = 0;
+      while (true)
+      {
+         size_t tab = line.find('\t', start);
+         fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+         if (tab == std::string::npos)
+            return fields;
+         start = tab + 1;
+      }
+   }
+
+   void AppendField(std::string& line, const std::string& text)
+   {
+      line += '\t';
+      for (char c : text)
+         line += (c == '\t' || c == '\n' || c == '\r') ? ' ' : c;
+   }
+
+   void AppendField(std::string& line, float value)
+   {
+      char number[32];
+      snprintf(number, sizeof(number), "\t%g", value);
+      line += number;
+   }
+
+   void SetModifiers(int modifiers, int heldButton)
+   {
+      int flags = 0;
+      if (modifiers & 1)
+         flags |= juce::ModifierKeys::shiftModifier;
+      if (modifiers & 2)
+         flags |= juce::ModifierKeys::altModifier;
+      if (modifiers & 4)
+         flags |= juce::ModifierKeys::ctrlModifier;
+      if (modifiers & 8)
+         flags |= juce::ModifierKeys::commandModifier;
+      if (heldButton == 1)
+         flags |= juce::ModifierKeys::leftButtonModifier;
+      else if (heldButton == 2)
+         flags |= juce::ModifierKeys::rightButtonModifier;
+      else if (heldButton == 3)
+         flags |= juce::ModifierKeys::middleButtonModifier;
+      juce::ModifierKeys::currentModifiers = juce::ModifierKeys(flags);
+   }
+
+   int ParseKey(const std::string& key)
+   {
+      if (key == "left")
+         return juce::KeyPress::leftKey;
+      if (key == "right")
+         return juce::KeyPress::rightKey;
+      if (key == "up")
+         return juce::KeyPress::upKey;
+      if (key == "down")
+         return juce::KeyPress::downKey;
+      if (key == "delete")
+         return juce::KeyPress::deleteKey;
+      if (key == "backspace")
+         return juce::KeyPress::backspaceKey;
+      if (key == "return")
+         return juce::KeyPress::returnKey;
+      if (key == "escape")
+         return juce::KeyPress::escapeKey;
+      if (key == "tab")
+         return juce::KeyPress::tabKey;
+      return atoi(key.c_str());
+   }
+}
+
+//one connection, on its own thread. it does the handshake, queues the lines that come in for the main thread,
+//and writes out what the main thread queued for it
+class RemoteUIServer::Client : private juce::Thread
+{
+public:
+   Client(RemoteUIServer& server, std::unique_ptr<juce::StreamingSocket> socket, int id)
+   : juce::Thread("remote ui client " + juce::String(id))
+   , mServer(server)
+   , mSocket(std::move(socket))
+   {
+      startThread();
+   }
+
+   ~Client() override
+   {
+      signalThreadShouldExit();
+      stopThread(1000);
+      mSocket->close();
+   }
+
+   bool IsConnected() const { return mConnected && mAuthenticated; }
+   bool IsClosed() const { return mClosed; }
+   bool TakeSnapshotRequest() { return mWantsSnapshot.exchange(false); }
+
+   void Send(const std::string& text) //main thread
+   {
+      std::string frame = MakeFrame(0x1, text.data(), text.size());
+      std::lock_guard<std::mutex> lock(mSendMutex);
+      if (mPendingSend.size() + frame.size() > kMaxPendingBytes)
+      {
+         mPendingSend.clear();
+         mWantsSnapshot = true;
+         return;
+      }
+      mPendingSend += frame;
+   }
+
+private:
+   //juce::Thread
+   void run() override
+   {
+      if (Handshake())
+      {
+         mConnected = true;
+
+         double connectedMs = juce::Time::getMillisecondCounterHiRes();
+         std::string toSend;
+         while (!threadShouldExit())
+         {
+            if (!mAuthenticated && juce::Time::getMillisecondCounterHiRes() - connectedMs > kHandshakeTimeoutMs)
+               break;
+
+            {
+               std::lock_guard<std::mutex> lock(mSendMutex);
+               toSend.swap(mPendingSend);
+            }
+            if (!toSend.empty() && !Write(toSend))
+               break;
+            toSend.clear();
+
+            int ready = mSocket->waitUntilReady(true, 10);
+            if (ready < 0 || (ready > 0 && !ReadFrames()))
+               break;
+         }
+      }
+
+      mConnected = false;
+      mClosed = true;
+   }
+
+   bool Write(const std::string& bytes)
+   {
+      size_t written = 0;
+      while (written < bytes.size())
+      {
+         int result = mSocket->write(bytes.data() + written, (int)(bytes.size() - written));
+         if (result <= 0)
+            return false;
+         written += result;
+      }
+      return true;
+   }
+
+   bool ReadBytes()
+   {
+      char bytes[4096];
+      int numRead = mSocket->read(bytes, sizeof(bytes), false);
+      if (numRead <= 0)
+         return false; //ready to read with nothing there means the other end went away
+      mReceived.append(bytes, numRead);
+      return true;
+   }
+
+   bool Handshake()
+   {
+      double startMs = juce::Time::getMillisecondCounterHiRes();
+      size_t headerEnd;
+      while ((headerEnd = mReceived.find("\r\n\r\n")) == std::string::npos)
+      {
+         if (threadShouldExit() || mReceived.size() > 16384 || juce::Time::getMillisecondCounterHiRes() - startMs > kHandshakeTimeoutMs)
+            return false;
+         int ready = mSocket->waitUntilReady(true, 100);
+         if (ready < 0 || (ready > 0 && !ReadBytes()))
+            return false;
+      }
+
+      std::string key;
+      std::string origin;
+      juce::StringArray headers = juce::StringArray::fromLines(juce::String(mReceived.substr(0, headerEnd)));
+      for (const auto& header : headers)
+      {
+         juce::String name = header.upToFirstOccurrenceOf(":", false, false).trim();
+         if (name.equalsIgnoreCase("sec-websocket-key"))
+            key = header.fromFirstOccurrenceOf(":", false, false).trim().toStdString();
+         else if (name.equalsIgnoreCase("origin"))
+            origin = header.fromFirstOccurrenceOf(":", false, false).trim().toStdString();
+      }
+      mReceived.erase(0, headerEnd + 4);
+
+      if (key.empty())
+      {
+         Write("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+         return false;
+      }
+
+      //browsers always send where the page came from, so any page the user has open can't just connect to localhost
+      if (!origin.empty() && !mServer.IsOriginAllowed(origin))
+      {
+         ofLog() << "remote ui refused a connection from a page on " << origin;
+         Write("HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+         return false;
+      }
+
+      std::string digest = Sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+      juce::String accept = juce::Base64::toBase64(digest.data(), digest.size());
+      return Write("HTTP/1.1 101 Switching Protocols\r\n"
+                   "Upgrade: websocket\r\n"
+                   "Connection: Upgrade\r\n"
+                   "Sec-WebSocket-Accept: " +
+                   accept.toStdString() + "\r\n\r\n");
+   }
+
+   bool ReadFrames()
+   {
+      if (!ReadBytes())
+         return false;
+
+      size_t position = 0;
+      while (mReceived.size() - position >= 2)
+      {
+         const unsigned char* header = (const unsigned char*)mReceived.data() + position;
+         bool isFinal = (header[0] & 0x80) != 0;
+         int opcode = header[0] & 0x0f;
+         bool isMasked = (header[1] & 0x80) != 0;
+         uint64_t length = header[1] & 0x7f;
+         size_t headerSize = 2;
+         if (length == 126)
+         {
+            if (mReceived.size() - position < 4)
+               break;
+            length = ((uint64_t)header[2] << 8) | header[3];
+            headerSize = 4;
+         }
+         else if (length == 127)
+         {
+            if (mReceived.size() - position < 10)
+               break;
+            length = 0;
+            for (int i = 0; i < 8; ++i)
+               length = (length << 8) | header[2 + i];
+            headerSize = 10;
+         }
+         if (length > kMaxMessageBytes)
+            return false;
+         size_t maskOffset = headerSize;
+         if (isMasked)
+            headerSize += 4;
+         if (mReceived.size() - position < headerSize + length)
+            break;
+
+         std::string payload = mReceived.substr(position + headerSize, length);
+         if (isMasked)
+         {
+            for (size_t i = 0; i < payload.size(); ++i)
+               payload[i] ^= header[maskOffset + i % 4];
+         }
+         position += headerSize + length;
+
+         if (opcode == 0x0 || opcode == 0x1) //continuation, text
+         {
+            mMessage += payload;
+            if (mMessage.size() > kMaxMessageBytes)
+               return false;
+            if (isFinal)
+            {
+               size_t start = 0;
+               while (start < mMessage.size())
+               {
+                  size_t end = mMessage.find('\n', start);
+                  if (end == std::string::npos)
+                     end = mMessage.size();
+                  if (end > start && !mAuthenticated)
+                  {
+                     std::string line = mMessage.substr(start, end - start);
+                     if (line.compare(0, 5, "auth\t") != 0 || !mServer.IsValidToken(line.substr(5)))
+                     {
+                        ofLog() << "remote ui dropped a client that didn't send the right token";
+                        const char policyViolation[] = { (char)0x03, (char)0xf0 }; //1008
+                        Write(MakeFrame(0x8, policyViolation, sizeof(policyViolation)));
+                        return false;
+                     }
+                     mAuthenticated = true;
+                     mWantsSnapshot = true;
+                  }
+                  else if (end > start)
+                  {
+                     mServer.QueueInput(mMessage.substr(start, end - start));
+                  }
+                  start = end + 1;
+               }
+               mMessage.clear();
+            }
+         }
+         else if (opcode == 0x8) //close
+         {
+            Write(MakeFrame(0x8, payload.data(), MIN(payload.size(), 2)));
+            return false;
+         }
+         else if (opcode == 0x9) //ping
+         {
+            if (!Write(MakeFrame(0xA, payload.data(), payload.size())))
+               return false;
+         }
+      }
+      mReceived.erase(0, position);
+      return true;
+   }
+
+   RemoteUIServer& mServer;
+   std::unique_ptr<juce::StreamingSocket> mSocket;
+   std::atomic<bool> mConnected{ false };
+   std::atomic<bool> mAuthenticated{ false };
+   std::atomic<bool> mClosed{ false };
+   std::atomic<bool> mWantsSnapshot{ false };
+   std::mutex mSendMutex;
+   std::string mPendingSend;
+   std::string mReceived;
+   std::string mMessage;
+};
+
+RemoteUIServer::RemoteUIServer(juce::Component* canvas)
+: juce::Thread("remote ui server")
+, mCanvas(canvas)
+{
+}
+
+RemoteUIServer::~RemoteUIServer()
+{
+   Stop();
+}
+
+//static
+std::string RemoteUIServer::GenerateToken()
+{
+   std::random_device random;
+   char token[33];
+   for (int i = 0; i < 4; ++i)
+      snprintf(token + i * 8, 9, "%08x", (unsigned int)random());
+   return token;
+}
+
+bool RemoteUIServer::Listen(int port, const std::string& bindAddress)
+{
+   Stop();
+
+   mListener = std::make_unique<juce::StreamingSocket>();
+   if (!mListener->createListener(port, bindAddress))
+   {
+      mListener.reset();
+      return false;
+   }
+   startThread();
+   return true;
+}
+
+void RemoteUIServer::Stop()
+{
+   signalThreadShouldExit();
+   if (mListener != nullptr)
+      mListener->close(); //wakes the accept up
+   stopThread(1000);
+   mListener.reset();
+
+   std::lock_guard<std::mutex> lock(mClientsMutex);
+   mClients.clear();
+   mSentState.clear();
+}
+
+int RemoteUIServer::GetNumClients() const
+{
+   std::lock_guard<std::mutex> lock(mClientsMutex);
+   int count = 0;
+   for (const auto& client : mClients)
+   {
+      if (client->IsConnected())
+         ++count;
+   }
+   return count;
+}
+
+void RemoteUIServer::run()
+{
+   while (!threadShouldExit())
+   {
+      //wake up now and then to check whether we should be stopping
+      if (mListener->waitUntilReady(true, 100) <= 0)
+         continue;
+
+      std::unique_ptr<juce::StreamingSocket> socket(mListener->waitForNextConnection());
+      if (socket == nullptr || threadShouldExit())
+         continue;
+
+      ofLog() << "remote ui connected from " << socket->getHostName();
+      std::lock_guard<std::mutex> lock(mClientsMutex);
+      mClients.push_back(std::make_unique<Client>(*this, std::move(socket), mNextClientId++));
+   }
+}
+
+bool RemoteUIServer::IsOriginAllowed(const std::string& origin) const
+{
+   for (const auto& allowed : mAllowedOrigins)
+   {
+      if (juce::String(origin).equalsIgnoreCase(juce::String(allowed)))
+         return true;
+   }
+
+   //pages served from this machine, on any port
+   juce::String text(origin);
+   if (!text.startsWithIgnoreCase("http://") && !text.startsWithIgnoreCase("https://"))
+      return false;
+   juce::String host = text.fromFirstOccurrenceOf("://", false, false).upToFirstOccurrenceOf("/", false, false);
+   if (host.startsWithChar('['))
+      host = host.upToFirstOccurrenceOf("]", true, false);
+   else
+      host = host.upToFirstOccurrenceOf(":", false, false);
+   return host.equalsIgnoreCase("localhost") || host == "127.0.0.1" || host == "[::1]";
+}
+
+bool RemoteUIServer::IsValidToken(const std::string& token) const
+{
+   if (mToken.empty() || token.size() != mToken.size())
+      return false;
+   unsigned char difference = 0; //the same time whichever character is wrong
+   for (size_t i = 0; i < token.size(); ++i)
+      difference |= (unsigned char)(token[i] ^ mToken[i]);
+   return difference == 0;
+}
+
+void RemoteUIServer::QueueInput(const std::string& line)
+{
+   std::lock_guard<std::mutex> lock(mInputMutex);
+   mInput.push_back(line);
+}
+
+void RemoteUIServer::Poll()
+{
+   {
+      std::lock_guard<std::mutex> lock(mInputMutex);
+      mInputToApply.swap(mInput);
+   }
+   for (const auto& line : mInputToApply)
+      ApplyInput(line);
+   mInputToApply.clear();
+
+   double nowMs = juce::Time::getMillisecondCounterHiRes();
+   if (nowMs - mLastSendMs < kSendIntervalMs)
+      return;
+   mLastSendMs = nowMs;
+
+   std::lock_guard<std::mutex> lock(mClientsMutex);
+   for (auto it = mClients.begin(); it != mClients.end();)
+   {
+      if ((*it)->IsClosed())
+      {
+         ofLog() << "remote ui disconnected";
+         it = mClients.erase(it);
+      }
+      else
+      {
+         ++it;
+      }
+   }
+
+   bool anyConnected = false;
+   for (const auto& client : mClients)
+      anyConnected |= client->IsConnected();
+   if (!anyConnected)
+   {
+      mSentState.clear(); //whoever connects next starts from a full state anyway
+      return;
+   }
+
+   mState.clear();
+   CollectState(mState);
+
+   std::string diff;
+   for (const auto& entry : mState)
+   {
+      auto sent = mSentState.find(entry.first);
+      if (sent == mSentState.end() || sent->second != entry.second)
+         diff += entry.second + '\n';
+   }
+   for (const auto& entry : mSentState)
+   {
+      if (mState.find(entry.first) == mState.end())
+         diff += "-\t" + entry.first + '\n';
+   }
+   mSentState.swap(mState);
+
+   std::string snapshot;
+   for (const auto& client : mClients)
+   {
+      if (!client->IsConnected())
+         continue;
+
+      if (client->TakeSnapshotRequest())
+      {
+         if (snapshot.empty())
+         {
+            snapshot = "reset\n";
+            for (const auto& entry : mSentState)
+               snapshot += entry.second + '\n';
+         }
+         client->Send(snapshot);
+      }
+      else if (!diff.empty())
+      {
+         client->Send(diff);
+      }
+   }
+}
+
+void RemoteUIServer::CollectState(std::unordered_map<std::string, std::string>& state) const
+{
+   std::string line = "v\tview";
+   AppendField(line, TheSynth->GetDrawOffset().x);
+   AppendField(line, TheSynth->GetDrawOffset().y);
+   AppendField(line, gDrawScale);
+   state["v\tview"] = line;
+
+   std::vector<IDrawableModule*> modules;
+   TheSynth->GetAllModules(modules);
+   for (auto* module : modules)
+   {
+      if (!module->IsShowing())
+         continue;
+
+      std::string path = module->Path();
+      float x, y, width, height;
+      module->GetPosition(x, y);
+      module->GetDimensions(width, height);
+      line = "m";
+      AppendField(line, path);
+      AppendField(line, module->GetTypeName());
+      AppendField(line, x);
+      AppendField(line, y);
+      AppendField(line, width);
+      AppendField(line, height);
+      AppendField(line, module->Minimized() ? "1" : "0");
+      AppendField(line, module->IsEnabled() ? "1" : "0");
+      state["m\t" + path] = line;
+
+      line = "p";
+      AppendField(line, path);
+      bool hasCables = false;
+      for (auto* source : module->GetPatchCableSources())
+      {
+         for (auto* cable : source->GetPatchCables())
+         {
+            if (cable->GetTarget() != nullptr)
+            {
+               AppendField(line, cable->GetTarget()->Path());
+               hasCables = true;
+            }
+         }
+      }
+      if (hasCables)
+         state["p\t" + path] = line;
+
+      if (module->Minimized())
+         continue;
+
+      for (auto* control : module->GetUIControls())
+      {
+         if (!control->IsShowing())
+            continue;
+
+         std::string controlPath = control->Path();
+         control->GetPosition(x, y, K(local));
+         control->GetDimensions(width, height);
+         line = "c";
+         AppendField(line, controlPath);
+         AppendField(line, x);
+         AppendField(line, y);
+         AppendField(line, width);
+         AppendField(line, height);
+         AppendField(line, control->GetMidiValue());
+         AppendField(line, control->GetDisplayValue(control->GetValue()));
+         state["c\t" + controlPath] = line;
+      }
+   }
+}
+
+void RemoteUIServer::ApplyInput(const std::string& line)
+{
+   std::vector<std::string> fields = SplitFields(line);
+   const std::string& type = fields[0];
+   auto number = [&fields](size_t index)
+   { return index < fields.size() ? atof(fields[index].c_str()) : 0; };
+
+   if (type == "resize")
+   {
+      if (mCanvas != nullptr && number(1) > 0 && number(2) > 0)
+         mCanvas->setSize((int)number(1), (int)number(2));
+   }
+   else if (type == "move")
+   {
+      SetModifiers((int)number(3), mHeldButton);
+      TheSynth->MouseMoved((int)number(1), (int)number(2));
+      if (mHeldButton != -1)
+         TheSynth->MouseDragged((int)number(1), (int)number(2), mHeldButton, juce::Desktop::getInstance().getMainMouseSource());
+   }
+   else if (type == "down")
+   {
+      mHeldButton = (int)number(3);
+      SetModifiers((int)number(4), mHeldButton);
+      TheSynth->MousePressed((int)number(1), (int)number(2), mHeldButton, juce::Desktop::getInstance().getMainMouseSource());
+   }
+   else if (type == "up")
+   {
+      mHeldButton = -1;
+      SetModifiers((int)number(4), mHeldButton);
+      TheSynth->MouseReleased((int)number(1), (int)number(2), (int)number(3), juce::Desktop::getInstance().getMainMouseSource());
+   }
+   else if (type == "wheel")
+   {
+      SetModifiers((int)number(3), mHeldButton);
+      TheSynth->MouseScrolled(number(1), number(2), !K(isSmoothScroll), !K(isInvertedScroll), K(canZoomCanvas));
+   }
+   else if (type == "keydown" && fields.size() > 1)
+   {
+      SetModifiers((int)number(3), mHeldButton);
+      TheSynth->KeyPressed(ParseKey(fields[1]), number(2) != 0);
+   }
+   else if (type == "keyup" && fields.size() > 1)
+   {
+      SetModifiers((int)number(2), mHeldButton);
+      TheSynth->KeyReleased(ParseKey(fields[1]));
+   }
+   else if (type == "set" && fields.size() > 2)
+   {
+      IUIControl* control = TheSynth->FindUIControl(fields[1]);
+      if (control != nullptr)
+         control->SetFromMidiCC(number(2), NextBufferTime(false), !K(setViaModulator));
+   }
+}
@@ -0,0 +1,96 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    RemoteUIServer.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce_core/juce_core.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace juce
+{
+   class Component;
+}
+
+//serves the patch to remote uis over a websocket, for bespoke-server, so the engine can run on one machine and be played
+//from a browser on another (wasm/src/RemoteSession.cpp is the client). nothing is rendered here. each client gets the whole
+//state when it connects, and after that only the lines that changed, see RemoteUIServer.cpp for the protocol.
+//input from the clients goes through the same ModularSynth entry points as the window's, so all clients share one cursor and view
+class RemoteUIServer : private juce::Thread
+{
+public:
+   static constexpr int kDefaultPort = 9310;
+
+   explicit RemoteUIServer(juce::Component* canvas); //canvas stands in for the window, it gets sized to the client's viewport
+   ~RemoteUIServer();
+
+   //clients have to send this before anything else is read from them or sent to them. set it before Listen()
+   void SetToken(const std::string& token) { mToken = token; }
+   //page origins, like "https://example.com:8080", that can connect besides the ones served from this machine. set it before Listen()
+   void AllowOrigin(const std::string& origin) { mAllowedOrigins.push_back(origin); }
+   static std::string GenerateToken();
+
+   //main thread, false if the port couldn't be bound. an empty bind address listens on every interface
+   bool Listen(int port, const std::string& bindAddress = "127.0.0.1");
+   void Stop();
+   void Poll(); //main thread, applies the input that came in and sends what changed
+   int GetNumClients() const;
+
+private:
+   class Client;
+
+   //juce::Thread, accepts connections
+   void run() override;
+
+   void QueueInput(const std::string& line); //client threads
+   bool IsOriginAllowed(const std::string& origin) const; //client threads
+   bool IsValidToken(const std::string& token) const; //client threads
+   void ApplyInput(const std::string& line);
+   void CollectState(std::unordered_map<std::string, std::string>& state) const;
+
+   juce::Component* mCanvas{ nullptr };
+   std::unique_ptr<juce::StreamingSocket> mListener;
+   std::string mToken;
+   std::vector<std::string> mAllowedOrigins;
+
+   mutable std::mutex mClientsMutex;
+   std::vector<std::unique_ptr<Client>> mClients;
+   int mNextClientId{ 0 };
+
+   std::mutex mInputMutex;
+   std::vector<std::string> mInput;
+   std::vector<std::string> mInputToApply;
+   int mHeldButton{ -1 };
+
+   std::unordered_map<std::string, std::string> mSentState; //line for each key, as every client has it
+   std::unordered_map<std::string, std::string> mState;
+   double mLastSendMs{ 0 };
+};
@@ -0,0 +1,268 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ReplayCapture.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ReplayCapture.h"
+#include "FileStream.h"
+#include "IDrawableModule.h"
+#include "IUIControl.h"
+#include "ModularSynth.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+
+#include "juce_audio_basics/juce_audio_basics.h"
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> ReplayCapture::sCapturing{ false };
+std::atomic<uint32_t> ReplayCapture::sBuffer{ 0 };
+
+namespace
+{
+   const int kAudioFifoSize = 1 << 23; //about twenty seconds of stereo input at 48k, if the main thread stalls
+
+   std::unique_ptr<FileStreamOut> sFile;
+   std::string sPath;
+
+   //audio input, written by the audio thread without locking or allocating
+   std::unique_ptr<juce::AbstractFifo> sAudioFifo;
+   std::vector<char> sAudioFifoData;
+   std::atomic<int> sDroppedAudioBlocks{ 0 };
+
+   //everything else, from the main thread and the midi threads
+   std::mutex sPendingMutex;
+   juce::MemoryBlock sPending;
+
+   void WriteToFifo(const void* data, int size, int& start1, int& size1, int& start2, int& size2, int& offset)
+   {
+      const char* bytes = static_cast<const char*>(data);
+      int fromFirst = std::max(0, std::min(size, size1 - offset));
+      if (fromFirst > 0)
+      {
+         memcpy(sAudioFifoData.data() + start1 + offset, bytes, fromFirst);
+         offset += fromFirst;
+      }
+      if (fromFirst < size)
+      {
+         int secondOffset = offset - size1;
+         memcpy(sAudioFifoData.data() + start2 + secondOffset, bytes + fromFirst, size - fromFirst);
+         offset += size - fromFirst;
+      }
+   }
+}
+
+ReplayCapture::ScopedControlWatch::ScopedControlWatch()
+{
+   if (IsCapturing() && gHoveredUIControl != nullptr)
+   {
+      mControl = gHoveredUIControl;
+      mValue = mControl->GetValue();
+   }
+}
+
+ReplayCapture::ScopedControlWatch::~ScopedControlWatch()
+{
+   //deleted modules are only retired until the patch is cleared, so the control is still safe to look at here
+   if (mControl != nullptr && IsCapturing() && (mControl->GetModuleParent() == nullptr || !mControl->GetModuleParent()->IsDeleted()) && mControl->GetValue() != mValue)
+      RecordControl(mControl, mControl->GetValue());
+}
+
+//static
+bool ReplayCapture::Start(std::string path)
+{
+   assert(IsMainThread());
+   if (IsCapturing())
+      return false;
+
+   sFile = std::make_unique<FileStreamOut>(path);
+   sPath = path;
+   if (sAudioFifo == nullptr)
+   {
+      sAudioFifo = std::make_unique<juce::AbstractFifo>(kAudioFifoSize);
+      sAudioFifoData.resize(kAudioFifoSize);
+   }
+   sAudioFifo->reset();
+   sDroppedAudioBlocks = 0;
+   sPending.reset();
+
+   std::string statePath = juce::File(path).withFileExtension("bsk").getFullPathName().toStdString();
+   TheSynth->SaveState(statePath, true);
+
+   //everything from here on happens at a known buffer: the rng starts from a seed we know, and the buffer count restarts
+   ScopedMutex mutex(TheSynth->GetAudioMutex(), "ReplayCapture::Start()");
+   uint64_t seed = ((uint64_t)gRandomDevice() << 32) | gRandomDevice();
+   gRandom = bespoke::core::Xoshiro256ss(seed);
+   sBuffer = 0;
+
+   int oversampling = UserPrefs.oversampling.Get();
+   *sFile << kMagic << kVersion;
+   *sFile << (int)(gSampleRate / oversampling) << gIOBufferSize / oversampling << oversampling << gBufferSize;
+   *sFile << TheSynth->GetNumInputChannels() << TheSynth->GetNumOutputChannels();
+   sFile->WriteGeneric(&seed, sizeof(seed));
+   *sFile << gTime << statePath;
+
+   sCapturing = true;
+   ofLog() << "capturing engine input to " << path << ", \"replay\" again to stop";
+   return true;
+}
+
+//static
+void ReplayCapture::Stop()
+{
+   assert(IsMainThread());
+   if (!IsCapturing())
+      return;
+
+   {
+      ScopedMutex mutex(TheSynth->GetAudioMutex(), "ReplayCapture::Stop()");
+      sCapturing = false;
+   }
+
+   Flush();
+   *sFile << (char)kRecord_End << sBuffer.load();
+   sFile.reset();
+
+   if (sDroppedAudioBlocks > 0)
+      ofLog() << "replay capture dropped " << sDroppedAudioBlocks << " blocks of audio input, the main thread fell behind";
+   ofLog() << "captured " << sBuffer.load() << " buffers to " << sPath;
+}
+
+//static
+void ReplayCapture::Poll()
+{
+   if (IsCapturing())
+      Flush();
+}
+
+//static
+void ReplayCapture::Flush()
+{
+   //audio input first: a block is recorded before the buffer it goes into starts, so this keeps the file roughly in order
+   int start1, size1, start2, size2;
+   sAudioFifo->prepareToRead(sAudioFifo->getNumReady(), start1, size1, start2, size2);
+   if (size1 > 0)
+      sFile->WriteGeneric(sAudioFifoData.data() + start1, size1);
+   if (size2 > 0)
+      sFile->WriteGeneric(sAudioFifoData.data() + start2, size2);
+   sAudioFifo->finishedRead(size1 + size2);
+
+   juce::MemoryBlock pending;
+   {
+      std::lock_guard<std::mutex> lock(sPendingMutex);
+      pending.swapWith(sPending);
+   }
+   if (pending.getSize() > 0)
+      sFile->WriteGeneric(pending.getData(), (int)pending.getSize());
+}
+
+//static
+void ReplayCapture::OnBufferStarted()
+{
+   if (IsCapturing())
+      ++sBuffer;
+}
+
+//static
+void ReplayCapture::RecordMidi(const std::string& listenerPath, const char* deviceName, const juce::MidiMessage& message)
+{
+   if (!IsCapturing())
+      return;
+
+   std::lock_guard<std::mutex> lock(sPendingMutex);
+   FileStreamOut out(sPending);
+   out << (char)kRecord_Midi << sBuffer.load() << listenerPath << std::string(deviceName) << message.getTimeStamp() << message.getRawDataSize();
+   out.WriteGeneric(message.getRawData(), message.getRawDataSize());
+}
+
+//static
+void ReplayCapture::RecordControl(IUIControl* control, float value)
+{
+   if (!IsCapturing())
+      return;
+
+   std::string path = control->Path();
+   std::lock_guard<std::mutex> lock(sPendingMutex);
+   FileStreamOut out(sPending);
+   out << (char)kRecord_Control << sBuffer.load() << path << value;
+}
+
+//static
+void ReplayCapture::RecordTempo(float tempo)
+{
+   //tempo set from the audio thread comes from the patch itself, which does it again on replay
+   if (!IsCapturing() || IsAudioThread())
+      return;
+
+   std::lock_guard<std::mutex> lock(sPendingMutex);
+   FileStreamOut out(sPending);
+   out << (char)kRecord_Tempo << sBuffer.load() << tempo;
+}
+
+//static
+void ReplayCapture::RecordAudioInput(const float* const* input, int bufferSize, int numChannels)
+{
+   if (!IsCapturing())
+      return;
+
+   //silence isn't stored, the replay feeds silence into any buffer that has no input recorded
+   bool silent = true;
+   for (int ch = 0; ch < numChannels && silent; ++ch)
+   {
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         if (input[ch][i] != 0)
+         {
+            silent = false;
+            break;
+         }
+      }
+   }
+   if (silent)
+      return;
+
+   const char type = kRecord_AudioInput;
+   const uint32_t buffer = sBuffer.load();
+   const int size = int(sizeof(type) + sizeof(buffer) + sizeof(numChannels) + sizeof(bufferSize) + numChannels * bufferSize * sizeof(float));
+   if (sAudioFifo->getFreeSpace() < size)
+   {
+      ++sDroppedAudioBlocks;
+      return;
+   }
+
+   int start1, size1, start2, size2;
+   sAudioFifo->prepareToWrite(size, start1, size1, start2, size2);
+   int offset = 0;
+   WriteToFifo(&type, sizeof(type), start1, size1, start2, size2, offset);
+   WriteToFifo(&buffer, sizeof(buffer), start1, size1, start2, size2, offset);
+   WriteToFifo(&numChannels, sizeof(numChannels), start1, size1, start2, size2, offset);
+   WriteToFifo(&bufferSize, sizeof(bufferSize), start1, size1, start2, size2, offset);
+   for (int ch = 0; ch < numChannels; ++ch)
+      WriteToFifo(input[ch], bufferSize * sizeof(float), start1, size1, start2, size2, offset);
+   sAudioFifo->finishedWrite(size);
+}
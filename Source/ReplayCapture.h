@@ -0,0 +1,89 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ReplayCapture.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class IUIControl;
+
+namespace juce
+{
+   class MidiMessage;
+}
+
+//records everything that goes into the engine from outside of it, so that a session can be run again offline with
+//"bespoke-bench --replay": the save state and the rng seed it started from, then midi input, ui control changes,
+//tempo changes and audio input, each stamped with the audio buffer it went into. started and stopped with the
+//"replay" console command.
+//the audio thread only ever writes its records (audio input) into a preallocated fifo, the other threads append
+//theirs under a lock, and Poll() moves both into the file from the main thread
+class ReplayCapture
+{
+public:
+   static constexpr uint32_t kMagic = 0x50525342; //"BSRP"
+   static constexpr int kVersion = 2; //2 added the internal block size
+
+   enum RecordType : char
+   {
+      kRecord_Midi,
+      kRecord_Control,
+      kRecord_Tempo,
+      kRecord_AudioInput,
+      kRecord_End
+   };
+
+   //notes the value of the control under the mouse, and records it if it's different by the time the event is handled
+   class ScopedControlWatch
+   {
+   public:
+      ScopedControlWatch();
+      ~ScopedControlWatch();
+
+   private:
+      IUIControl* mControl{ nullptr };
+      float mValue{ 0 };
+   };
+
+   static bool Start(std::string path);
+   static void Stop();
+   static bool IsCapturing() { return sCapturing.load(std::memory_order_relaxed); }
+   static void Poll();
+
+   static void OnBufferStarted();
+   static void RecordMidi(const std::string& listenerPath, const char* deviceName, const juce::MidiMessage& message);
+   static void RecordControl(IUIControl* control, float value);
+   static void RecordTempo(float tempo);
+   static void RecordAudioInput(const float* const* input, int bufferSize, int numChannels);
+
+private:
+   static void Flush();
+
+   static std::atomic<bool> sCapturing;
+   static std::atomic<uint32_t> sBuffer;
+};
@@ -0,0 +1,249 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ReplayRunner.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ReplayRunner.h"
+#include "FileStream.h"
+#include "IUIControl.h"
+#include "MidiDevice.h"
+#include "ModularSynth.h"
+#include "ProfilerTrace.h"
+#include "ReplayCapture.h"
+#include "SampleLoader.h"
+#include "SynthGlobals.h"
+#include "Transport.h"
+#include "ofxJSONElement.h"
+
+#include "juce_audio_basics/juce_audio_basics.h"
+#include "juce_core/juce_core.h"
+
+#include <algorithm>
+
+ReplayRunner::ReplayRunner(std::string capturePath)
+: mCapturePath(std::move(capturePath))
+{
+}
+
+double ReplayRunner::GetBudgetMs() const
+{
+   return mBufferSize * 1000.0 / mSampleRate;
+}
+
+bool ReplayRunner::ReadCapture()
+{
+   FileStreamIn in(juce::File::getCurrentWorkingDirectory().getChildFile(mCapturePath).getFullPathName().toStdString());
+   if (!in.OpenedOk())
+   {
+      fprintf(stderr, "couldn't open %s\n", mCapturePath.c_str());
+      return false;
+   }
+
+   uint32_t magic = 0;
+   int version = 0;
+   in >> magic >> version;
+   if (magic != ReplayCapture::kMagic || version > ReplayCapture::kVersion)
+   {
+      fprintf(stderr, "%s isn't a replay capture this version can read\n", mCapturePath.c_str());
+      return false;
+   }
+
+   in >> mSampleRate >> mBufferSize >> mOversampling;
+   if (version >= 2)
+      in >> mBlockSize;
+   in >> mNumInputChannels >> mNumOutputChannels;
+   in.ReadGeneric(&mSeed, sizeof(mSeed));
+   in >> mStartTime >> mStatePath;
+
+   //a capture that wasn't stopped (the app crashed, say) has no end record, and runs up to its last input
+   bool ended = false;
+   while (!in.Eof() && !ended)
+   {
+      Record record;
+      in >> record.mType >> record.mBuffer;
+      switch (record.mType)
+      {
+         case ReplayCapture::kRecord_Midi:
+         {
+            int size = 0;
+            in >> record.mPath >> record.mDeviceName >> record.mTimestamp >> size;
+            record.mMidi.resize(size);
+            in.ReadGeneric(record.mMidi.data(), size);
+            break;
+         }
+         case ReplayCapture::kRecord_Control:
+            in >> record.mPath >> record.mValue;
+            break;
+         case ReplayCapture::kRecord_Tempo:
+            in >> record.mValue;
+            break;
+         case ReplayCapture::kRecord_AudioInput:
+            in >> record.mNumChannels >> record.mNumSamples;
+            record.mAudio.resize(record.mNumChannels * record.mNumSamples);
+            in.Read(record.mAudio.data(), (int)record.mAudio.size());
+            break;
+         case ReplayCapture::kRecord_End:
+            mNumBuffers = record.mBuffer;
+            ended = true;
+            continue;
+         default:
+            fprintf(stderr, "%s is damaged after %d records, replaying up to there\n", mCapturePath.c_str(), (int)mRecords.size());
+            ended = true;
+            continue;
+      }
+      mNumBuffers = std::max(mNumBuffers, record.mBuffer + 1);
+      mRecords.push_back(std::move(record));
+   }
+
+   //the audio thread's records and everyone else's are written out separately, so they're only in order per thread
+   std::stable_sort(mRecords.begin(), mRecords.end(), [](const Record& a, const Record& b)
+                    {
+                       return a.mBuffer < b.mBuffer;
+                    });
+
+   return mSampleRate > 0 && mBufferSize > 0 && mOversampling > 0 && mNumOutputChannels > 0;
+}
+
+void ReplayRunner::Apply(const Record& record, std::vector<std::vector<float>>& input)
+{
+   switch (record.mType)
+   {
+      case ReplayCapture::kRecord_Midi:
+      {
+         auto* listener = dynamic_cast<MidiDeviceListener*>(TheSynth->FindModule(record.mPath));
+         if (listener == nullptr)
+         {
+            ++mMissingTargets;
+            return;
+         }
+         MidiDevice::SendMidiMessage(listener, record.mDeviceName.c_str(), juce::MidiMessage(record.mMidi.data(), (int)record.mMidi.size(), record.mTimestamp));
+         break;
+      }
+      case ReplayCapture::kRecord_Control:
+      {
+         IUIControl* control = TheSynth->FindUIControl(record.mPath);
+         if (control == nullptr)
+         {
+            ++mMissingTargets;
+            return;
+         }
+         control->SetValue(record.mValue, gTime);
+         break;
+      }
+      case ReplayCapture::kRecord_Tempo:
+         TheTransport->SetTempo(record.mValue);
+         break;
+      case ReplayCapture::kRecord_AudioInput:
+         for (int ch = 0; ch < std::min(record.mNumChannels, (int)input.size()); ++ch)
+            std::copy_n(record.mAudio.begin() + ch * record.mNumSamples, std::min(record.mNumSamples, mBufferSize), input[ch].begin());
+         break;
+   }
+}
+
+bool ReplayRunner::Run(std::string tracePath)
+{
+   juce::File stateFile(mStatePath);
+   if (!stateFile.existsAsFile())
+   {
+      fprintf(stderr, "couldn't find the capture's save state %s\n", mStatePath.c_str());
+      return false;
+   }
+
+   TheSynth->LoadState(mStatePath);
+   while (SampleLoader::Get().IsBusy())
+      juce::Thread::sleep(10);
+
+   //the same starting point the capture had
+   gRandom = bespoke::core::Xoshiro256ss(mSeed);
+   gTime = mStartTime;
+
+   std::vector<std::vector<float>> input(mNumInputChannels, std::vector<float>(mBufferSize));
+   std::vector<const float*> inputPointers;
+   for (auto& channel : input)
+      inputPointers.push_back(channel.data());
+   std::vector<std::vector<float>> output(mNumOutputChannels, std::vector<float>(mBufferSize));
+   std::vector<float*> outputPointers;
+   for (auto& channel : output)
+      outputPointers.push_back(channel.data());
+
+   if (!tracePath.empty())
+      ProfilerTrace::Start();
+
+   mCallbackMs.resize(mNumBuffers);
+   size_t next = 0;
+   for (uint32_t buffer = 0; buffer < mNumBuffers; ++buffer)
+   {
+      for (auto& channel : input)
+         std::fill(channel.begin(), channel.end(), 0.0f);
+      for (; next < mRecords.size() && mRecords[next].mBuffer == buffer; ++next)
+         Apply(mRecords[next], input);
+
+      //the same order the device callback calls them in
+      long start = ofGetSystemTimeNanos();
+      TheSynth->AudioIn(inputPointers.data(), mBufferSize, mNumInputChannels);
+      TheSynth->AudioOut(outputPointers.data(), mBufferSize, mNumOutputChannels);
+      mCallbackMs[buffer] = (ofGetSystemTimeNanos() - start) / 1000000.0;
+   }
+
+   if (!tracePath.empty() && !ProfilerTrace::StopAndSave(tracePath))
+      fprintf(stderr, "couldn't write %s\n", tracePath.c_str());
+
+   if (mMissingTargets > 0)
+      fprintf(stderr, "%d inputs went to modules or controls that aren't in the save state, they were skipped\n", mMissingTargets);
+   return true;
+}
+
+void ReplayRunner::WriteResults(ofxJSONElement& root) const
+{
+   root["capture"] = mCapturePath;
+   root["bufferSize"] = mBufferSize;
+   root["oversampling"] = mOversampling;
+   root["blockSize"] = gBufferSize;
+   root["budgetMs"] = GetBudgetMs();
+   root["callbacks"] = (int)mNumBuffers;
+   root["inputs"] = (int)mRecords.size();
+
+   int overruns = 0;
+   double total = 0;
+   for (double ms : mCallbackMs)
+   {
+      total += ms;
+      if (ms > GetBudgetMs())
+         ++overruns;
+   }
+   std::vector<double> sorted = mCallbackMs;
+   std::sort(sorted.begin(), sorted.end());
+   int count = (int)sorted.size();
+   root["meanMs"] = count > 0 ? total / count : 0;
+   root["p99Ms"] = count > 0 ? sorted[std::min(count - 1, (int)(count * .99))] : 0;
+   root["maxMs"] = count > 0 ? sorted.back() : 0;
+   root["overruns"] = overruns;
+
+   //every callback in order, to line up against the buffers that glitched live
+   root["callbackMs"].resize(0);
+   for (int i = 0; i < count; ++i)
+      root["callbackMs"][i] = mCallbackMs[i];
+
+   fprintf(stderr, "%d callbacks  mean %7.3f ms  p99 %7.3f ms  max %7.3f ms  (budget %.3f ms)  %d overruns\n", count, root["meanMs"].asDouble(), root["p99Ms"].asDouble(), root["maxMs"].asDouble(), GetBudgetMs(), overruns);
+}
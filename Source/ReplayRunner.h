@@ -0,0 +1,88 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ReplayRunner.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ofxJSONElement;
+
+//runs a session captured with the "replay" console command (see ReplayCapture.h) again, for bespoke-bench: loads the
+//state it started from, reseeds the rng, then feeds each buffer the midi, control changes, tempo changes and audio input
+//that went into it live, and times every ModularSynth::AudioOut(). with a trace path, the profiler timeline of the whole
+//run is saved too, so a glitch that happened live can be looked at in chrome://tracing as often as needed
+class ReplayRunner
+{
+public:
+   explicit ReplayRunner(std::string capturePath);
+
+   bool ReadCapture(); //before the synth is set up, it needs the sample rate, buffer size and channels recorded here
+   bool Run(std::string tracePath);
+   void WriteResults(ofxJSONElement& root) const;
+
+   int GetSampleRate() const { return mSampleRate; }
+   int GetBufferSize() const { return mBufferSize; }
+   int GetOversampling() const { return mOversampling; }
+   int GetBlockSize() const { return mBlockSize; } //at the internal rate, 0 if the capture predates it, which means whole callbacks
+   int GetNumInputChannels() const { return mNumInputChannels; }
+   int GetNumOutputChannels() const { return mNumOutputChannels; }
+
+private:
+   struct Record
+   {
+      char mType{ 0 };
+      uint32_t mBuffer{ 0 };
+      std::string mPath;
+      std::string mDeviceName;
+      double mTimestamp{ 0 };
+      std::vector<uint8_t> mMidi;
+      float mValue{ 0 };
+      int mNumChannels{ 0 };
+      int mNumSamples{ 0 };
+      std::vector<float> mAudio;
+   };
+
+   void Apply(const Record& record, std::vector<std::vector<float>>& input);
+   double GetBudgetMs() const;
+
+   std::string mCapturePath;
+   int mSampleRate{ 0 };
+   int mBufferSize{ 0 };
+   int mOversampling{ 1 };
+   int mBlockSize{ 0 };
+   int mNumInputChannels{ 0 };
+   int mNumOutputChannels{ 0 };
+   uint64_t mSeed{ 0 };
+   double mStartTime{ 0 };
+   std::string mStatePath;
+   uint32_t mNumBuffers{ 0 };
+   std::vector<Record> mRecords;
+
+   std::vector<double> mCallbackMs;
+   int mMissingTargets{ 0 };
+};
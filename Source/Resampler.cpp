@@ -0,0 +1,335 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Resampler.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "Resampler.h"
+#include "SynthGlobals.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+   const int kSincZeroCrossings = 8; //per side
+   const int kSincTaps = kSincZeroCrossings * 2;
+   const int kSincPhases = 128;
+   const int kSincTableResolution = 128; //entries per zero crossing, for the widened kernel
+   const float kSincCutoff = .9f; //leave room for the transition band below nyquist
+   const float kMaxSincWidening = 4; //past 4x playback speed, the kernel stops widening
+   const int kMaxTaps = int(kSincTaps * kMaxSincWidening);
+
+   double SincWindowed(double x)
+   {
+      if (fabs(x) >= kSincZeroCrossings)
+         return 0;
+      double w = FPI * x / kSincZeroCrossings;
+      double window = .35875 + .48829 * cos(w) + .14128 * cos(2 * w) + .01168 * cos(3 * w); //blackman-harris
+      double sinc = x == 0 ? 1 : sin(FPI * kSincCutoff * x) / (FPI * kSincCutoff * x);
+      return kSincCutoff * sinc * window;
+   }
+
+   struct SincTables
+   {
+      SincTables()
+      {
+         for (int phase = 0; phase <= kSincPhases; ++phase)
+         {
+            double frac = phase / double(kSincPhases);
+            double sum = 0;
+            for (int k = 0; k < kSincTaps; ++k)
+            {
+               mPhases[phase][k] = SincWindowed(k - (kSincZeroCrossings - 1) - frac);
+               sum += mPhases[phase][k];
+            }
+            for (int k = 0; k < kSincTaps; ++k)
+               mPhases[phase][k] /= sum; //exact unity gain at dc, for every phase
+         }
+
+         for (int i = 0; i < kHalfTableSize; ++i)
+            mHalf[i] = SincWindowed(i / double(kSincTableResolution));
+      }
+
+      static const int kHalfTableSize = kSincZeroCrossings * kSincTableResolution + 2; //last two entries are zero, so lookups can run off the end
+      float mPhases[kSincPhases + 1][kSincTaps];
+      float mHalf[kHalfTableSize];
+   };
+
+   const SincTables& GetSincTables()
+   {
+      static SincTables sTables;
+      return sTables;
+   }
+
+   //each kernel reads src[i + kLo] through src[i + kHi] around the sample before the read position, with frac in [0, 1)
+   struct LinearKernel
+   {
+      int mLo{ 0 };
+      int mHi{ 1 };
+
+      float Eval(const float* src, int i, float frac) const
+      {
+         return (1 - frac) * src[i] + frac * src[i + 1];
+      }
+   };
+
+   struct CubicKernel
+   {
+      int mLo{ -1 };
+      int mHi{ 2 };
+
+      float Eval(const float* src, int i, float frac) const
+      {
+         float xm1 = src[i - 1];
+         float x0 = src[i];
+         float x1 = src[i + 1];
+         float x2 = src[i + 2];
+         float c = (x1 - xm1) * .5f;
+         float v = x0 - x1;
+         float w = c + v;
+         float a = w + v + (x2 - x0) * .5f;
+         float b = w + a;
+         return ((a * frac - b) * frac + c) * frac + x0;
+      }
+   };
+
+   struct SincKernel
+   {
+      int mLo{ -(kSincZeroCrossings - 1) };
+      int mHi{ kSincZeroCrossings };
+
+      float Eval(const float* src, int i, float frac) const
+      {
+         float phasePos = frac * kSincPhases;
+         int phase = std::min(int(phasePos), kSincPhases - 1);
+         float t = phasePos - phase;
+         const float* c0 = mTables->mPhases[phase];
+         const float* c1 = mTables->mPhases[phase + 1];
+         const float* s = src + i + mLo;
+         float sum = 0;
+         for (int k = 0; k < kSincTaps; ++k)
+            sum += s[k] * (c0[k] + t * (c1[k] - c0[k]));
+         return sum;
+      }
+
+      const SincTables* mTables{ &GetSincTables() };
+   };
+
+   //for playback faster than 1x, the kernel is stretched out to cut off below the output's nyquist
+   struct WideSincKernel
+   {
+      explicit WideSincKernel(float rate)
+      : mScale(1 / std::min(rate, kMaxSincWidening))
+      {
+         int radius = (int)ceil(kSincZeroCrossings / mScale);
+         mLo = -radius + 1;
+         mHi = radius;
+      }
+
+      float Eval(const float* src, int i, float frac) const
+      {
+         const float* half = mTables->mHalf;
+         const float step = mScale * kSincTableResolution;
+         float sum = 0;
+         float weightSum = 0;
+         for (int k = mLo; k <= mHi; ++k)
+         {
+            float x = fabsf(k - frac) * step;
+            int index = std::min(int(x), SincTables::kHalfTableSize - 2);
+            float t = x - index;
+            float weight = half[index] + t * (half[index + 1] - half[index]);
+            sum += src[i + k] * weight;
+            weightSum += weight;
+         }
+         return sum / weightSum;
+      }
+
+      int mLo;
+      int mHi;
+      float mScale;
+      const SincTables* mTables{ &GetSincTables() };
+   };
+
+   inline double WrapPosition(double pos, int srcLength)
+   {
+      if (pos >= 0 && pos < srcLength)
+         return pos;
+      pos = DoubleWrap(pos, srcLength);
+      if (pos >= srcLength) //rounding
+         pos = 0;
+      return pos;
+   }
+
+   template <typename Kernel>
+   float EvalWrapped(const Kernel& kernel, const float* src, int srcLength, int index, float frac)
+   {
+      float taps[kMaxTaps + 1];
+      for (int k = kernel.mLo; k <= kernel.mHi; ++k)
+      {
+         int tap = (index + k) % srcLength;
+         if (tap < 0)
+            tap += srcLength;
+         taps[k - kernel.mLo] = src[tap];
+      }
+      return kernel.Eval(taps - kernel.mLo, 0, frac);
+   }
+
+   template <typename Kernel>
+   float EvalAt(const Kernel& kernel, const float* src, int srcLength, double pos)
+   {
+      pos = WrapPosition(pos, srcLength);
+      int index = int(pos);
+      float frac = pos - index;
+      if (index + kernel.mLo >= 0 && index + kernel.mHi < srcLength)
+         return kernel.Eval(src, index, frac);
+      return EvalWrapped(kernel, src, srcLength, index, frac);
+   }
+
+   template <typename Kernel>
+   void ResampleConstantRate(const Kernel& kernel, const float* src, int srcLength, double pos, double rate, float* dst, int numSamples)
+   {
+      //read positions with an index in [minIndex, maxIndex] can use src directly
+      const int minIndex = -kernel.mLo;
+      const int maxIndex = srcLength - 1 - kernel.mHi;
+
+      pos = WrapPosition(pos, srcLength);
+      int i = 0;
+      while (i < numSamples)
+      {
+         int index = int(pos);
+         if (index >= minIndex && index <= maxIndex)
+         {
+            //how many outputs we have until the read position leaves the unwrapped region
+            int count = numSamples - i;
+            if (rate > 0)
+               count = std::min(count, (int)ceil((maxIndex + 1 - pos) / rate));
+            else if (rate < 0)
+               count = std::min(count, (int)floor((pos - minIndex) / -rate) + 1);
+            while (count > 1)
+            {
+               int lastIndex = int(pos + (count - 1) * rate);
+               if (lastIndex >= minIndex && lastIndex <= maxIndex)
+                  break;
+               --count;
+            }
+            count = std::max(count, 1);
+
+            float* out = dst + i;
+            for (int j = 0; j < count; ++j)
+            {
+               double p = pos + j * rate;
+               int pIndex = int(p);
+               out[j] = kernel.Eval(src, pIndex, float(p - pIndex));
+            }
+            pos += count * rate;
+            i += count;
+         }
+         else
+         {
+            dst[i] = EvalWrapped(kernel, src, srcLength, index, float(pos - index));
+            pos += rate;
+            ++i;
+         }
+         pos = WrapPosition(pos, srcLength);
+      }
+   }
+
+   template <typename Kernel>
+   void ResamplePositions(const Kernel& kernel, const float* src, int srcLength, const double* positions, float* dst, int numSamples)
+   {
+      for (int i = 0; i < numSamples; ++i)
+         dst[i] = EvalAt(kernel, src, srcLength, positions[i]);
+   }
+}
+
+double Resample(const float* src, int srcLength, double offset, double rate, float* dst, int numSamples, ResampleQuality quality)
+{
+   if (srcLength <= 0)
+   {
+      std::fill(dst, dst + numSamples, 0.0f);
+      return offset;
+   }
+
+   switch (quality)
+   {
+      case ResampleQuality::Linear:
+         ResampleConstantRate(LinearKernel(), src, srcLength, offset, rate, dst, numSamples);
+         break;
+      case ResampleQuality::Cubic:
+         ResampleConstantRate(CubicKernel(), src, srcLength, offset, rate, dst, numSamples);
+         break;
+      case ResampleQuality::Sinc:
+         if (fabs(rate) > 1)
+            ResampleConstantRate(WideSincKernel(fabs(rate)), src, srcLength, offset, rate, dst, numSamples);
+         else
+            ResampleConstantRate(SincKernel(), src, srcLength, offset, rate, dst, numSamples);
+         break;
+   }
+
+   return offset + numSamples * rate;
+}
+
+void Resample(const float* src, int srcLength, const double* positions, float* dst, int numSamples, ResampleQuality quality, float rateHint /*= 1*/)
+{
+   if (srcLength <= 0)
+   {
+      std::fill(dst, dst + numSamples, 0.0f);
+      return;
+   }
+
+   switch (quality)
+   {
+      case ResampleQuality::Linear:
+         ResamplePositions(LinearKernel(), src, srcLength, positions, dst, numSamples);
+         break;
+      case ResampleQuality::Cubic:
+         ResamplePositions(CubicKernel(), src, srcLength, positions, dst, numSamples);
+         break;
+      case ResampleQuality::Sinc:
+         if (fabsf(rateHint) > 1)
+            ResamplePositions(WideSincKernel(fabsf(rateHint)), src, srcLength, positions, dst, numSamples);
+         else
+            ResamplePositions(SincKernel(), src, srcLength, positions, dst, numSamples);
+         break;
+   }
+}
+
+float GetResampledSample(double offset, const float* src, int srcLength, ResampleQuality quality, float rateHint /*= 1*/)
+{
+   if (srcLength <= 0)
+      return 0;
+
+   switch (quality)
+   {
+      case ResampleQuality::Linear:
+         return EvalAt(LinearKernel(), src, srcLength, offset);
+      case ResampleQuality::Cubic:
+         return EvalAt(CubicKernel(), src, srcLength, offset);
+      case ResampleQuality::Sinc:
+         if (fabsf(rateHint) > 1)
+            return EvalAt(WideSincKernel(fabsf(rateHint)), src, srcLength, offset);
+         return EvalAt(SincKernel(), src, srcLength, offset);
+   }
+   return 0;
+}
@@ -0,0 +1,54 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    Resampler.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+enum class ResampleQuality
+{
+   Linear,
+   Cubic,
+   Sinc
+};
+
+//a step cheaper, for voices the cpu governor has asked to save time
+inline ResampleQuality GetCheaperQuality(ResampleQuality quality)
+{
+   return quality == ResampleQuality::Sinc ? ResampleQuality::Cubic : ResampleQuality::Linear;
+}
+
+//block versions of GetInterpolatedSample(). src is read as a loop of srcLength samples, the same way GetInterpolatedSample() reads it,
+//but the wrapping is only done for the few output samples whose kernels straddle the ends of src.
+//
+//linear matches GetInterpolatedSample(), cubic is a 4-point hermite, and sinc is a windowed-sinc polyphase filter that widens
+//when playing faster than 1x, so pitched up material doesn't alias.
+
+//fills numSamples outputs, starting at offset and advancing rate samples per output. returns the (unwrapped) offset after the last one
+double Resample(const float* src, int srcLength, double offset, double rate, float* dst, int numSamples, ResampleQuality quality);
+
+//for playheads that don't move at a constant rate. rateHint is the playback rate the sinc kernel should band-limit for
+void Resample(const float* src, int srcLength, const double* positions, float* dst, int numSamples, ResampleQuality quality, float rateHint = 1);
+
+float GetResampledSample(double offset, const float* src, int srcLength, ResampleQuality quality, float rateHint = 1);
@@ -0,0 +1,422 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    RetroCapture.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "RetroCapture.h"
+#include "RollingBuffer.h"
+#include "SynthGlobals.h"
+
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+   const float kBufferedSeconds = 4; //how far the compressor can fall behind before blocks start getting dropped
+   const int kCompressorSleepMs = 10;
+
+   //each channel of a chunk is coded in runs of this many samples, each with its own predictor and rice parameter
+   const int kRunSize = 256;
+   const int kAllZeroRun = 31; //in place of the rice parameter, for a run that predicts perfectly, which is what silence does
+   const int kEscapeLength = 24; //a unary part this long is followed by the residual raw, instead of by more ones
+
+   //float bits onto integers that sort the same way the floats do, so nearby values are nearby integers, across zero as well
+   uint32_t ToOrdered(float sample)
+   {
+      uint32_t bits;
+      memcpy(&bits, &sample, sizeof(bits));
+      return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+   }
+
+   uint32_t OrderedToBits(uint32_t ordered)
+   {
+      return (ordered & 0x80000000u) ? (ordered & 0x7fffffffu) : ~ordered;
+   }
+
+   float FromOrdered(uint32_t ordered)
+   {
+      uint32_t bits = OrderedToBits(ordered);
+      float sample;
+      memcpy(&sample, &bits, sizeof(sample));
+      return sample;
+   }
+
+   const uint32_t kOrderedZero = 0x80000000u;
+
+   bool IsNormal(uint32_t ordered)
+   {
+      uint32_t exponent = (OrderedToBits(ordered) >> 23) & 0xff;
+      return exponent != 0 && exponent != 0xff;
+   }
+
+   //0: none, 1: the last sample, 2: the line through the last two. the line is worked out on the values rather than the
+   //bits, so it holds across exponents, but only from normal floats and out to normal floats, so that flushing denormals
+   //or not on whichever thread decodes can't change the prediction
+   uint32_t Predict(int order, uint32_t last, uint32_t beforeLast)
+   {
+      if (order == 0)
+         return kOrderedZero;
+      if (order == 1 || !IsNormal(last) || !IsNormal(beforeLast))
+         return last;
+      double predicted = 2.0 * FromOrdered(last) - FromOrdered(beforeLast);
+      if (fabs(predicted) < FLT_MIN)
+         return kOrderedZero;
+      return ToOrdered((float)predicted);
+   }
+
+   uint32_t ZigZag(uint32_t residual)
+   {
+      return (residual << 1) ^ (uint32_t)((int32_t)residual >> 31);
+   }
+
+   uint32_t UnZigZag(uint32_t value)
+   {
+      return (value >> 1) ^ (0u - (value & 1));
+   }
+
+   uint32_t Mask(int numBits)
+   {
+      return numBits >= 32 ? 0xffffffffu : (1u << numBits) - 1;
+   }
+
+   class BitWriter
+   {
+   public:
+      explicit BitWriter(std::vector<uint8_t>& out)
+      : mOut(out)
+      {
+      }
+      void Write(uint32_t value, int numBits) //up to 32
+      {
+         mBits = (mBits << numBits) | (value & Mask(numBits));
+         mNumBits += numBits;
+         while (mNumBits >= 8)
+         {
+            mNumBits -= 8;
+            mOut.push_back((uint8_t)(mBits >> mNumBits));
+         }
+      }
+      void WriteBit(uint32_t bit) { Write(bit, 1); }
+      void Flush()
+      {
+         if (mNumBits > 0)
+            Write(0, 8 - mNumBits);
+      }
+
+   private:
+      std::vector<uint8_t>& mOut;
+      uint64_t mBits{ 0 };
+      int mNumBits{ 0 };
+   };
+
+   class BitReader
+   {
+   public:
+      explicit BitReader(const std::vector<uint8_t>& in)
+      : mIn(in)
+      {
+      }
+      uint32_t Read(int numBits) //up to 32, zeros past the end
+      {
+         while (mNumBits < numBits)
+         {
+            mBits = (mBits << 8) | (mPos < mIn.size() ? mIn[mPos] : 0);
+            ++mPos;
+            mNumBits += 8;
+         }
+         mNumBits -= numBits;
+         return (uint32_t)(mBits >> mNumBits) & Mask(numBits);
+      }
+      uint32_t ReadBit() { return Read(1); }
+
+   private:
+      const std::vector<uint8_t>& mIn;
+      size_t mPos{ 0 };
+      uint64_t mBits{ 0 };
+      int mNumBits{ 0 };
+   };
+}
+
+RetroCapture::RetroCapture(std::vector<RollingBuffer*> sources, std::int64_t maxSamples)
+: mMaxSamples(maxSamples)
+, mBlockSize(gBufferSize)
+{
+   for (auto* source : sources)
+   {
+      for (int ch = 0; ch < source->NumChannels(); ++ch)
+         mSources.push_back(std::make_pair(source, ch));
+   }
+
+   int numBlocks = MAX(2, (int)(kBufferedSeconds * gSampleRate / mBlockSize));
+   mBlocks.assign(numBlocks, Block());
+   mFilledBlocks = std::make_unique<moodycamel::ReaderWriterQueue<Block*>>(numBlocks);
+   mFreeBlocks = std::make_unique<moodycamel::ReaderWriterQueue<Block*>>(numBlocks);
+   for (auto& block : mBlocks)
+   {
+      block.mData.resize(mSources.size() * mBlockSize);
+      mFreeBlocks->enqueue(&block);
+   }
+   mStaged.assign(mSources.size(), std::vector<float>(kChunkSize));
+
+   mCompressorThread = std::thread(&RetroCapture::CompressorThreadLoop, this);
+}
+
+RetroCapture::~RetroCapture()
+{
+   mStopCompressor = true;
+   mCompressorThread.join();
+}
+
+void RetroCapture::Write(int numSamples)
+{
+   Block* block;
+   if (mFreeBlocks->try_dequeue(block))
+   {
+      block->mNumSamples = MIN(numSamples, mBlockSize);
+      for (size_t i = 0; i < mSources.size(); ++i)
+         mSources[i].first->ReadChunk(block->mData.data() + i * mBlockSize, block->mNumSamples, 0, mSources[i].second);
+      mFilledBlocks->try_enqueue(block); //can't fail, the queue has room for every block
+   }
+   else
+   {
+      ++mNumDroppedBlocks;
+   }
+}
+
+void RetroCapture::CompressorThreadLoop()
+{
+   while (!mStopCompressor)
+   {
+      {
+         std::lock_guard<std::mutex> lock(mChunksMutex);
+         ProcessFilledBlocks();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(kCompressorSleepMs));
+   }
+}
+
+void RetroCapture::ProcessFilledBlocks()
+{
+   Block* block;
+   while (mFilledBlocks->try_dequeue(block))
+   {
+      int taken = 0;
+      while (taken < block->mNumSamples)
+      {
+         int numSamples = MIN(block->mNumSamples - taken, kChunkSize - mNumStaged);
+         for (size_t i = 0; i < mSources.size(); ++i)
+            BufferCopy(mStaged[i].data() + mNumStaged, block->mData.data() + i * mBlockSize + taken, numSamples);
+         mNumStaged += numSamples;
+         taken += numSamples;
+         if (mNumStaged == kChunkSize)
+            CompressStaged();
+      }
+      mFreeBlocks->enqueue(block);
+   }
+}
+
+void RetroCapture::CompressStaged()
+{
+   Chunk chunk;
+   chunk.mNumSamples = mNumStaged;
+   chunk.mChannels.resize(mSources.size());
+   for (size_t i = 0; i < mSources.size(); ++i)
+   {
+      Encode(mStaged[i].data(), mNumStaged, chunk.mChannels[i]);
+      chunk.mChannels[i].shrink_to_fit();
+   }
+   mChunks.push_back(std::move(chunk));
+   mChunkedSamples += mNumStaged;
+   mNumStaged = 0;
+
+   //the staged samples count toward the length too, so there's always room for them
+   while (!mChunks.empty() && mChunkedSamples + kChunkSize > mMaxSamples)
+   {
+      mChunkedSamples -= mChunks.front().mNumSamples;
+      mChunks.pop_front();
+   }
+}
+
+std::int64_t RetroCapture::GetNumSamples()
+{
+   std::lock_guard<std::mutex> lock(mChunksMutex);
+   ProcessFilledBlocks();
+   return mChunkedSamples + mNumStaged;
+}
+
+void RetroCapture::Read(std::int64_t numSamples, const std::function<void(const float* const* channels, int numSamples)>& onPiece)
+{
+   std::lock_guard<std::mutex> lock(mChunksMutex);
+   ProcessFilledBlocks();
+
+   std::int64_t skip = MAX(0, mChunkedSamples + mNumStaged - numSamples);
+   std::vector<std::vector<float>> decoded(mSources.size(), std::vector<float>(kChunkSize));
+   std::vector<const float*> pointers(mSources.size());
+   for (const auto& chunk : mChunks)
+   {
+      if (skip >= chunk.mNumSamples)
+      {
+         skip -= chunk.mNumSamples;
+         continue;
+      }
+      for (size_t i = 0; i < mSources.size(); ++i)
+      {
+         Decode(chunk.mChannels[i], decoded[i].data(), chunk.mNumSamples);
+         pointers[i] = decoded[i].data() + skip;
+      }
+      onPiece(pointers.data(), chunk.mNumSamples - (int)skip);
+      skip = 0;
+   }
+
+   if (mNumStaged > skip)
+   {
+      for (size_t i = 0; i < mSources.size(); ++i)
+         pointers[i] = mStaged[i].data() + skip;
+      onPiece(pointers.data(), mNumStaged - (int)skip);
+   }
+}
+
+void RetroCapture::Clear()
+{
+   std::lock_guard<std::mutex> lock(mChunksMutex);
+   ProcessFilledBlocks();
+   mChunks.clear();
+   mChunkedSamples = 0;
+   mNumStaged = 0;
+}
+
+size_t RetroCapture::GetMemoryUsage()
+{
+   std::lock_guard<std::mutex> lock(mChunksMutex);
+   size_t bytes = 0;
+   for (const auto& chunk : mChunks)
+   {
+      for (const auto& channel : chunk.mChannels)
+         bytes += channel.capacity();
+   }
+   return bytes;
+}
+
+//static
+void RetroCapture::Encode(const float* samples, int numSamples, std::vector<std::uint8_t>& out)
+{
+   out.clear();
+   BitWriter writer(out);
+   uint32_t last = kOrderedZero;
+   uint32_t beforeLast = kOrderedZero;
+   uint32_t residuals[3][kRunSize];
+   for (int runStart = 0; runStart < numSamples; runStart += kRunSize)
+   {
+      int runSize = MIN(kRunSize, numSamples - runStart);
+
+      //try each predictor over the run, and keep whichever leaves the smallest residuals
+      int bestOrder = 0;
+      uint64_t bestSum = UINT64_MAX;
+      for (int order = 0; order < 3; ++order)
+      {
+         uint32_t a = last;
+         uint32_t b = beforeLast;
+         uint64_t sum = 0;
+         for (int i = 0; i < runSize; ++i)
+         {
+            uint32_t ordered = ToOrdered(samples[runStart + i]);
+            residuals[order][i] = ZigZag(ordered - Predict(order, a, b));
+            sum += residuals[order][i];
+            b = a;
+            a = ordered;
+         }
+         if (sum < bestSum)
+         {
+            bestSum = sum;
+            bestOrder = order;
+         }
+      }
+      beforeLast = runSize > 1 ? ToOrdered(samples[runStart + runSize - 2]) : last;
+      last = ToOrdered(samples[runStart + runSize - 1]);
+
+      writer.Write(bestOrder, 2);
+      if (bestSum == 0)
+      {
+         writer.Write(kAllZeroRun, 5);
+         continue;
+      }
+
+      //the rice parameter that suits the run's mean residual
+      int k = 0;
+      while (k < 30 && ((uint64_t)runSize << (k + 1)) <= bestSum)
+         ++k;
+      writer.Write(k, 5);
+      for (int i = 0; i < runSize; ++i)
+      {
+         uint32_t value = residuals[bestOrder][i];
+         uint32_t quotient = value >> k;
+         if (quotient >= (uint32_t)kEscapeLength)
+         {
+            writer.Write(0xffffffffu, kEscapeLength);
+            writer.Write(value, 32);
+         }
+         else
+         {
+            writer.Write(0xffffffffu, (int)quotient);
+            writer.WriteBit(0);
+            writer.Write(value, k);
+         }
+      }
+   }
+   writer.Flush();
+}
+
+//static
+void RetroCapture::Decode(const std::vector<std::uint8_t>& in, float* samples, int numSamples)
+{
+   BitReader reader(in);
+   uint32_t last = kOrderedZero;
+   uint32_t beforeLast = kOrderedZero;
+   for (int runStart = 0; runStart < numSamples; runStart += kRunSize)
+   {
+      int runSize = MIN(kRunSize, numSamples - runStart);
+      int order = (int)reader.Read(2);
+      int k = (int)reader.Read(5);
+      for (int i = 0; i < runSize; ++i)
+      {
+         uint32_t value = 0;
+         if (k != kAllZeroRun)
+         {
+            int quotient = 0;
+            while (quotient < kEscapeLength && reader.ReadBit() == 1)
+               ++quotient;
+            if (quotient == kEscapeLength)
+               value = reader.Read(32);
+            else
+               value = ((uint32_t)quotient << k) | reader.Read(k);
+         }
+         uint32_t ordered = Predict(order, last, beforeLast) + UnZigZag(value);
+         samples[runStart + i] = FromOrdered(ordered);
+         beforeLast = last;
+         last = ordered;
+      }
+   }
+}
@@ -0,0 +1,105 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    RetroCapture.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "readerwriterqueue.h"
+
+class RollingBuffer;
+
+//a long "always recording" capture of the output, kept losslessly compressed in memory (record_buffer_compressed).
+//the audio thread copies what it just wrote to the record buffers into one of a fixed pool of blocks, and a compressor
+//thread packs them into fixed chunks and drops the oldest once there's more than the capture's length.
+//reading it back waits for the compressor to catch up, so it has everything written up to the call
+class RetroCapture
+{
+public:
+   RetroCapture(std::vector<RollingBuffer*> sources, std::int64_t maxSamples);
+   ~RetroCapture();
+
+   //audio thread, after each block has been written to the sources
+   void Write(int numSamples);
+
+   //main thread
+   int GetNumChannels() const { return (int)mSources.size(); }
+   std::int64_t GetNumSamples();
+   //the most recent numSamples, oldest first, a piece at a time
+   void Read(std::int64_t numSamples, const std::function<void(const float* const* channels, int numSamples)>& onPiece);
+   void Clear();
+   size_t GetMemoryUsage(); //compressed bytes held
+   int GetNumDroppedBlocks() const { return mNumDroppedBlocks; }
+
+   //lossless: Decode() gives back exactly the bits Encode() was given
+   static void Encode(const float* samples, int numSamples, std::vector<std::uint8_t>& out);
+   static void Decode(const std::vector<std::uint8_t>& in, float* samples, int numSamples);
+
+   static constexpr int kChunkSize = 1 << 15;
+   static constexpr float kRawSeconds = 5; //what the raw record buffer shrinks to, enough for what draws from it
+
+private:
+   struct Block
+   {
+      std::vector<float> mData; //channels one after another, mBlockSize apart
+      int mNumSamples{ 0 };
+   };
+
+   struct Chunk
+   {
+      std::vector<std::vector<std::uint8_t>> mChannels;
+      int mNumSamples{ 0 };
+   };
+
+   void CompressorThreadLoop();
+   void ProcessFilledBlocks(); //with mChunksMutex held
+   void CompressStaged();
+
+   std::vector<std::pair<RollingBuffer*, int>> mSources; //buffer and channel, one per captured channel
+   std::int64_t mMaxSamples{ 0 };
+   int mBlockSize{ 0 };
+   std::vector<Block> mBlocks;
+   std::unique_ptr<moodycamel::ReaderWriterQueue<Block*>> mFilledBlocks; //audio thread -> compressor thread
+   std::unique_ptr<moodycamel::ReaderWriterQueue<Block*>> mFreeBlocks; //compressor thread -> audio thread
+
+   std::mutex mChunksMutex; //the compressor thread holds it while it takes blocks, so a reader holding it can drain the rest itself
+   std::deque<Chunk> mChunks;
+   std::int64_t mChunkedSamples{ 0 };
+   std::vector<std::vector<float>> mStaged; //filling up to the next chunk
+   int mNumStaged{ 0 };
+
+   std::thread mCompressorThread;
+   std::atomic<bool> mStopCompressor{ false };
+   std::atomic<int> mNumDroppedBlocks{ 0 };
+};
@@ -52,6 +52,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //records its input
 
    //IButtonListener
    void ButtonClicked(ClickButton* button, double time) override;
@@ -63,6 +64,7 @@ public:
    void SetUpFromSaveData() override;
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override { return mRecordBuffer.GetMemoryUsage(); }
 
 private:
    //IDrawableModule
@@ -27,9 +27,26 @@
 #include "SynthGlobals.h"
 #include "UserPrefs.h"
 
-RollingBuffer::RollingBuffer(int sizeInSamples)
-: mBuffer(sizeInSamples)
+#include <array>
+
+namespace
+{
+   int RoundUpToPowerOfTwo(int size)
+   {
+      int powerOfTwo = 1;
+      while (powerOfTwo < size)
+         powerOfTwo <<= 1;
+      return powerOfTwo;
+   }
+}
+
+RollingBuffer::RollingBuffer(int sizeInSamples, bool roundUpToPowerOfTwo /*= false*/)
+: mBuffer(roundUpToPowerOfTwo ? RoundUpToPowerOfTwo(sizeInSamples) : sizeInSamples)
 {
+   mSize = mBuffer.BufferSize();
+   if (mSize > 0 && (mSize & (mSize - 1)) == 0)
+      mMask = mSize - 1;
+   ResetSignalTracking();
 }
 
 RollingBuffer::~RollingBuffer()
@@ -40,61 +57,121 @@ float RollingBuffer::GetSample(int samplesAgo, int channel)
 {
    assert(samplesAgo >= 0);
    assert(samplesAgo < Size());
-   return mBuffer.GetChannel(channel)[(Size() + mOffsetToNow[channel] - samplesAgo) % Size()];
+   return mBuffer.GetChannelReadOnly(channel)[WrapIndex(mOffsetToNow[channel] - samplesAgo)];
 }
 
 void RollingBuffer::ReadChunk(float* dst, int size, int samplesAgo, int channel)
 {
-   assert(size <= Size());
+   ReadSpan span = GetReadSpan(size, samplesAgo, channel);
+   BufferCopy(dst, span.mFirst, span.mFirstSize);
+   if (span.mSecondSize > 0) //wrap around loop point
+      BufferCopy(dst + span.mFirstSize, span.mSecond, span.mSecondSize);
+}
 
-   int offset = mOffsetToNow[channel] - samplesAgo;
-   if (offset < 0)
-      offset += Size();
+RollingBuffer::ReadSpan RollingBuffer::GetReadSpan(int size, int samplesAgo, int channel)
+{
+   assert(size <= Size());
 
-   int wrapSamples = size - offset;
-   if (wrapSamples <= 0) //no wraparound
-   {
-      BufferCopy(dst, mBuffer.GetChannel(channel) + (offset - size), size);
-   }
-   else //wrap around loop point
-   {
-      BufferCopy(dst, mBuffer.GetChannel(channel) + (Size() - wrapSamples), wrapSamples);
-      BufferCopy(dst + wrapSamples, mBuffer.GetChannel(channel), (size - wrapSamples));
-   }
+   ReadSpan span;
+   const float* data = mBuffer.GetChannelReadOnly(channel);
+   int start = WrapIndex(mOffsetToNow[channel] - samplesAgo - size);
+   span.mFirst = data + start;
+   span.mFirstSize = MIN(size, mSize - start);
+   span.mSecond = data;
+   span.mSecondSize = size - span.mFirstSize;
+   return span;
 }
 
 void RollingBuffer::Accum(int samplesAgo, float sample, int channel)
 {
    assert(samplesAgo < Size());
-   mBuffer.GetChannel(channel)[(Size() + mOffsetToNow[channel] - samplesAgo) % Size()] += sample;
+   mBuffer.GetChannel(channel)[WrapIndex(mOffsetToNow[channel] - samplesAgo)] += sample;
+   if (sample != 0)
+      mSamplesSinceSignal[channel] = MIN(mSamplesSinceSignal[channel], samplesAgo);
+}
+
+void RollingBuffer::WriteChunk(const float* samples, int size, int channel)
+{
+   WriteSpan span = GetWriteSpan(size, channel);
+   BufferCopy(span.mFirst, samples, span.mFirstSize);
+   if (span.mSecondSize > 0) //wrap around loop point
+      BufferCopy(span.mSecond, samples + span.mFirstSize, span.mSecondSize);
+   CommitWrite(size, channel);
+}
+
+void RollingBuffer::Write(float sample, int channel)
+{
+   mBuffer.GetChannel(channel)[mOffsetToNow[channel]] = sample;
+   if (sample != 0)
+      mSamplesSinceSignal[channel] = 0;
+   else if (mSamplesSinceSignal[channel] < mSize)
+      ++mSamplesSinceSignal[channel];
+   mOffsetToNow[channel] = WrapIndex(mOffsetToNow[channel] + 1);
+   if (channel != 0)
+      SyncChannelOffset(channel);
 }
 
-void RollingBuffer::WriteChunk(float* samples, int size, int channel)
+RollingBuffer::WriteSpan RollingBuffer::GetWriteSpan(int size, int channel)
 {
    assert(size < Size());
 
-   int wrapSamples = (mOffsetToNow[channel] + size) - Size();
-   if (wrapSamples <= 0) //no wraparound
-   {
-      BufferCopy(mBuffer.GetChannel(channel) + mOffsetToNow[channel], samples, size);
-   }
-   else //wrap around loop point
+   WriteSpan span;
+   float* data = mBuffer.GetChannel(channel);
+   span.mFirst = data + mOffsetToNow[channel];
+   span.mFirstSize = MIN(size, Size() - mOffsetToNow[channel]);
+   span.mSecond = data;
+   span.mSecondSize = size - span.mFirstSize;
+   return span;
+}
+
+void RollingBuffer::CommitWrite(int size, int channel)
+{
+   WriteSpan span = GetWriteSpan(size, channel);
+   TrackSignal(span.mFirst, span.mFirstSize, channel);
+   if (span.mSecondSize > 0)
+      TrackSignal(span.mSecond, span.mSecondSize, channel);
+
+   mOffsetToNow[channel] = WrapIndex(mOffsetToNow[channel] + size);
+   if (channel != 0)
+      SyncChannelOffset(channel);
+}
+
+void RollingBuffer::SyncChannelOffset(int channel)
+{
+   if (mOffsetToNow[channel] < mOffsetToNow[0] - gBufferSize * 2) //channels out of sync, probably was only writing to channel 0 for a while
+      mOffsetToNow[channel] = mOffsetToNow[0];
+}
+
+void RollingBuffer::TrackSignal(const float* samples, int size, int channel)
+{
+   for (int i = size - 1; i >= 0; --i)
    {
-      BufferCopy(mBuffer.GetChannel(channel) + mOffsetToNow[channel], samples, (size - wrapSamples));
-      BufferCopy(mBuffer.GetChannel(channel), samples + (size - wrapSamples), wrapSamples);
+      if (samples[i] != 0)
+      {
+         mSamplesSinceSignal[channel] = size - 1 - i;
+         return;
+      }
    }
+   mSamplesSinceSignal[channel] = MIN(mSamplesSinceSignal[channel] + size, Size());
+}
 
-   mOffsetToNow[channel] = (mOffsetToNow[channel] + size) % Size();
-   if (channel != 0 && mOffsetToNow[channel] < mOffsetToNow[0] - gBufferSize * 2) //channels out of sync, probably was only writing to channel 0 for a while
-      mOffsetToNow[channel] = mOffsetToNow[0];
+void RollingBuffer::ResetSignalTracking()
+{
+   for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
+      mSamplesSinceSignal[i] = Size();
 }
 
-void RollingBuffer::Write(float sample, int channel)
+bool RollingBuffer::IsSilent() const
 {
-   mBuffer.GetChannel(channel)[mOffsetToNow[channel]] = sample;
-   mOffsetToNow[channel] = (mOffsetToNow[channel] + 1) % Size();
-   if (channel != 0 && mOffsetToNow[channel] < mOffsetToNow[0] - gBufferSize * 2) //channels out of sync, probably was only writing to channel 0 for a while
-      mOffsetToNow[channel] = mOffsetToNow[0];
+   return GetSamplesSinceSignal() >= mBuffer.BufferSize();
+}
+
+int RollingBuffer::GetSamplesSinceSignal() const
+{
+   int samplesSinceSignal = mBuffer.BufferSize();
+   for (int ch = 0; ch < NumChannels(); ++ch)
+      samplesSinceSignal = MIN(samplesSinceSignal, mSamplesSinceSignal[ch]);
+   return samplesSinceSignal;
 }
 
 void RollingBuffer::ClearBuffer()
@@ -102,6 +179,7 @@ void RollingBuffer::ClearBuffer()
    mBuffer.Clear();
    for (int i = 0; i < ChannelBuffer::kMaxNumChannels; ++i)
       mOffsetToNow[i] = 0;
+   ResetSignalTracking();
 }
 
 void RollingBuffer::Draw(int x, int y, int width, int height, int length /*= -1*/, int channel /*= -1*/, int delayOffset /*= 0*/)
@@ -157,7 +235,17 @@ void RollingBuffer::SaveState(FileStreamOut& out)
    for (int i = 0; i < mBuffer.NumActiveChannels(); ++i)
    {
       out << mOffsetToNow[i];
-      out.Write(mBuffer.GetChannel(i), Size());
+      if (mBuffer.IsSilent(i))
+      {
+         //zeros don't need the channel allocated, or unshared, to be written out (see ChannelBuffer::ReleaseChannels())
+         static const std::array<float, 1024> kZeros{};
+         for (int written = 0; written < Size(); written += (int)kZeros.size())
+            out.Write(kZeros.data(), MIN((int)kZeros.size(), Size() - written));
+      }
+      else
+      {
+         out.Write(mBuffer.GetChannel(i), Size());
+      }
    }
 }
 
@@ -220,4 +308,9 @@ void RollingBuffer::LoadState(FileStreamIn& in)
          delete[] sampleLoader;
       }
    }
+
+   //there's no telling how long ago the loaded samples were written, so treat them as if they all arrived just now
+   ResetSignalTracking();
+   for (int i = 0; i < channels; ++i)
+      TrackSignal(mBuffer.GetChannel(i), Size(), i);
 }
@@ -31,25 +31,70 @@
 class RollingBuffer
 {
 public:
-   RollingBuffer(int sizeInSamples);
+   //roundUpToPowerOfTwo trades a little memory for wrapping indices with a mask instead of a divide, for buffers that are
+   //read and written every sample. sizes that are already powers of two get the mask either way
+   RollingBuffer(int sizeInSamples, bool roundUpToPowerOfTwo = false);
    ~RollingBuffer();
    float GetSample(int samplesAgo, int channel);
    void ReadChunk(float* dst, int size, int samplesAgo, int channel);
-   void WriteChunk(float* samples, int size, int channel);
+   void WriteChunk(const float* samples, int size, int channel);
    void Write(float sample, int channel);
+
+   //for writing straight into the buffer: the next size samples, split where they wrap around.
+   //fill both pieces, then CommitWrite() to move "now" past them
+   struct WriteSpan
+   {
+      float* mFirst{ nullptr };
+      int mFirstSize{ 0 };
+      float* mSecond{ nullptr };
+      int mSecondSize{ 0 };
+   };
+   WriteSpan GetWriteSpan(int size, int channel);
+   void CommitWrite(int size, int channel);
+
+   //for reading straight out of the buffer: the size samples that end samplesAgo before now (what ReadChunk() would copy),
+   //oldest first, split where they wrap around
+   struct ReadSpan
+   {
+      const float* mFirst{ nullptr };
+      int mFirstSize{ 0 };
+      const float* mSecond{ nullptr };
+      int mSecondSize{ 0 };
+   };
+   ReadSpan GetReadSpan(int size, int samplesAgo, int channel);
    void ClearBuffer();
    void Draw(int x, int y, int width, int height, int length = -1, int channel = -1, int delayOffset = 0);
-   int Size() { return mBuffer.BufferSize(); }
+   int Size() const { return mSize; }
    ChannelBuffer* GetRawBuffer() { return &mBuffer; }
    int GetRawBufferOffset(int channel) { return mOffsetToNow[channel]; }
    void Accum(int samplesAgo, float sample, int channel);
    void SetNumChannels(int channels) { mBuffer.SetNumActiveChannels(channels); }
    int NumChannels() const { return mBuffer.NumActiveChannels(); }
+   size_t GetMemoryUsage() const { return mBuffer.GetMemoryUsage(); }
+   //true if every sample in the buffer is zero. tracked as samples are written, so it's cheap to ask every frame
+   bool IsSilent() const;
+   int GetSamplesSinceSignal() const;
 
    void SaveState(FileStreamOut& out);
    void LoadState(FileStreamIn& in);
 
+   //any index, positive or negative, onto one in the buffer
+   int WrapIndex(int index) const
+   {
+      if (mMask != -1)
+         return index & mMask;
+      index %= mSize;
+      return index < 0 ? index + mSize : index;
+   }
+
 private:
+   void SyncChannelOffset(int channel);
+   void TrackSignal(const float* samples, int size, int channel);
+   void ResetSignalTracking();
+
    int mOffsetToNow[ChannelBuffer::kMaxNumChannels]{};
+   int mSamplesSinceSignal[ChannelBuffer::kMaxNumChannels]{}; //how long ago the last nonzero sample was written
    ChannelBuffer mBuffer;
+   int mSize{ 0 };
+   int mMask{ -1 }; //mSize - 1, when mSize is a power of two
 };
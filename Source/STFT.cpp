@@ -0,0 +1,114 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    STFT.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "STFT.h"
+
+STFT::STFT(int frameSize, int hopSize, int numInputs /*= 1*/)
+: mFrameSize(frameSize)
+, mHopSize(hopSize)
+, mFFT(frameSize)
+, mOutputRing(frameSize)
+{
+   assert(hopSize > 0 && hopSize <= frameSize);
+
+   mWindow = mFFT.GetHannWindow();
+
+   for (int i = 0; i < numInputs; ++i)
+   {
+      mFrames.push_back(std::make_unique<FFTData>(frameSize, GetNumBins()));
+      mInputRings.emplace_back(frameSize);
+   }
+
+   //each output sample is the sum of frameSize / hopSize frames, each windowed twice (analysis and synthesis),
+   //and the inverse transform is unnormalized
+   float windowPowerSum = 0;
+   for (int i = 0; i < frameSize; ++i)
+      windowPowerSum += mWindow[i] * mWindow[i];
+   float overlapGain = windowPowerSum / hopSize;
+   mSynthesisScale = 1.0f / (frameSize * overlapGain);
+
+   Clear();
+}
+
+void STFT::Clear()
+{
+   for (auto& ring : mInputRings)
+      ::Clear(ring.data(), mFrameSize);
+   ::Clear(mOutputRing.data(), mFrameSize);
+   for (auto& frame : mFrames)
+      frame->Clear();
+   mPos = 0;
+   mSamplesUntilHop = mHopSize;
+}
+
+void STFT::Advance(const float* const* inputs, float* output, int offset, int length)
+{
+   int done = 0;
+   while (done < length)
+   {
+      int run = MIN(length - done, mFrameSize - mPos);
+
+      for (size_t i = 0; i < mInputRings.size(); ++i)
+         BufferCopy(mInputRings[i].data() + mPos, inputs[i] + offset + done, run);
+
+      if (output != nullptr)
+      {
+         BufferCopy(output + offset + done, mOutputRing.data() + mPos, run);
+         ::Clear(mOutputRing.data() + mPos, run);
+      }
+
+      mPos = (mPos + run) % mFrameSize;
+      done += run;
+   }
+}
+
+void STFT::AnalyzeFrames()
+{
+   //unroll the rings oldest-first, in two pieces, around mPos
+   int firstRun = mFrameSize - mPos;
+   for (size_t i = 0; i < mInputRings.size(); ++i)
+   {
+      FFTData& frame = *mFrames[i];
+      BufferCopy(frame.mTimeDomain, mInputRings[i].data() + mPos, firstRun);
+      BufferCopy(frame.mTimeDomain + firstRun, mInputRings[i].data(), mPos);
+      Mult(frame.mTimeDomain, mWindow, mFrameSize);
+
+      mFFT.Forward(frame.mTimeDomain, frame.mRealValues, frame.mImaginaryValues);
+   }
+}
+
+void STFT::SynthesizeFrame()
+{
+   FFTData& frame = *mFrames[0];
+   mFFT.Inverse(frame.mRealValues, frame.mImaginaryValues, frame.mTimeDomain);
+   Mult(frame.mTimeDomain, mWindow, mFrameSize);
+   Mult(frame.mTimeDomain, mSynthesisScale, mFrameSize);
+
+   //the frame ends at mPos, which is also where the oldest output sample is
+   int firstRun = mFrameSize - mPos;
+   Add(mOutputRing.data() + mPos, frame.mTimeDomain, firstRun);
+   Add(mOutputRing.data(), frame.mTimeDomain + firstRun, mPos);
+}
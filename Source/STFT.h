@@ -0,0 +1,102 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    STFT.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FFT.h"
+
+#include <memory>
+#include <vector>
+
+//short-time fourier transform for the spectral modules: hann-windowed frames of frameSize samples are analyzed every hopSize
+//samples, and (optionally) resynthesized with a windowed overlap-add. frames only get computed when a hop boundary falls inside
+//the block being processed, so the cost depends on the hop size instead of on the audio buffer size.
+class STFT
+{
+public:
+   STFT(int frameSize, int hopSize, int numInputs = 1);
+
+   int GetFrameSize() const { return mFrameSize; }
+   int GetHopSize() const { return mHopSize; }
+   int GetNumBins() const { return mFrameSize / 2 + 1; }
+   int GetLatencySamples() const { return mFrameSize; } //from input to resynthesized output
+
+   //the latest spectrum of each input, laid out the way ::FFT leaves it
+   FFTData& GetFrame(int input = 0) { return *mFrames[input]; }
+
+   //multiplier applied to each inverse transform before it's windowed and overlapped.
+   //defaults to the value that brings an untouched spectrum back at unity gain
+   void SetSynthesisScale(float scale) { mSynthesisScale = scale; }
+
+   //feeds in a block (one pointer per input), calling onFrame(offset) with the new spectra in GetFrame() every time a hop completes.
+   //offset is the position in the block where that frame ends
+   template <typename OnFrame>
+   void Analyze(const float* const* inputs, int bufferSize, OnFrame onFrame) { Run(inputs, nullptr, bufferSize, onFrame); }
+
+   //same as Analyze(), and also resynthesizes GetFrame(0), as left by onFrame, into output
+   template <typename OnFrame>
+   void Process(const float* const* inputs, float* output, int bufferSize, OnFrame onFrame) { Run(inputs, output, bufferSize, onFrame); }
+
+   void Clear();
+
+private:
+   template <typename OnFrame>
+   void Run(const float* const* inputs, float* output, int bufferSize, OnFrame& onFrame)
+   {
+      int offset = 0;
+      while (offset < bufferSize)
+      {
+         int length = MIN(bufferSize - offset, mSamplesUntilHop);
+         Advance(inputs, output, offset, length);
+         offset += length;
+         mSamplesUntilHop -= length;
+
+         if (mSamplesUntilHop == 0)
+         {
+            mSamplesUntilHop = mHopSize;
+            AnalyzeFrames();
+            onFrame(offset);
+            if (output != nullptr)
+               SynthesizeFrame();
+         }
+      }
+   }
+
+   void Advance(const float* const* inputs, float* output, int offset, int length);
+   void AnalyzeFrames();
+   void SynthesizeFrame();
+
+   int mFrameSize{ 0 };
+   int mHopSize{ 0 };
+   const float* mWindow{ nullptr };
+   float mSynthesisScale{ 1 };
+   ::FFT mFFT;
+   std::vector<std::unique_ptr<FFTData>> mFrames;
+   std::vector<std::vector<float>> mInputRings; //the last frameSize samples of each input, oldest at mPos
+   std::vector<float> mOutputRing; //overlap-add accumulator, the sample at mPos is the next one out
+   int mPos{ 0 };
+   int mSamplesUntilHop{ 0 };
+};
@@ -28,16 +28,25 @@
 #include "FileStream.h"
 #include "ModularSynth.h"
 #include "ChannelBuffer.h"
+#include "SampleCache.h"
+#include "SampleLoader.h"
+#include "OnsetIndex.h"
+#include "SampleStream.h"
+#include "SaveStateChunks.h"
+#include "UserPrefs.h"
 #include <memory>
 
 #include "juce_audio_formats/juce_audio_formats.h"
 
 Sample::Sample()
 {
+   mData.EnablePeaks();
 }
 
 Sample::~Sample()
 {
+   CancelLoad();
+   delete mReader;
 }
 
 bool Sample::Read(const char* path, bool mono, ReadType readType)
@@ -48,12 +57,40 @@ bool Sample::Read(const char* path, bool mono, ReadType readType)
    mName = tokens[tokens.size() - 1];
 
    juce::File file(ofToSamplePath(mReadPath));
+   CancelLoad();
+   mOnsets.reset();
    delete mReader;
    mReader = TheSynth->GetAudioFormatManager().createReaderFor(file);
+   mStream.reset();
 
    if (mReader != nullptr)
    {
-      mData.Resize((int)mReader->lengthInSamples);
+      const float kStreamHeadSeconds = 10;
+      bool stream = readType == ReadType::Stream &&
+                    mReader->lengthInSamples > UserPrefs.stream_samples_longer_than_minutes.Get() * 60 * mReader->sampleRate &&
+                    mReader->lengthInSamples > 2 * kStreamHeadSeconds * mReader->sampleRate;
+      int bufferLength = stream ? int(kStreamHeadSeconds * mReader->sampleRate) : (int)mReader->lengthInSamples;
+      if (!stream && readType != ReadType::Async && SampleLoader::Get().IsBatching())
+         readType = ReadType::Async;
+
+      mReadMono = mono;
+
+      if (!stream)
+      {
+         std::shared_ptr<const SampleCache::Data> shared = SampleCache::Get().Find(file.getFullPathName().toStdString(), mono);
+         if (shared != nullptr)
+         {
+            //already decoded, either by another module or in an earlier session
+            UseSharedData(shared);
+            mOffset = mNumSamples;
+            mOriginalSampleRate = shared->SampleRate();
+            mSampleRateRatio = float(mOriginalSampleRate) / gSampleRate;
+            return true;
+         }
+      }
+
+      mData.Resize(bufferLength);
+      mSharedData.reset();
       if (mono)
          mData.SetNumActiveChannels(1);
       else
@@ -66,17 +103,31 @@ bool Sample::Read(const char* path, bool mono, ReadType readType)
       mSampleRateRatio = float(mOriginalSampleRate) / gSampleRate;
 
       mReadBuffer = std::make_unique<juce::AudioSampleBuffer>();
-      mReadBuffer->setSize(mReader->numChannels, mNumSamples);
+      mReadBuffer->setSize(mReader->numChannels, bufferLength);
+
+      if (stream)
+      {
+         //decode just the head now, the stream takes it from there
+         mReader->read(mReadBuffer.get(), 0, bufferLength, 0, true, true);
+         FinishRead();
+         mReadBuffer.reset();
 
-      if (readType == ReadType::Sync)
+         std::unique_ptr<juce::AudioFormatReader> streamReader(TheSynth->GetAudioFormatManager().createReaderFor(file));
+         if (streamReader != nullptr)
+            mStream = std::make_unique<SampleStream>(std::move(streamReader), bufferLength, mData.NumActiveChannels());
+         else
+            mNumSamples = bufferLength;
+      }
+      else if (readType == ReadType::Sync || readType == ReadType::Stream)
       {
          mReader->read(mReadBuffer.get(), 0, mNumSamples, 0, true, true);
          FinishRead();
+         ShareDecodedData();
       }
       else if (readType == ReadType::Async)
       {
          mSamplesLeftToRead = mNumSamples;
-         startTimer(100);
+         SampleLoader::Get().Load(this);
       }
 
       return true;
@@ -103,28 +154,180 @@ void Sample::FinishRead()
       for (int ch = 0; ch < mReadBuffer->getNumChannels(); ++ch)
          BufferCopy(mData.GetChannel(ch), mReadBuffer->getReadPointer(ch), mReadBuffer->getNumSamples());
    }
+   mData.MarkPeaksDirty();
 }
 
-//juce::Timer
-void Sample::timerCallback()
+bool Sample::ReadNextChunk()
 {
-   int samplesToRead = 44100 * 10;
-   if (samplesToRead > mSamplesLeftToRead)
-      samplesToRead = mSamplesLeftToRead;
+   int samplesToRead = MIN(44100 * 10, mSamplesLeftToRead.load());
    int startSample = mNumSamples - mSamplesLeftToRead;
    mReader->read(mReadBuffer.get(), startSample, samplesToRead, startSample, true, true);
-   mSamplesLeftToRead -= samplesToRead;
 
-   if (mSamplesLeftToRead <= 0)
+   if (samplesToRead == mSamplesLeftToRead)
    {
+      LockDataMutex(true);
       FinishRead();
-      stopTimer();
+      LockDataMutex(false);
+      ShareDecodedData();
+   }
+
+   mSamplesLeftToRead -= samplesToRead; //only reaches zero once the data is in place
+   return mSamplesLeftToRead <= 0;
+}
+
+void Sample::LoadSampleBlock(int block, int numChannels)
+{
+   mOnsets.reset();
+   SaveStateChunkReader* reader = SaveStateChunkReader::GetActive();
+   if (reader == nullptr || !reader->IsValidSampleBlock(block, numChannels, mNumSamples))
+   {
+      TheSynth->LogEvent("couldn't find sample data in save state", kLogEventType_Error);
+      mData.Resize(0);
+      mSharedData.reset();
+      mNumSamples = 0;
+      return;
+   }
+
+   std::shared_ptr<const SampleCache::Data> shared = SampleCache::MapFileRegion(reader->GetPath(), reader->GetChunkOffset(block), numChannels, mNumSamples, SaveStateChunk::GetSampleBlockStride(mNumSamples));
+   LockDataMutex(true);
+   if (shared != nullptr)
+   {
+      UseSharedData(shared);
+   }
+   else
+   {
+      mData.Resize(mNumSamples);
+      mSharedData.reset();
+      reader->ReadSampleBlock(block, &mData, numChannels, mNumSamples);
+      mData.MarkPeaksDirty();
+   }
+   LockDataMutex(false);
+}
+
+void Sample::CancelLoad()
+{
+   SampleLoader::Get().Cancel(this);
+   mSamplesLeftToRead = 0;
+}
+
+void Sample::ShareDecodedData()
+{
+   mReadBuffer.reset(); //we have it all in mData now
+   delete mReader; //and don't need to keep the file open
+   mReader = nullptr;
+
+   std::string path = juce::File(ofToSamplePath(mReadPath)).getFullPathName().toStdString();
+   std::shared_ptr<const SampleCache::Data> shared = SampleCache::Get().Add(path, mReadMono, &mData, mNumSamples, mOriginalSampleRate);
+   LockDataMutex(true);
+   UseSharedData(shared);
+   LockDataMutex(false);
+}
+
+void Sample::UseSharedData(std::shared_ptr<const SampleCache::Data> shared)
+{
+   float* channels[2];
+   for (int ch = 0; ch < shared->NumChannels(); ++ch)
+      channels[ch] = shared->GetChannel(ch);
+   mData.SetExternalData(channels, shared->NumChannels(), shared->NumSamples());
+   mNumSamples = shared->NumSamples();
+   mSharedData = std::move(shared);
+}
+
+bool Sample::CanHibernate() const
+{
+   return mSharedData != nullptr && !mReadPath.empty() && !IsStreaming() && mSamplesLeftToRead == 0 &&
+          juce::File(ofToSamplePath(mReadPath)).existsAsFile();
+}
+
+bool Sample::Hibernate()
+{
+   if (!CanHibernate())
+      return false;
+
+   LockDataMutex(true);
+   mData.Resize(0);
+   mSharedData.reset();
+   mOnsets.reset();
+   mNumSamples = 0;
+   mOffset = std::numeric_limits<double>::max();
+   LockDataMutex(false);
+   return true;
+}
+
+void Sample::Wake(ReadType readType)
+{
+   if (mNumSamples > 0 || IsSampleLoading())
+      return;
+
+   std::string name = mName;
+   Read(mReadPath.c_str(), mReadMono, readType);
+   mName = name;
+}
+
+std::shared_ptr<const OnsetIndex> Sample::GetOnsets()
+{
+   if (IsSampleLoading() || mNumSamples == 0 || NumChannels() == 0)
+      return nullptr;
+
+   if (mSharedData != nullptr)
+      return SampleCache::Get().GetOnsets(mSharedData);
+
+   if (mOnsets == nullptr)
+   {
+      if (mStream != nullptr)
+      {
+         //only the head is in memory, the job reads the rest of the file itself
+         std::unique_ptr<juce::AudioFormatReader> reader(TheSynth->GetAudioFormatManager().createReaderFor(juce::File(ofToSamplePath(mReadPath))));
+         if (reader == nullptr)
+            return nullptr;
+         mOnsets = OnsetIndex::Analyze(std::move(reader));
+      }
+      else
+      {
+         //a mono copy, so the job doesn't race edits to our data
+         std::vector<float> mono(mNumSamples);
+         BufferCopy(mono.data(), mData.GetChannel(0), mNumSamples);
+         for (int ch = 1; ch < NumChannels(); ++ch)
+            Add(mono.data(), mData.GetChannel(ch), mNumSamples);
+         Mult(mono.data(), 1.0f / NumChannels(), mNumSamples);
+         mOnsets = OnsetIndex::Analyze(std::move(mono), mOriginalSampleRate);
+      }
    }
+   return mOnsets;
+}
+
+size_t Sample::GetMemoryUsage() const
+{
+   //decoded data from SampleCache is split evenly between the samples sharing it
+   size_t bytes = mData.GetMemoryUsage();
+   if (mSharedData != nullptr)
+      bytes += size_t(mSharedData->NumChannels()) * mSharedData->NumSamples() * sizeof(float) / mSharedData.use_count();
+   return bytes;
+}
+
+//shared data is read-only, so take our own copy before changing it
+void Sample::MakeDataUnique()
+{
+   mOnsets.reset(); //it's about to be edited
+   if (mSharedData == nullptr)
+      return;
+
+   LockDataMutex(true);
+   int numChannels = mData.NumActiveChannels();
+   mData.Resize(mNumSamples);
+   mData.SetNumActiveChannels(numChannels);
+   for (int ch = 0; ch < numChannels; ++ch)
+      BufferCopy(mData.GetChannel(ch), mSharedData->GetChannel(ch), mNumSamples);
+   mSharedData.reset();
+   LockDataMutex(false);
 }
 
 void Sample::Create(int length)
 {
+   CancelLoad();
+   mStream.reset();
    mData.Resize(length);
+   mSharedData.reset();
    mData.SetNumActiveChannels(1);
    Setup(length);
 }
@@ -133,15 +336,20 @@ void Sample::Create(ChannelBuffer* data)
 {
    int channels = data->NumActiveChannels();
    int length = data->BufferSize();
+   CancelLoad();
+   mStream.reset();
    mData.Resize(length);
+   mSharedData.reset();
    mData.SetNumActiveChannels(channels);
    for (int ch = 0; ch < channels; ++ch)
       BufferCopy(mData.GetChannel(ch), data->GetChannel(ch), length);
+   mData.MarkPeaksDirty();
    Setup(length);
 }
 
 void Sample::Setup(int length)
 {
+   mOnsets.reset();
    mNumSamples = length;
    mRate = 1;
    mOffset = length;
@@ -220,7 +428,152 @@ bool Sample::ConsumeData(double time, ChannelBuffer* out, int size, bool replace
       return false;
    }
 
+   if (mStream != nullptr)
+   {
+      bool ret = ConsumeStreamedData(time, out, size, replace, end);
+      mPlayMutex.unlock();
+      return ret;
+   }
+
    LockDataMutex(true);
+   int startIndex = 0;
+   while (startIndex < size && time < mStartTime)
+   {
+      time += gInvSampleRateMs;
+      ++startIndex;
+   }
+   if (replace)
+   {
+      for (int ch = 0; ch < out->NumActiveChannels(); ++ch)
+         ::Clear(out->GetChannel(ch), startIndex);
+   }
+
+   double rate = mRate * mSampleRateRatio;
+   int numToPlay = size - startIndex;
+   int numAudible = numToPlay;
+   if (!mLooping && rate > 0)
+      numAudible = (int)ofClamp(ceil((end - mOffset) / rate), 0, numToPlay);
+
+   if (mStretcher != nullptr && rate > 0)
+   {
+      ConsumeStretchedData(out, startIndex, numToPlay, numAudible, rate, replace);
+      mOffset += numToPlay * rate;
+      LockDataMutex(false);
+      mPlayMutex.unlock();
+      return true;
+   }
+
+   for (int ch = 0; ch < out->NumActiveChannels(); ++ch)
+   {
+      const float* data = mData.GetChannel(MIN(ch, mData.NumActiveChannels() - 1));
+      float* dest = out->GetChannel(ch) + startIndex;
+      if (replace)
+      {
+         Resample(data, mNumSamples, mOffset, rate, dest, numAudible, mResampleQuality);
+         Mult(dest, mVolume, numAudible);
+         ::Clear(dest + numAudible, numToPlay - numAudible);
+      }
+      else
+      {
+         const int kChunkSize = 256;
+         float resampled[kChunkSize];
+         for (int chunkStart = 0; chunkStart < numAudible; chunkStart += kChunkSize)
+         {
+            int chunkSize = MIN(kChunkSize, numAudible - chunkStart);
+            Resample(data, mNumSamples, mOffset + chunkStart * rate, rate, resampled, chunkSize, mResampleQuality);
+            AddWithGain(dest + chunkStart, resampled, mVolume, chunkSize);
+         }
+      }
+   }
+   mOffset += numToPlay * rate;
+   LockDataMutex(false);
+   mPlayMutex.unlock();
+
+   return true;
+}
+
+void Sample::ConsumeStretchedData(ChannelBuffer* out, int startIndex, int numToPlay, int numAudible, double rate, bool replace)
+{
+   int numChannels = MIN(out->NumActiveChannels(), TimeStretcher::kMaxChannels);
+   TimeStretcher::Source source;
+   for (int ch = 0; ch < numChannels; ++ch)
+      source.mChannels[ch] = mData.GetChannelReadOnly(MIN(ch, mData.NumActiveChannels() - 1));
+   source.mLength = mNumSamples;
+   source.mLooping = mLooping;
+
+   const int kChunkSize = 256;
+   float stretched[TimeStretcher::kMaxChannels][kChunkSize];
+   float* stretchedChannels[TimeStretcher::kMaxChannels];
+   for (int ch = 0; ch < numChannels; ++ch)
+      stretchedChannels[ch] = stretched[ch];
+   for (int chunkStart = 0; chunkStart < numAudible; chunkStart += kChunkSize)
+   {
+      int chunkSize = MIN(kChunkSize, numAudible - chunkStart);
+      mStretcher->Process(source, mOffset + chunkStart * rate, rate, mSampleRateRatio, stretchedChannels, numChannels, chunkSize);
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         float* dest = out->GetChannel(ch) + startIndex + chunkStart;
+         if (replace)
+         {
+            BufferCopy(dest, stretched[ch], chunkSize);
+            Mult(dest, mVolume, chunkSize);
+         }
+         else
+         {
+            AddWithGain(dest, stretched[ch], mVolume, chunkSize);
+         }
+      }
+   }
+
+   if (replace)
+   {
+      for (int ch = 0; ch < out->NumActiveChannels(); ++ch)
+      {
+         if (ch >= numChannels)
+            ::Clear(out->GetChannel(ch) + startIndex, numAudible);
+         ::Clear(out->GetChannel(ch) + startIndex + numAudible, numToPlay - numAudible);
+      }
+   }
+}
+
+void Sample::SetStretchMode(StretchMode mode)
+{
+   if (mode == mStretchMode)
+      return;
+
+   //built out here, the audio thread only waits for the swap
+   std::unique_ptr<TimeStretcher> stretcher;
+   if (mode != StretchMode::Off)
+   {
+      stretcher = std::make_unique<TimeStretcher>();
+      stretcher->SetMode(mode);
+   }
+   mPlayMutex.lock();
+   std::swap(mStretcher, stretcher);
+   mStretchMode = mode;
+   mPlayMutex.unlock();
+}
+
+void Sample::PrefetchStream(double position)
+{
+   if (mStream != nullptr)
+      mStream->Prefetch(MAX((int64_t)position, (int64_t)mData.BufferSize()));
+}
+
+bool Sample::ConsumeStreamedData(double time, ChannelBuffer* out, int size, bool replace, double end)
+{
+   //make sure the part of the file this block will read is resident first
+   double advance = mRate * mSampleRateRatio * size;
+   int64_t low = (int64_t)floor(MIN(mOffset, mOffset + advance)) - 1;
+   int64_t high = (int64_t)ceil(MAX(mOffset, mOffset + advance)) + 1;
+   int64_t headLength = mData.BufferSize();
+   bool resident = true;
+   if (high >= headLength)
+      resident = mStream->Acquire(MAX(low, headLength), high);
+   else
+      mStream->Prefetch(headLength); //we'll leave the head soon, or just looped back into it
+
+   //if the reader fell behind, play silence but keep moving, so we stay in time
    for (int i = 0; i < size; ++i)
    {
       if (time < mStartTime)
@@ -238,8 +591,8 @@ bool Sample::ConsumeData(double time, ChannelBuffer* out, int size, bool replace
             int dataChannel = MIN(ch, mData.NumActiveChannels() - 1);
 
             float sample = 0;
-            if (mOffset < end || mLooping)
-               sample = GetInterpolatedSample(mOffset, mData.GetChannel(dataChannel), mNumSamples) * mVolume;
+            if (resident && (mOffset < end || mLooping))
+               sample = GetStreamedSample(mOffset, dataChannel) * mVolume;
 
             if (replace)
                out->GetChannel(ch)[i] = sample;
@@ -251,61 +604,108 @@ bool Sample::ConsumeData(double time, ChannelBuffer* out, int size, bool replace
       }
       time += gInvSampleRateMs;
    }
-   LockDataMutex(false);
-   mPlayMutex.unlock();
 
    return true;
 }
 
+float Sample::GetStreamedSample(double offset, int channel)
+{
+   if (mLooping)
+      offset = DoubleWrap(offset, mNumSamples);
+   int64_t pos = MAX((int64_t)offset, int64_t(0));
+   int64_t posNext = pos + 1;
+   if (posNext >= mNumSamples)
+      posNext = mLooping ? 0 : pos;
+
+   auto getSample = [this, channel](int64_t position)
+   {
+      if (position < mData.BufferSize())
+         return mData.GetChannel(channel)[position];
+      return mStream->GetSample(position, channel);
+   };
+
+   float a = float(offset - pos);
+   return (1 - a) * getSample(pos) + a * getSample(posNext);
+}
+
 void Sample::PadBack(int amount)
 {
-   //TODO(Ryan)
-   /*int newSamples = mNumSamples + amount;
-   float* newData = new float[newSamples];
-   BufferCopy(newData, mData, mNumSamples);
-   Clear(newData+mNumSamples, amount);
+   if (IsStreaming())
+      return; //we only have the head in memory
+   MakeDataUnique();
+
+   int newSamples = mNumSamples + amount;
+   ChannelBuffer old(mNumSamples);
+   old.CopyFrom(&mData, mNumSamples);
    LockDataMutex(true);
-   delete mData;
-   mData = newData;
+   mData.Resize(newSamples);
+   mData.CopyFrom(&old, mNumSamples); //the rest is left cleared by the resize
+   mNumSamples = newSamples;
    LockDataMutex(false);
-   mNumSamples = newSamples;*/
 }
 
 void Sample::ClipTo(int start, int end)
 {
-   //TODO(Ryan)
-   /*assert(start < end);
+   assert(start < end);
    assert(end <= mNumSamples);
-   int newSamples = end-start;
-   float* newData = new float[newSamples];
-   BufferCopy(newData, mData+start, newSamples);
+   if (IsStreaming())
+      return; //we only have the head in memory
+   MakeDataUnique();
+
+   int newSamples = end - start;
+   ChannelBuffer old(mNumSamples);
+   old.CopyFrom(&mData, mNumSamples);
    LockDataMutex(true);
-   delete mData;
-   mData = newData;
+   mData.Resize(newSamples);
+   mData.CopyFrom(&old, newSamples, start);
+   mNumSamples = newSamples;
    LockDataMutex(false);
-   mNumSamples = newSamples;*/
 }
 
 void Sample::ShiftWrap(int numSamplesToShift)
 {
-   //TODO(Ryan)
-   /*assert(numSamplesToShift <= mNumSamples);
-   float* newData = new float[mNumSamples];
+   assert(numSamplesToShift <= mNumSamples);
+   if (IsStreaming())
+      return; //we only have the head in memory
+   MakeDataUnique();
+
    int chunk = mNumSamples - numSamplesToShift;
-   BufferCopy(newData, mData+numSamplesToShift, chunk);
-   BufferCopy(newData+chunk, mData, numSamplesToShift);
+   ChannelBuffer old(mNumSamples);
+   old.CopyFrom(&mData, mNumSamples);
    LockDataMutex(true);
-   delete mData;
-   mData = newData;
-   LockDataMutex(false);*/
+   for (int ch = 0; ch < mData.NumActiveChannels(); ++ch)
+   {
+      BufferCopy(mData.GetChannel(ch), old.GetChannel(ch) + numSamplesToShift, chunk);
+      BufferCopy(mData.GetChannel(ch) + chunk, old.GetChannel(ch), numSamplesToShift);
+   }
+   mData.MarkPeaksDirty();
+   LockDataMutex(false);
 }
 
 void Sample::CopyFrom(Sample* sample)
 {
-   mNumSamples = sample->mNumSamples;
-   if (mData.BufferSize() != sample->mData.BufferSize())
-      mData.Resize(sample->mNumSamples);
-   mData.CopyFrom(&sample->mData);
+   CancelLoad();
+   if (sample->IsStreaming())
+   {
+      //open our own stream of the same file, rather than copying the head and losing the rest
+      Read(sample->mReadPath.c_str(), sample->mReadMono, ReadType::Stream);
+   }
+   else if (sample->mSharedData != nullptr)
+   {
+      mStream.reset();
+      UseSharedData(sample->mSharedData);
+   }
+   else
+   {
+      mStream.reset();
+      mNumSamples = sample->mNumSamples;
+      if (mData.BufferSize() != sample->mData.BufferSize() || mSharedData != nullptr)
+         mData.Resize(sample->mNumSamples);
+      mSharedData.reset();
+      mData.CopyFrom(&sample->mData);
+   }
+   mOnsets = sample->mOnsets;
+   mReadMono = sample->mReadMono;
    mNumBars = sample->mNumBars;
    mLooping = sample->mLooping;
    mRate = sample->mRate;
@@ -318,16 +718,37 @@ void Sample::CopyFrom(Sample* sample)
 
 namespace
 {
-   const int kSaveStateRev = 1;
+   const int kSaveStateRev = 4;
 }
 
 void Sample::SaveState(FileStreamOut& out)
 {
    out << kSaveStateRev;
 
-   out << mNumSamples;
-   if (mNumSamples > 0)
-      mData.Save(out, mNumSamples);
+   out << IsStreaming();
+   if (IsStreaming())
+   {
+      //the audio stays on disk, just remember where it is
+      out << mReadPath;
+      out << mReadMono;
+   }
+   else
+   {
+      out << mNumSamples;
+      //in a chunked save state, the data goes in its own block that can be mapped when loading
+      SaveStateChunkWriter* writer = SaveStateChunkWriter::GetActive();
+      bool inBlock = writer != nullptr && mNumSamples > 0;
+      out << inBlock;
+      if (inBlock)
+      {
+         out << mData.NumActiveChannels();
+         out << writer->AddSampleBlock(&mData, mNumSamples);
+      }
+      else if (mNumSamples > 0)
+      {
+         mData.Save(out, mNumSamples);
+      }
+   }
    out << mNumBars;
    out << mLooping;
    out << mRate;
@@ -339,14 +760,48 @@ void Sample::SaveState(FileStreamOut& out)
 
 void Sample::LoadState(FileStreamIn& in)
 {
+   CancelLoad();
    int rev;
    in >> rev;
 
-   in >> mNumSamples;
-   if (mNumSamples > 0)
+   bool streaming = false;
+   if (rev >= 2)
+      in >> streaming;
+
+   if (streaming)
+   {
+      std::string readPath;
+      bool mono;
+      in >> readPath;
+      in >> mono;
+      Read(readPath.c_str(), mono, ReadType::Stream);
+   }
+   else
+   {
+      in >> mNumSamples;
+   }
+
+   bool inBlock = false;
+   if (!streaming && rev >= 3)
+      in >> inBlock;
+
+   if (inBlock)
+   {
+      int numChannels;
+      int block;
+      in >> numChannels;
+      in >> block;
+      SaveStateChunkReader* reader = SaveStateChunkReader::GetActive();
+      if (rev >= 4 && reader != nullptr)
+         block = reader->GetModuleSampleBlock(block); //numbered within the module's own blocks
+      LoadSampleBlock(block, numChannels);
+   }
+   else if (!streaming && mNumSamples > 0)
    {
       int readLength;
       mData.Load(in, readLength, ChannelBuffer::LoadMode::kSetBufferSize);
+      mSharedData.reset();
+      mOnsets.reset();
       assert(readLength == mNumSamples);
       /*for (int ch=0; ch<mData.NumActiveChannels(); ++ch)
       {
@@ -27,12 +27,19 @@
 
 #include "OpenFrameworksPort.h"
 #include "ChannelBuffer.h"
+#include "Resampler.h"
+#include "SampleCache.h"
+#include "TimeStretcher.h"
+#include <atomic>
 #include <limits>
+#include <memory>
 
 #include "juce_events/juce_events.h"
 
 class FileStreamOut;
 class FileStreamIn;
+class SampleStream;
+class OnsetIndex;
 
 namespace juce
 {
@@ -42,13 +49,14 @@ namespace juce
    using AudioSampleBuffer = AudioBuffer<float>;
 }
 
-class Sample : public juce::Timer
+class Sample
 {
 public:
    enum class ReadType
    {
-      Sync,
-      Async
+      Sync, //unless a SampleLoader batch is open, then it's read like Async
+      Async, //decoded on SampleLoader's threads, the sample plays silence until it's done
+      Stream //plays long files from disk, see SampleStream. files shorter than the "stream_samples_longer_than_minutes" pref are read like Sync
    };
 
    Sample();
@@ -62,7 +70,10 @@ public:
    void SetName(std::string name) { mName = name; }
    int LengthInSamples() const { return mNumSamples; }
    int NumChannels() const { return mData.NumActiveChannels(); }
-   ChannelBuffer* Data() { return &mData; }
+   ChannelBuffer* Data() { return &mData; } //when streaming, this only holds the head of the sample
+   size_t GetMemoryUsage() const;
+   bool IsStreaming() const { return mStream != nullptr; }
+   void PrefetchStream(double position); //audio thread, so that starting to play from position later doesn't have to wait for the disk
    double GetPlayPosition() const { return mOffset; }
    void SetPlayPosition(double sample) { mOffset = sample; }
    float GetSampleRateRatio() const { return mSampleRateRatio; }
@@ -84,18 +95,39 @@ public:
    void SetNumBars(int numBars) { mNumBars = numBars; }
    int GetNumBars() const { return mNumBars; }
    void SetVolume(float vol) { mVolume = vol; }
+   void SetResampleQuality(ResampleQuality quality) { mResampleQuality = quality; } //for ConsumeData(), streamed samples always play back linearly
+   //main thread. with a stretch mode, ConsumeData() plays forward at the rate without changing pitch. streamed samples still resample
+   void SetStretchMode(StretchMode mode);
+   StretchMode GetStretchMode() const { return mStretchMode; }
    void CopyFrom(Sample* sample);
    bool IsSampleLoading() { return mSamplesLeftToRead > 0; }
    float GetSampleLoadProgress() { return (mNumSamples > 0) ? (1 - (float(mSamplesLeftToRead) / mNumSamples)) : 1; }
+   //main thread. where the transients are, analyzed in the background the first time this is asked for, so check OnsetIndex::IsReady().
+   //nullptr while the sample is still loading. data read from a file shares its analysis through SampleCache
+   std::shared_ptr<const OnsetIndex> GetOnsets();
 
    void SaveState(FileStreamOut& out);
    void LoadState(FileStreamIn& in);
 
+   //main thread. lets go of data read from a file, since SampleCache can give it back later. false if there's nothing to let go of,
+   //or it couldn't be read again (edited, streamed, still loading, or mapped from a save state)
+   bool CanHibernate() const;
+   bool Hibernate();
+   void Wake(ReadType readType = ReadType::Async); //reads the file again, unless that's already happened
+
+   bool ReadNextChunk(); //SampleLoader's threads, returns true when done
+   void CancelLoad(); //waits for a background read to stop, so call it before taking the data mutex: the read takes it to finish
+
 private:
    void Setup(int length);
    void FinishRead();
-   //juce::Timer
-   void timerCallback();
+   void ShareDecodedData();
+   void UseSharedData(std::shared_ptr<const SampleCache::Data> shared);
+   void MakeDataUnique();
+   bool ConsumeStreamedData(double time, ChannelBuffer* out, int size, bool replace, double end);
+   void ConsumeStretchedData(ChannelBuffer* out, int startIndex, int numToPlay, int numAudible, double rate, bool replace);
+   float GetStreamedSample(double offset, int channel);
+   void LoadSampleBlock(int block, int numChannels);
 
    ChannelBuffer mData{ 0 };
    int mNumSamples{ 0 };
@@ -112,8 +144,16 @@ private:
    bool mLooping{ false };
    int mNumBars{ -1 };
    float mVolume{ 1 };
+   ResampleQuality mResampleQuality{ ResampleQuality::Linear };
+   StretchMode mStretchMode{ StretchMode::Off };
+   std::unique_ptr<TimeStretcher> mStretcher;
 
    juce::AudioFormatReader* mReader{};
    std::unique_ptr<juce::AudioSampleBuffer> mReadBuffer;
-   int mSamplesLeftToRead{ 0 };
+   std::atomic<int> mSamplesLeftToRead{ 0 };
+
+   std::unique_ptr<SampleStream> mStream;
+   bool mReadMono{ false };
+   std::shared_ptr<const SampleCache::Data> mSharedData; //read-only, see SampleCache
+   std::shared_ptr<const OnsetIndex> mOnsets; //for data that isn't shared or is streamed, dropped whenever the data changes
 };
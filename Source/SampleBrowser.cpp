@@ -50,6 +50,7 @@ void SampleBrowser::CreateUIControls()
    IDrawableModule::CreateUIControls();
 
    UIBLOCK(3, 20);
+   TEXTENTRY(mSearchEntry, "search", 36, &mSearch);
    for (int i = 0; i < (int)mButtons.size(); ++i)
    {
       xOffset += 270;
@@ -82,8 +83,32 @@ void SampleBrowser::DrawModule()
       textX = moduleWidth - 3 - stringWidth;
    gFont.DrawString(mCurrentDirectory.toStdString(), fontSize, textX, 15);
 
-   for (size_t i = 0; i < mButtons.size(); ++i)
+   mSearchEntry->Draw();
+
+   int offset = mCurrentPage * (int)mButtons.size();
+   for (int i = 0; i < (int)mButtons.size(); ++i)
+   {
+      //peak thumbnail from the library index, behind the file's name
+      if (mButtons[i]->IsShowing() && i + offset < (int)mDirectoryListing.size() && mDirectoryListing[i + offset].mHasAudioInfo)
+      {
+         const auto& thumbnail = mDirectoryListing[i + offset].mThumbnail;
+         ofVec2f pos = mButtons[i]->GetPosition(true);
+         const float kThumbnailX = 200;
+         const float kThumbnailWidth = 64;
+         const float kRowHeight = 15;
+         ofPushStyle();
+         ofSetColor(255, 255, 255, 50);
+         ofFill();
+         float sliceWidth = kThumbnailWidth / SampleLibrary::kThumbnailSize;
+         for (int j = 0; j < SampleLibrary::kThumbnailSize; ++j)
+         {
+            float height = thumbnail[j] / 255.0f * kRowHeight;
+            ofRect(kThumbnailX + j * sliceWidth, pos.y + (kRowHeight - height) * .5f, sliceWidth, MAX(height, 1), 0);
+         }
+         ofPopStyle();
+      }
       mButtons[i]->Draw();
+   }
    for (int i = 0; i < (int)mPlayButtons.size(); ++i)
    {
       mPlayButtons[i]->SetDisplayStyle(IsSamplePlaying(i) ? ButtonDisplayStyle::kStop : ButtonDisplayStyle::kPlay);
@@ -95,11 +120,23 @@ void SampleBrowser::DrawModule()
    int numPages = GetNumPages();
    if (numPages > 1)
       DrawTextNormal(ofToString(mCurrentPage + 1) + "/" + ofToString(numPages), 40, mBackButton->GetPosition(true).y + 12);
+   if (!mDirectoryScanned)
+      DrawTextNormal("scanning...", 120, mBackButton->GetPosition(true).y + 12);
+}
+
+void SampleBrowser::Poll()
+{
+   IDrawableModule::Poll();
+
+   //pick up whatever the library's background scan has found since we last looked
+   if (SampleLibrary::Get().GetRevision() != mLibraryRevision)
+      UpdateListing(false);
 }
 
 bool SampleBrowser::IsSamplePlaying(int index) const
 {
-   return mPlayingSample.IsPlaying() && mButtons[index]->IsShowing() && mDirectoryListing[index] == juce::String(mPlayingSample.GetReadPath());
+   int entryIndex = mCurrentPage * (int)mButtons.size() + index;
+   return mPlayingSample.IsPlaying() && mButtons[index]->IsShowing() && entryIndex < (int)mDirectoryListing.size() && mDirectoryListing[entryIndex].mPath == mPlayingSample.GetReadPath();
 }
 
 void SampleBrowser::ButtonClicked(ClickButton* button, double time)
@@ -116,7 +153,8 @@ void SampleBrowser::ButtonClicked(ClickButton* button, double time)
          int entryIndex = offset + i;
          if (entryIndex < (int)mDirectoryListing.size())
          {
-            String clicked = mDirectoryListing[entryIndex];
+            const SampleLibrary::FileInfo& entry = mDirectoryListing[entryIndex];
+            String clicked = entry.mPath;
             if (button == mButtons[i])
             {
                if (clicked == "..")
@@ -127,7 +165,7 @@ void SampleBrowser::ButtonClicked(ClickButton* button, double time)
                   else
                      SetDirectory("");
                }
-               else if (File(clicked).isDirectory())
+               else if (entry.mIsDirectory)
                {
                   SetDirectory(clicked);
                }
@@ -171,44 +209,46 @@ void SampleBrowser::Process(double time)
    int bufferSize = target->GetBuffer()->BufferSize();
    assert(bufferSize == gBufferSize);
 
-   gWorkChannelBuffer.Clear();
+   gWorkChannelBuffer->Clear();
    mSampleMutex.lock();
    if (mPlayingSample.IsPlaying())
-      mPlayingSample.ConsumeData(time, &gWorkChannelBuffer, bufferSize, true);
+      mPlayingSample.ConsumeData(time, gWorkChannelBuffer, bufferSize, true);
    mSampleMutex.unlock();
 
    const int kNumChannels = 2;
-   if (gWorkChannelBuffer.NumActiveChannels() == 1)
+   if (gWorkChannelBuffer->NumActiveChannels() == 1)
    {
-      gWorkChannelBuffer.SetNumActiveChannels(2);
-      BufferCopy(gWorkChannelBuffer.GetChannel(1), gWorkChannelBuffer.GetChannel(0), bufferSize);
+      gWorkChannelBuffer->SetNumActiveChannels(2);
+      BufferCopy(gWorkChannelBuffer->GetChannel(1), gWorkChannelBuffer->GetChannel(0), bufferSize);
    }
    SyncOutputBuffer(kNumChannels);
    for (int ch = 0; ch < kNumChannels; ++ch)
    {
-      GetVizBuffer()->WriteChunk(gWorkChannelBuffer.GetChannel(ch), bufferSize, ch);
-      Add(target->GetBuffer()->GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), bufferSize);
+      GetVizBuffer()->WriteChunk(gWorkChannelBuffer->GetChannel(ch), bufferSize, ch);
+      Add(target->GetBuffer()->GetChannel(ch), gWorkChannelBuffer->GetChannel(ch), bufferSize);
    }
 }
 
 namespace
 {
-   int CompareDirectoryListing(const String& text, const String& other)
+   int CompareDirectoryListing(const SampleLibrary::FileInfo& entry, const SampleLibrary::FileInfo& other)
    {
-      if (text == other)
+      if (entry.mPath == other.mPath)
          return 0;
-      bool isDir = text == ".." || File(text).isDirectory();
-      bool isOtherDir = other == ".." || File(other).isDirectory();
-      if (isDir && !isOtherDir)
+      if (entry.mPath == "..")
+         return -1;
+      if (other.mPath == "..")
+         return 1;
+      if (entry.mIsDirectory && !other.mIsDirectory)
          return -1;
-      if (!isDir && isOtherDir)
+      if (!entry.mIsDirectory && other.mIsDirectory)
          return 1;
-      return text.compareIgnoreCase(other);
+      return String(entry.mPath).compareIgnoreCase(other.mPath);
    }
 
-   void SortDirectoryListing(StringArray& listing)
+   void SortDirectoryListing(std::vector<SampleLibrary::FileInfo>& listing)
    {
-      std::sort(listing.begin(), listing.end(), [](const String& a, const String& b)
+      std::sort(listing.begin(), listing.end(), [](const SampleLibrary::FileInfo& a, const SampleLibrary::FileInfo& b)
                 {
                    return CompareDirectoryListing(a, b) < 0;
                 });
@@ -218,53 +258,56 @@ namespace
 void SampleBrowser::SetDirectory(String dirPath)
 {
    mCurrentDirectory = dirPath;
+   UpdateListing(true);
+   ShowPage(0);
+}
 
+void SampleBrowser::UpdateListing(bool rescan)
+{
+   mLibraryRevision = SampleLibrary::Get().GetRevision();
    mDirectoryListing.clear();
+   mDirectoryScanned = true;
 
-   if (dirPath != "")
+   if (!mSearch.empty())
    {
-      String matcher = TheSynth->GetAudioFormatManager().getWildcardForAllFormats();
-
-      StringArray wildcards;
-      wildcards.addTokens(matcher, ";,", "\"'");
-      wildcards.trim();
-      wildcards.removeEmptyStrings();
-
-      mDirectoryListing.add("..");
-
-      File dir(ofToSamplePath(dirPath.toStdString()));
-      for (auto& file : dir.findChildFiles(File::findFilesAndDirectories | File::ignoreHiddenFiles, false))
-      {
-         bool include = false;
-         if (file.isDirectory())
-         {
-            include = true;
-         }
-         else
-         {
-            for (auto& w : wildcards)
-            {
-               if (file.getFileName().matchesWildcard(w, true))
-               {
-                  include = true;
-                  break;
-               }
-            }
-         }
-         if (include)
-            mDirectoryListing.add(file.getFullPathName());
-      }
+      const int kMaxSearchResults = 1000;
+      SampleLibrary::Get().Search(mSearch, mDirectoryListing, kMaxSearchResults);
+   }
+   else if (mCurrentDirectory != "")
+   {
+      //everything comes out of the library index, which keeps itself up to date in the background
+      std::string dirPath = File(ofToSamplePath(mCurrentDirectory.toStdString())).getFullPathName().toStdString();
+      mDirectoryScanned = SampleLibrary::Get().GetDirectory(dirPath, mDirectoryListing, rescan);
+
+      SampleLibrary::FileInfo parent;
+      parent.mPath = "..";
+      parent.mIsDirectory = true;
+      mDirectoryListing.push_back(parent);
    }
    else
    {
       Array<File> roots;
       File::findFileSystemRoots(roots);
       for (auto& root : roots)
-         mDirectoryListing.add(root.getFullPathName());
+      {
+         SampleLibrary::FileInfo info;
+         info.mPath = root.getFullPathName().toStdString();
+         info.mIsDirectory = true;
+         mDirectoryListing.push_back(info);
+      }
    }
    SortDirectoryListing(mDirectoryListing);
 
-   ShowPage(0);
+   ShowPage(mCurrentPage);
+}
+
+void SampleBrowser::TextEntryComplete(TextEntry* entry)
+{
+   if (entry == mSearchEntry)
+   {
+      UpdateListing(false);
+      ShowPage(0);
+   }
 }
 
 void SampleBrowser::ShowPage(int page)
@@ -276,8 +319,9 @@ void SampleBrowser::ShowPage(int page)
    {
       if (i + offset < (int)mDirectoryListing.size())
       {
+         const SampleLibrary::FileInfo& entry = mDirectoryListing[i + offset];
          mButtons[i]->SetShowing(true);
-         if (mDirectoryListing[i + offset] == ".." || File(mDirectoryListing[i + offset]).isDirectory())
+         if (entry.mIsDirectory)
          {
             mButtons[i]->SetDisplayStyle(ButtonDisplayStyle::kFolderIcon);
             mPlayButtons[i]->SetShowing(false);
@@ -288,10 +332,10 @@ void SampleBrowser::ShowPage(int page)
             mPlayButtons[i]->SetShowing(true);
          }
 
-         if (mDirectoryListing[i + offset] == "..")
+         if (entry.mPath == "..")
             mButtons[i]->SetLabel("..");
          else
-            mButtons[i]->SetLabel(File(mDirectoryListing[i + offset]).getFileName().toStdString().c_str());
+            mButtons[i]->SetLabel(File(entry.mPath).getFileName().toStdString().c_str());
       }
       else
       {
@@ -31,8 +31,10 @@
 #include "Sample.h"
 #include "ClickButton.h"
 #include "IAudioSource.h"
+#include "SampleLibrary.h"
+#include "TextEntry.h"
 
-class SampleBrowser : public IDrawableModule, public IButtonListener, public IAudioSource
+class SampleBrowser : public IDrawableModule, public IButtonListener, public IAudioSource, public ITextEntryListener
 {
 public:
    SampleBrowser();
@@ -47,7 +49,10 @@ public:
    //IAudioSource
    void Process(double time) override;
 
+   void Poll() override;
+
    void ButtonClicked(ClickButton* button, double time) override;
+   void TextEntryComplete(TextEntry* entry) override;
 
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
@@ -63,16 +68,22 @@ private:
    void GetModuleDimensions(float& width, float& height) override
    {
       width = 300;
-      height = 38 + (int)mButtons.size() * 17;
+      height = 56 + (int)mButtons.size() * 17;
    }
 
    void SetDirectory(juce::String dirPath);
+   void UpdateListing(bool rescan);
    int GetNumPages() const;
    void ShowPage(int page);
    bool IsSamplePlaying(int index) const;
 
    juce::String mCurrentDirectory;
-   juce::StringArray mDirectoryListing;
+   std::vector<SampleLibrary::FileInfo> mDirectoryListing;
+   bool mDirectoryScanned{ true };
+   int mLibraryRevision{ 0 };
+   double mListingUpdateTime{ 0 };
+   std::string mSearch;
+   TextEntry* mSearchEntry{ nullptr };
    std::array<ClickButton*, 30> mButtons{ nullptr };
    std::array<ClickButton*, 30> mPlayButtons{ nullptr };
    ClickButton* mBackButton{ nullptr };
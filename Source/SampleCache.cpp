@@ -0,0 +1,341 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleCache.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SampleCache.h"
+#include "ChannelBuffer.h"
+#include "OnsetIndex.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "juce_core/juce_core.h"
+
+namespace
+{
+   const char kMagic[8] = { 'B', 'S', 'K', 'S', 'M', 'P', 'L', 'C' };
+   const int kCacheFileRev = 1;
+   const int kDataAlignment = 64;
+   const juce::int64 kMaxCacheFolderSize = juce::int64(4) * 1024 * 1024 * 1024;
+
+   struct Header
+   {
+      char mMagic[8];
+      int32_t mRev;
+      int32_t mNumChannels;
+      int32_t mNumSamples;
+      int32_t mSampleRate;
+      int32_t mKeyLength;
+      int32_t mDataOffset;
+   };
+
+   juce::File GetCacheFolder()
+   {
+      return juce::File(ofToDataPath("cache/samples"));
+   }
+
+   const int kTouchHeadsIntervalMs = 2000;
+   const int kFloatsPerPage = 4096 / sizeof(float);
+
+   class HeadWarmerThread : public juce::Thread
+   {
+   public:
+      HeadWarmerThread()
+      : juce::Thread("sample head warmer")
+      {
+      }
+
+      ~HeadWarmerThread() override
+      {
+         stopThread(1000);
+      }
+
+      void run() override
+      {
+         while (!threadShouldExit())
+         {
+            SampleCache::Get().TouchHeads();
+            wait(kTouchHeadsIntervalMs);
+         }
+      }
+   };
+
+   void StartHeadWarmer()
+   {
+      static HeadWarmerThread sThread;
+      if (!sThread.isThreadRunning())
+         sThread.startThread(1);
+   }
+}
+
+SampleCache::Data::~Data()
+{
+}
+
+SampleCache& SampleCache::Get()
+{
+   static SampleCache* sCache = new SampleCache(); //never destroyed, samples can outlive static destruction
+   return *sCache;
+}
+
+//static
+std::string SampleCache::GetKey(const std::string& path, bool mono)
+{
+   juce::File file(path);
+   return file.getFullPathName().toStdString() + "|" +
+          ofToString((int64_t)file.getLastModificationTime().toMilliseconds()) + "|" +
+          ofToString((int64_t)file.getSize()) + (mono ? "|mono" : "");
+}
+
+//static
+std::string SampleCache::GetCacheFilePath(const std::string& key)
+{
+   return GetCacheFolder().getChildFile(juce::String::toHexString((juce::int64)std::hash<std::string>()(key)) + ".samplecache").getFullPathName().toStdString();
+}
+
+std::shared_ptr<const SampleCache::Data> SampleCache::Find(const std::string& path, bool mono)
+{
+   std::string key = GetKey(path, mono);
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   auto it = mEntries.find(key);
+   if (it != mEntries.end())
+   {
+      if (auto data = it->second.lock())
+         return data;
+   }
+
+   std::shared_ptr<const Data> data = LoadCacheFile(key);
+   if (data != nullptr)
+   {
+      mEntries[key] = data;
+      KeepHeadWarm(data);
+   }
+   return data;
+}
+
+std::shared_ptr<const SampleCache::Data> SampleCache::Add(const std::string& path, bool mono, ChannelBuffer* decoded, int numSamples, int sampleRate)
+{
+   std::string key = GetKey(path, mono);
+   int numChannels = MIN(decoded->NumActiveChannels(), 2);
+
+   GetCacheFolder().createDirectory();
+   juce::File cacheFile(GetCacheFilePath(key));
+   juce::TemporaryFile tempFile(cacheFile);
+   bool written = false;
+   {
+      juce::FileOutputStream out(tempFile.getFile());
+      if (out.openedOk())
+      {
+         Header header{};
+         memcpy(header.mMagic, kMagic, sizeof(kMagic));
+         header.mRev = kCacheFileRev;
+         header.mNumChannels = numChannels;
+         header.mNumSamples = numSamples;
+         header.mSampleRate = sampleRate;
+         header.mKeyLength = (int)key.size();
+         header.mDataOffset = (int(sizeof(Header) + key.size()) + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+
+         written = out.write(&header, sizeof(Header)) && out.write(key.data(), key.size());
+         written = written && out.writeRepeatedByte(0, header.mDataOffset - sizeof(Header) - key.size());
+         for (int ch = 0; ch < numChannels && written; ++ch)
+            written = out.write(decoded->GetChannel(ch), numSamples * sizeof(float));
+         out.flush();
+         written = written && !out.getStatus().failed();
+      }
+   }
+   written = written && tempFile.overwriteTargetFileWithTemporary();
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   std::shared_ptr<Data> data = written ? LoadCacheFile(key) : nullptr;
+   if (data == nullptr)
+   {
+      //couldn't use the cache folder, but we can still share the data in memory
+      data = std::make_shared<Data>();
+      data->mNumChannels = numChannels;
+      data->mNumSamples = numSamples;
+      data->mSampleRate = sampleRate;
+      data->mHeapData.resize(size_t(numChannels) * numSamples);
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         data->mChannels[ch] = data->mHeapData.data() + size_t(ch) * numSamples;
+         BufferCopy(data->mChannels[ch], decoded->GetChannel(ch), numSamples);
+      }
+   }
+
+   mEntries[key] = data;
+   if (data->mMapping != nullptr)
+      KeepHeadWarm(data);
+
+   if (written)
+      TrimCacheFolder();
+
+   return data;
+}
+
+std::shared_ptr<SampleCache::Data> SampleCache::LoadCacheFile(const std::string& key)
+{
+   juce::File cacheFile(GetCacheFilePath(key));
+   if (!cacheFile.existsAsFile())
+      return nullptr;
+
+   auto mapping = std::make_unique<juce::MemoryMappedFile>(cacheFile, juce::MemoryMappedFile::readOnly);
+   if (mapping->getData() == nullptr || mapping->getSize() < sizeof(Header))
+      return nullptr;
+
+   Header header;
+   memcpy(&header, mapping->getData(), sizeof(Header));
+   const char* bytes = static_cast<const char*>(mapping->getData());
+   if (memcmp(header.mMagic, kMagic, sizeof(kMagic)) != 0 || header.mRev != kCacheFileRev ||
+       header.mNumChannels < 1 || header.mNumChannels > 2 || header.mNumSamples < 0 ||
+       header.mKeyLength != (int)key.size() || key.compare(0, key.size(), bytes + sizeof(Header), header.mKeyLength) != 0 ||
+       mapping->getSize() != size_t(header.mDataOffset) + size_t(header.mNumChannels) * header.mNumSamples * sizeof(float))
+   {
+      return nullptr; //stale, or from a different version
+   }
+
+   auto data = std::make_shared<Data>();
+   data->mNumChannels = header.mNumChannels;
+   data->mNumSamples = header.mNumSamples;
+   data->mSampleRate = header.mSampleRate;
+   float* samples = reinterpret_cast<float*>(static_cast<char*>(mapping->getData()) + header.mDataOffset);
+   for (int ch = 0; ch < header.mNumChannels; ++ch)
+      data->mChannels[ch] = samples + size_t(ch) * header.mNumSamples;
+   data->mMapping = std::move(mapping);
+   PrepareHead(*data, header.mSampleRate);
+
+   cacheFile.setLastAccessTime(juce::Time::getCurrentTime());
+   return data;
+}
+
+//static
+std::shared_ptr<const SampleCache::Data> SampleCache::MapFileRegion(const std::string& path, std::int64_t offset, int numChannels, int numSamples, int channelStride)
+{
+   if (numChannels < 1 || numChannels > 2 || numSamples <= 0)
+      return nullptr;
+
+   juce::int64 length = juce::int64(numChannels) * channelStride * sizeof(float);
+   auto mapping = std::make_unique<juce::MemoryMappedFile>(juce::File(path), juce::Range<juce::int64>(offset, offset + length), juce::MemoryMappedFile::readOnly);
+   if (mapping->getData() == nullptr || mapping->getRange().getEnd() < offset + length)
+      return nullptr;
+   //the mapping starts at a page boundary, which can be before the offset we asked for
+   juce::int64 startInMapping = offset - mapping->getRange().getStart();
+
+   auto data = std::make_shared<Data>();
+   data->mNumChannels = numChannels;
+   data->mNumSamples = numSamples;
+   float* samples = reinterpret_cast<float*>(static_cast<char*>(mapping->getData()) + startInMapping);
+   for (int ch = 0; ch < numChannels; ++ch)
+      data->mChannels[ch] = samples + size_t(ch) * channelStride;
+   data->mMapping = std::move(mapping);
+   PrepareHead(*data, gSampleRate);
+
+   SampleCache& cache = Get();
+   std::lock_guard<std::mutex> lock(cache.mMutex);
+   cache.KeepHeadWarm(data);
+   return data;
+}
+
+//static
+void SampleCache::PrepareHead(Data& data, int sampleRate)
+{
+   data.mHeadSamples = MIN(data.mNumSamples, int(juce::int64(UserPrefs.sample_attack_head_ms.Get()) * sampleRate / 1000));
+   TouchHead(data);
+}
+
+//static
+void SampleCache::TouchHead(const Data& data)
+{
+   //one read a page is enough for the os to bring the whole page in
+   volatile float sink = 0;
+   for (int ch = 0; ch < data.mNumChannels; ++ch)
+   {
+      for (int i = 0; i < data.mHeadSamples; i += kFloatsPerPage)
+         sink = sink + data.mChannels[ch][i];
+   }
+}
+
+void SampleCache::KeepHeadWarm(std::shared_ptr<const Data> data)
+{
+   if (data->mHeadSamples <= 0)
+      return;
+   mWarmHeads.push_back(std::move(data));
+   StartHeadWarmer();
+}
+
+std::shared_ptr<const OnsetIndex> SampleCache::GetOnsets(const std::shared_ptr<const Data>& data)
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   if (data->mOnsets == nullptr)
+      data->mOnsets = OnsetIndex::Analyze(data);
+   return data->mOnsets;
+}
+
+//head warmer thread
+void SampleCache::TouchHeads()
+{
+   std::vector<std::shared_ptr<const Data>> heads;
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mWarmHeads.erase(std::remove_if(mWarmHeads.begin(), mWarmHeads.end(), [](const std::weak_ptr<const Data>& head)
+                                      { return head.expired(); }),
+                       mWarmHeads.end());
+      for (auto it = mWarmHeads.rbegin(); it != mWarmHeads.rend(); ++it)
+      {
+         if (auto head = it->lock())
+            heads.push_back(std::move(head));
+      }
+   }
+
+   //the pages are touched outside the lock, a slow disk shouldn't hold up samples being read
+   juce::int64 budget = juce::int64(UserPrefs.sample_attack_head_budget_mb.Get()) * 1024 * 1024;
+   for (const auto& head : heads)
+   {
+      juce::int64 bytes = juce::int64(head->mNumChannels) * head->mHeadSamples * sizeof(float);
+      if (bytes > budget)
+         break;
+      budget -= bytes;
+      TouchHead(*head);
+   }
+}
+
+void SampleCache::TrimCacheFolder()
+{
+   //least recently used files go first. deleting a file that's still mapped either fails or leaves the mapping intact, so that's safe
+   juce::Array<juce::File> files = GetCacheFolder().findChildFiles(juce::File::findFiles, false, "*.samplecache");
+   std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+             { return a.getLastAccessTime() > b.getLastAccessTime(); });
+
+   juce::int64 totalSize = 0;
+   for (const auto& file : files)
+   {
+      totalSize += file.getSize();
+      if (totalSize > kMaxCacheFolderSize)
+         file.deleteFile();
+   }
+}
@@ -0,0 +1,100 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleCache.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ChannelBuffer;
+class OnsetIndex;
+
+namespace juce
+{
+   class MemoryMappedFile;
+}
+
+//decoded sample data, shared by every Sample that reads the same file (keyed by path, modification time and size).
+//the decoded floats are written out to "cache/samples" in the data folder and memory-mapped from there,
+//so reopening a set doesn't have to decode anything again. shared data is read-only, Sample copies it before editing.
+//the first "sample_attack_head_ms" of every mapped sample are read in when it's mapped and kept warm from a background thread,
+//so triggering a sample never has to wait for the disk, while the rest of it is left to the os to page in and out
+class SampleCache
+{
+public:
+   class Data
+   {
+   public:
+      ~Data();
+      int NumChannels() const { return mNumChannels; }
+      int NumSamples() const { return mNumSamples; }
+      int SampleRate() const { return mSampleRate; }
+      float* GetChannel(int channel) const { return mChannels[channel]; } //don't write to this
+
+   private:
+      friend class SampleCache;
+      int mNumChannels{ 0 };
+      int mNumSamples{ 0 };
+      int mSampleRate{ 0 };
+      float* mChannels[2]{};
+      std::unique_ptr<juce::MemoryMappedFile> mMapping;
+      std::vector<float> mHeapData; //if the cache file couldn't be written
+      int mHeadSamples{ 0 }; //how much of the start of mapped data to keep warm
+      mutable std::shared_ptr<OnsetIndex> mOnsets; //analyzed the first time it's asked for, with SampleCache's mutex held
+   };
+
+   static SampleCache& Get();
+
+   //returns nullptr if this file hasn't been decoded yet
+   std::shared_ptr<const Data> Find(const std::string& path, bool mono);
+   //hands over freshly decoded data, and returns the shared copy to use from now on
+   std::shared_ptr<const Data> Add(const std::string& path, bool mono, ChannelBuffer* decoded, int numSamples, int sampleRate);
+   //maps raw channels stored somewhere else (like a block in a save state), channelStride floats apart. not kept in the cache
+   static std::shared_ptr<const Data> MapFileRegion(const std::string& path, std::int64_t offset, int numChannels, int numSamples, int channelStride);
+   //the transients in this data, shared by everything using it. the analysis starts on the first call, check OnsetIndex::IsReady()
+   std::shared_ptr<const OnsetIndex> GetOnsets(const std::shared_ptr<const Data>& data);
+
+   //head warmer thread. touches the heads of everything mapped, newest first, until "sample_attack_head_budget_mb" is used up
+   void TouchHeads();
+
+private:
+   SampleCache() = default;
+   static std::string GetKey(const std::string& path, bool mono);
+   static std::string GetCacheFilePath(const std::string& key);
+   std::shared_ptr<Data> LoadCacheFile(const std::string& key);
+   void TrimCacheFolder();
+   static void PrepareHead(Data& data, int sampleRate);
+   static void TouchHead(const Data& data);
+   void KeepHeadWarm(std::shared_ptr<const Data> data); //with mMutex held
+
+   std::map<std::string, std::weak_ptr<const Data>> mEntries;
+   std::vector<std::weak_ptr<const Data>> mWarmHeads;
+   std::mutex mMutex;
+};
@@ -100,7 +100,7 @@ void SampleCanvas::Process(double time)
    int bufferSize = target->GetBuffer()->BufferSize();
    assert(bufferSize == gBufferSize);
 
-   gWorkChannelBuffer.Clear();
+   gWorkChannelBuffer->Clear();
 
    const std::vector<CanvasElement*>& elements = mCanvas->GetElements();
    for (int elemIdx = 0; elemIdx < elements.size(); ++elemIdx)
@@ -124,7 +124,7 @@ void SampleCanvas::Process(double time)
             for (int ch = 0; ch < target->GetBuffer()->NumActiveChannels(); ++ch)
             {
                int sampleChannel = MAX(ch, clip->NumChannels() - 1);
-               gWorkChannelBuffer.GetChannel(ch)[i] += GetInterpolatedSample(sampleIndex, clip->Data()->GetChannel(sampleChannel), clip->LengthInSamples()) * vol;
+               gWorkChannelBuffer->GetChannel(ch)[i] += GetInterpolatedSample(sampleIndex, clip->Data()->GetChannel(sampleChannel), clip->LengthInSamples()) * vol;
             }
          }
       }
@@ -133,8 +133,8 @@ void SampleCanvas::Process(double time)
    for (int ch = 0; ch < target->GetBuffer()->NumActiveChannels(); ++ch)
    {
       ChannelBuffer* out = GetTarget()->GetBuffer();
-      Add(out->GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), gBufferSize);
-      GetVizBuffer()->WriteChunk(gWorkChannelBuffer.GetChannel(ch), gBufferSize, ch);
+      Add(out->GetChannel(ch), gWorkChannelBuffer->GetChannel(ch), gBufferSize);
+      GetVizBuffer()->WriteChunk(gWorkChannelBuffer->GetChannel(ch), gBufferSize, ch);
    }
 }
 
@@ -82,11 +82,11 @@ void SampleCapturer::Process(double time)
    int bufferSize = GetBuffer()->BufferSize();
 
    ChannelBuffer* out = target->GetBuffer();
-   gWorkChannelBuffer.SetNumActiveChannels(GetBuffer()->NumActiveChannels());
+   gWorkChannelBuffer->SetNumActiveChannels(GetBuffer()->NumActiveChannels());
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
    {
       Add(out->GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
-      BufferCopy(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
+      BufferCopy(gWorkChannelBuffer->GetChannel(ch), GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
    }
 
    for (int i = 0; i < bufferSize; ++i)
@@ -139,7 +139,7 @@ void SampleCapturer::Process(double time)
             for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
             {
                out->GetChannel(ch)[i] += mSamples[sample].mBuffer.GetChannel(ch)[mSamples[sample].mPlaybackPos];
-               gWorkChannelBuffer.GetChannel(ch)[i] += mSamples[sample].mBuffer.GetChannel(ch)[mSamples[sample].mPlaybackPos];
+               gWorkChannelBuffer->GetChannel(ch)[i] += mSamples[sample].mBuffer.GetChannel(ch)[mSamples[sample].mPlaybackPos];
             }
             ++mSamples[sample].mPlaybackPos;
             if (mSamples[sample].mPlaybackPos >= mSamples[sample].mRecordingLength)
@@ -152,7 +152,7 @@ void SampleCapturer::Process(double time)
    }
 
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
-      GetVizBuffer()->WriteChunk(gWorkChannelBuffer.GetChannel(ch), GetBuffer()->BufferSize(), ch);
+      GetVizBuffer()->WriteChunk(gWorkChannelBuffer->GetChannel(ch), GetBuffer()->BufferSize(), ch);
 
    GetBuffer()->Reset();
 }
@@ -46,6 +46,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //records its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
@@ -0,0 +1,134 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleKernel.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BiquadFilter.h"
+
+//the per sample work of a simple effect, handed to EffectChain so that a row of them can share one loop over the buffer
+//instead of making a pass each (see IAudioEffect::BeginSampleKernel()). there are a few fixed shapes of kernel rather than
+//one per effect, so that EffectChain can fuse any two of them in a loop the compiler sees all the way through
+class SampleKernel
+{
+public:
+   enum class Type
+   {
+      kGain,
+      kBiquad,
+      kBitcrush
+   };
+
+   explicit SampleKernel(Type type)
+   : mType(type)
+   {}
+   virtual ~SampleKernel() {}
+
+   Type GetKernelType() const { return mType; }
+   //samples [start, start + length) of one channel, in place
+   virtual void Run(int channel, float* samples, int start, int length) = 0;
+
+private:
+   Type mType;
+};
+
+//every channel times the same gain a sample
+class GainKernel final : public SampleKernel
+{
+public:
+   GainKernel()
+   : SampleKernel(Type::kGain)
+   {}
+
+   void SetGains(const float* gains) { mGains = gains; }
+   float Tick(int channel, int i, float sample) { return sample * mGains[i]; }
+   void Run(int channel, float* samples, int start, int length) override
+   {
+      for (int i = start; i < start + length; ++i)
+         samples[i] = Tick(channel, i, samples[i]);
+   }
+
+private:
+   const float* mGains{ nullptr };
+};
+
+//a biquad for each channel
+class BiquadKernel final : public SampleKernel
+{
+public:
+   BiquadKernel()
+   : SampleKernel(Type::kBiquad)
+   {}
+
+   void SetFilters(BiquadFilter* filters) { mFilters = filters; }
+   float Tick(int channel, int i, float sample) { return mFilters[channel].Filter(sample); }
+   void Run(int channel, float* samples, int start, int length) override { mFilters[channel].Filter(samples + start, length); }
+
+private:
+   BiquadFilter* mFilters{ nullptr };
+};
+
+//holds each sample for a while, then quantizes it
+class BitcrushKernel final : public SampleKernel
+{
+public:
+   BitcrushKernel()
+   : SampleKernel(Type::kBitcrush)
+   {}
+
+   void Set(int* counters, float* held, int holdLength, float bitDepth)
+   {
+      mCounters = counters;
+      mHeld = held;
+      mHoldLength = holdLength;
+      mBitDepth = bitDepth;
+      mInvBitDepth = 1.f / bitDepth;
+   }
+   float Tick(int channel, int i, float sample)
+   {
+      if (mCounters[channel] < mHoldLength - 1)
+      {
+         ++mCounters[channel];
+      }
+      else
+      {
+         mHeld[channel] = sample;
+         mCounters[channel] = 0;
+      }
+      return ((int)(mHeld[channel] * mBitDepth)) * mInvBitDepth;
+   }
+   void Run(int channel, float* samples, int start, int length) override
+   {
+      for (int i = start; i < start + length; ++i)
+         samples[i] = Tick(channel, i, samples[i]);
+   }
+
+private:
+   int* mCounters{ nullptr };
+   float* mHeld{ nullptr };
+   int mHoldLength{ 1 };
+   float mBitDepth{ 1 };
+   float mInvBitDepth{ 1 };
+};
@@ -0,0 +1,351 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleLibrary.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SampleLibrary.h"
+#include "FileStream.h"
+#include "SynthGlobals.h"
+
+#include "juce_audio_formats/juce_audio_formats.h"
+
+namespace
+{
+   const int kIndexRev = 1;
+   const float kMaxThumbnailSeconds = 10 * 60; //longer files would take a while to read through, just skip their thumbnail
+
+   void ReadAudioInfo(juce::AudioFormatManager& formats, SampleLibrary::FileInfo& info)
+   {
+      std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(juce::File(info.mPath)));
+      if (reader == nullptr || reader->sampleRate <= 0)
+         return;
+
+      info.mHasAudioInfo = true;
+      info.mLengthSeconds = float(reader->lengthInSamples / reader->sampleRate);
+      info.mNumChannels = (int)reader->numChannels;
+      info.mSampleRate = (int)reader->sampleRate;
+      info.mThumbnail.fill(0);
+
+      if (info.mLengthSeconds > kMaxThumbnailSeconds || reader->lengthInSamples < SampleLibrary::kThumbnailSize)
+         return;
+
+      int numChannels = MIN((int)reader->numChannels, 2);
+      juce::Range<float> levels[2];
+      juce::int64 sliceLength = reader->lengthInSamples / SampleLibrary::kThumbnailSize;
+      for (int i = 0; i < SampleLibrary::kThumbnailSize; ++i)
+      {
+         reader->readMaxLevels(i * sliceLength, sliceLength, levels, numChannels);
+         float peak = 0;
+         for (int ch = 0; ch < numChannels; ++ch)
+            peak = MAX(peak, levels[ch].getLength() * .5f);
+         info.mThumbnail[i] = (std::uint8_t)ofClamp(peak * 255, 0, 255);
+      }
+   }
+}
+
+SampleLibrary& SampleLibrary::Get()
+{
+   static SampleLibrary sLibrary;
+   return sLibrary;
+}
+
+void SampleLibrary::StartIfNeeded()
+{
+   //nothing gets scanned until somebody actually browses
+   if (mScanThread.joinable() || mQuit)
+      return;
+
+   Load();
+   mCrawlRoot = juce::File(ofToSamplePath("")).getFullPathName().toStdString();
+   mScanQueue.push_back({ mCrawlRoot, false });
+   mScanThread = std::thread(&SampleLibrary::ScanThreadLoop, this);
+}
+
+void SampleLibrary::Shutdown()
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mQuit = true;
+   }
+   mWakeCondition.notify_all();
+   if (mScanThread.joinable())
+      mScanThread.join();
+   Save();
+}
+
+bool SampleLibrary::GetDirectory(const std::string& dirPath, std::vector<FileInfo>& contents, bool rescan /*= true*/)
+{
+   StartIfNeeded();
+   std::lock_guard<std::mutex> lock(mMutex);
+
+   if (rescan)
+   {
+      mScanQueue.push_front({ dirPath, true });
+      mWakeCondition.notify_all();
+   }
+
+   auto dir = mDirectories.find(dirPath);
+   if (dir == mDirectories.end())
+   {
+      contents.clear();
+      return false;
+   }
+   contents = dir->second.mContents;
+   return true;
+}
+
+void SampleLibrary::Search(const std::string& text, std::vector<FileInfo>& results, int maxResults)
+{
+   StartIfNeeded();
+   results.clear();
+   juce::String query(text);
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   for (const auto& dir : mDirectories)
+   {
+      for (const auto& info : dir.second.mContents)
+      {
+         if (info.mIsDirectory || !juce::File(info.mPath).getFileName().containsIgnoreCase(query))
+            continue;
+         results.push_back(info);
+         if ((int)results.size() >= maxResults)
+            return;
+      }
+   }
+}
+
+void SampleLibrary::ScanThreadLoop()
+{
+   for (;;)
+   {
+      std::pair<std::string, bool> next;
+      {
+         std::unique_lock<std::mutex> lock(mMutex);
+         mScanning = !mScanQueue.empty();
+         if (!mScanning && mUnsaved)
+         {
+            lock.unlock();
+            Save(); //caught up, good time to write the index out
+            continue;
+         }
+         mWakeCondition.wait(lock, [this]
+                             {
+                                return mQuit || !mScanQueue.empty();
+                             });
+         if (mQuit)
+            return;
+         next = mScanQueue.front();
+         mScanQueue.pop_front();
+         mScanning = true;
+
+         //the crawl only needs to look at each directory once. directories somebody is browsing get looked at every time they ask,
+         //but only once per request, even if they asked several times while waiting
+         if (!next.second && mScannedThisSession.count(next.first) > 0)
+            continue;
+         for (auto it = mScanQueue.begin(); it != mScanQueue.end();)
+         {
+            if (it->first == next.first)
+               it = mScanQueue.erase(it);
+            else
+               ++it;
+         }
+      }
+
+      ScanDirectory(next.first, next.second);
+   }
+}
+
+void SampleLibrary::ScanDirectory(const std::string& dirPath, bool requested)
+{
+   juce::File dir(dirPath);
+   if (!dir.isDirectory())
+      return;
+
+   double modificationTime = (double)dir.getLastModificationTime().toMilliseconds();
+
+   std::map<std::string, FileInfo> known;
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mScannedThisSession.insert(dirPath);
+      auto existing = mDirectories.find(dirPath);
+      if (existing != mDirectories.end())
+      {
+         //nothing was added or removed, and this is just the crawl, so there's no need to hit the disk for anything else
+         if (!requested && existing->second.mModificationTime == modificationTime)
+         {
+            for (const auto& info : existing->second.mContents)
+            {
+               if (info.mIsDirectory && info.mPath.rfind(mCrawlRoot, 0) == 0)
+                  mScanQueue.push_back({ info.mPath, false });
+            }
+            return;
+         }
+
+         for (const auto& info : existing->second.mContents)
+            known[info.mPath] = info;
+      }
+   }
+
+   juce::AudioFormatManager formats;
+   formats.registerBasicFormats();
+   juce::StringArray wildcards;
+   wildcards.addTokens(formats.getWildcardForAllFormats(), ";,", "\"'");
+   wildcards.trim();
+   wildcards.removeEmptyStrings();
+
+   Directory scanned;
+   scanned.mModificationTime = modificationTime;
+   bool changed = known.empty();
+   for (const auto& entry : juce::RangedDirectoryIterator(dir, false, "*", juce::File::findFilesAndDirectories | juce::File::ignoreHiddenFiles))
+   {
+      if (mQuit)
+         return;
+
+      const juce::File& file = entry.getFile();
+      FileInfo info;
+      info.mPath = file.getFullPathName().toStdString();
+      info.mIsDirectory = entry.isDirectory();
+      info.mModificationTime = (double)entry.getModificationTime().toMilliseconds();
+
+      if (!info.mIsDirectory)
+      {
+         bool isAudio = false;
+         for (const auto& w : wildcards)
+         {
+            if (file.getFileName().matchesWildcard(w, true))
+            {
+               isAudio = true;
+               break;
+            }
+         }
+         if (!isAudio)
+            continue;
+      }
+
+      auto previous = known.find(info.mPath);
+      if (previous != known.end() && previous->second.mModificationTime == info.mModificationTime && previous->second.mIsDirectory == info.mIsDirectory)
+      {
+         info = previous->second;
+         known.erase(previous);
+      }
+      else
+      {
+         if (!info.mIsDirectory)
+            ReadAudioInfo(formats, info);
+         changed = true;
+      }
+
+      scanned.mContents.push_back(info);
+   }
+   changed = changed || !known.empty(); //something was deleted
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   for (const auto& info : scanned.mContents)
+   {
+      if (info.mIsDirectory && info.mPath.rfind(mCrawlRoot, 0) == 0)
+         mScanQueue.push_back({ info.mPath, false });
+   }
+   mDirectories[dirPath] = std::move(scanned);
+   if (changed)
+   {
+      mUnsaved = true;
+      ++mRevision;
+   }
+}
+
+std::string SampleLibrary::GetIndexPath()
+{
+   return ofToDataPath("internal/sample_library_index");
+}
+
+void SampleLibrary::Load()
+{
+   if (!juce::File(GetIndexPath()).existsAsFile())
+      return;
+
+   FileStreamIn in(GetIndexPath());
+   int rev;
+   in >> rev;
+   if (rev != kIndexRev)
+      return; //just rebuild it
+
+   int numDirectories;
+   in >> numDirectories;
+   for (int i = 0; i < numDirectories && !in.Eof(); ++i)
+   {
+      std::string path;
+      Directory dir;
+      int numFiles;
+      in >> path;
+      in >> dir.mModificationTime;
+      in >> numFiles;
+      dir.mContents.resize(numFiles);
+      for (auto& info : dir.mContents)
+      {
+         in >> info.mPath;
+         in >> info.mIsDirectory;
+         in >> info.mModificationTime;
+         in >> info.mHasAudioInfo;
+         in >> info.mLengthSeconds;
+         in >> info.mNumChannels;
+         in >> info.mSampleRate;
+         in.ReadGeneric(info.mThumbnail.data(), kThumbnailSize);
+      }
+      mDirectories[path] = std::move(dir);
+   }
+}
+
+void SampleLibrary::Save()
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   if (!mUnsaved)
+      return;
+
+   //write to a temp file first, so a crash mid-save doesn't cost the whole index
+   std::string tmpPath = GetIndexPath() + ".tmp";
+   {
+      FileStreamOut out(tmpPath);
+      out << kIndexRev;
+      out << (int)mDirectories.size();
+      for (const auto& dir : mDirectories)
+      {
+         out << dir.first;
+         out << dir.second.mModificationTime;
+         out << (int)dir.second.mContents.size();
+         for (const auto& info : dir.second.mContents)
+         {
+            out << info.mPath;
+            out << info.mIsDirectory;
+            out << info.mModificationTime;
+            out << info.mHasAudioInfo;
+            out << info.mLengthSeconds;
+            out << info.mNumChannels;
+            out << info.mSampleRate;
+            out.WriteGeneric(info.mThumbnail.data(), kThumbnailSize);
+         }
+      }
+   }
+   juce::File(tmpPath).moveFileTo(juce::File(GetIndexPath()));
+   mUnsaved = false;
+}
@@ -0,0 +1,97 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleLibrary.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+//an index of the sample directories that have been browsed, and of everything under the sample path, kept in data/internal/.
+//a background thread lists directories and reads each new or modified file's length, format and a little peak thumbnail,
+//so browsing and searching never have to wait on the filesystem (which can be very slow on network shares)
+class SampleLibrary
+{
+public:
+   static constexpr int kThumbnailSize = 32;
+
+   struct FileInfo
+   {
+      std::string mPath;
+      bool mIsDirectory{ false };
+      double mModificationTime{ 0 }; //ms since epoch
+      bool mHasAudioInfo{ false };
+      float mLengthSeconds{ 0 };
+      int mNumChannels{ 0 };
+      int mSampleRate{ 0 };
+      std::array<std::uint8_t, kThumbnailSize> mThumbnail{}; //peak of each slice of the file, scaled to 0-255
+   };
+
+   static SampleLibrary& Get();
+
+   //whatever is known about a directory without touching the disk, and optionally queues it to be rescanned ahead of everything else.
+   //returns false if it hasn't been scanned yet
+   bool GetDirectory(const std::string& dirPath, std::vector<FileInfo>& contents, bool rescan = true);
+   void Search(const std::string& text, std::vector<FileInfo>& results, int maxResults); //files whose names contain text
+   bool IsScanning() const { return mScanning; }
+   int GetRevision() const { return mRevision; } //changes whenever a scan finds something new
+   void Shutdown();
+
+private:
+   struct Directory
+   {
+      double mModificationTime{ 0 };
+      std::vector<FileInfo> mContents;
+   };
+
+   SampleLibrary() = default;
+   void StartIfNeeded();
+   void ScanThreadLoop();
+   void ScanDirectory(const std::string& dirPath, bool requested);
+   void Load();
+   void Save();
+   static std::string GetIndexPath();
+
+   std::map<std::string, Directory> mDirectories;
+   std::deque<std::pair<std::string, bool>> mScanQueue; //path, and whether somebody is waiting to look at it
+   std::set<std::string> mScannedThisSession;
+   std::string mCrawlRoot;
+   bool mUnsaved{ false };
+   std::thread mScanThread;
+   std::atomic<bool> mQuit{ false };
+   std::atomic<bool> mScanning{ false };
+   std::atomic<int> mRevision{ 0 };
+   mutable std::mutex mMutex;
+   std::condition_variable mWakeCondition;
+};
@@ -0,0 +1,168 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleLoader.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SampleLoader.h"
+#include "Sample.h"
+#include "SynthGlobals.h"
+
+#include "juce_core/juce_core.h"
+
+#include <atomic>
+
+//shared between a job and the loader, so a load is called off through this rather than by the job's address, which the pool may have reused
+struct SampleLoadState
+{
+   std::atomic<bool> mCancelled{ false };
+   std::mutex mRunning; //held by the job for as long as it touches the sample
+};
+
+class SampleLoadJob : public juce::ThreadPoolJob
+{
+public:
+   SampleLoadJob(Sample* sample, std::shared_ptr<SampleLoadState> state)
+   : juce::ThreadPoolJob("sample load")
+   , mSample(sample)
+   , mState(std::move(state))
+   {
+   }
+
+   JobStatus runJob() override
+   {
+      std::lock_guard<std::mutex> running(mState->mRunning);
+      while (!shouldExit() && !mState->mCancelled)
+      {
+         if (mSample->ReadNextChunk())
+         {
+            SampleLoader::Get().OnJobFinished(mSample, mState);
+            return jobHasFinished;
+         }
+      }
+      return jobHasFinished; //cancelled, and the sample may be gone already if it never started
+   }
+
+private:
+   Sample* mSample;
+   std::shared_ptr<SampleLoadState> mState;
+};
+
+SampleLoader& SampleLoader::Get()
+{
+   static SampleLoader* sLoader = new SampleLoader(); //never destroyed, samples can outlive static destruction
+   return *sLoader;
+}
+
+void SampleLoader::Load(Sample* sample)
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+
+   assert(mJobs.find(sample) == mJobs.end()); //Sample cancels its previous load before starting a new one
+
+   auto state = std::make_shared<SampleLoadState>();
+   mJobs[sample] = state;
+   ++mNumQueued;
+   GetPool().addJob(new SampleLoadJob(sample, state), true);
+}
+
+void SampleLoader::AddJob(juce::ThreadPoolJob* job)
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   GetPool().addJob(job, true);
+}
+
+juce::ThreadPool& SampleLoader::GetPool()
+{
+   if (mPool == nullptr)
+      mPool = std::make_unique<juce::ThreadPool>(MAX(1, juce::SystemStats::getNumCpus() - 1));
+   return *mPool;
+}
+
+void SampleLoader::Cancel(Sample* sample)
+{
+   std::shared_ptr<SampleLoadState> state;
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto it = mJobs.find(sample);
+      if (it == mJobs.end())
+         return;
+      state = std::move(it->second);
+      mJobs.erase(it);
+      --mNumQueued;
+      if (mJobs.empty())
+         mNumQueued = mNumLoaded = 0;
+   }
+
+   //a job that hasn't started will see the flag and leave the sample alone. one that's running stops after its current chunk
+   state->mCancelled = true;
+   std::lock_guard<std::mutex> waitForJob(state->mRunning);
+}
+
+void SampleLoader::OnJobFinished(Sample* sample, const std::shared_ptr<SampleLoadState>& state)
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   auto it = mJobs.find(sample);
+   if (it == mJobs.end() || it->second != state)
+      return; //cancelled just as it finished
+
+   mJobs.erase(it);
+   ++mNumLoaded;
+   if (mJobs.empty())
+      mNumQueued = mNumLoaded = 0;
+}
+
+void SampleLoader::Shutdown()
+{
+   if (mPool != nullptr)
+      mPool->removeAllJobs(true, -1);
+   mPool.reset();
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   mJobs.clear();
+   mNumQueued = mNumLoaded = 0;
+}
+
+bool SampleLoader::IsBusy() const
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   return !mJobs.empty();
+}
+
+float SampleLoader::GetProgress() const
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   return mNumQueued > 0 ? float(mNumLoaded) / mNumQueued : 1;
+}
+
+int SampleLoader::GetNumLoaded() const
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   return mNumLoaded;
+}
+
+int SampleLoader::GetNumQueued() const
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   return mNumQueued;
+}
@@ -0,0 +1,79 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleLoader.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+class Sample;
+class SampleLoadJob;
+struct SampleLoadState;
+
+namespace juce
+{
+   class ThreadPool;
+   class ThreadPoolJob;
+}
+
+//decodes samples on a pool of background threads, so a set full of samples doesn't have to load them one after another.
+//a Sample that's being loaded already has its full length, and plays silence until its data arrives.
+class SampleLoader
+{
+public:
+   static SampleLoader& Get();
+
+   //while a batch is open (loading a layout or a save state), sample reads that would block get handed to the pool instead.
+   //main thread only
+   void BeginBatch() { ++mBatchDepth; }
+   void EndBatch() { --mBatchDepth; }
+   bool IsBatching() const { return mBatchDepth > 0; }
+
+   void Load(Sample* sample);
+   void Cancel(Sample* sample); //waits for the sample's job to stop, if it's already running. don't hold the sample's data mutex, the job may be waiting on it
+   //other background work on sample data, like OnsetIndex's analysis. not counted by IsBusy(), the pool deletes the job when it's done
+   void AddJob(juce::ThreadPoolJob* job);
+   void Shutdown();
+
+   bool IsBusy() const;
+   float GetProgress() const;
+   int GetNumLoaded() const;
+   int GetNumQueued() const;
+
+private:
+   friend class SampleLoadJob;
+   SampleLoader() = default;
+   void OnJobFinished(Sample* sample, const std::shared_ptr<SampleLoadState>& state);
+   juce::ThreadPool& GetPool(); //with mMutex held
+
+   std::unique_ptr<juce::ThreadPool> mPool;
+   std::map<Sample*, std::shared_ptr<SampleLoadState>> mJobs; //the pool owns the jobs, we only keep what's needed to call them off
+   int mNumQueued{ 0 }; //since the loader was last idle
+   int mNumLoaded{ 0 };
+   int mBatchDepth{ 0 };
+   mutable std::mutex mMutex;
+};
@@ -34,6 +34,7 @@
 #include "PatchCableSource.h"
 #include "Scale.h"
 #include "UIControlMacros.h"
+#include "OnsetIndex.h"
 #include "UserPrefs.h"
 
 #include "juce_gui_basics/juce_gui_basics.h"
@@ -66,6 +67,10 @@ void SamplePlayer::CreateUIControls()
    BUTTON(mTrimToZoomButton, "trim");
    UIBLOCK_SHIFTRIGHT();
    BUTTON(mDownloadYoutubeButton, "youtube");
+   UIBLOCK_SHIFTRIGHT();
+   DROPDOWN(mResampleQualitySelector, "quality", (int*)(&mResampleQuality), 50);
+   UIBLOCK_SHIFTRIGHT();
+   DROPDOWN(mStretchModeSelector, "stretch", (int*)(&mStretchMode), 60);
    UIBLOCK_NEWLINE();
    TEXTENTRY(mDownloadYoutubeSearch, "yt:", 30, mYoutubeSearch);
    UIBLOCK_NEWLINE();
@@ -118,6 +123,9 @@ void SamplePlayer::CreateUIControls()
    }
    ENDUIBLOCK0();
 
+   mAutoSliceTransientsButton = new ClickButton(this, "transients", -1, -1);
+   mAutoSliceTransientsButton->PositionTo(mShowGridCheckbox, kAnchor_Right);
+
    mPlayHoveredClipButton = new ClickButton(this, "playhovered", -1, -1, ButtonDisplayStyle::kPlay);
    mGrabHoveredClipButton = new ClickButton(this, "grabhovered", -1, -1, ButtonDisplayStyle::kGrabSample);
    mPlayHoveredClipButton->SetShowing(false);
@@ -126,6 +134,15 @@ void SamplePlayer::CreateUIControls()
    for (int i = 0; i < (int)mSampleCuePoints.size(); ++i)
       mCuePointSelector->AddLabel(ofToString(i).c_str(), i);
 
+   mResampleQualitySelector->AddLabel("linear", (int)ResampleQuality::Linear);
+   mResampleQualitySelector->AddLabel("cubic", (int)ResampleQuality::Cubic);
+   mResampleQualitySelector->AddLabel("sinc", (int)ResampleQuality::Sinc);
+
+   //speed changes pitch when resampling, the other two keep it. beats suits drums, tonal suits sustained material
+   mStretchModeSelector->AddLabel("resample", (int)StretchMode::Off);
+   mStretchModeSelector->AddLabel("beats", (int)StretchMode::Beats);
+   mStretchModeSelector->AddLabel("tonal", (int)StretchMode::Tonal);
+
    AddChild(&mRecordGate);
    mRecordGate.SetPosition(mRecordAsClipsCheckbox->GetRect().getMaxX() + 3, -1);
    mRecordGate.SetEnabled(mRecordAsClips);
@@ -155,6 +172,16 @@ void SamplePlayer::Poll()
 {
    IDrawableModule::Poll();
 
+   if (mWantTransientSlices && mSample != nullptr)
+   {
+      std::shared_ptr<const OnsetIndex> onsets = mSample->GetOnsets();
+      if (onsets != nullptr && onsets->IsReady())
+      {
+         AutoSliceAtTransients(*onsets);
+         mWantTransientSlices = false;
+      }
+   }
+
    const juce::String& clipboard = TheSynth->GetTextFromClipboard();
    if (clipboard.contains("youtube"))
    {
@@ -346,22 +373,23 @@ void SamplePlayer::Process(double time)
          mPlaySpeed = ofLerp(mPlaySpeed, mSpeed * mCuePointSpeed, kBlendSpeed);
       }
       mSample->SetRate(mPlaySpeed);
+      mSample->SetResampleQuality(mResampleQuality);
 
-      gWorkChannelBuffer.SetNumActiveChannels(mSample->NumChannels());
+      gWorkChannelBuffer->SetNumActiveChannels(mSample->NumChannels());
 
       if (mPlay)
       {
-         if (mSample->ConsumeData(time, &gWorkChannelBuffer, bufferSize, true))
+         if (mSample->ConsumeData(time, gWorkChannelBuffer, bufferSize, true))
          {
-            for (int ch = 0; ch < gWorkChannelBuffer.NumActiveChannels(); ++ch)
+            for (int ch = 0; ch < gWorkChannelBuffer->NumActiveChannels(); ++ch)
             {
                for (int i = 0; i < bufferSize; ++i)
-                  gWorkChannelBuffer.GetChannel(ch)[i] *= volSq * mAdsr.Value(time + i * gInvSampleRateMs);
+                  gWorkChannelBuffer->GetChannel(ch)[i] *= volSq * mAdsr.Value(time + i * gInvSampleRateMs);
             }
          }
          else
          {
-            gWorkChannelBuffer.Clear();
+            gWorkChannelBuffer->Clear();
             mPlay = false;
             mSample->SetPlayPosition(0);
             mAdsr.Stop(time);
@@ -369,16 +397,16 @@ void SamplePlayer::Process(double time)
       }
       else
       {
-         gWorkChannelBuffer.Clear();
+         gWorkChannelBuffer->Clear();
       }
 
-      for (int ch = 0; ch < gWorkChannelBuffer.NumActiveChannels(); ++ch)
+      for (int ch = 0; ch < gWorkChannelBuffer->NumActiveChannels(); ++ch)
       {
          for (int i = 0; i < bufferSize; ++i)
-            gWorkChannelBuffer.GetChannel(ch)[i] = mSwitchAndRamp.Process(ch, gWorkChannelBuffer.GetChannel(ch)[i]);
+            gWorkChannelBuffer->GetChannel(ch)[i] = mSwitchAndRamp.Process(ch, gWorkChannelBuffer->GetChannel(ch)[i]);
 
-         Add(target->GetBuffer()->GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), bufferSize);
-         GetVizBuffer()->WriteChunk(gWorkChannelBuffer.GetChannel(ch), bufferSize, ch);
+         Add(target->GetBuffer()->GetChannel(ch), gWorkChannelBuffer->GetChannel(ch), bufferSize);
+         GetVizBuffer()->WriteChunk(gWorkChannelBuffer->GetChannel(ch), bufferSize, ch);
       }
    }
 
@@ -435,10 +463,37 @@ void SamplePlayer::DropdownClicked(DropdownList* list)
 {
 }
 
+size_t SamplePlayer::GetMemoryUsage() const
+{
+   return mSample != nullptr ? mSample->GetMemoryUsage() : 0;
+}
+
+bool SamplePlayer::CanHibernate() const
+{
+   return mSample != nullptr && mSample->CanHibernate() && !mRecord;
+}
+
+void SamplePlayer::Hibernate()
+{
+   if (mSample != nullptr)
+      mSample->Hibernate();
+}
+
+void SamplePlayer::Wake()
+{
+   if (mSample != nullptr)
+   {
+      mSample->Wake();
+      mSample->Reset();
+   }
+}
+
 void SamplePlayer::DropdownUpdated(DropdownList* list, int oldVal, double time)
 {
    if (list == mCuePointSelector)
       UpdateActiveCuePoint();
+   if (list == mStretchModeSelector && mSample != nullptr)
+      mSample->SetStretchMode(mStretchMode);
 }
 
 void SamplePlayer::RadioButtonUpdated(RadioButton* radio, int oldVal, double time)
@@ -475,10 +530,32 @@ void SamplePlayer::AutoSlice(int slices)
    }
 }
 
+//a cue point per transient, each running up to the next one
+void SamplePlayer::AutoSliceAtTransients(const OnsetIndex& onsets)
+{
+   const std::vector<int>& positions = onsets.GetOnsets();
+   float sampleRate = gSampleRate * mSample->GetSampleRateRatio();
+   for (int i = 0; i < (int)mSampleCuePoints.size(); ++i)
+   {
+      if (i < (int)positions.size())
+      {
+         int end = i + 1 < (int)positions.size() ? positions[i + 1] : mSample->LengthInSamples();
+         mSampleCuePoints[i].startSeconds = positions[i] / sampleRate;
+         mSampleCuePoints[i].lengthSeconds = (end - positions[i]) / sampleRate;
+         mSampleCuePoints[i].speed = 1;
+      }
+      else
+      {
+         mSampleCuePoints[i].startSeconds = 0;
+         mSampleCuePoints[i].lengthSeconds = 0;
+      }
+   }
+}
+
 void SamplePlayer::FilesDropped(std::vector<std::string> files, int x, int y)
 {
    Sample* sample = new Sample();
-   sample->Read(files[0].c_str());
+   sample->Read(files[0].c_str(), false, Sample::ReadType::Stream);
    UpdateSample(sample, true);
 }
 
@@ -504,6 +581,7 @@ void SamplePlayer::UpdateSample(Sample* sample, bool ownsSample)
    sample->SetPlayPosition(0);
    sample->SetLooping(mLoop);
    sample->SetRate(mSpeed);
+   sample->SetStretchMode(mStretchMode);
    mSample = sample;
    mPlay = false;
    mOwnsSample = ownsSample;
@@ -512,6 +590,7 @@ void SamplePlayer::UpdateSample(Sample* sample, bool ownsSample)
    mRecordingLength = 0;
 
    mErrorString = "";
+   mWantTransientSlices = false;
 
    if (ownedOldSample)
       delete oldSamplePtr;
@@ -558,7 +637,7 @@ void SamplePlayer::ButtonClicked(ClickButton* button, double time)
       LoadFile();
    if (button == mSaveFileButton)
       SaveFile();
-   if (button == mTrimToZoomButton && mSample != nullptr)
+   if (button == mTrimToZoomButton && mSample != nullptr && !mSample->IsStreaming())
    {
       for (auto& cuePoint : mSampleCuePoints)
          cuePoint.startSeconds = MAX(0, cuePoint.startSeconds - GetZoomStartSeconds());
@@ -572,6 +651,7 @@ void SamplePlayer::ButtonClicked(ClickButton* button, double time)
          for (int i = 0; i < sample->LengthInSamples(); ++i)
             sampleData[i] = mSample->Data()->GetChannel(ch)[i + GetZoomStartSample()];
       }
+      sample->Data()->MarkPeaksDirty();
       sample->SetName(mSample->Name());
       UpdateSample(sample, true);
    }
@@ -601,6 +681,8 @@ void SamplePlayer::ButtonClicked(ClickButton* button, double time)
       AutoSlice(16);
    if (button == mAutoSlice32)
       AutoSlice(32);
+   if (button == mAutoSliceTransientsButton && mSample != nullptr)
+      mWantTransientSlices = true; //the analysis might still be running, Poll() slices once it's done
 
    if (button == mPlayHoveredClipButton)
       PlayCuePoint(time, mHoveredCuePointIndex, 127, 1, 0);
@@ -757,7 +839,7 @@ void SamplePlayer::LoadFile()
 
       Sample* sample = new Sample();
       if (file.existsAsFile())
-         sample->Read(file.getFullPathName().toStdString().c_str());
+         sample->Read(file.getFullPathName().toStdString().c_str(), false, Sample::ReadType::Stream);
       UpdateSample(sample, true);
    }
 }
@@ -769,7 +851,7 @@ void SamplePlayer::SaveFile()
    if (chooser.browseForFileToSave(true))
    {
       auto file = chooser.getResult();
-      Sample::WriteDataToFile(file.getFullPathName().toStdString().c_str(), mSample->Data(), mSample->LengthInSamples());
+      Sample::WriteDataToFile(file.getFullPathName().toStdString().c_str(), mSample->Data(), mSample->Data()->BufferSize());
    }
 }
 
@@ -780,6 +862,7 @@ void SamplePlayer::FillData(std::vector<float> data)
    float* sampleData = sample->Data()->GetChannel(0);
    for (size_t i = 0; i < data.size(); ++i)
       sampleData[i] = data[i];
+   sample->Data()->MarkPeaksDirty();
    UpdateSample(sample, true);
 }
 
@@ -964,6 +1047,8 @@ void SamplePlayer::DrawModule()
    mStopButton->Draw();
    mTrimToZoomButton->Draw();
    mDownloadYoutubeButton->Draw();
+   mResampleQualitySelector->Draw();
+   mStretchModeSelector->Draw();
    mDownloadYoutubeSearch->Draw();
    mLoadFileButton->Draw();
    mSaveFileButton->Draw();
@@ -981,6 +1066,7 @@ void SamplePlayer::DrawModule()
    mAutoSlice8->Draw();
    mAutoSlice16->Draw();
    mAutoSlice32->Draw();
+   mAutoSliceTransientsButton->Draw();
    mRecordingAppendModeCheckbox->Draw();
    mRecordAsClipsCheckbox->Draw();
    mRecordGate.Draw();
@@ -1069,14 +1155,32 @@ void SamplePlayer::DrawModule()
       if (mIsLoadingSample && !mSample->IsSampleLoading())
       {
          mIsLoadingSample = false;
-         mDrawBuffer.Resize(mSample->LengthInSamples());
+         mDrawBuffer.Resize(mSample->Data()->BufferSize());
          mDrawBuffer.CopyFrom(mSample->Data());
       }
 
       int playPosition = mSample->GetPlayPosition();
       if (mAdsr.Value(gTime) == 0)
          playPosition = -1;
-      DrawAudioBuffer(sampleWidth, mHeight - 65, &mDrawBuffer, GetZoomStartSample(), GetZoomEndSample(), playPosition);
+      if (mSample->IsStreaming())
+      {
+         //only the head is in memory, so there's no waveform to show
+         DrawAudioBuffer(sampleWidth, mHeight - 65, (const float*)nullptr, GetZoomStartSample(), GetZoomEndSample(), playPosition);
+         ofPushStyle();
+         ofSetColor(40, 40, 40);
+         DrawTextNormal("streaming from disk", 5, mHeight - 70, 10);
+         if (playPosition >= 0)
+         {
+            ofSetColor(0, 255, 0);
+            float x = ofMap(playPosition, GetZoomStartSample(), GetZoomEndSample(), 0, sampleWidth, true);
+            ofLine(x, 0, x, mHeight - 65);
+         }
+         ofPopStyle();
+      }
+      else
+      {
+         DrawAudioBuffer(sampleWidth, mHeight - 65, &mDrawBuffer, GetZoomStartSample(), GetZoomEndSample(), playPosition);
+      }
 
       ofPushStyle();
       ofFill();
@@ -1405,6 +1509,11 @@ void SamplePlayer::SetUpFromSaveData()
 
 void SamplePlayer::SaveState(FileStreamOut& out)
 {
+   //the data has to be in place to be written out, so don't leave it to load in the background
+   if (IsHibernating() && mSample != nullptr)
+      mSample->Wake(Sample::ReadType::Sync);
+   WakeModule();
+
    out << GetModuleSaveStateRev();
 
    IDrawableModule::SaveState(out);
@@ -1426,6 +1535,8 @@ void SamplePlayer::SaveState(FileStreamOut& out)
 
 void SamplePlayer::LoadState(FileStreamIn& in, int rev)
 {
+   WakeModule();
+
    IDrawableModule::LoadState(in, rev);
 
    if (ModularSynth::sLoadingFileSaveStateRev < 423)
@@ -38,12 +38,15 @@
 #include "TextEntry.h"
 #include "RadioButton.h"
 #include "GateEffect.h"
+#include "Resampler.h"
+#include "TimeStretcher.h"
 #include "IPulseReceiver.h"
 #include "SwitchAndRamp.h"
 
 #include "juce_osc/juce_osc.h"
 
 class Sample;
+class OnsetIndex;
 
 class SamplePlayer : public IAudioProcessor, public IDrawableModule, public INoteReceiver, public IFloatSliderListener, public IIntSliderListener, public IDropdownListener, public IButtonListener, public IRadioButtonListener, public ITextEntryListener, public IPulseReceiver, private juce::OSCReceiver, private juce::OSCReceiver::Listener<juce::OSCReceiver::RealtimeCallback>
 {
@@ -65,6 +68,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //can record its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    void FilesDropped(std::vector<std::string> files, int x, int y) override;
@@ -104,6 +108,8 @@ public:
    std::vector<IUIControl*> ControlsToIgnoreInSaveState() const override;
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override;
+   bool CanHibernate() const override;
 
 private:
    void UpdateSample(Sample* sample, bool ownsSample);
@@ -125,9 +131,12 @@ private:
    void PlayCuePoint(double time, int index, int velocity, float speedMult, float startOffsetSeconds);
    void RunProcess(const juce::StringArray& args);
    void AutoSlice(int slices);
+   void AutoSliceAtTransients(const OnsetIndex& onsets);
    void StopRecording();
 
    //IDrawableModule
+   void Hibernate() override;
+   void Wake() override;
    void DrawModule() override;
    void OnClicked(float x, float y, bool right) override;
    bool MouseMoved(float x, float y) override;
@@ -162,6 +171,10 @@ private:
    float mZoomLevel{ 1 };
    float mZoomOffset{ 0 };
    ClickButton* mTrimToZoomButton{ nullptr };
+   ResampleQuality mResampleQuality{ ResampleQuality::Linear };
+   DropdownList* mResampleQualitySelector{ nullptr };
+   StretchMode mStretchMode{ StretchMode::Off };
+   DropdownList* mStretchModeSelector{ nullptr };
 
    bool mOscWheelGrabbed{ false };
    float mOscWheelPos{ 0 };
@@ -199,6 +212,8 @@ private:
    ClickButton* mAutoSlice8{ nullptr };
    ClickButton* mAutoSlice16{ nullptr };
    ClickButton* mAutoSlice32{ nullptr };
+   ClickButton* mAutoSliceTransientsButton{ nullptr };
+   bool mWantTransientSlices{ false }; //waiting for the sample's onset analysis
    ClickButton* mPlayHoveredClipButton{ nullptr };
    ClickButton* mGrabHoveredClipButton{ nullptr };
 
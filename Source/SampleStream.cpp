@@ -0,0 +1,194 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleStream.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SampleStream.h"
+#include "SynthGlobals.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "juce_audio_formats/juce_audio_formats.h"
+
+//one thread services every open stream, it only runs while there are streams open
+class SampleStreamReader
+{
+public:
+   static SampleStreamReader& Get()
+   {
+      static SampleStreamReader* sReader = new SampleStreamReader(); //never destroyed, streams can outlive static destruction
+      return *sReader;
+   }
+
+   void Register(SampleStream* stream)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStreams.push_back(stream);
+      if (!mThread.joinable())
+         mThread = std::thread(&SampleStreamReader::ThreadLoop, this, ++mGeneration);
+   }
+
+   void Unregister(SampleStream* stream)
+   {
+      std::thread finishedThread;
+      {
+         std::lock_guard<std::mutex> lock(mMutex); //also waits for any Fill() of this stream to finish
+         RemoveFromVector(stream, mStreams);
+         if (mStreams.empty())
+         {
+            ++mGeneration; //the thread being stopped quits even if Register() starts another before the join below
+            finishedThread = std::move(mThread);
+         }
+      }
+      if (finishedThread.joinable())
+         finishedThread.join();
+   }
+
+private:
+   void ThreadLoop(uint64_t generation)
+   {
+      while (true)
+      {
+         bool didWork = false;
+         {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mGeneration != generation)
+               return;
+            for (auto* stream : mStreams)
+               didWork |= stream->Fill();
+         }
+
+         if (!didWork)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+   }
+
+   std::mutex mMutex;
+   std::vector<SampleStream*> mStreams;
+   std::thread mThread;
+   uint64_t mGeneration{ 0 }; //which thread is meant to be running, any other quits
+};
+
+SampleStream::SampleStream(std::unique_ptr<juce::AudioFormatReader> reader, int64_t startOffset, int numChannels)
+: mReader(std::move(reader))
+, mStartOffset(startOffset)
+{
+   mLength = mReader->lengthInSamples;
+   mRingLength = (int)MIN(int64_t(mReader->sampleRate * kRingSeconds), mLength - startOffset + kChunkSize);
+   mRing.Resize(mRingLength);
+   mRing.SetNumActiveChannels(numChannels);
+   mReadBuffer = std::make_unique<juce::AudioSampleBuffer>((int)mReader->numChannels, kChunkSize);
+
+   mWindowStart = startOffset;
+   mWindowEnd = startOffset;
+   mReadLow = startOffset;
+
+   SampleStreamReader::Get().Register(this);
+}
+
+SampleStream::~SampleStream()
+{
+   SampleStreamReader::Get().Unregister(this);
+}
+
+bool SampleStream::Acquire(int64_t start, int64_t end)
+{
+   start = MAX(start, mStartOffset);
+   end = MIN(end, mLength - 1);
+
+   mReadLow = start;
+   if (mSeekRequest >= 0)
+      return false; //don't touch the ring while the reader is moving the window
+
+   int64_t windowEnd = mWindowEnd;
+   //the reader may be partway through overwriting one chunk behind the oldest resident data
+   int64_t windowStart = MAX(mWindowStart.load(), windowEnd - mRingLength + kChunkSize);
+
+   if (start >= windowStart && end < windowEnd)
+      return true;
+
+   if (start < windowStart || start > windowEnd)
+      mSeekRequest = start; //otherwise the reader is already on its way, and we just have to wait for it
+   return false;
+}
+
+void SampleStream::Prefetch(int64_t position)
+{
+   int64_t windowEnd = mWindowEnd;
+   int64_t windowStart = MAX(mWindowStart.load(), windowEnd - mRingLength + kChunkSize);
+   if (mSeekRequest < 0 && (position < windowStart || position > windowEnd))
+      mSeekRequest = position;
+}
+
+bool SampleStream::Fill()
+{
+   int64_t seek = mSeekRequest;
+   if (seek >= 0)
+   {
+      int64_t start = MAX(seek - kChunkSize / 4, mStartOffset); //keep a little behind the jump, for reverse playback and interpolation
+      mWindowStart = start;
+      mWindowEnd = start;
+      mSeekRequest.compare_exchange_strong(seek, -1); //if another jump came in meanwhile, leave it for the next pass
+      return true;
+   }
+
+   int64_t windowEnd = mWindowEnd;
+   int64_t limit = MIN(mLength, mReadLow.load() + mRingLength - kChunkSize);
+   int numSamples = (int)MIN(int64_t(kChunkSize), limit - windowEnd);
+   if (numSamples <= 0)
+      return false;
+
+   mReader->read(mReadBuffer.get(), 0, numSamples, windowEnd, true, true);
+
+   int ringPos = int(windowEnd % mRingLength);
+   int firstPart = MIN(numSamples, mRingLength - ringPos);
+   for (int ch = 0; ch < mRing.NumActiveChannels(); ++ch)
+   {
+      float* dest = mRing.GetChannel(ch);
+      if (mRing.NumActiveChannels() == 1 && mReadBuffer->getNumChannels() > 1)
+      {
+         //mixed down to mono, same as Sample::FinishRead()
+         for (int i = 0; i < numSamples; ++i)
+         {
+            float sample = 0;
+            for (int readCh = 0; readCh < mReadBuffer->getNumChannels(); ++readCh)
+               sample += mReadBuffer->getSample(readCh, i);
+            dest[(ringPos + i) % mRingLength] = sample / mReadBuffer->getNumChannels();
+         }
+      }
+      else
+      {
+         const float* src = mReadBuffer->getReadPointer(MIN(ch, mReadBuffer->getNumChannels() - 1));
+         BufferCopy(dest + ringPos, src, firstPart);
+         if (firstPart < numSamples)
+            BufferCopy(dest, src + firstPart, numSamples - firstPart);
+      }
+   }
+
+   mWindowEnd = windowEnd + numSamples;
+   return true;
+}
@@ -0,0 +1,79 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SampleStream.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChannelBuffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace juce
+{
+   class AudioFormatReader;
+   template <typename T>
+   class AudioBuffer;
+   using AudioSampleBuffer = AudioBuffer<float>;
+}
+
+//keeps a ring of upcoming audio from a file resident, filled ahead of the play position by a shared background reader thread.
+//used by Sample for files too long to decode into memory. positions before the stream's start offset aren't covered,
+//Sample keeps that part (the "head") decoded in memory, so playback can always start immediately.
+class SampleStream
+{
+public:
+   SampleStream(std::unique_ptr<juce::AudioFormatReader> reader, int64_t startOffset, int numChannels);
+   ~SampleStream();
+
+   //audio thread. returns true if [start, end] is resident. if it isn't, the reader is asked to jump to start
+   bool Acquire(int64_t start, int64_t end);
+   //audio thread. makes sure the reader has data from position onwards ready, without jumping it elsewhere
+   void Prefetch(int64_t position);
+   //only valid for positions inside the last successful Acquire()
+   float GetSample(int64_t position, int channel) { return mRing.GetChannel(channel)[position % mRingLength]; }
+
+   int64_t GetLength() const { return mLength; }
+
+private:
+   friend class SampleStreamReader;
+   bool Fill(); //reader thread, returns true if any work was done
+
+   static const int kChunkSize = 16384;
+   static const int kRingSeconds = 20;
+
+   std::unique_ptr<juce::AudioFormatReader> mReader;
+   std::unique_ptr<juce::AudioSampleBuffer> mReadBuffer;
+   ChannelBuffer mRing{ 0 };
+   int mRingLength{ 0 };
+   int64_t mStartOffset{ 0 };
+   int64_t mLength{ 0 };
+
+   std::atomic<int64_t> mWindowStart{ 0 };
+   std::atomic<int64_t> mWindowEnd{ 0 };
+   std::atomic<int64_t> mReadLow{ 0 }; //earliest position the consumer might still read, the reader won't overwrite it
+   std::atomic<int64_t> mSeekRequest{ -1 };
+};
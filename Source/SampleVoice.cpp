@@ -29,6 +29,7 @@
 #include "Profiler.h"
 #include "ChannelBuffer.h"
 #include "Sample.h"
+#include "CpuGovernor.h"
 
 SampleVoice::SampleVoice(IDrawableModule* owner)
 : mOwner(owner)
@@ -54,8 +55,19 @@ bool SampleVoice::Process(double time, ChannelBuffer* out, int oversampling)
       return false;
 
    float volSq = mVoiceParams->mVol * mVoiceParams->mVol;
+   int bufferSize = out->BufferSize();
+   if ((int)mReadPositions.size() < bufferSize)
+   {
+      mReadPositions.resize(bufferSize);
+      mGain.resize(bufferSize);
+      mResampled.resize(bufferSize);
+   }
 
-   for (int pos = 0; pos < out->BufferSize(); ++pos)
+   mAdsr.RenderBlock(time, mGain.data(), bufferSize, gInvSampleRateMs);
+
+   //find the read position and gain for each sample, then resample the block in one go
+   float maxSpeed = 0;
+   for (int pos = 0; pos < bufferSize; ++pos)
    {
       if (mOwner)
          mOwner->ComputeSliders(pos);
@@ -73,18 +85,16 @@ bool SampleVoice::Process(double time, ChannelBuffer* out, int oversampling)
          jumpTo = mVoiceParams->mSustainLoopStart;
       }
 
+      mReadPositions[pos] = mPos;
+      float adsrVal = mGain[pos];
+      mGain[pos] = 0;
       if (mPos <= stopSample)
       {
          float freq = TheScale->PitchToFreq(GetPitch(pos));
          float speed = freq / TheScale->PitchToFreq(mVoiceParams->mSamplePitch);
+         maxSpeed = MAX(maxSpeed, fabsf(speed));
 
-         for (int i = 0; i < 2; ++i)
-         {
-            int ch = MIN(i, mVoiceParams->mSample->Data()->NumActiveChannels() - 1);
-            float sample = GetInterpolatedSample(mPos, mVoiceParams->mSample->Data()->GetChannel(ch), mVoiceParams->mSample->LengthInSamples()) * mAdsr.Value(time) * volSq;
-            float pan = i == 0 ? GetLeftPanGain(GetPan()) : GetRightPanGain(GetPan());
-            out->GetChannel(i)[pos] += sample * pan;
-         }
+         mGain[pos] = adsrVal * volSq;
 
          mPos += speed;
 
@@ -95,6 +105,22 @@ bool SampleVoice::Process(double time, ChannelBuffer* out, int oversampling)
       time += gInvSampleRateMs;
    }
 
+   ResampleQuality quality = mVoiceParams->mResampleQuality;
+   if (GetDegradeLevel() >= CpuGovernor::kLevel_ReduceQuality)
+      quality = GetCheaperQuality(quality);
+
+   ChannelBuffer* data = mVoiceParams->mSample->Data();
+   for (int i = 0; i < 2; ++i)
+   {
+      int ch = MIN(i, data->NumActiveChannels() - 1);
+      if (i == 0 || ch != 0) //mono samples only need to be resampled once
+         Resample(data->GetChannel(ch), mVoiceParams->mSample->LengthInSamples(), mReadPositions.data(), mResampled.data(), bufferSize, quality, maxSpeed);
+      float pan = i == 0 ? GetLeftPanGain(GetPan()) : GetRightPanGain(GetPan());
+      float* dest = out->GetChannel(i);
+      for (int pos = 0; pos < bufferSize; ++pos)
+         dest[pos] += mResampled[pos] * mGain[pos] * pan;
+   }
+
    return true;
 }
 
@@ -29,6 +29,9 @@
 #include "IVoiceParams.h"
 #include "ADSR.h"
 #include "EnvOscillator.h"
+#include "Resampler.h"
+
+#include <vector>
 
 class IDrawableModule;
 
@@ -43,6 +46,7 @@ public:
    int mStopSample{ -1 };
    int mSustainLoopStart{ -1 };
    int mSustainLoopEnd{ -1 };
+   ResampleQuality mResampleQuality{ ResampleQuality::Linear };
 };
 
 class SampleVoice : public IMidiVoice
@@ -60,10 +64,15 @@ public:
    bool Process(double time, ChannelBuffer* out, int oversampling) override;
    void SetVoiceParams(IVoiceParams* params) override;
    bool IsDone(double time) override;
+   float GetLevel(double time) override { return mAdsr.Value(time); }
 
 private:
    ::ADSR mAdsr;
    SampleVoiceParams* mVoiceParams{};
    float mPos{ 0 };
    IDrawableModule* mOwner{ nullptr };
+
+   std::vector<double> mReadPositions;
+   std::vector<float> mGain;
+   std::vector<float> mResampled;
 };
@@ -63,6 +63,7 @@ void Sampler::CreateUIControls()
    CHECKBOX(mRecordCheckbox, "rec", &mRecording);
    FLOATSLIDER(mThreshSlider, "thresh", &mThresh, 0, 1);
    CHECKBOX(mPassthroughCheckbox, "passthrough", &mPassthrough);
+   DROPDOWN(mResampleQualitySelector, "quality", (int*)(&mVoiceParams.mResampleQuality), 50);
    UIBLOCK_NEWCOLUMN();
    UIBLOCK_PUSHSLIDERWIDTH(200);
    INTSLIDER(mStartSlider, "start", &mVoiceParams.mStartSample, 0, 1000);
@@ -71,6 +72,10 @@ void Sampler::CreateUIControls()
    INTSLIDER(mSustainLoopStartSlider, "sustain start", &mVoiceParams.mSustainLoopStart, -1, 1000);
    INTSLIDER(mSustainLoopEndSlider, "sustain end", &mVoiceParams.mSustainLoopEnd, -1, 1000);
    ENDUIBLOCK(mWidth, mHeight);
+
+   mResampleQualitySelector->AddLabel("linear", (int)ResampleQuality::Linear);
+   mResampleQualitySelector->AddLabel("cubic", (int)ResampleQuality::Cubic);
+   mResampleQualitySelector->AddLabel("sinc", (int)ResampleQuality::Sinc);
 }
 
 Sampler::~Sampler()
@@ -104,6 +109,7 @@ void Sampler::Process(double time)
 
    if (mRecording)
    {
+      int recordStart = mRecordPos;
       for (int i = 0; i < gBufferSize; ++i)
       {
          //if we've already started recording, or if it's a new recording and there's sound
@@ -124,6 +130,7 @@ void Sampler::Process(double time)
             break;
          }
       }
+      mSample.Data()->MarkPeaksDirty(recordStart, mRecordPos - recordStart);
    }
 
    mSample.LockDataMutex(true);
@@ -132,8 +139,9 @@ void Sampler::Process(double time)
 
    for (int ch = 0; ch < mWriteBuffer.NumActiveChannels(); ++ch)
    {
-      GetVizBuffer()->WriteChunk(mWriteBuffer.GetChannel(ch), mWriteBuffer.BufferSize(), ch);
-      Add(target->GetBuffer()->GetChannel(ch), mWriteBuffer.GetChannel(ch), gBufferSize);
+      GetVizBuffer()->WriteChunk(mWriteBuffer.GetChannelReadOnly(ch), mWriteBuffer.BufferSize(), ch);
+      if (!mWriteBuffer.IsSilent(ch)) //no voices playing
+         Add(target->GetBuffer()->GetChannel(ch), mWriteBuffer.GetChannelReadOnly(ch), gBufferSize);
    }
 
    GetBuffer()->Reset();
@@ -192,6 +200,7 @@ void Sampler::DrawModule()
    mThreshSlider->Draw();
    mDetectPitchButton->Draw();
    mPassthroughCheckbox->Draw();
+   mResampleQualitySelector->Draw();
    mSamplePitchEntry->Draw();
    mStartSlider->Draw();
    mStopSlider->Draw();
@@ -262,6 +271,7 @@ void Sampler::UpdateForNewSample()
 
 void Sampler::FilesDropped(std::vector<std::string> files, int x, int y)
 {
+   mSample.CancelLoad(); //not with the data mutex held, see Sample::CancelLoad()
    mSample.LockDataMutex(true);
    mSample.Read(files[0].c_str());
    mSample.LockDataMutex(false);
@@ -270,6 +280,7 @@ void Sampler::FilesDropped(std::vector<std::string> files, int x, int y)
 
 void Sampler::SampleDropped(int x, int y, Sample* sample)
 {
+   mSample.CancelLoad();
    mSample.LockDataMutex(true);
    mSample.CopyFrom(sample);
    mSample.LockDataMutex(false);
@@ -279,6 +290,8 @@ void Sampler::SampleDropped(int x, int y, Sample* sample)
 void Sampler::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, -1, -1, kMaxPolyphony);
+   mModuleSaveData.LoadInt("cpu_priority", moduleInfo, 0, 0, CpuGovernor::kNumLevels - 1);
 
    SetUpFromSaveData();
 }
@@ -286,6 +299,13 @@ void Sampler::LoadLayout(const ofxJSONElement& moduleInfo)
 void Sampler::SetUpFromSaveData()
 {
    SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
+
+   int voiceLimit = mModuleSaveData.GetInt("voicelimit");
+   if (voiceLimit > 0)
+      mPolyMgr.SetVoiceLimit(voiceLimit);
+   else
+      mPolyMgr.SetVoiceLimit(kNumVoices);
+   mPolyMgr.SetPriority(mModuleSaveData.GetInt("cpu_priority"));
 }
 
 
@@ -311,6 +331,7 @@ void Sampler::CheckboxUpdated(Checkbox* checkbox, double time)
       if (mRecording)
       {
          mRecordPos = 0;
+         mSample.CancelLoad();
          mSample.LockDataMutex(true);
          mSample.Create(3.0f * gSampleRate);
          mSample.SetName("recorded");
@@ -60,6 +60,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //can record its input
    void SetEnabled(bool enabled) override;
 
    //INoteReceiver
@@ -117,6 +118,7 @@ private:
    ClickButton* mDetectPitchButton{ nullptr };
    bool mPassthrough{ false };
    Checkbox* mPassthroughCheckbox{ nullptr };
+   DropdownList* mResampleQualitySelector{ nullptr };
    TextEntry* mSamplePitchEntry{ nullptr };
    int mMostRecentVoiceIdx{ -1 };
 
@@ -58,6 +58,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //records its input
    void SetEnabled(bool enabled) override;
 
    //IAudioProcessor
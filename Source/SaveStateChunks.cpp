@@ -0,0 +1,442 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SaveStateChunks.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SaveStateChunks.h"
+#include "ChannelBuffer.h"
+#include "FileStream.h"
+#include "SynthGlobals.h"
+#include "ofxJSONElement.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+SaveStateChunkWriter* SaveStateChunkWriter::sActive = nullptr;
+SaveStateChunkReader* SaveStateChunkReader::sActive = nullptr;
+
+namespace
+{
+   const char kMagic[8] = { 'B', 'S', 'K', 'C', 'H', 'N', 'K', 'S' };
+   const int kFormatRev = 1;
+   const int kHeaderSize = sizeof(kMagic) + 4 + 4 + 8; //magic, format rev, save state rev, table of contents offset
+   const int kTocOffsetPosition = sizeof(kMagic) + 4 + 4;
+   const int kSampleBlockAlignment = 64;
+   const int kCompressionLevel = 1; //fast, most of the win on module state comes from the first level anyway
+}
+
+bool SaveStateChunk::IsChunkedSaveState(const std::string& path)
+{
+   juce::FileInputStream in{ juce::File(path) };
+   char magic[sizeof(kMagic)];
+   return in.openedOk() && in.read(magic, sizeof(magic)) == sizeof(magic) && memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+int SaveStateChunk::GetSampleBlockStride(int numSamples)
+{
+   const int kFloatsPerAlignment = kSampleBlockAlignment / sizeof(float);
+   return (numSamples + kFloatsPerAlignment - 1) / kFloatsPerAlignment * kFloatsPerAlignment;
+}
+
+SaveStateChunkWriter::SaveStateChunkWriter(const std::string& path, bool compress, bool append /*= false*/)
+: mCompress(compress)
+{
+   juce::File file(path);
+   if (!append)
+      file.deleteFile(); //FileOutputStream appends otherwise
+   mStream = std::make_unique<juce::FileOutputStream>(file);
+   if (OpenedOk())
+   {
+      mStartPosition = mStream->getPosition();
+      mStream->write(kMagic, sizeof(kMagic));
+      mStream->writeInt(kFormatRev);
+      mStream->writeInt(0); //save state rev, see Finish()
+      mStream->writeInt64(0); //table of contents offset, see Finish()
+   }
+}
+
+void SaveStateChunkWriter::AddChunk(std::uint32_t type, const std::string& name, juce::MemoryBlock&& data)
+{
+   SaveStateChunk::Info info;
+   info.mType = type;
+   info.mName = name;
+   info.mSize = data.getSize();
+   mChunks.push_back(info);
+   mPendingData.push_back(std::move(data));
+}
+
+void SaveStateChunkWriter::CopyChunk(SaveStateChunkReader& reader, int index)
+{
+   SaveStateChunk::Info info = reader.GetChunks()[index];
+   juce::MemoryBlock data;
+   reader.ReadStoredData(index, data);
+
+   if (info.mType == SaveStateChunk::kSampleBlock)
+   {
+      if (!OpenedOk())
+         return;
+      PadTo(kSampleBlockAlignment);
+      info.mOffset = mStream->getPosition();
+      mStream->write(data.getData(), data.getSize());
+      mChunks.push_back(info);
+      mPendingData.emplace_back();
+   }
+   else
+   {
+      mChunks.push_back(info); //keeps its compression, Finish() doesn't compress it again
+      mPendingData.push_back(std::move(data));
+   }
+}
+
+void SaveStateChunkWriter::SetCurrentModule(const std::string& name)
+{
+   mCurrentModule = name;
+   mCurrentModuleSampleBlocks = 0;
+}
+
+int SaveStateChunkWriter::AddSampleBlock(ChannelBuffer* data, int numSamples)
+{
+   if (!OpenedOk())
+      return -1;
+
+   PadTo(kSampleBlockAlignment);
+
+   int stride = SaveStateChunk::GetSampleBlockStride(numSamples);
+   SaveStateChunk::Info info;
+   info.mType = SaveStateChunk::kSampleBlock;
+   info.mName = mCurrentModule;
+   info.mOffset = mStream->getPosition();
+   info.mSize = info.mStoredSize = juce::int64(data->NumActiveChannels()) * stride * sizeof(float);
+
+   std::vector<float> padding(stride - numSamples, 0.0f);
+   for (int ch = 0; ch < data->NumActiveChannels(); ++ch)
+   {
+      mStream->write(data->GetChannel(ch), numSamples * sizeof(float));
+      if (!padding.empty())
+         mStream->write(padding.data(), padding.size() * sizeof(float));
+   }
+
+   mChunks.push_back(info);
+   mPendingData.emplace_back();
+   return mCurrentModuleSampleBlocks++;
+}
+
+bool SaveStateChunkWriter::Finish(int saveStateRev)
+{
+   if (!OpenedOk())
+      return false;
+
+   if (mCompress)
+   {
+      RunInParallel((int)mChunks.size(), [this](int i)
+                    {
+                       juce::MemoryBlock& data = mPendingData[i];
+                       if (mChunks[i].mType == SaveStateChunk::kSampleBlock || mChunks[i].mCompression != SaveStateChunk::Compression::None || data.getSize() < 256)
+                          return;
+
+                       juce::MemoryBlock compressed;
+                       {
+                          juce::MemoryOutputStream compressedStream(compressed, false);
+                          juce::GZIPCompressorOutputStream zlib(compressedStream, kCompressionLevel);
+                          zlib.write(data.getData(), data.getSize());
+                          zlib.flush();
+                       }
+                       if (compressed.getSize() < data.getSize())
+                       {
+                          data = std::move(compressed);
+                          mChunks[i].mCompression = SaveStateChunk::Compression::Zlib;
+                       }
+                    });
+   }
+
+   for (size_t i = 0; i < mChunks.size(); ++i)
+   {
+      if (mChunks[i].mType == SaveStateChunk::kSampleBlock)
+         continue;
+      mChunks[i].mOffset = mStream->getPosition();
+      mChunks[i].mStoredSize = mPendingData[i].getSize();
+      mStream->write(mPendingData[i].getData(), mPendingData[i].getSize());
+      mPendingData[i].reset();
+   }
+
+   juce::int64 tocOffset = mStream->getPosition();
+   mStream->writeInt((int)mChunks.size());
+   for (const auto& info : mChunks)
+   {
+      mStream->writeInt((int)info.mType);
+      mStream->writeInt((int)info.mCompression);
+      mStream->writeInt64(info.mOffset);
+      mStream->writeInt64(info.mStoredSize);
+      mStream->writeInt64(info.mSize);
+      mStream->writeInt((int)info.mName.size());
+      mStream->write(info.mName.data(), info.mName.size());
+   }
+
+   mStream->setPosition(mStartPosition + kTocOffsetPosition - 4);
+   mStream->writeInt(saveStateRev);
+   mStream->writeInt64(tocOffset);
+   mStream->flush();
+
+   bool ok = mStream->getStatus().wasOk();
+   mStream.reset();
+   return ok;
+}
+
+void SaveStateChunkWriter::PadTo(int alignment)
+{
+   const char zeros[kSampleBlockAlignment] = {};
+   int padding = int((alignment - mStream->getPosition() % alignment) % alignment);
+   mStream->write(zeros, padding);
+}
+
+SaveStateChunkReader::SaveStateChunkReader(const std::string& path, std::int64_t startOffset /*= 0*/)
+: mPath(path)
+{
+   juce::FileInputStream in{ juce::File(path) };
+   if (!in.openedOk() || in.getTotalLength() < startOffset + kHeaderSize || !in.setPosition(startOffset))
+      return;
+
+   char magic[sizeof(kMagic)];
+   in.read(magic, sizeof(magic));
+   int formatRev = in.readInt();
+   if (memcmp(magic, kMagic, sizeof(kMagic)) != 0 || formatRev > kFormatRev)
+      return;
+
+   mSaveStateRev = in.readInt();
+   juce::int64 tocOffset = in.readInt64();
+   if (tocOffset < startOffset + kHeaderSize || tocOffset >= in.getTotalLength() || !in.setPosition(tocOffset))
+      return; //zero if the container was never finished
+
+   int numChunks = in.readInt();
+   if (numChunks < 0)
+      return;
+   for (int i = 0; i < numChunks && !in.isExhausted(); ++i)
+   {
+      SaveStateChunk::Info info;
+      info.mType = (std::uint32_t)in.readInt();
+      info.mCompression = (SaveStateChunk::Compression)in.readInt();
+      info.mOffset = in.readInt64();
+      info.mStoredSize = in.readInt64();
+      info.mSize = in.readInt64();
+      int nameLength = in.readInt();
+      if (nameLength < 0 || nameLength > FileStreamIn::sMaxStringLength)
+         return;
+      info.mName.resize(nameLength);
+      in.read(&info.mName[0], nameLength);
+      if (info.mOffset < startOffset + kHeaderSize || info.mStoredSize < 0 || info.mOffset + info.mStoredSize > tocOffset)
+         return;
+      mChunks.push_back(info);
+   }
+
+   if ((int)mChunks.size() != numChunks)
+      return;
+
+   mData.resize(mChunks.size());
+   mDataLoaded.resize(mChunks.size(), false);
+   mEndOffset = in.getPosition();
+   mOpenedOk = true;
+}
+
+int SaveStateChunkReader::FindChunk(std::uint32_t type) const
+{
+   for (size_t i = 0; i < mChunks.size(); ++i)
+   {
+      if (mChunks[i].mType == type)
+         return (int)i;
+   }
+   return -1;
+}
+
+void SaveStateChunkReader::Prefetch(const std::vector<int>& indices)
+{
+   std::vector<int> toLoad;
+   for (int index : indices)
+   {
+      if (!mDataLoaded[index])
+         toLoad.push_back(index);
+   }
+
+   RunInParallel((int)toLoad.size(), [this, &toLoad](int i)
+                 {
+                    LoadChunkData(toLoad[i], mData[toLoad[i]]);
+                 });
+
+   for (int index : toLoad)
+      mDataLoaded[index] = true;
+}
+
+const juce::MemoryBlock& SaveStateChunkReader::GetChunkData(int index)
+{
+   if (!mDataLoaded[index])
+   {
+      LoadChunkData(index, mData[index]);
+      mDataLoaded[index] = true;
+   }
+   return mData[index];
+}
+
+void SaveStateChunkReader::ReleaseChunkData(int index)
+{
+   mData[index].reset();
+   mDataLoaded[index] = false;
+}
+
+bool SaveStateChunkReader::ReadStoredData(int index, juce::MemoryBlock& into) const
+{
+   //each call opens its own stream, so chunks can be loaded from several threads at once
+   const SaveStateChunk::Info& info = mChunks[index];
+   into.reset();
+
+   juce::FileInputStream in{ juce::File(mPath) };
+   if (!in.openedOk() || !in.setPosition(info.mOffset))
+      return false;
+
+   return (juce::int64)in.readIntoMemoryBlock(into, info.mStoredSize) == info.mStoredSize;
+}
+
+bool SaveStateChunkReader::LoadChunkData(int index, juce::MemoryBlock& into) const
+{
+   const SaveStateChunk::Info& info = mChunks[index];
+
+   if (info.mCompression == SaveStateChunk::Compression::Zlib)
+   {
+      juce::MemoryBlock stored;
+      into.reset();
+      if (!ReadStoredData(index, stored))
+         return false;
+      juce::GZIPDecompressorInputStream zlib(new juce::MemoryInputStream(stored, false), true, juce::GZIPDecompressorInputStream::zlibFormat, info.mSize);
+      return (juce::int64)zlib.readIntoMemoryBlock(into, info.mSize) == info.mSize;
+   }
+
+   return ReadStoredData(index, into);
+}
+
+int SaveStateChunkReader::GetModuleSampleBlock(int indexInModule) const
+{
+   if (mCurrentModuleChunk < 0)
+      return -1;
+
+   const std::string& module = mChunks[mCurrentModuleChunk].mName;
+   for (size_t i = 0; i < mChunks.size(); ++i)
+   {
+      if (mChunks[i].mType == SaveStateChunk::kSampleBlock && mChunks[i].mName == module)
+      {
+         if (indexInModule == 0)
+            return (int)i;
+         --indexInModule;
+      }
+   }
+   return -1;
+}
+
+bool SaveStateChunkReader::IsValidSampleBlock(int index, int numChannels, int numSamples) const
+{
+   return index >= 0 && index < (int)mChunks.size() && mChunks[index].mType == SaveStateChunk::kSampleBlock &&
+          mChunks[index].mSize >= juce::int64(numChannels) * SaveStateChunk::GetSampleBlockStride(numSamples) * sizeof(float);
+}
+
+bool SaveStateChunkReader::ReadSampleBlock(int index, ChannelBuffer* into, int numChannels, int numSamples)
+{
+   if (!IsValidSampleBlock(index, numChannels, numSamples))
+      return false;
+
+   int stride = SaveStateChunk::GetSampleBlockStride(numSamples);
+
+   juce::FileInputStream in{ juce::File(mPath) };
+   if (!in.openedOk())
+      return false;
+
+   into->SetNumActiveChannels(numChannels);
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      in.setPosition(mChunks[index].mOffset + juce::int64(ch) * stride * sizeof(float));
+      if (in.read(into->GetChannel(ch), numSamples * sizeof(float)) != int(numSamples * sizeof(float)))
+         return false;
+   }
+   return true;
+}
+
+bool SaveStateChunkSet::Add(std::unique_ptr<SaveStateChunkReader> reader)
+{
+   if (reader == nullptr || !reader->OpenedOk())
+      return false;
+
+   auto replace = [&reader](std::vector<SaveStateChunkRef>& refs, int index)
+   {
+      const std::string& name = reader->GetChunks()[index].mName;
+      for (auto& ref : refs)
+      {
+         if (ref.mReader->GetChunks()[ref.mIndex].mName == name)
+         {
+            ref = { reader.get(), index };
+            return;
+         }
+      }
+      refs.push_back({ reader.get(), index });
+   };
+
+   const auto& chunks = reader->GetChunks();
+   for (int i = 0; i < (int)chunks.size(); ++i)
+   {
+      if (chunks[i].mType == SaveStateChunk::kLayout)
+         mLayout = { reader.get(), i };
+      else if (chunks[i].mType == SaveStateChunk::kModule)
+         replace(mModules, i);
+      else if (chunks[i].mType == SaveStateChunk::kUILayerModule)
+         replace(mUILayerModules, i);
+   }
+
+   mSaveStateRev = reader->GetSaveStateRev();
+   mReaders.push_back(std::move(reader));
+   return true;
+}
+
+void SaveStateChunkSet::RemoveModulesNotInLayout()
+{
+   if (!IsValid())
+      return;
+
+   ofxJSONElement layout;
+   const juce::MemoryBlock& layoutData = mLayout.mReader->GetChunkData(mLayout.mIndex);
+   if (!layout.parse((const char*)layoutData.getData(), (const char*)layoutData.getData() + layoutData.getSize()))
+      return;
+   mLayout.mReader->ReleaseChunkData(mLayout.mIndex);
+
+   auto filter = [](std::vector<SaveStateChunkRef>& refs, const ofxJSONElement& modules)
+   {
+      std::set<std::string> names;
+      for (int i = 0; i < (int)modules.size(); ++i)
+         names.insert(modules[i]["name"].asString());
+
+      refs.erase(std::remove_if(refs.begin(), refs.end(), [&names](const SaveStateChunkRef& ref)
+                                {
+                                   return names.count(ref.mReader->GetChunks()[ref.mIndex].mName) == 0;
+                                }),
+                 refs.end());
+   };
+
+   filter(mModules, layout["modules"]);
+   filter(mUILayerModules, layout["ui_modules"]);
+}
@@ -0,0 +1,164 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SaveStateChunks.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "juce_core/juce_core.h"
+
+class ChannelBuffer;
+
+//a .bsk save state made of chunks, with a table of contents at the end.
+//the layout and each module's state go in their own chunk (optionally zlib compressed, in parallel), so loading can
+//decompress everything at once and skip straight past a module that fails to load. sample data embedded in module state
+//is written as raw, aligned blocks that Sample maps straight out of the file instead of reading.
+//older .bsk files (a json string followed by the module container streams) don't start with the magic, see IsChunkedSaveState()
+namespace SaveStateChunk
+{
+   enum Type : std::uint32_t
+   {
+      kLayout = 0x4c41594f, //'LAYO'
+      kModule = 0x4d4f444c, //'MODL'
+      kUILayerModule = 0x55494d44, //'UIMD'
+      kSampleBlock = 0x534d504c //'SMPL'
+   };
+
+   enum class Compression : std::uint32_t
+   {
+      None,
+      Zlib
+   };
+
+   struct Info
+   {
+      std::uint32_t mType{ 0 };
+      Compression mCompression{ Compression::None };
+      std::int64_t mOffset{ 0 };
+      std::int64_t mStoredSize{ 0 };
+      std::int64_t mSize{ 0 };
+      std::string mName;
+   };
+
+   bool IsChunkedSaveState(const std::string& path);
+   int GetSampleBlockStride(int numSamples); //floats between channels in a sample block
+}
+
+class SaveStateChunkReader;
+
+struct SaveStateChunkRef
+{
+   SaveStateChunkReader* mReader{ nullptr };
+   int mIndex{ -1 };
+};
+
+class SaveStateChunkWriter
+{
+public:
+   SaveStateChunkWriter(const std::string& path, bool compress, bool append = false); //append to add another container to the end of the file (see AutosaveJournal)
+
+   bool OpenedOk() const { return mStream != nullptr && mStream->openedOk(); }
+   void AddChunk(std::uint32_t type, const std::string& name, juce::MemoryBlock&& data);
+   void CopyChunk(SaveStateChunkReader& reader, int index); //as it's stored, without decompressing it
+   bool Finish(int saveStateRev); //compresses and writes the rest of the chunks, then the table of contents
+
+   //sample blocks belong to the module being written, and are numbered from zero within it, so they can be copied along with it
+   void SetCurrentModule(const std::string& name);
+   int AddSampleBlock(ChannelBuffer* data, int numSamples); //written out right away
+
+   //the writer for the save state being written, if any, so Sample::SaveState() can put its data in a block
+   static SaveStateChunkWriter* GetActive() { return sActive; }
+   static void SetActive(SaveStateChunkWriter* writer) { sActive = writer; }
+
+private:
+   void PadTo(int alignment);
+
+   std::unique_ptr<juce::FileOutputStream> mStream;
+   std::int64_t mStartPosition{ 0 };
+   bool mCompress{ false };
+   std::string mCurrentModule;
+   int mCurrentModuleSampleBlocks{ 0 };
+   std::vector<SaveStateChunk::Info> mChunks;
+   std::vector<juce::MemoryBlock> mPendingData; //per chunk, empty once written
+   static SaveStateChunkWriter* sActive;
+};
+
+class SaveStateChunkReader
+{
+public:
+   explicit SaveStateChunkReader(const std::string& path, std::int64_t startOffset = 0);
+
+   bool OpenedOk() const { return mOpenedOk; }
+   int GetSaveStateRev() const { return mSaveStateRev; }
+   std::int64_t GetEndOffset() const { return mEndOffset; } //where the next container in the file would start
+   const std::vector<SaveStateChunk::Info>& GetChunks() const { return mChunks; }
+   int FindChunk(std::uint32_t type) const; //first chunk of this type, or -1
+   void Prefetch(const std::vector<int>& indices); //reads and unpacks these chunks in parallel, ahead of GetChunkData()
+   const juce::MemoryBlock& GetChunkData(int index);
+   void ReleaseChunkData(int index);
+   bool ReadStoredData(int index, juce::MemoryBlock& into) const;
+
+   //sample blocks
+   void SetCurrentModule(int moduleChunk) { mCurrentModuleChunk = moduleChunk; }
+   int GetModuleSampleBlock(int indexInModule) const; //chunk index of the current module's nth sample block, or -1
+   bool IsValidSampleBlock(int index, int numChannels, int numSamples) const;
+   bool ReadSampleBlock(int index, ChannelBuffer* into, int numChannels, int numSamples);
+   std::string GetPath() const { return mPath; }
+   std::int64_t GetChunkOffset(int index) const { return mChunks[index].mOffset; }
+
+   static SaveStateChunkReader* GetActive() { return sActive; }
+   static void SetActive(SaveStateChunkReader* reader) { sActive = reader; }
+
+private:
+   bool LoadChunkData(int index, juce::MemoryBlock& into) const;
+
+   std::string mPath;
+   bool mOpenedOk{ false };
+   int mSaveStateRev{ 0 };
+   std::int64_t mEndOffset{ 0 };
+   int mCurrentModuleChunk{ -1 };
+   std::vector<SaveStateChunk::Info> mChunks;
+   std::vector<juce::MemoryBlock> mData;
+   std::vector<bool> mDataLoaded;
+   static SaveStateChunkReader* sActive;
+};
+
+//the chunks that make up one save state, which can be spread over several containers (see AutosaveJournal)
+struct SaveStateChunkSet
+{
+   bool Add(std::unique_ptr<SaveStateChunkReader> reader); //chunks in later containers replace earlier ones for the same module
+   void RemoveModulesNotInLayout();
+   bool IsValid() const { return mLayout.mReader != nullptr; }
+
+   std::vector<std::unique_ptr<SaveStateChunkReader>> mReaders;
+   SaveStateChunkRef mLayout;
+   std::vector<SaveStateChunkRef> mModules;
+   std::vector<SaveStateChunkRef> mUILayerModules;
+   int mSaveStateRev{ 0 };
+};
@@ -44,6 +44,8 @@ Scale::Scale()
    assert(TheScale == nullptr);
    TheScale = this;
    SetName("scale");
+   mScale.UseLookup();
+   UpdatePitchFreqs();
 }
 
 Scale::~Scale()
@@ -172,6 +174,25 @@ void Scale::Init()
 }
 
 float Scale::PitchToFreq(float pitch)
+{
+   //oddsound can retune from outside at any time, so it's always asked
+   if (mIntonation != kIntonation_Oddsound && pitch >= 0 && pitch < (int)mPitchFreqs.size())
+   {
+      int intPitch = (int)pitch;
+      if (intPitch == pitch)
+         return mPitchFreqs[intPitch];
+
+      //the ratio intonations interpolate linearly between whole pitches anyway
+      if (intPitch + 1 < (int)mPitchFreqs.size() &&
+          (mIntonation == kIntonation_Pythagorean || mIntonation == kIntonation_Just ||
+           mIntonation == kIntonation_Rational || mIntonation == kIntonation_Meantone))
+         return ofLerp(mPitchFreqs[intPitch], mPitchFreqs[intPitch + 1], pitch - intPitch);
+   }
+
+   return ComputePitchToFreq(pitch);
+}
+
+float Scale::ComputePitchToFreq(float pitch)
 {
    if (mIntonation == kIntonation_SclFile)
    {
@@ -265,27 +286,18 @@ float Scale::FreqToPitch(float freq)
    //return 0;
 }
 
-int Scale::MakeDiatonic(int pitch)
+void Scale::UpdatePitchFreqs()
 {
-   if (mScale.GetPitches().empty()) //empty list means "chromatic"
-      return pitch;
-
-   assert(mScale.mScaleRoot >= 0 && mScale.mScaleRoot < mPitchesPerOctave);
-
-   int pitchOut = (pitch - mScale.mScaleRoot) % mPitchesPerOctave; //transform into 0-12 scale space
-
-   for (int i = (int)mScale.GetPitches().size() - 1; i >= 0; --i)
-   {
-      if (mScale.GetScalePitch(i) <= pitchOut)
-      {
-         pitchOut = mScale.GetScalePitch(i);
-         break;
-      }
-   }
+   if (mIntonation == kIntonation_Oddsound)
+      return;
 
-   pitchOut += mPitchesPerOctave * ((pitch - mScale.mScaleRoot) / mPitchesPerOctave) + mScale.mScaleRoot; //transform back
+   for (int i = 0; i < (int)mPitchFreqs.size(); ++i)
+      mPitchFreqs[i] = ComputePitchToFreq(i);
+}
 
-   return pitchOut;
+int Scale::MakeDiatonic(int pitch)
+{
+   return mScale.MakeDiatonic(pitch);
 }
 
 void Scale::GetChordDegreeAndAccidentals(const Chord& chord, int& degree, std::vector<Accidental>& accidentals)
@@ -315,6 +327,7 @@ void Scale::SetRoot(int root, bool force)
       return;
 
    mScale.SetRoot(root);
+   UpdatePitchFreqs(); //the ratio intonations are relative to the root
 
    NotifyListeners();
 }
@@ -706,6 +719,9 @@ void Scale::UpdateTuningTable()
             mTuningTable[i] *= ratio;
       }
    }
+
+   mScale.UpdateLookup(); //the pitches per octave may have changed
+   UpdatePitchFreqs();
 }
 
 float Scale::GetTuningTableRatio(int semitonesFromCenter)
@@ -798,12 +814,18 @@ void Scale::LoadState(FileStreamIn& in, int rev)
       ofLog() << "Restoring SCL/KBM from streaming";
       UpdateTuningTable();
    }
+   else
+   {
+      UpdatePitchFreqs();
+   }
 }
 
 void ScalePitches::SetRoot(int root)
 {
    assert(root >= 0);
    mScaleRoot = root % TheScale->GetPitchesPerOctave();
+   if (mUseLookup)
+      UpdateLookup();
 }
 
 void ScalePitches::SetScaleType(std::string type)
@@ -812,12 +834,49 @@ void ScalePitches::SetScaleType(std::string type)
 
    int newFlip = (mScalePitchesFlip == 0) ? 1 : 0;
    mScalePitches[newFlip] = TheScale->GetPitchesForScale(type);
+   if (mUseLookup)
+      BuildLookup(newFlip);
    mScalePitchesFlip = newFlip;
 }
 
 void ScalePitches::SetAccidentals(const std::vector<Accidental>& accidentals)
 {
    mAccidentals = accidentals;
+   if (mUseLookup)
+      UpdateLookup();
+}
+
+void ScalePitches::UseLookup()
+{
+   UpdateLookup();
+   mUseLookup = true;
+}
+
+void ScalePitches::UpdateLookup()
+{
+   int newFlip = (mScalePitchesFlip == 0) ? 1 : 0;
+   mScalePitches[newFlip] = mScalePitches[mScalePitchesFlip];
+   BuildLookup(newFlip);
+   mScalePitchesFlip = newFlip;
+}
+
+void ScalePitches::BuildLookup(int flip)
+{
+   PitchLookup& lookup = mLookup[flip];
+   for (int i = 0; i < PitchLookup::kNumPitches; ++i)
+   {
+      uint8_t flags = 0;
+      if (ComputeIsInScale(flip, i))
+         flags |= PitchLookup::kInScale;
+      if (ComputeIsRoot(flip, i))
+         flags |= PitchLookup::kRoot;
+      if (ComputeIsInPentatonic(flip, i))
+         flags |= PitchLookup::kPentatonic;
+      lookup.mFlags[i] = flags;
+      lookup.mDiatonic[i] = ComputeDiatonic(flip, i);
+      lookup.mToneFromPitch[i] = ComputeToneFromPitch(flip, i);
+      lookup.mPitchFromTone[i] = ComputePitchFromTone(flip, i);
+   }
 }
 
 void ScalePitches::GetChordDegreeAndAccidentals(const Chord& chord, int& degree, std::vector<Accidental>& accidentals) const
@@ -891,11 +950,64 @@ int ScalePitches::NumTonesInScale() const
 
 int ScalePitches::GetScalePitch(int index) const
 {
-   if (mScalePitches[mScalePitchesFlip].empty())
+   return ComputeScalePitch(mScalePitchesFlip, index);
+}
+
+bool ScalePitches::IsRoot(int pitch) const
+{
+   int flip = mScalePitchesFlip;
+   if (mUseLookup && pitch >= 0 && pitch < PitchLookup::kNumPitches)
+      return mLookup[flip].mFlags[pitch] & PitchLookup::kRoot;
+   return ComputeIsRoot(flip, pitch);
+}
+
+bool ScalePitches::IsInPentatonic(int pitch) const
+{
+   int flip = mScalePitchesFlip;
+   if (mUseLookup && pitch >= 0 && pitch < PitchLookup::kNumPitches)
+      return mLookup[flip].mFlags[pitch] & PitchLookup::kPentatonic;
+   return ComputeIsInPentatonic(flip, pitch);
+}
+
+bool ScalePitches::IsInScale(int pitch) const
+{
+   int flip = mScalePitchesFlip;
+   if (mUseLookup && pitch >= 0 && pitch < PitchLookup::kNumPitches)
+      return mLookup[flip].mFlags[pitch] & PitchLookup::kInScale;
+   return ComputeIsInScale(flip, pitch);
+}
+
+int ScalePitches::GetPitchFromTone(int n) const
+{
+   int flip = mScalePitchesFlip;
+   if (mUseLookup && n >= 0 && n < PitchLookup::kNumPitches)
+      return mLookup[flip].mPitchFromTone[n];
+   return ComputePitchFromTone(flip, n);
+}
+
+int ScalePitches::GetToneFromPitch(int pitch) const
+{
+   int flip = mScalePitchesFlip;
+   if (mUseLookup && pitch >= 0 && pitch < PitchLookup::kNumPitches)
+      return mLookup[flip].mToneFromPitch[pitch];
+   return ComputeToneFromPitch(flip, pitch);
+}
+
+int ScalePitches::MakeDiatonic(int pitch) const
+{
+   int flip = mScalePitchesFlip;
+   if (mUseLookup && pitch >= 0 && pitch < PitchLookup::kNumPitches)
+      return mLookup[flip].mDiatonic[pitch];
+   return ComputeDiatonic(flip, pitch);
+}
+
+int ScalePitches::ComputeScalePitch(int flip, int index) const
+{
+   if (mScalePitches[flip].empty())
       return index;
 
-   assert(index >= 0 && index < mScalePitches[mScalePitchesFlip].size());
-   int pitch = mScalePitches[mScalePitchesFlip][index];
+   assert(index >= 0 && index < mScalePitches[flip].size());
+   int pitch = mScalePitches[flip][index];
 
    for (int i = 0; i < mAccidentals.size(); ++i)
    {
@@ -906,19 +1018,19 @@ int ScalePitches::GetScalePitch(int index) const
    return pitch;
 }
 
-bool ScalePitches::IsRoot(int pitch) const
+bool ScalePitches::ComputeIsRoot(int flip, int pitch) const
 {
    pitch -= mScaleRoot;
    pitch += TheScale->GetPitchesPerOctave();
    assert(pitch >= 0);
    pitch %= TheScale->GetPitchesPerOctave();
 
-   return pitch == GetScalePitch(0);
+   return pitch == ComputeScalePitch(flip, 0);
 }
 
-bool ScalePitches::IsInPentatonic(int pitch) const
+bool ScalePitches::ComputeIsInPentatonic(int flip, int pitch) const
 {
-   if (!IsInScale(pitch))
+   if (!ComputeIsInScale(flip, pitch))
       return false;
 
    pitch -= mScaleRoot;
@@ -926,7 +1038,7 @@ bool ScalePitches::IsInPentatonic(int pitch) const
    assert(pitch >= 0);
    pitch %= TheScale->GetPitchesPerOctave();
 
-   bool isMinor = IsInScale(mScaleRoot + 3);
+   bool isMinor = ComputeIsInScale(flip, mScaleRoot + 3);
 
    if (isMinor)
       return pitch == 0 || pitch == 3 || pitch == 5 || pitch == 7 || pitch == 10;
@@ -934,9 +1046,9 @@ bool ScalePitches::IsInPentatonic(int pitch) const
       return pitch == 0 || pitch == 2 || pitch == 4 || pitch == 7 || pitch == 9;
 }
 
-bool ScalePitches::IsInScale(int pitch) const
+bool ScalePitches::ComputeIsInScale(int flip, int pitch) const
 {
-   if (mScalePitches[mScalePitchesFlip].empty())
+   if (mScalePitches[flip].empty())
       return true;
 
    pitch -= mScaleRoot;
@@ -945,18 +1057,20 @@ bool ScalePitches::IsInScale(int pitch) const
       return false;
    pitch %= TheScale->GetPitchesPerOctave();
 
-   for (int i = 0; i < mScalePitches[mScalePitchesFlip].size(); ++i)
+   for (int i = 0; i < mScalePitches[flip].size(); ++i)
    {
-      if (pitch == GetScalePitch(i))
+      if (pitch == ComputeScalePitch(flip, i))
          return true;
    }
 
    return false;
 }
 
-int ScalePitches::GetPitchFromTone(int n) const
+int ScalePitches::ComputePitchFromTone(int flip, int n) const
 {
-   int numTones = NumTonesInScale();
+   int numTones = (int)mScalePitches[flip].size();
+   if (numTones == 0)
+      numTones = TheScale->GetPitchesPerOctave();
 
    int octave = n / numTones;
    while (n < 0)
@@ -966,17 +1080,17 @@ int ScalePitches::GetPitchFromTone(int n) const
    }
    int degree = n % numTones;
 
-   return GetScalePitch(degree) + TheScale->GetPitchesPerOctave() * octave + mScaleRoot;
+   return ComputeScalePitch(flip, degree) + TheScale->GetPitchesPerOctave() * octave + mScaleRoot;
 }
 
-int ScalePitches::GetToneFromPitch(int pitch) const
+int ScalePitches::ComputeToneFromPitch(int flip, int pitch) const
 {
-   if (mScalePitches[mScalePitchesFlip].empty()) //empty list means "chromatic"
+   if (mScalePitches[flip].empty()) //empty list means "chromatic"
       return pitch;
 
    assert(mScaleRoot >= 0 && mScaleRoot < TheScale->GetPitchesPerOctave());
 
-   int numTones = (int)mScalePitches[mScalePitchesFlip].size();
+   int numTones = (int)mScalePitches[flip].size();
    int rootRel = pitch - mScaleRoot;
    while (rootRel < 0)
       rootRel += TheScale->GetPitchesPerOctave();
@@ -987,13 +1101,37 @@ int ScalePitches::GetToneFromPitch(int pitch) const
       tone = i;
 
       int octave = i / numTones;
-      if (GetScalePitch(i % numTones) + octave * TheScale->GetPitchesPerOctave() >= rootRel)
+      if (ComputeScalePitch(flip, i % numTones) + octave * TheScale->GetPitchesPerOctave() >= rootRel)
          break;
    }
 
    return tone;
 }
 
+int ScalePitches::ComputeDiatonic(int flip, int pitch) const
+{
+   if (mScalePitches[flip].empty()) //empty list means "chromatic"
+      return pitch;
+
+   int pitchesPerOctave = TheScale->GetPitchesPerOctave();
+   assert(mScaleRoot >= 0 && mScaleRoot < pitchesPerOctave);
+
+   int pitchOut = (pitch - mScaleRoot) % pitchesPerOctave; //transform into 0-12 scale space
+
+   for (int i = (int)mScalePitches[flip].size() - 1; i >= 0; --i)
+   {
+      if (ComputeScalePitch(flip, i) <= pitchOut)
+      {
+         pitchOut = ComputeScalePitch(flip, i);
+         break;
+      }
+   }
+
+   pitchOut += pitchesPerOctave * ((pitch - mScaleRoot) / pitchesPerOctave) + mScaleRoot; //transform back
+
+   return pitchOut;
+}
+
 
 
 
@@ -65,6 +65,8 @@ struct ScalePitches
    void SetRoot(int root);
    void SetScaleType(std::string type);
    void SetAccidentals(const std::vector<Accidental>& accidentals);
+   void UseLookup(); //bake per-pitch tables from now on, for a scale that's asked about on every note
+   void UpdateLookup(); //call when the pitches per octave change
 
    const std::vector<int>& GetPitches() const { return mScalePitches[mScalePitchesFlip]; }
    int ScaleRoot() const { return mScaleRoot; }
@@ -77,7 +79,38 @@ struct ScalePitches
    bool IsInScale(int pitch) const;
    int GetPitchFromTone(int n) const;
    int GetToneFromPitch(int pitch) const;
+   int MakeDiatonic(int pitch) const;
    int NumTonesInScale() const;
+
+private:
+   //the answers for every midi pitch, baked whenever the scale changes so that note processors don't have to work them out per note.
+   //double-buffered along with mScalePitches
+   struct PitchLookup
+   {
+      static constexpr int kNumPitches = 128;
+      enum Flags : uint8_t
+      {
+         kInScale = 1 << 0,
+         kRoot = 1 << 1,
+         kPentatonic = 1 << 2
+      };
+      std::array<uint8_t, kNumPitches> mFlags{};
+      std::array<int, kNumPitches> mDiatonic{};
+      std::array<int, kNumPitches> mToneFromPitch{};
+      std::array<int, kNumPitches> mPitchFromTone{};
+   };
+
+   void BuildLookup(int flip);
+   int ComputeScalePitch(int flip, int index) const;
+   bool ComputeIsRoot(int flip, int pitch) const;
+   bool ComputeIsInPentatonic(int flip, int pitch) const;
+   bool ComputeIsInScale(int flip, int pitch) const;
+   int ComputePitchFromTone(int flip, int n) const;
+   int ComputeToneFromPitch(int flip, int pitch) const;
+   int ComputeDiatonic(int flip, int pitch) const;
+
+   PitchLookup mLookup[2];
+   bool mUseLookup{ false };
 };
 
 class MTSClient;
@@ -163,6 +196,8 @@ private:
    float RationalizeNumber(float input);
    void UpdateTuningTable();
    float GetTuningTableRatio(int semitonesFromCenter);
+   float ComputePitchToFreq(float pitch);
+   void UpdatePitchFreqs();
    void SetRandomRootAndScale();
 
    enum IntonationMode
@@ -201,6 +236,7 @@ private:
    DropdownList* mIntonationSelector{ nullptr };
 
    std::array<float, 256> mTuningTable{};
+   std::array<float, 128> mPitchFreqs{}; //PitchToFreq() of each whole midi pitch, for everything but oddsound
 
    ChordDatabase mChordDatabase;
 
@@ -82,10 +82,73 @@ false;
 #endif
 //static
 bool ScriptModule::sHasLoadedUntrustedScript = false;
+//static
+int ScriptModule::sInterpreterGeneration = 0;
 
 //static
 ofxJSONElement ScriptModule::sStyleJSON;
 
+namespace
+{
+   const char* kCallbackNames[] = { "on_pulse", "on_note", "on_grid_button", "on_osc", "on_midi", "on_sysex" };
+   const size_t kMaxCachedMethodCalls = 64;
+
+   py::object CompileCode(const std::string& code)
+   {
+      //the same source py::exec() builds, so that line numbers in errors come out the same
+      std::string source = "# -*- coding: utf-8 -*-\n" + code;
+      PyObject* compiled = Py_CompileString(source.c_str(), "<string>", Py_file_input);
+      if (compiled == nullptr)
+         throw py::error_already_set();
+      return py::reinterpret_steal<py::object>(compiled);
+   }
+
+   void ExecCode(const py::object& compiled)
+   {
+      py::dict globals = py::globals();
+      PyObject* result = PyEval_EvalCode(compiled.ptr(), globals.ptr(), globals.ptr());
+      if (result == nullptr)
+         throw py::error_already_set();
+      Py_DECREF(result);
+   }
+}
+
+struct ScriptModule::CompiledCode
+{
+   ~CompiledCode()
+   {
+      if (mGeneration != sInterpreterGeneration || !sPythonInitialized)
+         Abandon();
+   }
+
+   //objects from an interpreter that has since been finalized can't be released, only let go of
+   void CheckGeneration()
+   {
+      if (mGeneration != sInterpreterGeneration)
+      {
+         Abandon();
+         mGeneration = sInterpreterGeneration;
+      }
+   }
+
+   void Abandon()
+   {
+      mScript.release();
+      mScriptSource.clear();
+      for (auto& methodCall : mMethodCalls)
+         methodCall.second.release();
+      mMethodCalls.clear();
+      for (auto& callback : mCallbacks)
+         callback.release();
+   }
+
+   int mGeneration{ -1 };
+   std::string mScriptSource; //the instrumented script that mScript was compiled from
+   py::object mScript;
+   std::unordered_map<std::string, py::object> mMethodCalls; //RunCode() strings, before FixUpCode()
+   std::array<py::object, kNumCallbacks> mCallbacks; //the script's on_pulse() and friends, as it last defined them
+};
+
 ScriptModule::ScriptModule()
 {
    CheckIfPythonEverSuccessfullyInitialized();
@@ -94,6 +157,8 @@ ScriptModule::ScriptModule()
 
    Reset();
 
+   mCompiledCode = std::make_unique<CompiledCode>();
+
    mScriptModuleIndex = sScriptModules.size();
    sScriptModules.push_back(this);
 
@@ -102,6 +167,7 @@ ScriptModule::ScriptModule()
 
 ScriptModule::~ScriptModule()
 {
+   sScriptModules[mScriptModuleIndex] = nullptr;
 }
 
 void ScriptModule::CreateUIControls()
@@ -148,7 +214,10 @@ void ScriptModule::CreateUIControls()
 void ScriptModule::UninitializePython()
 {
    if (sPythonInitialized)
+   {
       py::finalize_interpreter();
+      ++sInterpreterGeneration;
+   }
    sPythonInitialized = false;
 }
 
@@ -519,6 +588,14 @@ void ScriptModule::Poll()
    if (!sPythonInitialized)
       return;
 
+   unsigned long long now = ofGetSystemTimeNanos();
+   if (now - mPythonLoadWindowStart >= 1000000000ull)
+   {
+      mPythonLoad = mPythonLoadWindowStart == 0 ? 0 : (double)mPythonNanosThisWindow / (now - mPythonLoadWindowStart);
+      mPythonNanosThisWindow = 0;
+      mPythonLoadWindowStart = now;
+   }
+
    if (ScriptModule::sHasLoadedUntrustedScript)
    {
       if (TheSynth->FindModule("scriptwarning") == nullptr)
@@ -544,35 +621,7 @@ void ScriptModule::Poll()
 
    double time = gTime;
 
-   for (size_t i = 0; i < mScheduledPulseTimes.size(); ++i)
-   {
-      if (mScheduledPulseTimes[i] != -1)
-      {
-         double runTime = mScheduledPulseTimes[i];
-         mScheduledPulseTimes[i] = -1;
-         if (mLastError == "")
-         {
-            //if (runTime < time)
-            //   ofLog() << "trying to run script triggered by pulse too late!";
-            RunCode(runTime, "on_pulse()");
-         }
-      }
-   }
-
-   for (size_t i = 0; i < mPendingNoteInput.size(); ++i)
-   {
-      if (mPendingNoteInput[i].time != -1 &&
-          time + TheTransport->GetEventLookaheadMs() > mPendingNoteInput[i].time)
-      {
-         if (mLastError == "")
-         {
-            //if (mPendingNoteInput[i].time < time)
-            //   ofLog() << "trying to run script triggered by note too late!";
-            RunCode(mPendingNoteInput[i].time, "on_note(" + ofToString(mPendingNoteInput[i].pitch) + ", " + ofToString(mPendingNoteInput[i].velocity) + ")");
-         }
-         mPendingNoteInput[i].time = -1;
-      }
-   }
+   RunPendingInput();
 
    for (size_t i = 0; i < mScheduledUIControlValue.size(); ++i)
    {
@@ -622,10 +671,16 @@ void ScriptModule::Poll()
    if (mMidiMessageQueue.size() > 0)
    {
       mMidiMessageQueueMutex.lock();
-      for (std::string& methodCall : mMidiMessageQueue)
-         RunCode(gTime, methodCall);
-      mMidiMessageQueue.clear();
+      mMidiMessagesToRun.swap(mMidiMessageQueue);
       mMidiMessageQueueMutex.unlock();
+      for (const auto& message : mMidiMessagesToRun)
+      {
+         if (message.isSysEx)
+            RunCallback(gTime, kCallback_OnSysEx, py::bytes(reinterpret_cast<const char*>(message.sysex.data()), message.sysex.size()));
+         else
+            RunCallback(gTime, kCallback_OnMidi, (int)message.type, message.control, message.value, message.channel);
+      }
+      mMidiMessagesToRun.clear();
    }
 
    if (mHotloadScripts && !mLoadedScriptPath.empty())
@@ -644,6 +699,68 @@ void ScriptModule::Poll()
    }
 }
 
+void ScriptModule::RunPendingInput()
+{
+   PendingInput input;
+   while (mAudioThreadInputQueue.try_dequeue(input))
+      mPendingInput.push_back(input);
+
+   mOtherThreadInputMutex.lock();
+   mPendingInput.insert(mPendingInput.end(), mOtherThreadInput.begin(), mOtherThreadInput.end());
+   mOtherThreadInput.clear();
+   mOtherThreadInputMutex.unlock();
+
+   if (mPendingInput.empty())
+      return;
+
+   //pulses run as soon as they show up, notes wait until they're within the lookahead window
+   for (const auto& pending : mPendingInput)
+   {
+      if (pending.isPulse && mLastError == "")
+      {
+         //if (pending.time < gTime)
+         //   ofLog() << "trying to run script triggered by pulse too late!";
+         RunCallback(pending.time, kCallback_OnPulse);
+      }
+   }
+
+   size_t numStillPending = 0;
+   for (size_t i = 0; i < mPendingInput.size(); ++i)
+   {
+      const PendingInput pending = mPendingInput[i];
+      if (pending.isPulse)
+         continue;
+
+      if (gTime + TheTransport->GetEventLookaheadMs() > pending.time)
+      {
+         if (mLastError == "")
+         {
+            //if (pending.time < gTime)
+            //   ofLog() << "trying to run script triggered by note too late!";
+            RunCallback(pending.time, kCallback_OnNote, pending.pitch, pending.velocity);
+         }
+      }
+      else
+      {
+         mPendingInput[numStillPending++] = pending;
+      }
+   }
+   mPendingInput.resize(numStillPending);
+}
+
+void ScriptModule::QueueInput(const PendingInput& input)
+{
+   if (IsAudioThread())
+   {
+      mAudioThreadInputQueue.try_enqueue(input); //doesn't allocate, drops the input if the main thread has fallen far behind
+      return;
+   }
+
+   mOtherThreadInputMutex.lock();
+   mOtherThreadInput.push_back(input);
+   mOtherThreadInputMutex.unlock();
+}
+
 //static
 float ScriptModule::GetScriptMeasureTime()
 {
@@ -914,26 +1031,29 @@ void ScriptModule::oscMessageReceived(const OSCMessage& msg)
          messageString += " " + msg[i].getString().toStdString();
    }
 
-   RunCode(gTime, "on_osc(\"" + messageString + "\")");
+   RunCallback(gTime, kCallback_OnOsc, messageString);
 }
 
 void ScriptModule::SysExReceived(const uint8_t* data, int data_size)
 {
-   // Avoid code injection by preventing the sysex payload to be interpreted as Python
-   // - convert the sysex payload to hex
-   // - use bytes.fromhex in Python to parse it
-   std::ostringstream ss;
-   for (size_t i = 0; i < data_size; i++)
-      ss << std::setfill('0') << std::setw(2) << std::hex << static_cast<int>(data[i]);
+   //the payload is handed to on_sysex() as bytes, never as python source
+   QueuedMidiMessage message;
+   message.isSysEx = true;
+   message.sysex.assign(data, data + data_size);
    mMidiMessageQueueMutex.lock();
-   mMidiMessageQueue.push_back("on_sysex(bytes.fromhex('" + ss.str() + "'))");
+   mMidiMessageQueue.push_back(std::move(message));
    mMidiMessageQueueMutex.unlock();
 }
 
 void ScriptModule::MidiReceived(MidiMessageType messageType, int control, float value, int channel)
 {
+   QueuedMidiMessage message;
+   message.type = messageType;
+   message.control = control;
+   message.value = value;
+   message.channel = channel;
    mMidiMessageQueueMutex.lock();
-   mMidiMessageQueue.push_back("on_midi(" + ofToString((int)messageType) + ", " + ofToString(control) + ", " + ofToString(value) + ", " + ofToString(channel) + ")");
+   mMidiMessageQueue.push_back(std::move(message));
    mMidiMessageQueueMutex.unlock();
 }
 
@@ -1138,29 +1258,20 @@ void ScriptModule::OnCodeUpdated()
 
 void ScriptModule::OnPulse(double time, float velocity, int flags)
 {
-   for (size_t i = 0; i < mScheduledPulseTimes.size(); ++i)
-   {
-      if (mScheduledPulseTimes[i] == -1)
-      {
-         mScheduledPulseTimes[i] = time;
-         break;
-      }
-   }
+   PendingInput input;
+   input.time = time;
+   input.isPulse = true;
+   QueueInput(input);
 }
 
 //INoteReceiver
 void ScriptModule::PlayNote(NoteMessage note)
 {
-   for (size_t i = 0; i < mPendingNoteInput.size(); ++i)
-   {
-      if (mPendingNoteInput[i].time == -1)
-      {
-         mPendingNoteInput[i].time = note.time;
-         mPendingNoteInput[i].pitch = note.pitch;
-         mPendingNoteInput[i].velocity = note.velocity;
-         break;
-      }
-   }
+   PendingInput input;
+   input.time = note.time;
+   input.pitch = note.pitch;
+   input.velocity = note.velocity;
+   QueueInput(input);
 }
 
 std::string ScriptModule::GetThisName()
@@ -1179,7 +1290,7 @@ std::pair<int, int> ScriptModule::RunScript(double time, int lineStart /*=-1*/,
       return std::make_pair(0, 0);
    }
 
-   py::exec(GetThisName() + " = scriptmodule.get_me(" + ofToString(mScriptModuleIndex) + ")", py::globals());
+   py::globals()[GetThisName().c_str()] = py::module::import("scriptmodule").attr("get_me")(mScriptModuleIndex);
    std::string code = mCodeEntry->GetText(true);
    std::vector<std::string> lines = ofSplitString(code, "\n");
 
@@ -1219,18 +1330,32 @@ std::pair<int, int> ScriptModule::RunScript(double time, int lineStart /*=-1*/,
    FixUpCode(code);
    mLastRunLiteralCode = code;
 
-   RunCode(time, code);
+   //the method prefix goes into compiled calls, and it changes if the module is renamed
+   mCompiledCode->CheckGeneration();
+   mCompiledCode->mMethodCalls.clear();
+
+   RunPython(time, "RunScript", [this, &code]()
+             {
+                if (!mCompiledCode->mScript || mCompiledCode->mScriptSource != code)
+                {
+                   mCompiledCode->mScript = CompileCode(code);
+                   mCompiledCode->mScriptSource = code;
+                }
+                ExecCode(mCompiledCode->mScript);
+             });
+   UpdateCallbacks();
 
    return std::make_pair(executionStartLine, executionEndLine);
 }
 
-void ScriptModule::RunCode(double time, std::string code)
+template <typename T>
+void ScriptModule::RunPython(double time, const char* caller, T&& run)
 {
    //should only be called from main thread
 
    if (!sPythonInitialized)
    {
-      TheSynth->LogEvent("trying to call ScriptModule::RunCode() before python is initialized", kLogEventType_Error);
+      TheSynth->LogEvent("trying to call ScriptModule::" + std::string(caller) + "() before python is initialized", kLogEventType_Error);
       return;
    }
 
@@ -1245,10 +1370,10 @@ void ScriptModule::RunCode(double time, std::string code)
    ComputeSliders(0);
    sPriorExecutedModule = nullptr;
 
+   unsigned long long startNanos = ofGetSystemTimeNanos();
    try
    {
-      FixUpCode(code);
-      py::exec(code, py::globals());
+      run();
 
       mCodeEntry->SetError(false);
       mLastError = "";
@@ -1299,6 +1424,68 @@ void ScriptModule::RunCode(double time, std::string code)
    {
       ofLog() << "python execution exception: " << e.what();
    }
+   mPythonNanosThisWindow += ofGetSystemTimeNanos() - startNanos;
+}
+
+void ScriptModule::RunCode(double time, std::string code)
+{
+   RunPython(time, "RunCode", [this, &code]()
+             {
+                mCompiledCode->CheckGeneration();
+                auto& methodCalls = mCompiledCode->mMethodCalls;
+                auto methodCall = methodCalls.find(code);
+                if (methodCall == methodCalls.end())
+                {
+                   //calls with their arguments baked in can be a new string every time, so this doesn't grow forever
+                   if (methodCalls.size() >= kMaxCachedMethodCalls)
+                      methodCalls.clear();
+                   std::string fixedUpCode = code;
+                   FixUpCode(fixedUpCode);
+                   methodCall = methodCalls.emplace(code, CompileCode(fixedUpCode)).first;
+                }
+                ExecCode(methodCall->second);
+             });
+}
+
+template <typename... Args>
+void ScriptModule::RunCallback(double time, Callback callback, Args... args)
+{
+   mCompiledCode->CheckGeneration();
+   const py::object& function = mCompiledCode->mCallbacks[callback];
+   if (!function)
+   {
+      //the script doesn't define it (or hasn't run yet). calling it by name reports that the way it always has
+      RunCode(time, std::string(kCallbackNames[callback]) + "()");
+      return;
+   }
+
+   RunPython(time, "RunCallback", [&]()
+             {
+                function(args...);
+             });
+}
+
+void ScriptModule::RunGridButtonCallback(double time, int x, int y, float velocity)
+{
+   RunCallback(time, kCallback_OnGridButton, x, y, velocity);
+}
+
+void ScriptModule::UpdateCallbacks()
+{
+   if (!sPythonInitialized)
+      return;
+
+   mCompiledCode->CheckGeneration();
+   std::string prefix = GetMethodPrefix();
+   py::dict globals = py::globals();
+   for (int i = 0; i < kNumCallbacks; ++i)
+   {
+      std::string name = std::string(kCallbackNames[i]) + "__" + prefix;
+      if (globals.contains(name))
+         mCompiledCode->mCallbacks[i] = globals[name.c_str()];
+      else
+         mCompiledCode->mCallbacks[i] = py::object();
+   }
 }
 
 std::string ScriptModule::GetMethodPrefix()
@@ -1444,9 +1631,6 @@ void ScriptModule::Stop()
 
 void ScriptModule::Reset()
 {
-   for (size_t i = 0; i < mScheduledPulseTimes.size(); ++i)
-      mScheduledPulseTimes[i] = -1;
-
    for (size_t i = 0; i < mScheduledNoteOutput.size(); ++i)
       mScheduledNoteOutput[i].time = -1;
 
@@ -1456,8 +1640,14 @@ void ScriptModule::Reset()
    for (size_t i = 0; i < mScheduledUIControlValue.size(); ++i)
       mScheduledUIControlValue[i].time = -1;
 
-   for (size_t i = 0; i < mPendingNoteInput.size(); ++i)
-      mPendingNoteInput[i].time = -1;
+   PendingInput input;
+   while (mAudioThreadInputQueue.try_dequeue(input))
+   {
+   }
+   mOtherThreadInputMutex.lock();
+   mOtherThreadInput.clear();
+   mOtherThreadInputMutex.unlock();
+   mPendingInput.clear();
 
    for (size_t i = 0; i < mPrintDisplay.size(); ++i)
       mPrintDisplay[i].time = -1;
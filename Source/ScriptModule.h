@@ -37,6 +37,7 @@
 #include "DropdownList.h"
 #include "ModulationChain.h"
 #include "MidiController.h"
+#include "readerwriterqueue.h"
 
 #include "juce_osc/juce_osc.h"
 
@@ -77,8 +78,10 @@ public:
    void SetContext();
    void ClearContext();
    bool IsScriptTrusted() const { return !mIsScriptUntrusted; }
+   double GetPythonLoad() const { return mPythonLoad; } //fraction of the main thread this script's python took, over the last second
 
    void RunCode(double time, std::string code);
+   void RunGridButtonCallback(double time, int x, int y, float velocity);
 
    void OnPulse(double time, float velocity, int flags) override;
    void ButtonClicked(ClickButton* button, double time) override;
@@ -134,7 +137,25 @@ private:
    void AdjustUIControl(IUIControl* control, float value, double time, int lineNum);
    std::pair<int, int> RunScript(double time, int lineStart = -1, int lineEnd = -1);
    void FixUpCode(std::string& code);
+   template <typename T>
+   void RunPython(double time, const char* caller, T&& run);
+   enum Callback
+   {
+      kCallback_OnPulse,
+      kCallback_OnNote,
+      kCallback_OnGridButton,
+      kCallback_OnOsc,
+      kCallback_OnMidi,
+      kCallback_OnSysEx,
+      kNumCallbacks
+   };
+   template <typename... Args>
+   void RunCallback(double time, Callback callback, Args... args);
+   void UpdateCallbacks();
    void ScheduleNote(double time, float pitch, float velocity, float pan, int noteOutputIndex);
+   struct PendingInput;
+   void QueueInput(const PendingInput& input);
+   void RunPendingInput();
    void SendNoteToIndex(int index, NoteMessage note);
    std::string GetThisName();
    std::string GetIndentation(std::string line);
@@ -185,7 +206,6 @@ private:
    float mC{ 0 };
    float mD{ 0 };
 
-   std::array<double, 20> mScheduledPulseTimes{};
    std::string mLastError;
    size_t mScriptModuleIndex;
    std::string mLastRunLiteralCode;
@@ -225,13 +245,19 @@ private:
    };
    std::array<ScheduledUIControlValue, 50> mScheduledUIControlValue;
 
-   struct PendingNoteInput
+   //pulses and notes that arrive on the audio thread are handed to the main thread through a lock-free queue,
+   //and python runs from Poll(), so a slow script never holds up the audio thread
+   struct PendingInput
    {
       double time{ 0 };
+      bool isPulse{ false };
       int pitch{ 0 };
       int velocity{ 0 };
    };
-   std::array<PendingNoteInput, 50> mPendingNoteInput;
+   moodycamel::ReaderWriterQueue<PendingInput> mAudioThreadInputQueue{ 256 };
+   std::vector<PendingInput> mOtherThreadInput;
+   ofMutex mOtherThreadInputMutex;
+   std::vector<PendingInput> mPendingInput; //main thread only
 
    struct PrintDisplay
    {
@@ -294,9 +320,28 @@ private:
    std::array<ModulationChain, 128> mPitchBends{ ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend, ModulationParameters::kDefaultPitchBend };
    std::array<ModulationChain, 128> mModWheels{ ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel, ModulationParameters::kDefaultModWheel };
    std::array<ModulationChain, 128> mPressures{ ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure, ModulationParameters::kDefaultPressure };
-   std::list<std::string> mMidiMessageQueue;
+   struct QueuedMidiMessage
+   {
+      bool isSysEx{ false };
+      MidiMessageType type{ kMidiMessage_Note };
+      int control{ 0 };
+      float value{ 0 };
+      int channel{ 0 };
+      std::vector<uint8_t> sysex;
+   };
+   std::vector<QueuedMidiMessage> mMidiMessageQueue;
+   std::vector<QueuedMidiMessage> mMidiMessagesToRun; //main thread only
    ofMutex mMidiMessageQueueMutex;
 
+   //python objects for the script and its callbacks, so that source is only parsed when it changes
+   struct CompiledCode;
+   std::unique_ptr<CompiledCode> mCompiledCode;
+   static int sInterpreterGeneration;
+
+   unsigned long long mPythonNanosThisWindow{ 0 };
+   unsigned long long mPythonLoadWindowStart{ 0 };
+   double mPythonLoad{ 0 };
+
    bool mShowJediWarning{ false };
 };
 
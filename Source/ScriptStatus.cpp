@@ -79,8 +79,19 @@ void ScriptStatus::Poll()
 
    if (gTime > mNextUpdateTime)
    {
-      mStatus = py::str(py::globals());
-      ofStringReplace(mStatus, ",", "\n");
+      //every script shares the one interpreter and its lock, so this is where to look when scripts run late
+      std::string load;
+      for (auto* script : ScriptModule::sScriptModules)
+      {
+         if (script != nullptr && script->GetPythonLoad() > 0)
+            load += script->Path() + ": " + ofToString(script->GetPythonLoad() * 100, 1) + "%\n";
+      }
+      if (!load.empty())
+         load = "main thread time in python:\n" + load + "\n";
+
+      std::string globals = py::str(py::globals());
+      ofStringReplace(globals, ",", "\n");
+      mStatus = load + globals;
       mNextUpdateTime = gTime + 100;
    }
 }
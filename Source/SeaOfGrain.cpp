@@ -101,6 +101,7 @@ void SeaOfGrain::CreateUIControls()
       mManualVoices[i].mGainSlider = new FloatSlider(this, ("gain " + ofToString(i + 1)).c_str(), mManualVoices[i].mEnabledCheckbox, kAnchor_Below, 120, 15, &mManualVoices[i].mGain, 0, 1);
       mManualVoices[i].mPositionSlider = new FloatSlider(this, ("pos " + ofToString(i + 1)).c_str(), mManualVoices[i].mGainSlider, kAnchor_Below, 120, 15, &mManualVoices[i].mPosition, 0, 1);
       mManualVoices[i].mOverlapSlider = new FloatSlider(this, ("overlap " + ofToString(i + 1)).c_str(), mManualVoices[i].mPositionSlider, kAnchor_Below, 120, 15, &mManualVoices[i].mGranulator.mGrainOverlap, .25, MAX_GRAINS);
+      mManualVoices[i].mOverlapSlider->SetMode(FloatSlider::kLogarithmic);
       mManualVoices[i].mSpeedSlider = new FloatSlider(this, ("speed " + ofToString(i + 1)).c_str(), mManualVoices[i].mOverlapSlider, kAnchor_Below, 120, 15, &mManualVoices[i].mGranulator.mSpeed, -3, 3);
       mManualVoices[i].mLengthMsSlider = new FloatSlider(this, ("len ms " + ofToString(i + 1)).c_str(), mManualVoices[i].mSpeedSlider, kAnchor_Below, 120, 15, &mManualVoices[i].mGranulator.mGrainLengthMs, 1, 1000);
       mManualVoices[i].mPosRandomizeSlider = new FloatSlider(this, ("pos r " + ofToString(i + 1)).c_str(), mManualVoices[i].mLengthMsSlider, kAnchor_Below, 120, 15, &mManualVoices[i].mGranulator.mPosRandomizeMs, 0, 200);
@@ -159,17 +160,17 @@ void SeaOfGrain::Process(double time)
          mRecordBuffer.WriteChunk(GetBuffer()->GetChannel(ch), bufferSize, ch);
    }
 
-   gWorkChannelBuffer.SetNumActiveChannels(numChannels);
-   gWorkChannelBuffer.Clear();
+   gWorkChannelBuffer->SetNumActiveChannels(numChannels);
+   gWorkChannelBuffer->Clear();
    for (int i = 0; i < kNumMPEVoices; ++i)
-      mMPEVoices[i].Process(&gWorkChannelBuffer, bufferSize);
+      mMPEVoices[i].Process(gWorkChannelBuffer, bufferSize);
    for (int i = 0; i < kNumManualVoices; ++i)
-      mManualVoices[i].Process(&gWorkChannelBuffer, bufferSize);
+      mManualVoices[i].Process(gWorkChannelBuffer, bufferSize);
    for (int ch = 0; ch < numChannels; ++ch)
    {
-      Mult(gWorkChannelBuffer.GetChannel(ch), mVolume, bufferSize);
-      GetVizBuffer()->WriteChunk(gWorkChannelBuffer.GetChannel(ch), bufferSize, ch);
-      Add(out->GetChannel(ch), gWorkChannelBuffer.GetChannel(ch), bufferSize);
+      Mult(gWorkChannelBuffer->GetChannel(ch), mVolume, bufferSize);
+      GetVizBuffer()->WriteChunk(gWorkChannelBuffer->GetChannel(ch), bufferSize, ch);
+      Add(out->GetChannel(ch), gWorkChannelBuffer->GetChannel(ch), bufferSize);
    }
 
    GetBuffer()->Reset();
@@ -290,6 +291,14 @@ int SeaOfGrain::GetSampleNumChannels()
    return mSample->NumChannels();
 }
 
+void SeaOfGrain::PrepareGrainBuffer(float** channels)
+{
+   mGrainBuffer.SetNumActiveChannels(ChannelBuffer::kMaxNumChannels);
+   mGrainBuffer.Clear();
+   for (int ch = 0; ch < ChannelBuffer::kMaxNumChannels; ++ch)
+      channels[ch] = mGrainBuffer.GetChannel(ch);
+}
+
 void SeaOfGrain::FilesDropped(std::vector<std::string> files, int x, int y)
 {
    mLoading = true;
@@ -400,6 +409,11 @@ void SeaOfGrain::CheckboxUpdated(Checkbox* checkbox, double time)
    }
 }
 
+size_t SeaOfGrain::GetMemoryUsage() const
+{
+   return mRecordBuffer.GetMemoryUsage() + mGrainBuffer.GetMemoryUsage() + (mSample != nullptr ? mSample->GetMemoryUsage() : 0);
+}
+
 void SeaOfGrain::GetModuleDimensions(float& width, float& height)
 {
    width = mBufferW + 10;
@@ -517,27 +531,40 @@ void SeaOfGrain::GrainMPEVoice::Process(ChannelBuffer* output, int bufferSize)
    {
       double time = gTime;
       float speed = mOwner->GetSampleRateRatio();
-      for (int i = 0; i < bufferSize; ++i)
+
+      //grain parameters follow the modulation once per block
+      float pressure = mPressure ? mPressure->GetValue(0) : ModulationParameters::kDefaultPressure;
+      float modwheel = mModWheel ? mModWheel->GetValue(0) : ModulationParameters::kDefaultModWheel;
+      if (pressure > 0)
+      {
+         mGranulator.mGrainOverlap = ofMap(pressure * pressure, 0, 1, 3, Granulator::kReferenceOverlap);
+         mGranulator.mPosRandomizeMs = ofMap(pressure * pressure, 0, 1, 100, .03f);
+      }
+      mGranulator.mGrainLengthMs = ofMap(modwheel, -1, 1, 10, 700);
+
+      //the spawn position glides from where it is at the start of the block to where it is at the end
+      auto getOffset = [this](int i)
       {
          float pitchBend = mPitchBend ? mPitchBend->GetValue(i) : ModulationParameters::kDefaultPitchBend;
-         float pressure = mPressure ? mPressure->GetValue(i) : ModulationParameters::kDefaultPressure;
-         float modwheel = mModWheel ? mModWheel->GetValue(i) : ModulationParameters::kDefaultModWheel;
-         if (pressure > 0)
-         {
-            mGranulator.mGrainOverlap = ofMap(pressure * pressure, 0, 1, 3, MAX_GRAINS);
-            mGranulator.mPosRandomizeMs = ofMap(pressure * pressure, 0, 1, 100, .03f);
-         }
-         mGranulator.mGrainLengthMs = ofMap(modwheel, -1, 1, 10, 700);
+         float pos = (mPitch + pitchBend + MIN(.125f, mPlay + i * .001f) - mOwner->mKeyboardBasePitch) / mOwner->mKeyboardNumPitches;
+         return ofLerp(mOwner->GetSourceStartSample(), mOwner->GetSourceEndSample(), pos) + mOwner->GetSourceBufferOffset();
+      };
+      double offset = getOffset(0);
+      double offsetIncrement = bufferSize > 1 ? (getOffset(bufferSize - 1) - offset) / (bufferSize - 1) : 0;
+
+      float* grains[ChannelBuffer::kMaxNumChannels]{};
+      mOwner->PrepareGrainBuffer(grains);
+      mGranulator.Process(time, mOwner->GetSourceBuffer(), mOwner->GetSourceBuffer()->BufferSize(), offset, offsetIncrement, speed, grains, bufferSize);
 
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         pressure = mPressure ? mPressure->GetValue(i) : ModulationParameters::kDefaultPressure;
          float blend = .0005f;
          mGain = mGain * (1 - blend) + pressure * blend;
 
-         float outSample[ChannelBuffer::kMaxNumChannels];
-         Clear(outSample, ChannelBuffer::kMaxNumChannels);
-         float pos = (mPitch + pitchBend + MIN(.125f, mPlay) - mOwner->mKeyboardBasePitch) / mOwner->mKeyboardNumPitches;
-         mGranulator.ProcessFrame(time, mOwner->GetSourceBuffer(), mOwner->GetSourceBuffer()->BufferSize(), ofLerp(mOwner->GetSourceStartSample(), mOwner->GetSourceEndSample(), pos) + mOwner->GetSourceBufferOffset(), speed, outSample);
+         float gain = sqrtf(mGain) * mADSR.Value(time);
          for (int ch = 0; ch < output->NumActiveChannels(); ++ch)
-            output->GetChannel(ch)[i] += outSample[mOwner->GetSampleNumChannels() == 1 ? 0 : ch] * sqrtf(mGain) * mADSR.Value(time);
+            output->GetChannel(ch)[i] += grains[mOwner->GetSampleNumChannels() == 1 ? 0 : ch][i] * gain;
 
          time += gInvSampleRateMs;
          mPlay += .001f;
@@ -589,14 +616,18 @@ void SeaOfGrain::GrainManualVoice::Process(ChannelBuffer* output, int bufferSize
       float panLeft = GetLeftPanGain(mPan);
       float panRight = GetRightPanGain(mPan);
       float speed = mOwner->GetSampleRateRatio();
-      for (int i = 0; i < bufferSize; ++i)
+      double offset = ofLerp(mOwner->GetSourceStartSample(), mOwner->GetSourceEndSample(), mPosition) + mOwner->GetSourceBufferOffset();
+
+      float* grains[ChannelBuffer::kMaxNumChannels]{};
+      mOwner->PrepareGrainBuffer(grains);
+      mGranulator.Process(time, mOwner->GetSourceBuffer(), mOwner->GetSourceBuffer()->BufferSize(), offset, 0, speed, grains, bufferSize);
+
+      for (int ch = 0; ch < output->NumActiveChannels(); ++ch)
       {
-         float outSample[ChannelBuffer::kMaxNumChannels];
-         Clear(outSample, ChannelBuffer::kMaxNumChannels);
-         mGranulator.ProcessFrame(time, mOwner->GetSourceBuffer(), mOwner->GetSourceBuffer()->BufferSize(), ofLerp(mOwner->GetSourceStartSample(), mOwner->GetSourceEndSample(), mPosition) + mOwner->GetSourceBufferOffset(), speed, outSample);
-         for (int ch = 0; ch < output->NumActiveChannels(); ++ch)
-            output->GetChannel(ch)[i] += outSample[mOwner->GetSampleNumChannels() == 1 ? 0 : ch] * mGain * mLastInputVelocity * (ch == 0 ? panLeft : panRight);
-         time += gInvSampleRateMs;
+         float gain = mGain * mLastInputVelocity * (ch == 0 ? panLeft : panRight);
+         const float* source = grains[mOwner->GetSampleNumChannels() == 1 ? 0 : ch];
+         for (int i = 0; i < bufferSize; ++i)
+            output->GetChannel(ch)[i] += source[i] * gain;
       }
    }
    else
@@ -56,6 +56,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //can record its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    //IDrawableModule
@@ -88,6 +89,7 @@ public:
    int GetModuleSaveStateRev() const override { return 1; }
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override;
 
 private:
    void UpdateSample();
@@ -105,6 +107,7 @@ private:
    float GetSourceEndSample();
    float GetSourceBufferOffset();
    int GetSampleNumChannels();
+   void PrepareGrainBuffer(float** channels);
 
    struct GrainMPEVoice
    {
@@ -161,6 +164,7 @@ private:
 
    Sample* mSample{ nullptr };
    RollingBuffer mRecordBuffer;
+   ChannelBuffer mGrainBuffer{ gBufferSize }; //voices render their grains into this one at a time
 
    ClickButton* mLoadButton{ nullptr };
    bool mRecordInput{ false };
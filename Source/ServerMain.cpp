@@ -0,0 +1,313 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    ServerMain.cpp
+    Created: 14 Oct 2026
+
+    entry point for bespoke-server, which runs the synth on the audio device without a window,
+    and serves its ui to remote clients over a websocket (see RemoteUIServer.h)
+
+  ==============================================================================
+*/
+
+#include "AudioThreadPolicy.h"
+#include "ModularSynth.h"
+#include "RemoteUIServer.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+
+#include "juce_audio_devices/juce_audio_devices.h"
+#include "juce_audio_formats/juce_audio_formats.h"
+#include "juce_data_structures/juce_data_structures.h"
+#include "juce_gui_basics/juce_gui_basics.h"
+
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+   std::unique_ptr<juce::ApplicationProperties> sAppProperties;
+   std::atomic<bool> sQuit{ false };
+
+   struct ServerOptions
+   {
+      int mPort{ RemoteUIServer::kDefaultPort };
+      std::string mBindAddress{ "127.0.0.1" };
+      std::vector<std::string> mAllowedOrigins;
+      std::string mToken;
+      std::string mLoadPath;
+      int mWidth{ 1280 };
+      int mHeight{ 800 };
+   };
+
+   void PrintUsage()
+   {
+      std::cout << "Runs bespoke on the audio device in userprefs.json without a window, and serves its ui over a websocket.\n"
+                << "\n"
+                << "Usage: bespoke-server [OPTIONS] [file.bsk]\n"
+                << "\n"
+                << "Options:\n"
+                << "  --port <port>           port to listen on (default " << RemoteUIServer::kDefaultPort << ")\n"
+                << "  --bind <address>        address to listen on (default 127.0.0.1, this machine only). 0.0.0.0 for every interface\n"
+                << "  --allow-origin <origin> let pages from this origin connect, as well as ones served from this machine. can be repeated\n"
+                << "  --token <token>         token clients have to send to connect (default a new random one, printed at startup)\n"
+                << "  --size <width>x<height> canvas size until a client sends its own (default 1280x800)\n"
+                << "  -h, --help              show this help\n";
+   }
+
+   bool ParseOptions(int argc, char* argv[], ServerOptions& options)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         juce::String argument = argv[i];
+         bool hasValue = i + 1 < argc;
+         if (argument == "-h" || argument == "--help")
+         {
+            PrintUsage();
+            return false;
+         }
+         else if (argument == "--port" && hasValue)
+         {
+            options.mPort = juce::String(argv[++i]).getIntValue();
+         }
+         else if (argument == "--bind" && hasValue)
+         {
+            options.mBindAddress = argv[++i];
+         }
+         else if (argument == "--allow-origin" && hasValue)
+         {
+            options.mAllowedOrigins.push_back(argv[++i]);
+         }
+         else if (argument == "--token" && hasValue)
+         {
+            options.mToken = argv[++i];
+         }
+         else if (argument == "--size" && hasValue)
+         {
+            juce::String size = argv[++i];
+            options.mWidth = size.upToFirstOccurrenceOf("x", false, true).getIntValue();
+            options.mHeight = size.fromFirstOccurrenceOf("x", false, true).getIntValue();
+         }
+         else if ((argument.endsWith(".bsk") || argument.endsWith(".bskt")) && options.mLoadPath.empty())
+         {
+            options.mLoadPath = argument.toStdString();
+         }
+         else
+         {
+            std::cerr << "unknown or incomplete option " << argument << "\n\n";
+            PrintUsage();
+            return false;
+         }
+      }
+
+      if (options.mPort <= 0 || options.mPort > 65535 || options.mWidth <= 0 || options.mHeight <= 0)
+      {
+         PrintUsage();
+         return false;
+      }
+      return true;
+   }
+
+   class ServerAudioCallback : public juce::AudioIODeviceCallback
+   {
+   public:
+      explicit ServerAudioCallback(ModularSynth& synth)
+      : mSynth(synth)
+      {
+      }
+
+      void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                            int numInputChannels,
+                                            float* const* outputChannelData,
+                                            int numOutputChannels,
+                                            int numSamples,
+                                            const juce::AudioIODeviceCallbackContext& context) override
+      {
+         juce::ignoreUnused(context);
+         if (mSynth.IsRenderingOffline())
+         {
+            for (int ch = 0; ch < numOutputChannels; ++ch)
+               juce::FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+            return;
+         }
+
+         static thread_local bool sConfiguredThread = false;
+         if (!sConfiguredThread)
+         {
+            AudioThreadPolicy::ConfigureAudioThread();
+            sConfiguredThread = true;
+         }
+
+         mSynth.AudioIn(inputChannelData, numSamples, numInputChannels);
+         mSynth.AudioOut(outputChannelData, numSamples, numOutputChannels);
+      }
+
+      void audioDeviceAboutToStart(juce::AudioIODevice* device) override {}
+      void audioDeviceStopped() override {}
+
+   private:
+      ModularSynth& mSynth;
+   };
+
+   //the message loop runs the synth's polling, like MainContentComponent's timer does without the drawing
+   class ServerPoller : public juce::Timer
+   {
+   public:
+      ServerPoller(ModularSynth& synth, RemoteUIServer& server)
+      : mSynth(synth)
+      , mServer(server)
+      {
+         startTimerHz(60);
+      }
+
+      void timerCallback() override
+      {
+         if (sQuit)
+         {
+            stopTimer();
+            juce::MessageManager::getInstance()->stopDispatchLoop();
+            return;
+         }
+
+         mSynth.Poll();
+         mServer.Poll();
+      }
+
+   private:
+      ModularSynth& mSynth;
+      RemoteUIServer& mServer;
+   };
+
+   int CountChannels(const juce::BigInteger& channels)
+   {
+      int count = 0;
+      for (juce::int64 mask = channels.toInteger(); mask != 0; mask >>= 1)
+         ++count;
+      return count;
+   }
+}
+
+//VSTScanner.cpp uses this, the app defines it in Main.cpp
+juce::ApplicationProperties& getAppProperties()
+{
+   return *sAppProperties;
+}
+
+int main(int argc, char* argv[])
+{
+   ServerOptions options;
+   if (!ParseOptions(argc, argv, options))
+      return 1;
+
+   std::signal(SIGINT, [](int)
+               { sQuit = true; });
+   std::signal(SIGTERM, [](int)
+               { sQuit = true; });
+#if !JUCE_WINDOWS
+   std::signal(SIGPIPE, SIG_IGN); //a client going away mid write shouldn't take the server with it
+#endif
+
+   juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+   juce::PropertiesFile::Options propertiesOptions;
+   propertiesOptions.applicationName = "Bespoke Synth";
+   propertiesOptions.filenameSuffix = "settings";
+   propertiesOptions.osxLibrarySubFolder = "Preferences";
+   sAppProperties = std::make_unique<juce::ApplicationProperties>();
+   sAppProperties->setStorageParameters(propertiesOptions);
+
+   {
+      //the same bring up as MainContentComponent, minus the window and the gl context.
+      //the canvas is never shown, it only gives the synth a size to lay its ui out in
+      auto synth = std::make_unique<ModularSynth>();
+      juce::AudioDeviceManager deviceManager;
+      juce::AudioFormatManager formatManager;
+      juce::Component canvas;
+      canvas.setSize(options.mWidth, options.mHeight);
+
+      UserPrefs.Init();
+      if (UserPrefs.devicetype.Get() != "auto")
+         deviceManager.setCurrentAudioDeviceType(UserPrefs.devicetype.Get(), true);
+      SetGlobalSampleRateAndBufferSize(UserPrefs.samplerate.Get(), UserPrefs.buffersize.Get());
+      synth->Setup(&deviceManager, &formatManager, &canvas, nullptr);
+      if (!options.mLoadPath.empty())
+         synth->SetStartupSaveStateFile(juce::File::getCurrentWorkingDirectory().getChildFile(options.mLoadPath).getFullPathName().toStdString());
+
+      std::string inputDevice = UserPrefs.audio_input_device.Get();
+      std::string outputDevice = UserPrefs.audio_output_device.Get();
+      juce::AudioDeviceManager::AudioDeviceSetup setup;
+      setup.sampleRate = gSampleRate / UserPrefs.oversampling.Get();
+      setup.bufferSize = gIOBufferSize / UserPrefs.oversampling.Get();
+      if (outputDevice != "auto" && outputDevice != "none")
+         setup.outputDeviceName = outputDevice;
+      if (inputDevice != "auto" && inputDevice != "none")
+         setup.inputDeviceName = inputDevice;
+      juce::String audioError = deviceManager.initialise(inputDevice == "none" ? 0 : UserPrefs.max_input_channels.Get(),
+                                                         outputDevice == "none" ? 0 : UserPrefs.max_output_channels.Get(),
+                                                         nullptr, true, "", &setup);
+      if (audioError.isNotEmpty() || deviceManager.getCurrentAudioDevice() == nullptr)
+      {
+         std::cerr << "couldn't open the audio device: " << audioError << "\n";
+         return 1;
+      }
+
+      auto loadedSetup = deviceManager.getAudioDeviceSetup();
+      if (loadedSetup.sampleRate != setup.sampleRate || loadedSetup.bufferSize != setup.bufferSize)
+      {
+         std::cerr << "the audio device is running at " << loadedSetup.sampleRate << " hz with a buffer size of " << loadedSetup.bufferSize
+                   << ", fix samplerate and buffersize in userprefs.json to match\n";
+         return 1;
+      }
+      synth->InitIOBuffers(CountChannels(loadedSetup.inputChannels), CountChannels(loadedSetup.outputChannels));
+
+      ServerAudioCallback audioCallback(*synth);
+      deviceManager.addAudioCallback(&audioCallback);
+
+      RemoteUIServer server(&canvas);
+      std::string token = options.mToken.empty() ? RemoteUIServer::GenerateToken() : options.mToken;
+      server.SetToken(token);
+      for (const auto& origin : options.mAllowedOrigins)
+         server.AllowOrigin(origin);
+      if (!server.Listen(options.mPort, options.mBindAddress))
+      {
+         std::cerr << "couldn't listen on " << options.mBindAddress << ":" << options.mPort << "\n";
+         deviceManager.removeAudioCallback(&audioCallback);
+         return 1;
+      }
+      std::cerr << "playing on " << loadedSetup.outputDeviceName << ", serving the ui on ws://" << options.mBindAddress << ":" << options.mPort << "\n"
+                << "token: " << token << "\n";
+
+      {
+         ServerPoller poller(*synth, server);
+         juce::MessageManager::getInstance()->runDispatchLoop();
+      }
+
+      server.Stop();
+      deviceManager.removeAudioCallback(&audioCallback);
+      deviceManager.closeAudioDevice();
+   }
+
+   sAppProperties.reset();
+   return 0;
+}
@@ -0,0 +1,144 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SidechainBus.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SidechainBus.h"
+#include "IAudioSource.h"
+#include "IDrawableModule.h"
+#include "SynthGlobals.h"
+
+//static
+SidechainBus& SidechainBus::Get()
+{
+   static SidechainBus sBus;
+   return sBus;
+}
+
+SidechainBus::Channel* SidechainBus::GetChannel(const std::string& name)
+{
+   for (auto& channel : mChannels)
+   {
+      if (channel.mName == name)
+         return &channel;
+   }
+   mChannels.emplace_back();
+   mChannels.back().mName = name;
+   return &mChannels.back();
+}
+
+SidechainBus::Channel* SidechainBus::SetProducer(IDrawableModule* producer, const std::string& name)
+{
+   for (auto& channel : mChannels)
+   {
+      if (channel.mProducer == producer)
+      {
+         channel.mProducer = nullptr;
+         channel.mBuffer = nullptr;
+         channel.mEnvelope = nullptr;
+         channel.mPublishedTime = -1;
+      }
+   }
+
+   if (name.empty())
+      return nullptr;
+
+   Channel* channel = GetChannel(name);
+   if (channel->mProducer != nullptr)
+      return nullptr;
+   channel->mProducer = producer;
+   return channel;
+}
+
+SidechainBus::Channel* SidechainBus::Subscribe(IDrawableModule* subscriber, const std::string& name)
+{
+   for (auto iter = mSubscriptions.begin(); iter != mSubscriptions.end();)
+   {
+      if (iter->first == subscriber)
+         iter = mSubscriptions.erase(iter);
+      else
+         ++iter;
+   }
+
+   if (name.empty())
+      return nullptr;
+
+   Channel* channel = GetChannel(name);
+   mSubscriptions.push_back(std::make_pair(subscriber, channel));
+   return channel;
+}
+
+void SidechainBus::RemoveModule(IDrawableModule* module)
+{
+   SetProducer(module, "");
+   Subscribe(module, "");
+}
+
+//static
+IAudioSource* SidechainBus::GetAudioSource(IDrawableModule* module)
+{
+   //effects are processed by the effect chain they're in, so that's what has to be ordered
+   for (IClickable* clickable = module; clickable != nullptr; clickable = clickable->GetParent())
+   {
+      IAudioSource* source = dynamic_cast<IAudioSource*>(clickable);
+      if (source != nullptr)
+         return source;
+   }
+   return nullptr;
+}
+
+void SidechainBus::GetDependencies(std::vector<std::pair<IAudioSource*, IAudioSource*>>& dependencies) const
+{
+   for (const auto& subscription : mSubscriptions)
+   {
+      if (subscription.second->mProducer == nullptr)
+         continue;
+      IAudioSource* producer = GetAudioSource(subscription.second->mProducer);
+      IAudioSource* consumer = GetAudioSource(subscription.first);
+      if (producer != nullptr && consumer != nullptr && producer != consumer)
+         dependencies.push_back(std::make_pair(producer, consumer));
+   }
+}
+
+//static
+void SidechainBus::Publish(Channel* channel, ChannelBuffer* buffer, const float* envelope, double time)
+{
+   if (channel == nullptr)
+      return;
+   channel->mBuffer.store(buffer, std::memory_order_relaxed);
+   channel->mEnvelope.store(envelope, std::memory_order_relaxed);
+   channel->mPublishedTime.store(time, std::memory_order_release);
+}
+
+//static
+SidechainBus::View SidechainBus::Read(const Channel* channel, double time)
+{
+   View view;
+   //a producer that's been removed, or that hasn't got to this buffer yet (it's in a feedback loop with us), reads as silence
+   if (channel == nullptr || channel->mPublishedTime.load(std::memory_order_acquire) != time)
+      return view;
+   view.mBuffer = channel->mBuffer.load(std::memory_order_relaxed);
+   view.mEnvelope = channel->mEnvelope.load(std::memory_order_relaxed);
+   return view;
+}
@@ -0,0 +1,78 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SidechainBus.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ChannelBuffer;
+class IAudioSource;
+class IDrawableModule;
+
+//named sidechain channels. a producer (see SidechainSend) publishes a read-only view of the audio going through it every buffer,
+//along with its envelope, and consumers (compressor, gate, pumper, fftvocoder) read that view in place, rather than having it copied into them.
+//the execution plan orders each producer before the consumers subscribed to its channel, so the view is always of the current buffer
+class SidechainBus
+{
+public:
+   struct Channel
+   {
+      std::string mName;
+      IDrawableModule* mProducer{ nullptr };
+      std::atomic<ChannelBuffer*> mBuffer{ nullptr };
+      std::atomic<const float*> mEnvelope{ nullptr };
+      std::atomic<double> mPublishedTime{ -1 };
+   };
+
+   struct View
+   {
+      ChannelBuffer* mBuffer{ nullptr }; //read-only, through GetChannelReadOnly()
+      const float* mEnvelope{ nullptr }; //per sample, linked across channels, 0-1ish
+   };
+
+   static SidechainBus& Get();
+
+   //main thread
+   Channel* SetProducer(IDrawableModule* producer, const std::string& name); //nullptr if another module already publishes on that name
+   Channel* Subscribe(IDrawableModule* subscriber, const std::string& name); //an empty name just unsubscribes
+   void RemoveModule(IDrawableModule* module);
+   void GetDependencies(std::vector<std::pair<IAudioSource*, IAudioSource*>>& dependencies) const; //producer, consumer
+
+   //audio thread
+   static void Publish(Channel* channel, ChannelBuffer* buffer, const float* envelope, double time);
+   static View Read(const Channel* channel, double time); //empty if nothing published on it this buffer
+
+private:
+   Channel* GetChannel(const std::string& name);
+   static IAudioSource* GetAudioSource(IDrawableModule* module);
+
+   std::list<Channel> mChannels; //never erased, so the audio thread's pointers to them stay valid
+   std::vector<std::pair<IDrawableModule*, Channel*>> mSubscriptions;
+};
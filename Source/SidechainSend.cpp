@@ -0,0 +1,156 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SidechainSend.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SidechainSend.h"
+#include "ModularSynth.h"
+#include "Profiler.h"
+#include "Transport.h"
+#include "UIControlMacros.h"
+
+SidechainSend::SidechainSend()
+: IAudioProcessor(gBufferSize)
+, mEnvelope(gBufferSize)
+{
+   mEnvelopeFollower.SetAttack(1);
+   mEnvelopeFollower.SetRelease(mRelease);
+}
+
+void SidechainSend::Init()
+{
+   IDrawableModule::Init();
+
+   TheTransport->AddAudioPoller(this);
+}
+
+void SidechainSend::CreateUIControls()
+{
+   IDrawableModule::CreateUIControls();
+   UIBLOCK0();
+   TEXTENTRY(mNameEntry, "name", 13, &mName);
+   FLOATSLIDER(mReleaseSlider, "release", &mRelease, 1, 500);
+   ENDUIBLOCK(mWidth, mHeight);
+   mHeight += 10; //room for the level, or the warning
+
+   mReleaseSlider->SetMode(FloatSlider::kSquare);
+}
+
+SidechainSend::~SidechainSend()
+{
+   TheTransport->RemoveAudioPoller(this);
+}
+
+void SidechainSend::Process(double time)
+{
+   PROFILER(SidechainSend);
+
+   SyncBuffers();
+
+   ChannelBuffer* buffer = GetBuffer();
+   int bufferSize = buffer->BufferSize();
+   int numChannels = MIN(buffer->NumActiveChannels(), ChannelBuffer::kMaxNumChannels);
+
+   if (mEnabled && mChannel != nullptr)
+   {
+      if ((int)mEnvelope.size() < bufferSize)
+         mEnvelope.resize(bufferSize);
+
+      const float* channels[ChannelBuffer::kMaxNumChannels];
+      for (int ch = 0; ch < numChannels; ++ch)
+         channels[ch] = buffer->GetChannelReadOnly(ch);
+      mDetector.Process(channels, numChannels, bufferSize, mEnvelope.data());
+      mEnvelopeFollower.Process(mEnvelope.data(), mEnvelope.data(), bufferSize);
+      mLevel = mEnvelopeFollower.GetValue();
+
+      //consumers read our input buffer itself, so nothing gets copied for them
+      SidechainBus::Publish(mChannel, buffer, mEnvelope.data(), time);
+   }
+
+   IAudioReceiver* target = GetTarget();
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      if (target != nullptr)
+         target->GetBuffer()->AddShared(ch, buffer, ch);
+      GetVizBuffer()->WriteChunk(buffer->GetChannelReadOnly(ch), bufferSize, ch);
+   }
+
+   //the input is reset when the transport advances for the next buffer instead of here, so it's still intact when the consumers read it
+}
+
+void SidechainSend::OnTransportAdvanced(float amount)
+{
+   GetBuffer()->Reset();
+}
+
+void SidechainSend::DrawModule()
+{
+   if (Minimized() || IsVisible() == false)
+      return;
+
+   mNameEntry->Draw();
+   mReleaseSlider->Draw();
+
+   ofPushStyle();
+   if (mNameInUse)
+   {
+      ofSetColor(255, 0, 0);
+      DrawTextNormal("name in use", 5, mHeight - 4);
+   }
+   else
+   {
+      ofFill();
+      ofSetColor(0, 255, 0, gModuleDrawAlpha * .4f);
+      ofRect(5, mHeight - 6, (mWidth - 10) * ofClamp(sqrtf(mLevel), 0, 1), 4);
+   }
+   ofPopStyle();
+}
+
+void SidechainSend::TextEntryComplete(TextEntry* entry)
+{
+   if (entry == mNameEntry)
+   {
+      mChannel = SidechainBus::Get().SetProducer(this, mName);
+      mNameInUse = mChannel == nullptr && !mName.empty();
+      TheSynth->ArrangeAudioSourceDependencies();
+   }
+}
+
+void SidechainSend::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
+{
+   if (slider == mReleaseSlider)
+      mEnvelopeFollower.SetRelease(mRelease);
+}
+
+void SidechainSend::LoadLayout(const ofxJSONElement& moduleInfo)
+{
+   mModuleSaveData.LoadString("target", moduleInfo);
+
+   SetUpFromSaveData();
+}
+
+void SidechainSend::SetUpFromSaveData()
+{
+   SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
+}
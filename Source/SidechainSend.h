@@ -0,0 +1,88 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SidechainSend.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "IAudioProcessor.h"
+#include "IDrawableModule.h"
+#include "IAudioPoller.h"
+#include "TextEntry.h"
+#include "Slider.h"
+#include "SidechainBus.h"
+#include "DynamicsCore.h"
+
+//passes audio through untouched, and publishes it on a named sidechain channel, for compressors, gates, pumpers and vocoders to key off of
+class SidechainSend : public IAudioProcessor, public IDrawableModule, public IAudioPoller, public ITextEntryListener, public IFloatSliderListener
+{
+public:
+   SidechainSend();
+   virtual ~SidechainSend();
+   static IDrawableModule* Create() { return new SidechainSend(); }
+   static bool AcceptsAudio() { return true; }
+   static bool AcceptsNotes() { return false; }
+   static bool AcceptsPulses() { return false; }
+
+   void Init() override;
+   void CreateUIControls() override;
+
+   //IAudioSource
+   void Process(double time) override;
+   void SetEnabled(bool enabled) override { mEnabled = enabled; }
+
+   //IAudioPoller
+   void OnTransportAdvanced(float amount) override;
+
+   void TextEntryComplete(TextEntry* entry) override;
+   void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override;
+
+   virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
+   virtual void SetUpFromSaveData() override;
+
+   bool IsEnabled() const override { return mEnabled; }
+
+private:
+   //IDrawableModule
+   void DrawModule() override;
+   void GetModuleDimensions(float& w, float& h) override
+   {
+      w = mWidth;
+      h = mHeight;
+   }
+
+   std::string mName;
+   TextEntry* mNameEntry{ nullptr };
+   float mRelease{ 50 };
+   FloatSlider* mReleaseSlider{ nullptr };
+   float mWidth{ 120 };
+   float mHeight{ 40 };
+
+   SidechainBus::Channel* mChannel{ nullptr };
+   bool mNameInUse{ false };
+   LevelDetector mDetector;
+   EnvelopeFollower mEnvelopeFollower;
+   std::vector<float> mEnvelope;
+   float mLevel{ 0 };
+};
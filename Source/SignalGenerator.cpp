@@ -194,9 +194,9 @@ void SignalGenerator::Process(double time)
       mSyncPhase += syncPhaseInc;
 
       if (mSyncMode != Oscillator::SyncMode::None)
-         mWriteBuffer[pos] += mOsc.Audio(time, mSyncPhase) * volSq;
+         mWriteBuffer[pos] += mOsc.Audio(time, mSyncPhase, syncPhaseInc) * volSq;
       else
-         mWriteBuffer[pos] += mOsc.Audio(time, mPhase + mPhaseOffset * FTWO_PI) * volSq;
+         mWriteBuffer[pos] += mOsc.Audio(time, mPhase + mPhaseOffset * FTWO_PI, phaseInc) * volSq;
 
       time += gInvSampleRateMs;
    }
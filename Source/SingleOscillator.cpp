@@ -182,8 +182,9 @@ void SingleOscillator::Process(double time)
    SyncOutputBuffer(mWriteBuffer.NumActiveChannels());
    for (int ch = 0; ch < mWriteBuffer.NumActiveChannels(); ++ch)
    {
-      GetVizBuffer()->WriteChunk(mWriteBuffer.GetChannel(ch), mWriteBuffer.BufferSize(), ch);
-      Add(target->GetBuffer()->GetChannel(ch), mWriteBuffer.GetChannel(ch), gBufferSize);
+      GetVizBuffer()->WriteChunk(mWriteBuffer.GetChannelReadOnly(ch), mWriteBuffer.BufferSize(), ch);
+      if (!mWriteBuffer.IsSilent(ch)) //no voices playing
+         Add(target->GetBuffer()->GetChannel(ch), mWriteBuffer.GetChannelReadOnly(ch), gBufferSize);
    }
 }
 
@@ -342,7 +343,14 @@ void SingleOscillator::UpdateOldControlName(std::string& oldName)
 void SingleOscillator::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
-   mModuleSaveData.LoadInt("voicelimit", moduleInfo, -1, -1, kNumVoices);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, -1, -1, kMaxPolyphony);
+   mModuleSaveData.LoadInt("cpu_priority", moduleInfo, 0, 0, CpuGovernor::kNumLevels - 1);
+   EnumMap oversamplingMap;
+   oversamplingMap["1"] = 1;
+   oversamplingMap["2"] = 2;
+   oversamplingMap["4"] = 4;
+   oversamplingMap["8"] = 8;
+   mModuleSaveData.LoadEnum<int>("oversampling", moduleInfo, 1, nullptr, &oversamplingMap);
    mModuleSaveData.LoadBool("mono", moduleInfo, false);
 
    SetUpFromSaveData();
@@ -357,9 +365,13 @@ void SingleOscillator::SetUpFromSaveData()
       mPolyMgr.SetVoiceLimit(voiceLimit);
    else
       mPolyMgr.SetVoiceLimit(kNumVoices);
+   mPolyMgr.SetPriority(mModuleSaveData.GetInt("cpu_priority"));
 
    bool mono = mModuleSaveData.GetBool("mono");
    mWriteBuffer.SetNumActiveChannels(mono ? 1 : 2);
+
+   int oversampling = mModuleSaveData.GetEnum<int>("oversampling");
+   mPolyMgr.SetOversampling(oversampling);
 }
 
 
@@ -48,6 +48,7 @@ public:
    static bool AcceptsAudio() { return false; }
    static bool AcceptsNotes() { return true; }
    static bool AcceptsPulses() { return false; }
+   static bool CanConstructOffThread() { return true; }
 
    void CreateUIControls() override;
 
@@ -29,6 +29,8 @@
 #include "Scale.h"
 #include "Profiler.h"
 #include "ChannelBuffer.h"
+#include "PolyphonyMgr.h"
+#include "CpuGovernor.h"
 
 SingleOscillatorVoice::SingleOscillatorVoice(IDrawableModule* owner)
 : mOwner(owner)
@@ -48,133 +50,237 @@ bool SingleOscillatorVoice::Process(double time, ChannelBuffer* out, int oversam
 {
    PROFILER(SingleOscillatorVoice);
 
-   if (IsDone(time))
+   if (!BeginBlock(time, out, oversampling))
       return false;
 
-   for (int u = 0; u < mVoiceParams->mUnison && u < kMaxUnison; ++u)
-      mOscData[u].mOsc.SetType(mVoiceParams->mOscType);
+   int bufferSize = out->BufferSize();
+   ChannelBuffer* destBuffer = out;
+   if (oversampling != 1)
+   {
+      gMidiVoiceWorkChannelBuffer.SetNumActiveChannels(out->NumActiveChannels());
+      destBuffer = &gMidiVoiceWorkChannelBuffer;
+      gMidiVoiceWorkChannelBuffer.Clear();
+      bufferSize *= oversampling;
+   }
+
+   float* outLeft = destBuffer->GetChannel(0);
+   float* outRight = mBlock.mMono ? nullptr : destBuffer->GetChannel(1);
 
-   bool mono = (out->NumActiveChannels() == 1);
+   for (int pos = 0; pos < bufferSize; ++pos)
+   {
+      AdvanceLanes(pos, oversampling, mLanePhases.data(), mLanePhaseIncs.data());
 
-   float pitch;
-   float freq;
-   float vol;
-   float syncPhaseInc;
+      //every unison copy at once, four to a simd lane
+      SetUpOscillator(mOsc);
+      mOsc.RenderLanes(mLanePhases.data(), mLanePhaseIncs.data(), mLaneSamples.data(), mNumUnison);
 
-   if (mVoiceParams->mLiteCPUMode)
-      DoParameterUpdate(0, pitch, freq, vol, syncPhaseInc);
+      FinishSample(pos, oversampling, mLaneSamples.data(), outLeft, outRight);
+   }
 
-   for (int pos = 0; pos < out->BufferSize(); ++pos)
+   if (oversampling != 1)
    {
-      if (!mVoiceParams->mLiteCPUMode)
-         DoParameterUpdate(pos, pitch, freq, vol, syncPhaseInc);
+      bufferSize /= oversampling;
+      for (int ch = 0; ch < out->NumActiveChannels(); ++ch)
+      {
+         mOversampler.Downsample(ch, destBuffer->GetChannel(ch), destBuffer->GetChannel(ch), bufferSize);
+         Add(out->GetChannel(ch), destBuffer->GetChannel(ch), bufferSize);
+      }
+   }
+
+   return true;
+}
 
-      float adsrVal = mAdsr.Value(time);
+//static
+void SingleOscillatorVoice::ProcessLanes(SingleOscillatorVoice* const* voices, int numVoices, double time, ChannelBuffer* out, OscillatorLanes& lanes)
+{
+   PROFILER(SingleOscillatorVoice);
 
-      float summedLeft = 0;
-      float summedRight = 0;
-      for (int u = 0; u < mVoiceParams->mUnison && u < kMaxUnison; ++u)
+   int numSounding = 0;
+   for (int i = 0; i < numVoices; ++i)
+   {
+      if (voices[i]->BeginBlock(time, out, 1))
+         lanes.mVoices[numSounding++] = voices[i];
+   }
+   if (numSounding == 0)
+      return;
+
+   float* outLeft = out->GetChannel(0);
+   float* outRight = out->NumActiveChannels() == 1 ? nullptr : out->GetChannel(1);
+   Oscillator& osc = lanes.mVoices[0]->mOsc; //they all share one set of params, so any of their oscillators will do for the lot
+   int bufferSize = out->BufferSize();
+   for (int pos = 0; pos < bufferSize; ++pos)
+   {
+      //each voice's unison copies go after the previous voice's, and then all of them render at once
+      int numLanes = 0;
+      for (int i = 0; i < numSounding; ++i)
       {
-         mOscData[u].mOsc.SetPulseWidth(mVoiceParams->mPulseWidth);
-         mOscData[u].mOsc.SetShuffle(mVoiceParams->mShuffle);
-         mOscData[u].mOsc.SetSoften(mVoiceParams->mSoften);
+         lanes.mVoices[i]->AdvanceLanes(pos, 1, lanes.mPhases.data() + numLanes, lanes.mPhaseIncs.data() + numLanes);
+         numLanes += lanes.mVoices[i]->mNumUnison;
+      }
 
-         {
-            //PROFILER(SingleOscillatorVoice_UpdatePhase);
-            mOscData[u].mPhase += mOscData[u].mCurrentPhaseInc;
-            if (std::isinf(mOscData[u].mPhase))
-            {
-               ofLog() << "Infinite phase. phaseInc:" + ofToString(mOscData[u].mCurrentPhaseInc) + " detune:" + ofToString(mVoiceParams->mDetune) + " freq:" + ofToString(freq) + " pitch:" + ofToString(pitch) + " getpitch:" + ofToString(GetPitch(pos));
-               // Reset to 0 because letting this propagate causes NaN's
-               mOscData[u].mPhase = 0;
-               mOscData[u].mCurrentPhaseInc = 0;
-            }
-            else
-            {
-               while (mOscData[u].mPhase > FTWO_PI * 2)
-               {
-                  mOscData[u].mPhase -= FTWO_PI * 2;
-                  mOscData[u].mSyncPhase = 0;
-               }
-            }
-            mOscData[u].mSyncPhase += syncPhaseInc;
-         }
-         if (std::isinf(mOscData[u].mSyncPhase))
-         {
-            // Reset to 0 because letting this propagate causes NaN's
-            mOscData[u].mSyncPhase = 0;
-            syncPhaseInc = 0;
-         }
+      lanes.mVoices[0]->SetUpOscillator(osc);
+      osc.RenderLanes(lanes.mPhases.data(), lanes.mPhaseIncs.data(), lanes.mSamples.data(), numLanes);
 
-         float sample;
+      numLanes = 0;
+      for (int i = 0; i < numSounding; ++i)
+      {
+         lanes.mVoices[i]->FinishSample(pos, 1, lanes.mSamples.data() + numLanes, outLeft, outRight);
+         numLanes += lanes.mVoices[i]->mNumUnison;
+      }
+   }
+}
 
-         {
-            //PROFILER(SingleOscillatorVoice_GetOscValue);
-            if (mVoiceParams->mSyncMode != Oscillator::SyncMode::None)
-               sample = mOscData[u].mOsc.Value(mOscData[u].mSyncPhase) * adsrVal * vol;
-            else
-               sample = mOscData[u].mOsc.Value(mOscData[u].mPhase + mVoiceParams->mPhaseOffset * (1 + (float(u) / mVoiceParams->mUnison))) * adsrVal * vol;
-         }
+//everything that's worked out once a block, false if the voice has finished
+bool SingleOscillatorVoice::BeginBlock(double time, ChannelBuffer* out, int oversampling)
+{
+   if (IsDone(time))
+      return false;
+
+   mOsc.SetType(mVoiceParams->mOscType);
+
+   //under cpu pressure, half the unison copies, and then the parameters only once a buffer
+   mNumUnison = MIN(mVoiceParams->mUnison, kMaxUnison);
+   if (GetDegradeLevel() >= CpuGovernor::kLevel_ReduceQuality)
+      mNumUnison = (mNumUnison + 1) / 2;
+   mBlock.mLiteCPUMode = mVoiceParams->mLiteCPUMode || GetDegradeLevel() >= CpuGovernor::kLevel_ReduceControlRate;
+   mBlock.mSync = mVoiceParams->mSyncMode != Oscillator::SyncMode::None;
+   mBlock.mMono = (out->NumActiveChannels() == 1);
+
+   int bufferSize = out->BufferSize() * oversampling;
+   double sampleIncrementMs = gInvSampleRateMs / oversampling;
+
+   mOversampler.SetFactor(oversampling);
+   mBlock.mForceFilterUpdate = false;
+   if (oversampling != mFilterOversampling)
+   {
+      mFilterOversampling = oversampling;
+      mFilterLeft.SetSampleRate(gSampleRate * oversampling);
+      mFilterRight.SetSampleRate(gSampleRate * oversampling);
+      mBlock.mForceFilterUpdate = true;
+   }
 
-         if (u >= 2)
-            sample *= 1 - (mOscData[u].mDetuneFactor * .5f);
+   if (mBlock.mLiteCPUMode)
+      DoParameterUpdate(0, oversampling, mBlock.mPitch, mBlock.mFreq, mBlock.mVol, mBlock.mSyncPhaseInc);
 
-         if (mono)
+   //the envelopes for the whole block up front, rather than a lookup per sample
+   if ((int)mAdsrValues.size() < bufferSize)
+   {
+      mAdsrValues.resize(bufferSize);
+      mFilterAdsrValues.resize(bufferSize);
+   }
+   mAdsr.RenderBlock(time, mAdsrValues.data(), bufferSize, sampleIncrementMs);
+   if (mUseFilter)
+      mFilterAdsr.RenderBlock(time, mFilterAdsrValues.data(), bufferSize, sampleIncrementMs);
+
+   return true;
+}
+
+void SingleOscillatorVoice::SetUpOscillator(Oscillator& osc) const
+{
+   osc.SetPulseWidth(mVoiceParams->mPulseWidth);
+   osc.SetShuffle(mVoiceParams->mShuffle);
+   osc.SetSoften(mVoiceParams->mSoften);
+}
+
+//moves each unison copy on by a sample, and gives the phases to render it at
+void SingleOscillatorVoice::AdvanceLanes(int pos, int oversampling, float* phases, float* phaseIncs)
+{
+   //parameters follow the base rate, the oversampled samples in between share them
+   if (!mBlock.mLiteCPUMode && pos % oversampling == 0)
+      DoParameterUpdate(pos / oversampling, oversampling, mBlock.mPitch, mBlock.mFreq, mBlock.mVol, mBlock.mSyncPhaseInc);
+
+   for (int u = 0; u < mNumUnison; ++u)
+   {
+      {
+         //PROFILER(SingleOscillatorVoice_UpdatePhase);
+         mOscData[u].mPhase += mOscData[u].mCurrentPhaseInc;
+         if (std::isinf(mOscData[u].mPhase))
          {
-            summedLeft += sample;
+            ofLog() << "Infinite phase. phaseInc:" + ofToString(mOscData[u].mCurrentPhaseInc) + " detune:" + ofToString(mVoiceParams->mDetune) + " freq:" + ofToString(mBlock.mFreq) + " pitch:" + ofToString(mBlock.mPitch) + " getpitch:" + ofToString(GetPitch(pos / oversampling));
+            // Reset to 0 because letting this propagate causes NaN's
+            mOscData[u].mPhase = 0;
+            mOscData[u].mCurrentPhaseInc = 0;
          }
          else
          {
-            //PROFILER(SingleOscillatorVoice_pan);
-            float unisonPan;
-            if (mVoiceParams->mUnison == 1)
-               unisonPan = 0;
-            else if (u == 0)
-               unisonPan = -1;
-            else if (u == 1)
-               unisonPan = 1;
-            else
-               unisonPan = mOscData[u].mDetuneFactor;
-            float pan = GetPan() + unisonPan * mVoiceParams->mUnisonWidth;
-            summedLeft += sample * GetLeftPanGain(pan);
-            summedRight += sample * GetRightPanGain(pan);
+            while (mOscData[u].mPhase > FTWO_PI * 2)
+            {
+               mOscData[u].mPhase -= FTWO_PI * 2;
+               mOscData[u].mSyncPhase = 0;
+            }
          }
+         mOscData[u].mSyncPhase += mBlock.mSyncPhaseInc;
+      }
+      if (std::isinf(mOscData[u].mSyncPhase))
+      {
+         // Reset to 0 because letting this propagate causes NaN's
+         mOscData[u].mSyncPhase = 0;
+         mBlock.mSyncPhaseInc = 0;
       }
 
-      if (mUseFilter)
+      if (mBlock.mSync)
       {
-         //PROFILER(SingleOscillatorVoice_filter);
-         float f = ofLerp(mVoiceParams->mFilterCutoffMin, mVoiceParams->mFilterCutoffMax, mFilterAdsr.Value(time)) * (1 - GetModWheel(pos) * .9f);
-         float q = mVoiceParams->mFilterQ;
-         if (f != mFilterLeft.mF || q != mFilterLeft.mQ)
-            mFilterLeft.SetFilterParams(f, q);
-         summedLeft = mFilterLeft.Filter(summedLeft);
-         if (!mono)
-         {
-            mFilterRight.CopyCoeffFrom(mFilterLeft);
-            summedRight = mFilterRight.Filter(summedRight);
-         }
+         phases[u] = mOscData[u].mSyncPhase;
+         phaseIncs[u] = mBlock.mSyncPhaseInc;
+      }
+      else
+      {
+         phases[u] = mOscData[u].mPhase + mVoiceParams->mPhaseOffset * (1 + (float(u) / mVoiceParams->mUnison));
+         phaseIncs[u] = mOscData[u].mCurrentPhaseInc;
       }
+   }
+}
 
+//mixes the rendered unison copies down, and puts them through the envelope and the filter into the output
+void SingleOscillatorVoice::FinishSample(int pos, int oversampling, const float* samples, float* outLeft, float* outRight)
+{
+   bool mono = mBlock.mMono;
+   float summedLeft = 0;
+   float summedRight = 0;
+   for (int u = 0; u < mNumUnison; ++u)
+   {
+      if (mono)
       {
-         //PROFILER(SingleOscillatorVoice_output);
-         if (mono)
-         {
-            out->GetChannel(0)[pos] += summedLeft;
-         }
-         else
-         {
-            out->GetChannel(0)[pos] += summedLeft;
-            out->GetChannel(1)[pos] += summedRight;
-         }
+         summedLeft += samples[u] * mOscData[u].mGain;
+      }
+      else
+      {
+         summedLeft += samples[u] * mOscData[u].mLeftGain;
+         summedRight += samples[u] * mOscData[u].mRightGain;
       }
-      time += gInvSampleRateMs;
    }
+   float adsrVal = mAdsrValues[pos];
+   summedLeft *= adsrVal;
+   summedRight *= adsrVal;
 
-   return true;
+   if (mUseFilter)
+   {
+      //PROFILER(SingleOscillatorVoice_filter);
+      float f = ofLerp(mVoiceParams->mFilterCutoffMin, mVoiceParams->mFilterCutoffMax, mFilterAdsrValues[pos]) * (1 - GetModWheel(pos / oversampling) * .9f);
+      float q = mVoiceParams->mFilterQ;
+      if (mBlock.mForceFilterUpdate || f != mFilterLeft.mF || q != mFilterLeft.mQ)
+      {
+         mFilterLeft.SetFilterParams(f, q);
+         mBlock.mForceFilterUpdate = false;
+      }
+      summedLeft = mFilterLeft.Filter(summedLeft);
+      if (!mono)
+      {
+         mFilterRight.CopyCoeffFrom(mFilterLeft);
+         summedRight = mFilterRight.Filter(summedRight);
+      }
+   }
+
+   {
+      //PROFILER(SingleOscillatorVoice_output);
+      outLeft[pos] += summedLeft;
+      if (!mono)
+         outRight[pos] += summedRight;
+   }
 }
 
 void SingleOscillatorVoice::DoParameterUpdate(int samplesIn,
+                                              int oversampling,
                                               float& pitch,
                                               float& freq,
                                               float& vol,
@@ -185,18 +291,38 @@ void SingleOscillatorVoice::DoParameterUpdate(int samplesIn,
 
    pitch = GetPitch(samplesIn);
    freq = TheScale->PitchToFreq(pitch) * mVoiceParams->mMult;
-   vol = mVoiceParams->mVol * .4f / mVoiceParams->mUnison;
+   vol = mVoiceParams->mVol * .4f / mNumUnison;
    if (mVoiceParams->mSyncMode == Oscillator::SyncMode::Frequency)
-      syncPhaseInc = GetPhaseInc(mVoiceParams->mSyncFreq);
+      syncPhaseInc = GetPhaseInc(mVoiceParams->mSyncFreq) / oversampling;
    else if (mVoiceParams->mSyncMode == Oscillator::SyncMode::Ratio)
-      syncPhaseInc = GetPhaseInc(freq * mVoiceParams->mSyncRatio);
+      syncPhaseInc = GetPhaseInc(freq * mVoiceParams->mSyncRatio) / oversampling;
    else
       syncPhaseInc = 0;
 
-   for (int u = 0; u < mVoiceParams->mUnison && u < kMaxUnison; ++u)
+   for (int u = 0; u < mNumUnison; ++u)
    {
       float detune = exp2(mVoiceParams->mDetune * mOscData[u].mDetuneFactor * (1 - GetPressure(samplesIn)));
-      mOscData[u].mCurrentPhaseInc = GetPhaseInc(freq * detune);
+      mOscData[u].mCurrentPhaseInc = GetPhaseInc(freq * detune) / oversampling;
+
+      //output gains only change along with the parameters, so work them out here instead of per sample
+      float gain = vol;
+      if (u >= 2)
+         gain *= 1 - (mOscData[u].mDetuneFactor * .5f);
+
+      float unisonPan;
+      if (mNumUnison == 1)
+         unisonPan = 0;
+      else if (u == 0)
+         unisonPan = -1;
+      else if (u == 1)
+         unisonPan = 1;
+      else
+         unisonPan = mOscData[u].mDetuneFactor;
+      float pan = GetPan() + unisonPan * mVoiceParams->mUnisonWidth;
+
+      mOscData[u].mGain = gain;
+      mOscData[u].mLeftGain = gain * GetLeftPanGain(pan);
+      mOscData[u].mRightGain = gain * GetRightPanGain(pan);
    }
 }
 
@@ -32,6 +32,9 @@
 #include "EnvOscillator.h"
 #include "LFO.h"
 #include "BiquadFilter.h"
+#include "Oversampler.h"
+
+#include <array>
 
 #define SINGLEOSCILLATOR_NO_CUTOFF 10000
 
@@ -64,6 +67,8 @@ public:
    bool mLiteCPUMode{ false };
 };
 
+struct OscillatorLanes;
+
 class SingleOscillatorVoice : public IMidiVoice
 {
 public:
@@ -77,14 +82,24 @@ public:
    bool Process(double time, ChannelBuffer* out, int oversampling) override;
    void SetVoiceParams(IVoiceParams* params) override;
    bool IsDone(double time) override;
+   float GetLevel(double time) override { return mAdsr.Value(time); }
+
+   //voices that share their params, rendered in lockstep: a sample of every voice's oscillators at once, four lanes to a simd op however few
+   //unison copies each voice has. no oversampling, that goes through Process() a voice at a time
+   static void ProcessLanes(SingleOscillatorVoice* const* voices, int numVoices, double time, ChannelBuffer* out, OscillatorLanes& lanes);
 
    static float GetADSRScale(float velocity, float velToEnvelope);
    static float GetADSRCurve(float velocity, float velToEnvelope);
 
-   static const int kMaxUnison = 8;
+   static const int kMaxUnison = 16;
 
 private:
+   bool BeginBlock(double time, ChannelBuffer* out, int oversampling);
+   void SetUpOscillator(Oscillator& osc) const;
+   void AdvanceLanes(int pos, int oversampling, float* phases, float* phaseIncs);
+   void FinishSample(int pos, int oversampling, const float* samples, float* outLeft, float* outRight);
    void DoParameterUpdate(int samplesIn,
+                          int oversampling,
                           float& pitch,
                           float& freq,
                           float& vol,
@@ -94,11 +109,31 @@ private:
    {
       float mPhase{ 0 };
       float mSyncPhase{ 0 };
-      Oscillator mOsc{ kOsc_Square };
       float mDetuneFactor{ 0 };
       float mCurrentPhaseInc{ 0 };
+      float mGain{ 0 };
+      float mLeftGain{ 0 };
+      float mRightGain{ 0 };
    };
    OscData mOscData[kMaxUnison];
+
+   struct BlockState //worked out by BeginBlock(), and carried from sample to sample
+   {
+      bool mLiteCPUMode{ false };
+      bool mSync{ false };
+      bool mMono{ false };
+      bool mForceFilterUpdate{ false };
+      float mPitch{ 0 };
+      float mFreq{ 0 };
+      float mVol{ 0 };
+      float mSyncPhaseInc{ 0 };
+   };
+   BlockState mBlock;
+   int mNumUnison{ 1 }; //the copies playing this buffer, which the cpu governor can make fewer than asked for
+   Oscillator mOsc{ kOsc_Square }; //the unison copies share a waveform, and render together through RenderLanes()
+   alignas(16) std::array<float, kMaxUnison> mLanePhases{};
+   alignas(16) std::array<float, kMaxUnison> mLanePhaseIncs{};
+   alignas(16) std::array<float, kMaxUnison> mLaneSamples{};
    ::ADSR mAdsr;
    OscillatorVoiceParams* mVoiceParams{ nullptr };
 
@@ -106,6 +141,20 @@ private:
    BiquadFilter mFilterLeft;
    BiquadFilter mFilterRight;
    bool mUseFilter{ false };
+   int mFilterOversampling{ 1 };
+   Oversampler mOversampler;
+   std::vector<float> mAdsrValues;
+   std::vector<float> mFilterAdsrValues;
 
    IDrawableModule* mOwner;
 };
+
+//room for every voice's unison copies side by side, so that voices can render their oscillators together, see SingleOscillatorVoice::ProcessLanes()
+struct OscillatorLanes
+{
+   static const int kMaxLanes = kMaxPolyphony * SingleOscillatorVoice::kMaxUnison;
+   alignas(16) std::array<float, kMaxLanes> mPhases{};
+   alignas(16) std::array<float, kMaxLanes> mPhaseIncs{};
+   alignas(16) std::array<float, kMaxLanes> mSamples{};
+   std::array<SingleOscillatorVoice*, kMaxPolyphony> mVoices{};
+};
@@ -32,6 +32,8 @@
 #include "ModularSynth.h"
 #include "IModulator.h"
 #include "Push2Control.h"
+#include "ControlChangeQueue.h"
+#include "ReplayCapture.h"
 
 FloatSlider::FloatSlider(IFloatSliderListener* owner, const char* label, int x, int y, int w, int h, float* var, float min, float max, int digits /* = -1 */)
 : mVar(var)
@@ -388,7 +390,26 @@ void FloatSlider::SetValueForMouse(float x, float y)
       return;
    }
 
-   *var = PosToVal(pos, false);
+   float newVal = ofClamp(PosToVal(pos, false), mMin, mMax);
+   bool relative = mRelative && (mModulator == nullptr || mModulator->Active() == false);
+   //outside of relative mode, the audio thread picks up the new value at the start of its next buffer and notifies the owner from there
+   if (relative || newVal == oldVal || !TheSynth->GetControlChangeQueue()->QueueSliderValue(this, var, newVal))
+      SetValueForMouseDirect(var, PosToVal(pos, false), oldVal);
+   else
+      ReplayCapture::RecordControl(this, newVal);
+
+   if (mModulator && mModulator->Active() && mModulator->CanAdjustRange())
+   {
+      float move = (y - mRefY) * -.003f;
+      float change = move * (mMax - mMin);
+      mModulator->GetMin() = ofClamp(mModulator->GetMin() + change, mMin, mModulator->GetMax());
+      mRefY = y;
+   }
+}
+
+void FloatSlider::SetValueForMouseDirect(float* var, float value, float oldVal)
+{
+   *var = value;
    if (mRelative && (mModulator == nullptr || mModulator->Active() == false))
    {
       if (!mTouching || mRelativeOffset == -999)
@@ -407,14 +428,18 @@ void FloatSlider::SetValueForMouse(float x, float y)
    {
       mOwner->FloatSliderUpdated(this, oldVal, NextBufferTime(false));
    }
+}
 
-   if (mModulator && mModulator->Active() && mModulator->CanAdjustRange())
-   {
-      float move = (y - mRefY) * -.003f;
-      float change = move * (mMax - mMin);
-      mModulator->GetMin() = ofClamp(mModulator->GetMin() + change, mMin, mModulator->GetMax());
-      mRefY = y;
-   }
+void FloatSlider::ApplyQueuedValue(float* target, float value, double time)
+{
+   //the target can be swapped out between queuing and now (an lfo getting attached, for instance), in which case the change is stale
+   if (target != GetModifyValue())
+      return;
+
+   float oldVal = *target;
+   *target = value;
+   if (oldVal != value)
+      mOwner->FloatSliderUpdated(this, oldVal, time);
 }
 
 bool FloatSlider::AdjustSmooth() const
@@ -630,9 +655,9 @@ void FloatSlider::DoCompute(int samplesIn /*= 0*/)
       if (mModulator && mModulator->Active())
       {
          if (mIsSmoothing)
-            mSmoothTarget = mModulator->Value(samplesIn);
+            mSmoothTarget = GetModulatorValue(samplesIn);
          else
-            *mVar = mModulator->Value(samplesIn);
+            *mVar = GetModulatorValue(samplesIn);
       }
 
       if (mIsSmoothing)
@@ -649,6 +674,114 @@ void FloatSlider::DoCompute(int samplesIn /*= 0*/)
       mOwner->FloatSliderUpdated(this, oldVal, gTime + samplesIn * gInvSampleRateMs);
 }
 
+void FloatSlider::ComputeBlock(float* out, int numSamples, int controlRateInterval /*= 1*/)
+{
+   mComputeHasBeenCalledOnce = true;
+   if (numSamples <= 0)
+      return;
+
+   bool lowRes = mLFOControl && mLFOControl->Active() && mLFOControl->InLowResMode();
+   if (!NeedsCompute() || lowRes)
+   {
+      if (NeedsCompute())
+         DoCompute(0);
+      for (int i = 0; i < numSamples; ++i)
+         out[i] = *mVar;
+      return;
+   }
+
+   bool useCache = IsAudioThread() && numSamples <= gBufferSize;
+   if (useCache && mLastComputeBlockTime == gTime && mLastComputeBlockSize >= numSamples)
+   {
+      //already done for this buffer (or we've looped back around through a circular modulation), reuse it
+      memcpy(out, mLastComputeCacheValue, numSamples * sizeof(float));
+      return;
+   }
+   if (useCache)
+   {
+      mLastComputeBlockTime = gTime;
+      mLastComputeBlockSize = numSamples;
+   }
+   mLastComputeTime = gTime;
+   mLastComputeSamplesIn = numSamples - 1;
+
+   float oldVal = *mVar;
+
+   if (controlRateInterval <= 1)
+   {
+      bool modulated = mModulator && mModulator->Active();
+      const float* cv = modulated ? mModulator->GetCVBlock() : nullptr;
+      if (cv != nullptr && numSamples <= gBufferSize)
+         BufferCopy(out, cv, numSamples);
+      else if (modulated)
+         mModulator->ValueBlock(out, numSamples);
+
+      if (mIsSmoothing)
+      {
+         //the ramp only retargets from mSmoothTarget when the transport advances
+         if (modulated)
+            mSmoothTarget = out[numSamples - 1];
+         mRamp.ValueBlock(gTime, gInvSampleRateMs, out, numSamples);
+      }
+      else if (!modulated)
+      {
+         for (int i = 0; i < numSamples; ++i)
+            out[i] = *mVar;
+      }
+   }
+   else
+   {
+      float from = ComputeBlockPoint(0);
+      int fromIndex = 0;
+      while (fromIndex < numSamples - 1)
+      {
+         int toIndex = MIN(fromIndex + controlRateInterval, numSamples - 1);
+         float to = ComputeBlockPoint(toIndex);
+         float step = (to - from) / (toIndex - fromIndex);
+         for (int i = fromIndex; i < toIndex; ++i)
+            out[i] = from + step * (i - fromIndex);
+         from = to;
+         fromIndex = toIndex;
+      }
+      out[numSamples - 1] = from;
+   }
+
+   *mVar = out[numSamples - 1];
+
+   if (useCache)
+   {
+      memcpy(mLastComputeCacheValue, out, numSamples * sizeof(float));
+      for (int i = 0; i < numSamples; ++i)
+         mLastComputeCacheTime[i] = gTime;
+   }
+
+   if (oldVal != *mVar)
+      mOwner->FloatSliderUpdated(this, oldVal, gTime + (numSamples - 1) * gInvSampleRateMs);
+}
+
+float FloatSlider::ComputeBlockPoint(int samplesIn)
+{
+   float value = *mVar;
+   if (mModulator && mModulator->Active())
+   {
+      if (mIsSmoothing)
+         mSmoothTarget = GetModulatorValue(samplesIn);
+      else
+         value = GetModulatorValue(samplesIn);
+   }
+   if (mIsSmoothing)
+      value = mRamp.Value(gTime + samplesIn * gInvSampleRateMs);
+   return value;
+}
+
+float FloatSlider::GetModulatorValue(int samplesIn)
+{
+   const float* cv = mModulator->GetCVBlock();
+   if (cv != nullptr && samplesIn >= 0 && samplesIn < gBufferSize)
+      return cv[samplesIn];
+   return mModulator->Value(samplesIn);
+}
+
 float* FloatSlider::GetModifyValue()
 {
    if (!TheSynth->IsLoadingModule() && mModulator && mModulator->Active() && mModulator->CanAdjustRange())
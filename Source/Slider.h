@@ -64,6 +64,10 @@ public:
       if (mIsSmoothing || mModulator != nullptr)
          DoCompute(samplesIn);
    }
+   //fills out with the slider's value for each sample of the block, leaving the slider at the last one.
+   //with controlRateInterval > 1 the modulator is only sampled that often, and interpolated linearly in between
+   void ComputeBlock(float* out, int numSamples, int controlRateInterval = 1);
+   bool NeedsCompute() const { return mIsSmoothing || mModulator != nullptr; }
    void DisplayLFOControl();
    void DisableLFO();
    FloatSliderLFOControl* GetLFO() { return mLFOControl; }
@@ -106,6 +110,9 @@ public:
 
    bool CheckNeedsDraw() override;
 
+   //called by ControlChangeQueue on the audio thread
+   void ApplyQueuedValue(float* target, float value, double time);
+
    //IUIControl
    void SetFromMidiCC(float slider, double time, bool setViaModulator) override;
    float GetValueForMidiCC(float slider) const override;
@@ -148,10 +155,13 @@ protected:
 private:
    void OnClicked(float x, float y, bool right) override;
    void SetValueForMouse(float x, float y);
+   void SetValueForMouseDirect(float* var, float value, float oldVal);
    float* GetModifyValue();
    bool AdjustSmooth() const;
    void SmoothUpdated();
    void DoCompute(int samplesIn);
+   float ComputeBlockPoint(int samplesIn);
+   float GetModulatorValue(int samplesIn); //from the modulator's cv block when it has one, see IModulator::GetCVBlock()
 
    int mWidth;
    int mHeight;
@@ -185,6 +195,8 @@ private:
    int mLastComputeSamplesIn{ 0 };
    double* mLastComputeCacheTime;
    float* mLastComputeCacheValue;
+   double mLastComputeBlockTime{ -1 };
+   int mLastComputeBlockSize{ 0 };
 
    float mLastDisplayedValue{ std::numeric_limits<float>::max() };
 
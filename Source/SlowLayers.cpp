@@ -34,7 +34,8 @@ SlowLayers::SlowLayers()
 : IAudioProcessor(gBufferSize)
 {
    //TODO(Ryan) buffer sizes
-   mBuffer = new float[MAX_BUFFER_SIZE];
+   mBufferSize = MAX_BUFFER_SIZE;
+   mBuffer = new float[mBufferSize];
    Clear();
 }
 
@@ -109,10 +110,40 @@ void SlowLayers::Process(double time)
 }
 
 int SlowLayers::LoopLength() const
+{
+   return MIN(FullLoopLength(), mBufferSize);
+}
+
+int SlowLayers::FullLoopLength() const
 {
    return TheTransport->GetDuration(kInterval_1n) * mNumBars * gSampleRate / 1000;
 }
 
+bool SlowLayers::CanShrinkMemory() const
+{
+   return FullLoopLength() < mBufferSize;
+}
+
+void SlowLayers::ShrinkMemory()
+{
+   ResizeBuffer(MAX(1, FullLoopLength()));
+}
+
+//keeps what's been recorded so far, up to the new size
+void SlowLayers::ResizeBuffer(int size)
+{
+   float* buffer = new float[size];
+   ::Clear(buffer, size);
+   float* oldBuffer = mBuffer;
+   {
+      ScopedMutex mutex(TheSynth->GetAudioMutex(), "SlowLayers::ResizeBuffer()");
+      BufferCopy(buffer, mBuffer, MIN(size, mBufferSize));
+      mBuffer = buffer;
+      mBufferSize = size;
+   }
+   delete[] oldBuffer;
+}
+
 void SlowLayers::DrawModule()
 {
    if (Minimized() || IsVisible() == false)
@@ -141,7 +172,7 @@ void SlowLayers::DrawModule()
 
 void SlowLayers::Clear()
 {
-   ::Clear(mBuffer, MAX_BUFFER_SIZE);
+   ::Clear(mBuffer, mBufferSize);
 }
 
 void SlowLayers::SetNumBars(int numBars)
@@ -158,7 +189,7 @@ void SlowLayers::GetModuleDimensions(float& width, float& height)
 void SlowLayers::ButtonClicked(ClickButton* button, double time)
 {
    if (button == mClearButton)
-      ::Clear(mBuffer, MAX_BUFFER_SIZE);
+      Clear();
 }
 
 void SlowLayers::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
@@ -171,6 +202,9 @@ void SlowLayers::RadioButtonUpdated(RadioButton* radio, int oldVal, double time)
 
 void SlowLayers::DropdownUpdated(DropdownList* list, int oldVal, double time)
 {
+   //after a shrink, a longer loop needs the room back. a slower tempo doesn't get it, the loop just stops at the end of the buffer
+   if (list == mNumBarsSelector && FullLoopLength() > mBufferSize && mBufferSize < MAX_BUFFER_SIZE)
+      ResizeBuffer(MAX_BUFFER_SIZE);
 }
 
 void SlowLayers::CheckboxUpdated(Checkbox* checkbox, double time)
@@ -51,6 +51,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //records its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    //IAudioProcessor
@@ -68,6 +69,9 @@ public:
    virtual void SetUpFromSaveData() override;
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override { return mBufferSize * sizeof(float); }
+   bool CanShrinkMemory() const override; //down to the loop at the current tempo
+   void ShrinkMemory() override;
 
 private:
    //IDrawableModule
@@ -75,6 +79,8 @@ private:
    void GetModuleDimensions(float& width, float& height) override;
 
    int LoopLength() const;
+   int FullLoopLength() const; //can be longer than the buffer, after a shrink
+   void ResizeBuffer(int size);
 
    static const int BUFFER_X = 4;
    static const int BUFFER_Y = 4;
@@ -82,6 +88,7 @@ private:
    static const int BUFFER_H = 93;
 
    float* mBuffer{ nullptr };
+   int mBufferSize{ 0 };
    float mLoopPos{ 0 };
    int mNumBars{ 1 };
    float mVol{ 1 };
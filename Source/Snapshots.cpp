@@ -64,6 +64,8 @@ void Snapshots::CreateUIControls()
    mGridControlOffsetXSlider = new IntSlider(this, "x offset", mStoreCheckbox, kAnchor_Below, 60, 15, &mGridControlOffsetX, 0, 16);
    mGridControlOffsetYSlider = new IntSlider(this, "y offset", mGridControlOffsetXSlider, kAnchor_Right, 60, 15, &mGridControlOffsetY, 0, 16);
    mSnapshotLabelEntry = new TextEntry(this, "snapshot label", -1, -1, 12, &mSnapshotLabel);
+   mMorphSlider = new FloatSlider(this, "morph", mStoreCheckbox, kAnchor_Below, 80, 15, &mMorph, 0, 1);
+   mMorphTargetSlider = new IntSlider(this, "to", mMorphSlider, kAnchor_Right, 50, 15, &mMorphTarget, 0, kMinNumListRows - 1);
 
    {
       mModuleCable = new PatchCableSource(this, kConnectionType_Special);
@@ -122,6 +124,76 @@ void Snapshots::Poll()
    {
       mBlendRamps.clear();
    }
+
+   UpdateMorph();
+}
+
+//recompiles a snapshot's controls if it's been stored again, or modules or controls have come or gone since
+void Snapshots::Compile(SnapshotCollection& coll)
+{
+   if (coll.mCompiledEdits == mSnapshotEdits && coll.mCompiledGeneration == UIControlIndex::GetGeneration())
+      return;
+
+   coll.mCompiled.clear();
+   auto context = IClickable::sPathLoadContext;
+   IClickable::sPathLoadContext = GetParent() ? GetParent()->Path() + "~" : "";
+   for (const auto& snapshot : coll.mSnapshots)
+   {
+      IUIControl* control = TheSynth->FindUIControl(snapshot.mControlPath);
+      if (control != nullptr)
+         coll.mCompiled.push_back({ UIControlIndex::Get().GetHandle(control), &snapshot });
+   }
+   IClickable::sPathLoadContext = context;
+
+   coll.mCompiledEdits = mSnapshotEdits;
+   coll.mCompiledGeneration = UIControlIndex::GetGeneration();
+}
+
+//pairs up the plain values stored in both the current snapshot and the morph target, for OnTransportAdvanced() to blend between
+void Snapshots::UpdateMorph()
+{
+   if (mMorphFrom == mCurrentSnapshot && mMorphTo == mMorphTarget && mMorphEdits == mSnapshotEdits && mMorphGeneration == UIControlIndex::GetGeneration())
+      return;
+
+   std::vector<MorphControl> morphControls;
+   if (mCurrentSnapshot >= 0 && mCurrentSnapshot < (int)mSnapshotCollection.size() &&
+       mMorphTarget >= 0 && mMorphTarget < (int)mSnapshotCollection.size())
+   {
+      SnapshotCollection& from = mSnapshotCollection[mCurrentSnapshot];
+      SnapshotCollection& to = mSnapshotCollection[mMorphTarget];
+      Compile(from);
+      Compile(to);
+
+      std::unordered_map<UIControlIndex::Handle, float> targetValues;
+      for (const auto& compiled : to.mCompiled)
+      {
+         const Snapshot& snapshot = *compiled.mSnapshot;
+         if (!snapshot.mHasLFO && snapshot.mGridContents.empty() && snapshot.mString.empty())
+            targetValues[compiled.mHandle] = snapshot.mValue;
+      }
+
+      for (const auto& compiled : from.mCompiled)
+      {
+         const Snapshot& snapshot = *compiled.mSnapshot;
+         auto target = targetValues.find(compiled.mHandle);
+         IUIControl* control = UIControlIndex::Get().Resolve(compiled.mHandle);
+         if (target == targetValues.end() || control == nullptr || snapshot.mHasLFO || !snapshot.mGridContents.empty() || !snapshot.mString.empty())
+            continue;
+         MorphControl morph;
+         morph.mUIControl = control;
+         morph.mFrom = snapshot.mValue;
+         morph.mTo = target->second;
+         morphControls.push_back(morph);
+      }
+   }
+
+   mRampMutex.lock();
+   mMorphControls.swap(morphControls);
+   mMorphFrom = mCurrentSnapshot;
+   mMorphTo = mMorphTarget;
+   mMorphEdits = mSnapshotEdits;
+   mMorphGeneration = UIControlIndex::GetGeneration();
+   mRampMutex.unlock();
 }
 
 void Snapshots::DrawModule()
@@ -143,7 +215,9 @@ void Snapshots::DrawModule()
       mGridControlTarget->PositionTo(mDeleteCheckbox, kAnchor_Right);
       mGridControlOffsetXSlider->SetShowing((mGridControlTarget->GetGridController() != nullptr && mGrid->GetCols() > mGridControlTarget->GetGridController()->NumCols()) || mPush2Connected);
       mGridControlOffsetYSlider->SetShowing((mGridControlTarget->GetGridController() != nullptr && mGrid->GetRows() > mGridControlTarget->GetGridController()->NumRows()) || mPush2Connected);
-      mGridControlOffsetXSlider->PositionTo(mStoreCheckbox, kAnchor_Below);
+      mMorphSlider->PositionTo(mStoreCheckbox, kAnchor_Below);
+      mMorphTargetSlider->PositionTo(mMorphSlider, kAnchor_Right);
+      mGridControlOffsetXSlider->PositionTo(mMorphSlider, kAnchor_Below);
       mGridControlOffsetYSlider->PositionTo(mGridControlOffsetXSlider, kAnchor_Right);
    }
 
@@ -159,7 +233,9 @@ void Snapshots::DrawModule()
       mGridControlTarget->PositionTo(mDeleteCheckbox, kAnchor_Right);
       mGridControlOffsetXSlider->SetShowing(false);
       mGridControlOffsetYSlider->SetShowing((mGridControlTarget->GetGridController() != nullptr && kListRowHeight > mGridControlTarget->GetGridController()->NumRows()) || mPush2Connected);
-      mGridControlOffsetXSlider->PositionTo(mStoreCheckbox, kAnchor_Below);
+      mMorphSlider->PositionTo(mStoreCheckbox, kAnchor_Below);
+      mMorphTargetSlider->PositionTo(mMorphSlider, kAnchor_Right);
+      mGridControlOffsetXSlider->PositionTo(mMorphSlider, kAnchor_Below);
       mGridControlOffsetYSlider->PositionTo(mGridControlOffsetXSlider, kAnchor_Right);
    }
 
@@ -173,6 +249,8 @@ void Snapshots::DrawModule()
    mGridControlTarget->Draw();
    mGridControlOffsetXSlider->Draw();
    mGridControlOffsetYSlider->Draw();
+   mMorphSlider->Draw();
+   mMorphTargetSlider->Draw();
 
    if (mDisplayMode == DisplayMode::List)
    {
@@ -446,14 +524,12 @@ void Snapshots::SetSnapshot(int idx, double time)
    for (const auto control : sSnapshotHighlightControls)
       control->SetSnapshotHighlight(false);
    sSnapshotHighlightControls.clear();
-   const SnapshotCollection& coll = mSnapshotCollection[idx];
-   for (const auto& snapshot : coll.mSnapshots)
+   SnapshotCollection& coll = mSnapshotCollection[idx];
+   Compile(coll);
+   for (const auto& compiled : coll.mCompiled)
    {
-      auto context = IClickable::sPathLoadContext;
-      IClickable::sPathLoadContext = GetParent() ? GetParent()->Path() + "~" : "";
-      IUIControl* control = TheSynth->FindUIControl(snapshot.mControlPath);
-      IClickable::sPathLoadContext = context;
-
+      const Snapshot& snapshot = *compiled.mSnapshot;
+      IUIControl* control = UIControlIndex::Get().Resolve(compiled.mHandle);
       if (control)
       {
          if (mBlendTime == 0 ||
@@ -571,6 +647,20 @@ void Snapshots::OnTransportAdvanced(float amount)
 
       mRampMutex.unlock();
    }
+
+   //glide to the morph position over a few ms, so dragging it doesn't step the controls at the ui's frame rate
+   const float kMorphSmoothingMs = 20;
+   mSmoothedMorph += (mMorph - mSmoothedMorph) * (1 - expf(-amount * TheTransport->MsPerBar() / kMorphSmoothingMs));
+   if (fabsf(mMorph - mSmoothedMorph) < .0001f)
+      mSmoothedMorph = mMorph;
+   if (mSmoothedMorph != mAppliedMorph)
+   {
+      mRampMutex.lock();
+      for (const auto& morph : mMorphControls)
+         morph.mUIControl->SetValueDirect(ofLerp(morph.mFrom, morph.mTo, mSmoothedMorph), gTime);
+      mAppliedMorph = mSmoothedMorph;
+      mRampMutex.unlock();
+   }
 }
 
 void Snapshots::PostRepatch(PatchCableSource* cableSource, bool fromUserClick)
@@ -601,6 +691,7 @@ void Snapshots::PostRepatch(PatchCableSource* cableSource, bool fromUserClick)
 
          for (auto& remove : toRemove)
             square.mSnapshots.remove(remove);
+         ++mSnapshotEdits;
       }
    }
 }
@@ -631,6 +722,7 @@ void Snapshots::StoreSnapshot(int idx, bool setAsCurrent)
    SnapshotCollection& coll = mSnapshotCollection[idx];
    coll.mSnapshots.clear();
    coll.mModuleData.clear();
+   ++mSnapshotEdits;
 
    for (int i = 0; i < mSnapshotControls.size(); ++i)
    {
@@ -666,6 +758,7 @@ void Snapshots::DeleteSnapshot(int idx)
    {
       SnapshotCollection& coll = mSnapshotCollection[idx];
       coll.mSnapshots.clear();
+      ++mSnapshotEdits;
       coll.mLabel = ofToString(idx);
       if (mOnlyListFilledSnapshots)
          mCurrentSnapshotSelector->RemoveLabel(idx);
@@ -837,6 +930,8 @@ void Snapshots::ResizeSnapshotCollection(int size)
       mSnapshotCollection.resize(size);
       for (int i = oldSize; i < size; ++i)
          mSnapshotCollection[i].mLabel = ofToString(i);
+      ++mSnapshotEdits;
+      mMorphTargetSlider->SetExtents(0, MAX(size - 1, 1));
 
       if (mDisplayMode == DisplayMode::List)
          mModuleSaveData.SetInt("num_list_snapshots", size);
@@ -846,7 +941,7 @@ void Snapshots::ResizeSnapshotCollection(int size)
 namespace
 {
    const float extraW = 11;
-   const float extraH = 58;
+   const float extraH = 76;
    const float gridSquareDimension = 18;
    const int maxGridSide = 20;
 }
@@ -982,6 +1077,7 @@ void Snapshots::SetUpFromSaveData()
          StoreSnapshot(i, false);
          mSnapshotCollection[i].mLabel = control->GetDisplayValue(i - 1);
          mSnapshotCollection[i].mSnapshots.begin()->mValue = i - 1;
+         ++mSnapshotEdits;
       }
    }
 
@@ -1082,6 +1178,7 @@ void Snapshots::LoadState(FileStreamIn& in, int rev)
    int collSize;
    in >> collSize;
    mSnapshotCollection.resize(collSize);
+   ++mSnapshotEdits;
    for (int i = 0; i < collSize; ++i)
    {
       int snapshotSize;
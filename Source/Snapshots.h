@@ -38,6 +38,7 @@
 #include "TextEntry.h"
 #include "Push2Control.h"
 #include "GridController.h"
+#include "UIControlIndex.h"
 
 
 class Snapshots : public IDrawableModule, public IButtonListener, public IAudioPoller, public IIntSliderListener, public IFloatSliderListener, public IDropdownListener, public INoteReceiver, public ITextEntryListener, public IAbletonGridController, public IGridControllerListener
@@ -114,6 +115,9 @@ private:
    void RandomizeControl(IUIControl* control);
    void UpdateListGrid();
    void ResizeSnapshotCollection(int size);
+   struct SnapshotCollection;
+   void Compile(SnapshotCollection& coll);
+   void UpdateMorph();
 
    //IDrawableModule
    void DrawModule() override;
@@ -159,11 +163,21 @@ private:
       std::string mData;
    };
 
+   //a snapshot entry with its control already looked up, so recalling doesn't have to resolve paths
+   struct CompiledSnapshot
+   {
+      UIControlIndex::Handle mHandle{ UIControlIndex::kInvalidHandle };
+      const Snapshot* mSnapshot{ nullptr };
+   };
+
    struct SnapshotCollection
    {
       std::list<Snapshot> mSnapshots;
       std::list<SnapshotModuleData> mModuleData;
       std::string mLabel;
+      std::vector<CompiledSnapshot> mCompiled; //rebuilt when the snapshots or the layout change, see Compile()
+      int mCompiledEdits{ -1 };
+      int mCompiledGeneration{ -1 };
    };
 
    struct ControlRamp
@@ -172,6 +186,13 @@ private:
       Ramp mRamp;
    };
 
+   struct MorphControl
+   {
+      IUIControl* mUIControl{ nullptr };
+      float mFrom{ 0 };
+      float mTo{ 0 };
+   };
+
    UIGrid* mGrid{ nullptr };
    std::vector<SnapshotCollection> mSnapshotCollection;
    ClickButton* mRandomizeButton{ nullptr };
@@ -185,6 +206,18 @@ private:
    float mBlendProgress{ 0 };
    std::vector<ControlRamp> mBlendRamps;
    ofMutex mRampMutex;
+   int mSnapshotEdits{ 0 }; //bumped whenever stored snapshots change, so compiled ones know to rebuild
+   float mMorph{ 0 };
+   FloatSlider* mMorphSlider{ nullptr };
+   int mMorphTarget{ 1 };
+   IntSlider* mMorphTargetSlider{ nullptr };
+   std::vector<MorphControl> mMorphControls; //controls stored in both the current snapshot and the morph target, with mRampMutex held
+   int mMorphFrom{ -1 }; //what mMorphControls was built for
+   int mMorphTo{ -1 };
+   int mMorphEdits{ -1 };
+   int mMorphGeneration{ -1 };
+   float mSmoothedMorph{ 0 }; //audio thread
+   float mAppliedMorph{ 0 };
    int mCurrentSnapshot{ 0 };
    DropdownList* mCurrentSnapshotSelector{ nullptr };
    PatchCableSource* mModuleCable{ nullptr };
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "PatchCableSource.h"
 #include "ofxJSONElement.h"
 #include "RadioButton.h"
+#include "ModuleHibernation.h"
 
 namespace
 {
@@ -281,6 +282,72 @@ void SongBuilder::Poll()
       }
       mWantRefreshValueDropdowns = false;
    }
+
+   //wake up whatever the next scene is going to enable ahead of time, so it doesn't come in silent while its buffers are restored,
+   //and give everything it's going to touch one chance to allocate and load here, rather than in the boundary buffer
+   bool withinPrefetchBars = false;
+   int upcomingScene = GetUpcomingScene(withinPrefetchBars);
+   if (upcomingScene != -1 && withinPrefetchBars)
+   {
+      PrefetchScene(upcomingScene, upcomingScene != mPrewarmedScene);
+      mPrewarmedScene = upcomingScene;
+   }
+   else
+   {
+      mPrewarmedScene = -1;
+   }
+}
+
+int SongBuilder::GetUpcomingScene(bool& withinPrefetchBars)
+{
+   //a queued scene is at most one quantize interval away, so it gets ready straight away
+   withinPrefetchBars = true;
+   int queuedScene = mQueuedScene;
+   if (queuedScene != -1)
+      return queuedScene;
+
+   int stepIndex = mSequenceStepIndex;
+   if (stepIndex == -1)
+      return -1;
+
+   int nextStep = (mLoopSequence && stepIndex == mSequenceLoopEndIndex && mSequenceLoopEndIndex >= mSequenceLoopStartIndex) ? mSequenceLoopStartIndex : stepIndex + 1;
+   if (nextStep >= kMaxSequencerScenes)
+      return -1;
+
+   int measure = TheTransport->GetMeasure(gTime + TheTransport->GetListenerInfo(this)->mOffsetInfo.mOffset);
+   withinPrefetchBars = mSequencerStepLength[stepIndex] - measure <= mPrefetchBars;
+   for (int i = 0; i < (int)mScenes.size(); ++i)
+   {
+      if (mScenes[i]->mId == mSequencerSceneId[nextStep])
+         return i;
+   }
+   return -1;
+}
+
+void SongBuilder::PrefetchScene(int sceneIndex, bool prewarm)
+{
+   if (sceneIndex < 0 || sceneIndex >= (int)mScenes.size())
+      return;
+
+   for (int i = 0; i < (int)mTargets.size(); ++i)
+   {
+      bool isCheckbox = mTargets[i]->mDisplayType == ControlTarget::DisplayType::Checkbox;
+      bool turnsOn = isCheckbox && mScenes[sceneIndex]->mValues[i]->mBoolValue;
+      if (!turnsOn && (!prewarm || isCheckbox)) //nothing to get ready for a module that's being turned off
+         continue;
+
+      for (auto& cable : mTargets[i]->mCable->GetPatchCables())
+      {
+         IUIControl* target = dynamic_cast<IUIControl*>(cable->GetTarget());
+         IDrawableModule* module = target != nullptr ? target->GetModuleParent() : nullptr;
+         if (module == nullptr)
+            continue;
+         if (turnsOn && module->GetEnabledCheckbox() == target)
+            ModuleHibernation::Get().Prefetch(module);
+         if (prewarm)
+            module->Prewarm();
+      }
+   }
 }
 
 void SongBuilder::OnTimeEvent(double time)
@@ -832,6 +899,7 @@ void SongBuilder::IntSliderUpdated(IntSlider* slider, int oldVal, double time)
 void SongBuilder::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadBool("reset_transport_every_sequencer_scene", moduleInfo, true);
+   mModuleSaveData.LoadInt("prefetch_bars", moduleInfo, 2, 1, 16, K(isTextField));
 
    if (IsSpawningOnTheFly(moduleInfo))
    {
@@ -854,6 +922,7 @@ void SongBuilder::LoadLayout(const ofxJSONElement& moduleInfo)
 void SongBuilder::SetUpFromSaveData()
 {
    mResetOnSceneChange = mModuleSaveData.GetBool("reset_transport_every_sequencer_scene");
+   mPrefetchBars = mModuleSaveData.GetInt("prefetch_bars");
 }
 
 void SongBuilder::SaveState(FileStreamOut& out)
@@ -92,6 +92,8 @@ private:
    bool ShouldSavePatchCableSources() const override { return false; }
 
    void SetActiveScene(double time, int newScene);
+   void PrefetchScene(int sceneIndex, bool prewarm); //main thread
+   int GetUpcomingScene(bool& withinPrefetchBars);
    void SetActiveSceneById(double time, int newSceneId);
    void DuplicateScene(int sceneIndex);
    void AddTarget();
@@ -203,6 +205,8 @@ private:
    bool mUseSequencer{ false };
    Checkbox* mUseSequencerCheckbox{ nullptr };
    bool mResetOnSceneChange{ true };
+   int mPrefetchBars{ 2 }; //how far ahead of a sequenced scene its modules get ready
+   int mPrewarmedScene{ -1 };
    bool mActivateFirstSceneOnStop{ true };
    Checkbox* mActivateFirstSceneOnStopCheckbox{ nullptr };
    NoteInterval mChangeQuantizeInterval{ NoteInterval::kInterval_1n };
@@ -0,0 +1,447 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SpawnIndex.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SpawnIndex.h"
+#include "EffectFactory.h"
+#include "MidiController.h"
+#include "ModularSynth.h"
+#include "PresetLibrary.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+#include "VSTPlugin.h"
+#include "ofxJSONElement.h"
+
+#include <algorithm>
+
+namespace
+{
+   const int kMaxQuickspawnVstCount = 10;
+   const int kMaxRecentFirst = 3; //how many of the most recently spawned matches go ahead of the alphabetical ones
+
+   std::string ToLower(const std::string& str)
+   {
+      return juce::String(str).toLowerCase().toStdString();
+   }
+
+   uint32_t Trigram(const std::string& str, size_t pos)
+   {
+      return (uint32_t)(unsigned char)str[pos] | ((uint32_t)(unsigned char)str[pos + 1] << 8) | ((uint32_t)(unsigned char)str[pos + 2] << 16);
+   }
+
+   //the first key is the first letter, and the rest have to come in order in the first word
+   bool CheckHeldKeysMatch(const std::string& lowerName, const std::string& heldKeys)
+   {
+      juce::String name(lowerName);
+
+      if (name.isEmpty() || heldKeys.empty())
+         return false;
+
+      if (name[0] != heldKeys[0])
+         return false;
+
+      int stringPos = 0;
+      int end = name.indexOfChar('.');
+      if (end == -1)
+         end = name.indexOfChar(' ');
+      if (end == -1)
+         end = name.length() - 1;
+      for (size_t j = 1; j < heldKeys.length(); ++j)
+      {
+         stringPos = name.substring(stringPos + 1, end + 1).indexOfChar(heldKeys[j]);
+         if (stringPos == -1) //couldn't find key in remaining string
+            return false;
+      }
+
+      return true;
+   }
+}
+
+void SpawnIndex::Group::Set(std::vector<ModuleFactory::Spawnable> spawnables, const std::vector<bool>& hidden)
+{
+   mEntries.clear();
+   mEntries.reserve(spawnables.size());
+   mTrigrams.clear();
+   mByFirstChar.clear();
+
+   for (int i = 0; i < (int)spawnables.size(); ++i)
+   {
+      Entry entry;
+      entry.mLowerLabel = ToLower(spawnables[i].mLabel);
+      entry.mRecencyKey = GetRecencyKey(spawnables[i]);
+      entry.mIsHidden = i < (int)hidden.size() && hidden[i];
+      entry.mSpawnable = std::move(spawnables[i]);
+
+      const std::string& label = entry.mLowerLabel;
+      if (!label.empty())
+         mByFirstChar[label[0]].push_back(i);
+      for (size_t pos = 0; pos + 3 <= label.size(); ++pos)
+      {
+         auto& entries = mTrigrams[Trigram(label, pos)];
+         if (entries.empty() || entries.back() != i)
+            entries.push_back(i);
+      }
+
+      mEntries.push_back(std::move(entry));
+   }
+}
+
+void SpawnIndex::Group::Find(const std::string& keys, bool continuousString, std::vector<const Entry*>& matches) const
+{
+   if (keys.empty())
+      return;
+
+   if (!continuousString)
+   {
+      auto candidates = mByFirstChar.find(keys[0]);
+      if (candidates != mByFirstChar.end())
+      {
+         for (int i : candidates->second)
+         {
+            if (CheckHeldKeysMatch(mEntries[i].mLowerLabel, keys))
+               matches.push_back(&mEntries[i]);
+         }
+      }
+      return;
+   }
+
+   if (keys.size() < 3)
+   {
+      for (const auto& entry : mEntries)
+      {
+         if (entry.mLowerLabel.find(keys) != std::string::npos)
+            matches.push_back(&entry);
+      }
+      return;
+   }
+
+   //only the entries that have the search's rarest three letters in them need checking
+   const std::vector<int>* candidates = nullptr;
+   for (size_t pos = 0; pos + 3 <= keys.size(); ++pos)
+   {
+      auto entries = mTrigrams.find(Trigram(keys, pos));
+      if (entries == mTrigrams.end())
+         return;
+      if (candidates == nullptr || entries->second.size() < candidates->size())
+         candidates = &entries->second;
+   }
+
+   for (int i : *candidates)
+   {
+      if (mEntries[i].mLowerLabel.find(keys) != std::string::npos)
+         matches.push_back(&mEntries[i]);
+   }
+}
+
+SpawnIndex::SpawnIndex(const std::map<std::string, ModuleFactory::ModuleInfo>& factoryMap)
+: mFactoryMap(factoryMap)
+{
+}
+
+SpawnIndex::~SpawnIndex()
+{
+   Shutdown();
+}
+
+void SpawnIndex::Shutdown()
+{
+   if (mListeningTo != nullptr)
+      mListeningTo->removeChangeListener(this);
+   mListeningTo = nullptr;
+}
+
+void SpawnIndex::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+   mPluginsChanged = true;
+}
+
+void SpawnIndex::Refresh()
+{
+   if (!mBuilt)
+   {
+      //the module and effect types don't change after startup
+      std::vector<ModuleFactory::Spawnable> modules;
+      std::vector<bool> hidden;
+      for (const auto& iter : mFactoryMap)
+      {
+         ModuleFactory::Spawnable spawnable{};
+         spawnable.mLabel = iter.first;
+         modules.push_back(spawnable);
+         hidden.push_back(iter.second.mIsHidden);
+      }
+      mModules.Set(modules, hidden);
+
+      std::vector<ModuleFactory::Spawnable> effects;
+      for (const auto& effect : TheSynth->GetEffectFactory()->GetSpawnableEffects())
+      {
+         ModuleFactory::Spawnable spawnable{};
+         spawnable.mLabel = effect;
+         spawnable.mDecorator = ModuleFactory::kEffectChainSuffix;
+         spawnable.mSpawnMethod = ModuleFactory::SpawnMethod::EffectChain;
+         effects.push_back(spawnable);
+      }
+      mEffects.Set(effects);
+
+      mListeningTo = &TheSynth->GetKnownPluginList();
+      mListeningTo->addChangeListener(this);
+      mBuilt = true;
+   }
+
+   RefreshPlugins();
+   RefreshPrefabs();
+   RefreshPresets();
+   RefreshMidiControllers();
+}
+
+void SpawnIndex::RefreshPlugins()
+{
+   if (!mPluginsChanged && mPluginPreferenceOrder == UserPrefs.plugin_preference_order.Get())
+      return;
+   mPluginsChanged = false;
+   mPluginPreferenceOrder = UserPrefs.plugin_preference_order.Get();
+
+   std::vector<juce::PluginDescription> vsts;
+   VSTLookup::GetAvailableVSTs(vsts);
+   mPluginSpawnables.clear();
+   mPluginIndexById.clear();
+   for (auto& pluginDesc : vsts)
+   {
+      ModuleFactory::Spawnable spawnable{};
+      spawnable.mLabel = pluginDesc.name.toStdString();
+      spawnable.mDecorator = "[" + ModuleFactory::Spawnable::GetPluginLabel(pluginDesc) + "]";
+      spawnable.mPluginDesc = pluginDesc;
+      spawnable.mSpawnMethod = ModuleFactory::SpawnMethod::Plugin;
+      mPluginIndexById[pluginDesc.createIdentifierString().toStdString()] = (int)mPluginSpawnables.size();
+      mPluginSpawnables.push_back(spawnable);
+   }
+   mPlugins.Set(mPluginSpawnables);
+
+   //when each plugin was last used is kept across sessions by VSTPlugin
+   if (juce::File(ofToDataPath("vst/recent_plugins.json")).existsAsFile())
+   {
+      ofxJSONElement root;
+      root.open(ofToDataPath("vst/recent_plugins.json"));
+      ofxJSONElement jsonList = root["vsts"];
+
+      for (auto it = jsonList.begin(); it != jsonList.end(); ++it)
+      {
+         try
+         {
+            std::string id = it.key().asString();
+            mLastUsedMs[id] = MAX(mLastUsedMs[id], jsonList[id].asDouble());
+         }
+         catch (Json::LogicError& e)
+         {
+            TheSynth->LogEvent(__PRETTY_FUNCTION__ + std::string(" json error: ") + e.what(), kLogEventType_Error);
+         }
+      }
+   }
+}
+
+void SpawnIndex::RefreshPrefabs()
+{
+   int revision = PresetLibrary::Get().GetRevision();
+   if (revision == mPrefabsRevision)
+      return;
+   mPrefabsRevision = revision;
+
+   std::vector<ModuleFactory::Spawnable> prefabs;
+   ModuleFactory::GetPrefabs(prefabs);
+   mPrefabs.Set(prefabs);
+}
+
+void SpawnIndex::RefreshPresets()
+{
+   int revision = PresetLibrary::Get().GetRevision();
+   if (revision == mPresetsRevision)
+      return;
+   mPresetsRevision = revision;
+
+   std::vector<ModuleFactory::Spawnable> presets;
+   ModuleFactory::GetPresets(presets);
+   mPresets.Set(presets);
+}
+
+void SpawnIndex::RefreshMidiControllers()
+{
+   std::vector<std::string> devices = MidiController::GetAvailableInputDevices();
+   if (devices == mMidiControllerNames)
+      return;
+   mMidiControllerNames = devices;
+
+   std::vector<ModuleFactory::Spawnable> midicontrollers;
+   for (const auto& device : devices)
+   {
+      ModuleFactory::Spawnable spawnable{};
+      spawnable.mLabel = device;
+      spawnable.mDecorator = ModuleFactory::kMidiControllerSuffix;
+      spawnable.mSpawnMethod = ModuleFactory::SpawnMethod::MidiController;
+      midicontrollers.push_back(spawnable);
+   }
+   mMidiControllers.Set(midicontrollers);
+}
+
+std::vector<ModuleFactory::Spawnable> SpawnIndex::Search(std::string keys, bool continuousString)
+{
+   if (!mBuilt)
+      Refresh();
+
+   keys = ToLower(keys);
+   if (keys.empty())
+      return {};
+
+   std::vector<const Entry*> matches;
+
+   std::vector<const Entry*> modules;
+   mModules.Find(keys, continuousString, modules);
+   for (const auto* entry : modules)
+   {
+      if (!entry->mIsHidden || gShowDevModules)
+         matches.push_back(entry);
+   }
+
+   //there can be thousands of plugins, so only the ones used most recently make it in
+   std::vector<const Entry*> plugins;
+   mPlugins.Find(keys, continuousString, plugins);
+   if ((int)plugins.size() > kMaxQuickspawnVstCount)
+   {
+      std::stable_sort(plugins.begin(), plugins.end(), [this](const Entry* a, const Entry* b)
+                       {
+                          return GetLastUsedMs(a) > GetLastUsedMs(b);
+                       });
+      plugins.resize(kMaxQuickspawnVstCount);
+   }
+   matches.insert(matches.end(), plugins.begin(), plugins.end());
+
+   //';' lists every prefab and preset
+   if (keys[0] == ';')
+   {
+      for (const auto& entry : mPrefabs.mEntries)
+         matches.push_back(&entry);
+   }
+   else
+   {
+      mPrefabs.Find(keys, continuousString, matches);
+   }
+
+   mMidiControllers.Find(keys, continuousString, matches);
+   mEffects.Find(keys, continuousString, matches);
+
+   if (keys[0] == ';')
+   {
+      for (const auto& entry : mPresets.mEntries)
+         matches.push_back(&entry);
+   }
+   else
+   {
+      mPresets.Find(keys, continuousString, matches);
+   }
+
+   //the same order as Spawnable::CompareAlphabetical, without copying the spawnables to compare them
+   std::sort(matches.begin(), matches.end(), [](const Entry* a, const Entry* b)
+             {
+                if (a->mLowerLabel == b->mLowerLabel)
+                   return a->mSpawnable.mDecorator < b->mSpawnable.mDecorator;
+                return a->mLowerLabel < b->mLowerLabel;
+             });
+
+   //the few that were spawned most recently go first, the rest stay alphabetical so the list doesn't jump around
+   std::vector<const Entry*> recent;
+   for (const auto* entry : matches)
+   {
+      if (GetLastUsedMs(entry) > 0)
+         recent.push_back(entry);
+   }
+   std::stable_sort(recent.begin(), recent.end(), [this](const Entry* a, const Entry* b)
+                    {
+                       return GetLastUsedMs(a) > GetLastUsedMs(b);
+                    });
+   if ((int)recent.size() > kMaxRecentFirst)
+      recent.resize(kMaxRecentFirst);
+
+   std::vector<ModuleFactory::Spawnable> ret;
+   ret.reserve(matches.size());
+   for (const auto* entry : recent)
+      ret.push_back(entry->mSpawnable);
+   for (const auto* entry : matches)
+   {
+      if (!VectorContains(entry, recent))
+         ret.push_back(entry->mSpawnable);
+   }
+   return ret;
+}
+
+void SpawnIndex::NoteSpawned(const ModuleFactory::Spawnable& spawnable)
+{
+   mLastUsedMs[GetRecencyKey(spawnable)] = (double)juce::Time::currentTimeMillis();
+}
+
+const std::vector<ModuleFactory::Spawnable>& SpawnIndex::GetPlugins()
+{
+   Refresh();
+   return mPluginSpawnables;
+}
+
+std::vector<ModuleFactory::Spawnable> SpawnIndex::GetRecentPlugins(int num)
+{
+   Refresh();
+
+   std::vector<std::pair<double, std::string>> lastUsed;
+   for (const auto& iter : mLastUsedMs)
+   {
+      if (mPluginIndexById.find(iter.first) != mPluginIndexById.end())
+         lastUsed.push_back(std::make_pair(iter.second, iter.first));
+   }
+   std::sort(lastUsed.rbegin(), lastUsed.rend());
+
+   std::vector<ModuleFactory::Spawnable> recentPlugins;
+   for (int i = 0; i < (int)lastUsed.size() && i < num; ++i)
+      recentPlugins.push_back(mPluginSpawnables[mPluginIndexById[lastUsed[i].second]]);
+   return recentPlugins;
+}
+
+std::vector<ModuleFactory::Spawnable> SpawnIndex::GetPrefabs()
+{
+   Refresh();
+
+   std::vector<ModuleFactory::Spawnable> prefabs;
+   for (const auto& entry : mPrefabs.mEntries)
+      prefabs.push_back(entry.mSpawnable);
+   return prefabs;
+}
+
+double SpawnIndex::GetLastUsedMs(const Entry* entry) const
+{
+   auto lastUsed = mLastUsedMs.find(entry->mRecencyKey);
+   return lastUsed != mLastUsedMs.end() ? lastUsed->second : 0;
+}
+
+//static
+std::string SpawnIndex::GetRecencyKey(const ModuleFactory::Spawnable& spawnable)
+{
+   if (spawnable.mSpawnMethod == ModuleFactory::SpawnMethod::Plugin)
+      return spawnable.mPluginDesc.createIdentifierString().toStdString();
+   return spawnable.mLabel + " " + spawnable.mDecorator;
+}
@@ -0,0 +1,101 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SpawnIndex.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ModuleFactory.h"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//everything that can be spawned from the quickspawn menu and the title bar spawn lists, kept indexed so that a search
+//doesn't have to go to disk or ask the os for midi devices on every key press. each kind of spawnable is its own group,
+//and a group is only rebuilt when what it came from has changed. results lead with what was spawned most recently
+class SpawnIndex : public juce::ChangeListener
+{
+public:
+   explicit SpawnIndex(const std::map<std::string, ModuleFactory::ModuleInfo>& factoryMap);
+   ~SpawnIndex() override;
+
+   void Refresh(); //picks up new plugins, prefabs, presets and midi devices. cheap when nothing has changed, call it when a spawn menu opens
+   void Shutdown(); //before the known plugin list goes away
+   std::vector<ModuleFactory::Spawnable> Search(std::string keys, bool continuousString);
+   void NoteSpawned(const ModuleFactory::Spawnable& spawnable);
+
+   const std::vector<ModuleFactory::Spawnable>& GetPlugins();
+   std::vector<ModuleFactory::Spawnable> GetRecentPlugins(int num);
+   std::vector<ModuleFactory::Spawnable> GetPrefabs();
+
+private:
+   struct Entry
+   {
+      ModuleFactory::Spawnable mSpawnable;
+      std::string mLowerLabel;
+      std::string mRecencyKey;
+      bool mIsHidden{ false };
+   };
+
+   struct Group
+   {
+      void Set(std::vector<ModuleFactory::Spawnable> spawnables, const std::vector<bool>& hidden = {});
+      void Find(const std::string& keys, bool continuousString, std::vector<const Entry*>& matches) const;
+
+      std::vector<Entry> mEntries;
+      std::unordered_map<uint32_t, std::vector<int>> mTrigrams; //the entries that contain each three byte sequence, for substring searches
+      std::unordered_map<char, std::vector<int>> mByFirstChar; //for held key searches, which always match the first letter
+   };
+
+   void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+
+   void RefreshPlugins();
+   void RefreshPrefabs();
+   void RefreshPresets();
+   void RefreshMidiControllers();
+   double GetLastUsedMs(const Entry* entry) const;
+   static std::string GetRecencyKey(const ModuleFactory::Spawnable& spawnable);
+
+   const std::map<std::string, ModuleFactory::ModuleInfo>& mFactoryMap;
+   bool mBuilt{ false };
+   Group mModules;
+   Group mEffects;
+   Group mPlugins;
+   Group mPrefabs;
+   Group mPresets;
+   Group mMidiControllers;
+
+   juce::KnownPluginList* mListeningTo{ nullptr };
+   bool mPluginsChanged{ true };
+   std::string mPluginPreferenceOrder;
+   std::vector<ModuleFactory::Spawnable> mPluginSpawnables;
+   std::unordered_map<std::string, int> mPluginIndexById;
+   int mPrefabsRevision{ -1 }; //of PresetLibrary, which has both
+   int mPresetsRevision{ -1 };
+   std::vector<std::string> mMidiControllerNames;
+
+   std::unordered_map<std::string, double> mLastUsedMs; //plugins by identifier string, everything else by label and decorator
+};
@@ -27,38 +27,40 @@
 
 #include "SpectralDisplay.h"
 #include "ModularSynth.h"
+#include "ModuleRenderCache.h"
 #include "Profiler.h"
 
+#include "nanovg/nanovg.h"
+
 namespace
 {
    const int kNumFFTBins = 1024;
+   const int kHopSize = kNumFFTBins / 2;
    const int kBinIgnore = 2;
 };
 
 SpectralDisplay::SpectralDisplay()
 : IAudioProcessor(gBufferSize)
 , IDrawableModule(400, 100)
-, mFFT(kNumFFTBins)
-, mFFTData(kNumFFTBins, kNumFFTBins / 2 + 1)
-, mRollingInputBuffer(kNumFFTBins)
+, mSmoother(new float[kNumFFTBins / 2 + 1 - kBinIgnore]())
+, mAnalyzer(kNumFFTBins, kHopSize, [this](const float* amplitudes, int numBins)
+            { FillTap(amplitudes, numBins); })
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[kNumFFTBins];
-   for (int i = 0; i < kNumFFTBins; ++i)
-      mWindower[i] = -.5f * cos(FTWO_PI * i / kNumFFTBins) + .5f;
-   mSmoother = new float[kNumFFTBins / 2 + 1 - kBinIgnore];
-   for (int i = 0; i < kNumFFTBins / 2 + 1 - kBinIgnore; ++i)
-      mSmoother[i] = 0;
 }
 
 void SpectralDisplay::CreateUIControls()
 {
    IDrawableModule::CreateUIControls();
+
+   mModeSelector = new DropdownList(this, "mode", 3, 3, (int*)(&mMode));
+   mModeSelector->AddLabel("spectrum", (int)Mode::Spectrum);
+   mModeSelector->AddLabel("spectrogram", (int)Mode::Spectrogram);
 }
 
 SpectralDisplay::~SpectralDisplay()
 {
-   delete[] mWindower;
+   if (mSpectrogramImage != -1)
+      ModuleRenderCache::RetireImage(mSpectrogramImage);
    delete[] mSmoother;
 }
 
@@ -80,15 +82,9 @@ void SpectralDisplay::Process(double time)
             Add(gWorkBuffer, GetBuffer()->GetChannel(ch), GetBuffer()->BufferSize());
       }
 
-      mRollingInputBuffer.WriteChunk(gWorkBuffer, GetBuffer()->BufferSize(), 0);
-
-      //copy rolling input buffer into working buffer and window it
-      mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, kNumFFTBins, 0, 0);
-      Mult(mFFTData.mTimeDomain, mWindower, kNumFFTBins);
-
-      mFFT.Forward(mFFTData.mTimeDomain,
-                   mFFTData.mRealValues,
-                   mFFTData.mImaginaryValues);
+      //the ffts happen on the analysis thread
+      mAnalyzer.SetSpectrogramEnabled(mMode == Mode::Spectrogram);
+      mAnalyzer.Push(gWorkBuffer, GetBuffer()->BufferSize());
    }
 
    IAudioReceiver* target = GetTarget();
@@ -105,31 +101,80 @@ void SpectralDisplay::Process(double time)
    GetBuffer()->Reset();
 }
 
+void SpectralDisplay::FillTap(const float* amplitudes, int numBins)
+{
+   VisualizationTap::Frame* frame = mTap.BeginFrame();
+   if (frame == nullptr)
+      return;
+
+   //bins are spread out on a square root scale, so the high end packs many bins into each column. keep the loudest of them
+   int end = numBins;
+   int numColumns = MIN(mTap.GetResolution(), VisualizationTap::kMaxPoints / 2);
+   float smoothed[VisualizationTap::kMaxPoints / 2];
+   int lastColumn = -1;
+   for (int i = kBinIgnore; i < end; i++)
+   {
+      float x = sqrtf(float(i - kBinIgnore) / (end - kBinIgnore - 1));
+      float samp = sqrtf(amplitudes[i] * (kNumFFTBins / 4) / end) * 3; //scaled back to the raw fft magnitude, which the display was tuned to
+      mSmoother[i - kBinIgnore] = ofLerp(mSmoother[i - kBinIgnore], samp, .1f);
+
+      int column = MIN(int(x * numColumns), numColumns - 1);
+      if (column == lastColumn)
+      {
+         int point = frame->mNumPoints - 1;
+         frame->mPoints[point].y = MAX(frame->mPoints[point].y, samp);
+         smoothed[point] = MAX(smoothed[point], mSmoother[i - kBinIgnore]);
+      }
+      else
+      {
+         smoothed[frame->mNumPoints] = mSmoother[i - kBinIgnore];
+         frame->AddPoint(ofVec2f(x, samp));
+         lastColumn = column;
+      }
+   }
+
+   int numRawPoints = frame->mNumPoints;
+   for (int i = 0; i < numRawPoints; ++i)
+      frame->AddPoint(ofVec2f(frame->mPoints[i].x, smoothed[i]));
+
+   mTap.PublishFrame();
+}
+
 void SpectralDisplay::DrawModule()
 {
    if (Minimized() || IsVisible() == false || !mEnabled)
       return;
 
-   ofPushStyle();
-   ofPushMatrix();
-
    float w, h;
    GetDimensions(w, h);
 
+   if (mMode == Mode::Spectrogram)
+      DrawSpectrogram(w, h);
+   else
+      DrawSpectrum(w, h);
+
+   mModeSelector->Draw();
+}
+
+void SpectralDisplay::DrawSpectrum(float w, float h)
+{
+   ofPushStyle();
+   ofPushMatrix();
+
    ofSetColor(255, 255, 255);
    ofSetLineWidth(1);
 
+   mTap.SetResolution(w * gDrawScale);
+   const VisualizationTap::Frame& frame = mTap.GetLatestFrame();
+   int numRawPoints = frame.mNumPoints / 2;
+
    //raw
-   int end = kNumFFTBins / 2 + 1;
    ofBeginShape();
-   for (int i = kBinIgnore; i < end; i++)
+   for (int i = 0; i < numRawPoints; i++)
    {
-      float x = sqrtf(float(i - kBinIgnore) / (end - kBinIgnore - 1)) * w;
-      float samp = sqrtf(fabsf(mFFTData.mRealValues[i]) / end) * 3;
-      float y = ofClamp(samp, 0, 1) * h;
+      float x = frame.mPoints[i].x * w;
+      float y = ofClamp(frame.mPoints[i].y, 0, 1) * h;
       ofVertex(x, h - y);
-
-      mSmoother[i - kBinIgnore] = ofLerp(mSmoother[i - kBinIgnore], samp, .1f);
    }
    ofEndShape(false);
 
@@ -138,10 +183,10 @@ void SpectralDisplay::DrawModule()
 
    //smoothed
    ofBeginShape();
-   for (int i = kBinIgnore; i < end; i++)
+   for (int i = numRawPoints; i < numRawPoints * 2; i++)
    {
-      float x = sqrtf(float(i - kBinIgnore) / (end - kBinIgnore - 1)) * w;
-      float y = ofClamp(mSmoother[i - kBinIgnore], 0, 1) * h;
+      float x = frame.mPoints[i].x * w;
+      float y = ofClamp(frame.mPoints[i].y, 0, 1) * h;
       ofVertex(x, h - y);
    }
    ofEndShape(false);
@@ -150,6 +195,34 @@ void SpectralDisplay::DrawModule()
    ofPopStyle();
 }
 
+void SpectralDisplay::DrawSpectrogram(float w, float h)
+{
+   const int columns = SpectrumAnalyzer::kSpectrogramColumns;
+   const int rows = SpectrumAnalyzer::kSpectrogramRows;
+   if (mSpectrogramImage == -1)
+   {
+      mSpectrogramPixels.assign(columns * rows, SpectrumAnalyzer::GetSpectrogramBackground());
+      mSpectrogramImage = nvgCreateImageRGBA(gNanoVG, columns, rows, NVG_IMAGE_REPEATX, (const unsigned char*)mSpectrogramPixels.data());
+      if (mSpectrogramImage == 0)
+      {
+         mSpectrogramImage = -1;
+         return;
+      }
+   }
+
+   if (mAnalyzer.CopySpectrogramColumns(mSpectrogramPixels.data(), mSpectrogramColumnsCopied))
+      nvgUpdateImage(gNanoVG, mSpectrogramImage, (const unsigned char*)mSpectrogramPixels.data());
+
+   //the texture repeats horizontally, so shifting it puts the newest column at the right edge, with the oldest wrapping round behind it
+   float columnWidth = w / columns;
+   int newestColumn = (int)((mSpectrogramColumnsCopied + columns - 1) % columns);
+   NVGpaint paint = nvgImagePattern(gNanoVG, w - (newestColumn + 1) * columnWidth, 0, w, h, 0, mSpectrogramImage, gModuleDrawAlpha / 255.0f);
+   nvgBeginPath(gNanoVG);
+   nvgRect(gNanoVG, 0, 0, w, h);
+   nvgFillPaint(gNanoVG, paint);
+   nvgFill(gNanoVG);
+}
+
 void SpectralDisplay::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
@@ -30,10 +30,11 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Slider.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "DropdownList.h"
+#include "SpectrumAnalyzer.h"
+#include "VisualizationTap.h"
 
-class SpectralDisplay : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener
+class SpectralDisplay : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public IDropdownListener
 {
 public:
    SpectralDisplay();
@@ -47,6 +48,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //displays its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    bool IsResizable() const override { return true; }
@@ -56,6 +58,7 @@ public:
    void SetUpFromSaveData() override;
 
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
+   void DropdownUpdated(DropdownList* list, int oldVal, double time) override {}
 
    bool IsEnabled() const override { return mEnabled; }
 
@@ -63,10 +66,28 @@ private:
    //IDrawableModule
    void DrawModule() override;
 
-   float* mWindower{ nullptr };
-   float* mSmoother{ nullptr };
+   void FillTap(const float* amplitudes, int numBins);
+   void DrawSpectrum(float w, float h);
+   void DrawSpectrogram(float w, float h);
 
-   ::FFT mFFT;
-   FFTData mFFTData;
-   RollingBuffer mRollingInputBuffer;
+   enum class Mode
+   {
+      Spectrum,
+      Spectrogram
+   };
+
+   Mode mMode{ Mode::Spectrum };
+   DropdownList* mModeSelector{ nullptr };
+
+   float* mSmoother{ nullptr }; //analysis thread only, advanced once per hop
+
+   //the raw spectrum, one point per column that has any bins in it, followed by the smoothed spectrum at the same x positions
+   VisualizationTap mTap;
+
+   //render thread. the spectrogram ring as a texture, drawn as one textured rect that wraps around at the newest column
+   int mSpectrogramImage{ -1 };
+   std::vector<uint32_t> mSpectrogramPixels;
+   int64_t mSpectrogramColumnsCopied{ 0 };
+
+   SpectrumAnalyzer mAnalyzer; //last, so its callbacks stop before anything they use is destroyed
 };
@@ -0,0 +1,269 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+#include "SynthGlobals.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+   const int kNumBlocks = 32; //how many buffers the analysis thread can fall behind by before input is dropped
+   const int kAnalysisSleepMs = 5;
+   const int kFirstBin = 1; //dc isn't worth a row
+   const float kFloorDb = -90; //the bottom of the colormap
+
+   //close to matplotlib's inferno: black, through purple and red, to pale yellow. as rgba bytes in memory order, the way nanovg takes them
+   const std::array<uint32_t, 256>& GetColormap()
+   {
+      static const std::array<uint32_t, 256> sColormap = []
+      {
+         const float stops[][3] = { { 0, 0, 4 }, { 87, 16, 110 }, { 188, 55, 84 }, { 249, 142, 9 }, { 252, 255, 164 } };
+         const int numSegments = (int)(sizeof(stops) / sizeof(stops[0])) - 1;
+         std::array<uint32_t, 256> colormap{};
+         for (int i = 0; i < 256; ++i)
+         {
+            float position = i / 255.0f * numSegments;
+            int segment = MIN((int)position, numSegments - 1);
+            float t = position - segment;
+            uint32_t pixel = 0xff000000u;
+            for (int component = 0; component < 3; ++component)
+            {
+               float value = ofLerp(stops[segment][component], stops[segment + 1][component], t);
+               pixel |= (uint32_t)(value + .5f) << (component * 8);
+            }
+            colormap[i] = pixel;
+         }
+         return colormap;
+      }();
+      return sColormap;
+   }
+}
+
+//runs the ffts of every analyzer. started with the first analyzer, and stopped once the last one goes away
+class SpectrumAnalysisThread
+{
+public:
+   static void Add(SpectrumAnalyzer* analyzer);
+   static void Remove(SpectrumAnalyzer* analyzer);
+
+private:
+   static void Loop();
+
+   static std::mutex sLifecycleMutex; //analyzers come and go on the main thread, this only keeps a start from overlapping a stop
+   static std::mutex sMutex; //held while analyzing, so an analyzer can't be deleted halfway through
+   static std::vector<SpectrumAnalyzer*> sAnalyzers;
+   static std::thread sThread;
+   static std::atomic<bool> sStop;
+};
+
+std::mutex SpectrumAnalysisThread::sLifecycleMutex;
+std::mutex SpectrumAnalysisThread::sMutex;
+std::vector<SpectrumAnalyzer*> SpectrumAnalysisThread::sAnalyzers;
+std::thread SpectrumAnalysisThread::sThread;
+std::atomic<bool> SpectrumAnalysisThread::sStop{ false };
+
+void SpectrumAnalysisThread::Add(SpectrumAnalyzer* analyzer)
+{
+   std::lock_guard<std::mutex> lifecycleLock(sLifecycleMutex);
+   {
+      std::lock_guard<std::mutex> lock(sMutex);
+      sAnalyzers.push_back(analyzer);
+   }
+   if (!sThread.joinable())
+   {
+      sStop = false;
+      sThread = std::thread(&SpectrumAnalysisThread::Loop);
+   }
+}
+
+void SpectrumAnalysisThread::Remove(SpectrumAnalyzer* analyzer)
+{
+   std::lock_guard<std::mutex> lifecycleLock(sLifecycleMutex);
+   bool empty;
+   {
+      std::lock_guard<std::mutex> lock(sMutex);
+      sAnalyzers.erase(std::remove(sAnalyzers.begin(), sAnalyzers.end(), analyzer), sAnalyzers.end());
+      empty = sAnalyzers.empty();
+   }
+   if (empty && sThread.joinable())
+   {
+      sStop = true;
+      sThread.join();
+   }
+}
+
+void SpectrumAnalysisThread::Loop()
+{
+   while (!sStop)
+   {
+      {
+         std::lock_guard<std::mutex> lock(sMutex);
+         for (auto* analyzer : sAnalyzers)
+            analyzer->Analyze();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(kAnalysisSleepMs));
+   }
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(int windowSize, int hopSize, std::function<void(const float* amplitudes, int numBins)> onSpectrum)
+: mPlan(FFTPlan::Get(windowSize))
+, mHopSize(hopSize)
+, mNumBins(windowSize / 2 + 1)
+, mOnSpectrum(std::move(onSpectrum))
+, mBlockSize(gBufferSize)
+, mBlocks(kNumBlocks)
+, mFilledBlocks(kNumBlocks)
+, mFreeBlocks(kNumBlocks)
+, mWindow(windowSize)
+, mSamplesUntilHop(hopSize)
+, mFrame(windowSize)
+, mRe(mNumBins)
+, mIm(mNumBins)
+, mScratch(mPlan.GetScratchSize())
+, mAmplitudes(mNumBins)
+, mRowFirstBin(kSpectrogramRows)
+, mRowEndBin(kSpectrogramRows)
+, mSpectrogramColumns(kSpectrogramColumns * kSpectrogramRows, GetSpectrogramBackground())
+{
+   for (auto& block : mBlocks)
+   {
+      block.mData.resize(mBlockSize);
+      mFreeBlocks.enqueue(&block);
+   }
+
+   int span = mNumBins - kFirstBin;
+   for (int row = 0; row < kSpectrogramRows; ++row)
+   {
+      float bottom = row / (float)kSpectrogramRows;
+      float top = (row + 1) / (float)kSpectrogramRows;
+      mRowFirstBin[row] = kFirstBin + (int)(bottom * bottom * span);
+      mRowEndBin[row] = MAX(mRowFirstBin[row] + 1, kFirstBin + (int)(top * top * span));
+   }
+
+   SpectrumAnalysisThread::Add(this);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+   SpectrumAnalysisThread::Remove(this);
+}
+
+void SpectrumAnalyzer::Push(const float* input, int bufferSize)
+{
+   Block* block;
+   if (mFreeBlocks.try_dequeue(block))
+   {
+      block->mNumSamples = MIN(bufferSize, mBlockSize);
+      BufferCopy(block->mData.data(), input, block->mNumSamples);
+      mFilledBlocks.try_enqueue(block); //can't fail, the queue has room for every block
+   }
+}
+
+void SpectrumAnalyzer::Analyze()
+{
+   int windowSize = (int)mWindow.size();
+   Block* block;
+   while (mFilledBlocks.try_dequeue(block))
+   {
+      const float* samples = block->mData.data();
+      int remaining = block->mNumSamples;
+      while (remaining > 0)
+      {
+         int length = MIN(remaining, mSamplesUntilHop);
+         memmove(mWindow.data(), mWindow.data() + length, (windowSize - length) * sizeof(float));
+         BufferCopy(mWindow.data() + windowSize - length, samples, length);
+         samples += length;
+         remaining -= length;
+         mSamplesUntilHop -= length;
+         if (mSamplesUntilHop > 0)
+            continue;
+         mSamplesUntilHop = mHopSize;
+
+         BufferCopy(mFrame.data(), mWindow.data(), windowSize);
+         Mult(mFrame.data(), mPlan.GetHannWindow(), windowSize);
+         mPlan.Forward(mFrame.data(), mRe.data(), mIm.data(), mScratch.data());
+
+         //a hann window sums to half its length, so a full scale sine comes out at a quarter of the window size
+         float scale = 4.0f / windowSize;
+         for (int i = 0; i < mNumBins; ++i)
+            mAmplitudes[i] = sqrtf(mRe[i] * mRe[i] + mIm[i] * mIm[i]) * scale;
+
+         if (mOnSpectrum)
+            mOnSpectrum(mAmplitudes.data(), mNumBins);
+         if (mSpectrogramEnabled)
+            WriteSpectrogramColumn();
+      }
+      mFreeBlocks.enqueue(block);
+   }
+}
+
+void SpectrumAnalyzer::WriteSpectrogramColumn()
+{
+   const auto& colormap = GetColormap();
+   int64_t written = mSpectrogramColumnsWritten.load(std::memory_order_relaxed);
+   uint32_t* column = mSpectrogramColumns.data() + (written % kSpectrogramColumns) * kSpectrogramRows;
+   for (int row = 0; row < kSpectrogramRows; ++row)
+   {
+      float amplitude = 0;
+      for (int bin = mRowFirstBin[row]; bin < mRowEndBin[row]; ++bin)
+         amplitude = MAX(amplitude, mAmplitudes[bin]);
+      float db = amplitude > 0 ? 20 * log10f(amplitude) : kFloorDb;
+      int index = (int)(ofClamp((db - kFloorDb) / -kFloorDb, 0, 1) * 255);
+      column[kSpectrogramRows - 1 - row] = colormap[index];
+   }
+   mSpectrogramColumnsWritten.store(written + 1, std::memory_order_release);
+}
+
+bool SpectrumAnalyzer::CopySpectrogramColumns(uint32_t* image, int64_t& columnsCopied) const
+{
+   int64_t written = mSpectrogramColumnsWritten.load(std::memory_order_acquire);
+   if (written == columnsCopied)
+      return false;
+
+   //a ui that fell a whole ring behind only takes the newest ones, and leaves the slot that's about to be written alone
+   int64_t first = MAX(columnsCopied, written - kSpectrogramColumns + 1);
+   for (int64_t i = first; i < written; ++i)
+   {
+      int x = (int)(i % kSpectrogramColumns);
+      const uint32_t* column = mSpectrogramColumns.data() + x * kSpectrogramRows;
+      for (int row = 0; row < kSpectrogramRows; ++row)
+         image[row * kSpectrogramColumns + x] = column[row];
+   }
+   columnsCopied = written;
+   return true;
+}
+
+//static
+uint32_t SpectrumAnalyzer::GetSpectrogramBackground()
+{
+   return GetColormap()[0];
+}
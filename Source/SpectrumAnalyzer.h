@@ -0,0 +1,99 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FFT.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "readerwriterqueue.h"
+
+//windowed ffts of a stream of audio, worked out on a background thread that every analyzer shares, so the audio thread only copies samples.
+//the audio thread hands each buffer over a lock-free queue in one of a fixed pool of blocks, and if the analysis falls behind by more than
+//the pool, blocks are dropped rather than stalling audio.
+//each hop, the analysis thread passes the spectrum to a callback, and with the spectrogram on, also turns it into a column of colormapped
+//pixels in a ring that the ui copies into a texture
+class SpectrumAnalyzer
+{
+public:
+   //onSpectrum gets one amplitude per bin, 1 for a full scale sine, on the analysis thread
+   SpectrumAnalyzer(int windowSize, int hopSize, std::function<void(const float* amplitudes, int numBins)> onSpectrum);
+   ~SpectrumAnalyzer();
+
+   void Push(const float* input, int bufferSize); //audio thread
+
+   void SetSpectrogramEnabled(bool enabled) { mSpectrogramEnabled = enabled; }
+
+   //ui thread. copies the columns made since columnsCopied into image, a kSpectrogramColumns x kSpectrogramRows rgba image that they fill
+   //from left to right and then wrap around, and brings columnsCopied up to date. returns false if there was nothing new
+   bool CopySpectrogramColumns(uint32_t* image, int64_t& columnsCopied) const;
+   static uint32_t GetSpectrogramBackground();
+
+   static constexpr int kSpectrogramColumns = 512;
+   static constexpr int kSpectrogramRows = 256;
+
+private:
+   friend class SpectrumAnalysisThread;
+
+   struct Block
+   {
+      std::vector<float> mData;
+      int mNumSamples{ 0 };
+   };
+
+   void Analyze(); //analysis thread
+   void WriteSpectrogramColumn();
+
+   const FFTPlan& mPlan;
+   int mHopSize{ 0 };
+   int mNumBins{ 0 };
+   std::function<void(const float*, int)> mOnSpectrum;
+
+   int mBlockSize{ 0 };
+   std::vector<Block> mBlocks;
+   moodycamel::ReaderWriterQueue<Block*> mFilledBlocks; //audio thread -> analysis thread
+   moodycamel::ReaderWriterQueue<Block*> mFreeBlocks; //analysis thread -> audio thread
+
+   //analysis thread only
+   std::vector<float> mWindow; //the last windowSize samples, oldest first
+   int mSamplesUntilHop{ 0 };
+   std::vector<float> mFrame;
+   std::vector<float> mRe;
+   std::vector<float> mIm;
+   std::vector<float> mScratch;
+   std::vector<float> mAmplitudes;
+   std::vector<int> mRowFirstBin; //the bins each spectrogram row covers, bottom row first, on the same square root scale as the spectrum
+   std::vector<int> mRowEndBin;
+
+   std::atomic<bool> mSpectrogramEnabled{ false };
+   std::vector<uint32_t> mSpectrogramColumns; //kSpectrogramColumns columns of kSpectrogramRows pixels, top row first
+   std::atomic<int64_t> mSpectrogramColumnsWritten{ 0 };
+};
@@ -48,6 +48,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool CanSleepWhenSilent() const override { return true; }
    int GetNumTargets() override { return 2; }
 
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
@@ -0,0 +1,61 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    StartupTimer.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "StartupTimer.h"
+#include "SynthGlobals.h"
+
+#include "juce_core/juce_core.h"
+
+StartupTimer& StartupTimer::Get()
+{
+   static StartupTimer* sInstance = new StartupTimer(); //never destroyed
+   return *sInstance;
+}
+
+void StartupTimer::Start()
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   mStartMs = juce::Time::getMillisecondCounterHiRes();
+   mLastStageMs = mStartMs;
+   mFinished = false;
+}
+
+void StartupTimer::Stage(const std::string& name)
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   double now = juce::Time::getMillisecondCounterHiRes();
+   ofLog() << "startup: " << name << " took " << ofToString(now - mLastStageMs, 1) << " ms (" << ofToString(now - mStartMs, 1) << " ms since launch)";
+   mLastStageMs = now;
+}
+
+void StartupTimer::Finish()
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   if (mFinished)
+      return;
+   mFinished = true;
+   ofLog() << "startup: ready after " << ofToString(juce::Time::getMillisecondCounterHiRes() - mStartMs, 1) << " ms";
+}
@@ -0,0 +1,51 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    StartupTimer.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <mutex>
+#include <string>
+
+//logs how long each stage of startup took, from the application starting to the first layout being loaded, so
+//that slow startups can be pinned on something. stages get marked from both the message thread and the gl thread
+class StartupTimer
+{
+public:
+   static StartupTimer& Get();
+
+   void Start();
+   void Stage(const std::string& name); //logs the time since the previous stage
+   void Finish(); //logs the total, the first time it's called
+   bool IsFinished() const { return mFinished; }
+
+private:
+   StartupTimer() = default;
+
+   std::mutex mMutex;
+   double mStartMs{ 0 };
+   double mLastStageMs{ 0 };
+   bool mFinished{ false };
+};
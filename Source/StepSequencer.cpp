@@ -756,9 +756,47 @@ void StepSequencer::Step(double time, float velocity, int pulseFlags)
 
    if (mHasExternalPulseSource)
    {
-      for (auto& row : mRows)
-         row->PlayStep(time, mCurrentColumn);
+      CompilePatternIfNecessary();
+      if (mCurrentColumn + 1 < (int)mCompiledColumnStart.size())
+      {
+         for (int i = mCompiledColumnStart[mCurrentColumn]; i < mCompiledColumnStart[mCurrentColumn + 1]; ++i)
+            mRows[mCompiledStepRows[i]]->PlayStep(time, mCurrentColumn);
+      }
+   }
+}
+
+bool StepSequencer::RowHasSteps(int row)
+{
+   CompilePatternIfNecessary();
+   return mCompiledRowHasSteps[row];
+}
+
+void StepSequencer::CompilePatternIfNecessary()
+{
+   if (mPatternCompiled && mGrid->GetChangeCount() == mCompiledGridChangeCount)
+      return;
+
+   mPatternCompiled = true;
+   mCompiledGridChangeCount = mGrid->GetChangeCount();
+   mCompiledStepRows.clear();
+   mCompiledRowHasSteps.fill(false);
+
+   const int numCols = mGrid->GetCols();
+   const int numRows = MIN(mGrid->GetRows(), NUM_STEPSEQ_ROWS);
+   mCompiledColumnStart.resize(numCols + 1);
+   for (int col = 0; col < numCols; ++col)
+   {
+      mCompiledColumnStart[col] = (int)mCompiledStepRows.size();
+      for (int row = 0; row < numRows; ++row)
+      {
+         if (static_cast<const UIGrid*>(mGrid)->GetVal(col, row) > 0)
+         {
+            mCompiledStepRows.push_back(row);
+            mCompiledRowHasSteps[row] = true;
+         }
+      }
    }
+   mCompiledColumnStart[numCols] = (int)mCompiledStepRows.size();
 }
 
 void StepSequencer::PlayStepNote(double time, int note, float val)
@@ -1155,6 +1193,9 @@ void StepSequencerRow::OnTimeEvent(double time)
    if (mSeq->IsEnabled() == false || mSeq->HasExternalPulseSource())
       return;
 
+   if (!mPlayRow || !mSeq->RowHasSteps(mRow))
+      return; //nothing to look up
+
    float offsetMs = mOffset * TheTransport->MsPerBar();
    int step = mSeq->GetStepNum(time + offsetMs);
    PlayStep(time, step);
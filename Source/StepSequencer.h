@@ -163,6 +163,7 @@ public:
    void UpdateAbletonGridLeds(IAbletonGridDevice* abletonGrid) override;
 
    bool IsMetaStepActive(double time, int col, int row);
+   bool RowHasSteps(int row);
 
    //IDrivableSequencer
    bool HasExternalPulseSource() const override { return mHasExternalPulseSource; }
@@ -198,6 +199,7 @@ private:
    void DrawRowLabel(const char* label, int row, int x, int y);
    int GetNumSteps(NoteInterval interval, int numMeasures) const;
    Vec2i ControllerToGrid(const Vec2i& controller);
+   void CompilePatternIfNecessary();
    int GetNumControllerChunks(); //how many vertical chunks of the sequence are there to fit multi-rowed on the controller?
    int GetMetaStep(double time);
    int GetMetaStepMaskIndex(int col, int row) { return MIN(col, META_STEP_MAX - 1) + row * META_STEP_MAX; }
@@ -286,4 +288,12 @@ private:
    GridControllerMode mGridControllerMode{ GridControllerMode::FitMultipleRows };
 
    TransportListenerInfo* mTransportListenerInfo{ nullptr };
+
+   //the grid flattened into the steps that will play, sorted by column, so playback doesn't have to look through every row.
+   //rebuilt when the grid's change count moves
+   std::vector<int> mCompiledStepRows;
+   std::vector<int> mCompiledColumnStart; //index of each column's first step, plus one past the end
+   std::array<bool, NUM_STEPSEQ_ROWS> mCompiledRowHasSteps{};
+   unsigned int mCompiledGridChangeCount{ 0 };
+   bool mPatternCompiled{ false };
 };
@@ -59,26 +59,29 @@ void StereoRotation::Process(double time)
 
    SyncBuffers(2);
 
-   int secondChannel = GetBuffer()->NumActiveChannels() - 1;
-   for (int i = 0; i < bufferSize; ++i)
+   //the phase holds still across the buffer, so the rotation is worked out once and the whole pair goes through it together
+   ChannelBuffer* in = GetBuffer();
+   if (mEnabled)
    {
-      if (mEnabled)
-      {
-         float phaseSin = sin(mPhase * 2 * PI);
-         float phaseCos = cos(mPhase * 2 * PI);
-
-         out->GetChannel(0)[i] += GetBuffer()->GetChannel(0)[i] * phaseCos - GetBuffer()->GetChannel(secondChannel)[i] * phaseSin;
-         out->GetChannel(1)[i] += GetBuffer()->GetChannel(0)[i] * phaseSin + GetBuffer()->GetChannel(secondChannel)[i] * phaseCos;
-      }
-      else
-      {
-         out->GetChannel(0)[i] += GetBuffer()->GetChannel(0)[i];
-         out->GetChannel(1)[i] += GetBuffer()->GetChannel(secondChannel)[i];
-      }
+      float phaseSin = sin(mPhase * 2 * PI);
+      float phaseCos = cos(mPhase * 2 * PI);
+      ChannelBuffer::StereoMix rotation;
+      rotation.mLeftToLeft = phaseCos;
+      rotation.mRightToLeft = -phaseSin;
+      rotation.mLeftToRight = phaseSin;
+      rotation.mRightToRight = phaseCos;
+      in->MixStereo(rotation, bufferSize);
+   }
+   else
+   {
+      in->SpreadToStereo();
    }
 
    for (int ch = 0; ch < 2; ++ch)
+   {
+      Add(out->GetChannel(ch), in->GetChannel(ch), bufferSize);
       GetVizBuffer()->WriteChunk(out->GetChannel(ch), bufferSize, ch);
+   }
 
    GetBuffer()->Reset();
 }
@@ -0,0 +1,156 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    StreamingRecorder.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "StreamingRecorder.h"
+#include "ChannelBuffer.h"
+#include "SynthGlobals.h"
+
+#include "juce_audio_formats/juce_audio_formats.h"
+
+#include <chrono>
+
+namespace
+{
+   const float kBufferedSeconds = 4; //how far the disk can fall behind before blocks start getting dropped
+   const int kWriterSleepMs = 10;
+}
+
+StreamingRecorder::StreamingRecorder()
+{
+}
+
+StreamingRecorder::~StreamingRecorder()
+{
+   Stop();
+}
+
+bool StreamingRecorder::Start(const std::string& path, int numChannels)
+{
+   Stop();
+
+   juce::File file(path);
+   file.getParentDirectory().createDirectory();
+   file.deleteFile();
+   auto stream = file.createOutputStream();
+   if (stream == nullptr)
+      return false;
+
+   std::unique_ptr<juce::AudioFormat> format;
+   if (file.hasFileExtension("flac"))
+      format = std::make_unique<juce::FlacAudioFormat>();
+   else
+      format = std::make_unique<juce::WavAudioFormat>();
+
+   mWriter.reset(format->createWriterFor(stream.get(), gSampleRate, numChannels, 24, {}, 0));
+   if (mWriter == nullptr)
+      return false;
+   stream.release(); //owned by the writer now
+
+   mPath = path;
+   mNumChannels = numChannels;
+   mBlockSize = gBufferSize;
+   mNumSamplesWritten = 0;
+   mNumDroppedBlocks = 0;
+
+   int numBlocks = MAX(2, (int)(kBufferedSeconds * gSampleRate / mBlockSize));
+   mBlocks.assign(numBlocks, Block());
+   mFilledBlocks = std::make_unique<moodycamel::ReaderWriterQueue<Block*>>(numBlocks);
+   mFreeBlocks = std::make_unique<moodycamel::ReaderWriterQueue<Block*>>(numBlocks);
+   for (auto& block : mBlocks)
+   {
+      block.mData.resize(mNumChannels * mBlockSize);
+      mFreeBlocks->enqueue(&block);
+   }
+
+   mStopWriter = false;
+   mWriterThread = std::thread(&StreamingRecorder::WriterThreadLoop, this);
+   mRecording = true;
+   return true;
+}
+
+void StreamingRecorder::Stop()
+{
+   if (!mWriterThread.joinable())
+      return;
+
+   //once the audio thread is out of Write(), nothing else can be queued
+   mRecording = false;
+   while (mAudioThreadWriting > 0)
+      std::this_thread::yield();
+
+   mStopWriter = true;
+   mWriterThread.join();
+
+   mWriter.reset(); //finishes off the file's header
+   mFilledBlocks.reset();
+   mFreeBlocks.reset();
+   mBlocks.clear();
+}
+
+void StreamingRecorder::Write(ChannelBuffer* buffer, int numSamples)
+{
+   ++mAudioThreadWriting;
+   if (mRecording)
+   {
+      Block* block;
+      if (mFreeBlocks->try_dequeue(block))
+      {
+         block->mNumSamples = MIN(numSamples, mBlockSize);
+         for (int ch = 0; ch < mNumChannels; ++ch)
+            BufferCopy(block->mData.data() + ch * mBlockSize, buffer->GetChannel(MIN(ch, buffer->NumActiveChannels() - 1)), block->mNumSamples);
+         mFilledBlocks->try_enqueue(block); //can't fail, the queue has room for every block
+      }
+      else
+      {
+         ++mNumDroppedBlocks;
+      }
+   }
+   --mAudioThreadWriting;
+}
+
+void StreamingRecorder::WriterThreadLoop()
+{
+   std::vector<const float*> channels(mNumChannels);
+   for (;;)
+   {
+      bool stopping = mStopWriter; //check before draining, so nothing queued before the stop gets left behind
+
+      Block* block;
+      while (mFilledBlocks->try_dequeue(block))
+      {
+         for (int ch = 0; ch < mNumChannels; ++ch)
+            channels[ch] = block->mData.data() + ch * mBlockSize;
+         mWriter->writeFromFloatArrays(channels.data(), mNumChannels, block->mNumSamples);
+         mNumSamplesWritten += block->mNumSamples;
+         mFreeBlocks->enqueue(block);
+      }
+
+      if (stopping)
+         break;
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(kWriterSleepMs));
+   }
+}
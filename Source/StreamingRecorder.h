@@ -0,0 +1,88 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    StreamingRecorder.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "readerwriterqueue.h"
+
+namespace juce
+{
+   class AudioFormatWriter;
+}
+
+class ChannelBuffer;
+
+//records straight to a .wav or .flac file, so a take costs the same memory however long it runs.
+//the audio thread copies each buffer into one of a fixed pool of blocks and hands it over a lock-free queue
+//to a writer thread, which encodes it and hands the block back. if the disk falls behind by more than the pool,
+//blocks get dropped rather than stalling audio (see GetNumDroppedBlocks())
+class StreamingRecorder
+{
+public:
+   StreamingRecorder();
+   ~StreamingRecorder();
+
+   //main thread
+   bool Start(const std::string& path, int numChannels);
+   void Stop(); //waits for everything recorded so far to be written, and closes the file
+   bool IsRecording() const { return mRecording; }
+   const std::string& GetPath() const { return mPath; }
+   int GetNumChannels() const { return mNumChannels; }
+   std::int64_t GetNumSamplesWritten() const { return mNumSamplesWritten; }
+   int GetNumDroppedBlocks() const { return mNumDroppedBlocks; }
+
+   //audio thread
+   void Write(ChannelBuffer* buffer, int numSamples);
+
+private:
+   struct Block
+   {
+      std::vector<float> mData; //channels one after another, gBufferSize apart
+      int mNumSamples{ 0 };
+   };
+
+   void WriterThreadLoop();
+
+   std::string mPath;
+   int mNumChannels{ 0 };
+   int mBlockSize{ 0 };
+   std::unique_ptr<juce::AudioFormatWriter> mWriter;
+   std::vector<Block> mBlocks;
+   std::unique_ptr<moodycamel::ReaderWriterQueue<Block*>> mFilledBlocks; //audio thread -> writer thread
+   std::unique_ptr<moodycamel::ReaderWriterQueue<Block*>> mFreeBlocks; //writer thread -> audio thread
+   std::thread mWriterThread;
+   std::atomic<bool> mRecording{ false };
+   std::atomic<bool> mStopWriter{ false };
+   std::atomic<int> mAudioThreadWriting{ 0 };
+   std::atomic<std::int64_t> mNumSamplesWritten{ 0 };
+   std::atomic<int> mNumDroppedBlocks{ 0 };
+};
@@ -32,7 +32,7 @@ bool Stutter::sQuantize = true;
 int Stutter::sStutterSubdivide = 1;
 
 Stutter::Stutter()
-: mRecordBuffer(STUTTER_BUFFER_SIZE)
+: mRecordBuffer(STUTTER_BUFFER_SIZE, K(roundUpToPowerOfTwo))
 , mStutterBuffer(STUTTER_BUFFER_SIZE)
 {
    mBlendRamp.SetValue(0);
@@ -37,7 +37,10 @@
 #include "ChannelBuffer.h"
 #include "IPulseReceiver.h"
 #include "exprtk.hpp"
+#include "CompiledExpression.h"
 #include "UserPrefs.h"
+#include "VisualizationTap.h"
+#include "nanovg/nanovg.h"
 
 #include "juce_audio_formats/juce_audio_formats.h"
 #include "juce_gui_basics/juce_gui_basics.h"
@@ -46,9 +49,17 @@
 #import <execinfo.h>
 #endif
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+#include <atomic>
+#include <thread>
+
 using namespace juce;
 
 int gBufferSize = -999; //values set in SetGlobalSampleRateAndBufferSize(), setting them to bad values here to highlight any bugs
+int gIOBufferSize = -999;
 int gSampleRate = -999;
 double gTwoPiOverSampleRate = -999;
 double gSampleRateMs = -999;
@@ -66,8 +77,8 @@ RetinaTrueTypeFont gFontBold;
 RetinaTrueTypeFont gFontFixedWidth;
 float gModuleDrawAlpha = 255;
 float gZeroBuffer[kWorkBufferSize];
-float gWorkBuffer[kWorkBufferSize];
-ChannelBuffer gWorkChannelBuffer(kWorkBufferSize);
+thread_local float* gWorkBuffer = nullptr;
+thread_local ChannelBuffer* gWorkChannelBuffer = nullptr;
 IDrawableModule* gHoveredModule = nullptr;
 IUIControl* gHoveredUIControl = nullptr;
 IUIControl* gHotBindUIControl[10];
@@ -101,8 +112,27 @@ void SynthInit()
    gStepVelocityLevels[(int)StepVelocityType::Accent] = kVelocityAccent;
 }
 
+namespace
+{
+   std::thread sPreloadThread;
+}
+
+void PreloadGlobalResources()
+{
+   sPreloadThread = std::thread([]
+                                {
+                                   gFont.ReadFontFile(ofToResourcePath("frabk.ttf"));
+                                   gFontBold.ReadFontFile(ofToResourcePath("frabk_m.ttf"));
+                                   gFontFixedWidth.ReadFontFile(ofToResourcePath("iosevka-type-light.ttf"));
+                                });
+}
+
 void LoadGlobalResources()
 {
+   //usually already done by the time the gl context exists
+   if (sPreloadThread.joinable())
+      sPreloadThread.join();
+
    gFont.LoadFont(ofToResourcePath("frabk.ttf"));
    gFontBold.LoadFont(ofToResourcePath("frabk_m.ttf"));
    gFontFixedWidth.LoadFont(ofToResourcePath("iosevka-type-light.ttf"));
@@ -111,8 +141,19 @@ void LoadGlobalResources()
 
 void SetGlobalSampleRateAndBufferSize(int rate, int size)
 {
-   assert(size <= kWorkBufferSize);
-   gBufferSize = size * UserPrefs.oversampling.Get();
+   gIOBufferSize = size * UserPrefs.oversampling.Get();
+
+   //a fixed block keeps per-buffer costs and latency the same whatever the device asks for. it has to split the callback evenly
+   gBufferSize = gIOBufferSize;
+   int blockSize = UserPrefs.internal_block_size.Get();
+   if (blockSize > 0 && blockSize < gIOBufferSize)
+   {
+      if (gIOBufferSize % blockSize == 0)
+         gBufferSize = blockSize;
+      else
+         ofLog() << "internal_block_size " << blockSize << " doesn't divide the buffer size " << gIOBufferSize << ", processing whole buffers";
+   }
+   assert(gBufferSize <= kWorkBufferSize);
 
    gSampleRate = rate * UserPrefs.oversampling.Get();
    gTwoPiOverSampleRate = TWO_PI / gSampleRate;
@@ -120,6 +161,53 @@ void SetGlobalSampleRateAndBufferSize(int rate, int size)
    gInvSampleRateMs = 1000.0 / gSampleRate;
    gBufferSizeMs = gBufferSize / gSampleRateMs;
    gNyquistLimit = gSampleRate / 2.0f;
+
+   ChannelBufferArena::Get().SetBlockSize(gBufferSize);
+}
+
+namespace
+{
+   struct WorkBuffers
+   {
+      explicit WorkBuffers(int size)
+      : mBuffer(new float[size]())
+      , mChannelBuffer(size)
+      , mSize(size)
+      {
+         //touch every channel now, so nothing gets allocated the first time the audio thread asks for one
+         mChannelBuffer.SetNumActiveChannels(mChannelBuffer.NumTotalChannels());
+         for (int ch = 0; ch < mChannelBuffer.NumTotalChannels(); ++ch)
+            mChannelBuffer.GetChannel(ch);
+         mChannelBuffer.Clear();
+      }
+
+      std::unique_ptr<float[]> mBuffer;
+      ChannelBuffer mChannelBuffer;
+      int mSize{ 0 };
+   };
+
+   std::array<std::unique_ptr<WorkBuffers>, kMaxWorkBuffers> sWorkBuffers;
+}
+
+void AllocateWorkBuffers(int numWorkers)
+{
+   int size = gBufferSize * kWorkBufferScale;
+   int numSlots = MIN(kFirstWorkerWorkBuffers + MAX(0, numWorkers), kMaxWorkBuffers);
+   for (int i = 0; i < numSlots; ++i)
+   {
+      if (sWorkBuffers[i] == nullptr)
+         sWorkBuffers[i] = std::make_unique<WorkBuffers>(size);
+      assert(sWorkBuffers[i]->mSize >= size); //gBufferSize only changes before the audio starts
+   }
+   BindWorkBuffers(kMainThreadWorkBuffers);
+}
+
+void BindWorkBuffers(int slot)
+{
+   assert(slot >= 0 && slot < kMaxWorkBuffers && sWorkBuffers[slot] != nullptr);
+   WorkBuffers* buffers = sWorkBuffers[slot].get();
+   gWorkBuffer = buffers->mBuffer.get();
+   gWorkChannelBuffer = &buffers->mChannelBuffer;
 }
 
 std::string GetBuildInfoString()
@@ -142,14 +230,18 @@ void DrawAudioBuffer(float width, float height, ChannelBuffer* buffer, float sta
       int numChannels = buffer->NumActiveChannels();
       for (int i = 0; i < numChannels; ++i)
       {
-         DrawAudioBuffer(width, height / numChannels, buffer->GetChannel(i), start, MIN(end, buffer->BufferSize()), pos, vol, color, wraparoundFrom, wraparoundTo, buffer->BufferSize());
+         const float* data = buffer->GetChannel(i);
+         WaveformPeaks* peaks = buffer->GetPeaks(i);
+         if (peaks != nullptr)
+            peaks->Update(data, buffer->BufferSize());
+         DrawAudioBuffer(width, height / numChannels, data, start, MIN(end, buffer->BufferSize()), pos, vol, color, wraparoundFrom, wraparoundTo, buffer->BufferSize(), peaks);
          ofTranslate(0, height / numChannels);
       }
    }
    ofPopMatrix();
 }
 
-void DrawAudioBuffer(float width, float height, const float* buffer, float start, float end, float pos, float vol /*=1*/, ofColor color /*=ofColor::black*/, int wraparoundFrom /*= -1*/, int wraparoundTo /*= 0*/, int bufferSize /*=-1*/)
+void DrawAudioBuffer(float width, float height, const float* buffer, float start, float end, float pos, float vol /*=1*/, ofColor color /*=ofColor::black*/, int wraparoundFrom /*= -1*/, int wraparoundTo /*= 0*/, int bufferSize /*=-1*/, const WaveformPeaks* peaks /*= nullptr*/)
 {
    static std::array<float, 10000> sAudioBufferMinValues;
    static std::array<float, 10000> sAudioBufferMaxValues;
@@ -177,7 +269,9 @@ void DrawAudioBuffer(float width, float height, const float* buffer, float start
 
    if (length > 0)
    {
-      const float kStepSize = 3;
+      //one column every few screen pixels, so zoomed out waveforms don't draw many columns per pixel
+      const float kStepPixels = 3;
+      const float kStepSize = MAX(3, kStepPixels / MAX(GetOnScreenScale(), .01f));
       float samplesPerStep = length / abs(width) * kStepSize;
       start = start - (int(start) % MAX(1, int(samplesPerStep)));
 
@@ -194,18 +288,27 @@ void DrawAudioBuffer(float width, float height, const float* buffer, float start
             float max = -999;
             float min = 999;
             int position = i / width * length + start;
+            int columnEnd = position + (int)ceilf(samplesPerStep);
 
-            int j;
-            int inc = 1 + samplesPerStep / 100;
-            for (j = 0; j < samplesPerStep; j += inc)
+            if (peaks != nullptr && wraparoundFrom == -1 && position >= 0 && columnEnd <= peaks->GetNumSamples())
             {
-               int sampleIdx = position + j;
-               if (wraparoundFrom != -1 && sampleIdx > wraparoundFrom)
-                  sampleIdx = sampleIdx - wraparoundFrom + wraparoundTo;
-               if (bufferSize > 0)
-                  sampleIdx %= bufferSize;
-               max = std::max(max, buffer[sampleIdx]);
-               min = std::min(min, buffer[sampleIdx]);
+               //exact min/max from the pyramid, rather than sampling the column
+               peaks->GetRange(buffer, position, columnEnd, min, max);
+            }
+            else
+            {
+               int j;
+               int inc = 1 + samplesPerStep / 100;
+               for (j = 0; j < samplesPerStep; j += inc)
+               {
+                  int sampleIdx = position + j;
+                  if (wraparoundFrom != -1 && sampleIdx > wraparoundFrom)
+                     sampleIdx = sampleIdx - wraparoundFrom + wraparoundTo;
+                  if (bufferSize > 0)
+                     sampleIdx %= bufferSize;
+                  max = std::max(max, buffer[sampleIdx]);
+                  min = std::min(min, buffer[sampleIdx]);
+               }
             }
 
             if (max > highestMagnitude)
@@ -262,9 +365,17 @@ void DrawAudioBuffer(float width, float height, const float* buffer, float start
    ofPopStyle();
 }
 
+//JUCE's vector ops cover SSE and NEON on desktop, but fall back to scalar loops in the wasm build, so we do those ourselves
+
 void Add(float* dst, const float* src, int bufferSize)
 {
-#ifdef USE_VECTOR_OPS
+#if defined(__wasm_simd128__)
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+      wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), wasm_v128_load(src + i)));
+   for (; i < bufferSize; ++i)
+      dst[i] += src[i];
+#elif defined(USE_VECTOR_OPS)
    FloatVectorOperations::add(dst, src, bufferSize);
 #else
    for (int i = 0; i < bufferSize; ++i)
@@ -276,7 +387,13 @@ void Add(float* dst, const float* src, int bufferSize)
 
 void Subtract(float* dst, const float* src, int bufferSize)
 {
-#ifdef USE_VECTOR_OPS
+#if defined(__wasm_simd128__)
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+      wasm_v128_store(dst + i, wasm_f32x4_sub(wasm_v128_load(dst + i), wasm_v128_load(src + i)));
+   for (; i < bufferSize; ++i)
+      dst[i] -= src[i];
+#elif defined(USE_VECTOR_OPS)
    FloatVectorOperations::subtract(dst, src, bufferSize);
 #else
    for (int i = 0; i < bufferSize; ++i)
@@ -288,7 +405,14 @@ void Subtract(float* dst, const float* src, int bufferSize)
 
 void Mult(float* buff, float val, int bufferSize)
 {
-#ifdef USE_VECTOR_OPS
+#if defined(__wasm_simd128__)
+   v128_t val4 = wasm_f32x4_splat(val);
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+      wasm_v128_store(buff + i, wasm_f32x4_mul(wasm_v128_load(buff + i), val4));
+   for (; i < bufferSize; ++i)
+      buff[i] *= val;
+#elif defined(USE_VECTOR_OPS)
    FloatVectorOperations::multiply(buff, val, bufferSize);
 #else
    for (int i = 0; i < bufferSize; ++i)
@@ -300,7 +424,13 @@ void Mult(float* buff, float val, int bufferSize)
 
 void Mult(float* dst, const float* src, int bufferSize)
 {
-#ifdef USE_VECTOR_OPS
+#if defined(__wasm_simd128__)
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+      wasm_v128_store(dst + i, wasm_f32x4_mul(wasm_v128_load(dst + i), wasm_v128_load(src + i)));
+   for (; i < bufferSize; ++i)
+      dst[i] *= src[i];
+#elif defined(USE_VECTOR_OPS)
    FloatVectorOperations::multiply(dst, src, bufferSize);
 #else
    for (int i = 0; i < bufferSize; ++i)
@@ -310,9 +440,130 @@ void Mult(float* dst, const float* src, int bufferSize)
 #endif
 }
 
+void AddWithGain(float* dst, const float* src, float gain, int bufferSize)
+{
+#if defined(__wasm_simd128__)
+   v128_t gain4 = wasm_f32x4_splat(gain);
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+      wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), wasm_f32x4_mul(wasm_v128_load(src + i), gain4)));
+   for (; i < bufferSize; ++i)
+      dst[i] += src[i] * gain;
+#elif defined(USE_VECTOR_OPS)
+   FloatVectorOperations::addWithMultiply(dst, src, gain, bufferSize);
+#else
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      dst[i] += src[i] * gain;
+   }
+#endif
+}
+
+void AddWithGain(float* dst, const float* src, const float* gain, int bufferSize)
+{
+#if defined(__wasm_simd128__)
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+      wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), wasm_f32x4_mul(wasm_v128_load(src + i), wasm_v128_load(gain + i))));
+   for (; i < bufferSize; ++i)
+      dst[i] += src[i] * gain[i];
+#elif defined(USE_VECTOR_OPS)
+   FloatVectorOperations::addWithMultiply(dst, src, gain, bufferSize);
+#else
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      dst[i] += src[i] * gain[i];
+   }
+#endif
+}
+
+void AddWithGainRamp(float* dst, const float* src, float startGain, float endGain, int bufferSize)
+{
+   if (startGain == endGain)
+   {
+      AddWithGain(dst, src, startGain, bufferSize);
+      return;
+   }
+
+   float step = (endGain - startGain) / bufferSize;
+#if defined(__wasm_simd128__)
+   v128_t gain4 = wasm_f32x4_make(startGain, startGain + step, startGain + step * 2, startGain + step * 3);
+   v128_t step4 = wasm_f32x4_splat(step * 4);
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+   {
+      wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), wasm_f32x4_mul(wasm_v128_load(src + i), gain4)));
+      gain4 = wasm_f32x4_add(gain4, step4);
+   }
+   for (; i < bufferSize; ++i)
+      dst[i] += src[i] * (startGain + step * i);
+#else
+   for (int i = 0; i < bufferSize; ++i)
+      dst[i] += src[i] * (startGain + step * i);
+#endif
+}
+
+void MixRamp(float* wet, const float* dry, float startMix, float endMix, int bufferSize)
+{
+   if (startMix == 0 && endMix == 0)
+   {
+      BufferCopy(wet, dry, bufferSize);
+      return;
+   }
+
+   float step = (endMix - startMix) / bufferSize;
+#if defined(__wasm_simd128__)
+   v128_t mix4 = wasm_f32x4_make(startMix, startMix + step, startMix + step * 2, startMix + step * 3);
+   v128_t step4 = wasm_f32x4_splat(step * 4);
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+   {
+      v128_t dry4 = wasm_v128_load(dry + i);
+      wasm_v128_store(wet + i, wasm_f32x4_add(dry4, wasm_f32x4_mul(wasm_f32x4_sub(wasm_v128_load(wet + i), dry4), mix4)));
+      mix4 = wasm_f32x4_add(mix4, step4);
+   }
+   for (; i < bufferSize; ++i)
+      wet[i] = dry[i] + (wet[i] - dry[i]) * (startMix + step * i);
+#else
+   for (int i = 0; i < bufferSize; ++i)
+      wet[i] = dry[i] + (wet[i] - dry[i]) * (startMix + step * i);
+#endif
+}
+
+void MultAndAdd(float* buff, const float* gain, float* dst, int bufferSize)
+{
+#if defined(__wasm_simd128__)
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+   {
+      v128_t scaled = wasm_f32x4_mul(wasm_v128_load(buff + i), wasm_v128_load(gain + i));
+      wasm_v128_store(buff + i, scaled);
+      wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), scaled));
+   }
+   for (; i < bufferSize; ++i)
+   {
+      buff[i] *= gain[i];
+      dst[i] += buff[i];
+   }
+#else
+   for (int i = 0; i < bufferSize; ++i)
+   {
+      buff[i] *= gain[i];
+      dst[i] += buff[i];
+   }
+#endif
+}
+
 void Clear(float* buffer, int bufferSize)
 {
-#ifdef USE_VECTOR_OPS
+#if defined(__wasm_simd128__)
+   v128_t zero = wasm_f32x4_splat(0);
+   int i = 0;
+   for (; i + 4 <= bufferSize; i += 4)
+      wasm_v128_store(buffer + i, zero);
+   for (; i < bufferSize; ++i)
+      buffer[i] = 0;
+#elif defined(USE_VECTOR_OPS)
    FloatVectorOperations::clear(buffer, bufferSize);
 #else
    bzero(buffer, bufferSize * sizeof(float));
@@ -456,6 +707,13 @@ float GetStringWidth(std::string text, float size)
    return gFont.GetStringWidth(text, size);
 }
 
+float GetOnScreenScale()
+{
+   float transform[6];
+   nvgCurrentTransform(gNanoVG, transform);
+   return (sqrtf(transform[0] * transform[0] + transform[2] * transform[2]) + sqrtf(transform[1] * transform[1] + transform[3] * transform[3])) * .5f;
+}
+
 void AssertIfDenormal(float input)
 {
    assert(input == 0 || input != input || fabsf(input) > std::numeric_limits<float>::min());
@@ -590,6 +848,50 @@ void DrawLissajous(RollingBuffer* buffer, float x, float y, float w, float h, fl
    ofPopStyle();
 }
 
+void FillLissajousTap(VisualizationTap& tap, RollingBuffer* buffer, bool autocorrelationMode /* = true */)
+{
+   VisualizationTap::Frame* frame = tap.BeginFrame();
+   if (frame == nullptr)
+      return;
+
+   int secondChannel = 1;
+   if (buffer->NumChannels() == 1)
+      secondChannel = 0;
+
+   const int delaySamps = 90;
+   int numPoints = MIN(buffer->Size() - delaySamps - 1, .02f * gSampleRate);
+   float minDistance = 1.0f / tap.GetResolution();
+   for (int i = 100; i < numPoints; ++i)
+   {
+      ofVec2f point(buffer->GetSample(i, 0), 0);
+      if (autocorrelationMode)
+         point.y = buffer->GetSample(i + delaySamps, secondChannel);
+      else
+         point.y = buffer->GetSample(i, secondChannel);
+      frame->AddPoint(point, minDistance);
+   }
+
+   tap.PublishFrame();
+}
+
+void DrawLissajous(VisualizationTap& tap, float x, float y, float w, float h, float r, float g, float b)
+{
+   float scale = .8f * MIN(w, h);
+   tap.SetResolution(scale);
+   const VisualizationTap::Frame& frame = tap.GetLatestFrame();
+
+   ofPushStyle();
+   ofSetLineWidth(1.5f);
+
+   ofSetColor(r * 255, g * 255, b * 255, 70);
+   ofBeginShape();
+   for (int i = 0; i < frame.mNumPoints; ++i)
+      ofVertex(x + w / 2 + frame.mPoints[i].x * scale, y + h / 2 + frame.mPoints[i].y * scale);
+   ofEndShape();
+
+   ofPopStyle();
+}
+
 void StringCopy(char* dest, const char* source, int destLength)
 {
    if (dest == source)
@@ -817,6 +1119,61 @@ double NextBufferTime(bool includeLookahead)
    return time;
 }
 
+namespace
+{
+   //gTime at the start of the most recent buffer, and the wall clock time that buffer started at.
+   //written by the audio thread, read from anywhere (the sequence number is odd while it's being written)
+   std::atomic<uint32_t> sAudioClockSequence{ 0 };
+   std::atomic<double> sAudioClockTime{ 0 };
+   std::atomic<double> sAudioClockWallMs{ 0 };
+}
+
+//audio thread, once per buffer, right after gTime advances
+void UpdateAudioClock()
+{
+   uint32_t sequence = sAudioClockSequence.load(std::memory_order_relaxed);
+   sAudioClockSequence.store(sequence + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+   sAudioClockTime.store(gTime, std::memory_order_relaxed);
+   sAudioClockWallMs.store(Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+   sAudioClockSequence.store(sequence + 2, std::memory_order_release);
+}
+
+//the time to schedule an event at that happened "now" on a non-audio thread.
+//gTime only moves once per buffer, so scheduling against it bunches events up at buffer boundaries. instead, measure how far into
+//the current buffer the event happened, and play it that far into the buffer after next. that's a fixed one buffer of latency,
+//rather than anywhere between zero and one depending on when the event happened to come in
+double GetTimeForImmediateEvent()
+{
+   return GetTimeForEventAt(Time::getMillisecondCounterHiRes());
+}
+
+//the same, for an event that happened at a known Time::getMillisecondCounterHiRes() time, like a timestamped midi message
+double GetTimeForEventAt(double eventWallMs)
+{
+   double audioTime = gTime;
+   double wallMs = eventWallMs;
+   for (int attempt = 0; attempt < 10; ++attempt)
+   {
+      uint32_t sequence = sAudioClockSequence.load(std::memory_order_acquire);
+      if (sequence & 1)
+         continue;
+      double readTime = sAudioClockTime.load(std::memory_order_relaxed);
+      double readWallMs = sAudioClockWallMs.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sAudioClockSequence.load(std::memory_order_relaxed) == sequence)
+      {
+         audioTime = readTime;
+         wallMs = readWallMs;
+         break;
+      }
+   }
+
+   //clamped, in case audio has stalled or hasn't started yet
+   double sinceBufferStart = ofClamp(eventWallMs - wallMs, 0, gBufferSizeMs * 2);
+   return MAX(audioTime + gBufferSizeMs + sinceBufferStart, NextBufferTime(false));
+}
+
 bool IsMainThread()
 {
    return std::this_thread::get_id() == ModularSynth::GetMainThreadID();
@@ -824,7 +1181,7 @@ bool IsMainThread()
 
 bool IsAudioThread()
 {
-   return std::this_thread::get_id() == ModularSynth::GetAudioThreadID();
+   return std::this_thread::get_id() == ModularSynth::GetAudioThreadID() || ModularSynth::IsOfflineRenderThread();
 }
 
 float GetLeftPanGain(float pan)
@@ -11522,12 +11879,6 @@ void DrawFallbackText(const char* text, float posX, float posY)
 
 bool EvaluateExpression(std::string expressionStr, float currentValue, float& output)
 {
-   exprtk::symbol_table<float> symbolTable;
-   exprtk::expression<float> expression;
-   symbolTable.add_variable("x", currentValue);
-   symbolTable.add_constants();
-   expression.register_symbol_table(symbolTable);
-
    juce::String input = expressionStr;
    if (input.startsWith("+="))
       input = input.replace("+=", "x+");
@@ -11538,6 +11889,21 @@ bool EvaluateExpression(std::string expressionStr, float currentValue, float& ou
    if (input.startsWith("-="))
       input = input.replace("-=", "x-");
 
+   CompiledExpression compiled;
+   int x = compiled.AddVariable("x");
+   if (compiled.Compile(input.toStdString()))
+   {
+      compiled.SetValue(x, currentValue);
+      output = compiled.Evaluate();
+      return true;
+   }
+
+   exprtk::symbol_table<float> symbolTable;
+   exprtk::expression<float> expression;
+   symbolTable.add_variable("x", currentValue);
+   symbolTable.add_constants();
+   expression.register_symbol_table(symbolTable);
+
    exprtk::parser<float> parser;
    bool expressionValid = parser.compile(input.toStdString(), expression);
    if (expressionValid)
@@ -11556,6 +11922,11 @@ ofLog::~ofLog()
       TheSynth->LogEvent(output, kLogEventType_Verbose);
 }
 
+namespace
+{
+   thread_local size_t* tAllocationCounter = nullptr; //see ScopedAllocationCounter
+}
+
 #ifdef BESPOKE_DEBUG_ALLOCATIONS
 FILE* logAllocationsFile;
 
@@ -11722,6 +12093,8 @@ void* operator new(std::size_t size, const char* file, int line) throw(std::bad_
 {
    void* ptr = (void*)malloc(size);
    AddTrack((uint32)ptr, size, file, line);
+   if (tAllocationCounter != nullptr)
+      *tAllocationCounter += size;
    return (ptr);
 }
 void operator delete(void* p) throw()
@@ -11739,6 +12112,8 @@ void* operator new[](std::size_t size, const char* file, int line) throw(std::ba
 {
    void* ptr = (void*)malloc(size);
    AddTrack((uint32)ptr, size, file, line);
+   if (tAllocationCounter != nullptr)
+      *tAllocationCounter += size;
    return (ptr);
 }
 void operator delete[](void* p) throw()
@@ -11756,3 +12131,38 @@ void DumpUnfreedMemory()
    ofLog() << "This only works with BESPOKE_DEBUG_ALLOCATIONS defined";
 };
 #endif
+
+ScopedAllocationCounter::ScopedAllocationCounter(size_t* counter)
+: mPrevious(tAllocationCounter)
+{
+   tAllocationCounter = counter;
+}
+
+ScopedAllocationCounter::~ScopedAllocationCounter()
+{
+   tAllocationCounter = mPrevious;
+}
+
+void RunInParallel(int count, const std::function<void(int)>& job)
+{
+   int numThreads = MIN(count, MAX(1, juce::SystemStats::getNumCpus()));
+   if (numThreads <= 1)
+   {
+      for (int i = 0; i < count; ++i)
+         job(i);
+      return;
+   }
+
+   std::atomic<int> next{ 0 };
+   std::vector<std::thread> threads;
+   for (int t = 0; t < numThreads; ++t)
+   {
+      threads.emplace_back([&]
+                           {
+                              for (int i = next++; i < count; i = next++)
+                                 job(i);
+                           });
+   }
+   for (auto& thread : threads)
+      thread.join();
+}
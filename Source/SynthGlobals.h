@@ -39,6 +39,7 @@
 #include <cctype>
 #include <random>
 #include <float.h>
+#include <functional>
 
 //#define BESPOKE_DEBUG_ALLOCATIONS
 
@@ -80,15 +81,21 @@ class IUIControl;
 class IDrawableModule;
 class RollingBuffer;
 class ChannelBuffer;
+class WaveformPeaks;
+class VisualizationTap;
 
 typedef std::map<std::string, int> EnumMap;
 
 const int kWorkBufferSize = 8192 * 16 * 2; //larger than the audio buffer size would ever be (even oversampled). Noxy: This needs to be twice as large as the largest possible buffersize (Largest I've seen on my system is 8192) multiplied by the largest possible oversampling times two. Why two? Well effectchains use this buffer twice consecutive for the drywet mixing. Obviously this should become a smart buffer so we can dynamically increase the size when it is needed but that is for later. For now this increase should fix it ... mostly.
 
-const int kNumVoices = 16;
+const int kWorkBufferScale = kWorkBufferSize / 8192; //the per-thread work buffers are this many times gBufferSize, see AllocateWorkBuffers()
+
+const int kNumVoices = 16; //the voice indices that notes can address, for per-voice modulation
+const int kMaxPolyphony = 128; //how many voices an instrument can be set to play at once
 
 extern int gSampleRate;
-extern int gBufferSize;
+extern int gBufferSize; //the block every module processes at once
+extern int gIOBufferSize; //what each device callback asks for at the internal rate, a whole number of gBufferSize blocks
 extern double gTwoPiOverSampleRate;
 extern double gSampleRateMs;
 extern double gInvSampleRateMs;
@@ -102,8 +109,8 @@ extern RetinaTrueTypeFont gFontBold;
 extern RetinaTrueTypeFont gFontFixedWidth;
 extern float gModuleDrawAlpha;
 extern float gZeroBuffer[kWorkBufferSize];
-extern float gWorkBuffer[kWorkBufferSize]; //scratch buffer for doing work in
-extern ChannelBuffer gWorkChannelBuffer;
+extern thread_local float* gWorkBuffer; //scratch buffer for doing work in, one per thread so audio graph workers can process at the same time. see BindWorkBuffers()
+extern thread_local ChannelBuffer* gWorkChannelBuffer;
 extern IDrawableModule* gHoveredModule;
 extern IUIControl* gHoveredUIControl;
 extern IUIControl* gHotBindUIControl[10];
@@ -182,16 +189,31 @@ class LoadStateException : public std::exception
 };
 
 void SynthInit();
+void PreloadGlobalResources(); //starts reading the font files in the background, before there's a gl context to load them into
 void LoadGlobalResources();
 
 void SetGlobalSampleRateAndBufferSize(int rate, int size);
+
+//only the threads that process audio get work buffers: the main thread (notes played from the ui), the audio thread, and each audio graph worker.
+//they're sized from gBufferSize and allocated off the audio thread when the workers start, then each thread points gWorkBuffer/gWorkChannelBuffer at its own
+const int kMainThreadWorkBuffers = 0;
+const int kAudioThreadWorkBuffers = 1;
+const int kFirstWorkerWorkBuffers = 2;
+const int kMaxWorkBuffers = kFirstWorkerWorkBuffers + 64;
+void AllocateWorkBuffers(int numWorkers); //main thread, binds the main thread's. slots that already exist are kept, so this is safe with the audio running
+void BindWorkBuffers(int slot); //on the thread that's going to use them, doesn't allocate
 std::string GetBuildInfoString();
 void DrawAudioBuffer(float width, float height, ChannelBuffer* buffer, float start, float end, float pos, float vol = 1, ofColor color = ofColor::black, int wraparoundFrom = -1, int wraparoundTo = 0);
-void DrawAudioBuffer(float width, float height, const float* buffer, float start, float end, float pos, float vol = 1, ofColor color = ofColor::black, int wraparoundFrom = -1, int wraparoundTo = 0, int bufferSize = -1);
+void DrawAudioBuffer(float width, float height, const float* buffer, float start, float end, float pos, float vol = 1, ofColor color = ofColor::black, int wraparoundFrom = -1, int wraparoundTo = 0, int bufferSize = -1, const WaveformPeaks* peaks = nullptr);
 void Add(float* buff1, const float* buff2, int bufferSize);
 void Subtract(float* buff1, const float* buff2, int bufferSize);
 void Mult(float* buff, float val, int bufferSize);
 void Mult(float* buff1, const float* buff2, int bufferSize);
+void AddWithGain(float* dst, const float* src, float gain, int bufferSize);
+void AddWithGain(float* dst, const float* src, const float* gain, int bufferSize);
+void AddWithGainRamp(float* dst, const float* src, float startGain, float endGain, int bufferSize);
+void MixRamp(float* wet, const float* dry, float startMix, float endMix, int bufferSize); //wet = dry + (wet - dry) * mix, with mix ramped across the buffer
+void MultAndAdd(float* buff, const float* gain, float* dst, int bufferSize); //buff *= gain, then dst += buff
 void Clear(float* buffer, int bufferSize);
 void BufferCopy(float* dst, const float* src, int bufferSize);
 std::string NoteName(int pitch, bool flat = false, bool includeOctave = false);
@@ -204,6 +226,7 @@ void DrawTextNormal(std::string text, int x, int y, float size = 13);
 void DrawTextRightJustify(std::string text, int x, int y, float size = 13);
 void DrawTextBold(std::string text, int x, int y, float size = 13);
 float GetStringWidth(std::string text, float size = 13);
+float GetOnScreenScale(); //screen pixels per unit at the current transform, including every parent zoom
 void AssertIfDenormal(float input);
 float GetInterpolatedSample(double offset, const float* buffer, int bufferSize);
 float GetInterpolatedSample(double offset, ChannelBuffer* buffer, int bufferSize, float channelBlend);
@@ -211,6 +234,8 @@ void WriteInterpolatedSample(double offset, float* buffer, int bufferSize, float
 std::string GetRomanNumeralForDegree(int degree);
 void UpdateTarget(IDrawableModule* module);
 void DrawLissajous(RollingBuffer* buffer, float x, float y, float w, float h, float r = .2f, float g = .7f, float b = .2f, bool autocorrelationMode = true);
+void FillLissajousTap(VisualizationTap& tap, RollingBuffer* buffer, bool autocorrelationMode = true); //audio thread, for the overload below
+void DrawLissajous(VisualizationTap& tap, float x, float y, float w, float h, float r = .2f, float g = .7f, float b = .2f);
 void StringCopy(char* dest, const char* source, int destLength);
 int GetKeyModifiers();
 bool IsKeyHeld(int key, int modifiers = kModifier_None);
@@ -225,6 +250,18 @@ std::string GetUniqueName(std::string name, std::vector<IDrawableModule*> existi
 std::string GetUniqueName(std::string name, std::vector<std::string> existing);
 void SetMemoryTrackingEnabled(bool enabled);
 void DumpUnfreedMemory();
+
+//while in scope, bytes newed on this thread are added to *counter (and not to any counter further out). only counts with BESPOKE_DEBUG_ALLOCATIONS
+class ScopedAllocationCounter
+{
+public:
+   explicit ScopedAllocationCounter(size_t* counter);
+   ~ScopedAllocationCounter();
+
+private:
+   size_t* mPrevious;
+};
+void RunInParallel(int count, const std::function<void(int)>& job); //job(i) for i in [0, count), spread over a thread per cpu. returns once they're all done
 float DistSqToLine(ofVec2f point, ofVec2f a, ofVec2f b);
 uint32_t JenkinsHash(const char* key);
 void LoadStateValidate(bool assertion);
@@ -233,6 +270,9 @@ float GetRightPanGain(float pan);
 void DrawFallbackText(const char* text, float posX, float posY);
 bool EvaluateExpression(std::string expression, float currentValue, float& output);
 double NextBufferTime(bool includeLookahead);
+void UpdateAudioClock();
+double GetTimeForImmediateEvent();
+double GetTimeForEventAt(double eventWallMs);
 bool IsMainThread();
 bool IsAudioThread();
 
@@ -0,0 +1,91 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    TextLayoutCache.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#include "TextLayoutCache.h"
+#include "nanovg/nanovg.h"
+
+#include <cmath>
+#include <functional>
+
+TextLayoutCache& TextLayoutCache::Get()
+{
+   static TextLayoutCache sCache;
+   return sCache;
+}
+
+size_t TextLayoutCache::KeyHash::operator()(const Key& key) const
+{
+   size_t hash = std::hash<std::string>()(key.mText);
+   auto combine = [&hash](size_t value)
+   {
+      hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+   };
+   combine(std::hash<const void*>()(key.mContext));
+   combine(std::hash<int>()(key.mFontHandle));
+   combine(std::hash<float>()(key.mSize));
+   combine(std::hash<float>()(key.mScale));
+   return hash;
+}
+
+void TextLayoutCache::Measure(NVGcontext* vg, int fontHandle, float size, const std::string& str, float& width, float& height)
+{
+   float transform[6];
+   nvgCurrentTransform(vg, transform);
+   float scale = (sqrtf(transform[0] * transform[0] + transform[2] * transform[2]) + sqrtf(transform[1] * transform[1] + transform[3] * transform[3])) * .5f;
+
+   Key key{ str, vg, fontHandle, size, scale };
+
+   std::lock_guard<std::mutex> lock(mMutex);
+
+   auto found = mLookup.find(key);
+   if (found != mLookup.end())
+   {
+      mEntries.splice(mEntries.begin(), mEntries, found->second);
+      width = found->second->mWidth;
+      height = found->second->mHeight;
+      return;
+   }
+
+   float bounds[4];
+   width = nvgTextBounds(vg, 0, 0, str.c_str(), nullptr, bounds);
+   height = bounds[3] - bounds[1];
+
+   if ((int)mEntries.size() >= kMaxEntries)
+   {
+      mLookup.erase(mEntries.back().mKey);
+      mEntries.pop_back();
+   }
+   mEntries.push_front({ key, width, height });
+   mLookup[std::move(key)] = mEntries.begin();
+}
+
+void TextLayoutCache::Clear()
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   mLookup.clear();
+   mEntries.clear();
+}
@@ -0,0 +1,82 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    TextLayoutCache.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct NVGcontext;
+
+//remembers the measured bounds of strings, so labels that get measured every frame (slider values, right-justified text, etc)
+//don't have to be laid out by nanovg every time. glyphs themselves are already cached in nanovg's font atlas.
+class TextLayoutCache
+{
+public:
+   static TextLayoutCache& Get();
+
+   //measures str like nvgTextBounds(vg, 0, 0, str, nullptr, bounds) would, with the font face and size already set on vg
+   void Measure(NVGcontext* vg, int fontHandle, float size, const std::string& str, float& width, float& height);
+   void Clear();
+
+private:
+   TextLayoutCache() = default;
+
+   struct Key
+   {
+      std::string mText;
+      const NVGcontext* mContext;
+      int mFontHandle;
+      float mSize;
+      float mScale; //nanovg measures at the rasterized size, so results shift slightly with zoom
+
+      bool operator==(const Key& other) const
+      {
+         return mContext == other.mContext && mFontHandle == other.mFontHandle && mSize == other.mSize && mScale == other.mScale && mText == other.mText;
+      }
+   };
+
+   struct KeyHash
+   {
+      size_t operator()(const Key& key) const;
+   };
+
+   struct Entry
+   {
+      Key mKey;
+      float mWidth;
+      float mHeight;
+   };
+
+   static const int kMaxEntries = 4096;
+
+   std::list<Entry> mEntries; //most recently used at the front
+   std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> mLookup;
+   std::mutex mMutex;
+};
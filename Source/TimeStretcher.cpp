@@ -0,0 +1,415 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    TimeStretcher.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "TimeStretcher.h"
+#include "SynthGlobals.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace
+{
+   const float kWsolaFrameMs = 20; //short, so transients don't smear
+   const float kVocoderFrameMs = 80; //long, so partials resolve
+   const double kJumpTolerance = 64; //in source samples, how far the playhead can be from where it was headed before it counts as a jump
+   const float kVocoderOverlapGain = 1.5f; //a hann window squared, overlapped four times
+
+   int FrameSizeForMs(float ms)
+   {
+      int size = 64;
+      while (size * 1.5f < ms * gSampleRateMs)
+         size *= 2;
+      return size;
+   }
+
+   float Dot(const float* a, const float* b, int length)
+   {
+#if defined(__wasm_simd128__)
+      v128_t sum4 = wasm_f32x4_splat(0);
+      int i = 0;
+      for (; i + 4 <= length; i += 4)
+         sum4 = wasm_f32x4_add(sum4, wasm_f32x4_mul(wasm_v128_load(a + i), wasm_v128_load(b + i)));
+      float sum = wasm_f32x4_extract_lane(sum4, 0) + wasm_f32x4_extract_lane(sum4, 1) + wasm_f32x4_extract_lane(sum4, 2) + wasm_f32x4_extract_lane(sum4, 3);
+      for (; i < length; ++i)
+         sum += a[i] * b[i];
+      return sum;
+#else
+      float lanes[4]{};
+      int i = 0;
+      for (; i + 4 <= length; i += 4)
+      {
+         for (int lane = 0; lane < 4; ++lane)
+            lanes[lane] += a[i + lane] * b[i + lane];
+      }
+      float sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      for (; i < length; ++i)
+         sum += a[i] * b[i];
+      return sum;
+#endif
+   }
+
+   //FFTPlan's imaginary part has the opposite sign to the usual convention, so flip it to get the usual phase
+   float Phase(float re, float im)
+   {
+      return atan2f(-im, re);
+   }
+
+   float WrapPhase(float phase)
+   {
+      return phase - TWO_PI * floorf((phase + PI) / TWO_PI);
+   }
+}
+
+TimeStretcher::TimeStretcher()
+{
+   SetMode(StretchMode::Beats);
+}
+
+void TimeStretcher::SetMode(StretchMode mode)
+{
+   mMode = (mode == StretchMode::Tonal) ? StretchMode::Tonal : StretchMode::Beats;
+
+   if (mMode == StretchMode::Beats)
+   {
+      mFrameSize = FrameSizeForMs(kWsolaFrameMs);
+      mHopSize = mFrameSize / 2;
+      mSearchRadius = mFrameSize / 4;
+      mReference.resize(mFrameSize - mHopSize);
+      mCandidates.resize(mFrameSize - mHopSize + mSearchRadius * 2);
+      mCandidateEnergy.resize(mCandidates.size() + 1);
+   }
+   else
+   {
+      mFrameSize = FrameSizeForMs(kVocoderFrameMs);
+      mHopSize = mFrameSize / 4;
+      int numBins = mFrameSize / 2 + 1;
+      for (int ch = 0; ch < kMaxChannels; ++ch)
+      {
+         for (auto* bins : { &mRe[ch], &mIm[ch], &mLastRe[ch], &mLastIm[ch], &mSynthRe[ch], &mSynthIm[ch], &mLastSynthRe[ch], &mLastSynthIm[ch] })
+            bins->assign(numBins, 0);
+      }
+      mMagnitude.resize(numBins);
+      mPeaks.reserve(numBins / 2);
+   }
+
+   mPlan = &FFTPlan::Get(mFrameSize);
+   for (auto& accum : mAccum)
+      accum.resize(mFrameSize);
+   mFrame.resize(mFrameSize);
+   mScratch.resize(mPlan->GetScratchSize());
+   Reset();
+}
+
+void TimeStretcher::Reset()
+{
+   mPrimed = false;
+   mHopPos = mHopSize;
+   for (auto& accum : mAccum)
+      std::fill(accum.begin(), accum.end(), 0.0f);
+}
+
+void TimeStretcher::Process(const Source& source, double position, double rate, double pitchRatio, float* const* output, int numChannels, int size)
+{
+   assert(numChannels <= kMaxChannels);
+
+   if (mPrimed)
+   {
+      double jump = std::abs(position - mExpectedPosition);
+      if (source.mLooping && source.mLength > 0)
+      {
+         jump = fmod(jump, source.mLength);
+         jump = MIN(jump, source.mLength - jump);
+      }
+      if (jump > kJumpTolerance)
+         Reset();
+   }
+
+   for (int done = 0; done < size;)
+   {
+      if (mHopPos == mHopSize)
+      {
+         StartHop(source, position + done * rate, rate, pitchRatio, numChannels);
+         mHopPos = 0;
+      }
+      int numSamples = MIN(size - done, mHopSize - mHopPos);
+      for (int ch = 0; ch < numChannels; ++ch)
+         BufferCopy(output[ch] + done, mAccum[ch].data() + mHopPos, numSamples);
+      mHopPos += numSamples;
+      done += numSamples;
+   }
+
+   mExpectedPosition = position + size * rate;
+}
+
+void TimeStretcher::StartHop(const Source& source, double position, double rate, double pitchRatio, int numChannels)
+{
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      float* accum = mAccum[ch].data();
+      memmove(accum, accum + mHopSize, (mFrameSize - mHopSize) * sizeof(float));
+      ::Clear(accum + mFrameSize - mHopSize, mHopSize);
+   }
+
+   //each frame is centered on where the playhead will be halfway through it
+   double frameStart = position + mFrameSize * .5 * (rate - pitchRatio);
+   if (mMode == StretchMode::Beats)
+      StartWsolaHop(source, frameStart, pitchRatio, numChannels);
+   else
+      StartVocoderHop(source, frameStart, pitchRatio, numChannels);
+}
+
+void TimeStretcher::StartWsolaHop(const Source& source, double frameStart, double pitchRatio, int numChannels)
+{
+   if (!mPrimed)
+   {
+      //the frame before this one as well, carrying straight on into it, so the output starts at full level
+      AddFrame(source, frameStart - mHopSize * pitchRatio, pitchRatio, numChannels, mHopSize);
+      AddFrame(source, frameStart, pitchRatio, numChannels, 0);
+      mLastFrameStart = frameStart;
+      mPrimed = true;
+      return;
+   }
+
+   //look around where this frame should start for the offset that looks most like the last frame carrying straight on,
+   //on the channels mixed down
+   int overlap = mFrameSize - mHopSize;
+   int numCandidateSamples = (int)mCandidates.size();
+   double searchStart = frameStart - mSearchRadius * pitchRatio;
+   ReadSource(source, 0, mLastFrameStart + mHopSize * pitchRatio, pitchRatio, mReference.data(), overlap);
+   ReadSource(source, 0, searchStart, pitchRatio, mCandidates.data(), numCandidateSamples);
+   for (int ch = 1; ch < numChannels; ++ch)
+   {
+      ReadSource(source, ch, mLastFrameStart + mHopSize * pitchRatio, pitchRatio, mFrame.data(), overlap);
+      Add(mReference.data(), mFrame.data(), overlap);
+      ReadSource(source, ch, searchStart, pitchRatio, mFrame.data(), numCandidateSamples);
+      Add(mCandidates.data(), mFrame.data(), numCandidateSamples);
+   }
+
+   mCandidateEnergy[0] = 0;
+   for (int i = 0; i < numCandidateSamples; ++i)
+      mCandidateEnergy[i + 1] = mCandidateEnergy[i] + mCandidates[i] * mCandidates[i];
+   auto score = [this, overlap](int offset)
+   {
+      double energy = mCandidateEnergy[offset + overlap] - mCandidateEnergy[offset];
+      return Dot(mReference.data(), mCandidates.data() + offset, overlap) / sqrt(energy + 1e-9);
+   };
+
+   //every other offset, then either side of the best of those
+   int best = mSearchRadius;
+   double bestScore = score(best);
+   for (int offset = 0; offset <= mSearchRadius * 2; offset += 2)
+   {
+      double offsetScore = score(offset);
+      if (offsetScore > bestScore)
+      {
+         bestScore = offsetScore;
+         best = offset;
+      }
+   }
+   int coarseBest = best;
+   for (int offset : { coarseBest - 1, coarseBest + 1 })
+   {
+      if (offset < 0 || offset > mSearchRadius * 2)
+         continue;
+      double offsetScore = score(offset);
+      if (offsetScore > bestScore)
+      {
+         bestScore = offsetScore;
+         best = offset;
+      }
+   }
+
+   double chosenStart = searchStart + best * pitchRatio;
+   AddFrame(source, chosenStart, pitchRatio, numChannels, 0);
+   mLastFrameStart = chosenStart;
+}
+
+void TimeStretcher::StartVocoderHop(const Source& source, double frameStart, double pitchRatio, int numChannels)
+{
+   int numBins = mFrameSize / 2 + 1;
+
+   if (!mPrimed)
+   {
+      //the frames before this one as well, carrying straight on into it, so the output starts at full level
+      for (int frame = mFrameSize / mHopSize - 1; frame >= 1; --frame)
+      {
+         Analyze(source, frameStart - frame * mHopSize * pitchRatio, pitchRatio, numChannels, mRe, mIm);
+         Synthesize(mRe, mIm, numChannels, frame * mHopSize);
+      }
+      Analyze(source, frameStart, pitchRatio, numChannels, mRe, mIm);
+      Synthesize(mRe, mIm, numChannels, 0);
+      for (int ch = 0; ch < numChannels; ++ch)
+      {
+         mLastSynthRe[ch] = mRe[ch];
+         mLastSynthIm[ch] = mIm[ch];
+         std::swap(mLastRe[ch], mRe[ch]);
+         std::swap(mLastIm[ch], mIm[ch]);
+      }
+      mLastFrameStart = frameStart;
+      mPrimed = true;
+      return;
+   }
+
+   Analyze(source, frameStart, pitchRatio, numChannels, mRe, mIm);
+
+   //how far the analysis moved since the last frame, in output samples. too far to tell the frequencies apart (or backwards,
+   //round a loop), and they come from an extra analysis a standard hop back instead
+   double analysisHop = (frameStart - mLastFrameStart) / pitchRatio;
+   if (analysisHop < .5 || analysisHop > mHopSize + .5)
+   {
+      Analyze(source, frameStart - mHopSize * pitchRatio, pitchRatio, numChannels, mLastRe, mLastIm);
+      analysisHop = mHopSize;
+   }
+
+   //peaks of the channels together, each bin belongs to its nearest one
+   for (int bin = 0; bin < numBins; ++bin)
+   {
+      float magnitude = 0;
+      for (int ch = 0; ch < numChannels; ++ch)
+         magnitude += mRe[ch][bin] * mRe[ch][bin] + mIm[ch][bin] * mIm[ch][bin];
+      mMagnitude[bin] = magnitude;
+   }
+   mPeaks.clear();
+   for (int bin = 2; bin < numBins - 2; ++bin)
+   {
+      float magnitude = mMagnitude[bin];
+      if (magnitude > mMagnitude[bin - 1] && magnitude > mMagnitude[bin - 2] && magnitude >= mMagnitude[bin + 1] && magnitude >= mMagnitude[bin + 2])
+         mPeaks.push_back(bin);
+   }
+
+   //phase locking: each peak's phase moves on at its own frequency, and the bins around it keep their phase relative to it
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      if (mPeaks.empty())
+      {
+         mSynthRe[ch] = mRe[ch];
+         mSynthIm[ch] = mIm[ch];
+         continue;
+      }
+
+      for (int peakIndex = 0; peakIndex < (int)mPeaks.size(); ++peakIndex)
+      {
+         int peak = mPeaks[peakIndex];
+         int regionStart = (peakIndex == 0) ? 0 : (mPeaks[peakIndex - 1] + peak + 1) / 2;
+         int regionEnd = (peakIndex == (int)mPeaks.size() - 1) ? numBins : (peak + mPeaks[peakIndex + 1] + 1) / 2;
+
+         float phase = Phase(mRe[ch][peak], mIm[ch][peak]);
+         float binFrequency = TWO_PI * peak / mFrameSize;
+         float deviation = WrapPhase(phase - Phase(mLastRe[ch][peak], mLastIm[ch][peak]) - binFrequency * analysisHop);
+         float frequency = binFrequency + deviation / analysisHop;
+         float synthPhase = Phase(mLastSynthRe[ch][peak], mLastSynthIm[ch][peak]) + frequency * mHopSize;
+
+         float rotation = WrapPhase(synthPhase - phase);
+         float rotateRe = cosf(rotation);
+         float rotateIm = -sinf(rotation); //FFTPlan's sign again
+         for (int bin = regionStart; bin < regionEnd; ++bin)
+         {
+            float re = mRe[ch][bin];
+            float im = mIm[ch][bin];
+            mSynthRe[ch][bin] = re * rotateRe - im * rotateIm;
+            mSynthIm[ch][bin] = re * rotateIm + im * rotateRe;
+         }
+      }
+   }
+
+   Synthesize(mSynthRe, mSynthIm, numChannels, 0);
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      std::swap(mLastRe[ch], mRe[ch]);
+      std::swap(mLastIm[ch], mIm[ch]);
+      std::swap(mLastSynthRe[ch], mSynthRe[ch]);
+      std::swap(mLastSynthIm[ch], mSynthIm[ch]);
+   }
+   mLastFrameStart = frameStart;
+}
+
+void TimeStretcher::Analyze(const Source& source, double frameStart, double pitchRatio, int numChannels, std::vector<float>* re, std::vector<float>* im)
+{
+   const float* window = mPlan->GetHannWindow();
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      ReadSource(source, ch, frameStart, pitchRatio, mFrame.data(), mFrameSize);
+      for (int i = 0; i < mFrameSize; ++i)
+         mFrame[i] *= window[i];
+      mPlan->Forward(mFrame.data(), re[ch].data(), im[ch].data(), mScratch.data());
+   }
+}
+
+void TimeStretcher::Synthesize(const std::vector<float>* re, const std::vector<float>* im, int numChannels, int startInFrame)
+{
+   const float* window = mPlan->GetHannWindow();
+   float scale = 1.0f / (mFrameSize * kVocoderOverlapGain);
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      mPlan->Inverse(re[ch].data(), im[ch].data(), mFrame.data(), mScratch.data());
+      float* accum = mAccum[ch].data();
+      for (int i = startInFrame; i < mFrameSize; ++i)
+         accum[i - startInFrame] += mFrame[i] * window[i] * scale;
+   }
+}
+
+void TimeStretcher::AddFrame(const Source& source, double frameStart, double pitchRatio, int numChannels, int startInFrame)
+{
+   const float* window = mPlan->GetHannWindow();
+   int length = mFrameSize - startInFrame;
+   for (int ch = 0; ch < numChannels; ++ch)
+   {
+      ReadSource(source, ch, frameStart + startInFrame * pitchRatio, pitchRatio, mFrame.data(), length);
+      float* accum = mAccum[ch].data();
+      for (int i = 0; i < length; ++i)
+         accum[i] += mFrame[i] * window[startInFrame + i];
+   }
+}
+
+void TimeStretcher::ReadSource(const Source& source, int channel, double start, double step, float* dest, int length) const
+{
+   const float* data = source.mChannels[channel];
+   int sourceLength = source.mLength;
+   if (data == nullptr || sourceLength <= 0)
+   {
+      ::Clear(dest, length);
+      return;
+   }
+
+   for (int i = 0; i < length; ++i)
+   {
+      double pos = start + i * step;
+      if (source.mLooping)
+         pos -= floor(pos / sourceLength) * sourceLength;
+      int index = (int)floor(pos);
+      float frac = (float)(pos - index);
+      int nextIndex = index + 1;
+      if (source.mLooping && nextIndex >= sourceLength)
+         nextIndex -= sourceLength;
+      float a = (index >= 0 && index < sourceLength) ? data[index] : 0;
+      float b = (nextIndex >= 0 && nextIndex < sourceLength) ? data[nextIndex] : 0;
+      dest[i] = a + (b - a) * frac;
+   }
+}
@@ -0,0 +1,104 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    TimeStretcher.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChannelBuffer.h"
+#include "FFT.h"
+
+#include <vector>
+
+enum class StretchMode
+{
+   Off, //resampled, so speed changes pitch
+   Beats, //wsola, which keeps transients tight
+   Tonal //phase vocoder with phase locking, which keeps sustained material smooth
+};
+
+//plays a source at any speed without changing its pitch, for Sample::ConsumeData() and Looper.
+//it reads the source wherever the playhead is rather than streaming it in, so it adds no latency, and it starts over
+//(without a fade in) when the playhead goes somewhere it didn't expect. the channels share one analysis, so the stereo image holds
+class TimeStretcher
+{
+public:
+   static const int kMaxChannels = ChannelBuffer::kMaxNumChannels;
+
+   struct Source
+   {
+      const float* mChannels[kMaxChannels]{};
+      int mLength{ 0 };
+      bool mLooping{ false };
+   };
+
+   TimeStretcher();
+
+   void SetMode(StretchMode mode); //Beats or Tonal
+   StretchMode GetMode() const { return mMode; }
+   //renders size samples to output. the playhead starts at position, and moves rate source samples for each one rendered.
+   //pitchRatio is how far it would move to keep the source's pitch, which is the sample rate ratio for a sample from a file
+   void Process(const Source& source, double position, double rate, double pitchRatio, float* const* output, int numChannels, int size);
+   void Reset();
+
+private:
+   void StartHop(const Source& source, double position, double rate, double pitchRatio, int numChannels);
+   void StartWsolaHop(const Source& source, double frameStart, double pitchRatio, int numChannels);
+   void StartVocoderHop(const Source& source, double frameStart, double pitchRatio, int numChannels);
+   void Analyze(const Source& source, double frameStart, double pitchRatio, int numChannels, std::vector<float>* re, std::vector<float>* im);
+   void Synthesize(const std::vector<float>* re, const std::vector<float>* im, int numChannels, int startInFrame);
+   void AddFrame(const Source& source, double frameStart, double pitchRatio, int numChannels, int startInFrame);
+   void ReadSource(const Source& source, int channel, double start, double step, float* dest, int length) const;
+
+   StretchMode mMode{ StretchMode::Beats };
+   int mFrameSize{ 0 };
+   int mHopSize{ 0 };
+   int mHopPos{ 0 }; //how much of the current hop has been rendered
+   bool mPrimed{ false };
+   double mExpectedPosition{ 0 };
+   double mLastFrameStart{ 0 };
+   const FFTPlan* mPlan{ nullptr };
+
+   std::vector<float> mAccum[kMaxChannels]; //frames overlap-added, the current hop first
+   std::vector<float> mFrame;
+   std::vector<float> mScratch;
+
+   //wsola: the search for the offset that best continues the last frame, on the channels mixed down
+   int mSearchRadius{ 0 };
+   std::vector<float> mReference;
+   std::vector<float> mCandidates;
+   std::vector<double> mCandidateEnergy;
+
+   //phase vocoder: the last analysis, and what was synthesized from it
+   std::vector<float> mRe[kMaxChannels];
+   std::vector<float> mIm[kMaxChannels];
+   std::vector<float> mLastRe[kMaxChannels];
+   std::vector<float> mLastIm[kMaxChannels];
+   std::vector<float> mSynthRe[kMaxChannels];
+   std::vector<float> mSynthIm[kMaxChannels];
+   std::vector<float> mLastSynthRe[kMaxChannels];
+   std::vector<float> mLastSynthIm[kMaxChannels];
+   std::vector<float> mMagnitude;
+   std::vector<int> mPeaks;
+};
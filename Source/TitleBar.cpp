@@ -28,6 +28,7 @@
 #include "SynthGlobals.h"
 #include "Profiler.h"
 #include "ModuleFactory.h"
+#include "SpawnIndex.h"
 #include "ModuleSaveDataPanel.h"
 #include "HelpDisplay.h"
 #include "Prefab.h"
@@ -192,7 +193,7 @@ void TitleBar::OnWindowClosed()
 {
    mPluginListWindow.reset(nullptr);
 
-   TheSynth->GetKnownPluginList().createXml()->writeTo(juce::File(ofToDataPath("vst/found_vsts.xml")));
+   VSTLookup::SaveKnownPluginList();
 }
 
 SpawnListManager::SpawnListManager(IDropdownListener* owner)
@@ -234,9 +235,7 @@ void SpawnListManager::SetModuleFactory(ModuleFactory* factory)
 
 void SpawnListManager::SetUpPrefabsDropdown()
 {
-   std::vector<ModuleFactory::Spawnable> prefabs;
-   ModuleFactory::GetPrefabs(prefabs);
-   mPrefabs.SetList(prefabs);
+   mPrefabs.SetList(TheSynth->GetModuleFactory()->GetSpawnIndex()->GetPrefabs());
 }
 
 void SpawnListManager::SetUpPluginsDropdown()
@@ -247,29 +246,12 @@ void SpawnListManager::SetUpPluginsDropdown()
    scanDummy.mLabel = kManagePluginsLabel;
    list.push_back(scanDummy);
 
-   std::vector<juce::PluginDescription> recentPlugins;
-   VSTLookup::GetRecentPlugins(recentPlugins, 8);
-   for (auto& pluginDesc : recentPlugins)
-   {
-      ModuleFactory::Spawnable spawnable{};
-      spawnable.mLabel = pluginDesc.name.toStdString();
-      spawnable.mDecorator = "[" + ModuleFactory::Spawnable::GetPluginLabel(pluginDesc) + "]";
-      spawnable.mPluginDesc = pluginDesc;
-      spawnable.mSpawnMethod = ModuleFactory::SpawnMethod::Plugin;
-      list.push_back(spawnable);
-   }
+   SpawnIndex* spawnIndex = TheSynth->GetModuleFactory()->GetSpawnIndex();
+   const auto& recentPlugins = spawnIndex->GetRecentPlugins(8);
+   list.insert(list.end(), recentPlugins.begin(), recentPlugins.end());
 
-   std::vector<juce::PluginDescription> vsts;
-   VSTLookup::GetAvailableVSTs(vsts);
-   for (auto& pluginDesc : vsts)
-   {
-      ModuleFactory::Spawnable spawnable{};
-      spawnable.mLabel = pluginDesc.name.toStdString();
-      spawnable.mDecorator = "[" + ModuleFactory::Spawnable::GetPluginLabel(pluginDesc) + "]";
-      spawnable.mPluginDesc = pluginDesc;
-      spawnable.mSpawnMethod = ModuleFactory::SpawnMethod::Plugin;
-      list.push_back(spawnable);
-   }
+   const auto& plugins = spawnIndex->GetPlugins();
+   list.insert(list.end(), plugins.begin(), plugins.end());
 
    mPlugins.SetList(list);
    mPlugins.GetList()->ClearSeparators();
@@ -416,7 +398,13 @@ void TitleBar::DrawModule()
    std::string stats;
    stats += "fps:" + ofToString(ofGetFrameRate(), 0);
    stats += "  audio cpu:" + ofToString(usage * 100, 1);
-   if (usage > 1)
+   int missedDeadlines = TheSynth->GetCallbackMonitor().GetRecentMissedDeadlines();
+   if (missedDeadlines > 0)
+      stats += "  missed:" + ofToString(missedDeadlines) + " in " + ofToString(AudioCallbackMonitor::kRecentMinutes) + "m";
+   int governorLevel = TheSynth->GetCpuGovernor().GetLevel();
+   if (governorLevel > CpuGovernor::kLevel_None)
+      stats += "  degraded:" + ofToString(governorLevel);
+   if (usage > 1 || missedDeadlines > 0)
       ofSetColor(255, 150, 150);
    else
       ofSetColor(255, 255, 255);
@@ -27,8 +27,11 @@
 #include "SynthGlobals.h"
 #include "ModularSynth.h"
 #include "ChaosEngine.h"
+#include "ReplayCapture.h"
 #include "ableton/platforms/asio/AsioTimer.hpp"
 
+#include <algorithm>
+
 Transport* TheTransport = nullptr;
 
 //statics
@@ -45,6 +48,13 @@ Transport::Transport()
    SetRandomTempo();
 }
 
+Transport::~Transport()
+{
+   mAudioPollersInUse = nullptr;
+   delete mPublishedAudioPollers.exchange(nullptr);
+   FreeRetiredAudioPollers();
+}
+
 void Transport::SetRandomTempo()
 {
    SetTempo(gRandom() % 80 + 75);
@@ -107,6 +117,9 @@ void Transport::Poll()
       SetRandomTempo();
       mWantSetRandomTempo = false;
    }
+
+   ApplyDeferredAudioPollerChanges();
+   FreeRetiredAudioPollers();
 }
 
 void Transport::KeyPressed(int key, bool isRepeat)
@@ -116,7 +129,13 @@ void Transport::KeyPressed(int key, bool isRepeat)
 
 void Transport::Advance(double ms)
 {
-   if (mNudgeFactor != 0)
+   double targetMeasureTime;
+   if (mClockSource != nullptr && mClockSource->GetTargetMeasureTime(ms, targetMeasureTime))
+   {
+      ms = FollowClockSource(ms, targetMeasureTime);
+      mNudgeFactor = 0; //the clock source decides where we are
+   }
+   else if (mNudgeFactor != 0)
    {
       const float kNudgePower = .05f;
       float nudgeScale = (1 + mNudgeFactor * kNudgePower);
@@ -159,13 +178,82 @@ void Transport::Advance(double ms)
 
    UpdateListeners(ms);
 
-   for (std::list<IAudioPoller*>::iterator i = mAudioPollers.begin(); i != mAudioPollers.end(); ++i)
+   //the list we used last time is still ours, hold on to it until the counters have been carried over to the new one
+   AudioPollerList* previous = mAudioPollersInUse;
+   mPreviousAudioPollersInUse = previous;
+   AudioPollerList* pollers;
+   do
+   {
+      pollers = mPublishedAudioPollers;
+      mAudioPollersInUse = pollers;
+   } while (pollers != mPublishedAudioPollers); //make sure it didn't get retired before we claimed it
+   if (previous != pollers && previous != nullptr && pollers != nullptr)
+      CarryOverAudioPollerCounters(*previous, *pollers);
+   mPreviousAudioPollersInUse = nullptr;
+
+   if (pollers != nullptr)
    {
-      IAudioPoller* poller = *i;
-      poller->OnTransportAdvanced(amount);
+      for (auto& entry : *pollers)
+      {
+         if (entry.mBufferDivider == 1)
+         {
+            entry.mPoller->OnTransportAdvanced(amount);
+            continue;
+         }
+
+         entry.mAmountSinceCall += amount;
+         if (--entry.mCountdown == 0)
+         {
+            entry.mPoller->OnTransportAdvanced(entry.mAmountSinceCall);
+            entry.mAmountSinceCall = 0;
+            entry.mCountdown = entry.mBufferDivider;
+         }
+      }
    }
 }
 
+//static
+void Transport::CarryOverAudioPollerCounters(const AudioPollerList& from, AudioPollerList& to)
+{
+   //the lists mostly differ by an insert or a removal, so look for each poller from where the last one was found
+   size_t fromIndex = 0;
+   for (auto& entry : to)
+   {
+      if (entry.mBufferDivider == 1)
+         continue;
+      for (size_t i = 0; i < from.size(); ++i)
+      {
+         const auto& previous = from[(fromIndex + i) % from.size()];
+         if (previous.mPoller == entry.mPoller)
+         {
+            entry.mCountdown = MIN(previous.mCountdown, entry.mBufferDivider);
+            entry.mAmountSinceCall = previous.mAmountSinceCall;
+            fromIndex = (fromIndex + i + 1) % from.size();
+            break;
+         }
+      }
+   }
+}
+
+//how far to advance to stay with the clock source. a small drift is pulled in by running slightly fast or slow over the
+//next few buffers, so nothing downstream hears a jump. only a big difference (the session restarting, the offset changing) jumps
+double Transport::FollowClockSource(double ms, double targetMeasureTime)
+{
+   const double kMaxDriftMs = MsPerBar() / mTimeSigTop / 2; //half a beat
+   const double kCorrectionPerBuffer = .1; //close a tenth of the gap each buffer...
+   const double kMaxSpeedChange = .05; //...without running more than 5% off tempo
+
+   double errorMs = (targetMeasureTime - mMeasureTime) * MsPerBar() - ms;
+   if (abs(errorMs) > kMaxDriftMs)
+   {
+      mMeasureTime = targetMeasureTime - ms / MsPerBar();
+      ofLog() << "correcting transport position for external clock";
+      return ms;
+   }
+
+   return ms + ofClamp(errorMs * kCorrectionPerBuffer, -ms * kMaxSpeedChange, ms * kMaxSpeedChange);
+}
+
 float QuadraticBezier(float x, float a, float b)
 {
    // adapted from BEZMATH.PS (1993)
@@ -273,6 +361,13 @@ void Transport::DrawModule()
    ofLine(nudgeX, mNudgeBackButton->GetRect(true).getMinY(), nudgeX, mNudgeBackButton->GetRect(true).getMaxY());
 }
 
+void Transport::SetTempo(float tempo)
+{
+   if (tempo != mTempo)
+      ReplayCapture::RecordTempo(tempo);
+   mTempo = tempo;
+}
+
 void Transport::Reset(bool timeSensitive /*= false*/)
 {
    if (mLoopEndMeasure != -1)
@@ -322,9 +417,16 @@ TransportListenerInfo* Transport::AddListener(ITimeListener* listener, NoteInter
       info->mOffsetInfo = offsetInfo;
       info->mUseEventLookahead = useEventLookahead;
    }
+   else if (!mStagings.empty())
+   {
+      mStagings.back().mListeners.push_front(TransportListenerInfo(listener, interval, offsetInfo, useEventLookahead));
+   }
    else
    {
       mListeners.push_front(TransportListenerInfo(listener, interval, offsetInfo, useEventLookahead));
+      mScheduleDirty = true;
+      if (!mUpdatingListeners)
+         RebuildSchedule();
    }
 
    return GetListenerInfo(listener);
@@ -338,6 +440,14 @@ TransportListenerInfo* Transport::GetListenerInfo(ITimeListener* listener)
       if (info.mListener == listener)
          return &info;
    }
+   for (auto& staging : mStagings)
+   {
+      for (auto& info : staging.mListeners)
+      {
+         if (info.mListener == listener)
+            return &info;
+      }
+   }
    return nullptr;
 }
 
@@ -347,13 +457,47 @@ void Transport::RemoveListener(ITimeListener* listener)
    {
       TransportListenerInfo& info = *i;
       if (info.mListener == listener)
+      {
+         for (auto& entry : mSchedule)
+         {
+            if (entry.mInfo == &info)
+               entry.mInfo = nullptr;
+         }
+         mScheduleDirty = true;
          i = mListeners.erase(i);
+      }
       else
+      {
          ++i;
+      }
+   }
+   for (auto& staging : mStagings)
+   {
+      staging.mListeners.remove_if([listener](const TransportListenerInfo& info)
+                                   { return info.mListener == listener; });
+   }
+
+   if (mScheduleDirty && !mUpdatingListeners)
+      RebuildSchedule();
+}
+
+namespace
+{
+   template <typename T>
+   typename T::iterator FindAudioPoller(T& pollers, IAudioPoller* poller)
+   {
+      return std::find_if(pollers.begin(), pollers.end(), [poller](const auto& entry)
+                          { return entry.mPoller == poller; });
    }
 }
 
-void Transport::AddAudioPoller(IAudioPoller* poller)
+void Transport::AddAudioPoller(IAudioPoller* poller, int bufferDivider /*= 1*/)
+{
+   if (!DeferAudioPollerChange(poller, bufferDivider, true))
+      DoAddAudioPoller(poller, bufferDivider);
+}
+
+void Transport::DoAddAudioPoller(IAudioPoller* poller, int bufferDivider)
 {
 #if DEBUG
    IDrawableModule* module = dynamic_cast<IDrawableModule*>(poller);
@@ -362,19 +506,183 @@ void Transport::AddAudioPoller(IAudioPoller* poller)
       assert(module->IsInitialized());
 #endif
 
-   if (!ListContains(poller, mAudioPollers))
-      mAudioPollers.push_front(poller);
+   AudioPollerEntry entry;
+   entry.mPoller = poller;
+   entry.mBufferDivider = MAX(1, bufferDivider);
+
+   auto existing = FindAudioPoller(mAudioPollers, poller);
+   if (existing != mAudioPollers.end())
+   {
+      if (existing->mBufferDivider != entry.mBufferDivider)
+      {
+         existing->mBufferDivider = entry.mBufferDivider;
+         PublishAudioPollers();
+      }
+   }
+   else if (!mStagings.empty())
+   {
+      for (auto& staging : mStagings)
+      {
+         auto staged = FindAudioPoller(staging.mAudioPollers, poller);
+         if (staged != staging.mAudioPollers.end())
+         {
+            staged->mBufferDivider = entry.mBufferDivider;
+            return;
+         }
+      }
+      auto& pollers = mStagings.back().mAudioPollers;
+      pollers.insert(pollers.begin(), entry);
+   }
+   else
+   {
+      mAudioPollers.insert(mAudioPollers.begin(), entry);
+      PublishAudioPollers();
+   }
 }
 
 void Transport::RemoveAudioPoller(IAudioPoller* poller)
 {
-   mAudioPollers.remove(poller);
+   if (DeferAudioPollerChange(poller, 1, false))
+      return;
+   ApplyDeferredAudioPollerChanges(); //so that an add still in the queue can't bring it back after it's gone
+   DoRemoveAudioPoller(poller);
+}
+
+void Transport::DoRemoveAudioPoller(IAudioPoller* poller)
+{
+   auto existing = FindAudioPoller(mAudioPollers, poller);
+   if (existing != mAudioPollers.end())
+   {
+      mAudioPollers.erase(existing);
+      PublishAudioPollers();
+   }
+   for (auto& staging : mStagings)
+   {
+      auto staged = FindAudioPoller(staging.mAudioPollers, poller);
+      if (staged != staging.mAudioPollers.end())
+         staging.mAudioPollers.erase(staged);
+   }
+}
+
+void Transport::PublishAudioPollers()
+{
+   AudioPollerList* pollers = new AudioPollerList(mAudioPollers);
+   for (size_t i = 0; i < pollers->size(); ++i)
+   {
+      //spread the divided pollers across buffers, rather than have them all land on the same one.
+      //the ones that were already there pick up where they were when the audio thread switches over
+      auto& entry = (*pollers)[i];
+      entry.mCountdown = 1 + (int)(i % entry.mBufferDivider);
+      entry.mAmountSinceCall = 0;
+   }
+
+   AudioPollerList* oldPollers = mPublishedAudioPollers.exchange(pollers);
+   if (oldPollers != nullptr)
+   {
+      std::lock_guard<std::mutex> lock(mRetiredAudioPollersMutex);
+      mRetiredAudioPollers.push_back(oldPollers);
+   }
+}
+
+void Transport::FreeRetiredAudioPollers()
+{
+   std::lock_guard<std::mutex> lock(mRetiredAudioPollersMutex);
+   for (auto iter = mRetiredAudioPollers.begin(); iter != mRetiredAudioPollers.end();)
+   {
+      if (*iter != mAudioPollersInUse && *iter != mPreviousAudioPollersInUse)
+      {
+         delete *iter;
+         iter = mRetiredAudioPollers.erase(iter);
+      }
+      else
+      {
+         ++iter;
+      }
+   }
+}
+
+bool Transport::DeferAudioPollerChange(IAudioPoller* poller, int bufferDivider, bool add)
+{
+   if (!IsAudioThread() && !AudioGraphScheduler::IsWorkerThread())
+      return false;
+   if (juce::MessageManager::existsAndIsCurrentThread()) //the offline runners call AudioOut() from the message thread, there's no one to defer to
+      return false;
+
+   DeferredAudioPollerChange change;
+   change.mPoller = poller;
+   change.mBufferDivider = bufferDivider;
+   change.mAdd = add;
+   while (mDeferringAudioPollerChange.test_and_set(std::memory_order_acquire))
+   {
+   }
+   mDeferredAudioPollerChanges.try_enqueue(change); //dropped rather than allocating if the main thread has fallen that far behind
+   mDeferringAudioPollerChange.clear(std::memory_order_release);
+   return true;
+}
+
+void Transport::ApplyDeferredAudioPollerChanges()
+{
+   DeferredAudioPollerChange change;
+   while (mDeferredAudioPollerChanges.try_dequeue(change))
+   {
+      if (change.mAdd)
+         DoAddAudioPoller(change.mPoller, change.mBufferDivider);
+      else
+         DoRemoveAudioPoller(change.mPoller);
+   }
+}
+
+int Transport::BeginStaging()
+{
+   Staging staging;
+   staging.mToken = mNextStagingToken++;
+   mStagings.push_back(std::move(staging));
+   return mStagings.back().mToken;
+}
+
+void Transport::CommitStaged(int token)
+{
+   auto staging = std::find_if(mStagings.begin(), mStagings.end(), [token](const Staging& s)
+                               { return s.mToken == token; });
+   if (staging == mStagings.end())
+      return;
+
+   //splicing keeps the TransportListenerInfo addresses that AddListener() handed out
+   if (!staging->mListeners.empty())
+   {
+      mListeners.splice(mListeners.begin(), staging->mListeners);
+      mScheduleDirty = true;
+      if (!mUpdatingListeners)
+         RebuildSchedule();
+   }
+   if (!staging->mAudioPollers.empty())
+   {
+      mAudioPollers.insert(mAudioPollers.begin(), staging->mAudioPollers.begin(), staging->mAudioPollers.end());
+      PublishAudioPollers();
+   }
+   mStagings.erase(staging);
 }
 
 void Transport::ClearListenersAndPollers()
 {
    mListeners.clear();
+   for (auto& entry : mSchedule)
+      entry.mInfo = nullptr;
+   mScheduleDirty = true;
+   if (!mUpdatingListeners)
+      RebuildSchedule();
    mAudioPollers.clear();
+   PublishAudioPollers();
+   DeferredAudioPollerChange change;
+   while (mDeferredAudioPollerChanges.try_dequeue(change)) //for pollers that are all about to be gone
+   {
+   }
+   for (auto& staging : mStagings) //the loads still hold their tokens
+   {
+      staging.mListeners.clear();
+      staging.mAudioPollers.clear();
+   }
+   mClockSource = nullptr;
 }
 
 int Transport::GetQuantized(double time, const TransportListenerInfo* listenerInfo, double* remainderMs /*=nullptr*/)
@@ -644,35 +952,165 @@ double Transport::GetMeasureFraction(NoteInterval interval)
    }
 }
 
-void Transport::UpdateListeners(double jumpMs)
+void Transport::RebuildSchedule()
 {
-   std::list<int> priorities;
-   for (const auto& info : mListeners)
+   mSchedule.clear();
+   for (auto& info : mListeners)
+      mSchedule.push_back(ScheduledListener(&info));
+
+   //insertion sort: it's stable (listeners with the same priority keep their order in mListeners), and doesn't allocate
+   for (size_t i = 1; i < mSchedule.size(); ++i)
    {
-      if (info.mListener != nullptr && !ListContains(info.mListener->mTransportPriority, priorities))
-         priorities.push_back(info.mListener->mTransportPriority);
+      for (size_t j = i; j > 0 && mSchedule[j - 1].mPriority > mSchedule[j].mPriority; --j)
+         std::swap(mSchedule[j - 1], mSchedule[j]);
    }
 
-   priorities.sort();
+   mScheduleDirty = false;
+}
 
-   for (const auto& priority : priorities)
+bool Transport::HasSameTiming(const TransportListenerInfo& a, const TransportListenerInfo& b)
+{
+   return a.mInterval == b.mInterval && a.mOffsetInfo.mOffset == b.mOffsetInfo.mOffset && a.mOffsetInfo.mOffsetIsInMs == b.mOffsetInfo.mOffsetIsInMs &&
+          a.mUseEventLookahead == b.mUseEventLookahead && a.mCustomDivisor == b.mCustomDivisor;
+}
+
+double Transport::GetMeasuresUntilStepCouldChange(double time, const TransportListenerInfo* listenerInfo)
+{
+   //a lower bound on how far the transport has to advance before GetQuantized() could return something different for this listener.
+   //steps are evenly spaced in swung time, and swing never runs faster than 1 + |term| times real time
+   double offsetMs;
+   if (listenerInfo->mOffsetInfo.mOffsetIsInMs)
+      offsetMs = listenerInfo->mOffsetInfo.mOffset;
+   else
+      offsetMs = listenerInfo->mOffsetInfo.mOffset * MsPerBar();
+
+   double measureTime = GetMeasureTime(time + offsetMs);
+   if (measureTime < 0)
+      return 0; //GetMeasurePos() goes negative here, just check every buffer
+   double measure = floor(measureTime);
+   double measurePos = measureTime - measure;
+   double untilNextMeasure = 1 - measurePos;
+   double pos = Swing(measurePos);
+
+   //same as the step calculations in GetQuantized(), but keeping the fraction
+   double stepsPerMeasure;
+   double stepPos;
+   switch (listenerInfo->mInterval)
+   {
+      case kInterval_2n:
+      case kInterval_2nt:
+      case kInterval_4n:
+      case kInterval_4nt:
+      case kInterval_8n:
+      case kInterval_8nt:
+      case kInterval_16n:
+      case kInterval_16nt:
+      case kInterval_32n:
+      case kInterval_32nt:
+      case kInterval_64n:
+         stepsPerMeasure = double(mTimeSigTop) / mTimeSigBottom * CountInStandardMeasure(listenerInfo->mInterval);
+         stepPos = pos * stepsPerMeasure;
+         break;
+      case kInterval_4nd:
+      case kInterval_8nd:
+      case kInterval_16nd:
+         stepsPerMeasure = double(mTimeSigTop) / mTimeSigBottom / GetMeasureFraction(listenerInfo->mInterval);
+         stepPos = (measure + pos * mTimeSigTop / mTimeSigBottom) / GetMeasureFraction(listenerInfo->mInterval);
+         break;
+      case kInterval_CustomDivisor:
+         stepsPerMeasure = listenerInfo->mCustomDivisor;
+         stepPos = pos * stepsPerMeasure;
+         break;
+      default:
+         return untilNextMeasure; //these only change on measure boundaries
+   }
+
+   double swingTerm = (.5 - mSwing) / (mSwing * mSwing - mSwing);
+   double maxSwingRate = 1 + fabs(swingTerm);
+   if (!(stepsPerMeasure > 0) || !std::isfinite(maxSwingRate))
+      return 0;
+
+   double untilNextStep = (floor(stepPos) + 1 - stepPos) / (stepsPerMeasure * maxSwingRate);
+   return MIN(untilNextStep, untilNextMeasure);
+}
+
+void Transport::UpdateListeners(double jumpMs)
+{
+   if (mScheduleDirty)
+      RebuildSchedule();
+
+   const double msPerBar = MsPerBar();
+
+   //wake times are in measures, so they hold as long as the transport just keeps moving forward at the same tempo, swing and signature.
+   //a seek, a loop jump or a change to any of that invalidates all of them
+   ScheduleTimeline timeline;
+   timeline.mTempo = mTempo;
+   timeline.mSwing = mSwing;
+   timeline.mSwingInterval = mSwingInterval;
+   timeline.mTimeSigTop = mTimeSigTop;
+   timeline.mTimeSigBottom = mTimeSigBottom;
+   timeline.mQueuedMeasure = mQueuedMeasure;
+   timeline.mJumpFromMeasure = mJumpFromMeasure;
+   timeline.mEventLookaheadMs = GetEventLookaheadMs();
+   bool timelineContinues = timeline == mScheduleTimeline && mMeasureTime == mScheduleMeasureTime + jumpMs / msPerBar;
+   mScheduleTimeline = timeline;
+   mScheduleMeasureTime = mMeasureTime;
+
+   //listener infos get changed in place by their owners, so catch that (and priority changes) by comparing against what each wake time was based on
+   bool prioritiesChanged = false;
+   for (auto& entry : mSchedule)
    {
-      for (const auto& info : mListeners)
+      if (entry.mInfo == nullptr || entry.mInfo->mListener == nullptr)
+         continue;
+      if (entry.mInfo->mListener->mTransportPriority != entry.mPriority)
+         prioritiesChanged = true;
+      if (!timelineContinues || !HasSameTiming(entry.mTiming, *entry.mInfo))
       {
-         if (info.mListener != nullptr &&
-             info.mListener->mTransportPriority == priority &&
-             info.mInterval != kInterval_None &&
-             info.mInterval != kInterval_Free)
-         {
-            double lookaheadMs = jumpMs;
-            if (info.mUseEventLookahead)
-               lookaheadMs = MAX(lookaheadMs, GetEventLookaheadMs());
+         entry.mTiming = *entry.mInfo;
+         entry.mWakeMeasureTime = -DBL_MAX;
+      }
+   }
+   if (prioritiesChanged)
+      RebuildSchedule(); //starts every listener over
 
-            double checkTime = gTime + lookaheadMs;
+   mUpdatingListeners = true;
+   for (size_t i = 0; i < mSchedule.size(); ++i) //by index, since listeners can add or remove listeners from OnTimeEvent()
+   {
+      ScheduledListener& entry = mSchedule[i];
+      const TransportListenerInfo* info = entry.mInfo;
+      if (info != nullptr &&
+          info->mListener != nullptr &&
+          info->mInterval != kInterval_None &&
+          info->mInterval != kInterval_Free)
+      {
+         double lookaheadMs = jumpMs;
+         if (info->mUseEventLookahead)
+            lookaheadMs = MAX(lookaheadMs, GetEventLookaheadMs());
+
+         double checkMeasureTime = mMeasureTime + lookaheadMs / msPerBar;
+         if (checkMeasureTime < entry.mWakeMeasureTime)
+            continue;
 
+         double checkTime = gTime + lookaheadMs;
+
+         const double kWakeMargin = .99; //wake a little early rather than risk rounding past a step
+         double wakeMeasureTime = checkMeasureTime + GetMeasuresUntilStepCouldChange(checkTime, info) * kWakeMargin;
+         if (mQueuedMeasure != -1)
+         {
+            //don't sleep through the queued jump, which remaps the measure (taking the listener's offset into account in GetQuantized())
+            double offsetMeasures = info->mOffsetInfo.mOffsetIsInMs ? info->mOffsetInfo.mOffset / msPerBar : info->mOffsetInfo.mOffset;
+            for (double jumpPoint : { double(mJumpFromMeasure), mJumpFromMeasure - offsetMeasures })
+            {
+               if (jumpPoint > checkMeasureTime)
+                  wakeMeasureTime = MIN(wakeMeasureTime, jumpPoint);
+            }
+         }
+         entry.mWakeMeasureTime = wakeMeasureTime;
+
+         {
             double remainderMs;
-            int oldStep = GetQuantized(checkTime - jumpMs, &info);
-            int newStep = GetQuantized(checkTime, &info, &remainderMs);
+            int oldStep = GetQuantized(checkTime - jumpMs, info);
+            int newStep = GetQuantized(checkTime, info, &remainderMs);
             bool oldJumped = IsPastQueuedMeasureJump(checkTime - jumpMs);
             bool newJumped = IsPastQueuedMeasureJump(checkTime);
             if (oldStep != newStep ||
@@ -689,11 +1127,15 @@ void Transport::UpdateListeners(double jumpMs)
                   ofLog() << remainderShouldBeZeroMs;
                }*/
                //assert(GetQuantized(checkTime + offsetMs, info.mInterval) == GetQuantized(time + offsetMs, info.mInterval));
-               info.mListener->OnTimeEvent(time);
+               info->mListener->OnTimeEvent(time);
             }
          }
       }
    }
+   mUpdatingListeners = false;
+
+   if (mScheduleDirty)
+      RebuildSchedule();
 }
 
 void Transport::OnDrumEvent(NoteInterval drumEvent)
@@ -33,6 +33,12 @@
 #include "IAudioPoller.h"
 #include "AbletonDeviceShared.h"
 #include "TapTempo.h"
+#include "readerwriterqueue.h"
+
+#include <atomic>
+#include <cfloat>
+#include <mutex>
+#include <vector>
 
 class ITimeListener
 {
@@ -46,6 +52,16 @@ public:
    int mTransportPriority{ kDefaultTransportPriority };
 };
 
+//a clock outside the synth that the transport follows, like an ableton link session. it's asked once per buffer,
+//before anything hears the transport move, so everything in the buffer sees the same position
+class ITransportClockSource
+{
+public:
+   virtual ~ITransportClockSource() {}
+   //where the transport should be once it's advanced by ms, or false to let it run freely for this buffer
+   virtual bool GetTargetMeasureTime(double ms, double& measureTime) = 0;
+};
+
 enum NoteInterval
 {
    kInterval_1n,
@@ -105,12 +121,13 @@ class Transport : public IDrawableModule, public IButtonListener, public IFloatS
 {
 public:
    Transport();
+   ~Transport();
 
    void CreateUIControls() override;
    void Poll() override;
 
    float GetTempo() { return mTempo; }
-   void SetTempo(float tempo) { mTempo = tempo; }
+   void SetTempo(float tempo);
    void SetTimeSignature(int top, int bottom)
    {
       mTimeSigTop = top;
@@ -125,9 +142,17 @@ public:
    TransportListenerInfo* AddListener(ITimeListener* listener, NoteInterval interval, OffsetInfo offsetInfo, bool useEventLookahead);
    void RemoveListener(ITimeListener* listener);
    TransportListenerInfo* GetListenerInfo(ITimeListener* listener);
-   void AddAudioPoller(IAudioPoller* poller);
+   //with a divider, it's called every that many buffers with the amount since the last call, for pollers that only need control rate.
+   //from the audio thread or a graph worker, the change is queued and made by the main thread's next Poll(), since it allocates
+   void AddAudioPoller(IAudioPoller* poller, int bufferDivider = 1);
    void RemoveAudioPoller(IAudioPoller* poller);
    void ClearListenersAndPollers();
+   //listeners and pollers added from here on aren't called until CommitStaged() is given the token this returns, which has to be called under the audio lock.
+   //loads can overlap: what's added goes to the latest staging that hasn't been committed, and each commit only splices in its own
+   int BeginStaging();
+   void CommitStaged(int token);
+   void SetClockSource(ITransportClockSource* source) { mClockSource = source; }
+   ITransportClockSource* GetClockSource() const { return mClockSource; }
    double GetDuration(NoteInterval interval);
    int GetQuantized(double time, const TransportListenerInfo* listenerInfo, double* remainderMs = nullptr);
    double GetMeasurePos(double time) const { return fmod(GetMeasureTime(time), 1); }
@@ -193,10 +218,48 @@ public:
    static bool IsTripletInterval(NoteInterval interval);
 
 private:
+   struct ScheduledListener
+   {
+      explicit ScheduledListener(TransportListenerInfo* info)
+      : mInfo(info)
+      , mTiming(*info)
+      , mPriority(info->mListener ? info->mListener->mTransportPriority : 0)
+      {}
+
+      TransportListenerInfo* mInfo{ nullptr }; //nulled if the listener is removed while listeners are being updated
+      TransportListenerInfo mTiming; //what mWakeMeasureTime was calculated from
+      int mPriority{ 0 };
+      double mWakeMeasureTime{ -DBL_MAX }; //the listener can't fire before the transport reaches this measure time
+   };
+
+   struct ScheduleTimeline
+   {
+      bool operator==(const ScheduleTimeline& other) const
+      {
+         return mTempo == other.mTempo && mSwing == other.mSwing && mSwingInterval == other.mSwingInterval &&
+                mTimeSigTop == other.mTimeSigTop && mTimeSigBottom == other.mTimeSigBottom &&
+                mQueuedMeasure == other.mQueuedMeasure && mJumpFromMeasure == other.mJumpFromMeasure &&
+                mEventLookaheadMs == other.mEventLookaheadMs;
+      }
+
+      float mTempo{ 0 };
+      float mSwing{ 0 };
+      int mSwingInterval{ 0 };
+      int mTimeSigTop{ 0 };
+      int mTimeSigBottom{ 0 };
+      int mQueuedMeasure{ 0 };
+      int mJumpFromMeasure{ 0 };
+      double mEventLookaheadMs{ 0 };
+   };
+
    void UpdateListeners(double jumpMs);
+   void RebuildSchedule();
+   double GetMeasuresUntilStepCouldChange(double time, const TransportListenerInfo* listenerInfo);
+   static bool HasSameTiming(const TransportListenerInfo& a, const TransportListenerInfo& b);
    double Swing(double measurePos);
    double SwingBeat(double pos);
    void Nudge(double amount);
+   double FollowClockSource(double ms, double targetMeasureTime);
    void SetRandomTempo();
    double GetMeasureTimeInternal(double time) const;
 
@@ -237,7 +300,49 @@ private:
    double mSeekMsAfterJump{ 0.0 };
 
    std::list<TransportListenerInfo> mListeners;
-   std::list<IAudioPoller*> mAudioPollers;
+   std::vector<ScheduledListener> mSchedule; //mListeners, ordered by priority
+   bool mScheduleDirty{ false };
+   bool mUpdatingListeners{ false };
+   ScheduleTimeline mScheduleTimeline;
+   double mScheduleMeasureTime{ 0 };
+   struct AudioPollerEntry
+   {
+      IAudioPoller* mPoller{ nullptr };
+      int mBufferDivider{ 1 };
+      int mCountdown{ 1 }; //audio thread only, from here down. carried over from the previous list by the audio thread, see CarryOverAudioPollerCounters()
+      double mAmountSinceCall{ 0 };
+   };
+   using AudioPollerList = std::vector<AudioPollerEntry>;
+   struct DeferredAudioPollerChange
+   {
+      IAudioPoller* mPoller{ nullptr };
+      int mBufferDivider{ 1 };
+      bool mAdd{ true };
+   };
+   void PublishAudioPollers();
+   void FreeRetiredAudioPollers();
+   static void CarryOverAudioPollerCounters(const AudioPollerList& from, AudioPollerList& to);
+   bool DeferAudioPollerChange(IAudioPoller* poller, int bufferDivider, bool add);
+   void DoAddAudioPoller(IAudioPoller* poller, int bufferDivider);
+   void DoRemoveAudioPoller(IAudioPoller* poller);
+   void ApplyDeferredAudioPollerChanges();
+   AudioPollerList mAudioPollers; //the main thread's copy, Advance() goes through the published one
+   std::atomic<AudioPollerList*> mPublishedAudioPollers{ nullptr }; //swapped out whole when a poller is added or removed, the same way as AudioEngine's execution plan
+   std::atomic<AudioPollerList*> mAudioPollersInUse{ nullptr }; //left on the last list the audio thread used, so that its counters are still there when the next one is published
+   std::atomic<AudioPollerList*> mPreviousAudioPollersInUse{ nullptr }; //held while the counters are carried over from it
+   moodycamel::ReaderWriterQueue<DeferredAudioPollerChange> mDeferredAudioPollerChanges{ 256 };
+   std::atomic_flag mDeferringAudioPollerChange = ATOMIC_FLAG_INIT; //the audio thread and the graph workers can both get there
+   std::vector<AudioPollerList*> mRetiredAudioPollers;
+   std::mutex mRetiredAudioPollersMutex;
+   struct Staging
+   {
+      int mToken{ 0 };
+      std::list<TransportListenerInfo> mListeners;
+      AudioPollerList mAudioPollers;
+   };
+   std::list<Staging> mStagings; //in the order they began
+   int mNextStagingToken{ 1 };
+   ITransportClockSource* mClockSource{ nullptr };
 
    TapTempoDetector mTapTempoDetector;
 };
@@ -71,10 +71,19 @@ void TremoloEffect::ProcessAudio(double time, ChannelBuffer* buffer)
    if (!mEnabled)
       return;
 
-   float bufferSize = buffer->BufferSize();
+   int bufferSize = buffer->BufferSize();
+   BeginSampleKernel(time, bufferSize);
+   if (mAmount > 0)
+      buffer->MultLinked(mGains.data(), bufferSize);
+}
 
+SampleKernel* TremoloEffect::BeginSampleKernel(double time, int bufferSize)
+{
    ComputeSliders(0);
 
+   //one gain a sample, shared by every channel
+   if ((int)mGains.size() < bufferSize)
+      mGains.resize(bufferSize);
    if (mAmount > 0)
    {
       for (int i = 0; i < bufferSize; ++i)
@@ -87,10 +96,15 @@ void TremoloEffect::ProcessAudio(double time, ChannelBuffer* buffer)
             lfoVal += mWindow[j];
          lfoVal /= kAntiPopWindowSize;
 
-         for (int ch = 0; ch < buffer->NumActiveChannels(); ++ch)
-            buffer->GetChannel(ch)[i] *= (1 - (mAmount * (1 - lfoVal)));
+         mGains[i] = 1 - (mAmount * (1 - lfoVal));
       }
    }
+   else
+   {
+      std::fill(mGains.begin(), mGains.begin() + bufferSize, 1.0f);
+   }
+   mKernel.SetGains(mGains.data());
+   return &mKernel;
 }
 
 void TremoloEffect::DrawModule()
@@ -30,6 +30,9 @@
 #include "Checkbox.h"
 #include "LFO.h"
 #include "DropdownList.h"
+#include "SampleKernel.h"
+
+#include <vector>
 
 class TremoloEffect : public IAudioEffect, public IDropdownListener, public IFloatSliderListener
 {
@@ -45,6 +48,8 @@ public:
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    float GetEffectAmount() override;
    std::string GetType() override { return "tremolo"; }
+   int GetTailLengthSamples() override { return 0; }
+   SampleKernel* BeginSampleKernel(double time, int bufferSize) override;
 
    //IDropdownListener
    void DropdownUpdated(DropdownList* list, int oldVal, double time) override;
@@ -74,4 +79,6 @@ private:
    static const int kAntiPopWindowSize = 300;
    float mWindow[kAntiPopWindowSize]{};
    int mWindowPos{ 0 };
+   std::vector<float> mGains;
+   GainKernel mKernel;
 };
@@ -0,0 +1,114 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    UIControlIndex.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "UIControlIndex.h"
+#include "ModularSynth.h"
+#include "ModuleContainer.h"
+#include "IDrawableModule.h"
+#include "IUIControl.h"
+
+std::atomic<int> UIControlIndex::sLayoutGeneration{ 0 };
+
+int UIControlIndex::GetGeneration()
+{
+   return ModuleContainer::GetModuleListGeneration() + sLayoutGeneration; //both only ever go up
+}
+
+UIControlIndex& UIControlIndex::Get()
+{
+   static UIControlIndex* sIndex = new UIControlIndex(); //never destroyed, controls can be deleted during static destruction
+   return *sIndex;
+}
+
+IUIControl* UIControlIndex::Find(const std::string& path)
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mPathsModuleListGeneration != ModuleContainer::GetModuleListGeneration() || mPathsLayoutGeneration != sLayoutGeneration)
+      {
+         mPaths.clear();
+         mPathsModuleListGeneration = ModuleContainer::GetModuleListGeneration();
+         mPathsLayoutGeneration = sLayoutGeneration;
+      }
+
+      auto it = mPaths.find(path);
+      if (it != mPaths.end())
+         return it->second;
+   }
+
+   //the walk can create controls (see IDrawableModule::OnUIControlRequested), which changes the layout
+   int moduleListGeneration = ModuleContainer::GetModuleListGeneration();
+   int layoutGeneration = sLayoutGeneration;
+   IUIControl* control = TheSynth->GetRootContainer()->FindUIControl(path);
+   if (control == nullptr)
+      return nullptr;
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   if (moduleListGeneration == mPathsModuleListGeneration && layoutGeneration == mPathsLayoutGeneration)
+      mPaths[path] = control;
+   return control;
+}
+
+UIControlIndex::Handle UIControlIndex::GetHandle(IUIControl* control)
+{
+   if (control == nullptr)
+      return kInvalidHandle;
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   auto it = mControlHandles.find(control);
+   if (it != mControlHandles.end())
+      return it->second;
+
+   Handle handle = mNextHandle++;
+   mControlHandles[control] = handle;
+   mHandles[handle] = control;
+   return handle;
+}
+
+IUIControl* UIControlIndex::Resolve(Handle handle)
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   auto it = mHandles.find(handle);
+   if (it == mHandles.end())
+      return nullptr;
+   //deleted modules stay allocated for a while (see ModularSynth::OnModuleDeleted), their controls shouldn't resolve any more
+   IDrawableModule* module = it->second->GetModuleParent();
+   if (module != nullptr && module->IsDeleted())
+      return nullptr;
+   return it->second;
+}
+
+void UIControlIndex::OnControlDeleted(IUIControl* control)
+{
+   NoteLayoutChanged();
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   auto it = mControlHandles.find(control);
+   if (it == mControlHandles.end())
+      return;
+   mHandles.erase(it->second);
+   mControlHandles.erase(it);
+}
@@ -0,0 +1,73 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    UIControlIndex.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class IUIControl;
+
+//remembers what control paths like "synth~volume" resolved to, until modules or controls are added, removed or renamed,
+//so snapshots, scripts, osc and save loading that look the same paths up over and over get a hash lookup instead of a walk
+//through every module. see ModularSynth::FindUIControl().
+//it also hands out handles, ids that stay valid for as long as a control exists and resolve to nullptr once it's gone,
+//for anything that wants to keep a reference to a control without it dangling when the control's module is deleted
+class UIControlIndex
+{
+public:
+   using Handle = int;
+   static constexpr Handle kInvalidHandle = 0;
+
+   static UIControlIndex& Get();
+
+   //path is a full path, with any load context already applied. failed lookups aren't remembered
+   IUIControl* Find(const std::string& path);
+
+   Handle GetHandle(IUIControl* control);
+   IUIControl* Resolve(Handle handle);
+
+   void OnControlDeleted(IUIControl* control);
+   //a module or control was added, removed or renamed, module list changes are picked up from ModuleContainer
+   static void NoteLayoutChanged() { ++sLayoutGeneration; }
+   //changes whenever paths might resolve differently, for anything that compiles its own list of controls
+   static int GetGeneration();
+
+private:
+   UIControlIndex() = default;
+
+   std::unordered_map<std::string, IUIControl*> mPaths;
+   int mPathsModuleListGeneration{ -1 };
+   int mPathsLayoutGeneration{ -1 };
+   std::unordered_map<Handle, IUIControl*> mHandles;
+   std::unordered_map<IUIControl*, Handle> mControlHandles;
+   Handle mNextHandle{ kInvalidHandle + 1 };
+   std::mutex mMutex;
+
+   static std::atomic<int> sLayoutGeneration;
+};
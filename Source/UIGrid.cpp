@@ -29,8 +29,11 @@
 #include "IDrawableModule.h"
 #include "PatchCableSource.h"
 #include "Snapshots.h"
+#include "nanovg/nanovg.h"
 
 #include <cstring>
+#include <map>
+#include <tuple>
 
 UIGrid::UIGrid(IClickable* parent, std::string name, int x, int y, int w, int h, int cols, int rows)
 : mWidth(w)
@@ -66,10 +69,112 @@ void UIGrid::Render()
    ofTranslate(mX, mY);
    ofPushStyle();
    ofSetLineWidth(.5f);
-   float w, h;
-   GetDimensions(w, h);
    float xsize = float(mWidth) / mCols;
    float ysize = float(mHeight) / mRows;
+   //outlines for cells only a couple of pixels across just blur together, draw one around the whole grid instead
+   const float kMinOutlinedCellPixels = 3;
+   bool drawCellOutlines = MIN(xsize, ysize) * GetOnScreenScale() >= kMinOutlinedCellPixels;
+
+   //the cells are drawn a colour at a time rather than a cell at a time, and only worked out again when something they show changes
+   uint64_t signature = CalculateRenderSignature(drawCellOutlines);
+   if (!mHasRenderBatches || signature != mRenderSignature)
+   {
+      RebuildRenderBatches(drawCellOutlines);
+      mRenderSignature = signature;
+      mHasRenderBatches = true;
+   }
+   for (const auto& batch : mRenderBatches)
+      DrawRectBatch(batch);
+
+   if (mCurrentHover != -1 && mCurrentHover < mCols * mRows && gHoveredUIControl == nullptr)
+   {
+      ofFill();
+      ofSetColor(180, 180, 0, 160);
+      ofRect(GetX(mCurrentHover % mCols, mCurrentHover / mCols) + 2, GetY(mCurrentHover / mCols) + 2, std::min(xsize * mCurrentHoverAmount, xsize - 4), ysize - 4);
+   }
+
+   int highlightCol = GetHighlightCol(gTime);
+   if (highlightCol != -1)
+   {
+      mHighlightBatch.mColor = ofColor(0, 255, 0, gModuleDrawAlpha);
+      mHighlightBatch.mFill = false;
+      mHighlightBatch.mRects.clear();
+      for (int j = 0; j < mRows; ++j)
+         mHighlightBatch.mRects.push_back(ofRectangle(GetX(highlightCol, j), GetY(j), xsize, ysize));
+      DrawRectBatch(mHighlightBatch);
+   }
+   if (mCurrentHover != -1 && mShouldDrawValue)
+   {
+      ofSetColor(ofColor::grey, gModuleDrawAlpha);
+      DrawTextNormal(ofToString(GetVal(mCurrentHover % mCols, mCurrentHover / mCols)), 0, 12);
+   }
+   ofPopStyle();
+
+   ofPopMatrix();
+}
+
+uint64_t UIGrid::CalculateRenderSignature(bool drawCellOutlines) const
+{
+   uint64_t hash = 14695981039346656037ull;
+   auto mix = [&hash](uint64_t value)
+   {
+      hash ^= value;
+      hash *= 1099511628211ull;
+   };
+   auto mixFloat = [&mix](float value)
+   {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      mix(bits);
+   };
+
+   mix(mRows);
+   mix(mCols);
+   mixFloat(mWidth);
+   mixFloat(mHeight);
+   mix(mGridMode);
+   mix(mFlip);
+   mix(drawCellOutlines);
+   mix(mMajorCol);
+   mixFloat(gModuleDrawAlpha);
+   mix(mClick && mHoldVal != 0 && CanAdjustMultislider() ? mHoldRow : -1); //the drag level line
+   for (int j = 0; j < mRows; ++j)
+   {
+      mixFloat(mDrawOffset[j]);
+      for (int i = 0; i < mCols; ++i)
+         mixFloat(mData[GetDataIndex(i, j)]);
+   }
+   return hash;
+}
+
+void UIGrid::RebuildRenderBatches(bool drawCellOutlines)
+{
+   for (auto& batch : mRenderBatches)
+      batch.mRects.clear();
+   std::map<std::tuple<int, int, int, int, float, bool>, size_t> batchIndices;
+   int numUsedBatches = 0;
+   //batches are drawn in the order they're first used, so a line that goes on top of its cell comes after the cell's colour
+   auto addRect = [&](const ofColor& color, float cornerRadius, bool fill, ofRectangle rect)
+   {
+      auto key = std::make_tuple(color.r, color.g, color.b, color.a, cornerRadius, fill);
+      auto found = batchIndices.find(key);
+      if (found == batchIndices.end())
+      {
+         if (numUsedBatches == (int)mRenderBatches.size())
+            mRenderBatches.emplace_back();
+         RectBatch& batch = mRenderBatches[numUsedBatches];
+         batch.mColor = color;
+         batch.mCornerRadius = cornerRadius;
+         batch.mFill = fill;
+         found = batchIndices.emplace(key, numUsedBatches).first;
+         ++numUsedBatches;
+      }
+      mRenderBatches[found->second].mRects.push_back(rect);
+   };
+
+   float xsize = float(mWidth) / mCols;
+   float ysize = float(mHeight) / mRows;
+   int dragLevelRow = (mClick && mHoldVal != 0 && CanAdjustMultislider()) ? mHoldRow : -1;
    for (int j = 0; j < mRows; ++j)
    {
       for (int i = 0; i < mCols; ++i)
@@ -81,120 +186,92 @@ void UIGrid::Render()
          float data = mData[GetDataIndex(i, j)];
          if (data)
          {
-            ofFill();
             float sliderFillAmount = ofClamp(ofLerp(.15f, 1, data), 0, 1);
+            float fadeAmount = ofClamp(ofLerp(.5f, 1, data), 0, 1);
+            ofColor fadeColor(int(255 * fadeAmount), int(255 * fadeAmount), int(255 * fadeAmount), int(gModuleDrawAlpha));
             if (mGridMode == kNormal)
             {
-               ofSetColor(255 * data, 255 * data, 255 * data, gModuleDrawAlpha);
-               ofRect(x, y, xsize, ysize);
+               addRect(ofColor(int(255 * data), int(255 * data), int(255 * data), int(gModuleDrawAlpha)), 3, true, ofRectangle(x, y, xsize, ysize));
             }
             else if (mGridMode == kMultislider)
             {
-               float fadeAmount = ofClamp(ofLerp(.5f, 1, data), 0, 1);
-               ofSetColor(255 * fadeAmount, 255 * fadeAmount, 255 * fadeAmount, gModuleDrawAlpha);
-               ofRect(x + .5f, y + .5f + (ysize * (1 - sliderFillAmount)), xsize - 1, ysize * sliderFillAmount - 1, 0);
-               /*ofSetColor(255, 255, 255, gModuleDrawAlpha);
-               ofNoFill();
-               ofRect(x+1,y+1,xsize-2,ysize-2, gCornerRoundness*.99f);*/
+               addRect(fadeColor, 0, true, ofRectangle(x + .5f, y + .5f + (ysize * (1 - sliderFillAmount)), xsize - 1, ysize * sliderFillAmount - 1));
             }
             else if (mGridMode == kHorislider)
             {
-               ofSetColor(255, 255, 255, gModuleDrawAlpha);
-               ofRect(x, y, xsize * sliderFillAmount, ysize);
+               addRect(ofColor(255, 255, 255, int(gModuleDrawAlpha)), 3, true, ofRectangle(x, y, xsize * sliderFillAmount, ysize));
             }
             else if (mGridMode == kMultisliderBipolar)
             {
-               float fadeAmount = ofClamp(ofLerp(.5f, 1, data), 0, 1);
-               ofSetColor(255 * fadeAmount, 255 * fadeAmount, 255 * fadeAmount, gModuleDrawAlpha);
-               ofRect(x, y + ysize * (.5f - sliderFillAmount / 2), xsize, ysize * sliderFillAmount);
+               addRect(fadeColor, 3, true, ofRectangle(x, y + ysize * (.5f - sliderFillAmount / 2), xsize, ysize * sliderFillAmount));
                drawDragLevels = true;
             }
             else if (mGridMode == kMultisliderGrow)
             {
-               float fadeAmount = ofClamp(ofLerp(.5f, 1, data), 0, 1);
-               ofSetColor(255 * fadeAmount, 255 * fadeAmount, 255 * fadeAmount, gModuleDrawAlpha);
+               float grow = sliderFillAmount * sliderFillAmount;
                ofVec2f center(x + xsize * 0.5f, y + ysize * 0.5f);
-               ofRect(center.x - (sliderFillAmount * sliderFillAmount * xsize * 0.5f), center.y - (sliderFillAmount * sliderFillAmount * ysize * 0.5f), sliderFillAmount * sliderFillAmount * xsize, sliderFillAmount * sliderFillAmount * ysize);
+               addRect(fadeColor, 3, true, ofRectangle(center.x - (grow * xsize * 0.5f), center.y - (grow * ysize * 0.5f), grow * xsize, grow * ysize));
                drawDragLevels = true;
             }
 
-            if (drawDragLevels)
-            {
-               if (mClick && mHoldVal != 0 && CanAdjustMultislider())
-               {
-                  if (j == mHoldRow)
-                  {
-                     ofSetColor(0, 255, 0, gModuleDrawAlpha);
-                     ofRect(x + .5f, y + .5f + (ysize * (1 - sliderFillAmount)), xsize - 1, 2, 0);
-                  }
-               }
-            }
-         }
-
-         if (mCurrentHover == i + j * mCols && gHoveredUIControl == nullptr)
-         {
-            ofFill();
-            ofSetColor(180, 180, 0, 160);
-            ofRect(x + 2, y + 2, std::min(xsize * mCurrentHoverAmount, xsize - 4), ysize - 4);
+            if (drawDragLevels && j == dragLevelRow)
+               addRect(ofColor(0, 255, 0, int(gModuleDrawAlpha)), 0, true, ofRectangle(x + .5f, y + .5f + (ysize * (1 - sliderFillAmount)), xsize - 1, 2));
          }
       }
    }
-   ofNoFill();
-   ofSetColor(100, 100, 100, gModuleDrawAlpha);
-   for (int j = 0; j < mRows; ++j)
+
+   ofColor outlineColor(100, 100, 100, int(gModuleDrawAlpha));
+   if (!drawCellOutlines)
    {
-      for (int i = 0; i < mCols; ++i)
-         ofRect(GetX(i, j), GetY(j), xsize, ysize);
+      addRect(outlineColor, 3, false, ofRectangle(0, 0, mWidth, mHeight));
    }
-   ofNoFill();
-   if (mMajorCol > 0)
+   else
    {
-      ofSetColor(255, 200, 100, gModuleDrawAlpha);
       for (int j = 0; j < mRows; ++j)
       {
-         for (int i = 0; i < mCols; i += mMajorCol)
-         {
-            ofRect(GetX(i, j), GetY(j), xsize, ysize);
-         }
+         for (int i = 0; i < mCols; ++i)
+            addRect(outlineColor, 3, false, ofRectangle(GetX(i, j), GetY(j), xsize, ysize));
       }
-      if (mCols > mMajorCol * mMajorCol)
+   }
+   if (mMajorCol > 0 && drawCellOutlines)
+   {
+      //each level of major column gets its own colour, drawn over the one before
+      const ofColor kMajorColors[] = { ofColor(255, 200, 100), ofColor(255, 255, 100), ofColor(255, 255, 200) };
+      int step = mMajorCol;
+      for (int level = 0; level < 3 && (level == 0 || mCols > step); ++level)
       {
-         ofSetColor(255, 255, 100, gModuleDrawAlpha);
+         ofColor color = kMajorColors[level];
+         color.a = int(gModuleDrawAlpha);
          for (int j = 0; j < mRows; ++j)
          {
-            for (int i = 0; i < mCols; i += mMajorCol * mMajorCol)
-            {
-               ofRect(GetX(i, j), GetY(j), xsize, ysize);
-            }
-         }
-         if (mCols > mMajorCol * mMajorCol * mMajorCol)
-         {
-            ofSetColor(255, 255, 200, gModuleDrawAlpha);
-            for (int j = 0; j < mRows; ++j)
-            {
-               for (int i = 0; i < mCols; i += mMajorCol * mMajorCol * mMajorCol)
-               {
-                  ofRect(GetX(i, j), GetY(j), xsize, ysize);
-               }
-            }
+            for (int i = 0; i < mCols; i += step)
+               addRect(color, 3, false, ofRectangle(GetX(i, j), GetY(j), xsize, ysize));
          }
+         step *= mMajorCol;
       }
    }
-   if (GetHighlightCol(gTime) != -1)
-   {
-      ofNoFill();
-      ofSetColor(0, 255, 0, gModuleDrawAlpha);
-      for (int j = 0; j < mRows; ++j)
-         ofRect(GetX(GetHighlightCol(gTime), j), GetY(j), xsize, ysize);
-   }
-   if (mCurrentHover != -1 && mShouldDrawValue)
-   {
-      ofSetColor(ofColor::grey, gModuleDrawAlpha);
-      DrawTextNormal(ofToString(GetVal(mCurrentHover % mCols, mCurrentHover / mCols)), 0, 12);
-   }
-   ofPopStyle();
 
-   ofPopMatrix();
+   mRenderBatches.resize(numUsedBatches);
+}
+
+//static
+void UIGrid::DrawRectBatch(const RectBatch& batch)
+{
+   if (batch.mRects.empty())
+      return;
+
+   if (batch.mFill)
+      ofFill();
+   else
+      ofNoFill();
+   ofSetColor(batch.mColor);
+   nvgBeginPath(gNanoVG);
+   for (const auto& rect : batch.mRects)
+      nvgRoundedRect(gNanoVG, rect.x, rect.y, rect.width, rect.height, batch.mCornerRadius * gCornerRoundness);
+   if (batch.mFill)
+      nvgFill(gNanoVG);
+   else
+      nvgStroke(gNanoVG);
 }
 
 float UIGrid::GetX(int col, int row) const
@@ -272,6 +349,7 @@ void UIGrid::OnClicked(float x, float y, bool right)
 
    mClick = true;
    mLastClickWasClear = false;
+   ++mChangeCount;
 
    float clickHeight, clickWidth;
    GridCell cell = GetGridCellAt(x, y, &clickHeight, &clickWidth);
@@ -366,6 +444,7 @@ void UIGrid::MouseReleased()
    {
       float oldValue = mData[GetDataIndex(mHoldCol, mHoldRow)];
       mData[GetDataIndex(mHoldCol, mHoldRow)] = 0;
+      ++mChangeCount;
       mListener->GridUpdated(this, mHoldCol, mHoldRow, 0, oldValue);
    }
 
@@ -417,6 +496,7 @@ bool UIGrid::MouseMoved(float x, float y)
    {
       int dataIndex = GetDataIndex(cell.mCol, cell.mRow);
       float oldValue = mData[dataIndex];
+      ++mChangeCount;
 
       if ((mGridMode == kMultislider || mGridMode == kMultisliderBipolar || mGridMode == kMultisliderGrow) && mHoldVal != 0 && CanAdjustMultislider())
       {
@@ -479,6 +559,7 @@ bool UIGrid::MouseScrolled(float x, float y, float scrollX, float scrollY, bool
          {
             float oldValue = data;
             data = ofClamp(data + scrollY / 100, FLT_EPSILON, 1);
+            ++mChangeCount;
             if (mListener)
                mListener->GridUpdated(this, cell.mCol, cell.mRow, data, oldValue);
          }
@@ -492,6 +573,8 @@ void UIGrid::SetGrid(int cols, int rows)
 {
    cols = ofClamp(cols, 0, MAX_GRID_COLS);
    rows = ofClamp(rows, 0, MAX_GRID_ROWS);
+   if (rows != mRows || cols != mCols)
+      ++mChangeCount;
    mRows = rows;
    mCols = cols;
 }
@@ -499,6 +582,7 @@ void UIGrid::SetGrid(int cols, int rows)
 void UIGrid::Clear()
 {
    mData.fill(0);
+   ++mChangeCount;
 }
 
 float UIGrid::GetVal(int col, int row) const
@@ -523,6 +607,7 @@ void UIGrid::SetVal(int col, int row, float val, bool notifyListener)
    {
       float oldValue = mData[GetDataIndex(col, row)];
       mData[GetDataIndex(col, row)] = val;
+      ++mChangeCount;
 
       if (mSingleColumn && val > 0)
       {
@@ -621,6 +706,8 @@ void UIGrid::LoadState(FileStreamIn& in, bool shouldSetValue)
    in >> rev;
    LoadStateValidate(rev <= kSaveStateRev);
 
+   ++mChangeCount;
+
    int cols;
    int rows;
 
@@ -88,7 +88,14 @@ public:
    void SetShouldDrawValue(bool draw) { mShouldDrawValue = draw; }
    void SetMomentary(bool momentary) { mMomentary = momentary; }
    const std::array<float, MAX_GRID_COLS * MAX_GRID_ROWS>& GetData() const { return mData; }
-   void SetData(std::array<float, MAX_GRID_COLS * MAX_GRID_ROWS>& data) { mData = data; }
+   void SetData(std::array<float, MAX_GRID_COLS * MAX_GRID_ROWS>& data)
+   {
+      mData = data;
+      ++mChangeCount;
+   }
+   //goes up whenever the size or contents might have changed, so owners can cache things they derive from the grid.
+   //writes made through the non-const GetVal() aren't counted
+   unsigned int GetChangeCount() const { return mChangeCount; }
    void SetClickValueSubdivisions(int subdivisions) { mClickSubdivisions = subdivisions; }
    float GetSubdividedValue(float position) const;
    bool GetNoHover() const override { return true; }
@@ -137,6 +144,18 @@ private:
    float GetY(int row) const;
    bool CanAdjustMultislider() const;
 
+   //rects that share a colour and style, drawn as one path
+   struct RectBatch
+   {
+      ofColor mColor;
+      float mCornerRadius{ 3 };
+      bool mFill{ true };
+      std::vector<ofRectangle> mRects;
+   };
+   uint64_t CalculateRenderSignature(bool drawCellOutlines) const;
+   void RebuildRenderBatches(bool drawCellOutlines);
+   static void DrawRectBatch(const RectBatch& batch);
+
    struct HighlightColBuffer
    {
       double time{ 0 };
@@ -172,4 +191,9 @@ private:
    bool mCanBeUIControlTarget{ false };
    int mValueSetTargetCol{ 0 };
    int mValueSetTargetRow{ 0 };
+   unsigned int mChangeCount{ 0 };
+   std::vector<RectBatch> mRenderBatches; //cell fills and outlines, in drawing order
+   uint64_t mRenderSignature{ 0 };
+   bool mHasRenderBatches{ false };
+   RectBatch mHighlightBatch;
 };
@@ -0,0 +1,413 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    UndoHistory.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "UndoHistory.h"
+#include "FileStream.h"
+#include "IUIControl.h"
+#include "ModularSynth.h"
+#include "ModuleContainer.h"
+#include "PatchCable.h"
+#include "PatchCableSource.h"
+#include "SynthGlobals.h"
+#include "UserPrefs.h"
+#include "ofxJSONElement.h"
+
+#include <set>
+
+namespace
+{
+   const double kSettleMs = 300; //so that a drag or a run of key presses becomes one step
+   const int kMaxSteps = 100;
+
+   std::map<std::string, IDrawableModule*> GetLiveModules()
+   {
+      std::map<std::string, IDrawableModule*> modules;
+      for (auto* module : TheSynth->GetRootContainer()->GetModules())
+      {
+         if (module->IsSaveable() && !module->IsDeleted())
+            modules[module->Name()] = module;
+      }
+      return modules;
+   }
+
+   //if a layout names this module as a target, either on its own or as the start of a control's path
+   bool References(const std::string& layout, const std::string& name)
+   {
+      for (size_t pos = layout.find(name); pos != std::string::npos; pos = layout.find(name, pos + 1))
+      {
+         char before = pos > 0 ? layout[pos - 1] : 0;
+         char after = pos + name.size() < layout.size() ? layout[pos + name.size()] : 0;
+         if ((before == '"' || before == ',') && (after == '"' || after == ',' || after == '~'))
+            return true;
+      }
+      return false;
+   }
+}
+
+UndoHistory& UndoHistory::Get()
+{
+   static UndoHistory sHistory;
+   return sHistory;
+}
+
+size_t UndoHistory::GetBudget() const
+{
+   return (size_t)UserPrefs.undo_history_budget_mb.Get() * 1024 * 1024;
+}
+
+void UndoHistory::Reset()
+{
+   mSteps.clear();
+   mCurrent = -1;
+   mBytes = 0;
+   mChangesSeenTime = -1;
+}
+
+bool UndoHistory::HasChanges() const
+{
+   if (mCurrent < 0)
+      return true;
+
+   const Step& current = mSteps[mCurrent];
+   size_t numModules = 0;
+   for (auto* module : TheSynth->GetRootContainer()->GetModules())
+   {
+      if (!module->IsSaveable() || module->IsDeleted())
+         continue;
+      ++numModules;
+      if (module->IsUndoDirty() || current.mModules.count(module->Name()) == 0)
+         return true;
+   }
+   return numModules != current.mModules.size();
+}
+
+void UndoHistory::Poll(bool canRecord)
+{
+   if (GetBudget() == 0)
+   {
+      if (!mSteps.empty())
+         Reset();
+      return;
+   }
+
+   if (!HasChanges())
+   {
+      mChangesSeenTime = -1;
+      return;
+   }
+
+   double now = juce::Time::getMillisecondCounterHiRes();
+   if (mChangesSeenTime < 0)
+      mChangesSeenTime = now;
+
+   if (canRecord && now - mChangesSeenTime > kSettleMs)
+      Record();
+}
+
+UndoHistory::SnapshotPtr UndoHistory::TakeSnapshot(IDrawableModule* module, size_t maxStateSize) const
+{
+   auto snapshot = std::make_shared<ModuleSnapshot>();
+   snapshot->mType = module->GetTypeName();
+
+   ofxJSONElement layout;
+   UpdateTarget(module);
+   module->SaveLayoutBase(layout);
+   snapshot->mX = layout["position"][0u].asFloat();
+   snapshot->mY = layout["position"][1u].asFloat();
+   layout.removeMember("position"); //so that comparing layouts tells whether there's more to it than a move
+   snapshot->mLayout = layout.getRawString(false);
+
+   {
+      FileStreamOut out(snapshot->mState);
+      module->SaveState(out);
+   }
+   if (snapshot->mState.getSize() > maxStateSize)
+   {
+      //something like a long recording. coming back with its layout but not its contents beats failing the whole step
+      snapshot->mState.reset();
+      snapshot->mHasState = false;
+   }
+
+   return snapshot;
+}
+
+void UndoHistory::Record()
+{
+   mChangesSeenTime = -1;
+
+   const Step* previous = mCurrent >= 0 ? &mSteps[mCurrent] : nullptr;
+   Step step;
+   bool changed = previous == nullptr;
+   size_t addedBytes = 0;
+   for (const auto& [name, module] : GetLiveModules())
+   {
+      bool dirty = module->TakeUndoDirty();
+      SnapshotPtr previousSnapshot;
+      if (previous != nullptr)
+      {
+         auto it = previous->mModules.find(name);
+         if (it != previous->mModules.end() && it->second->mType == module->GetTypeName())
+            previousSnapshot = it->second;
+      }
+
+      if (previousSnapshot != nullptr && !dirty)
+      {
+         step.mModules[name] = previousSnapshot;
+         continue;
+      }
+
+      SnapshotPtr snapshot = TakeSnapshot(module, GetBudget() / 8);
+      if (previousSnapshot != nullptr && *snapshot == *previousSnapshot)
+      {
+         step.mModules[name] = previousSnapshot; //clicked, but nothing came of it
+         continue;
+      }
+
+      step.mModules[name] = snapshot;
+      addedBytes += snapshot->GetSize();
+      changed = true;
+   }
+
+   if (previous != nullptr && step.mModules.size() != previous->mModules.size())
+      changed = true;
+
+   if (!changed)
+      return;
+
+   //a new edit after an undo replaces what could have been redone
+   while ((int)mSteps.size() > mCurrent + 1)
+   {
+      ReleaseStep(mSteps.back());
+      mSteps.pop_back();
+   }
+
+   mSteps.push_back(std::move(step));
+   mCurrent = (int)mSteps.size() - 1;
+   mBytes += addedBytes;
+   Trim();
+}
+
+void UndoHistory::ReleaseStep(Step& step)
+{
+   //only what no other step shares is actually freed
+   for (auto& [name, snapshot] : step.mModules)
+   {
+      if (snapshot.use_count() == 1)
+         mBytes -= MIN(mBytes, snapshot->GetSize());
+   }
+   step.mModules.clear();
+}
+
+void UndoHistory::Trim()
+{
+   while (mCurrent > 0 && (mBytes > GetBudget() || (int)mSteps.size() > kMaxSteps))
+   {
+      ReleaseStep(mSteps.front());
+      mSteps.pop_front();
+      --mCurrent;
+   }
+}
+
+bool UndoHistory::Undo()
+{
+   if (HasChanges())
+      Record(); //so that undo goes back to before the last edit, even if it hasn't settled yet
+
+   if (!CanUndo())
+      return false;
+
+   Apply(mSteps[mCurrent], mSteps[mCurrent - 1]);
+   --mCurrent;
+   return true;
+}
+
+bool UndoHistory::Redo()
+{
+   if (HasChanges())
+      Record(); //which drops the redo steps, the same as any other edit would
+
+   if (!CanRedo())
+      return false;
+
+   Apply(mSteps[mCurrent], mSteps[mCurrent + 1]);
+   ++mCurrent;
+   return true;
+}
+
+bool UndoHistory::NeedsRecreate(const ModuleSnapshot& from, const ModuleSnapshot& to)
+{
+   //the layout is only read when a module is set up, so anything in it besides the position takes a new module
+   return from.mType != to.mType || from.mLayout != to.mLayout;
+}
+
+void UndoHistory::Apply(const Step& from, const Step& to)
+{
+   ScopedMutex mutex(TheSynth->GetAudioMutex(), "UndoHistory::Apply()");
+   TheSynth->SetHoldExecutionPlan(true);
+
+   std::map<std::string, IDrawableModule*> live = GetLiveModules();
+
+   std::set<std::string> recreate;
+   for (const auto& [name, module] : live)
+   {
+      auto toIt = to.mModules.find(name);
+      auto fromIt = from.mModules.find(name);
+      if (toIt == to.mModules.end() || fromIt == from.mModules.end() || NeedsRecreate(*fromIt->second, *toIt->second))
+      {
+         if (module->CanBeDeleted())
+            recreate.insert(name);
+      }
+   }
+
+   //a module that's kept connects to the new ones by name, but its cables to the old ones go when they're deleted
+   for (bool added = true; added;)
+   {
+      added = false;
+      for (const auto& [name, snapshot] : to.mModules)
+      {
+         auto it = live.find(name);
+         if (recreate.count(name) > 0 || it == live.end() || !it->second->CanBeDeleted())
+            continue;
+         for (const auto& recreated : recreate)
+         {
+            if (References(snapshot->mLayout, recreated))
+            {
+               recreate.insert(name);
+               added = true;
+               break;
+            }
+         }
+      }
+   }
+
+   for (const auto& name : recreate)
+   {
+      IDrawableModule* module = live[name];
+      module->GetOwningContainer()->DeleteModule(module);
+      live.erase(name);
+   }
+
+   //the rest load their old state in place
+   for (const auto& [name, module] : live)
+   {
+      auto toIt = to.mModules.find(name);
+      auto fromIt = from.mModules.find(name);
+      if (toIt == to.mModules.end() || (fromIt != from.mModules.end() && fromIt->second == toIt->second))
+         continue;
+
+      const ModuleSnapshot& snapshot = *toIt->second;
+      module->SetPosition(snapshot.mX, snapshot.mY);
+      if (snapshot.mHasState && (fromIt == from.mModules.end() || !(fromIt->second->mState == snapshot.mState)))
+         TheSynth->LoadModuleState(module, snapshot.mState);
+   }
+
+   //and the new ones come up the same way a layout loads: all created, then all set up, so they can find each other
+   std::vector<std::pair<IDrawableModule*, const ModuleSnapshot*>> created;
+   std::vector<ofxJSONElement> layouts;
+   for (const auto& [name, snapshot] : to.mModules)
+   {
+      if (live.count(name) > 0)
+         continue;
+
+      ofxJSONElement layout;
+      if (!layout.parse(snapshot->mLayout))
+         continue;
+      layout["position"][0u] = snapshot->mX;
+      layout["position"][1u] = snapshot->mY;
+
+      IDrawableModule* module = TheSynth->CreateModule(layout);
+      if (module == nullptr)
+         continue;
+      TheSynth->GetRootContainer()->AddModule(module);
+      created.push_back({ module, snapshot.get() });
+      layouts.push_back(layout);
+   }
+
+   for (size_t i = 0; i < created.size(); ++i)
+   {
+      try
+      {
+         TheSynth->SetUpModule(created[i].first, layouts[i]);
+      }
+      catch (LoadingJSONException& e)
+      {
+         TheSynth->LogEvent("Couldn't restore \"" + std::string(created[i].first->Name()) + "\" for undo", kLogEventType_Error);
+      }
+   }
+
+   for (auto& [module, snapshot] : created)
+      module->Init();
+
+   for (auto& [module, snapshot] : created)
+   {
+      if (snapshot->mHasState)
+         TheSynth->LoadModuleState(module, snapshot->mState);
+   }
+
+   RetargetCables();
+
+   TheSynth->SetHoldExecutionPlan(false);
+
+   //none of that is an edit of its own
+   for (auto* module : TheSynth->GetRootContainer()->GetModules())
+      module->TakeUndoDirty();
+   mChangesSeenTime = -1;
+}
+
+void UndoHistory::RetargetCables()
+{
+   //cables that aren't part of a layout, like the extra sources a module makes itself, still point at what was deleted
+   for (auto* module : TheSynth->GetRootContainer()->GetModules())
+   {
+      if (module->IsDeleted())
+         continue;
+      for (auto* source : module->GetPatchCableSources())
+      {
+         std::vector<PatchCable*> cables = source->GetPatchCables();
+         for (auto* cable : cables)
+         {
+            IClickable* target = cable->GetTarget();
+            if (target == nullptr)
+               continue;
+
+            IDrawableModule* targetModule = dynamic_cast<IDrawableModule*>(target);
+            IUIControl* targetControl = dynamic_cast<IUIControl*>(target);
+            if (targetModule == nullptr && targetControl != nullptr)
+               targetModule = targetControl->GetModuleParent();
+            if (targetModule == nullptr || !targetModule->IsDeleted())
+               continue;
+
+            IClickable* newTarget = nullptr;
+            if (targetControl != nullptr)
+               newTarget = TheSynth->FindUIControl(target->Path(true));
+            else
+               newTarget = TheSynth->FindModule(target->Path(true));
+            if (newTarget != nullptr)
+               source->SetPatchCableTarget(cable, newTarget, false);
+         }
+      }
+   }
+}
@@ -0,0 +1,90 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    UndoHistory.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce_core/juce_core.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+
+class IDrawableModule;
+
+//undo and redo for edits to the patch. each step has a snapshot of every module at the root of the layout (its layout
+//json and its saved state), but a module that hasn't changed since the step before shares that step's snapshot, so a
+//step only costs the modules that were edited. the oldest steps are dropped to stay under undo_history_budget_mb.
+//undoing only applies the difference between two steps to the live patch: modules that came or went are deleted or
+//recreated, a module whose state changed loads the old state in place, and the audio thread gets one new plan at the end
+class UndoHistory
+{
+public:
+   static UndoHistory& Get();
+
+   void Poll(bool canRecord); //main thread. records a step once the edits have settled, and canRecord is true
+   void Reset(); //for when a different layout gets loaded
+   bool Undo();
+   bool Redo();
+   bool CanUndo() const { return mCurrent > 0; }
+   bool CanRedo() const { return mCurrent + 1 < (int)mSteps.size(); }
+   size_t GetMemoryUsage() const { return mBytes; }
+
+private:
+   struct ModuleSnapshot
+   {
+      std::string mType;
+      std::string mLayout; //without the position, which is kept apart
+      float mX{ 0 };
+      float mY{ 0 };
+      juce::MemoryBlock mState;
+      bool mHasState{ true }; //false if it was too big to keep, then only the layout comes back
+      size_t GetSize() const { return mType.size() + mLayout.size() + mState.getSize(); }
+      bool operator==(const ModuleSnapshot& other) const { return mLayout == other.mLayout && mX == other.mX && mY == other.mY && mHasState == other.mHasState && mState == other.mState; }
+   };
+   using SnapshotPtr = std::shared_ptr<const ModuleSnapshot>;
+
+   struct Step
+   {
+      std::map<std::string, SnapshotPtr> mModules; //by name
+   };
+
+   UndoHistory() = default;
+   bool HasChanges() const;
+   void Record();
+   SnapshotPtr TakeSnapshot(IDrawableModule* module, size_t maxStateSize) const;
+   void Apply(const Step& from, const Step& to);
+   static bool NeedsRecreate(const ModuleSnapshot& from, const ModuleSnapshot& to);
+   static void RetargetCables();
+   void ReleaseStep(Step& step);
+   void Trim();
+   size_t GetBudget() const;
+
+   std::deque<Step> mSteps;
+   int mCurrent{ -1 }; //the step that matches the patch as it is
+   size_t mBytes{ 0 }; //of the snapshots, each counted once however many steps share it
+   double mChangesSeenTime{ -1 };
+};
@@ -296,6 +296,7 @@ public:
    UserPrefDropdownInt samplerate{ "samplerate", 48000, 100, UserPrefCategory::General };
    UserPrefDropdownInt buffersize{ "buffersize", 256, 100, UserPrefCategory::General };
    UserPrefDropdownInt oversampling{ "oversampling", 1, 100, UserPrefCategory::General };
+   UserPrefTextEntryInt internal_block_size{ "internal_block_size", 0, 0, 4096, 5, UserPrefCategory::General }; //in samples at the internal rate, modules process the device buffer this many at a time. 0 for the whole buffer
    UserPrefTextEntryInt width{ "width", 1700, 100, 10000, 5, UserPrefCategory::General };
    UserPrefTextEntryInt height{ "height", 1100, 100, 10000, 5, UserPrefCategory::General };
    UserPrefBool set_manual_window_position{ "set_manual_window_position", false, UserPrefCategory::General };
@@ -310,17 +311,42 @@ public:
    UserPrefFloat scroll_multiplier_horizontal{ "scroll_multiplier_horizontal", 1, -2, 2, UserPrefCategory::General };
    UserPrefBool wrap_mouse_on_pan{ "wrap_mouse_on_pan", true, UserPrefCategory::General };
    UserPrefBool autosave{ "autosave", false, UserPrefCategory::General };
+   UserPrefBool autosave_journal{ "autosave_journal", true, UserPrefCategory::General };
+   UserPrefBool compress_savestates{ "compress_savestates", true, UserPrefCategory::General };
    UserPrefBool show_tooltips_on_load{ "show_tooltips_on_load", true, UserPrefCategory::General };
    UserPrefBool show_minimap{ "show_minimap", false, UserPrefCategory::General };
    UserPrefFloat minimap_margin{ "minimap_margin", 10, 0, 50, UserPrefCategory::General };
    UserPrefDropdownString minimap_corner{ "minimap_corner", "Top right", 150, UserPrefCategory::General };
    UserPrefBool immediate_paste{ "immediate_paste", false, UserPrefCategory::General };
    UserPrefTextEntryFloat record_buffer_length_minutes{ "record_buffer_length_minutes", 30, 1, 120, 5, UserPrefCategory::General };
+   UserPrefBool record_buffer_compressed{ "record_buffer_compressed", false, UserPrefCategory::General }; //keep the record buffer losslessly compressed in the background, to fit longer captures in the same memory
+   UserPrefTextEntryFloat stream_samples_longer_than_minutes{ "stream_samples_longer_than_minutes", 5, 0, 10000, 5, UserPrefCategory::General };
+   UserPrefTextEntryInt sample_attack_head_ms{ "sample_attack_head_ms", 200, 0, 10000, 5, UserPrefCategory::General };
+   UserPrefTextEntryInt sample_attack_head_budget_mb{ "sample_attack_head_budget_mb", 256, 0, 65536, 5, UserPrefCategory::General };
+   UserPrefTextEntryInt hibernate_disabled_modules_after_seconds{ "hibernate_disabled_modules_after_seconds", 60, 0, 86400, 5, UserPrefCategory::General };
+   UserPrefTextEntryInt undo_history_budget_mb{ "undo_history_budget_mb", 256, 0, 65536, 5, UserPrefCategory::General };
+   UserPrefTextEntryInt cpu_governor_budget_percent{ "cpu_governor_budget_percent", 80, 0, 100, 5, UserPrefCategory::General };
 #if !BESPOKE_LINUX
    UserPrefBool vst_always_on_top{ "vst_always_on_top", true, UserPrefCategory::General };
 #endif
    UserPrefTextEntryInt max_output_channels{ "max_output_channels", 16, 1, 1024, 5, UserPrefCategory::General };
    UserPrefTextEntryInt max_input_channels{ "max_input_channels", 16, 1, 1024, 5, UserPrefCategory::General };
+   UserPrefString output_routing{ "output_routing", "", 70, UserPrefCategory::General };
+   UserPrefBool record_all_outputs{ "record_all_outputs", false, UserPrefCategory::General };
+   UserPrefBool master_limiter{ "master_limiter", false, UserPrefCategory::General };
+   UserPrefTextEntryFloat master_limiter_ceiling_db{ "master_limiter_ceiling_db", -1, -24, 0, 5, UserPrefCategory::General };
+   UserPrefTextEntryFloat master_limiter_release_ms{ "master_limiter_release_ms", 80, 1, 2000, 5, UserPrefCategory::General };
+   UserPrefTextEntryInt audio_worker_threads{ "audio_worker_threads", 0, 0, 64, 2, UserPrefCategory::General };
+   UserPrefString audio_thread_cores{ "audio_thread_cores", "", 70, UserPrefCategory::General }; //like "2" or "2-3,6". see AudioThreadPolicy
+   UserPrefString audio_worker_cores{ "audio_worker_cores", "", 70, UserPrefCategory::General };
+   UserPrefBool realtime_audio_threads{ "realtime_audio_threads", true, UserPrefCategory::General };
+   UserPrefBool keep_other_threads_off_audio_cores{ "keep_other_threads_off_audio_cores", true, UserPrefCategory::General };
+   UserPrefBool auto_suspend_modules{ "auto_suspend_modules", false, UserPrefCategory::General };
+   UserPrefBool guard_audio_faults{ "guard_audio_faults", true, UserPrefCategory::General };
+   UserPrefBool timestamped_midi_input{ "timestamped_midi_input", true, UserPrefCategory::General };
+   UserPrefBool sandbox_plugins{ "sandbox_plugins", false, UserPrefCategory::General };
+   UserPrefBool rescan_plugins_on_startup{ "rescan_plugins_on_startup", true, UserPrefCategory::General };
+   UserPrefTextEntryFloat event_lookahead_ms{ "event_lookahead_ms", 150, 20, 1000, 5, UserPrefCategory::General };
    UserPrefString plugin_preference_order{ "plugin_preference_order", "VST3;VST;AudioUnit;LV2", 70, UserPrefCategory::General };
 
    UserPrefBool draw_background_lissajous{ "draw_background_lissajous", true, UserPrefCategory::Graphics };
@@ -335,8 +361,11 @@ public:
    UserPrefFloat background_g{ "background_g", 0.09f, 0, 1, UserPrefCategory::Graphics };
    UserPrefFloat background_b{ "background_b", 0.09f, 0, 1, UserPrefCategory::Graphics };
    UserPrefFloat target_framerate{ "target_framerate", 60, 30, 144, UserPrefCategory::Graphics };
+   UserPrefBool adaptive_framerate{ "adaptive_framerate", true, UserPrefCategory::Graphics };
    UserPrefFloat motion_trails{ "motion_trails", 1, 0, 2, UserPrefCategory::Graphics };
    UserPrefBool draw_module_highlights{ "draw_module_highlights", true, UserPrefCategory::Graphics };
+   UserPrefBool show_module_cpu_usage{ "show_module_cpu_usage", false, UserPrefCategory::Graphics };
+   UserPrefFloat simplify_modules_below_size{ "simplify_modules_below_size", 40, 0, 200, UserPrefCategory::Graphics };
    UserPrefTextEntryFloat mouse_offset_x{ "mouse_offset_x", 0, -100, 100, 5, UserPrefCategory::Graphics };
    UserPrefTextEntryFloat mouse_offset_y
    {
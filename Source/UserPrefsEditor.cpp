@@ -118,10 +118,10 @@ void UserPrefsEditor::Show()
 
 void UserPrefsEditor::CreatePrefsFileIfNonexistent()
 {
-   UpdateDropdowns({});
-
    if (!juce::File(TheSynth->GetUserPrefsPath()).existsAsFile())
    {
+      //scanning for audio devices is slow on some systems, so the dropdowns are otherwise only filled in on Show()
+      UpdateDropdowns({});
       Save();
       UserPrefs.mUserPrefsFile.open(TheSynth->GetUserPrefsPath());
    }
@@ -257,7 +257,7 @@ void UserPrefsEditor::UpdateDropdowns(std::vector<DropdownList*> toUpdate)
       for (auto& bufferSize : selectedDevice->getAvailableBufferSizes())
       {
          UserPrefs.buffersize.GetDropdown()->AddLabel(ofToString(bufferSize), i);
-         if (bufferSize == gBufferSize / UserPrefs.oversampling.Get())
+         if (bufferSize == gIOBufferSize / UserPrefs.oversampling.Get())
             UserPrefs.buffersize.GetIndex() = i;
          ++i;
       }
@@ -388,9 +388,19 @@ bool UserPrefsEditor::PrefRequiresRestart(UserPref* pref) const
           pref == &UserPrefs.samplerate ||
           pref == &UserPrefs.buffersize ||
           pref == &UserPrefs.oversampling ||
+          pref == &UserPrefs.internal_block_size ||
           pref == &UserPrefs.max_output_channels ||
           pref == &UserPrefs.max_input_channels ||
+          pref == &UserPrefs.output_routing ||
+          pref == &UserPrefs.record_all_outputs ||
+          pref == &UserPrefs.audio_worker_threads ||
+          pref == &UserPrefs.audio_thread_cores ||
+          pref == &UserPrefs.audio_worker_cores ||
+          pref == &UserPrefs.realtime_audio_threads ||
+          pref == &UserPrefs.keep_other_threads_off_audio_cores ||
+          pref == &UserPrefs.event_lookahead_ms ||
           pref == &UserPrefs.record_buffer_length_minutes ||
+          pref == &UserPrefs.record_buffer_compressed ||
           pref == &UserPrefs.show_minimap;
 }
 
@@ -431,6 +441,8 @@ void UserPrefsEditor::ButtonClicked(ClickButton* button, double time)
 
 void UserPrefsEditor::CheckboxUpdated(Checkbox* checkbox, double time)
 {
+   if (checkbox == UserPrefs.auto_suspend_modules.GetCheckbox())
+      TheSynth->RebuildExecutionPlan();
 }
 
 void UserPrefsEditor::FloatSliderUpdated(FloatSlider* slider, float oldVal, double time)
@@ -34,6 +34,9 @@
 #include "ModulationChain.h"
 #include "PatchCableSource.h"
 #include "UserPrefs.h"
+#include "NoteEventLane.h"
+#include "PluginSandbox.h"
+#include "SpawnIndex.h"
 //#include "NSWindowOverlay.h"
 
 namespace
@@ -92,19 +95,31 @@ namespace VSTLookup
       }
    };
 
-   void GetAvailableVSTs(std::vector<PluginDescription>& vsts)
+   void LoadKnownPluginList()
    {
-      vsts.clear();
-      static bool sFirstTime = true;
-      if (sFirstTime)
+      static bool sLoaded = false;
+      if (sLoaded)
+         return;
+      sLoaded = true;
+
+      auto file = juce::File(ofToDataPath("vst/found_vsts.xml"));
+      if (file.existsAsFile())
       {
-         auto file = juce::File(ofToDataPath("vst/found_vsts.xml"));
-         if (file.existsAsFile())
-         {
-            auto xml = juce::parseXML(file);
+         auto xml = juce::parseXML(file);
+         if (xml != nullptr)
             TheSynth->GetKnownPluginList().recreateFromXml(*xml);
-         }
       }
+   }
+
+   void SaveKnownPluginList()
+   {
+      TheSynth->GetKnownPluginList().createXml()->writeTo(juce::File(ofToDataPath("vst/found_vsts.xml")));
+   }
+
+   void GetAvailableVSTs(std::vector<PluginDescription>& vsts)
+   {
+      vsts.clear();
+      LoadKnownPluginList();
 
       auto types = TheSynth->GetKnownPluginList().getTypes();
       std::string formatPreferenceOrder = UserPrefs.plugin_preference_order.Get();
@@ -146,8 +161,6 @@ namespace VSTLookup
       /*auto vstCopy = vsts;
       for (int i = 0; i < 40; ++i)
          vsts.insert(vsts.end(), vstCopy.begin(), vstCopy.end());*/
-
-      sFirstTime = false;
    }
 
    void FillVSTList(DropdownList* list)
@@ -520,6 +533,11 @@ void VSTPlugin::SetVST(juce::PluginDescription pluginDesc)
       root["vsts"][strPluginId] = (double)time.currentTimeMillis();
 
       root.save(ofToDataPath("vst/recent_plugins.json"), true);
+
+      ModuleFactory::Spawnable spawnable;
+      spawnable.mSpawnMethod = ModuleFactory::SpawnMethod::Plugin;
+      spawnable.mPluginDesc = pluginDesc;
+      TheSynth->GetModuleFactory()->GetSpawnIndex()->NoteSpawned(spawnable);
    }
 
    if (mPlugin != nullptr && dynamic_cast<juce::AudioPluginInstance*>(mPlugin.get())->getPluginDescription().matchesIdentifierString(pluginId))
@@ -540,7 +558,10 @@ void VSTPlugin::LoadVST(juce::PluginDescription desc)
 
    mVSTMutex.lock();
    juce::String errorMessage;
-   mPlugin = TheSynth->GetAudioPluginFormatManager().createPluginInstance(desc, gSampleRate, gBufferSize, errorMessage);
+   if (UserPrefs.sandbox_plugins.Get())
+      mPlugin = PluginSandbox::CreateInstance(desc, gSampleRate, gBufferSize, errorMessage);
+   else
+      mPlugin = TheSynth->GetAudioPluginFormatManager().createPluginInstance(desc, gSampleRate, gBufferSize, errorMessage);
    if (mPlugin != nullptr)
    {
       mPlugin->enableAllBuses();
@@ -634,6 +655,15 @@ void VSTPlugin::CreateParameterSliders()
 
 void VSTPlugin::Poll()
 {
+   int latencySamples = (mEnabled && mPluginReady && mPlugin != nullptr) ? mPlugin->getLatencySamples() : 0;
+   bool midiOutConnected = !mMidiOutCable->GetPatchCableSource()->GetPatchCables().empty();
+   if (latencySamples != mLatencySamples || midiOutConnected != mMidiOutConnected)
+   {
+      mLatencySamples = latencySamples;
+      mMidiOutConnected = midiOutConnected;
+      TheSynth->RebuildExecutionPlan();
+   }
+
    if (mRescanParameterNames)
    {
       mRescanParameterNames = false;
@@ -674,7 +704,12 @@ void VSTPlugin::Poll()
    if (mWantOpenVstWindow)
    {
       mWantOpenVstWindow = false;
-      if (mPlugin != nullptr)
+      if (PluginSandbox::IsSandboxed(mPlugin.get()))
+      {
+         //the editor lives in the helper process, with its own window
+         PluginSandbox::ShowEditor(mPlugin.get());
+      }
+      else if (mPlugin != nullptr)
       {
          if (mWindow == nullptr)
             mWindow = std::unique_ptr<VSTWindow>(VSTWindow::CreateVSTWindow(this, VSTWindow::Normal));
@@ -1058,7 +1093,7 @@ void VSTPlugin::PlayNote(NoteMessage note)
 
    const juce::ScopedLock lock(mMidiInputLock);
 
-   int sampleNumber = (note.time - gTime) * gSampleRateMs;
+   int sampleNumber = NoteEventLane::GetSampleOffset(note.time, gTime); //late notes go at the start of the buffer, rather than at a negative offset
    //ofLog() << sampleNumber;
 
    if (note.velocity > 0)
@@ -1135,6 +1170,14 @@ void VSTPlugin::DrawModule()
    DrawTextNormal("extra outputs:", 3, 50);
    ofPopStyle();
 
+   if (PluginSandbox::HasCrashed(mPlugin.get()))
+   {
+      ofPushStyle();
+      ofSetColor(255, 0, 0);
+      DrawTextRightJustify("plugin process crashed", GetRect().width - 3, 50);
+      ofPopStyle();
+   }
+
    ofPushStyle();
    ofSetColor(IDrawableModule::GetColor(kModuleCategory_Synth), 75);
    DrawTextRightJustify(ofToString(mParameterSliders.size()), GetRect().width - 3, 67);
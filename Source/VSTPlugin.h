@@ -45,6 +45,8 @@ class ofxJSONElement;
 
 namespace VSTLookup
 {
+   void LoadKnownPluginList(); //from vst/found_vsts.xml, the first time it's called
+   void SaveKnownPluginList();
    void GetAvailableVSTs(std::vector<juce::PluginDescription>& vsts);
    void FillVSTList(DropdownList* list);
    std::string GetVSTPath(std::string vstName);
@@ -84,6 +86,8 @@ public:
    //IAudioSource
    void Process(double time) override;
    void SetEnabled(bool enabled) override;
+   int GetLatencySamples() const override { return mLatencySamples; }
+   bool RequiresSerialProcessing() const override { return mMidiOutConnected; } //notes played from a worker thread would race the other workers into the note output queue
 
    //INoteReceiver
    void PlayNote(NoteMessage note) override;
@@ -219,5 +223,9 @@ private:
     */
    AdditionalNoteCable* mMidiOutCable{ nullptr };
 
+   //what the execution plan was last built with. a change to either means it needs building again, see Poll()
+   int mLatencySamples{ 0 };
+   bool mMidiOutConnected{ false };
+
    bool mWantOpenVstWindow{ false };
 };
@@ -31,6 +31,139 @@
 
 extern juce::ApplicationProperties& getAppProperties();
 
+namespace
+{
+   juce::File GetScanCacheFile()
+   {
+      return juce::File(ofToDataPath("vst/plugin_scan_cache.xml"));
+   }
+}
+
+//static
+PluginScanCache& PluginScanCache::Get()
+{
+   static PluginScanCache sCache;
+   return sCache;
+}
+
+//static
+bool PluginScanCache::GetStamp(const juce::String& fileOrIdentifier, Stamp& stamp)
+{
+   if (!juce::File::isAbsolutePath(fileOrIdentifier))
+      return false; //an identifier rather than a file (AudioUnits), nothing to compare against
+
+   juce::File file(fileOrIdentifier);
+   if (file.existsAsFile())
+   {
+      stamp.mSize = file.getSize();
+      stamp.mModificationTime = file.getLastModificationTime().toMilliseconds();
+      return true;
+   }
+
+   if (file.isDirectory())
+   {
+      //a bundle. the binaries live a level down inside Contents/ (MacOS/, x86_64-linux/, x86_64-win/...),
+      //so look at those rather than walking any resources the bundle carries
+      stamp.mSize = 0;
+      stamp.mModificationTime = file.getLastModificationTime().toMilliseconds();
+      for (const auto& folder : juce::RangedDirectoryIterator(file.getChildFile("Contents"), false, "*", juce::File::findDirectories))
+      {
+         for (const auto& binary : juce::RangedDirectoryIterator(folder.getFile(), false, "*", juce::File::findFiles))
+         {
+            stamp.mSize += binary.getFileSize();
+            stamp.mModificationTime = MAX(stamp.mModificationTime, binary.getModificationTime().toMilliseconds());
+         }
+      }
+      return true;
+   }
+
+   return false;
+}
+
+void PluginScanCache::LoadIfNeeded()
+{
+   if (mLoaded)
+      return;
+   mLoaded = true;
+
+   auto xml = juce::parseXML(GetScanCacheFile());
+   if (xml == nullptr || !xml->hasTagName("PLUGINSCANCACHE"))
+      return;
+
+   for (const auto* fileXml : xml->getChildWithTagNameIterator("FILE"))
+   {
+      Entry entry;
+      entry.mStamp.mSize = fileXml->getStringAttribute("size").getLargeIntValue();
+      entry.mStamp.mModificationTime = fileXml->getStringAttribute("modified").getLargeIntValue();
+      for (const auto* typeXml : fileXml->getChildIterator())
+      {
+         juce::PluginDescription desc;
+         if (desc.loadFromXml(*typeXml))
+            entry.mTypes.add(desc);
+      }
+      mEntries[GetKey(fileXml->getStringAttribute("format"), fileXml->getStringAttribute("path"))] = entry;
+   }
+}
+
+bool PluginScanCache::Lookup(const juce::String& formatName, const juce::String& fileOrIdentifier, juce::OwnedArray<juce::PluginDescription>& result)
+{
+   Stamp stamp;
+   if (!GetStamp(fileOrIdentifier, stamp))
+      return false;
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   LoadIfNeeded();
+   auto it = mEntries.find(GetKey(formatName, fileOrIdentifier));
+   if (it == mEntries.end() || !(it->second.mStamp == stamp))
+      return false;
+
+   for (const auto& type : it->second.mTypes)
+      result.add(new juce::PluginDescription(type));
+   return true;
+}
+
+void PluginScanCache::Store(const juce::String& formatName, const juce::String& fileOrIdentifier, const juce::OwnedArray<juce::PluginDescription>& found)
+{
+   //an empty result is as likely to be a plugin that failed to load as a binary with nothing in it, so it gets probed again next time
+   Stamp stamp;
+   if (found.isEmpty() || !GetStamp(fileOrIdentifier, stamp))
+      return;
+
+   Entry entry;
+   entry.mStamp = stamp;
+   for (const auto* type : found)
+      entry.mTypes.add(*type);
+
+   std::lock_guard<std::mutex> lock(mMutex);
+   LoadIfNeeded();
+   mEntries[GetKey(formatName, fileOrIdentifier)] = entry;
+   mDirty = true;
+}
+
+void PluginScanCache::Save()
+{
+   std::lock_guard<std::mutex> lock(mMutex);
+   if (!mDirty)
+      return;
+   mDirty = false;
+
+   juce::XmlElement xml("PLUGINSCANCACHE");
+   for (const auto& pair : mEntries)
+   {
+      auto* fileXml = xml.createNewChildElement("FILE");
+      fileXml->setAttribute("format", pair.first.upToFirstOccurrenceOf("|", false, false));
+      fileXml->setAttribute("path", pair.first.fromFirstOccurrenceOf("|", false, false));
+      fileXml->setAttribute("size", juce::String(pair.second.mStamp.mSize));
+      fileXml->setAttribute("modified", juce::String(pair.second.mStamp.mModificationTime));
+      for (const auto& type : pair.second.mTypes)
+         fileXml->addChildElement(type.createXml().release());
+   }
+   GetScanCacheFile().getParentDirectory().createDirectory();
+   xml.writeTo(GetScanCacheFile());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
 CustomPluginScanner::CustomPluginScanner()
 {
    if (auto* file = getAppProperties().getUserSettings())
@@ -45,77 +178,68 @@ CustomPluginScanner::~CustomPluginScanner()
       file->removeChangeListener(this);
 }
 
+//static
+int CustomPluginScanner::GetNumParallelScans()
+{
+   //probing is mostly waiting on disk and on plugins initializing, so more processes than that would just contend
+   return juce::jlimit(1, 8, juce::SystemStats::getNumCpus() - 1);
+}
+
 bool CustomPluginScanner::findPluginTypesFor(juce::AudioPluginFormat& format,
                                              juce::OwnedArray<juce::PluginDescription>& result,
                                              const juce::String& fileOrIdentifier)
 {
+   if (PluginScanCache::Get().Lookup(format.getName(), fileOrIdentifier, result))
+      return true;
+
    if (!scanWithExternalProcess)
    {
-      superprocess = nullptr;
-      format.findAllTypesForFile(result, fileOrIdentifier);
+      {
+         const std::lock_guard<std::mutex> lock(inProcessMutex);
+         format.findAllTypesForFile(result, fileOrIdentifier);
+      }
+      PluginScanCache::Get().Store(format.getName(), fileOrIdentifier, result);
       return true;
    }
 
-   if (superprocess == nullptr)
+   std::unique_ptr<Superprocess> superprocess;
    {
-      superprocess = std::make_unique<Superprocess>(*this);
-
-      std::unique_lock<std::mutex> lock(mutex);
-      connectionLost = false;
-   }
-
-   juce::MemoryBlock block;
-   juce::MemoryOutputStream stream{ block, true };
-   stream.writeString(format.getName());
-   stream.writeString(fileOrIdentifier);
-
-   if (superprocess->sendMessageToWorker(block))
-   {
-      std::unique_lock<std::mutex> lock(mutex);
-      gotResponse = false;
-      pluginDescription = nullptr;
-
-      for (;;)
+      const std::lock_guard<std::mutex> lock(superprocessMutex);
+      if (!idleSuperprocesses.empty())
       {
-         if (condvar.wait_for(lock,
-                              std::chrono::milliseconds(50),
-                              [this]
-                              {
-                                 return gotResponse || shouldExit();
-                              }))
-         {
-            break;
-         }
+         superprocess = std::move(idleSuperprocesses.back());
+         idleSuperprocesses.pop_back();
       }
+   }
+   if (superprocess == nullptr)
+      superprocess = std::make_unique<Superprocess>();
 
-      if (shouldExit())
+   switch (superprocess->Scan(format.getName(), fileOrIdentifier, result, *this))
+   {
+      case Superprocess::Result::Found:
       {
-         superprocess = nullptr;
+         PluginScanCache::Get().Store(format.getName(), fileOrIdentifier, result);
+         const std::lock_guard<std::mutex> lock(superprocessMutex);
+         idleSuperprocesses.push_back(std::move(superprocess));
          return true;
       }
+      case Superprocess::Result::Cancelled:
+         return true;
+      case Superprocess::Result::ConnectionLost:
+         break;
+   }
 
-      if (connectionLost)
-      {
-         superprocess = nullptr;
-         return false;
-      }
-
-      if (pluginDescription != nullptr)
-      {
-         for (const auto* item : pluginDescription->getChildIterator())
-         {
-            auto desc = std::make_unique<juce::PluginDescription>();
-
-            if (desc->loadFromXml(*item))
-               result.add(std::move(desc));
-         }
-      }
+   return false;
+}
 
-      return true;
+void CustomPluginScanner::scanFinished()
+{
+   {
+      const std::lock_guard<std::mutex> lock(superprocessMutex);
+      idleSuperprocesses.clear();
    }
 
-   superprocess = nullptr;
-   return false;
+   PluginScanCache::Get().Save();
 }
 
 void CustomPluginScanner::changeListenerCallback(juce::ChangeBroadcaster*)
@@ -124,29 +248,83 @@ void CustomPluginScanner::changeListenerCallback(juce::ChangeBroadcaster*)
       scanWithExternalProcess = (file->getIntValue(kScanModeKey) == 0);
 }
 
-CustomPluginScanner::Superprocess::Superprocess(CustomPluginScanner& o)
-: owner(o)
+CustomPluginScanner::Superprocess::Superprocess()
 {
    launchWorkerProcess(juce::File::getSpecialLocation(juce::File::currentExecutableFile), kScanProcessUID, 0, 0);
 }
 
+CustomPluginScanner::Superprocess::Result CustomPluginScanner::Superprocess::Scan(const juce::String& formatName,
+                                                                                  const juce::String& fileOrIdentifier,
+                                                                                  juce::OwnedArray<juce::PluginDescription>& result,
+                                                                                  const CustomPluginScanner& owner)
+{
+   juce::MemoryBlock block;
+   juce::MemoryOutputStream stream{ block, true };
+   stream.writeString(formatName);
+   stream.writeString(fileOrIdentifier);
+
+   std::unique_lock<std::mutex> lock(mutex);
+   gotResponse = false;
+   pluginDescription = nullptr;
+
+   if (connectionLost)
+      return Result::ConnectionLost;
+
+   lock.unlock();
+   if (!sendMessageToWorker(block))
+      return Result::ConnectionLost;
+   lock.lock();
+
+   for (;;)
+   {
+      if (condvar.wait_for(lock,
+                           std::chrono::milliseconds(50),
+                           [&]
+                           {
+                              return gotResponse || owner.shouldExit();
+                           }))
+      {
+         break;
+      }
+   }
+
+   if (owner.shouldExit())
+      return Result::Cancelled;
+
+   if (connectionLost)
+      return Result::ConnectionLost;
+
+   if (pluginDescription != nullptr)
+   {
+      for (const auto* item : pluginDescription->getChildIterator())
+      {
+         auto desc = std::make_unique<juce::PluginDescription>();
+
+         if (desc->loadFromXml(*item))
+            result.add(std::move(desc));
+      }
+   }
+
+   return Result::Found;
+}
+
 void CustomPluginScanner::Superprocess::handleMessageFromWorker(const juce::MemoryBlock& mb)
 {
    auto xml = parseXML(mb.toString());
 
-   const std::lock_guard<std::mutex> lock(owner.mutex);
-   owner.pluginDescription = std::move(xml);
-   owner.gotResponse = true;
-   owner.condvar.notify_one();
+   const std::lock_guard<std::mutex> lock(mutex);
+   pluginDescription = std::move(xml);
+   gotResponse = true;
+   condvar.notify_one();
 }
 
 void CustomPluginScanner::Superprocess::handleConnectionLost()
 {
-   const std::lock_guard<std::mutex> lock(owner.mutex);
-   owner.pluginDescription = nullptr;
-   owner.gotResponse = true;
-   owner.connectionLost = true;
-   owner.condvar.notify_one();
+   const std::lock_guard<std::mutex> lock(mutex);
+   pluginDescription = nullptr;
+   gotResponse = true;
+   connectionLost = true;
+   condvar.notify_one();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -177,6 +355,8 @@ CustomPluginListComponent::CustomPluginListComponent(juce::AudioPluginFormatMana
       getAppProperties().getUserSettings()->setValue(kScanModeKey, validationModeBox.getSelectedItemIndex());
    };
 
+   setNumberOfThreadsForScanning(CustomPluginScanner::GetNumParallelScans());
+
    OnResize();
 }
 
@@ -243,6 +423,146 @@ void PluginListWindow::closeButtonPressed()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
+BackgroundPluginScan::BackgroundPluginScan(juce::AudioPluginFormatManager& formatManager, juce::KnownPluginList& knownList)
+: juce::Thread("background plugin scan")
+, mKnownList(knownList)
+{
+   //a plugin crashing while it's probed in process would take the synth down with it, so that's left to the plugin manager
+   if (!mScanner.IsScanningWithExternalProcess())
+      return;
+
+   //the list needs to be there to compare against, or everything would look new
+   VSTLookup::LoadKnownPluginList();
+
+   mBlacklist = mKnownList.getBlacklistedFiles();
+   for (auto* format : formatManager.getFormats())
+   {
+      if (!format->canScanForPlugins())
+         continue;
+      FormatToScan toScan;
+      toScan.mFormat = format;
+      toScan.mSearchPath = juce::PluginListComponent::getLastSearchPath(*getAppProperties().getUserSettings(), *format);
+      mFormats.push_back(toScan);
+   }
+
+   startThread(1); //low priority, it has all the time it needs
+}
+
+BackgroundPluginScan::~BackgroundPluginScan()
+{
+   cancelPendingUpdate();
+   stopThread(10000);
+}
+
+void BackgroundPluginScan::run()
+{
+   juce::ThreadPool pool(CustomPluginScanner::GetNumParallelScans());
+
+   int numToProbe = 0;
+   for (auto& toScan : mFormats)
+   {
+      auto* format = toScan.mFormat;
+      toScan.mFoundFiles = format->searchPathsForPlugins(toScan.mSearchPath, true, true);
+      for (const auto& file : toScan.mFoundFiles)
+      {
+         if (threadShouldExit())
+            break;
+
+         if (mBlacklist.contains(file))
+            continue;
+
+         if (mKnownList.isListingUpToDate(file, *format))
+         {
+            //already known from a scan before there was a cache, so take the list's word for it rather than probing again
+            juce::OwnedArray<juce::PluginDescription> cached;
+            if (!PluginScanCache::Get().Lookup(format->getName(), file, cached))
+            {
+               for (const auto& type : mKnownList.getTypes())
+               {
+                  if (type.fileOrIdentifier == file && type.pluginFormatName == format->getName())
+                     cached.add(new juce::PluginDescription(type));
+               }
+               PluginScanCache::Get().Store(format->getName(), file, cached);
+            }
+            continue;
+         }
+
+         ++numToProbe;
+         pool.addJob([this, format, file]
+                     {
+                        ProbeResult result;
+                        result.mFormat = format;
+                        result.mFileOrIdentifier = file;
+                        juce::OwnedArray<juce::PluginDescription> found;
+                        result.mFailed = !mScanner.findPluginTypesFor(*format, found, file);
+                        for (const auto* type : found)
+                           result.mTypes.add(*type);
+
+                        const std::lock_guard<std::mutex> lock(mResultsMutex);
+                        mResults.push_back(result);
+                     });
+      }
+   }
+
+   while (pool.getNumJobs() > 0)
+   {
+      if (threadShouldExit())
+      {
+         pool.removeAllJobs(true, 5000);
+         return;
+      }
+      wait(50);
+   }
+
+   if (numToProbe > 0)
+      ofLog() << "background plugin scan probed " << numToProbe << " new or changed plugin binaries";
+
+   mScanner.scanFinished();
+   triggerAsyncUpdate();
+}
+
+void BackgroundPluginScan::handleAsyncUpdate()
+{
+   bool changed = false;
+
+   //binaries that aren't there any more
+   for (const auto& toScan : mFormats)
+   {
+      for (const auto& type : mKnownList.getTypes())
+      {
+         if (type.pluginFormatName == toScan.mFormat->getName() && !toScan.mFoundFiles.contains(type.fileOrIdentifier) &&
+             !toScan.mFormat->doesPluginStillExist(type))
+         {
+            mKnownList.removeType(type);
+            changed = true;
+         }
+      }
+   }
+
+   const std::lock_guard<std::mutex> lock(mResultsMutex);
+   for (const auto& result : mResults)
+   {
+      for (const auto& type : mKnownList.getTypes())
+      {
+         if (type.fileOrIdentifier == result.mFileOrIdentifier && type.pluginFormatName == result.mFormat->getName())
+            mKnownList.removeType(type);
+      }
+
+      //like KnownPluginList::scanAndAddFile(), a binary that failed to probe is blacklisted until the user clears it
+      if (result.mFailed)
+         mKnownList.addToBlacklist(result.mFileOrIdentifier);
+      for (const auto& type : result.mTypes)
+         mKnownList.addType(type);
+      changed = true;
+   }
+   mResults.clear();
+
+   if (changed)
+      VSTLookup::SaveKnownPluginList();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
 PluginScannerSubprocess::PluginScannerSubprocess()
 {
    formatManager.addDefaultFormats();
@@ -29,9 +29,47 @@
 
 #include "juce_audio_processors/juce_audio_processors.h"
 
+#include <map>
+
 constexpr const char* kScanProcessUID = "bespokesynth";
 constexpr const char* kScanModeKey = "pluginScanMode";
 
+//remembers what each plugin binary held when it was last probed, keyed by its path, size and modification time,
+//so that rescans only have to probe the binaries that are new or have changed. saved in vst/plugin_scan_cache.xml
+class PluginScanCache
+{
+public:
+   static PluginScanCache& Get();
+
+   //thread safe. Lookup() is false if the binary hasn't been seen in its current state
+   bool Lookup(const juce::String& formatName, const juce::String& fileOrIdentifier, juce::OwnedArray<juce::PluginDescription>& result);
+   void Store(const juce::String& formatName, const juce::String& fileOrIdentifier, const juce::OwnedArray<juce::PluginDescription>& found);
+   void Save();
+
+private:
+   struct Stamp
+   {
+      juce::int64 mSize{ 0 };
+      juce::int64 mModificationTime{ 0 };
+      bool operator==(const Stamp& other) const { return mSize == other.mSize && mModificationTime == other.mModificationTime; }
+   };
+
+   struct Entry
+   {
+      Stamp mStamp;
+      juce::Array<juce::PluginDescription> mTypes;
+   };
+
+   static bool GetStamp(const juce::String& fileOrIdentifier, Stamp& stamp);
+   static juce::String GetKey(const juce::String& formatName, const juce::String& fileOrIdentifier) { return formatName + "|" + fileOrIdentifier; }
+   void LoadIfNeeded();
+
+   std::mutex mMutex;
+   std::map<juce::String, Entry> mEntries;
+   bool mLoaded{ false };
+   bool mDirty{ false };
+};
+
 class CustomPluginScanner : public juce::KnownPluginList::CustomScanner,
                             private juce::ChangeListener
 {
@@ -42,31 +80,45 @@ public:
    bool findPluginTypesFor(juce::AudioPluginFormat& format,
                            juce::OwnedArray<juce::PluginDescription>& result,
                            const juce::String& fileOrIdentifier) override;
-   void scanFinished() override { superprocess = nullptr; }
+   void scanFinished() override;
+
+   bool IsScanningWithExternalProcess() const { return scanWithExternalProcess; }
+   static int GetNumParallelScans();
 
 private:
+   //one helper process per scanning thread, so that several binaries can be probed at once
    class Superprocess : public juce::ChildProcessCoordinator
    {
    public:
-      explicit Superprocess(CustomPluginScanner& o);
+      enum class Result
+      {
+         Found,
+         ConnectionLost,
+         Cancelled
+      };
+
+      Superprocess();
+
+      Result Scan(const juce::String& formatName, const juce::String& fileOrIdentifier, juce::OwnedArray<juce::PluginDescription>& result, const CustomPluginScanner& owner);
 
    private:
       void handleMessageFromWorker(const juce::MemoryBlock& mb) override;
       void handleConnectionLost() override;
 
-      CustomPluginScanner& owner;
+      std::mutex mutex;
+      std::condition_variable condvar;
+      std::unique_ptr<juce::XmlElement> pluginDescription;
+      bool gotResponse = false;
+      bool connectionLost = false;
 
       JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Superprocess)
    };
 
    void changeListenerCallback(juce::ChangeBroadcaster*) override;
 
-   std::unique_ptr<Superprocess> superprocess;
-   std::mutex mutex;
-   std::condition_variable condvar;
-   std::unique_ptr<juce::XmlElement> pluginDescription;
-   bool gotResponse = false;
-   bool connectionLost = false;
+   std::mutex superprocessMutex;
+   std::vector<std::unique_ptr<Superprocess>> idleSuperprocesses;
+   std::mutex inProcessMutex; //plugins can't be trusted to load on several threads at once
 
    std::atomic<bool> scanWithExternalProcess{ true };
 
@@ -108,6 +160,45 @@ private:
    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginListWindow)
 };
 
+//brings the known plugin list up to date in the background at startup. only the binaries that the scan cache hasn't
+//seen in their current state get probed, several at a time, and the list is only touched on the message thread once it's done
+class BackgroundPluginScan : private juce::Thread,
+                             private juce::AsyncUpdater
+{
+public:
+   BackgroundPluginScan(juce::AudioPluginFormatManager& formatManager, juce::KnownPluginList& knownList);
+   ~BackgroundPluginScan() override;
+
+private:
+   struct FormatToScan
+   {
+      juce::AudioPluginFormat* mFormat{ nullptr };
+      juce::FileSearchPath mSearchPath;
+      juce::StringArray mFoundFiles;
+   };
+
+   void run() override;
+   void handleAsyncUpdate() override;
+
+   juce::KnownPluginList& mKnownList;
+   juce::StringArray mBlacklist;
+   std::vector<FormatToScan> mFormats;
+   CustomPluginScanner mScanner;
+
+   struct ProbeResult
+   {
+      juce::AudioPluginFormat* mFormat{ nullptr };
+      juce::String mFileOrIdentifier;
+      juce::Array<juce::PluginDescription> mTypes;
+      bool mFailed{ false };
+   };
+
+   std::mutex mResultsMutex;
+   std::vector<ProbeResult> mResults;
+
+   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BackgroundPluginScan)
+};
+
 class PluginScannerSubprocess : private juce::ChildProcessWorker,
                                 private juce::AsyncUpdater
 {
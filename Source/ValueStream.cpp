@@ -67,13 +67,15 @@ void ValueStream::OnTransportAdvanced(float amount)
 {
    if (mUIControl && mEnabled)
    {
-      for (int i = 0; i < gBufferSize; ++i)
+      int i = mNextValueOffset;
+      for (; i < gBufferSize; i += kSamplesPerValue)
       {
          if (mFloatSlider)
             mFloatSlider->Compute(i);
          mValues[mValueDisplayPointer] = mUIControl->GetValue();
          mValueDisplayPointer = (mValueDisplayPointer + 1) % mValues.size();
       }
+      mNextValueOffset = i - gBufferSize;
    }
 }
 
@@ -90,10 +92,10 @@ void ValueStream::DrawModule()
       for (int i = 0; i < mWidth; ++i)
       {
          float x = mWidth - i;
-         int samplesAgo = int(i / (mSpeed / 200)) + 1;
-         if (samplesAgo < mValues.size())
+         int valuesAgo = int(i / (mSpeed / 200)) / kSamplesPerValue + 1;
+         if (valuesAgo < mValues.size())
          {
-            float y = ofMap(mValues[(mValueDisplayPointer - samplesAgo + mValues.size()) % mValues.size()], mFloatSlider->GetMin(), mFloatSlider->GetMax(), mHeight - 10, 10);
+            float y = ofMap(mValues[(mValueDisplayPointer - valuesAgo + mValues.size()) % mValues.size()], mFloatSlider->GetMin(), mFloatSlider->GetMax(), mHeight - 10, 10);
             ofVertex(x, y);
          }
       }
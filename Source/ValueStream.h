@@ -71,6 +71,7 @@ public:
    void PostRepatch(PatchCableSource* cableSource, bool fromUserClick) override;
 
    bool IsEnabled() const override { return mEnabled; }
+   size_t GetMemoryUsage() const override { return sizeof(mValues); }
 
 private:
    //IDrawableModule
@@ -81,6 +82,8 @@ private:
    PatchCableSource* mControlCable{ nullptr };
    float mSpeed{ 1 };
    FloatSlider* mSpeedSlider{ nullptr };
-   std::array<float, 100000> mValues{};
+   static constexpr int kSamplesPerValue = 8; //the display never shows more than one value per 40 samples, so only keep every 8th
+   std::array<float, 100000 / kSamplesPerValue> mValues{};
    int mValueDisplayPointer{ 0 };
+   int mNextValueOffset{ 0 }; //where in the next buffer to take the next value
 };
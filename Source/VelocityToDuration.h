@@ -27,6 +27,7 @@
 
 #include "IDrawableModule.h"
 #include "NoteEffectBase.h"
+#include "NoteEventLane.h"
 #include "Slider.h"
 #include "Transport.h"
 
@@ -64,5 +65,5 @@ private:
 
    float mMaxDuration{ .25 };
    FloatSlider* mMaxDurationSlider{ nullptr };
-   std::list<NoteMessage> mNoteOffs;
+   NoteEventLane mNoteOffs{ 128 }; //at most one per pitch
 };
@@ -0,0 +1,57 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    VisualizationTap.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "VisualizationTap.h"
+
+void VisualizationTap::Frame::AddPoint(ofVec2f point, float minDistance)
+{
+   if (mNumPoints == kMaxPoints)
+      return;
+   if (mNumPoints > 0 && fabsf(point.x - mPoints[mNumPoints - 1].x) < minDistance && fabsf(point.y - mPoints[mNumPoints - 1].y) < minDistance)
+      return;
+   mPoints[mNumPoints] = point;
+   ++mNumPoints;
+}
+
+VisualizationTap::Frame* VisualizationTap::BeginFrame()
+{
+   if (mMiddleIndex.load(std::memory_order_acquire) & kFreshBit)
+      return nullptr;
+   mFrames[mWriteIndex].Clear();
+   return &mFrames[mWriteIndex];
+}
+
+void VisualizationTap::PublishFrame()
+{
+   mWriteIndex = mMiddleIndex.exchange(mWriteIndex | kFreshBit, std::memory_order_acq_rel) & ~kFreshBit;
+}
+
+const VisualizationTap::Frame& VisualizationTap::GetLatestFrame()
+{
+   if (mMiddleIndex.load(std::memory_order_acquire) & kFreshBit)
+      mReadIndex = mMiddleIndex.exchange(mReadIndex, std::memory_order_acq_rel) & ~kFreshBit;
+   return mFrames[mReadIndex];
+}
@@ -0,0 +1,69 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    VisualizationTap.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include "OpenFrameworksPort.h"
+
+//hands display-ready points from the audio thread to the ui thread, without either side waiting on the other or reading the other's buffers.
+//the audio thread only builds a new frame once the ui has picked up the last one, so thinning the data out to display resolution
+//happens at most once per drawn frame, and the ui only ever draws a small, already-decimated set of vertices.
+class VisualizationTap
+{
+public:
+   static constexpr int kMaxPoints = 4096;
+
+   struct Frame
+   {
+      //skips points that land within minDistance of the last one on both axes, so dense traces don't turn into more vertices than there are pixels
+      void AddPoint(ofVec2f point, float minDistance = 0);
+      void Clear() { mNumPoints = 0; }
+
+      ofVec2f mPoints[kMaxPoints];
+      int mNumPoints{ 0 };
+   };
+
+   //audio thread. returns nullptr if the ui hasn't drawn the last frame yet, in which case there's no point making another one
+   Frame* BeginFrame();
+   void PublishFrame();
+
+   //ui thread. the most recently published frame, or the previous one again if nothing new has arrived
+   const Frame& GetLatestFrame();
+
+   //ui thread tells the audio thread how many pixels across the data is drawn
+   void SetResolution(int resolution) { mResolution = MAX(resolution, 1); }
+   int GetResolution() const { return mResolution; }
+
+private:
+   static constexpr int kFreshBit = 4;
+
+   Frame mFrames[3];
+   int mWriteIndex{ 0 };
+   int mReadIndex{ 1 };
+   std::atomic<int> mMiddleIndex{ 2 };
+   std::atomic<int> mResolution{ 256 };
+};
@@ -30,10 +30,7 @@
 Vocoder::Vocoder()
 : IAudioProcessor(gBufferSize)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[VOCODER_WINDOW_SIZE];
-   for (int i = 0; i < VOCODER_WINDOW_SIZE; ++i)
-      mWindower[i] = -.5 * cos(FTWO_PI * i / VOCODER_WINDOW_SIZE) + .5;
+   mSTFT.SetSynthesisScale(.0001f); //the level this has always had
 
    mCarrierInputBuffer = new float[GetBuffer()->BufferSize()];
    Clear(mCarrierInputBuffer, GetBuffer()->BufferSize());
@@ -54,13 +51,13 @@ void Vocoder::CreateUIControls()
    mWhisperSlider = new FloatSlider(this, "whisper", 5, 119, 100, 15, &mWhisper, 0, 1);
    mPhaseOffsetSlider = new FloatSlider(this, "phase off", 5, 137, 100, 15, &mPhaseOffset, 0, FTWO_PI);
    mCutSlider = new IntSlider(this, "cut", 5, 155, 100, 15, &mCut, 0, 100);
+   mCarrierBusEntry = new TextEntry(this, "carrier bus", 5, 173, 9, &mCarrierBusName);
 
    mGate.CreateUIControls();
 }
 
 Vocoder::~Vocoder()
 {
-   delete[] mWindower;
    delete[] mCarrierInputBuffer;
 }
 
@@ -119,87 +116,70 @@ void Vocoder::Process(double time)
 
    mGate.ProcessAudio(time, GetBuffer());
 
-   mRollingInputBuffer.WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
-
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, VOCODER_WINDOW_SIZE, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, VOCODER_WINDOW_SIZE);
-   Mult(mFFTData.mTimeDomain, inputPreampSq, VOCODER_WINDOW_SIZE);
-
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
-
-   if (!fricative)
+   //a carrier bus channel is read in place, where its producer left it
+   const float* carrierInput = mCarrierInputBuffer;
+   if (mCarrierBusChannel != nullptr)
    {
-      mRollingCarrierBuffer.WriteChunk(mCarrierInputBuffer, bufferSize, 0);
+      ChannelBuffer* bus = SidechainBus::Read(mCarrierBusChannel, time).mBuffer;
+      carrierInput = (bus != nullptr && bus->BufferSize() >= bufferSize) ? bus->GetChannelReadOnly(0) : gZeroBuffer;
    }
-   else
+
+   float* wet = gWorkBuffer;
+   const float* carrier = carrierInput;
+   if (fricative)
    {
       //use noise as carrier signal if it's a fricative
       //but make the noise the same-ish volume as input carrier
+      float* noise = gWorkBuffer + bufferSize;
       for (int i = 0; i < bufferSize; ++i)
-         mRollingCarrierBuffer.Write(mCarrierInputBuffer[gRandom() % bufferSize] * 2, 0);
+         noise[i] = carrierInput[gRandom() % bufferSize] * 2;
+      carrier = noise;
    }
 
-   //copy rolling carrier buffer into working buffer and window it
-   mRollingCarrierBuffer.ReadChunk(mCarrierFFTData.mTimeDomain, VOCODER_WINDOW_SIZE, 0, 0);
-   Mult(mCarrierFFTData.mTimeDomain, mWindower, VOCODER_WINDOW_SIZE);
-   Mult(mCarrierFFTData.mTimeDomain, carrierPreampSq, VOCODER_WINDOW_SIZE);
-
-   mFFT.Forward(mCarrierFFTData.mTimeDomain,
-                mCarrierFFTData.mRealValues,
-                mCarrierFFTData.mImaginaryValues);
-
-   for (int i = 0; i < FFT_FREQDOMAIN_SIZE; ++i)
-   {
-      float real = mFFTData.mRealValues[i];
-      float imag = mFFTData.mImaginaryValues[i];
-
-      //cartesian to polar
-      float amp = 2. * sqrtf(real * real + imag * imag);
-      //float phase = atan2(imag,real);
+   const float* inputs[] = { GetBuffer()->GetChannel(0), carrier };
+   mSTFT.Process(inputs, wet, bufferSize, [this, inputPreampSq, carrierPreampSq](int)
+                 {
+                    FFTData& frame = mSTFT.GetFrame(0);
+                    FFTData& carrierFrame = mSTFT.GetFrame(1);
+                    for (int i = 0; i < FFT_FREQDOMAIN_SIZE; ++i)
+                    {
+                       float real = frame.mRealValues[i];
+                       float imag = frame.mImaginaryValues[i];
 
-      float carrierReal = mCarrierFFTData.mRealValues[i];
-      float carrierImag = mCarrierFFTData.mImaginaryValues[i];
+                       //cartesian to polar
+                       float amp = 2. * sqrtf(real * real + imag * imag) * inputPreampSq;
+                       //float phase = atan2(imag,real);
 
-      //cartesian to polar
-      float carrierAmp = 2. * sqrtf(carrierReal * carrierReal + carrierImag * carrierImag);
-      float carrierPhase = atan2(carrierImag, carrierReal);
+                       float carrierReal = carrierFrame.mRealValues[i];
+                       float carrierImag = carrierFrame.mImaginaryValues[i];
 
-      amp *= carrierAmp;
-      float phase = carrierPhase;
+                       //cartesian to polar
+                       float carrierAmp = 2. * sqrtf(carrierReal * carrierReal + carrierImag * carrierImag) * carrierPreampSq;
+                       float carrierPhase = atan2(carrierImag, carrierReal);
 
-      phase += ofRandom(mWhisper * FTWO_PI);
-      mPhaseOffsetSlider->Compute();
-      phase = FloatWrap(phase + mPhaseOffset, FTWO_PI);
+                       amp *= carrierAmp;
+                       float phase = carrierPhase;
 
-      if (i < mCut) //cut out superbass
-         amp = 0;
+                       phase += ofRandom(mWhisper * FTWO_PI);
+                       mPhaseOffsetSlider->Compute();
+                       phase = FloatWrap(phase + mPhaseOffset, FTWO_PI);
 
-      //polar to cartesian
-      real = amp * cos(phase);
-      imag = amp * sin(phase);
+                       if (i < mCut) //cut out superbass
+                          amp = 0;
 
-      mFFTData.mRealValues[i] = real;
-      mFFTData.mImaginaryValues[i] = imag;
-   }
-
-   mFFT.Inverse(mFFTData.mRealValues,
-                mFFTData.mImaginaryValues,
-                mFFTData.mTimeDomain);
+                       //polar to cartesian
+                       real = amp * cos(phase);
+                       imag = amp * sin(phase);
 
-   for (int i = 0; i < bufferSize; ++i)
-      mRollingOutputBuffer.Write(0, 0);
-
-   //copy rolling input buffer into working buffer and window it
-   for (int i = 0; i < VOCODER_WINDOW_SIZE; ++i)
-      mRollingOutputBuffer.Accum(VOCODER_WINDOW_SIZE - i - 1, mFFTData.mTimeDomain[i] * mWindower[i] * .0001f, 0);
+                       frame.mRealValues[i] = real;
+                       frame.mImaginaryValues[i] = imag;
+                    }
+                 });
 
    Mult(GetBuffer()->GetChannel(0), (1 - mDryWet) * inputPreampSq, GetBuffer()->BufferSize());
 
    for (int i = 0; i < bufferSize; ++i)
-      GetBuffer()->GetChannel(0)[i] += mRollingOutputBuffer.GetSample(VOCODER_WINDOW_SIZE - i - 1, 0) * volSq * mDryWet;
+      GetBuffer()->GetChannel(0)[i] += wet[i] * volSq * mDryWet;
 
    Add(target->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
 
@@ -213,7 +193,7 @@ void Vocoder::DrawModule()
    if (Minimized() || IsVisible() == false)
       return;
 
-   if (!mCarrierDataSet)
+   if (!mCarrierDataSet && mCarrierBusChannel == nullptr)
    {
       ofPushStyle();
       ofSetColor(255, 0, 0);
@@ -229,6 +209,7 @@ void Vocoder::DrawModule()
    mWhisperSlider->Draw();
    mPhaseOffsetSlider->Draw();
    mCutSlider->Draw();
+   mCarrierBusEntry->Draw();
 
    if (mFricDetected)
    {
@@ -251,6 +232,15 @@ void Vocoder::CheckboxUpdated(Checkbox* checkbox, double time)
    }
 }
 
+void Vocoder::TextEntryComplete(TextEntry* entry)
+{
+   if (entry == mCarrierBusEntry)
+   {
+      mCarrierBusChannel = SidechainBus::Get().Subscribe(this, mCarrierBusName);
+      TheSynth->ArrangeAudioSourceDependencies();
+   }
+}
+
 void Vocoder::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
@@ -27,16 +27,18 @@
 
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
-#include "FFT.h"
+#include "STFT.h"
 #include "Slider.h"
 #include "GateEffect.h"
 #include "BiquadFilterEffect.h"
 #include "VocoderCarrierInput.h"
+#include "TextEntry.h"
+#include "SidechainBus.h"
 
 #define VOCODER_WINDOW_SIZE 1024
 #define FFT_FREQDOMAIN_SIZE VOCODER_WINDOW_SIZE / 2 + 1
 
-class Vocoder : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public VocoderBase, public IIntSliderListener
+class Vocoder : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public VocoderBase, public IIntSliderListener, public ITextEntryListener
 {
 public:
    Vocoder();
@@ -61,6 +63,7 @@ public:
    void CheckboxUpdated(Checkbox* checkbox, double time) override;
    void FloatSliderUpdated(FloatSlider* slider, float oldVal, double time) override {}
    void IntSliderUpdated(IntSlider* slider, int oldVal, double time) override {}
+   void TextEntryComplete(TextEntry* entry) override;
 
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
@@ -73,21 +76,12 @@ private:
    void GetModuleDimensions(float& w, float& h) override
    {
       w = 235;
-      h = 170;
+      h = 190;
    }
 
-   FFTData mFFTData{ VOCODER_WINDOW_SIZE, FFT_FREQDOMAIN_SIZE };
-
-   float* mWindower{ nullptr };
-
-
-   ::FFT mFFT{ VOCODER_WINDOW_SIZE };
-   RollingBuffer mRollingInputBuffer{ VOCODER_WINDOW_SIZE };
-   RollingBuffer mRollingOutputBuffer{ VOCODER_WINDOW_SIZE };
+   STFT mSTFT{ VOCODER_WINDOW_SIZE, VOCODER_WINDOW_SIZE / 4, 2 }; //modulator and carrier
 
    float* mCarrierInputBuffer{ nullptr };
-   RollingBuffer mRollingCarrierBuffer{ VOCODER_WINDOW_SIZE };
-   FFTData mCarrierFFTData{ VOCODER_WINDOW_SIZE, FFT_FREQDOMAIN_SIZE };
 
    float mInputPreamp{ 1 };
    float mCarrierPreamp{ 1 };
@@ -107,6 +101,9 @@ private:
 
    int mCut{ 1 };
    IntSlider* mCutSlider{ nullptr };
+   std::string mCarrierBusName; //take the carrier from a sidechain bus channel instead of from a vocodercarrier
+   TextEntry* mCarrierBusEntry{ nullptr };
+   SidechainBus::Channel* mCarrierBusChannel{ nullptr };
 
    GateEffect mGate;
 
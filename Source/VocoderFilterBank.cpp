@@ -0,0 +1,264 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    VocoderFilterBank.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "VocoderFilterBank.h"
+#include "BiquadFilter.h"
+#include "SynthGlobals.h"
+#include "Profiler.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+void VocoderFilterBank::SetNumBands(int numBands)
+{
+   assert(numBands >= 0 && numBands <= kMaxBands);
+   //bands coming back in start from rest, and bands going away leave zeroed coefficients so that their lanes stay silent
+   for (int i = MIN(numBands, mNumBands); i < kMaxBands; ++i)
+   {
+      if (i >= numBands)
+         mA0[i] = mA1[i] = mA2[i] = mB1[i] = mB2[i] = 0;
+      mModulatorZ1[i] = mModulatorZ2[i] = mCarrierZ1[i] = mCarrierZ2[i] = 0;
+      mPeak[i] = 0;
+   }
+   mNumBands = numBands;
+}
+
+void VocoderFilterBank::SetBand(int band, const BiquadFilter& design)
+{
+   assert(band >= 0 && band < mNumBands);
+   double a0, a1, a2, b1, b2;
+   design.GetCoefficients(a0, a1, a2, b1, b2);
+   mA0[band] = a0;
+   mA1[band] = a1;
+   mA2[band] = a2;
+   mB1[band] = b1;
+   mB2[band] = b2;
+}
+
+void VocoderFilterBank::Clear()
+{
+   for (int i = 0; i < kMaxBands; ++i)
+   {
+      mModulatorZ1[i] = mModulatorZ2[i] = mCarrierZ1[i] = mCarrierZ2[i] = 0;
+      mPeak[i] = 0;
+   }
+}
+
+void VocoderFilterBank::Process(const float* modulator, const float* carrier, float* out, int bufferSize)
+{
+   PROFILER(VocoderFilterBank);
+
+   if (mNumBands == 0 || bufferSize <= 0)
+      return;
+
+   alignas(16) float oldPeak[kMaxBands];
+   for (int i = 0; i < kMaxBands; ++i)
+      oldPeak[i] = mPeak[i];
+
+   FollowModulator(modulator, bufferSize);
+   ProcessCarrier(carrier, oldPeak, out, bufferSize);
+   ClearNonFinite();
+}
+
+//the same follower as PeakTracker: ride peaks up instantly, decay exponentially, optionally clamped to a limit
+void VocoderFilterBank::FollowModulator(const float* modulator, int bufferSize)
+{
+   const float decay = powf(0.5f, 1.0f / (mDecayTime * gSampleRate));
+   const float epsilon = std::numeric_limits<float>::epsilon();
+   const bool useLimit = mLimit > epsilon;
+   const float limit = useLimit ? mLimit : std::numeric_limits<float>::max();
+
+   for (int g = 0; g < GetNumGroups(); ++g)
+   {
+      int b = g * kLanes;
+#if defined(__wasm_simd128__)
+      v128_t a0 = wasm_v128_load(mA0 + b);
+      v128_t a1 = wasm_v128_load(mA1 + b);
+      v128_t a2 = wasm_v128_load(mA2 + b);
+      v128_t b1 = wasm_v128_load(mB1 + b);
+      v128_t b2 = wasm_v128_load(mB2 + b);
+      v128_t z1 = wasm_v128_load(mModulatorZ1 + b);
+      v128_t z2 = wasm_v128_load(mModulatorZ2 + b);
+      v128_t peak = wasm_v128_load(mPeak + b);
+      v128_t vDecay = wasm_f32x4_splat(decay);
+      v128_t vEpsilon = wasm_f32x4_splat(epsilon);
+      v128_t vLimit = wasm_f32x4_splat(limit);
+
+      for (int i = 0; i < bufferSize; ++i)
+      {
+         v128_t in = wasm_f32x4_splat(modulator[i]);
+         v128_t filtered = wasm_f32x4_add(wasm_f32x4_mul(in, a0), z1);
+         z1 = wasm_f32x4_sub(wasm_f32x4_add(wasm_f32x4_mul(in, a1), z2), wasm_f32x4_mul(b1, filtered));
+         z2 = wasm_f32x4_sub(wasm_f32x4_mul(in, a2), wasm_f32x4_mul(b2, filtered));
+
+         v128_t level = wasm_f32x4_abs(filtered);
+         v128_t decayed = wasm_f32x4_mul(peak, vDecay);
+         decayed = wasm_v128_and(decayed, wasm_f32x4_ge(decayed, vEpsilon));
+         peak = wasm_v128_bitselect(wasm_f32x4_min(level, vLimit), decayed, wasm_f32x4_ge(level, peak));
+      }
+
+      wasm_v128_store(mModulatorZ1 + b, z1);
+      wasm_v128_store(mModulatorZ2 + b, z2);
+      wasm_v128_store(mPeak + b, peak);
+#else
+      for (int lane = b; lane < b + kLanes; ++lane)
+      {
+         //keep everything in locals, so the filter state can live in registers for the length of the block
+         float a0 = mA0[lane];
+         float a1 = mA1[lane];
+         float a2 = mA2[lane];
+         float b1 = mB1[lane];
+         float b2 = mB2[lane];
+         float z1 = mModulatorZ1[lane];
+         float z2 = mModulatorZ2[lane];
+         float peak = mPeak[lane];
+
+         for (int i = 0; i < bufferSize; ++i)
+         {
+            float in = modulator[i];
+            float filtered = in * a0 + z1;
+            z1 = in * a1 + z2 - b1 * filtered;
+            z2 = in * a2 - b2 * filtered;
+
+            float level = fabsf(filtered);
+            if (level >= peak)
+            {
+               peak = MIN(level, limit);
+            }
+            else
+            {
+               peak *= decay;
+               if (peak < epsilon)
+                  peak = 0;
+            }
+         }
+
+         mModulatorZ1[lane] = z1;
+         mModulatorZ2[lane] = z2;
+         mPeak[lane] = peak;
+      }
+#endif
+   }
+}
+
+void VocoderFilterBank::ProcessCarrier(const float* carrier, const float* oldPeak, float* out, int bufferSize)
+{
+   const float invBufferSize = 1.0f / bufferSize;
+
+   for (int chunkStart = 0; chunkStart < bufferSize; chunkStart += kChunkSize)
+   {
+      int chunkSize = MIN(kChunkSize, bufferSize - chunkStart);
+      for (int i = 0; i < chunkSize * kLanes; ++i)
+         mLaneSums[i] = 0;
+
+      for (int g = 0; g < GetNumGroups(); ++g)
+      {
+         int b = g * kLanes;
+#if defined(__wasm_simd128__)
+         v128_t a0 = wasm_v128_load(mA0 + b);
+         v128_t a1 = wasm_v128_load(mA1 + b);
+         v128_t a2 = wasm_v128_load(mA2 + b);
+         v128_t b1 = wasm_v128_load(mB1 + b);
+         v128_t b2 = wasm_v128_load(mB2 + b);
+         v128_t z1 = wasm_v128_load(mCarrierZ1 + b);
+         v128_t z2 = wasm_v128_load(mCarrierZ2 + b);
+
+         //the level ramps linearly from where it was to where the modulator has it now, over the whole buffer
+         v128_t from = wasm_v128_load(oldPeak + b);
+         v128_t gainInc = wasm_f32x4_mul(wasm_f32x4_sub(wasm_v128_load(mPeak + b), from), wasm_f32x4_splat(invBufferSize));
+         v128_t gain = wasm_f32x4_add(from, wasm_f32x4_mul(gainInc, wasm_f32x4_splat(chunkStart)));
+
+         for (int i = 0; i < chunkSize; ++i)
+         {
+            v128_t in = wasm_f32x4_splat(carrier[chunkStart + i]);
+            v128_t filtered = wasm_f32x4_add(wasm_f32x4_mul(in, a0), z1);
+            z1 = wasm_f32x4_sub(wasm_f32x4_add(wasm_f32x4_mul(in, a1), z2), wasm_f32x4_mul(b1, filtered));
+            z2 = wasm_f32x4_sub(wasm_f32x4_mul(in, a2), wasm_f32x4_mul(b2, filtered));
+
+            float* sums = mLaneSums + i * kLanes;
+            wasm_v128_store(sums, wasm_f32x4_add(wasm_v128_load(sums), wasm_f32x4_mul(filtered, gain)));
+            gain = wasm_f32x4_add(gain, gainInc);
+         }
+
+         wasm_v128_store(mCarrierZ1 + b, z1);
+         wasm_v128_store(mCarrierZ2 + b, z2);
+#else
+         for (int lane = 0; lane < kLanes; ++lane)
+         {
+            int band = b + lane;
+            float a0 = mA0[band];
+            float a1 = mA1[band];
+            float a2 = mA2[band];
+            float b1 = mB1[band];
+            float b2 = mB2[band];
+            float z1 = mCarrierZ1[band];
+            float z2 = mCarrierZ2[band];
+
+            float gainInc = (mPeak[band] - oldPeak[band]) * invBufferSize;
+            float gain = oldPeak[band] + gainInc * chunkStart;
+
+            for (int i = 0; i < chunkSize; ++i)
+            {
+               float in = carrier[chunkStart + i];
+               float filtered = in * a0 + z1;
+               z1 = in * a1 + z2 - b1 * filtered;
+               z2 = in * a2 - b2 * filtered;
+
+               mLaneSums[i * kLanes + lane] += filtered * gain;
+               gain += gainInc;
+            }
+
+            mCarrierZ1[band] = z1;
+            mCarrierZ2[band] = z2;
+         }
+#endif
+      }
+
+      for (int i = 0; i < chunkSize; ++i)
+      {
+         const float* sums = mLaneSums + i * kLanes;
+         out[chunkStart + i] += sums[0] + sums[1] + sums[2] + sums[3];
+      }
+   }
+}
+
+void VocoderFilterBank::ClearNonFinite()
+{
+   for (int i = 0; i < mNumBands; ++i)
+   {
+      if (!std::isfinite(mModulatorZ1[i]) || !std::isfinite(mModulatorZ2[i]) || !std::isfinite(mPeak[i]))
+      {
+         mModulatorZ1[i] = mModulatorZ2[i] = 0;
+         mPeak[i] = 0;
+      }
+      if (!std::isfinite(mCarrierZ1[i]) || !std::isfinite(mCarrierZ2[i]))
+         mCarrierZ1[i] = mCarrierZ2[i] = 0;
+   }
+}
@@ -0,0 +1,79 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    VocoderFilterBank.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class BiquadFilter;
+
+//the band-pass filters and envelope followers of a channel vocoder, as structure-of-arrays so four bands run per simd lane group.
+//every band filters the modulator and follows its level, then filters the carrier and scales it by that level,
+//ramped across the block from the level at the end of the previous one
+class VocoderFilterBank
+{
+public:
+   static const int kMaxBands = 64;
+
+   //bands at or past numBands are silent
+   void SetNumBands(int numBands);
+   int GetNumBands() const { return mNumBands; }
+   //the modulator and the carrier both use design's coefficients for this band
+   void SetBand(int band, const BiquadFilter& design);
+   void SetDecayTime(float time) { mDecayTime = time; }
+   void SetLimit(float limit) { mLimit = limit; }
+   void Clear();
+
+   float GetPeak(int band) const { return mPeak[band]; }
+
+   //adds the vocoded carrier into out
+   void Process(const float* modulator, const float* carrier, float* out, int bufferSize);
+
+private:
+   static const int kLanes = 4;
+   static const int kChunkSize = 64; //output samples summed per pass over the bands
+
+   int GetNumGroups() const { return (mNumBands + kLanes - 1) / kLanes; }
+   void FollowModulator(const float* modulator, int bufferSize);
+   void ProcessCarrier(const float* carrier, const float* oldPeak, float* out, int bufferSize);
+   void ClearNonFinite();
+
+   int mNumBands{ 0 };
+   float mDecayTime{ .01f };
+   float mLimit{ -1 };
+
+   //per band
+   alignas(16) float mA0[kMaxBands]{};
+   alignas(16) float mA1[kMaxBands]{};
+   alignas(16) float mA2[kMaxBands]{};
+   alignas(16) float mB1[kMaxBands]{};
+   alignas(16) float mB2[kMaxBands]{};
+   alignas(16) float mModulatorZ1[kMaxBands]{};
+   alignas(16) float mModulatorZ2[kMaxBands]{};
+   alignas(16) float mCarrierZ1[kMaxBands]{};
+   alignas(16) float mCarrierZ2[kMaxBands]{};
+   alignas(16) float mPeak[kMaxBands]{};
+
+   alignas(16) float mLaneSums[kChunkSize * kLanes]; //four interleaved band sums per output sample
+};
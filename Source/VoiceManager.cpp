@@ -26,6 +26,7 @@
 #include "VoiceManager.h"
 #include "SynthGlobals.h"
 #include "UIControlMacros.h"
+#include "ModularSynth.h"
 
 VoiceManager::VoiceManager()
 : IDrawableModule(204, 22)
@@ -158,6 +159,11 @@ void VoiceManager::PlayNote(NoteMessage note)
       PlayNoteOutput(note);
       return;
    }
+   //when the cpu governor is at its last level, new notes are spread over half the voices
+   int voiceLimit = mVoiceLimit;
+   if (TheSynth->GetCpuGovernor().GetLevel(mPriority) >= CpuGovernor::kLevel_ReduceVoices)
+      voiceLimit = MAX(1, mVoiceLimit / 2);
+
    if (note.voiceIdx == -1 && mVoiceDistributionMode != Ignore)
    {
       // Reuse
@@ -167,7 +173,7 @@ void VoiceManager::PlayNote(NoteMessage note)
          // See if we have a previous voice that has the same pitch
          for (const auto& voice : mVoices)
          {
-            if (voice.voiceIdx >= mVoiceLimit)
+            if (voice.voiceIdx >= voiceLimit)
                break;
             if (voice.lastNote.pitch == note.pitch && voice.mVoiceAction != VoiceManagerVoice::Filter)
             {
@@ -182,9 +188,9 @@ void VoiceManager::PlayNote(NoteMessage note)
       {
          found = false;
          auto newVoice = mLastOutputVoice;
-         for (int i = 0; i < MAX(kNumVoices, mVoiceLimit - 1); ++i)
+         for (int i = 0; i < MAX(kNumVoices, voiceLimit - 1); ++i)
          {
-            if (++newVoice > kNumVoices - 1 || newVoice > mVoiceLimit)
+            if (++newVoice > kNumVoices - 1 || newVoice > voiceLimit)
                newVoice = 0;
             if (mVoices[newVoice].lastNote.velocity < 1 && mVoices[newVoice].mVoiceAction != VoiceManagerVoice::Filter)
             {
@@ -200,7 +206,7 @@ void VoiceManager::PlayNote(NoteMessage note)
             auto oldestId = 0;
             for (const auto& voice : mVoices)
             {
-               if (voice.voiceIdx >= mVoiceLimit)
+               if (voice.voiceIdx >= voiceLimit)
                   break;
                if (voice.lastUsedTime < oldestTime && voice.mVoiceAction != VoiceManagerVoice::Filter)
                {
@@ -227,7 +233,7 @@ void VoiceManager::PlayNote(NoteMessage note)
          if (!found) // All notes are being played
          {
             note.voiceIdx = mLastOutputVoice + 1;
-            if (note.voiceIdx >= mVoiceLimit)
+            if (note.voiceIdx >= voiceLimit)
                note.voiceIdx = 0;
          }
       }
@@ -236,12 +242,12 @@ void VoiceManager::PlayNote(NoteMessage note)
       {
          std::vector<int> voiceOptions;
          for (auto& voice : mVoices)
-            if (voice.lastNote.velocity < 1 && voice.mVoiceAction != VoiceManagerVoice::Filter && voice.voiceIdx < mVoiceLimit)
+            if (voice.lastNote.velocity < 1 && voice.mVoiceAction != VoiceManagerVoice::Filter && voice.voiceIdx < voiceLimit)
                voiceOptions.push_back(voice.voiceIdx);
          if (voiceOptions.empty())
          {
             note.voiceIdx = mLastOutputVoice + 1;
-            if (note.voiceIdx >= mVoiceLimit)
+            if (note.voiceIdx >= voiceLimit)
                note.voiceIdx = 0;
          }
          else
@@ -280,9 +286,12 @@ void VoiceManager::PlayNote(NoteMessage note)
 
 void VoiceManager::LoadLayout(const ofxJSONElement& moduleInfo)
 {
+   mModuleSaveData.LoadInt("cpu_priority", moduleInfo, 0, 0, CpuGovernor::kNumLevels - 1);
+
    SetUpFromSaveData();
 }
 
 void VoiceManager::SetUpFromSaveData()
 {
+   mPriority = mModuleSaveData.GetInt("cpu_priority");
 }
@@ -97,5 +97,6 @@ private:
 
    int mVoiceLimit{ 16 };
    IntSlider* mVoiceLimitSlider{ nullptr };
+   int mPriority{ 0 }; //subtracted from the CpuGovernor level
    VoiceManagerVoice mVoices[kNumVoices];
 };
@@ -0,0 +1,167 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    WaveformPeaks.cpp
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "WaveformPeaks.h"
+
+#include <algorithm>
+
+void WaveformPeaks::MarkDirty(int start, int length)
+{
+   if (length <= 0)
+      return;
+
+   uint32_t newStart = (uint32_t)std::max(start, 0);
+   uint32_t newEnd = (uint32_t)std::min((int64_t)start + length, (int64_t)INT32_MAX);
+
+   uint64_t current = mDirty.load(std::memory_order_relaxed);
+   uint64_t merged;
+   do
+   {
+      uint32_t currentStart = (uint32_t)(current >> 32);
+      uint32_t currentEnd = (uint32_t)(current & UINT32_MAX);
+      merged = PackRange(std::min(currentStart, newStart), std::max(currentEnd, newEnd));
+   } while (merged != current && !mDirty.compare_exchange_weak(current, merged, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void WaveformPeaks::Rebuild(int numSamples)
+{
+   mNumSamples = numSamples;
+   mLevels.clear();
+
+   int blockSize = kBaseBlockSize;
+   while (true)
+   {
+      int numBlocks = (numSamples + blockSize - 1) / blockSize;
+      if (numBlocks == 0)
+         break;
+
+      Level level;
+      level.mBlockSize = blockSize;
+      level.mMin.resize(numBlocks);
+      level.mMax.resize(numBlocks);
+      mLevels.push_back(std::move(level));
+
+      if (numBlocks == 1)
+         break;
+      blockSize *= kLevelScale;
+   }
+}
+
+void WaveformPeaks::Update(const float* data, int numSamples)
+{
+   uint64_t dirty = mDirty.exchange(kClean, std::memory_order_acquire);
+   int start = (int)(dirty >> 32);
+   int end = (int)(dirty & UINT32_MAX);
+
+   if (numSamples != mNumSamples)
+   {
+      Rebuild(numSamples);
+      start = 0;
+      end = numSamples;
+   }
+
+   if (data == nullptr || mLevels.empty())
+      return;
+
+   end = std::min(end, numSamples);
+   if (start >= end)
+      return;
+
+   int firstBlock = start / kBaseBlockSize;
+   int lastBlock = (end - 1) / kBaseBlockSize;
+
+   Level& base = mLevels[0];
+   for (int block = firstBlock; block <= lastBlock; ++block)
+   {
+      int blockStart = block * kBaseBlockSize;
+      int blockEnd = std::min(blockStart + kBaseBlockSize, numSamples);
+      auto minMax = std::minmax_element(data + blockStart, data + blockEnd);
+      base.mMin[block] = *minMax.first;
+      base.mMax[block] = *minMax.second;
+   }
+
+   for (size_t i = 1; i < mLevels.size(); ++i)
+   {
+      const Level& child = mLevels[i - 1];
+      Level& level = mLevels[i];
+      firstBlock /= kLevelScale;
+      lastBlock /= kLevelScale;
+      for (int block = firstBlock; block <= lastBlock; ++block)
+      {
+         int childStart = block * kLevelScale;
+         int childEnd = std::min(childStart + kLevelScale, (int)child.mMin.size());
+         level.mMin[block] = *std::min_element(child.mMin.begin() + childStart, child.mMin.begin() + childEnd);
+         level.mMax[block] = *std::max_element(child.mMax.begin() + childStart, child.mMax.begin() + childEnd);
+      }
+   }
+}
+
+void WaveformPeaks::GetRange(const float* data, int start, int end, float& min, float& max) const
+{
+   start = std::max(start, 0);
+   end = std::min(end, mNumSamples);
+
+   int level = -1;
+   while (level + 1 < (int)mLevels.size() && mLevels[level + 1].mBlockSize <= end - start)
+      ++level;
+
+   GetRangeAtLevel(data, level, start, end, min, max);
+}
+
+void WaveformPeaks::GetRangeAtLevel(const float* data, int level, int start, int end, float& min, float& max) const
+{
+   if (start >= end)
+      return;
+
+   if (level < 0)
+   {
+      for (int i = start; i < end; ++i)
+      {
+         min = std::min(min, data[i]);
+         max = std::max(max, data[i]);
+      }
+      return;
+   }
+
+   //use whole blocks from this level for the middle of the range, and go down a level for the ragged ends
+   const Level& current = mLevels[level];
+   int firstBlock = (start + current.mBlockSize - 1) / current.mBlockSize;
+   int endBlock = end / current.mBlockSize;
+   if (firstBlock >= endBlock)
+   {
+      GetRangeAtLevel(data, level - 1, start, end, min, max);
+      return;
+   }
+
+   for (int block = firstBlock; block < endBlock; ++block)
+   {
+      min = std::min(min, current.mMin[block]);
+      max = std::max(max, current.mMax[block]);
+   }
+
+   GetRangeAtLevel(data, level - 1, start, firstBlock * current.mBlockSize, min, max);
+   GetRangeAtLevel(data, level - 1, endBlock * current.mBlockSize, end, min, max);
+}
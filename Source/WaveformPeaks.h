@@ -0,0 +1,69 @@
+/**
+    bespoke synth, a software modular synthesizer
+    Copyright (C) 2022 Ryan Challinor (contact: awwbees@gmail.com)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/*
+  ==============================================================================
+
+    WaveformPeaks.h
+    Created: 14 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+//min/max pyramid over one channel of audio, so waveforms can be drawn at any zoom level without touching every sample.
+//writers mark the ranges they've changed (from any thread), and the affected blocks are recomputed on the next Update(), at draw time.
+class WaveformPeaks
+{
+public:
+   void MarkDirty(int start, int length);
+   void MarkAllDirty() { MarkDirty(0, INT32_MAX); }
+
+   //ui thread. brings the pyramid up to date with data, recomputing only what has been marked dirty since the last update
+   void Update(const float* data, int numSamples);
+
+   //ui thread, after Update(). finds the exact min and max of data[start, end)
+   void GetRange(const float* data, int start, int end, float& min, float& max) const;
+
+   int GetNumSamples() const { return mNumSamples; }
+
+   static const int kBaseBlockSize = 128;
+   static const int kLevelScale = 4;
+
+private:
+   struct Level
+   {
+      int mBlockSize{ 0 };
+      std::vector<float> mMin;
+      std::vector<float> mMax;
+   };
+
+   void Rebuild(int numSamples);
+   void GetRangeAtLevel(const float* data, int level, int start, int end, float& min, float& max) const;
+
+   static uint64_t PackRange(uint32_t start, uint32_t end) { return ((uint64_t)start << 32) | end; }
+   static constexpr uint64_t kClean = (uint64_t)UINT32_MAX << 32;
+
+   std::atomic<uint64_t> mDirty{ kClean }; //[start, end) packed into one word, so it can be merged without a lock
+   std::vector<Level> mLevels;
+   int mNumSamples{ 0 };
+};
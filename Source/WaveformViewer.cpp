@@ -32,16 +32,6 @@ WaveformViewer::WaveformViewer()
 : IAudioProcessor(gBufferSize)
 , IDrawableModule(600, 150)
 {
-   mBufferVizOffset[0] = 0;
-   mBufferVizOffset[1] = 0;
-   mVizPhase[0] = 0;
-   mVizPhase[1] = 0;
-
-   for (int i = 0; i < BUFFER_VIZ_SIZE; ++i)
-   {
-      for (int j = 0; j < 2; ++j)
-         mAudioView[i][j] = 0;
-   }
 }
 
 void WaveformViewer::CreateUIControls()
@@ -85,16 +75,18 @@ void WaveformViewer::Process(double time)
       }
 
       for (int i = 0; i < bufferSize; ++i)
-         mAudioView[(i + mBufferVizOffset[!mDoubleBufferFlip]) % lengthSamples][!mDoubleBufferFlip] = gWorkBuffer[i];
+         mAudioView[(i + mBufferVizOffset) % lengthSamples] = gWorkBuffer[i];
 
       float vizPhaseInc = GetPhaseInc(mDisplayFreq / 2);
-      mVizPhase[!mDoubleBufferFlip] += vizPhaseInc * bufferSize;
-      while (mVizPhase[!mDoubleBufferFlip] > FTWO_PI)
+      mVizPhase += vizPhaseInc * bufferSize;
+      while (mVizPhase > FTWO_PI)
       {
-         mVizPhase[!mDoubleBufferFlip] -= FTWO_PI;
+         mVizPhase -= FTWO_PI;
       }
 
-      mBufferVizOffset[!mDoubleBufferFlip] = (mBufferVizOffset[!mDoubleBufferFlip] + bufferSize) % lengthSamples;
+      mBufferVizOffset = (mBufferVizOffset + bufferSize) % lengthSamples;
+
+      FillTap(lengthSamples);
    }
 
    IAudioReceiver* target = GetTarget();
@@ -111,6 +103,60 @@ void WaveformViewer::Process(double time)
    GetBuffer()->Reset();
 }
 
+void WaveformViewer::FillTap(int lengthSamples)
+{
+   VisualizationTap::Frame* frame = mTap.BeginFrame();
+   if (frame == nullptr)
+      return;
+
+   //the window starts where the phase of the display frequency wraps, so the waveform holds still
+   float vizPhaseInc = GetPhaseInc(mDisplayFreq / 2);
+   int phaseStart = (FTWO_PI - mVizPhase) / vizPhaseInc;
+   float length = lengthSamples - (FTWO_PI / vizPhaseInc);
+   int numColumns = MIN(mTap.GetResolution(), VisualizationTap::kMaxPoints);
+   float samplesPerColumn = length / numColumns;
+   if (samplesPerColumn <= 0)
+   {
+      mTap.PublishFrame();
+      return;
+   }
+
+   for (int column = 0; column < numColumns; ++column)
+   {
+      int start = phaseStart + int(column * samplesPerColumn);
+      int end = MIN(phaseStart + int((column + 1) * samplesPerColumn), lengthSamples);
+      end = MAX(end, start + 1);
+      if (start >= lengthSamples)
+         break;
+
+      float minSample = mAudioView[(start + mBufferVizOffset) % lengthSamples];
+      float maxSample = minSample;
+      int minIndex = start;
+      int maxIndex = start;
+      for (int i = start + 1; i < end; ++i)
+      {
+         float sample = mAudioView[(i + mBufferVizOffset) % lengthSamples];
+         if (sample < minSample)
+         {
+            minSample = sample;
+            minIndex = i;
+         }
+         if (sample > maxSample)
+         {
+            maxSample = sample;
+            maxIndex = i;
+         }
+      }
+
+      if (minIndex <= maxIndex)
+         frame->AddPoint(ofVec2f(minSample, maxSample));
+      else
+         frame->AddPoint(ofVec2f(maxSample, minSample));
+   }
+
+   mTap.PublishFrame();
+}
+
 void WaveformViewer::DrawModule()
 {
    if (Minimized() || IsVisible() == false)
@@ -137,21 +183,19 @@ void WaveformViewer::DrawModule()
 
    float w, h;
    GetDimensions(w, h);
-   int lengthSamples = MIN(mLengthSamples, BUFFER_VIZ_SIZE);
-   float vizPhaseInc = GetPhaseInc(mDisplayFreq / 2);
-   float phaseStart = (FTWO_PI - mVizPhase[mDoubleBufferFlip]) / vizPhaseInc;
-   float end = lengthSamples - (FTWO_PI / vizPhaseInc);
+   mTap.SetResolution(w * gDrawScale);
+   const VisualizationTap::Frame& frame = mTap.GetLatestFrame();
+   float columnWidth = frame.mNumPoints > 0 ? w / frame.mNumPoints : 0;
 
    if (mDrawWaveform)
    {
       ofBeginShape();
-      for (int i = phaseStart; i < lengthSamples; i++)
+      for (int i = 0; i < frame.mNumPoints; ++i)
       {
-         float x = ofMap(i - phaseStart, 0, end, 0, w, true);
-         float samp = mAudioView[(i + mBufferVizOffset[mDoubleBufferFlip]) % lengthSamples][mDoubleBufferFlip];
-         samp *= mDrawGain;
-         if (x < w)
-            ofVertex(x, h / 2 - samp * (h / 2));
+         float x = i * columnWidth;
+         ofVertex(x, h / 2 - frame.mPoints[i].x * mDrawGain * (h / 2));
+         if (frame.mPoints[i].y != frame.mPoints[i].x)
+            ofVertex(x + columnWidth * .5f, h / 2 - frame.mPoints[i].y * mDrawGain * (h / 2));
       }
       ofEndShape(false);
    }
@@ -160,30 +204,21 @@ void WaveformViewer::DrawModule()
    {
       ofSetCircleResolution(32);
       ofSetLineWidth(1);
-      for (int i = phaseStart; i < lengthSamples; i++)
+      for (int i = 0; i < frame.mNumPoints; ++i)
       {
-         float a = float(i - phaseStart) / end;
-         if (a < 1)
-         {
-            float rad = a * MIN(w, h) / 2;
-            float samp = mAudioView[(i + mBufferVizOffset[mDoubleBufferFlip]) % lengthSamples][mDoubleBufferFlip];
-            if (samp > 0)
-               ofSetColor(245, 58, 135, ofMap(samp * mDrawGain / 10, 0, 1, 0, 255, true));
-            else
-               ofSetColor(58, 245, 135, ofMap(-samp * mDrawGain / 10, 0, 1, 0, 255, true));
-            ofCircle(w / 2, h / 2, rad);
-         }
+         float a = float(i) / frame.mNumPoints;
+         float rad = a * MIN(w, h) / 2;
+         float samp = fabsf(frame.mPoints[i].x) > fabsf(frame.mPoints[i].y) ? frame.mPoints[i].x : frame.mPoints[i].y;
+         if (samp > 0)
+            ofSetColor(245, 58, 135, ofMap(samp * mDrawGain / 10, 0, 1, 0, 255, true));
+         else
+            ofSetColor(58, 245, 135, ofMap(-samp * mDrawGain / 10, 0, 1, 0, 255, true));
+         ofCircle(w / 2, h / 2, rad);
       }
    }
 
    ofPopMatrix();
    ofPopStyle();
-
-   for (int i = 0; i < lengthSamples; ++i)
-      mAudioView[i][mDoubleBufferFlip] = mAudioView[i][!mDoubleBufferFlip];
-   mBufferVizOffset[mDoubleBufferFlip] = mBufferVizOffset[!mDoubleBufferFlip];
-   mVizPhase[mDoubleBufferFlip] = mVizPhase[!mDoubleBufferFlip];
-   mDoubleBufferFlip = !mDoubleBufferFlip;
 }
 
 void WaveformViewer::PlayNote(NoteMessage note)
@@ -30,6 +30,7 @@
 #include "Slider.h"
 #include "TextEntry.h"
 #include "INoteReceiver.h"
+#include "VisualizationTap.h"
 
 #define BUFFER_VIZ_SIZE 10000
 
@@ -47,6 +48,7 @@ public:
 
    //IAudioSource
    void Process(double time) override;
+   bool IsAudioSink() const override { return true; } //displays its input
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
 
    bool IsResizable() const override { return true; }
@@ -69,11 +71,15 @@ private:
    //IDrawableModule
    void DrawModule() override;
 
-   float mAudioView[BUFFER_VIZ_SIZE][2]{};
-   bool mDoubleBufferFlip{ false };
+   void FillTap(int lengthSamples);
 
-   int mBufferVizOffset[2]{};
-   float mVizPhase[2]{};
+   //audio thread only
+   float mAudioView[BUFFER_VIZ_SIZE]{};
+   int mBufferVizOffset{ 0 };
+   float mVizPhase{ 0 };
+
+   //one point per column, holding the column's extremes in the order they happened
+   VisualizationTap mTap;
 
    float mDisplayFreq{ 220 };
    int mLengthSamples{ 2048 };
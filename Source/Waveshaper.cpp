@@ -29,17 +29,115 @@
 #include "ModularSynth.h"
 #include "Profiler.h"
 
+#include "juce_core/juce_core.h"
+
 namespace
 {
    const int kGraphWidth = 100;
    const int kGraphHeight = 100;
    const int kGraphX = 115;
    const int kGraphY = 18;
+
+   //in the order of Waveshaper::Variable
+   const char* const kVariableNames[] = { "x", "x1", "x2", "y1", "y2", "t", "a", "b", "c", "d", "e" };
+
+   //the table covers x (the rescaled input) from -kTableRange to kTableRange. blocks that go outside it are evaluated directly
+   const float kTableRange = 16;
+   const int kTableSize = 16384;
+   const float kTableStep = 2 * kTableRange / kTableSize;
+
+   juce::ThreadPool& GetTablePool()
+   {
+      static juce::ThreadPool* sPool = new juce::ThreadPool(1); //never destroyed, modules can outlive static destruction
+      return *sPool;
+   }
 }
 
+class WaveshaperTableJob : public juce::ThreadPoolJob
+{
+public:
+   WaveshaperTableJob(Waveshaper* owner, std::string expression, Waveshaper::TableKey key)
+   : juce::ThreadPoolJob("waveshaper table")
+   , mOwner(owner)
+   , mExpression(expression)
+   , mKey(key)
+   {
+   }
+
+   JobStatus runJob() override
+   {
+      auto table = std::make_unique<Waveshaper::ShapeTable>();
+      table->mKey = mKey;
+      bool built = Build(table->mValues);
+      if (!shouldExit())
+         mOwner->OnTableBuilt(built ? table.release() : nullptr);
+      return jobHasFinished;
+   }
+
+private:
+   bool Build(std::vector<float>& values)
+   {
+      int numPoints = kTableSize + 4;
+      std::vector<float> inputs(numPoints);
+      for (int i = 0; i < numPoints; ++i)
+         inputs[i] = -kTableRange + (i - 1) * kTableStep;
+      values.resize(numPoints);
+
+      //the same two ways the module evaluates it, so the table matches what it replaces
+      CompiledExpression compiled;
+      for (const char* name : kVariableNames)
+         compiled.AddVariable(name);
+      if (compiled.Compile(mExpression))
+      {
+         compiled.SetValues(Waveshaper::kVariable_X, inputs.data());
+         for (int variable : { Waveshaper::kVariable_X1, Waveshaper::kVariable_X2, Waveshaper::kVariable_Y1, Waveshaper::kVariable_Y2, Waveshaper::kVariable_T })
+            compiled.SetValue(variable, 0);
+         for (int i = 0; i < (int)mKey.mParams.size(); ++i)
+            compiled.SetValue(Waveshaper::kVariable_A + i, mKey.mParams[i]);
+         compiled.EvaluateBlock(values.data(), numPoints);
+         return true;
+      }
+
+      float variables[Waveshaper::kNumVariables]{};
+      exprtk::symbol_table<float> symbolTable;
+      for (int i = 0; i < Waveshaper::kNumVariables; ++i)
+         symbolTable.add_variable(kVariableNames[i], variables[i]);
+      symbolTable.add_constants();
+      exprtk::expression<float> expression;
+      expression.register_symbol_table(symbolTable);
+      exprtk::parser<float> parser;
+      if (!parser.compile(mExpression, expression))
+         return false;
+
+      for (int i = 0; i < (int)mKey.mParams.size(); ++i)
+         variables[Waveshaper::kVariable_A + i] = mKey.mParams[i];
+      for (int i = 0; i < numPoints; ++i)
+      {
+         if (i % 1024 == 0 && shouldExit())
+            return false;
+         variables[Waveshaper::kVariable_X] = inputs[i];
+         values[i] = expression.value();
+      }
+      return true;
+   }
+
+   Waveshaper* mOwner;
+   std::string mExpression;
+   Waveshaper::TableKey mKey;
+};
+
 Waveshaper::Waveshaper()
 : IAudioProcessor(gBufferSize)
 {
+   for (CompiledExpression* expression : { &mCompiledExpression, &mCompiledExpressionDraw })
+   {
+      for (const char* name : kVariableNames)
+         expression->AddVariable(name);
+   }
+   for (auto& block : mVariableBlocks)
+      block.resize(gBufferSize);
+   mRescaleBlock.resize(gBufferSize);
+   mTablePositions.resize(gBufferSize);
 }
 
 void Waveshaper::CreateUIControls()
@@ -54,6 +152,17 @@ void Waveshaper::CreateUIControls()
    mCSlider = new FloatSlider(this, "c", mBSlider, kAnchor_Below, 110, 15, &mC, -10, 10, 4);
    mDSlider = new FloatSlider(this, "d", mCSlider, kAnchor_Below, 110, 15, &mD, -10, 10, 4);
    mESlider = new FloatSlider(this, "e", mDSlider, kAnchor_Below, 110, 15, &mE, -10, 10, 4);
+   mOversampleDropdown = new DropdownList(this, "oversample", mESlider, kAnchor_Below, &mOversample, 40);
+   mTableDropdown = new DropdownList(this, "table", mOversampleDropdown, kAnchor_Below, &mTableInterpolation, 50);
+
+   mOversampleDropdown->AddLabel("1x", 1);
+   mOversampleDropdown->AddLabel("2x", 2);
+   mOversampleDropdown->AddLabel("4x", 4);
+   mOversampleDropdown->AddLabel("8x", 8);
+
+   mTableDropdown->AddLabel("off", kTableOff);
+   mTableDropdown->AddLabel("linear", (int)ResampleQuality::Linear);
+   mTableDropdown->AddLabel("cubic", (int)ResampleQuality::Cubic);
 
    mSymbolTable.add_variable("x", mExpressionInput);
    mSymbolTable.add_variable("x1", mHistPre1);
@@ -88,6 +197,66 @@ void Waveshaper::CreateUIControls()
 
 Waveshaper::~Waveshaper()
 {
+   CancelTableBuild();
+   delete mTable;
+   delete mPendingTable.exchange(nullptr);
+   delete mRetiredTable.exchange(nullptr);
+}
+
+void Waveshaper::Poll()
+{
+   delete mRetiredTable.exchange(nullptr);
+
+   //one build at a time. if the parameters moved on while it ran, the next one starts when it's done
+   TableKey key;
+   if (mTableBuilding || !GetTableKey(key) || key == mRequestedTableKey)
+      return;
+
+   CancelTableBuild();
+   mRequestedTableKey = key;
+   mTableBuilding = true;
+   mTableJob = new WaveshaperTableJob(this, mEntryString, key);
+   GetTablePool().addJob(mTableJob, true);
+}
+
+bool Waveshaper::GetTableKey(TableKey& key) const
+{
+   if (mTableInterpolation == kTableOff || !mExpressionValid || !mCanUseTable)
+      return false;
+
+   //modulated parameters change too quickly for a table to keep up, so those are evaluated directly
+   const FloatSlider* sliders[] = { mASlider, mBSlider, mCSlider, mDSlider, mESlider };
+   const float params[] = { mA, mB, mC, mD, mE };
+   key.mExpressionRevision = mExpressionRevision;
+   for (int i = 0; i < (int)key.mParams.size(); ++i)
+   {
+      key.mParams[i] = 0;
+      if (mTableUsesParam[i])
+      {
+         if (sliders[i]->NeedsCompute())
+            return false;
+         key.mParams[i] = params[i];
+      }
+   }
+   return true;
+}
+
+void Waveshaper::CancelTableBuild()
+{
+   if (mTableJob == nullptr)
+      return;
+
+   //the job might have finished and been deleted by now, removeJob() only looks for the pointer
+   GetTablePool().removeJob(mTableJob, true, -1);
+   mTableJob = nullptr;
+   mTableBuilding = false;
+}
+
+void Waveshaper::OnTableBuilt(ShapeTable* table)
+{
+   if (table != nullptr)
+      delete mPendingTable.exchange(table); //replaces one that never got swapped in
+   mTableBuilding = false;
 }
 
 void Waveshaper::Process(double time)
@@ -117,39 +286,76 @@ void Waveshaper::Process(double time)
    float min = 0;
 
    int bufferSize = GetBuffer()->BufferSize();
+   int factor = mOversample;
+   mOversampler.SetFactor(factor);
+   int numSamples = bufferSize * factor;
+   if (numSamples > (int)mRescaleBlock.size())
+   {
+      for (auto& block : mVariableBlocks)
+         block.resize(numSamples);
+      mRescaleBlock.resize(numSamples);
+      mTablePositions.resize(numSamples);
+   }
+
+   //swap in a newly built table, once the last one swapped out has been cleaned up
+   if (mRetiredTable.load() == nullptr)
+   {
+      ShapeTable* pending = mPendingTable.exchange(nullptr);
+      if (pending != nullptr)
+      {
+         mRetiredTable = mTable;
+         mTable = pending;
+      }
+   }
 
    ChannelBuffer* out = target->GetBuffer();
    for (int ch = 0; ch < GetBuffer()->NumActiveChannels(); ++ch)
    {
-      float* buffer = GetBuffer()->GetChannel(ch);
-      if (mExpressionValid)
+      //with oversampling on, the expression sees the oversampled signal, so x1/x2/y1/y2 are the previous oversampled samples
+      float* channel = GetBuffer()->GetChannel(ch);
+      float* buffer = channel;
+      if (factor > 1)
+         buffer = mOversampler.Upsample(ch, channel, bufferSize);
+
+      bool usesHistory = mCompiledExpression.UsesVariable(kVariable_X1) || mCompiledExpression.UsesVariable(kVariable_X2) ||
+                         mCompiledExpression.UsesVariable(kVariable_Y1) || mCompiledExpression.UsesVariable(kVariable_Y2);
+      if (mExpressionValid && !ProcessTableBlock(buffer, bufferSize, factor, ch, min, max))
       {
-         for (int i = 0; i < bufferSize; ++i)
+         if (mUseCompiledExpression && !usesHistory)
          {
-            ComputeSliders(i);
-            mExpressionInput = buffer[i] * mRescale;
-
-            mHistPre1 = mBiquadState[ch].mHistPre1;
-            mHistPre2 = mBiquadState[ch].mHistPre2;
-            mHistPost1 = mBiquadState[ch].mHistPost1;
-            mHistPost2 = mBiquadState[ch].mHistPost2;
-
-            if (mExpressionInput > max)
-               max = mExpressionInput;
-            if (mExpressionInput < min)
-               min = mExpressionInput;
-
-            mT = (gTime + i * gInvSampleRateMs) * .001;
-            buffer[i] = mExpression.value() / mRescale;
-
-            mBiquadState[ch].mHistPre2 = mBiquadState[ch].mHistPre1;
-            mBiquadState[ch].mHistPre1 = mExpressionInput;
-            mBiquadState[ch].mHistPost2 = mBiquadState[ch].mHistPost1;
-            mBiquadState[ch].mHistPost1 = ofClamp(buffer[i], -1, 1); //keep feedback from spiraling out of control
+            ProcessCompiledBlock(buffer, bufferSize, factor, ch, min, max);
+         }
+         else
+         {
+            for (int i = 0; i < numSamples; ++i)
+            {
+               ComputeSliders(i / factor);
+               mExpressionInput = buffer[i] * mRescale;
+
+               mHistPre1 = mBiquadState[ch].mHistPre1;
+               mHistPre2 = mBiquadState[ch].mHistPre2;
+               mHistPost1 = mBiquadState[ch].mHistPost1;
+               mHistPost2 = mBiquadState[ch].mHistPost2;
+
+               if (mExpressionInput > max)
+                  max = mExpressionInput;
+               if (mExpressionInput < min)
+                  min = mExpressionInput;
+
+               mT = (gTime + i * gInvSampleRateMs / factor) * .001;
+               buffer[i] = (mUseCompiledExpression ? EvaluateCompiledSample() : mExpression.value()) / mRescale;
+
+               mBiquadState[ch].mHistPre2 = mBiquadState[ch].mHistPre1;
+               mBiquadState[ch].mHistPre1 = mExpressionInput;
+               mBiquadState[ch].mHistPost2 = mBiquadState[ch].mHistPost1;
+               mBiquadState[ch].mHistPost1 = ofClamp(buffer[i], -1, 1); //keep feedback from spiraling out of control
+            }
          }
       }
-      Add(out->GetChannel(ch), buffer, bufferSize);
-      GetVizBuffer()->WriteChunk(buffer, bufferSize, ch);
+      if (factor > 1)
+         mOversampler.Downsample(ch, buffer, channel, bufferSize);
+      Add(out->GetChannel(ch), channel, bufferSize);
+      GetVizBuffer()->WriteChunk(channel, bufferSize, ch);
    }
 
    mSmoothMax = max > mSmoothMax ? max : ofLerp(mSmoothMax, max, .01f);
@@ -158,12 +364,206 @@ void Waveshaper::Process(double time)
    GetBuffer()->Reset();
 }
 
+void Waveshaper::ComputeRescaleBlock(int bufferSize, int factor)
+{
+   int numSamples = bufferSize * factor;
+   if (mRescaleSlider->NeedsCompute())
+   {
+      ComputeSliderBlock(mRescaleSlider, mRescaleBlock.data(), bufferSize, factor);
+   }
+   else
+   {
+      for (int i = 0; i < numSamples; ++i)
+         mRescaleBlock[i] = mRescale;
+   }
+}
+
+void Waveshaper::KeepHistory(int ch, const float* input, const float* output, int numSamples)
+{
+   //keep the history going, in case the expression changes to one that uses it
+   BiquadState& state = mBiquadState[ch];
+   for (int i = MAX(0, numSamples - 2); i < numSamples; ++i)
+   {
+      state.mHistPre2 = state.mHistPre1;
+      state.mHistPre1 = input[i];
+      state.mHistPost2 = state.mHistPost1;
+      state.mHistPost1 = ofClamp(output[i], -1, 1);
+   }
+}
+
+//a baked expression is a lookup per sample, however much exprtk work it took to build
+bool Waveshaper::ProcessTableBlock(float* buffer, int bufferSize, int factor, int ch, float& min, float& max)
+{
+   TableKey key;
+   if (mTable == nullptr || !GetTableKey(key) || key != mTable->mKey)
+      return false;
+
+   int numSamples = bufferSize * factor;
+   ComputeRescaleBlock(bufferSize, factor);
+
+   float* input = mVariableBlocks[kVariable_X].data();
+   float blockMin = 0;
+   float blockMax = 0;
+   for (int i = 0; i < numSamples; ++i)
+   {
+      input[i] = buffer[i] * mRescaleBlock[i];
+      blockMax = MAX(blockMax, input[i]);
+      blockMin = MIN(blockMin, input[i]);
+   }
+   if (blockMin < -kTableRange || blockMax > kTableRange)
+      return false;
+   max = MAX(max, blockMax);
+   min = MIN(min, blockMin);
+
+   for (int i = 0; i < numSamples; ++i)
+      mTablePositions[i] = (input[i] + kTableRange) / kTableStep + 1;
+   Resample(mTable->mValues.data(), (int)mTable->mValues.size(), mTablePositions.data(), buffer, numSamples, (ResampleQuality)mTableInterpolation);
+   for (int i = 0; i < numSamples; ++i)
+      buffer[i] /= mRescaleBlock[i];
+
+   KeepHistory(ch, input, buffer, numSamples);
+   return true;
+}
+
+//without feedback from previous samples, every sample of the block can be shaped at once.
+//buffer holds bufferSize * factor samples when oversampling
+void Waveshaper::ProcessCompiledBlock(float* buffer, int bufferSize, int factor, int ch, float& min, float& max)
+{
+   int numSamples = bufferSize * factor;
+   ComputeRescaleBlock(bufferSize, factor);
+
+   float* input = mVariableBlocks[kVariable_X].data();
+   for (int i = 0; i < numSamples; ++i)
+   {
+      input[i] = buffer[i] * mRescaleBlock[i];
+      if (input[i] > max)
+         max = input[i];
+      if (input[i] < min)
+         min = input[i];
+   }
+   mCompiledExpression.SetValues(kVariable_X, input);
+
+   FloatSlider* sliders[] = { mASlider, mBSlider, mCSlider, mDSlider, mESlider };
+   for (int i = 0; i < 5; ++i)
+   {
+      int variable = kVariable_A + i;
+      if (!mCompiledExpression.UsesVariable(variable))
+         continue;
+
+      if (sliders[i]->NeedsCompute())
+      {
+         ComputeSliderBlock(sliders[i], mVariableBlocks[variable].data(), bufferSize, factor);
+         mCompiledExpression.SetValues(variable, mVariableBlocks[variable].data());
+      }
+      else
+      {
+         mCompiledExpression.SetValue(variable, *sliders[i]->GetVar());
+      }
+   }
+
+   if (mCompiledExpression.UsesVariable(kVariable_T))
+   {
+      float* t = mVariableBlocks[kVariable_T].data();
+      for (int i = 0; i < numSamples; ++i)
+         t[i] = (gTime + i * gInvSampleRateMs / factor) * .001;
+      mCompiledExpression.SetValues(kVariable_T, t);
+   }
+
+   mCompiledExpression.EvaluateBlock(buffer, numSamples);
+   for (int i = 0; i < numSamples; ++i)
+      buffer[i] /= mRescaleBlock[i];
+
+   KeepHistory(ch, input, buffer, numSamples);
+}
+
+//slider modulation is computed at the base rate, and each value held across its oversampled samples
+void Waveshaper::ComputeSliderBlock(FloatSlider* slider, float* block, int bufferSize, int factor)
+{
+   slider->ComputeBlock(block, bufferSize);
+   for (int i = bufferSize - 1; i >= 0 && factor > 1; --i)
+   {
+      for (int j = factor - 1; j >= 0; --j)
+         block[i * factor + j] = block[i];
+   }
+}
+
+float Waveshaper::EvaluateCompiledSample()
+{
+   mCompiledExpression.SetValue(kVariable_X, mExpressionInput);
+   mCompiledExpression.SetValue(kVariable_X1, mHistPre1);
+   mCompiledExpression.SetValue(kVariable_X2, mHistPre2);
+   mCompiledExpression.SetValue(kVariable_Y1, mHistPost1);
+   mCompiledExpression.SetValue(kVariable_Y2, mHistPost2);
+   mCompiledExpression.SetValue(kVariable_T, mT);
+   mCompiledExpression.SetValue(kVariable_A, mA);
+   mCompiledExpression.SetValue(kVariable_B, mB);
+   mCompiledExpression.SetValue(kVariable_C, mC);
+   mCompiledExpression.SetValue(kVariable_D, mD);
+   mCompiledExpression.SetValue(kVariable_E, mE);
+   return mCompiledExpression.Evaluate();
+}
+
+float Waveshaper::EvaluateForDraw(float input)
+{
+   if (mUseCompiledExpression)
+   {
+      for (int variable : { kVariable_X, kVariable_X1, kVariable_X2, kVariable_Y1, kVariable_Y2 })
+         mCompiledExpressionDraw.SetValue(variable, input);
+      mCompiledExpressionDraw.SetValue(kVariable_T, mT);
+      mCompiledExpressionDraw.SetValue(kVariable_A, mA);
+      mCompiledExpressionDraw.SetValue(kVariable_B, mB);
+      mCompiledExpressionDraw.SetValue(kVariable_C, mC);
+      mCompiledExpressionDraw.SetValue(kVariable_D, mD);
+      mCompiledExpressionDraw.SetValue(kVariable_E, mE);
+      return mCompiledExpressionDraw.Evaluate();
+   }
+   mExpressionInputDraw = input;
+   return mExpressionDraw.value();
+}
+
 void Waveshaper::TextEntryComplete(TextEntry* entry)
 {
-   exprtk::parser<float> parser;
-   mExpressionValid = parser.compile(mEntryString, mExpression);
-   if (mExpressionValid)
-      parser.compile(mEntryString, mExpressionDraw);
+   ++mExpressionRevision;
+   mUseCompiledExpression = false;
+   if (mCompiledExpressionDraw.Compile(mEntryString))
+   {
+      mCompiledExpression.Compile(mEntryString);
+      mUseCompiledExpression = true;
+      mExpressionValid = true;
+   }
+   else
+   {
+      exprtk::parser<float> parser;
+      mExpressionValid = parser.compile(mEntryString, mExpression);
+      if (mExpressionValid)
+         parser.compile(mEntryString, mExpressionDraw);
+   }
+
+   //a table can stand in for the expression if all it depends on is x and parameters that hold still
+   std::array<bool, kNumVariables> usesVariable{};
+   bool knowsVariables = mExpressionValid;
+   if (mUseCompiledExpression)
+   {
+      for (int i = 0; i < kNumVariables; ++i)
+         usesVariable[i] = mCompiledExpression.UsesVariable(i);
+   }
+   else if (mExpressionValid)
+   {
+      std::vector<std::string> variables;
+      knowsVariables = exprtk::collect_variables(mEntryString, variables);
+      for (const auto& variable : variables)
+      {
+         for (int i = 0; i < kNumVariables; ++i)
+         {
+            if (juce::String(variable).equalsIgnoreCase(kVariableNames[i]))
+               usesVariable[i] = true;
+         }
+      }
+   }
+   mCanUseTable = knowsVariables && !usesVariable[kVariable_X1] && !usesVariable[kVariable_X2] && !usesVariable[kVariable_Y1] &&
+                  !usesVariable[kVariable_Y2] && !usesVariable[kVariable_T];
+   for (int i = 0; i < (int)mTableUsesParam.size(); ++i)
+      mTableUsesParam[i] = usesVariable[kVariable_A + i];
 }
 
 void Waveshaper::DrawModule()
@@ -192,16 +592,13 @@ void Waveshaper::DrawModule()
       ofBeginShape();
       for (int i = 0; i < 100; ++i)
       {
-         mExpressionInputDraw = ofMap(i, 0, kGraphWidth, -1, 1);
-         ofVertex(i + kGraphX, ofMap(mExpressionDraw.value(), -1, 1, kGraphHeight, 0) + kGraphY);
+         ofVertex(i + kGraphX, ofMap(EvaluateForDraw(ofMap(i, 0, kGraphWidth, -1, 1)), -1, 1, kGraphHeight, 0) + kGraphY);
       }
       ofEndShape();
 
       ofSetColor(245, 58, 135);
-      mExpressionInputDraw = mSmoothMin;
-      ofCircle(kGraphX + ofMap(mSmoothMin, -1, 1, 0, kGraphWidth), ofMap(mExpressionDraw.value(), -1, 1, kGraphHeight, 0) + kGraphY, 3);
-      mExpressionInputDraw = mSmoothMax;
-      ofCircle(kGraphX + ofMap(mSmoothMax, -1, 1, 0, kGraphWidth), ofMap(mExpressionDraw.value(), -1, 1, kGraphHeight, 0) + kGraphY, 3);
+      ofCircle(kGraphX + ofMap(mSmoothMin, -1, 1, 0, kGraphWidth), ofMap(EvaluateForDraw(mSmoothMin), -1, 1, kGraphHeight, 0) + kGraphY, 3);
+      ofCircle(kGraphX + ofMap(mSmoothMax, -1, 1, 0, kGraphWidth), ofMap(EvaluateForDraw(mSmoothMax), -1, 1, kGraphHeight, 0) + kGraphY, 3);
 
       ofPopMatrix();
    }
@@ -215,12 +612,15 @@ void Waveshaper::DrawModule()
    mCSlider->Draw();
    mDSlider->Draw();
    mESlider->Draw();
+   mOversampleDropdown->Draw();
+   mTableDropdown->Draw();
 }
 
 void Waveshaper::GetModuleDimensions(float& w, float& h)
 {
    w = MAX(kGraphX + kGraphWidth + 2, 4 + mTextEntry->GetRect().width);
-   h = kGraphY + kGraphHeight;
+   ofRectangle tableRect = mTableDropdown->GetRect(true);
+   h = MAX(kGraphY + kGraphHeight, tableRect.y + tableRect.height + 2);
 }
 
 void Waveshaper::LoadLayout(const ofxJSONElement& moduleInfo)
@@ -33,8 +33,17 @@
 #include "ClickButton.h"
 #include "TextEntry.h"
 #include "exprtk.hpp"
+#include "CompiledExpression.h"
+#include "DropdownList.h"
+#include "Oversampler.h"
+#include "Resampler.h"
 
-class Waveshaper : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public ITextEntryListener
+#include <array>
+#include <atomic>
+
+class WaveshaperTableJob;
+
+class Waveshaper : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public ITextEntryListener, public IDropdownListener
 {
 public:
    Waveshaper();
@@ -45,6 +54,7 @@ public:
    static bool AcceptsPulses() { return false; }
 
    void CreateUIControls() override;
+   void Poll() override;
 
    //IAudioSource
    void Process(double time) override;
@@ -56,16 +66,65 @@ public:
    //ITextEntryListener
    void TextEntryComplete(TextEntry* entry) override;
 
+   //IDropdownListener
+   void DropdownUpdated(DropdownList* list, int oldVal, double time) override {}
+
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
 
    bool IsEnabled() const override { return mEnabled; }
 
 private:
+   friend class WaveshaperTableJob;
+
    //IDrawableModule
    void DrawModule() override;
    void GetModuleDimensions(float& w, float& h) override;
 
+   //what a table was baked from. parameters the expression doesn't use are left at zero, so moving them doesn't rebuild it
+   struct TableKey
+   {
+      int mExpressionRevision{ -1 };
+      std::array<float, 5> mParams{};
+      bool operator==(const TableKey& other) const { return mExpressionRevision == other.mExpressionRevision && mParams == other.mParams; }
+      bool operator!=(const TableKey& other) const { return !(*this == other); }
+   };
+
+   //the expression sampled across the input range, for expressions of x and the sliders alone.
+   //mValues has a guard point below the range and two above it, for cubic interpolation
+   struct ShapeTable
+   {
+      TableKey mKey;
+      std::vector<float> mValues;
+   };
+
+   void ProcessCompiledBlock(float* buffer, int bufferSize, int factor, int ch, float& min, float& max);
+   bool ProcessTableBlock(float* buffer, int bufferSize, int factor, int ch, float& min, float& max); //false if the table can't be used for this block
+   void ComputeRescaleBlock(int bufferSize, int factor);
+   void KeepHistory(int ch, const float* input, const float* output, int numSamples);
+   bool GetTableKey(TableKey& key) const; //false if the current parameters can't be baked
+   void CancelTableBuild();
+   void OnTableBuilt(ShapeTable* table); //background thread, null if the expression couldn't be baked
+   void ComputeSliderBlock(FloatSlider* slider, float* block, int bufferSize, int factor);
+   float EvaluateCompiledSample();
+   float EvaluateForDraw(float input);
+
+   enum Variable
+   {
+      kVariable_X,
+      kVariable_X1,
+      kVariable_X2,
+      kVariable_Y1,
+      kVariable_Y2,
+      kVariable_T,
+      kVariable_A,
+      kVariable_B,
+      kVariable_C,
+      kVariable_D,
+      kVariable_E,
+      kNumVariables
+   };
+
    float mRescale{ 1 };
    FloatSlider* mRescaleSlider{ nullptr };
    float mA{ 0 };
@@ -78,6 +137,12 @@ private:
    FloatSlider* mDSlider{ nullptr };
    float mE{ 0 };
    FloatSlider* mESlider{ nullptr };
+   int mOversample{ 1 };
+   DropdownList* mOversampleDropdown{ nullptr };
+   Oversampler mOversampler;
+   static constexpr int kTableOff = -1;
+   int mTableInterpolation{ kTableOff }; //kTableOff, or a ResampleQuality
+   DropdownList* mTableDropdown{ nullptr };
 
    std::string mEntryString{ "x" };
    TextEntry* mTextEntry{ nullptr };
@@ -85,6 +150,22 @@ private:
    exprtk::expression<float> mExpression;
    exprtk::symbol_table<float> mSymbolTableDraw;
    exprtk::expression<float> mExpressionDraw;
+   CompiledExpression mCompiledExpression;
+   CompiledExpression mCompiledExpressionDraw;
+   bool mUseCompiledExpression{ false };
+   std::array<std::vector<float>, kNumVariables> mVariableBlocks;
+   std::vector<float> mRescaleBlock;
+   std::vector<double> mTablePositions;
+
+   int mExpressionRevision{ 0 };
+   bool mCanUseTable{ false }; //the expression only depends on x and the sliders
+   std::array<bool, 5> mTableUsesParam{};
+   TableKey mRequestedTableKey;
+   WaveshaperTableJob* mTableJob{ nullptr };
+   std::atomic<bool> mTableBuilding{ false };
+   ShapeTable* mTable{ nullptr }; //audio thread
+   std::atomic<ShapeTable*> mPendingTable{ nullptr }; //ready to be swapped in
+   std::atomic<ShapeTable*> mRetiredTable{ nullptr }; //swapped out, for Poll() to delete
 
    float mExpressionInput{ 0 };
    float mHistPre1{ 0 };
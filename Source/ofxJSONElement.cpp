@@ -15,8 +15,616 @@
 
 #include "juce_core/juce_core.h"
 
+#include <cmath>
+#include <cstdio>
+
 using namespace Json;
 
+namespace
+{
+   //a recursive descent parser that builds the Json::Value tree straight from the text, without jsoncpp's token stream,
+   //per-value offsets and comment collection, and without copying strings that have no escapes in them.
+   //it takes what CharReaderBuilder's defaults take (comments, trailing commas), anything stranger falls back to jsoncpp
+   class JsonFastReader
+   {
+   public:
+      JsonFastReader(const char* begin, const char* end)
+      : mPos(begin)
+      , mEnd(end)
+      {
+      }
+
+      bool Parse(Json::Value& root)
+      {
+         SkipWhitespace();
+         if (!ParseValue(root, 0))
+            return false;
+         SkipWhitespace();
+         return mPos == mEnd;
+      }
+
+   private:
+      static constexpr int kMaxDepth = 1000; //jsoncpp's stackLimit
+
+      void SkipWhitespace()
+      {
+         while (mPos < mEnd)
+         {
+            char c = *mPos;
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+            {
+               ++mPos;
+            }
+            else if (c == '/' && mPos + 1 < mEnd && mPos[1] == '/')
+            {
+               while (mPos < mEnd && *mPos != '\n')
+                  ++mPos;
+            }
+            else if (c == '/' && mPos + 1 < mEnd && mPos[1] == '*')
+            {
+               mPos += 2;
+               while (mPos + 1 < mEnd && !(mPos[0] == '*' && mPos[1] == '/'))
+                  ++mPos;
+               mPos = MIN(mPos + 2, mEnd);
+            }
+            else
+            {
+               return;
+            }
+         }
+      }
+
+      bool Match(const char* literal)
+      {
+         const char* pos = mPos;
+         for (; *literal != 0; ++literal, ++pos)
+         {
+            if (pos == mEnd || *pos != *literal)
+               return false;
+         }
+         mPos = pos;
+         return true;
+      }
+
+      bool ParseValue(Json::Value& out, int depth)
+      {
+         if (mPos == mEnd || depth > kMaxDepth)
+            return false;
+
+         switch (*mPos)
+         {
+            case '{':
+               return ParseObject(out, depth);
+            case '[':
+               return ParseArray(out, depth);
+            case '"':
+            {
+               const char* begin;
+               const char* end;
+               if (!ParseString(begin, end, mValueScratch))
+                  return false;
+               out = Json::Value(begin, end);
+               return true;
+            }
+            case 't':
+               out = true;
+               return Match("true");
+            case 'f':
+               out = false;
+               return Match("false");
+            case 'n':
+               out = Json::Value();
+               return Match("null");
+            default:
+               return ParseNumber(out);
+         }
+      }
+
+      bool ParseObject(Json::Value& out, int depth)
+      {
+         ++mPos;
+         out = Json::Value(Json::objectValue);
+         while (true)
+         {
+            SkipWhitespace();
+            if (mPos == mEnd)
+               return false;
+            if (*mPos == '}')
+            {
+               ++mPos;
+               return true;
+            }
+
+            const char* keyBegin;
+            const char* keyEnd;
+            if (*mPos != '"' || !ParseString(keyBegin, keyEnd, mKeyScratch))
+               return false;
+            SkipWhitespace();
+            if (mPos == mEnd || *mPos != ':')
+               return false;
+            ++mPos;
+            SkipWhitespace();
+            Json::Value* child = out.demand(keyBegin, keyEnd); //the key is copied in here, so the scratch can be reused below
+            if (!ParseValue(*child, depth + 1))
+               return false;
+
+            SkipWhitespace();
+            if (mPos == mEnd)
+               return false;
+            if (*mPos == ',')
+               ++mPos;
+            else if (*mPos != '}')
+               return false;
+         }
+      }
+
+      bool ParseArray(Json::Value& out, int depth)
+      {
+         ++mPos;
+         out = Json::Value(Json::arrayValue);
+         while (true)
+         {
+            SkipWhitespace();
+            if (mPos == mEnd)
+               return false;
+            if (*mPos == ']')
+            {
+               ++mPos;
+               return true;
+            }
+
+            if (!ParseValue(out.append(Json::Value()), depth + 1))
+               return false;
+
+            SkipWhitespace();
+            if (mPos == mEnd)
+               return false;
+            if (*mPos == ',')
+               ++mPos;
+            else if (*mPos != ']')
+               return false;
+         }
+      }
+
+      //points begin/end at the string in the text when it has no escapes, otherwise decodes it into scratch
+      bool ParseString(const char*& begin, const char*& end, std::string& scratch)
+      {
+         ++mPos;
+         const char* start = mPos;
+         while (mPos < mEnd && *mPos != '"' && *mPos != '\\')
+            ++mPos;
+         if (mPos == mEnd)
+            return false;
+         if (*mPos == '"')
+         {
+            begin = start;
+            end = mPos;
+            ++mPos;
+            return true;
+         }
+
+         scratch.assign(start, mPos);
+         while (mPos < mEnd)
+         {
+            char c = *mPos++;
+            if (c == '"')
+            {
+               begin = scratch.data();
+               end = scratch.data() + scratch.size();
+               return true;
+            }
+            if (c != '\\')
+            {
+               scratch += c;
+               continue;
+            }
+            if (mPos == mEnd)
+               return false;
+            switch (*mPos++)
+            {
+               case '"': scratch += '"'; break;
+               case '\\': scratch += '\\'; break;
+               case '/': scratch += '/'; break;
+               case 'b': scratch += '\b'; break;
+               case 'f': scratch += '\f'; break;
+               case 'n': scratch += '\n'; break;
+               case 'r': scratch += '\r'; break;
+               case 't': scratch += '\t'; break;
+               case 'u':
+               {
+                  unsigned int codepoint;
+                  if (!ParseHex4(codepoint))
+                     return false;
+                  if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+                  {
+                     unsigned int low;
+                     if (!Match("\\u") || !ParseHex4(low) || low < 0xDC00 || low > 0xDFFF)
+                        return false;
+                     codepoint = 0x10000 + ((codepoint & 0x3FF) << 10) + (low & 0x3FF);
+                  }
+                  AppendUTF8(scratch, codepoint);
+                  break;
+               }
+               default:
+                  return false;
+            }
+         }
+         return false;
+      }
+
+      bool ParseHex4(unsigned int& value)
+      {
+         if (mEnd - mPos < 4)
+            return false;
+         value = 0;
+         for (int i = 0; i < 4; ++i)
+         {
+            char c = *mPos++;
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+               value += c - '0';
+            else if (c >= 'a' && c <= 'f')
+               value += c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+               value += c - 'A' + 10;
+            else
+               return false;
+         }
+         return true;
+      }
+
+      static void AppendUTF8(std::string& out, unsigned int codepoint)
+      {
+         if (codepoint < 0x80)
+         {
+            out += (char)codepoint;
+         }
+         else if (codepoint < 0x800)
+         {
+            out += (char)(0xC0 | (codepoint >> 6));
+            out += (char)(0x80 | (codepoint & 0x3F));
+         }
+         else if (codepoint < 0x10000)
+         {
+            out += (char)(0xE0 | (codepoint >> 12));
+            out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out += (char)(0x80 | (codepoint & 0x3F));
+         }
+         else
+         {
+            out += (char)(0xF0 | (codepoint >> 18));
+            out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+            out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out += (char)(0x80 | (codepoint & 0x3F));
+         }
+      }
+
+      //integers that fit stay integers, the same as jsoncpp decides it
+      bool ParseNumber(Json::Value& out)
+      {
+         const char* start = mPos;
+         bool negative = false;
+         if (mPos < mEnd && *mPos == '-')
+         {
+            negative = true;
+            ++mPos;
+         }
+
+         const char* digits = mPos;
+         Json::LargestUInt magnitude = 0;
+         bool overflow = false;
+         while (mPos < mEnd && *mPos >= '0' && *mPos <= '9')
+         {
+            unsigned int digit = *mPos - '0';
+            if (magnitude > (Json::Value::maxLargestUInt - digit) / 10)
+               overflow = true;
+            else
+               magnitude = magnitude * 10 + digit;
+            ++mPos;
+         }
+         if (mPos == digits)
+            return false;
+
+         bool isInteger = true;
+         if (mPos < mEnd && *mPos == '.')
+         {
+            isInteger = false;
+            ++mPos;
+            const char* fraction = mPos;
+            while (mPos < mEnd && *mPos >= '0' && *mPos <= '9')
+               ++mPos;
+            if (mPos == fraction)
+               return false;
+         }
+         if (mPos < mEnd && (*mPos == 'e' || *mPos == 'E'))
+         {
+            isInteger = false;
+            ++mPos;
+            if (mPos < mEnd && (*mPos == '+' || *mPos == '-'))
+               ++mPos;
+            const char* exponent = mPos;
+            while (mPos < mEnd && *mPos >= '0' && *mPos <= '9')
+               ++mPos;
+            if (mPos == exponent)
+               return false;
+         }
+
+         if (isInteger && !overflow)
+         {
+            if (!negative && magnitude <= (Json::LargestUInt)Json::Value::maxLargestInt)
+            {
+               out = (Json::LargestInt)magnitude;
+               return true;
+            }
+            if (!negative)
+            {
+               out = magnitude;
+               return true;
+            }
+            if (magnitude <= (Json::LargestUInt)Json::Value::maxLargestInt + 1)
+            {
+               out = (Json::LargestInt)(0 - magnitude);
+               return true;
+            }
+         }
+
+         //not locale dependent, unlike strtod
+         mNumberScratch.assign(start, mPos);
+         auto text = juce::CharPointer_UTF8(mNumberScratch.c_str());
+         out = juce::CharacterFunctions::readDoubleValue(text);
+         return true;
+      }
+
+      const char* mPos;
+      const char* mEnd;
+      std::string mKeyScratch;
+      std::string mValueScratch;
+      std::string mNumberScratch;
+   };
+
+   //writes straight to a stream, rather than building the whole document as a string first.
+   //the output is the same as jsoncpp's StreamWriterBuilder: pretty is "indentation" set to three spaces, otherwise it's its default tab
+   class JsonStreamWriter
+   {
+   public:
+      JsonStreamWriter(juce::OutputStream& out, bool pretty)
+      : mOut(out)
+      , mIndentation(pretty ? "   " : "\t")
+      {
+      }
+
+      void Write(const Json::Value& value)
+      {
+         mIndented = true;
+         WriteValue(value);
+      }
+
+   private:
+      void WriteValue(const Json::Value& value)
+      {
+         switch (value.type())
+         {
+            case Json::nullValue:
+               Write("null");
+               break;
+            case Json::intValue:
+               Write(juce::String(value.asLargestInt()));
+               break;
+            case Json::uintValue:
+               Write(juce::String(value.asLargestUInt()));
+               break;
+            case Json::realValue:
+               WriteDouble(value.asDouble());
+               break;
+            case Json::stringValue:
+            {
+               const char* begin;
+               const char* end;
+               value.getString(&begin, &end);
+               WriteString(begin, end);
+               break;
+            }
+            case Json::booleanValue:
+               Write(value.asBool() ? "true" : "false");
+               break;
+            case Json::arrayValue:
+               WriteArray(value);
+               break;
+            case Json::objectValue:
+               WriteObject(value);
+               break;
+         }
+      }
+
+      void WriteObject(const Json::Value& value)
+      {
+         if (value.empty())
+         {
+            Write("{}");
+            return;
+         }
+
+         WriteWithIndent("{");
+         ++mDepth;
+         for (auto it = value.begin(); it != value.end(); ++it)
+         {
+            if (it != value.begin())
+               mOut.writeByte(',');
+            if (!mIndented)
+               WriteIndent();
+            const char* keyEnd = nullptr;
+            const char* key = it.memberName(&keyEnd);
+            WriteString(key, keyEnd);
+            mIndented = false;
+            Write(" : ");
+            WriteValue(*it);
+         }
+         --mDepth;
+         WriteWithIndent("}");
+      }
+
+      void WriteArray(const Json::Value& value)
+      {
+         if (value.empty())
+         {
+            Write("[]");
+            return;
+         }
+
+         WriteWithIndent("[");
+         ++mDepth;
+         for (Json::ArrayIndex i = 0; i < value.size(); ++i)
+         {
+            if (i > 0)
+               mOut.writeByte(',');
+            if (!mIndented)
+               WriteIndent();
+            mIndented = true;
+            WriteValue(value[i]);
+            mIndented = false;
+         }
+         --mDepth;
+         WriteWithIndent("]");
+      }
+
+      void WriteDouble(double value)
+      {
+         if (std::isnan(value))
+         {
+            Write("null");
+            return;
+         }
+         if (std::isinf(value))
+         {
+            Write(value < 0 ? "-1e+9999" : "1e+9999");
+            return;
+         }
+
+         char buffer[32];
+         int length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+         bool hasPoint = false;
+         for (int i = 0; i < length; ++i)
+         {
+            if (buffer[i] == ',')
+               buffer[i] = '.'; //whatever the locale's decimal separator is
+            if (buffer[i] == '.' || buffer[i] == 'e')
+               hasPoint = true;
+         }
+         mOut.write(buffer, length);
+         if (!hasPoint)
+            Write(".0"); //so it reads back as a double
+      }
+
+      //non-ascii goes out as \\u escapes, like jsoncpp does by default
+      void WriteString(const char* begin, const char* end)
+      {
+         mOut.writeByte('"');
+         const char* run = begin;
+         for (const char* c = begin; c < end;)
+         {
+            unsigned char ch = (unsigned char)*c;
+            if (ch >= 0x20 && ch < 0x80 && ch != '"' && ch != '\\')
+            {
+               ++c;
+               continue;
+            }
+
+            mOut.write(run, c - run);
+            switch (ch)
+            {
+               case '"': Write("\\\""); break;
+               case '\\': Write("\\\\"); break;
+               case '\b': Write("\\b"); break;
+               case '\f': Write("\\f"); break;
+               case '\n': Write("\\n"); break;
+               case '\r': Write("\\r"); break;
+               case '\t': Write("\\t"); break;
+               default:
+               {
+                  if (ch < 0x80)
+                  {
+                     WriteEscaped(ch);
+                     break;
+                  }
+                  unsigned int codepoint = DecodeUTF8(c, end);
+                  if (codepoint >= 0x10000)
+                  {
+                     codepoint -= 0x10000;
+                     WriteEscaped(0xD800 + (codepoint >> 10));
+                     WriteEscaped(0xDC00 + (codepoint & 0x3FF));
+                  }
+                  else
+                  {
+                     WriteEscaped(codepoint);
+                  }
+                  run = c;
+                  continue;
+               }
+            }
+            ++c;
+            run = c;
+         }
+         mOut.write(run, end - run);
+         mOut.writeByte('"');
+      }
+
+      //advances c past the sequence, a broken one comes out as U+FFFD
+      static unsigned int DecodeUTF8(const char*& c, const char* end)
+      {
+         unsigned char first = (unsigned char)*c;
+         int length = (first & 0xE0) == 0xC0 ? 2 : (first & 0xF0) == 0xE0 ? 3 : (first & 0xF8) == 0xF0 ? 4 : 0;
+         if (length == 0 || end - c < length)
+         {
+            ++c;
+            return 0xFFFD;
+         }
+         unsigned int codepoint = first & (0x7F >> length);
+         for (int i = 1; i < length; ++i)
+         {
+            unsigned char next = (unsigned char)c[i];
+            if ((next & 0xC0) != 0x80)
+            {
+               ++c;
+               return 0xFFFD;
+            }
+            codepoint = (codepoint << 6) | (next & 0x3F);
+         }
+         c += length;
+         return codepoint;
+      }
+
+      void WriteEscaped(unsigned int codeUnit)
+      {
+         char escaped[8];
+         snprintf(escaped, sizeof(escaped), "\\u%04x", codeUnit & 0xFFFF);
+         Write(escaped);
+      }
+
+      void WriteWithIndent(const char* text)
+      {
+         if (!mIndented)
+            WriteIndent();
+         Write(text);
+         mIndented = false;
+      }
+
+      void WriteIndent()
+      {
+         mOut.writeByte('\n');
+         for (int i = 0; i < mDepth; ++i)
+            Write(mIndentation);
+      }
+
+      void Write(const char* text) { mOut.write(text, strlen(text)); }
+      void Write(const juce::String& text) { mOut.write(text.toRawUTF8(), text.getNumBytesAsUTF8()); }
+
+      juce::OutputStream& mOut;
+      const char* mIndentation;
+      int mDepth{ 0 };
+      bool mIndented{ false }; //already at the start of a line, so the next bracket doesn't get one of its own
+   };
+}
+
 
 //--------------------------------------------------------------
 ofxJSONElement::ofxJSONElement(const Json::Value& v)
@@ -33,14 +641,27 @@ ofxJSONElement::ofxJSONElement(std::string jsonString)
 
 
 //--------------------------------------------------------------
-bool ofxJSONElement::parse(std::string jsonString)
+bool ofxJSONElement::parse(const std::string& jsonString)
+{
+   return parse(jsonString.data(), jsonString.data() + jsonString.size());
+}
+
+
+//--------------------------------------------------------------
+bool ofxJSONElement::parse(const char* begin, const char* end)
 {
+   Json::Value root;
+   if (JsonFastReader(begin, end).Parse(root))
+   {
+      swap(root);
+      return true;
+   }
+
+   //let jsoncpp have a go, for whatever the fast reader doesn't take, and for its error message
    CharReaderBuilder rb;
    auto reader = std::unique_ptr<Json::CharReader>(rb.newCharReader());
    Json::String errors;
-   if (!reader->parse(jsonString.c_str(),
-                      jsonString.c_str() + jsonString.size(),
-                      this, &errors))
+   if (!reader->parse(begin, end, this, &errors))
    {
       ofLog() << "Unable to parse string: " << errors;
       return false;
@@ -56,13 +677,8 @@ bool ofxJSONElement::open(std::string filename)
 
    if (file.exists())
    {
-      juce::String str = file.loadFileAsString();
-
-      CharReaderBuilder builder;
-      auto reader = std::unique_ptr<CharReader>(builder.newCharReader());
-      auto mS = str.toStdString();
-
-      if (!reader->parse(mS.c_str(), mS.c_str() + mS.size(), this, nullptr))
+      juce::MemoryBlock data;
+      if (!file.loadFileAsData(data) || !parse((const char*)data.getData(), (const char*)data.getData() + data.getSize()))
       {
          ofLog() << "Unable to parse " + filename;
          return false;
@@ -90,14 +706,28 @@ bool ofxJSONElement::save(std::string filename, bool pretty)
       return false;
    }
 
-   Json::StreamWriterBuilder builder;
-
-   if (pretty)
+   //written to a temporary file next to it and swapped in, the same as juce's replaceWithText() does
+   juce::TemporaryFile temp(file);
+   {
+      juce::FileOutputStream out(temp.getFile());
+      if (out.failedToOpen())
+      {
+         ofLog() << "Unable to write " + filename;
+         return false;
+      }
+      JsonStreamWriter(out, pretty).Write(*this);
+      out.flush();
+      if (out.getStatus().failed())
+      {
+         ofLog() << "Unable to write " + filename;
+         return false;
+      }
+   }
+   if (!temp.overwriteTargetFileWithTemporary())
    {
-      builder["indentation"] = "   ";
+      ofLog() << "Unable to write " + filename;
+      return false;
    }
-   const std::string json_file = Json::writeString(builder, *this);
-   file.replaceWithText(json_file);
 
    ofLog() << "JSON saved to " + filename;
    return true;
@@ -107,13 +737,7 @@ bool ofxJSONElement::save(std::string filename, bool pretty)
 //--------------------------------------------------------------
 std::string ofxJSONElement::getRawString(bool pretty)
 {
-   std::string raw;
-   Json::StreamWriterBuilder builder;
-
-   if (pretty)
-   {
-      builder["indentation"] = "   ";
-   }
-   raw = Json::writeString(builder, *this);
-   return raw;
+   juce::MemoryOutputStream out;
+   JsonStreamWriter(out, pretty).Write(*this);
+   return std::string((const char*)out.getData(), out.getDataSize());
 }
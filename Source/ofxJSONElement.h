@@ -22,7 +22,8 @@ public:
    ofxJSONElement(std::string jsonString);
    ofxJSONElement(const Json::Value& v);
 
-   bool parse(std::string jsonString);
+   bool parse(const std::string& jsonString);
+   bool parse(const char* begin, const char* end);
    bool open(std::string filename);
    bool save(std::string filename, bool pretty = false);
    std::string getRawString(bool pretty = true);
@@ -0,0 +1,182 @@
+#!/usr/bin/env node
+/**
+ * Runs the WASM benchmarks in headless Chromium and compares builds
+ *
+ * Serves each build directory, opens BespokeSynthWASM_bench<suffix>.html in it and waits for
+ * the page to post its results back. With both the scalar and the SIMD build this also
+ * reports the SIMD speedup per kernel.
+ *
+ * Build the benchmarks first with:
+ *   emcmake cmake wasm -B wasm/build -DBESPOKE_WASM_BENCH=ON -DBESPOKE_WASM_SIMD=OFF
+ *   emcmake cmake wasm -B wasm/build-simd -DBESPOKE_WASM_BENCH=ON -DBESPOKE_WASM_SIMD=ON -DBESPOKE_WASM_OUTPUT_SUFFIX=-simd
+ *
+ * Usage: node scripts/run-wasm-bench.js [--scalar <dir>] [--simd <dir>] [--out <file>] [--timeout <seconds>]
+ * Set CHROME_BIN to pick the browser.
+ */
+
+const { spawn, execSync } = require('child_process');
+const fs = require('fs');
+const http = require('http');
+const os = require('os');
+const path = require('path');
+
+const rootDir = path.join(__dirname, '..');
+
+const MIME_TYPES = {
+  '.html': 'text/html',
+  '.js': 'text/javascript',
+  '.wasm': 'application/wasm',
+  '.data': 'application/octet-stream',
+  '.json': 'application/json',
+};
+
+function parseArgs(argv) {
+  const args = {
+    scalar: path.join(rootDir, 'wasm', 'build'),
+    simd: path.join(rootDir, 'wasm', 'build-simd'),
+    out: null,
+    timeout: 300,
+  };
+  for (let i = 0; i < argv.length; i += 2) {
+    const name = argv[i].replace(/^--/, '');
+    if (!(name in args) || i + 1 >= argv.length) {
+      console.error(`Unknown or incomplete option: ${argv[i]}`);
+      process.exit(1);
+    }
+    args[name] = name === 'timeout' ? Number(argv[i + 1]) : argv[i + 1];
+  }
+  return args;
+}
+
+function findChrome() {
+  if (process.env.CHROME_BIN) return process.env.CHROME_BIN;
+  const candidates = ['chromium', 'chromium-browser', 'google-chrome', 'google-chrome-stable'];
+  for (const candidate of candidates) {
+    try {
+      execSync(`command -v ${candidate}`, { stdio: 'ignore', shell: true });
+      return candidate;
+    } catch (error) {
+      // not installed, try the next one
+    }
+  }
+  return null;
+}
+
+// Serves dir and resolves with the JSON the page posts to /report
+function runInBrowser(chrome, dir, page, timeoutSeconds) {
+  return new Promise((resolve, reject) => {
+    let browser = null;
+    let timer = null;
+    const profileDir = fs.mkdtempSync(path.join(os.tmpdir(), 'bespoke-bench-'));
+
+    const finish = (error, result) => {
+      clearTimeout(timer);
+      if (browser) browser.kill();
+      server.close();
+      fs.rmSync(profileDir, { recursive: true, force: true });
+      if (error) reject(error);
+      else resolve(result);
+    };
+
+    const server = http.createServer((request, response) => {
+      const url = new URL(request.url, 'http://localhost');
+      if (request.method === 'POST' && url.pathname === '/report') {
+        let body = '';
+        request.on('data', (chunk) => (body += chunk));
+        request.on('end', () => {
+          response.end();
+          try {
+            finish(null, JSON.parse(body));
+          } catch (error) {
+            finish(new Error(`Invalid results from ${page}: ${error.message}`));
+          }
+        });
+        return;
+      }
+
+      const file = path.join(dir, path.normalize(decodeURIComponent(url.pathname)));
+      if (!file.startsWith(dir) || !fs.existsSync(file) || fs.statSync(file).isDirectory()) {
+        response.statusCode = 404;
+        response.end();
+        return;
+      }
+      response.setHeader('Content-Type', MIME_TYPES[path.extname(file)] || 'application/octet-stream');
+      fs.createReadStream(file).pipe(response);
+    });
+
+    server.listen(0, '127.0.0.1', () => {
+      const port = server.address().port;
+      const url = `http://127.0.0.1:${port}/${page}?report=/report`;
+      console.error(`Running ${url}`);
+
+      browser = spawn(chrome, [
+        '--headless=new',
+        '--no-sandbox',
+        '--no-first-run',
+        '--enable-unsafe-webgpu',
+        '--enable-features=Vulkan',
+        `--user-data-dir=${profileDir}`,
+        url,
+      ], { stdio: 'ignore' });
+      browser.on('error', (error) => finish(new Error(`Failed to start ${chrome}: ${error.message}`)));
+
+      timer = setTimeout(() => finish(new Error(`${page} did not report within ${timeoutSeconds}s`)), timeoutSeconds * 1000);
+    });
+  });
+}
+
+function compare(scalar, simd) {
+  const key = (kernel) => `${kernel.name}@${kernel.bufferSize}`;
+  const scalarKernels = new Map(scalar.kernels.map((kernel) => [key(kernel), kernel]));
+  return simd.kernels
+    .filter((kernel) => scalarKernels.has(key(kernel)))
+    .map((kernel) => ({
+      name: kernel.name,
+      bufferSize: kernel.bufferSize,
+      speedup: Number((scalarKernels.get(key(kernel)).nsPerSample / kernel.nsPerSample).toFixed(3)),
+    }));
+}
+
+async function main() {
+  const args = parseArgs(process.argv.slice(2));
+  const chrome = findChrome();
+  if (!chrome) {
+    console.error('No Chromium found, set CHROME_BIN');
+    process.exit(1);
+  }
+
+  const builds = [
+    { name: 'scalar', dir: args.scalar, page: 'BespokeSynthWASM_bench.html' },
+    { name: 'simd', dir: args.simd, page: 'BespokeSynthWASM_bench-simd.html' },
+  ];
+
+  const results = {};
+  for (const build of builds) {
+    if (!fs.existsSync(path.join(build.dir, build.page))) {
+      console.error(`Skipping ${build.name}, ${build.page} not found in ${build.dir}`);
+      continue;
+    }
+    results[build.name] = await runInBrowser(chrome, path.resolve(build.dir), build.page, args.timeout);
+  }
+
+  if (!results.scalar && !results.simd) {
+    console.error('No benchmark builds found (configure with -DBESPOKE_WASM_BENCH=ON)');
+    process.exit(1);
+  }
+  if (results.scalar && results.simd) {
+    results.simdSpeedup = compare(results.scalar, results.simd);
+  }
+
+  const json = JSON.stringify(results, null, 2);
+  if (args.out) {
+    fs.writeFileSync(args.out, json + '\n');
+    console.error(`Results written to ${args.out}`);
+  } else {
+    console.log(json);
+  }
+}
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exit(1);
+});
@@ -6,12 +6,100 @@
  */
 
 import './styles.css';
+import { SamplePipeline } from './sample-pipeline';
 
-// Load WASM module script dynamically
+// Smallest module using a v128 instruction, it only validates when the browser supports wasm SIMD
+const SIMD_PROBE = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11,
+]);
+
+const supportsWasmSimd = (): boolean => {
+  try {
+    return WebAssembly.validate(SIMD_PROBE);
+  } catch {
+    return false;
+  }
+};
+
+const WASM_CACHE_PREFIX = 'bespoke-wasm-';
+
+// Hash of the current build, written next to the binaries by wasm/build.sh. null if there is no manifest
+const fetchBuildHash = async (): Promise<string | null> => {
+  try {
+    const response = await fetch('wasm/build-manifest.json', { cache: 'no-cache' });
+    if (!response.ok) return null;
+    const manifest = await response.json();
+    return typeof manifest.hash === 'string' ? manifest.hash : null;
+  } catch {
+    return null;
+  }
+};
+
+// Fetch a binary through Cache Storage, one cache per build hash. Browsers keep the compiled
+// code alongside cached wasm responses, so a repeat visit instantiates without recompiling
+const fetchWasmBinary = async (url: string, buildHash: string | null): Promise<Response> => {
+  if (buildHash === null || typeof caches === 'undefined') return fetch(url);
+
+  const cacheName = WASM_CACHE_PREFIX + buildHash;
+  try {
+    const cache = await caches.open(cacheName);
+    const cached = await cache.match(url);
+    if (cached) return cached;
+
+    const response = await fetch(url);
+    if (response.ok) {
+      // Don't wait on the cache write, streaming compilation can start right away
+      cache
+        .put(url, response.clone())
+        .then(() => caches.keys())
+        .then((keys) =>
+          Promise.all(keys.filter((key) => key.startsWith(WASM_CACHE_PREFIX) && key !== cacheName).map((key) => caches.delete(key)))
+        )
+        .catch((err) => console.warn('fetchWasmBinary: failed to cache', url, err));
+    }
+    return response;
+  } catch (err) {
+    console.warn('fetchWasmBinary: Cache Storage unavailable, fetching directly', err);
+    return fetch(url);
+  }
+};
+
+const instantiateWasmBinary = async (
+  url: string,
+  buildHash: string | null,
+  imports: WebAssembly.Imports
+): Promise<WebAssembly.WebAssemblyInstantiatedSource> => {
+  const response = await fetchWasmBinary(url, buildHash);
+  if (!response.ok) {
+    throw new Error(`Failed to fetch ${url}: ${response.status}`);
+  }
+
+  // Streaming compilation needs the right MIME type, some static servers don't send it
+  if (response.headers.get('Content-Type')?.startsWith('application/wasm')) {
+    return WebAssembly.instantiateStreaming(response, imports);
+  }
+  console.warn(`instantiateWasmBinary: ${url} is not served as application/wasm, compiling from a buffer`);
+  return WebAssembly.instantiate(await response.arrayBuffer(), imports);
+};
+
+// Load WASM module script dynamically, preferring the SIMD build when the browser can run it
 const loadWasmModule = async (canvas?: HTMLCanvasElement): Promise<any> => {
+  const buildHash = await fetchBuildHash();
+  if (supportsWasmSimd()) {
+    try {
+      return await loadWasmVariant('wasm/BespokeSynthWASM-simd.js', buildHash, canvas);
+    } catch (err) {
+      console.warn('loadWasmModule: SIMD build failed to load, falling back to the scalar build', err);
+    }
+  }
+  return loadWasmVariant('wasm/BespokeSynthWASM.js', buildHash, canvas);
+};
+
+const loadWasmVariant = async (src: string, buildHash: string | null, canvas?: HTMLCanvasElement): Promise<any> => {
+  const wasmUrl = src.replace(/\.js$/, '.wasm');
   return new Promise((resolve, reject) => {
     const script = document.createElement('script');
-    script.src = 'wasm/BespokeSynthWASM.js';
+    script.src = src;
     script.onload = async () => {
       console.log('loadWasmModule: script loaded');
       // If the build was modularized, a factory function will be exposed
@@ -22,6 +110,19 @@ const loadWasmModule = async (canvas?: HTMLCanvasElement): Promise<any> => {
           canvas: canvas ?? document.getElementById('canvas'),
           print: (text: any) => console.log(text),
           printErr: (text: any) => console.error(text),
+          // Replaces Emscripten's own fetch so the binary goes through the build hash cache
+          instantiateWasm: (
+            imports: WebAssembly.Imports,
+            receiveInstance: (instance: WebAssembly.Instance, module: WebAssembly.Module) => void
+          ) => {
+            instantiateWasmBinary(wasmUrl, buildHash, imports)
+              .then(({ instance, module }) => receiveInstance(instance, module))
+              .catch((err) => {
+                console.error('loadWasmModule: failed to instantiate', wasmUrl, err);
+                reject(err);
+              });
+            return {};
+          },
         };
 
         try {
@@ -50,17 +151,34 @@ const loadWasmModule = async (canvas?: HTMLCanvasElement): Promise<any> => {
         };
       }
     };
-    script.onerror = () => reject(new Error('Failed to load WASM module'));
+    script.onerror = () => {
+      script.remove();
+      reject(new Error(`Failed to load WASM module ${src}`));
+    };
     document.head.appendChild(script);
   });
 };
 
+// UI frame rate steps for when the audio thread is busy. A step is entered once the audio
+// CPU load (callback time over buffer period) goes above enterLoad, and left once it drops
+// below exitLoad, so the frame rate doesn't flip back and forth around one threshold
+const THROTTLE_LEVELS = [
+  { enterLoad: 0.7, exitLoad: 0.55, minFrameMs: 1000 / 30 },
+  { enterLoad: 0.85, exitLoad: 0.7, minFrameMs: 1000 / 15 },
+];
+
 // Main application class
 class BespokeSynthApp {
   private canvas: HTMLCanvasElement | null = null;
   private module: any = null;
   private animationFrameId: number | null = null;
   private isInitialized = false;
+  private canvasVisible = true;
+  private visibilityObserver: IntersectionObserver | null = null;
+  private lastFrameTime = 0;
+  private throttleLevel = 0;
+  // Loads samples for the engine, see sample-pipeline.ts
+  samples: SamplePipeline | null = null;
 
   async init(): Promise<void> {
     console.log('Initializing BespokeSynth WASM...');
@@ -95,8 +213,10 @@ class BespokeSynthApp {
 
       if (result === 0) {
         this.isInitialized = true;
+        this.samples = new SamplePipeline(this.module, sampleRate);
         this.showStatus('Ready!');
         this.setupEventListeners();
+        this.setupFrameScheduling();
         this.startRenderLoop();
         console.log('BespokeSynth initialized successfully');
       } else if (result === 1) {
@@ -129,8 +249,10 @@ class BespokeSynthApp {
 
         // Now initialization completed successfully
         this.isInitialized = true;
+        this.samples = new SamplePipeline(this.module, sampleRate);
         this.showStatus('Ready!');
         this.setupEventListeners();
+        this.setupFrameScheduling();
         this.startRenderLoop();
         console.log('BespokeSynth initialized successfully (async)');
       } else {
@@ -172,9 +294,14 @@ class BespokeSynthApp {
       }
     });
 
-    this.canvas.addEventListener('mousemove', (e) => {
+    // Pointer events carry the intermediate positions the browser merged into this event,
+    // WASM queues them while a button is held so knob drags follow the exact path
+    this.canvas.addEventListener('pointermove', (e) => {
       if (this.module._bespoke_mouse_move) {
-        this.module._bespoke_mouse_move(e.offsetX, e.offsetY);
+        const events = e.getCoalescedEvents?.() ?? [];
+        for (const move of events.length > 0 ? events : [e]) {
+          this.module._bespoke_mouse_move(move.offsetX, move.offsetY);
+        }
       }
     });
 
@@ -234,12 +361,60 @@ class BespokeSynthApp {
     return modifiers;
   }
 
+  // Rendering only runs while the page is visible and the canvas is on screen. Audio runs in
+  // its own callback and keeps going either way
+  private setupFrameScheduling(): void {
+    document.addEventListener('visibilitychange', () => this.updateRenderLoop());
+
+    if (this.canvas && typeof IntersectionObserver !== 'undefined') {
+      this.visibilityObserver = new IntersectionObserver((entries) => {
+        this.canvasVisible = entries[entries.length - 1].isIntersecting;
+        this.updateRenderLoop();
+      });
+      this.visibilityObserver.observe(this.canvas);
+    }
+  }
+
+  private shouldRender(): boolean {
+    return this.isInitialized && !document.hidden && this.canvasVisible;
+  }
+
+  private updateRenderLoop(): void {
+    if (this.shouldRender()) {
+      this.startRenderLoop();
+    } else {
+      this.stopRenderLoop();
+    }
+  }
+
+  private updateThrottle(): void {
+    const load = this.module?._bespoke_get_cpu_load?.() ?? 0;
+    const previous = this.throttleLevel;
+    while (this.throttleLevel < THROTTLE_LEVELS.length && load > THROTTLE_LEVELS[this.throttleLevel].enterLoad) {
+      this.throttleLevel++;
+    }
+    while (this.throttleLevel > 0 && load < THROTTLE_LEVELS[this.throttleLevel - 1].exitLoad) {
+      this.throttleLevel--;
+    }
+    if (this.throttleLevel !== previous) {
+      const fps = this.throttleLevel > 0 ? Math.round(1000 / THROTTLE_LEVELS[this.throttleLevel - 1].minFrameMs) : 'display rate';
+      console.log(`Render loop: audio load ${load.toFixed(2)}, rendering at ${fps}`);
+    }
+  }
+
   private startRenderLoop(): void {
-    if (this.animationFrameId !== null) return;
+    if (this.animationFrameId !== null || !this.shouldRender()) return;
 
-    const renderFrame = () => {
-      if (this.module?._bespoke_render) {
-        this.module._bespoke_render();
+    const renderFrame = (time: number) => {
+      this.updateThrottle();
+      const minFrameMs = this.throttleLevel > 0 ? THROTTLE_LEVELS[this.throttleLevel - 1].minFrameMs : 0;
+
+      // A millisecond of slack keeps a throttled rate on the display's frame grid
+      if (time - this.lastFrameTime >= minFrameMs - 1) {
+        this.lastFrameTime = time;
+        if (this.module?._bespoke_render) {
+          this.module._bespoke_render();
+        }
       }
       this.animationFrameId = requestAnimationFrame(renderFrame);
     };
@@ -270,6 +445,10 @@ class BespokeSynthApp {
 
   shutdown(): void {
     this.stopRenderLoop();
+    this.visibilityObserver?.disconnect();
+    this.visibilityObserver = null;
+    this.samples?.shutdown();
+    this.samples = null;
     if (this.module?._bespoke_shutdown) {
       this.module._bespoke_shutdown();
     }
@@ -277,8 +456,18 @@ class BespokeSynthApp {
   }
 }
 
+// The service worker pre-caches resource/ fonts and samples, see src/service-worker.js
+const registerServiceWorker = (): void => {
+  if (!('serviceWorker' in navigator)) return;
+  navigator.serviceWorker.register('sw.js').catch((err) => {
+    console.warn('Service worker registration failed', err);
+  });
+};
+
 // Start the application when DOM is ready
 document.addEventListener('DOMContentLoaded', async () => {
+  registerServiceWorker();
+
   const app = new BespokeSynthApp();
   
   try {
@@ -0,0 +1,165 @@
+/**
+ * Sample pipeline
+ *
+ * Loads samples through the decoding worker (sample-worker.ts) and pages
+ * their frames into wasm as the engine asks for them. The wasm side of this
+ * is SampleStore (wasm/include/BespokeWasm/SampleStore.h): short samples are
+ * copied in whole right after loading, long ones are streamed in blocks,
+ * and an engine read of a block that isn't in yet is silent rather than
+ * waiting on this.
+ */
+
+import type { SampleWorkerRequest, SampleWorkerResponse } from './sample-worker';
+
+// Pumps on its own timer rather than the render loop, so samples keep streaming while the canvas isn't drawn
+const PUMP_INTERVAL_MS = 20;
+const REQUEST_WORDS = 6; // SampleStore::kRequestWords
+
+interface PendingLoad {
+  url: string;
+  resolve: (id: number) => void;
+  reject: (err: Error) => void;
+}
+
+interface LoadedSample {
+  key: string;
+}
+
+interface PendingRead {
+  id: number;
+  sample: LoadedSample;
+  slot: number;
+  startFrame: number;
+  stride: number;
+  pointer: number;
+}
+
+export class SamplePipeline {
+  private worker: Worker;
+  private pumpId: number;
+  private nextRequestId = 0;
+  private pendingLoads = new Map<number, PendingLoad>();
+  private pendingReads = new Map<number, PendingRead>();
+  private samples = new Map<number, LoadedSample>();
+  private keyRefs = new Map<string, number>();
+
+  // sampleRate is the engine's, what decodeAudioData resamples to for the formats the worker can't parse
+  constructor(private module: any, private sampleRate: number) {
+    this.worker = new Worker(new URL('./sample-worker.ts', import.meta.url));
+    this.worker.onmessage = (event: MessageEvent<SampleWorkerResponse>) => this.onWorkerMessage(event.data);
+    this.pumpId = window.setInterval(() => this.pump(), PUMP_INTERVAL_MS);
+  }
+
+  // Resolves with the SampleStore id to play the sample by
+  load(url: string): Promise<number> {
+    const requestId = this.nextRequestId++;
+    return new Promise((resolve, reject) => {
+      this.pendingLoads.set(requestId, { url, resolve, reject });
+      this.post({ type: 'load', requestId, url: new URL(url, document.baseURI).href });
+    });
+  }
+
+  release(id: number): void {
+    const sample = this.samples.get(id);
+    if (!sample) return;
+    this.samples.delete(id);
+    this.module._bespoke_sample_release(id);
+
+    const refs = (this.keyRefs.get(sample.key) ?? 1) - 1;
+    if (refs > 0) {
+      this.keyRefs.set(sample.key, refs);
+    } else {
+      this.keyRefs.delete(sample.key);
+      this.post({ type: 'close', key: sample.key });
+    }
+  }
+
+  shutdown(): void {
+    window.clearInterval(this.pumpId);
+    this.worker.terminate();
+    this.pendingLoads.forEach((load) => load.reject(new Error('Sample pipeline shut down')));
+    this.pendingLoads.clear();
+    this.pendingReads.clear();
+  }
+
+  private post(message: SampleWorkerRequest, transfer: Transferable[] = []): void {
+    this.worker.postMessage(message, transfer);
+  }
+
+  private pump(): void {
+    const count = this.module._bespoke_sample_take_requests();
+    if (count === 0) return;
+
+    // Views are taken per pump, they're replaced whenever wasm memory grows
+    const base = this.module._bespoke_sample_get_requests() >> 2;
+    const requests = this.module.HEAPU32.slice(base, base + count * REQUEST_WORDS) as Uint32Array;
+    for (let i = 0; i < count; ++i) {
+      const [id, slot, startFrame, frames, stride, pointer] = requests.subarray(i * REQUEST_WORDS, (i + 1) * REQUEST_WORDS);
+      const sample = this.samples.get(id);
+      if (!sample) continue;
+
+      const readId = this.nextRequestId++;
+      this.pendingReads.set(readId, { id, sample, slot, startFrame, stride, pointer });
+      this.post({ type: 'read', readId, key: sample.key, startFrame, frames });
+    }
+  }
+
+  private onWorkerMessage(message: SampleWorkerResponse): void {
+    switch (message.type) {
+      case 'loaded': {
+        const load = this.pendingLoads.get(message.requestId);
+        if (!load) return;
+        this.pendingLoads.delete(message.requestId);
+
+        const id = this.module._bespoke_sample_create(message.numChannels, message.numFrames, message.sampleRate);
+        if (id < 0) {
+          if (!this.keyRefs.has(message.key)) this.post({ type: 'close', key: message.key });
+          load.reject(new Error(`No room for ${load.url}`));
+          return;
+        }
+        this.samples.set(id, { key: message.key });
+        this.keyRefs.set(message.key, (this.keyRefs.get(message.key) ?? 0) + 1);
+        load.resolve(id);
+        break;
+      }
+      case 'decode':
+        this.decode(message.requestId, message.validator, message.data);
+        break;
+      case 'error': {
+        const load = this.pendingLoads.get(message.requestId);
+        this.pendingLoads.delete(message.requestId);
+        load?.reject(new Error(message.message));
+        break;
+      }
+      case 'data': {
+        const read = this.pendingReads.get(message.readId);
+        this.pendingReads.delete(message.readId);
+        // Released, or the id already belongs to another sample
+        if (!read || !message.channels || this.samples.get(read.id) !== read.sample) return;
+
+        const heap = this.module.HEAPF32 as Float32Array;
+        message.channels.forEach((channel, index) => heap.set(channel, (read.pointer >> 2) + index * read.stride));
+        this.module._bespoke_sample_block_ready(read.id, read.slot, read.startFrame);
+        break;
+      }
+    }
+  }
+
+  // Formats the worker can't parse. decodeAudioData only exists on the main thread
+  private async decode(requestId: number, validator: string, data: ArrayBuffer): Promise<void> {
+    const load = this.pendingLoads.get(requestId);
+    if (!load) return;
+    try {
+      const context = new OfflineAudioContext(1, 1, this.sampleRate);
+      const buffer = await context.decodeAudioData(data);
+      const channels = Array.from({ length: buffer.numberOfChannels }, (_, index) => buffer.getChannelData(index).slice());
+      this.post(
+        { type: 'store', requestId, url: new URL(load.url, document.baseURI).href, validator, sampleRate: buffer.sampleRate, channels },
+        channels.map((channel) => channel.buffer)
+      );
+    } catch (err) {
+      this.pendingLoads.delete(requestId);
+      load.reject(new Error(`Couldn't decode ${load.url}: ${err instanceof Error ? err.message : String(err)}`));
+    }
+  }
+}
@@ -0,0 +1,366 @@
+/**
+ * Sample decoding worker
+ *
+ * Fetches and decodes samples off the main thread, and keeps the decoded
+ * floats in an OPFS cache so a sample only gets decoded once, not on every
+ * load. SamplePipeline (sample-pipeline.ts) then reads blocks of frames out
+ * of the cache as wasm asks for them (see wasm/include/BespokeWasm/SampleStore.h).
+ *
+ * Cache files live in the OPFS directory "samples", one per url, named after
+ * a SHA-256 of the url:
+ *   header: "BSMP", version, numChannels, numFrames, sampleRate, validator
+ *           length, validator (UTF-8), padded to a multiple of 4 bytes
+ *   data:   numChannels planar float32 channels of numFrames each
+ * The validator is the ETag, or Last-Modified and Content-Length, so the file
+ * is decoded again if the server has a different one.
+ *
+ * WAV is parsed here. Everything else goes back to the main thread to be
+ * decoded, since decodeAudioData is only available there, and comes back as
+ * a 'store' message to be cached.
+ */
+
+const CACHE_DIRECTORY = 'samples';
+const CACHE_MAGIC = 0x504d5342; // "BSMP"
+const CACHE_VERSION = 1;
+const CACHE_HEADER_WORDS = 6;
+const CACHE_MAX_BYTES = 1024 * 1024 * 1024;
+const WRITE_CHUNK_FRAMES = 1 << 16;
+
+export type SampleWorkerRequest =
+  | { type: 'load'; requestId: number; url: string }
+  | { type: 'store'; requestId: number; url: string; validator: string; sampleRate: number; channels: Float32Array[] }
+  | { type: 'read'; readId: number; key: string; startFrame: number; frames: number }
+  | { type: 'close'; key: string };
+
+export type SampleWorkerResponse =
+  | { type: 'loaded'; requestId: number; key: string; numChannels: number; numFrames: number; sampleRate: number }
+  | { type: 'decode'; requestId: number; validator: string; data: ArrayBuffer }
+  | { type: 'error'; requestId: number; message: string }
+  | { type: 'data'; readId: number; channels: Float32Array[] | null };
+
+// The parts of the worker and OPFS apis used here. The project compiles against the DOM lib only
+interface WorkerScope {
+  onmessage: ((event: MessageEvent<SampleWorkerRequest>) => void) | null;
+  postMessage(message: SampleWorkerResponse, transfer?: Transferable[]): void;
+}
+
+interface SyncAccessHandle {
+  read(buffer: ArrayBufferView, options?: { at: number }): number;
+  write(buffer: ArrayBufferView, options?: { at: number }): number;
+  truncate(size: number): void;
+  getSize(): number;
+  flush(): void;
+  close(): void;
+}
+
+interface CacheFileHandle {
+  getFile(): Promise<File>;
+  createSyncAccessHandle(): Promise<SyncAccessHandle>;
+}
+
+interface CacheDirectoryHandle {
+  getFileHandle(name: string, options?: { create: boolean }): Promise<CacheFileHandle>;
+  removeEntry(name: string): Promise<void>;
+  entries(): AsyncIterableIterator<[string, { kind: string }]>;
+}
+
+interface DecodedSample {
+  numChannels: number;
+  numFrames: number;
+  sampleRate: number;
+  // Either an open cache file, or the channels themselves when OPFS isn't available
+  handle: SyncAccessHandle | null;
+  dataOffset: number;
+  channels: Float32Array[] | null;
+}
+
+const scope = self as unknown as WorkerScope;
+const samples = new Map<string, DecodedSample>();
+let cacheDirectory: Promise<CacheDirectoryHandle | null> | null = null;
+
+const getCacheDirectory = (): Promise<CacheDirectoryHandle | null> => {
+  if (cacheDirectory === null) {
+    cacheDirectory = (async () => {
+      try {
+        const root = (await navigator.storage.getDirectory()) as unknown as {
+          getDirectoryHandle(name: string, options: { create: boolean }): Promise<CacheDirectoryHandle>;
+        };
+        return await root.getDirectoryHandle(CACHE_DIRECTORY, { create: true });
+      } catch (err) {
+        console.warn('sample-worker: OPFS unavailable, samples are kept in memory', err);
+        return null;
+      }
+    })();
+  }
+  return cacheDirectory;
+};
+
+const hashUrl = async (url: string): Promise<string> => {
+  const digest = await crypto.subtle.digest('SHA-256', new TextEncoder().encode(url));
+  return Array.from(new Uint8Array(digest), (byte) => byte.toString(16).padStart(2, '0')).join('');
+};
+
+const getValidator = (response: Response): string => {
+  const etag = response.headers.get('ETag');
+  if (etag) return etag;
+  return `${response.headers.get('Last-Modified') ?? ''};${response.headers.get('Content-Length') ?? ''}`;
+};
+
+// null when the server can't be reached, then whatever is cached is used as it is
+const fetchValidator = async (url: string): Promise<string | null> => {
+  try {
+    const response = await fetch(url, { method: 'HEAD', cache: 'no-cache' });
+    return response.ok ? getValidator(response) : null;
+  } catch {
+    return null;
+  }
+};
+
+const getDataOffset = (validatorBytes: number): number => (CACHE_HEADER_WORDS * 4 + validatorBytes + 3) & ~3;
+
+const openCached = async (directory: CacheDirectoryHandle, key: string, validator: string | null): Promise<DecodedSample | null> => {
+  let handle: SyncAccessHandle;
+  try {
+    handle = await (await directory.getFileHandle(key)).createSyncAccessHandle();
+  } catch {
+    return null;
+  }
+
+  const header = new Uint32Array(CACHE_HEADER_WORDS);
+  if (handle.read(header, { at: 0 }) === header.byteLength && header[0] === CACHE_MAGIC && header[1] === CACHE_VERSION) {
+    const cachedValidator = new Uint8Array(header[5]);
+    handle.read(cachedValidator, { at: header.byteLength });
+    const dataOffset = getDataOffset(cachedValidator.byteLength);
+    const complete = handle.getSize() === dataOffset + header[2] * header[3] * 4;
+    if (complete && (validator === null || new TextDecoder().decode(cachedValidator) === validator)) {
+      return { numChannels: header[2], numFrames: header[3], sampleRate: header[4], handle, dataOffset, channels: null };
+    }
+  }
+  handle.close();
+  return null;
+};
+
+const writeCached = async (
+  directory: CacheDirectoryHandle,
+  key: string,
+  validator: string,
+  sampleRate: number,
+  numChannels: number,
+  numFrames: number,
+  // Fills one channel's frames from start into out
+  readFrames: (channel: number, start: number, out: Float32Array) => void
+): Promise<DecodedSample> => {
+  await trimCache(directory, numChannels * numFrames * 4);
+  const handle = await (await directory.getFileHandle(key, { create: true })).createSyncAccessHandle();
+  const validatorBytes = new TextEncoder().encode(validator);
+  const dataOffset = getDataOffset(validatorBytes.byteLength);
+
+  handle.truncate(0);
+  handle.write(new Uint32Array([CACHE_MAGIC, CACHE_VERSION, numChannels, numFrames, sampleRate, validatorBytes.byteLength]), { at: 0 });
+  handle.write(validatorBytes, { at: CACHE_HEADER_WORDS * 4 });
+  const chunk = new Float32Array(WRITE_CHUNK_FRAMES);
+  for (let channel = 0; channel < numChannels; ++channel) {
+    for (let start = 0; start < numFrames; start += WRITE_CHUNK_FRAMES) {
+      const out = chunk.subarray(0, Math.min(WRITE_CHUNK_FRAMES, numFrames - start));
+      readFrames(channel, start, out);
+      handle.write(out, { at: dataOffset + (channel * numFrames + start) * 4 });
+    }
+  }
+  handle.flush();
+  return { numChannels, numFrames, sampleRate, handle, dataOffset, channels: null };
+};
+
+// Deletes the least recently written files until there's room for another one of this size
+const trimCache = async (directory: CacheDirectoryHandle, incomingBytes: number): Promise<void> => {
+  const files: { name: string; size: number; lastModified: number }[] = [];
+  for await (const [name, entry] of directory.entries()) {
+    if (entry.kind !== 'file') continue;
+    const file = await (await directory.getFileHandle(name)).getFile();
+    files.push({ name, size: file.size, lastModified: file.lastModified });
+  }
+
+  let total = files.reduce((sum, file) => sum + file.size, 0) + incomingBytes;
+  files.sort((a, b) => a.lastModified - b.lastModified);
+  for (const file of files) {
+    if (total <= CACHE_MAX_BYTES) break;
+    try {
+      await directory.removeEntry(file.name);
+      total -= file.size;
+    } catch {
+      // Open in this worker, so it's in use
+    }
+  }
+};
+
+interface WavInfo {
+  numChannels: number;
+  numFrames: number;
+  sampleRate: number;
+  readFrames: (channel: number, start: number, out: Float32Array) => void;
+}
+
+// PCM 8/16/24/32 bit and 32/64 bit float, WAVE_FORMAT_EXTENSIBLE included. null if it's anything else
+const parseWav = (data: ArrayBuffer): WavInfo | null => {
+  const view = new DataView(data);
+  if (view.byteLength < 12 || view.getUint32(0, false) !== 0x52494646 || view.getUint32(8, false) !== 0x57415645) return null;
+
+  let format = 0;
+  let numChannels = 0;
+  let sampleRate = 0;
+  let bitsPerSample = 0;
+  let dataStart = -1;
+  let dataBytes = 0;
+  for (let offset = 12; offset + 8 <= view.byteLength; ) {
+    const id = view.getUint32(offset, false);
+    const size = view.getUint32(offset + 4, true);
+    const body = offset + 8;
+    if (id === 0x666d7420 && body + 16 <= view.byteLength) {
+      // "fmt "
+      format = view.getUint16(body, true);
+      numChannels = view.getUint16(body + 2, true);
+      sampleRate = view.getUint32(body + 4, true);
+      bitsPerSample = view.getUint16(body + 14, true);
+      if (format === 0xfffe && size >= 40) format = view.getUint16(body + 24, true);
+    } else if (id === 0x64617461) {
+      // "data", some writers leave the size at 0 or too big when they didn't finish
+      dataStart = body;
+      dataBytes = size === 0 || body + size > view.byteLength ? view.byteLength - body : size;
+      break;
+    }
+    offset = body + size + (size & 1);
+  }
+
+  const bytesPerSample = bitsPerSample / 8;
+  const supported =
+    (format === 1 && [8, 16, 24, 32].includes(bitsPerSample)) || (format === 3 && (bitsPerSample === 32 || bitsPerSample === 64));
+  if (!supported || dataStart < 0 || numChannels === 0 || sampleRate === 0) return null;
+
+  const frameBytes = bytesPerSample * numChannels;
+  const readSample = (position: number): number => {
+    if (format === 3) return bitsPerSample === 32 ? view.getFloat32(position, true) : view.getFloat64(position, true);
+    switch (bitsPerSample) {
+      case 8:
+        return (view.getUint8(position) - 128) / 128;
+      case 16:
+        return view.getInt16(position, true) / 32768;
+      case 24:
+        return ((view.getInt8(position + 2) << 16) | view.getUint16(position, true)) / 8388608;
+      default:
+        return view.getInt32(position, true) / 2147483648;
+    }
+  };
+
+  return {
+    numChannels,
+    numFrames: Math.floor(dataBytes / frameBytes),
+    sampleRate,
+    readFrames: (channel, start, out) => {
+      let position = dataStart + start * frameBytes + channel * bytesPerSample;
+      for (let i = 0; i < out.length; ++i, position += frameBytes) out[i] = readSample(position);
+    },
+  };
+};
+
+const keepInMemory = (info: WavInfo): DecodedSample => {
+  const channels = Array.from({ length: info.numChannels }, () => new Float32Array(info.numFrames));
+  channels.forEach((channel, index) => info.readFrames(index, 0, channel));
+  return { numChannels: info.numChannels, numFrames: info.numFrames, sampleRate: info.sampleRate, handle: null, dataOffset: 0, channels };
+};
+
+const store = async (key: string, validator: string, info: WavInfo): Promise<DecodedSample> => {
+  const directory = await getCacheDirectory();
+  const sample =
+    directory === null
+      ? keepInMemory(info)
+      : await writeCached(directory, key, validator, info.sampleRate, info.numChannels, info.numFrames, info.readFrames);
+  samples.get(key)?.handle?.close();
+  samples.set(key, sample);
+  return sample;
+};
+
+const postLoaded = (requestId: number, key: string, sample: DecodedSample): void => {
+  scope.postMessage({ type: 'loaded', requestId, key, numChannels: sample.numChannels, numFrames: sample.numFrames, sampleRate: sample.sampleRate });
+};
+
+const load = async (requestId: number, url: string): Promise<void> => {
+  const key = await hashUrl(url);
+  const open = samples.get(key);
+  if (open) {
+    postLoaded(requestId, key, open);
+    return;
+  }
+
+  const directory = await getCacheDirectory();
+  if (directory !== null) {
+    const cached = await openCached(directory, key, await fetchValidator(url));
+    if (cached) {
+      samples.set(key, cached);
+      postLoaded(requestId, key, cached);
+      return;
+    }
+  }
+
+  const response = await fetch(url);
+  if (!response.ok) throw new Error(`Failed to fetch ${url}: ${response.status}`);
+  const validator = getValidator(response);
+  const data = await response.arrayBuffer();
+  const wav = parseWav(data);
+  if (wav === null) {
+    scope.postMessage({ type: 'decode', requestId, validator, data }, [data]);
+    return;
+  }
+  postLoaded(requestId, key, await store(key, validator, wav));
+};
+
+const read = (readId: number, key: string, startFrame: number, frames: number): void => {
+  const sample = samples.get(key);
+  if (!sample) {
+    scope.postMessage({ type: 'data', readId, channels: null });
+    return;
+  }
+
+  const channels: Float32Array[] = [];
+  for (let channel = 0; channel < sample.numChannels; ++channel) {
+    if (sample.channels) {
+      channels.push(sample.channels[channel].slice(startFrame, startFrame + frames));
+    } else {
+      const out = new Float32Array(frames);
+      sample.handle?.read(out, { at: sample.dataOffset + (channel * sample.numFrames + startFrame) * 4 });
+      channels.push(out);
+    }
+  }
+  scope.postMessage({ type: 'data', readId, channels }, channels.map((channel) => channel.buffer));
+};
+
+scope.onmessage = (event) => {
+  const message = event.data;
+  switch (message.type) {
+    case 'load':
+      load(message.requestId, message.url).catch((err) =>
+        scope.postMessage({ type: 'error', requestId: message.requestId, message: err instanceof Error ? err.message : String(err) })
+      );
+      break;
+    case 'store': {
+      const { channels } = message;
+      const info: WavInfo = {
+        numChannels: channels.length,
+        numFrames: channels[0]?.length ?? 0,
+        sampleRate: message.sampleRate,
+        readFrames: (channel, start, out) => out.set(channels[channel].subarray(start, start + out.length)),
+      };
+      hashUrl(message.url)
+        .then(async (key) => postLoaded(message.requestId, key, await store(key, message.validator, info)))
+        .catch((err) =>
+          scope.postMessage({ type: 'error', requestId: message.requestId, message: err instanceof Error ? err.message : String(err) })
+        );
+      break;
+    }
+    case 'read':
+      read(message.readId, message.key, message.startFrame, message.frames);
+      break;
+    case 'close':
+      samples.get(message.key)?.handle?.close();
+      samples.delete(message.key);
+      break;
+  }
+};
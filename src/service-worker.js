@@ -0,0 +1,57 @@
+/**
+ * BespokeSynth WASM Service Worker
+ *
+ * Pre-caches the fonts and drum samples from resource/ so repeat visits don't
+ * touch the network for them. The WASM binaries are cached by the loader in
+ * index.ts (keyed by build hash), so they are not handled here.
+ *
+ * __RESOURCE_PRECACHE__ and __RESOURCE_VERSION__ are filled in by webpack.config.js.
+ */
+
+const RESOURCE_PRECACHE = __RESOURCE_PRECACHE__;
+const RESOURCE_CACHE = `bespoke-resource-${__RESOURCE_VERSION__}`;
+const RESOURCE_CACHE_PREFIX = 'bespoke-resource-';
+
+self.addEventListener('install', (event) => {
+  event.waitUntil(
+    caches.open(RESOURCE_CACHE).then((cache) => cache.addAll(RESOURCE_PRECACHE)).then(() => self.skipWaiting())
+  );
+});
+
+self.addEventListener('activate', (event) => {
+  // Drop resource caches from older deployments
+  event.waitUntil(
+    caches
+      .keys()
+      .then((keys) =>
+        Promise.all(
+          keys
+            .filter((key) => key.startsWith(RESOURCE_CACHE_PREFIX) && key !== RESOURCE_CACHE)
+            .map((key) => caches.delete(key))
+        )
+      )
+      .then(() => self.clients.claim())
+  );
+});
+
+self.addEventListener('fetch', (event) => {
+  const request = event.request;
+  if (request.method !== 'GET') return;
+
+  const url = new URL(request.url);
+  if (url.origin !== self.location.origin || !url.pathname.includes('/resource/')) return;
+
+  // Cache first, anything under resource/ that wasn't pre-cached is cached on first use
+  event.respondWith(
+    caches.open(RESOURCE_CACHE).then(async (cache) => {
+      const cached = await cache.match(request);
+      if (cached) return cached;
+
+      const response = await fetch(request);
+      if (response.ok) {
+        cache.put(request, response.clone());
+      }
+      return response;
+    })
+  );
+});
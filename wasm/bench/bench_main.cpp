@@ -0,0 +1,343 @@
+/**
+ * BespokeSynth WASM - Benchmarks
+ * Per-kernel DSP throughput and renderer frame cost, reported as JSON
+ *
+ * Build with -DBESPOKE_WASM_BENCH=ON, once per SIMD setting, and run both
+ * builds with scripts/run-wasm-bench.js to compare them.
+ *
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include <emscripten.h>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SynthGlobals.h"
+#include "BiquadCascade.h"
+#include "BiquadFilter.h"
+#include "FFT.h"
+#include "FreeverbCore.h"
+#include "Oscillator.h"
+
+#include "WebGPUContext.h"
+#include "WebGPURenderer.h"
+#include "Knob.h"
+
+using namespace bespoke::wasm;
+
+namespace {
+
+const int kSampleRate = 48000;
+const int kBufferSizes[] = {64, 256, 1024};
+const double kMinKernelMs = 200.0;  // each kernel runs at least this long per buffer size
+const int kCanvasWidth = 1280;
+const int kCanvasHeight = 720;
+const int kWarmupFrames = 10;
+const int kMeasuredFrames = 120;
+
+// Results are summed into here, so the optimizer can't drop the work
+volatile float gSink = 0.0f;
+
+std::string gKernelJson;
+std::string gRendererJson;
+
+void appendKernelResult(const char* name, int bufferSize, double nsPerCall, int samplesPerCall) {
+    char entry[256];
+    snprintf(entry, sizeof(entry),
+             "%s\n    {\"name\": \"%s\", \"bufferSize\": %d, \"nsPerCall\": %.1f, \"nsPerSample\": %.3f}",
+             gKernelJson.empty() ? "" : ",", name, bufferSize, nsPerCall, nsPerCall / samplesPerCall);
+    gKernelJson += entry;
+    printf("bench: %-28s %5d  %10.3f ns/sample\n", name, bufferSize, nsPerCall / samplesPerCall);
+}
+
+// Calls fn() in batches until kMinKernelMs has passed, after a short warmup, and returns ns per call
+template <typename Fn>
+double timeKernel(Fn&& fn) {
+    for (int i = 0; i < 16; ++i) fn();
+
+    int calls = 0;
+    int batch = 16;
+    double start = emscripten_get_now();
+    double elapsed = 0.0;
+    while (elapsed < kMinKernelMs) {
+        for (int i = 0; i < batch; ++i) fn();
+        calls += batch;
+        batch *= 2;
+        elapsed = emscripten_get_now() - start;
+    }
+    return elapsed * 1e6 / calls;
+}
+
+void fillNoise(std::vector<float>& buffer) {
+    for (size_t i = 0; i < buffer.size(); ++i) buffer[i] = sinf(i * 0.37f) * 0.5f + cosf(i * 1.91f) * 0.25f;
+}
+
+// ============================================================================
+// Kernels
+// ============================================================================
+
+void benchBufferOps(int n) {
+    std::vector<float> a(n), b(n), gain(n);
+    fillNoise(a);
+    fillNoise(b);
+    for (int i = 0; i < n; ++i) gain[i] = 0.5f + 0.5f * i / n;
+
+    appendKernelResult("buffer/add", n, timeKernel([&] { Add(a.data(), b.data(), n); gSink += a[0]; Mult(a.data(), 0.5f, n); }), n);
+    appendKernelResult("buffer/mult", n, timeKernel([&] { Mult(a.data(), b.data(), n); gSink += a[0]; BufferCopy(a.data(), b.data(), n); }), n);
+    appendKernelResult("buffer/add_with_gain", n, timeKernel([&] { AddWithGain(a.data(), b.data(), gain.data(), n); gSink += a[0]; Mult(a.data(), 0.5f, n); }), n);
+    appendKernelResult("buffer/gain_ramp", n, timeKernel([&] { AddWithGainRamp(a.data(), b.data(), 0.2f, 0.8f, n); gSink += a[0]; Mult(a.data(), 0.5f, n); }), n);
+    appendKernelResult("buffer/copy", n, timeKernel([&] { BufferCopy(a.data(), b.data(), n); gSink += a[n - 1]; }), n);
+}
+
+void benchBiquads(int n) {
+    std::vector<float> left(n), right(n);
+    fillNoise(left);
+    fillNoise(right);
+
+    BiquadFilter filter;
+    filter.SetSampleRate(kSampleRate);
+    filter.SetFilterType(kFilterType_Lowpass);
+    filter.SetFilterParams(2000, 0.707);
+    appendKernelResult("biquad/filter", n, timeKernel([&] { filter.Filter(left.data(), n); gSink += left[0]; }), n);
+
+    // Four stages over a stereo pair, the shape of a 48dB/oct lowpass
+    BiquadCascade cascade;
+    cascade.SetNumStages(4);
+    for (int stage = 0; stage < 4; ++stage) cascade.SetStageCoefficients(stage, filter, false);
+    float* channels[2] = {left.data(), right.data()};
+    appendKernelResult("biquad/cascade4_stereo", n, timeKernel([&] { cascade.Process(channels, 2, n); gSink += left[0]; }), n);
+}
+
+void benchOscillators(int n) {
+    std::vector<float> out(n);
+    float phaseInc = static_cast<float>(FTWO_PI * 220.0 / kSampleRate);
+    const struct {
+        const char* name;
+        OscillatorType type;
+    } kTypes[] = {
+        {"oscillator/sin", kOsc_Sin},
+        {"oscillator/saw", kOsc_Saw},
+        {"oscillator/square", kOsc_Square},
+    };
+
+    for (const auto& type : kTypes) {
+        Oscillator osc(type.type);
+        float phase = 0.0f;
+        appendKernelResult(type.name, n, timeKernel([&] { phase = osc.RenderBlock(phase, phaseInc, out.data(), n); gSink += out[0]; }), n);
+    }
+}
+
+void benchFFT(int n) {
+    // Run the transform at the buffer size, like the spectral modules do with their window size
+    std::vector<float> input(n), re(n / 2 + 1), im(n / 2 + 1), output(n);
+    fillNoise(input);
+
+    FFT fft(n);
+    appendKernelResult("fft/forward", n, timeKernel([&] { fft.Forward(input.data(), re.data(), im.data()); gSink += re[1]; }), n);
+    appendKernelResult("fft/inverse", n, timeKernel([&] { fft.Inverse(re.data(), im.data(), output.data()); gSink += output[0]; }), n);
+}
+
+// Eight saw voices through their own filter, summed to stereo and into a reverb: roughly what a small
+// polysynth patch costs per buffer, using the same kernels the modules call
+void benchReferencePatch(int n) {
+    const int kVoices = 8;
+    std::vector<float> voice(n), mixL(n), mixR(n), outL(n), outR(n);
+
+    Oscillator oscillators[kVoices] = {
+        Oscillator(kOsc_Saw), Oscillator(kOsc_Saw), Oscillator(kOsc_Saw), Oscillator(kOsc_Saw),
+        Oscillator(kOsc_Saw), Oscillator(kOsc_Saw), Oscillator(kOsc_Saw), Oscillator(kOsc_Saw)
+    };
+    BiquadFilter filters[kVoices];
+    float phases[kVoices] = {};
+    for (int i = 0; i < kVoices; ++i) {
+        filters[i].SetSampleRate(kSampleRate);
+        filters[i].SetFilterType(kFilterType_Lowpass);
+        filters[i].SetFilterParams(800 + 300 * i, 1.5);
+    }
+
+    FreeverbCore reverb;
+    reverb.SetRoomSize(0.7f);
+    reverb.Update();
+
+    auto process = [&] {
+        Clear(mixL.data(), n);
+        Clear(mixR.data(), n);
+        for (int i = 0; i < kVoices; ++i) {
+            float phaseInc = static_cast<float>(FTWO_PI * (110.0 * (i + 1)) / kSampleRate);
+            phases[i] = oscillators[i].RenderBlock(phases[i], phaseInc, voice.data(), n);
+            filters[i].Filter(voice.data(), n);
+            float pan = static_cast<float>(i) / (kVoices - 1);
+            AddWithGainRamp(mixL.data(), voice.data(), 0.1f * (1 - pan), 0.1f * (1 - pan), n);
+            AddWithGainRamp(mixR.data(), voice.data(), 0.1f * pan, 0.1f * pan, n);
+        }
+        reverb.Process(mixL.data(), mixR.data(), outL.data(), outR.data(), n);
+        gSink += outL[0];
+    };
+    appendKernelResult("patch/reference", n, timeKernel(process), n);
+}
+
+void runKernelBenchmarks() {
+    for (int n : kBufferSizes) {
+        SetGlobalSampleRateAndBufferSize(kSampleRate, n);
+        benchBufferOps(n);
+        benchBiquads(n);
+        benchOscillators(n);
+        benchFFT(n);
+        benchReferencePatch(n);
+    }
+}
+
+// ============================================================================
+// Renderer
+// ============================================================================
+
+// CPU cost of recording and submitting a frame, which is what competes with audio on the main thread
+struct RendererScenario {
+    const char* name;
+    int count;
+    void (*draw)(WebGPURenderer& renderer, int count, float time);
+};
+
+std::unique_ptr<WebGPUContext> gContext;
+std::unique_ptr<WebGPURenderer> gRenderer;
+std::vector<std::unique_ptr<Knob>> gKnobs;
+
+void drawKnobs(WebGPURenderer& renderer, int count, float time) {
+    const int kColumns = 20;
+    const float kSize = 48.0f;
+    while (static_cast<int>(gKnobs.size()) < count) gKnobs.push_back(std::make_unique<Knob>("knob"));
+    for (int i = 0; i < count; ++i) {
+        gKnobs[i]->setValueNormalized(0.5f + 0.5f * sinf(time + i * 0.1f));
+        gKnobs[i]->render(renderer, 40.0f + (i % kColumns) * 60.0f, 40.0f + (i / kColumns) * 64.0f, kSize);
+    }
+}
+
+void drawCables(WebGPURenderer& renderer, int count, float time) {
+    for (int i = 0; i < count; ++i) {
+        float x1 = 20.0f + (i * 37) % (kCanvasWidth - 40);
+        float y1 = 20.0f + (i * 53) % (kCanvasHeight / 2);
+        float x2 = 20.0f + (i * 91 + 300) % (kCanvasWidth - 40);
+        float y2 = kCanvasHeight / 2 + (i * 29) % (kCanvasHeight / 2 - 20);
+        renderer.drawCableWithSag(x1, y1, x2, y2, Color(0.8f, 0.4f, 0.2f, 0.9f), 3.0f, 0.2f + 0.1f * sinf(time + i));
+    }
+}
+
+void drawText(WebGPURenderer& renderer, int count, float time) {
+    char line[96];
+    renderer.fillColor(Color(0.9f, 0.9f, 0.95f, 1.0f));
+    renderer.fontSize(12.0f);
+    for (int i = 0; i < count; ++i) {
+        // Half the lines change every frame, so both cached and fresh layouts are measured
+        if (i % 2 == 0) snprintf(line, sizeof(line), "module %d  value %.3f  %s", i, sinf(time + i), "lorem ipsum dolor sit amet");
+        else snprintf(line, sizeof(line), "module %d  static label for a control panel", i);
+        renderer.text(10.0f + (i % 3) * 420.0f, 16.0f + (i / 3) * 14.0f, line);
+    }
+}
+
+const RendererScenario kRendererScenarios[] = {
+    {"renderer/knobs", 200, drawKnobs},
+    {"renderer/cables", 200, drawCables},
+    {"renderer/text", 150, drawText},
+};
+const int kNumRendererScenarios = sizeof(kRendererScenarios) / sizeof(kRendererScenarios[0]);
+
+int gScenario = 0;
+int gFrame = 0;
+double gScenarioCpuMs = 0.0;
+
+void report();
+
+void appendRendererResult(const RendererScenario& scenario, double msPerFrame) {
+    char entry[256];
+    snprintf(entry, sizeof(entry), "%s\n    {\"name\": \"%s\", \"count\": %d, \"frames\": %d, \"cpuMsPerFrame\": %.4f}",
+             gRendererJson.empty() ? "" : ",", scenario.name, scenario.count, kMeasuredFrames, msPerFrame);
+    gRendererJson += entry;
+    printf("bench: %-28s %5d  %10.4f ms/frame\n", scenario.name, scenario.count, msPerFrame);
+}
+
+void renderFrame() {
+    const RendererScenario& scenario = kRendererScenarios[gScenario];
+    float time = gFrame / 60.0f;
+
+    double start = emscripten_get_now();
+    gRenderer->beginFrame(kCanvasWidth, kCanvasHeight, 1.0f, time);
+    gRenderer->fillColor(Color(0.12f, 0.12f, 0.14f, 1.0f));
+    gRenderer->rect(0, 0, static_cast<float>(kCanvasWidth), static_cast<float>(kCanvasHeight));
+    gRenderer->fill();
+    scenario.draw(*gRenderer, scenario.count, time);
+    gRenderer->endFrame();
+    double elapsed = emscripten_get_now() - start;
+
+    if (gFrame >= kWarmupFrames) gScenarioCpuMs += elapsed;
+    if (++gFrame < kWarmupFrames + kMeasuredFrames) return;
+
+    appendRendererResult(scenario, gScenarioCpuMs / kMeasuredFrames);
+    gFrame = 0;
+    gScenarioCpuMs = 0.0;
+    if (++gScenario == kNumRendererScenarios) {
+        emscripten_cancel_main_loop();
+        report();
+    }
+}
+
+void onWebGPUReady(bool success) {
+    if (success) {
+        gContext->resize(kCanvasWidth, kCanvasHeight);
+        gRenderer = std::make_unique<WebGPURenderer>(*gContext);
+        success = gRenderer->initialize();
+    }
+    if (!success) {
+        printf("bench: WebGPU unavailable, skipping the renderer benchmarks\n");
+        report();
+        return;
+    }
+
+    // One frame per animation frame, the same pacing as the app
+    emscripten_set_main_loop(renderFrame, 0, false);
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+
+std::string gReport;
+
+void report() {
+#if defined(__wasm_simd128__)
+    const char* simd = "true";
+#else
+    const char* simd = "false";
+#endif
+    char header[128];
+    snprintf(header, sizeof(header), "{\n  \"simd\": %s,\n  \"sampleRate\": %d,\n  \"kernels\": [", simd, kSampleRate);
+    gReport = header;
+    gReport += gKernelJson;
+    gReport += "\n  ],\n  \"renderer\": [";
+    gReport += gRendererJson;
+    gReport += "\n  ]\n}";
+
+    printf("BENCH_RESULTS %s\n", gReport.c_str());
+
+    // bench_shell.html shows the results and posts them back to the runner
+    char script[160];
+    snprintf(script, sizeof(script),
+             "if (window.__bespokeBenchDone) window.__bespokeBenchDone(Module.UTF8ToString(%lu));",
+             static_cast<unsigned long>(reinterpret_cast<uintptr_t>(gReport.c_str())));
+    emscripten_run_script(script);
+}
+
+} // namespace
+
+int main() {
+    printf("bench: running kernel benchmarks\n");
+    runKernelBenchmarks();
+
+    printf("bench: running renderer benchmarks\n");
+    gContext = std::make_unique<WebGPUContext>();
+    gContext->initializeAsync("#canvas", onWebGPUReady);
+    return 0;
+}
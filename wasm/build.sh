@@ -36,35 +36,61 @@ fi
 
 echo -e "${GREEN}Using Emscripten:${NC} $(emcc --version | head -n 1)"
 
-# Create build directory
-mkdir -p "$BUILD_DIR"
-cd "$BUILD_DIR"
+OUTPUT_DIR="$SCRIPT_DIR/dist"
+mkdir -p "$OUTPUT_DIR"
 
-# Configure with CMake
-echo -e "${YELLOW}Configuring with CMake...${NC}"
-emcmake cmake "$SCRIPT_DIR" \
-    -DCMAKE_BUILD_TYPE=Release \
-    -DBESPOKE_WASM_WEBGPU=ON \
-    -DBESPOKE_WASM_SDL2_AUDIO=ON
+# Build one variant into its own build directory and copy its output files
+# usage: build_variant <build dir> <simd ON|OFF> <output suffix>
+build_variant() {
+    local build_dir="$1"
+    local simd="$2"
+    local suffix="$3"
+    local name="BespokeSynthWASM$suffix"
 
-# Build
-echo -e "${YELLOW}Building...${NC}"
-cmake --build . --parallel 55
+    mkdir -p "$build_dir"
+    cd "$build_dir"
 
-# Copy output files
-echo -e "${YELLOW}Copying output files...${NC}"
-OUTPUT_DIR="$SCRIPT_DIR/dist"
-mkdir -p "$OUTPUT_DIR"
+    # Configure with CMake
+    echo -e "${YELLOW}Configuring $name (SIMD $simd)...${NC}"
+    emcmake cmake "$SCRIPT_DIR" \
+        -DCMAKE_BUILD_TYPE=Release \
+        -DBESPOKE_WASM_WEBGPU=ON \
+        -DBESPOKE_WASM_SDL2_AUDIO=ON \
+        -DBESPOKE_WASM_SIMD="$simd" \
+        -DBESPOKE_WASM_OUTPUT_SUFFIX="$suffix"
+
+    # Build
+    echo -e "${YELLOW}Building $name...${NC}"
+    cmake --build . --parallel 55
 
+    # Copy output files
+    echo -e "${YELLOW}Copying $name output files...${NC}"
+    if [ -f "$name.js" ]; then
+        cp "$name.js" "$OUTPUT_DIR/"
+    fi
+    if [ -f "$name.wasm" ]; then
+        cp "$name.wasm" "$OUTPUT_DIR/"
+    fi
+    if [ -f "$name.data" ]; then
+        cp "$name.data" "$OUTPUT_DIR/"
+    fi
+    if [ -d "modules$suffix" ]; then
+        cp -r "modules$suffix" "$OUTPUT_DIR/"
+    fi
+}
+
+# Scalar build for browsers without wasm SIMD, the loader picks the SIMD one when it can
+build_variant "$BUILD_DIR" OFF ""
+build_variant "$BUILD_DIR-simd" ON "-simd"
+
+# Build hash the web loader keys its compiled module cache on, so a new build never reuses a stale binary
+BUILD_HASH=$(cat "$OUTPUT_DIR"/BespokeSynthWASM*.wasm | sha256sum | cut -c1-16)
+echo "{ \"hash\": \"$BUILD_HASH\" }" > "$OUTPUT_DIR/build-manifest.json"
+
+cd "$BUILD_DIR"
 if [ -f "BespokeSynthWASM.html" ]; then
     cp BespokeSynthWASM.html "$OUTPUT_DIR/index.html"
 fi
-if [ -f "BespokeSynthWASM.js" ]; then
-    cp BespokeSynthWASM.js "$OUTPUT_DIR/"
-fi
-if [ -f "BespokeSynthWASM.wasm" ]; then
-    cp BespokeSynthWASM.wasm "$OUTPUT_DIR/"
-fi
 if [ -d "resource" ]; then
     cp -r resource "$OUTPUT_DIR/"
 fi
@@ -0,0 +1,67 @@
+/**
+ * BespokeSynth WASM - Audio Backend Interface
+ * Common interface for the browser audio backends
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <functional>
+
+namespace bespoke {
+namespace wasm {
+
+/**
+ * Audio callback type - receives input buffer and fills output buffer
+ * @param input Input audio buffer (may be null if no input)
+ * @param output Output audio buffer to fill
+ * @param numInputChannels Number of input channels
+ * @param numOutputChannels Number of output channels
+ * @param numSamples Number of samples per channel
+ */
+using AudioCallback = std::function<void(
+    const float* const* input,
+    float* const* output,
+    int numInputChannels,
+    int numOutputChannels,
+    int numSamples
+)>;
+
+/**
+ * Audio backend interface
+ * The callback may be invoked from a thread other than the main thread,
+ * so it must not touch renderer or DOM state.
+ */
+class AudioBackend {
+public:
+    virtual ~AudioBackend() = default;
+    
+    // Initialize audio system
+    virtual bool initialize(int sampleRate = 44100, int bufferSize = 512, int numOutputChannels = 2, int numInputChannels = 0) = 0;
+    
+    // Shutdown audio system
+    virtual void shutdown() = 0;
+    
+    // Start/stop audio processing
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    
+    // Set the audio processing callback
+    virtual void setCallback(AudioCallback callback) = 0;
+    
+    // Audio state
+    virtual bool isRunning() const = 0;
+    virtual int getSampleRate() const = 0;
+    virtual int getBufferSize() const = 0;
+    virtual int getNumOutputChannels() const = 0;
+    virtual int getNumInputChannels() const = 0;
+    
+    // Audio level monitoring
+    virtual float getOutputLevel() const = 0;
+    virtual float getInputLevel() const = 0;
+};
+
+} // namespace wasm
+} // namespace bespoke
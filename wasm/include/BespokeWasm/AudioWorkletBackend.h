@@ -0,0 +1,96 @@
+/**
+ * BespokeSynth WASM - AudioWorklet Audio Backend
+ * Runs the audio callback inside an AudioWorklet, off the main thread
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include "AudioBackend.h"
+#include <emscripten/webaudio.h>
+#include <atomic>
+#include <cstdint>
+
+namespace bespoke {
+namespace wasm {
+
+/**
+ * AudioWorklet-based audio backend for WASM
+ * 
+ * The module's memory is shared with the AudioWorkletGlobalScope, so the
+ * callback runs as WASM directly on the audio rendering thread, one
+ * 128-frame render quantum at a time. A blocked main thread (rendering,
+ * input handling) no longer starves the audio callback.
+ * 
+ * Requires a build with -sAUDIO_WORKLET and -sWASM_WORKERS, served
+ * cross-origin isolated (COOP/COEP) so SharedArrayBuffer is available.
+ */
+class AudioWorkletBackend : public AudioBackend {
+public:
+    static constexpr int kQuantumSize = 128;  // Web Audio render quantum
+    static constexpr int kMaxChannels = 8;
+    
+    AudioWorkletBackend();
+    ~AudioWorkletBackend() override;
+    
+    // bufferSize is ignored, the worklet always processes kQuantumSize frames
+    bool initialize(int sampleRate = 44100, int bufferSize = 512, int numOutputChannels = 2, int numInputChannels = 0) override;
+    void shutdown() override;
+    
+    // start() resumes the AudioContext, so it must be called from a user gesture
+    bool start() override;
+    void stop() override;
+    
+    // Set before start(), the callback is read from the audio thread
+    void setCallback(AudioCallback callback) override { mCallback = callback; }
+    
+    bool isRunning() const override { return mIsRunning.load(); }
+    int getSampleRate() const override { return mSampleRate; }
+    int getBufferSize() const override { return kQuantumSize; }
+    int getNumOutputChannels() const override { return mNumOutputChannels; }
+    int getNumInputChannels() const override { return mNumInputChannels; }
+    
+    float getOutputLevel() const override { return mOutputLevel.load(); }
+    float getInputLevel() const override { return mInputLevel.load(); }
+    
+    // The worklet node is created asynchronously after initialize()
+    bool isNodeReady() const { return mNodeReady.load(); }
+    
+    // Handle for emscriptenGetAudioObject(), e.g. to connect a microphone source to the node's input
+    EMSCRIPTEN_AUDIO_WORKLET_NODE_T getNodeHandle() const { return mNode; }
+
+private:
+    static void onWorkletThreadStarted(EMSCRIPTEN_WEBAUDIO_T context, EM_BOOL success, void* userData);
+    static void onProcessorCreated(EMSCRIPTEN_WEBAUDIO_T context, EM_BOOL success, void* userData);
+    static EM_BOOL processStatic(int numInputs, const AudioSampleFrame* inputs,
+                                 int numOutputs, AudioSampleFrame* outputs,
+                                 int numParams, const AudioParamFrame* params, void* userData);
+    void process(const AudioSampleFrame* input, AudioSampleFrame* output);
+    
+    static constexpr uint32_t kWorkletStackSize = 64 * 1024;
+    
+    EMSCRIPTEN_WEBAUDIO_T mContext = 0;
+    EMSCRIPTEN_AUDIO_WORKLET_NODE_T mNode = 0;
+    
+    AudioCallback mCallback;
+    
+    int mSampleRate = 44100;
+    int mNumOutputChannels = 2;
+    int mNumInputChannels = 0;
+    
+    std::atomic<bool> mIsRunning{false};
+    std::atomic<bool> mNodeReady{false};
+    std::atomic<float> mOutputLevel{0.0f};
+    std::atomic<float> mInputLevel{0.0f};
+    
+    // Zeros, for input channels the browser didn't deliver
+    float mSilence[kQuantumSize] = {};
+    
+    // Stack for the audio worklet thread, must stay alive as long as the context
+    alignas(16) uint8_t mWorkletStack[kWorkletStackSize];
+};
+
+} // namespace wasm
+} // namespace bespoke
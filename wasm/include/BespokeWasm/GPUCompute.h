@@ -0,0 +1,131 @@
+/**
+ * BespokeSynth WASM - GPU Compute
+ * Runs ComputeOffload's kernels as WebGPU compute shaders
+ *
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include "ComputeOffload.h"
+#include <webgpu/webgpu.h>
+#include <cstdint>
+#include <vector>
+
+class WebGPUContext;
+
+namespace bespoke {
+namespace wasm {
+
+/**
+ * Everything queued during an audio callback goes into that callback's
+ * batch. endCallback() uploads the batch, runs one dispatch per job and
+ * copies the results into a readback buffer, which is mapped without
+ * waiting. Results are collected kLatencyCallbacks callbacks later, by
+ * when the map has normally come back; if it hasn't, Collect() says so and
+ * the caller runs the job on the CPU (see ConvolutionEngine and
+ * AdditiveBank). Batches are double buffered on top of the one being
+ * recorded, so a readback still in flight never holds up the next batch.
+ *
+ * The device lives on the main thread, so this only works with the audio
+ * callback on the main thread too (SDL2 audio, not the AudioWorklet).
+ */
+class GPUCompute : public ComputeOffload {
+public:
+    static constexpr int kLatencyCallbacks = 2;
+    static constexpr int kNumBatches = kLatencyCallbacks + 1;
+    static constexpr int kMaxJobsPerBatch = 64;
+    static constexpr int kMaxSpectralBanks = 64;
+
+    explicit GPUCompute(WebGPUContext& context);
+    ~GPUCompute();
+
+    bool initialize();
+
+    // Sends off everything queued since the last call, at the end of every audio callback
+    void endCallback();
+
+    // ComputeOffload
+    int GetLatencyCallbacks() const override { return kLatencyCallbacks; }
+    int CreateSpectralBank(const float* spectra, int numPartitions, int numBins, int historyLength) override;
+    void ClearSpectralBank(int bank) override;
+    void DestroySpectralBank(int bank) override;
+    int QueueSpectralMultiply(int bank, const float* spectrum, int historyPos, int firstPartition) override;
+    int QueueAdditive(const float* phase, const float* phaseInc, const float* amp, const float* ampInc, int numPartials, int numSamples) override;
+    bool Collect(int ticket, float* out, int size) override;
+
+    // How many results weren't back by the time they were collected
+    int getNumLateResults() const { return mNumLateResults; }
+
+private:
+    // Matches Params in the shader, padded to the dynamic uniform offset alignment
+    struct JobParams {
+        uint32_t inputOffset;
+        uint32_t outputOffset;
+        uint32_t count;  // Partials or partitions
+        uint32_t size;  // Samples or bins
+        uint32_t historyPos;
+        uint32_t historyLength;
+        uint32_t firstPartition;
+        uint32_t pad[57];
+    };
+
+    struct Job {
+        int bank;  // -1 for additive
+        uint32_t workgroups;
+        JobParams params;
+    };
+
+    struct SpectralBank {
+        WGPUBuffer spectra = nullptr;
+        WGPUBuffer history = nullptr;
+        WGPUBindGroup bindGroup = nullptr;
+        int numPartitions = 0;
+        int numBins = 0;
+        int historyLength = 0;
+    };
+
+    enum class BatchState { Idle, Recording, InFlight, Mapped };
+
+    struct Batch {
+        BatchState state = BatchState::Idle;
+        int serial = -1;  // The callback it was recorded in
+        std::vector<Job> jobs;
+        std::vector<float> input;
+        uint32_t outputFloats = 0;
+        std::vector<float> results;
+
+        WGPUBuffer inputBuffer = nullptr;
+        WGPUBuffer outputBuffer = nullptr;
+        WGPUBuffer readbackBuffer = nullptr;
+        uint64_t inputCapacity = 0;
+        uint64_t outputCapacity = 0;
+        WGPUBindGroup bindGroup = nullptr;
+    };
+
+    static GPUCompute* sLive;  // Readbacks can come back after we're gone
+    static void onReadbackMapped(WGPUMapAsyncStatus status, WGPUStringView message, void* userdata1, void* userdata2);
+
+    Batch* getRecordingBatch();
+    int addJob(Batch& batch, int bank, uint32_t workgroups, JobParams params, uint32_t outputFloats);
+    bool prepareBuffers(Batch& batch);
+    void releaseBatch(Batch& batch);
+    WGPUBuffer createBuffer(uint64_t size, WGPUBufferUsage usage);
+
+    WebGPUContext& mContext;
+    WGPUComputePipeline mAdditivePipeline = nullptr;
+    WGPUComputePipeline mSpectralPipeline = nullptr;
+    WGPUBindGroupLayout mBatchLayout = nullptr;
+    WGPUBindGroupLayout mBankLayout = nullptr;
+    WGPUBuffer mParamsBuffer[kNumBatches] = {};
+
+    SpectralBank mBanks[kMaxSpectralBanks];
+    Batch mBatches[kNumBatches];
+    std::vector<JobParams> mParamsStaging;
+    int mSerial = 0;
+    int mNumLateResults = 0;
+};
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,65 @@
+/**
+ * BespokeSynth WASM - Glyph Atlas
+ * Signed distance field glyphs for GPU text rendering
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace bespoke {
+namespace wasm {
+
+/**
+ * Single-channel SDF atlas of the printable ASCII range, rasterized once from a TTF.
+ * Glyphs are generated at kBaseSize and scale to any font size, since the
+ * distance field stays sharp when magnified or minified.
+ */
+class GlyphAtlas {
+public:
+    struct Glyph {
+        float u0, v0, u1, v1;  // atlas texture coordinates
+        float xOffset, yOffset;  // top-left of the glyph box relative to the pen on the baseline, at kBaseSize
+        float width, height;     // glyph box, at kBaseSize
+        float advance;           // at kBaseSize
+        bool visible;            // false for glyphs with no outline, like space
+    };
+
+    static constexpr float kBaseSize = 32.0f;
+    static constexpr int kPadding = 4;           // distance field reach around each glyph, in atlas pixels
+    static constexpr int kAtlasSize = 512;
+    static constexpr int kFirstCodepoint = 32;
+    static constexpr int kLastCodepoint = 126;
+
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    // Load the font and rasterize all glyphs. Returns false if the font can't be read.
+    bool build(const char* fontPath);
+    bool isValid() const { return mValid; }
+
+    // Returns the glyph for a codepoint, substituting '?' for ones outside the atlas
+    const Glyph& getGlyph(int codepoint) const;
+    float getKerning(int first, int second) const;  // at kBaseSize
+
+    const std::vector<uint8_t>& getPixels() const { return mPixels; }
+    int getWidth() const { return kAtlasSize; }
+    int getHeight() const { return kAtlasSize; }
+
+private:
+    struct FontInfo;
+
+    std::vector<uint8_t> mFontData;
+    FontInfo* mFont = nullptr;
+    float mScale = 1.0f;
+    std::vector<Glyph> mGlyphs;
+    std::vector<uint8_t> mPixels;
+    bool mValid = false;
+};
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,78 @@
+/**
+ * BespokeSynth WASM - Input Queue
+ * Buffers mouse and keyboard events between frames and hands them out once per frame
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace bespoke {
+namespace wasm {
+
+enum class InputEventType : uint8_t {
+    MouseMove,
+    MouseDown,
+    MouseUp,
+    MouseWheel,
+    KeyDown,
+    KeyUp
+};
+
+struct InputEvent {
+    InputEventType type;
+    float x;          // Mouse position, or wheel deltas
+    float y;
+    int code;         // Mouse button or key code
+    int modifiers;
+};
+
+/**
+ * DOM callbacks only push events here, bespoke_render drains the queue once
+ * per frame, in the order the events arrived, so the handlers see the same
+ * sequence of downs, moves and ups as desktop IClickable handling does.
+ * 
+ * Moves with no button held only matter for their final position, so a move
+ * replaces a move queued right before it. While a button is held every move
+ * is kept (including the pointer's coalesced ones), so drags follow the
+ * exact path, until the queue runs low on room.
+ */
+class InputQueue {
+public:
+    static constexpr uint32_t kCapacity = 512;
+    
+    // Past this fill level drag moves are coalesced too, leaving room for the downs, ups and keys
+    static constexpr uint32_t kDragCoalesceThreshold = kCapacity * 3 / 4;
+    
+    using Handler = std::function<void(const InputEvent& event)>;
+    
+    void pushMouseMove(float x, float y);
+    void pushMouseDown(float x, float y, int button);
+    void pushMouseUp(float x, float y, int button);
+    void pushMouseWheel(float deltaX, float deltaY);
+    void pushKeyDown(int keyCode, int modifiers);
+    void pushKeyUp(int keyCode, int modifiers);
+    
+    // Calls handler for every queued event, oldest first, and empties the queue
+    void drain(const Handler& handler);
+    
+    uint32_t size() const { return mCount; }
+    uint32_t getDroppedCount() const { return mDropped; }
+
+private:
+    void push(const InputEvent& event);
+    InputEvent* back();
+    
+    InputEvent mEvents[kCapacity];
+    uint32_t mHead = 0;     // Oldest event
+    uint32_t mCount = 0;
+    uint32_t mDropped = 0;
+    int mButtonsDown = 0;   // Bitmask, tracked as events are pushed
+};
+
+} // namespace wasm
+} // namespace bespoke
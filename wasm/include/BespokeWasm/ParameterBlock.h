@@ -0,0 +1,92 @@
+/**
+ * BespokeSynth WASM - Parameter Block
+ * Control values, meters and peak levels shared with JS as plain arrays in WASM memory
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bespoke {
+namespace wasm {
+
+/**
+ * Controls are addressed by numeric ID (look one up once by name with
+ * bespoke_get_parameter_id), and their values, the meters and the peak levels
+ * live in a fixed-layout struct-of-arrays that JS maps with typed array views
+ * (see bespoke_get_parameter_block), so reading meters every frame or writing
+ * a batch of automation costs no calls:
+ * 
+ *   uint32 [0] parameter count     uint32 [1] meter count
+ *   uint32 [2] kMaxParameters      uint32 [3] kMaxMeters
+ *   uint32 [4] rendered frames     uint32 [5 ... 5 + kMaxPanels) frames per panel
+ *   float  [kHeaderWords ...]                         values, kMaxParameters
+ *   float  [kHeaderWords + kMaxParameters ...]        meters, kMaxMeters
+ *   float  [kHeaderWords + kMaxParameters + kMaxMeters ...]  peaks, kMaxMeters
+ * 
+ * JS writes new values straight into the values array, applyChanges() picks
+ * them up once per rendered frame. Both sides run on the main thread.
+ */
+class ParameterBlock {
+public:
+    static constexpr uint32_t kMaxParameters = 256;
+    static constexpr uint32_t kMaxMeters = 16;
+    static constexpr uint32_t kMaxPanels = 8;
+    static constexpr uint32_t kHeaderWords = 16;
+    
+    // Peaks fall by this factor every frame once the level drops below them
+    static constexpr float kPeakDecay = 0.95f;
+    
+    // Applies a value written from JS to its control, returns the value the control ended up with (e.g. after clamping)
+    using ApplyFn = std::function<float(float value)>;
+    
+    // Returns the new parameter's ID, or -1 if the block is full
+    int addParameter(const std::string& name, float value, ApplyFn apply);
+    int findParameter(const std::string& name) const;
+    const char* getParameterName(int id) const;
+    
+    // A change made on the WASM side, e.g. by dragging a knob. Visible to JS, and not applied back
+    void setValue(int id, float value);
+    float getValue(int id) const;
+    
+    // Applies every value JS changed since the last call
+    void applyChanges();
+    
+    int addMeter(const std::string& name);
+    int findMeter(const std::string& name) const;
+    void setMeter(int id, float level);
+    
+    void setFrameCount(uint32_t frames) { mFrameCount = frames; }
+    void setPanelFrameCount(int panel, uint32_t frames);
+    
+    // Start of the block described above
+    const void* data() const { return &mParameterCount; }
+
+private:
+    // Layout matters, JS addresses these by offset
+    uint32_t mParameterCount = 0;
+    uint32_t mMeterCount = 0;
+    uint32_t mMaxParameters = kMaxParameters;
+    uint32_t mMaxMeters = kMaxMeters;
+    uint32_t mFrameCount = 0;
+    uint32_t mPanelFrameCounts[kMaxPanels] = {};
+    uint32_t mReserved[kHeaderWords - 5 - kMaxPanels] = {};
+    float mValues[kMaxParameters] = {};
+    float mMeters[kMaxMeters] = {};
+    float mPeaks[kMaxMeters] = {};
+    
+    // Not part of the shared block
+    float mAppliedValues[kMaxParameters] = {};
+    std::vector<std::string> mParameterNames;
+    std::vector<ApplyFn> mApplyFns;
+    std::vector<std::string> mMeterNames;
+};
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,88 @@
+/**
+ * BespokeSynth WASM - Path Tessellator
+ * Turns fill()/stroke() paths into triangles, with a cache for paths that repeat every frame
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace bespoke {
+namespace wasm {
+
+enum class LineJoin {
+    Miter,   // falls back to bevel past the miter limit
+    Round,
+    Bevel
+};
+
+// A run of points in a path's point list (x,y pairs), started by moveTo()
+struct PathContour {
+    uint32_t first;
+    uint32_t count;
+    bool closed;
+};
+
+/**
+ * Tessellation of paths into triangle lists. Output is appended as x,y pairs,
+ * three points per triangle, in the same coordinate space as the input.
+ */
+class PathTessellator {
+public:
+    // Ear-clips each contour, so concave outlines fill correctly. Contours are filled
+    // independently; holes and self-intersections aren't handled.
+    static void fill(const std::vector<float>& points, const std::vector<PathContour>& contours,
+                     std::vector<float>& triangles);
+
+    // Thick strokes with joins between segments and butt ends
+    static void stroke(const std::vector<float>& points, const std::vector<PathContour>& contours,
+                       float width, LineJoin join, std::vector<float>& triangles);
+
+    static constexpr float kMiterLimit = 10.0f;
+};
+
+/**
+ * Triangles for recently used paths, keyed by their geometry and style. Paths are cached in
+ * local coordinates, before the transform, so moving or scrolling a panel still hits the cache.
+ */
+class PathCache {
+public:
+    const std::vector<float>& getFill(const std::vector<float>& points, const std::vector<PathContour>& contours);
+    const std::vector<float>& getStroke(const std::vector<float>& points, const std::vector<PathContour>& contours,
+                                        float width, LineJoin join);
+
+    // Drops paths that haven't been drawn for a while, call once per frame
+    void endFrame();
+    void clear() { mEntries.clear(); }
+
+private:
+    struct Entry {
+        std::vector<float> points;
+        std::vector<PathContour> contours;
+        bool stroke;
+        float width;
+        LineJoin join;
+        std::vector<float> triangles;
+        uint32_t lastUsedFrame;
+    };
+
+    const std::vector<float>& get(const std::vector<float>& points, const std::vector<PathContour>& contours,
+                                  bool stroke, float width, LineJoin join);
+
+    std::unordered_map<uint64_t, Entry> mEntries;
+    std::vector<float> mUncached;  // triangles for paths too big to be worth caching
+    uint32_t mFrame = 0;
+
+    static constexpr uint32_t kMaxUnusedFrames = 120;
+    static constexpr size_t kMaxEntries = 4096;
+    static constexpr size_t kMaxCachedPoints = 4096;  // bigger paths (waveforms etc.) change every frame anyway
+};
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,96 @@
+/**
+ * BespokeSynth WASM - Remote Session
+ * Draws the ui of a bespoke-server running elsewhere, and sends input back to it
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include "InputQueue.h"
+#include <emscripten/websocket.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bespoke {
+namespace wasm {
+
+class WebGPURenderer;
+
+/**
+ * The server (Source/RemoteUIServer.cpp, which documents the protocol)
+ * sends the whole patch once and then only the lines that changed: module
+ * rects, cables, control rects and values, and the canvas view. This keeps
+ * a copy of that state and draws it each frame; nothing is drawn from the
+ * server's NanoVG output, so a frame costs no network traffic when nothing
+ * changed.
+ * 
+ * Input events are forwarded as they come out of the InputQueue, batched
+ * into one message per frame. The server runs them through ModularSynth's
+ * own mouse and key handling, so dragging, patching and menus behave as
+ * they do on the desktop, and the result comes back as state.
+ * 
+ * The websocket callbacks run on the main thread, between frames.
+ */
+class RemoteSession {
+public:
+    ~RemoteSession();
+    
+    // token is the one bespoke-server printed when it started, it's sent before anything else
+    bool connect(const char* url, const char* token);
+    void disconnect();
+    bool isConnected() const { return mOpen; }
+    
+    // The server lays its ui out for this size
+    void setViewport(int width, int height);
+    
+    void sendInput(const InputEvent& event);
+    void flush();  // Sends the input queued since the last flush
+    
+    void render(WebGPURenderer& renderer, int width, int height);
+
+private:
+    struct Module {
+        std::string title;
+        float x = 0, y = 0, w = 0, h = 0;
+        bool minimized = false;
+        bool enabled = true;
+    };
+    
+    struct Control {
+        std::string module;  // Path of the module it's on
+        std::string label;
+        float x = 0, y = 0, w = 0, h = 0;  // Relative to the module
+        float value = 0;
+        std::string display;
+    };
+    
+    static EM_BOOL onOpen(int eventType, const EmscriptenWebSocketOpenEvent* event, void* userData);
+    static EM_BOOL onMessage(int eventType, const EmscriptenWebSocketMessageEvent* event, void* userData);
+    static EM_BOOL onClose(int eventType, const EmscriptenWebSocketCloseEvent* event, void* userData);
+    
+    void applyLine(const std::vector<std::string>& fields);
+    void clearState();
+    bool findTarget(const std::string& path, float& x, float& y) const;
+    
+    EMSCRIPTEN_WEBSOCKET_T mSocket = 0;
+    bool mOpen = false;
+    std::string mToken;
+    int mWidth = 0;
+    int mHeight = 0;
+    std::string mOutgoing;
+    int mHeldButton = -1;
+    int mModifiers = 0;  // From the last key event, mouse events don't carry them
+    
+    std::map<std::string, Module> mModules;
+    std::map<std::string, std::vector<std::string>> mCables;  // Targets, by source module
+    std::map<std::string, Control> mControls;
+    float mOffsetX = 0;
+    float mOffsetY = 0;
+    float mScale = 1;
+};
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,80 @@
+/**
+ * BespokeSynth WASM - Resource Loader
+ * Fetches files from resource/ into the virtual file system when they are first needed
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bespoke {
+namespace wasm {
+
+/**
+ * Only the manifest of resource/ is preloaded, the files themselves are
+ * fetched on request and written to /resource/<path> in MEMFS, where the
+ * normal file APIs (ofToResourcePath, juce::File) find them. Callers request
+ * a file before opening it, e.g. when the panel that shows it opens.
+ * 
+ * The manifest has one "<size in bytes> <path relative to resource/>" entry
+ * per line, paths may contain spaces. It is generated by CMakeLists.txt.
+ * 
+ * Fetching is asynchronous and callback driven, no ASYNCIFY is involved.
+ */
+class ResourceLoader {
+public:
+    using ReadyCallback = std::function<void(bool success)>;
+    
+    static constexpr const char* kMountPoint = "/resource";
+    static constexpr const char* kBaseUrl = "resource";
+    
+    bool loadManifest(const char* path);
+    
+    bool contains(const std::string& path) const { return mResources.count(path) > 0; }
+    bool isLoaded(const std::string& path) const;
+    bool isLoading(const std::string& path) const;
+    size_t getSize(const std::string& path) const;
+    
+    // Fetches a file listed in the manifest, onReady is called once it can be
+    // opened from kMountPoint, right away if it already can
+    void request(const std::string& path, ReadyCallback onReady = nullptr);
+    
+    // Marks a file that is already in the virtual file system (e.g. preloaded) as loaded
+    void markLoaded(const std::string& path);
+    
+    size_t getLoadedBytes() const { return mLoadedBytes; }
+    size_t getTotalBytes() const { return mTotalBytes; }
+
+private:
+    enum class State {
+        NotLoaded,
+        Loading,
+        Loaded
+    };
+    
+    struct Resource {
+        ResourceLoader* loader = nullptr;
+        std::string path;
+        size_t size = 0;
+        State state = State::NotLoaded;
+        std::vector<ReadyCallback> pending;
+    };
+    
+    static void onLoaded(unsigned handle, void* userData, const char* file);
+    static void onError(unsigned handle, void* userData, int status);
+    static bool makeParentDirectories(const std::string& filePath);
+    void finish(Resource& resource, bool success);
+    
+    std::map<std::string, Resource> mResources;  // Nodes stay put while a fetch is in flight
+    size_t mLoadedBytes = 0;
+    size_t mTotalBytes = 0;
+};
+
+} // namespace wasm
+} // namespace bespoke
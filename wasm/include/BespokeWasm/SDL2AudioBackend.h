@@ -8,66 +8,51 @@
 
 #pragma once
 
+#include "AudioBackend.h"
 #include <SDL2/SDL.h>
-#include <functional>
+#include <string>
 #include <vector>
 #include <atomic>
 
 namespace bespoke {
 namespace wasm {
 
-/**
- * Audio callback type - receives input buffer and fills output buffer
- * @param input Input audio buffer (may be null if no input)
- * @param output Output audio buffer to fill
- * @param numInputChannels Number of input channels
- * @param numOutputChannels Number of output channels
- * @param numSamples Number of samples per channel
- */
-using AudioCallback = std::function<void(
-    const float* const* input,
-    float* const* output,
-    int numInputChannels,
-    int numOutputChannels,
-    int numSamples
-)>;
-
 /**
  * SDL2-based audio backend for WASM
  * Handles audio initialization, callback management, and buffer conversion
  */
-class SDL2AudioBackend {
+class SDL2AudioBackend : public AudioBackend {
 public:
     SDL2AudioBackend();
-    ~SDL2AudioBackend();
+    ~SDL2AudioBackend() override;
     
     // Initialize audio system
-    bool initialize(int sampleRate = 44100, int bufferSize = 512, int numOutputChannels = 2, int numInputChannels = 0);
+    bool initialize(int sampleRate = 44100, int bufferSize = 512, int numOutputChannels = 2, int numInputChannels = 0) override;
     
     // Shutdown audio system
-    void shutdown();
+    void shutdown() override;
     
     // Start/stop audio processing
-    bool start();
-    void stop();
+    bool start() override;
+    void stop() override;
     
     // Set the audio processing callback
-    void setCallback(AudioCallback callback) { mCallback = callback; }
+    void setCallback(AudioCallback callback) override { mCallback = callback; }
     
     // Audio state
-    bool isRunning() const { return mIsRunning; }
-    int getSampleRate() const { return mSampleRate; }
-    int getBufferSize() const { return mBufferSize; }
-    int getNumOutputChannels() const { return mNumOutputChannels; }
-    int getNumInputChannels() const { return mNumInputChannels; }
+    bool isRunning() const override { return mIsRunning; }
+    int getSampleRate() const override { return mSampleRate; }
+    int getBufferSize() const override { return mBufferSize; }
+    int getNumOutputChannels() const override { return mNumOutputChannels; }
+    int getNumInputChannels() const override { return mNumInputChannels; }
     
     // Get audio device info
     std::vector<std::string> getOutputDevices();
     std::vector<std::string> getInputDevices();
     
     // Audio level monitoring
-    float getOutputLevel() const { return mOutputLevel.load(); }
-    float getInputLevel() const { return mInputLevel.load(); }
+    float getOutputLevel() const override { return mOutputLevel.load(); }
+    float getInputLevel() const override { return mInputLevel.load(); }
 
 private:
     static void audioCallbackStatic(void* userdata, Uint8* stream, int len);
@@ -0,0 +1,108 @@
+/**
+ * BespokeSynth WASM - Sample Store
+ * Decoded sample data that the browser pages into WASM memory a block at a time
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bespoke {
+namespace wasm {
+
+/**
+ * Samples aren't decoded in WASM. src/sample-worker.ts decodes them in a
+ * worker and keeps the decoded floats in an OPFS cache file, so they load
+ * without decoding again after a reload, and the encoded file never has to
+ * sit in MEMFS. This side only holds the blocks that are resident:
+ * 
+ * - Samples up to kMaxResidentBytes get a slot for every block and are
+ *   paged in completely once created.
+ * - Longer ones are streamed, like Sample's streaming mode on the desktop.
+ *   Block 0 stays resident so playback can always start right away, the
+ *   other blocks share kStreamSlots - 1 slots (block b goes in slot
+ *   1 + (b - 1) % (kStreamSlots - 1)), and reading a block asks for the next
+ *   one ahead of time.
+ * 
+ * read() runs on the audio thread and never waits: what isn't resident
+ * reads as silence and is marked as wanted. takeRequests() runs on the main
+ * thread, turns what's wanted into requests for JS, which reads the frames
+ * out of the cache and writes them straight into the slot, then calls
+ * blockReady(). Each slot is a seqlock (odd version while it's being
+ * refilled), so a read that raced a refill is thrown away instead of mixing
+ * two blocks.
+ */
+class SampleStore {
+public:
+    static constexpr int kMaxSamples = 256;
+    static constexpr int kBlockFrames = 1 << 16;
+    static constexpr int kStreamSlots = 8;
+    static constexpr int64_t kMaxResidentBytes = 32 << 20;
+    static constexpr int kMaxRequests = 64;
+    static constexpr int kRequestWords = 6;  // id, slot, start frame, frames, channel stride (floats), pointer
+    
+    // Released samples are freed after this many takeRequests() calls, the audio thread may still be reading them
+    static constexpr int kReleaseDelay = 50;
+    
+    static SampleStore& get();
+    
+    // Main thread. Returns the new sample's ID, or -1 if there's no room
+    int create(int numChannels, int64_t numFrames, int sampleRate);
+    void release(int id);
+    
+    // Audio thread. Copies channel's frames [startFrame, startFrame + numFrames) into out, silence past the
+    // end. Returns false if some of it wasn't resident yet (that part is silent too, and was asked for)
+    bool read(int id, int channel, int64_t startFrame, int numFrames, float* out);
+    
+    int getNumChannels(int id) const;
+    int64_t getNumFrames(int id) const;
+    int getSampleRate(int id) const;
+    bool isStreamed(int id) const;
+    // How far from the start everything is resident, e.g. to show loading progress
+    int64_t getResidentFrames(int id) const;
+    
+    // Main thread. Collects the blocks read() or create() wanted into the request list, returns how many there are
+    int takeRequests();
+    const uint32_t* getRequests() const { return mRequests; }
+    void blockReady(int id, int slot, int64_t startFrame);
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> version{0};
+        std::atomic<int> block{-1};
+        std::atomic<int> wanted{-1};  // Written by read(), picked up by takeRequests()
+        bool loading = false;  // Main thread only
+    };
+    
+    struct Sample {
+        std::atomic<bool> active{false};
+        int numChannels = 0;
+        int64_t numFrames = 0;
+        int sampleRate = 0;
+        int numBlocks = 0;
+        bool streamed = false;
+        int numSlots = 0;
+        std::unique_ptr<Slot[]> slots;
+        std::vector<float> data;  // numSlots x numChannels x kBlockFrames
+        int releasedAt = -1;
+    };
+    
+    Sample* find(int id) const;
+    int getSlot(const Sample& sample, int block) const;
+    float* getSlotData(Sample& sample, int slot, int channel) {
+        return sample.data.data() + (static_cast<size_t>(slot) * sample.numChannels + channel) * kBlockFrames;
+    }
+    
+    std::unique_ptr<Sample> mSamples[kMaxSamples];
+    uint32_t mRequests[kMaxRequests * kRequestWords] = {};
+    int mTakeCount = 0;
+};
+
+} // namespace wasm
+} // namespace bespoke
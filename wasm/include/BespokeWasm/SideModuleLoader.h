@@ -0,0 +1,85 @@
+/**
+ * BespokeSynth WASM - Side Module Loader
+ * Fetches rarely used modules from separately compiled side modules on first spawn
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bespoke {
+namespace wasm {
+
+// Creates an instance of a module type, an IDrawableModule* once ModuleFactory is part of the build
+using SideModuleCreateFn = void* (*)();
+
+// Passed to a side module's init function, which calls it once per module type it provides
+using SideModuleRegisterFn = void (*)(void* context, const char* typeName, SideModuleCreateFn create);
+
+/**
+ * Loads side modules (built with bespoke_add_side_module() and -sSIDE_MODULE)
+ * with emscripten_dlopen, so the initial download and compile only cover the
+ * core engine. Each side module exports:
+ * 
+ *   extern "C" void bespoke_side_module_init(SideModuleRegisterFn reg, void* context);
+ * 
+ * The manifest maps module types to side module files, so spawn menus can
+ * list lazily loaded types before their code has been fetched.
+ * 
+ * Loading is asynchronous and callback driven, no ASYNCIFY is involved.
+ */
+class SideModuleLoader {
+public:
+    using ReadyCallback = std::function<void(bool success)>;
+    
+    static constexpr const char* kInitSymbol = "bespoke_side_module_init";
+    
+    // Manifest handling, the file has one "<module type> <side module path>" pair per line
+    bool loadManifest(const char* path);
+    void addManifestEntry(const std::string& typeName, const std::string& sideModulePath);
+    std::vector<std::string> getLazyTypes() const;
+    
+    bool isLazyType(const std::string& typeName) const { return mTypeToPath.count(typeName) > 0; }
+    bool isLoaded(const std::string& typeName) const { return mCreators.count(typeName) > 0; }
+    bool isLoading(const std::string& typeName) const;
+    
+    // Fetches and instantiates the side module providing typeName. onReady is
+    // called once its types are registered, right away if they already are
+    void request(const std::string& typeName, ReadyCallback onReady = nullptr);
+    
+    // Returns null until the type's side module has loaded
+    SideModuleCreateFn getCreator(const std::string& typeName) const;
+
+private:
+    enum class State {
+        NotLoaded,
+        Loading,
+        Loaded
+    };
+    
+    struct SideModule {
+        SideModuleLoader* loader = nullptr;
+        std::string path;
+        State state = State::NotLoaded;
+        void* handle = nullptr;
+        std::vector<ReadyCallback> pending;
+    };
+    
+    static void onLoaded(void* userData, void* handle);
+    static void onError(void* userData);
+    static void registerType(void* context, const char* typeName, SideModuleCreateFn create);
+    void finish(SideModule& sideModule, bool success);
+    
+    std::map<std::string, std::string> mTypeToPath;
+    std::map<std::string, SideModule> mSideModules;  // Keyed by path, nodes stay put while a load is in flight
+    std::map<std::string, SideModuleCreateFn> mCreators;
+};
+
+} // namespace wasm
+} // namespace bespoke
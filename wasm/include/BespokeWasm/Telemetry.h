@@ -0,0 +1,81 @@
+/**
+ * BespokeSynth WASM - Telemetry
+ * Audio load, xrun and frame timing rings that JS reads straight out of WASM memory
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace bespoke {
+namespace wasm {
+
+/**
+ * Timing telemetry with a fixed memory layout, so JS can map it with typed
+ * array views once (see bespoke_get_telemetry) and read it without any
+ * per-call marshalling:
+ * 
+ *   uint32 [0] audio sample count    uint32 [1] frame sample count
+ *   uint32 [2] xrun count            uint32 [3] ring size (kRingSize)
+ *   float  [4] smoothed cpu load     float  [5] buffer period (ms)
+ *   float  [6] last frame (ms)       float  [7] reserved
+ *   float  [8 ...]                   audio ring, kRingSize x kAudioFields
+ *   float  [8 + kRingSize * 4 ...]   frame ring, kRingSize x kFrameFields
+ * 
+ * Sample n of a ring lives in slot n % kRingSize, the count is bumped after
+ * the slot is written. Audio samples are written by the audio thread, frame
+ * samples by the main thread; each ring has a single writer.
+ */
+class Telemetry {
+public:
+    static constexpr uint32_t kRingSize = 256;
+    
+    // Audio ring fields: time (ms), callback duration (ms), load (duration / period), interval since previous callback (ms)
+    static constexpr uint32_t kAudioFields = 4;
+    // Frame ring fields: time (ms), frame duration (ms), GPU encode + submit duration (ms), interval since previous frame (ms)
+    static constexpr uint32_t kFrameFields = 4;
+    
+    // A callback arriving this many periods late means the browser starved us
+    static constexpr double kLateCallbackPeriods = 1.5;
+    
+    Telemetry();
+    
+    void reset();
+    
+    // Audio thread, timestamps from emscripten_get_now()
+    void recordAudioCallback(double startMs, double endMs, int numSamples, int sampleRate);
+    
+    // Main thread, timestamps from emscripten_get_now()
+    void recordFrame(double startMs, double submitStartMs, double endMs);
+    
+    float getCpuLoad() const { return mCpuLoad; }
+    uint32_t getXrunCount() const { return mXrunCount.load(); }
+    
+    // Start of the block described above
+    const void* data() const { return &mAudioCount; }
+
+private:
+    // Layout matters, JS addresses these by offset
+    std::atomic<uint32_t> mAudioCount{0};
+    std::atomic<uint32_t> mFrameCount{0};
+    std::atomic<uint32_t> mXrunCount{0};
+    uint32_t mRingSize = kRingSize;
+    float mCpuLoad = 0.0f;
+    float mBufferPeriodMs = 0.0f;
+    float mLastFrameMs = 0.0f;
+    float mReserved = 0.0f;
+    float mAudioRing[kRingSize * kAudioFields] = {};
+    float mFrameRing[kRingSize * kFrameFields] = {};
+    
+    // Not part of the shared block
+    double mOriginMs = 0.0;
+    double mLastAudioStartMs = 0.0;
+    double mLastFrameStartMs = 0.0;
+};
+
+} // namespace wasm
+} // namespace bespoke
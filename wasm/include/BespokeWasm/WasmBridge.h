@@ -9,6 +9,7 @@
 #pragma once
 
 #include <emscripten.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,7 +39,39 @@ EMSCRIPTEN_KEEPALIVE void bespoke_mouse_wheel(float deltaX, float deltaY);
 EMSCRIPTEN_KEEPALIVE void bespoke_key_down(int keyCode, int modifiers);
 EMSCRIPTEN_KEEPALIVE void bespoke_key_up(int keyCode, int modifiers);
 
+// Remote ui
+// Draws a bespoke-server's patch instead of the local panels, and sends input to it (see RemoteSession.h).
+// url is e.g. "ws://host:9310" and token the one the server printed; returns 0 once connecting started, -1 if it couldn't
+EMSCRIPTEN_KEEPALIVE int bespoke_remote_connect(const char* url, const char* token);
+EMSCRIPTEN_KEEPALIVE void bespoke_remote_disconnect(void);
+EMSCRIPTEN_KEEPALIVE int bespoke_remote_is_connected(void);
+
+// Samples (see SampleStore.h, src/sample-pipeline.ts pages them in)
+// Frame counts are doubles so they don't need BigInt on the JS side. create returns the sample id, -1 if there is no room
+EMSCRIPTEN_KEEPALIVE int bespoke_sample_create(int numChannels, double numFrames, int sampleRate);
+EMSCRIPTEN_KEEPALIVE void bespoke_sample_release(int id);
+EMSCRIPTEN_KEEPALIVE int bespoke_sample_is_streamed(int id);
+EMSCRIPTEN_KEEPALIVE double bespoke_sample_get_resident_frames(int id);
+// Returns how many requests there are, each one SampleStore::kRequestWords uint32s at bespoke_sample_get_requests()
+EMSCRIPTEN_KEEPALIVE int bespoke_sample_take_requests(void);
+EMSCRIPTEN_KEEPALIVE const uint32_t* bespoke_sample_get_requests(void);
+EMSCRIPTEN_KEEPALIVE void bespoke_sample_block_ready(int id, int slot, double startFrame);
+
+// Resources
+// Fetches a file from resource/ into /resource, path relative to resource/ as in the manifest.
+// Returns 0 when it can be opened, 1 while it is being fetched (call again later), -1 if it isn't a resource
+EMSCRIPTEN_KEEPALIVE int bespoke_request_resource(const char* path);
+
+// Shared parameter block (layout in ParameterBlock.h), map it with HEAPU32/HEAPF32 views.
+// IDs are stable for the session, look them up once by name; -1 if there is no such parameter or meter
+EMSCRIPTEN_KEEPALIVE const void* bespoke_get_parameter_block(void);
+EMSCRIPTEN_KEEPALIVE int bespoke_get_parameter_id(const char* name);
+EMSCRIPTEN_KEEPALIVE int bespoke_get_meter_id(const char* name);
+
 // Module management
+// Returns 0 when the type can be spawned, 1 while its side module is being fetched (call again later)
+EMSCRIPTEN_KEEPALIVE int bespoke_request_module(const char* type);
+// Returns -2 if the type's side module hasn't finished loading yet
 EMSCRIPTEN_KEEPALIVE int bespoke_create_module(const char* type, float x, float y);
 EMSCRIPTEN_KEEPALIVE void bespoke_delete_module(int moduleId);
 EMSCRIPTEN_KEEPALIVE void bespoke_connect_modules(int sourceId, int destId);
@@ -62,6 +95,8 @@ EMSCRIPTEN_KEEPALIVE float bespoke_get_tempo(void);
 // Debug/info
 EMSCRIPTEN_KEEPALIVE const char* bespoke_get_version(void);
 EMSCRIPTEN_KEEPALIVE float bespoke_get_cpu_load(void);
+// Address of the telemetry block (layout in Telemetry.h), map it with HEAPU32/HEAPF32 views
+EMSCRIPTEN_KEEPALIVE const void* bespoke_get_telemetry(void);
 EMSCRIPTEN_KEEPALIVE int bespoke_get_module_count(void);
 
 // Panel management
@@ -9,10 +9,13 @@
 #pragma once
 
 #include "WebGPUContext.h"
+#include "GlyphAtlas.h"
+#include "PathTessellator.h"
 #include <vector>
 #include <string>
 #include <cstdint>
 #include <map>
+#include <unordered_map>
 
 namespace bespoke {
 namespace wasm {
@@ -36,6 +39,47 @@ struct Vertex2D {
     Color color;
 };
 
+// Per-instance data for the antialiased SDF shapes drawn by fs_shape
+struct ShapeInstance2D {
+    float cx, cy;        // center, in framebuffer coordinates
+    float hw, hh;        // half extents of the shape's local box
+    float axisX, axisY;  // local x axis (cos/sin of the rotation)
+    float kind;          // ShapeKind
+    float strokeWidth;
+    float params[4];     // per-kind: arc radius/start/sweep, corner radius, line half length, glyph uv rect
+    Color fill;
+    Color stroke;
+};
+
+enum class ShapeKind {
+    Circle = 0,
+    Arc = 1,
+    RoundedRect = 2,
+    Line = 3,
+    Glyph = 4   // samples the SDF glyph atlas
+};
+
+// Per-instance data for a sample trace drawn by vs_trace. The samples themselves
+// are in a storage buffer, and the vertex shader builds the geometry from them.
+struct TraceInstance2D {
+    float x, y, w, h;     // bounds, in framebuffer coordinates
+    uint32_t first;       // first sample in the frame's sample buffer
+    uint32_t count;       // number of samples
+    uint32_t mode;        // TraceMode
+    uint32_t segments;    // quads generated for the trace
+    Color color;
+    float thickness;
+    float gradient;       // 1 to shade bars by height, like fs_spectrum_bar
+    float padding[2];
+};
+
+enum class TraceMode {
+    Line = 0,     // a segment between each pair of samples
+    Columns = 1,  // min/max per pixel column, for more samples than pixels
+    Fill = 2,     // the area between the center line and the samples
+    Bars = 3      // a bar and a peak marker per sample
+};
+
 // Shader Pipelines storage
 struct Pipelines {
     WGPURenderPipeline solid;
@@ -70,6 +114,9 @@ struct Pipelines {
     WGPURenderPipeline fader_groove;
     WGPURenderPipeline fader_cap;
     WGPURenderPipeline mod_wheel;
+    WGPURenderPipeline shape;  // instanced, see ShapeInstance2D
+    WGPURenderPipeline trace;  // instanced, see TraceInstance2D
+    WGPURenderPipeline layer;  // fs_textured with premultiplied blending, for drawLayer()
 };
 
 /**
@@ -107,6 +154,7 @@ public:
     void fillColor(const Color& color);
     void strokeColor(const Color& color);
     void strokeWidth(float width);
+    void lineJoin(LineJoin join);
     
     // Path operations
     void beginPath();
@@ -114,7 +162,7 @@ public:
     void lineTo(float x, float y);
     void bezierTo(float c1x, float c1y, float c2x, float c2y, float x, float y);
     void quadTo(float cx, float cy, float x, float y);
-    void arc(float cx, float cy, float r, float a0, float a1, int dir);
+    void arc(float cx, float cy, float r, float a0, float a1, int dir);  // dir 1 sweeps counter-clockwise, anything else clockwise
     void arcTo(float x1, float y1, float x2, float y2, float radius);
     void closePath();
     
@@ -142,6 +190,15 @@ public:
     void drawSlider(float x, float y, float w, float h, float value, const Color& bgColor, const Color& fgColor);
     void drawVUMeter(float x, float y, float w, float h, float level, const Color& lowColor, const Color& highColor);
 
+    // Instanced SDF primitives. These are antialiased on the GPU and batch into a single draw
+    // no matter how the shape kinds are interleaved. Angles follow arc(), sweeping clockwise from a0 to a1.
+    void drawCircle(float cx, float cy, float r, const Color& fill,
+                    const Color& stroke = Color(0, 0, 0, 0), float strokeWidth = 0.0f);
+    void drawArc(float cx, float cy, float r, float a0, float a1, float thickness, const Color& color);
+    void drawRoundedRect(float x, float y, float w, float h, float r, const Color& fill,
+                         const Color& stroke = Color(0, 0, 0, 0), float strokeWidth = 0.0f);
+    void drawLine(float x1, float y1, float x2, float y2, float width, const Color& color);
+
     // New UI elements
     void drawButton(float x, float y, float w, float h, const char* label, bool pressed, bool hover);
     void drawToggle(float x, float y, float w, float h, bool state);
@@ -155,27 +212,131 @@ public:
     void drawLED(float x, float y, float w, float h, bool on);
     void drawProgressBar(float x, float y, float w, float h, float value);
 
+    // Cached render-to-texture layers, for content that rarely changes like panel chrome.
+    // A layer covers the whole framebuffer. beginLayer() returns true when the layer has to be
+    // redrawn (first use, a resize, a different key or invalidateLayers()), and the draws up to
+    // endLayer() then go into the layer instead of the frame. drawLayer() blits the layer into the frame.
+    int createLayer();
+    bool beginLayer(int layer, uint64_t key);
+    void endLayer();
+    void drawLayer(int layer);
+    void invalidateLayers();
+
 private:
     void createPipelines();
     void createBuffers();
-    void flushBatch();
-    void setPipeline(WGPURenderPipeline pipeline);
+    void createTextAtlas();
+    void closeDrawCommand();
+    void submitFrame();
+    // How a draw command's range is interpreted
+    enum class Geometry {
+        Triangles,  // raw vertices
+        Quads,      // 4 vertices per quad, drawn through mQuadIndexBuffer
+        Shapes,     // ShapeInstance2D instances, drawn as instanced quads
+        Traces      // one TraceInstance2D per command, the count is the number of vertices to generate
+    };
+
+    // Growable GPU buffer that successive frames are written into one after another
+    struct GpuRing {
+        WGPUBuffer buffer = nullptr;
+        uint64_t capacity = 0;  // bytes
+        uint64_t head = 0;      // where the next frame's data goes, so we don't overwrite data still in flight
+    };
+
+    // Where the frame's data landed in the rings
+    struct FrameOffsets {
+        uint64_t vertex = 0;
+        uint64_t instance = 0;
+        uint64_t trace = 0;
+        uint64_t sample = 0;
+    };
+
+    struct Layer {
+        WGPUTexture texture = nullptr;
+        WGPUTextureView view = nullptr;
+        WGPUBindGroup bindGroup = nullptr;  // samples the texture, for drawLayer()
+        int width = 0;
+        int height = 0;
+        uint64_t key = 0;
+        bool valid = false;
+    };
+
+    // A layer redrawn this frame, and the range of mDrawCommands that goes into it
+    struct LayerPass {
+        int layer;
+        size_t firstCommand;
+        size_t endCommand;
+    };
+
+    bool allocateRing(GpuRing& ring, uint64_t bytes, WGPUBufferUsage usage, uint64_t& byteOffset);
+    void encodeCommands(WGPURenderPassEncoder pass, size_t firstCommand, size_t endCommand, const FrameOffsets& offsets);
+    void encodeLayerPasses(const FrameOffsets& offsets);
+    bool createLayerTexture(Layer& layer);
+    void releaseLayer(Layer& layer);
+    void clearFrame();
+    void setPipeline(WGPURenderPipeline pipeline, Geometry geometry = Geometry::Triangles);
+    void pushShape(ShapeInstance2D& shape);  // shape is in local coordinates, and gets the current transform applied
+    // Queues a trace over the samples, with the bounds in local coordinates. Returns false if
+    // the trace pipeline isn't available and the caller should draw the samples itself.
+    bool pushTrace(float x, float y, float w, float h, const float* data, int count, TraceMode mode,
+                   const Color& color, float thickness);
     void pushVertex(float x, float y, float u, float v, const Color& color);
     void transformPoint(float& x, float& y);
     void drawQuad(float x, float y, float w, float h, WGPURenderPipeline pipeline);
+    void drawPlaceholderText(float x, float y, const char* string);
+    void pathPoint(float x, float y);
+    void drawPathTriangles(const std::vector<float>& triangles, const Color& color);
+
+    // Glyph instances for a string at the current font size, relative to the pen on the baseline
+    struct TextLayout {
+        std::vector<ShapeInstance2D> glyphs;
+        float width = 0.0f;
+    };
+    const TextLayout& getTextLayout(const char* string);
     
     WebGPUContext& mContext;
     
     Pipelines mPipelines;
     WGPURenderPipeline mCurrentPipeline = nullptr;
-    WGPURenderPipeline mStrokePipeline = nullptr; // Kept separate for lines
+    Geometry mCurrentGeometry = Geometry::Triangles;
 
-    WGPUBuffer mVertexBuffer = nullptr;
+    GpuRing mVertexRing;
+    GpuRing mInstanceRing;
+    GpuRing mTraceRing;
+    GpuRing mSampleRing;  // storage buffer with the samples of every trace in the frame
+    WGPUBuffer mQuadIndexBuffer = nullptr;  // static 0,1,2, 0,2,3 pattern for kMaxQuadsPerDraw quads
     WGPUBuffer mUniformBuffer = nullptr;
     WGPUBindGroup mBindGroup = nullptr;
+    WGPUBindGroup mShapeBindGroup = nullptr;  // binds the glyph atlas, so text batches with the other shapes
     WGPUBindGroupLayout mBindGroupLayout = nullptr; // Cached layout used even when pipelines are null
+    WGPUBindGroupLayout mSampleBindGroupLayout = nullptr;  // group 1 of the trace pipeline
+    WGPUBindGroup mSampleBindGroup = nullptr;
+    WGPUBuffer mSampleBindGroupBuffer = nullptr;  // the mSampleRing buffer mSampleBindGroup was made for
     
     std::vector<Vertex2D> mVertices;
+    std::vector<ShapeInstance2D> mShapes;
+    std::vector<TraceInstance2D> mTraces;
+    std::vector<float> mSamples;
+    static constexpr size_t kInitialVertexCapacity = 65536;
+    static constexpr size_t kInitialShapeCapacity = 4096;
+    static constexpr uint32_t kMaxQuadsPerDraw = 16384;  // keeps quad indices within uint16
+
+    // Frame-wide command list, replayed in submission order inside one render pass
+    struct DrawCommand {
+        WGPURenderPipeline pipeline;
+        WGPUBindGroup bindGroup;
+        Geometry geometry;
+        uint32_t first;  // vertex, or instance for Geometry::Shapes and Geometry::Traces
+        uint32_t count;
+    };
+    std::vector<DrawCommand> mDrawCommands;
+    size_t mCommandStart = 0;  // first vertex/instance of the current geometry not yet covered by a command
+    size_t mMergeBarrier = 0;  // commands before this belong to a different pass and can't be extended
+
+    std::vector<Layer> mLayers;
+    std::vector<LayerPass> mLayerPasses;
+    int mActiveLayer = -1;  // layer the draws currently go into, -1 for the frame
+    WGPUSampler mLayerSampler = nullptr;
     
     // State stack
     struct State {
@@ -183,21 +344,26 @@ private:
         Color fillColor;
         Color strokeColor;
         float strokeWidth;
+        LineJoin lineJoin;
         float scissor[4];  // x, y, w, h
         bool hasScissor;
     };
     std::vector<State> mStateStack;
     State mCurrentState;
     
-    // Path building
+    // Path building, in local coordinates so tessellated paths can be reused under any transform
     std::vector<float> mPathPoints;
-    float mPathStartX, mPathStartY;
-    float mPathX, mPathY;
-    bool mPathHasStart;
+    std::vector<PathContour> mPathContours;
+    float mPathX = 0.0f, mPathY = 0.0f;
+    bool mPathHasStart = false;
+    PathCache mPathCache;
     
     // Font state
     float mFontSize = 14.0f;
     std::string mFontName;
+    GlyphAtlas mGlyphAtlas;
+    std::unordered_map<std::string, TextLayout> mTextLayouts;  // keyed by font size and string
+    static constexpr size_t kMaxTextLayouts = 1024;
     
     int mWidth = 0;
     int mHeight = 0;
@@ -26,4 +26,7 @@ struct parser {
     bool compile(const std::string&, expression<T>&) { return true; }
 };
 
+template<typename Sequence>
+bool collect_variables(const std::string&, Sequence&) { return false; }
+
 } // namespace exprtk
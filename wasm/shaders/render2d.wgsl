@@ -824,3 +824,288 @@ fn fs_mod_wheel(input: VertexOutput) -> @location(0) vec4<f32> {
     
     return color;
 }
+
+// ============================================================================
+// Instanced SDF shapes (circle, arc, rounded rect, line, atlas glyph)
+// One instance per shape; the quad's four corners come from the vertex index.
+// ============================================================================
+
+struct ShapeInput {
+    @location(0) bounds: vec4<f32>,       // center.xy, halfSize.xy in pixels
+    @location(1) style: vec4<f32>,        // axis.xy, kind, strokeWidth
+    @location(2) params: vec4<f32>,       // per-kind parameters
+    @location(3) fillColor: vec4<f32>,
+    @location(4) strokeColor: vec4<f32>,
+};
+
+struct ShapeOutput {
+    @builtin(position) position: vec4<f32>,
+    @location(0) local: vec2<f32>,        // pixel offset from the center, in the shape's own frame
+    @location(1) @interpolate(flat) halfSize: vec2<f32>,
+    @location(2) @interpolate(flat) style: vec4<f32>,
+    @location(3) @interpolate(flat) params: vec4<f32>,
+    @location(4) @interpolate(flat) fillColor: vec4<f32>,
+    @location(5) @interpolate(flat) strokeColor: vec4<f32>,
+};
+
+const SHAPE_CIRCLE: i32 = 0;
+const SHAPE_ARC: i32 = 1;
+const SHAPE_ROUNDED_RECT: i32 = 2;
+const SHAPE_LINE: i32 = 3;
+const SHAPE_GLYPH: i32 = 4;
+
+// Value the glyph atlas stores on the outline (128 / 255)
+const GLYPH_EDGE: f32 = 0.50196;
+
+@vertex
+fn vs_shape(@builtin(vertex_index) vertexIndex: u32, input: ShapeInput) -> ShapeOutput {
+    var corners = array<vec2<f32>, 4>(
+        vec2<f32>(-1.0, -1.0),
+        vec2<f32>(1.0, -1.0),
+        vec2<f32>(1.0, 1.0),
+        vec2<f32>(-1.0, 1.0)
+    );
+
+    // Grow the quad by a pixel so the antialiased edge isn't cut off
+    let local = corners[vertexIndex % 4u] * (input.bounds.zw + vec2<f32>(1.0, 1.0));
+    let axis = input.style.xy;
+    let offset = vec2<f32>(local.x * axis.x - local.y * axis.y, local.x * axis.y + local.y * axis.x);
+    let pos = input.bounds.xy + offset;
+
+    var output: ShapeOutput;
+    output.position = vec4<f32>(
+        (pos.x / uniforms.viewSize.x) * 2.0 - 1.0,
+        1.0 - (pos.y / uniforms.viewSize.y) * 2.0,
+        0.0, 1.0);
+    output.local = local;
+    output.halfSize = input.bounds.zw;
+    output.style = input.style;
+    output.params = input.params;
+    output.fillColor = input.fillColor;
+    output.strokeColor = input.strokeColor;
+    return output;
+}
+
+fn sd_rounded_box(p: vec2<f32>, halfSize: vec2<f32>, radius: f32) -> f32 {
+    let q = abs(p) - halfSize + vec2<f32>(radius, radius);
+    return length(max(q, vec2<f32>(0.0, 0.0))) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+fn sd_arc(p: vec2<f32>, radius: f32, startAngle: f32, sweep: f32, thickness: f32) -> f32 {
+    var a = atan2(p.y, p.x) - startAngle;
+    a = a - TWO_PI * floor(a / TWO_PI);
+    if (a <= sweep) {
+        return abs(length(p) - radius) - thickness * 0.5;
+    }
+    // Outside the sweep: distance to the nearer round cap
+    let endAngle = startAngle + sweep;
+    let p0 = vec2<f32>(cos(startAngle), sin(startAngle)) * radius;
+    let p1 = vec2<f32>(cos(endAngle), sin(endAngle)) * radius;
+    return min(distance(p, p0), distance(p, p1)) - thickness * 0.5;
+}
+
+@fragment
+fn fs_shape(input: ShapeOutput) -> @location(0) vec4<f32> {
+    let p = input.local;
+    let kind = i32(input.style.z + 0.5);
+    let strokeWidth = input.style.w;
+
+    // Texture sampling has to happen outside the per-kind branches. For glyphs the
+    // params hold the atlas rect; other shapes sample the atlas too but ignore the result.
+    let boxUV = p / max(input.halfSize, vec2<f32>(0.0001, 0.0001)) * 0.5 + vec2<f32>(0.5, 0.5);
+    let atlasUV = clamp(mix(input.params.xy, input.params.zw, boxUV), input.params.xy, input.params.zw);
+    let atlasDistance = textureSampleLevel(textureData, textureSampler, atlasUV, 0.0).r;
+
+    var d = 0.0;
+    var strokeOnly = false;
+    switch kind {
+        case SHAPE_CIRCLE: {
+            d = length(p) - input.halfSize.x;
+        }
+        case SHAPE_ARC: {
+            d = sd_arc(p, input.params.x, input.params.y, input.params.z, strokeWidth);
+            strokeOnly = true;
+        }
+        case SHAPE_ROUNDED_RECT: {
+            d = sd_rounded_box(p, input.halfSize, input.params.x);
+        }
+        case SHAPE_GLYPH: {
+            d = GLYPH_EDGE - atlasDistance;
+        }
+        case SHAPE_LINE, default: {  // a capsule
+            let q = vec2<f32>(max(abs(p.x) - input.params.x, 0.0), p.y);
+            d = length(q) - strokeWidth * 0.5;
+            strokeOnly = true;
+        }
+    }
+
+    let aa = max(fwidth(d), 0.0001);
+    let coverage = clamp(0.5 - d / aa, 0.0, 1.0);
+
+    var color = input.strokeColor;
+    if (!strokeOnly) {
+        // The stroke sits just inside the edge
+        var inner = 1.0;
+        if (strokeWidth > 0.0) {
+            inner = clamp(0.5 - (d + strokeWidth) / aa, 0.0, 1.0);
+        }
+        color = mix(input.strokeColor, input.fillColor, inner);
+    }
+    color.a = color.a * coverage;
+    return color;
+}
+
+// ============================================================================
+// Sample traces (waveform, scope, spectrum)
+// The samples are uploaded once into a storage buffer and each trace is a single
+// instance, with its segments, columns or bars generated from the vertex index.
+// ============================================================================
+
+struct TraceInput {
+    @location(0) bounds: vec4<f32>,       // x, y, w, h in pixels
+    @location(1) range: vec4<u32>,        // first sample, sample count, mode, segment count
+    @location(2) color: vec4<f32>,
+    @location(3) style: vec4<f32>,        // line thickness, height gradient, unused
+};
+
+struct TraceOutput {
+    @builtin(position) position: vec4<f32>,
+    @location(0) across: f32,             // pixel distance from the center of a line segment
+    @location(1) height: f32,             // 0 at the bottom of the bounds, 1 at the top
+    @location(2) @interpolate(flat) color: vec4<f32>,
+    @location(3) @interpolate(flat) halfWidth: f32,
+    @location(4) @interpolate(flat) gradient: f32,
+};
+
+@group(1) @binding(0) var<storage, read> traceSamples: array<f32>;
+
+const TRACE_LINE: u32 = 0u;
+const TRACE_COLUMNS: u32 = 1u;
+const TRACE_FILL: u32 = 2u;
+const TRACE_BARS: u32 = 3u;
+
+fn trace_x(bounds: vec4<f32>, index: u32, count: u32) -> f32 {
+    return bounds.x + f32(index) / f32(max(count, 2u) - 1u) * bounds.z;
+}
+
+fn trace_y(bounds: vec4<f32>, value: f32) -> f32 {
+    return bounds.y + bounds.w * 0.5 - value * bounds.w * 0.5;
+}
+
+@vertex
+fn vs_trace(@builtin(vertex_index) vertexIndex: u32, input: TraceInput) -> TraceOutput {
+    // Two triangles per segment, x runs along the segment and y across it
+    var corners = array<vec2<f32>, 6>(
+        vec2<f32>(0.0, 0.0),
+        vec2<f32>(1.0, 0.0),
+        vec2<f32>(1.0, 1.0),
+        vec2<f32>(0.0, 0.0),
+        vec2<f32>(1.0, 1.0),
+        vec2<f32>(0.0, 1.0)
+    );
+    let corner = corners[vertexIndex % 6u];
+    let segment = vertexIndex / 6u;
+
+    let bounds = input.bounds;
+    let first = input.range.x;
+    let count = input.range.y;
+    let segments = max(input.range.w, 1u);
+    let halfWidth = input.style.x * 0.5;
+
+    var pos = vec2<f32>(0.0, 0.0);
+    var across = 0.0;
+    var gradient = 0.0;
+    switch input.range.z {
+        case TRACE_COLUMNS: {
+            // One pixel column per segment, covering the min and max of its samples.
+            // Each column also takes the next column's first sample, so the trace stays connected.
+            let start = segment * count / segments;
+            let end = min((segment + 1u) * count / segments + 1u, count);
+            var lo = traceSamples[first + start];
+            var hi = lo;
+            for (var i = start + 1u; i < end; i = i + 1u) {
+                let value = traceSamples[first + i];
+                lo = min(lo, value);
+                hi = max(hi, value);
+            }
+            let x0 = bounds.x + f32(segment) / f32(segments) * bounds.z;
+            let x1 = bounds.x + f32(segment + 1u) / f32(segments) * bounds.z;
+            let top = trace_y(bounds, hi) - halfWidth;
+            let bottom = trace_y(bounds, lo) + halfWidth;
+            pos = vec2<f32>(mix(x0, x1, corner.x), mix(top, bottom, corner.y));
+        }
+        case TRACE_FILL: {
+            // The area between the center line and the samples
+            let p0 = vec2<f32>(trace_x(bounds, segment, count), trace_y(bounds, traceSamples[first + segment]));
+            let p1 = vec2<f32>(trace_x(bounds, segment + 1u, count), trace_y(bounds, traceSamples[first + segment + 1u]));
+            let p = mix(p0, p1, corner.x);
+            pos = vec2<f32>(p.x, mix(bounds.y + bounds.w * 0.5, p.y, corner.y));
+        }
+        case TRACE_BARS: {
+            // Even segments are the bars, odd ones the peak markers on top of them
+            let bar = segment / 2u;
+            let barWidth = bounds.z / f32(count);
+            let barHeight = traceSamples[first + bar] * bounds.w;
+            let x0 = bounds.x + f32(bar) * barWidth;
+            let x1 = x0 + max(barWidth - 1.0, 0.0);
+            let top = bounds.y + bounds.w - barHeight;
+            if (segment % 2u == 0u) {
+                pos = vec2<f32>(mix(x0, x1, corner.x), mix(top, top + barHeight, corner.y));
+                gradient = input.style.y;
+            } else {
+                pos = vec2<f32>(mix(x0, x1, corner.x), mix(top - 2.0, top, corner.y));
+            }
+        }
+        case TRACE_LINE, default: {
+            // A thick segment between neighbouring samples, extended by half the
+            // thickness at both ends so consecutive segments overlap at the joins
+            let p0 = vec2<f32>(trace_x(bounds, segment, count), trace_y(bounds, traceSamples[first + segment]));
+            let p1 = vec2<f32>(trace_x(bounds, segment + 1u, count), trace_y(bounds, traceSamples[first + segment + 1u]));
+            let delta = p1 - p0;
+            let len = length(delta);
+            var dir = vec2<f32>(1.0, 0.0);
+            if (len > 0.0001) {
+                dir = delta / len;
+            }
+            let normal = vec2<f32>(-dir.y, dir.x);
+            // Grow by a pixel so the antialiased edge isn't cut off
+            let extent = halfWidth + 1.0;
+            across = (corner.y * 2.0 - 1.0) * extent;
+            pos = mix(p0, p1, corner.x) + dir * (corner.x * 2.0 - 1.0) * halfWidth + normal * across;
+        }
+    }
+
+    var output: TraceOutput;
+    output.position = vec4<f32>(
+        (pos.x / uniforms.viewSize.x) * 2.0 - 1.0,
+        1.0 - (pos.y / uniforms.viewSize.y) * 2.0,
+        0.0, 1.0);
+    output.across = across;
+    output.height = (bounds.y + bounds.w - pos.y) / max(bounds.w, 0.0001);
+    output.color = input.color;
+    output.halfWidth = max(halfWidth, 0.5);
+    output.gradient = gradient;
+    return output;
+}
+
+@fragment
+fn fs_trace(input: TraceOutput) -> @location(0) vec4<f32> {
+    var color = input.color;
+    if (input.gradient > 0.5) {
+        // Same green, yellow, red zones as fs_spectrum_bar
+        let height = clamp(input.height, 0.0, 1.0);
+        if (height > 0.8) {
+            let t = (height - 0.8) / 0.2;
+            color = vec4<f32>(1.0, max(0.0, 1.0 - t * 0.7), 0.1, color.a);
+        } else if (height > 0.5) {
+            let t = (height - 0.5) / 0.3;
+            color = vec4<f32>(0.5 + t * 0.5, 1.0, 0.1, color.a);
+        } else {
+            color = vec4<f32>(0.2, 0.5 + height, 0.2, color.a);
+        }
+    }
+
+    let coverage = clamp(input.halfWidth + 0.5 - abs(input.across), 0.0, 1.0);
+    color.a = color.a * coverage;
+    return color;
+}
@@ -0,0 +1,183 @@
+/**
+ * BespokeSynth WASM - AudioWorklet Audio Backend Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "AudioWorkletBackend.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+namespace bespoke {
+namespace wasm {
+
+static const char* kProcessorName = "bespoke-processor";
+
+AudioWorkletBackend::AudioWorkletBackend() {
+}
+
+AudioWorkletBackend::~AudioWorkletBackend() {
+    shutdown();
+}
+
+bool AudioWorkletBackend::initialize(int sampleRate, int bufferSize, int numOutputChannels, int numInputChannels) {
+    mSampleRate = sampleRate;
+    mNumOutputChannels = std::min(numOutputChannels, kMaxChannels);
+    mNumInputChannels = std::min(numInputChannels, kMaxChannels);
+    
+    printf("AudioWorkletBackend: Initializing AudioWorklet audio...\n");
+    printf("  Sample rate: %d\n", sampleRate);
+    printf("  Buffer size: %d (requested %d)\n", kQuantumSize, bufferSize);
+    printf("  Output channels: %d\n", mNumOutputChannels);
+    printf("  Input channels: %d\n", mNumInputChannels);
+    
+    EmscriptenWebAudioCreateAttributes attributes = {};
+    attributes.latencyHint = "interactive";
+    attributes.sampleRate = static_cast<uint32_t>(sampleRate);
+    
+    mContext = emscripten_create_audio_context(&attributes);
+    if (mContext <= 0) {
+        printf("AudioWorkletBackend: Failed to create AudioContext\n");
+        mContext = 0;
+        return false;
+    }
+    
+    // The worklet thread, processor and node come up asynchronously, the
+    // context stays silent until the node is connected
+    emscripten_start_wasm_audio_worklet_thread_async(mContext, mWorkletStack, kWorkletStackSize,
+                                                     &AudioWorkletBackend::onWorkletThreadStarted, this);
+    return true;
+}
+
+void AudioWorkletBackend::shutdown() {
+    stop();
+    
+    if (mContext != 0) {
+        mNodeReady = false;
+        emscripten_destroy_audio_context(mContext);
+        mContext = 0;
+        mNode = 0;
+        printf("AudioWorkletBackend: Shutdown complete\n");
+    }
+}
+
+bool AudioWorkletBackend::start() {
+    if (mContext == 0) {
+        printf("AudioWorkletBackend: Cannot start - no audio context\n");
+        return false;
+    }
+    
+    // Browsers keep new contexts suspended until a user gesture resumes them
+    emscripten_resume_audio_context_sync(mContext);
+    mIsRunning = true;
+    
+    printf("AudioWorkletBackend: Audio started%s\n", mNodeReady ? "" : " (worklet still loading)");
+    return true;
+}
+
+void AudioWorkletBackend::stop() {
+    // The context keeps running, process() outputs silence while stopped
+    mIsRunning = false;
+    mOutputLevel.store(0.0f);
+    mInputLevel.store(0.0f);
+    
+    printf("AudioWorkletBackend: Audio stopped\n");
+}
+
+void AudioWorkletBackend::onWorkletThreadStarted(EMSCRIPTEN_WEBAUDIO_T context, EM_BOOL success, void* userData) {
+    if (!success) {
+        printf("AudioWorkletBackend: Failed to start audio worklet thread\n");
+        return;
+    }
+    
+    WebAudioWorkletProcessorCreateOptions options = {};
+    options.name = kProcessorName;
+    emscripten_create_wasm_audio_worklet_processor_async(context, &options,
+                                                         &AudioWorkletBackend::onProcessorCreated, userData);
+}
+
+void AudioWorkletBackend::onProcessorCreated(EMSCRIPTEN_WEBAUDIO_T context, EM_BOOL success, void* userData) {
+    AudioWorkletBackend* backend = static_cast<AudioWorkletBackend*>(userData);
+    if (!success) {
+        printf("AudioWorkletBackend: Failed to create audio worklet processor\n");
+        return;
+    }
+    
+    int outputChannelCounts[1] = { backend->mNumOutputChannels };
+    EmscriptenAudioWorkletNodeCreateOptions options = {};
+    options.numberOfInputs = backend->mNumInputChannels > 0 ? 1 : 0;
+    options.numberOfOutputs = 1;
+    options.outputChannelCounts = outputChannelCounts;
+    
+    backend->mNode = emscripten_create_wasm_audio_worklet_node(context, kProcessorName, &options,
+                                                              &AudioWorkletBackend::processStatic, backend);
+    emscripten_audio_node_connect(backend->mNode, context, 0, 0);
+    backend->mNodeReady = true;
+    
+    printf("AudioWorkletBackend: Worklet node connected\n");
+}
+
+EM_BOOL AudioWorkletBackend::processStatic(int numInputs, const AudioSampleFrame* inputs,
+                                           int numOutputs, AudioSampleFrame* outputs,
+                                           int numParams, const AudioParamFrame* params, void* userData) {
+    AudioWorkletBackend* backend = static_cast<AudioWorkletBackend*>(userData);
+    if (numOutputs > 0) {
+        backend->process(numInputs > 0 ? &inputs[0] : nullptr, &outputs[0]);
+    }
+    return EM_TRUE;  // Keep the node alive
+}
+
+void AudioWorkletBackend::process(const AudioSampleFrame* input, AudioSampleFrame* output) {
+    // Runs on the audio rendering thread: no logging, no allocation
+    int numOutputChannels = std::min(output->numberOfChannels, mNumOutputChannels);
+    
+    // The worklet's data is planar, one quantum per channel
+    std::memset(output->data, 0, output->numberOfChannels * kQuantumSize * sizeof(float));
+    
+    if (!mIsRunning.load() || !mCallback || numOutputChannels <= 0) {
+        return;
+    }
+    
+    float* outputPtrs[kMaxChannels];
+    for (int ch = 0; ch < numOutputChannels; ch++) {
+        outputPtrs[ch] = output->data + ch * kQuantumSize;
+    }
+    
+    const float* inputPtrs[kMaxChannels];
+    float inputLevel = 0.0f;
+    int numDeliveredInputChannels = input ? input->numberOfChannels : 0;
+    for (int ch = 0; ch < mNumInputChannels; ch++) {
+        if (ch < numDeliveredInputChannels) {
+            inputPtrs[ch] = input->data + ch * kQuantumSize;
+            for (int i = 0; i < kQuantumSize; i++) {
+                inputLevel = std::max(inputLevel, std::abs(inputPtrs[ch][i]));
+            }
+        } else {
+            inputPtrs[ch] = mSilence;
+        }
+    }
+    
+    mCallback(
+        mNumInputChannels > 0 ? inputPtrs : nullptr,
+        outputPtrs,
+        mNumInputChannels,
+        numOutputChannels,
+        kQuantumSize
+    );
+    
+    float outputLevel = 0.0f;
+    for (int ch = 0; ch < numOutputChannels; ch++) {
+        for (int i = 0; i < kQuantumSize; i++) {
+            outputLevel = std::max(outputLevel, std::abs(outputPtrs[ch][i]));
+        }
+    }
+    
+    mOutputLevel.store(outputLevel);
+    mInputLevel.store(inputLevel);
+}
+
+} // namespace wasm
+} // namespace bespoke
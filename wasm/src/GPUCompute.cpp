@@ -0,0 +1,507 @@
+/**
+ * BespokeSynth WASM - GPU Compute Implementation
+ *
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "GPUCompute.h"
+#include "WebGPUContext.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace bespoke {
+namespace wasm {
+
+namespace {
+
+WGPUStringView stringView(const char* str) {
+    return WGPUStringView{str, strlen(str)};
+}
+
+const uint64_t kInitialBufferFloats = 1 << 16;
+const uint32_t kWorkgroupSize = 64;
+const int kSerialWrap = 1 << 24;  // Keeps tickets in range of an int
+
+// One dispatch per job, the job's Params picked with a dynamic offset
+const char* kComputeShader = R"(
+struct Params {
+    inputOffset: u32,
+    outputOffset: u32,
+    count: u32,
+    size: u32,
+    historyPos: u32,
+    historyLength: u32,
+    firstPartition: u32,
+};
+
+@group(0) @binding(0) var<uniform> params: Params;
+@group(0) @binding(1) var<storage, read> input: array<f32>;
+@group(0) @binding(2) var<storage, read_write> output: array<f32>;
+
+@group(1) @binding(0) var<storage, read> spectra: array<f32>;
+@group(1) @binding(1) var<storage, read> history: array<f32>;
+
+const TWO_PI: f32 = 6.283185307;
+const INV_TWO_PI: f32 = 0.159154943;
+
+var<workgroup> partialSums: array<f32, 64>;
+
+// One workgroup per output sample, its threads splitting the partials between them.
+// Input is phase, phaseInc, amp and ampInc, count of each
+@compute @workgroup_size(64)
+fn cs_additive(@builtin(workgroup_id) group: vec3<u32>, @builtin(local_invocation_index) lane: u32) {
+    let n = f32(group.x + 1u);
+    var sum = 0.0;
+    for (var i = lane; i < params.count; i += 64u) {
+        let base = params.inputOffset + i;
+        let phase = input[base];
+        let phaseInc = input[base + params.count];
+        let amp = input[base + params.count * 2u];
+        let ampInc = input[base + params.count * 3u];
+        // Wrapped in cycles first, sin() loses precision far from zero
+        let cycles = fract(phase * INV_TWO_PI + n * (phaseInc * INV_TWO_PI));
+        sum += (amp + n * ampInc) * sin(cycles * TWO_PI);
+    }
+
+    partialSums[lane] = sum;
+    workgroupBarrier();
+    for (var stride = 32u; stride > 0u; stride >>= 1u) {
+        if (lane < stride) {
+            partialSums[lane] += partialSums[lane + stride];
+        }
+        workgroupBarrier();
+    }
+    if (lane == 0u) {
+        output[params.outputOffset + group.x] = partialSums[0];
+    }
+}
+
+// One thread per bin, summing over the partitions like ConvolutionEngine::MultiplyAccumulate
+@compute @workgroup_size(64)
+fn cs_spectral_mac(@builtin(global_invocation_id) id: vec3<u32>) {
+    let k = id.x;
+    let numBins = params.size;
+    if (k >= numBins) {
+        return;
+    }
+
+    let stride = numBins * 2u;
+    var accRe = 0.0;
+    var accIm = 0.0;
+    for (var i = 0u; i < params.count; i++) {
+        let x = ((params.historyPos + i + params.firstPartition) % params.historyLength) * stride + k;
+        let h = i * stride + k;
+        let xRe = history[x];
+        let xIm = history[x + numBins];
+        let hRe = spectra[h];
+        let hIm = spectra[h + numBins];
+        accRe += xRe * hRe - xIm * hIm;
+        accIm += xRe * hIm + xIm * hRe;
+    }
+    output[params.outputOffset + k] = accRe;
+    output[params.outputOffset + numBins + k] = accIm;
+}
+)";
+
+} // namespace
+
+GPUCompute* GPUCompute::sLive = nullptr;
+
+GPUCompute::GPUCompute(WebGPUContext& context)
+    : mContext(context) {
+    sLive = this;
+}
+
+GPUCompute::~GPUCompute() {
+    if (sLive == this) sLive = nullptr;
+    for (Batch& batch : mBatches) releaseBatch(batch);
+    for (int i = 0; i < kMaxSpectralBanks; ++i) DestroySpectralBank(i);
+    for (WGPUBuffer params : mParamsBuffer) {
+        if (params) wgpuBufferRelease(params);
+    }
+    if (mAdditivePipeline) wgpuComputePipelineRelease(mAdditivePipeline);
+    if (mSpectralPipeline) wgpuComputePipelineRelease(mSpectralPipeline);
+    if (mBatchLayout) wgpuBindGroupLayoutRelease(mBatchLayout);
+    if (mBankLayout) wgpuBindGroupLayoutRelease(mBankLayout);
+}
+
+WGPUBuffer GPUCompute::createBuffer(uint64_t size, WGPUBufferUsage usage) {
+    WGPUBufferDescriptor bufferDesc = {};
+    bufferDesc.size = size;
+    bufferDesc.usage = usage;
+    return wgpuDeviceCreateBuffer(mContext.getDevice(), &bufferDesc);
+}
+
+bool GPUCompute::initialize() {
+    WGPUDevice device = mContext.getDevice();
+    if (!device) return false;
+
+    WGPUShaderSourceWGSL shaderWGSL = {};
+    shaderWGSL.chain.sType = WGPUSType_ShaderSourceWGSL;
+    shaderWGSL.code = stringView(kComputeShader);
+    WGPUShaderModuleDescriptor shaderDesc = {};
+    shaderDesc.nextInChain = (WGPUChainedStruct*)&shaderWGSL;
+    WGPUShaderModule shaderModule = wgpuDeviceCreateShaderModule(device, &shaderDesc);
+    if (!shaderModule) {
+        printf("GPUCompute: ERROR - Failed to create the compute shader module\n");
+        return false;
+    }
+
+    WGPUBindGroupLayoutEntry batchEntries[3] = {};
+    for (int i = 0; i < 3; ++i) {
+        batchEntries[i].binding = i;
+        batchEntries[i].visibility = WGPUShaderStage_Compute;
+    }
+    batchEntries[0].buffer.type = WGPUBufferBindingType_Uniform;
+    batchEntries[0].buffer.hasDynamicOffset = true;
+    batchEntries[0].buffer.minBindingSize = sizeof(JobParams);
+    batchEntries[1].buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
+    batchEntries[2].buffer.type = WGPUBufferBindingType_Storage;
+
+    WGPUBindGroupLayoutDescriptor batchLayoutDesc = {};
+    batchLayoutDesc.entryCount = 3;
+    batchLayoutDesc.entries = batchEntries;
+    mBatchLayout = wgpuDeviceCreateBindGroupLayout(device, &batchLayoutDesc);
+
+    WGPUBindGroupLayoutEntry bankEntries[2] = {};
+    for (int i = 0; i < 2; ++i) {
+        bankEntries[i].binding = i;
+        bankEntries[i].visibility = WGPUShaderStage_Compute;
+        bankEntries[i].buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
+    }
+
+    WGPUBindGroupLayoutDescriptor bankLayoutDesc = {};
+    bankLayoutDesc.entryCount = 2;
+    bankLayoutDesc.entries = bankEntries;
+    mBankLayout = wgpuDeviceCreateBindGroupLayout(device, &bankLayoutDesc);
+
+    auto createPipeline = [&](const char* entryPoint, int numLayouts) -> WGPUComputePipeline {
+        WGPUBindGroupLayout layouts[2] = {mBatchLayout, mBankLayout};
+        WGPUPipelineLayoutDescriptor layoutDesc = {};
+        layoutDesc.bindGroupLayoutCount = numLayouts;
+        layoutDesc.bindGroupLayouts = layouts;
+        WGPUPipelineLayout layout = wgpuDeviceCreatePipelineLayout(device, &layoutDesc);
+
+        WGPUComputePipelineDescriptor pipelineDesc = {};
+        pipelineDesc.layout = layout;
+        pipelineDesc.compute.module = shaderModule;
+        pipelineDesc.compute.entryPoint = stringView(entryPoint);
+        WGPUComputePipeline pipeline = wgpuDeviceCreateComputePipeline(device, &pipelineDesc);
+        if (layout) wgpuPipelineLayoutRelease(layout);
+        if (!pipeline) printf("GPUCompute: ERROR - Failed to create the %s pipeline\n", entryPoint);
+        return pipeline;
+    };
+
+    if (mBatchLayout && mBankLayout) {
+        mAdditivePipeline = createPipeline("cs_additive", 1);
+        mSpectralPipeline = createPipeline("cs_spectral_mac", 2);
+    }
+    wgpuShaderModuleRelease(shaderModule);
+
+    for (WGPUBuffer& params : mParamsBuffer) {
+        params = createBuffer(kMaxJobsPerBatch * sizeof(JobParams), WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst);
+    }
+    mParamsStaging.reserve(kMaxJobsPerBatch);
+    for (Batch& batch : mBatches) {
+        batch.jobs.reserve(kMaxJobsPerBatch);
+        batch.input.reserve(kInitialBufferFloats);
+        batch.results.reserve(kInitialBufferFloats);
+    }
+
+    bool ok = mAdditivePipeline && mSpectralPipeline && std::all_of(std::begin(mParamsBuffer), std::end(mParamsBuffer), [](WGPUBuffer buffer) { return buffer != nullptr; });
+    printf("GPUCompute: %s\n", ok ? "Compute offload ready" : "Compute offload unavailable, DSP stays on the CPU");
+    return ok;
+}
+
+int GPUCompute::CreateSpectralBank(const float* spectra, int numPartitions, int numBins, int historyLength) {
+    if (numPartitions <= 0 || numBins <= 0 || historyLength < numPartitions) return -1;
+
+    int index = -1;
+    for (int i = 0; i < kMaxSpectralBanks; ++i) {
+        if (!mBanks[i].spectra) {
+            index = i;
+            break;
+        }
+    }
+    if (index == -1) return -1;
+
+    SpectralBank& bank = mBanks[index];
+    uint64_t spectrumBytes = static_cast<uint64_t>(numBins) * 2 * sizeof(float);
+    bank.spectra = createBuffer(spectrumBytes * numPartitions, WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst);
+    bank.history = createBuffer(spectrumBytes * historyLength, WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst);
+    if (!bank.spectra || !bank.history) {
+        DestroySpectralBank(index);
+        return -1;
+    }
+    // New buffers start zeroed, which is what an empty history is
+    wgpuQueueWriteBuffer(mContext.getQueue(), bank.spectra, 0, spectra, spectrumBytes * numPartitions);
+
+    WGPUBindGroupEntry entries[2] = {};
+    entries[0].binding = 0;
+    entries[0].buffer = bank.spectra;
+    entries[0].size = spectrumBytes * numPartitions;
+    entries[1].binding = 1;
+    entries[1].buffer = bank.history;
+    entries[1].size = spectrumBytes * historyLength;
+
+    WGPUBindGroupDescriptor bindGroupDesc = {};
+    bindGroupDesc.layout = mBankLayout;
+    bindGroupDesc.entryCount = 2;
+    bindGroupDesc.entries = entries;
+    bank.bindGroup = wgpuDeviceCreateBindGroup(mContext.getDevice(), &bindGroupDesc);
+    if (!bank.bindGroup) {
+        DestroySpectralBank(index);
+        return -1;
+    }
+
+    bank.numPartitions = numPartitions;
+    bank.numBins = numBins;
+    bank.historyLength = historyLength;
+    return index;
+}
+
+void GPUCompute::ClearSpectralBank(int index) {
+    if (index < 0 || index >= kMaxSpectralBanks || !mBanks[index].history) return;
+
+    // Submitted right away, so it lands before any history written after it
+    const SpectralBank& bank = mBanks[index];
+    WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(mContext.getDevice(), nullptr);
+    wgpuCommandEncoderClearBuffer(encoder, bank.history, 0, static_cast<uint64_t>(bank.numBins) * 2 * sizeof(float) * bank.historyLength);
+    WGPUCommandBuffer commands = wgpuCommandEncoderFinish(encoder, nullptr);
+    wgpuQueueSubmit(mContext.getQueue(), 1, &commands);
+    wgpuCommandBufferRelease(commands);
+    wgpuCommandEncoderRelease(encoder);
+}
+
+void GPUCompute::DestroySpectralBank(int index) {
+    if (index < 0 || index >= kMaxSpectralBanks) return;
+
+    // Batches already submitted keep their own references to the buffers
+    SpectralBank& bank = mBanks[index];
+    if (bank.bindGroup) wgpuBindGroupRelease(bank.bindGroup);
+    if (bank.spectra) wgpuBufferRelease(bank.spectra);
+    if (bank.history) wgpuBufferRelease(bank.history);
+    bank = SpectralBank();
+
+    // Queued this callback but not submitted yet, its bind group is gone
+    for (Batch& batch : mBatches) {
+        if (batch.state != BatchState::Recording) continue;
+        for (Job& job : batch.jobs) {
+            if (job.bank == index) job.workgroups = 0;
+        }
+    }
+}
+
+GPUCompute::Batch* GPUCompute::getRecordingBatch() {
+    Batch& batch = mBatches[mSerial % kNumBatches];
+    if (batch.state == BatchState::Recording && batch.serial == mSerial) return &batch;
+
+    // Still waiting on the readback from kNumBatches callbacks ago, nothing goes out this callback
+    if (batch.state == BatchState::InFlight) return nullptr;
+
+    batch.state = BatchState::Recording;
+    batch.serial = mSerial;
+    batch.jobs.clear();
+    batch.input.clear();
+    batch.outputFloats = 0;
+    return &batch;
+}
+
+int GPUCompute::addJob(Batch& batch, int bank, uint32_t workgroups, JobParams params, uint32_t outputFloats) {
+    params.outputOffset = batch.outputFloats;
+    batch.outputFloats += outputFloats;
+    batch.jobs.push_back({bank, workgroups, params});
+    return batch.serial * kMaxJobsPerBatch + static_cast<int>(batch.jobs.size()) - 1;
+}
+
+int GPUCompute::QueueSpectralMultiply(int index, const float* spectrum, int historyPos, int firstPartition) {
+    if (index < 0 || index >= kMaxSpectralBanks || !mBanks[index].history) return -1;
+    const SpectralBank& bank = mBanks[index];
+    if (historyPos < 0 || historyPos >= bank.historyLength || firstPartition < 0) return -1;
+
+    Batch* batch = getRecordingBatch();
+    if (!batch || batch->jobs.size() >= kMaxJobsPerBatch) return -1;
+
+    // Written straight into the history, queue writes land before the batch's dispatches
+    uint64_t spectrumBytes = static_cast<uint64_t>(bank.numBins) * 2 * sizeof(float);
+    wgpuQueueWriteBuffer(mContext.getQueue(), bank.history, spectrumBytes * historyPos, spectrum, spectrumBytes);
+
+    JobParams params = {};
+    params.count = bank.numPartitions;
+    params.size = bank.numBins;
+    params.historyPos = historyPos;
+    params.historyLength = bank.historyLength;
+    params.firstPartition = firstPartition;
+    uint32_t workgroups = (bank.numBins + kWorkgroupSize - 1) / kWorkgroupSize;
+    return addJob(*batch, index, workgroups, params, bank.numBins * 2);
+}
+
+int GPUCompute::QueueAdditive(const float* phase, const float* phaseInc, const float* amp, const float* ampInc, int numPartials, int numSamples) {
+    if (numPartials <= 0 || numSamples <= 0) return -1;
+
+    Batch* batch = getRecordingBatch();
+    if (!batch || batch->jobs.size() >= kMaxJobsPerBatch) return -1;
+
+    JobParams params = {};
+    params.inputOffset = static_cast<uint32_t>(batch->input.size());
+    params.count = numPartials;
+    params.size = numSamples;
+    for (const float* values : {phase, phaseInc, amp, ampInc}) {
+        batch->input.insert(batch->input.end(), values, values + numPartials);
+    }
+    return addJob(*batch, -1, numSamples, params, numSamples);
+}
+
+bool GPUCompute::prepareBuffers(Batch& batch) {
+    bool changed = false;
+    uint64_t inputBytes = std::max<uint64_t>(batch.input.size(), 1) * sizeof(float);
+    if (inputBytes > batch.inputCapacity) {
+        uint64_t capacity = std::max<uint64_t>(batch.inputCapacity, kInitialBufferFloats * sizeof(float));
+        while (capacity < inputBytes) capacity *= 2;
+        if (batch.inputBuffer) wgpuBufferRelease(batch.inputBuffer);
+        batch.inputBuffer = createBuffer(capacity, WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst);
+        batch.inputCapacity = batch.inputBuffer ? capacity : 0;
+        changed = true;
+    }
+
+    uint64_t outputBytes = static_cast<uint64_t>(batch.outputFloats) * sizeof(float);
+    if (outputBytes > batch.outputCapacity) {
+        uint64_t capacity = std::max<uint64_t>(batch.outputCapacity, kInitialBufferFloats * sizeof(float));
+        while (capacity < outputBytes) capacity *= 2;
+        if (batch.outputBuffer) wgpuBufferRelease(batch.outputBuffer);
+        if (batch.readbackBuffer) wgpuBufferRelease(batch.readbackBuffer);
+        batch.outputBuffer = createBuffer(capacity, WGPUBufferUsage_Storage | WGPUBufferUsage_CopySrc);
+        batch.readbackBuffer = createBuffer(capacity, WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst);
+        batch.outputCapacity = (batch.outputBuffer && batch.readbackBuffer) ? capacity : 0;
+        changed = true;
+    }
+
+    if (!batch.inputCapacity || !batch.outputCapacity) return false;
+    if (batch.bindGroup && !changed) return true;
+
+    int index = static_cast<int>(&batch - mBatches);
+    WGPUBindGroupEntry entries[3] = {};
+    entries[0].binding = 0;
+    entries[0].buffer = mParamsBuffer[index];
+    entries[0].size = sizeof(JobParams);
+    entries[1].binding = 1;
+    entries[1].buffer = batch.inputBuffer;
+    entries[1].size = batch.inputCapacity;
+    entries[2].binding = 2;
+    entries[2].buffer = batch.outputBuffer;
+    entries[2].size = batch.outputCapacity;
+
+    WGPUBindGroupDescriptor bindGroupDesc = {};
+    bindGroupDesc.layout = mBatchLayout;
+    bindGroupDesc.entryCount = 3;
+    bindGroupDesc.entries = entries;
+    if (batch.bindGroup) wgpuBindGroupRelease(batch.bindGroup);
+    batch.bindGroup = wgpuDeviceCreateBindGroup(mContext.getDevice(), &bindGroupDesc);
+    return batch.bindGroup != nullptr;
+}
+
+void GPUCompute::endCallback() {
+    Batch& batch = mBatches[mSerial % kNumBatches];
+    mSerial = (mSerial + 1) % kSerialWrap;
+    if (batch.state != BatchState::Recording || batch.jobs.empty()) return;
+
+    if (!prepareBuffers(batch)) {
+        printf("GPUCompute: ERROR - Failed to allocate buffers for %d jobs\n", static_cast<int>(batch.jobs.size()));
+        batch.state = BatchState::Idle;
+        return;
+    }
+
+    int index = static_cast<int>(&batch - mBatches);
+    WGPUQueue queue = mContext.getQueue();
+    mParamsStaging.clear();
+    for (const Job& job : batch.jobs) mParamsStaging.push_back(job.params);
+    wgpuQueueWriteBuffer(queue, mParamsBuffer[index], 0, mParamsStaging.data(), mParamsStaging.size() * sizeof(JobParams));
+    if (!batch.input.empty()) {
+        wgpuQueueWriteBuffer(queue, batch.inputBuffer, 0, batch.input.data(), batch.input.size() * sizeof(float));
+    }
+
+    WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(mContext.getDevice(), nullptr);
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, nullptr);
+    for (size_t i = 0; i < batch.jobs.size(); ++i) {
+        const Job& job = batch.jobs[i];
+        if (job.workgroups == 0) continue;
+        uint32_t offset = static_cast<uint32_t>(i * sizeof(JobParams));
+        if (job.bank == -1) {
+            wgpuComputePassEncoderSetPipeline(pass, mAdditivePipeline);
+        } else {
+            wgpuComputePassEncoderSetPipeline(pass, mSpectralPipeline);
+            wgpuComputePassEncoderSetBindGroup(pass, 1, mBanks[job.bank].bindGroup, 0, nullptr);
+        }
+        wgpuComputePassEncoderSetBindGroup(pass, 0, batch.bindGroup, 1, &offset);
+        wgpuComputePassEncoderDispatchWorkgroups(pass, job.workgroups, 1, 1);
+    }
+    wgpuComputePassEncoderEnd(pass);
+    wgpuComputePassEncoderRelease(pass);
+
+    uint64_t outputBytes = static_cast<uint64_t>(batch.outputFloats) * sizeof(float);
+    wgpuCommandEncoderCopyBufferToBuffer(encoder, batch.outputBuffer, 0, batch.readbackBuffer, 0, outputBytes);
+    WGPUCommandBuffer commands = wgpuCommandEncoderFinish(encoder, nullptr);
+    wgpuQueueSubmit(queue, 1, &commands);
+    wgpuCommandBufferRelease(commands);
+    wgpuCommandEncoderRelease(encoder);
+
+    batch.state = BatchState::InFlight;
+    WGPUBufferMapCallbackInfo callbackInfo = {};
+    callbackInfo.mode = WGPUCallbackMode_AllowSpontaneous;
+    callbackInfo.callback = onReadbackMapped;
+    callbackInfo.userdata1 = this;
+    callbackInfo.userdata2 = &batch;
+    wgpuBufferMapAsync(batch.readbackBuffer, WGPUMapMode_Read, 0, outputBytes, callbackInfo);
+}
+
+void GPUCompute::onReadbackMapped(WGPUMapAsyncStatus status, WGPUStringView message, void* userdata1, void* userdata2) {
+    if (userdata1 != sLive) return;
+    Batch& batch = *static_cast<Batch*>(userdata2);
+    if (status != WGPUMapAsyncStatus_Success) {
+        printf("GPUCompute: Readback failed: %.*s\n", static_cast<int>(message.length), message.data ? message.data : "");
+        batch.state = BatchState::Idle;
+        return;
+    }
+
+    // Copied out so the readback buffer is free for the next batch in this slot right away
+    uint64_t outputBytes = static_cast<uint64_t>(batch.outputFloats) * sizeof(float);
+    const float* mapped = static_cast<const float*>(wgpuBufferGetConstMappedRange(batch.readbackBuffer, 0, outputBytes));
+    if (mapped) {
+        batch.results.assign(mapped, mapped + batch.outputFloats);
+        batch.state = BatchState::Mapped;
+    } else {
+        batch.state = BatchState::Idle;
+    }
+    wgpuBufferUnmap(batch.readbackBuffer);
+}
+
+bool GPUCompute::Collect(int ticket, float* out, int size) {
+    if (ticket < 0) return false;
+
+    int serial = ticket / kMaxJobsPerBatch;
+    size_t jobIndex = ticket % kMaxJobsPerBatch;
+    const Batch& batch = mBatches[serial % kNumBatches];
+    if (batch.serial != serial || jobIndex >= batch.jobs.size() || batch.jobs[jobIndex].workgroups == 0) return false;
+    if (batch.state != BatchState::Mapped) {
+        ++mNumLateResults;
+        return false;
+    }
+
+    const Job& job = batch.jobs[jobIndex];
+    uint32_t jobFloats = job.bank == -1 ? job.params.size : job.params.size * 2;
+    std::copy_n(batch.results.begin() + job.params.outputOffset, std::min<uint32_t>(jobFloats, size), out);
+    return true;
+}
+
+void GPUCompute::releaseBatch(Batch& batch) {
+    if (batch.bindGroup) wgpuBindGroupRelease(batch.bindGroup);
+    if (batch.inputBuffer) wgpuBufferRelease(batch.inputBuffer);
+    if (batch.outputBuffer) wgpuBufferRelease(batch.outputBuffer);
+    if (batch.readbackBuffer) wgpuBufferRelease(batch.readbackBuffer);
+    batch = Batch();
+}
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,133 @@
+/**
+ * BespokeSynth WASM - Glyph Atlas Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "GlyphAtlas.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+// Private copy of stb_truetype, so it can't clash with the one fontstash compiles
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#include "nanovg/stb_truetype.h"
+
+namespace bespoke {
+namespace wasm {
+
+static const unsigned char kOnEdgeValue = 128;
+static const float kPixelDistScale = 128.0f / GlyphAtlas::kPadding;  // full 0..255 range spans the padding
+
+struct GlyphAtlas::FontInfo {
+    stbtt_fontinfo info;
+};
+
+GlyphAtlas::GlyphAtlas() {
+}
+
+GlyphAtlas::~GlyphAtlas() {
+    delete mFont;
+}
+
+bool GlyphAtlas::build(const char* fontPath) {
+    mValid = false;
+
+    FILE* file = fopen(fontPath, "rb");
+    if (!file) {
+        printf("GlyphAtlas: ERROR - Could not open font %s\n", fontPath);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    mFontData.resize(size > 0 ? size : 0);
+    size_t read = size > 0 ? fread(mFontData.data(), 1, size, file) : 0;
+    fclose(file);
+
+    if (read != mFontData.size() || mFontData.empty()) {
+        printf("GlyphAtlas: ERROR - Could not read font %s\n", fontPath);
+        return false;
+    }
+
+    delete mFont;
+    mFont = new FontInfo();
+    if (!stbtt_InitFont(&mFont->info, mFontData.data(), stbtt_GetFontOffsetForIndex(mFontData.data(), 0))) {
+        printf("GlyphAtlas: ERROR - %s is not a usable TrueType font\n", fontPath);
+        return false;
+    }
+
+    // Size by em height, so kBaseSize matches what fontSize() means elsewhere
+    mScale = stbtt_ScaleForMappingEmToPixels(&mFont->info, kBaseSize);
+
+    mPixels.assign(kAtlasSize * kAtlasSize, 0);
+    mGlyphs.assign(kLastCodepoint - kFirstCodepoint + 1, Glyph());
+
+    // Simple shelf packing, glyphs are all about the same height
+    int penX = 1;
+    int penY = 1;
+    int shelfHeight = 0;
+
+    for (int codepoint = kFirstCodepoint; codepoint <= kLastCodepoint; ++codepoint) {
+        Glyph& glyph = mGlyphs[codepoint - kFirstCodepoint];
+        memset(&glyph, 0, sizeof(glyph));
+
+        int advance = 0;
+        int leftSideBearing = 0;
+        stbtt_GetCodepointHMetrics(&mFont->info, codepoint, &advance, &leftSideBearing);
+        glyph.advance = advance * mScale;
+
+        int w = 0, h = 0, xoff = 0, yoff = 0;
+        unsigned char* sdf = stbtt_GetCodepointSDF(&mFont->info, mScale, codepoint, kPadding,
+                                                   kOnEdgeValue, kPixelDistScale, &w, &h, &xoff, &yoff);
+        if (!sdf) continue;  // nothing to draw, e.g. space
+
+        if (penX + w + 1 > kAtlasSize) {
+            penX = 1;
+            penY += shelfHeight + 1;
+            shelfHeight = 0;
+        }
+        if (penY + h + 1 > kAtlasSize) {
+            printf("GlyphAtlas: WARNING - Atlas full, dropping glyphs from '%c'\n", codepoint);
+            stbtt_FreeSDF(sdf, nullptr);
+            break;
+        }
+
+        for (int row = 0; row < h; ++row) {
+            memcpy(&mPixels[(penY + row) * kAtlasSize + penX], sdf + row * w, w);
+        }
+        stbtt_FreeSDF(sdf, nullptr);
+
+        glyph.u0 = static_cast<float>(penX) / kAtlasSize;
+        glyph.v0 = static_cast<float>(penY) / kAtlasSize;
+        glyph.u1 = static_cast<float>(penX + w) / kAtlasSize;
+        glyph.v1 = static_cast<float>(penY + h) / kAtlasSize;
+        glyph.xOffset = static_cast<float>(xoff);
+        glyph.yOffset = static_cast<float>(yoff);
+        glyph.width = static_cast<float>(w);
+        glyph.height = static_cast<float>(h);
+        glyph.visible = true;
+
+        penX += w + 1;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+
+    mValid = true;
+    printf("GlyphAtlas: Built %d glyphs from %s\n", kLastCodepoint - kFirstCodepoint + 1, fontPath);
+    return true;
+}
+
+const GlyphAtlas::Glyph& GlyphAtlas::getGlyph(int codepoint) const {
+    if (codepoint < kFirstCodepoint || codepoint > kLastCodepoint) codepoint = '?';
+    return mGlyphs[codepoint - kFirstCodepoint];
+}
+
+float GlyphAtlas::getKerning(int first, int second) const {
+    if (!mValid) return 0.0f;
+    return stbtt_GetCodepointKernAdvance(&mFont->info, first, second) * mScale;
+}
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,82 @@
+/**
+ * BespokeSynth WASM - Input Queue Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "InputQueue.h"
+#include <cstdio>
+
+namespace bespoke {
+namespace wasm {
+
+void InputQueue::pushMouseMove(float x, float y) {
+    bool dragging = mButtonsDown != 0;
+    InputEvent* last = back();
+    if (last && last->type == InputEventType::MouseMove && (!dragging || mCount >= kDragCoalesceThreshold)) {
+        last->x = x;
+        last->y = y;
+        return;
+    }
+    push({InputEventType::MouseMove, x, y, 0, 0});
+}
+
+void InputQueue::pushMouseDown(float x, float y, int button) {
+    mButtonsDown |= 1 << button;
+    push({InputEventType::MouseDown, x, y, button, 0});
+}
+
+void InputQueue::pushMouseUp(float x, float y, int button) {
+    mButtonsDown &= ~(1 << button);
+    push({InputEventType::MouseUp, x, y, button, 0});
+}
+
+void InputQueue::pushMouseWheel(float deltaX, float deltaY) {
+    // Consecutive wheel ticks add up to the same scroll
+    InputEvent* last = back();
+    if (last && last->type == InputEventType::MouseWheel) {
+        last->x += deltaX;
+        last->y += deltaY;
+        return;
+    }
+    push({InputEventType::MouseWheel, deltaX, deltaY, 0, 0});
+}
+
+void InputQueue::pushKeyDown(int keyCode, int modifiers) {
+    push({InputEventType::KeyDown, 0.0f, 0.0f, keyCode, modifiers});
+}
+
+void InputQueue::pushKeyUp(int keyCode, int modifiers) {
+    push({InputEventType::KeyUp, 0.0f, 0.0f, keyCode, modifiers});
+}
+
+void InputQueue::drain(const Handler& handler) {
+    // Handlers may push more events, those wait for the next frame
+    uint32_t count = mCount;
+    for (uint32_t i = 0; i < count; ++i) {
+        InputEvent event = mEvents[mHead];
+        mHead = (mHead + 1) % kCapacity;
+        --mCount;
+        handler(event);
+    }
+}
+
+void InputQueue::push(const InputEvent& event) {
+    if (mCount == kCapacity) {
+        // Only happens if frames stop being drawn, e.g. while init is still running
+        if (mDropped++ == 0) {
+            printf("InputQueue: Full, dropping events\n");
+        }
+        return;
+    }
+    mEvents[(mHead + mCount) % kCapacity] = event;
+    ++mCount;
+}
+
+InputEvent* InputQueue::back() {
+    return mCount > 0 ? &mEvents[(mHead + mCount - 1) % kCapacity] : nullptr;
+}
+
+} // namespace wasm
+} // namespace bespoke
@@ -91,19 +91,16 @@ void Knob::render(WebGPURenderer& renderer, float x, float y, float size) {
     }
 }
 
+// All styles are built from the renderer's instanced SDF shapes, so a panel of knobs
+// costs a handful of instances each and renders in a single draw
 void Knob::renderClassicKnob(WebGPURenderer& renderer, float x, float y, float size) {
     float radius = size * 0.4f;
-    float normalizedValue = getValueNormalized();
     
     // Draw shadow
-    renderer.fillColor(Color(0.0f, 0.0f, 0.0f, 0.3f));
-    renderer.circle(x + 2, y + 2, radius);
-    renderer.fill();
+    renderer.drawCircle(x + 2, y + 2, radius, Color(0.0f, 0.0f, 0.0f, 0.3f));
     
-    // Draw main knob body
-    renderer.fillColor(mBackgroundColor);
-    renderer.circle(x, y, radius);
-    renderer.fill();
+    // Draw main knob body with the outer ring
+    renderer.drawCircle(x, y, radius, mBackgroundColor, mForegroundColor, 1.0f);
     
     // Draw 3D effect - highlight
     Color highlight(
@@ -112,11 +109,7 @@ void Knob::renderClassicKnob(WebGPURenderer& renderer, float x, float y, float s
         std::min(1.0f, mBackgroundColor.b + 0.2f),
         1.0f
     );
-    renderer.strokeColor(highlight);
-    renderer.strokeWidth(2.0f);
-    renderer.beginPath();
-    renderer.arc(x, y, radius * 0.95f, -kPi * 0.75f, kPi * 0.25f, 0);
-    renderer.stroke();
+    renderer.drawArc(x, y, radius * 0.9f, -kPi * 0.75f, kPi * 0.25f, 2.0f, highlight);
     
     // Draw 3D effect - shadow
     Color shadow(
@@ -125,16 +118,7 @@ void Knob::renderClassicKnob(WebGPURenderer& renderer, float x, float y, float s
         mBackgroundColor.b * 0.6f,
         1.0f
     );
-    renderer.strokeColor(shadow);
-    renderer.beginPath();
-    renderer.arc(x, y, radius * 0.95f, kPi * 0.25f, kPi * 1.25f, 0);
-    renderer.stroke();
-    
-    // Draw outer ring
-    renderer.strokeColor(mForegroundColor);
-    renderer.strokeWidth(1.0f);
-    renderer.circle(x, y, radius);
-    renderer.stroke();
+    renderer.drawArc(x, y, radius * 0.9f, kPi * 0.25f, kPi * 1.25f, 2.0f, shadow);
     
     // Draw indicator line
     float angle = valueToAngle(mAnimatedValue);
@@ -146,24 +130,13 @@ void Knob::renderClassicKnob(WebGPURenderer& renderer, float x, float y, float s
     float x2 = x + cosf(angle) * outerRadius;
     float y2 = y + sinf(angle) * outerRadius;
     
-    renderer.strokeColor(mIndicatorColor);
-    renderer.strokeWidth(3.0f);
-    renderer.line(x1, y1, x2, y2);
+    renderer.drawLine(x1, y1, x2, y2, 3.0f, mIndicatorColor);
     
     // Draw modulation ring if modulation is active
     if (std::abs(mModulationAmount) > 0.001f) {
         float modValue = std::max(mMin, std::min(mMax, mValue + mModulationValue));
         float modAngle = valueToAngle(modValue);
-        
-        renderer.strokeColor(Color(0.3f, 0.7f, 1.0f, 0.8f));
-        renderer.strokeWidth(4.0f);
-        renderer.beginPath();
-        if (mModulationAmount > 0) {
-            renderer.arc(x, y, radius + 5, angle, modAngle, 0);
-        } else {
-            renderer.arc(x, y, radius + 5, modAngle, angle, 0);
-        }
-        renderer.stroke();
+        renderer.drawArc(x, y, radius + 5, angle, modAngle, 4.0f, Color(0.3f, 0.7f, 1.0f, 0.8f));
     }
 }
 
@@ -171,75 +144,45 @@ void Knob::renderVintageKnob(WebGPURenderer& renderer, float x, float y, float s
     float radius = size * 0.4f;
     
     // Outer ring (metal)
-    renderer.fillColor(Color(0.4f, 0.4f, 0.42f, 1.0f));
-    renderer.circle(x, y, radius);
-    renderer.fill();
+    renderer.drawCircle(x, y, radius, Color(0.4f, 0.4f, 0.42f, 1.0f));
     
     // Metal texture with knurling
-    renderer.strokeColor(Color(0.5f, 0.5f, 0.52f, 1.0f));
-    renderer.strokeWidth(1.0f);
+    Color knurl(0.5f, 0.5f, 0.52f, 1.0f);
     for (int i = 0; i < 24; i++) {
         float a = (static_cast<float>(i) / 24.0f) * 2.0f * kPi;
         float x1 = x + cosf(a) * radius * 0.7f;
         float y1 = y + sinf(a) * radius * 0.7f;
         float x2 = x + cosf(a) * radius * 0.95f;
         float y2 = y + sinf(a) * radius * 0.95f;
-        renderer.line(x1, y1, x2, y2);
+        renderer.drawLine(x1, y1, x2, y2, 1.0f, knurl);
     }
     
     // Center cap
-    renderer.fillColor(Color(0.3f, 0.3f, 0.32f, 1.0f));
-    renderer.circle(x, y, radius * 0.5f);
-    renderer.fill();
+    renderer.drawCircle(x, y, radius * 0.5f, Color(0.3f, 0.3f, 0.32f, 1.0f));
     
     // Pointer
     float angle = valueToAngle(mAnimatedValue);
     float px = x + cosf(angle) * radius * 0.35f;
     float py = y + sinf(angle) * radius * 0.35f;
     
-    renderer.fillColor(Color(0.9f, 0.9f, 0.8f, 1.0f));
-    renderer.circle(px, py, radius * 0.1f);
-    renderer.fill();
+    renderer.drawCircle(px, py, radius * 0.1f, Color(0.9f, 0.9f, 0.8f, 1.0f));
 }
 
 void Knob::renderModernKnob(WebGPURenderer& renderer, float x, float y, float size) {
     float radius = size * 0.4f;
-    float normalizedValue = getValueNormalized();
     
     // Background arc (full range)
-    renderer.strokeColor(Color(0.3f, 0.3f, 0.3f, 1.0f));
-    renderer.strokeWidth(4.0f);
-    renderer.beginPath();
-    renderer.arc(x, y, radius, kStartAngle, kEndAngle, 0);
-    renderer.stroke();
+    renderer.drawArc(x, y, radius, kStartAngle, kEndAngle, 4.0f, Color(0.3f, 0.3f, 0.3f, 1.0f));
     
-    // Value arc
-    if (mBipolar) {
-        float centerAngle = kStartAngle + kAngleRange * 0.5f;
-        float valueAngle = valueToAngle(mAnimatedValue);
-        
-        renderer.strokeColor(mIndicatorColor);
-        renderer.strokeWidth(4.0f);
-        renderer.beginPath();
-        if (normalizedValue >= 0.5f) {
-            renderer.arc(x, y, radius, centerAngle, valueAngle, 0);
-        } else {
-            renderer.arc(x, y, radius, valueAngle, centerAngle, 0);
-        }
-        renderer.stroke();
-    } else {
-        float valueAngle = valueToAngle(mAnimatedValue);
-        renderer.strokeColor(mIndicatorColor);
-        renderer.strokeWidth(4.0f);
-        renderer.beginPath();
-        renderer.arc(x, y, radius, kStartAngle, valueAngle, 0);
-        renderer.stroke();
+    // Value arc, from the center for bipolar knobs. drawArc doesn't care which end comes first.
+    float valueAngle = valueToAngle(mAnimatedValue);
+    float fromAngle = mBipolar ? kStartAngle + kAngleRange * 0.5f : kStartAngle;
+    if (valueAngle != fromAngle) {
+        renderer.drawArc(x, y, radius, fromAngle, valueAngle, 4.0f, mIndicatorColor);
     }
     
     // Center dot
-    renderer.fillColor(mForegroundColor);
-    renderer.circle(x, y, radius * 0.15f);
-    renderer.fill();
+    renderer.drawCircle(x, y, radius * 0.15f, mForegroundColor);
 }
 
 void Knob::renderLEDKnob(WebGPURenderer& renderer, float x, float y, float size) {
@@ -258,52 +201,37 @@ void Knob::renderLEDKnob(WebGPURenderer& renderer, float x, float y, float size)
         
         // LED glow
         if (isLit) {
-            renderer.fillColor(Color(mIndicatorColor.r, mIndicatorColor.g, mIndicatorColor.b, 0.3f));
-            renderer.circle(ledX, ledY, radius * 0.12f);
-            renderer.fill();
+            renderer.drawCircle(ledX, ledY, radius * 0.12f,
+                                Color(mIndicatorColor.r, mIndicatorColor.g, mIndicatorColor.b, 0.3f));
         }
         
         // LED body
-        if (isLit) {
-            renderer.fillColor(mIndicatorColor);
-        } else {
-            renderer.fillColor(Color(0.15f, 0.15f, 0.15f, 1.0f));
-        }
-        renderer.circle(ledX, ledY, radius * 0.08f);
-        renderer.fill();
+        renderer.drawCircle(ledX, ledY, radius * 0.08f,
+                            isLit ? mIndicatorColor : Color(0.15f, 0.15f, 0.15f, 1.0f));
     }
     
     // Center knob
-    renderer.fillColor(mBackgroundColor);
-    renderer.circle(x, y, radius * 0.5f);
-    renderer.fill();
+    renderer.drawCircle(x, y, radius * 0.5f, mBackgroundColor);
     
     // Indicator
     float angle = valueToAngle(mAnimatedValue);
     float ix = x + cosf(angle) * radius * 0.35f;
     float iy = y + sinf(angle) * radius * 0.35f;
-    renderer.fillColor(mForegroundColor);
-    renderer.circle(ix, iy, radius * 0.08f);
-    renderer.fill();
+    renderer.drawCircle(ix, iy, radius * 0.08f, mForegroundColor);
 }
 
 void Knob::renderMinimalKnob(WebGPURenderer& renderer, float x, float y, float size) {
     float radius = size * 0.4f;
     
     // Simple circle
-    renderer.strokeColor(mForegroundColor);
-    renderer.strokeWidth(2.0f);
-    renderer.circle(x, y, radius);
-    renderer.stroke();
+    renderer.drawCircle(x, y, radius, Color(0.0f, 0.0f, 0.0f, 0.0f), mForegroundColor, 2.0f);
     
     // Dot indicator
     float angle = valueToAngle(mAnimatedValue);
     float dotX = x + cosf(angle) * radius * 0.7f;
     float dotY = y + sinf(angle) * radius * 0.7f;
     
-    renderer.fillColor(mIndicatorColor);
-    renderer.circle(dotX, dotY, radius * 0.15f);
-    renderer.fill();
+    renderer.drawCircle(dotX, dotY, radius * 0.15f, mIndicatorColor);
 }
 
 bool Knob::hitTest(float mouseX, float mouseY, float knobX, float knobY, float size) const {
@@ -0,0 +1,88 @@
+/**
+ * BespokeSynth WASM - Parameter Block Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "ParameterBlock.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace bespoke {
+namespace wasm {
+
+int ParameterBlock::addParameter(const std::string& name, float value, ApplyFn apply) {
+    if (mParameterCount == kMaxParameters) {
+        printf("ParameterBlock: No room for parameter '%s'\n", name.c_str());
+        return -1;
+    }
+    
+    int id = static_cast<int>(mParameterCount);
+    mParameterNames.push_back(name);
+    mApplyFns.push_back(std::move(apply));
+    mValues[id] = value;
+    mAppliedValues[id] = value;
+    ++mParameterCount;
+    return id;
+}
+
+int ParameterBlock::findParameter(const std::string& name) const {
+    auto found = std::find(mParameterNames.begin(), mParameterNames.end(), name);
+    return found != mParameterNames.end() ? static_cast<int>(found - mParameterNames.begin()) : -1;
+}
+
+const char* ParameterBlock::getParameterName(int id) const {
+    if (id < 0 || id >= static_cast<int>(mParameterCount)) return "";
+    return mParameterNames[id].c_str();
+}
+
+void ParameterBlock::setValue(int id, float value) {
+    if (id < 0 || id >= static_cast<int>(mParameterCount)) return;
+    mValues[id] = value;
+    mAppliedValues[id] = value;
+}
+
+float ParameterBlock::getValue(int id) const {
+    if (id < 0 || id >= static_cast<int>(mParameterCount)) return 0.0f;
+    return mValues[id];
+}
+
+void ParameterBlock::applyChanges() {
+    for (uint32_t id = 0; id < mParameterCount; ++id) {
+        if (mValues[id] != mAppliedValues[id]) {
+            float applied = mApplyFns[id] ? mApplyFns[id](mValues[id]) : mValues[id];
+            mValues[id] = applied;
+            mAppliedValues[id] = applied;
+        }
+    }
+}
+
+int ParameterBlock::addMeter(const std::string& name) {
+    if (mMeterCount == kMaxMeters) {
+        printf("ParameterBlock: No room for meter '%s'\n", name.c_str());
+        return -1;
+    }
+    
+    mMeterNames.push_back(name);
+    return static_cast<int>(mMeterCount++);
+}
+
+int ParameterBlock::findMeter(const std::string& name) const {
+    auto found = std::find(mMeterNames.begin(), mMeterNames.end(), name);
+    return found != mMeterNames.end() ? static_cast<int>(found - mMeterNames.begin()) : -1;
+}
+
+void ParameterBlock::setMeter(int id, float level) {
+    if (id < 0 || id >= static_cast<int>(mMeterCount)) return;
+    mMeters[id] = level;
+    mPeaks[id] = std::max(level, mPeaks[id] * kPeakDecay);
+}
+
+void ParameterBlock::setPanelFrameCount(int panel, uint32_t frames) {
+    if (panel < 0 || panel >= static_cast<int>(kMaxPanels)) return;
+    mPanelFrameCounts[panel] = frames;
+}
+
+} // namespace wasm
+} // namespace bespoke
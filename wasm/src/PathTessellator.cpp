@@ -0,0 +1,298 @@
+/**
+ * BespokeSynth WASM - Path Tessellator Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "PathTessellator.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace bespoke {
+namespace wasm {
+
+static const float kPointEpsilon = 1e-4f;
+static const float kRoundTolerance = 0.25f;  // max distance of round joins from the true arc
+static const float PI = 3.14159265f;
+
+namespace {
+
+struct Vec2 {
+    float x, y;
+};
+
+inline Vec2 pointAt(const std::vector<float>& points, uint32_t index) {
+    return {points[index * 2], points[index * 2 + 1]};
+}
+
+inline float cross(const Vec2& a, const Vec2& b, const Vec2& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+inline bool samePoint(const Vec2& a, const Vec2& b) {
+    return std::abs(a.x - b.x) < kPointEpsilon && std::abs(a.y - b.y) < kPointEpsilon;
+}
+
+inline void emit(std::vector<float>& out, const Vec2& a, const Vec2& b, const Vec2& c) {
+    out.push_back(a.x); out.push_back(a.y);
+    out.push_back(b.x); out.push_back(b.y);
+    out.push_back(c.x); out.push_back(c.y);
+}
+
+// Contour points with repeats removed, including a closing point that repeats the first
+void collectContour(const std::vector<float>& points, const PathContour& contour, std::vector<Vec2>& out) {
+    out.clear();
+    for (uint32_t i = 0; i < contour.count; ++i) {
+        Vec2 p = pointAt(points, contour.first + i);
+        if (out.empty() || !samePoint(out.back(), p)) out.push_back(p);
+    }
+    if (out.size() > 1 && samePoint(out.front(), out.back())) out.pop_back();
+}
+
+bool pointInTriangle(const Vec2& p, const Vec2& a, const Vec2& b, const Vec2& c) {
+    return cross(a, b, p) >= 0.0f && cross(b, c, p) >= 0.0f && cross(c, a, p) >= 0.0f;
+}
+
+int curveDivisions(float radius, float angle) {
+    float da = acosf(radius / (radius + kRoundTolerance)) * 2.0f;
+    return std::max(2, static_cast<int>(ceilf(angle / std::max(da, 0.01f))));
+}
+
+void earClip(const std::vector<Vec2>& poly, std::vector<float>& out) {
+    size_t n = poly.size();
+    if (n < 3) return;
+
+    float area = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        const Vec2& a = poly[i];
+        const Vec2& b = poly[(i + 1) % n];
+        area += a.x * b.y - b.x * a.y;
+    }
+    if (std::abs(area) < kPointEpsilon) return;
+
+    // Work with positive winding, so convex corners have a positive cross product
+    std::vector<uint32_t> remaining(n);
+    for (size_t i = 0; i < n; ++i) remaining[i] = static_cast<uint32_t>(area > 0 ? i : n - 1 - i);
+
+    size_t i = 0;
+    size_t misses = 0;
+    while (remaining.size() > 3) {
+        size_t count = remaining.size();
+        const Vec2& a = poly[remaining[(i + count - 1) % count]];
+        const Vec2& b = poly[remaining[i]];
+        const Vec2& c = poly[remaining[(i + 1) % count]];
+
+        bool ear = cross(a, b, c) > 0.0f;
+        for (size_t j = 0; ear && j < count; ++j) {
+            const Vec2& p = poly[remaining[j]];
+            if (samePoint(p, a) || samePoint(p, b) || samePoint(p, c)) continue;
+            if (pointInTriangle(p, a, b, c)) ear = false;
+        }
+
+        if (ear) {
+            emit(out, a, b, c);
+            remaining.erase(remaining.begin() + i);
+            if (i >= remaining.size()) i = 0;
+            misses = 0;
+        } else {
+            i = (i + 1) % count;
+            // A full lap without an ear means the outline intersects itself; fan what's left
+            if (++misses > count) break;
+        }
+    }
+
+    for (size_t j = 1; j + 1 < remaining.size(); ++j) {
+        emit(out, poly[remaining[0]], poly[remaining[j]], poly[remaining[j + 1]]);
+    }
+}
+
+void addJoin(const Vec2& p, const Vec2& d0, const Vec2& d1, float halfWidth, LineJoin join, std::vector<float>& out) {
+    Vec2 n0 = {-d0.y, d0.x};
+    Vec2 n1 = {-d1.y, d1.x};
+    float turn = d0.x * d1.y - d0.y * d1.x;
+    if (std::abs(turn) < 1e-6f && d0.x * d1.x + d0.y * d1.y > 0.0f) return;  // straight on, the segments already meet
+
+    // The gap to fill is on the outside of the turn
+    float side = turn > 0.0f ? -1.0f : 1.0f;
+    Vec2 a = {p.x + n0.x * halfWidth * side, p.y + n0.y * halfWidth * side};
+    Vec2 b = {p.x + n1.x * halfWidth * side, p.y + n1.y * halfWidth * side};
+
+    float cosAngle = std::max(-1.0f, std::min(1.0f, n0.x * n1.x + n0.y * n1.y));
+    if (join == LineJoin::Miter && 1.0f + cosAngle > 1e-6f) {
+        float miterScale = 1.0f / (1.0f + cosAngle);
+        if (sqrtf(2.0f * miterScale) <= PathTessellator::kMiterLimit) {
+            Vec2 m = {p.x + (n0.x + n1.x) * halfWidth * side * miterScale,
+                      p.y + (n0.y + n1.y) * halfWidth * side * miterScale};
+            emit(out, p, a, m);
+            emit(out, p, m, b);
+            return;
+        }
+    }
+
+    if (join == LineJoin::Round) {
+        // Sweep from a to b the short way around, which is the outside of the turn
+        float startAngle = atan2f(a.y - p.y, a.x - p.x);
+        float sweep = atan2f(b.y - p.y, b.x - p.x) - startAngle;
+        if (sweep > PI) sweep -= 2.0f * PI;
+        if (sweep < -PI) sweep += 2.0f * PI;
+        int divisions = curveDivisions(halfWidth, std::abs(sweep));
+
+        Vec2 previous = a;
+        for (int i = 1; i <= divisions; ++i) {
+            float t = startAngle + sweep * i / divisions;
+            Vec2 q = i == divisions ? b : Vec2{p.x + cosf(t) * halfWidth, p.y + sinf(t) * halfWidth};
+            emit(out, p, previous, q);
+            previous = q;
+        }
+        return;
+    }
+
+    emit(out, p, a, b);  // bevel
+}
+
+} // namespace
+
+void PathTessellator::fill(const std::vector<float>& points, const std::vector<PathContour>& contours,
+                           std::vector<float>& triangles) {
+    std::vector<Vec2> poly;
+    for (const PathContour& contour : contours) {
+        collectContour(points, contour, poly);
+        earClip(poly, triangles);
+    }
+}
+
+void PathTessellator::stroke(const std::vector<float>& points, const std::vector<PathContour>& contours,
+                             float width, LineJoin join, std::vector<float>& triangles) {
+    if (width <= 0.0f) return;
+    float halfWidth = width * 0.5f;
+
+    std::vector<Vec2> line;
+    std::vector<Vec2> directions;
+    for (const PathContour& contour : contours) {
+        collectContour(points, contour, line);
+        size_t n = line.size();
+        if (n < 2) continue;
+
+        bool closed = contour.closed && n >= 3;
+        size_t numSegments = closed ? n : n - 1;
+
+        directions.resize(numSegments);
+        for (size_t i = 0; i < numSegments; ++i) {
+            const Vec2& p0 = line[i];
+            const Vec2& p1 = line[(i + 1) % n];
+            float dx = p1.x - p0.x;
+            float dy = p1.y - p0.y;
+            float len = sqrtf(dx * dx + dy * dy);
+            directions[i] = {dx / len, dy / len};
+        }
+
+        for (size_t i = 0; i < numSegments; ++i) {
+            const Vec2& p0 = line[i];
+            const Vec2& p1 = line[(i + 1) % n];
+            Vec2 offset = {-directions[i].y * halfWidth, directions[i].x * halfWidth};
+            Vec2 a = {p0.x + offset.x, p0.y + offset.y};
+            Vec2 b = {p1.x + offset.x, p1.y + offset.y};
+            Vec2 c = {p1.x - offset.x, p1.y - offset.y};
+            Vec2 d = {p0.x - offset.x, p0.y - offset.y};
+            emit(triangles, a, b, c);
+            emit(triangles, a, c, d);
+        }
+
+        size_t firstJoin = closed ? 0 : 1;
+        size_t lastJoin = closed ? n : n - 1;
+        for (size_t i = firstJoin; i < lastJoin; ++i) {
+            const Vec2& incoming = directions[(i + numSegments - 1) % numSegments];
+            const Vec2& outgoing = directions[i % numSegments];
+            addJoin(line[i], incoming, outgoing, halfWidth, join, triangles);
+        }
+    }
+}
+
+const std::vector<float>& PathCache::getFill(const std::vector<float>& points, const std::vector<PathContour>& contours) {
+    return get(points, contours, false, 0.0f, LineJoin::Miter);
+}
+
+const std::vector<float>& PathCache::getStroke(const std::vector<float>& points, const std::vector<PathContour>& contours,
+                                              float width, LineJoin join) {
+    return get(points, contours, true, width, join);
+}
+
+const std::vector<float>& PathCache::get(const std::vector<float>& points, const std::vector<PathContour>& contours,
+                                        bool stroke, float width, LineJoin join) {
+    auto tessellate = [&](std::vector<float>& triangles) {
+        triangles.clear();
+        if (stroke)
+            PathTessellator::stroke(points, contours, width, join, triangles);
+        else
+            PathTessellator::fill(points, contours, triangles);
+    };
+
+    if (points.size() / 2 > kMaxCachedPoints) {
+        tessellate(mUncached);
+        return mUncached;
+    }
+
+    // FNV-1a over the geometry and style
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(points.data(), points.size() * sizeof(float));
+    for (const PathContour& contour : contours) {
+        mix(&contour.first, sizeof(contour.first));
+        mix(&contour.count, sizeof(contour.count));
+        mix(&contour.closed, sizeof(contour.closed));
+    }
+    mix(&stroke, sizeof(stroke));
+    mix(&width, sizeof(width));
+    mix(&join, sizeof(join));
+
+    auto it = mEntries.find(hash);
+    if (it != mEntries.end()) {
+        Entry& entry = it->second;
+        bool sameContours = entry.contours.size() == contours.size();
+        for (size_t i = 0; sameContours && i < contours.size(); ++i) {
+            sameContours = entry.contours[i].first == contours[i].first &&
+                           entry.contours[i].count == contours[i].count &&
+                           entry.contours[i].closed == contours[i].closed;
+        }
+        if (sameContours && entry.stroke == stroke && entry.width == width && entry.join == join &&
+            entry.points == points) {
+            entry.lastUsedFrame = mFrame;
+            return entry.triangles;
+        }
+    }
+
+    // Something is generating lots of one-off paths; start over rather than scanning for old ones
+    if (mEntries.size() >= kMaxEntries && it == mEntries.end()) mEntries.clear();
+
+    // New path, or a hash collision, which simply replaces the older path
+    Entry& entry = mEntries[hash];
+    entry.points = points;
+    entry.contours = contours;
+    entry.stroke = stroke;
+    entry.width = width;
+    entry.join = join;
+    entry.lastUsedFrame = mFrame;
+    tessellate(entry.triangles);
+    return entry.triangles;
+}
+
+void PathCache::endFrame() {
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (mFrame - it->second.lastUsedFrame > kMaxUnusedFrames)
+            it = mEntries.erase(it);
+        else
+            ++it;
+    }
+    ++mFrame;
+}
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,346 @@
+/**
+ * BespokeSynth WASM - Remote Session Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "RemoteSession.h"
+#include "WebGPURenderer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace bespoke {
+namespace wasm {
+
+namespace {
+
+// The desktop scrolls about this much for a notch that the browser reports as 100 pixels
+const float kWheelScale = -0.015f;
+const float kTitleBarHeight = 12.0f;
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) return fields;
+        start = tab + 1;
+    }
+}
+
+float number(const std::vector<std::string>& fields, size_t index) {
+    return index < fields.size() ? static_cast<float>(atof(fields[index].c_str())) : 0.0f;
+}
+
+std::string lastSegment(const std::string& path) {
+    size_t separator = path.rfind('~');
+    return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+// Modifiers as WasmMain.cpp packs them (1 shift, 2 alt, 4 ctrl, 8 meta), which is also what the server takes
+// Keys are sent as the characters typed, or by name, DOM key codes are layout dependent
+std::string keyName(int keyCode, int modifiers) {
+    switch (keyCode) {
+        case 8: return "backspace";
+        case 9: return "tab";
+        case 13: return "return";
+        case 27: return "escape";
+        case 37: return "left";
+        case 38: return "up";
+        case 39: return "right";
+        case 40: return "down";
+        case 46: return "delete";
+        case 16: case 17: case 18: case 91: case 93: return "";  // Modifiers on their own
+        default: break;
+    }
+    if (keyCode >= 'A' && keyCode <= 'Z' && !(modifiers & 1)) keyCode += 'a' - 'A';
+    return std::to_string(keyCode);
+}
+
+// DOM buttons are 0 left, 1 middle, 2 right; the server takes ModularSynth's 1 left, 2 right, 3 middle
+int serverButton(int domButton) {
+    return domButton == 1 ? 3 : domButton == 2 ? 2 : 1;
+}
+
+} // namespace
+
+RemoteSession::~RemoteSession() {
+    disconnect();
+}
+
+bool RemoteSession::connect(const char* url, const char* token) {
+    disconnect();
+    mToken = token ? token : "";
+    
+    if (!emscripten_websocket_is_supported()) {
+        printf("RemoteSession: WebSockets aren't supported here\n");
+        return false;
+    }
+    
+    EmscriptenWebSocketCreateAttributes attributes;
+    emscripten_websocket_init_create_attributes(&attributes);
+    attributes.url = url;
+    attributes.createOnMainThread = EM_TRUE;
+    
+    mSocket = emscripten_websocket_new(&attributes);
+    if (mSocket <= 0) {
+        printf("RemoteSession: Couldn't open %s\n", url);
+        mSocket = 0;
+        return false;
+    }
+    
+    emscripten_websocket_set_onopen_callback(mSocket, this, onOpen);
+    emscripten_websocket_set_onmessage_callback(mSocket, this, onMessage);
+    emscripten_websocket_set_onclose_callback(mSocket, this, onClose);
+    printf("RemoteSession: Connecting to %s\n", url);
+    return true;
+}
+
+void RemoteSession::disconnect() {
+    if (mSocket > 0) {
+        emscripten_websocket_close(mSocket, 1000, "");
+        emscripten_websocket_delete(mSocket);
+    }
+    mSocket = 0;
+    mOpen = false;
+    mOutgoing.clear();
+    clearState();
+}
+
+void RemoteSession::clearState() {
+    mModules.clear();
+    mCables.clear();
+    mControls.clear();
+}
+
+void RemoteSession::setViewport(int width, int height) {
+    if (width == mWidth && height == mHeight) return;
+    mWidth = width;
+    mHeight = height;
+    if (mOpen) {
+        mOutgoing += "resize\t" + std::to_string(width) + "\t" + std::to_string(height) + "\n";
+    }
+}
+
+void RemoteSession::sendInput(const InputEvent& event) {
+    if (!mOpen) return;
+    
+    char line[128];
+    line[0] = '\0';
+    int x = static_cast<int>(event.x);
+    int y = static_cast<int>(event.y);
+    switch (event.type) {
+        case InputEventType::MouseMove:
+            snprintf(line, sizeof(line), "move\t%d\t%d\t%d\n", x, y, mModifiers);
+            break;
+        case InputEventType::MouseDown:
+            // The server tracks one button, like a desktop drag
+            if (mHeldButton != -1) break;
+            mHeldButton = event.code;
+            snprintf(line, sizeof(line), "down\t%d\t%d\t%d\t%d\n", x, y, serverButton(event.code), mModifiers);
+            break;
+        case InputEventType::MouseUp:
+            if (event.code != mHeldButton) break;
+            mHeldButton = -1;
+            snprintf(line, sizeof(line), "up\t%d\t%d\t%d\t%d\n", x, y, serverButton(event.code), mModifiers);
+            break;
+        case InputEventType::MouseWheel:
+            snprintf(line, sizeof(line), "wheel\t%g\t%g\t%d\n", event.x * kWheelScale, event.y * kWheelScale, mModifiers);
+            break;
+        case InputEventType::KeyDown:
+        case InputEventType::KeyUp: {
+            mModifiers = event.modifiers;
+            std::string key = keyName(event.code, event.modifiers);
+            if (key.empty()) break;
+            if (event.type == InputEventType::KeyDown) {
+                snprintf(line, sizeof(line), "keydown\t%s\t0\t%d\n", key.c_str(), mModifiers);
+            } else {
+                snprintf(line, sizeof(line), "keyup\t%s\t%d\n", key.c_str(), mModifiers);
+            }
+            break;
+        }
+    }
+    mOutgoing += line;
+}
+
+void RemoteSession::flush() {
+    if (!mOpen || mOutgoing.empty()) return;
+    emscripten_websocket_send_utf8_text(mSocket, mOutgoing.c_str());
+    mOutgoing.clear();
+}
+
+EM_BOOL RemoteSession::onOpen(int eventType, const EmscriptenWebSocketOpenEvent* event, void* userData) {
+    auto* session = static_cast<RemoteSession*>(userData);
+    session->mOpen = true;
+    
+    // The server ignores everything until it has this
+    session->mOutgoing = "auth\t" + session->mToken + "\n";
+    
+    // Lay out for this canvas before the first state arrives
+    int width = session->mWidth;
+    int height = session->mHeight;
+    session->mWidth = session->mHeight = 0;
+    session->setViewport(width, height);
+    session->flush();
+    printf("RemoteSession: Connected\n");
+    return EM_TRUE;
+}
+
+EM_BOOL RemoteSession::onMessage(int eventType, const EmscriptenWebSocketMessageEvent* event, void* userData) {
+    if (!event->isText) return EM_TRUE;
+    
+    auto* session = static_cast<RemoteSession*>(userData);
+    const char* text = reinterpret_cast<const char*>(event->data);
+    size_t size = event->numBytes;
+    while (size > 0 && text[size - 1] == '\0') size--;  // Text messages come null terminated
+    
+    size_t start = 0;
+    while (start < size) {
+        size_t end = start;
+        while (end < size && text[end] != '\n') end++;
+        if (end > start) {
+            session->applyLine(splitFields(std::string(text + start, end - start)));
+        }
+        start = end + 1;
+    }
+    return EM_TRUE;
+}
+
+EM_BOOL RemoteSession::onClose(int eventType, const EmscriptenWebSocketCloseEvent* event, void* userData) {
+    auto* session = static_cast<RemoteSession*>(userData);
+    printf("RemoteSession: Disconnected (%d)\n", event->code);
+    session->mOpen = false;
+    session->mHeldButton = -1;
+    session->clearState();
+    return EM_TRUE;
+}
+
+void RemoteSession::applyLine(const std::vector<std::string>& fields) {
+    const std::string& kind = fields[0];
+    if (kind == "reset") {
+        clearState();
+    } else if (kind == "-" && fields.size() > 2) {
+        if (fields[1] == "m") mModules.erase(fields[2]);
+        else if (fields[1] == "p") mCables.erase(fields[2]);
+        else if (fields[1] == "c") mControls.erase(fields[2]);
+    } else if (kind == "v") {
+        mOffsetX = number(fields, 2);
+        mOffsetY = number(fields, 3);
+        mScale = number(fields, 4);
+    } else if (kind == "m" && fields.size() > 8) {
+        Module& module = mModules[fields[1]];
+        module.title = lastSegment(fields[1]);
+        module.x = number(fields, 3);
+        module.y = number(fields, 4);
+        module.w = number(fields, 5);
+        module.h = number(fields, 6);
+        module.minimized = fields[7] == "1";
+        module.enabled = fields[8] == "1";
+    } else if (kind == "p" && fields.size() > 1) {
+        mCables[fields[1]].assign(fields.begin() + 2, fields.end());
+    } else if (kind == "c" && fields.size() > 7) {
+        Control& control = mControls[fields[1]];
+        size_t separator = fields[1].rfind('~');
+        control.module = separator == std::string::npos ? "" : fields[1].substr(0, separator);
+        control.label = lastSegment(fields[1]);
+        control.x = number(fields, 2);
+        control.y = number(fields, 3);
+        control.w = number(fields, 4);
+        control.h = number(fields, 5);
+        control.value = number(fields, 6);
+        control.display = fields[7];
+    }
+}
+
+bool RemoteSession::findTarget(const std::string& path, float& x, float& y) const {
+    auto module = mModules.find(path);
+    if (module != mModules.end()) {
+        x = module->second.x + module->second.w * 0.5f;
+        y = module->second.y - kTitleBarHeight;
+        return true;
+    }
+    
+    auto control = mControls.find(path);
+    if (control != mControls.end()) {
+        auto owner = mModules.find(control->second.module);
+        if (owner == mModules.end()) return false;
+        x = owner->second.x + control->second.x + control->second.w * 0.5f;
+        y = owner->second.y + control->second.y + control->second.h * 0.5f;
+        return true;
+    }
+    return false;
+}
+
+void RemoteSession::render(WebGPURenderer& renderer, int width, int height) {
+    renderer.fillColor(Color(0.09f, 0.09f, 0.1f, 1.0f));
+    renderer.rect(0, 0, static_cast<float>(width), static_cast<float>(height));
+    renderer.fill();
+    
+    if (!mOpen) {
+        renderer.fillColor(Color(0.6f, 0.6f, 0.65f, 1.0f));
+        renderer.fontSize(14.0f);
+        renderer.text(20, 30, mSocket > 0 ? "Connecting to bespoke-server..." : "Not connected");
+        return;
+    }
+    
+    // Same mapping as the desktop canvas: screen = (canvas + draw offset) * draw scale.
+    // translate() adds in screen space, so the offset goes in scaled
+    renderer.save();
+    renderer.scale(mScale, mScale);
+    renderer.translate(mOffsetX * mScale, mOffsetY * mScale);
+    
+    for (const auto& module : mModules) {
+        const Module& m = module.second;
+        float bodyHeight = m.minimized ? 0.0f : m.h;
+        float alpha = m.enabled ? 1.0f : 0.5f;
+        renderer.fillColor(Color(0.2f, 0.2f, 0.22f, 0.95f * alpha));
+        renderer.roundedRect(m.x, m.y - kTitleBarHeight, m.w, bodyHeight + kTitleBarHeight, 3.0f);
+        renderer.fill();
+        renderer.fillColor(Color(0.85f, 0.85f, 0.9f, alpha));
+        renderer.fontSize(11.0f);
+        renderer.text(m.x + 3.0f, m.y - 2.0f, m.title.c_str());
+    }
+    
+    for (const auto& control : mControls) {
+        const Control& c = control.second;
+        auto owner = mModules.find(c.module);
+        if (owner == mModules.end() || owner->second.minimized) continue;
+        
+        float x = owner->second.x + c.x;
+        float y = owner->second.y + c.y;
+        renderer.fillColor(Color(0.12f, 0.12f, 0.13f, 1.0f));
+        renderer.rect(x, y, c.w, c.h);
+        renderer.fill();
+        renderer.fillColor(Color(0.35f, 0.45f, 0.6f, 1.0f));
+        renderer.rect(x, y, c.w * std::min(std::max(c.value, 0.0f), 1.0f), c.h);
+        renderer.fill();
+        
+        std::string label = c.label + ": " + c.display;
+        renderer.fillColor(Color(0.9f, 0.9f, 0.9f, 1.0f));
+        renderer.fontSize(std::min(c.h - 2.0f, 11.0f));
+        renderer.text(x + 2.0f, y + c.h - 3.0f, label.c_str());
+    }
+    
+    // Cables on top, they're what a remote patch is mostly about
+    for (const auto& cables : mCables) {
+        auto source = mModules.find(cables.first);
+        if (source == mModules.end()) continue;
+        const Module& m = source->second;
+        float x1 = m.x + m.w * 0.5f;
+        float y1 = m.y + (m.minimized ? 0.0f : m.h);
+        for (const auto& target : cables.second) {
+            float x2, y2;
+            if (findTarget(target, x2, y2)) {
+                renderer.drawCableWithSag(x1, y1, x2, y2, Color(0.55f, 0.6f, 0.7f, 0.8f), 2.0f, 0.2f);
+            }
+        }
+    }
+    
+    renderer.restore();
+}
+
+} // namespace wasm
+} // namespace bespoke
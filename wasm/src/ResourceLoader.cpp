@@ -0,0 +1,132 @@
+/**
+ * BespokeSynth WASM - Resource Loader Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "ResourceLoader.h"
+#include <emscripten.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace bespoke {
+namespace wasm {
+
+bool ResourceLoader::loadManifest(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        printf("ResourceLoader: No manifest at %s\n", path);
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        
+        size_t separator = line.find(' ');
+        if (separator == std::string::npos) continue;
+        
+        std::string resourcePath = line.substr(separator + 1);
+        Resource& resource = mResources[resourcePath];
+        resource.loader = this;
+        resource.path = resourcePath;
+        resource.size = strtoull(line.c_str(), nullptr, 10);
+        mTotalBytes += resource.size;
+    }
+    
+    printf("ResourceLoader: %zu resources (%zu KB) available on demand\n", mResources.size(), mTotalBytes / 1024);
+    return true;
+}
+
+bool ResourceLoader::isLoaded(const std::string& path) const {
+    auto resource = mResources.find(path);
+    return resource != mResources.end() && resource->second.state == State::Loaded;
+}
+
+bool ResourceLoader::isLoading(const std::string& path) const {
+    auto resource = mResources.find(path);
+    return resource != mResources.end() && resource->second.state == State::Loading;
+}
+
+size_t ResourceLoader::getSize(const std::string& path) const {
+    auto resource = mResources.find(path);
+    return resource != mResources.end() ? resource->second.size : 0;
+}
+
+void ResourceLoader::request(const std::string& path, ReadyCallback onReady) {
+    auto found = mResources.find(path);
+    if (found == mResources.end()) {
+        printf("ResourceLoader: '%s' is not in the manifest\n", path.c_str());
+        if (onReady) onReady(false);
+        return;
+    }
+    
+    Resource& resource = found->second;
+    if (resource.state == State::Loaded) {
+        if (onReady) onReady(true);
+        return;
+    }
+    
+    if (onReady) resource.pending.push_back(onReady);
+    if (resource.state == State::Loading) return;
+    
+    std::string filePath = std::string(kMountPoint) + "/" + resource.path;
+    if (!makeParentDirectories(filePath)) {
+        printf("ResourceLoader: Could not create the directories for %s\n", filePath.c_str());
+        finish(resource, false);
+        return;
+    }
+    
+    // Paths are sent as is, the sample names' spaces and brackets go through the browser's URL parsing
+    std::string url = std::string(kBaseUrl) + "/" + resource.path;
+    resource.state = State::Loading;
+    emscripten_async_wget2(url.c_str(), filePath.c_str(), "GET", "", &resource,
+                           &ResourceLoader::onLoaded, &ResourceLoader::onError, nullptr);
+}
+
+void ResourceLoader::markLoaded(const std::string& path) {
+    auto resource = mResources.find(path);
+    if (resource != mResources.end() && resource->second.state != State::Loaded) {
+        finish(resource->second, true);
+    }
+}
+
+void ResourceLoader::onLoaded(unsigned handle, void* userData, const char* file) {
+    Resource& resource = *static_cast<Resource*>(userData);
+    resource.loader->finish(resource, true);
+}
+
+void ResourceLoader::onError(unsigned handle, void* userData, int status) {
+    Resource& resource = *static_cast<Resource*>(userData);
+    printf("ResourceLoader: Failed to fetch %s (HTTP %d)\n", resource.path.c_str(), status);
+    resource.loader->finish(resource, false);
+}
+
+bool ResourceLoader::makeParentDirectories(const std::string& filePath) {
+    for (size_t slash = filePath.find('/', 1); slash != std::string::npos; slash = filePath.find('/', slash + 1)) {
+        std::string directory = filePath.substr(0, slash);
+        if (mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ResourceLoader::finish(Resource& resource, bool success) {
+    // A failed fetch may be a network hiccup, so the next request tries again
+    resource.state = success ? State::Loaded : State::NotLoaded;
+    if (success) mLoadedBytes += resource.size;
+    
+    std::vector<ReadyCallback> pending;
+    pending.swap(resource.pending);
+    for (auto& callback : pending) {
+        callback(success);
+    }
+}
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,210 @@
+/**
+ * BespokeSynth WASM - Sample Store Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "SampleStore.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace bespoke {
+namespace wasm {
+
+SampleStore& SampleStore::get() {
+    static SampleStore sStore;
+    return sStore;
+}
+
+int SampleStore::create(int numChannels, int64_t numFrames, int sampleRate) {
+    if (numChannels <= 0 || numFrames <= 0 || sampleRate <= 0) return -1;
+    
+    int id = -1;
+    for (int i = 0; i < kMaxSamples; ++i) {
+        if (mSamples[i] == nullptr) {
+            id = i;
+            break;
+        }
+    }
+    if (id == -1) {
+        printf("SampleStore: No room for another sample\n");
+        return -1;
+    }
+    
+    auto sample = std::make_unique<Sample>();
+    sample->numChannels = numChannels;
+    sample->numFrames = numFrames;
+    sample->sampleRate = sampleRate;
+    sample->numBlocks = static_cast<int>((numFrames + kBlockFrames - 1) / kBlockFrames);
+    sample->streamed = numFrames * numChannels * static_cast<int64_t>(sizeof(float)) > kMaxResidentBytes &&
+                       sample->numBlocks > kStreamSlots;
+    sample->numSlots = sample->streamed ? kStreamSlots : sample->numBlocks;
+    sample->slots = std::make_unique<Slot[]>(sample->numSlots);
+    sample->data.resize(static_cast<size_t>(sample->numSlots) * numChannels * kBlockFrames);
+    
+    // A resident sample wants everything, a streamed one its head and what comes right after
+    for (int slot = 0; slot < sample->numSlots; ++slot) {
+        sample->slots[slot].wanted.store(slot, std::memory_order_relaxed);
+    }
+    
+    sample->active.store(true, std::memory_order_release);
+    mSamples[id] = std::move(sample);
+    return id;
+}
+
+void SampleStore::release(int id) {
+    Sample* sample = find(id);
+    if (!sample) return;
+    sample->active.store(false, std::memory_order_release);
+    sample->releasedAt = mTakeCount;
+}
+
+SampleStore::Sample* SampleStore::find(int id) const {
+    if (id < 0 || id >= kMaxSamples || !mSamples[id]) return nullptr;
+    Sample* sample = mSamples[id].get();
+    return sample->active.load(std::memory_order_acquire) ? sample : nullptr;
+}
+
+int SampleStore::getSlot(const Sample& sample, int block) const {
+    if (!sample.streamed || block == 0) return block;
+    return 1 + (block - 1) % (kStreamSlots - 1);
+}
+
+bool SampleStore::read(int id, int channel, int64_t startFrame, int numFrames, float* out) {
+    Sample* sample = find(id);
+    if (!sample || channel < 0 || channel >= sample->numChannels) {
+        std::fill(out, out + numFrames, 0.0f);
+        return sample != nullptr;
+    }
+    
+    bool complete = true;
+    while (numFrames > 0) {
+        if (startFrame < 0 || startFrame >= sample->numFrames) {
+            // Before the start or past the end is silence, not something missing
+            int silent = startFrame < 0 ? static_cast<int>(std::min<int64_t>(numFrames, -startFrame)) : numFrames;
+            std::fill(out, out + silent, 0.0f);
+            out += silent;
+            startFrame += silent;
+            numFrames -= silent;
+            continue;
+        }
+        
+        int block = static_cast<int>(startFrame / kBlockFrames);
+        int offset = static_cast<int>(startFrame % kBlockFrames);
+        int count = static_cast<int>(std::min<int64_t>({numFrames, kBlockFrames - offset, sample->numFrames - startFrame}));
+        
+        int slotIndex = getSlot(*sample, block);
+        Slot& slot = sample->slots[slotIndex];
+        uint32_t version = slot.version.load(std::memory_order_acquire);
+        bool resident = (version & 1) == 0 && slot.block.load(std::memory_order_relaxed) == block;
+        if (resident) {
+            memcpy(out, getSlotData(*sample, slotIndex, channel) + offset, count * sizeof(float));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            resident = slot.version.load(std::memory_order_relaxed) == version;
+        }
+        
+        if (!resident) {
+            std::fill(out, out + count, 0.0f);
+            slot.wanted.store(block, std::memory_order_relaxed);
+            complete = false;
+        } else if (sample->streamed && block + 1 < sample->numBlocks) {
+            // Playback mostly moves forward, have the next block in by the time it gets there
+            Slot& next = sample->slots[getSlot(*sample, block + 1)];
+            if (next.block.load(std::memory_order_relaxed) != block + 1) {
+                next.wanted.store(block + 1, std::memory_order_relaxed);
+            }
+        }
+        
+        out += count;
+        startFrame += count;
+        numFrames -= count;
+    }
+    return complete;
+}
+
+int SampleStore::getNumChannels(int id) const {
+    Sample* sample = find(id);
+    return sample ? sample->numChannels : 0;
+}
+
+int64_t SampleStore::getNumFrames(int id) const {
+    Sample* sample = find(id);
+    return sample ? sample->numFrames : 0;
+}
+
+int SampleStore::getSampleRate(int id) const {
+    Sample* sample = find(id);
+    return sample ? sample->sampleRate : 0;
+}
+
+bool SampleStore::isStreamed(int id) const {
+    Sample* sample = find(id);
+    return sample && sample->streamed;
+}
+
+int64_t SampleStore::getResidentFrames(int id) const {
+    Sample* sample = find(id);
+    if (!sample) return 0;
+    
+    int64_t frames = 0;
+    for (int block = 0; block < sample->numBlocks; ++block) {
+        const Slot& slot = sample->slots[getSlot(*sample, block)];
+        if ((slot.version.load(std::memory_order_acquire) & 1) != 0 || slot.block.load(std::memory_order_relaxed) != block) break;
+        frames = std::min(sample->numFrames, static_cast<int64_t>(block + 1) * kBlockFrames);
+    }
+    return frames;
+}
+
+int SampleStore::takeRequests() {
+    ++mTakeCount;
+    int count = 0;
+    for (int id = 0; id < kMaxSamples; ++id) {
+        Sample* sample = mSamples[id].get();
+        if (!sample) continue;
+        
+        if (!sample->active.load(std::memory_order_relaxed)) {
+            if (mTakeCount - sample->releasedAt > kReleaseDelay) {
+                mSamples[id].reset();
+            }
+            continue;
+        }
+        
+        for (int slotIndex = 0; slotIndex < sample->numSlots && count < kMaxRequests; ++slotIndex) {
+            Slot& slot = sample->slots[slotIndex];
+            int wanted = slot.wanted.load(std::memory_order_relaxed);
+            if (wanted < 0 || slot.loading || wanted == slot.block.load(std::memory_order_relaxed)) continue;
+            if (getSlot(*sample, wanted) != slotIndex) continue;
+            
+            // Odd until blockReady(), so read() leaves the slot alone while JS fills it
+            slot.version.fetch_add(1, std::memory_order_acq_rel);
+            slot.block.store(wanted, std::memory_order_relaxed);
+            slot.loading = true;
+            
+            int64_t startFrame = static_cast<int64_t>(wanted) * kBlockFrames;
+            uint32_t* request = mRequests + count * kRequestWords;
+            request[0] = static_cast<uint32_t>(id);
+            request[1] = static_cast<uint32_t>(slotIndex);
+            request[2] = static_cast<uint32_t>(startFrame);
+            request[3] = static_cast<uint32_t>(std::min<int64_t>(kBlockFrames, sample->numFrames - startFrame));
+            request[4] = static_cast<uint32_t>(kBlockFrames);
+            request[5] = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(getSlotData(*sample, slotIndex, 0)));
+            ++count;
+        }
+    }
+    return count;
+}
+
+void SampleStore::blockReady(int id, int slotIndex, int64_t startFrame) {
+    Sample* sample = find(id);
+    if (!sample || slotIndex < 0 || slotIndex >= sample->numSlots) return;
+    
+    Slot& slot = sample->slots[slotIndex];
+    if (!slot.loading || static_cast<int64_t>(slot.block.load(std::memory_order_relaxed)) * kBlockFrames != startFrame) return;
+    slot.loading = false;
+    slot.version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,131 @@
+/**
+ * BespokeSynth WASM - Side Module Loader Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "SideModuleLoader.h"
+#include <emscripten.h>
+#include <dlfcn.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace bespoke {
+namespace wasm {
+
+using SideModuleInitFn = void (*)(SideModuleRegisterFn reg, void* context);
+
+bool SideModuleLoader::loadManifest(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        printf("SideModuleLoader: No manifest at %s\n", path);
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream entry(line);
+        std::string typeName, sideModulePath;
+        if (entry >> typeName >> sideModulePath && typeName[0] != '#') {
+            addManifestEntry(typeName, sideModulePath);
+        }
+    }
+    
+    printf("SideModuleLoader: %zu lazily loaded module types in %zu side modules\n",
+           mTypeToPath.size(), mSideModules.size());
+    return true;
+}
+
+void SideModuleLoader::addManifestEntry(const std::string& typeName, const std::string& sideModulePath) {
+    mTypeToPath[typeName] = sideModulePath;
+    SideModule& sideModule = mSideModules[sideModulePath];
+    sideModule.loader = this;
+    sideModule.path = sideModulePath;
+}
+
+std::vector<std::string> SideModuleLoader::getLazyTypes() const {
+    std::vector<std::string> types;
+    types.reserve(mTypeToPath.size());
+    for (const auto& entry : mTypeToPath) {
+        types.push_back(entry.first);
+    }
+    return types;
+}
+
+bool SideModuleLoader::isLoading(const std::string& typeName) const {
+    auto path = mTypeToPath.find(typeName);
+    if (path == mTypeToPath.end()) return false;
+    auto sideModule = mSideModules.find(path->second);
+    return sideModule != mSideModules.end() && sideModule->second.state == State::Loading;
+}
+
+void SideModuleLoader::request(const std::string& typeName, ReadyCallback onReady) {
+    if (isLoaded(typeName)) {
+        if (onReady) onReady(true);
+        return;
+    }
+    
+    auto path = mTypeToPath.find(typeName);
+    if (path == mTypeToPath.end()) {
+        printf("SideModuleLoader: Unknown module type '%s'\n", typeName.c_str());
+        if (onReady) onReady(false);
+        return;
+    }
+    
+    SideModule& sideModule = mSideModules[path->second];
+    if (onReady) sideModule.pending.push_back(onReady);
+    if (sideModule.state == State::Loading) return;
+    
+    // Not in the virtual file system, so the dynamic linker fetches it next to the main module
+    printf("SideModuleLoader: Fetching %s for '%s'\n", sideModule.path.c_str(), typeName.c_str());
+    sideModule.state = State::Loading;
+    emscripten_dlopen(sideModule.path.c_str(), RTLD_NOW | RTLD_LOCAL, &sideModule,
+                      &SideModuleLoader::onLoaded, &SideModuleLoader::onError);
+}
+
+SideModuleCreateFn SideModuleLoader::getCreator(const std::string& typeName) const {
+    auto creator = mCreators.find(typeName);
+    return creator != mCreators.end() ? creator->second : nullptr;
+}
+
+void SideModuleLoader::onLoaded(void* userData, void* handle) {
+    SideModule& sideModule = *static_cast<SideModule*>(userData);
+    sideModule.handle = handle;
+    
+    auto init = reinterpret_cast<SideModuleInitFn>(dlsym(handle, kInitSymbol));
+    if (!init) {
+        printf("SideModuleLoader: %s does not export %s\n", sideModule.path.c_str(), kInitSymbol);
+        sideModule.loader->finish(sideModule, false);
+        return;
+    }
+    
+    init(&SideModuleLoader::registerType, sideModule.loader);
+    sideModule.loader->finish(sideModule, true);
+}
+
+void SideModuleLoader::onError(void* userData) {
+    SideModule& sideModule = *static_cast<SideModule*>(userData);
+    printf("SideModuleLoader: Failed to load %s: %s\n", sideModule.path.c_str(), dlerror());
+    sideModule.loader->finish(sideModule, false);
+}
+
+void SideModuleLoader::registerType(void* context, const char* typeName, SideModuleCreateFn create) {
+    static_cast<SideModuleLoader*>(context)->mCreators[typeName] = create;
+}
+
+void SideModuleLoader::finish(SideModule& sideModule, bool success) {
+    // A failed fetch may be a network hiccup, so the next request tries again
+    sideModule.state = success ? State::Loaded : State::NotLoaded;
+    printf("SideModuleLoader: %s %s\n", sideModule.path.c_str(), success ? "loaded" : "failed");
+    
+    std::vector<ReadyCallback> pending;
+    pending.swap(sideModule.pending);
+    for (auto& callback : pending) {
+        callback(success);
+    }
+}
+
+} // namespace wasm
+} // namespace bespoke
@@ -0,0 +1,73 @@
+/**
+ * BespokeSynth WASM - Telemetry Implementation
+ * 
+ * Copyright (C) 2024
+ * Licensed under GNU GPL v3
+ */
+
+#include "Telemetry.h"
+#include <emscripten.h>
+#include <cstddef>
+
+namespace bespoke {
+namespace wasm {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "telemetry counters must be plain words for JS");
+
+// One-pole smoothing of the load, roughly a quarter second at 512 samples / 44.1kHz
+static const float kLoadSmoothing = 0.05f;
+
+Telemetry::Telemetry() {
+    reset();
+}
+
+void Telemetry::reset() {
+    mOriginMs = emscripten_get_now();
+    mLastAudioStartMs = 0.0;
+    mLastFrameStartMs = 0.0;
+    mCpuLoad = 0.0f;
+    mXrunCount = 0;
+}
+
+void Telemetry::recordAudioCallback(double startMs, double endMs, int numSamples, int sampleRate) {
+    if (sampleRate <= 0 || numSamples <= 0) return;
+    
+    double periodMs = 1000.0 * numSamples / sampleRate;
+    double durationMs = endMs - startMs;
+    double intervalMs = mLastAudioStartMs > 0.0 ? startMs - mLastAudioStartMs : periodMs;
+    mLastAudioStartMs = startMs;
+    
+    // Overran the buffer ourselves, or the browser called us too late to keep the device fed
+    if (durationMs > periodMs || intervalMs > periodMs * kLateCallbackPeriods) {
+        mXrunCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    float load = static_cast<float>(durationMs / periodMs);
+    mCpuLoad += (load - mCpuLoad) * kLoadSmoothing;
+    mBufferPeriodMs = static_cast<float>(periodMs);
+    
+    uint32_t count = mAudioCount.load(std::memory_order_relaxed);
+    float* slot = &mAudioRing[(count % kRingSize) * kAudioFields];
+    slot[0] = static_cast<float>(startMs - mOriginMs);
+    slot[1] = static_cast<float>(durationMs);
+    slot[2] = load;
+    slot[3] = static_cast<float>(intervalMs);
+    mAudioCount.store(count + 1, std::memory_order_release);
+}
+
+void Telemetry::recordFrame(double startMs, double submitStartMs, double endMs) {
+    double intervalMs = mLastFrameStartMs > 0.0 ? startMs - mLastFrameStartMs : 0.0;
+    mLastFrameStartMs = startMs;
+    mLastFrameMs = static_cast<float>(endMs - startMs);
+    
+    uint32_t count = mFrameCount.load(std::memory_order_relaxed);
+    float* slot = &mFrameRing[(count % kRingSize) * kFrameFields];
+    slot[0] = static_cast<float>(startMs - mOriginMs);
+    slot[1] = mLastFrameMs;
+    slot[2] = static_cast<float>(endMs - submitStartMs);
+    slot[3] = static_cast<float>(intervalMs);
+    mFrameCount.store(count + 1, std::memory_order_release);
+}
+
+} // namespace wasm
+} // namespace bespoke
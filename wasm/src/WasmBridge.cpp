@@ -9,8 +9,29 @@
 #include "WebGPUContext.h"
 #include "WebGPURenderer.h"
 #include "SDL2AudioBackend.h"
+#if BESPOKE_AUDIO_WORKLET
+#include "AudioWorkletBackend.h"
+#endif
+#if BESPOKE_SIDE_MODULES
+#include "SideModuleLoader.h"
+#endif
+#if BESPOKE_ENGINE
+#include "AudioEngine.h"
+#include "SynthGlobals.h"
+#endif
+#if BESPOKE_GPU_COMPUTE
+#include "GPUCompute.h"
+#endif
+#include "InputQueue.h"
 #include "Knob.h"
+#include "ParameterBlock.h"
+#include "RemoteSession.h"
+#include "ResourceLoader.h"
+#include "SampleStore.h"
+#include "Telemetry.h"
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <memory>
 #include <vector>
@@ -36,15 +57,57 @@ enum class InitState {
 // Global state
 static std::unique_ptr<WebGPUContext> gContext;
 static std::unique_ptr<WebGPURenderer> gRenderer;
-static std::unique_ptr<SDL2AudioBackend> gAudioBackend;
+static std::unique_ptr<AudioBackend> gAudioBackend;
 
 // Demo controls
 static std::vector<std::unique_ptr<Knob>> gKnobs;
 
+// Backgrounds, bezels and labels only change with the selected panel and the panel
+// status, so they're rendered into a layer once and redrawn only when one of those changes
+static int gChromeLayer = -1;
+
+static Telemetry gTelemetry;
+
+#if BESPOKE_ENGINE
+// Same audio path as ModularSynth::AudioOut
+static AudioEngine gEngine;
+#endif
+
+#if BESPOKE_GPU_COMPUTE
+// Where ConvolutionEngine and AdditiveBank send their heaviest work, see GPUCompute.h
+static std::unique_ptr<GPUCompute> gCompute;
+#endif
+
+// Control values and meters shared with JS, see ParameterBlock.h
+static ParameterBlock gParameters;
+static int gOutputMeter = -1;
+static int gInputMeter = -1;
+static uint32_t gRenderedFrames = 0;
+
+// DOM input, handled once per frame from bespoke_render
+static InputQueue gInput;
+
+// A bespoke-server's ui, drawn in place of the panels while connected
+static RemoteSession gRemote;
+static bool gRemoteActive = false;
+
+// Files under resource/, fetched when first needed instead of preloaded
+static ResourceLoader gResources;
+static const char* kResourceManifest = "/resource_manifest.txt";
+static const char* kPreloadedResources[] = {"frabk.ttf"};  // Needed to build the glyph atlas during init
+
+#if BESPOKE_SIDE_MODULES
+// Module types that live in side modules, fetched on first spawn
+static SideModuleLoader gSideModules;
+static const char* kSideModuleManifest = "/side_modules.txt";
+#endif
+
 static int gWidth = 800;
 static int gHeight = 600;
 static bool gInitialized = false;
-static float gTime = 0.0f;
+static float gRenderTime = 0.0f;
+static double gLastFrameMs = 0.0;
+static const double kMaxFrameDeltaMs = 100.0;  // so animations don't jump after rendering was paused
 static InitState gInitState = InitState::NotStarted;
 static std::string gInitErrorMessage;
 
@@ -77,10 +140,8 @@ static PanelStatus gPanelStatus[PANEL_COUNT] = {
 static const char* kVersion = "1.0.0-wasm";
 
 // Audio callback for demo (thread-safe)
-static void audioCallback(const float* const* input, float* const* output,
+static void generateAudio(const float* const* input, float* const* output,
                           int numInputChannels, int numOutputChannels, int numSamples) {
-    // Mark that audio callback is active
-    gAudioCallbackActive.store(true);
     
     // Simple demo: generate a sine wave with frequency controlled by first knob
     static float phase = 0.0f;
@@ -107,6 +168,48 @@ static void audioCallback(const float* const* input, float* const* output,
     }
 }
 
+#if BESPOKE_ENGINE
+static void renderEngine(const float* const* input, float* const* output,
+                         int numInputChannels, int numOutputChannels, int numSamples) {
+    if (numInputChannels == gEngine.GetNumInputChannels()) {
+        gEngine.ReadInput(input, numSamples, numInputChannels, 1);
+    }
+    gEngine.ProcessQueues(NextBufferTime(false));
+    gEngine.ProcessBuffer();
+    
+    for (int ch = 0; ch < numOutputChannels; ch++) {
+        if (ch < gEngine.GetNumOutputChannels()) {
+            memcpy(output[ch], gEngine.GetDeviceOutputBuffers()[ch], numSamples * sizeof(float));
+        } else {
+            memset(output[ch], 0, numSamples * sizeof(float));
+        }
+    }
+}
+#endif
+
+static void audioCallback(const float* const* input, float* const* output,
+                          int numInputChannels, int numOutputChannels, int numSamples) {
+    // Mark that audio callback is active
+    gAudioCallbackActive.store(true);
+    
+    double startMs = emscripten_get_now();
+#if BESPOKE_ENGINE
+    if (gEngine.HasSources() && numSamples == gBufferSize) {
+        renderEngine(input, output, numInputChannels, numOutputChannels, numSamples);
+    } else
+#endif
+    generateAudio(input, output, numInputChannels, numOutputChannels, numSamples);
+#if BESPOKE_GPU_COMPUTE
+    if (gCompute) {
+        gCompute->endCallback();
+    }
+#endif
+    double endMs = emscripten_get_now();
+    
+    int sampleRate = gAudioBackend ? gAudioBackend->getSampleRate() : 44100;
+    gTelemetry.recordAudioCallback(startMs, endMs, numSamples, sampleRate);
+}
+
 // Helper function to get panel name
 static const char* getPanelName(int panelIndex) {
     static const char* panelNames[] = {"Mixer", "Effects", "Sequencer"};
@@ -147,242 +250,321 @@ static void markPanelRunning(int panelIndex) {
     }
 }
 
-extern "C" {
+// Reports the end of initialization to JS, 0 on success or a negative error code
+static void notifyInitComplete(int status) {
+    printf("WasmBridge: notifying JS of init %s (%d)\n", status == 0 ? "complete" : "failure", status);
+    char script[128];
+    snprintf(script, sizeof(script), "if (window.__bespoke_on_init_complete) window.__bespoke_on_init_complete(%d);", status);
+    emscripten_run_script(script);
+}
 
-EMSCRIPTEN_KEEPALIVE int bespoke_init(int width, int height, int sampleRate, int bufferSize) {
-    printf("BespokeSynth WASM: Initializing (%dx%d, %dHz, %d samples)\n", 
-           width, height, sampleRate, bufferSize);
-    
-    if (gInitState != InitState::NotStarted) {
-        printf("BespokeSynth WASM: Already initialized or in progress (state=%d)\n", static_cast<int>(gInitState));
-        return gInitState == InitState::FullyInitialized ? 0 : 1;
+static void failInit(int status, const char* message) {
+    printf("BespokeSynth WASM: %s\n", message);
+    gInitState = InitState::Failed;
+    gInitErrorMessage = message;
+    notifyInitComplete(status);
+}
+
+static bool initRenderer() {
+    printf("WasmBridge: Initializing renderer...\n");
+    gRenderer = std::make_unique<WebGPURenderer>(*gContext);
+    if (!gRenderer->initialize()) {
+        failInit(-2, "Renderer initialization failed");
+        return false;
     }
     
-    gWidth = width;
-    gHeight = height;
-    gInitState = InitState::WebGPURequested;
+    gChromeLayer = gRenderer->createLayer();
     
-    // Initialize WebGPU context (asynchronous)
-    gContext = std::make_unique<WebGPUContext>();
-    printf("WasmBridge: starting async WebGPU initialization (selector=#canvas)\n");
-
-    bool started = gContext->initializeAsync("#canvas", [] (bool success) {
-        if (!success) {
-            printf("BespokeSynth WASM: Failed to initialize WebGPU\n");
-            printf("WasmBridge: notifying JS of init failure (-1)\n");
-            gInitState = InitState::Failed;
-            gInitErrorMessage = "WebGPU initialization failed";
-            // Notify JS that initialization failed
-            emscripten_run_script("if (window.__bespoke_on_init_complete) window.__bespoke_on_init_complete(-1);");
-            return;
-        }
+    printf("WasmBridge: Renderer initialized successfully\n");
+    gInitState = InitState::RendererReady;
+    return true;
+}
 
-        // WebGPU initialized successfully
-        printf("WasmBridge: WebGPU context ready, proceeding with remaining initialization\n");
-        gInitState = InitState::WebGPUReady;
-        
-        // Continue remaining initialization on success
-        gContext->resize(gWidth, gHeight);
-
-        // Initialize renderer
-        printf("WasmBridge: Initializing renderer...\n");
-        gRenderer = std::make_unique<WebGPURenderer>(*gContext);
-        if (!gRenderer->initialize()) {
-            printf("BespokeSynth WASM: Failed to initialize renderer\n");
-            printf("WasmBridge: notifying JS of init failure (-2)\n");
-            gInitState = InitState::Failed;
-            gInitErrorMessage = "Renderer initialization failed";
-            emscripten_run_script("if (window.__bespoke_on_init_complete) window.__bespoke_on_init_complete(-2);");
-            return;
-        }
-        
-        printf("WasmBridge: Renderer initialized successfully\n");
-        gInitState = InitState::RendererReady;
-
-        // Initialize audio backend
-        printf("WasmBridge: Initializing audio backend...\n");
-        gAudioBackend = std::make_unique<SDL2AudioBackend>();
-        if (!gAudioBackend->initialize(44100, 512, 2, 0)) {
-            printf("BespokeSynth WASM: Failed to initialize audio\n");
-            printf("WasmBridge: notifying JS of init failure (-3)\n");
-            gInitState = InitState::Failed;
-            gInitErrorMessage = "Audio backend initialization failed";
-            emscripten_run_script("if (window.__bespoke_on_init_complete) window.__bespoke_on_init_complete(-3);");
-            return;
-        }
+// Optional, everything runs on the CPU without it. Has to be in place before anything that
+// could use it is created, they decide when they're constructed
+static void initCompute() {
+#if BESPOKE_GPU_COMPUTE
+    gCompute = std::make_unique<GPUCompute>(*gContext);
+    if (gCompute->initialize()) {
+        ComputeOffload::Set(gCompute.get());
+    } else {
+        gCompute.reset();
+    }
+#endif
+}
 
-        printf("WasmBridge: Audio backend initialized successfully\n");
-        gInitState = InitState::AudioReady;
-        
-        // Set audio callback
-        gAudioBackend->setCallback(audioCallback);
-
-        // Create some demo knobs
-        printf("WasmBridge: Creating demo controls...\n");
-        gKnobs.clear();
-
-        auto knob1 = std::make_unique<Knob>("Frequency", 0.5f);
-        knob1->setRange(0.0f, 1.0f);
-        knob1->setStyle(KnobStyle::Classic);
-        knob1->setColors(
-            Color(0.25f, 0.25f, 0.28f, 1.0f),
-            Color(0.7f, 0.7f, 0.75f, 1.0f),
-            Color(0.4f, 0.8f, 0.5f, 1.0f)
-        );
-        gKnobs.push_back(std::move(knob1));
-
-        auto knob2 = std::make_unique<Knob>("Volume", 0.7f);
-        knob2->setRange(0.0f, 1.0f);
-        knob2->setStyle(KnobStyle::Modern);
-        knob2->setColors(
-            Color(0.2f, 0.2f, 0.22f, 1.0f),
-            Color(0.6f, 0.6f, 0.65f, 1.0f),
-            Color(0.3f, 0.7f, 0.9f, 1.0f)
-        );
-        gKnobs.push_back(std::move(knob2));
-
-        auto knob3 = std::make_unique<Knob>("Filter", 0.3f);
-        knob3->setRange(0.0f, 1.0f);
-        knob3->setStyle(KnobStyle::LED);
-        knob3->setColors(
-            Color(0.15f, 0.15f, 0.18f, 1.0f),
-            Color(0.5f, 0.5f, 0.55f, 1.0f),
-            Color(0.9f, 0.4f, 0.2f, 1.0f)
-        );
-        gKnobs.push_back(std::move(knob3));
+static bool initAudio() {
+    printf("WasmBridge: Initializing audio backend...\n");
+#if BESPOKE_AUDIO_WORKLET
+    // Render quanta are always 128 frames, the requested buffer size is ignored
+    gAudioBackend = std::make_unique<AudioWorkletBackend>();
+#else
+    gAudioBackend = std::make_unique<SDL2AudioBackend>();
+#endif
+    if (!gAudioBackend->initialize(44100, 512, 2, 0)) {
+        failInit(-3, "Audio backend initialization failed");
+        return false;
+    }
 
-        auto knob4 = std::make_unique<Knob>("Pan", 0.5f);
-        knob4->setRange(0.0f, 1.0f);
-        knob4->setBipolar(true);
-        knob4->setStyle(KnobStyle::Vintage);
-        gKnobs.push_back(std::move(knob4));
+    printf("WasmBridge: Audio backend initialized successfully\n");
+    gInitState = InitState::AudioReady;
 
-        // Mark all panels as loaded
-        printf("\n=== DEBUG: Panel Initialization ===\n");
-        for (int i = 0; i < PANEL_COUNT; i++) {
-            markPanelLoaded(i);
-        }
-        printf("=== Panel Initialization Complete ===\n\n");
+#if BESPOKE_ENGINE
+    // The engine processes one device buffer per callback, so they have to match
+    SetGlobalSampleRateAndBufferSize(gAudioBackend->getSampleRate(), gAudioBackend->getBufferSize());
+    gEngine.InitIOBuffers(gAudioBackend->getNumInputChannels(), gAudioBackend->getNumOutputChannels());
+    // No graph workers yet, but this also gives the main and audio threads their work buffers
+    gEngine.StartWorkers(0);
+#endif
+    
+    // Set audio callback
+    gAudioBackend->setCallback(audioCallback);
+    return true;
+}
 
-        gInitState = InitState::FullyInitialized;
-        gInitialized = true;
-        printf("BespokeSynth WASM: Initialization complete - all subsystems ready\n");
-        printf("WasmBridge: notifying JS of init complete (0)\n");
+static void createDemoControls() {
+    // Create some demo knobs
+    printf("WasmBridge: Creating demo controls...\n");
+    gKnobs.clear();
 
-        // Notify JS that initialization finished successfully
-        emscripten_run_script("if (window.__bespoke_on_init_complete) window.__bespoke_on_init_complete(0);");
-    });
+    auto knob1 = std::make_unique<Knob>("Frequency", 0.5f);
+    knob1->setRange(0.0f, 1.0f);
+    knob1->setStyle(KnobStyle::Classic);
+    knob1->setColors(
+        Color(0.25f, 0.25f, 0.28f, 1.0f),
+        Color(0.7f, 0.7f, 0.75f, 1.0f),
+        Color(0.4f, 0.8f, 0.5f, 1.0f)
+    );
+    gKnobs.push_back(std::move(knob1));
+
+    auto knob2 = std::make_unique<Knob>("Volume", 0.7f);
+    knob2->setRange(0.0f, 1.0f);
+    knob2->setStyle(KnobStyle::Modern);
+    knob2->setColors(
+        Color(0.2f, 0.2f, 0.22f, 1.0f),
+        Color(0.6f, 0.6f, 0.65f, 1.0f),
+        Color(0.3f, 0.7f, 0.9f, 1.0f)
+    );
+    gKnobs.push_back(std::move(knob2));
+
+    auto knob3 = std::make_unique<Knob>("Filter", 0.3f);
+    knob3->setRange(0.0f, 1.0f);
+    knob3->setStyle(KnobStyle::LED);
+    knob3->setColors(
+        Color(0.15f, 0.15f, 0.18f, 1.0f),
+        Color(0.5f, 0.5f, 0.55f, 1.0f),
+        Color(0.9f, 0.4f, 0.2f, 1.0f)
+    );
+    gKnobs.push_back(std::move(knob3));
+
+    auto knob4 = std::make_unique<Knob>("Pan", 0.5f);
+    knob4->setRange(0.0f, 1.0f);
+    knob4->setBipolar(true);
+    knob4->setStyle(KnobStyle::Vintage);
+    gKnobs.push_back(std::move(knob4));
+}
 
-    if (!started) {
-        printf("BespokeSynth WASM: Failed to start WebGPU initialization\n");
-        gInitState = InitState::Failed;
-        gInitErrorMessage = "Failed to start async WebGPU initialization";
-        return -1;
+static void registerParameters() {
+    for (auto& knob : gKnobs) {
+        Knob* control = knob.get();
+        int id = gParameters.addParameter(control->getLabel(), control->getValue(), [control](float value) {
+            control->setValue(value);
+            return control->getValue();
+        });
+        // Drags and bespoke_set_control_value show up in the block as well
+        control->setValueChangedCallback([id](float value) {
+            gParameters.setValue(id, value);
+        });
     }
-
-    // Indicate initialization started asynchronously
-    return 1;
+    
+    gOutputMeter = gParameters.addMeter("output");
+    gInputMeter = gParameters.addMeter("input");
 }
 
-EMSCRIPTEN_KEEPALIVE void bespoke_process_events(void) {
-    // Process pending WebGPU events to allow async callbacks to fire
-    if (gContext) {
-        gContext->processEvents();
+// Once per frame, so JS never has to poll these
+static void updateParameterBlock() {
+    gParameters.setFrameCount(++gRenderedFrames);
+    for (int i = 0; i < PANEL_COUNT; i++) {
+        gParameters.setPanelFrameCount(i, gPanelStatus[i].frameCount);
+    }
+    if (gAudioBackend) {
+        gParameters.setMeter(gOutputMeter, gAudioBackend->getOutputLevel());
+        gParameters.setMeter(gInputMeter, gAudioBackend->getInputLevel());
     }
 }
 
-EMSCRIPTEN_KEEPALIVE void bespoke_shutdown(void) {
-    printf("BespokeSynth WASM: Shutting down\n");
-    
-    // Clear controls first
-    gKnobs.clear();
-    
-    // Stop and cleanup audio
-    if (gAudioBackend) {
-        gAudioBackend->stop();
-        gAudioBackend->shutdown();
-        gAudioBackend.reset();
+// Continues initialization once the WebGPU adapter and device requests have completed.
+// Everything after bespoke_init runs from browser callbacks, nothing blocks, so the build doesn't need ASYNCIFY
+static void onWebGPUReady(bool success) {
+    if (!success) {
+        failInit(-1, "WebGPU initialization failed");
+        return;
     }
-    
-    // Brief delay to allow audio callback to complete
-    // (In WASM, the audio callback should complete quickly after stop)
-    for (int i = 0; i < 10 && gAudioCallbackActive.load(); ++i) {
-        // Just a short busy wait - audio callback should complete within 1-2 buffer periods
+
+    printf("WasmBridge: WebGPU context ready, proceeding with remaining initialization\n");
+    gInitState = InitState::WebGPUReady;
+    gContext->resize(gWidth, gHeight);
+
+    if (!initRenderer()) {
+        return;
+    }
+    initCompute();
+    if (!initAudio()) {
+        return;
     }
-    
-    // Cleanup renderer and context
-    gRenderer.reset();
-    gContext.reset();
-    
-    // Reset state
-    gInitialized = false;
-    gInitState = InitState::NotStarted;
-    gInitErrorMessage.clear();
-    
-    printf("BespokeSynth WASM: Shutdown complete\n");
-}
 
-EMSCRIPTEN_KEEPALIVE void bespoke_process_audio(void) {
-    // Audio is handled by SDL callback, nothing to do here
-}
+    createDemoControls();
+    registerParameters();
 
-EMSCRIPTEN_KEEPALIVE void bespoke_set_sample_rate(int sampleRate) {
-    // Would need to reinitialize audio for this to take effect
-    printf("BespokeSynth WASM: Sample rate change requested: %d\n", sampleRate);
-}
+    // Mark all panels as loaded
+    printf("\n=== DEBUG: Panel Initialization ===\n");
+    for (int i = 0; i < PANEL_COUNT; i++) {
+        markPanelLoaded(i);
+    }
+    printf("=== Panel Initialization Complete ===\n\n");
 
-EMSCRIPTEN_KEEPALIVE void bespoke_set_buffer_size(int bufferSize) {
-    printf("BespokeSynth WASM: Buffer size change requested: %d\n", bufferSize);
+    gInitState = InitState::FullyInitialized;
+    gInitialized = true;
+    printf("BespokeSynth WASM: Initialization complete - all subsystems ready\n");
+    notifyInitComplete(0);
 }
 
-EMSCRIPTEN_KEEPALIVE int bespoke_get_sample_rate(void) {
-    return gAudioBackend ? gAudioBackend->getSampleRate() : 44100;
-}
+static int gMouseX = 0;
+static int gMouseY = 0;
+static bool gMouseDown = false;
 
-EMSCRIPTEN_KEEPALIVE int bespoke_get_buffer_size(void) {
-    return gAudioBackend ? gAudioBackend->getBufferSize() : 512;
+static void handleMouseMove(int x, int y) {
+    int prevX = gMouseX;
+    int prevY = gMouseY;
+    gMouseX = x;
+    gMouseY = y;
+    
+    // Handle knob dragging
+    if (gMouseDown) {
+        for (auto& knob : gKnobs) {
+            knob->onMouseDrag(static_cast<float>(x), static_cast<float>(y),
+                              static_cast<float>(prevX), static_cast<float>(prevY));
+        }
+    }
 }
 
-EMSCRIPTEN_KEEPALIVE void bespoke_render(void) {
-    // During initialization, process events to allow WebGPU callbacks
-    if (gInitState != InitState::FullyInitialized) {
-        if (gContext) {
-            gContext->processEvents();
+static void handleMouseDown(int x, int y, int button) {
+    gMouseDown = true;
+    gMouseX = x;
+    gMouseY = y;
+    
+    // Check panel tab clicks
+    float tabY = 70.0f;
+    float tabHeight = 35.0f;
+    float tabWidth = 150.0f;
+    float tabSpacing = 5.0f;
+    
+    if (y >= tabY && y <= tabY + tabHeight) {
+        for (int i = 0; i < PANEL_COUNT; i++) {
+            float tabX = 20.0f + i * (tabWidth + tabSpacing);
+            if (x >= tabX && x <= tabX + tabWidth) {
+                int prevPanel = gCurrentPanel;
+                gCurrentPanel = i;
+                printf("DEBUG [Panel Switch] From:%s To:%s\n", 
+                       getPanelName(prevPanel), getPanelName(i));
+                logPanelStatus(i, "ACTIVATED");
+                return;
+            }
         }
-        return;
     }
     
-    // Double-check all subsystems are ready
-    if (!gInitialized || !gRenderer || !gContext) {
-        printf("BespokeSynth WASM: Render called but not fully initialized\n");
-        return;
-    }
+    // Check knob hit testing
+    float knobSize = 80.0f;
+    float startX = 100.0f;
+    float startY = 130.0f;  // Updated to match render
+    float spacing = 120.0f;
     
-    // Verify WebGPU context is still valid
-    if (!gContext->isInitialized()) {
-        printf("BespokeSynth WASM: WebGPU context lost, cannot render\n");
-        return;
+    for (size_t i = 0; i < gKnobs.size(); i++) {
+        float kx = startX + i * spacing;
+        if (gKnobs[i]->hitTest(static_cast<float>(x), static_cast<float>(y), kx, startY, knobSize)) {
+            gKnobs[i]->onMouseDown(static_cast<float>(x), static_cast<float>(y), kx, startY, knobSize);
+            break;
+        }
     }
+}
+
+static void handleMouseUp(int x, int y, int button) {
+    gMouseDown = false;
     
-    gTime += 0.016f; // Approximate 60fps
+    for (auto& knob : gKnobs) {
+        knob->onMouseUp();
+    }
+}
+
+static void handleMouseWheel(float deltaX, float deltaY) {
+    // Handle scroll on knobs
+    float knobSize = 80.0f;
+    float startX = 100.0f;
+    float startY = 130.0f;  // Updated to match render
+    float spacing = 120.0f;
     
-    // Mark current panel as running and update frame count
-    if (gCurrentPanel >= 0 && gCurrentPanel < PANEL_COUNT) {
-        markPanelRunning(gCurrentPanel);
-        gPanelStatus[gCurrentPanel].frameCount++;
-        gPanelStatus[gCurrentPanel].lastUpdateTime = gTime;
-        
-        // Log panel status every 300 frames (~5 seconds at 60fps)
-        if (gPanelStatus[gCurrentPanel].frameCount % 300 == 0) {
-            printf("DEBUG [Panel:%s] Running - Frames:%d Time:%.1fs\n",
-                   getPanelName(gCurrentPanel),
-                   gPanelStatus[gCurrentPanel].frameCount,
-                   gTime);
+    for (size_t i = 0; i < gKnobs.size(); i++) {
+        float kx = startX + i * spacing;
+        if (gKnobs[i]->hitTest(static_cast<float>(gMouseX), static_cast<float>(gMouseY), kx, startY, knobSize)) {
+            gKnobs[i]->onScroll(deltaY);
+            break;
+        }
+    }
+}
+
+static void handleKeyDown(int keyCode, int modifiers) {
+    // Handle shift for fine mode
+    if (keyCode == KEY_SHIFT) {
+        for (auto& knob : gKnobs) {
+            knob->setFineMode(true);
         }
     }
     
-    gRenderer->beginFrame(gWidth, gHeight, 1.0f, gTime);
-    
+    // Space to toggle audio
+    if (keyCode == KEY_SPACE && gAudioBackend) {
+        if (gAudioBackend->isRunning()) {
+            gAudioBackend->stop();
+        } else {
+            gAudioBackend->start();
+        }
+    }
+}
+
+static void handleKeyUp(int keyCode, int modifiers) {
+    if (keyCode == KEY_SHIFT) {
+        for (auto& knob : gKnobs) {
+            knob->setFineMode(false);
+        }
+    }
+}
+
+static void dispatchInputEvent(const InputEvent& event) {
+    int x = static_cast<int>(event.x);
+    int y = static_cast<int>(event.y);
+    switch (event.type) {
+        case InputEventType::MouseMove: handleMouseMove(x, y); break;
+        case InputEventType::MouseDown: handleMouseDown(x, y, event.code); break;
+        case InputEventType::MouseUp: handleMouseUp(x, y, event.code); break;
+        case InputEventType::MouseWheel: handleMouseWheel(event.x, event.y); break;
+        case InputEventType::KeyDown: handleKeyDown(event.code, event.modifiers); break;
+        case InputEventType::KeyUp: handleKeyUp(event.code, event.modifiers); break;
+    }
+}
+
+// Panel layout, shared by the chrome and the controls drawn over it
+static const float kPanelX = 50.0f;
+static const float kPanelY = 260.0f;
+static const float kPanelHeight = 220.0f;
+
+static uint64_t getChromeKey() {
+    uint64_t key = static_cast<uint64_t>(gCurrentPanel);
+    for (int i = 0; i < PANEL_COUNT; i++) {
+        key = (key << 2) | (gPanelStatus[i].loaded ? 1u : 0u) | (gPanelStatus[i].running ? 2u : 0u);
+    }
+    return key;
+}
+
+static void drawChrome() {
     // Clear background
     gRenderer->fillColor(Color(0.12f, 0.12f, 0.14f, 1.0f));
     gRenderer->rect(0, 0, static_cast<float>(gWidth), static_cast<float>(gHeight));
@@ -399,8 +581,6 @@ EMSCRIPTEN_KEEPALIVE void bespoke_render(void) {
     float tabWidth = 150.0f;
     float tabSpacing = 5.0f;
     
-    const char* panelNames[] = {"Mixer", "Effects", "Sequencer"};
-    
     for (int i = 0; i < PANEL_COUNT; i++) {
         float tabX = 20.0f + i * (tabWidth + tabSpacing);
         
@@ -432,43 +612,13 @@ EMSCRIPTEN_KEEPALIVE void bespoke_render(void) {
             gRenderer->fillColor(Color(0.6f, 0.6f, 0.65f, 1.0f));
         }
         gRenderer->fontSize(14.0f);
-        gRenderer->text(tabX + 15, tabY + 22, panelNames[i]);
+        gRenderer->text(tabX + 15, tabY + 22, getPanelName(i));
     }
     
-    // Draw knobs in a row (common across all panels)
-    float knobSize = 80.0f;
-    float startX = 100.0f;
-    float startY = 130.0f;
-    float spacing = 120.0f;
-    
-    for (size_t i = 0; i < gKnobs.size(); i++) {
-        float x = startX + i * spacing;
-        gKnobs[i]->render(*gRenderer, x, startY, knobSize);
-    }
-    
-    // Draw cables connecting knobs
-    if (gKnobs.size() >= 2) {
-        gRenderer->drawCableWithSag(
-            startX, startY + knobSize * 0.5f + 20,
-            startX + spacing, startY + knobSize * 0.5f + 20,
-            Color(0.8f, 0.3f, 0.2f, 0.9f),
-            3.0f, 0.2f
-        );
-    }
-    if (gKnobs.size() >= 3) {
-        gRenderer->drawCableWithSag(
-            startX + spacing, startY + knobSize * 0.5f + 30,
-            startX + spacing * 2, startY + knobSize * 0.5f + 30,
-            Color(0.2f, 0.6f, 0.8f, 0.9f),
-            3.0f, 0.25f
-        );
-    }
-    
-    // Draw panel based on selection
-    float panelX = 50.0f;
-    float panelY = 260.0f;
+    float panelX = kPanelX;
+    float panelY = kPanelY;
     float panelW = static_cast<float>(gWidth) - 100.0f;
-    float panelH = 220.0f;
+    float panelH = kPanelHeight;
     
     // Panel background
     gRenderer->fillColor(Color(0.18f, 0.18f, 0.2f, 1.0f));
@@ -483,77 +633,33 @@ EMSCRIPTEN_KEEPALIVE void bespoke_render(void) {
     // Panel title
     gRenderer->fillColor(Color(0.8f, 0.8f, 0.85f, 1.0f));
     gRenderer->fontSize(16.0f);
-    gRenderer->text(panelX + 15, panelY + 25, panelNames[gCurrentPanel]);
+    gRenderer->text(panelX + 15, panelY + 25, getPanelName(gCurrentPanel));
     
-    // Render panel-specific content
+    // Panel-specific labels and decorations
+    gRenderer->fillColor(Color(0.5f, 0.5f, 0.55f, 1.0f));
+    gRenderer->fontSize(12.0f);
     switch (gCurrentPanel) {
         case PANEL_MIXER: {
-            // Draw mixer controls - sliders and VU meters
             float sliderX = panelX + 30;
             float sliderY = panelY + 50;
-            
-            gRenderer->fillColor(Color(0.5f, 0.5f, 0.55f, 1.0f));
-            gRenderer->fontSize(12.0f);
             gRenderer->text(sliderX, sliderY - 10, "Channel 1");
-            gRenderer->drawSlider(sliderX, sliderY, 200, 20, 0.6f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.4f, 0.7f, 0.5f, 1.0f));
-            
             gRenderer->text(sliderX, sliderY + 40, "Channel 2");
-            gRenderer->drawSlider(sliderX, sliderY + 50, 200, 20, 0.3f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.5f, 0.6f, 0.9f, 1.0f));
-            
             gRenderer->text(sliderX, sliderY + 90, "Master");
-            gRenderer->drawSlider(sliderX, sliderY + 100, 200, 20, 0.8f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.9f, 0.5f, 0.3f, 1.0f));
             
-            // Draw VU meters
             float vuX = panelX + panelW - 120;
             float vuY = panelY + 40;
-            
-            float audioLevel = gAudioBackend ? gAudioBackend->getOutputLevel() : 0.0f;
-            
-            gRenderer->fillColor(Color(0.5f, 0.5f, 0.55f, 1.0f));
             gRenderer->text(vuX, vuY - 10, "L");
-            gRenderer->drawVUMeter(vuX, vuY, 20, 160, audioLevel,
-                Color(0.2f, 0.8f, 0.3f, 1.0f),
-                Color(1.0f, 0.2f, 0.1f, 1.0f));
-            
             gRenderer->text(vuX + 40, vuY - 10, "R");
-            gRenderer->drawVUMeter(vuX + 40, vuY, 20, 160, audioLevel * 0.9f,
-                Color(0.2f, 0.8f, 0.3f, 1.0f),
-                Color(1.0f, 0.2f, 0.1f, 1.0f));
             break;
         }
         
         case PANEL_EFFECTS: {
-            // Draw effects controls
             float effectX = panelX + 30;
             float effectY = panelY + 50;
-            
-            gRenderer->fillColor(Color(0.5f, 0.5f, 0.55f, 1.0f));
-            gRenderer->fontSize(12.0f);
             gRenderer->text(effectX, effectY - 10, "Reverb Mix");
-            gRenderer->drawSlider(effectX, effectY, 250, 20, 0.4f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.6f, 0.3f, 0.8f, 1.0f));
-            
             gRenderer->text(effectX, effectY + 40, "Delay Time");
-            gRenderer->drawSlider(effectX, effectY + 50, 250, 20, 0.5f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.8f, 0.6f, 0.3f, 1.0f));
-            
             gRenderer->text(effectX, effectY + 90, "Chorus Depth");
-            gRenderer->drawSlider(effectX, effectY + 100, 250, 20, 0.7f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.3f, 0.8f, 0.8f, 1.0f));
-            
             gRenderer->text(effectX, effectY + 140, "Distortion");
-            gRenderer->drawSlider(effectX, effectY + 150, 250, 20, 0.2f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.9f, 0.3f, 0.3f, 1.0f));
             
             // Draw effect visualizer
             float vizX = panelX + panelW - 200;
@@ -580,21 +686,10 @@ EMSCRIPTEN_KEEPALIVE void bespoke_render(void) {
         }
         
         case PANEL_SEQUENCER: {
-            // Draw sequencer controls
             float seqX = panelX + 30;
             float seqY = panelY + 50;
-            
-            gRenderer->fillColor(Color(0.5f, 0.5f, 0.55f, 1.0f));
-            gRenderer->fontSize(12.0f);
             gRenderer->text(seqX, seqY - 10, "BPM");
-            gRenderer->drawSlider(seqX, seqY, 150, 20, 0.6f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.5f, 0.8f, 0.4f, 1.0f));
-            
             gRenderer->text(seqX + 200, seqY - 10, "Swing");
-            gRenderer->drawSlider(seqX + 200, seqY, 150, 20, 0.5f,
-                Color(0.25f, 0.25f, 0.28f, 1.0f),
-                Color(0.8f, 0.7f, 0.4f, 1.0f));
             
             // Draw step sequencer grid
             float gridX = seqX;
@@ -635,6 +730,294 @@ EMSCRIPTEN_KEEPALIVE void bespoke_render(void) {
             break;
         }
     }
+}
+
+// The parts of the panel that change from frame to frame, drawn over the chrome
+static void drawPanelControls() {
+    float panelX = kPanelX;
+    float panelY = kPanelY;
+    float panelW = static_cast<float>(gWidth) - 100.0f;
+    
+    switch (gCurrentPanel) {
+        case PANEL_MIXER: {
+            // Draw mixer controls - sliders and VU meters
+            float sliderX = panelX + 30;
+            float sliderY = panelY + 50;
+            
+            gRenderer->drawSlider(sliderX, sliderY, 200, 20, 0.6f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.4f, 0.7f, 0.5f, 1.0f));
+            
+            gRenderer->drawSlider(sliderX, sliderY + 50, 200, 20, 0.3f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.5f, 0.6f, 0.9f, 1.0f));
+            
+            gRenderer->drawSlider(sliderX, sliderY + 100, 200, 20, 0.8f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.9f, 0.5f, 0.3f, 1.0f));
+            
+            // Draw VU meters
+            float vuX = panelX + panelW - 120;
+            float vuY = panelY + 40;
+            
+            float audioLevel = gAudioBackend ? gAudioBackend->getOutputLevel() : 0.0f;
+            
+            gRenderer->drawVUMeter(vuX, vuY, 20, 160, audioLevel,
+                Color(0.2f, 0.8f, 0.3f, 1.0f),
+                Color(1.0f, 0.2f, 0.1f, 1.0f));
+            
+            gRenderer->drawVUMeter(vuX + 40, vuY, 20, 160, audioLevel * 0.9f,
+                Color(0.2f, 0.8f, 0.3f, 1.0f),
+                Color(1.0f, 0.2f, 0.1f, 1.0f));
+            break;
+        }
+        
+        case PANEL_EFFECTS: {
+            // Draw effects controls
+            float effectX = panelX + 30;
+            float effectY = panelY + 50;
+            
+            gRenderer->drawSlider(effectX, effectY, 250, 20, 0.4f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.6f, 0.3f, 0.8f, 1.0f));
+            
+            gRenderer->drawSlider(effectX, effectY + 50, 250, 20, 0.5f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.8f, 0.6f, 0.3f, 1.0f));
+            
+            gRenderer->drawSlider(effectX, effectY + 100, 250, 20, 0.7f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.3f, 0.8f, 0.8f, 1.0f));
+            
+            gRenderer->drawSlider(effectX, effectY + 150, 250, 20, 0.2f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.9f, 0.3f, 0.3f, 1.0f));
+            break;
+        }
+        
+        case PANEL_SEQUENCER: {
+            // Draw sequencer controls
+            float seqX = panelX + 30;
+            float seqY = panelY + 50;
+            
+            gRenderer->drawSlider(seqX, seqY, 150, 20, 0.6f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.5f, 0.8f, 0.4f, 1.0f));
+            
+            gRenderer->drawSlider(seqX + 200, seqY, 150, 20, 0.5f,
+                Color(0.25f, 0.25f, 0.28f, 1.0f),
+                Color(0.8f, 0.7f, 0.4f, 1.0f));
+            break;
+        }
+    }
+}
+
+extern "C" {
+
+EMSCRIPTEN_KEEPALIVE int bespoke_init(int width, int height, int sampleRate, int bufferSize) {
+    printf("BespokeSynth WASM: Initializing (%dx%d, %dHz, %d samples)\n", 
+           width, height, sampleRate, bufferSize);
+    
+    if (gInitState != InitState::NotStarted) {
+        printf("BespokeSynth WASM: Already initialized or in progress (state=%d)\n", static_cast<int>(gInitState));
+        return gInitState == InitState::FullyInitialized ? 0 : 1;
+    }
+    
+    gWidth = width;
+    gHeight = height;
+    gInitState = InitState::WebGPURequested;
+
+    gResources.loadManifest(kResourceManifest);
+    for (const char* path : kPreloadedResources) {
+        gResources.markLoaded(path);
+    }
+
+#if BESPOKE_SIDE_MODULES
+    gSideModules.loadManifest(kSideModuleManifest);
+#endif
+    
+    // Initialize WebGPU context (asynchronous), onWebGPUReady continues from there
+    gContext = std::make_unique<WebGPUContext>();
+    printf("WasmBridge: starting async WebGPU initialization (selector=#canvas)\n");
+
+    if (!gContext->initializeAsync("#canvas", onWebGPUReady)) {
+        // initializeAsync has already reported the failure through onWebGPUReady
+        return -1;
+    }
+
+    // Indicate initialization started asynchronously
+    return 1;
+}
+
+EMSCRIPTEN_KEEPALIVE void bespoke_process_events(void) {
+    // Process pending WebGPU events to allow async callbacks to fire
+    if (gContext) {
+        gContext->processEvents();
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE void bespoke_shutdown(void) {
+    printf("BespokeSynth WASM: Shutting down\n");
+    
+    // Clear controls first
+    gKnobs.clear();
+    
+    // Stop and cleanup audio
+    if (gAudioBackend) {
+        gAudioBackend->stop();
+        gAudioBackend->shutdown();
+        gAudioBackend.reset();
+    }
+    
+    // Brief delay to allow audio callback to complete
+    // (In WASM, the audio callback should complete quickly after stop)
+    for (int i = 0; i < 10 && gAudioCallbackActive.load(); ++i) {
+        // Just a short busy wait - audio callback should complete within 1-2 buffer periods
+    }
+    
+#if BESPOKE_GPU_COMPUTE
+    ComputeOffload::Set(nullptr);
+    gCompute.reset();
+#endif
+
+    // Cleanup renderer and context
+    gRenderer.reset();
+    gContext.reset();
+    
+    // Reset state
+    gInitialized = false;
+    gInitState = InitState::NotStarted;
+    gInitErrorMessage.clear();
+    
+    printf("BespokeSynth WASM: Shutdown complete\n");
+}
+
+EMSCRIPTEN_KEEPALIVE void bespoke_process_audio(void) {
+    // Audio is handled by the backend's callback, nothing to do here
+}
+
+EMSCRIPTEN_KEEPALIVE void bespoke_set_sample_rate(int sampleRate) {
+    // Would need to reinitialize audio for this to take effect
+    printf("BespokeSynth WASM: Sample rate change requested: %d\n", sampleRate);
+}
+
+EMSCRIPTEN_KEEPALIVE void bespoke_set_buffer_size(int bufferSize) {
+    printf("BespokeSynth WASM: Buffer size change requested: %d\n", bufferSize);
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_get_sample_rate(void) {
+    return gAudioBackend ? gAudioBackend->getSampleRate() : 44100;
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_get_buffer_size(void) {
+    return gAudioBackend ? gAudioBackend->getBufferSize() : 512;
+}
+
+EMSCRIPTEN_KEEPALIVE void bespoke_render(void) {
+    // During initialization, process events to allow WebGPU callbacks
+    if (gInitState != InitState::FullyInitialized) {
+        if (gContext) {
+            gContext->processEvents();
+        }
+        // Nothing can react to input yet, don't replay it once init completes
+        gInput.drain([](const InputEvent&) {});
+        return;
+    }
+    
+    // Double-check all subsystems are ready
+    if (!gInitialized || !gRenderer || !gContext) {
+        printf("BespokeSynth WASM: Render called but not fully initialized\n");
+        return;
+    }
+    
+    // Verify WebGPU context is still valid
+    if (!gContext->isInitialized()) {
+        printf("BespokeSynth WASM: WebGPU context lost, cannot render\n");
+        return;
+    }
+    
+    // JS throttles or pauses rendering, so animations follow the real time between frames
+    double frameStartMs = emscripten_get_now();
+    double frameDeltaMs = gLastFrameMs > 0.0 ? std::min(frameStartMs - gLastFrameMs, kMaxFrameDeltaMs) : 16.0;
+    gLastFrameMs = frameStartMs;
+    gRenderTime += static_cast<float>(frameDeltaMs / 1000.0);
+    
+    // Values JS wrote into the parameter block since the last frame
+    gParameters.applyChanges();
+    
+    // The remote patch takes the whole canvas and all of the input
+    if (gRemoteActive) {
+        gRemote.setViewport(gWidth, gHeight);
+        gInput.drain([](const InputEvent& event) { gRemote.sendInput(event); });
+        gRemote.flush();
+        
+        gRenderer->beginFrame(gWidth, gHeight, 1.0f, gRenderTime);
+        gRemote.render(*gRenderer, gWidth, gHeight);
+        double submitStartMs = emscripten_get_now();
+        gRenderer->endFrame();
+        gTelemetry.recordFrame(frameStartMs, submitStartMs, emscripten_get_now());
+        return;
+    }
+    
+    // Input that arrived since the last frame, in order
+    gInput.drain(dispatchInputEvent);
+    
+    // Mark current panel as running and update frame count
+    if (gCurrentPanel >= 0 && gCurrentPanel < PANEL_COUNT) {
+        markPanelRunning(gCurrentPanel);
+        gPanelStatus[gCurrentPanel].frameCount++;
+        gPanelStatus[gCurrentPanel].lastUpdateTime = gRenderTime;
+        
+        // Log panel status every 300 frames (~5 seconds at 60fps)
+        if (gPanelStatus[gCurrentPanel].frameCount % 300 == 0) {
+            printf("DEBUG [Panel:%s] Running - Frames:%d Time:%.1fs\n",
+                   getPanelName(gCurrentPanel),
+                   gPanelStatus[gCurrentPanel].frameCount,
+                   gRenderTime);
+        }
+    }
+    
+    updateParameterBlock();
+    
+    gRenderer->beginFrame(gWidth, gHeight, 1.0f, gRenderTime);
+    
+    // Static chrome comes from its layer, everything else is drawn on top every frame
+    if (gRenderer->beginLayer(gChromeLayer, getChromeKey())) {
+        drawChrome();
+        gRenderer->endLayer();
+    }
+    gRenderer->drawLayer(gChromeLayer);
+    
+    // Draw knobs in a row (common across all panels)
+    float knobSize = 80.0f;
+    float startX = 100.0f;
+    float startY = 130.0f;
+    float spacing = 120.0f;
+    
+    for (size_t i = 0; i < gKnobs.size(); i++) {
+        float x = startX + i * spacing;
+        gKnobs[i]->render(*gRenderer, x, startY, knobSize);
+    }
+    
+    // Draw cables connecting knobs
+    if (gKnobs.size() >= 2) {
+        gRenderer->drawCableWithSag(
+            startX, startY + knobSize * 0.5f + 20,
+            startX + spacing, startY + knobSize * 0.5f + 20,
+            Color(0.8f, 0.3f, 0.2f, 0.9f),
+            3.0f, 0.2f
+        );
+    }
+    if (gKnobs.size() >= 3) {
+        gRenderer->drawCableWithSag(
+            startX + spacing, startY + knobSize * 0.5f + 30,
+            startX + spacing * 2, startY + knobSize * 0.5f + 30,
+            Color(0.2f, 0.6f, 0.8f, 0.9f),
+            3.0f, 0.25f
+        );
+    }
+    
+    drawPanelControls();
     
     // Draw status
     gRenderer->fillColor(Color(0.6f, 0.6f, 0.65f, 1.0f));
@@ -646,11 +1029,13 @@ EMSCRIPTEN_KEEPALIVE void bespoke_render(void) {
              bespoke_get_sample_rate(),
              bespoke_get_buffer_size(),
              (gAudioBackend && gAudioBackend->isRunning()) ? "Running" : "Stopped",
-             panelNames[gCurrentPanel]);
+             getPanelName(gCurrentPanel));
     
     gRenderer->text(20, static_cast<float>(gHeight) - 20, statusText);
     
+    double submitStartMs = emscripten_get_now();
     gRenderer->endFrame();
+    gTelemetry.recordFrame(frameStartMs, submitStartMs, emscripten_get_now());
 }
 
 EMSCRIPTEN_KEEPALIVE void bespoke_resize(int width, int height) {
@@ -664,116 +1049,117 @@ EMSCRIPTEN_KEEPALIVE void bespoke_resize(int width, int height) {
     printf("BespokeSynth WASM: Resized to %dx%d\n", width, height);
 }
 
-static int gMouseX = 0;
-static int gMouseY = 0;
-static bool gMouseDown = false;
+EMSCRIPTEN_KEEPALIVE int bespoke_remote_connect(const char* url, const char* token) {
+    gRemoteActive = gRemote.connect(url, token);
+    if (gRemoteActive) {
+        gRemote.setViewport(gWidth, gHeight);
+    }
+    return gRemoteActive ? 0 : -1;
+}
 
+EMSCRIPTEN_KEEPALIVE void bespoke_remote_disconnect(void) {
+    gRemote.disconnect();
+    gRemoteActive = false;
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_remote_is_connected(void) {
+    return gRemote.isConnected() ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_sample_create(int numChannels, double numFrames, int sampleRate) {
+    return bespoke::wasm::SampleStore::get().create(numChannels, static_cast<int64_t>(numFrames), sampleRate);
+}
+
+EMSCRIPTEN_KEEPALIVE void bespoke_sample_release(int id) {
+    bespoke::wasm::SampleStore::get().release(id);
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_sample_is_streamed(int id) {
+    return bespoke::wasm::SampleStore::get().isStreamed(id) ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE double bespoke_sample_get_resident_frames(int id) {
+    return static_cast<double>(bespoke::wasm::SampleStore::get().getResidentFrames(id));
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_sample_take_requests(void) {
+    return bespoke::wasm::SampleStore::get().takeRequests();
+}
+
+EMSCRIPTEN_KEEPALIVE const uint32_t* bespoke_sample_get_requests(void) {
+    return bespoke::wasm::SampleStore::get().getRequests();
+}
+
+EMSCRIPTEN_KEEPALIVE void bespoke_sample_block_ready(int id, int slot, double startFrame) {
+    bespoke::wasm::SampleStore::get().blockReady(id, slot, static_cast<int64_t>(startFrame));
+}
+
+// The exported input entry points only queue, see InputQueue.h
 EMSCRIPTEN_KEEPALIVE void bespoke_mouse_move(int x, int y) {
-    int prevX = gMouseX;
-    int prevY = gMouseY;
-    gMouseX = x;
-    gMouseY = y;
-    
-    // Handle knob dragging
-    if (gMouseDown) {
-        for (auto& knob : gKnobs) {
-            knob->onMouseDrag(static_cast<float>(x), static_cast<float>(y),
-                              static_cast<float>(prevX), static_cast<float>(prevY));
-        }
-    }
+    gInput.pushMouseMove(static_cast<float>(x), static_cast<float>(y));
 }
 
 EMSCRIPTEN_KEEPALIVE void bespoke_mouse_down(int x, int y, int button) {
-    gMouseDown = true;
-    gMouseX = x;
-    gMouseY = y;
-    
-    // Check panel tab clicks
-    float tabY = 70.0f;
-    float tabHeight = 35.0f;
-    float tabWidth = 150.0f;
-    float tabSpacing = 5.0f;
-    
-    if (y >= tabY && y <= tabY + tabHeight) {
-        for (int i = 0; i < PANEL_COUNT; i++) {
-            float tabX = 20.0f + i * (tabWidth + tabSpacing);
-            if (x >= tabX && x <= tabX + tabWidth) {
-                int prevPanel = gCurrentPanel;
-                gCurrentPanel = i;
-                printf("DEBUG [Panel Switch] From:%s To:%s\n", 
-                       getPanelName(prevPanel), getPanelName(i));
-                logPanelStatus(i, "ACTIVATED");
-                return;
-            }
-        }
-    }
-    
-    // Check knob hit testing
-    float knobSize = 80.0f;
-    float startX = 100.0f;
-    float startY = 130.0f;  // Updated to match render
-    float spacing = 120.0f;
-    
-    for (size_t i = 0; i < gKnobs.size(); i++) {
-        float kx = startX + i * spacing;
-        if (gKnobs[i]->hitTest(static_cast<float>(x), static_cast<float>(y), kx, startY, knobSize)) {
-            gKnobs[i]->onMouseDown(static_cast<float>(x), static_cast<float>(y), kx, startY, knobSize);
-            break;
-        }
-    }
+    gInput.pushMouseDown(static_cast<float>(x), static_cast<float>(y), button);
 }
 
 EMSCRIPTEN_KEEPALIVE void bespoke_mouse_up(int x, int y, int button) {
-    gMouseDown = false;
-    
-    for (auto& knob : gKnobs) {
-        knob->onMouseUp();
-    }
+    gInput.pushMouseUp(static_cast<float>(x), static_cast<float>(y), button);
 }
 
 EMSCRIPTEN_KEEPALIVE void bespoke_mouse_wheel(float deltaX, float deltaY) {
-    // Handle scroll on knobs
-    float knobSize = 80.0f;
-    float startX = 100.0f;
-    float startY = 130.0f;  // Updated to match render
-    float spacing = 120.0f;
-    
-    for (size_t i = 0; i < gKnobs.size(); i++) {
-        float kx = startX + i * spacing;
-        if (gKnobs[i]->hitTest(static_cast<float>(gMouseX), static_cast<float>(gMouseY), kx, startY, knobSize)) {
-            gKnobs[i]->onScroll(deltaY);
-            break;
-        }
-    }
+    gInput.pushMouseWheel(deltaX, deltaY);
 }
 
 EMSCRIPTEN_KEEPALIVE void bespoke_key_down(int keyCode, int modifiers) {
-    // Handle shift for fine mode
-    if (keyCode == KEY_SHIFT) {
-        for (auto& knob : gKnobs) {
-            knob->setFineMode(true);
-        }
-    }
-    
-    // Space to toggle audio
-    if (keyCode == KEY_SPACE && gAudioBackend) {
-        if (gAudioBackend->isRunning()) {
-            gAudioBackend->stop();
-        } else {
-            gAudioBackend->start();
-        }
-    }
+    gInput.pushKeyDown(keyCode, modifiers);
 }
 
 EMSCRIPTEN_KEEPALIVE void bespoke_key_up(int keyCode, int modifiers) {
-    if (keyCode == KEY_SHIFT) {
-        for (auto& knob : gKnobs) {
-            knob->setFineMode(false);
-        }
+    gInput.pushKeyUp(keyCode, modifiers);
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_request_module(const char* type) {
+#if BESPOKE_SIDE_MODULES
+    if (gSideModules.isLazyType(type) && !gSideModules.isLoaded(type)) {
+        gSideModules.request(type);
+        return 1;
     }
+#endif
+    return 0;
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_request_resource(const char* path) {
+    if (!gResources.contains(path)) {
+        return -1;
+    }
+    if (gResources.isLoaded(path)) {
+        return 0;
+    }
+    gResources.request(path);
+    return 1;
+}
+
+EMSCRIPTEN_KEEPALIVE const void* bespoke_get_parameter_block(void) {
+    return gParameters.data();
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_get_parameter_id(const char* name) {
+    return gParameters.findParameter(name);
+}
+
+EMSCRIPTEN_KEEPALIVE int bespoke_get_meter_id(const char* name) {
+    return gParameters.findMeter(name);
 }
 
 EMSCRIPTEN_KEEPALIVE int bespoke_create_module(const char* type, float x, float y) {
+#if BESPOKE_SIDE_MODULES
+    // The spawn menu should call bespoke_request_module first, kick off the fetch if it didn't
+    if (bespoke_request_module(type) != 0) {
+        printf("BespokeSynth WASM: Module '%s' is still loading\n", type);
+        return -2;
+    }
+#endif
     // TODO: Implement module creation
     printf("BespokeSynth WASM: Create module '%s' at (%.1f, %.1f)\n", type, x, y);
     return 0;
@@ -846,8 +1232,11 @@ EMSCRIPTEN_KEEPALIVE const char* bespoke_get_version(void) {
 }
 
 EMSCRIPTEN_KEEPALIVE float bespoke_get_cpu_load(void) {
-    // TODO: Calculate actual CPU load
-    return 0.0f;
+    return gTelemetry.getCpuLoad();
+}
+
+EMSCRIPTEN_KEEPALIVE const void* bespoke_get_telemetry(void) {
+    return gTelemetry.data();
 }
 
 EMSCRIPTEN_KEEPALIVE int bespoke_get_module_count(void) {
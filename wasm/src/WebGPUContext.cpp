@@ -71,9 +71,9 @@ static void handleAdapterRequest(WebGPUContext* context, WGPURequestAdapterStatu
             printf("WebGPUContext: Adapter found, requesting device\n");
             WGPUDeviceDescriptor deviceDesc = {};
 
-            // Use new callback info structure
+            // Spontaneous callbacks fire from the browser event loop, no polling or ASYNCIFY needed
             WGPURequestDeviceCallbackInfo deviceCallbackInfo = {};
-            deviceCallbackInfo.mode = WGPUCallbackMode_AllowProcessEvents;
+            deviceCallbackInfo.mode = WGPUCallbackMode_AllowSpontaneous;
             deviceCallbackInfo.callback = onDeviceRequest;
             deviceCallbackInfo.userdata1 = context;
             deviceCallbackInfo.userdata2 = nullptr;
@@ -135,9 +135,10 @@ bool WebGPUContext::initializeAsync(const char* selector, std::function<void(boo
 
     printf("WebGPUContext: initializeAsync started with selector=%s\n", selector ? selector : "(null)");
 
-    // Use new callback info structure
+    // Spontaneous callbacks fire from the browser event loop as soon as the
+    // request's promise resolves, so initialization never has to block
     WGPURequestAdapterCallbackInfo callbackInfo = {};
-    callbackInfo.mode = WGPUCallbackMode_AllowProcessEvents;
+    callbackInfo.mode = WGPUCallbackMode_AllowSpontaneous;
     callbackInfo.callback = onAdapterRequest;
     callbackInfo.userdata1 = this;
     callbackInfo.userdata2 = nullptr;
@@ -243,6 +244,8 @@ void WebGPUContext::resize(int width, int height) {
     config.usage = WGPUTextureUsage_RenderAttachment;
     config.width = width;
     config.height = height;
+    // Frames come from requestAnimationFrame, which already runs at the display rate,
+    // so Fifo only ever presents what JS asked for and never queues up extra frames
     config.presentMode = WGPUPresentMode_Fifo;
     config.alphaMode = WGPUCompositeAlphaMode_Auto;
     
@@ -846,6 +846,291 @@ fn fs_mod_wheel(input: VertexOutput) -> @location(0) vec4<f32> {
 
     return color;
 }
+
+// ============================================================================
+// Instanced SDF shapes (circle, arc, rounded rect, line, atlas glyph)
+// One instance per shape; the quad's four corners come from the vertex index.
+// ============================================================================
+
+struct ShapeInput {
+    @location(0) bounds: vec4<f32>,       // center.xy, halfSize.xy in pixels
+    @location(1) style: vec4<f32>,        // axis.xy, kind, strokeWidth
+    @location(2) params: vec4<f32>,       // per-kind parameters
+    @location(3) fillColor: vec4<f32>,
+    @location(4) strokeColor: vec4<f32>,
+};
+
+struct ShapeOutput {
+    @builtin(position) position: vec4<f32>,
+    @location(0) local: vec2<f32>,        // pixel offset from the center, in the shape's own frame
+    @location(1) @interpolate(flat) halfSize: vec2<f32>,
+    @location(2) @interpolate(flat) style: vec4<f32>,
+    @location(3) @interpolate(flat) params: vec4<f32>,
+    @location(4) @interpolate(flat) fillColor: vec4<f32>,
+    @location(5) @interpolate(flat) strokeColor: vec4<f32>,
+};
+
+const SHAPE_CIRCLE: i32 = 0;
+const SHAPE_ARC: i32 = 1;
+const SHAPE_ROUNDED_RECT: i32 = 2;
+const SHAPE_LINE: i32 = 3;
+const SHAPE_GLYPH: i32 = 4;
+
+// Value the glyph atlas stores on the outline (128 / 255)
+const GLYPH_EDGE: f32 = 0.50196;
+
+@vertex
+fn vs_shape(@builtin(vertex_index) vertexIndex: u32, input: ShapeInput) -> ShapeOutput {
+    var corners = array<vec2<f32>, 4>(
+        vec2<f32>(-1.0, -1.0),
+        vec2<f32>(1.0, -1.0),
+        vec2<f32>(1.0, 1.0),
+        vec2<f32>(-1.0, 1.0)
+    );
+
+    // Grow the quad by a pixel so the antialiased edge isn't cut off
+    let local = corners[vertexIndex % 4u] * (input.bounds.zw + vec2<f32>(1.0, 1.0));
+    let axis = input.style.xy;
+    let offset = vec2<f32>(local.x * axis.x - local.y * axis.y, local.x * axis.y + local.y * axis.x);
+    let pos = input.bounds.xy + offset;
+
+    var output: ShapeOutput;
+    output.position = vec4<f32>(
+        (pos.x / uniforms.viewSize.x) * 2.0 - 1.0,
+        1.0 - (pos.y / uniforms.viewSize.y) * 2.0,
+        0.0, 1.0);
+    output.local = local;
+    output.halfSize = input.bounds.zw;
+    output.style = input.style;
+    output.params = input.params;
+    output.fillColor = input.fillColor;
+    output.strokeColor = input.strokeColor;
+    return output;
+}
+
+fn sd_rounded_box(p: vec2<f32>, halfSize: vec2<f32>, radius: f32) -> f32 {
+    let q = abs(p) - halfSize + vec2<f32>(radius, radius);
+    return length(max(q, vec2<f32>(0.0, 0.0))) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+fn sd_arc(p: vec2<f32>, radius: f32, startAngle: f32, sweep: f32, thickness: f32) -> f32 {
+    var a = atan2(p.y, p.x) - startAngle;
+    a = a - TWO_PI * floor(a / TWO_PI);
+    if (a <= sweep) {
+        return abs(length(p) - radius) - thickness * 0.5;
+    }
+    // Outside the sweep: distance to the nearer round cap
+    let endAngle = startAngle + sweep;
+    let p0 = vec2<f32>(cos(startAngle), sin(startAngle)) * radius;
+    let p1 = vec2<f32>(cos(endAngle), sin(endAngle)) * radius;
+    return min(distance(p, p0), distance(p, p1)) - thickness * 0.5;
+}
+
+@fragment
+fn fs_shape(input: ShapeOutput) -> @location(0) vec4<f32> {
+    let p = input.local;
+    let kind = i32(input.style.z + 0.5);
+    let strokeWidth = input.style.w;
+
+    // Texture sampling has to happen outside the per-kind branches. For glyphs the
+    // params hold the atlas rect; other shapes sample the atlas too but ignore the result.
+    let boxUV = p / max(input.halfSize, vec2<f32>(0.0001, 0.0001)) * 0.5 + vec2<f32>(0.5, 0.5);
+    let atlasUV = clamp(mix(input.params.xy, input.params.zw, boxUV), input.params.xy, input.params.zw);
+    let atlasDistance = textureSampleLevel(textureData, textureSampler, atlasUV, 0.0).r;
+
+    var d = 0.0;
+    var strokeOnly = false;
+    switch kind {
+        case SHAPE_CIRCLE: {
+            d = length(p) - input.halfSize.x;
+        }
+        case SHAPE_ARC: {
+            d = sd_arc(p, input.params.x, input.params.y, input.params.z, strokeWidth);
+            strokeOnly = true;
+        }
+        case SHAPE_ROUNDED_RECT: {
+            d = sd_rounded_box(p, input.halfSize, input.params.x);
+        }
+        case SHAPE_GLYPH: {
+            d = GLYPH_EDGE - atlasDistance;
+        }
+        case SHAPE_LINE, default: {  // a capsule
+            let q = vec2<f32>(max(abs(p.x) - input.params.x, 0.0), p.y);
+            d = length(q) - strokeWidth * 0.5;
+            strokeOnly = true;
+        }
+    }
+
+    let aa = max(fwidth(d), 0.0001);
+    let coverage = clamp(0.5 - d / aa, 0.0, 1.0);
+
+    var color = input.strokeColor;
+    if (!strokeOnly) {
+        // The stroke sits just inside the edge
+        var inner = 1.0;
+        if (strokeWidth > 0.0) {
+            inner = clamp(0.5 - (d + strokeWidth) / aa, 0.0, 1.0);
+        }
+        color = mix(input.strokeColor, input.fillColor, inner);
+    }
+    color.a = color.a * coverage;
+    return color;
+}
+
+// ============================================================================
+// Sample traces (waveform, scope, spectrum)
+// The samples are uploaded once into a storage buffer and each trace is a single
+// instance, with its segments, columns or bars generated from the vertex index.
+// ============================================================================
+
+struct TraceInput {
+    @location(0) bounds: vec4<f32>,       // x, y, w, h in pixels
+    @location(1) range: vec4<u32>,        // first sample, sample count, mode, segment count
+    @location(2) color: vec4<f32>,
+    @location(3) style: vec4<f32>,        // line thickness, height gradient, unused
+};
+
+struct TraceOutput {
+    @builtin(position) position: vec4<f32>,
+    @location(0) across: f32,             // pixel distance from the center of a line segment
+    @location(1) height: f32,             // 0 at the bottom of the bounds, 1 at the top
+    @location(2) @interpolate(flat) color: vec4<f32>,
+    @location(3) @interpolate(flat) halfWidth: f32,
+    @location(4) @interpolate(flat) gradient: f32,
+};
+
+@group(1) @binding(0) var<storage, read> traceSamples: array<f32>;
+
+const TRACE_LINE: u32 = 0u;
+const TRACE_COLUMNS: u32 = 1u;
+const TRACE_FILL: u32 = 2u;
+const TRACE_BARS: u32 = 3u;
+
+fn trace_x(bounds: vec4<f32>, index: u32, count: u32) -> f32 {
+    return bounds.x + f32(index) / f32(max(count, 2u) - 1u) * bounds.z;
+}
+
+fn trace_y(bounds: vec4<f32>, value: f32) -> f32 {
+    return bounds.y + bounds.w * 0.5 - value * bounds.w * 0.5;
+}
+
+@vertex
+fn vs_trace(@builtin(vertex_index) vertexIndex: u32, input: TraceInput) -> TraceOutput {
+    // Two triangles per segment, x runs along the segment and y across it
+    var corners = array<vec2<f32>, 6>(
+        vec2<f32>(0.0, 0.0),
+        vec2<f32>(1.0, 0.0),
+        vec2<f32>(1.0, 1.0),
+        vec2<f32>(0.0, 0.0),
+        vec2<f32>(1.0, 1.0),
+        vec2<f32>(0.0, 1.0)
+    );
+    let corner = corners[vertexIndex % 6u];
+    let segment = vertexIndex / 6u;
+
+    let bounds = input.bounds;
+    let first = input.range.x;
+    let count = input.range.y;
+    let segments = max(input.range.w, 1u);
+    let halfWidth = input.style.x * 0.5;
+
+    var pos = vec2<f32>(0.0, 0.0);
+    var across = 0.0;
+    var gradient = 0.0;
+    switch input.range.z {
+        case TRACE_COLUMNS: {
+            // One pixel column per segment, covering the min and max of its samples.
+            // Each column also takes the next column's first sample, so the trace stays connected.
+            let start = segment * count / segments;
+            let end = min((segment + 1u) * count / segments + 1u, count);
+            var lo = traceSamples[first + start];
+            var hi = lo;
+            for (var i = start + 1u; i < end; i = i + 1u) {
+                let value = traceSamples[first + i];
+                lo = min(lo, value);
+                hi = max(hi, value);
+            }
+            let x0 = bounds.x + f32(segment) / f32(segments) * bounds.z;
+            let x1 = bounds.x + f32(segment + 1u) / f32(segments) * bounds.z;
+            let top = trace_y(bounds, hi) - halfWidth;
+            let bottom = trace_y(bounds, lo) + halfWidth;
+            pos = vec2<f32>(mix(x0, x1, corner.x), mix(top, bottom, corner.y));
+        }
+        case TRACE_FILL: {
+            // The area between the center line and the samples
+            let p0 = vec2<f32>(trace_x(bounds, segment, count), trace_y(bounds, traceSamples[first + segment]));
+            let p1 = vec2<f32>(trace_x(bounds, segment + 1u, count), trace_y(bounds, traceSamples[first + segment + 1u]));
+            let p = mix(p0, p1, corner.x);
+            pos = vec2<f32>(p.x, mix(bounds.y + bounds.w * 0.5, p.y, corner.y));
+        }
+        case TRACE_BARS: {
+            // Even segments are the bars, odd ones the peak markers on top of them
+            let bar = segment / 2u;
+            let barWidth = bounds.z / f32(count);
+            let barHeight = traceSamples[first + bar] * bounds.w;
+            let x0 = bounds.x + f32(bar) * barWidth;
+            let x1 = x0 + max(barWidth - 1.0, 0.0);
+            let top = bounds.y + bounds.w - barHeight;
+            if (segment % 2u == 0u) {
+                pos = vec2<f32>(mix(x0, x1, corner.x), mix(top, top + barHeight, corner.y));
+                gradient = input.style.y;
+            } else {
+                pos = vec2<f32>(mix(x0, x1, corner.x), mix(top - 2.0, top, corner.y));
+            }
+        }
+        case TRACE_LINE, default: {
+            // A thick segment between neighbouring samples, extended by half the
+            // thickness at both ends so consecutive segments overlap at the joins
+            let p0 = vec2<f32>(trace_x(bounds, segment, count), trace_y(bounds, traceSamples[first + segment]));
+            let p1 = vec2<f32>(trace_x(bounds, segment + 1u, count), trace_y(bounds, traceSamples[first + segment + 1u]));
+            let delta = p1 - p0;
+            let len = length(delta);
+            var dir = vec2<f32>(1.0, 0.0);
+            if (len > 0.0001) {
+                dir = delta / len;
+            }
+            let normal = vec2<f32>(-dir.y, dir.x);
+            // Grow by a pixel so the antialiased edge isn't cut off
+            let extent = halfWidth + 1.0;
+            across = (corner.y * 2.0 - 1.0) * extent;
+            pos = mix(p0, p1, corner.x) + dir * (corner.x * 2.0 - 1.0) * halfWidth + normal * across;
+        }
+    }
+
+    var output: TraceOutput;
+    output.position = vec4<f32>(
+        (pos.x / uniforms.viewSize.x) * 2.0 - 1.0,
+        1.0 - (pos.y / uniforms.viewSize.y) * 2.0,
+        0.0, 1.0);
+    output.across = across;
+    output.height = (bounds.y + bounds.w - pos.y) / max(bounds.w, 0.0001);
+    output.color = input.color;
+    output.halfWidth = max(halfWidth, 0.5);
+    output.gradient = gradient;
+    return output;
+}
+
+@fragment
+fn fs_trace(input: TraceOutput) -> @location(0) vec4<f32> {
+    var color = input.color;
+    if (input.gradient > 0.5) {
+        // Same green, yellow, red zones as fs_spectrum_bar
+        let height = clamp(input.height, 0.0, 1.0);
+        if (height > 0.8) {
+            let t = (height - 0.8) / 0.2;
+            color = vec4<f32>(1.0, max(0.0, 1.0 - t * 0.7), 0.1, color.a);
+        } else if (height > 0.5) {
+            let t = (height - 0.5) / 0.3;
+            color = vec4<f32>(0.5 + t * 0.5, 1.0, 0.1, color.a);
+        } else {
+            color = vec4<f32>(0.2, 0.5 + height, 0.2, color.a);
+        }
+    }
+
+    let coverage = clamp(input.halfWidth + 0.5 - abs(input.across), 0.0, 1.0);
+    color.a = color.a * coverage;
+    return color;
+}
 )";
 
 WebGPURenderer::WebGPURenderer(WebGPUContext& context)
@@ -861,16 +1146,24 @@ WebGPURenderer::WebGPURenderer(WebGPUContext& context)
     mCurrentState.fillColor = Color(1.0f, 1.0f, 1.0f, 1.0f);
     mCurrentState.strokeColor = Color(0.0f, 0.0f, 0.0f, 1.0f);
     mCurrentState.strokeWidth = 1.0f;
+    mCurrentState.lineJoin = LineJoin::Miter;
     mCurrentState.hasScissor = false;
 }
 
 WebGPURenderer::~WebGPURenderer() {
     if (mBindGroup) wgpuBindGroupRelease(mBindGroup);
+    if (mShapeBindGroup) wgpuBindGroupRelease(mShapeBindGroup);
+    if (mSampleBindGroup) wgpuBindGroupRelease(mSampleBindGroup);
+    for (Layer& layer : mLayers) releaseLayer(layer);
+    if (mLayerSampler) wgpuSamplerRelease(mLayerSampler);
     if (mUniformBuffer) wgpuBufferRelease(mUniformBuffer);
-    if (mVertexBuffer) wgpuBufferRelease(mVertexBuffer);
+    if (mVertexRing.buffer) wgpuBufferRelease(mVertexRing.buffer);
+    if (mInstanceRing.buffer) wgpuBufferRelease(mInstanceRing.buffer);
+    if (mTraceRing.buffer) wgpuBufferRelease(mTraceRing.buffer);
+    if (mSampleRing.buffer) wgpuBufferRelease(mSampleRing.buffer);
+    if (mQuadIndexBuffer) wgpuBufferRelease(mQuadIndexBuffer);
 
     // Release all pipelines
-    if (mStrokePipeline) wgpuRenderPipelineRelease(mStrokePipeline);
     if (mPipelines.solid) wgpuRenderPipelineRelease(mPipelines.solid);
     if (mPipelines.textured) wgpuRenderPipelineRelease(mPipelines.textured);
     if (mPipelines.knob_highlight) wgpuRenderPipelineRelease(mPipelines.knob_highlight);
@@ -903,8 +1196,12 @@ WebGPURenderer::~WebGPURenderer() {
     if (mPipelines.fader_groove) wgpuRenderPipelineRelease(mPipelines.fader_groove);
     if (mPipelines.fader_cap) wgpuRenderPipelineRelease(mPipelines.fader_cap);
     if (mPipelines.mod_wheel) wgpuRenderPipelineRelease(mPipelines.mod_wheel);
+    if (mPipelines.shape) wgpuRenderPipelineRelease(mPipelines.shape);
+    if (mPipelines.trace) wgpuRenderPipelineRelease(mPipelines.trace);
+    if (mPipelines.layer) wgpuRenderPipelineRelease(mPipelines.layer);
 
     if (mBindGroupLayout) wgpuBindGroupLayoutRelease(mBindGroupLayout);
+    if (mSampleBindGroupLayout) wgpuBindGroupLayoutRelease(mSampleBindGroupLayout);
 }
 
 bool WebGPURenderer::initialize() {
@@ -934,10 +1231,13 @@ bool WebGPURenderer::initialize() {
     createBuffers();
     
     // Verify buffers were created
-    if (!mVertexBuffer || !mUniformBuffer) {
+    if (!mVertexRing.buffer || !mInstanceRing.buffer || !mUniformBuffer || !mQuadIndexBuffer) {
         printf("WebGPURenderer: ERROR - Failed to create required buffers\n");
         return false;
     }
+
+    // Text falls back to placeholder boxes if the font can't be loaded
+    createTextAtlas();
     
     // Set default pipeline
     mCurrentPipeline = mPipelines.solid;
@@ -1101,6 +1401,12 @@ void WebGPURenderer::createPipelines() {
     mPipelines.fader_groove = createPipeline("fs_fader_groove");
     mPipelines.fader_cap = createPipeline("fs_fader_cap");
     mPipelines.mod_wheel = createPipeline("fs_mod_wheel");
+
+    // Layers are rendered with the blending above over a transparent clear, so their
+    // color is already premultiplied and gets blitted without multiplying by alpha again
+    blendState.color.srcFactor = WGPUBlendFactor_One;
+    mPipelines.layer = createPipeline("fs_textured");
+    blendState.color.srcFactor = WGPUBlendFactor_SrcAlpha;
 #else
     printf("WebGPURenderer: Skipping pipeline creation because WGSL/chain types are unavailable in this build\n");
     memset(&mPipelines, 0, sizeof(mPipelines));
@@ -1145,21 +1451,99 @@ void WebGPURenderer::createPipelines() {
     checkPipeline(mPipelines.fader_groove, "fs_fader_groove");
     checkPipeline(mPipelines.fader_cap, "fs_fader_cap");
     checkPipeline(mPipelines.mod_wheel, "fs_mod_wheel");
+    checkPipeline(mPipelines.layer, "fs_textured (layer)");
 
-    // Create stroke pipeline (lines) - uses solid color shader
+    // Create the instanced SDF shape pipeline. Instances are stepped per instance and
+    // the quad corners come from the vertex index, so there's no per-vertex data at all.
     if (shaderModule) {
-        pipelineDesc.primitive.topology = WGPUPrimitiveTopology_LineList;
-        fragmentState.entryPoint = s("fs_solid");
-        mStrokePipeline = wgpuDeviceCreateRenderPipeline(device, &pipelineDesc);
-    } else {
-        // No shader module available in this build; leave stroke pipeline null
-        mStrokePipeline = nullptr;
+        WGPUVertexAttribute shapeAttributes[5] = {};
+        const size_t shapeOffsets[5] = {
+            offsetof(ShapeInstance2D, cx),
+            offsetof(ShapeInstance2D, axisX),
+            offsetof(ShapeInstance2D, params),
+            offsetof(ShapeInstance2D, fill),
+            offsetof(ShapeInstance2D, stroke)
+        };
+        for (int i = 0; i < 5; ++i) {
+            shapeAttributes[i].format = WGPUVertexFormat_Float32x4;
+            shapeAttributes[i].offset = shapeOffsets[i];
+            shapeAttributes[i].shaderLocation = i;
+        }
+
+        WGPUVertexBufferLayout shapeBufferLayout = {};
+        shapeBufferLayout.arrayStride = sizeof(ShapeInstance2D);
+        shapeBufferLayout.stepMode = WGPUVertexStepMode_Instance;
+        shapeBufferLayout.attributeCount = 5;
+        shapeBufferLayout.attributes = shapeAttributes;
+
+        pipelineDesc.vertex.entryPoint = s("vs_shape");
+        pipelineDesc.vertex.buffers = &shapeBufferLayout;
+        mPipelines.shape = createPipeline("fs_shape");
+        checkPipeline(mPipelines.shape, "fs_shape");
+
+        pipelineDesc.vertex.entryPoint = s("vs_main");
+        pipelineDesc.vertex.buffers = &vertexBufferLayout;
+    }
+
+    // Create the sample trace pipeline. The samples are read from a storage buffer in group 1,
+    // and like the shapes, the trace instances are the only vertex input.
+    WGPUPipelineLayout tracePipelineLayout = nullptr;
+    if (shaderModule) {
+        WGPUBindGroupLayoutEntry sampleEntry = {};
+        sampleEntry.binding = 0;
+        sampleEntry.visibility = WGPUShaderStage_Vertex;
+        sampleEntry.buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
+        sampleEntry.buffer.minBindingSize = sizeof(float);
+
+        WGPUBindGroupLayoutDescriptor sampleLayoutDesc = {};
+        sampleLayoutDesc.entryCount = 1;
+        sampleLayoutDesc.entries = &sampleEntry;
+        if (mSampleBindGroupLayout) wgpuBindGroupLayoutRelease(mSampleBindGroupLayout);
+        mSampleBindGroupLayout = wgpuDeviceCreateBindGroupLayout(device, &sampleLayoutDesc);
+    }
+
+    if (shaderModule && mSampleBindGroupLayout) {
+        WGPUBindGroupLayout traceLayouts[2] = { mBindGroupLayout, mSampleBindGroupLayout };
+        WGPUPipelineLayoutDescriptor traceLayoutDesc = {};
+        traceLayoutDesc.bindGroupLayoutCount = 2;
+        traceLayoutDesc.bindGroupLayouts = traceLayouts;
+        tracePipelineLayout = wgpuDeviceCreatePipelineLayout(device, &traceLayoutDesc);
+
+        WGPUVertexAttribute traceAttributes[4] = {};
+        const size_t traceOffsets[4] = {
+            offsetof(TraceInstance2D, x),
+            offsetof(TraceInstance2D, first),
+            offsetof(TraceInstance2D, color),
+            offsetof(TraceInstance2D, thickness)
+        };
+        for (int i = 0; i < 4; ++i) {
+            traceAttributes[i].format = i == 1 ? WGPUVertexFormat_Uint32x4 : WGPUVertexFormat_Float32x4;
+            traceAttributes[i].offset = traceOffsets[i];
+            traceAttributes[i].shaderLocation = i;
+        }
+
+        WGPUVertexBufferLayout traceBufferLayout = {};
+        traceBufferLayout.arrayStride = sizeof(TraceInstance2D);
+        traceBufferLayout.stepMode = WGPUVertexStepMode_Instance;
+        traceBufferLayout.attributeCount = 4;
+        traceBufferLayout.attributes = traceAttributes;
+
+        pipelineDesc.layout = tracePipelineLayout;
+        pipelineDesc.vertex.entryPoint = s("vs_trace");
+        pipelineDesc.vertex.buffers = &traceBufferLayout;
+        mPipelines.trace = createPipeline("fs_trace");
+        checkPipeline(mPipelines.trace, "fs_trace");
+
+        pipelineDesc.layout = pipelineLayout;
+        pipelineDesc.vertex.entryPoint = s("vs_main");
+        pipelineDesc.vertex.buffers = &vertexBufferLayout;
     }
 
     // Clean up
     if (shaderModule) wgpuShaderModuleRelease(shaderModule);
     // Note: mBindGroupLayout is cached and will be released in the destructor
     wgpuPipelineLayoutRelease(pipelineLayout);
+    if (tracePipelineLayout) wgpuPipelineLayoutRelease(tracePipelineLayout);
 }
 
 void WebGPURenderer::createBuffers() {
@@ -1171,11 +1555,40 @@ void WebGPURenderer::createBuffers() {
     uniformBufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
     mUniformBuffer = wgpuDeviceCreateBuffer(device, &uniformBufferDesc);
     
-    // Create vertex buffer (will be resized as needed)
+    // Create vertex and shape instance buffers (grown by allocateRing as needed)
     WGPUBufferDescriptor vertexBufferDesc = {};
-    vertexBufferDesc.size = sizeof(Vertex2D) * 65536;  // Initial size
+    vertexBufferDesc.size = sizeof(Vertex2D) * kInitialVertexCapacity;
     vertexBufferDesc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst;
-    mVertexBuffer = wgpuDeviceCreateBuffer(device, &vertexBufferDesc);
+    mVertexRing.buffer = wgpuDeviceCreateBuffer(device, &vertexBufferDesc);
+    mVertexRing.capacity = mVertexRing.buffer ? vertexBufferDesc.size : 0;
+    mVertexRing.head = 0;
+
+    WGPUBufferDescriptor instanceBufferDesc = {};
+    instanceBufferDesc.size = sizeof(ShapeInstance2D) * kInitialShapeCapacity;
+    instanceBufferDesc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst;
+    mInstanceRing.buffer = wgpuDeviceCreateBuffer(device, &instanceBufferDesc);
+    mInstanceRing.capacity = mInstanceRing.buffer ? instanceBufferDesc.size : 0;
+    mInstanceRing.head = 0;
+
+    // Create the shared quad index buffer, so quads only need 4 vertices each
+    std::vector<uint16_t> quadIndices(kMaxQuadsPerDraw * 6);
+    for (uint32_t i = 0; i < kMaxQuadsPerDraw; ++i) {
+        uint16_t base = static_cast<uint16_t>(i * 4);
+        quadIndices[i * 6 + 0] = base + 0;
+        quadIndices[i * 6 + 1] = base + 1;
+        quadIndices[i * 6 + 2] = base + 2;
+        quadIndices[i * 6 + 3] = base + 0;
+        quadIndices[i * 6 + 4] = base + 2;
+        quadIndices[i * 6 + 5] = base + 3;
+    }
+    WGPUBufferDescriptor indexBufferDesc = {};
+    indexBufferDesc.size = quadIndices.size() * sizeof(uint16_t);
+    indexBufferDesc.usage = WGPUBufferUsage_Index | WGPUBufferUsage_CopyDst;
+    mQuadIndexBuffer = wgpuDeviceCreateBuffer(device, &indexBufferDesc);
+    if (mQuadIndexBuffer) {
+        wgpuQueueWriteBuffer(mContext.getQueue(), mQuadIndexBuffer, 0,
+                             quadIndices.data(), indexBufferDesc.size);
+    }
     
     // Create default 1x1 white texture
     WGPUTextureDescriptor textureDesc = {};
@@ -1279,6 +1692,83 @@ void WebGPURenderer::createBuffers() {
     if (!mBindGroupLayout && mPipelines.solid) wgpuBindGroupLayoutRelease(layout);
 }
 
+void WebGPURenderer::createTextAtlas() {
+    if (!mBindGroupLayout || !mGlyphAtlas.build("/resource/frabk.ttf")) {
+        printf("WebGPURenderer: WARNING - No glyph atlas, text will be drawn as placeholders\n");
+        return;
+    }
+
+    WGPUDevice device = mContext.getDevice();
+
+    WGPUTextureDescriptor textureDesc = {};
+    textureDesc.usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopyDst;
+    textureDesc.dimension = WGPUTextureDimension_2D;
+    textureDesc.size = {static_cast<uint32_t>(mGlyphAtlas.getWidth()), static_cast<uint32_t>(mGlyphAtlas.getHeight()), 1};
+    textureDesc.format = WGPUTextureFormat_R8Unorm;
+    textureDesc.mipLevelCount = 1;
+    textureDesc.sampleCount = 1;
+    WGPUTexture atlasTexture = wgpuDeviceCreateTexture(device, &textureDesc);
+    if (!atlasTexture) {
+        printf("WebGPURenderer: ERROR - Failed to create glyph atlas texture\n");
+        return;
+    }
+
+    WGPUTexelCopyTextureInfo destination = {};
+    destination.texture = atlasTexture;
+    destination.mipLevel = 0;
+    destination.origin = {0, 0, 0};
+    destination.aspect = WGPUTextureAspect_All;
+
+    WGPUTexelCopyBufferLayout dataLayout = {};
+    dataLayout.offset = 0;
+    dataLayout.bytesPerRow = mGlyphAtlas.getWidth();
+    dataLayout.rowsPerImage = mGlyphAtlas.getHeight();
+
+    const std::vector<uint8_t>& pixels = mGlyphAtlas.getPixels();
+    wgpuQueueWriteTexture(mContext.getQueue(), &destination, pixels.data(), pixels.size(), &dataLayout, &textureDesc.size);
+
+    WGPUTextureViewDescriptor viewDesc = {};
+    viewDesc.format = WGPUTextureFormat_R8Unorm;
+    viewDesc.dimension = WGPUTextureViewDimension_2D;
+    viewDesc.baseMipLevel = 0;
+    viewDesc.mipLevelCount = 1;
+    viewDesc.baseArrayLayer = 0;
+    viewDesc.arrayLayerCount = 1;
+    viewDesc.aspect = WGPUTextureAspect_All;
+    WGPUTextureView atlasView = wgpuTextureCreateView(atlasTexture, &viewDesc);
+
+    // Clamp so glyphs at the atlas edges don't pick up the opposite side
+    WGPUSamplerDescriptor samplerDesc = {};
+    samplerDesc.addressModeU = WGPUAddressMode_ClampToEdge;
+    samplerDesc.addressModeV = WGPUAddressMode_ClampToEdge;
+    samplerDesc.addressModeW = WGPUAddressMode_ClampToEdge;
+    samplerDesc.magFilter = WGPUFilterMode_Linear;
+    samplerDesc.minFilter = WGPUFilterMode_Linear;
+    samplerDesc.mipmapFilter = WGPUMipmapFilterMode_Nearest;
+    WGPUSampler atlasSampler = wgpuDeviceCreateSampler(device, &samplerDesc);
+
+    WGPUBindGroupEntry bgEntries[3] = {};
+    bgEntries[0].binding = 0;
+    bgEntries[0].buffer = mUniformBuffer;
+    bgEntries[0].offset = 0;
+    bgEntries[0].size = sizeof(float) * 4;
+    bgEntries[1].binding = 1;
+    bgEntries[1].sampler = atlasSampler;
+    bgEntries[2].binding = 2;
+    bgEntries[2].textureView = atlasView;
+
+    WGPUBindGroupDescriptor bindGroupDesc = {};
+    bindGroupDesc.layout = mBindGroupLayout;
+    bindGroupDesc.entryCount = 3;
+    bindGroupDesc.entries = bgEntries;
+    mShapeBindGroup = wgpuDeviceCreateBindGroup(device, &bindGroupDesc);
+
+    // The bind group keeps its own references
+    wgpuSamplerRelease(atlasSampler);
+    wgpuTextureViewRelease(atlasView);
+    wgpuTextureRelease(atlasTexture);
+}
+
 void WebGPURenderer::beginFrame(int width, int height, float pixelRatio, float time) {
     mWidth = width;
     mHeight = height;
@@ -1286,7 +1776,7 @@ void WebGPURenderer::beginFrame(int width, int height, float pixelRatio, float t
     mTime = time;
     mFrameStarted = true;
     
-    mVertices.clear();
+    clearFrame();
     
     // Update uniform buffer with view size and time
     float uniforms[4] = {
@@ -1302,10 +1792,12 @@ void WebGPURenderer::beginFrame(int width, int height, float pixelRatio, float t
 
     // Reset pipeline
     mCurrentPipeline = mPipelines.solid;
+    mCurrentGeometry = Geometry::Triangles;
 }
 
 void WebGPURenderer::endFrame() {
-    flushBatch();
+    submitFrame();
+    mPathCache.endFrame();
     mFrameStarted = false;
 }
 
@@ -1330,6 +1822,7 @@ void WebGPURenderer::reset() {
     mCurrentState.fillColor = Color(1.0f, 1.0f, 1.0f, 1.0f);
     mCurrentState.strokeColor = Color(0.0f, 0.0f, 0.0f, 1.0f);
     mCurrentState.strokeWidth = 1.0f;
+    mCurrentState.lineJoin = LineJoin::Miter;
     mCurrentState.hasScissor = false;
 }
 
@@ -1389,35 +1882,47 @@ void WebGPURenderer::strokeWidth(float width) {
     mCurrentState.strokeWidth = width;
 }
 
+void WebGPURenderer::lineJoin(LineJoin join) {
+    mCurrentState.lineJoin = join;
+}
+
 void WebGPURenderer::beginPath() {
     mPathPoints.clear();
+    mPathContours.clear();
     mPathHasStart = false;
 }
 
 void WebGPURenderer::moveTo(float x, float y) {
-    transformPoint(x, y);
-    mPathStartX = x;
-    mPathStartY = y;
-    mPathX = x;
-    mPathY = y;
+    mPathContours.push_back({static_cast<uint32_t>(mPathPoints.size() / 2), 0, false});
     mPathHasStart = true;
+    pathPoint(x, y);
 }
 
 void WebGPURenderer::lineTo(float x, float y) {
-    transformPoint(x, y);
-    if (mPathHasStart) {
-        mPathPoints.push_back(mPathX);
-        mPathPoints.push_back(mPathY);
-        mPathPoints.push_back(x);
-        mPathPoints.push_back(y);
+    if (!mPathHasStart) {
+        moveTo(x, y);
+        return;
     }
+    pathPoint(x, y);
+}
+
+void WebGPURenderer::pathPoint(float x, float y) {
+    mPathPoints.push_back(x);
+    mPathPoints.push_back(y);
+    mPathContours.back().count++;
     mPathX = x;
     mPathY = y;
 }
 
 void WebGPURenderer::closePath() {
     if (mPathHasStart) {
-        lineTo(mPathStartX, mPathStartY);
+        PathContour& contour = mPathContours.back();
+        contour.closed = true;
+        // Further segments continue from the start of the closed contour, as in nanovg
+        mPathX = mPathPoints[contour.first * 2];
+        mPathY = mPathPoints[contour.first * 2 + 1];
+        mPathHasStart = false;
+        moveTo(mPathX, mPathY);
     }
 }
 
@@ -1426,10 +1931,6 @@ void WebGPURenderer::bezierTo(float c1x, float c1y, float c2x, float c2y, float
     const int segments = 20;
     float px = mPathX, py = mPathY;
     
-    transformPoint(c1x, c1y);
-    transformPoint(c2x, c2y);
-    transformPoint(x, y);
-    
     for (int i = 1; i <= segments; i++) {
         float t = static_cast<float>(i) / segments;
         float t2 = t * t;
@@ -1441,13 +1942,7 @@ void WebGPURenderer::bezierTo(float c1x, float c1y, float c2x, float c2y, float
         float bx = mt3 * px + 3.0f * mt2 * t * c1x + 3.0f * mt * t2 * c2x + t3 * x;
         float by = mt3 * py + 3.0f * mt2 * t * c1y + 3.0f * mt * t2 * c2y + t3 * y;
         
-        mPathPoints.push_back(mPathX);
-        mPathPoints.push_back(mPathY);
-        mPathPoints.push_back(bx);
-        mPathPoints.push_back(by);
-        
-        mPathX = bx;
-        mPathY = by;
+        lineTo(bx, by);
     }
 }
 
@@ -1461,118 +1956,54 @@ void WebGPURenderer::quadTo(float cx, float cy, float x, float y) {
 }
 
 void WebGPURenderer::arc(float cx, float cy, float r, float a0, float a1, int dir) {
-    transformPoint(cx, cy);
-    
     // Draw arc as line segments
     float da = a1 - a0;
     if (dir == 1) {
-        if (da < 0) da += TWO_PI;
+        if (std::abs(da) >= TWO_PI) da = -TWO_PI;
+        else while (da > 0) da -= TWO_PI;
     } else {
-        if (da > 0) da -= TWO_PI;
+        if (std::abs(da) >= TWO_PI) da = TWO_PI;
+        else while (da < 0) da += TWO_PI;
     }
     
     int numSegments = std::max(3, static_cast<int>(std::abs(da) * r / kArcTessellationFactor));
     float dAngle = da / numSegments;
     
-    if (!mPathHasStart) {
-        float startX = cx + cosf(a0) * r;
-        float startY = cy + sinf(a0) * r;
-        moveTo(startX, startY);
-    }
+    // Connect to the current point, or start a new contour
+    lineTo(cx + cosf(a0) * r, cy + sinf(a0) * r);
     
     for (int i = 1; i <= numSegments; i++) {
         float angle = a0 + dAngle * i;
-        float x = cx + cosf(angle) * r;
-        float y = cy + sinf(angle) * r;
-        
-        mPathPoints.push_back(mPathX);
-        mPathPoints.push_back(mPathY);
-        mPathPoints.push_back(x);
-        mPathPoints.push_back(y);
-        
-        mPathX = x;
-        mPathY = y;
+        lineTo(cx + cosf(angle) * r, cy + sinf(angle) * r);
     }
 }
 
 void WebGPURenderer::arcTo(float x1, float y1, float x2, float y2, float radius) {
-    // Simplified arc-to implementation
-    transformPoint(x1, y1);
-    transformPoint(x2, y2);
-    
-    float dx1 = mPathX - x1;
-    float dy1 = mPathY - y1;
-    float dx2 = x2 - x1;
-    float dy2 = y2 - y1;
-    
-    // Just draw lines for now
+    // Simplified arc-to implementation, just draw lines for now
     lineTo(x1, y1);
     lineTo(x2, y2);
 }
 
 void WebGPURenderer::fill() {
-    setPipeline(mPipelines.solid);
+    if (mPathPoints.size() < 6) return;
+    drawPathTriangles(mPathCache.getFill(mPathPoints, mPathContours), mCurrentState.fillColor);
+}
 
-    // Simple triangle fan fill for convex shapes
+void WebGPURenderer::stroke() {
     if (mPathPoints.size() < 4) return;
-    
-    // Get center point (average of all points)
-    float cx = 0, cy = 0;
-    int numPoints = 0;
-    for (size_t i = 0; i < mPathPoints.size(); i += 2) {
-        cx += mPathPoints[i];
-        cy += mPathPoints[i + 1];
-        numPoints++;
-    }
-    cx /= numPoints;
-    cy /= numPoints;
-    
-    // Draw triangles from center
-    for (size_t i = 0; i < mPathPoints.size() - 2; i += 2) {
-        pushVertex(cx, cy, 0, 0, mCurrentState.fillColor);
-        pushVertex(mPathPoints[i], mPathPoints[i + 1], 0, 0, mCurrentState.fillColor);
-        pushVertex(mPathPoints[i + 2], mPathPoints[i + 3], 0, 0, mCurrentState.fillColor);
-    }
+    drawPathTriangles(mPathCache.getStroke(mPathPoints, mPathContours, mCurrentState.strokeWidth, mCurrentState.lineJoin),
+                      mCurrentState.strokeColor);
 }
 
-void WebGPURenderer::stroke() {
-    setPipeline(mStrokePipeline);
-
-    // Draw path as lines
-    for (size_t i = 0; i < mPathPoints.size() - 2; i += 2) {
-        // Create thick line using quads
-        float x1 = mPathPoints[i];
-        float y1 = mPathPoints[i + 1];
-        float x2 = mPathPoints[i + 2];
-        float y2 = mPathPoints[i + 3];
-        
-        float dx = x2 - x1;
-        float dy = y2 - y1;
-        float len = sqrtf(dx * dx + dy * dy);
-        if (len < 0.0001f) continue;
-        
-        float nx = -dy / len * mCurrentState.strokeWidth * 0.5f;
-        float ny = dx / len * mCurrentState.strokeWidth * 0.5f;
-        
-        // This actually draws filled quads (triangles), not lines, so we use pushVertex
-        // Note: stroke pipeline is configured as LineList but here we are generating quads.
-        // If we really want thick lines in WebGPU, we must draw quads.
-        // However, if mStrokePipeline is LineList, we must output lines.
-        // Let's stick to simple lines for LineList, or switch to quads if we want width > 1.
-        // For now, simpler implementation:
-        
-        // Just raw lines for LineList topology
-        if (mCurrentState.strokeWidth <= 1.5f) {
-             pushVertex(x1, y1, 0, 0, mCurrentState.strokeColor);
-             pushVertex(x2, y2, 0, 0, mCurrentState.strokeColor);
-        } else {
-             // For thick lines, we need to use a triangle topology pipeline (solid)
-             // But we already switched to mStrokePipeline (LineList).
-             // Let's temporarily switch to solid for thick lines?
-             // Or just ignore thickness for now to keep it simple and correct.
-             pushVertex(x1, y1, 0, 0, mCurrentState.strokeColor);
-             pushVertex(x2, y2, 0, 0, mCurrentState.strokeColor);
-        }
+void WebGPURenderer::drawPathTriangles(const std::vector<float>& triangles, const Color& color) {
+    setPipeline(mPipelines.solid);
+
+    // Cached triangles are in local coordinates, the transform is applied here
+    for (size_t i = 0; i + 1 < triangles.size(); i += 2) {
+        float x = triangles[i];
+        float y = triangles[i + 1];
+        transformPoint(x, y);
+        pushVertex(x, y, 0, 0, color);
     }
 }
 
@@ -1640,9 +2071,70 @@ void WebGPURenderer::fontFace(const char* name) {
 }
 
 void WebGPURenderer::text(float x, float y, const char* string) {
-    // Simple box-based text rendering as placeholder
-    // Each character is a small box with approximate spacing
     if (!string || string[0] == '\0') return;
+
+    if (!mGlyphAtlas.isValid() || !mShapeBindGroup || !mPipelines.shape) {
+        drawPlaceholderText(x, y, string);
+        return;
+    }
+
+    // Glyphs are shape instances, so text batches with knobs, panels and the rest
+    const TextLayout& layout = getTextLayout(string);
+    for (const ShapeInstance2D& glyph : layout.glyphs) {
+        ShapeInstance2D shape = glyph;
+        shape.cx += x;
+        shape.cy += y;
+        shape.fill = mCurrentState.fillColor;
+        pushShape(shape);
+    }
+}
+
+const WebGPURenderer::TextLayout& WebGPURenderer::getTextLayout(const char* string) {
+    std::string key(reinterpret_cast<const char*>(&mFontSize), sizeof(mFontSize));
+    key += string;
+
+    auto it = mTextLayouts.find(key);
+    if (it != mTextLayouts.end()) return it->second;
+
+    // UI labels are few and stable, so when the cache fills up it's fine to just start over
+    if (mTextLayouts.size() >= kMaxTextLayouts) mTextLayouts.clear();
+
+    TextLayout& layout = mTextLayouts[key];
+    float scale = mFontSize / GlyphAtlas::kBaseSize;
+    float penX = 0.0f;
+    int previous = 0;
+    for (const char* c = string; *c; ++c) {
+        int codepoint = static_cast<unsigned char>(*c);
+        if (previous) penX += mGlyphAtlas.getKerning(previous, codepoint) * scale;
+
+        const GlyphAtlas::Glyph& glyph = mGlyphAtlas.getGlyph(codepoint);
+        if (glyph.visible) {
+            float w = glyph.width * scale;
+            float h = glyph.height * scale;
+
+            ShapeInstance2D shape = {};
+            shape.cx = penX + glyph.xOffset * scale + w * 0.5f;
+            shape.cy = glyph.yOffset * scale + h * 0.5f;
+            shape.hw = w * 0.5f;
+            shape.hh = h * 0.5f;
+            shape.kind = static_cast<float>(ShapeKind::Glyph);
+            shape.params[0] = glyph.u0;
+            shape.params[1] = glyph.v0;
+            shape.params[2] = glyph.u1;
+            shape.params[3] = glyph.v1;
+            layout.glyphs.push_back(shape);
+        }
+
+        penX += glyph.advance * scale;
+        previous = codepoint;
+    }
+    layout.width = penX;
+    return layout;
+}
+
+void WebGPURenderer::drawPlaceholderText(float x, float y, const char* string) {
+    // Simple box-based text rendering, used when no font could be loaded
+    // Each character is a small box with approximate spacing
     
     float charWidth = mFontSize * kCharacterWidthRatio;
     float charHeight = mFontSize;
@@ -1675,6 +2167,9 @@ void WebGPURenderer::text(float x, float y, const char* string) {
 }
 
 float WebGPURenderer::textWidth(const char* string) {
+    if (!string) return 0.0f;
+    if (mGlyphAtlas.isValid()) return getTextLayout(string).width;
+
     // Approximate text width
     return strlen(string) * mFontSize * kCharacterWidthRatio;
 }
@@ -1683,15 +2178,19 @@ float WebGPURenderer::textWidth(const char* string) {
 // Drawing Helpers
 // ============================================================================
 
-void WebGPURenderer::setPipeline(WGPURenderPipeline pipeline) {
-    if (mCurrentPipeline != pipeline) {
-        flushBatch();
+void WebGPURenderer::setPipeline(WGPURenderPipeline pipeline, Geometry geometry) {
+    if (mCurrentPipeline != pipeline || mCurrentGeometry != geometry) {
+        closeDrawCommand();
         mCurrentPipeline = pipeline;
+        if (mCurrentGeometry != geometry) {
+            mCurrentGeometry = geometry;
+            mCommandStart = geometry == Geometry::Shapes ? mShapes.size() : mVertices.size();
+        }
     }
 }
 
 void WebGPURenderer::drawQuad(float x, float y, float w, float h, WGPURenderPipeline pipeline) {
-    setPipeline(pipeline);
+    setPipeline(pipeline, Geometry::Quads);
 
     float x1 = x;
     float y1 = y;
@@ -1709,47 +2208,119 @@ void WebGPURenderer::drawQuad(float x, float y, float w, float h, WGPURenderPipe
     transformPoint(tx3, ty3);
     transformPoint(tx4, ty4);
 
-    // Push vertices (2 triangles)
-    // Triangle 1
+    // Push corners, the two triangles come from the quad index buffer
     pushVertex(tx1, ty1, 0.0f, 0.0f, mCurrentState.fillColor);
     pushVertex(tx2, ty2, 1.0f, 0.0f, mCurrentState.fillColor);
     pushVertex(tx3, ty3, 1.0f, 1.0f, mCurrentState.fillColor);
-
-    // Triangle 2
-    pushVertex(tx1, ty1, 0.0f, 0.0f, mCurrentState.fillColor);
-    pushVertex(tx3, ty3, 1.0f, 1.0f, mCurrentState.fillColor);
     pushVertex(tx4, ty4, 0.0f, 1.0f, mCurrentState.fillColor);
 }
 
+// ============================================================================
+// Instanced SDF shapes
+// ============================================================================
+
+void WebGPURenderer::drawCircle(float cx, float cy, float r, const Color& fill,
+                                const Color& stroke, float strokeWidth) {
+    ShapeInstance2D shape = {};
+    shape.cx = cx;
+    shape.cy = cy;
+    shape.hw = r;
+    shape.hh = r;
+    shape.kind = static_cast<float>(ShapeKind::Circle);
+    shape.strokeWidth = strokeWidth;
+    shape.fill = fill;
+    shape.stroke = stroke;
+    pushShape(shape);
+}
+
+void WebGPURenderer::drawArc(float cx, float cy, float r, float a0, float a1, float thickness, const Color& color) {
+    float sweep = a1 - a0;
+    if (sweep < 0) {
+        a0 = a1;
+        sweep = -sweep;
+    }
+
+    ShapeInstance2D shape = {};
+    shape.cx = cx;
+    shape.cy = cy;
+    shape.hw = r + thickness * 0.5f;
+    shape.hh = r + thickness * 0.5f;
+    shape.kind = static_cast<float>(ShapeKind::Arc);
+    shape.strokeWidth = thickness;
+    shape.params[0] = r;
+    shape.params[1] = a0;
+    shape.params[2] = std::min(sweep, TWO_PI);
+    shape.fill = Color(0, 0, 0, 0);
+    shape.stroke = color;
+    pushShape(shape);
+}
+
+void WebGPURenderer::drawRoundedRect(float x, float y, float w, float h, float r, const Color& fill,
+                                     const Color& stroke, float strokeWidth) {
+    if (w <= 0 || h <= 0) return;
+
+    ShapeInstance2D shape = {};
+    shape.cx = x + w * 0.5f;
+    shape.cy = y + h * 0.5f;
+    shape.hw = w * 0.5f;
+    shape.hh = h * 0.5f;
+    shape.kind = static_cast<float>(ShapeKind::RoundedRect);
+    shape.strokeWidth = strokeWidth;
+    shape.params[0] = std::max(0.0f, std::min(r, std::min(w, h) * 0.5f));
+    shape.fill = fill;
+    shape.stroke = stroke;
+    pushShape(shape);
+}
+
+void WebGPURenderer::drawLine(float x1, float y1, float x2, float y2, float width, const Color& color) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float len = sqrtf(dx * dx + dy * dy);
+
+    ShapeInstance2D shape = {};
+    shape.cx = (x1 + x2) * 0.5f;
+    shape.cy = (y1 + y2) * 0.5f;
+    shape.hw = len * 0.5f + width * 0.5f;
+    shape.hh = width * 0.5f;
+    shape.axisX = len > 0.0001f ? dx / len : 1.0f;
+    shape.axisY = len > 0.0001f ? dy / len : 0.0f;
+    shape.kind = static_cast<float>(ShapeKind::Line);
+    shape.strokeWidth = width;
+    shape.params[0] = len * 0.5f;
+    shape.fill = Color(0, 0, 0, 0);
+    shape.stroke = color;
+    pushShape(shape);
+}
+
 // ============================================================================
 // Specialized synth UI elements
 // ============================================================================
 
 void WebGPURenderer::drawKnob(float cx, float cy, float radius, float value,
                                const Color& bgColor, const Color& fgColor) {
-    float size = radius * 2.0f;
-    float x = cx - radius;
-    float y = cy - radius;
+    // Everything here is an SDF shape instance, so any number of knobs batch into one draw
+    float startAngle = 0.75f * PI;
+    float angle = startAngle + value * 1.5f * PI;
+    float ringThickness = std::max(2.0f, radius * 0.12f);
+    float ringRadius = radius - ringThickness * 0.5f;
+
+    // Value ring over a dim track
+    drawArc(cx, cy, ringRadius, startAngle, startAngle + 1.5f * PI, ringThickness,
+            Color(fgColor.r, fgColor.g, fgColor.b, fgColor.a * 0.25f));
+    if (value > 0.0f)
+        drawArc(cx, cy, ringRadius, startAngle, angle, ringThickness, fgColor);
 
     // Knob body
-    fillColor(bgColor);
-    drawQuad(x, y, size, size, mPipelines.knob_highlight);
-    
-    // Ticks ring
-    fillColor(fgColor);
-    drawQuad(x, y, size, size, mPipelines.dial_ticks);
-    
-    // Value indicator (simple line for now as the shader handles 3D look)
-    // We could add a dedicated shader for the indicator if needed
-    float angle = 0.75f * PI + value * 1.5f * PI;
-    float ix = cx + cosf(angle) * radius * 0.6f;
-    float iy = cy + sinf(angle) * radius * 0.6f;
-    float ix2 = cx + cosf(angle) * radius * 0.9f;
-    float iy2 = cy + sinf(angle) * radius * 0.9f;
-    
-    strokeColor(fgColor);
-    strokeWidth(3.0f);
-    line(ix, iy, ix2, iy2);
+    Color rim(std::min(1.0f, bgColor.r + 0.15f), std::min(1.0f, bgColor.g + 0.15f),
+              std::min(1.0f, bgColor.b + 0.15f), bgColor.a);
+    drawCircle(cx, cy, radius * 0.72f, bgColor, rim, 1.5f);
+
+    // Value indicator
+    float ix = cx + cosf(angle) * radius * 0.25f;
+    float iy = cy + sinf(angle) * radius * 0.25f;
+    float ix2 = cx + cosf(angle) * radius * 0.62f;
+    float iy2 = cy + sinf(angle) * radius * 0.62f;
+    drawLine(ix, iy, ix2, iy2, 3.0f, fgColor);
 }
 
 void WebGPURenderer::drawWire(float x1, float y1, float x2, float y2,
@@ -1808,17 +2379,20 @@ void WebGPURenderer::drawCableWithSag(float x1, float y1, float x2, float y2,
 
 void WebGPURenderer::drawSlider(float x, float y, float w, float h, float value,
                                  const Color& bgColor, const Color& fgColor) {
+    float corner = std::min(w, h) * 0.25f;
+    Color handleColor(std::min(1.0f, fgColor.r + 0.2f), std::min(1.0f, fgColor.g + 0.2f),
+                      std::min(1.0f, fgColor.b + 0.2f), fgColor.a);
+    Color handleEdge(0.0f, 0.0f, 0.0f, 0.5f);
+
     // Track
-    fillColor(bgColor);
-    drawQuad(x, y, w, h, mPipelines.slider_track);
+    drawRoundedRect(x, y, w, h, corner, bgColor);
     
     // Fill
-    fillColor(fgColor);
     // Vertical slider assumption based on typical usage, but check dimensions
     if (h > w) {
         // Vertical
         float fillH = h * value;
-        drawQuad(x, y + h - fillH, w, fillH, mPipelines.slider_fill);
+        drawRoundedRect(x, y + h - fillH, w, fillH, corner, fgColor);
 
         // Handle
         float handleH = w * 0.5f;
@@ -1827,11 +2401,11 @@ void WebGPURenderer::drawSlider(float x, float y, float w, float h, float value,
         if (handleY < y) handleY = y;
         if (handleY > y + h - handleH) handleY = y + h - handleH;
 
-        drawQuad(x, handleY, w, handleH, mPipelines.slider_handle);
+        drawRoundedRect(x, handleY, w, handleH, corner, handleColor, handleEdge, 1.0f);
     } else {
         // Horizontal
         float fillW = w * value;
-        drawQuad(x, y, fillW, h, mPipelines.slider_fill);
+        drawRoundedRect(x, y, fillW, h, corner, fgColor);
 
         // Handle
         float handleW = h * 0.5f;
@@ -1840,21 +2414,16 @@ void WebGPURenderer::drawSlider(float x, float y, float w, float h, float value,
         if (handleX < x) handleX = x;
         if (handleX > x + w - handleW) handleX = x + w - handleW;
 
-        drawQuad(handleX, y, handleW, h, mPipelines.slider_handle);
+        drawRoundedRect(handleX, y, handleW, h, corner, handleColor, handleEdge, 1.0f);
     }
 }
 
 void WebGPURenderer::drawVUMeter(float x, float y, float w, float h, float level,
                                   const Color& lowColor, const Color& highColor) {
     // Background
-    fillColor(Color(0.1f, 0.1f, 0.1f, 1.0f));
-    rect(x, y, w, h);
-    fill();
-    
-    // We can use the fs_spectrum_bar shader or similar for the gradient bar
-    // Or iterate segments like before but use proper shaders
+    drawRoundedRect(x, y, w, h, 2.0f, Color(0.1f, 0.1f, 0.1f, 1.0f));
 
-    // Let's use fs_vu_meter for each segment
+    // Segments are rounded rect instances, batched with the background
     int numSegments = 10;
     float segmentHeight = h / numSegments;
     float gap = 2.0f;
@@ -1871,11 +2440,10 @@ void WebGPURenderer::drawVUMeter(float x, float y, float w, float h, float level
                 lowColor.b + (highColor.b - lowColor.b) * t,
                 1.0f
             );
-            fillColor(c);
-            drawQuad(x + gap, segmentY + gap/2, w - gap * 2, segmentHeight - gap, mPipelines.vu_meter);
+            drawRoundedRect(x + gap, segmentY + gap/2, w - gap * 2, segmentHeight - gap, 1.5f, c);
         } else {
-            fillColor(Color(0.15f, 0.15f, 0.15f, 1.0f));
-            drawQuad(x + gap, segmentY + gap/2, w - gap * 2, segmentHeight - gap, mPipelines.vu_meter);
+            drawRoundedRect(x + gap, segmentY + gap/2, w - gap * 2, segmentHeight - gap, 1.5f,
+                            Color(0.15f, 0.15f, 0.15f, 1.0f));
         }
     }
 }
@@ -1958,17 +2526,16 @@ void WebGPURenderer::drawWaveform(float x, float y, float w, float h, const floa
 
     if (!data || count <= 0) return;
 
-    // Draw waveform segments using lines or thin quads
-    fillColor(mCurrentState.strokeColor);
-
-    // This is expensive to do with quads for every sample
-    // Ideally we would use a line strip with mStrokePipeline
-    // But let's use the waveform shader on a single quad covering the area?
-    // No, the waveform shader expects y-coord to be the amplitude.
+    if (filled) {
+        Color fill = mCurrentState.strokeColor;
+        fill.a *= 0.35f;
+        pushTrace(x, y, w, h, data, count, TraceMode::Fill, fill, 0.0f);
+    }
+    if (pushTrace(x, y, w, h, data, count, TraceMode::Line, mCurrentState.strokeColor, mCurrentState.strokeWidth))
+        return;
 
-    // Actually, fs_waveform uses the texcoord to draw a line at center.
-    // To draw a real waveform, we need to generate geometry.
-    // Let's stick to lines for now.
+    // Stroke the samples as a single path, the tessellation is cached while the data doesn't change
+    fillColor(mCurrentState.strokeColor);
 
     beginPath();
     for (int i = 0; i < count; i++) {
@@ -1983,6 +2550,10 @@ void WebGPURenderer::drawWaveform(float x, float y, float w, float h, const floa
 void WebGPURenderer::drawSpectrum(float x, float y, float w, float h, const float* data, int count) {
     if (!data || count <= 0) return;
 
+    // Bars and peaks in one instanced draw, shaded by height on the GPU
+    if (pushTrace(x, y, w, h, data, count, TraceMode::Bars, Color(0.0f, 1.0f, 0.0f, 1.0f), 0.0f))
+        return;
+
     float barWidth = w / count;
 
     for (int i = 0; i < count; i++) {
@@ -2005,9 +2576,11 @@ void WebGPURenderer::drawScope(float x, float y, float w, float h, const float*
     drawQuad(x, y, w, h, mPipelines.scope_grid);
 
     // Trace
-    // Similar to waveform, need to draw lines
     if (!data || count <= 0) return;
 
+    if (pushTrace(x, y, w, h, data, count, TraceMode::Line, Color(0.2f, 1.0f, 0.2f, 1.0f), mCurrentState.strokeWidth))
+        return;
+
     beginPath();
     for (int i = 0; i < count; i++) {
         float px = x + (static_cast<float>(i) / (count - 1)) * w;
@@ -2034,11 +2607,20 @@ void WebGPURenderer::drawPanel(float x, float y, float w, float h, bool bordered
 }
 
 void WebGPURenderer::drawLED(float x, float y, float w, float h, bool on) {
-    fillColor(mCurrentState.fillColor);
+    const Color& color = mCurrentState.fillColor;
+    float cx = x + w * 0.5f;
+    float cy = y + h * 0.5f;
+    float r = std::min(w, h) * 0.5f;
+
     if (on) {
-        drawQuad(x, y, w, h, mPipelines.led_indicator);
+        // Glow, then a lit core with a bright rim
+        drawCircle(cx, cy, r, Color(color.r, color.g, color.b, color.a * 0.3f));
+        Color rim(std::min(1.0f, color.r + 0.4f), std::min(1.0f, color.g + 0.4f),
+                  std::min(1.0f, color.b + 0.4f), color.a);
+        drawCircle(cx, cy, r * 0.6f, color, rim, 1.0f);
     } else {
-        drawQuad(x, y, w, h, mPipelines.led_off);
+        drawCircle(cx, cy, r * 0.6f, Color(color.r * 0.25f, color.g * 0.25f, color.b * 0.25f, color.a),
+                   Color(0.0f, 0.0f, 0.0f, 0.5f), 1.0f);
     }
 }
 
@@ -2070,31 +2652,488 @@ void WebGPURenderer::pushVertex(float x, float y, float u, float v, const Color&
     mVertices.push_back(vertex);
 }
 
-void WebGPURenderer::flushBatch() {
-    if (mVertices.empty()) return;
-    
-    // Upload vertices
-    wgpuQueueWriteBuffer(mContext.getQueue(), mVertexBuffer, 0,
-                         mVertices.data(), mVertices.size() * sizeof(Vertex2D));
-    
-    // Get render pass encoder
+void WebGPURenderer::pushShape(ShapeInstance2D& shape) {
+    if (!mPipelines.shape) return;
+    setPipeline(mPipelines.shape, Geometry::Shapes);
+
+    // Shapes without an explicit direction use the local x axis
+    if (shape.axisX == 0.0f && shape.axisY == 0.0f) shape.axisX = 1.0f;
+
+    // Map the center and axis through the current transform. Lengths use the
+    // transform's average scale, so non-uniform scaling isn't supported here.
+    const float* t = mCurrentState.transform;
+    transformPoint(shape.cx, shape.cy);
+    float ax = t[0] * shape.axisX + t[2] * shape.axisY;
+    float ay = t[1] * shape.axisX + t[3] * shape.axisY;
+    float axisLength = sqrtf(ax * ax + ay * ay);
+    if (axisLength > 0.0001f) {
+        shape.axisX = ax / axisLength;
+        shape.axisY = ay / axisLength;
+    }
+
+    float scale = sqrtf(std::abs(t[0] * t[3] - t[1] * t[2]));
+    if (scale != 1.0f) {
+        shape.hw *= scale;
+        shape.hh *= scale;
+        shape.strokeWidth *= scale;
+        ShapeKind kind = static_cast<ShapeKind>(static_cast<int>(shape.kind));
+        if (kind == ShapeKind::Arc || kind == ShapeKind::RoundedRect || kind == ShapeKind::Line)
+            shape.params[0] *= scale;  // arc radius, corner radius, line half length
+    }
+
+    mShapes.push_back(shape);
+}
+
+bool WebGPURenderer::pushTrace(float x, float y, float w, float h, const float* data, int count, TraceMode mode,
+                               const Color& color, float thickness) {
+    if (!mPipelines.trace || !mSampleBindGroupLayout) return false;
+    if (!data || count <= 0 || (mode != TraceMode::Bars && count < 2)) return true;
+
+    // Traces are always axis aligned, only the bounds go through the current transform
+    const float* t = mCurrentState.transform;
+    float x1 = x, y1 = y;
+    float x2 = x + w, y2 = y + h;
+    transformPoint(x1, y1);
+    transformPoint(x2, y2);
+    float scale = sqrtf(std::abs(t[0] * t[3] - t[1] * t[2]));
+
+    TraceInstance2D trace = {};
+    trace.x = std::min(x1, x2);
+    trace.y = std::min(y1, y2);
+    trace.w = std::abs(x2 - x1);
+    trace.h = std::abs(y2 - y1);
+    trace.first = static_cast<uint32_t>(mSamples.size());
+    trace.count = static_cast<uint32_t>(count);
+    trace.color = color;
+    trace.thickness = thickness * scale;
+    trace.gradient = mode == TraceMode::Bars ? 1.0f : 0.0f;
+
+    // With more than a couple of samples per pixel, a min/max column per pixel
+    // looks the same as the full line and keeps the vertex count bounded
+    uint32_t segments = static_cast<uint32_t>(count - 1);
+    if (mode == TraceMode::Line && count > trace.w * 2.0f) {
+        mode = TraceMode::Columns;
+        segments = std::max(1u, static_cast<uint32_t>(std::ceil(trace.w)));
+    } else if (mode == TraceMode::Bars) {
+        segments = static_cast<uint32_t>(count * 2);
+    }
+    trace.mode = static_cast<uint32_t>(mode);
+    trace.segments = segments;
+
+    // Every trace is its own draw, since the vertex count comes from the trace
+    closeDrawCommand();
+    mCurrentPipeline = mPipelines.trace;
+    mCurrentGeometry = Geometry::Traces;
+    mSamples.insert(mSamples.end(), data, data + count);
+    mDrawCommands.push_back({mPipelines.trace, mBindGroup, Geometry::Traces,
+                             static_cast<uint32_t>(mTraces.size()), segments * 6});
+    mTraces.push_back(trace);
+    mCommandStart = mTraces.size();
+    return true;
+}
+
+void WebGPURenderer::closeDrawCommand() {
+    if (mCurrentGeometry == Geometry::Traces) return;  // pushTrace records its own commands
+
+    bool shapes = mCurrentGeometry == Geometry::Shapes;
+    size_t end = shapes ? mShapes.size() : mVertices.size();
+    if (end <= mCommandStart) return;
+
+    WGPURenderPipeline pipeline = mCurrentPipeline ? mCurrentPipeline : mPipelines.solid;
+    WGPUBindGroup bindGroup = shapes && mShapeBindGroup ? mShapeBindGroup : mBindGroup;
+    uint32_t first = static_cast<uint32_t>(mCommandStart);
+    uint32_t count = static_cast<uint32_t>(end - mCommandStart);
+    mCommandStart = end;
+
+    // Switching away from a pipeline and straight back again just extends the previous draw
+    if (!mDrawCommands.empty()) {
+        DrawCommand& last = mDrawCommands.back();
+        if (mDrawCommands.size() > mMergeBarrier && last.pipeline == pipeline && last.bindGroup == bindGroup &&
+            last.geometry == mCurrentGeometry && last.first + last.count == first) {
+            last.count += count;
+            return;
+        }
+    }
+
+    mDrawCommands.push_back({pipeline, bindGroup, mCurrentGeometry, first, count});
+}
+
+bool WebGPURenderer::allocateRing(GpuRing& ring, uint64_t bytes, WGPUBufferUsage usage, uint64_t& byteOffset) {
+    // Frames are placed one after another in the ring, wrapping around when the
+    // tail is too short, so each write lands in a region the previous frame isn't using.
+    // Keep the buffer at least twice the frame size so two frames always fit.
+    bytes = (bytes + 3) & ~uint64_t(3);
+    if (bytes * 2 <= ring.capacity) {
+        if (ring.head + bytes > ring.capacity) ring.head = 0;
+        byteOffset = ring.head;
+        ring.head += bytes;
+        return true;
+    }
+
+    uint64_t capacity = std::max<uint64_t>(ring.capacity, 4096);
+    while (capacity < bytes * 2) capacity *= 2;
+
+    WGPUBufferDescriptor bufferDesc = {};
+    bufferDesc.size = capacity;
+    bufferDesc.usage = usage | WGPUBufferUsage_CopyDst;
+    WGPUBuffer buffer = wgpuDeviceCreateBuffer(mContext.getDevice(), &bufferDesc);
+    if (!buffer) {
+        printf("WebGPURenderer: ERROR - Failed to grow ring buffer to %llu bytes\n",
+               static_cast<unsigned long long>(capacity));
+        return false;
+    }
+
+    if (ring.buffer) wgpuBufferRelease(ring.buffer);
+    ring.buffer = buffer;
+    ring.capacity = capacity;
+    byteOffset = 0;
+    ring.head = bytes;
+    return true;
+}
+
+void WebGPURenderer::submitFrame() {
+    closeDrawCommand();
+    endLayer();
+
+    FrameOffsets offsets;
+    bool ok = !mDrawCommands.empty();
+    if (ok && !mVertices.empty())
+        ok = allocateRing(mVertexRing, mVertices.size() * sizeof(Vertex2D), WGPUBufferUsage_Vertex, offsets.vertex);
+    if (ok && !mShapes.empty())
+        ok = allocateRing(mInstanceRing, mShapes.size() * sizeof(ShapeInstance2D), WGPUBufferUsage_Vertex, offsets.instance);
+    if (ok && !mTraces.empty()) {
+        ok = allocateRing(mTraceRing, mTraces.size() * sizeof(TraceInstance2D), WGPUBufferUsage_Vertex, offsets.trace) &&
+             allocateRing(mSampleRing, mSamples.size() * sizeof(float), WGPUBufferUsage_Storage, offsets.sample);
+    }
+
+    // The sample bind group covers the whole ring, so it only changes when the ring grows
+    if (ok && !mTraces.empty() && mSampleBindGroupBuffer != mSampleRing.buffer) {
+        if (mSampleBindGroup) wgpuBindGroupRelease(mSampleBindGroup);
+
+        WGPUBindGroupEntry sampleEntry = {};
+        sampleEntry.binding = 0;
+        sampleEntry.buffer = mSampleRing.buffer;
+        sampleEntry.offset = 0;
+        sampleEntry.size = mSampleRing.capacity;
+
+        WGPUBindGroupDescriptor bindGroupDesc = {};
+        bindGroupDesc.layout = mSampleBindGroupLayout;
+        bindGroupDesc.entryCount = 1;
+        bindGroupDesc.entries = &sampleEntry;
+        mSampleBindGroup = wgpuDeviceCreateBindGroup(mContext.getDevice(), &bindGroupDesc);
+        mSampleBindGroupBuffer = mSampleBindGroup ? mSampleRing.buffer : nullptr;
+        ok = mSampleBindGroup != nullptr;
+    }
+
+    if (!ok) {
+        // Layers that were supposed to be redrawn have to be redrawn next frame instead
+        for (const LayerPass& layerPass : mLayerPasses) mLayers[layerPass.layer].valid = false;
+        clearFrame();
+        return;
+    }
+
+    // Upload the whole frame's vertices and instances at once
+    if (!mVertices.empty()) {
+        wgpuQueueWriteBuffer(mContext.getQueue(), mVertexRing.buffer, offsets.vertex,
+                             mVertices.data(), mVertices.size() * sizeof(Vertex2D));
+    }
+    if (!mShapes.empty()) {
+        wgpuQueueWriteBuffer(mContext.getQueue(), mInstanceRing.buffer, offsets.instance,
+                             mShapes.data(), mShapes.size() * sizeof(ShapeInstance2D));
+    }
+    if (!mTraces.empty()) {
+        // Point the traces at where this frame's samples landed in the ring
+        uint32_t sampleBase = static_cast<uint32_t>(offsets.sample / sizeof(float));
+        for (TraceInstance2D& trace : mTraces) trace.first += sampleBase;
+
+        wgpuQueueWriteBuffer(mContext.getQueue(), mTraceRing.buffer, offsets.trace,
+                             mTraces.data(), mTraces.size() * sizeof(TraceInstance2D));
+        wgpuQueueWriteBuffer(mContext.getQueue(), mSampleRing.buffer, offsets.sample,
+                             mSamples.data(), mSamples.size() * sizeof(float));
+    }
+
+    // Redrawn layers are submitted ahead of the frame, so the frame can sample them
+    encodeLayerPasses(offsets);
+
+    // One surface acquire, one render pass and one submit for the whole frame,
+    // skipping the commands that went into layers
     WGPURenderPassEncoder pass = mContext.beginFrame();
-    if (!pass) return;
-    
-    // Set pipeline and draw
-    if (mCurrentPipeline) {
-        wgpuRenderPassEncoderSetPipeline(pass, mCurrentPipeline);
-    } else {
-        wgpuRenderPassEncoderSetPipeline(pass, mPipelines.solid);
+    if (pass) {
+        size_t command = 0;
+        for (const LayerPass& layerPass : mLayerPasses) {
+            encodeCommands(pass, command, layerPass.firstCommand, offsets);
+            command = layerPass.endCommand;
+        }
+        encodeCommands(pass, command, mDrawCommands.size(), offsets);
+
+        mContext.endFrame();
     }
 
-    wgpuRenderPassEncoderSetBindGroup(pass, 0, mBindGroup, 0, nullptr);
-    wgpuRenderPassEncoderSetVertexBuffer(pass, 0, mVertexBuffer, 0, mVertices.size() * sizeof(Vertex2D));
-    wgpuRenderPassEncoderDraw(pass, static_cast<uint32_t>(mVertices.size()), 1, 0, 0);
-    
-    mContext.endFrame();
-    
+    clearFrame();
+}
+
+void WebGPURenderer::encodeCommands(WGPURenderPassEncoder pass, size_t firstCommand, size_t endCommand,
+                                    const FrameOffsets& offsets) {
+    if (firstCommand >= endCommand) return;
+
+    wgpuRenderPassEncoderSetIndexBuffer(pass, mQuadIndexBuffer, WGPUIndexFormat_Uint16, 0, WGPU_WHOLE_SIZE);
+
+    WGPURenderPipeline boundPipeline = nullptr;
+    WGPUBindGroup boundBindGroup = nullptr;
+    WGPUBuffer boundBuffer = nullptr;
+    bool samplesBound = false;
+    for (size_t i = firstCommand; i < endCommand; ++i) {
+        const DrawCommand& command = mDrawCommands[i];
+        if (!command.pipeline) continue;
+        if (command.pipeline != boundPipeline) {
+            wgpuRenderPassEncoderSetPipeline(pass, command.pipeline);
+            boundPipeline = command.pipeline;
+        }
+        if (command.bindGroup != boundBindGroup) {
+            wgpuRenderPassEncoderSetBindGroup(pass, 0, command.bindGroup, 0, nullptr);
+            boundBindGroup = command.bindGroup;
+        }
+
+        // Bind groups stay bound across pipeline changes, so the samples only need binding once
+        if (command.geometry == Geometry::Traces && !samplesBound) {
+            wgpuRenderPassEncoderSetBindGroup(pass, 1, mSampleBindGroup, 0, nullptr);
+            samplesBound = true;
+        }
+
+        bool shapes = command.geometry == Geometry::Shapes;
+        bool traces = command.geometry == Geometry::Traces;
+        WGPUBuffer buffer = shapes ? mInstanceRing.buffer : traces ? mTraceRing.buffer : mVertexRing.buffer;
+        if (buffer != boundBuffer) {
+            if (shapes) {
+                wgpuRenderPassEncoderSetVertexBuffer(pass, 0, buffer, offsets.instance,
+                                                     mShapes.size() * sizeof(ShapeInstance2D));
+            } else if (traces) {
+                wgpuRenderPassEncoderSetVertexBuffer(pass, 0, buffer, offsets.trace,
+                                                     mTraces.size() * sizeof(TraceInstance2D));
+            } else {
+                wgpuRenderPassEncoderSetVertexBuffer(pass, 0, buffer, offsets.vertex,
+                                                     mVertices.size() * sizeof(Vertex2D));
+            }
+            boundBuffer = buffer;
+        }
+
+        switch (command.geometry) {
+            case Geometry::Triangles:
+                wgpuRenderPassEncoderDraw(pass, command.count, 1, command.first, 0);
+                break;
+            case Geometry::Quads: {
+                uint32_t numQuads = command.count / 4;
+                for (uint32_t quad = 0; quad < numQuads; quad += kMaxQuadsPerDraw) {
+                    uint32_t chunk = std::min(numQuads - quad, kMaxQuadsPerDraw);
+                    wgpuRenderPassEncoderDrawIndexed(pass, chunk * 6, 1, 0,
+                                                     static_cast<int32_t>(command.first + quad * 4), 0);
+                }
+                break;
+            }
+            case Geometry::Shapes:
+                // Every instance reads the same four corners out of the quad index buffer
+                wgpuRenderPassEncoderDrawIndexed(pass, 6, command.count, 0, 0, command.first);
+                break;
+            case Geometry::Traces:
+                // The vertex shader builds two triangles per segment from the vertex index
+                wgpuRenderPassEncoderDraw(pass, command.count, 1, 0, command.first);
+                break;
+        }
+    }
+}
+
+void WebGPURenderer::encodeLayerPasses(const FrameOffsets& offsets) {
+    if (mLayerPasses.empty()) return;
+
+    WGPUCommandEncoderDescriptor encoderDesc = {};
+    WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(mContext.getDevice(), &encoderDesc);
+    if (!encoder) {
+        printf("WebGPURenderer: ERROR - Failed to create command encoder for layers\n");
+        for (const LayerPass& layerPass : mLayerPasses) mLayers[layerPass.layer].valid = false;
+        return;
+    }
+
+    for (const LayerPass& layerPass : mLayerPasses) {
+        // Cleared to transparent, so the layer ends up premultiplied
+        WGPURenderPassColorAttachment colorAttachment = {};
+        colorAttachment.view = mLayers[layerPass.layer].view;
+        colorAttachment.loadOp = WGPULoadOp_Clear;
+        colorAttachment.storeOp = WGPUStoreOp_Store;
+        colorAttachment.clearValue = {0.0, 0.0, 0.0, 0.0};
+#ifdef WGPU_DEPTH_SLICE_UNDEFINED
+        colorAttachment.depthSlice = WGPU_DEPTH_SLICE_UNDEFINED;
+#else
+        colorAttachment.depthSlice = 0xFFFFFFFF;
+#endif
+
+        WGPURenderPassDescriptor passDesc = {};
+        passDesc.colorAttachmentCount = 1;
+        passDesc.colorAttachments = &colorAttachment;
+
+        WGPURenderPassEncoder pass = wgpuCommandEncoderBeginRenderPass(encoder, &passDesc);
+        if (!pass) {
+            mLayers[layerPass.layer].valid = false;
+            continue;
+        }
+        encodeCommands(pass, layerPass.firstCommand, layerPass.endCommand, offsets);
+        wgpuRenderPassEncoderEnd(pass);
+        wgpuRenderPassEncoderRelease(pass);
+    }
+
+    WGPUCommandBufferDescriptor cmdBufDesc = {};
+    WGPUCommandBuffer cmdBuf = wgpuCommandEncoderFinish(encoder, &cmdBufDesc);
+    wgpuQueueSubmit(mContext.getQueue(), 1, &cmdBuf);
+    wgpuCommandBufferRelease(cmdBuf);
+    wgpuCommandEncoderRelease(encoder);
+}
+
+void WebGPURenderer::clearFrame() {
     mVertices.clear();
+    mShapes.clear();
+    mTraces.clear();
+    mSamples.clear();
+    mDrawCommands.clear();
+    mLayerPasses.clear();
+    mCommandStart = 0;
+    mMergeBarrier = 0;
+    mActiveLayer = -1;
+}
+
+// ============================================================================
+// Layers
+// ============================================================================
+
+int WebGPURenderer::createLayer() {
+    mLayers.emplace_back();
+    return static_cast<int>(mLayers.size()) - 1;
+}
+
+bool WebGPURenderer::beginLayer(int layer, uint64_t key) {
+    if (layer < 0 || layer >= static_cast<int>(mLayers.size()) || mActiveLayer >= 0) return false;
+
+    Layer& target = mLayers[layer];
+    if (target.width != mWidth || target.height != mHeight) releaseLayer(target);
+    if (target.valid && target.key == key) return false;
+
+    // Without a texture the content is drawn straight into the frame every time
+    if (!target.texture && !createLayerTexture(target)) return true;
+
+    closeDrawCommand();
+    target.key = key;
+    target.valid = true;
+    mActiveLayer = layer;
+    mLayerPasses.push_back({layer, mDrawCommands.size(), mDrawCommands.size()});
+    mMergeBarrier = mDrawCommands.size();
+    return true;
+}
+
+void WebGPURenderer::endLayer() {
+    if (mActiveLayer < 0) return;
+
+    closeDrawCommand();
+    mLayerPasses.back().endCommand = mDrawCommands.size();
+    mMergeBarrier = mDrawCommands.size();
+    mActiveLayer = -1;
+}
+
+void WebGPURenderer::drawLayer(int layer) {
+    if (layer < 0 || layer >= static_cast<int>(mLayers.size()) || mActiveLayer >= 0 || !mPipelines.layer) return;
+
+    const Layer& source = mLayers[layer];
+    if (!source.valid || !source.bindGroup || source.width != mWidth || source.height != mHeight) return;
+
+    // The layer is already in framebuffer coordinates, so the transform doesn't apply
+    closeDrawCommand();
+    uint32_t first = static_cast<uint32_t>(mVertices.size());
+    float w = static_cast<float>(source.width);
+    float h = static_cast<float>(source.height);
+    Color white(1.0f, 1.0f, 1.0f, 1.0f);
+    pushVertex(0.0f, 0.0f, 0.0f, 0.0f, white);
+    pushVertex(w, 0.0f, 1.0f, 0.0f, white);
+    pushVertex(w, h, 1.0f, 1.0f, white);
+    pushVertex(0.0f, h, 0.0f, 1.0f, white);
+    mDrawCommands.push_back({mPipelines.layer, source.bindGroup, Geometry::Quads, first, 4});
+
+    mCurrentPipeline = mPipelines.layer;
+    mCurrentGeometry = Geometry::Quads;
+    mCommandStart = mVertices.size();
+}
+
+void WebGPURenderer::invalidateLayers() {
+    for (Layer& layer : mLayers) layer.valid = false;
+}
+
+bool WebGPURenderer::createLayerTexture(Layer& layer) {
+    if (mWidth <= 0 || mHeight <= 0 || !mBindGroupLayout) return false;
+
+    WGPUDevice device = mContext.getDevice();
+    if (!mLayerSampler) {
+        // Layers are drawn 1:1, so there's nothing to filter
+        WGPUSamplerDescriptor samplerDesc = {};
+        samplerDesc.addressModeU = WGPUAddressMode_ClampToEdge;
+        samplerDesc.addressModeV = WGPUAddressMode_ClampToEdge;
+        samplerDesc.addressModeW = WGPUAddressMode_ClampToEdge;
+        samplerDesc.magFilter = WGPUFilterMode_Nearest;
+        samplerDesc.minFilter = WGPUFilterMode_Nearest;
+        samplerDesc.mipmapFilter = WGPUMipmapFilterMode_Nearest;
+        mLayerSampler = wgpuDeviceCreateSampler(device, &samplerDesc);
+        if (!mLayerSampler) return false;
+    }
+
+    // Same format as the swap chain, so the existing pipelines can render into it
+    WGPUTextureDescriptor textureDesc = {};
+    textureDesc.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding;
+    textureDesc.dimension = WGPUTextureDimension_2D;
+    textureDesc.size = {static_cast<uint32_t>(mWidth), static_cast<uint32_t>(mHeight), 1};
+    textureDesc.format = mContext.getSwapChainFormat();
+    textureDesc.mipLevelCount = 1;
+    textureDesc.sampleCount = 1;
+    layer.texture = wgpuDeviceCreateTexture(device, &textureDesc);
+    if (!layer.texture) {
+        printf("WebGPURenderer: ERROR - Failed to create %dx%d layer texture\n", mWidth, mHeight);
+        return false;
+    }
+
+    WGPUTextureViewDescriptor viewDesc = {};
+    viewDesc.format = textureDesc.format;
+    viewDesc.dimension = WGPUTextureViewDimension_2D;
+    viewDesc.baseMipLevel = 0;
+    viewDesc.mipLevelCount = 1;
+    viewDesc.baseArrayLayer = 0;
+    viewDesc.arrayLayerCount = 1;
+    viewDesc.aspect = WGPUTextureAspect_All;
+    layer.view = wgpuTextureCreateView(layer.texture, &viewDesc);
+
+    WGPUBindGroupEntry bgEntries[3] = {};
+    bgEntries[0].binding = 0;
+    bgEntries[0].buffer = mUniformBuffer;
+    bgEntries[0].offset = 0;
+    bgEntries[0].size = sizeof(float) * 4;
+    bgEntries[1].binding = 1;
+    bgEntries[1].sampler = mLayerSampler;
+    bgEntries[2].binding = 2;
+    bgEntries[2].textureView = layer.view;
+
+    WGPUBindGroupDescriptor bindGroupDesc = {};
+    bindGroupDesc.layout = mBindGroupLayout;
+    bindGroupDesc.entryCount = 3;
+    bindGroupDesc.entries = bgEntries;
+    layer.bindGroup = layer.view ? wgpuDeviceCreateBindGroup(device, &bindGroupDesc) : nullptr;
+    if (!layer.bindGroup) {
+        releaseLayer(layer);
+        return false;
+    }
+
+    layer.width = mWidth;
+    layer.height = mHeight;
+    return true;
+}
+
+void WebGPURenderer::releaseLayer(Layer& layer) {
+    if (layer.bindGroup) wgpuBindGroupRelease(layer.bindGroup);
+    if (layer.view) wgpuTextureViewRelease(layer.view);
+    if (layer.texture) wgpuTextureRelease(layer.texture);
+    layer = Layer();
 }
 
 } // namespace wasm
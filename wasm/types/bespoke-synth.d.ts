@@ -33,6 +33,28 @@ export interface BespokeSynthModule extends EmscriptenModule {
     _bespoke_key_down(keyCode: number, modifiers: number): void;
     _bespoke_key_up(keyCode: number, modifiers: number): void;
 
+    // Remote ui (url is a pointer to a UTF-8 ws:// url of a bespoke-server)
+    _bespoke_remote_connect(url: number, token: number): number;
+    _bespoke_remote_disconnect(): void;
+    _bespoke_remote_is_connected(): number;
+
+    // Samples (see SampleStore.h; requests are 6 uint32s each: id, slot, start frame, frames, channel stride, pointer)
+    _bespoke_sample_create(numChannels: number, numFrames: number, sampleRate: number): number;
+    _bespoke_sample_release(id: number): void;
+    _bespoke_sample_is_streamed(id: number): number;
+    _bespoke_sample_get_resident_frames(id: number): number;
+    _bespoke_sample_take_requests(): number;
+    _bespoke_sample_get_requests(): number;
+    _bespoke_sample_block_ready(id: number, slot: number, startFrame: number): void;
+
+    // Shared parameter block (name is a pointer to a UTF-8 string)
+    _bespoke_get_parameter_block(): number;
+    _bespoke_get_parameter_id(name: number): number;
+    _bespoke_get_meter_id(name: number): number;
+
+    // Resources (path is a pointer to a UTF-8 path relative to resource/)
+    _bespoke_request_resource(path: number): number;
+
     // Module management
     _bespoke_create_module(type: number, x: number, y: number): number;
     _bespoke_delete_module(moduleId: number): void;
@@ -57,6 +79,7 @@ export interface BespokeSynthModule extends EmscriptenModule {
     // Debug/info
     _bespoke_get_version(): number;
     _bespoke_get_cpu_load(): number;
+    _bespoke_get_telemetry(): number;
     _bespoke_get_module_count(): number;
 
     // Panel management
@@ -95,6 +118,40 @@ export enum PanelType {
     Sequencer = 2
 }
 
+/**
+ * Live views over the WASM telemetry block (layout in Telemetry.h).
+ * Sample n of a ring is at index (n % ringSize) * 4 of its ring view.
+ */
+export interface BespokeTelemetry {
+    readonly audioCount: number;
+    readonly frameCount: number;
+    readonly xrunCount: number;
+    readonly ringSize: number;
+    /** Smoothed audio callback duration over buffer period */
+    readonly cpuLoad: number;
+    readonly bufferPeriodMs: number;
+    readonly lastFrameMs: number;
+    /** time ms, callback ms, load, interval ms */
+    readonly audioRing: Float32Array;
+    /** time ms, frame ms, submit ms, interval ms */
+    readonly frameRing: Float32Array;
+}
+
+/**
+ * Live views over the WASM parameter block (layout in ParameterBlock.h).
+ * Writing values[id] changes the control on the next rendered frame.
+ */
+export interface BespokeParameterBlock {
+    readonly parameterCount: number;
+    readonly meterCount: number;
+    readonly frameCount: number;
+    /** Rendered frames per panel, indexed by PanelType */
+    readonly panelFrameCounts: Uint32Array;
+    readonly values: Float32Array;
+    readonly meters: Float32Array;
+    readonly peaks: Float32Array;
+}
+
 /**
  * High-level TypeScript wrapper for BespokeSynth WASM
  */
@@ -103,6 +160,10 @@ export class BespokeSynth {
     private canvas: HTMLCanvasElement;
     private animationFrameId: number | null = null;
     private isInitialized = false;
+    private telemetryBuffer: ArrayBufferLike | null = null;
+    private telemetry: BespokeTelemetry | null = null;
+    private parameterBuffer: ArrayBufferLike | null = null;
+    private parameters: BespokeParameterBlock | null = null;
 
     constructor(module: BespokeSynthModule, canvas: HTMLCanvasElement) {
         this.module = module;
@@ -228,6 +289,82 @@ export class BespokeSynth {
         return this.module._bespoke_get_cpu_load();
     }
 
+    /**
+     * Get the telemetry views. These read WASM memory directly, so polling them
+     * costs nothing; they are only rebuilt when memory growth replaces the buffer.
+     */
+    getTelemetry(): BespokeTelemetry {
+        const buffer = this.module.HEAPU8.buffer;
+        if (this.telemetry === null || this.telemetryBuffer !== buffer) {
+            const ptr = this.module._bespoke_get_telemetry();
+            const words = new Uint32Array(buffer, ptr, 8);
+            const floats = new Float32Array(buffer, ptr, 8);
+            const ringSize = words[3];
+            const audioRing = new Float32Array(buffer, ptr + 32, ringSize * 4);
+            const frameRing = new Float32Array(buffer, ptr + 32 + ringSize * 16, ringSize * 4);
+            this.telemetryBuffer = buffer;
+            this.telemetry = {
+                get audioCount() { return words[0]; },
+                get frameCount() { return words[1]; },
+                get xrunCount() { return words[2]; },
+                ringSize,
+                get cpuLoad() { return floats[4]; },
+                get bufferPeriodMs() { return floats[5]; },
+                get lastFrameMs() { return floats[6]; },
+                audioRing,
+                frameRing
+            };
+        }
+        return this.telemetry;
+    }
+
+    /**
+     * Get the parameter block views, rebuilt only when memory growth replaces the buffer
+     */
+    getParameterBlock(): BespokeParameterBlock {
+        const buffer = this.module.HEAPU8.buffer;
+        if (this.parameters === null || this.parameterBuffer !== buffer) {
+            const ptr = this.module._bespoke_get_parameter_block();
+            const header = new Uint32Array(buffer, ptr, 16);
+            const maxParameters = header[2];
+            const maxMeters = header[3];
+            const valuesPtr = ptr + 16 * 4;
+            const metersPtr = valuesPtr + maxParameters * 4;
+            const peaksPtr = metersPtr + maxMeters * 4;
+            this.parameterBuffer = buffer;
+            this.parameters = {
+                get parameterCount() { return header[0]; },
+                get meterCount() { return header[1]; },
+                get frameCount() { return header[4]; },
+                panelFrameCounts: header.subarray(5, 13),
+                values: new Float32Array(buffer, valuesPtr, maxParameters),
+                meters: new Float32Array(buffer, metersPtr, maxMeters),
+                peaks: new Float32Array(buffer, peaksPtr, maxMeters)
+            };
+        }
+        return this.parameters;
+    }
+
+    /**
+     * Look up a parameter ID by control name, -1 if there is none. IDs don't change, so cache them
+     */
+    getParameterId(name: string): number {
+        const namePtr = this.module.allocateUTF8(name);
+        const id = this.module._bespoke_get_parameter_id(namePtr);
+        this.module._free(namePtr);
+        return id;
+    }
+
+    /**
+     * Look up a meter ID by name ("output", "input"), -1 if there is none
+     */
+    getMeterId(name: string): number {
+        const namePtr = this.module.allocateUTF8(name);
+        const id = this.module._bespoke_get_meter_id(namePtr);
+        this.module._free(namePtr);
+        return id;
+    }
+
     /**
      * Get the number of modules
      */
@@ -1,9 +1,37 @@
 const path = require('path');
 const HtmlWebpackPlugin = require('html-webpack-plugin');
 const CopyWebpackPlugin = require('copy-webpack-plugin');
+const crypto = require('crypto');
+const fs = require('fs');
+
+// Fonts and drum samples the service worker pre-caches, as paths relative to the site root
+const PRECACHE_PATTERNS = [/^resource\/[^/]+\.(ttf|sfn\.gz)$/, /^resource\/userdata_original\/drums\/.+\.wav$/];
+
+const listFiles = (dir) => {
+  if (!fs.existsSync(dir)) return [];
+  return fs.readdirSync(dir, { withFileTypes: true }).flatMap((entry) => {
+    const entryPath = path.posix.join(dir, entry.name);
+    return entry.isDirectory() ? listFiles(entryPath) : [entryPath];
+  });
+};
+
+const collectPrecache = () => {
+  const files = listFiles('resource').filter((file) => PRECACHE_PATTERNS.some((pattern) => pattern.test(file)));
+  const hash = crypto.createHash('sha256');
+  for (const file of files) {
+    hash.update(file);
+    hash.update(fs.readFileSync(file));
+  }
+  return {
+    // encodeURI, the sample names contain spaces and brackets
+    urls: files.map((file) => encodeURI(file)),
+    version: hash.digest('hex').slice(0, 16),
+  };
+};
 
 module.exports = (env, argv) => {
   const isDevelopment = argv.mode === 'development';
+  const precache = collectPrecache();
 
   return {
     entry: './src/index.ts',
@@ -49,6 +77,15 @@ module.exports = (env, argv) => {
             to: 'resource',
             noErrorOnMissing: true,
           },
+          {
+            from: 'src/service-worker.js',
+            to: 'sw.js',
+            transform: (content) =>
+              content
+                .toString()
+                .replace('__RESOURCE_PRECACHE__', JSON.stringify(precache.urls))
+                .replace('__RESOURCE_VERSION__', JSON.stringify(precache.version)),
+          },
         ],
       }),
     ],